@@ -133,6 +133,8 @@ def generate_schema_cc_library(
             "//lullaby/util:logging",
             "//lullaby/util:common_types",
             "//lullaby/util:optional",
+            "//lullaby/util:span",
+            "//lullaby/util:string_view",
         ],
         linkstatic = 1,
         visibility = visibility,
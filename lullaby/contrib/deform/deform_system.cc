@@ -21,6 +21,7 @@ limitations under the License.
 #include "lullaby/modules/render/mesh_util.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/job_processor.h"
 #include "lullaby/util/math.h"
 
 namespace lull {
@@ -28,6 +29,10 @@ namespace {
 const HashValue kDeformerHash = ConstHash("DeformerDef");
 const HashValue kDeformedHash = ConstHash("DeformedDef");
 
+// Meshes are split into jobs of at least this many vertices when deformed on
+// the JobProcessor, so that small meshes aren't dominated by scheduling costs.
+constexpr size_t kMinVerticesPerJob = 2048;
+
 // Returns the standard transformation matrix given the SQT and a nullable
 // world_from_parent_mat
 mathfu::mat4 CalculateTransformMatrixFromParent(
@@ -91,6 +96,7 @@ void DeformSystem::Create(Entity e, HashValue type, const Def* def) {
     deformer->radius = deformer_def->horizontal_radius();
     deformer->mode = deformer_def->deform_mode();
     deformer->clamp_angle = deformer_def->clamp_angle();
+    deformer->gpu_deform = deformer_def->gpu_deform();
 
     if (deformer_def->deform_mode() == DeformMode_Waypoint) {
       for (const lull::WaypointPath* waypoint_path :
@@ -333,7 +339,11 @@ void DeformSystem::DeformMesh(Entity e, MeshData* mesh) {
     const Deformer* deformer = deformers_.Get(deformed->deformer);
     if (deformer != nullptr && deformer->mode == DeformMode_CylinderBend) {
       deformed->undeformed_aabb = GetBoundingBox(*mesh);
-      CylinderBendDeformMesh(*deformed, *deformer, mesh);
+      if (deformer->gpu_deform) {
+        UpdateGpuDeformation(e);
+      } else {
+        CylinderBendDeformMesh(*deformed, *deformer, mesh);
+      }
     } else if (deformer != nullptr && deformer->mode == DeformMode_Waypoint) {
       // Waypoint deformation deliberately does not deform mesh
     } else {
@@ -478,9 +488,10 @@ mathfu::mat4 DeformSystem::CalculateWaypointTransformMatrix(
                                             deformed_world_from_deformer);
 }
 
-void DeformSystem::CylinderBendDeformMesh(const Deformed& deformed,
-                                          const Deformer& deformer,
-                                          MeshData* mesh) const {
+bool DeformSystem::CalculateCylinderBendMatrices(
+    const Deformed& deformed, const Deformer& deformer,
+    mathfu::mat4* root_from_entity_undeformed_space,
+    mathfu::mat4* entity_from_root_deformed_space) const {
   const TransformSystem& transform_system = *registry_->Get<TransformSystem>();
   const mathfu::mat4* world_from_entity_deformed_space =
       transform_system.GetWorldFromEntityMatrix(deformed.GetEntity());
@@ -488,7 +499,7 @@ void DeformSystem::CylinderBendDeformMesh(const Deformed& deformed,
       transform_system.GetWorldFromEntityMatrix(deformer.GetEntity());
   if (!world_from_entity_deformed_space ||
       !world_from_deformer_deformed_space) {
-    return;
+    return false;
   }
 
   // To deform the mesh we first transform the vertices into the deformer root
@@ -496,21 +507,98 @@ void DeformSystem::CylinderBendDeformMesh(const Deformed& deformed,
   // z-axis. To get back out of root space, we have to use the deformed
   // transforms that we have set on the transform system.
   const float radius = deformer.radius;
-  const mathfu::mat4 root_from_entity_undeformed_space =
+  *root_from_entity_undeformed_space =
       mathfu::mat4::FromTranslationVector(-radius * mathfu::kAxisZ3f) *
       deformed.deformer_from_entity_undeformed_space;
 
-  const mathfu::mat4 entity_from_root_deformed_space =
+  *entity_from_root_deformed_space =
       world_from_entity_deformed_space->Inverse() *
       (*world_from_deformer_deformed_space) *
       mathfu::mat4::FromTranslationVector(radius * mathfu::kAxisZ3f);
+  return true;
+}
 
-  ApplyDeformation(
-      mesh, [&radius, &root_from_entity_undeformed_space,
-             &entity_from_root_deformed_space](const mathfu::vec3& pos) {
+void DeformSystem::CylinderBendDeformMesh(const Deformed& deformed,
+                                          const Deformer& deformer,
+                                          MeshData* mesh) const {
+  mathfu::mat4 root_from_entity_undeformed_space;
+  mathfu::mat4 entity_from_root_deformed_space;
+  if (!CalculateCylinderBendMatrices(deformed, deformer,
+                                     &root_from_entity_undeformed_space,
+                                     &entity_from_root_deformed_space)) {
+    return;
+  }
+
+  const float radius = deformer.radius;
+  const PositionDeformation deform =
+      [&radius, &root_from_entity_undeformed_space,
+       &entity_from_root_deformed_space](const mathfu::vec3& pos) {
         return entity_from_root_deformed_space *
                DeformPoint(root_from_entity_undeformed_space * pos, radius);
-      });
+      };
+
+  JobProcessor* job_processor = registry_->Get<JobProcessor>();
+  const size_t num_vertices = mesh->GetNumVertices();
+  const size_t num_jobs = num_vertices / kMinVerticesPerJob;
+#if !LULLABY_USE_JAVASCRIPT_TIMERS
+  if (job_processor && num_jobs > 1) {
+    // Each job deforms its own range of vertices, so they don't share any
+    // output. Dispatch all but the first range to the worker threads, and
+    // deform the first range on this thread while waiting.
+    const size_t vertices_per_job = (num_vertices + num_jobs - 1) / num_jobs;
+    std::vector<JobProcessor::JobHandle> jobs;
+    jobs.reserve(num_jobs - 1);
+    for (size_t begin = vertices_per_job; begin < num_vertices;
+         begin += vertices_per_job) {
+      const size_t end = std::min(begin + vertices_per_job, num_vertices);
+      jobs.emplace_back(job_processor->Run([mesh, begin, end, &deform]() {
+        ApplyDeformation(mesh, begin, end, deform);
+      }));
+    }
+    ApplyDeformation(mesh, 0, vertices_per_job, deform);
+    for (const auto& job : jobs) {
+      job_processor->Wait(job);
+    }
+    return;
+  }
+#else
+  (void)job_processor;
+  (void)num_jobs;
+#endif
+  ApplyDeformation(mesh, deform);
+}
+
+void DeformSystem::UpdateGpuDeformation(Entity entity) {
+  const Deformed* deformed = deformed_.Get(entity);
+  if (!deformed) {
+    return;
+  }
+  const Deformer* deformer = deformers_.Get(deformed->deformer);
+  if (!deformer || !deformer->gpu_deform ||
+      deformer->mode != DeformMode_CylinderBend) {
+    return;
+  }
+
+  mathfu::mat4 root_from_entity_undeformed_space;
+  mathfu::mat4 entity_from_root_deformed_space;
+  if (!CalculateCylinderBendMatrices(*deformed, *deformer,
+                                     &root_from_entity_undeformed_space,
+                                     &entity_from_root_deformed_space)) {
+    return;
+  }
+
+  auto* render_system = registry_->Get<RenderSystem>();
+  render_system->SetUniform(
+      entity, "deform_root_from_entity", ShaderDataType_Float4x4,
+      {reinterpret_cast<const uint8_t*>(&root_from_entity_undeformed_space[0]),
+       sizeof(mathfu::mat4)});
+  render_system->SetUniform(
+      entity, "deform_entity_from_root", ShaderDataType_Float4x4,
+      {reinterpret_cast<const uint8_t*>(&entity_from_root_deformed_space[0]),
+       sizeof(mathfu::mat4)});
+  render_system->SetUniform(
+      entity, "deform_radius", ShaderDataType_Float1,
+      {reinterpret_cast<const uint8_t*>(&deformer->radius), sizeof(float)});
 }
 
 void DeformSystem::OnParentChanged(const ParentChangedEvent& ev) {
@@ -45,6 +45,10 @@ namespace lull {
 //     Note that render_system_mock is an empty implementation and no deform
 //     will be applied.
 //     No mesh alteration is applied for Waypoint.
+//     Large meshes are split into ranges of vertices that are deformed on the
+//     JobProcessor's worker threads, if one is in the Registry.  Deformers with
+//     |gpu_deform| set leave the mesh untouched and instead set the uniforms
+//     used by cylinder_deform.glslh on each deformed entity.
 //
 // Deformation should be accomplished by adding a DeformerDef component to
 // the root object of the deformation, and a contiguous chain of DeformedDef
@@ -99,6 +103,11 @@ class DeformSystem : public System {
   // Returns the bounding box of the entity before deformation was applied.
   const Aabb* UndeformedBoundingBox(Entity entity) const;
 
+  // Updates the uniforms used to deform |entity|'s mesh in the vertex shader if
+  // its deformer uses |gpu_deform|.  Call this after moving the entity relative
+  // to its deformer; unlike CPU deformation, no mesh needs to be recreated.
+  void UpdateGpuDeformation(Entity entity);
+
  private:
   // All the data for one Waypoint in waypoint deformation mode.
   struct Waypoint {
@@ -148,10 +157,14 @@ class DeformSystem : public System {
           radius(0.f),
           mode(DeformMode::DeformMode_None) {}
     Deformer(Entity e, const Deformer& prototype)
-        : Component(e), radius(prototype.radius), mode(prototype.mode) {}
+        : Component(e),
+          radius(prototype.radius),
+          mode(prototype.mode),
+          gpu_deform(prototype.gpu_deform) {}
     float radius;
     DeformMode mode;
     float clamp_angle;
+    bool gpu_deform = false;
     std::unordered_map<HashValue, WaypointPath> paths;
     float deform_strength = 1.0f;
   };
@@ -216,6 +229,14 @@ class DeformSystem : public System {
   void CylinderBendDeformMesh(const Deformed& deformed,
                               const Deformer& deformer, MeshData* mesh) const;
 
+  // Calculates the matrices that take |deformed|'s vertices into and out of
+  // the deformer's cylinder root space.  Returns false if either entity has no
+  // world transform.
+  bool CalculateCylinderBendMatrices(
+      const Deformed& deformed, const Deformer& deformer,
+      mathfu::mat4* root_from_entity_undeformed_space,
+      mathfu::mat4* entity_from_root_deformed_space) const;
+
   void OnParentChanged(const ParentChangedEvent& ev);
 
   // Recursively sets the deformer for all child entity's deformed components in
@@ -33,6 +33,7 @@ namespace lull {
 namespace {
 const HashValue kFadeResponseHash = ConstHash("FadeDef");
 const Clock::duration kDefaultFadeTime = std::chrono::milliseconds(250);
+const size_t kSubtreeAlphaChannelPoolSize = 16;
 }
 
 FadeSystem::FadeComponent::FadeComponent(Entity entity)
@@ -46,6 +47,11 @@ FadeSystem::FadeSystem(Registry* registry) : System(registry), fades_(16) {
 }
 
 void FadeSystem::Initialize() {
+  // Default fades of a whole hierarchy animate the alpha of the root's subtree
+  // color multiplier, which all of its descendants inherit when drawn.
+  AlphaMultiplierDescendantsChannel::Setup(registry_,
+                                           kSubtreeAlphaChannelPoolSize);
+
   auto* dispatcher = registry_->Get<Dispatcher>();
   dispatcher->Connect(this, [this](const FadeInEvent& e) {
     const auto duration = std::chrono::duration_cast<Clock::duration>(
@@ -137,6 +143,11 @@ void FadeSystem::FadeIn(Entity e, const Clock::duration& time) {
       first_animating = e;
       break;
     case FadeInheritMode_SelfAndChildren:
+      if (!fade->data || !fade->data->enable_anim()) {
+        fade->enable_animation_id = AnimateSubtreeFadeIn(*fade, e, time);
+        first_animating = e;
+        break;
+      }
       transform_system->ForAllDescendants(
           e, [this, fade, &first_animating, time](Entity child) {
             AnimationId child_anim = AnimateFadeIn(*fade, child, time);
@@ -208,13 +219,21 @@ void FadeSystem::FadeOut(Entity e, const Clock::duration& time) {
       break;
   }
 
-  // Start an animation on all targets.
+  // Start an animation on all targets, or a single one on the root if the
+  // whole hierarchy uses the default alpha fade.
   Entity first_animating = kNullEntity;
-  for (auto target : targets) {
-    AnimationId id = AnimateFadeOut(*fade, target, time);
-    if (fade->disable_animation_id == kNullAnimation && id != kNullAnimation) {
-      fade->disable_animation_id = id;
-      first_animating = target;
+  if (inherit_mode == FadeInheritMode_SelfAndChildren &&
+      (!fade->data || !fade->data->disable_anim())) {
+    fade->disable_animation_id = AnimateSubtreeFadeOut(*fade, e, time);
+    first_animating = e;
+  } else {
+    for (auto target : targets) {
+      AnimationId id = AnimateFadeOut(*fade, target, time);
+      if (fade->disable_animation_id == kNullAnimation &&
+          id != kNullAnimation) {
+        fade->disable_animation_id = id;
+        first_animating = target;
+      }
     }
   }
 
@@ -365,12 +384,68 @@ AnimationId FadeSystem::AnimateFadeOut(const FadeComponent& fade, Entity e,
   return kNullAnimation;
 }
 
+AnimationId FadeSystem::AnimateSubtreeFadeIn(const FadeComponent& fade,
+                                             Entity e, Clock::duration time) {
+  if (time.count() == 0) {
+    ResetSubtreeAlpha(e);
+    return kNullAnimation;
+  }
+  SetSubtreeAlpha(e, 0.f);
+  if (fade.data) {
+    time = std::chrono::milliseconds(fade.data->fade_time_ms());
+  }
+  const float alpha = 1.f;
+  auto* animation_system = registry_->Get<AnimationSystem>();
+  return animation_system->SetTarget(
+      e, AlphaMultiplierDescendantsChannel::kChannelName, &alpha, 1, time);
+}
+
+AnimationId FadeSystem::AnimateSubtreeFadeOut(const FadeComponent& fade,
+                                              Entity e, Clock::duration time) {
+  if (time.count() == 0) {
+    ResetSubtreeAlpha(e);
+    return kNullAnimation;
+  }
+  if (fade.data) {
+    time = std::chrono::milliseconds(fade.data->fade_time_ms());
+  }
+  const float alpha = 0.f;
+  auto* animation_system = registry_->Get<AnimationSystem>();
+  return animation_system->SetTarget(
+      e, AlphaMultiplierDescendantsChannel::kChannelName, &alpha, 1, time);
+}
+
+void FadeSystem::SetSubtreeAlpha(Entity e, float alpha) {
+  auto* render_system = registry_->Get<RenderSystem>();
+  mathfu::vec4 multiplier = mathfu::kOnes4f;
+  render_system->GetSubtreeColorMultiplier(e, &multiplier);
+  multiplier[3] = alpha;
+  render_system->SetSubtreeColorMultiplier(e, multiplier);
+}
+
+void FadeSystem::ResetSubtreeAlpha(Entity e) {
+  auto* render_system = registry_->Get<RenderSystem>();
+  mathfu::vec4 multiplier;
+  if (!render_system->GetSubtreeColorMultiplier(e, &multiplier)) {
+    return;
+  }
+  multiplier[3] = 1.f;
+  if (multiplier == mathfu::kOnes4f) {
+    render_system->ClearSubtreeColorMultiplier(e);
+  } else {
+    render_system->SetSubtreeColorMultiplier(e, multiplier);
+  }
+}
+
 void FadeSystem::FinishFadeIn(FadeComponent* fade, bool interrupted) {
   auto* dispatcher_system = registry_->Get<DispatcherSystem>();
   dispatcher_system->Send(fade->GetEntity(),
                           FadeInCompleteEvent(fade->GetEntity(), interrupted));
   fade->enable_animation_id = kNullAnimation;
   fade->enable_animation_connection.Disconnect();
+  if (!interrupted) {
+    ResetSubtreeAlpha(fade->GetEntity());
+  }
 }
 
 void FadeSystem::FinishFadeOut(FadeComponent* fade, bool interrupted) {
@@ -381,6 +456,7 @@ void FadeSystem::FinishFadeOut(FadeComponent* fade, bool interrupted) {
   if (!interrupted) {
     auto* transform_system = registry_->Get<TransformSystem>();
     transform_system->Disable(fade->GetEntity());
+    ResetSubtreeAlpha(fade->GetEntity());
   }
 }
 
@@ -99,6 +99,20 @@ class FadeSystem : public System {
   AnimationId AnimateFadeOut(const FadeComponent& comp, Entity e,
                              Clock::duration time);
 
+  // Fades |e| and all of its descendants in (or out) by animating the alpha of
+  // the subtree color multiplier on |e|, so that only a single value is
+  // updated each frame regardless of the size of the hierarchy.
+  AnimationId AnimateSubtreeFadeIn(const FadeComponent& comp, Entity e,
+                                   Clock::duration time);
+  AnimationId AnimateSubtreeFadeOut(const FadeComponent& comp, Entity e,
+                                    Clock::duration time);
+
+  // Sets the alpha of |e|'s subtree color multiplier.
+  void SetSubtreeAlpha(Entity e, float alpha);
+  // Restores the alpha of |e|'s subtree color multiplier to 1, removing the
+  // multiplier entirely if it no longer has any effect.
+  void ResetSubtreeAlpha(Entity e);
+
   void FinishFadeIn(FadeComponent* fade, bool interrupted);
   void FinishFadeOut(FadeComponent* fade, bool interrupted);
 
@@ -41,6 +41,27 @@ struct LayoutDirtyEvent {
 const lull::HashValue kLayoutDef = lull::Hash("LayoutDef");
 const lull::HashValue kLayoutElementDef = lull::Hash("LayoutElementDef");
 const lull::HashValue kRadialLayoutDef = lull::Hash("RadialLayoutDef");
+
+// The number of times a single layout may be processed by one ProcessDirty()
+// call.  Layouts that keep getting dirtied past this (e.g. a resize feedback
+// loop between a layout and its children) are deferred to the next dispatch.
+constexpr int kMaxPassesPerProcess = 4;
+
+bool AabbEquals(const lull::Aabb& lhs, const lull::Aabb& rhs) {
+  return lhs.min == rhs.min && lhs.max == rhs.max;
+}
+
+bool LayoutParamsEquals(const lull::LayoutParams& lhs,
+                        const lull::LayoutParams& rhs) {
+  return lhs.canvas_size == rhs.canvas_size && lhs.spacing == rhs.spacing &&
+         lhs.fill_order == rhs.fill_order &&
+         lhs.horizontal_alignment == rhs.horizontal_alignment &&
+         lhs.vertical_alignment == rhs.vertical_alignment &&
+         lhs.row_alignment == rhs.row_alignment &&
+         lhs.column_alignment == rhs.column_alignment &&
+         lhs.elements_per_wrap == rhs.elements_per_wrap &&
+         lhs.shrink_to_fit == rhs.shrink_to_fit;
+}
 }  // namespace
 LULLABY_SETUP_TYPEID(LayoutDirtyEvent);
 
@@ -289,6 +310,7 @@ void LayoutSystem::Create(Entity e, const LayoutParams& params) {
 
 void LayoutSystem::Destroy(Entity e) {
   layouts_.Destroy(e);
+  dirty_layouts_.erase(e);
   ignored_layout_elements_.erase(e);
   layout_elements_.erase(e);
 }
@@ -440,6 +462,11 @@ size_t LayoutSystem::GetInsertIndexForPosition(Entity entity,
 }
 
 void LayoutSystem::Layout(Entity e) {
+  // An explicit request always reapplies the layout, even if nothing changed.
+  LayoutComponent* layout = layouts_.Get(e);
+  if (layout) {
+    layout->last_inputs.reset();
+  }
   LayoutImpl(DirtyLayout(e, kOriginal));
 }
 
@@ -553,6 +580,35 @@ void LayoutSystem::LayoutImpl(const DirtyLayout& dirty_layout) {
         params.canvas_size.y = *y;
       }
     }
+
+    LayoutInputs inputs;
+    inputs.params = params;
+    inputs.set_actual_box = dirty_layout.ShouldSetActualBox();
+    inputs.desired_source = dirty_layout.GetChildrensDesiredSource();
+    inputs.actual_source = dirty_layout.GetActualSource();
+    inputs.elements.reserve(elements.size());
+    for (const LayoutElement& element : elements) {
+      LayoutInputs::ElementInputs element_inputs;
+      element_inputs.entity = element.entity;
+      element_inputs.horizontal_weight = element.horizontal_weight;
+      element_inputs.vertical_weight = element.vertical_weight;
+      const Aabb* original_box =
+          layout_box_system->GetOriginalBox(element.entity);
+      if (original_box) {
+        element_inputs.original_box = *original_box;
+      }
+      const Aabb* actual_box = layout_box_system->GetActualBox(element.entity);
+      if (actual_box) {
+        element_inputs.has_actual_box = true;
+        element_inputs.actual_box = *actual_box;
+      }
+      inputs.elements.emplace_back(element_inputs);
+    }
+    if (layout->last_inputs && *layout->last_inputs == inputs) {
+      return;
+    }
+    layout->last_inputs = std::move(inputs);
+
     const auto set_pos_fn = [this](Entity entity, const mathfu::vec2& pos) {
       SetLayoutPosition(entity, pos);
     };
@@ -576,6 +632,29 @@ void LayoutSystem::LayoutImpl(const DirtyLayout& dirty_layout) {
   SendEvent(registry_, e, LayoutChangedEvent(e));
 }
 
+bool LayoutSystem::LayoutInputs::operator==(const LayoutInputs& rhs) const {
+  if (!LayoutParamsEquals(params, rhs.params) ||
+      set_actual_box != rhs.set_actual_box ||
+      desired_source != rhs.desired_source ||
+      actual_source != rhs.actual_source ||
+      elements.size() != rhs.elements.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < elements.size(); ++i) {
+    const ElementInputs& lhs_element = elements[i];
+    const ElementInputs& rhs_element = rhs.elements[i];
+    if (lhs_element.entity != rhs_element.entity ||
+        lhs_element.horizontal_weight != rhs_element.horizontal_weight ||
+        lhs_element.vertical_weight != rhs_element.vertical_weight ||
+        !AabbEquals(lhs_element.original_box, rhs_element.original_box) ||
+        lhs_element.has_actual_box != rhs_element.has_actual_box ||
+        !AabbEquals(lhs_element.actual_box, rhs_element.actual_box)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 LayoutElement& LayoutSystem::GetLayoutElement(Entity e) {
   // Create a default element (weights = 0) if it doesn't exist yet, or get the
   // current one.
@@ -588,25 +667,68 @@ LayoutElement& LayoutSystem::GetLayoutElement(Entity e) {
 }
 
 void LayoutSystem::ProcessDirty() {
-  // Copy dirty layouts in case the Dispatcher is not Queued.
-  std::unordered_map<Entity, DirtyLayout> dirty_layouts_copy;
-  using std::swap;
-  swap(dirty_layouts_copy, dirty_layouts_);
-  for (const auto& pair : dirty_layouts_copy) {
-    LayoutImpl(pair.second);
+  // With a non-Queued Dispatcher, processing a layout can synchronously trigger
+  // another LayoutDirtyEvent.  Layouts dirtied meanwhile are added to
+  // |dirty_queue_| and handled by the outer call instead.
+  if (processing_dirty_) {
+    return;
+  }
+  processing_dirty_ = true;
+
+  for (const auto& pair : dirty_layouts_) {
+    dirty_queue_.emplace(GetDepth(pair.first), pair.first);
+  }
+
+  std::unordered_map<Entity, int> num_passes;
+  while (!dirty_queue_.empty()) {
+    const Entity e = dirty_queue_.top().second;
+    dirty_queue_.pop();
+
+    auto iter = dirty_layouts_.find(e);
+    if (iter == dirty_layouts_.end()) {
+      continue;
+    }
+    // Leave layouts that exceeded their budget in |dirty_layouts_| so that
+    // further changes keep aggregating into them until the next dispatch.
+    if (++num_passes[e] > kMaxPassesPerProcess) {
+      continue;
+    }
+    // Remove the layout before processing it in case it dirties itself.
+    const DirtyLayout dirty_layout = iter->second;
+    dirty_layouts_.erase(iter);
+    LayoutImpl(dirty_layout);
+  }
+
+  processing_dirty_ = false;
+  if (!dirty_layouts_.empty()) {
+    Dispatcher* dispatcher = registry_->Get<Dispatcher>();
+    dispatcher->Send(LayoutDirtyEvent());
   }
 }
 
+int LayoutSystem::GetDepth(Entity e) const {
+  const auto* transform_system = registry_->Get<TransformSystem>();
+  int depth = 0;
+  for (Entity parent = transform_system->GetParent(e); parent != kNullEntity;
+       parent = transform_system->GetParent(parent)) {
+    ++depth;
+  }
+  return depth;
+}
+
 void LayoutSystem::SetDirty(Entity e, LayoutPass pass, Entity source) {
   const bool was_clean = dirty_layouts_.empty();
   // Insert this before sending event in case the Dispatcher is not Queued.
   auto iter = dirty_layouts_.find(e);
   if (iter == dirty_layouts_.end()) {
     dirty_layouts_.emplace(e, DirtyLayout(e, pass, source));
+    if (processing_dirty_) {
+      dirty_queue_.emplace(GetDepth(e), e);
+    }
   } else {
     iter->second.Update(registry_, pass, source);
   }
-  if (was_clean) {
+  if (was_clean && !processing_dirty_) {
     Dispatcher* dispatcher = registry_->Get<Dispatcher>();
     dispatcher->Send(LayoutDirtyEvent());
   }
@@ -20,6 +20,8 @@ limitations under the License.
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "lullaby/generated/layout_def_generated.h"
 #include "lullaby/events/entity_events.h"
@@ -28,6 +30,8 @@ limitations under the License.
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/modules/layout/layout.h"
 #include "lullaby/util/clock.h"
+#include "lullaby/util/math.h"
+#include "lullaby/util/optional.h"
 
 namespace lull {
 
@@ -84,6 +88,29 @@ class LayoutSystem : public System {
   void SetElementIgnored(Entity element, bool ignored);
 
  private:
+  // Everything ApplyLayout() reads for a layout.  If these are unchanged since
+  // the layout's previous pass, the result would be identical so the pass is
+  // skipped.
+  struct LayoutInputs {
+    struct ElementInputs {
+      Entity entity = kNullEntity;
+      float horizontal_weight = 0.f;
+      float vertical_weight = 0.f;
+      Aabb original_box;
+      bool has_actual_box = false;
+      Aabb actual_box;
+    };
+
+    bool operator==(const LayoutInputs& rhs) const;
+    bool operator!=(const LayoutInputs& rhs) const { return !(*this == rhs); }
+
+    LayoutParams params;
+    bool set_actual_box = false;
+    Entity desired_source = kNullEntity;
+    Entity actual_source = kNullEntity;
+    std::vector<ElementInputs> elements;
+  };
+
   struct LayoutComponent : Component {
     explicit LayoutComponent(Entity e);
     std::unique_ptr<LayoutParams> layout = nullptr;
@@ -94,6 +121,7 @@ class LayoutSystem : public System {
     std::queue<Entity> empty_placeholders;
     SetLayoutPositionFn set_pos_fn;
     CachedPositions cached_positions;
+    Optional<LayoutInputs> last_inputs;
   };
 
   // The processing done by the LayoutSystem is catagorized into different
@@ -161,6 +189,7 @@ class LayoutSystem : public System {
   void LayoutImpl(const DirtyLayout& dirty_layout);
   LayoutElement& GetLayoutElement(Entity e);
   void ProcessDirty();
+  int GetDepth(Entity e) const;
   void SetDirty(Entity e, LayoutPass pass, Entity source = kNullEntity);
   void SetParentDirty(Entity e, LayoutPass pass, Entity source = kNullEntity);
 
@@ -181,6 +210,11 @@ class LayoutSystem : public System {
   std::unordered_map<Entity, LayoutElement> layout_elements_;
   std::unordered_map<Entity, DirtyLayout> dirty_layouts_;
 
+  // Dirty layouts ordered by their depth in the scene graph, deepest first, so
+  // that nested layouts settle before the layouts that contain them.
+  std::priority_queue<std::pair<int, Entity>> dirty_queue_;
+  bool processing_dirty_ = false;
+
   LayoutSystem(const LayoutSystem&) = delete;
   LayoutSystem& operator=(const LayoutSystem&) = delete;
 };
@@ -0,0 +1,293 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/contrib/scroll/scroll_virtual_list_system.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "lullaby/generated/scroll_def_generated.h"
+#include "lullaby/contrib/scroll/scroll_system.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/logging.h"
+#include "lullaby/util/trace.h"
+
+namespace lull {
+namespace {
+
+const HashValue kScrollVirtualListDefHash = ConstHash("ScrollVirtualListDef");
+
+}  // namespace
+
+ScrollVirtualListSystem::ScrollVirtualListSystem(Registry* registry)
+    : System(registry), lists_(4) {
+  RegisterDef<ScrollVirtualListDefT>(this);
+  RegisterDependency<ScrollSystem>(this);
+  RegisterDependency<TransformSystem>(this);
+}
+
+void ScrollVirtualListSystem::Create(Entity entity, HashValue type,
+                                     const Def* def) {
+  if (type != kScrollVirtualListDefHash) {
+    LOG(DFATAL)
+        << "Invalid type passed to Create. Expecting ScrollVirtualListDef!";
+    return;
+  }
+  const auto* data = ConvertDef<ScrollVirtualListDef>(def);
+  if (data->row_size() <= 0.f) {
+    LOG(DFATAL) << "ScrollVirtualListDef requires a positive row_size.";
+    return;
+  }
+
+  VirtualList* list = lists_.Emplace(entity);
+  list->row_size = data->row_size();
+  list->view_size = data->view_size();
+  list->margin_rows = static_cast<size_t>(std::max(data->margin_rows(), 0));
+  list->horizontal = data->horizontal();
+  list->num_rows = static_cast<size_t>(std::max(data->num_rows(), 0));
+  if (data->row_blueprint()) {
+    list->row_blueprint = data->row_blueprint()->str();
+  }
+}
+
+void ScrollVirtualListSystem::PostCreateInit(Entity entity, HashValue type,
+                                             const Def* def) {
+  VirtualList* list = lists_.Get(entity);
+  if (list) {
+    UpdateContentBounds(*list);
+    UpdateRows(list, true);
+  }
+}
+
+void ScrollVirtualListSystem::Destroy(Entity entity) {
+  // The rows and pooled rows are children of the list entity and are destroyed
+  // along with it.
+  lists_.Destroy(entity);
+}
+
+void ScrollVirtualListSystem::AdvanceFrame(Clock::duration delta_time) {
+  LULLABY_CPU_TRACE_CALL();
+  const auto* scroll_system = registry_->Get<ScrollSystem>();
+  lists_.ForEach([this, scroll_system](VirtualList& list) {
+    const mathfu::vec2 offset = scroll_system->GetViewOffset(list.GetEntity());
+    if (offset.x != list.view_offset.x || offset.y != list.view_offset.y) {
+      UpdateRows(&list, false);
+    }
+  });
+}
+
+void ScrollVirtualListSystem::SetNumRows(Entity entity, size_t num_rows) {
+  VirtualList* list = lists_.Get(entity);
+  if (list) {
+    list->num_rows = num_rows;
+    UpdateContentBounds(*list);
+    UpdateRows(list, true);
+  }
+}
+
+size_t ScrollVirtualListSystem::GetNumRows(Entity entity) const {
+  const VirtualList* list = lists_.Get(entity);
+  return list ? list->num_rows : 0;
+}
+
+void ScrollVirtualListSystem::RebindRows(Entity entity) {
+  VirtualList* list = lists_.Get(entity);
+  if (list) {
+    UpdateRows(list, true);
+  }
+}
+
+void ScrollVirtualListSystem::SetBindRowFn(Entity entity, BindRowFn fn) {
+  VirtualList* list = lists_.Get(entity);
+  if (list) {
+    list->bind_row_fn = std::move(fn);
+    UpdateRows(list, true);
+  }
+}
+
+void ScrollVirtualListSystem::SetRowBlueprintFn(Entity entity,
+                                                RowBlueprintFn fn) {
+  VirtualList* list = lists_.Get(entity);
+  if (list) {
+    list->row_blueprint_fn = std::move(fn);
+    UpdateRows(list, true);
+  }
+}
+
+Entity ScrollVirtualListSystem::GetRowEntity(Entity entity,
+                                             size_t index) const {
+  const VirtualList* list = lists_.Get(entity);
+  if (!list || index < list->first_row || index >= list->end_row) {
+    return kNullEntity;
+  }
+  return list->rows[index - list->first_row];
+}
+
+size_t ScrollVirtualListSystem::GetIndexForPosition(
+    Entity entity, const mathfu::vec3& local_position) const {
+  const VirtualList* list = lists_.Get(entity);
+  if (!list || list->num_rows == 0) {
+    return 0;
+  }
+  // Undo the view offset that the ScrollSystem applies to all children to get
+  // back to content space.
+  const auto* scroll_system = registry_->Get<ScrollSystem>();
+  const mathfu::vec2 offset = scroll_system->GetViewOffset(entity);
+  const mathfu::vec2 content_position = local_position.xy() + offset;
+  const float distance =
+      list->horizontal ? content_position.x : -content_position.y;
+  if (distance <= 0.f) {
+    return 0;
+  }
+  const size_t index = static_cast<size_t>(distance / list->row_size);
+  return std::min(index, list->num_rows - 1);
+}
+
+float ScrollVirtualListSystem::GetScrollDistance(
+    const VirtualList& list, const mathfu::vec2& view_offset) const {
+  return list.horizontal ? view_offset.x : -view_offset.y;
+}
+
+void ScrollVirtualListSystem::UpdateContentBounds(const VirtualList& list) {
+  const float content_size = static_cast<float>(list.num_rows) * list.row_size;
+  const float scroll_size = std::max(content_size - list.view_size, 0.f);
+  Aabb bounds;
+  if (list.horizontal) {
+    bounds.max.x = scroll_size;
+  } else {
+    bounds.min.y = -scroll_size;
+  }
+  auto* scroll_system = registry_->Get<ScrollSystem>();
+  scroll_system->SetContentBounds(list.GetEntity(), bounds);
+}
+
+void ScrollVirtualListSystem::UpdateRows(VirtualList* list, bool rebind) {
+  const auto* scroll_system = registry_->Get<ScrollSystem>();
+  list->view_offset = scroll_system->GetViewOffset(list->GetEntity());
+
+  // Find the rows overlapping the viewport, then grow the range by the margin
+  // so that rows are ready before they scroll into view.
+  size_t first_row = 0;
+  size_t end_row = 0;
+  if (list->num_rows > 0) {
+    const float distance =
+        std::max(GetScrollDistance(*list, list->view_offset), 0.f);
+    const size_t first_visible =
+        static_cast<size_t>(std::floor(distance / list->row_size));
+    const size_t end_visible = static_cast<size_t>(
+        std::ceil((distance + list->view_size) / list->row_size));
+    first_row = first_visible > list->margin_rows
+                    ? first_visible - list->margin_rows
+                    : 0;
+    end_row = std::min(end_visible + list->margin_rows, list->num_rows);
+    first_row = std::min(first_row, end_row);
+  }
+
+  std::vector<Entity> rows(end_row - first_row, kNullEntity);
+  std::vector<std::string> row_blueprints(rows.size());
+
+  // Keep the rows that are still in range and release the rest first, so that
+  // they can be reused for the rows that are entering the range.
+  for (size_t i = 0; i < list->rows.size(); ++i) {
+    const size_t index = list->first_row + i;
+    const Entity row = list->rows[i];
+    std::string& blueprint = list->row_blueprints[i];
+    if (row == kNullEntity) {
+      continue;
+    }
+    const bool in_range = index >= first_row && index < end_row;
+    const bool same_type =
+        !rebind || !list->row_blueprint_fn ||
+        list->row_blueprint_fn(index) == blueprint;
+    if (in_range && same_type) {
+      rows[index - first_row] = row;
+      row_blueprints[index - first_row] = std::move(blueprint);
+    } else {
+      ReleaseRow(list, row, std::move(blueprint));
+    }
+  }
+
+  for (size_t i = 0; i < rows.size(); ++i) {
+    const size_t index = first_row + i;
+    const bool is_new = rows[i] == kNullEntity;
+    if (is_new) {
+      rows[i] = AcquireRow(list, index, &row_blueprints[i]);
+      if (rows[i] == kNullEntity) {
+        continue;
+      }
+    }
+    PositionRow(*list, rows[i], index);
+    if ((is_new || rebind) && list->bind_row_fn) {
+      list->bind_row_fn(rows[i], index);
+    }
+  }
+
+  list->first_row = first_row;
+  list->end_row = end_row;
+  list->rows = std::move(rows);
+  list->row_blueprints = std::move(row_blueprints);
+}
+
+Entity ScrollVirtualListSystem::AcquireRow(VirtualList* list, size_t index,
+                                           std::string* blueprint) {
+  *blueprint = list->row_blueprint_fn ? list->row_blueprint_fn(index)
+                                      : list->row_blueprint;
+  if (blueprint->empty()) {
+    LOG(DFATAL) << "No blueprint for row " << index << " of virtual list "
+                << list->GetEntity();
+    return kNullEntity;
+  }
+
+  auto* transform_system = registry_->Get<TransformSystem>();
+  auto iter = list->pool.find(*blueprint);
+  if (iter != list->pool.end() && !iter->second.empty()) {
+    const Entity row = iter->second.back();
+    iter->second.pop_back();
+    transform_system->Enable(row);
+    return row;
+  }
+
+  const Entity row =
+      transform_system->CreateChild(list->GetEntity(), *blueprint);
+  if (row == kNullEntity) {
+    LOG(WARNING) << "Could not create row from blueprint: " << *blueprint;
+  }
+  return row;
+}
+
+void ScrollVirtualListSystem::ReleaseRow(VirtualList* list, Entity row,
+                                         std::string blueprint) {
+  auto* transform_system = registry_->Get<TransformSystem>();
+  transform_system->Disable(row);
+  list->pool[std::move(blueprint)].push_back(row);
+}
+
+void ScrollVirtualListSystem::PositionRow(const VirtualList& list, Entity row,
+                                          size_t index) {
+  // Rows are placed at their position in content space less the current view
+  // offset, matching the translation the ScrollSystem applies to all children.
+  auto* transform_system = registry_->Get<TransformSystem>();
+  const float center = (static_cast<float>(index) + 0.5f) * list.row_size;
+  mathfu::vec3 translation = transform_system->GetLocalTranslation(row);
+  if (list.horizontal) {
+    translation.x = center - list.view_offset.x;
+  } else {
+    translation.y = -center - list.view_offset.y;
+  }
+  transform_system->SetLocalTranslation(row, translation);
+}
+
+}  // namespace lull
@@ -0,0 +1,127 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_SCROLL_SCROLL_VIRTUAL_LIST_SYSTEM_H_
+#define LULLABY_SYSTEMS_SCROLL_SCROLL_VIRTUAL_LIST_SYSTEM_H_
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lullaby/modules/ecs/component.h"
+#include "lullaby/modules/ecs/system.h"
+#include "lullaby/util/clock.h"
+#include "lullaby/util/math.h"
+
+namespace lull {
+
+// Extends the ScrollSystem with virtualized lists: a scroll view that presents
+// a large number of equally sized rows while only instantiating the rows that
+// are within the viewport (plus a margin).  As the view scrolls, rows that
+// leave the margin are disabled and returned to a pool keyed by their
+// blueprint, and rows that enter it are taken from that pool (or created) and
+// rebound to their new index.
+//
+// Rows are stacked top-down starting at the scroll entity's origin, or
+// left-to-right if the list is horizontal.  The content bounds of the scroll
+// view are updated automatically from the number of rows, so this should not
+// be combined with the ScrollContentLayoutSystem on the same entity.
+class ScrollVirtualListSystem : public System {
+ public:
+  // Called whenever |row| is (re)assigned to present the row at |index|.
+  using BindRowFn = std::function<void(Entity row, size_t index)>;
+
+  // Returns the name of the blueprint used to create the row at |index|.  Rows
+  // created from different blueprints are pooled separately.
+  using RowBlueprintFn = std::function<std::string(size_t index)>;
+
+  explicit ScrollVirtualListSystem(Registry* registry);
+
+  void Create(Entity entity, HashValue type, const Def* def) override;
+  void PostCreateInit(Entity entity, HashValue type, const Def* def) override;
+  void Destroy(Entity entity) override;
+
+  // Creates or recycles rows for any list whose view offset has changed.  This
+  // should be called after ScrollSystem::AdvanceFrame().
+  void AdvanceFrame(Clock::duration delta_time);
+
+  // Sets the number of rows in the list, rebinding all visible rows.
+  void SetNumRows(Entity entity, size_t num_rows);
+  size_t GetNumRows(Entity entity) const;
+
+  // Rebinds all visible rows, e.g. after the data backing the list changed.
+  void RebindRows(Entity entity);
+
+  void SetBindRowFn(Entity entity, BindRowFn fn);
+  void SetRowBlueprintFn(Entity entity, RowBlueprintFn fn);
+
+  // Returns the row entity currently presenting |index|, or kNullEntity if
+  // that row is not instantiated.
+  Entity GetRowEntity(Entity entity, size_t index) const;
+
+  // Returns the index of the row that a point at |local_position| (relative to
+  // the list entity, including the view offset) falls into.
+  size_t GetIndexForPosition(Entity entity,
+                             const mathfu::vec3& local_position) const;
+
+ private:
+  struct VirtualList : Component {
+    explicit VirtualList(Entity entity) : Component(entity) {}
+
+    float row_size = 0.f;
+    float view_size = 0.f;
+    size_t margin_rows = 1;
+    bool horizontal = false;
+    std::string row_blueprint;
+    size_t num_rows = 0;
+    BindRowFn bind_row_fn;
+    RowBlueprintFn row_blueprint_fn;
+
+    // The half-open range of row indices that are currently instantiated.
+    size_t first_row = 0;
+    size_t end_row = 0;
+    // Instantiated rows, indexed by |row index - first_row|.
+    std::vector<Entity> rows;
+    // The blueprint each row in |rows| was created from.
+    std::vector<std::string> row_blueprints;
+    // Disabled rows available for reuse, keyed by blueprint name.
+    std::unordered_map<std::string, std::vector<Entity>> pool;
+    mathfu::vec2 view_offset = mathfu::kZeros2f;
+  };
+
+  using VirtualListPool = ComponentPool<VirtualList>;
+
+  // Returns the distance the view has scrolled from the start of the list.
+  float GetScrollDistance(const VirtualList& list,
+                          const mathfu::vec2& view_offset) const;
+  void UpdateContentBounds(const VirtualList& list);
+  void UpdateRows(VirtualList* list, bool rebind);
+  Entity AcquireRow(VirtualList* list, size_t index, std::string* blueprint);
+  void ReleaseRow(VirtualList* list, Entity row, std::string blueprint);
+  void PositionRow(const VirtualList& list, Entity row, size_t index);
+
+  VirtualListPool lists_;
+
+  ScrollVirtualListSystem(const ScrollVirtualListSystem&) = delete;
+  ScrollVirtualListSystem& operator=(const ScrollVirtualListSystem&) = delete;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::ScrollVirtualListSystem);
+
+#endif  // LULLABY_SYSTEMS_SCROLL_SCROLL_VIRTUAL_LIST_SYSTEM_H_
@@ -154,8 +154,11 @@ bool EditText::Backspace() {
 }
 
 bool EditText::Insert(const char* utf8_cstr) {
-  std::string old = text_.str();
+  // Only a replaced selection can leave the text unchanged, so avoid copying
+  // the text for plain insertions.
+  std::string old;
   if (HasSelectionRegion()) {
+    old = text_.str();
     const size_t delete_len = selection_end_index_ - selection_start_index_;
     text_.DeleteChars(selection_start_index_, delete_len);
 
@@ -173,7 +176,7 @@ bool EditText::Insert(const char* utf8_cstr) {
 
   SetCaretPosition(selection_start_index_ + added);
 
-  return old != text_.str();
+  return old.empty() ? added > 0 : old != text_.str();
 }
 
 bool EditText::Insert(const std::string& utf8_str) {
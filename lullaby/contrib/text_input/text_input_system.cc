@@ -210,17 +210,19 @@ void TextInputSystem::AdvanceFrame(const Clock::duration& delta_time) {
     auto keys = input_manager->GetPressedKeys(InputManager::kKeyboard);
     bool text_changed = false;
     for (const std::string& key : keys) {
+      // Apply all the keys pressed this frame before updating the text, so the
+      // text is only laid out once.
       if (key == InputManager::kKeyBackspace) {
-        text_changed = input->text.Backspace();
+        text_changed |= input->text.Backspace();
       } else if (key == InputManager::kKeyReturn) {
         input->text.ClearComposingRegion();
         AcceptText(active_input_);
       } else {
-        text_changed = input->text.Insert(key);
+        text_changed |= input->text.Insert(key);
       }
     }
 
-    if (!keys.empty() && text_changed) {
+    if (text_changed) {
       UpdateText(active_input_);
     }
   }
@@ -646,8 +648,9 @@ void TextInputSystem::Insert(const char* utf8_cstr) {
   if (!input) {
     return;
   }
-  input->text.Insert(utf8_cstr);
-  UpdateText(active_input_);
+  if (input->text.Insert(utf8_cstr)) {
+    UpdateText(active_input_);
+  }
 }
 
 void TextInputSystem::Insert(const std::string& utf8_str) {
@@ -157,6 +157,34 @@ struct MeshChangedEvent {
   HashValue pass = 0;
 };
 
+/// Dispatched at the end of a frame when an entity passes the RenderSystem's
+/// culling after having been culled (or not drawn) in the previous frame.
+struct EnteredViewEvent {
+  EnteredViewEvent() {}
+  explicit EnteredViewEvent(Entity entity) : entity(entity) {}
+
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(&entity, ConstHash("entity"));
+  }
+
+  Entity entity = kNullEntity;
+};
+
+/// Dispatched at the end of a frame when an entity that was drawn in the
+/// previous frame is culled (or not drawn).
+struct ExitedViewEvent {
+  ExitedViewEvent() {}
+  explicit ExitedViewEvent(Entity entity) : entity(entity) {}
+
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(&entity, ConstHash("entity"));
+  }
+
+  Entity entity = kNullEntity;
+};
+
 /// Sets the native window for the RenderSystem. As of 8/2018, only
 /// Filament uses this, which is required to initialize its GL context. Also, it
 /// needs to be resent every time a new window is created, for example on
@@ -188,6 +216,8 @@ LULLABY_SETUP_TYPEID(lull::ShowEvent);
 LULLABY_SETUP_TYPEID(lull::SetRenderGroupIdEvent);
 LULLABY_SETUP_TYPEID(lull::SetRenderGroupParamsEvent);
 LULLABY_SETUP_TYPEID(lull::MeshChangedEvent);
+LULLABY_SETUP_TYPEID(lull::EnteredViewEvent);
+LULLABY_SETUP_TYPEID(lull::ExitedViewEvent);
 LULLABY_SETUP_TYPEID(lull::SetNativeWindowEvent);
 
 #endif  // LULLABY_EVENTS_RENDER_EVENTS_H_
@@ -65,6 +65,9 @@ void ExampleApp::Update() {
   // some systems might not like a delta_time of 0.
   if (last_frame_time_ != Clock::time_point()) {
     Clock::duration delta_time = timestamp - last_frame_time_;
+    if (config_.fixed_delta_time != Clock::duration::zero()) {
+      delta_time = config_.fixed_delta_time;
+    }
     const auto* global_config = registry_->Get<lull::Config>();
     if (global_config) {
       if (global_config->Get(kScreenshotTestHash, false)) {
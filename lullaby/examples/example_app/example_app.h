@@ -51,6 +51,12 @@ class ExampleApp {
     float far_clip_plane = 100.f;
     bool enable_hmd = true;
     bool enable_controller = true;
+    // If true, the window is never shown.  The app is expected to render into
+    // its own render targets, eg. for automated benchmarks.
+    bool headless = false;
+    // If non-zero, every frame is advanced by this amount rather than by the
+    // wall clock time since the previous frame, so that runs are repeatable.
+    Clock::duration fixed_delta_time = Clock::duration::zero();
   };
 
   ExampleApp() : registry_(std::make_shared<Registry>()) {}
@@ -78,6 +84,10 @@ class ExampleApp {
   // Shutsdown the example once per frame (including the derived class).
   void Shutdown();
 
+  // Returns true once the app has nothing more to do, eg. a benchmark that has
+  // run all of its frames.  The platform exits once this returns true.
+  virtual bool IsFinished() const { return false; }
+
  protected:
   virtual void OnInitialize() {}
   virtual void OnAdvanceFrame(Clock::duration delta_time) {}
@@ -166,9 +166,13 @@ bool MainWindow::Init() {
   SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
 
   const ExampleApp::Config& config = app_->GetConfig();
+  Uint32 window_flags = SDL_WINDOW_OPENGL;
+  if (config.headless) {
+    window_flags |= SDL_WINDOW_HIDDEN;
+  }
   window_ = SDL_CreateWindow(config.title.c_str(), SDL_WINDOWPOS_UNDEFINED,
                              SDL_WINDOWPOS_UNDEFINED, config.width,
-                             config.height, SDL_WINDOW_OPENGL);
+                             config.height, window_flags);
 
   if (!window_) {
     Exit(1, "SDL_CreateWindow failed.");
@@ -230,6 +234,9 @@ void MainWindow::Update() {
     }
     if (app_) {
       app_->Update();
+      if (app_->IsFinished()) {
+        OnQuit();
+      }
     }
 #ifndef LULLABY_RENDER_BACKEND_FILAMENT
     SDL_GL_SwapWindow(window_);
@@ -377,6 +384,10 @@ int MainWindow::HandleEvent(void* userdata, SDL_Event* event) {
 }
 
 void MainWindow::SimulateHMDMovement() {
+  if (!hmd_) {
+    return;
+  }
+
   mathfu::vec2i xy(0);
   if (pressed_keys_[SDLK_z]) {
     xy.y += 1;
@@ -0,0 +1,358 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/examples/render_benchmark/src/render_benchmark.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+#include "lullaby/examples/render_benchmark/entity_generated.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/modules/render/render_view.h"
+#include "lullaby/systems/render/detail/profiler.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/render_target.h"
+#include "lullaby/systems/text/text_system.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/logging.h"
+#include "lullaby/util/math.h"
+#include "lullaby/util/time.h"
+
+// Counts every heap allocation made through operator new so that the number of
+// allocations per frame can be reported.
+static std::atomic<size_t> g_num_allocations(0);
+
+void* operator new(size_t size) {
+  ++g_num_allocations;
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+LULLABY_EXAMPLE_APP(RenderBenchmark);
+
+namespace {
+
+constexpr const char* kOutputFile = "render_benchmark.json";
+
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+
+// Frames run before measuring each scene, so that asset loading and one-time
+// setup are not included in the results.
+constexpr int kWarmUpFrames = 60;
+constexpr int kMeasuredFrames = 600;
+
+constexpr lull::HashValue kRenderTarget = lull::ConstHash("RenderBenchmark");
+constexpr lull::HashValue kClearDisplayPass = lull::ConstHash("ClearDisplay");
+
+enum SceneType {
+  kQuadGrid,
+  kTextLabels,
+  kDeepHierarchies,
+  kWideHierarchies,
+  kNumScenes,
+};
+
+const char* const kSceneNames[kNumScenes] = {
+    "quad_grid_10k",
+    "text_labels_2k",
+    "hierarchies_depth64_width64",
+    "hierarchies_depth4_width1024",
+};
+
+// Writes |str| as a JSON string.  Step and scene names never need escaping.
+void WriteJsonString(std::ostream& os, const std::string& str) {
+  os << '"' << str << '"';
+}
+
+}  // namespace
+
+RenderBenchmark::RenderBenchmark() {
+  config_.title = "Render Benchmark";
+  config_.width = kWidth;
+  config_.height = kHeight;
+  config_.enable_hmd = false;
+  config_.enable_controller = false;
+  config_.headless = true;
+  config_.fixed_delta_time = lull::DurationFromSeconds(1.f / 60.f);
+}
+
+void RenderBenchmark::OnInitialize() {
+  auto* entity_factory = registry_->Get<lull::EntityFactory>();
+  entity_factory->CreateSystem<lull::RenderSystem>();
+  entity_factory->CreateSystem<lull::TextSystem>();
+  entity_factory->CreateSystem<lull::TransformSystem>();
+  entity_factory->Initialize<EntityDef, ComponentDef>(
+      GetEntityDef, EnumNamesComponentDefType());
+
+  // The profiler provides the GPU time and draw counts.
+  registry_->Create<lull::detail::Profiler>();
+
+  // Every pass is rendered into an offscreen target rather than the window.
+  auto* render_system = registry_->Get<lull::RenderSystem>();
+  lull::RenderTargetCreateParams params;
+  params.dimensions = mathfu::vec2i(kWidth, kHeight);
+  params.texture_format = lull::TextureFormat_RGBA8;
+  params.depth_stencil_format = lull::DepthStencilFormat_Depth24Stencil8;
+  render_system->CreateRenderTarget(kRenderTarget, params);
+  const lull::HashValue passes[] = {
+      kClearDisplayPass,
+      lull::RenderPass_Opaque,
+      lull::RenderPass_Main,
+      lull::RenderPass_OverDraw,
+  };
+  for (lull::HashValue pass : passes) {
+    render_system->SetRenderTarget(pass, kRenderTarget);
+  }
+  render_system->SetClearColor(0.f, 0.f, 0.f, 1.f);
+
+  BeginScene(0);
+}
+
+void RenderBenchmark::BeginScene(size_t index) {
+  scene_index_ = index;
+  frame_ = 0;
+  time_s_ = 0.f;
+
+  switch (index) {
+    case kQuadGrid:
+      CreateQuadGrid(10000);
+      break;
+    case kTextLabels:
+      CreateTextLabels(2000);
+      break;
+    case kDeepHierarchies:
+      CreateHierarchies(64, 64);
+      break;
+    case kWideHierarchies:
+      CreateHierarchies(4, 1024);
+      break;
+  }
+
+  results_.emplace_back();
+  results_.back().name = kSceneNames[index];
+  results_.back().num_entities = static_cast<int>(entities_.size());
+}
+
+void RenderBenchmark::EndScene() {
+  auto* entity_factory = registry_->Get<lull::EntityFactory>();
+  for (lull::Entity entity : entities_) {
+    entity_factory->Destroy(entity);
+  }
+  entities_.clear();
+  animated_.clear();
+}
+
+void RenderBenchmark::CreateQuadGrid(int count) {
+  auto* entity_factory = registry_->Get<lull::EntityFactory>();
+  auto* transform_system = registry_->Get<lull::TransformSystem>();
+
+  const int columns = static_cast<int>(std::ceil(std::sqrt(count)));
+  for (int i = 0; i < count; ++i) {
+    const lull::Entity entity = entity_factory->Create("quad");
+    const float x = 0.1f * static_cast<float>(i % columns - columns / 2);
+    const float y = 0.1f * static_cast<float>(i / columns - columns / 2);
+    transform_system->SetLocalTranslation(entity, mathfu::vec3(x, y, -10.f));
+    entities_.push_back(entity);
+    // Animate every tenth quad, as a UI would with a few active elements.
+    if (i % 10 == 0) {
+      animated_.push_back(entity);
+    }
+  }
+}
+
+void RenderBenchmark::CreateTextLabels(int count) {
+  auto* entity_factory = registry_->Get<lull::EntityFactory>();
+  auto* transform_system = registry_->Get<lull::TransformSystem>();
+  auto* text_system = registry_->Get<lull::TextSystem>();
+
+  const int columns = static_cast<int>(std::ceil(std::sqrt(count)));
+  for (int i = 0; i < count; ++i) {
+    const lull::Entity entity = entity_factory->Create("label");
+    const float x = 0.3f * static_cast<float>(i % columns - columns / 2);
+    const float y = 0.1f * static_cast<float>(i / columns - columns / 2);
+    transform_system->SetLocalTranslation(entity, mathfu::vec3(x, y, -8.f));
+    text_system->SetText(entity, "Label " + std::to_string(i));
+    entities_.push_back(entity);
+  }
+}
+
+void RenderBenchmark::CreateHierarchies(int depth, int width) {
+  auto* entity_factory = registry_->Get<lull::EntityFactory>();
+  auto* transform_system = registry_->Get<lull::TransformSystem>();
+
+  for (int i = 0; i < width; ++i) {
+    const lull::Entity root = entity_factory->Create("node");
+    const float x = 4.f * static_cast<float>(i) / static_cast<float>(width);
+    transform_system->SetLocalTranslation(root,
+                                          mathfu::vec3(x - 2.f, -1.f, -5.f));
+    entities_.push_back(root);
+    animated_.push_back(root);
+
+    lull::Entity parent = root;
+    for (int j = 1; j < depth; ++j) {
+      const lull::Entity child = entity_factory->Create("node");
+      transform_system->AddChild(parent, child);
+      entities_.push_back(child);
+      parent = child;
+    }
+  }
+}
+
+bool RenderBenchmark::IsMeasuring() const { return frame_ >= kWarmUpFrames; }
+
+void RenderBenchmark::RecordCpuTime(const char* step,
+                                    lull::Clock::time_point start) {
+  if (!IsMeasuring()) {
+    return;
+  }
+  const double ms = lull::MillisecondsFromDuration(lull::Clock::now() - start);
+  auto& cpu_ms = results_.back().cpu_ms;
+  for (auto& entry : cpu_ms) {
+    if (entry.first == step) {
+      entry.second += ms;
+      return;
+    }
+  }
+  cpu_ms.emplace_back(step, ms);
+}
+
+void RenderBenchmark::OnAdvanceFrame(lull::Clock::duration delta_time) {
+  frame_start_allocations_ = g_num_allocations;
+  time_s_ += lull::SecondsFromDuration(delta_time);
+
+  auto* transform_system = registry_->Get<lull::TransformSystem>();
+  auto* text_system = registry_->Get<lull::TextSystem>();
+  auto* render_system = registry_->Get<lull::RenderSystem>();
+
+  auto start = lull::Clock::now();
+  const mathfu::quat rotation =
+      mathfu::quat::FromAngleAxis(time_s_, mathfu::kAxisZ3f);
+  for (lull::Entity entity : animated_) {
+    const lull::Sqt* sqt = transform_system->GetSqt(entity);
+    if (sqt) {
+      lull::Sqt updated = *sqt;
+      updated.rotation = rotation;
+      transform_system->SetSqt(entity, updated);
+    }
+  }
+  RecordCpuTime("transform", start);
+
+  start = lull::Clock::now();
+  text_system->ProcessTasks();
+  RecordCpuTime("text", start);
+
+  start = lull::Clock::now();
+  render_system->ProcessTasks();
+  RecordCpuTime("render_process_tasks", start);
+
+  start = lull::Clock::now();
+  render_system->SubmitRenderData();
+  RecordCpuTime("render_submit", start);
+}
+
+void RenderBenchmark::OnRender(lull::Span<lull::RenderView> views) {
+  // There is no HMD in headless mode, so use a single fixed camera at the
+  // origin looking down -z.
+  const mathfu::recti viewport(mathfu::vec2i(0, 0),
+                               mathfu::vec2i(kWidth, kHeight));
+  const mathfu::mat4 clip_from_eye = lull::CalculatePerspectiveMatrixFromView(
+      60.f * mathfu::kDegreesToRadians,
+      static_cast<float>(kWidth) / static_cast<float>(kHeight),
+      lull::RenderView::kDefaultNearClipPlane,
+      lull::RenderView::kDefaultFarClipPlane);
+  lull::RenderView view;
+  lull::PopulateRenderView(&view, viewport, mathfu::mat4::Identity(),
+                           clip_from_eye, mathfu::rectf(), 0);
+
+  auto* render_system = registry_->Get<lull::RenderSystem>();
+  const auto start = lull::Clock::now();
+  render_system->BeginFrame();
+  render_system->BeginRendering();
+  render_system->Render(&view, 1, kClearDisplayPass);
+  render_system->Render(&view, 1);
+  render_system->EndRendering();
+  render_system->EndFrame();
+  RecordCpuTime("render", start);
+
+  if (IsMeasuring()) {
+    // GPU timings are read back a few frames late, so this is the GPU time of
+    // a recent frame of the same scene rather than this exact frame.
+    const auto* profiler = registry_->Get<lull::detail::Profiler>();
+    SceneStats& stats = results_.back();
+    stats.gpu_ms += profiler->GetGpuFrameMs();
+    stats.num_draws += profiler->GetNumDraws();
+    stats.num_allocations += g_num_allocations - frame_start_allocations_;
+    ++stats.num_frames;
+  }
+
+  ++frame_;
+  if (frame_ == kWarmUpFrames + kMeasuredFrames) {
+    EndScene();
+    if (scene_index_ + 1 < kNumScenes) {
+      BeginScene(scene_index_ + 1);
+    } else {
+      WriteResults();
+      finished_ = true;
+    }
+  }
+}
+
+void RenderBenchmark::WriteResults() const {
+  // All values are per-frame averages.
+  std::stringstream json;
+  json << "{\"scenes\":[";
+  for (size_t i = 0; i < results_.size(); ++i) {
+    const SceneStats& stats = results_[i];
+    const double frames = stats.num_frames > 0 ? stats.num_frames : 1;
+    json << (i > 0 ? "," : "") << "{\"name\":";
+    WriteJsonString(json, stats.name);
+    json << ",\"entities\":" << stats.num_entities
+         << ",\"frames\":" << stats.num_frames << ",\"cpu_ms\":{";
+    double total_ms = 0.0;
+    for (size_t j = 0; j < stats.cpu_ms.size(); ++j) {
+      json << (j > 0 ? "," : "");
+      WriteJsonString(json, stats.cpu_ms[j].first);
+      json << ":" << stats.cpu_ms[j].second / frames;
+      total_ms += stats.cpu_ms[j].second;
+    }
+    json << "},\"cpu_total_ms\":" << total_ms / frames
+         << ",\"gpu_ms\":" << stats.gpu_ms / frames
+         << ",\"draw_calls\":" << static_cast<double>(stats.num_draws) / frames
+         << ",\"allocations\":"
+         << static_cast<double>(stats.num_allocations) / frames << "}";
+  }
+  json << "]}";
+
+  LOG(INFO) << "RenderBenchmark " << json.str();
+  std::ofstream file(kOutputFile);
+  if (file) {
+    file << json.str() << std::endl;
+  } else {
+    LOG(ERROR) << "Could not write " << kOutputFile;
+  }
+}
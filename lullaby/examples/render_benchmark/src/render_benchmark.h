@@ -0,0 +1,92 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_EXAMPLES_RENDER_BENCHMARK_SRC_RENDER_BENCHMARK_H_
+#define LULLABY_EXAMPLES_RENDER_BENCHMARK_SRC_RENDER_BENCHMARK_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lullaby/examples/example_app/example_app.h"
+#include "lullaby/modules/ecs/entity.h"
+
+// Measures the end-to-end frame cost of a series of generated stress scenes.
+//
+// The app runs headless: each scene is rendered into an offscreen render
+// target for a fixed number of frames using a fixed timestep.  Once all scenes
+// have run, the per-scene CPU time of each step of the frame, GPU time, draw
+// count and heap allocation count are written as JSON to
+// render_benchmark.json in the working directory (and logged), and the app
+// exits.
+class RenderBenchmark : public lull::ExampleApp {
+ public:
+  RenderBenchmark();
+
+  bool IsFinished() const override { return finished_; }
+
+ protected:
+  void OnInitialize() override;
+  void OnAdvanceFrame(lull::Clock::duration delta_time) override;
+  void OnRender(lull::Span<lull::RenderView> views) override;
+
+ private:
+  // The measurements of a single scene, totalled over its measured frames.
+  struct SceneStats {
+    std::string name;
+    int num_entities = 0;
+    int num_frames = 0;
+    // The CPU time in milliseconds of each step of the frame, in the order the
+    // steps run.
+    std::vector<std::pair<std::string, double>> cpu_ms;
+    double gpu_ms = 0.0;
+    long long num_draws = 0;
+    long long num_allocations = 0;
+  };
+
+  // Creates the entities of the |index|-th scene.
+  void BeginScene(size_t index);
+
+  // Destroys the entities of the current scene.
+  void EndScene();
+
+  // Scene builders.  Entities that are animated each frame are added to
+  // |animated_|.
+  void CreateQuadGrid(int count);
+  void CreateTextLabels(int count);
+  void CreateHierarchies(int depth, int width);
+
+  // Adds the time since |start| to |step| of the current scene, if the current
+  // frame is being measured.
+  void RecordCpuTime(const char* step, lull::Clock::time_point start);
+
+  // Returns true if the current frame is being measured (ie. it is not a
+  // warm-up frame).
+  bool IsMeasuring() const;
+
+  void WriteResults() const;
+
+  std::vector<lull::Entity> entities_;
+  std::vector<lull::Entity> animated_;
+  std::vector<SceneStats> results_;
+  size_t scene_index_ = 0;
+  int frame_ = 0;
+  float time_s_ = 0.f;
+  size_t frame_start_allocations_ = 0;
+  bool finished_ = false;
+};
+
+#endif  // LULLABY_EXAMPLES_RENDER_BENCHMARK_SRC_RENDER_BENCHMARK_H_
@@ -18,7 +18,6 @@ limitations under the License.
 
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/systems/animation/animation_system.h"
-#include "lullaby/systems/render/render_helpers.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/color.h"
@@ -220,7 +219,6 @@ void AlphaDescendantsChannel::Set(Entity e, const float* values, size_t len) {
 RgbMultiplierDescendantsChannel::RgbMultiplierDescendantsChannel(
     Registry* registry, size_t pool_size)
     : AnimationChannel(registry, 3, pool_size),
-      registry_(registry),
       render_system_(registry->Get<RenderSystem>()) {}
 
 void RgbMultiplierDescendantsChannel::Setup(Registry* registry,
@@ -238,37 +236,29 @@ void RgbMultiplierDescendantsChannel::Setup(Registry* registry,
 
 bool RgbMultiplierDescendantsChannel::Get(Entity e, float* values,
                                           size_t len) const {
-  mathfu::vec4 color = mathfu::kOnes4f;
-  render_system_->GetColor(e, &color);
-  mathfu::vec4 default_color = render_system_->GetDefaultColor(e);
-
-  values[0] = default_color[0] > 0.f ? (color[0] / default_color[0]) : 0.f;
-  values[1] = default_color[1] > 0.f ? (color[1] / default_color[1]) : 0.f;
-  values[2] = default_color[2] > 0.f ? (color[2] / default_color[2]) : 0.f;
+  mathfu::vec4 multiplier = mathfu::kOnes4f;
+  render_system_->GetSubtreeColorMultiplier(e, &multiplier);
+  values[0] = multiplier[0];
+  values[1] = multiplier[1];
+  values[2] = multiplier[2];
   return true;
 }
 
 void RgbMultiplierDescendantsChannel::Set(Entity e, const float* values,
                                           size_t len) {
-  auto fn = [this, values](Entity child) {
-    mathfu::vec4 color;
-    const bool use_default = !render_system_->GetColor(child, &color);
-    const mathfu::vec4 default_color = render_system_->GetDefaultColor(child);
-    color[0] = default_color[0] * values[0];
-    color[1] = default_color[1] * values[1];
-    color[2] = default_color[2] * values[2];
-    color[3] = use_default ? default_color[3] : color[3];
-    render_system_->SetColor(child, color);
-  };
-
-  auto* transform_system = registry_->Get<TransformSystem>();
-  transform_system->ForAllDescendants(e, fn);
+  // The multiplier is inherited by all descendants when they are drawn, so a
+  // single write covers the whole subtree.
+  mathfu::vec4 multiplier = mathfu::kOnes4f;
+  render_system_->GetSubtreeColorMultiplier(e, &multiplier);
+  multiplier[0] = values[0];
+  multiplier[1] = values[1];
+  multiplier[2] = values[2];
+  render_system_->SetSubtreeColorMultiplier(e, multiplier);
 }
 
 AlphaMultiplierDescendantsChannel::AlphaMultiplierDescendantsChannel(
     Registry* registry, size_t pool_size)
     : AnimationChannel(registry, 1, pool_size),
-      registry_(registry),
       render_system_(registry->Get<RenderSystem>()) {}
 
 void AlphaMultiplierDescendantsChannel::Setup(Registry* registry,
@@ -286,10 +276,9 @@ void AlphaMultiplierDescendantsChannel::Setup(Registry* registry,
 
 bool AlphaMultiplierDescendantsChannel::Get(Entity e, float* values,
                                             size_t len) const {
-  mathfu::vec4 color = mathfu::kOnes4f;
-  render_system_->GetColor(e, &color);
-  mathfu::vec4 default_color = render_system_->GetDefaultColor(e);
-  values[0] = default_color[3] > 0.f ? (color[3] / default_color[3]) : 0.f;
+  mathfu::vec4 multiplier = mathfu::kOnes4f;
+  render_system_->GetSubtreeColorMultiplier(e, &multiplier);
+  values[0] = multiplier[3];
   return true;
 }
 
@@ -299,8 +288,12 @@ void AlphaMultiplierDescendantsChannel::Set(Entity e, const float* values,
     LOG(DFATAL) << "Must have 1 value for AlphaMultiplierDescendantsChannel!";
     return;
   }
-  auto* transform_system = registry_->Get<TransformSystem>();
-  SetAlphaMultiplierDescendants(e, values[0], transform_system, render_system_);
+  // The multiplier is inherited by all descendants when they are drawn, so a
+  // single write covers the whole subtree.
+  mathfu::vec4 multiplier = mathfu::kOnes4f;
+  render_system_->GetSubtreeColorMultiplier(e, &multiplier);
+  multiplier[3] = values[0];
+  render_system_->SetSubtreeColorMultiplier(e, multiplier);
 }
 
 }  // namespace lull
@@ -125,7 +125,6 @@ class RgbMultiplierDescendantsChannel : public AnimationChannel {
   bool Get(Entity e, float* values, size_t len) const override;
   void Set(Entity e, const float* values, size_t len) override;
 
-  Registry* registry_;
   RenderSystem* render_system_;
 };
 
@@ -142,7 +141,6 @@ class AlphaMultiplierDescendantsChannel : public AnimationChannel {
   bool Get(Entity e, float* values, size_t len) const override;
   void Set(Entity e, const float* values, size_t len) override;
 
-  Registry* registry_;
   RenderSystem* render_system_;
 };
 
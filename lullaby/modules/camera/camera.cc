@@ -15,18 +15,44 @@ limitations under the License.
 */
 
 #include "lullaby/modules/camera/camera.h"
+
+#include <algorithm>
+
 #include "mathfu/io.h"
 
 namespace lull {
-const mathfu::mat4& Camera::ClipFromWorld() const { return clip_from_world_; }
-const mathfu::mat4& Camera::WorldFromClip() const { return world_from_clip_; }
+const CameraFrameData& Camera::FrameData() const {
+  if (frame_data_dirty_) {
+    const mathfu::mat4 sensor_start_from_sensor = CalculateTransformMatrix(
+        sensor_pos_local_, sensor_rot_local_, mathfu::kOnes3f);
+    frame_data_.world_from_camera = world_from_sensor_start_ *
+                                    sensor_start_from_sensor *
+                                    sensor_from_camera_;
+    frame_data_.camera_from_world = frame_data_.world_from_camera.Inverse();
+    frame_data_.world_from_clip =
+        frame_data_.world_from_camera * camera_from_clip_;
+    frame_data_.clip_from_world =
+        clip_from_camera_ * frame_data_.camera_from_world;
+    CalculateViewFrustum(frame_data_.clip_from_world,
+                         frame_data_.frustum_planes);
+    frame_data_dirty_ = false;
+  }
+  return frame_data_;
+}
+
+const mathfu::mat4& Camera::ClipFromWorld() const {
+  return FrameData().clip_from_world;
+}
+const mathfu::mat4& Camera::WorldFromClip() const {
+  return FrameData().world_from_clip;
+}
 const mathfu::mat4& Camera::ClipFromCamera() const { return clip_from_camera_; }
 const mathfu::mat4& Camera::CameraFromClip() const { return camera_from_clip_; }
 const mathfu::mat4& Camera::CameraFromWorld() const {
-  return camera_from_world_;
+  return FrameData().camera_from_world;
 }
 const mathfu::mat4& Camera::WorldFromCamera() const {
-  return world_from_camera_;
+  return FrameData().world_from_camera;
 }
 const mathfu::mat4& Camera::WorldFromSensorStart() const {
   return world_from_sensor_start_;
@@ -37,10 +63,10 @@ const mathfu::mat4& Camera::SensorStartFromWorld() const {
 const mathfu::vec3& Camera::LocalPosition() const { return sensor_pos_local_; }
 const mathfu::quat& Camera::LocalRotation() const { return sensor_rot_local_; }
 mathfu::vec3 Camera::WorldPosition() const {
-  return world_from_camera_.TranslationVector3D();
+  return FrameData().world_from_camera.TranslationVector3D();
 }
 mathfu::quat Camera::WorldRotation() const {
-  return mathfu::quat::FromMatrix(world_from_camera_);
+  return mathfu::quat::FromMatrix(FrameData().world_from_camera);
 }
 const mathfu::mat4& Camera::CameraFromSensor() const {
   return camera_from_sensor_;
@@ -57,6 +83,9 @@ Camera::Rotation Camera::DisplayRotation() const { return display_rotation_; }
 bool Camera::IsCameraTracking() const { return tracking_; }
 int Camera::Width() const { return viewport_.size.x; }
 int Camera::Height() const { return viewport_.size.y; }
+const mathfu::vec4* Camera::FrustumPlanes() const {
+  return FrameData().frustum_planes;
+}
 
 DeviceOrientation Camera::Orientation() const {
   switch (display_rotation_) {
@@ -91,17 +120,22 @@ Camera::Rotation Camera::ToDisplayRotation(DeviceOrientation orientation) {
 }
 
 void Camera::PopulateRenderView(RenderView* view) const {
+  const CameraFrameData& data = FrameData();
   view->viewport = viewport_.pos;
   view->dimensions = viewport_.size;
-  view->world_from_eye_matrix = world_from_camera_;
-  view->eye_from_world_matrix = camera_from_world_;
+  view->world_from_eye_matrix = data.world_from_camera;
+  view->eye_from_world_matrix = data.camera_from_world;
   view->clip_from_eye_matrix = clip_from_camera_;
-  view->clip_from_world_matrix = clip_from_world_;
+  view->clip_from_world_matrix = data.clip_from_world;
+  std::copy(data.frustum_planes, data.frustum_planes + kNumFrustumPlanes,
+            view->frustum_planes);
+  view->has_frustum_planes = true;
 }
 
 Ray Camera::WorldRayFromClipPoint(const mathfu::vec3& clip_point) const {
-  return CalculateRayFromCamera(WorldPosition(), world_from_clip_,
-                                clip_point.xy());
+  const CameraFrameData& data = FrameData();
+  return CalculateRayFromCamera(data.world_from_camera.TranslationVector3D(),
+                                data.world_from_clip, clip_point.xy());
 }
 
 Ray Camera::WorldRayFromUV(const mathfu::vec2& uv) const {
@@ -119,11 +153,11 @@ Optional<mathfu::vec2> Camera::PixelFromWorldPoint(
 }
 
 mathfu::vec3 Camera::WorldPointFromClip(const mathfu::vec3& clip_point) const {
-  return world_from_clip_ * clip_point;
+  return FrameData().world_from_clip * clip_point;
 }
 
 mathfu::vec3 Camera::ClipFromWorldPoint(const mathfu::vec3& world_point) const {
-  return clip_from_world_ * world_point;
+  return FrameData().clip_from_world * world_point;
 }
 
 mathfu::vec2 Camera::UVFromWorldPoint(const mathfu::vec3& world_point) const {
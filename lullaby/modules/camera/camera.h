@@ -31,6 +31,20 @@ enum class DeviceOrientation {
   kUnknown
 };
 
+/// The matrices and view frustum derived from a camera's pose and projection.
+/// These are only recomputed when the camera changes (ie. typically once per
+/// frame), and are shared by rendering, culling and input raycasts.
+struct CameraFrameData {
+  /// The view matrix and its inverse.
+  mathfu::mat4 camera_from_world = mathfu::mat4::Identity();
+  mathfu::mat4 world_from_camera = mathfu::mat4::Identity();
+  /// The view projection matrix and its inverse.
+  mathfu::mat4 clip_from_world = mathfu::mat4::Identity();
+  mathfu::mat4 world_from_clip = mathfu::mat4::Identity();
+  /// The world space view frustum planes.  See CalculateViewFrustum().
+  mathfu::vec4 frustum_planes[kNumFrustumPlanes];
+};
+
 /// A class containing all of the information needed to go between screen space
 /// (or render target space) and world space.
 /// The Projection Matrix is the ClipFromCamera matrix.
@@ -72,6 +86,11 @@ class Camera {
   Camera() {}
   virtual ~Camera() {}
 
+  /// Returns the matrices and frustum derived from the camera's current pose
+  /// and projection, recomputing them first if the camera has changed since
+  /// they were last requested.  Not thread-safe.
+  const CameraFrameData& FrameData() const;
+
   /// Returns the view projection matrix.
   const mathfu::mat4& ClipFromWorld() const;
   /// Returns the inverse view projection matrix.
@@ -138,6 +157,9 @@ class Camera {
   /// Convert from DeviceOrientation to a DisplayRotation value.
   static Rotation ToDisplayRotation(DeviceOrientation orientation);
 
+  /// Returns the world space view frustum planes.
+  const mathfu::vec4* FrustumPlanes() const;
+
   /// Populates a render view to match this camera.
   virtual void PopulateRenderView(RenderView* view) const;
 
@@ -209,12 +231,12 @@ class Camera {
   static mathfu::vec2 UVFromClip(const mathfu::vec3& clip_point);
 
  protected:
-  mathfu::mat4 clip_from_world_ = mathfu::mat4::Identity();
-  mathfu::mat4 world_from_clip_ = mathfu::mat4::Identity();
+  /// Marks the CameraFrameData as needing to be recomputed.  Must be called
+  /// whenever the pose or projection of the camera changes.
+  void SetFrameDataDirty() { frame_data_dirty_ = true; }
+
   mathfu::mat4 clip_from_camera_ = mathfu::mat4::Identity();
   mathfu::mat4 camera_from_clip_ = mathfu::mat4::Identity();
-  mathfu::mat4 camera_from_world_ = mathfu::mat4::Identity();
-  mathfu::mat4 world_from_camera_ = mathfu::mat4::Identity();
   mathfu::mat4 world_from_sensor_start_ = mathfu::mat4::Identity();
   mathfu::mat4 sensor_start_from_world_ = mathfu::mat4::Identity();
   mathfu::mat4 camera_from_sensor_ = mathfu::mat4::Identity();
@@ -230,6 +252,10 @@ class Camera {
   mathfu::vec3 clip_scale_ = mathfu::kOnes3f;
   Rotation display_rotation_ = kRotation0;
   bool tracking_ = false;
+
+ private:
+  mutable CameraFrameData frame_data_;
+  mutable bool frame_data_dirty_ = true;
 };
 
 using CameraPtr = std::shared_ptr<Camera>;
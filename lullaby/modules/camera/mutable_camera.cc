@@ -82,14 +82,9 @@ void MutableCamera::SetViewport(const mathfu::recti& viewport) {
 }
 
 void MutableCamera::RecalculateClipFromWorld() {
-  mathfu::mat4 sensor_start_from_sensor = CalculateTransformMatrix(
-      LocalPosition(), LocalRotation(), mathfu::kOnes3f);
-
-  world_from_camera_ =
-      WorldFromSensorStart() * sensor_start_from_sensor * SensorFromCamera();
-  camera_from_world_ = world_from_camera_.Inverse();
-  world_from_clip_ = world_from_camera_ * camera_from_clip_;
-  clip_from_world_ = clip_from_camera_ * camera_from_world_;
+  // The derived matrices are computed on demand by Camera::FrameData(), so
+  // that setting several parts of the pose in a frame only computes them once.
+  SetFrameDataDirty();
 }
 
 mathfu::mat4 MutableCamera::MakePerspectiveProjection() const {
@@ -100,8 +95,7 @@ mathfu::mat4 MutableCamera::MakePerspectiveProjection() const {
 void MutableCamera::RecalculatePerspectiveProjection() {
   clip_from_camera_ = MakePerspectiveProjection();
   camera_from_clip_ = clip_from_camera_.Inverse();
-  world_from_clip_ = world_from_camera_ * camera_from_clip_;
-  clip_from_world_ = clip_from_camera_ * camera_from_world_;
+  SetFrameDataDirty();
 }
 
 void MutableCamera::SetIsCameraTracking(bool tracking) { tracking_ = tracking; }
@@ -73,9 +73,10 @@ class MutableCamera : public Camera {
   /// called when SetupDisplay, SetClipPlanes, or SetClipScale are called.
   void RecalculatePerspectiveProjection();
 
-  /// Recalculates derived matrices based on SensorStart space, Sensor Pose,
-  /// SensorFromCamera, and ClipFromCamera.  This is automatically called when
-  /// any of those are changed using the setters above.
+  /// Marks the derived matrices based on SensorStart space, Sensor Pose,
+  /// SensorFromCamera, and ClipFromCamera for recalculation the next time they
+  /// are requested.  This is automatically called when any of those are
+  /// changed using the setters above.
   void RecalculateClipFromWorld();
 
   /// Set the tracking state.
@@ -276,6 +276,7 @@ void DebugRender::Submit() {
       }
     }
   }
+  draw_->Flush();
   buffers_[read_index_].clear();
 }
 
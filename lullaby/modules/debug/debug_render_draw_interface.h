@@ -49,6 +49,10 @@ class DebugRenderDrawInterface {
       const mathfu::vec2& pixel_pos0, const mathfu::vec2& uv0,
       const mathfu::vec2& pixel_pos1, const mathfu::vec2& uv1,
       const TexturePtr& texture) = 0;
+
+  // Called after all the elements of a frame have been submitted, so that
+  // implementations which batch primitives can draw them.
+  virtual void Flush() {}
 };
 
 }  // namespace debug
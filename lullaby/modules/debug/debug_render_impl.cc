@@ -31,6 +31,9 @@ constexpr const char* kFontShader = "shaders/texture.fplshader";
 constexpr const char* kFontTexture = "textures/debug_font.webp";
 constexpr float kUVBounds[4] = {0.0f, 0.0f, 1.0f, 1.0f};
 constexpr float kFontSize = 0.12f;
+// Batched boxes use 16-bit indices, so a batch is drawn early before it would
+// exceed this many vertices.
+constexpr size_t kMaxBatchVertices = 0xffff;
 
 struct NormalizedCoordinates {
   mathfu::vec3 pos0;
@@ -132,32 +135,67 @@ void DebugRenderImpl::Begin(const RenderSystem::View* views, size_t num_views) {
   render_system_->UpdateCachedRenderState(GetRenderState());
 }
 
-void DebugRenderImpl::End() {
+void DebugRenderImpl::End() { Flush(); }
+
+void DebugRenderImpl::Flush() {
+  // Draw the opaque shapes first so that transparent ones blend over them.
+  FlushShapes(kState3DOpaque);
+  FlushShapes(kState3DTransparent);
 }
 
-void DebugRenderImpl::DrawLine(const mathfu::vec3& start_point,
-                               const mathfu::vec3& end_point,
-                               const Color4ub color) {
-  Initialize();
-  SetState(Choose3DState(color));
-  verts_.clear();
-  verts_.emplace_back(start_point.x, start_point.y, start_point.z, color);
-  verts_.emplace_back(end_point.x, end_point.y, end_point.z, color);
-  MeshData mesh(
-      MeshData::PrimitiveType::kLines, VertexPC::kFormat,
-      DataContainer::WrapDataAsReadOnly(verts_.data(),
-        VertexPC::kFormat.GetVertexSize() * verts_.size()));
+void DebugRenderImpl::FlushShapes(State state) {
+  ShapeBatch& batch = shape_batches_[state];
+  if (batch.line_verts.empty() && batch.triangle_verts.empty()) {
+    return;
+  }
+
+  SetState(state);
+  const size_t vertex_size = VertexPC::kFormat.GetVertexSize();
+  MeshData lines(MeshData::PrimitiveType::kLines, VertexPC::kFormat,
+                 DataContainer::WrapDataAsReadOnly(
+                     batch.line_verts.data(),
+                     vertex_size * batch.line_verts.size()));
+  MeshData triangles(
+      MeshData::PrimitiveType::kTriangles, VertexPC::kFormat,
+      DataContainer::WrapDataAsReadOnly(
+          batch.triangle_verts.data(),
+          vertex_size * batch.triangle_verts.size()),
+      MeshData::kIndexU16,
+      DataContainer::WrapDataAsReadOnly(
+          batch.triangle_indices.data(),
+          sizeof(uint16_t) * batch.triangle_indices.size()));
 
   for (size_t i = 0; i < num_views_; ++i) {
     render_system_->SetViewport(views_[i]);
     render_system_->BindShader(shape_shader_);
-    render_system_->DrawMesh(mesh, views_[i].clip_from_world_matrix);
+    if (!batch.triangle_verts.empty()) {
+      render_system_->DrawMesh(triangles, views_[i].clip_from_world_matrix);
+    }
+    if (!batch.line_verts.empty()) {
+      render_system_->DrawMesh(lines, views_[i].clip_from_world_matrix);
+    }
   }
+
+  // Keep the capacity so that later frames don't need to reallocate.
+  batch.line_verts.clear();
+  batch.triangle_verts.clear();
+  batch.triangle_indices.clear();
+}
+
+void DebugRenderImpl::DrawLine(const mathfu::vec3& start_point,
+                               const mathfu::vec3& end_point,
+                               const Color4ub color) {
+  Initialize();
+  ShapeBatch& batch = shape_batches_[Choose3DState(color)];
+  batch.line_verts.emplace_back(start_point.x, start_point.y, start_point.z,
+                                color);
+  batch.line_verts.emplace_back(end_point.x, end_point.y, end_point.z, color);
 }
 
 void DebugRenderImpl::DrawText3D(const mathfu::vec3& pos, const Color4ub color,
                                  const char* text) {
   Initialize();
+  Flush();
   SetState(Choose3DState(color));
   CHECK(font_);
   font_->SetSize(kFontSize);
@@ -180,6 +218,7 @@ void DebugRenderImpl::DrawText2D(const Color4ub color, const char* text) {
   const float kTopOfTextScreenScale = 0.40f;
   const float kFontScreenScale = .075f;
   Initialize();
+  Flush();
   SetState(kState2D);
   const float z = -1.0f;
   const float tan_half_fov = 1.0f / views_[0].clip_from_eye_matrix[5];
@@ -209,13 +248,19 @@ void DebugRenderImpl::DrawBox3D(const mathfu::mat4& world_from_object_matrix,
   constexpr int kNumCorners = 8;
   mathfu::vec3 corners[kNumCorners];
   Initialize();
-  SetState(Choose3DState(color));
   GetTransformedBoxCorners(box, world_from_object_matrix, corners);
 
-  verts_.clear();
-  verts_.reserve(kNumCorners);
+  const State state = Choose3DState(color);
+  if (shape_batches_[state].triangle_verts.size() + kNumCorners >
+      kMaxBatchVertices) {
+    FlushShapes(state);
+  }
+  ShapeBatch& batch = shape_batches_[state];
+
+  const uint16_t base_index =
+      static_cast<uint16_t>(batch.triangle_verts.size());
   for (int i = 0; i < kNumCorners; ++i) {
-    verts_.emplace_back(corners[i], color);
+    batch.triangle_verts.emplace_back(corners[i], color);
   }
 
   constexpr int kNumIndices = 6 * 2 * 3;  // 6 faces * 2 triangles * 3 indices
@@ -233,17 +278,8 @@ void DebugRenderImpl::DrawBox3D(const mathfu::mat4& world_from_object_matrix,
       // +z face
       1, 5, 7, 1, 7, 3,
   };
-
-  MeshData mesh(MeshData::PrimitiveType::kTriangles, VertexPC::kFormat,
-                DataContainer::WrapDataAsReadOnly(verts_.data(),
-                  VertexPC::kFormat.GetVertexSize() * verts_.size()),
-                MeshData::kIndexU16,
-                DataContainer::WrapDataAsReadOnly(indices,
-                  kNumIndices * sizeof(uint16_t)));
-  for (size_t i = 0; i < num_views_; ++i) {
-    render_system_->SetViewport(views_[i]);
-    render_system_->BindShader(shape_shader_);
-    render_system_->DrawMesh(mesh, views_[i].clip_from_world_matrix);
+  for (const uint16_t index : indices) {
+    batch.triangle_indices.push_back(static_cast<uint16_t>(base_index + index));
   }
 }
 
@@ -251,6 +287,7 @@ void DebugRenderImpl::DrawQuad2D(const Color4ub color, float x, float y,
                                  float w, float h, const TexturePtr& texture) {
   const float z = -1.0f;
   Initialize();
+  Flush();
   SetState(kState2D);
   const mathfu::vec3 pos0(x - w, y - h, z);
   const mathfu::vec3 pos1(x + w, y + h, z);
@@ -268,6 +305,7 @@ void DebugRenderImpl::DrawQuad2DAbsolute(
     const mathfu::vec2& pixel_pos1, const mathfu::vec2& uv1,
     const TexturePtr& texture) {
   Initialize();
+  Flush();
   SetState(kState2D);
   for (size_t i = 0; i < num_views_; ++i) {
     const RenderSystem::View& view = views_[i];
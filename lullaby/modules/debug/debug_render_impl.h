@@ -24,6 +24,10 @@ limitations under the License.
 
 namespace lull {
 
+// Draws debug primitives with the RenderSystem.  Lines and boxes are
+// accumulated into persistent vertex arrays and drawn with a few draw calls
+// when Flush() or End() is called, or before any text or quad is drawn so that
+// the relative order of shapes and other elements is preserved.
 class DebugRenderImpl : public debug::DebugRenderDrawInterface {
  public:
   explicit DebugRenderImpl(Registry* registry, const std::string& prefix = "");
@@ -53,7 +57,17 @@ class DebugRenderImpl : public debug::DebugRenderDrawInterface {
       const mathfu::vec2& pixel_pos1, const mathfu::vec2& uv1,
       const TexturePtr& texture) override;
 
+  // Draws all the batched lines and boxes.
+  void Flush() override;
+
  private:
+  // The lines and boxes accumulated for a single render state.
+  struct ShapeBatch {
+    std::vector<VertexPC> line_verts;
+    std::vector<VertexPC> triangle_verts;
+    std::vector<uint16_t> triangle_indices;
+  };
+
   Registry* registry_;
   RenderSystem* render_system_;
   const RenderSystem::View* views_;
@@ -66,7 +80,8 @@ class DebugRenderImpl : public debug::DebugRenderDrawInterface {
   ShaderPtr texture_2d_external_oes_shader_;
   ShaderPtr shape_shader_;
   MeshData quad_mesh_;
-  std::vector<VertexPC> verts_;
+  // Indexed by State; the 2D state is never batched.
+  ShapeBatch shape_batches_[3];
   std::string asset_prefix_;
   bool is_initialized_;
 
@@ -83,6 +98,9 @@ class DebugRenderImpl : public debug::DebugRenderDrawInterface {
   void SetState(State state) const;
   static State Choose3DState(Color4ub color);
 
+  // Draws and clears the batched shapes for |state|.
+  void FlushShapes(State state);
+
   void SubmitQuad2D(
       const mathfu::vec4& color,
       const mathfu::vec3& pos0, const mathfu::vec2& uv0,
@@ -21,14 +21,25 @@ limitations under the License.
 
 namespace lull {
 
-// Stores a map of TypeId to EventHandlers that is used by the Dispatcher for
-// sending events.
+// Stores a map of (Channel, TypeId) to EventHandlers that is used by the
+// Dispatcher for sending events.
 //
-// The EventHandlers can be invoked via the Dispatch() function.  Adding and
-// removing EventHandlers during Dispatch() is safely handled by storing the
-// add/remove request in a "command queue" and processing the queue when the
-// dispatch process is complete.  As a result, any EventHandler added during a
-// Dispatch() will not be invoked.
+// The EventHandlers for each (Channel, TypeId) are stored contiguously so that
+// Dispatch() is a linear walk over a single array.  Lists for channels other
+// than 0 are destroyed once they are empty, so that a channel per Entity does
+// not accumulate memory for destroyed Entities.  Each connection is also
+// assigned a "slot" that records which array (and which index in that array)
+// stores its EventHandler.  The ConnectionId encodes both the slot index and a
+// generation counter for the slot, so removing a connection by id does not
+// require a search, and stale ids for slots that have since been reused are
+// ignored.
+//
+// The EventHandlers can be invoked via the Dispatch() function.  EventHandlers
+// added during a Dispatch() are queued and only added when the dispatch process
+// is complete, so they will not be invoked by the current Dispatch().
+// EventHandlers removed during a Dispatch() are marked as removed immediately
+// (and so will not be invoked by the remainder of the Dispatch()), but are
+// only destroyed when the dispatch process is complete.
 //
 // This class is not thread-safe.  All calls to an instance of this class must
 // be done synchronously.
@@ -36,26 +47,38 @@ class Dispatcher::EventHandlerMap {
  public:
   EventHandlerMap();
 
-  // Associates an EventHandler with the specified event |type|.
-  void Add(TypeId type, ConnectionId id, const void* owner, EventHandler fn);
+  // Associates an EventHandler with the specified |channel| and event |type|,
+  // returning the ConnectionId that can be used to remove it.
+  ConnectionId Add(Channel channel, TypeId type, const void* owner,
+                   EventHandler fn);
+
+  // Removes the EventHandler with the given |id|, or all EventHandlers in
+  // |channel| with the given |owner| if |id| is 0.  If |type| is 0,
+  // EventHandlers with the given |owner| are removed for all types, and if
+  // |channel| is also 0 they are removed from all channels.
+  void Remove(Channel channel, TypeId type, ConnectionId id,
+              const void* owner);
 
-  // Removes an EventHandler that matches the given parameters as best as
-  // possible.
-  void Remove(TypeId type, ConnectionId id, const void* owner);
+  // Removes all EventHandlers in |channel|.
+  void RemoveChannel(Channel channel);
 
-  // Pass the |event| to all EventHandlers associated with the same TypeId as
-  // the |event|.
-  void Dispatch(const EventWrapper& event);
+  // Pass the |event| to all EventHandlers in |channel| associated with the
+  // same TypeId as the |event|, or with a TypeId of 0.
+  void Dispatch(Channel channel, const EventWrapper& event);
 
   // Returns the number of active connections.
   size_t Size() const;
 
-  /// Returns the number of connections for an event of |type|.
-  size_t GetHandlerCount(TypeId type) const;
+  /// Returns the number of connections in |channel| for an event of |type|.
+  size_t GetHandlerCount(Channel channel, TypeId type) const;
+
+  /// Returns the number of connections in |channel|.
+  size_t GetChannelHandlerCount(Channel channel) const;
 
  private:
   // Wraps an EventHandler with two extra "tags" (ConnectionId id and const
-  // void* owner) that can be used to find specific EventHandler instances.
+  // void* owner) that can be used to find specific EventHandler instances.  An
+  // id of 0 indicates that the EventHandler has been removed.
   struct TaggedEventHandler {
     TaggedEventHandler(ConnectionId id, const void* owner, EventHandler fn)
         : id(id), owner(owner), fn(std::move(fn)) {}
@@ -65,20 +88,128 @@ class Dispatcher::EventHandlerMap {
     EventHandler fn;
   };
 
+  // Lists are keyed by the channel in the upper 32 bits and the TypeId in the
+  // lower 32 bits.
+  using Key = uint64_t;
+
+  // The contiguous array of EventHandlers for a single (Channel, TypeId).
+  struct HandlerList {
+    explicit HandlerList(Key key) : key(key) {}
+
+    Key key;
+    std::vector<TaggedEventHandler> handlers;
+    // The number of handlers that have been removed but are still in the array.
+    size_t num_removed = 0;
+    // Whether or not this list is in |lists_to_compact_|.
+    bool compaction_pending = false;
+  };
+
+  // Tracks the location of the EventHandler for a single ConnectionId.
+  struct Slot {
+    // The list storing the EventHandler, or nullptr if the EventHandler has not
+    // been added yet due to a Dispatch() in progress.
+    HandlerList* list = nullptr;
+    // The index of the EventHandler in |list|.
+    uint32_t index = 0;
+    uint32_t generation = 0;
+    bool in_use = false;
+  };
+
+  // An EventHandler that was added during a Dispatch().
+  struct PendingHandler {
+    PendingHandler(Key key, TaggedEventHandler handler)
+        : key(key), handler(std::move(handler)) {}
+
+    Key key;
+    TaggedEventHandler handler;
+  };
+
+  static Key MakeKey(Channel channel, TypeId type) {
+    return (static_cast<Key>(channel) << 32) | type;
+  }
+  static Channel GetChannel(Key key) { return static_cast<Channel>(key >> 32); }
+  static TypeId GetType(Key key) { return static_cast<TypeId>(key); }
+
+  // The lower bits of a ConnectionId store the slot index (plus one, so that no
+  // valid ConnectionId is 0) and the upper bits store the slot generation.
+  static const uint32_t kSlotIndexBits = 20;
+  static const uint32_t kSlotIndexMask = (1u << kSlotIndexBits) - 1;
+  static const uint32_t kMaxGeneration = (1u << (32 - kSlotIndexBits)) - 1;
+
+  // Returns the slot for the given |id|, or nullptr if |id| is invalid or
+  // stale.
+  Slot* GetSlot(ConnectionId id);
+
+  // Returns a new ConnectionId for a newly allocated slot.
+  ConnectionId AllocateSlot();
+
+  // Releases the slot associated with |id| so that it can be reused.
+  void FreeSlot(ConnectionId id);
+
+  // Returns the list for the given |key|, or nullptr if there is none.
+  const HandlerList* FindList(Key key) const;
+
+  // Returns the list for the given |key|, creating it if necessary.
+  HandlerList* GetOrCreateList(Key key);
+
+  // Destroys |list|, which must be empty and in a channel other than 0.
+  void DestroyList(HandlerList* list);
+
   // Actually add the EventHandler.
-  void AddImpl(TypeId type, TaggedEventHandler handler);
+  void AddImpl(Key key, TaggedEventHandler handler);
+
+  // Marks the EventHandler at |index| of |list| as removed and frees its slot.
+  // If no Dispatch() is in progress, the EventHandler is moved to |released| so
+  // that the caller can destroy it once this map is in a consistent state
+  // (since destroying it may reentrantly remove other EventHandlers).
+  void RemoveAt(HandlerList* list, size_t index,
+                std::vector<EventHandler>* released);
+
+  // Removes all EventHandlers in |list| with the given |owner|.
+  void RemoveOwner(HandlerList* list, const void* owner,
+                   std::vector<EventHandler>* released);
+
+  // Erases removed EventHandlers from |list| once enough of them have
+  // accumulated.  If a Dispatch() is in progress |list| is instead queued to be
+  // compacted when the dispatch is complete.
+  void MaybeCompact(HandlerList* list);
 
-  // Actually remove the EventHandler.
-  void RemoveImpl(TypeId type, TaggedEventHandler handler);
+  // Erases all removed EventHandlers from |list|, destroying it if it is empty
+  // and in a channel other than 0.
+  void Compact(HandlerList* list);
+
+  // Invokes all EventHandlers in |list| with |event|.
+  static void DispatchList(const HandlerList& list, const EventWrapper& event);
 
   // Counter for tracking Dispatch() calls.
   int dispatch_count_;
 
-  // Deferred queue of add/remove commands for when a Dispatch() is in progress.
-  std::vector<std::pair<TypeId, TaggedEventHandler>> command_queue_;
+  // The number of active connections.
+  size_t size_;
+
+  // Map of registered handlers.  Since this is a node-based container, the
+  // HandlerLists are never moved and can be referenced by pointer.
+  std::unordered_map<Key, HandlerList> lists_;
+
+  // The lists of each channel other than 0.
+  std::unordered_map<Channel, std::vector<HandlerList*>> channel_lists_;
+
+  // The number of lists connected to all events of a channel other than 0, so
+  // that sending to a channel can usually skip looking them up.
+  size_t num_channel_all_events_lists_;
 
-  // Map of registered handlers.
-  std::unordered_multimap<TypeId, TaggedEventHandler> map_;
+  // The handlers in channel 0 connected to all events (ie. with a TypeId of 0).
+  HandlerList* all_events_list_;
+
+  // The location of all EventHandlers, indexed by ConnectionId.
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> free_slots_;
+
+  // Deferred queue of handlers added while a Dispatch() is in progress.
+  std::vector<PendingHandler> pending_handlers_;
+
+  // Lists with handlers removed while a Dispatch() is in progress.
+  std::vector<HandlerList*> lists_to_compact_;
 };
 
 Dispatcher::Dispatcher() { handlers_.reset(new EventHandlerMap()); }
@@ -91,16 +222,32 @@ void Dispatcher::SendImmediately(const EventWrapper& event) {
 
 Dispatcher::ScopedConnection Dispatcher::Connect(TypeId type,
                                                  EventHandler handler) {
-  return ConnectImpl(type, nullptr, std::move(handler));
+  return ConnectImpl(0, type, nullptr, std::move(handler));
 }
 
 Dispatcher::Connection Dispatcher::Connect(TypeId type, const void* owner,
                                            EventHandler handler) {
-  return ConnectImpl(type, owner, std::move(handler));
+  return ConnectImpl(0, type, owner, std::move(handler));
 }
 
 Dispatcher::ScopedConnection Dispatcher::ConnectToAll(EventHandler handler) {
-  return ConnectImpl(0, nullptr, std::move(handler));
+  return ConnectImpl(0, 0, nullptr, std::move(handler));
+}
+
+Dispatcher::ScopedConnection Dispatcher::ConnectToChannel(
+    Channel channel, TypeId type, EventHandler handler) {
+  return ConnectImpl(channel, type, nullptr, std::move(handler));
+}
+
+Dispatcher::Connection Dispatcher::ConnectToChannel(Channel channel,
+                                                    TypeId type,
+                                                    const void* owner,
+                                                    EventHandler handler) {
+  return ConnectImpl(channel, type, owner, std::move(handler));
+}
+
+void Dispatcher::SendToChannel(Channel channel, const EventWrapper& event) {
+  handlers_->Dispatch(channel, event);
 }
 
 void Dispatcher::Disconnect(TypeId type, const void* owner) {
@@ -108,32 +255,55 @@ void Dispatcher::Disconnect(TypeId type, const void* owner) {
 }
 
 void Dispatcher::Disconnect(TypeId type, ConnectionId id) {
-  handlers_->Remove(type, id, nullptr);
+  handlers_->Remove(0, type, id, nullptr);
+}
+
+void Dispatcher::DisconnectFromChannel(Channel channel, TypeId type,
+                                       const void* owner) {
+  if (channel == 0 && type == 0) {
+    // A channel and type of 0 would otherwise disconnect from all channels.
+    handlers_->Remove(0, 0, 0, owner);
+    return;
+  }
+  handlers_->Remove(channel, type, 0, owner);
+}
+
+void Dispatcher::DisconnectChannel(Channel channel) {
+  handlers_->RemoveChannel(channel);
 }
 
 void Dispatcher::SendImpl(const EventWrapper& event) {
-  handlers_->Dispatch(event);
+  handlers_->Dispatch(0, event);
 }
 
-Dispatcher::Connection Dispatcher::ConnectImpl(TypeId type, const void* owner,
+Dispatcher::Connection Dispatcher::ConnectImpl(Channel channel, TypeId type,
+                                               const void* owner,
                                                EventHandler handler) {
-  const ConnectionId id = ++id_;
-  handlers_->Add(type, id, owner, std::move(handler));
+  const ConnectionId id =
+      handlers_->Add(channel, type, owner, std::move(handler));
   return Connection(handlers_, type, id);
 }
 
 void Dispatcher::DisconnectAll(const void* owner) {
-  handlers_->Remove(0, 0, owner);
+  handlers_->Remove(0, 0, 0, owner);
 }
 
 void Dispatcher::DisconnectImpl(TypeId type, const void* owner) {
-  handlers_->Remove(type, 0, owner);
+  handlers_->Remove(0, type, 0, owner);
 }
 
 size_t Dispatcher::GetHandlerCount() const { return handlers_->Size(); }
 
 size_t Dispatcher::GetHandlerCount(TypeId type) const {
-  return handlers_->GetHandlerCount(type);
+  return handlers_->GetHandlerCount(0, type);
+}
+
+size_t Dispatcher::GetChannelHandlerCount(Channel channel) const {
+  return handlers_->GetChannelHandlerCount(channel);
+}
+
+size_t Dispatcher::GetChannelHandlerCount(Channel channel, TypeId type) const {
+  return handlers_->GetHandlerCount(channel, type);
 }
 
 Dispatcher::Connection::Connection() : type_(0), id_(0), handlers_() {}
@@ -144,7 +314,7 @@ Dispatcher::Connection::Connection(const EventHandlerMapPtr& handlers,
 
 void Dispatcher::Connection::Disconnect() {
   if (auto handlers = handlers_.lock()) {
-    handlers->Remove(type_, id_, nullptr);
+    handlers->Remove(0, type_, id_, nullptr);
     handlers_.reset();
   }
 }
@@ -172,98 +342,381 @@ Dispatcher::ScopedConnection::~ScopedConnection() { Disconnect(); }
 
 void Dispatcher::ScopedConnection::Disconnect() { connection_.Disconnect(); }
 
-Dispatcher::EventHandlerMap::EventHandlerMap() : dispatch_count_(0) {}
+Dispatcher::EventHandlerMap::EventHandlerMap()
+    : dispatch_count_(0),
+      size_(0),
+      num_channel_all_events_lists_(0),
+      all_events_list_(GetOrCreateList(0)) {}
+
+Dispatcher::ConnectionId Dispatcher::EventHandlerMap::Add(Channel channel,
+                                                          TypeId type,
+                                                          const void* owner,
+                                                          EventHandler fn) {
+  assert(fn != nullptr);
+  const ConnectionId id = AllocateSlot();
+  if (id == 0) {
+    return 0;
+  }
 
-void Dispatcher::EventHandlerMap::Add(TypeId type, ConnectionId id,
-                                      const void* owner, EventHandler fn) {
+  const Key key = MakeKey(channel, type);
   TaggedEventHandler handler(id, owner, std::move(fn));
   if (dispatch_count_ > 0) {
-    command_queue_.emplace_back(type, std::move(handler));
+    pending_handlers_.emplace_back(key, std::move(handler));
   } else {
-    AddImpl(type, std::move(handler));
+    AddImpl(key, std::move(handler));
   }
+  return id;
 }
 
-void Dispatcher::EventHandlerMap::Remove(TypeId type, ConnectionId id,
-                                         const void* owner) {
-  TaggedEventHandler handler(id, owner, nullptr);
-  if (dispatch_count_ > 0) {
-    command_queue_.emplace_back(type, std::move(handler));
+void Dispatcher::EventHandlerMap::Remove(Channel channel, TypeId type,
+                                         ConnectionId id, const void* owner) {
+  assert(id != 0 || owner != nullptr);
+
+  // Destroyed at the end of this function, after all bookkeeping is done.
+  std::vector<EventHandler> released;
+
+  if (id) {
+    Slot* slot = GetSlot(id);
+    if (slot == nullptr) {
+      return;
+    }
+    if (slot->list) {
+      HandlerList* list = slot->list;
+      RemoveAt(list, slot->index, &released);
+      MaybeCompact(list);
+    } else {
+      // The handler was added during a dispatch and is still pending.
+      for (auto& pending : pending_handlers_) {
+        if (pending.handler.id == id) {
+          pending.handler.id = 0;
+          break;
+        }
+      }
+      FreeSlot(id);
+    }
+  } else if (owner) {
+    const bool all_channels = channel == 0 && type == 0;
+    if (type != 0) {
+      auto iter = lists_.find(MakeKey(channel, type));
+      if (iter != lists_.end()) {
+        RemoveOwner(&iter->second, owner, &released);
+      }
+    } else if (all_channels) {
+      // Removing lists invalidates iterators, so gather them first.
+      std::vector<HandlerList*> lists;
+      lists.reserve(lists_.size());
+      for (auto& iter : lists_) {
+        lists.push_back(&iter.second);
+      }
+      for (HandlerList* list : lists) {
+        RemoveOwner(list, owner, &released);
+      }
+    } else {
+      auto iter = channel_lists_.find(channel);
+      if (iter != channel_lists_.end()) {
+        const std::vector<HandlerList*> lists = iter->second;
+        for (HandlerList* list : lists) {
+          RemoveOwner(list, owner, &released);
+        }
+      }
+    }
+
+    for (auto& pending : pending_handlers_) {
+      if (pending.handler.id != 0 && pending.handler.owner == owner &&
+          (all_channels || GetChannel(pending.key) == channel) &&
+          (type == 0 || GetType(pending.key) == type)) {
+        FreeSlot(pending.handler.id);
+        pending.handler.id = 0;
+      }
+    }
+  }
+}
+
+void Dispatcher::EventHandlerMap::RemoveChannel(Channel channel) {
+  // Destroyed at the end of this function, after all bookkeeping is done.
+  std::vector<EventHandler> released;
+
+  auto iter = channel_lists_.find(channel);
+  if (iter != channel_lists_.end()) {
+    const std::vector<HandlerList*> lists = iter->second;
+    for (HandlerList* list : lists) {
+      for (size_t i = 0; i < list->handlers.size(); ++i) {
+        if (list->handlers[i].id != 0) {
+          RemoveAt(list, i, &released);
+        }
+      }
+      MaybeCompact(list);
+    }
+  }
+
+  for (auto& pending : pending_handlers_) {
+    if (pending.handler.id != 0 && GetChannel(pending.key) == channel) {
+      FreeSlot(pending.handler.id);
+      pending.handler.id = 0;
+    }
+  }
+}
+
+Dispatcher::EventHandlerMap::Slot* Dispatcher::EventHandlerMap::GetSlot(
+    ConnectionId id) {
+  const uint32_t index = (id & kSlotIndexMask) - 1;
+  const uint32_t generation = id >> kSlotIndexBits;
+  if (index >= slots_.size()) {
+    return nullptr;
+  }
+  Slot* slot = &slots_[index];
+  if (!slot->in_use || slot->generation != generation) {
+    return nullptr;
+  }
+  return slot;
+}
+
+Dispatcher::ConnectionId Dispatcher::EventHandlerMap::AllocateSlot() {
+  uint32_t index = 0;
+  if (!free_slots_.empty()) {
+    index = free_slots_.back();
+    free_slots_.pop_back();
+  } else if (slots_.size() < kSlotIndexMask) {
+    index = static_cast<uint32_t>(slots_.size());
+    slots_.emplace_back();
   } else {
-    RemoveImpl(type, std::move(handler));
+    assert(false && "Too many connections.");
+    return 0;
   }
+
+  Slot& slot = slots_[index];
+  slot.in_use = true;
+  slot.list = nullptr;
+  return (slot.generation << kSlotIndexBits) | (index + 1);
+}
+
+void Dispatcher::EventHandlerMap::FreeSlot(ConnectionId id) {
+  const uint32_t index = (id & kSlotIndexMask) - 1;
+  Slot& slot = slots_[index];
+  slot.in_use = false;
+  slot.list = nullptr;
+  slot.generation = (slot.generation + 1) & kMaxGeneration;
+  free_slots_.push_back(index);
 }
 
-void Dispatcher::EventHandlerMap::AddImpl(TypeId type,
+const Dispatcher::EventHandlerMap::HandlerList*
+Dispatcher::EventHandlerMap::FindList(Key key) const {
+  auto iter = lists_.find(key);
+  return iter != lists_.end() ? &iter->second : nullptr;
+}
+
+Dispatcher::EventHandlerMap::HandlerList*
+Dispatcher::EventHandlerMap::GetOrCreateList(Key key) {
+  auto result = lists_.emplace(key, HandlerList(key));
+  HandlerList* list = &result.first->second;
+  const Channel channel = GetChannel(key);
+  if (result.second && channel != 0) {
+    channel_lists_[channel].push_back(list);
+    if (GetType(key) == 0) {
+      ++num_channel_all_events_lists_;
+    }
+  }
+  return list;
+}
+
+void Dispatcher::EventHandlerMap::DestroyList(HandlerList* list) {
+  assert(list->handlers.empty());
+  const Key key = list->key;
+  const Channel channel = GetChannel(key);
+  assert(channel != 0);
+
+  auto iter = channel_lists_.find(channel);
+  if (iter != channel_lists_.end()) {
+    std::vector<HandlerList*>& lists = iter->second;
+    for (size_t i = 0; i < lists.size(); ++i) {
+      if (lists[i] == list) {
+        lists[i] = lists.back();
+        lists.pop_back();
+        break;
+      }
+    }
+    if (lists.empty()) {
+      channel_lists_.erase(iter);
+    }
+  }
+  if (GetType(key) == 0) {
+    --num_channel_all_events_lists_;
+  }
+  lists_.erase(key);
+}
+
+void Dispatcher::EventHandlerMap::AddImpl(Key key,
                                           TaggedEventHandler handler) {
   assert(handler.id != 0);
   assert(handler.fn != nullptr);
-  map_.emplace(type, std::move(handler));
+  HandlerList* list = GetOrCreateList(key);
+  Slot* slot = GetSlot(handler.id);
+  assert(slot != nullptr);
+  slot->list = list;
+  slot->index = static_cast<uint32_t>(list->handlers.size());
+  list->handlers.emplace_back(std::move(handler));
+  ++size_;
+}
+
+void Dispatcher::EventHandlerMap::RemoveAt(
+    HandlerList* list, size_t index, std::vector<EventHandler>* released) {
+  TaggedEventHandler& handler = list->handlers[index];
+  FreeSlot(handler.id);
+  handler.id = 0;
+  if (dispatch_count_ == 0) {
+    released->emplace_back(std::move(handler.fn));
+    handler.fn = nullptr;
+  }
+  ++list->num_removed;
+  --size_;
 }
 
-void Dispatcher::EventHandlerMap::RemoveImpl(TypeId type,
-                                             TaggedEventHandler handler) {
-  assert(handler.fn == nullptr);
-  assert(handler.id != 0 || handler.owner != nullptr);
+void Dispatcher::EventHandlerMap::RemoveOwner(
+    HandlerList* list, const void* owner, std::vector<EventHandler>* released) {
+  bool removed = false;
+  for (size_t i = 0; i < list->handlers.size(); ++i) {
+    const TaggedEventHandler& handler = list->handlers[i];
+    if (handler.id != 0 && handler.owner == owner) {
+      RemoveAt(list, i, released);
+      removed = true;
+    }
+  }
+  if (removed) {
+    MaybeCompact(list);
+  }
+}
 
-  auto range = std::make_pair(map_.begin(), map_.end());
-  if (type != 0) {
-    range = map_.equal_range(type);
+void Dispatcher::EventHandlerMap::MaybeCompact(HandlerList* list) {
+  if (dispatch_count_ > 0) {
+    if (!list->compaction_pending) {
+      list->compaction_pending = true;
+      lists_to_compact_.push_back(list);
+    }
+  } else if (list->num_removed * 2 >= list->handlers.size()) {
+    // Only compact once at least half the handlers have been removed so that
+    // removing many handlers one at a time is not quadratic.
+    Compact(list);
   }
+}
 
-  if (handler.id) {
-    for (auto it = range.first; it != range.second; ++it) {
-      if (it->second.id == handler.id) {
-        map_.erase(it);
-        return;
-      }
+void Dispatcher::EventHandlerMap::Compact(HandlerList* list) {
+  size_t count = 0;
+  for (size_t i = 0; i < list->handlers.size(); ++i) {
+    TaggedEventHandler& handler = list->handlers[i];
+    if (handler.id == 0) {
+      continue;
     }
-  } else if (handler.owner) {
-    for (auto it = range.first; it != range.second;) {
-      if (it->second.owner == handler.owner) {
-        it = map_.erase(it);
-      } else {
-        ++it;
-      }
+    if (i != count) {
+      list->handlers[count] = std::move(handler);
     }
+    slots_[(list->handlers[count].id & kSlotIndexMask) - 1].index =
+        static_cast<uint32_t>(count);
+    ++count;
+  }
+  list->handlers.erase(list->handlers.begin() + count, list->handlers.end());
+  list->num_removed = 0;
+  if (list->handlers.empty() && GetChannel(list->key) != 0) {
+    DestroyList(list);
   }
 }
 
-void Dispatcher::EventHandlerMap::Dispatch(const EventWrapper& event) {
+void Dispatcher::EventHandlerMap::DispatchList(const HandlerList& list,
+                                               const EventWrapper& event) {
+  // Handlers added during the dispatch are deferred and removed handlers are
+  // only marked as such, so the array is not modified while it is iterated.
+  const size_t count = list.handlers.size();
+  for (size_t i = 0; i < count; ++i) {
+    const TaggedEventHandler& handler = list.handlers[i];
+    if (handler.id != 0) {
+      handler.fn(event);
+    }
+  }
+}
+
+void Dispatcher::EventHandlerMap::Dispatch(Channel channel,
+                                           const EventWrapper& event) {
   // NOTE: if you crash in this function, it may be because you destroyed an
   // an Entity from inside an event handler.
   // Call EntityFactory::QueueForDestruction instead.
   const TypeId type = event.GetTypeId();
 
   ++dispatch_count_;
-  auto range = map_.equal_range(type);
-  for (auto it = range.first; it != range.second; ++it) {
-    it->second.fn(event);
+  if (type != 0) {
+    const HandlerList* list = FindList(MakeKey(channel, type));
+    if (list) {
+      DispatchList(*list, event);
+    }
   }
   // Send to handlers that are listening for all events.
-  range = map_.equal_range(0);
-  for (auto it = range.first; it != range.second; ++it) {
-    it->second.fn(event);
+  if (channel == 0) {
+    DispatchList(*all_events_list_, event);
+  } else if (num_channel_all_events_lists_ > 0) {
+    const HandlerList* list = FindList(MakeKey(channel, 0));
+    if (list) {
+      DispatchList(*list, event);
+    }
   }
   --dispatch_count_;
 
   if (dispatch_count_ == 0) {
-    for (auto& cmd : command_queue_) {
-      // A non-null EventHandler implies that the operation is a remove.
-      if (cmd.second.fn) {
-        AddImpl(cmd.first, std::move(cmd.second));
-      } else {
-        RemoveImpl(cmd.first, std::move(cmd.second));
+    // Destroying handlers may reentrantly connect or disconnect others, so
+    // only destroy them once all the deferred work has been done.
+    std::vector<PendingHandler> pending;
+    pending.swap(pending_handlers_);
+    std::vector<EventHandler> released;
+
+    for (auto& handler : pending) {
+      // An id of 0 implies that the handler was removed before it was added.
+      if (handler.handler.id != 0) {
+        AddImpl(handler.key, std::move(handler.handler));
       }
     }
-    command_queue_.clear();
+
+    for (HandlerList* list : lists_to_compact_) {
+      list->compaction_pending = false;
+      for (auto& handler : list->handlers) {
+        if (handler.id == 0 && handler.fn) {
+          released.emplace_back(std::move(handler.fn));
+          handler.fn = nullptr;
+        }
+      }
+      MaybeCompact(list);
+    }
+    lists_to_compact_.clear();
   }
 }
 
-size_t Dispatcher::EventHandlerMap::Size() const { return map_.size(); }
+size_t Dispatcher::EventHandlerMap::Size() const { return size_; }
 
-size_t Dispatcher::EventHandlerMap::GetHandlerCount(TypeId type) const {
-  return map_.count(type);
+size_t Dispatcher::EventHandlerMap::GetHandlerCount(Channel channel,
+                                                    TypeId type) const {
+  const HandlerList* list = FindList(MakeKey(channel, type));
+  if (list == nullptr) {
+    return 0;
+  }
+  return list->handlers.size() - list->num_removed;
+}
+
+size_t Dispatcher::EventHandlerMap::GetChannelHandlerCount(
+    Channel channel) const {
+  if (channel == 0) {
+    size_t count = 0;
+    for (const auto& iter : lists_) {
+      if (GetChannel(iter.first) == 0) {
+        count += iter.second.handlers.size() - iter.second.num_removed;
+      }
+    }
+    return count;
+  }
+  auto iter = channel_lists_.find(channel);
+  if (iter == channel_lists_.end()) {
+    return 0;
+  }
+  size_t count = 0;
+  for (const HandlerList* list : iter->second) {
+    count += list->handlers.size() - list->num_removed;
+  }
+  return count;
 }
 
 }  // namespace lull
@@ -93,6 +93,12 @@ namespace lull {
 /// In addition to sending/receiving concrete Event types, clients can connect
 /// and send EventWrapper objects directly.  This allows clients to process
 /// events in a more generic way.
+///
+/// Finally, handlers can be connected to a numbered "channel" (eg. one per
+/// Entity) so that a single Dispatcher can store the handlers of many
+/// independent senders in one table.  Events sent to a channel are only passed
+/// to the handlers connected to that channel, and the regular Connect and Send
+/// functions use channel 0.
 class Dispatcher {
  private:
   /// Internal class that stores the map of TypeId to EventHandlers (and
@@ -106,6 +112,8 @@ class Dispatcher {
   typedef uint32_t ConnectionId;
   /// The underlying functor used for handling events.
   using EventHandler = std::function<void(const EventWrapper&)>;
+  /// Identifies an independent set of handlers within the Dispatcher.
+  using Channel = uint32_t;
 
   /// Connection object returned by Dispatcher::Connect which must be explicitly
   /// disconnected by calling Connection::Disconnect().
@@ -207,6 +215,37 @@ class Dispatcher {
   /// dispatcher.
   ScopedConnection ConnectToAll(EventHandler handler);
 
+  /// As the Connect functions above, but connects the handler to |channel|.  A
+  /// |type| of 0 connects the handler to all events sent to |channel|.
+  template <typename Fn>
+  ScopedConnection ConnectToChannel(Channel channel, Fn&& handler);
+  ScopedConnection ConnectToChannel(Channel channel, TypeId type,
+                                    EventHandler handler);
+  template <typename Fn>
+  Connection ConnectToChannel(Channel channel, const void* owner, Fn&& fn);
+  Connection ConnectToChannel(Channel channel, TypeId type, const void* owner,
+                              EventHandler handler);
+
+  /// Immediately sends the EventWrapper to the functions connected to
+  /// |channel| with the same TypeId as the EventWrapper (or with a TypeId of
+  /// 0).  Unlike Send, this is never queued, even by subclasses.
+  void SendToChannel(Channel channel, const EventWrapper& event);
+
+  /// Disconnects all functions connected to |channel| that listen to events of
+  /// the specified |type| (or to any events if |type| is 0) and are associated
+  /// with the specified |owner|.
+  void DisconnectFromChannel(Channel channel, TypeId type, const void* owner);
+
+  /// Disconnects all functions connected to |channel|.
+  void DisconnectChannel(Channel channel);
+
+  /// Returns the number of functions connected to |channel|.
+  size_t GetChannelHandlerCount(Channel channel) const;
+
+  /// Returns the number of functions connected to |channel| that listen for an
+  /// event of |type|.
+  size_t GetChannelHandlerCount(Channel channel, TypeId type) const;
+
   /// Disconnects all functions listening to the |Event| associated with the
   /// specified |owner|.
   template <typename Event>
@@ -246,14 +285,12 @@ class Dispatcher {
  private:
   /// Creates the actual Handler instance, registers it with the map, and
   /// returns the corresponding Connection object.
-  Connection ConnectImpl(TypeId type, const void* owner, EventHandler handler);
+  Connection ConnectImpl(Channel channel, TypeId type, const void* owner,
+                         EventHandler handler);
 
   /// Removes the Handler that matches the |type| and |owner|.
   void DisconnectImpl(TypeId type, const void* owner);
 
-  /// Autoincrementing value for generating unique connection IDs.
-  ConnectionId id_ = 0;
-
   /// Map of TypeId to EventHandlers.  Uses a shared_ptr to allow Connection
   /// objects to safely "disconnect" from Dispatchers that have been destroyed.
   EventHandlerMapPtr handlers_;
@@ -279,14 +316,28 @@ Dispatcher::ScopedConnection Dispatcher::Connect(Fn&& handler) {
 
 template <typename Fn>
 Dispatcher::Connection Dispatcher::Connect(const void* owner, Fn&& handler) {
+  return ConnectToChannel(0, owner, std::forward<Fn>(handler));
+}
+
+template <typename Fn>
+Dispatcher::ScopedConnection Dispatcher::ConnectToChannel(Channel channel,
+                                                          Fn&& handler) {
+  return ConnectToChannel(channel, nullptr, std::forward<Fn>(handler));
+}
+
+template <typename Fn>
+Dispatcher::Connection Dispatcher::ConnectToChannel(Channel channel,
+                                                    const void* owner,
+                                                    Fn&& handler) {
   using FnType = typename std::remove_reference<Fn>::type;
   using Event = decltype(ConnectHelper(&FnType::operator()));
 
   const TypeId type = GetTypeId<Event>();
-  return ConnectImpl(type, owner, [handler](const EventWrapper& event) mutable {
-    const Event* obj = event.Get<Event>();
-    handler(*obj);
-  });
+  return ConnectImpl(channel, type, owner,
+                     [handler](const EventWrapper& event) mutable {
+                       const Event* obj = event.Get<Event>();
+                       handler(*obj);
+                     });
 }
 
 template <typename Event>
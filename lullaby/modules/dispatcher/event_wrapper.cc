@@ -45,7 +45,7 @@ EventWrapper::EventWrapper(const EventWrapper& rhs)
   name_ = std::move(rhs.name_);
 #endif
   if (rhs.ptr_) {
-    ptr_ = AlignedAlloc(size_, align_);
+    ptr_ = AllocateConcreteEvent();
     owned_ = kTakeOwnership;
     handler_(kCopy, ptr_, rhs.ptr_);
   }
@@ -74,26 +74,46 @@ EventWrapper& EventWrapper::operator=(const EventWrapper& rhs) {
 }
 
 EventWrapper& EventWrapper::operator=(EventWrapper&& rhs) {
-  using std::swap;
-  swap(type_, rhs.type_);
-  swap(size_, rhs.size_);
-  swap(align_, rhs.align_);
-  swap(ptr_, rhs.ptr_);
-  swap(data_, rhs.data_);
-  swap(handler_, rhs.handler_);
-  swap(owned_, rhs.owned_);
-  swap(serializable_, rhs.serializable_);
+  if (this == &rhs) {
+    return *this;
+  }
+
+  DestroyConcreteEvent();
+  type_ = rhs.type_;
+  size_ = rhs.size_;
+  align_ = rhs.align_;
+  data_ = std::move(rhs.data_);
+  handler_ = rhs.handler_;
+  owned_ = rhs.owned_;
+  serializable_ = rhs.serializable_;
 #if LULLABY_TRACK_EVENT_NAMES
-  swap(name_, rhs.name_);
+  name_ = std::move(rhs.name_);
 #endif
+
+  if (rhs.ptr_ == &rhs.storage_) {
+    // The inline Event cannot be handed over, so move it into |storage_|.
+    ptr_ = &storage_;
+    handler_(kMove, ptr_, rhs.ptr_);
+    rhs.DestroyConcreteEvent();
+  } else {
+    ptr_ = rhs.ptr_;
+  }
+  rhs.ptr_ = nullptr;
+  rhs.owned_ = kDoNotOwn;
   return *this;
 }
 
-EventWrapper::~EventWrapper() {
+EventWrapper::~EventWrapper() { DestroyConcreteEvent(); }
+
+void EventWrapper::DestroyConcreteEvent() {
   if (owned_ == kTakeOwnership) {
     handler_(kDestroy, ptr_, nullptr);
-    AlignedFree(ptr_);
+    if (ptr_ != &storage_) {
+      AlignedFree(ptr_);
+    }
   }
+  ptr_ = nullptr;
+  owned_ = kDoNotOwn;
 }
 
 void EventWrapper::SetValue(HashValue key, const Variant& value) {
@@ -18,7 +18,11 @@ limitations under the License.
 #define LULLABY_MODULES_DISPATCHER_EVENT_WRAPPER_H_
 
 #include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 
 #include "lullaby/modules/serialize/serialize.h"
 #include "lullaby/modules/serialize/serialize_traits.h"
@@ -74,9 +78,14 @@ namespace lull {
 /// the lifetime of the EventWrapper must be less than the lifetime of the
 /// wrapped Event.  However, copying the EventWrapper results in the Concrete
 /// event being copied and, furthermore, the copied Event is now owned by the
-/// copied EventWrapper.
+/// copied EventWrapper.  Owned Concrete events of up to kInlineSize bytes are
+/// stored inside the EventWrapper itself, so copying them does not allocate.
 class EventWrapper {
  public:
+  /// Owned Concrete events up to this size are stored without any heap
+  /// allocation.
+  static constexpr size_t kInlineSize = 64;
+
   /// Default constructor.
   EventWrapper() {}
 
@@ -88,6 +97,16 @@ class EventWrapper {
   /// Creates an EventWrapper for a runtime Event representing |type|.
   explicit EventWrapper(TypeId type, string_view name = "");
 
+  /// Creates an EventWrapper for a runtime Event representing |type| whose
+  /// values are stored in the concrete |event|.  The values are only converted
+  /// into a VariantMap if they are requested, which avoids allocating when
+  /// sending events with known values.  As with wrapped concrete events, the
+  /// EventWrapper should not outlive |event|.  Get() cannot be used on the
+  /// returned EventWrapper.
+  template <typename Event>
+  static EventWrapper Wrap(TypeId type, const Event& event,
+                           string_view name = "");
+
   /// Clones the Event wrapped in |rhs| such that |this| now owns a copy of the
   /// Event.
   EventWrapper(const EventWrapper& rhs);
@@ -102,7 +121,7 @@ class EventWrapper {
   /// Event.
   EventWrapper& operator=(const EventWrapper& rhs);
 
-  /// Swaps ownership of the Events in |this| and |rhs|.
+  /// Takes ownership of the Event in |rhs|, leaving |rhs| empty.
   EventWrapper& operator=(EventWrapper&& rhs);
 
   /// Associates |value| with the |key| for a Runtime Event.  Internally, the
@@ -164,6 +183,7 @@ class EventWrapper {
  private:
   enum Operation {
     kCopy,
+    kMove,
     kDestroy,
     kSaveToVariant,
     kLoadFromVariant,
@@ -180,6 +200,8 @@ class EventWrapper {
   /// if |op| is:
   ///   kCopy: copies an |Event| from |dst| to |src| using the Event copy
   ///     constructor.
+  ///   kMove: moves an |Event| from |src| to |dst| using the Event move
+  ///     constructor.
   ///   kDestroy: destroys the |Event| in |dst| using the Event destructor.
   ///   kSaveToVariant: serializes the |Event| in |src| to the VariantMap |dst|.
   ///   kLoadFromVariant: serializes the VariantMap |src| to the |Event| in
@@ -196,6 +218,16 @@ class EventWrapper {
   /// a Concrete Event into a Runtime Event.
   void EnsureRuntimeEventAvailable() const;
 
+  /// Returns uninitialized memory for an owned Concrete Event of |size_| and
+  /// |align_|, using |storage_| if the Event fits in it.
+  void* AllocateConcreteEvent() const;
+
+  /// Destroys the owned Concrete Event and frees its memory.
+  void DestroyConcreteEvent();
+
+  using Storage = std::aligned_storage<kInlineSize,
+                                       alignof(std::max_align_t)>::type;
+
   /// The TypeId of the wrapped event.
   TypeId type_ = 0;
 
@@ -221,6 +253,10 @@ class EventWrapper {
   /// Tracks whether the event can safely be serialized.
   bool serializable_ = false;
 
+  /// Holds the owned concrete event if it fits, in which case |ptr_| points
+  /// here.
+  mutable Storage storage_;
+
 #if LULLABY_TRACK_EVENT_NAMES
   /// Store the string that was hashed to get the type_.  Used for debugging.
   std::string name_ = "";
@@ -243,6 +279,22 @@ EventWrapper::EventWrapper(const Event& event)
 #endif
 }
 
+template <typename Event>
+EventWrapper EventWrapper::Wrap(TypeId type, const Event& event,
+                                string_view name) {
+  EventWrapper wrapper;
+  wrapper.type_ = type;
+  wrapper.size_ = sizeof(Event);
+  wrapper.align_ = alignof(Event);
+  wrapper.ptr_ = const_cast<Event*>(&event);
+  wrapper.handler_ = &Handler<Event>;
+  wrapper.serializable_ = detail::IsSerializable<Event, SaveToVariant>::kValue;
+#if LULLABY_TRACK_EVENT_NAMES
+  wrapper.name_ = std::string(name);
+#endif
+  return wrapper;
+}
+
 template <typename Event>
 const Event* EventWrapper::Get() const {
   if (type_ != lull::GetTypeId<Event>()) {
@@ -290,6 +342,11 @@ void EventWrapper::Handler(Operation op, void* dst, const void* src) {
       new (dst) Event(*other);
       break;
     }
+    case kMove: {
+      Event* other = reinterpret_cast<Event*>(const_cast<void*>(src));
+      new (dst) Event(std::move(*other));
+      break;
+    }
     case kDestroy: {
       Event* event = reinterpret_cast<Event*>(dst);
       event->~Event();
@@ -324,7 +381,7 @@ void EventWrapper::EnsureConcreteEventAvailable() const {
 
   size_ = sizeof(Event);
   align_ = alignof(Event);
-  ptr_ = AlignedAlloc(size_, align_);
+  ptr_ = AllocateConcreteEvent();
   owned_ = kTakeOwnership;
   handler_ = &Handler<Event>;
 
@@ -334,6 +391,13 @@ void EventWrapper::EnsureConcreteEventAvailable() const {
   }
 }
 
+inline void* EventWrapper::AllocateConcreteEvent() const {
+  if (size_ <= sizeof(storage_) && align_ <= alignof(Storage)) {
+    return &storage_;
+  }
+  return AlignedAlloc(size_, align_);
+}
+
 inline void EventWrapper::EnsureRuntimeEventAvailable() const {
   if (data_) {
     return;
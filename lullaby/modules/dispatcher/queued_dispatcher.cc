@@ -18,7 +18,23 @@ limitations under the License.
 
 namespace lull {
 
+QueuedDispatcher::QueuedDispatcher(size_t capacity, bool wait_when_full)
+    : ring_(new BoundedMpscQueue<EventWrapper>(capacity)),
+      wait_when_full_(wait_when_full) {}
+
 void QueuedDispatcher::Dispatch() {
+  dispatch_thread_ = std::this_thread::get_id();
+
+  if (ring_) {
+    // Events are moved out of the preallocated ring buffer, so neither the
+    // EventWrappers nor the small events inside them are allocated here.
+    EventWrapper event;
+    while (ring_->Dequeue(&event) || DequeueOverflow(&event)) {
+      Dispatcher::SendImpl(event);
+    }
+    return;
+  }
+
   std::unique_ptr<EventWrapper> event;
   while (queue_.Dequeue(&event)) {
     Dispatcher::SendImpl(*event);
@@ -26,14 +42,61 @@ void QueuedDispatcher::Dispatch() {
 }
 
 bool QueuedDispatcher::Empty() const {
+  if (ring_) {
+    return ring_->Empty() && !overflowed_;
+  }
   return queue_.Empty();
 }
 
 void QueuedDispatcher::SendImpl(const EventWrapper& event) {
-  // Copy the event in order to increase the lifetime of the event until it
-  // is dispatched.  The original event can now safely go out-of-scope.
-  std::unique_ptr<EventWrapper> clone(new EventWrapper(event));
-  queue_.Enqueue(std::move(clone));
+  if (!ring_) {
+    // Copy the event in order to increase the lifetime of the event until it
+    // is dispatched.  The original event can now safely go out-of-scope.
+    std::unique_ptr<EventWrapper> clone(new EventWrapper(event));
+    queue_.Enqueue(std::move(clone));
+    return;
+  }
+
+  EventWrapper clone(event);
+  const bool on_dispatch_thread =
+      std::this_thread::get_id() == dispatch_thread_.load();
+  if (!on_dispatch_thread || !overflowed_) {
+    while (true) {
+      if (ring_->TryEnqueue(&clone)) {
+        return;
+      } else if (on_dispatch_thread) {
+        // Waiting for the ring buffer to be drained would never complete.
+        break;
+      } else if (!wait_when_full_) {
+        ++num_discarded_events_;
+        return;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(overflow_mutex_);
+  overflow_.emplace_back(std::move(clone));
+  overflowed_ = true;
+}
+
+bool QueuedDispatcher::DequeueOverflow(EventWrapper* out) {
+  if (!overflowed_) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(overflow_mutex_);
+  if (overflow_index_ >= overflow_.size()) {
+    return false;
+  }
+  *out = std::move(overflow_[overflow_index_]);
+  ++overflow_index_;
+  if (overflow_index_ == overflow_.size()) {
+    overflow_.clear();
+    overflow_index_ = 0;
+    overflowed_ = false;
+  }
+  return true;
 }
 
 }  // namespace lull
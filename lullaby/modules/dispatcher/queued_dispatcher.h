@@ -17,8 +17,13 @@ limitations under the License.
 #ifndef LULLABY_MODULES_DISPATCHER_QUEUED_DISPATCHER_H_
 #define LULLABY_MODULES_DISPATCHER_QUEUED_DISPATCHER_H_
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/util/bounded_mpsc_queue.h"
 #include "lullaby/util/thread_safe_queue.h"
 
 namespace lull {
@@ -27,17 +32,35 @@ namespace lull {
 // rather than "sending" them immediately.  Instead, the sending of the events
 // only occurs when the QueuedDispatcher::Dispatch() member function is called.
 //
-// Internally, the QueuedDispatcher uses a ThreadSafeQueue for storing the
+// By default, the QueuedDispatcher uses a ThreadSafeQueue for storing the
 // events.  This allows Events to be sent from multiple threads simultaneously
 // and allows the owner of the QueuedDispatcher to control when those Events are
 // actually handled by the owning thread.
 //
+// Alternatively, the QueuedDispatcher can be created with a fixed capacity, in
+// which case the events are stored in a lock-free ring buffer of preallocated
+// EventWrappers.  This avoids lock contention between the sending threads, and
+// since concrete events of up to EventWrapper::kInlineSize bytes are stored
+// inside the EventWrapper, queuing and dispatching them does not allocate.
+// Larger events and runtime events still allocate their data.
+//
 // On destruction, any events that have been queued but not yet dispatched will
 // be lost.
 class QueuedDispatcher : public Dispatcher {
  public:
+  // Creates a QueuedDispatcher backed by an unbounded queue.
   QueuedDispatcher() {}
 
+  // Creates a QueuedDispatcher backed by a lock-free ring buffer that holds at
+  // least |capacity| events.  If the ring buffer is full when an event is sent
+  // from a thread other than the one calling Dispatch(), the sending thread
+  // will wait until there is room if |wait_when_full| is true (ie. apply
+  // back-pressure to the producer), otherwise the event is discarded.  Events
+  // sent from the dispatching thread itself (including from inside event
+  // handlers) are never discarded; they are stored in a separate overflow queue
+  // instead since waiting would never complete.
+  explicit QueuedDispatcher(size_t capacity, bool wait_when_full = true);
+
   // Dispatches the Events in the queue to the registered handlers on the
   // calling thread.  It is expected that this function will only be called by a
   // single thread at a time.
@@ -46,15 +69,40 @@ class QueuedDispatcher : public Dispatcher {
   // Reports whether the underlying queue is empty or not.
   bool Empty() const;
 
+  // Returns the number of events that were discarded because the ring buffer
+  // was full.
+  size_t GetNumDiscardedEvents() const { return num_discarded_events_; }
+
  private:
   // Overrides the Dispatcher base-class SendImpl function to store the
   // EventWrapper objects in the queue rather than sending them to the
   // registered handlers.
   void SendImpl(const EventWrapper& event) override;
 
+  // Moves the next event from |overflow_| into |out|, returning false if there
+  // are no such events.
+  bool DequeueOverflow(EventWrapper* out);
+
   typedef ThreadSafeQueue<std::unique_ptr<EventWrapper>> EventQueue;
   EventQueue queue_;
 
+  // The ring buffer used instead of |queue_| if a capacity was specified.
+  std::unique_ptr<BoundedMpscQueue<EventWrapper>> ring_;
+  const bool wait_when_full_ = true;
+  std::atomic<size_t> num_discarded_events_{0};
+
+  // The thread that calls Dispatch() (or created this QueuedDispatcher, if
+  // Dispatch() has not been called yet).
+  std::atomic<std::thread::id> dispatch_thread_{std::this_thread::get_id()};
+
+  // Events sent by |dispatch_thread_| while |ring_| was full.  Once an event is
+  // in the overflow queue, all subsequent events from |dispatch_thread_| are
+  // also added to it until it is drained to preserve their order.
+  std::mutex overflow_mutex_;
+  std::vector<EventWrapper> overflow_;
+  size_t overflow_index_ = 0;
+  std::atomic<bool> overflowed_{false};
+
   QueuedDispatcher(const QueuedDispatcher&) = delete;
   QueuedDispatcher& operator=(const QueuedDispatcher&) = delete;
 };
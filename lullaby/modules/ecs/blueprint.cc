@@ -29,6 +29,11 @@ Blueprint::Blueprint(ArrayAccessorFn accessor, size_t count)
   Prepare();
 }
 
+Blueprint::Blueprint(const TypedFlatbuffer* defs, size_t count)
+    : defs_(defs), mode_(kReadMode), count_(count) {
+  Prepare();
+}
+
 void Blueprint::FinishWriting() {
   mode_ = kReadMode;
   index_ = 0;
@@ -49,6 +54,8 @@ void Blueprint::Prepare() {
 
   if (buffer_) {
     PrepareFromBuffer();
+  } else if (defs_) {
+    PrepareFromArray();
   } else if (accessor_) {
     PrepareFromAccessor();
   }
@@ -74,6 +81,14 @@ void Blueprint::PrepareFromAccessor() {
   }
 }
 
+void Blueprint::PrepareFromArray() {
+  const TypedFlatbuffer& def = defs_[index_];
+  if (def.first != 0) {
+    current_.type = BlueprintType::CreateFromSchemaNameHash(def.first);
+    current_.flatbuffer = def.second;
+  }
+}
+
 Blueprint::DefType Blueprint::GetLegacyDefType() const {
   return current_.type.GetSchemaNameHash();
 }
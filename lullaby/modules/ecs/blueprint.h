@@ -80,6 +80,13 @@ class Blueprint {
   using ArrayAccessorFn = std::function<TypedFlatbuffer(size_t index)>;
   Blueprint(ArrayAccessorFn accessor_fn, size_t count);
 
+  // Creates a blueprint that reads flatbuffers directly from a contiguous
+  // array of |count| |defs|.  Unlike the ArrayAccessorFn constructor, no
+  // function is called to extract each object, so this is the fastest way to
+  // iterate pre-resolved data (eg. a CompiledBlueprint).  The array must
+  // outlive the Blueprint.
+  Blueprint(const TypedFlatbuffer* defs, size_t count);
+
   // Returns the current type of the data in the blueprint (for reading).
   template <typename T>
   bool Is() const;
@@ -146,12 +153,14 @@ class Blueprint {
   void Next();
   void PrepareFromBuffer();
   void PrepareFromAccessor();
+  void PrepareFromArray();
   void WriteCurrentObjectToBuffer() const;
 
   // Buffer used to serialize objects into flatbuffer binaries.
   mutable lull::Optional<InwardBuffer> buffer_;
   mutable TypedBlueprintData current_;  // The "current" data to be read.
   ArrayAccessorFn accessor_;  // The function used to extract flatbuffers.
+  const TypedFlatbuffer* defs_ = nullptr;  // The array of flatbuffers to read.
   Mode mode_ = kReadMode;  // The current mode of operation.
   size_t index_ = 0;  // The index of the current data.
   size_t count_ = 0;  // The total number of objects stored in the Blueprint.
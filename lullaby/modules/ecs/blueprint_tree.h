@@ -23,6 +23,8 @@ limitations under the License.
 
 namespace lull {
 
+class CompiledBlueprint;
+
 // BlueprintTree is a blueprint which may have children.
 class BlueprintTree : public Blueprint {
  public:
@@ -39,6 +41,14 @@ class BlueprintTree : public Blueprint {
       : Blueprint(std::move(accessor_fn), count),
         children_(std::move(children)) {}
 
+  // Creates a view of the |node| in a |compiled| blueprint.  The view has no
+  // children of its own; they are instead stored in the CompiledBlueprint.
+  BlueprintTree(const TypedFlatbuffer* defs, size_t count,
+                const CompiledBlueprint* compiled, size_t node)
+      : Blueprint(defs, count),
+        compiled_(compiled),
+        compiled_node_(node) {}
+
   BlueprintTree* NewChild() {
     children_.emplace_back();
     return &children_.back();
@@ -46,8 +56,16 @@ class BlueprintTree : public Blueprint {
 
   std::list<BlueprintTree>* Children() { return &children_; }
 
+  // Returns the CompiledBlueprint this tree is a view of, or nullptr.
+  const CompiledBlueprint* GetCompiledBlueprint() const { return compiled_; }
+
+  // Returns the node in the CompiledBlueprint this tree is a view of.
+  size_t GetCompiledNode() const { return compiled_node_; }
+
  private:
   std::list<BlueprintTree> children_;
+  const CompiledBlueprint* compiled_ = nullptr;
+  size_t compiled_node_ = 0;
 };
 
 }  // namespace lull
@@ -0,0 +1,59 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/ecs/compiled_blueprint.h"
+
+#include <utility>
+
+namespace lull {
+
+const size_t CompiledBlueprint::kRootNode;
+
+CompiledBlueprint::CompiledBlueprint(std::shared_ptr<MappedAsset> asset,
+                                     BlueprintTree tree,
+                                     const GetSystemFn& get_system)
+    : asset_(std::move(asset)), tree_(std::move(tree)) {
+  // Visit the tree breadth-first, so that all the children of a node are
+  // queued (and therefore stored) next to each other.
+  std::vector<BlueprintTree*> queue;
+  queue.push_back(&tree_);
+  for (size_t i = 0; i < queue.size(); ++i) {
+    BlueprintTree* blueprint = queue[i];
+
+    Node node;
+    node.first_component = defs_.size();
+    blueprint->ForEachComponent([&](const Blueprint& blueprint) {
+      const Blueprint::DefType def_type = blueprint.GetLegacyDefType();
+      defs_.emplace_back(def_type, blueprint.GetLegacyDefData());
+      systems_.push_back(get_system(def_type));
+    });
+    node.num_components = defs_.size() - node.first_component;
+
+    node.first_child = queue.size();
+    for (BlueprintTree& child : *blueprint->Children()) {
+      queue.push_back(&child);
+    }
+    node.num_children = queue.size() - node.first_child;
+    nodes_.push_back(node);
+  }
+}
+
+BlueprintTree CompiledBlueprint::GetBlueprintTree(size_t node) const {
+  const Node& info = nodes_[node];
+  return BlueprintTree(GetDefs(info), info.num_components, this, node);
+}
+
+}  // namespace lull
@@ -0,0 +1,103 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_ECS_COMPILED_BLUEPRINT_H_
+#define LULLABY_MODULES_ECS_COMPILED_BLUEPRINT_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"
+#include "lullaby/modules/ecs/blueprint.h"
+#include "lullaby/modules/ecs/blueprint_tree.h"
+#include "lullaby/modules/file/asset.h"
+
+namespace lull {
+
+class System;
+
+// An immutable, flattened form of a BlueprintTree that can be shared by all
+// the Entities created from the same blueprint.
+//
+// The nodes of the tree are stored in breadth-first order, so the children of
+// each node are contiguous, and every component has the System that will
+// create it resolved up front.  The component defs and their Systems are kept
+// in two parallel arrays shared by all nodes, so the components of a node are
+// read with a linear scan instead of through a per-component accessor.  This
+// allows the EntityFactory to create Entities from a cached CompiledBlueprint
+// without re-parsing the blueprint data or looking up Systems for each
+// component.
+class CompiledBlueprint {
+ public:
+  // Returns the System that creates components of the given type, or nullptr.
+  using GetSystemFn = std::function<System*(Blueprint::DefType def_type)>;
+
+  // A single Entity in the tree.  Its components and children are ranges in the
+  // component and node arrays respectively.
+  struct Node {
+    size_t first_component = 0;
+    size_t num_components = 0;
+    size_t first_child = 0;
+    size_t num_children = 0;
+  };
+
+  // The node from which the root Entity is created.
+  static const size_t kRootNode = 0;
+
+  // Flattens |tree|, using |get_system| to resolve the System of each
+  // component.  The |asset| containing the data referenced by |tree| is kept
+  // alive for the lifetime of the CompiledBlueprint.
+  CompiledBlueprint(std::shared_ptr<MappedAsset> asset, BlueprintTree tree,
+                    const GetSystemFn& get_system);
+
+  CompiledBlueprint(const CompiledBlueprint&) = delete;
+  CompiledBlueprint& operator=(const CompiledBlueprint&) = delete;
+
+  // Returns the node at index |node|.
+  const Node& GetNode(size_t node) const { return nodes_[node]; }
+
+  // Returns the number of nodes in the tree.
+  size_t GetNumNodes() const { return nodes_.size(); }
+
+  // Returns the component defs of |node|.
+  const Blueprint::TypedFlatbuffer* GetDefs(const Node& node) const {
+    return defs_.data() + node.first_component;
+  }
+
+  // Returns the Systems that create the components of |node|, in the same
+  // order as GetDefs().  Unknown components have a null System.
+  System* const* GetSystems(const Node& node) const {
+    return systems_.data() + node.first_component;
+  }
+
+  // Returns a lightweight BlueprintTree that reads the components of |node|.
+  // The returned tree has no children of its own; instead it refers back to
+  // this CompiledBlueprint so that the EntityFactory can continue to create
+  // its descendants from the compiled data.  It must not outlive this object.
+  BlueprintTree GetBlueprintTree(size_t node) const;
+
+ private:
+  std::shared_ptr<MappedAsset> asset_;
+  BlueprintTree tree_;
+  std::vector<Node> nodes_;
+  std::vector<Blueprint::TypedFlatbuffer> defs_;
+  std::vector<System*> systems_;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_MODULES_ECS_COMPILED_BLUEPRINT_H_
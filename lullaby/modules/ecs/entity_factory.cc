@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "lullaby/modules/ecs/entity_factory.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
@@ -24,6 +25,7 @@ limitations under the License.
 #include "lullaby/modules/ecs/blueprint_writer.h"
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/modules/file/asset_loader.h"
+#include "lullaby/modules/file/asset_reloader.h"
 #include "lullaby/modules/script/function_binder.h"
 #include "lullaby/util/filename.h"
 #include "lullaby/util/logging.h"
@@ -83,6 +85,15 @@ void EntityFactory::Initialize() {
   InitializeBlueprintConverter();
 }
 
+void EntityFactory::ForEachSystem(
+    const std::function<void(TypeId, const char*, System*)>& fn) const {
+  for (const auto& iter : systems_) {
+    auto name = system_names_.find(iter.first);
+    fn(iter.first, name != system_names_.end() ? name->second : "",
+       iter.second);
+  }
+}
+
 void EntityFactory::InitializeBlueprintConverter() {
   FlatbufferConverter* converter = CreateFlatbufferConverter(
       detail::BlueprintBuilder::kBlueprintFileIdentifier);
@@ -101,6 +112,13 @@ void EntityFactory::InitializeBlueprintConverter() {
 void EntityFactory::RegisterDef(TypeId system_type,
                                 Blueprint::DefType def_type) {
   type_map_[def_type] = system_type;
+  auto system = systems_.find(system_type);
+  if (system != systems_.end()) {
+    def_systems_[def_type] = system->second;
+  } else {
+    def_systems_.erase(def_type);
+  }
+  compiled_blueprints_.Reset();
 }
 
 void EntityFactory::InitializeSystems() {
@@ -109,13 +127,21 @@ void EntityFactory::InitializeSystems() {
   }
 }
 
-void EntityFactory::AddSystem(TypeId system_type, System* system) {
+void EntityFactory::AddSystem(TypeId system_type, const char* name,
+                              System* system) {
   if (!system) {
     return;
   }
   auto iter = systems_.find(system_type);
   if (iter == systems_.end()) {
     systems_.emplace(system_type, system);
+    system_names_.emplace(system_type, name);
+    for (const auto& entry : type_map_) {
+      if (entry.second == system_type) {
+        def_systems_[entry.first] = system;
+      }
+    }
+    compiled_blueprints_.Reset();
   }
 }
 
@@ -148,12 +174,17 @@ Entity EntityFactory::Create() {
 }
 
 Entity EntityFactory::Create(const std::string& name) {
-  auto asset = GetBlueprintAsset(name);
-  if (asset == nullptr) {
-    LOG(ERROR) << "No such blueprint: " << name;
+  auto blueprint = GetCompiledBlueprint(name);
+  if (blueprint == nullptr) {
+    return kNullEntity;
+  }
+
+  const Entity entity = Create();
+  entity_to_blueprint_map_[entity] = name;
+  if (!CreateImpl(entity, blueprint.get(), CompiledBlueprint::kRootNode)) {
     return kNullEntity;
   }
-  return CreateFromBlueprint(asset->GetData(), asset->GetSize(), name);
+  return entity;
 }
 
 Entity EntityFactory::Create(Blueprint* blueprint) {
@@ -172,13 +203,17 @@ Entity EntityFactory::Create(BlueprintTree* blueprint) {
 }
 
 Entity EntityFactory::Create(Entity entity, const std::string& name) {
-  auto asset = GetBlueprintAsset(name);
-  if (!asset) {
-    LOG(ERROR) << "No such blueprint: " << name;
+  auto blueprint = GetCompiledBlueprint(name);
+  if (!blueprint) {
+    return kNullEntity;
+  }
+  if (entity == kNullEntity) {
+    LOG(DFATAL) << "Cannot create null entity: " << name;
     return kNullEntity;
   }
 
-  if (!CreateImpl(entity, name, asset->GetData(), asset->GetSize())) {
+  entity_to_blueprint_map_[entity] = name;
+  if (!CreateImpl(entity, blueprint.get(), CompiledBlueprint::kRootNode)) {
     LOG(ERROR) << "Could not create from blueprint: " << name;
     return kNullEntity;
   }
@@ -194,6 +229,49 @@ Entity EntityFactory::Create(Entity entity, BlueprintTree* blueprint) {
   return entity;
 }
 
+Entity EntityFactory::CreateWithoutChildren(Entity entity,
+                                            BlueprintTree* blueprint) {
+  skip_children_ = true;
+  return Create(entity, blueprint);
+}
+
+Entity EntityFactory::CreateChildWithoutChildren(Entity parent,
+                                                 BlueprintTree* blueprint) {
+  skip_children_ = true;
+  const Entity child = create_child_fn_(parent, blueprint);
+  // In case the create child function failed before creating the child.
+  skip_children_ = false;
+  return child;
+}
+
+std::vector<Entity> EntityFactory::CreateBatch(const std::string& name,
+                                               size_t count) {
+  std::vector<Entity> entities;
+  if (count == 0) {
+    return entities;
+  }
+
+  auto blueprint = GetCompiledBlueprint(name);
+  if (!blueprint) {
+    return entities;
+  }
+
+  entities.reserve(count);
+  {
+    Lock lock(mutex_);
+    entity_to_blueprint_map_.reserve(entity_to_blueprint_map_.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+      const Entity entity(++entity_generator_);
+      CHECK_NE(entity, kNullEntity) << "Overflow on Entity generation.";
+      entity_to_blueprint_map_[entity] = name;
+      entities.push_back(entity);
+    }
+  }
+
+  CreateBatchImpl(entities, blueprint.get());
+  return entities;
+}
+
 Span<uint8_t> EntityFactory::Finalize(Blueprint* blueprint,
                                       string_view identifier) {
   Span<uint8_t> data;
@@ -245,7 +323,16 @@ bool EntityFactory::CreateImpl(Entity entity, const std::string& name,
 }
 
 bool EntityFactory::CreateImpl(Entity entity, BlueprintTree* blueprint) {
-  return CreateImpl(entity, blueprint, blueprint->Children());
+  // Views of a CompiledBlueprint (eg. the children passed to create_child_fn_)
+  // keep their descendants in the CompiledBlueprint itself.
+  const bool create_children = !skip_children_;
+  skip_children_ = false;
+  if (blueprint && blueprint->GetCompiledBlueprint()) {
+    return CreateImpl(entity, blueprint->GetCompiledBlueprint(),
+                      blueprint->GetCompiledNode(), create_children);
+  }
+  return CreateImpl(entity, blueprint,
+                    create_children ? blueprint->Children() : nullptr);
 }
 
 bool EntityFactory::CreateImpl(Entity entity, Blueprint* blueprint,
@@ -288,7 +375,143 @@ bool EntityFactory::CreateImpl(Entity entity, Blueprint* blueprint,
   return true;
 }
 
-std::shared_ptr<SimpleAsset> EntityFactory::GetBlueprintAsset(
+void EntityFactory::CreateBatchImpl(Span<Entity> entities,
+                                    BlueprintTree* blueprint) {
+  // Look up the System for each component once, rather than once per Entity.
+  std::vector<System*> systems;
+  blueprint->ForEachComponent([&](const Blueprint& blueprint) {
+    System* system = GetSystem(blueprint.GetLegacyDefType());
+    if (system) {
+      system->CreateMany(entities, blueprint);
+    } else {
+      LOG(DFATAL) << "Unknown system " << blueprint.GetLegacyDefType()
+                  << " when creating entities from blueprint: "
+                  << entity_to_blueprint_map_[entities[0]];
+    }
+    systems.push_back(system);
+  });
+  // As with CreateImpl, construct children after all the parents have been
+  // created, but before parent post-creation.
+  for (const Entity entity : entities) {
+    for (auto& child_blueprint : *blueprint->Children()) {
+      create_child_fn_(entity, &child_blueprint);
+    }
+  }
+  size_t index = 0;
+  blueprint->ForEachComponent([&](const Blueprint& blueprint) {
+    System* system = systems[index++];
+    if (system) {
+      system->PostCreateMany(entities, blueprint);
+    }
+  });
+}
+
+bool EntityFactory::CreateImpl(Entity entity,
+                               const CompiledBlueprint* blueprint,
+                               size_t node, bool create_children) {
+  if (entity == kNullEntity) {
+    LOG(DFATAL) << "Cannot create null entity";
+    return false;
+  }
+
+  const CompiledBlueprint::Node& info = blueprint->GetNode(node);
+  System* const* systems = blueprint->GetSystems(info);
+  BlueprintTree components_blueprint = blueprint->GetBlueprintTree(node);
+
+  size_t index = 0;
+  components_blueprint.ForEachComponent([&](const Blueprint& blueprint) {
+    System* system = systems[index++];
+    if (system) {
+      system->CreateComponent(entity, blueprint);
+    } else {
+      LOG(DFATAL) << "Unknown system " << blueprint.GetLegacyDefType()
+                  << " when creating entity " << entity
+                  << " from blueprint: " << entity_to_blueprint_map_[entity];
+    }
+  });
+  // As with the uncompiled CreateImpl, construct children after parent
+  // creation, but before parent post-creation.
+  const size_t num_children = create_children ? info.num_children : 0;
+  for (size_t i = 0; i < num_children; ++i) {
+    BlueprintTree child = blueprint->GetBlueprintTree(info.first_child + i);
+    create_child_fn_(entity, &child);
+  }
+  index = 0;
+  components_blueprint.ForEachComponent([&](const Blueprint& blueprint) {
+    System* system = systems[index++];
+    if (system) {
+      system->PostCreateComponent(entity, blueprint);
+    }
+  });
+
+  return true;
+}
+
+void EntityFactory::CreateBatchImpl(Span<Entity> entities,
+                                    const CompiledBlueprint* blueprint) {
+  const CompiledBlueprint::Node& info =
+      blueprint->GetNode(CompiledBlueprint::kRootNode);
+  System* const* systems = blueprint->GetSystems(info);
+  BlueprintTree components_blueprint =
+      blueprint->GetBlueprintTree(CompiledBlueprint::kRootNode);
+
+  size_t index = 0;
+  components_blueprint.ForEachComponent([&](const Blueprint& blueprint) {
+    System* system = systems[index++];
+    if (system) {
+      system->CreateMany(entities, blueprint);
+    } else {
+      LOG(DFATAL) << "Unknown system " << blueprint.GetLegacyDefType()
+                  << " when creating entities from blueprint: "
+                  << entity_to_blueprint_map_[entities[0]];
+    }
+  });
+  for (const Entity entity : entities) {
+    for (size_t i = 0; i < info.num_children; ++i) {
+      BlueprintTree child = blueprint->GetBlueprintTree(info.first_child + i);
+      create_child_fn_(entity, &child);
+    }
+  }
+  index = 0;
+  components_blueprint.ForEachComponent([&](const Blueprint& blueprint) {
+    System* system = systems[index++];
+    if (system) {
+      system->PostCreateMany(entities, blueprint);
+    }
+  });
+}
+
+std::shared_ptr<CompiledBlueprint> EntityFactory::GetCompiledBlueprint(
+    const std::string& name) {
+  std::string filename = name;
+  if (!EndsWith(filename, ".json")) {
+    filename += ".bin";
+  }
+
+  const HashValue key = Hash(filename.c_str());
+
+  return compiled_blueprints_.Create(
+      key, [&]() -> std::shared_ptr<CompiledBlueprint> {
+        auto asset = GetBlueprintAsset(name);
+        if (asset == nullptr) {
+          LOG(ERROR) << "No such blueprint: " << name;
+          return nullptr;
+        }
+        auto tree =
+            CreateBlueprintFromData(name, asset->GetData(), asset->GetSize());
+        if (!tree) {
+          LOG(ERROR) << "Could not create from blueprint: " << name;
+          return nullptr;
+        }
+        return std::make_shared<CompiledBlueprint>(
+            std::move(asset), std::move(*tree),
+            [this](Blueprint::DefType def_type) {
+              return GetSystem(def_type);
+            });
+      });
+}
+
+std::shared_ptr<MappedAsset> EntityFactory::GetBlueprintAsset(
     const std::string& name) {
   std::string filename = name;
   if (!EndsWith(filename, ".json")) {
@@ -298,8 +521,15 @@ std::shared_ptr<SimpleAsset> EntityFactory::GetBlueprintAsset(
   const HashValue key = Hash(filename.c_str());
 
   auto asset = blueprints_.Create(key, [&]() {
+    AssetReloader* asset_reloader = registry_->Get<AssetReloader>();
+    if (asset_reloader) {
+      asset_reloader->AddResource(key,
+                                  [this, name]() { ReloadBlueprint(name); });
+      asset_reloader->AddFileDependency(key, filename);
+    }
+
     AssetLoader* asset_loader = registry_->Get<AssetLoader>();
-    return asset_loader->LoadNow<SimpleAsset>(filename);
+    return asset_loader->LoadNow<MappedAsset>(filename);
   });
 
   if (asset->GetSize() == 0) {
@@ -316,7 +546,7 @@ Optional<BlueprintTree> EntityFactory::CreateBlueprint(
 }
 
 Optional<BlueprintTree> EntityFactory::CreateBlueprintFromAsset(
-    const std::string& name, const SimpleAsset* asset) {
+    const std::string& name, const MappedAsset* asset) {
   if (asset == nullptr) {
     LOG(ERROR) << "No such blueprint: " << name;
     return NullOpt;
@@ -368,6 +598,42 @@ void EntityFactory::ForgetCachedBlueprint(const std::string& name) {
     filename += ".bin";
   }
   blueprints_.Erase(Hash(filename));
+  compiled_blueprints_.Erase(Hash(filename));
+}
+
+size_t EntityFactory::ReloadBlueprint(const std::string& name) {
+  ForgetCachedBlueprint(name);
+  // Pooled Entities may not match the new version of the blueprint closely
+  // enough to be reset in place, so discard them instead.
+  ClearPool(name);
+
+  std::vector<Entity> entities;
+  for (const auto& iter : entity_to_blueprint_map_) {
+    if (iter.second == name) {
+      entities.push_back(iter.first);
+    }
+  }
+  if (entities.empty()) {
+    return 0;
+  }
+
+  // Make sure that the new version is usable before tearing anything down.
+  if (GetCompiledBlueprint(name) == nullptr) {
+    LOG(ERROR) << "Unable to reload blueprint: " << name;
+    return 0;
+  }
+
+  size_t count = 0;
+  for (Entity entity : entities) {
+    // Re-creating one Entity may have destroyed another (eg. its child).
+    auto iter = entity_to_blueprint_map_.find(entity);
+    if (iter == entity_to_blueprint_map_.end() || iter->second != name) {
+      continue;
+    }
+    recreate_fn_(entity, name);
+    ++count;
+  }
+  return count;
 }
 
 void EntityFactory::Destroy(Entity entity) {
@@ -375,12 +641,158 @@ void EntityFactory::Destroy(Entity entity) {
     return;
   }
 
+  if (pooled_entities_.erase(entity) > 0) {
+    auto& pool = pools_[entity_to_blueprint_map_[entity]];
+    pool.erase(std::find(pool.begin(), pool.end(), entity));
+  }
   entity_to_blueprint_map_.erase(entity);
   for (auto& iter : systems_) {
     iter.second->Destroy(entity);
   }
 }
 
+Entity EntityFactory::AcquirePooled(const std::string& name) {
+  auto iter = pools_.find(name);
+  if (iter == pools_.end() || iter->second.empty()) {
+    return Create(name);
+  }
+
+  const Entity entity = iter->second.back();
+  iter->second.pop_back();
+  pooled_entities_.erase(entity);
+  if (!ResetPooledEntity(entity, name)) {
+    Destroy(entity);
+    return kNullEntity;
+  }
+  return entity;
+}
+
+bool EntityFactory::ReleaseToPool(Entity entity) {
+  auto iter = entity_to_blueprint_map_.find(entity);
+  if (iter == entity_to_blueprint_map_.end() || iter->second.empty()) {
+    return false;
+  }
+  if (pooled_entities_.count(entity) > 0) {
+    return true;
+  }
+  const std::string& name = iter->second;
+  auto blueprint = GetCompiledBlueprint(name);
+  if (blueprint == nullptr) {
+    return false;
+  }
+
+  // Components added after creation would otherwise leak into the next use of
+  // the Entity.
+  const CompiledBlueprint::Node& info =
+      blueprint->GetNode(CompiledBlueprint::kRootNode);
+  System* const* systems = blueprint->GetSystems(info);
+  for (auto& system_iter : systems_) {
+    System* system = system_iter.second;
+    bool in_blueprint = false;
+    for (size_t i = 0; i < info.num_components; ++i) {
+      if (systems[i] == system) {
+        in_blueprint = true;
+        break;
+      }
+    }
+    if (!in_blueprint) {
+      system->Destroy(entity);
+    }
+  }
+
+  release_fn_(entity);
+  pools_[name].push_back(entity);
+  pooled_entities_.insert(entity);
+  return true;
+}
+
+bool EntityFactory::ResetPooledEntity(Entity entity, const std::string& name) {
+  auto blueprint = GetCompiledBlueprint(name);
+  if (blueprint == nullptr) {
+    return false;
+  }
+
+  const CompiledBlueprint::Node& info =
+      blueprint->GetNode(CompiledBlueprint::kRootNode);
+  if (info.num_children > 0) {
+    // The Entity's descendants may have changed since it was created, so
+    // rebuild the whole hierarchy.
+    recreate_fn_(entity, name);
+    return true;
+  }
+
+  // Reset the Components in place where possible, and collect the Systems that
+  // need to re-create them instead.  A System is either reset or re-created as
+  // a whole since it may own several of the Entity's Components.
+  System* const* systems = blueprint->GetSystems(info);
+  BlueprintTree components_blueprint =
+      blueprint->GetBlueprintTree(CompiledBlueprint::kRootNode);
+  std::vector<System*> recreate;
+  size_t index = 0;
+  components_blueprint.ForEachComponent([&](const Blueprint& blueprint) {
+    System* system = systems[index++];
+    if (system && !system->ResetComponent(entity, blueprint) &&
+        std::find(recreate.begin(), recreate.end(), system) == recreate.end()) {
+      recreate.push_back(system);
+    }
+  });
+  if (recreate.empty()) {
+    return true;
+  }
+
+  for (System* system : recreate) {
+    system->Destroy(entity);
+  }
+  const auto needs_recreate = [&](System* system) {
+    return std::find(recreate.begin(), recreate.end(), system) !=
+           recreate.end();
+  };
+  index = 0;
+  components_blueprint.ForEachComponent([&](const Blueprint& blueprint) {
+    System* system = systems[index++];
+    if (system && needs_recreate(system)) {
+      system->CreateComponent(entity, blueprint);
+    }
+  });
+  index = 0;
+  components_blueprint.ForEachComponent([&](const Blueprint& blueprint) {
+    System* system = systems[index++];
+    if (system && needs_recreate(system)) {
+      system->PostCreateComponent(entity, blueprint);
+    }
+  });
+  return true;
+}
+
+void EntityFactory::ClearPool(const std::string& name) {
+  auto iter = pools_.find(name);
+  if (iter == pools_.end()) {
+    return;
+  }
+  std::vector<Entity> pool;
+  pool.swap(iter->second);
+  for (const Entity entity : pool) {
+    pooled_entities_.erase(entity);
+    Destroy(entity);
+  }
+}
+
+void EntityFactory::ClearPools() {
+  std::vector<std::string> names;
+  names.reserve(pools_.size());
+  for (const auto& iter : pools_) {
+    names.push_back(iter.first);
+  }
+  for (const std::string& name : names) {
+    ClearPool(name);
+  }
+}
+
+size_t EntityFactory::GetPoolSize(const std::string& name) const {
+  auto iter = pools_.find(name);
+  return iter != pools_.end() ? iter->second.size() : 0;
+}
+
 void EntityFactory::QueueForDestruction(Entity entity) {
   if (entity == kNullEntity) {
     return;
@@ -405,6 +817,20 @@ void EntityFactory::DestroyQueuedEntities() {
   }
 }
 
+bool EntityFactory::DestroyNextQueuedEntity() {
+  Entity entity = kNullEntity;
+  {
+    Lock lock(mutex_);
+    if (pending_destroy_.empty()) {
+      return false;
+    }
+    entity = pending_destroy_.front();
+    pending_destroy_.pop();
+  }
+  Destroy(entity);
+  return true;
+}
+
 size_t EntityFactory::GetFlatbufferConverterCount() {
   return converters_.size();
 }
@@ -433,13 +859,9 @@ EntityFactory::FlatbufferConverter* EntityFactory::GetFlatbufferConverter(
 }
 
 System* EntityFactory::GetSystem(const Blueprint::DefType def_type) {
-  // Don't pollute the type and systems maps with null values.
-  const auto type_id = type_map_.find(def_type);
-  if (type_id == type_map_.end()) {
-    return nullptr;
-  }
-  const auto system = systems_.find(type_id->second);
-  if (system == systems_.end()) {
+  // Don't pollute the systems map with null values.
+  const auto system = def_systems_.find(def_type);
+  if (system == def_systems_.end()) {
     return nullptr;
   }
   return system->second;
@@ -23,11 +23,14 @@ limitations under the License.
 #include <queue>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "flatbuffers/flatbuffers.h"
 #include "lullaby/modules/ecs/blueprint.h"
 #include "lullaby/modules/ecs/blueprint_tree.h"
+#include "lullaby/modules/ecs/compiled_blueprint.h"
 #include "lullaby/modules/ecs/component_handlers.h"
 #include "lullaby/modules/file/asset.h"
 #include "lullaby/util/dependency_checker.h"
@@ -35,6 +38,7 @@ limitations under the License.
 #include "lullaby/util/optional.h"
 #include "lullaby/util/registry.h"
 #include "lullaby/util/resource_manager.h"
+#include "lullaby/util/span.h"
 #include "lullaby/util/string_view.h"
 #include "lullaby/util/typeid.h"
 
@@ -101,6 +105,11 @@ class EntityFactory {
   // have been created.
   void Initialize();
 
+  // Invokes |fn| with the TypeId, name and instance of every System added to
+  // the EntityFactory.
+  void ForEachSystem(
+      const std::function<void(TypeId, const char*, System*)>& fn) const;
+
   // Registers a System with a specific ComponentDefT type, the
   // Lullaby-specific autogenerated wrapper type for a corresponding flatbuffer
   // ComponentDef type.
@@ -136,6 +145,25 @@ class EntityFactory {
   // of a blueprint.
   Entity Create(Entity entity, BlueprintTree* blueprint);
 
+  // Similar to Create(entity, blueprint), but does not create the children of
+  // the |blueprint|.  Used to instantiate large hierarchies a few Entities at a
+  // time (see ProgressiveLoader).  Note that the Components of |entity| are
+  // post-created before its children exist.
+  Entity CreateWithoutChildren(Entity entity, BlueprintTree* blueprint);
+
+  // Creates a new child of |parent| from the |blueprint| using the create child
+  // function (see SetCreateChildFn), but without creating the children of the
+  // |blueprint|.  Returns the child, or kNullEntity if unsuccessful.
+  Entity CreateChildWithoutChildren(Entity parent, BlueprintTree* blueprint);
+
+  // Creates |count| new Entities from the EntityDef Blueprint specified by
+  // |name|.  This is equivalent to calling Create(name) |count| times, but the
+  // blueprint is only loaded and resolved once, and each System creates all of
+  // its Components in a single call to System::CreateMany.  Children in the
+  // blueprint are still created individually for each Entity.  Returns an
+  // empty vector if unsuccessful.
+  std::vector<Entity> CreateBatch(const std::string& name, size_t count);
+
   // Creates a new Entity from raw blueprint data.  This data should not be
   // confused with the Blueprint class.  Instead, it is raw binary data from
   // operations such as loading off disk.  Returns kNullEntity if unsuccessful.
@@ -159,12 +187,17 @@ class EntityFactory {
   // Destroys the Entities marked for destruction by QueueForDestruction.
   void DestroyQueuedEntities();
 
+  // Destroys the next Entity marked for destruction by QueueForDestruction.
+  // Returns false if there are none.  This can be registered as work with a
+  // FrameBudget to spread destruction over multiple frames.
+  bool DestroyNextQueuedEntity();
+
   // Returns a map of entities to the name of the blueprint from which they were
   // created.
   const BlueprintMap& GetEntityToBlueprintMap() const;
 
   // Gets or loads off disk a blueprint asset with the given |name|.
-  std::shared_ptr<SimpleAsset> GetBlueprintAsset(const std::string& name);
+  std::shared_ptr<MappedAsset> GetBlueprintAsset(const std::string& name);
 
   // Sets the function used to make one entity a child of another.  Typically
   // set by the Transform system when it initializes.
@@ -175,9 +208,57 @@ class EntityFactory {
   // Create a blueprint without creating an entity.
   Optional<BlueprintTree> CreateBlueprint(const std::string& name);
 
-  // Stop caching the named blueprint.
+  // Stop caching the named blueprint, both its data and its compiled form.
   void ForgetCachedBlueprint(const std::string& name);
 
+  // Reloads the named blueprint and re-creates, in place, all Entities that
+  // were created from it so that they keep their Entity ids. Returns the number
+  // of Entities re-created. If the blueprint can no longer be loaded, the
+  // existing Entities are left untouched.
+  //
+  // When an AssetReloader is in the Registry, this is called automatically
+  // whenever a blueprint file changes.
+  size_t ReloadBlueprint(const std::string& name);
+
+  // Sets the function used by ReloadBlueprint to re-create an Entity from the
+  // named blueprint. By default the Entity is destroyed and created again;
+  // the Transform system overrides this so that the Entity keeps its place in
+  // the scene graph.
+  using RecreateFn =
+      std::function<void(Entity entity, const std::string& name)>;
+  void SetRecreateFn(RecreateFn fn) { recreate_fn_ = std::move(fn); }
+
+  // Returns an Entity created from the blueprint |name|, reusing an Entity
+  // previously passed to ReleaseToPool() if one is available.  A reused Entity
+  // keeps its id and has its Components reset to the blueprint's data: Systems
+  // that support System::ResetComponent() reset their Component in place, and
+  // the Components of other Systems are destroyed and re-created.  Blueprints
+  // with children are always fully re-created.  Returns kNullEntity if
+  // unsuccessful.
+  Entity AcquirePooled(const std::string& name);
+
+  // Releases an Entity that was created from a named blueprint into a pool for
+  // that blueprint instead of destroying it, so that it can be re-acquired with
+  // AcquirePooled().  Components from Systems not in the blueprint are
+  // destroyed, and the Entity is detached from its parent and disabled when the
+  // Transform system is present.  Returns false, and leaves the Entity
+  // untouched, if it was not created from a named blueprint.
+  bool ReleaseToPool(Entity entity);
+
+  // Destroys all the Entities pooled for the blueprint |name|.
+  void ClearPool(const std::string& name);
+
+  // Destroys all pooled Entities.
+  void ClearPools();
+
+  // Returns the number of Entities pooled for the blueprint |name|.
+  size_t GetPoolSize(const std::string& name) const;
+
+  // Sets the function used by ReleaseToPool to deactivate an Entity.  Typically
+  // set by the Transform system when it initializes.
+  using ReleaseFn = std::function<void(Entity entity)>;
+  void SetReleaseFn(ReleaseFn fn) { release_fn_ = std::move(fn); }
+
   // //////////////////////////////////////////////////////////////////////////
   // //////////////////////// DEPRECATED METHODS BELOW ////////////////////////
   // //////////////////////////////////////////////////////////////////////////
@@ -262,6 +343,9 @@ class EntityFactory {
   // ComponentDef type (hashed) to System TypeId map.
   using TypeMap = std::unordered_map<Blueprint::DefType, TypeId>;
 
+  // ComponentDef type (hashed) to System instance map.
+  using DefSystemMap = std::unordered_map<Blueprint::DefType, System*>;
+
   // ComponentDef type list used during the entity creation process.
   using TypeList = std::vector<Blueprint::DefType>;
 
@@ -324,16 +408,39 @@ class EntityFactory {
                   std::list<BlueprintTree>* children = nullptr);
   bool CreateImpl(Entity entity, BlueprintTree* blueprint);
 
+  // Performs the actual creation of all the |entities| using the same
+  // |blueprint|.
+  void CreateBatchImpl(Span<Entity> entities, BlueprintTree* blueprint);
+
+  // Performs the actual creation of the |entity| using the |node| of the
+  // |blueprint|, using the Systems resolved when it was compiled.
+  bool CreateImpl(Entity entity, const CompiledBlueprint* blueprint,
+                  size_t node, bool create_children = true);
+
+  // Performs the actual creation of all the |entities| using the root node of
+  // the same compiled |blueprint|.
+  void CreateBatchImpl(Span<Entity> entities,
+                       const CompiledBlueprint* blueprint);
+
+  // Gets, or loads and compiles, the blueprint with the given |name|.  Returns
+  // nullptr if the blueprint could not be loaded or parsed.
+  std::shared_ptr<CompiledBlueprint> GetCompiledBlueprint(
+      const std::string& name);
+
+  // Resets the Components of the pooled |entity| to the data in the blueprint
+  // |name|.  Returns false if the blueprint could not be loaded.
+  bool ResetPooledEntity(Entity entity, const std::string& name);
+
   // Create a blueprint from asset without creating an entity.
   Optional<BlueprintTree> CreateBlueprintFromAsset(const std::string& name,
-                                                   const SimpleAsset* asset);
+                                                   const MappedAsset* asset);
   // Create a blueprint from data without creating an entity.
   Optional<BlueprintTree> CreateBlueprintFromData(const std::string& name,
                                                   const void* data,
                                                   size_t size);
 
   // Caches the System mapped to the type.
-  void AddSystem(TypeId system_type, System* system);
+  void AddSystem(TypeId system_type, const char* name, System* system);
 
   // Gets a System associated with a DefType.
   System* GetSystem(const Blueprint::DefType def_type);
@@ -355,7 +462,12 @@ class EntityFactory {
   Registry* registry_;
 
   // ResourceManager to cache loaded Entity blueprints.
-  ResourceManager<SimpleAsset> blueprints_;
+  ResourceManager<MappedAsset> blueprints_;
+
+  // ResourceManager to cache compiled Entity blueprints.  Since these store
+  // the System for each component, they are discarded whenever the mapping
+  // of component types to Systems changes.
+  ResourceManager<CompiledBlueprint> compiled_blueprints_;
 
   // List of entity schemas that have been registered.  Most apps will only ever
   // need one converter unless they are compiled into the same binary as other
@@ -371,25 +483,47 @@ class EntityFactory {
   // Map of TypeId to System instances.
   SystemMap systems_;
 
+  // Map of TypeId to the name of each System in systems_.
+  std::unordered_map<TypeId, const char*> system_names_;
+
   // Map of ComponentDef type (hash) to System TypeIds.
   TypeMap type_map_;
 
+  // Map of ComponentDef type (hash) directly to System instances, combining
+  // type_map_ and systems_ so that GetSystem only needs a single lookup.
+  DefSystemMap def_systems_;
+
   // Map of created Entities.
   BlueprintMap entity_to_blueprint_map_;
 
   // Autoincrementing value to generate unique Entity IDs.
   uint32_t entity_generator_;
 
+  // Released Entities available for reuse, by blueprint name.
+  std::unordered_map<std::string, std::vector<Entity>> pools_;
+
+  // All the Entities currently in |pools_|.
+  std::unordered_set<Entity> pooled_entities_;
+
   // Queue of Entities pending destruction.
   std::queue<Entity> pending_destroy_;
 
   // Mutex for ensuring thread-safe operations.
   std::mutex mutex_;
 
+  // Set by CreateChildWithoutChildren so that the next BlueprintTree created
+  // through the create child function skips its children.
+  bool skip_children_ = false;
+
   // Default create_child_fn simply creates the child without a parent for cases
   // where there's no TransformSystem.  If the TransformSystem is used, it
   // provides it's own implementation which establishes the expected parent /
   // child relationship.
+  RecreateFn recreate_fn_ = [this](Entity entity, const std::string& name) {
+    Destroy(entity);
+    Create(entity, name);
+  };
+  ReleaseFn release_fn_ = [](Entity entity) {};
   CreateChildFn create_child_fn_ = [this](Entity parent, BlueprintTree* bpt) {
     return Create(bpt);
   };
@@ -401,14 +535,14 @@ class EntityFactory {
 template <typename T, typename... Args>
 T* EntityFactory::CreateSystem(Args&&... args) {
   T* system = registry_->Create<T>(registry_, std::forward<Args>(args)...);
-  AddSystem(GetTypeId<T>(), system);
+  AddSystem(GetTypeId<T>(), GetTypeName<T>(), system);
   return system;
 }
 
 template <typename T>
 T* EntityFactory::AddSystemFromRegistry() {
   T* system = registry_->Get<T>();
-  AddSystem(GetTypeId<T>(), system);
+  AddSystem(GetTypeId<T>(), GetTypeName<T>(), system);
   return system;
 }
 
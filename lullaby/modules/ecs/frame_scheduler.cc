@@ -0,0 +1,166 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/ecs/frame_scheduler.h"
+
+#include <algorithm>
+
+#include "lullaby/modules/dispatcher/queued_dispatcher.h"
+#include "lullaby/util/job_processor.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+namespace {
+
+bool Contains(const std::vector<TypeId>& types, TypeId type) {
+  return std::find(types.begin(), types.end(), type) != types.end();
+}
+
+bool Intersects(const std::vector<TypeId>& lhs,
+                const std::vector<TypeId>& rhs) {
+  for (TypeId type : lhs) {
+    if (Contains(rhs, type)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+FrameScheduler::Task& FrameScheduler::Task::Reads(TypeId type) {
+  if (!Contains(reads_, type)) {
+    reads_.push_back(type);
+    scheduler_->dirty_ = true;
+  }
+  return *this;
+}
+
+FrameScheduler::Task& FrameScheduler::Task::Writes(TypeId type) {
+  if (!Contains(writes_, type)) {
+    writes_.push_back(type);
+    scheduler_->dirty_ = true;
+  }
+  return *this;
+}
+
+FrameScheduler::Task& FrameScheduler::Task::RunOnCallingThread() {
+  calling_thread_ = true;
+  return *this;
+}
+
+FrameScheduler::FrameScheduler(Registry* registry,
+                               QueuedDispatcher* dispatcher)
+    : registry_(registry), dispatcher_(dispatcher) {}
+
+FrameScheduler::Task& FrameScheduler::Add(string_view name, TaskFn fn) {
+  CHECK(fn) << "Task " << name << " has no function.";
+  tasks_.emplace_back(new Task());
+  Task& task = *tasks_.back();
+  task.scheduler_ = this;
+  task.name_ = name.to_string();
+  task.fn_ = std::move(fn);
+  dirty_ = true;
+  return task;
+}
+
+bool FrameScheduler::Conflicts(const Task& earlier, const Task& later) {
+  return Intersects(earlier.writes_, later.writes_) ||
+         Intersects(earlier.writes_, later.reads_) ||
+         Intersects(earlier.reads_, later.writes_);
+}
+
+void FrameScheduler::BuildPhases() {
+  if (!dirty_) {
+    return;
+  }
+  dirty_ = false;
+  phases_.clear();
+
+  std::vector<size_t> task_phases(tasks_.size(), 0);
+  for (size_t i = 0; i < tasks_.size(); ++i) {
+    size_t phase = 0;
+    for (size_t j = 0; j < i; ++j) {
+      if (task_phases[j] >= phase && Conflicts(*tasks_[j], *tasks_[i])) {
+        phase = task_phases[j] + 1;
+      }
+    }
+    task_phases[i] = phase;
+    if (phase >= phases_.size()) {
+      phases_.resize(phase + 1);
+    }
+    phases_[phase].push_back(i);
+  }
+}
+
+void FrameScheduler::AdvanceFrame(Clock::duration delta_time) {
+  BuildPhases();
+
+  JobProcessor* job_processor = registry_->Get<JobProcessor>();
+  const bool parallel =
+      job_processor != nullptr && job_processor->GetNumWorkerThreads() > 0;
+
+  std::vector<JobProcessor::JobHandle> jobs;
+  for (const std::vector<size_t>& phase : phases_) {
+    if (parallel && phase.size() > 1) {
+      // Run tasks bound to this thread (and the last task, to keep this thread
+      // busy) directly, and the rest on the workers.
+      jobs.clear();
+      for (size_t i = 0; i + 1 < phase.size(); ++i) {
+        Task* task = tasks_[phase[i]].get();
+        if (!task->calling_thread_) {
+          jobs.push_back(job_processor->Run(
+              [task, delta_time]() { task->fn_(delta_time); }));
+        }
+      }
+      for (size_t i = 0; i < phase.size(); ++i) {
+        Task* task = tasks_[phase[i]].get();
+        if (task->calling_thread_ || i + 1 == phase.size()) {
+          task->fn_(delta_time);
+        }
+      }
+      for (const JobProcessor::JobHandle& job : jobs) {
+        job_processor->Wait(job);
+      }
+    } else {
+      for (size_t index : phase) {
+        tasks_[index]->fn_(delta_time);
+      }
+    }
+
+    if (dispatcher_) {
+      dispatcher_->Dispatch();
+    }
+  }
+}
+
+size_t FrameScheduler::GetNumPhases() {
+  BuildPhases();
+  return phases_.size();
+}
+
+std::vector<std::string> FrameScheduler::GetPhaseTaskNames(size_t phase) {
+  BuildPhases();
+  std::vector<std::string> names;
+  if (phase < phases_.size()) {
+    for (size_t index : phases_[phase]) {
+      names.push_back(tasks_[index]->name_);
+    }
+  }
+  return names;
+}
+
+}  // namespace lull
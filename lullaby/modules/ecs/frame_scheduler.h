@@ -0,0 +1,152 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_ECS_FRAME_SCHEDULER_H_
+#define LULLABY_MODULES_ECS_FRAME_SCHEDULER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lullaby/util/clock.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/util/string_view.h"
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+class QueuedDispatcher;
+
+// Runs the per-frame update functions of an app (usually the AdvanceFrame
+// functions of its Systems) in parallel wherever it is safe to do so.
+//
+// Each task declares the data it reads and writes, identified by TypeId
+// (usually the TypeId of the System that owns the data).  Tasks are grouped
+// into phases: a task is placed in the phase after the last phase containing a
+// task that was added before it and that writes data it accesses, or reads
+// data it writes.  Conflicting tasks therefore still run in the order they
+// were added, while independent tasks in the same phase run concurrently on
+// the JobProcessor in the Registry (if there is one).
+//
+// If a QueuedDispatcher is provided, it is dispatched on the calling thread
+// after every phase, so events sent by one phase are handled before the next.
+//
+// Example:
+//   scheduler->Add(transform_system, &TransformSystem::AdvanceFrame);
+//   scheduler->Add(animation_system, &AnimationSystem::AdvanceFrame)
+//       .Writes<TransformSystem>();
+//   scheduler->Add(audio_system, &AudioSystem::AdvanceFrame)
+//       .Reads<TransformSystem>();
+//   ...
+//   scheduler->AdvanceFrame(delta_time);
+class FrameScheduler {
+ public:
+  using TaskFn = std::function<void(Clock::duration)>;
+
+  // Configures the data accessed by a task.  References to Tasks remain valid
+  // for the lifetime of the FrameScheduler.
+  class Task {
+   public:
+    // Declares that the task reads the data identified by |type|.
+    Task& Reads(TypeId type);
+
+    // Declares that the task writes (and possibly reads) the data identified by
+    // |type|.
+    Task& Writes(TypeId type);
+
+    template <typename T>
+    Task& Reads() {
+      return Reads(GetTypeId<T>());
+    }
+
+    template <typename T>
+    Task& Writes() {
+      return Writes(GetTypeId<T>());
+    }
+
+    // Requires the task to run on the thread calling AdvanceFrame, eg. because
+    // it uses a graphics context.
+    Task& RunOnCallingThread();
+
+   private:
+    friend class FrameScheduler;
+
+    FrameScheduler* scheduler_ = nullptr;
+    std::string name_;
+    TaskFn fn_;
+    std::vector<TypeId> reads_;
+    std::vector<TypeId> writes_;
+    bool calling_thread_ = false;
+  };
+
+  // The |dispatcher|, if not null, is dispatched after every phase.
+  explicit FrameScheduler(Registry* registry,
+                          QueuedDispatcher* dispatcher = nullptr);
+
+  FrameScheduler(const FrameScheduler&) = delete;
+  FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+  // Adds a task named |name| that calls |fn|.  The task accesses no data until
+  // declared otherwise.
+  Task& Add(string_view name, TaskFn fn);
+
+  // Adds a task that calls |fn| on |system|.  The task is declared to write the
+  // data of |system|.
+  template <typename T>
+  Task& Add(T* system, void (T::*fn)(Clock::duration)) {
+    Task& task = Add(GetTypeName<T>(), [system, fn](Clock::duration dt) {
+      (system->*fn)(dt);
+    });
+    return task.Writes<T>();
+  }
+
+  // Adds a task that calls |fn| on |system|, ignoring the frame's delta time.
+  template <typename T>
+  Task& Add(T* system, void (T::*fn)()) {
+    Task& task = Add(GetTypeName<T>(),
+                     [system, fn](Clock::duration) { (system->*fn)(); });
+    return task.Writes<T>();
+  }
+
+  // Runs all the tasks, returning once they have all completed.
+  void AdvanceFrame(Clock::duration delta_time);
+
+  // Returns the number of phases the tasks are grouped into.
+  size_t GetNumPhases();
+
+  // Returns the names of the tasks in |phase|, in the order they were added.
+  std::vector<std::string> GetPhaseTaskNames(size_t phase);
+
+ private:
+  // Assigns every task to a phase, if not already done.
+  void BuildPhases();
+
+  static bool Conflicts(const Task& earlier, const Task& later);
+
+  Registry* registry_;
+  QueuedDispatcher* dispatcher_;
+  std::vector<std::unique_ptr<Task>> tasks_;
+  // The indices into |tasks_| of the tasks in each phase.
+  std::vector<std::vector<size_t>> phases_;
+  bool dirty_ = false;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::FrameScheduler);
+
+#endif  // LULLABY_MODULES_ECS_FRAME_SCHEDULER_H_
@@ -23,6 +23,7 @@ limitations under the License.
 #include "lullaby/modules/ecs/entity_factory.h"
 #include "lullaby/util/entity.h"
 #include "lullaby/util/registry.h"
+#include "lullaby/util/span.h"
 #include "lullaby/util/typeid.h"
 
 namespace lull {
@@ -63,6 +64,35 @@ class System {
                    blueprint.GetLegacyDefData());
   }
 
+  // Creates the Component described by |blueprint| for each of the |entities|.
+  // This is called by EntityFactory::CreateBatch when creating many Entities
+  // from the same blueprint, and allows Systems to reserve storage for all the
+  // new Components up front.  The default implementation calls
+  // CreateComponent() for each Entity.
+  virtual void CreateMany(Span<Entity> entities, const Blueprint& blueprint) {
+    for (const Entity e : entities) {
+      CreateComponent(e, blueprint);
+    }
+  }
+
+  // Batch version of PostCreateComponent().  The default implementation calls
+  // PostCreateComponent() for each Entity.
+  virtual void PostCreateMany(Span<Entity> entities,
+                              const Blueprint& blueprint) {
+    for (const Entity e : entities) {
+      PostCreateComponent(e, blueprint);
+    }
+  }
+
+  // Resets the existing Component of |e| described by |blueprint| to the
+  // blueprint's data without reallocating it.  This is called when an Entity is
+  // re-acquired from one of the EntityFactory's pools.  Returns false if the
+  // System does not support resetting in place (the default), in which case
+  // the EntityFactory destroys and re-creates the System's Components instead.
+  virtual bool ResetComponent(Entity e, const Blueprint& blueprint) {
+    return false;
+  }
+
   // Associates Component(s) with the Entity using the serialized |def| data.
   virtual void Create(Entity e, DefType type, const Def* def) {}
 
@@ -73,6 +103,16 @@ class System {
   // Disassociates all Component data from the Entity.
   virtual void Destroy(Entity e) {}
 
+  // Returns the number of Components owned by the System.  This is only used
+  // for diagnostics (eg. by the SystemProfiler), so Systems that do not
+  // override it simply report 0.
+  virtual size_t GetNumComponents() const { return 0; }
+
+  // Returns the approximate number of bytes allocated for the System's
+  // Component storage.  Like GetNumComponents(), this is only used for
+  // diagnostics.
+  virtual size_t GetComponentMemoryUsage() const { return 0; }
+
  protected:
   // Converts a flatbuffer::Table to a derived type for processing.
   template <typename T>
@@ -0,0 +1,118 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/ecs/system_profiler.h"
+
+#include <algorithm>
+
+#include "lullaby/modules/ecs/entity_factory.h"
+
+namespace lull {
+namespace {
+
+// A plain integer so that it can be safely used from inside operator new.
+thread_local size_t g_num_allocations = 0;
+
+}  // namespace
+
+void SystemProfiler::RecordAllocation() { ++g_num_allocations; }
+
+size_t SystemProfiler::GetNumAllocations() { return g_num_allocations; }
+
+SystemProfiler::ScopedSample::ScopedSample(SystemProfiler* profiler,
+                                           TypeId system, const char* name)
+    : profiler_(profiler), system_(system), name_(name) {
+  if (profiler_) {
+    start_allocations_ = g_num_allocations;
+    start_time_ = Clock::now();
+  }
+}
+
+SystemProfiler::ScopedSample::~ScopedSample() {
+  if (profiler_) {
+    const Clock::duration time = Clock::now() - start_time_;
+    const size_t allocations = g_num_allocations - start_allocations_;
+    profiler_->AddSample(system_, name_, time, allocations);
+  }
+}
+
+SystemProfiler::SystemProfiler(Registry* registry) : registry_(registry) {}
+
+SystemProfiler::Stats* SystemProfiler::GetOrCreateStats(TypeId system,
+                                                        const char* name) {
+  auto iter = stats_.find(system);
+  if (iter == stats_.end()) {
+    iter = stats_.emplace(system, Stats()).first;
+    iter->second.system = system;
+    iter->second.name = name ? name : "";
+  }
+  return &iter->second;
+}
+
+void SystemProfiler::AddSample(TypeId system, const char* name,
+                               Clock::duration time, size_t allocations) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats* stats = GetOrCreateStats(system, name);
+  ++stats->num_samples;
+  stats->last_time = time;
+  stats->total_time += time;
+  stats->max_time = std::max(stats->max_time, time);
+  stats->last_allocations = allocations;
+  stats->total_allocations += allocations;
+}
+
+const SystemProfiler::Stats* SystemProfiler::GetStats(TypeId system) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = stats_.find(system);
+  return iter != stats_.end() ? &iter->second : nullptr;
+}
+
+std::vector<SystemProfiler::Stats> SystemProfiler::GetAllStats() const {
+  std::vector<Stats> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.reserve(stats_.size());
+    for (const auto& iter : stats_) {
+      result.push_back(iter.second);
+    }
+  }
+  std::sort(result.begin(), result.end(), [](const Stats& a, const Stats& b) {
+    return a.total_time > b.total_time;
+  });
+  return result;
+}
+
+void SystemProfiler::UpdateComponentStats() {
+  const auto* entity_factory = registry_->Get<EntityFactory>();
+  if (!entity_factory) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  entity_factory->ForEachSystem(
+      [this](TypeId type, const char* name, System* system) {
+        Stats* stats = GetOrCreateStats(type, name);
+        stats->num_components = system->GetNumComponents();
+        stats->component_memory_usage = system->GetComponentMemoryUsage();
+      });
+}
+
+void SystemProfiler::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.clear();
+}
+
+}  // namespace lull
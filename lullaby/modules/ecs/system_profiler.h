@@ -0,0 +1,145 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_ECS_SYSTEM_PROFILER_H_
+#define LULLABY_MODULES_ECS_SYSTEM_PROFILER_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lullaby/util/clock.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+// Attributes frame time, heap allocations and Component memory to individual
+// Systems.
+//
+// Profiling is opt-in: it is only enabled once a SystemProfiler has been
+// created in the Registry, eg:
+//   registry->Create<SystemProfiler>(registry);
+//
+// Systems mark the work they do each frame with a ScopedSample:
+//   void MySystem::AdvanceFrame(Clock::duration delta_time) {
+//     SystemProfiler::ScopedSample sample(registry_, this);
+//     ...
+//   }
+// which does nothing (other than a Registry lookup) if there is no
+// SystemProfiler.
+//
+// Allocations are only counted if the "system_profiler_allocation_hook" library
+// is linked into the binary, since it replaces the global operator new.
+class SystemProfiler {
+ public:
+  // The accumulated statistics of a single System.
+  struct Stats {
+    TypeId system = 0;
+    std::string name;
+    // The number of samples recorded for the System, which is usually the
+    // number of frames it has been advanced.
+    size_t num_samples = 0;
+    Clock::duration last_time = Clock::duration::zero();
+    Clock::duration total_time = Clock::duration::zero();
+    Clock::duration max_time = Clock::duration::zero();
+    // The number of heap allocations made during the last sample and all
+    // samples.
+    size_t last_allocations = 0;
+    size_t total_allocations = 0;
+    // The values of System::GetNumComponents() and
+    // System::GetComponentMemoryUsage() at the last call to
+    // UpdateComponentStats().
+    size_t num_components = 0;
+    size_t component_memory_usage = 0;
+  };
+
+  // Records the time and allocations between its construction and destruction
+  // against a System.  Allocations are counted for the calling thread only, and
+  // nested samples are included in their parent sample.
+  class ScopedSample {
+   public:
+    template <typename S>
+    ScopedSample(Registry* registry, const S* system)
+        : ScopedSample(registry ? registry->Get<SystemProfiler>() : nullptr,
+                       GetTypeId<S>(), GetTypeName<S>()) {}
+
+    ~ScopedSample();
+
+    ScopedSample(const ScopedSample&) = delete;
+    ScopedSample& operator=(const ScopedSample&) = delete;
+
+   private:
+    ScopedSample(SystemProfiler* profiler, TypeId system, const char* name);
+
+    SystemProfiler* profiler_;
+    TypeId system_;
+    const char* name_;
+    Clock::time_point start_time_;
+    size_t start_allocations_ = 0;
+  };
+
+  explicit SystemProfiler(Registry* registry);
+
+  SystemProfiler(const SystemProfiler&) = delete;
+  SystemProfiler& operator=(const SystemProfiler&) = delete;
+
+  // Returns the statistics of the |system|, or nullptr if no samples or
+  // Component stats have been recorded for it.  The returned pointer is
+  // invalidated by any other call to the SystemProfiler.
+  const Stats* GetStats(TypeId system) const;
+
+  template <typename S>
+  const Stats* GetStats() const {
+    return GetStats(GetTypeId<S>());
+  }
+
+  // Returns a copy of the statistics of every System, sorted by descending
+  // total time.
+  std::vector<Stats> GetAllStats() const;
+
+  // Queries the Component count and memory usage of every System in the
+  // EntityFactory.  This is not done automatically since it can be relatively
+  // expensive, so it should be called before reading the stats (eg. once per
+  // frame by a debug UI).
+  void UpdateComponentStats();
+
+  // Clears all recorded statistics.
+  void Reset();
+
+  // Records a heap allocation on the calling thread.  This is called by the
+  // allocation hook and should not be called directly.
+  static void RecordAllocation();
+
+  // Returns the number of heap allocations recorded on the calling thread.
+  static size_t GetNumAllocations();
+
+ private:
+  Stats* GetOrCreateStats(TypeId system, const char* name);
+  void AddSample(TypeId system, const char* name, Clock::duration time,
+                 size_t allocations);
+
+  Registry* registry_;
+  std::unordered_map<TypeId, Stats> stats_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::SystemProfiler);
+
+#endif  // LULLABY_MODULES_ECS_SYSTEM_PROFILER_H_
@@ -0,0 +1,52 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstdlib>
+#include <new>
+
+#include "lullaby/modules/ecs/system_profiler.h"
+
+// Replaces the global allocation functions so that the SystemProfiler can
+// count the allocations made by each System.  Only link this into binaries
+// that want the counts, since every allocation in the process goes through it.
+
+void* operator new(std::size_t size) {
+  lull::SystemProfiler::RecordAllocation();
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  lull::SystemProfiler::RecordAllocation();
+  return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+  return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
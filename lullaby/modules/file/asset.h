@@ -22,6 +22,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 
+#include "lullaby/modules/file/mapped_file.h"
 #include "lullaby/util/error.h"
 #include "lullaby/util/typeid.h"
 
@@ -85,6 +86,26 @@ class Asset {
     return kErrorCode_Ok;
   }
 
+  // Assets that can use their data in place (e.g. flatbuffers) can return true
+  // to be given a read-only MappedFile instead of a copy of the data.  The
+  // AssetLoader then calls OnLoadMapped() and OnFinalizeMapped() rather than
+  // OnLoad() and OnFinalize().  If the file cannot be mapped, its contents are
+  // loaded as usual and wrapped in a MappedFile.
+  virtual bool UsesMappedData() const { return false; }
+
+  // Like OnLoad(), but for assets that use mapped data.
+  virtual ErrorCode OnLoadMapped(const std::string& filename,
+                                 const MappedFilePtr& data) {
+    return kErrorCode_Ok;
+  }
+
+  // Like OnFinalize(), but for assets that use mapped data.  The asset may keep
+  // |data| for as long as it needs the contents.
+  virtual ErrorCode OnFinalizeMapped(const std::string& filename,
+                                     MappedFilePtr data) {
+    return kErrorCode_Ok;
+  }
+
   // This function is called when an error was encountered at any time during
   // the load operation.
   virtual void OnError(const std::string& filename, ErrorCode error) {}
@@ -111,6 +132,26 @@ class SimpleAsset : public Asset {
   std::string data_;
 };
 
+// Asset type that holds the loaded data directly like SimpleAsset, but maps the
+// file into memory instead of copying it where possible.  The data is
+// read-only and is not null-terminated.
+class MappedAsset : public Asset {
+ public:
+  bool UsesMappedData() const override { return true; }
+
+  ErrorCode OnFinalizeMapped(const std::string& filename,
+                             MappedFilePtr data) override {
+    data_ = std::move(data);
+    return kErrorCode_Ok;
+  }
+
+  size_t GetSize() const { return data_ ? data_->GetSize() : 0; }
+  const void* GetData() const { return data_ ? data_->GetData() : nullptr; }
+
+ private:
+  MappedFilePtr data_;
+};
+
 typedef std::shared_ptr<Asset> AssetPtr;
 
 }  // namespace lull
@@ -24,6 +24,7 @@ limitations under the License.
 
 #include <fstream>
 #include <limits>
+#include <utility>
 
 #ifdef __ANDROID__
 #include "lullaby/util/android_context.h"
@@ -98,6 +99,24 @@ static bool LoadFileAndroid(Registry* registry, const std::string& filename,
   return LoadFileDirect(filename, dest);
 }
 
+static MappedFilePtr MapFileAndroid(Registry* registry,
+                                    const std::string& filename) {
+  AAssetManager* android_asset_manager = nullptr;
+  auto* android_context = registry->Get<AndroidContext>();
+  if (android_context) {
+    android_asset_manager = android_context->GetAndroidAssetManager();
+  }
+  if (android_asset_manager && !filename.empty() && filename[0] != '\\') {
+    MappedFilePtr file =
+        MappedFile::MapAndroidAsset(android_asset_manager, filename);
+    if (file) {
+      return file;
+    }
+  }
+
+  return MappedFile::Map(filename);
+}
+
 #endif  // __ANDROID__
 
 AssetLoader::LoadRequest::LoadRequest(const std::string& filename,
@@ -115,7 +134,7 @@ AssetLoader::AssetLoader(LoadFileFn load_fn) {
 }
 
 void AssetLoader::LoadImpl(const std::string& filename, const AssetPtr& asset,
-                           LoadMode mode) {
+                           LoadMode mode, const AsyncLoadOptions& options) {
   switch (mode) {
     case kImmediate: {
       LoadRequest req(filename, asset);
@@ -125,9 +144,12 @@ void AssetLoader::LoadImpl(const std::string& filename, const AssetPtr& asset,
     }
     case kAsynchronous: {
       LoadRequestPtr req(new LoadRequest(filename, asset));
+      req->tag = options.tag;
       ++pending_requests_;
-      processor_.Enqueue(
-          req, [=](LoadRequestPtr* req) { DoLoad(req->get(), mode); });
+      async_requests_.push_back(req);
+      req->task_id = processor_.Enqueue(
+          req, [=](LoadRequestPtr* req) { DoLoad(req->get(), mode); },
+          options.priority);
       break;
     }
   }
@@ -139,24 +161,122 @@ int AssetLoader::Finalize() {
 
 int AssetLoader::Finalize(int max_num_assets_to_finalize) {
   while (max_num_assets_to_finalize > 0) {
-    LoadRequestPtr req = nullptr;
-    if (!processor_.Dequeue(&req)) {
+    if (!FinalizeNext()) {
+      break;
+    }
+    --max_num_assets_to_finalize;
+  }
+  return pending_requests_;
+}
+
+int AssetLoader::Finalize(Clock::duration time_budget) {
+  Timer timer;
+  while (timer.GetElapsedTime() < time_budget) {
+    if (!FinalizeNext()) {
       break;
     }
+  }
+  return pending_requests_;
+}
 
+bool AssetLoader::FinalizeNext() {
+  LoadRequestPtr req = nullptr;
+  while (processor_.Dequeue(&req)) {
+    RemoveRequest(req);
+    --pending_requests_;
+    if (req->cancelled) {
+      // Cancelled after it started loading, so drop the result.
+      req->asset->OnError(req->filename, kErrorCode_Cancelled);
+      continue;
+    }
     DoFinalize(req.get(), kAsynchronous);
+    return true;
+  }
+  return false;
+}
+
+bool AssetLoader::SetLoadPriority(const AssetPtr& asset, int priority) {
+  for (const LoadRequestPtr& req : async_requests_) {
+    if (req->asset == asset) {
+      return processor_.SetPriority(req->task_id, priority);
+    }
+  }
+  return false;
+}
+
+int AssetLoader::SetLoadPriority(HashValue tag, int priority) {
+  int count = 0;
+  for (const LoadRequestPtr& req : async_requests_) {
+    if (req->tag == tag && processor_.SetPriority(req->task_id, priority)) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+bool AssetLoader::CancelLoad(const AssetPtr& asset) {
+  for (const LoadRequestPtr& req : async_requests_) {
+    if (req->asset == asset && !req->cancelled) {
+      CancelRequest(req);
+      return true;
+    }
+  }
+  return false;
+}
+
+int AssetLoader::CancelLoads(HashValue tag) {
+  std::vector<LoadRequestPtr> requests;
+  for (const LoadRequestPtr& req : async_requests_) {
+    if (req->tag == tag && !req->cancelled) {
+      requests.push_back(req);
+    }
+  }
+  for (const LoadRequestPtr& req : requests) {
+    CancelRequest(req);
+  }
+  return static_cast<int>(requests.size());
+}
+
+void AssetLoader::CancelRequest(LoadRequestPtr req) {
+  req->cancelled = true;
+  // If the request is still queued, drop it now.  Otherwise it is already
+  // loading, or waiting to be finalized, and Finalize() will drop it.
+  if (processor_.Cancel(req->task_id)) {
+    RemoveRequest(req);
     --pending_requests_;
-    --max_num_assets_to_finalize;
+    req->asset->OnError(req->filename, kErrorCode_Cancelled);
+  }
+}
+
+void AssetLoader::RemoveRequest(const LoadRequestPtr& req) {
+  auto iter = std::find(async_requests_.begin(), async_requests_.end(), req);
+  if (iter != async_requests_.end()) {
+    async_requests_.erase(iter);
   }
-  return pending_requests_;
 }
 
 void AssetLoader::DoLoad(LoadRequest* req, LoadMode mode) const {
+  if (req->cancelled) {
+    return;
+  }
 #if LULLABY_ASSET_LOADER_LOG_TIMES
   Timer load_timer;
 #endif
-  // Actually load the data using the provided load function.
-  const bool success = load_fn_(req->filename.c_str(), &req->data);
+  // Actually load the data using the provided load function, or map it for
+  // assets that don't need their own copy.
+  bool success = false;
+  const bool use_mapped_data = req->asset->UsesMappedData();
+  if (use_mapped_data) {
+    if (map_fn_) {
+      req->mapped_data = map_fn_(req->filename.c_str());
+    }
+    if (!req->mapped_data && load_fn_(req->filename.c_str(), &req->data)) {
+      req->mapped_data = MappedFile::FromString(std::move(req->data));
+    }
+    success = req->mapped_data != nullptr;
+  } else {
+    success = load_fn_(req->filename.c_str(), &req->data);
+  }
 #if LULLABY_ASSET_LOADER_LOG_TIMES
   {
     const auto dt = MillisecondsFromDuration(load_timer.GetElapsedTime());
@@ -175,7 +295,11 @@ void AssetLoader::DoLoad(LoadRequest* req, LoadMode mode) const {
   Timer on_load_timer;
 #endif
   // Notify the Asset of the loaded data.
-  req->error = req->asset->OnLoadWithError(req->filename, &req->data);
+  if (use_mapped_data) {
+    req->error = req->asset->OnLoadMapped(req->filename, req->mapped_data);
+  } else {
+    req->error = req->asset->OnLoadWithError(req->filename, &req->data);
+  }
 #if LULLABY_ASSET_LOADER_LOG_TIMES
   {
     const auto dt = MillisecondsFromDuration(on_load_timer.GetElapsedTime());
@@ -191,7 +315,12 @@ void AssetLoader::DoFinalize(LoadRequest* req, LoadMode mode) const {
 
   // Notify the Asset to finalize the data on the finalizer thread.
   if (req->error == kErrorCode_Ok) {
-    req->error = req->asset->OnFinalizeWithError(req->filename, &req->data);
+    if (req->mapped_data) {
+      req->error = req->asset->OnFinalizeMapped(req->filename,
+                                                std::move(req->mapped_data));
+    } else {
+      req->error = req->asset->OnFinalizeWithError(req->filename, &req->data);
+    }
   }
 #if LULLABY_ASSET_LOADER_LOG_TIMES
   const auto dt = MillisecondsFromDuration(timer.GetElapsedTime());
@@ -210,11 +339,17 @@ void AssetLoader::DoFinalize(LoadRequest* req, LoadMode mode) const {
 void AssetLoader::SetLoadFunction(LoadFileFn load_fn) {
   if (load_fn) {
     load_fn_ = std::move(load_fn);
+    map_fn_ = nullptr;
   } else {
     load_fn_ = GetDefaultLoadFunction();
+    map_fn_ = GetDefaultMapFunction();
   }
 }
 
+void AssetLoader::SetMapFunction(MapFileFn map_fn) {
+  map_fn_ = std::move(map_fn);
+}
+
 AssetLoader::LoadFileFn AssetLoader::GetLoadFunction() const {
   return load_fn_;
 }
@@ -232,11 +367,32 @@ AssetLoader::LoadFileFn AssetLoader::GetDefaultLoadFunction() const {
   return LoadFileDirect;
 }
 
+AssetLoader::MapFileFn AssetLoader::GetDefaultMapFunction() const {
+#ifdef __ANDROID__
+  Registry* registry = registry_;
+  if (registry) {
+    return [registry](const char* filename) {
+      return MapFileAndroid(registry, filename);
+    };
+  }
+#endif
+
+  return [](const char* filename) { return MappedFile::Map(filename); };
+}
+
 void AssetLoader::SetOnErrorFunction(OnErrorFn error_fn) {
   error_fn_ = std::move(error_fn);
 }
 
-void AssetLoader::StartAsyncLoads() { processor_.Start(); }
+void AssetLoader::StartAsyncLoads() {
+  processor_.Start(num_async_load_threads_);
+}
+
+void AssetLoader::SetNumAsyncLoadThreads(size_t num_threads) {
+  num_async_load_threads_ = num_threads;
+  processor_.Stop();
+  processor_.Start(num_async_load_threads_);
+}
 
 void AssetLoader::StopAsyncLoads() { processor_.Stop(); }
 
@@ -18,12 +18,16 @@ limitations under the License.
 #define LULLABY_BASE_ASSET_LOADER_H_
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "lullaby/modules/file/asset.h"
 #include "lullaby/util/async_processor.h"
+#include "lullaby/util/clock.h"
+#include "lullaby/util/hash.h"
 #include "lullaby/util/registry.h"
 #include "lullaby/util/typeid.h"
 
@@ -44,10 +48,27 @@ class AssetLoader {
   // Note: The function signature is based on fplbase::LoadFile.
   using LoadFileFn = std::function<bool(const char* filename, std::string*)>;
 
+  // An optional function that maps a file into memory for assets that use
+  // mapped data (see Asset::UsesMappedData).  It should return nullptr if the
+  // file cannot be mapped, in which case the LoadFileFn is used instead.  It is
+  // also assumed to be thread-safe.
+  using MapFileFn = std::function<MappedFilePtr(const char* filename)>;
+
   // An optional callback that can be used to track errors on file operations.
   using OnErrorFn =
       std::function<void(const std::string& filename, ErrorCode error)>;
 
+  // Options for asynchronous loads.
+  struct AsyncLoadOptions {
+    // Loads with higher priorities are loaded, and finalized, before loads with
+    // lower priorities.
+    int priority = 0;
+
+    // An optional tag, so that a group of loads can be cancelled or
+    // reprioritized together.
+    HashValue tag = 0;
+  };
+
   // Constructs the AssetLoader using the default load function.
   explicit AssetLoader(Registry* registry);
 
@@ -82,6 +103,30 @@ class AssetLoader {
   void LoadIntoAsync(const std::string& filename,
                      const std::shared_ptr<T>& asset);
 
+  // Like above, but with a priority and tag for the load.
+  template <typename T>
+  void LoadIntoAsync(const std::string& filename,
+                     const std::shared_ptr<T>& asset,
+                     const AsyncLoadOptions& options);
+
+  // Changes the priority of the pending asynchronous load of |asset|.  Returns
+  // false if |asset| has no pending load.
+  bool SetLoadPriority(const AssetPtr& asset, int priority);
+
+  // Changes the priority of all pending asynchronous loads with |tag|, and
+  // returns how many there were.
+  int SetLoadPriority(HashValue tag, int priority);
+
+  // Cancels the pending asynchronous load of |asset|, which then receives an
+  // OnError() with kErrorCode_Cancelled instead of being finalized.  Loads that
+  // are already running are still completed, but are not finalized.  Returns
+  // false if |asset| has no pending load.
+  bool CancelLoad(const AssetPtr& asset);
+
+  // Cancels all pending asynchronous loads with |tag|, and returns how many
+  // there were.
+  int CancelLoads(HashValue tag);
+
   // Finalizes any assets that were loaded asynchronously and are ready for
   // finalizing.  This function should be called on the thread on which it is
   // safe to Finalize the asset being loaded.  If |max_num_assets_to_finalize|
@@ -91,10 +136,30 @@ class AssetLoader {
   int Finalize();
   int Finalize(int max_num_assets_to_finalize);
 
+  // Like above, but keeps finalizing assets, highest priority first, until
+  // |time_budget| has elapsed.
+  int Finalize(Clock::duration time_budget);
+
+  // Finalizes the next completed asynchronous request, skipping cancelled
+  // ones.  Returns false if there are none.  This can be registered as work
+  // with a FrameBudget.
+  bool FinalizeNext();
+
   // Sets a load function so that assets can be loaded from different places
-  // using custom load functions.
+  // using custom load functions.  Since files mapped by the default map
+  // function might not match what a custom load function provides, setting a
+  // custom load function also disables mapping until SetMapFunction() is
+  // called.  Passing nullptr restores the default load and map functions.
   void SetLoadFunction(LoadFileFn load_fn);
 
+  // Sets the function used to map files for assets that use mapped data.
+  // Passing nullptr disables mapping, so those assets are always loaded with
+  // the load function.
+  void SetMapFunction(MapFileFn map_fn);
+
+  // Returns the default map function.
+  MapFileFn GetDefaultMapFunction() const;
+
   // Returns the load function set in |SetLoadFunction|.
   LoadFileFn GetLoadFunction() const;
 
@@ -109,6 +174,11 @@ class AssetLoader {
   // construction and it only needs to be called explicitly after Stop.
   void StartAsyncLoads();
 
+  // Sets the number of worker threads used for asynchronous loads and
+  // (re)starts them.  With more than one thread, the load and map functions
+  // must be thread-safe.
+  void SetNumAsyncLoadThreads(size_t num_threads);
+
   // Stops loading assets asynchronously. Blocks until the currently loading
   // asset has completed. Call StartAsyncLoads to resume loading the assets.
   void StopAsyncLoads();
@@ -126,13 +196,25 @@ class AssetLoader {
     AssetPtr asset;        // Asset object to load data into.
     std::string filename;  // Filename of data being loaded.
     std::string data;      // Actual data contents being loaded.
+    MappedFilePtr mapped_data;  // Contents for assets that use mapped data.
     ErrorCode error;
+    // The remaining fields are only used for asynchronous loads.
+    AsyncProcessor<std::shared_ptr<LoadRequest>>::TaskId task_id =
+        AsyncProcessor<std::shared_ptr<LoadRequest>>::kInvalidTaskId;
+    HashValue tag = 0;
+    std::atomic<bool> cancelled{false};
   };
   using LoadRequestPtr = std::shared_ptr<LoadRequest>;
 
   // Prepares a load request for the given asset.
   void LoadImpl(const std::string& filename, const AssetPtr& asset,
-                LoadMode mode);
+                LoadMode mode, const AsyncLoadOptions& options);
+
+  // Cancels an asynchronous request.
+  void CancelRequest(LoadRequestPtr req);
+
+  // Removes an asynchronous request from |async_requests_|.
+  void RemoveRequest(const LoadRequestPtr& req);
 
   // Performs the actual loading for both immediate and asynchronous requests.
   void DoLoad(LoadRequest* req, LoadMode mode) const;
@@ -142,8 +224,11 @@ class AssetLoader {
 
   Registry* registry_ = nullptr;
   LoadFileFn load_fn_;  // Client-provided function for performing actual load.
+  MapFileFn map_fn_;    // Function for mapping files, if any.
   OnErrorFn error_fn_;  // Client-provided function for tracking errors.
   int pending_requests_ = 0;  // Number of requests queued for async loading.
+  size_t num_async_load_threads_ = 1;
+  std::vector<LoadRequestPtr> async_requests_;  // Unfinalized async requests.
   AsyncProcessor<LoadRequestPtr> processor_;  // Async processor for loading
                                               // data on a worker thread.
 };
@@ -152,7 +237,7 @@ template <typename T, typename... Args>
 std::shared_ptr<T> AssetLoader::LoadNow(const std::string& filename,
                                         Args&&... args) {
   auto ptr = std::make_shared<T>(std::forward<Args>(args)...);
-  LoadImpl(filename, ptr, kImmediate);
+  LoadImpl(filename, ptr, kImmediate, AsyncLoadOptions());
   return ptr;
 }
 
@@ -160,20 +245,27 @@ template <typename T, typename... Args>
 std::shared_ptr<T> AssetLoader::LoadAsync(const std::string& filename,
                                           Args&&... args) {
   auto ptr = std::make_shared<T>(std::forward<Args>(args)...);
-  LoadImpl(filename, ptr, kAsynchronous);
+  LoadImpl(filename, ptr, kAsynchronous, AsyncLoadOptions());
   return ptr;
 }
 
 template <typename T>
 void AssetLoader::LoadIntoNow(const std::string& filename,
                               const std::shared_ptr<T>& asset) {
-  LoadImpl(filename, asset, kImmediate);
+  LoadImpl(filename, asset, kImmediate, AsyncLoadOptions());
 }
 
 template <typename T>
 void AssetLoader::LoadIntoAsync(const std::string& filename,
                                 const std::shared_ptr<T>& asset) {
-  LoadImpl(filename, asset, kAsynchronous);
+  LoadImpl(filename, asset, kAsynchronous, AsyncLoadOptions());
+}
+
+template <typename T>
+void AssetLoader::LoadIntoAsync(const std::string& filename,
+                                const std::shared_ptr<T>& asset,
+                                const AsyncLoadOptions& options) {
+  LoadImpl(filename, asset, kAsynchronous, options);
 }
 
 }  // namespace lull
@@ -0,0 +1,290 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/file/asset_reloader.h"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#endif
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+namespace {
+
+int64_t GetFileModificationTime(const std::string& filename) {
+#if defined(__unix__) || defined(__APPLE__)
+  struct stat info;
+  if (stat(filename.c_str(), &info) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  const struct timespec& mtime = info.st_mtimespec;
+#else
+  const struct timespec& mtime = info.st_mtim;
+#endif
+  // Second resolution misses quick successive saves, so use the full timestamp
+  // and also fold in the size in case the file system's timestamps are coarse.
+  const int64_t nanos = static_cast<int64_t>(mtime.tv_sec) * 1000000000 +
+                        static_cast<int64_t>(mtime.tv_nsec);
+  return nanos * 31 + static_cast<int64_t>(info.st_size);
+#else
+  return 0;
+#endif
+}
+
+template <typename T>
+void AddUnique(std::vector<T>* list, const T& value) {
+  if (std::find(list->begin(), list->end(), value) == list->end()) {
+    list->push_back(value);
+  }
+}
+
+template <typename T>
+void Remove(std::vector<T>* list, const T& value) {
+  list->erase(std::remove(list->begin(), list->end(), value), list->end());
+}
+
+}  // namespace
+
+AssetReloader::AssetReloader()
+    : modification_time_fn_(GetFileModificationTime) {}
+
+AssetReloader::~AssetReloader() { StopWatching(); }
+
+void AssetReloader::AddResource(HashValue resource, ReloadFn fn) {
+  Lock lock(mutex_);
+  resources_[resource].reload = std::move(fn);
+}
+
+void AssetReloader::RemoveResource(HashValue resource) {
+  Lock lock(mutex_);
+  auto iter = resources_.find(resource);
+  if (iter == resources_.end()) {
+    return;
+  }
+
+  for (HashValue dependency : iter->second.dependencies) {
+    auto file = files_.find(dependency);
+    if (file != files_.end()) {
+      Remove(&file->second.dependents, resource);
+      if (file->second.dependents.empty()) {
+        changed_files_.erase(file->first);
+        files_.erase(file);
+      }
+    }
+    auto other = resources_.find(dependency);
+    if (other != resources_.end()) {
+      Remove(&other->second.dependents, resource);
+    }
+  }
+  for (HashValue dependent : iter->second.dependents) {
+    auto other = resources_.find(dependent);
+    if (other != resources_.end()) {
+      Remove(&other->second.dependencies, resource);
+    }
+  }
+  resources_.erase(iter);
+}
+
+void AssetReloader::AddFileDependency(HashValue resource,
+                                      const std::string& filename) {
+  const HashValue key = Hash(filename);
+  const bool is_new = [&]() {
+    Lock lock(mutex_);
+    return files_.count(key) == 0;
+  }();
+
+  // Query the modification time outside the lock since it may hit the disk.
+  const int64_t modification_time =
+      is_new ? modification_time_fn_(filename) : 0;
+
+  Lock lock(mutex_);
+  auto iter = files_.find(key);
+  if (iter == files_.end()) {
+    iter = files_.emplace(key, WatchedFile()).first;
+    iter->second.filename = filename;
+    iter->second.modification_time = modification_time;
+  }
+  AddUnique(&iter->second.dependents, resource);
+  AddUnique(&resources_[resource].dependencies, key);
+}
+
+void AssetReloader::AddDependency(HashValue resource, HashValue dependency) {
+  if (resource == dependency) {
+    LOG(DFATAL) << "A resource cannot depend on itself.";
+    return;
+  }
+  Lock lock(mutex_);
+  AddUnique(&resources_[resource].dependencies, dependency);
+  AddUnique(&resources_[dependency].dependents, resource);
+}
+
+void AssetReloader::SetModificationTimeFn(ModificationTimeFn fn) {
+  Lock lock(mutex_);
+  modification_time_fn_ = std::move(fn);
+}
+
+void AssetReloader::StartWatching(Clock::duration interval) {
+  Lock lock(mutex_);
+  if (watching_) {
+    return;
+  }
+  watching_ = true;
+  watcher_thread_ =
+      std::thread([this, interval]() { WatcherThread(interval); });
+}
+
+void AssetReloader::StopWatching() {
+  {
+    Lock lock(mutex_);
+    if (!watching_) {
+      return;
+    }
+    watching_ = false;
+    condvar_.notify_all();
+  }
+  watcher_thread_.join();
+}
+
+void AssetReloader::WatcherThread(Clock::duration interval) {
+  Lock lock(mutex_);
+  while (watching_) {
+    lock.unlock();
+    CheckForChanges();
+    lock.lock();
+    condvar_.wait_for(lock, interval, [this]() { return !watching_; });
+  }
+}
+
+size_t AssetReloader::CheckForChanges() {
+  std::vector<std::pair<HashValue, std::string>> files;
+  ModificationTimeFn modification_time_fn;
+  {
+    Lock lock(mutex_);
+    files.reserve(files_.size());
+    for (const auto& iter : files_) {
+      files.emplace_back(iter.first, iter.second.filename);
+    }
+    modification_time_fn = modification_time_fn_;
+  }
+
+  // Query the file system without holding the lock so that resources can
+  // still be registered in the meantime.
+  std::vector<std::pair<HashValue, int64_t>> times;
+  times.reserve(files.size());
+  for (const auto& file : files) {
+    times.emplace_back(file.first, modification_time_fn(file.second));
+  }
+
+  size_t num_changed = 0;
+  Lock lock(mutex_);
+  for (const auto& time : times) {
+    auto iter = files_.find(time.first);
+    if (iter != files_.end() && iter->second.modification_time != time.second) {
+      iter->second.modification_time = time.second;
+      changed_files_.insert(time.first);
+      ++num_changed;
+    }
+  }
+  return num_changed;
+}
+
+void AssetReloader::NotifyFileChanged(const std::string& filename) {
+  const HashValue key = Hash(filename);
+  Lock lock(mutex_);
+  if (files_.count(key)) {
+    changed_files_.insert(key);
+  }
+}
+
+void AssetReloader::CollectDependents(
+    HashValue key, std::unordered_set<HashValue>* affected) const {
+  if (!affected->insert(key).second) {
+    return;
+  }
+  auto iter = resources_.find(key);
+  if (iter != resources_.end()) {
+    for (HashValue dependent : iter->second.dependents) {
+      CollectDependents(dependent, affected);
+    }
+  }
+}
+
+void AssetReloader::SortAffected(HashValue key,
+                                 const std::unordered_set<HashValue>& affected,
+                                 std::unordered_set<HashValue>* visited,
+                                 std::vector<HashValue>* out) const {
+  if (!visited->insert(key).second) {
+    return;
+  }
+  auto iter = resources_.find(key);
+  if (iter == resources_.end()) {
+    return;
+  }
+  for (HashValue dependency : iter->second.dependencies) {
+    if (affected.count(dependency)) {
+      SortAffected(dependency, affected, visited, out);
+    }
+  }
+  out->push_back(key);
+}
+
+size_t AssetReloader::ProcessChanges() {
+  std::vector<ReloadFn> reloads;
+  {
+    Lock lock(mutex_);
+    if (changed_files_.empty()) {
+      return 0;
+    }
+
+    std::unordered_set<HashValue> affected;
+    for (HashValue file : changed_files_) {
+      auto iter = files_.find(file);
+      if (iter != files_.end()) {
+        for (HashValue resource : iter->second.dependents) {
+          CollectDependents(resource, &affected);
+        }
+      }
+    }
+    changed_files_.clear();
+
+    std::unordered_set<HashValue> visited;
+    std::vector<HashValue> order;
+    for (HashValue resource : affected) {
+      SortAffected(resource, affected, &visited, &order);
+    }
+
+    for (HashValue resource : order) {
+      auto iter = resources_.find(resource);
+      if (iter != resources_.end() && iter->second.reload) {
+        reloads.push_back(iter->second.reload);
+      }
+    }
+  }
+
+  // The lock is released since reloading typically re-registers the resource
+  // and its dependencies.
+  for (const ReloadFn& reload : reloads) {
+    reload();
+  }
+  return reloads.size();
+}
+
+}  // namespace lull
@@ -0,0 +1,151 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_FILE_ASSET_RELOADER_H_
+#define LULLABY_MODULES_FILE_ASSET_RELOADER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "lullaby/util/clock.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+/// Watches files for changes and re-creates only the resources (and Entities)
+/// that were built from them, allowing content to be iterated on without
+/// restarting the app or reloading the whole scene.
+///
+/// Resources are identified by a HashValue (typically the hash of the name
+/// used to cache them) and registered along with a function that re-creates
+/// them. Each resource can depend on any number of files and on other
+/// resources. When a file changes, every resource that depends on it, directly
+/// or indirectly, is reloaded exactly once, with dependencies reloaded before
+/// the resources that use them.
+///
+/// Currently only the EntityFactory registers its blueprints, so editing a
+/// blueprint re-creates the Entities built from it. Other resources (eg.
+/// shaders, textures or animations) are not reloaded unless their owners
+/// register them through AddResource/AddFileDependency.
+///
+/// File modification times are polled on a background thread, but reloads are
+/// only performed from ProcessChanges(), which should be called from the thread
+/// that owns the resources (usually the main/render thread).
+class AssetReloader {
+ public:
+  /// Re-creates a resource.
+  using ReloadFn = std::function<void()>;
+
+  /// Returns a value that changes whenever |filename| is modified, or 0 if the
+  /// file does not exist.
+  using ModificationTimeFn = std::function<int64_t(const std::string&)>;
+
+  AssetReloader();
+  ~AssetReloader();
+
+  AssetReloader(const AssetReloader&) = delete;
+  AssetReloader& operator=(const AssetReloader&) = delete;
+
+  /// Registers (or replaces) the function used to reload |resource|.
+  void AddResource(HashValue resource, ReloadFn fn);
+
+  /// Removes |resource| and all of its dependencies. Resources that depend on
+  /// |resource| are not affected.
+  void RemoveResource(HashValue resource);
+
+  /// Records that |resource| was created from the contents of |filename|.
+  void AddFileDependency(HashValue resource, const std::string& filename);
+
+  /// Records that |resource| uses |dependency|, so that it needs to be
+  /// re-created whenever |dependency| is.
+  void AddDependency(HashValue resource, HashValue dependency);
+
+  /// Sets the function used to query file modification times. By default, the
+  /// file system's modification time is used.
+  void SetModificationTimeFn(ModificationTimeFn fn);
+
+  /// Starts polling the watched files for changes every |interval| on a
+  /// background thread.
+  void StartWatching(Clock::duration interval);
+
+  /// Stops the background thread started by StartWatching.
+  void StopWatching();
+
+  /// Polls the watched files once, queuing any that have changed, and returns
+  /// the number of changed files. This is done automatically by the background
+  /// thread, and is only needed if StartWatching has not been called.
+  size_t CheckForChanges();
+
+  /// Queues |filename| as having changed, eg. in response to a notification
+  /// from an external file watcher or an editor.
+  void NotifyFileChanged(const std::string& filename);
+
+  /// Reloads all resources affected by the changed files and returns the
+  /// number of resources that were reloaded.
+  size_t ProcessChanges();
+
+ private:
+  struct Resource {
+    ReloadFn reload;
+    std::vector<HashValue> dependencies;
+    std::vector<HashValue> dependents;
+  };
+
+  struct WatchedFile {
+    std::string filename;
+    int64_t modification_time = 0;
+    std::vector<HashValue> dependents;
+  };
+
+  using Lock = std::unique_lock<std::mutex>;
+
+  void WatcherThread(Clock::duration interval);
+
+  // Adds |key| and everything depending on it (directly or indirectly) to
+  // |affected|.
+  void CollectDependents(HashValue key,
+                         std::unordered_set<HashValue>* affected) const;
+
+  // Appends |key| to |out| after first appending any of its dependencies that
+  // are also |affected|, so that dependencies are reloaded first.
+  void SortAffected(HashValue key,
+                    const std::unordered_set<HashValue>& affected,
+                    std::unordered_set<HashValue>* visited,
+                    std::vector<HashValue>* out) const;
+
+  std::unordered_map<HashValue, Resource> resources_;
+  std::unordered_map<HashValue, WatchedFile> files_;
+  std::unordered_set<HashValue> changed_files_;
+  ModificationTimeFn modification_time_fn_;
+
+  std::mutex mutex_;
+  std::condition_variable condvar_;
+  std::thread watcher_thread_;
+  bool watching_ = false;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::AssetReloader);
+
+#endif  // LULLABY_MODULES_FILE_ASSET_RELOADER_H_
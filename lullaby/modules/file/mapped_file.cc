@@ -0,0 +1,121 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/file/mapped_file.h"
+
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LULLABY_MAPPED_FILE_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define LULLABY_MAPPED_FILE_USE_MMAP 0
+#endif
+
+#ifdef __ANDROID__
+#include <android/asset_manager.h>
+#endif
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+MappedFile::~MappedFile() {
+#if LULLABY_MAPPED_FILE_USE_MMAP
+  if (mapped_) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+  }
+#endif
+#ifdef __ANDROID__
+  if (android_asset_) {
+    AAsset_close(android_asset_);
+  }
+#endif
+}
+
+MappedFilePtr MappedFile::Map(const std::string& filename) {
+#if LULLABY_MAPPED_FILE_USE_MMAP
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+    close(fd);
+    return nullptr;
+  }
+
+  const size_t size = static_cast<size_t>(info.st_size);
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping remains valid after the descriptor is closed.
+  close(fd);
+  if (data == MAP_FAILED) {
+    LOG(ERROR) << "Failed to map file " << filename;
+    return nullptr;
+  }
+
+  std::shared_ptr<MappedFile> file(new MappedFile());
+  file->data_ = static_cast<const uint8_t*>(data);
+  file->size_ = size;
+  file->mapped_ = true;
+  return file;
+#else
+  (void)filename;
+  return nullptr;
+#endif
+}
+
+#ifdef __ANDROID__
+MappedFilePtr MappedFile::MapAndroidAsset(AAssetManager* asset_manager,
+                                          const std::string& filename) {
+  if (!asset_manager) {
+    return nullptr;
+  }
+  AAsset* asset =
+      AAssetManager_open(asset_manager, filename.c_str(), AASSET_MODE_BUFFER);
+  if (!asset) {
+    return nullptr;
+  }
+
+  // Compressed assets are decompressed into a buffer owned by the AAsset, so
+  // this is never worse than reading them.
+  const void* buffer = AAsset_getBuffer(asset);
+  const off_t length = AAsset_getLength(asset);
+  if (!buffer || length <= 0) {
+    AAsset_close(asset);
+    return nullptr;
+  }
+
+  std::shared_ptr<MappedFile> file(new MappedFile());
+  file->data_ = static_cast<const uint8_t*>(buffer);
+  file->size_ = static_cast<size_t>(length);
+  file->android_asset_ = asset;
+  return file;
+}
+#endif  // __ANDROID__
+
+MappedFilePtr MappedFile::FromString(std::string data) {
+  std::shared_ptr<MappedFile> file(new MappedFile());
+  file->string_data_ = std::move(data);
+  file->data_ = reinterpret_cast<const uint8_t*>(file->string_data_.data());
+  file->size_ = file->string_data_.size();
+  return file;
+}
+
+}  // namespace lull
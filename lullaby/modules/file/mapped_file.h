@@ -0,0 +1,82 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_FILE_MAPPED_FILE_H_
+#define LULLABY_MODULES_FILE_MAPPED_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#ifdef __ANDROID__
+struct AAsset;
+struct AAssetManager;
+#endif
+
+namespace lull {
+
+class MappedFile;
+using MappedFilePtr = std::shared_ptr<const MappedFile>;
+
+// A read-only view of the contents of a file.  Where possible the file is
+// mapped into memory rather than read, so that its contents are used straight
+// from the page cache instead of being copied onto the heap.  The contents stay
+// valid for as long as the MappedFile exists.
+//
+// Note that, unlike a std::string, the contents are not null-terminated.
+class MappedFile {
+ public:
+  ~MappedFile();
+
+  // Maps the file called |filename| into memory.  Returns nullptr if the file
+  // cannot be opened or is empty, or if the platform cannot map files.
+  static MappedFilePtr Map(const std::string& filename);
+
+#ifdef __ANDROID__
+  // Opens the asset called |filename| from the |asset_manager| and uses its
+  // buffer directly.  Uncompressed assets are mapped from the APK.  Returns
+  // nullptr if the asset cannot be opened or is empty.
+  static MappedFilePtr MapAndroidAsset(AAssetManager* asset_manager,
+                                       const std::string& filename);
+#endif
+
+  // Wraps |data| that was already loaded into memory.
+  static MappedFilePtr FromString(std::string data);
+
+  const uint8_t* GetData() const { return data_; }
+  size_t GetSize() const { return size_; }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+ private:
+  MappedFile() {}
+
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+
+  // Only one of these owns |data_|, depending on how the file was loaded.
+  bool mapped_ = false;
+  std::string string_data_;
+#ifdef __ANDROID__
+  AAsset* android_asset_ = nullptr;
+#endif
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_MODULES_FILE_MAPPED_FILE_H_
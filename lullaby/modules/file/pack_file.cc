@@ -0,0 +1,158 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/file/pack_file.h"
+
+#include <string.h>
+#include <algorithm>
+#include <utility>
+
+#include "lullaby/util/logging.h"
+#include "zlib.h"
+
+namespace lull {
+namespace {
+
+bool IsInRange(uint64_t offset, uint64_t size, size_t file_size) {
+  return offset <= file_size && size <= file_size - offset;
+}
+
+string_view GetName(const uint8_t* data, const PackFileEntry& entry) {
+  return string_view(reinterpret_cast<const char*>(data + entry.name_offset),
+                     entry.name_size);
+}
+
+}  // namespace
+
+std::unique_ptr<PackFile> PackFile::Open(MappedFilePtr file) {
+  if (!file) {
+    return nullptr;
+  }
+  const uint8_t* data = file->GetData();
+  const size_t size = file->GetSize();
+  if (size < sizeof(PackFileHeader) ||
+      reinterpret_cast<uintptr_t>(data) % alignof(PackFileEntry) != 0) {
+    LOG(ERROR) << "Invalid pack file.";
+    return nullptr;
+  }
+
+  PackFileHeader header;
+  memcpy(&header, data, sizeof(header));
+  if (header.magic != kPackFileMagic) {
+    LOG(ERROR) << "Invalid pack file magic: " << header.magic;
+    return nullptr;
+  }
+  if (header.version != kPackFileVersion) {
+    LOG(ERROR) << "Unsupported pack file version: " << header.version;
+    return nullptr;
+  }
+  const uint64_t index_size =
+      static_cast<uint64_t>(header.num_entries) * sizeof(PackFileEntry);
+  if (!IsInRange(sizeof(header), index_size, size)) {
+    LOG(ERROR) << "Truncated pack file index.";
+    return nullptr;
+  }
+
+  // Check every entry up front, so that lookups don't need to.
+  const PackFileEntry* entries =
+      reinterpret_cast<const PackFileEntry*>(data + sizeof(header));
+  for (uint32_t i = 0; i < header.num_entries; ++i) {
+    const PackFileEntry& entry = entries[i];
+    if (!IsInRange(entry.name_offset, entry.name_size, size) ||
+        !IsInRange(entry.offset, entry.stored_size, size)) {
+      LOG(ERROR) << "Pack file entry " << i << " is out of range.";
+      return nullptr;
+    }
+    if (entry.compression != kPackFileCompression_None &&
+        entry.compression != kPackFileCompression_Zlib) {
+      LOG(ERROR) << "Unknown pack file compression: " << entry.compression;
+      return nullptr;
+    }
+    if (entry.compression == kPackFileCompression_None &&
+        entry.stored_size != entry.size) {
+      LOG(ERROR) << "Pack file entry " << i << " has mismatched sizes.";
+      return nullptr;
+    }
+    if (i > 0 && entries[i - 1].hash > entry.hash) {
+      LOG(ERROR) << "Pack file index is not sorted.";
+      return nullptr;
+    }
+  }
+  return std::unique_ptr<PackFile>(
+      new PackFile(std::move(file), entries, header.num_entries));
+}
+
+PackFile::PackFile(MappedFilePtr file, const PackFileEntry* entries,
+                   size_t num_entries)
+    : file_(std::move(file)), entries_(entries), num_entries_(num_entries) {}
+
+const PackFileEntry* PackFile::FindEntry(string_view name) const {
+  const HashValue hash = Hash(name);
+  const PackFileEntry* end = entries_ + num_entries_;
+  const PackFileEntry* iter = std::lower_bound(
+      entries_, end, hash,
+      [](const PackFileEntry& entry, HashValue hash) {
+        return entry.hash < hash;
+      });
+  // Compare names to tell apart entries whose hashes collide.
+  for (; iter != end && iter->hash == hash; ++iter) {
+    if (GetName(file_->GetData(), *iter) == name) {
+      return iter;
+    }
+  }
+  return nullptr;
+}
+
+bool PackFile::Load(string_view name, std::string* dest) const {
+  const PackFileEntry* entry = FindEntry(name);
+  if (entry == nullptr) {
+    return false;
+  }
+  const uint8_t* contents = file_->GetData() + entry->offset;
+  switch (entry->compression) {
+    case kPackFileCompression_None: {
+      dest->assign(reinterpret_cast<const char*>(contents),
+                   static_cast<size_t>(entry->size));
+      return true;
+    }
+    case kPackFileCompression_Zlib: {
+      dest->resize(static_cast<size_t>(entry->size));
+      uLongf dest_size = static_cast<uLongf>(entry->size);
+      const int result =
+          uncompress(reinterpret_cast<Bytef*>(&(*dest)[0]), &dest_size,
+                     contents, static_cast<uLong>(entry->stored_size));
+      if (result != Z_OK || dest_size != entry->size) {
+        LOG(ERROR) << "Failed to uncompress pack file entry: " << name;
+        dest->clear();
+        return false;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+string_view PackFile::GetUncompressedContents(string_view name) const {
+  const PackFileEntry* entry = FindEntry(name);
+  if (entry == nullptr || entry->compression != kPackFileCompression_None) {
+    return string_view();
+  }
+  return string_view(
+      reinterpret_cast<const char*>(file_->GetData() + entry->offset),
+      static_cast<size_t>(entry->size));
+}
+
+}  // namespace lull
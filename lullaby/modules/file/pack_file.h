@@ -0,0 +1,113 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_FILE_PACK_FILE_H_
+#define LULLABY_MODULES_FILE_PACK_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#include "lullaby/modules/file/mapped_file.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/string_view.h"
+
+// A pack file bundles many small asset files into one, so that they can be
+// loaded with a single open instead of one per file.  The layout is:
+//
+//   PackFileHeader
+//   PackFileEntry[num_entries], sorted by (hash, name)
+//   Entry names, not null-terminated
+//   Entry contents, each starting on a kPackFileAlignment boundary
+//
+// All values are little-endian.  Entries are stored either as-is or
+// compressed with zlib.  The alignment only keeps uncompressed contents
+// suitably aligned for direct use; it is not a page size, since entries are
+// always read through the PackFile rather than mapped individually.
+
+namespace lull {
+
+constexpr uint32_t kPackFileMagic = 0x4b41504c;  // "LPAK"
+constexpr uint32_t kPackFileVersion = 1;
+constexpr size_t kPackFileAlignment = 16;
+
+enum PackFileCompression : uint32_t {
+  kPackFileCompression_None = 0,
+  kPackFileCompression_Zlib = 1,
+};
+
+struct PackFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t num_entries;
+  uint32_t reserved;
+};
+
+struct PackFileEntry {
+  HashValue hash;        // Hash() of the name.
+  uint32_t compression;  // A PackFileCompression.
+  uint32_t name_offset;  // Offset of the name from the start of the file.
+  uint32_t name_size;
+  uint64_t offset;       // Offset of the contents from the start of the file.
+  uint64_t stored_size;  // Size of the contents in the file.
+  uint64_t size;         // Size of the contents once uncompressed.
+};
+
+static_assert(sizeof(PackFileHeader) == 16, "Unexpected PackFileHeader size.");
+static_assert(sizeof(PackFileEntry) == 40, "Unexpected PackFileEntry size.");
+
+// Provides read-only access to the entries of a pack file.
+class PackFile {
+ public:
+  // Creates a PackFile that reads from |file|, which it keeps alive.  Returns
+  // nullptr if |file| is not a valid pack file.
+  static std::unique_ptr<PackFile> Open(MappedFilePtr file);
+
+  // Returns the number of entries in the pack.
+  size_t GetNumEntries() const { return num_entries_; }
+
+  // Returns true if the pack has an entry called |name|.
+  bool Contains(string_view name) const { return FindEntry(name) != nullptr; }
+
+  // Copies, and if needed uncompresses, the contents of the entry called
+  // |name| into |dest|.  Returns false if there is no such entry or it cannot
+  // be uncompressed.
+  bool Load(string_view name, std::string* dest) const;
+
+  // Returns the contents of the uncompressed entry called |name| without
+  // copying them.  They stay valid for as long as the PackFile exists.
+  // Returns an empty string_view if there is no such entry or it is
+  // compressed.
+  string_view GetUncompressedContents(string_view name) const;
+
+  PackFile(const PackFile&) = delete;
+  PackFile& operator=(const PackFile&) = delete;
+
+ private:
+  PackFile(MappedFilePtr file, const PackFileEntry* entries,
+           size_t num_entries);
+
+  const PackFileEntry* FindEntry(string_view name) const;
+
+  MappedFilePtr file_;
+  const PackFileEntry* entries_;
+  size_t num_entries_;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_MODULES_FILE_PACK_FILE_H_
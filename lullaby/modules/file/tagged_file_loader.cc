@@ -60,7 +60,8 @@ bool TaggedFileLoader::LoadFile(const char* filename, std::string* dest) {
   std::string tag_used;
   bool loaded = false;
   if (ApplySettingsToFile(filename, &transformed_filename, &tag_used)) {
-    loaded = PlatformSpecificLoadFile(transformed_filename.c_str(), dest,
+    loaded = LoadFromPackFile(tag_used, transformed_filename, dest) ||
+             PlatformSpecificLoadFile(transformed_filename.c_str(), dest,
                                       tag_used);
     filename = transformed_filename.c_str();
   } else {
@@ -89,6 +90,31 @@ void TaggedFileLoader::RegisterTag(const std::string& tag,
   tag_settings_map_.emplace(tag, path_prefix);
 }
 
+void TaggedFileLoader::RegisterPackFile(
+    const std::string& tag, std::shared_ptr<const PackFile> pack_file) {
+  if (!pack_file) {
+    LOG(DFATAL) << "Null pack file for tag " << tag;
+    return;
+  }
+  pack_files_[tag] = std::move(pack_file);
+}
+
+bool TaggedFileLoader::LoadFromPackFile(const std::string& tag,
+                                        const std::string& transformed_filename,
+                                        std::string* dest) const {
+  const auto pack = pack_files_.find(tag);
+  if (pack == pack_files_.end()) {
+    return false;
+  }
+  // Pack entries are named relative to the tag, so remove any path prefix.
+  string_view name = transformed_filename;
+  const auto prefix = tag_settings_map_.find(tag);
+  if (prefix != tag_settings_map_.end()) {
+    name = name.substr(prefix->second.size());
+  }
+  return pack->second->Load(name, dest);
+}
+
 void TaggedFileLoader::RegisterAltPathForSuffix(
     const std::string& suffix, const std::string& path) {
   alt_paths_[suffix].push_back(path);
@@ -145,8 +171,9 @@ bool TaggedFileLoader::ApplySettingsToFile(
 bool TaggedFileLoader::ApplySettingsToFile(
     const std::string& tag, const char* filename,
     std::string* const transformed_filename) {
+  static const std::string kNoPathPrefix;
   const auto it = tag_settings_map_.find(tag);
-  if (it == tag_settings_map_.end()) {
+  if (it == tag_settings_map_.end() && pack_files_.count(tag) == 0) {
     LOG(WARNING) << "Unregistered tag " << tag << " for file " << filename;
     return false;
   }
@@ -154,7 +181,8 @@ bool TaggedFileLoader::ApplySettingsToFile(
     // Path is absolute, don't prepend anything.
     return false;
   }
-  const std::string& path_prefix = it->second;
+  const std::string& path_prefix =
+      it != tag_settings_map_.end() ? it->second : kNoPathPrefix;
   if (transformed_filename) {
     if (!path_prefix.empty()) {
       *transformed_filename = path_prefix + filename;
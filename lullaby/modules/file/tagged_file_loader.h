@@ -18,11 +18,13 @@ limitations under the License.
 #define LULLABY_MODULES_FILE_TAGGED_FILE_LOADER_H_
 
 #include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "fplbase/file_utilities.h"
+#include "lullaby/modules/file/pack_file.h"
 
 // This file implements a "tagging" system that allows for asset filenames to
 // change at runtime, which is necessary in certain contexts..
@@ -102,6 +104,14 @@ class TaggedFileLoader {
   bool ApplySettingsToFile(const char* filename,
                            std::string* const transformed_filename);
 
+  // Set up files with |tag| to be loaded from |pack_file|, which must outlive
+  // any use of the tag.  I.e. after registering tag "foo", loading
+  // "foo:path/to/a/file" loads the pack entry named "path/to/a/file".  Files
+  // missing from the pack are loaded as usual, using the path prefix that was
+  // registered for |tag|, or no prefix if there is none.
+  void RegisterPackFile(const std::string& tag,
+                        std::shared_ptr<const PackFile> pack_file);
+
   // Replace requests to load |from_file| to load |to_file| instead.
   // Replacement is performed before any tag settings are applied.
   void AddReplacementFile(const std::string& from_file,
@@ -136,6 +146,7 @@ class TaggedFileLoader {
 
  private:
   std::unordered_map<std::string, std::string> tag_settings_map_;
+  std::unordered_map<std::string, std::shared_ptr<const PackFile>> pack_files_;
   std::unordered_map<std::string, std::string> replacement_map_;
   std::unordered_map<std::string, std::vector<std::string>> alt_paths_;
   std::string default_tag_;
@@ -143,6 +154,12 @@ class TaggedFileLoader {
 
   bool ApplySettingsToFile(const std::string& tag, const char* filename,
                            std::string* const transformed_filename);
+
+  // Loads |transformed_filename| from the pack file registered for |tag|, if
+  // any.  Returns true if successful.
+  bool LoadFromPackFile(const std::string& tag,
+                        const std::string& transformed_filename,
+                        std::string* dest) const;
 };
 
 }  // namespace lull
@@ -20,6 +20,7 @@ limitations under the License.
 #include "lullaby/modules/function/variant_converter.h"
 #include "lullaby/util/fixed_string.h"
 #include "lullaby/util/hash.h"
+#include "lullaby/util/hashed_string.h"
 #include "lullaby/util/string_view.h"
 #include "lullaby/util/type_name_generator.h"
 #include "lullaby/util/typeid.h"
@@ -42,11 +43,12 @@ class FunctionCall {
   template <typename... Args>
   static FunctionCall Create(HashValue id, Args... args);
   template <typename... Args>
-  static FunctionCall Create(string_view name, Args... args);
+  static FunctionCall Create(HashedString name, Args... args);
 
   /// Creates a FunctionCall object with the specified name or ID.
   explicit FunctionCall(HashValue id) : id_(id) {}
-  explicit FunctionCall(string_view name) : id_(Hash(name)), name_(name) {}
+  explicit FunctionCall(HashedString name)
+      : id_(name.GetHash()), name_(name.GetString()) {}
 
   /// Returns the ID of the function call (which is the Hash of the name
   /// specified in the Create function).
@@ -101,7 +103,7 @@ FunctionCall FunctionCall::Create(HashValue id, Args... args) {
 }
 
 template <typename... Args>
-FunctionCall FunctionCall::Create(string_view name, Args... args) {
+FunctionCall FunctionCall::Create(HashedString name, Args... args) {
   FunctionCall call(name);
   int dummy[] = {(call.AddArg(std::forward<Args>(args)), 0)...};
   (void)dummy;
@@ -17,6 +17,7 @@ limitations under the License.
 #include "lullaby/modules/input/input_manager.h"
 
 #include <algorithm>
+#include <cmath>
 
 #include "lullaby/util/bits.h"
 #include "lullaby/util/logging.h"
@@ -39,6 +40,9 @@ mathfu::vec2 ClampVec2(const mathfu::vec2& value, float min, float max) {
   }
   return value;
 }
+
+// Pose samples further apart than this are not used to estimate velocities.
+const Clock::duration kMaxPoseVelocityInterval = std::chrono::milliseconds(100);
 }  // namespace
 
 const InputManager::ButtonState InputManager::kReleased = 0x01 << 0;
@@ -73,6 +77,9 @@ const InputManager::TouchId InputManager::kPrimaryTouchId =
 
 const uint8_t InputManager::kInvalidBatteryCharge = 255;
 
+const Clock::duration InputManager::kMaxPosePredictionTime =
+    std::chrono::milliseconds(50);
+
 InputManager::DeviceParams::DeviceParams()
     : has_position_dof(false),
       is_position_fake(false),
@@ -155,6 +162,7 @@ void InputManager::DisconnectDevice(DeviceType device) {
   // TODO: Update connected state in a thread-safe manner.
   std::unique_lock<std::mutex> lock(mutex_);
   devices_[device].Disconnect();
+  poses_[device].Clear();
 }
 
 void InputManager::UpdateKey(DeviceType device, const std::string& key,
@@ -162,6 +170,38 @@ void InputManager::UpdateKey(DeviceType device, const std::string& key,
   LOG(DFATAL) << "Keyboard support not yet implemented.";
 }
 
+void InputManager::UpdateKey(DeviceType device, KeyCode key, bool pressed,
+                             bool repeat) {
+  if (key < 0 || key >= kNumKeyCodes) {
+    LOG(DFATAL) << "Invalid key [" << key
+                << "] for device: " << GetDeviceName(device);
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  DeviceState* state = GetDeviceStateForWriteLocked(device);
+  if (state == nullptr) {
+    LOG(DFATAL) << "No state for device: " << GetDeviceName(device);
+    return;
+  }
+
+  const DataBuffer* buffer = GetDataBuffer(device);
+  if (buffer == nullptr) {
+    LOG(DFATAL) << "Invalid buffer for device: " << GetDeviceName(device);
+    return;
+  }
+
+  // Update the press time if the key was just pressed.
+  if (pressed && !buffer->GetCurrent().keys_down[key]) {
+    if (state->key_press_times.empty()) {
+      state->key_press_times.resize(kNumKeyCodes, Clock::time_point());
+    }
+    state->key_press_times[key] = state->time_stamp;
+  }
+  state->keys_down[key] = pressed;
+  state->keys_repeat[key] = repeat;
+}
+
 void InputManager::KeyPressed(DeviceType device, const std::string& key) {
   std::unique_lock<std::mutex> lock(mutex_);
   DeviceState* state = GetDeviceStateForWriteLocked(device);
@@ -472,6 +512,54 @@ void InputManager::UpdateRotation(DeviceType device,
   }
 }
 
+void InputManager::UpdatePose(DeviceType device, const mathfu::vec3& position,
+                              const mathfu::quat& rotation,
+                              Clock::time_point time) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  DeviceState* state = GetDeviceStateForWriteLocked(device);
+  if (state == nullptr) {
+    LOG(DFATAL) << "No state for device: " << GetDeviceName(device);
+    return;
+  }
+
+  if (state->position.empty() && state->rotation.empty()) {
+    LOG(DFATAL) << "Position and Rotation DOF not enabled for device: "
+                << GetDeviceName(device);
+    return;
+  }
+
+  PoseSample sample;
+  sample.time = time;
+  if (state->position.size() == 1) {
+    state->position[0] = position;
+    sample.position = position;
+  }
+  if (state->rotation.size() == 1) {
+    state->rotation[0] = rotation;
+    sample.rotation = rotation;
+  }
+
+  PoseSample prev;
+  if (poses_[device].Read(&prev) && time > prev.time &&
+      time - prev.time <= kMaxPoseVelocityInterval) {
+    const float dt = SecondsFromDuration(time - prev.time);
+    sample.linear_velocity = (sample.position - prev.position) / dt;
+
+    // Take the shortest path between the two rotations.
+    mathfu::quat delta = sample.rotation * prev.rotation.Inverse();
+    if (delta.scalar() < 0.f) {
+      delta = mathfu::quat(-delta.scalar(), -delta.vector());
+    }
+    const float sin_half_angle = delta.vector().Length();
+    if (sin_half_angle > kDefaultEpsilon) {
+      const float angle = 2.f * std::atan2(sin_half_angle, delta.scalar());
+      sample.angular_velocity =
+          delta.vector() * (angle / (sin_half_angle * dt));
+    }
+  }
+  poses_[device].Write(sample);
+}
+
 void InputManager::UpdateEye(DeviceType device, EyeType eye,
                              const mathfu::mat4& eye_from_head_matrix,
                              const mathfu::mat4& screen_from_eye_matrix,
@@ -630,6 +718,45 @@ InputManager::ButtonState InputManager::GetKeyState(
   return 0;
 }
 
+InputManager::ButtonState InputManager::GetKeyState(DeviceType device,
+                                                    KeyCode key) const {
+  const DataBuffer* buffer = GetConnectedDataBuffer(device);
+  if (buffer == nullptr) {
+    LOG(DFATAL) << "Invalid buffer for device: " << GetDeviceName(device);
+    return kInvalidButtonState;
+  }
+
+  if (key < 0 || key >= kNumKeyCodes) {
+    LOG(DFATAL) << "Invalid key [" << key
+                << "] for device: " << GetDeviceName(device);
+    return kInvalidButtonState;
+  }
+
+  const DeviceState& curr_buffer = buffer->GetCurrent();
+  const DeviceState& prev_buffer = buffer->GetPrevious();
+  const Clock::time_point curr_press_time =
+      curr_buffer.key_press_times.empty() ? Clock::time_point()
+                                          : curr_buffer.key_press_times[key];
+  const Clock::time_point prev_press_time =
+      prev_buffer.key_press_times.empty() ? Clock::time_point()
+                                          : prev_buffer.key_press_times[key];
+
+  const DeviceProfile* profile = GetDeviceProfile(device);
+  return GetButtonState(curr_buffer.keys_down[key], prev_buffer.keys_down[key],
+                        curr_buffer.keys_repeat[key], profile->long_press_time,
+                        curr_buffer.time_stamp, prev_buffer.time_stamp,
+                        curr_press_time, prev_press_time);
+}
+
+KeyCodeBitset InputManager::GetKeysDown(DeviceType device) const {
+  const DataBuffer* buffer = GetConnectedDataBuffer(device);
+  if (buffer == nullptr) {
+    LOG(DFATAL) << "Invalid buffer for device: " << GetDeviceName(device);
+    return KeyCodeBitset();
+  }
+  return buffer->GetCurrent().keys_down;
+}
+
 InputManager::ButtonState InputManager::GetButtonState(DeviceType device,
                                                        ButtonId button) const {
   const DataBuffer* buffer = GetConnectedDataBuffer(device);
@@ -1071,6 +1198,36 @@ mathfu::mat4 InputManager::GetDofWorldFromObjectMatrix(
   return CalculateTransformMatrix(pos, rot, mathfu::kOnes3f);
 }
 
+bool InputManager::GetLatestPose(DeviceType device, PoseSample* sample) const {
+  if (device == kMaxNumDeviceTypes) {
+    LOG(DFATAL) << "Invalid device type: " << GetDeviceName(device);
+    return false;
+  }
+  return poses_[device].Read(sample);
+}
+
+mathfu::mat4 InputManager::GetDofWorldFromObjectMatrix(
+    DeviceType device, Clock::time_point time) const {
+  PoseSample sample;
+  if (!GetLatestPose(device, &sample)) {
+    return GetDofWorldFromObjectMatrix(device);
+  }
+
+  const Clock::duration horizon =
+      std::min(std::max(time - sample.time, Clock::duration::zero()),
+               kMaxPosePredictionTime);
+  const float dt = SecondsFromDuration(horizon);
+
+  const mathfu::vec3 pos = sample.position + sample.linear_velocity * dt;
+  mathfu::quat rot = sample.rotation;
+  const float angular_speed = sample.angular_velocity.Length();
+  if (angular_speed > kDefaultEpsilon) {
+    const mathfu::vec3 axis = sample.angular_velocity / angular_speed;
+    rot = mathfu::quat::FromAngleAxis(angular_speed * dt, axis) * rot;
+  }
+  return CalculateTransformMatrix(pos, rot, mathfu::kOnes3f);
+}
+
 int InputManager::GetScrollDelta(DeviceType device) const {
   const DataBuffer* buffer = GetConnectedDataBuffer(device);
   if (buffer == nullptr) {
@@ -1339,6 +1496,72 @@ InputManager::DeviceState* InputManager::GetDeviceStateForWriteLocked(
   return &buffer->GetMutable();
 }
 
+InputManager::PoseChannel::PoseChannel()
+    : sequence_(0), time_(kInvalidSampleTime.time_since_epoch().count()) {
+  for (std::atomic<float>& value : values_) {
+    value.store(0.f, std::memory_order_relaxed);
+  }
+}
+
+void InputManager::PoseChannel::Write(const PoseSample& sample) {
+  const mathfu::vec3& pos = sample.position;
+  const mathfu::vec3 rot = sample.rotation.vector();
+  const mathfu::vec3& vel = sample.linear_velocity;
+  const mathfu::vec3& ang = sample.angular_velocity;
+  const float values[kNumValues] = {
+      pos.x, pos.y, pos.z, sample.rotation.scalar(), rot.x, rot.y, rot.z,
+      vel.x, vel.y, vel.z, ang.x, ang.y, ang.z,
+  };
+
+  // An odd sequence number indicates that a write is in progress.
+  const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < kNumValues; ++i) {
+    values_[i].store(values[i], std::memory_order_relaxed);
+  }
+  time_.store(sample.time.time_since_epoch().count(),
+              std::memory_order_relaxed);
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+bool InputManager::PoseChannel::Read(PoseSample* sample) const {
+  float values[kNumValues];
+  Clock::rep time;
+  while (true) {
+    const uint32_t begin = sequence_.load(std::memory_order_acquire);
+    if (begin & 1) {
+      continue;
+    }
+    for (size_t i = 0; i < kNumValues; ++i) {
+      values[i] = values_[i].load(std::memory_order_relaxed);
+    }
+    time = time_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence_.load(std::memory_order_relaxed) == begin) {
+      break;
+    }
+  }
+
+  if (time == kInvalidSampleTime.time_since_epoch().count()) {
+    return false;
+  }
+  if (sample) {
+    sample->position = mathfu::vec3(values[0], values[1], values[2]);
+    sample->rotation = mathfu::quat(values[3], values[4], values[5], values[6]);
+    sample->linear_velocity = mathfu::vec3(values[7], values[8], values[9]);
+    sample->angular_velocity = mathfu::vec3(values[10], values[11], values[12]);
+    sample->time = Clock::time_point(Clock::duration(time));
+  }
+  return true;
+}
+
+void InputManager::PoseChannel::Clear() {
+  PoseSample sample;
+  sample.time = kInvalidSampleTime;
+  Write(sample);
+}
+
 InputManager::ButtonState InputManager::GetButtonState(
     bool curr, bool prev, bool repeat, Clock::duration long_press_time,
     Clock::time_point curr_time_stamp, Clock::time_point prev_time_stamp,
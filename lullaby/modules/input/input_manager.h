@@ -17,12 +17,14 @@ limitations under the License.
 #ifndef LULLABY_MODULES_INPUT_INPUT_MANAGER_H_
 #define LULLABY_MODULES_INPUT_INPUT_MANAGER_H_
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
 
 #include "lullaby/modules/input/device_profile.h"
+#include "lullaby/modules/input/keycodes.h"
 #include "lullaby/util/clock.h"
 #include "lullaby/util/typeid.h"
 #include "lullaby/util/variant.h"
@@ -48,6 +50,13 @@ namespace lull {
 // input events by using a mutex.  State information is also safe to read from
 // multiple threads as they are read-only operations.  However, it is assumed
 // that no query operations will be performed during the AdvanceFrame call.
+//
+// Pose data can additionally be reported with timestamps via UpdatePose.  The
+// most recent pose sample for each device is kept outside of the frame buffer
+// in a lock-free channel so that the render thread can read it just before
+// submitting a frame (ie. "late latching") rather than using the pose captured
+// at the start of the frame.  See GetLatestPose and the time-based overload of
+// GetDofWorldFromObjectMatrix.
 class InputManager {
  public:
   InputManager();
@@ -180,6 +189,14 @@ class InputManager {
   // Gets the keys which were pressed.
   std::vector<std::string> GetPressedKeys(DeviceType device) const;
 
+  // Gets the current state of a keyboard's |key|, as reported by the KeyCode
+  // overload of UpdateKey.  Does not allocate.
+  ButtonState GetKeyState(DeviceType device, KeyCode key) const;
+
+  // Gets the set of keys which are currently down, as reported by the KeyCode
+  // overload of UpdateKey.  Does not allocate.
+  KeyCodeBitset GetKeysDown(DeviceType device) const;
+
   // Gets the current state of a device's |button|.
   ButtonState GetButtonState(DeviceType device, ButtonId button) const;
 
@@ -302,6 +319,38 @@ class InputManager {
   // those degrees of freedom).
   mathfu::mat4 GetDofWorldFromObjectMatrix(DeviceType device) const;
 
+  // A timestamped pose sample for a device, as reported by UpdatePose.
+  struct PoseSample {
+    mathfu::vec3 position = mathfu::kZeros3f;
+    mathfu::quat rotation = mathfu::quat::identity;
+    // Linear velocity, in units per second, estimated from the previous sample.
+    mathfu::vec3 linear_velocity = mathfu::kZeros3f;
+    // Angular velocity in world space, as an axis scaled by radians per second,
+    // estimated from the previous sample.
+    mathfu::vec3 angular_velocity = mathfu::kZeros3f;
+    Clock::time_point time = kInvalidSampleTime;
+  };
+
+  // The furthest into the future that a pose will be predicted.
+  static const Clock::duration kMaxPosePredictionTime;
+
+  // Gets the most recent pose sample reported for the |device| via UpdatePose.
+  // Returns false if there is no such sample.  Unlike other queries, this
+  // returns the latest sample rather than the state captured by AdvanceFrame,
+  // and is safe to call from any thread at any time (including during
+  // AdvanceFrame) without blocking.
+  bool GetLatestPose(DeviceType device, PoseSample* sample) const;
+
+  // Gets a matrix composed of the Position and Rotation of the most recent pose
+  // sample for the |device|, extrapolated to |time| (eg. the time at which the
+  // frame being rendered is expected to be displayed).  Extrapolation is
+  // limited to kMaxPosePredictionTime past the sample's time.  Like
+  // GetLatestPose, this is safe to call at any time.  If no pose samples have
+  // been reported for the |device|, this falls back to the frame state (see
+  // above), in which case it must not be called during AdvanceFrame.
+  mathfu::mat4 GetDofWorldFromObjectMatrix(DeviceType device,
+                                           Clock::time_point time) const;
+
   // Gets the delta value for a |device| with a scroll wheel.
   int GetScrollDelta(DeviceType device) const;
 
@@ -381,6 +430,12 @@ class InputManager {
   // trigger another event.
   void UpdateKey(DeviceType device, const std::string& key, bool repeat);
 
+  // Updates the state of the |key| for the |device|.  The |pressed| flag is
+  // used to specify if the key is down or up, and the |repeat| flag can be used
+  // to indicate whether the key has been held long enough for the repeat rate
+  // to trigger another event.
+  void UpdateKey(DeviceType device, KeyCode key, bool pressed, bool repeat);
+
   // Updates which alphanumeric keys are pressed on the |device|.
   void KeyPressed(DeviceType device, const std::string& key);
 
@@ -428,6 +483,12 @@ class InputManager {
   // Updates rotation of the |device|.
   void UpdateRotation(DeviceType device, const mathfu::quat& value);
 
+  // Updates the position and rotation of the |device| (for the degrees of
+  // freedom it has) as sampled at |time|, and publishes the sample for late
+  // latching.  Samples should be reported in increasing time order.
+  void UpdatePose(DeviceType device, const mathfu::vec3& position,
+                  const mathfu::quat& rotation, Clock::time_point time);
+
   // Updates the "eye from head", "screen from eye", "field of view", and
   // "viewport" settings for the |device| and |eye|.
   void UpdateEye(DeviceType device, EyeType eye,
@@ -453,6 +514,28 @@ class InputManager {
 
  private:
   static const Clock::time_point kInvalidSampleTime;
+
+  // Holds the most recent PoseSample for a device.  Implemented as a seqlock
+  // so that readers never block or allocate; a reader that races with a write
+  // simply retries.  Writes must be serialized externally (by mutex_).
+  class PoseChannel {
+   public:
+    PoseChannel();
+
+    void Write(const PoseSample& sample);
+    bool Read(PoseSample* sample) const;
+    void Clear();
+
+   private:
+    static const size_t kNumValues = 13;
+    std::atomic<uint32_t> sequence_;
+    std::atomic<float> values_[kNumValues];
+    std::atomic<Clock::rep> time_;
+
+    PoseChannel(const PoseChannel&) = delete;
+    PoseChannel& operator=(const PoseChannel&) = delete;
+  };
+
   struct Touch {
     mathfu::vec2 position = kInvalidTouchLocation;
     mathfu::vec2 gesture_origin = kInvalidTouchLocation;
@@ -485,6 +568,11 @@ class InputManager {
     DeviceState() {}
 
     std::vector<std::string> keys;
+    KeyCodeBitset keys_down;
+    KeyCodeBitset keys_repeat;
+    // Sized to kNumKeyCodes when the first KeyCode is reported so that devices
+    // without keys don't pay for copying it each frame.
+    std::vector<Clock::time_point> key_press_times;
     std::vector<int> scroll;
     std::vector<bool> buttons;
     std::vector<Clock::time_point> button_press_times;
@@ -581,6 +669,7 @@ class InputManager {
 
   std::mutex mutex_;
   Device devices_[kMaxNumDeviceTypes];
+  PoseChannel poses_[kMaxNumDeviceTypes];
 };
 
 }  // namespace lull
@@ -0,0 +1,174 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_INPUT_KEYCODES_H_
+#define LULLABY_MODULES_INPUT_KEYCODES_H_
+
+#include <bitset>
+
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+// Identifiers for keyboard keys, used by the InputManager's KeyCode-based
+// keyboard APIs.  Unlike the string-based APIs, these allow keyboard state to
+// be stored and queried without any allocations.
+enum KeyCode {
+  kKeyCodeA,
+  kKeyCodeB,
+  kKeyCodeC,
+  kKeyCodeD,
+  kKeyCodeE,
+  kKeyCodeF,
+  kKeyCodeG,
+  kKeyCodeH,
+  kKeyCodeI,
+  kKeyCodeJ,
+  kKeyCodeK,
+  kKeyCodeL,
+  kKeyCodeM,
+  kKeyCodeN,
+  kKeyCodeO,
+  kKeyCodeP,
+  kKeyCodeQ,
+  kKeyCodeR,
+  kKeyCodeS,
+  kKeyCodeT,
+  kKeyCodeU,
+  kKeyCodeV,
+  kKeyCodeW,
+  kKeyCodeX,
+  kKeyCodeY,
+  kKeyCodeZ,
+  kKeyCode0,
+  kKeyCode1,
+  kKeyCode2,
+  kKeyCode3,
+  kKeyCode4,
+  kKeyCode5,
+  kKeyCode6,
+  kKeyCode7,
+  kKeyCode8,
+  kKeyCode9,
+  kKeyCodeKeypad0,
+  kKeyCodeKeypad1,
+  kKeyCodeKeypad2,
+  kKeyCodeKeypad3,
+  kKeyCodeKeypad4,
+  kKeyCodeKeypad5,
+  kKeyCodeKeypad6,
+  kKeyCodeKeypad7,
+  kKeyCodeKeypad8,
+  kKeyCodeKeypad9,
+  kKeyCodeKeypadPlus,
+  kKeyCodeKeypadMinus,
+  kKeyCodeKeypadMultiply,
+  kKeyCodeKeypadDivide,
+  kKeyCodeKeypadEnter,
+  kKeyCodeKeypadPeriod,
+  kKeyCodeKeypadEquals,
+  kKeyCodeEscape,
+  kKeyCodeTab,
+  kKeyCodeReturn,
+  kKeyCodeSpace,
+  kKeyCodeBackspace,
+  kKeyCodeComma,
+  kKeyCodePeriod,
+  kKeyCodeSlash,
+  kKeyCodeBackslash,
+  kKeyCodeColon,
+  kKeyCodeSemicolon,
+  kKeyCodeLeftBracket,
+  kKeyCodeRightBracket,
+  kKeyCodeLeftParen,
+  kKeyCodeRightParen,
+  kKeyCodeSingleQuote,
+  kKeyCodeDoubleQuote,
+  kKeyCodeBackQuote,
+  kKeyCodeExclamation,
+  kKeyCodeAt,
+  kKeyCodeHash,
+  kKeyCodeDollar,
+  kKeyCodePercent,
+  kKeyCodeCaret,
+  kKeyCodeAmpersand,
+  kKeyCodeAsterisk,
+  kKeyCodeQuestion,
+  kKeyCodePlus,
+  kKeyCodeMinus,
+  kKeyCodeLess,
+  kKeyCodeEquals,
+  kKeyCodeGreater,
+  kKeyCodeUnderscore,
+  kKeyCodeUp,
+  kKeyCodeDown,
+  kKeyCodeLeft,
+  kKeyCodeRight,
+  kKeyCodeCapsLock,
+  kKeyCodeNumLock,
+  kKeyCodeScrollLock,
+  kKeyCodePrintScreen,
+  kKeyCodePause,
+  kKeyCodeInsert,
+  kKeyCodeDelete,
+  kKeyCodeHome,
+  kKeyCodeEnd,
+  kKeyCodePageUp,
+  kKeyCodePageDown,
+  kKeyCodeLeftCtrl,
+  kKeyCodeLeftShift,
+  kKeyCodeLeftAlt,
+  kKeyCodeLeftGui,
+  kKeyCodeRightCtrl,
+  kKeyCodeRightShift,
+  kKeyCodeRightAlt,
+  kKeyCodeRightGui,
+  kKeyCodeMode,
+  kKeyCodeF1,
+  kKeyCodeF2,
+  kKeyCodeF3,
+  kKeyCodeF4,
+  kKeyCodeF5,
+  kKeyCodeF6,
+  kKeyCodeF7,
+  kKeyCodeF8,
+  kKeyCodeF9,
+  kKeyCodeF10,
+  kKeyCodeF11,
+  kKeyCodeF12,
+  kKeyCodeF13,
+  kKeyCodeF14,
+  kKeyCodeF15,
+  kKeyCodeF16,
+  kKeyCodeF17,
+  kKeyCodeF18,
+  kKeyCodeF19,
+  kKeyCodeF20,
+  kKeyCodeF21,
+  kKeyCodeF22,
+  kKeyCodeF23,
+  kKeyCodeF24,
+  kNumKeyCodes,
+};
+
+// The set of keys that are down on a keyboard, indexed by KeyCode.
+using KeyCodeBitset = std::bitset<kNumKeyCodes>;
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::KeyCode);
+
+#endif  // LULLABY_MODULES_INPUT_KEYCODES_H_
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/modules/input_processor/gesture.h"
 
+#include <algorithm>
+
 #include "lullaby/modules/input_processor/input_processor.h"
 
 namespace lull {
@@ -48,4 +50,15 @@ GestureRecognizer::GestureRecognizer(Registry* registry, string_view name,
   input_manager_ = registry_->Get<InputManager>();
 }
 
+GesturePtr GestureRecognizer::TryStartFromSamples(
+    InputManager::DeviceType device, InputManager::TouchpadId touchpad,
+    Span<const TouchSample*> samples) {
+  InputManager::TouchId ids[kMaxTouchesPerGesture];
+  const size_t num_ids = std::min(samples.size(), kMaxTouchesPerGesture);
+  for (size_t i = 0; i < num_ids; ++i) {
+    ids[i] = samples[i]->id;
+  }
+  return TryStart(device, touchpad, Gesture::TouchIdSpan(ids, num_ids));
+}
+
 }  // namespace lull
@@ -45,6 +45,29 @@ const HashValue kTouchIdHashes[] = {
 
 class InputProcessor;
 
+/// A touch as sampled by the InputProcessor at the start of gesture
+/// recognition.  Each touch is sampled once per frame and the samples are
+/// shared by all the GestureRecognizers of the touchpad, so recognizers do not
+/// need to query the InputManager themselves.
+struct TouchSample {
+  /// Bits describing the touch, used to reject touches before calling
+  /// GestureRecognizer::TryStart.
+  enum Flags : uint32_t {
+    /// The touch is owned by a Gesture.
+    kOwned = 1 << 0,
+    /// The touch moved this frame.
+    kMoving = 1 << 1,
+  };
+
+  InputManager::TouchId id = 0;
+  uint32_t flags = 0;
+  /// The gesture origin, current location and movement this frame of the
+  /// touch, all in centimeters.
+  mathfu::vec2 origin_cm = mathfu::kZeros2f;
+  mathfu::vec2 location_cm = mathfu::kZeros2f;
+  mathfu::vec2 delta_cm = mathfu::kZeros2f;
+};
+
 /// Gesture is a base class that actual gestures should extend.  This represents
 /// a single active gesture, which owns some number of touches.
 /// To create a gesture, override Gesture and GestureRecognizer, implementing
@@ -144,13 +167,34 @@ class GestureRecognizer {
 
   /// This function should return a new Gesture if and only if the passed in
   /// touch |ids| have been identified as starting a gesture.  This function
-  /// will be called with touches that are currently owned by another touch.
+  /// will be called with touches that are currently owned by another touch,
+  /// unless rejected by GetRejectedTouchFlags().
   virtual GesturePtr TryStart(InputManager::DeviceType device,
                               InputManager::TouchpadId touchpad,
                               Gesture::TouchIdSpan ids) {
     return nullptr;
   }
 
+  /// As TryStart, but receives the samples of the touches taken this frame.
+  /// This is what InputProcessor calls; the default implementation forwards
+  /// the touch ids to TryStart.
+  virtual GesturePtr TryStartFromSamples(InputManager::DeviceType device,
+                                         InputManager::TouchpadId touchpad,
+                                         Span<const TouchSample*> samples);
+
+  /// TouchSample::Flags that every touch passed to TryStart must have, or must
+  /// not have, respectively.  Touches are rejected with these masks before
+  /// calling TryStart, so a recognizer that is not interested in a touch does
+  /// not cost anything for it.
+  uint32_t GetRequiredTouchFlags() const { return required_touch_flags_; }
+  uint32_t GetRejectedTouchFlags() const { return rejected_touch_flags_; }
+
+  /// Returns true if |sample| passes the required and rejected flag masks.
+  bool AcceptsTouch(const TouchSample& sample) const {
+    return (sample.flags & required_touch_flags_) == required_touch_flags_ &&
+           (sample.flags & rejected_touch_flags_) == 0;
+  }
+
   /// Called by InputProcessor before any TryStart calls in a frame.  This sets
   /// the current display size in centimeters, so that touch thresholds can be
   /// independent of screen size.
@@ -168,6 +212,8 @@ class GestureRecognizer {
   std::string name_;
   HashValue hash_;
   size_t num_touches_;
+  uint32_t required_touch_flags_ = 0;
+  uint32_t rejected_touch_flags_ = 0;
   // Size of the screen in cm.  Multiply by inputManager touch deltas before
   // doing any threshold calculations.
   mathfu::vec2 touchpad_size_cm_ = mathfu::vec2(-1.0f, -1.0f);
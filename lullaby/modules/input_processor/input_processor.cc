@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "lullaby/events/input_events.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/serialize/variant_serializer.h"
 #include "lullaby/systems/dispatcher/dispatcher_system.h"
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/bits.h"
@@ -34,6 +35,9 @@ constexpr float kRayDragSlop = 2.0f * kDegreesToRadians;
 constexpr float kRayCancelSlop = 35.0f * kDegreesToRadians;
 constexpr float kTouchCancelSlop = .1f;
 constexpr const char* kAnyPrefix = "Any";
+// Touches that move less than this (squared, in touchpad units) in a frame
+// are not considered moving.
+constexpr float kTouchMovingThresholdSquared = 0.00001f;
 
 template <typename PressEvent, typename ReleaseEvent, typename ClickEvent,
           typename LongPressEvent, typename LongClickEvent>
@@ -182,10 +186,10 @@ void InputProcessor::UpdateFocus(InputManager::DeviceType device) {
       focus.previous.interactive ? focus.previous.target : kNullEntity;
   if (current != previous) {
     if (previous != kNullEntity) {
-      SendDeviceEvent(device, kFocusStop, previous, nullptr);
+      SendDeviceEvent(device, kFocusStop, previous);
     }
     if (current != kNullEntity) {
-      SendDeviceEvent(device, kFocusStart, current, nullptr);
+      SendDeviceEvent(device, kFocusStart, current);
     }
   }
 }
@@ -311,10 +315,11 @@ void InputProcessor::HandlePress(InputManager::DeviceType device,
       focus.current.interactive ? focus.current.target : kNullEntity;
   button_state->ms_since_press = 0;
   SetButtonTarget(device, button_state);
-  VariantMap values;
-  values.emplace(kLocationHash, button_state->pressed_location);
+  InputEvent event;
+  event.values = InputEvent::kHasLocation;
+  event.location = button_state->pressed_location;
   SendButtonEvent(device, button_id, kPress, button_state->focused_entity,
-                  &values);
+                  &event);
 }
 
 void InputProcessor::HandleDragStart(InputManager::DeviceType device,
@@ -334,9 +339,10 @@ void InputProcessor::HandleDragStart(InputManager::DeviceType device,
           world_mat->Inverse() * focus.current.cursor_position;
     }
   }
-  VariantMap values;
-  values.emplace(kLocationHash, drag_start_location);
-  SendButtonEvent(device, button_id, kDragStart, current, &values);
+  InputEvent event;
+  event.values = InputEvent::kHasLocation;
+  event.location = drag_start_location;
+  SendButtonEvent(device, button_id, kDragStart, current, &event);
 }
 
 void InputProcessor::HandleRelease(InputManager::DeviceType device,
@@ -357,9 +363,10 @@ void InputProcessor::HandleRelease(InputManager::DeviceType device,
   } else if (button_state->state == kInsideSlop &&
              button_state->focused_entity == current &&
              !CheckBit(button, InputManager::kLongPressed)) {
-    VariantMap values;
-    values.emplace(kDurationHash, button_state->ms_since_press);
-    SendButtonEvent(device, button_id, kClick, current, &values);
+    InputEvent event;
+    event.values = InputEvent::kHasDuration;
+    event.duration = button_state->ms_since_press;
+    SendButtonEvent(device, button_id, kClick, current, &event);
   }
 
   ResetButton(button_state);
@@ -397,18 +404,20 @@ void InputProcessor::HandleReleaseLegacy(
     }
   }
 
-  VariantMap values;
-  values.emplace(kPressedEntityHash, button_state->focused_entity);
-  SendButtonEvent(device, button_id, kRelease, current, &values);
+  InputEvent event;
+  event.values = InputEvent::kHasPressedEntity;
+  event.pressed_entity = button_state->focused_entity;
+  SendButtonEvent(device, button_id, kRelease, current, &event);
 
   // TODO need to only send click if within touch slop / cancel
   // threshold.
   if (button_state->focused_entity == current &&
       !CheckBit(button, InputManager::kLongPressed)) {
-    VariantMap click_values;
-    click_values.emplace(kDurationHash, button_state->ms_since_press);
+    InputEvent click_event;
+    click_event.values = InputEvent::kHasDuration;
+    click_event.duration = button_state->ms_since_press;
     SendButtonEvent(device, button_id, kClick, button_state->focused_entity,
-                    &click_values);
+                    &click_event);
   }
   ResetButton(button_state);
 }
@@ -578,36 +587,67 @@ void InputProcessor::UpdateTouchGestures(const Clock::duration& delta_time,
     return;
   }
 
+  // Sample every touch once, to be shared by all the recognizers.
+  std::vector<TouchSample>& samples = touchpad_state.samples;
+  samples.clear();
+  for (auto& pair : touchpad_state.touches) {
+    const mathfu::vec2 delta =
+        input_manager->GetTouchDelta(device, touchpad, pair.first);
+    TouchSample sample;
+    sample.id = pair.first;
+    if (pair.second.owner) {
+      sample.flags |= TouchSample::kOwned;
+    }
+    if (delta.LengthSquared() >= kTouchMovingThresholdSquared) {
+      sample.flags |= TouchSample::kMoving;
+    }
+    sample.origin_cm =
+        touchpad_size.value() *
+        input_manager->GetTouchGestureOrigin(device, touchpad, pair.first);
+    sample.location_cm =
+        touchpad_size.value() *
+        input_manager->GetTouchLocation(device, touchpad, pair.first);
+    sample.delta_cm = touchpad_size.value() * delta;
+    DCHECK(sample.origin_cm != InputManager::kInvalidTouchLocation);
+    DCHECK(sample.location_cm != InputManager::kInvalidTouchLocation);
+    samples.emplace_back(sample);
+  }
+
   // for each Recognizer
-  //   for each tuple of pressed touches
+  //   for each tuple of pressed touches accepted by the recognizer
   //     TryCreate()
-  Gesture::TouchIdVector touches;
-  for (auto recognizer : touchpad_state.recognizers) {
+  // Touches are rejected by flags before calling the recognizer, so touches
+  // that are owned by a gesture (or otherwise uninteresting) are cheap.
+  size_t touches[kMaxTouchesPerGesture];
+  for (auto& recognizer : touchpad_state.recognizers) {
     recognizer->SetTouchpadSize(touchpad_size.value());
     const size_t num_touches = recognizer->GetNumTouches();
-    touches.resize(num_touches);
+    if (num_touches > samples.size()) {
+      continue;
+    }
     if (num_touches == 1) {
-      for (auto& pair : touchpad_state.touches) {
-        touches[0] = pair.first;
-        GesturePtr gesture = recognizer->TryStart(device, touchpad, touches);
-        if (gesture != nullptr) {
-          HandleGestureStart(device, touchpad, touches, gesture, recognizer);
+      for (size_t i = 0; i < samples.size(); ++i) {
+        if (!recognizer->AcceptsTouch(samples[i])) {
+          continue;
         }
+        touches[0] = i;
+        TryStartGesture(device, touchpad, recognizer, touches, num_touches);
       }
     } else if (num_touches == 2) {
       // Note: these loops will call TryStart will all unique pairs of
-      // touches.
-      for (auto first_iter = touchpad_state.touches.begin();
-           first_iter != touchpad_state.touches.end(); ++first_iter) {
-        touches[0] = first_iter->first;
-        auto second_iter = first_iter;
-        ++second_iter;
-        for (; second_iter != touchpad_state.touches.end(); ++second_iter) {
-          touches[1] = second_iter->first;
-          GesturePtr gesture = recognizer->TryStart(device, touchpad, touches);
-          if (gesture != nullptr) {
-            HandleGestureStart(device, touchpad, touches, gesture, recognizer);
+      // accepted touches.
+      for (size_t i = 0; i < samples.size(); ++i) {
+        touches[0] = i;
+        for (size_t j = i + 1; j < samples.size(); ++j) {
+          // Starting a gesture may have changed the first touch's flags.
+          if (!recognizer->AcceptsTouch(samples[i])) {
+            break;
+          }
+          if (!recognizer->AcceptsTouch(samples[j])) {
+            continue;
           }
+          touches[1] = j;
+          TryStartGesture(device, touchpad, recognizer, touches, num_touches);
         }
       }
     } else {
@@ -633,6 +673,31 @@ void InputProcessor::UpdateTouchGestures(const Clock::duration& delta_time,
   }
 }
 
+void InputProcessor::TryStartGesture(InputManager::DeviceType device,
+                                     InputManager::TouchpadId touchpad,
+                                     const GestureRecognizerPtr& recognizer,
+                                     const size_t* touches,
+                                     size_t num_touches) {
+  Touchpad& touchpad_state = touchpad_states_[std::make_pair(device, touchpad)];
+  const TouchSample* samples[kMaxTouchesPerGesture];
+  for (size_t i = 0; i < num_touches; ++i) {
+    samples[i] = &touchpad_state.samples[touches[i]];
+  }
+  GesturePtr gesture = recognizer->TryStartFromSamples(
+      device, touchpad, Span<const TouchSample*>(samples, num_touches));
+  if (gesture == nullptr) {
+    return;
+  }
+  InputManager::TouchId ids[kMaxTouchesPerGesture];
+  for (size_t i = 0; i < num_touches; ++i) {
+    // Later recognizers must see that the touch is now owned.
+    touchpad_state.samples[touches[i]].flags |= TouchSample::kOwned;
+    ids[i] = samples[i]->id;
+  }
+  HandleGestureStart(device, touchpad, Gesture::TouchIdSpan(ids, num_touches),
+                     gesture, recognizer);
+}
+
 void InputProcessor::CancelAllGestures(const Clock::duration& delta_time,
                                        InputManager::DeviceType device,
                                        InputManager::TouchpadId touchpad) {
@@ -670,8 +735,8 @@ void InputProcessor::HandleGestureStart(InputManager::DeviceType device,
   FocusPair& focus = input_foci_[device];
   Entity target =
       focus.current.interactive ? focus.current.target : kNullEntity;
-  VariantMap values = gesture->GetEventValues();
-  SendGestureEvent(device, touchpad, gesture, kGestureStart, target, &values);
+  SendGestureEvent(device, touchpad, gesture, kGestureStart, target,
+                   gesture->GetEventValues());
 }
 
 void InputProcessor::HandleGestureEnd(InputManager::DeviceType device,
@@ -682,8 +747,8 @@ void InputProcessor::HandleGestureEnd(InputManager::DeviceType device,
   FocusPair& focus = input_foci_[device];
   Entity target =
       focus.current.interactive ? focus.current.target : kNullEntity;
-  VariantMap values = gesture->GetEventValues();
-  SendGestureEvent(device, touchpad, gesture, event_type, target, &values);
+  SendGestureEvent(device, touchpad, gesture, event_type, target,
+                   gesture->GetEventValues());
 
   Touchpad& touchpad_state = touchpad_states_[std::make_pair(device, touchpad)];
   for (auto& iter : touchpad_state.touches) {
@@ -704,11 +769,12 @@ void InputProcessor::HandleTouchPress(InputManager::DeviceType device,
       focus.current.interactive ? focus.current.target : kNullEntity;
   touch->ms_since_press = 0;
   SetButtonTarget(device, touch);
-  VariantMap values;
-  values.emplace(kLocationHash, touch->pressed_location);
-  values.emplace(kTouchLocationHash, touch_start_position);
+  InputEvent event;
+  event.values = InputEvent::kHasLocation | InputEvent::kHasTouchLocation;
+  event.location = touch->pressed_location;
+  event.touch_location = touch_start_position;
   SendTouchEvent(device, touchpad, id, kTouchPress, touch->focused_entity,
-                 &values);
+                 &event);
 }
 
 void InputProcessor::HandleTouchRelease(
@@ -732,9 +798,10 @@ void InputProcessor::HandleTouchRelease(
 
   if (touch->state == kInsideSlop &&
       !CheckBit(touch_state, InputManager::kLongPressed)) {
-    VariantMap values;
-    values.emplace(kDurationHash, touch->ms_since_press);
-    SendTouchEvent(device, touchpad, id, kTouchClick, current, &values);
+    InputEvent event;
+    event.values = InputEvent::kHasDuration;
+    event.duration = touch->ms_since_press;
+    SendTouchEvent(device, touchpad, id, kTouchClick, current, &event);
   }
   ResetTouch(touch);
 }
@@ -773,9 +840,10 @@ void InputProcessor::HandleTouchDragStart(InputManager::DeviceType device,
           world_mat->Inverse() * focus.current.cursor_position;
     }
   }
-  VariantMap values;
-  values.emplace(kLocationHash, drag_start_location);
-  SendTouchEvent(device, touchpad, id, kTouchDragStart, current, &values);
+  InputEvent event;
+  event.values = InputEvent::kHasLocation;
+  event.location = drag_start_location;
+  SendTouchEvent(device, touchpad, id, kTouchDragStart, current, &event);
 }
 
 void InputProcessor::HandleTouchSwipeStart(InputManager::DeviceType device,
@@ -786,9 +854,10 @@ void InputProcessor::HandleTouchSwipeStart(InputManager::DeviceType device,
   const Entity current =
       focus.current.interactive ? focus.current.target : kNullEntity;
   mathfu::vec2 touch_move_start_location = mathfu::kZeros2f;
-  VariantMap values;
-  values.emplace(kLocationHash, touch_move_start_location);
-  SendTouchEvent(device, touchpad, id, kSwipeStart, current, &values);
+  InputEvent event;
+  event.values = InputEvent::kHasSwipeLocation;
+  event.swipe_location = touch_move_start_location;
+  SendTouchEvent(device, touchpad, id, kSwipeStart, current, &event);
 }
 
 void InputProcessor::SetButtonTarget(InputManager::DeviceType device,
@@ -904,20 +973,24 @@ void InputProcessor::ClearTouchPrefix(InputManager::DeviceType device,
 }
 
 void InputProcessor::SendDeviceEvent(InputManager::DeviceType device,
-                                     DeviceEventType event_type, Entity target,
-                                     const VariantMap* values) {
+                                     DeviceEventType event_type,
+                                     Entity target) {
+  InputEvent event;
+  event.target = target;
+  event.device = device;
+
   auto iter = device_events_.find(device);
   if (iter != device_events_.end()) {
     // Send events with a specific prefix.
-    SendEvent(iter->second, event_type, target, device, values);
+    SendEvent(iter->second, event_type, event);
   }
 
   // Send generic events.
-  SendEvent(any_device_events_, event_type, target, device, values);
+  SendEvent(any_device_events_, event_type, event);
 
   if (legacy_mode_ != kNoLegacy && device == GetPrimaryDevice() &&
       legacy_device_events_.events[event_type] != 0) {
-    SendEvent(legacy_device_events_, event_type, target, device, values);
+    SendRuntimeEvent(legacy_device_events_, event_type, event, nullptr);
   }
 }
 
@@ -925,27 +998,38 @@ void InputProcessor::SendGestureEvent(InputManager::DeviceType device,
                                       InputManager::TouchpadId touchpad,
                                       const GesturePtr gesture,
                                       GestureEventType event_type,
-                                      Entity target, VariantMap* values) {
-  VariantMap event_values;
-  if (values == nullptr) {
-    values = &event_values;
-  }
-  values->emplace(kTouchpadIdHash, touchpad);
+                                      Entity target, const VariantMap& values) {
+  InputEvent event;
+  event.values = InputEvent::kHasTouchpad;
+  event.target = target;
+  event.device = device;
+  event.touchpad = touchpad;
 
   Gesture::TouchIdVector ids = gesture->GetTouches();
   DCHECK(ids.size() <= kMaxTouchesPerGesture);
   for (int i = 0; i < ids.size() && i < kMaxTouchesPerGesture; ++i) {
-    values->emplace(kTouchIdHashes[i], ids[i]);
+    event.touch_ids[i] = ids[i];
+    ++event.num_touch_ids;
   }
 
+  // Gestures may add their own values, so they are sent as runtime events.
+  const VariantMap* extra_values = values.empty() ? nullptr : &values;
   Touchpad& touchpad_state = touchpad_states_[std::make_pair(device, touchpad)];
   auto iter = touchpad_state.events.find(gesture->GetHash());
   if (iter != touchpad_state.events.end()) {
-    SendEvent(iter->second, event_type, target, device, values);
+    if (extra_values) {
+      SendRuntimeEvent(iter->second, event_type, event, extra_values);
+    } else {
+      SendEvent(iter->second, event_type, event);
+    }
   }
   iter = touchpad_state.any_events.find(gesture->GetHash());
   if (iter != touchpad_state.any_events.end()) {
-    SendEvent(iter->second, event_type, target, device, values);
+    if (extra_values) {
+      SendRuntimeEvent(iter->second, event_type, event, extra_values);
+    } else {
+      SendEvent(iter->second, event_type, event);
+    }
   }
 }
 
@@ -953,38 +1037,44 @@ void InputProcessor::SendTouchEvent(InputManager::DeviceType device,
                                     InputManager::TouchpadId touchpad,
                                     InputManager::TouchId id,
                                     TouchEventType event_type, Entity target,
-                                    VariantMap* values) {
-  VariantMap touch_event_values;
-  if (values == nullptr) {
-    values = &touch_event_values;
-  }
-  values->emplace(kTouchpadIdHash, touchpad);
-  values->emplace(kTouchIdHash, id);
+                                    InputEvent* event) {
+  InputEvent touch_event;
+  if (event == nullptr) {
+    event = &touch_event;
+  }
+  event->values |= InputEvent::kHasTouchpad | InputEvent::kHasTouchId;
+  event->target = target;
+  event->device = device;
+  event->touchpad = touchpad;
+  event->touch_id = id;
   auto iter = touch_events_.find(device);
   if (iter != touch_events_.end()) {
-    SendEvent(iter->second, event_type, target, device, values);
+    SendEvent(iter->second, event_type, *event);
   }
-  SendEvent(any_touch_events_, event_type, target, device, values);
+  SendEvent(any_touch_events_, event_type, *event);
 }
 
 void InputProcessor::SendButtonEvent(InputManager::DeviceType device,
                                      InputManager::ButtonId button,
                                      ButtonEventType event_type, Entity target,
-                                     VariantMap* values) {
-  VariantMap event_values;
-  if (values == nullptr) {
-    values = &event_values;
+                                     InputEvent* event) {
+  InputEvent button_event;
+  if (event == nullptr) {
+    event = &button_event;
   }
-  values->emplace(kButtonHash, button);
+  event->values |= InputEvent::kHasButton;
+  event->target = target;
+  event->device = device;
+  event->button = button;
 
   auto iter = button_events_.find(std::make_pair(device, button));
   if (iter != button_events_.end()) {
     // Send events with a specific prefix.
-    SendEvent(iter->second, event_type, target, device, values);
+    SendEvent(iter->second, event_type, *event);
   }
 
   // Send generic events.
-  SendEvent(any_button_events_, event_type, target, device, values);
+  SendEvent(any_button_events_, event_type, *event);
 
   if (legacy_mode_ != kNoLegacy && device == GetPrimaryDevice() &&
       button == InputManager::kPrimaryButton &&
@@ -999,27 +1089,82 @@ void InputProcessor::SendButtonEvent(InputManager::DeviceType device,
         dispatcher_system->Send(target, PrimaryButtonLongPress());
       }
     } else {
-      SendEvent(legacy_button_events_, event_type, target, device, values);
+      // Legacy events are concrete types, so they must be sent as runtime
+      // events to be read back as those types.
+      SendRuntimeEvent(legacy_button_events_, event_type, *event, nullptr);
     }
   }
 }
 
+template <typename Archive>
+void InputProcessor::InputEvent::Serialize(Archive archive) {
+  archive(&target, kEntityHash);
+  archive(&target, kTargetHash);
+  archive(&device, kDeviceHash);
+  if (values & kHasButton) {
+    archive(&button, kButtonHash);
+  }
+  if (values & kHasTouchpad) {
+    archive(&touchpad, kTouchpadIdHash);
+  }
+  if (values & kHasTouchId) {
+    archive(&touch_id, kTouchIdHash);
+  }
+  if (values & kHasLocation) {
+    archive(&location, kLocationHash);
+  }
+  if (values & kHasSwipeLocation) {
+    archive(&swipe_location, kLocationHash);
+  }
+  if (values & kHasTouchLocation) {
+    archive(&touch_location, kTouchLocationHash);
+  }
+  if (values & kHasPressedEntity) {
+    archive(&pressed_entity, kPressedEntityHash);
+  }
+  if (values & kHasDuration) {
+    archive(&duration, kDurationHash);
+  }
+  for (size_t i = 0; i < num_touch_ids; ++i) {
+    archive(&touch_ids[i], kTouchIdHashes[i]);
+  }
+}
+
 template <typename EventSet, typename EventType>
 void InputProcessor::SendEvent(const EventSet& event_set, EventType event_type,
-                               Entity target, InputManager::DeviceType device,
-                               const VariantMap* values) {
+                               const InputEvent& event) {
+#if LULLABY_TRACK_EVENT_NAMES
+  DispatchEvent(EventWrapper::Wrap(event_set.events[event_type], event,
+                                   event_set.names[event_type]),
+                event.target);
+#else
+  DispatchEvent(EventWrapper::Wrap(event_set.events[event_type], event),
+                event.target);
+#endif
+}
+
+template <typename EventSet, typename EventType>
+void InputProcessor::SendRuntimeEvent(const EventSet& event_set,
+                                      EventType event_type,
+                                      const InputEvent& event,
+                                      const VariantMap* values) {
 #if LULLABY_TRACK_EVENT_NAMES
-  EventWrapper event(event_set.events[event_type], event_set.names[event_type]);
+  EventWrapper wrapper(event_set.events[event_type],
+                       event_set.names[event_type]);
 #else
-  EventWrapper event(event_set.events[event_type]);
+  EventWrapper wrapper(event_set.events[event_type]);
 #endif
+  VariantMap event_values;
   if (values != nullptr) {
-    event.SetValues(*values);
+    event_values = *values;
   }
-  event.SetValue(kEntityHash, target);
-  event.SetValue(kTargetHash, target);
-  event.SetValue<InputManager::DeviceType>(kDeviceHash, device);
+  SaveToVariant serializer(&event_values);
+  Serialize(&serializer, const_cast<InputEvent*>(&event), 0);
+  wrapper.SetValues(std::move(event_values));
+  DispatchEvent(wrapper, event.target);
+}
 
+void InputProcessor::DispatchEvent(const EventWrapper& event, Entity target) {
   auto dispatcher = registry_->Get<Dispatcher>();
   dispatcher->Send(event);
 
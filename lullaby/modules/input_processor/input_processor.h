@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "lullaby/events/input_events.h"
+#include "lullaby/modules/dispatcher/event_wrapper.h"
 #include "lullaby/modules/input/input_focus.h"
 #include "lullaby/modules/input/input_manager.h"
 #include "lullaby/modules/input_processor/gesture.h"
@@ -272,10 +273,48 @@ class InputProcessor {
     GesturePtr owner = nullptr;
   };
 
+  /// The values of an event sent by the InputProcessor.  Events are wrapped as
+  /// this struct rather than built as VariantMaps so that sending them does not
+  /// allocate; the values are only converted if a listener reads them.
+  struct InputEvent {
+    /// Bits for the optional values which are set on the event.
+    enum Values {
+      kHasButton = 1 << 0,
+      kHasTouchpad = 1 << 1,
+      kHasTouchId = 1 << 2,
+      kHasLocation = 1 << 3,
+      kHasSwipeLocation = 1 << 4,
+      kHasTouchLocation = 1 << 5,
+      kHasPressedEntity = 1 << 6,
+      kHasDuration = 1 << 7,
+    };
+
+    template <typename Archive>
+    void Serialize(Archive archive);
+
+    uint32_t values = 0;
+    Entity target = kNullEntity;
+    InputManager::DeviceType device = InputManager::kMaxNumDeviceTypes;
+    InputManager::ButtonId button = 0;
+    InputManager::TouchpadId touchpad = 0;
+    InputManager::TouchId touch_id = 0;
+    // The touches of a gesture event.
+    InputManager::TouchId touch_ids[kMaxTouchesPerGesture] = {};
+    size_t num_touch_ids = 0;
+    mathfu::vec3 location = mathfu::kZeros3f;
+    // Swipe events use the same key as |location| for a 2D location.
+    mathfu::vec2 swipe_location = mathfu::kZeros2f;
+    mathfu::vec2 touch_location = mathfu::kZeros2f;
+    Entity pressed_entity = kNullEntity;
+    int64_t duration = 0;
+  };
+
   struct Touchpad {
     std::unordered_map<InputManager::TouchId, Touch> touches;
     std::vector<GesturePtr> gestures;
     GestureRecognizerList recognizers;
+    // The touches sampled for gesture recognition this frame.
+    std::vector<TouchSample> samples;
     // List of events for each recognizer.
     std::unordered_map<HashValue, GestureEvents> events;
     std::unordered_map<HashValue, GestureEvents> any_events;
@@ -312,6 +351,12 @@ class InputProcessor {
   void CancelAllGestures(const Clock::duration& delta_time,
                          InputManager::DeviceType device,
                          InputManager::TouchpadId touchpad);
+  // Calls |recognizer| with the samples at the |touches| indices, and starts
+  // the gesture it returns.
+  void TryStartGesture(InputManager::DeviceType device,
+                       InputManager::TouchpadId touchpad,
+                       const GestureRecognizerPtr& recognizer,
+                       const size_t* touches, size_t num_touches);
 
   void HandleGestureStart(InputManager::DeviceType device,
                           InputManager::TouchpadId touchpad,
@@ -365,26 +410,38 @@ class InputProcessor {
   void ResetButton(ButtonState* button_state);
   void ResetTouch(Touch* touch);
 
+  // The Send*Event functions fill in the device, target and ids of |event|
+  // (if not null), which holds any additional values set by the caller.
   void SendDeviceEvent(InputManager::DeviceType device,
-                       DeviceEventType event_type, Entity target,
-                       const VariantMap* values);
+                       DeviceEventType event_type, Entity target);
 
   void SendButtonEvent(InputManager::DeviceType device,
                        InputManager::ButtonId button,
                        ButtonEventType event_type, Entity target,
-                       VariantMap* values);
+                       InputEvent* event);
   void SendTouchEvent(InputManager::DeviceType device,
                       InputManager::TouchpadId touchpad,
                       InputManager::TouchId id, TouchEventType event_type,
-                      Entity target, VariantMap* values);
+                      Entity target, InputEvent* event);
   void SendGestureEvent(InputManager::DeviceType device,
                         InputManager::TouchpadId touchpad,
                         const GesturePtr gesture, GestureEventType event_type,
-                        Entity target, VariantMap* values);
+                        Entity target, const VariantMap& values);
 
+  /// Sends |event| with the type in |event_set| for |event_type|, without
+  /// converting it into a VariantMap.
   template <typename EventSet, typename EventType>
-  void SendEvent(const EventSet& event_set, EventType event_type, Entity target,
-                 InputManager::DeviceType device, const VariantMap* values);
+  void SendEvent(const EventSet& event_set, EventType event_type,
+                 const InputEvent& event);
+
+  /// Like SendEvent, but sends |event| as a VariantMap merged into |values|
+  /// (if not null).  Used for the legacy events, whose types are concrete
+  /// Events, and for gesture events which carry values of their own.
+  template <typename EventSet, typename EventType>
+  void SendRuntimeEvent(const EventSet& event_set, EventType event_type,
+                        const InputEvent& event, const VariantMap* values);
+
+  void DispatchEvent(const EventWrapper& event, Entity target);
 
   void SetupDeviceEvents(const string_view prefix,
                          InputProcessor::DeviceEvents* events);
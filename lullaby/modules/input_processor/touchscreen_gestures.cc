@@ -46,25 +46,12 @@ float CalculateDeltaRotation(mathfu::vec2 current_position1,
 
 }  // namespace
 
-GesturePtr OneFingerDragRecognizer::TryStart(InputManager::DeviceType device,
-                                             InputManager::TouchpadId touchpad,
-                                             Gesture::TouchIdSpan ids) {
-  // If the touch is already owned, ignore it.
-  if (input_processor_->GetTouchOwner(device, touchpad, ids[0]) != nullptr) {
-    return nullptr;
-  }
-
-  const mathfu::vec2 start_pos =
-      touchpad_size_cm_ *
-      input_manager_->GetTouchGestureOrigin(device, touchpad, ids[0]);
-  const mathfu::vec2 cur_pos =
-      touchpad_size_cm_ *
-      input_manager_->GetTouchLocation(device, touchpad, ids[0]);
-  const mathfu::vec2 delta_cm = (start_pos - cur_pos);
-
-  DCHECK(start_pos != InputManager::kInvalidTouchLocation);
-  DCHECK(cur_pos != InputManager::kInvalidTouchLocation);
-
+GesturePtr OneFingerDragRecognizer::TryStartFromSamples(
+    InputManager::DeviceType device, InputManager::TouchpadId touchpad,
+    Span<const TouchSample*> samples) {
+  // Owned touches are rejected by |rejected_touch_flags_|.
+  const mathfu::vec2 delta_cm =
+      samples[0]->origin_cm - samples[0]->location_cm;
   if (delta_cm.LengthSquared() >= kDragDeltaSquared) {
     return std::make_shared<OneFingerDrag>(callback_);
   }
@@ -95,46 +82,14 @@ Gesture::State OneFingerDragRecognizer::OneFingerDrag::AdvanceFrame(
   return state_;
 }
 
-GesturePtr TwistRecognizer::TryStart(InputManager::DeviceType device,
-                                     InputManager::TouchpadId touchpad,
-                                     Gesture::TouchIdSpan ids) {
-  // If the touch is already owned, ignore it.
-  if (input_processor_->GetTouchOwner(device, touchpad, ids[0]) != nullptr ||
-      input_processor_->GetTouchOwner(device, touchpad, ids[1]) != nullptr) {
-    return nullptr;
-  }
-
-  const mathfu::vec2 delta1 =
-      input_manager_->GetTouchDelta(device, touchpad, ids[0]);
-  const mathfu::vec2 delta2 =
-      input_manager_->GetTouchDelta(device, touchpad, ids[1]);
-  // Make sure both touches are moving.
-  if (delta1.LengthSquared() < 0.00001f || delta2.LengthSquared() < 0.00001f) {
-    return nullptr;
-  }
-
-  // all positions should be in cm before calculating rotation.
-  const mathfu::vec2 start_pos1 =
-      touchpad_size_cm_ *
-      input_manager_->GetTouchGestureOrigin(device, touchpad, ids[0]);
-  const mathfu::vec2 cur_pos1 =
-      touchpad_size_cm_ *
-      input_manager_->GetTouchLocation(device, touchpad, ids[0]);
-
-  const mathfu::vec2 start_pos2 =
-      touchpad_size_cm_ *
-      input_manager_->GetTouchGestureOrigin(device, touchpad, ids[1]);
-  const mathfu::vec2 cur_pos2 =
-      touchpad_size_cm_ *
-      input_manager_->GetTouchLocation(device, touchpad, ids[1]);
-
-  DCHECK(start_pos1 != InputManager::kInvalidTouchLocation);
-  DCHECK(start_pos2 != InputManager::kInvalidTouchLocation);
-  DCHECK(cur_pos1 != InputManager::kInvalidTouchLocation);
-  DCHECK(cur_pos2 != InputManager::kInvalidTouchLocation);
-
-  const float rotation =
-      CalculateDeltaRotation(cur_pos1, cur_pos2, start_pos1, start_pos2);
+GesturePtr TwistRecognizer::TryStartFromSamples(
+    InputManager::DeviceType device, InputManager::TouchpadId touchpad,
+    Span<const TouchSample*> samples) {
+  // Owned touches are rejected by |rejected_touch_flags_|, and touches that
+  // are not moving by |required_touch_flags_|.
+  const float rotation = CalculateDeltaRotation(
+      samples[0]->location_cm, samples[1]->location_cm, samples[0]->origin_cm,
+      samples[1]->origin_cm);
   if (std::abs(rotation) > kTwistThreshold) {
     return std::make_shared<Twist>(callback_);
   }
@@ -181,38 +136,16 @@ Gesture::State TwistRecognizer::Twist::AdvanceFrame(
   return state_;
 }
 
-GesturePtr PinchRecognizer::TryStart(InputManager::DeviceType device,
-                                     InputManager::TouchpadId touchpad,
-                                     Gesture::TouchIdSpan ids) {
-  // If the touch is already owned, ignore it.
-  if (input_processor_->GetTouchOwner(device, touchpad, ids[0]) != nullptr ||
-      input_processor_->GetTouchOwner(device, touchpad, ids[1]) != nullptr) {
-    return nullptr;
-  }
-
-  const mathfu::vec2 delta1 = touchpad_size_cm_ * input_manager_->GetTouchDelta(
-                                                      device, touchpad, ids[0]);
-  const mathfu::vec2 delta2 = touchpad_size_cm_ * input_manager_->GetTouchDelta(
-                                                      device, touchpad, ids[1]);
-
-  const mathfu::vec2 start_pos1 =
-      touchpad_size_cm_ *
-      input_manager_->GetTouchGestureOrigin(device, touchpad, ids[0]);
-  const mathfu::vec2 start_pos2 =
-      touchpad_size_cm_ *
-      input_manager_->GetTouchGestureOrigin(device, touchpad, ids[1]);
-
-  const mathfu::vec2 cur_pos1 =
-      touchpad_size_cm_ *
-      input_manager_->GetTouchLocation(device, touchpad, ids[0]);
-  const mathfu::vec2 cur_pos2 =
-      touchpad_size_cm_ *
-      input_manager_->GetTouchLocation(device, touchpad, ids[1]);
-
-  DCHECK(start_pos1 != InputManager::kInvalidTouchLocation);
-  DCHECK(start_pos2 != InputManager::kInvalidTouchLocation);
-  DCHECK(cur_pos1 != InputManager::kInvalidTouchLocation);
-  DCHECK(cur_pos2 != InputManager::kInvalidTouchLocation);
+GesturePtr PinchRecognizer::TryStartFromSamples(
+    InputManager::DeviceType device, InputManager::TouchpadId touchpad,
+    Span<const TouchSample*> samples) {
+  // Owned touches are rejected by |rejected_touch_flags_|.
+  const mathfu::vec2& delta1 = samples[0]->delta_cm;
+  const mathfu::vec2& delta2 = samples[1]->delta_cm;
+  const mathfu::vec2& start_pos1 = samples[0]->origin_cm;
+  const mathfu::vec2& start_pos2 = samples[1]->origin_cm;
+  const mathfu::vec2& cur_pos1 = samples[0]->location_cm;
+  const mathfu::vec2& cur_pos2 = samples[1]->location_cm;
 
   const mathfu::vec2 first_to_second = start_pos1 - start_pos2;
   const mathfu::vec2 first_to_second_dir = first_to_second.Normalized();
@@ -53,10 +53,12 @@ class OneFingerDragRecognizer : public GestureRecognizer {
 
   OneFingerDragRecognizer(Registry* registry, string_view event_name,
                           Callback callback)
-      : GestureRecognizer(registry, event_name, 1), callback_(callback) {}
-  GesturePtr TryStart(InputManager::DeviceType device,
-                      InputManager::TouchpadId touchpad,
-                      Gesture::TouchIdSpan ids) override;
+      : GestureRecognizer(registry, event_name, 1), callback_(callback) {
+    rejected_touch_flags_ = TouchSample::kOwned;
+  }
+  GesturePtr TryStartFromSamples(InputManager::DeviceType device,
+                                 InputManager::TouchpadId touchpad,
+                                 Span<const TouchSample*> samples) override;
 
  protected:
   Callback callback_;
@@ -81,10 +83,13 @@ class TwistRecognizer : public GestureRecognizer {
   };
 
   TwistRecognizer(Registry* registry, string_view event_name, Callback callback)
-      : GestureRecognizer(registry, event_name, 2), callback_(callback) {}
-  GesturePtr TryStart(InputManager::DeviceType device,
-                      InputManager::TouchpadId touchpad,
-                      Gesture::TouchIdSpan ids) override;
+      : GestureRecognizer(registry, event_name, 2), callback_(callback) {
+    required_touch_flags_ = TouchSample::kMoving;
+    rejected_touch_flags_ = TouchSample::kOwned;
+  }
+  GesturePtr TryStartFromSamples(InputManager::DeviceType device,
+                                 InputManager::TouchpadId touchpad,
+                                 Span<const TouchSample*> samples) override;
 
  protected:
   Callback callback_;
@@ -112,10 +117,12 @@ class PinchRecognizer : public GestureRecognizer {
   };
 
   PinchRecognizer(Registry* registry, string_view event_name, Callback callback)
-      : GestureRecognizer(registry, event_name, 2), callback_(callback) {}
-  GesturePtr TryStart(InputManager::DeviceType device,
-                      InputManager::TouchpadId touchpad,
-                      Gesture::TouchIdSpan ids) override;
+      : GestureRecognizer(registry, event_name, 2), callback_(callback) {
+    rejected_touch_flags_ = TouchSample::kOwned;
+  }
+  GesturePtr TryStartFromSamples(InputManager::DeviceType device,
+                                 InputManager::TouchpadId touchpad,
+                                 Span<const TouchSample*> samples) override;
 
  protected:
   Callback callback_;
@@ -0,0 +1,183 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/javascript/async_engine.h"
+
+#include <utility>
+
+#include "lullaby/util/make_unique.h"
+
+namespace lull {
+namespace script {
+namespace javascript {
+
+AsyncEngine::AsyncEngine() : engine_(MakeUnique<Engine>()) {
+  worker_ = std::thread(&AsyncEngine::WorkerMain, this);
+}
+
+AsyncEngine::~AsyncEngine() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  requests_cv_.notify_one();
+  worker_.join();
+}
+
+void AsyncEngine::SetLoadFileFunction(const AssetLoader::LoadFileFn& load_fn) {
+  Enqueue([this, load_fn]() { engine_->SetLoadFileFunction(load_fn); });
+}
+
+void AsyncEngine::RegisterFunction(const std::string& name, NativeFn fn) {
+  const HashValue function = Hash(name);
+  functions_[function] = std::move(fn);
+  Enqueue([this, name, function]() {
+    // Calls are queued, and made by the calling thread in AdvanceFrame.
+    engine_->RegisterVariantFunction(
+        name, [this, function](VariantArray args) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          native_calls_.emplace_back(function, std::move(args));
+        });
+  });
+}
+
+uint64_t AsyncEngine::LoadScript(const std::string& filename) {
+  const uint64_t id = next_script_id_++;
+  Enqueue([this, id, filename]() {
+    const uint64_t engine_id = engine_->LoadScript(filename);
+    if (engine_id != 0) {
+      engine_script_ids_[id] = engine_id;
+    }
+  });
+  return id;
+}
+
+uint64_t AsyncEngine::LoadScript(const std::string& code,
+                                 const std::string& debug_name) {
+  const uint64_t id = next_script_id_++;
+  Enqueue([this, id, code, debug_name]() {
+    const uint64_t engine_id = engine_->LoadScript(code, debug_name);
+    if (engine_id != 0) {
+      engine_script_ids_[id] = engine_id;
+    }
+  });
+  return id;
+}
+
+void AsyncEngine::RunScript(uint64_t id) {
+  Enqueue([this, id]() {
+    auto iter = engine_script_ids_.find(id);
+    if (iter != engine_script_ids_.end()) {
+      engine_->RunScript(iter->second);
+    }
+  });
+}
+
+void AsyncEngine::SetValue(uint64_t id, const std::string& name,
+                           const Variant& value) {
+  Enqueue([this, id, name, value]() {
+    auto iter = engine_script_ids_.find(id);
+    if (iter != engine_script_ids_.end()) {
+      engine_->SetValue(iter->second, name, value);
+    }
+  });
+}
+
+void AsyncEngine::UnloadScript(uint64_t id) {
+  Enqueue([this, id]() {
+    auto iter = engine_script_ids_.find(id);
+    if (iter != engine_script_ids_.end()) {
+      engine_->UnloadScript(iter->second);
+      engine_script_ids_.erase(iter);
+    }
+  });
+}
+
+void AsyncEngine::AdvanceFrame() {
+  CallNativeFunctions();
+  SubmitRequests();
+}
+
+void AsyncEngine::Flush() {
+  SubmitRequests();
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this]() { return !busy_ && requests_.empty(); });
+  }
+  CallNativeFunctions();
+}
+
+void AsyncEngine::Enqueue(Request request) {
+  pending_requests_.emplace_back(std::move(request));
+}
+
+void AsyncEngine::SubmitRequests() {
+  if (pending_requests_.empty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Request& request : pending_requests_) {
+      requests_.emplace_back(std::move(request));
+    }
+  }
+  pending_requests_.clear();
+  requests_cv_.notify_one();
+}
+
+void AsyncEngine::CallNativeFunctions() {
+  std::vector<NativeCall> calls;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    calls.swap(native_calls_);
+  }
+  for (const NativeCall& call : calls) {
+    auto iter = functions_.find(call.function);
+    if (iter != functions_.end()) {
+      iter->second(call.args);
+    }
+  }
+}
+
+void AsyncEngine::WorkerMain() {
+  std::vector<Request> batch;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      busy_ = false;
+      idle_cv_.notify_all();
+      requests_cv_.wait(lock,
+                        [this]() { return stop_ || !requests_.empty(); });
+      if (requests_.empty()) {
+        // Stopping, and all the submitted requests have been processed.
+        break;
+      }
+      batch.swap(requests_);
+      busy_ = true;
+    }
+    for (Request& request : batch) {
+      request();
+    }
+    batch.clear();
+  }
+  // Destroy the engine on the worker so that scripts are never touched by
+  // more than one thread.
+  engine_.reset();
+}
+
+}  // namespace javascript
+}  // namespace script
+}  // namespace lull
@@ -0,0 +1,143 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_JAVASCRIPT_ASYNC_ENGINE_H_
+#define LULLABY_MODULES_JAVASCRIPT_ASYNC_ENGINE_H_
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "lullaby/modules/javascript/engine.h"
+#include "lullaby/util/variant.h"
+
+namespace lull {
+namespace script {
+namespace javascript {
+
+// Runs Javascript scripts on a worker thread, in their own v8 isolate, so that
+// heavy scripts do not block the thread calling AdvanceFrame (usually the main
+// thread).
+//
+// The scripts and the calling thread communicate by message passing, batched
+// per frame:
+// - Requests made to the AsyncEngine (loading and running scripts, setting
+//   values, etc.) are queued, and handed to the worker together in
+//   AdvanceFrame.  The worker processes them in order.
+// - Calls made by the scripts to native functions are queued on the worker,
+//   and made together on the calling thread in the next AdvanceFrame.  Native
+//   functions therefore cannot return values to the scripts; use SetValue and
+//   RunScript to pass results back.
+//
+// All functions must be called from the same thread.
+class AsyncEngine {
+ public:
+  using NativeFn = std::function<void(const VariantArray& args)>;
+
+  AsyncEngine();
+
+  // Waits for the worker to finish the requests it has been handed, and
+  // discards any other requests.
+  ~AsyncEngine();
+
+  AsyncEngine(const AsyncEngine&) = delete;
+  AsyncEngine& operator=(const AsyncEngine&) = delete;
+
+  // Sets the file loader used to load scripts and by the include function.
+  // |load_fn| is called on the worker thread.
+  void SetLoadFileFunction(const AssetLoader::LoadFileFn& load_fn);
+
+  // Register a native function.  This function will be available to all
+  // subsequently loaded scripts.  Its arguments are converted to Variants, and
+  // it is called on the calling thread during AdvanceFrame.
+  void RegisterFunction(const std::string& name, NativeFn fn);
+
+  // Load a script from a file.  Returns an id for the script immediately; if
+  // the script fails to load, requests using the id are ignored.
+  uint64_t LoadScript(const std::string& filename);
+
+  // Load a script from inline code.  The debug_name is used when reporting
+  // error messages.
+  uint64_t LoadScript(const std::string& code, const std::string& debug_name);
+
+  // Run a loaded script.
+  void RunScript(uint64_t id);
+
+  // Set a value in the script's environment.
+  void SetValue(uint64_t id, const std::string& name, const Variant& value);
+
+  // Unloads a script.
+  void UnloadScript(uint64_t id);
+
+  // Makes the native function calls the scripts have made since the last
+  // frame, then hands the requests made since the last frame to the worker.
+  void AdvanceFrame();
+
+  // As AdvanceFrame, but waits for the worker to process all the requests and
+  // then makes the native function calls they resulted in.
+  void Flush();
+
+ private:
+  using Request = std::function<void()>;
+
+  struct NativeCall {
+    NativeCall(HashValue function, VariantArray args)
+        : function(function), args(std::move(args)) {}
+    HashValue function;
+    VariantArray args;
+  };
+
+  void Enqueue(Request request);
+  void SubmitRequests();
+  void CallNativeFunctions();
+  void WorkerMain();
+
+  // The engine running the scripts.  Only accessed by the worker thread once
+  // it has started.
+  std::unique_ptr<Engine> engine_;
+  // Maps the ids returned by LoadScript to the engine's script ids.  Only
+  // accessed by the worker thread.
+  std::unordered_map<uint64_t, uint64_t> engine_script_ids_;
+
+  // Calling thread state.
+  std::unordered_map<HashValue, NativeFn> functions_;
+  std::vector<Request> pending_requests_;
+  uint64_t next_script_id_ = 1;
+
+  // State shared by the calling and worker threads, guarded by |mutex_|.
+  std::mutex mutex_;
+  std::condition_variable requests_cv_;
+  std::condition_variable idle_cv_;
+  std::vector<Request> requests_;
+  std::vector<NativeCall> native_calls_;
+  bool busy_ = false;
+  bool stop_ = false;
+
+  std::thread worker_;
+};
+
+}  // namespace javascript
+}  // namespace script
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::script::javascript::AsyncEngine);
+
+#endif  // LULLABY_MODULES_JAVASCRIPT_ASYNC_ENGINE_H_
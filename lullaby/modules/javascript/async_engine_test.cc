@@ -0,0 +1,97 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/javascript/async_engine.h"
+
+#include "ion/base/logchecker.h"
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace script {
+namespace javascript {
+
+class AsyncJsEngineTest : public testing::Test {
+ public:
+  AsyncEngine js_;
+  ion::base::LogChecker log_checker_;
+};
+
+TEST_F(AsyncJsEngineTest, RunScript) {
+  std::vector<VariantArray> calls;
+  js_.RegisterFunction("Report", [&](const VariantArray& args) {
+    calls.push_back(args);
+  });
+  const uint64_t id = js_.LoadScript("Report((3 + x) * 2, 'done')", "Run");
+  js_.SetValue(id, "x", Variant(10));
+  js_.RunScript(id);
+  EXPECT_TRUE(calls.empty());
+
+  js_.Flush();
+  ASSERT_EQ(calls.size(), size_t(1));
+  ASSERT_EQ(calls[0].size(), size_t(2));
+  EXPECT_EQ(calls[0][0].ValueOr(0), 26);
+  EXPECT_EQ(calls[0][1].ValueOr(std::string()), "done");
+  EXPECT_FALSE(log_checker_.HasAnyMessages());
+}
+
+TEST_F(AsyncJsEngineTest, BatchesNativeCalls) {
+  std::vector<int> values;
+  js_.RegisterFunction("Report", [&](const VariantArray& args) {
+    values.push_back(args[0].ValueOr(-1));
+  });
+  const uint64_t id =
+      js_.LoadScript("for (i = 0; i < 3; ++i) { Report(i); }", "Batch");
+  js_.RunScript(id);
+  js_.RunScript(id);
+
+  // Nothing is sent to the worker until AdvanceFrame.
+  js_.AdvanceFrame();
+  js_.Flush();
+  EXPECT_EQ(values, std::vector<int>({0, 1, 2, 0, 1, 2}));
+}
+
+TEST_F(AsyncJsEngineTest, ConvertsObjects) {
+  VariantArray args;
+  js_.RegisterFunction("Report", [&](const VariantArray& a) { args = a; });
+  const uint64_t id =
+      js_.LoadScript("Report({a: 1.5, b: [true, 'x']})", "Objects");
+  js_.RunScript(id);
+  js_.Flush();
+
+  ASSERT_EQ(args.size(), size_t(1));
+  const VariantMap* map = args[0].Get<VariantMap>();
+  ASSERT_NE(map, nullptr);
+  EXPECT_EQ(map->at(Hash("a")).ValueOr(0.0), 1.5);
+  const VariantArray* array = map->at(Hash("b")).Get<VariantArray>();
+  ASSERT_NE(array, nullptr);
+  ASSERT_EQ(array->size(), size_t(2));
+  EXPECT_EQ((*array)[0].ValueOr(false), true);
+  EXPECT_EQ((*array)[1].ValueOr(std::string()), "x");
+}
+
+TEST_F(AsyncJsEngineTest, UnloadedScriptsAreIgnored) {
+  int calls = 0;
+  js_.RegisterFunction("Report", [&](const VariantArray&) { ++calls; });
+  const uint64_t id = js_.LoadScript("Report()", "Unload");
+  js_.UnloadScript(id);
+  js_.RunScript(id);
+  js_.Flush();
+  EXPECT_EQ(calls, 0);
+}
+
+}  // namespace javascript
+}  // namespace script
+}  // namespace lull
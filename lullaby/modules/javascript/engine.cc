@@ -147,6 +147,48 @@ struct ConverterImpl<EmptyList> {
 
 struct Converter : ConverterImpl<ScriptableTypes> {};
 
+// Converts |js_value| to a Variant of the type closest to the Javascript type,
+// since there is no C++ type to convert it to.  Objects are converted to
+// VariantMaps keyed by the hashes of their property names.
+void JsToVariant(v8::Isolate *isolate, const v8::Local<v8::Value> &js_value,
+                 Variant *value) {
+  if (js_value->IsBoolean()) {
+    bool boolean = false;
+    Convert<bool>::JsToCpp(isolate, js_value, &boolean);
+    *value = boolean;
+  } else if (js_value->IsInt32()) {
+    int32_t number = 0;
+    Convert<int32_t>::JsToCpp(isolate, js_value, &number);
+    *value = number;
+  } else if (js_value->IsNumber()) {
+    double number = 0.0;
+    Convert<double>::JsToCpp(isolate, js_value, &number);
+    *value = number;
+  } else if (js_value->IsString()) {
+    v8::String::Utf8Value str(isolate, js_value);
+    *value = std::string(*str);
+  } else if (js_value->IsArray()) {
+    v8::Local<v8::Array> js_array = v8::Local<v8::Array>::Cast(js_value);
+    VariantArray array(js_array->Length());
+    for (uint32_t i = 0; i < js_array->Length(); ++i) {
+      JsToVariant(isolate, js_array->Get(i), &array[i]);
+    }
+    *value = std::move(array);
+  } else if (js_value->IsObject()) {
+    v8::Local<v8::Object> js_obj = v8::Local<v8::Object>::Cast(js_value);
+    v8::Local<v8::Array> keys = js_obj->GetPropertyNames();
+    VariantMap map;
+    for (uint32_t i = 0; i < keys->Length(); ++i) {
+      v8::Local<v8::Value> key = keys->Get(i);
+      v8::String::Utf8Value key_str(isolate, key);
+      JsToVariant(isolate, js_obj->Get(key), &map[Hash(*key_str)]);
+    }
+    *value = std::move(map);
+  } else {
+    value->Clear();
+  }
+}
+
 }  // namespace
 
 Engine::Engine() {
@@ -445,6 +487,17 @@ void Engine::RegisterFunction(const std::string &name, ScriptableFn fn) {
       });
 }
 
+void Engine::RegisterVariantFunction(const std::string &name, VariantFn fn) {
+  RegisterFunctionImpl(
+      name, [fn](const v8::FunctionCallbackInfo<v8::Value> &args) {
+        VariantArray values(static_cast<size_t>(args.Length()));
+        for (int i = 0; i < args.Length(); ++i) {
+          JsToVariant(args.GetIsolate(), args[i], &values[i]);
+        }
+        fn(std::move(values));
+      });
+}
+
 void Engine::RegisterFunctionImpl(const std::string &name, JsLambda &&fn) {
   functions_.emplace(
       Hash(name.c_str()),
@@ -67,6 +67,12 @@ class Engine : public IScriptEngine {
   template <typename Fn>
   void RegisterFunction(const std::string& name, const Fn& fn);
 
+  // Register a function which receives all of its arguments converted to
+  // Variants, however many there are.  The function returns undefined to the
+  // script.
+  using VariantFn = std::function<void(VariantArray args)>;
+  void RegisterVariantFunction(const std::string& name, VariantFn fn);
+
   // Unregister a function. This also removes it from all loaded scripts such
   // that calling it will throw an exception.
   void UnregisterFunction(const std::string& name) override;
@@ -33,6 +33,7 @@ limitations under the License.
 #include "lullaby/util/logging.h"
 #include "lullaby/util/math.h"
 #include "lullaby/util/optional.h"
+#include "lullaby/util/span.h"
 #include "lullaby/util/type_util.h"
 #include "lullaby/util/typeid.h"
 #include "mathfu/glsl_mappings.h"
@@ -524,6 +525,167 @@ struct Convert<std::vector<T>, false, false, false> {
   }
 };
 
+namespace detail {
+
+// A SpanView is a userdata that gives scripts direct access to the elements of
+// a native array, without copying them into a table.  Elements are converted
+// only when they are read or written, using the metamethods of a metatable
+// that is shared by all the views of the same element type.  Scripts must not
+// keep views beyond the call that passed them into Lua, since the native array
+// may not outlive it.
+template <typename T>
+struct SpanView {
+  T* data;
+  size_t size;
+  bool writable;
+
+  static const char* GetMetatableName() {
+    static std::string name = std::string("lull_span_") + GetTypeName<T>();
+    return name.c_str();
+  }
+
+  static void Push(lua_State* lua, T* data, size_t size, bool writable) {
+    LUA_UTIL_EXPECT_STACK(lua, 1);
+    lua_checkstack(lua, 3);
+    auto* view = static_cast<SpanView*>(lua_newuserdata(lua, sizeof(SpanView)));
+    view->data = data;
+    view->size = size;
+    view->writable = writable;
+    if (luaL_newmetatable(lua, GetMetatableName())) {
+      lua_pushcfunction(lua, Index);
+      lua_setfield(lua, -2, "__index");
+      lua_pushcfunction(lua, NewIndex);
+      lua_setfield(lua, -2, "__newindex");
+      lua_pushcfunction(lua, Length);
+      lua_setfield(lua, -2, "__len");
+      lua_pushcfunction(lua, IPairs);
+      lua_setfield(lua, -2, "__ipairs");
+    }
+    lua_setmetatable(lua, -2);
+  }
+
+  // Returns the view at |index| on the stack, or nullptr if it isn't a view of
+  // T elements.
+  static SpanView* Get(lua_State* lua, int index) {
+    return static_cast<SpanView*>(
+        luaL_testudata(lua, index, GetMetatableName()));
+  }
+
+  static SpanView* Check(lua_State* lua) {
+    return static_cast<SpanView*>(luaL_checkudata(lua, 1, GetMetatableName()));
+  }
+
+  static int Index(lua_State* lua) {
+    const SpanView* view = Check(lua);
+    const lua_Integer index = luaL_checkinteger(lua, 2);
+    if (index < 1 || static_cast<size_t>(index) > view->size) {
+      lua_pushnil(lua);
+    } else {
+      Convert<T>::PushFromCppToLua(ConvertContext(lua), view->data[index - 1]);
+    }
+    return 1;
+  }
+
+  static int NewIndex(lua_State* lua) {
+    const SpanView* view = Check(lua);
+    const lua_Integer index = luaL_checkinteger(lua, 2);
+    if (!view->writable) {
+      return luaL_error(lua, "span is read-only");
+    }
+    if (index < 1 || static_cast<size_t>(index) > view->size) {
+      return luaL_error(lua, "span index %d is out of range",
+                        static_cast<int>(index));
+    }
+    T value;
+    if (!Convert<T>::PopFromLuaToCpp(ConvertContext(lua), &value)) {
+      return luaL_error(lua, "span expects elements to be %s",
+                        Convert<T>::GetLuaTypeName());
+    }
+    view->data[index - 1] = value;
+    return 0;
+  }
+
+  static int Length(lua_State* lua) {
+    const SpanView* view = Check(lua);
+    lua_pushinteger(lua, static_cast<lua_Integer>(view->size));
+    return 1;
+  }
+
+  static int IPairs(lua_State* lua) {
+    Check(lua);
+    lua_pushcfunction(lua, Next);
+    lua_pushvalue(lua, 1);
+    lua_pushinteger(lua, 0);
+    return 3;
+  }
+
+  static int Next(lua_State* lua) {
+    const SpanView* view = Check(lua);
+    const lua_Integer index = luaL_checkinteger(lua, 2) + 1;
+    if (index < 1 || static_cast<size_t>(index) > view->size) {
+      return 0;
+    }
+    lua_pushinteger(lua, index);
+    Convert<T>::PushFromCppToLua(ConvertContext(lua), view->data[index - 1]);
+    return 2;
+  }
+};
+
+}  // namespace detail
+
+template <typename T>
+struct Convert<Span<T>, false, false, false> {
+  static const char* GetLuaTypeName() {
+    static std::string type =
+        std::string("span of ") + Convert<T>::GetLuaTypeName();
+    return type.c_str();
+  }
+
+  static inline bool PopFromLuaToCpp(const ConvertContext& context,
+                                     Span<T>* value) {
+    LUA_UTIL_EXPECT_STACK(context.lua, -1);
+    Popper popper(context.lua);
+    const auto* view = detail::SpanView<T>::Get(context.lua, -1);
+    if (!view) {
+      return false;
+    }
+    *value = Span<T>(view->data, view->size);
+    return true;
+  }
+
+  static inline void PushFromCppToLua(const ConvertContext& context,
+                                      const Span<T>& value) {
+    detail::SpanView<T>::Push(context.lua, const_cast<T*>(value.data()),
+                              value.size(), false);
+  }
+};
+
+template <typename T>
+struct Convert<MutableSpan<T>, false, false, false> {
+  static const char* GetLuaTypeName() {
+    static std::string type =
+        std::string("writable span of ") + Convert<T>::GetLuaTypeName();
+    return type.c_str();
+  }
+
+  static inline bool PopFromLuaToCpp(const ConvertContext& context,
+                                     MutableSpan<T>* value) {
+    LUA_UTIL_EXPECT_STACK(context.lua, -1);
+    Popper popper(context.lua);
+    const auto* view = detail::SpanView<T>::Get(context.lua, -1);
+    if (!view || !view->writable) {
+      return false;
+    }
+    *value = MutableSpan<T>(view->data, view->size);
+    return true;
+  }
+
+  static inline void PushFromCppToLua(const ConvertContext& context,
+                                      const MutableSpan<T>& value) {
+    detail::SpanView<T>::Push(context.lua, value.data(), value.size(), true);
+  }
+};
+
 template <typename M>
 struct Convert<M, false, false, true> {
   using K = typename M::key_type;
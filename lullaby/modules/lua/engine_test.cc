@@ -837,6 +837,60 @@ TEST_F(LuaEngineTest, GetValueError) {
   EXPECT_FALSE(log_checker_->HasAnyMessages());
 }
 
+TEST_F(LuaEngineTest, Spans) {
+  std::vector<float> floats = {1.f, 2.f, 3.f};
+  std::vector<Entity> entities = {Entity(4), Entity(5)};
+  lua_.RegisterFunction("GetFloats",
+                        [&floats]() { return MutableSpan<float>(floats); });
+  lua_.RegisterFunction("GetEntities",
+                        [&entities]() { return Span<Entity>(entities); });
+  lua_.RegisterFunction("SumFloats", [](Span<float> values) {
+    float sum = 0.f;
+    for (float value : values) {
+      sum += value;
+    }
+    return sum;
+  });
+  uint64_t id = lua_.LoadScript(
+      R"(
+        floats = GetFloats()
+        for i, value in ipairs(floats) do
+          floats[i] = value * 2
+        end
+        num_floats = #floats
+        sum = SumFloats(floats)
+        entities = GetEntities()
+        second_entity = entities[2]
+        missing_entity = entities[3]
+      )",
+      "SpansScript");
+  lua_.RunScript(id);
+  EXPECT_EQ(floats, std::vector<float>({2.f, 4.f, 6.f}));
+  int num_floats = 0;
+  EXPECT_TRUE(lua_.GetValue(id, "num_floats", &num_floats));
+  EXPECT_EQ(3, num_floats);
+  float sum = 0.f;
+  EXPECT_TRUE(lua_.GetValue(id, "sum", &sum));
+  EXPECT_EQ(12.f, sum);
+  Entity second_entity = kNullEntity;
+  EXPECT_TRUE(lua_.GetValue(id, "second_entity", &second_entity));
+  EXPECT_EQ(Entity(5), second_entity);
+  Optional<Entity> missing_entity;
+  EXPECT_TRUE(lua_.GetValue(id, "missing_entity", &missing_entity));
+  EXPECT_FALSE(missing_entity);
+  EXPECT_FALSE(log_checker_->HasAnyMessages());
+}
+
+TEST_F(LuaEngineTest, ReadOnlySpanError) {
+  std::vector<float> floats = {1.f, 2.f, 3.f};
+  lua_.RegisterFunction("GetFloats",
+                        [&floats]() { return Span<float>(floats); });
+  uint64_t id = lua_.LoadScript("GetFloats()[1] = 5", "ReadOnlySpanScript");
+  lua_.RunScript(id);
+  EXPECT_EQ(1.f, floats[0]);
+  EXPECT_TRUE(log_checker_->HasMessage("ERROR", "span is read-only"));
+}
+
 TEST_F(LuaEngineTest, SyntaxError) {
   lua_.LoadScript("syntax error", "SyntaxErrorScript");
   EXPECT_TRUE(log_checker_->HasMessage("ERROR",
@@ -19,6 +19,16 @@ limitations under the License.
 #include "absl/memory/memory.h"
 
 namespace lull {
+namespace {
+
+// Scripts may be either source code or byte code generated by the
+// lull_script_compiler, in which case no parsing is needed to load them.
+Span<uint8_t> ToByteSpan(const std::string& code) {
+  return Span<uint8_t>(reinterpret_cast<const uint8_t*>(code.data()),
+                       code.size());
+}
+
+}  // namespace
 
 uint64_t LullScriptEngine::LoadScript(const std::string& code,
                                       const std::string& debug_name) {
@@ -26,21 +36,24 @@ uint64_t LullScriptEngine::LoadScript(const std::string& code,
   CHECK_NE(id, 0) << "Overflow on script id generation.";
   Script& script = scripts_.emplace(id, Script(base_env_)).first->second;
   script.debug_name = debug_name;
-  script.script = script.env.Read(code);
+  script.script = script.env.LoadOrRead(ToByteSpan(code));
+  script.program = ScriptProgram(&script.env, script.script);
   return id;
 }
 
 void LullScriptEngine::ReloadScript(uint64_t id, const std::string& code) {
   auto iter = scripts_.find(id);
   if (iter != scripts_.end()) {
-    iter->second.script = iter->second.env.Read(code);
+    Script& script = iter->second;
+    script.script = script.env.LoadOrRead(ToByteSpan(code));
+    script.program = ScriptProgram(&script.env, script.script);
   }
 }
 
 void LullScriptEngine::RunScript(uint64_t id) {
   auto iter = scripts_.find(id);
   if (iter != scripts_.end()) {
-    iter->second.env.Eval(iter->second.script);
+    iter->second.program.Run();
   }
 }
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include "lullaby/modules/function/function_call.h"
 #include "lullaby/modules/function/variant_converter.h"
 #include "lullaby/modules/lullscript/script_env.h"
+#include "lullaby/modules/lullscript/script_program.h"
 #include "lullaby/modules/script/script_engine.h"
 
 namespace lull {
@@ -82,6 +83,7 @@ class LullScriptEngine : public IScriptEngine {
 
     ScriptEnv env;
     ScriptValue script;
+    ScriptProgram program;
     std::string debug_name;
   };
 
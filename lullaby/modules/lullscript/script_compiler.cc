@@ -15,6 +15,9 @@ limitations under the License.
 */
 
 #include "lullaby/modules/lullscript/script_compiler.h"
+
+#include <cstring>
+
 #include "lullaby/modules/lullscript/script_env.h"
 #include "lullaby/modules/lullscript/script_types.h"
 
@@ -22,8 +25,68 @@ namespace lull {
 
 static const uint8_t kByteCodeMarker = 0;
 
+constexpr uint32_t ScriptCompiler::kVersion;
+
+namespace {
+
+void WriteString(SaveToBuffer* writer, string_view str) {
+  const uint32_t size = static_cast<uint32_t>(str.size());
+  (*writer)(&size, 0);
+  writer->Save(str.data(), size);
+}
+
+// Reads fixed-size values directly out of a span of byte code.  Any attempt to
+// read past the end of the byte code puts the reader into an error state.
+class ByteCodeReader {
+ public:
+  explicit ByteCodeReader(Span<uint8_t> code) : code_(code) {}
+
+  template <typename T>
+  T Read() {
+    T value = T();
+    const uint8_t* ptr = Advance(sizeof(T));
+    if (ptr) {
+      memcpy(&value, ptr, sizeof(T));
+    }
+    return value;
+  }
+
+  string_view ReadString() {
+    const uint32_t size = Read<uint32_t>();
+    const uint8_t* ptr = Advance(size);
+    return ptr ? string_view(reinterpret_cast<const char*>(ptr), size)
+               : string_view();
+  }
+
+  bool HasError() const { return error_; }
+
+ private:
+  const uint8_t* Advance(size_t size) {
+    if (error_ || size > code_.size() - offset_) {
+      error_ = true;
+      return nullptr;
+    }
+    const uint8_t* ptr = code_.data() + offset_;
+    offset_ += size;
+    return ptr;
+  }
+
+  Span<uint8_t> code_;
+  size_t offset_ = 0;
+  bool error_ = false;
+};
+
+template <typename Value>
+void DoProcess(ParserCallbacks::TokenType type, ParserCallbacks* builder,
+               ByteCodeReader* reader) {
+  const Value value = reader->Read<Value>();
+  builder->Process(type, &value, "");
+}
+
+}  // namespace
+
 ScriptCompiler::ScriptCompiler(ScriptByteCode* code)
-    : code_(code), writer_(code) {}
+    : code_(code), writer_(&tokens_) {}
 
 void ScriptCompiler::Process(TokenType type, const void* ptr,
                              string_view token) {
@@ -31,11 +94,7 @@ void ScriptCompiler::Process(TokenType type, const void* ptr,
     return;
   }
 
-  if (code_->empty()) {
-    writer_(&kByteCodeMarker, 0);
-  }
-
-  int code = type;
+  const uint8_t code = static_cast<uint8_t>(type);
   writer_(&code, 0);
 
   switch (type) {
@@ -77,13 +136,20 @@ void ScriptCompiler::Process(TokenType type, const void* ptr,
       break;
     case kSymbol: {
       const Symbol* symbol = reinterpret_cast<const Symbol*>(ptr);
-      writer_(&symbol->name, 0);
+      const uint32_t next_index = static_cast<uint32_t>(symbols_.size());
+      auto iter = symbol_indices_.emplace(symbol->value, next_index).first;
+      if (iter->second == next_index) {
+        symbols_.emplace_back(symbol->name);
+      }
+      writer_(&iter->second, 0);
     } break;
     case kString:
-      writer_(reinterpret_cast<const string_view*>(ptr), 0);
+      WriteString(&writer_, *reinterpret_cast<const string_view*>(ptr));
       break;
-    case kNull:
     case kEof:
+      Finish();
+      break;
+    case kNull:
     case kPush:
     case kPop:
     case kPushArray:
@@ -94,88 +160,96 @@ void ScriptCompiler::Process(TokenType type, const void* ptr,
   }
 }
 
-template <typename Value>
-static void DoProcess(ParserCallbacks::TokenType type, ParserCallbacks* builder,
-                      LoadFromBuffer* reader, Value value) {
-  (*reader)(&value, 0);
-  builder->Process(type, &value, "");
-}
+void ScriptCompiler::Finish() {
+  SaveToBuffer writer(code_);
+  writer(&kByteCodeMarker, 0);
+  writer(&kVersion, 0);
 
-static void DoProcess(ParserCallbacks::TokenType type, ParserCallbacks* builder,
-                      LoadFromBuffer* reader, Symbol value) {
-  (*reader)(&value.name, 0);
-  value.value = Hash(value.name);
-  builder->Process(type, &value, "");
+  const uint32_t num_symbols = static_cast<uint32_t>(symbols_.size());
+  writer(&num_symbols, 0);
+  for (const std::string& name : symbols_) {
+    WriteString(&writer, name);
+  }
+  writer.Save(tokens_.data(), tokens_.size());
 }
 
 void ScriptCompiler::Build(ParserCallbacks* builder) {
-  LoadFromBuffer reader(code_);
+  Build(*code_, builder);
+}
 
-  if (code_->empty()) {
+bool ScriptCompiler::Build(Span<uint8_t> code, ParserCallbacks* builder) {
+  if (code.empty()) {
     LOG(ERROR) << "Bytecode is empty.";
-    return;
+    return false;
   }
 
-  uint8_t marker = kByteCodeMarker;
-  reader(&marker, 0);
-  if (marker != kByteCodeMarker) {
+  ByteCodeReader reader(code);
+  if (reader.Read<uint8_t>() != kByteCodeMarker) {
     LOG(ERROR) << "Missing marker at start of bytecode.";
-    return;
+    return false;
+  }
+  const uint32_t version = reader.Read<uint32_t>();
+  if (version != kVersion) {
+    LOG(ERROR) << "Unsupported bytecode version " << version << ", expected "
+               << kVersion << ". Recompile the script.";
+    return false;
   }
 
-  bool done = false;
-  while (!done) {
-    int code = 0;
-    reader(&code, 0);
+  std::vector<Symbol> symbols(reader.Read<uint32_t>());
+  for (Symbol& symbol : symbols) {
+    symbol = Symbol(reader.ReadString());
+  }
 
-    const TokenType type = static_cast<TokenType>(code);
+  bool done = false;
+  while (!done && !reader.HasError()) {
+    const TokenType type = static_cast<TokenType>(reader.Read<uint8_t>());
     switch (type) {
       case kBool: {
-        DoProcess(type, builder, &reader, false);
+        DoProcess<bool>(type, builder, &reader);
         break;
       }
       case kInt8: {
-        DoProcess(type, builder, &reader, int8_t(0));
+        DoProcess<int8_t>(type, builder, &reader);
         break;
       }
       case kUint8: {
-        DoProcess(type, builder, &reader, uint8_t(0));
+        DoProcess<uint8_t>(type, builder, &reader);
         break;
       }
       case kInt16: {
-        DoProcess(type, builder, &reader, int16_t(0));
+        DoProcess<int16_t>(type, builder, &reader);
         break;
       }
       case kUint16: {
-        DoProcess(type, builder, &reader, uint16_t(0));
+        DoProcess<uint16_t>(type, builder, &reader);
         break;
       }
       case kInt32: {
-        DoProcess(type, builder, &reader, int32_t(0));
+        DoProcess<int32_t>(type, builder, &reader);
         break;
       }
       case kUint32: {
-        DoProcess(type, builder, &reader, uint32_t(0));
+        DoProcess<uint32_t>(type, builder, &reader);
         break;
       }
       case kInt64: {
-        DoProcess(type, builder, &reader, int64_t(0));
+        DoProcess<int64_t>(type, builder, &reader);
         break;
       }
       case kUint64: {
-        DoProcess(type, builder, &reader, uint64_t(0));
+        DoProcess<uint64_t>(type, builder, &reader);
         break;
       }
       case kFloat: {
-        DoProcess(type, builder, &reader, 0.f);
+        DoProcess<float>(type, builder, &reader);
         break;
       }
       case kDouble: {
-        DoProcess(type, builder, &reader, 0.0);
+        DoProcess<double>(type, builder, &reader);
         break;
       }
       case kHashValue: {
-        DoProcess<HashValue>(type, builder, &reader, 0);
+        DoProcess<HashValue>(type, builder, &reader);
         break;
       }
       case kNull: {
@@ -183,11 +257,17 @@ void ScriptCompiler::Build(ParserCallbacks* builder) {
         break;
       }
       case kSymbol: {
-        DoProcess(type, builder, &reader, Symbol());
+        const uint32_t index = reader.Read<uint32_t>();
+        if (index >= symbols.size()) {
+          LOG(ERROR) << "Invalid symbol index in bytecode: " << index;
+          return false;
+        }
+        builder->Process(type, &symbols[index], "");
         break;
       }
       case kString: {
-        DoProcess(type, builder, &reader, string_view());
+        const string_view str = reader.ReadString();
+        builder->Process(type, &str, "");
         break;
       }
       case kPush: {
@@ -219,13 +299,24 @@ void ScriptCompiler::Build(ParserCallbacks* builder) {
         done = true;
         break;
       }
+      default: {
+        LOG(ERROR) << "Invalid token in bytecode: " << static_cast<int>(type);
+        return false;
+      }
     }
   }
+
+  if (reader.HasError()) {
+    LOG(ERROR) << "Bytecode is truncated.";
+    return false;
+  }
+  return true;
 }
 
 void ScriptCompiler::Error(string_view token, string_view message) {
   LOG(WARNING) << "Error parsing " << token << ": " << message;
   code_->clear();
+  tokens_.clear();
   error_ = true;
 }
 
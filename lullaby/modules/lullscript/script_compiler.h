@@ -17,6 +17,8 @@ limitations under the License.
 #ifndef LULLABY_MODULES_LULLSCRIPT_SCRIPT_COMPILER_H_
 #define LULLABY_MODULES_LULLSCRIPT_SCRIPT_COMPILER_H_
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include "lullaby/modules/serialize/buffer_serializer.h"
 #include "lullaby/modules/lullscript/script_parser.h"
@@ -35,8 +37,24 @@ class ScriptEnv;
 // The byte array can then be converted (again using the ScriptCompiler) to
 // the appropriate runtime structure by calling ScriptCompiler::Build and
 // passing it another set of ParserCallbacks.
+//
+// The byte code only uses fixed-size fields and offsets relative to its own
+// start, so it can be built directly from memory-mapped data. It consists of:
+//   - a marker byte (0) that distinguishes byte code from source text.
+//   - the uint32 format version, kVersion.
+//   - the symbol table: a uint32 count followed by the name of each unique
+//     symbol in the script.  Each symbol is hashed once when the byte code is
+//     built, rather than once per use.
+//   - the token stream: a uint8 TokenType per token followed by its value.
+//     Symbols are stored as uint32 indices into the symbol table.
+// Strings (including symbol names) are stored as a uint32 length followed by
+// the characters.
 class ScriptCompiler : public ParserCallbacks {
  public:
+  // The version of the byte code format.  Byte code with a different version
+  // must be regenerated from source.
+  static constexpr uint32_t kVersion = 1;
+
   explicit ScriptCompiler(ScriptByteCode* code);
 
   // Stores the |type| and associated data into the byte array buffer.
@@ -46,6 +64,10 @@ class ScriptCompiler : public ParserCallbacks {
   // ParserCallbacks.
   void Build(ParserCallbacks* builder);
 
+  // Processes the byte code in |code| into a sequence of ParserCallbacks.
+  // Returns false if |code| is not valid byte code.
+  static bool Build(Span<uint8_t> code, ParserCallbacks* builder);
+
   // Sets the internal state to an error state.
   void Error(string_view token, string_view message) override;
 
@@ -53,8 +75,16 @@ class ScriptCompiler : public ParserCallbacks {
   static bool IsByteCode(Span<uint8_t> bytes);
 
  private:
+  // Writes the header, symbol table and token stream into |code_|.
+  void Finish();
+
   ScriptByteCode* code_;
+  // The token stream, which is written into |code_| after the symbol table
+  // once the entire script has been processed.
+  ScriptByteCode tokens_;
   SaveToBuffer writer_;
+  std::unordered_map<HashValue, uint32_t> symbol_indices_;
+  std::vector<std::string> symbols_;
   bool error_ = false;
 };
 
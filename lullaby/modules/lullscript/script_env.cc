@@ -23,6 +23,63 @@ limitations under the License.
 
 namespace lull {
 
+namespace {
+
+// Context passed to ScriptableFns registered with the ScriptEnv.  Arguments are
+// evaluated directly into ScriptValues and converted from the Variants they
+// already hold, and return values are stored directly in the frame, so calls
+// do not copy their arguments into an intermediate FunctionCall.
+class ScriptableFnContext {
+ public:
+  static constexpr size_t kMaxArgs = 16;
+
+  explicit ScriptableFnContext(ScriptFrame* frame) : frame_(frame) {
+    while (frame->HasNext()) {
+      if (num_args_ < kMaxArgs) {
+        args_[num_args_] = frame->EvalNext();
+        ++num_args_;
+      } else {
+        frame->Error("Too many args");
+        break;
+      }
+    }
+  }
+
+  template <typename T>
+  bool ArgToCpp(const char* name, size_t arg_index, T* value) {
+    static const Variant kNil;
+    const Variant* var = args_[arg_index].GetVariant();
+    if (!VariantConverter::FromVariant(var ? *var : kNil, value)) {
+      LOG(DFATAL) << name << " expects the type of arg " << arg_index + 1
+                  << " to be " << TypeNameGenerator::Generate<T>();
+      return false;
+    }
+    return true;
+  }
+
+  template <typename T>
+  bool ReturnFromCpp(const char* name, const T& value) {
+    frame_->Return(value);
+    return true;
+  }
+
+  bool CheckNumArgs(const char* name, size_t expected_args) const {
+    if (num_args_ != expected_args) {
+      LOG(DFATAL) << name << " expects " << expected_args << " args, but got "
+                  << num_args_;
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  ScriptFrame* frame_;
+  size_t num_args_ = 0;
+  ScriptValue args_[kMaxArgs];
+};
+
+}  // namespace
+
 static ScriptFunctionEntry* g_fn = nullptr;
 ScriptFunctionEntry::ScriptFunctionEntry(ScriptFunction fn, string_view name)
     : fn(fn), name(name) {
@@ -90,17 +147,17 @@ ScriptEnv::ScriptEnv() {
     frame->Return(str);
   };
 
-  Register("=", NativeFunction{set_fn});
-  Register("do", NativeFunction{do_fn});
-  Register("def", NativeFunction{def_fn});
-  Register("var", NativeFunction{let_fn});
-  Register("eval", NativeFunction{eval_fn});
-  Register("macro", NativeFunction{mac_fn});
-  Register("lambda", NativeFunction{lambda_fn});
-  Register("return", NativeFunction{ret_fn});
-  Register("?", NativeFunction{print_fn});
+  RegisterBuiltin("=", NativeFunction{set_fn});
+  RegisterBuiltin("do", NativeFunction{do_fn});
+  RegisterBuiltin("def", NativeFunction{def_fn});
+  RegisterBuiltin("var", NativeFunction{let_fn});
+  RegisterBuiltin("eval", NativeFunction{eval_fn});
+  RegisterBuiltin("macro", NativeFunction{mac_fn});
+  RegisterBuiltin("lambda", NativeFunction{lambda_fn});
+  RegisterBuiltin("return", NativeFunction{ret_fn});
+  RegisterBuiltin("?", NativeFunction{print_fn});
   for (auto* fn = g_fn; fn != nullptr; fn = fn->next) {
-    Register(fn->name, NativeFunction{fn->fn});
+    RegisterBuiltin(fn->name, NativeFunction{fn->fn});
   }
 }
 
@@ -112,27 +169,23 @@ void ScriptEnv::Register(string_view id, NativeFunction fn) {
   SetValue(Symbol(id), Create(fn));
 }
 
+void ScriptEnv::RegisterBuiltin(string_view id, NativeFunction fn) {
+  const Symbol symbol(id);
+  ScriptValue value = Create(std::move(fn));
+  SetValue(symbol, value);
+  builtins_[symbol] = std::move(value);
+}
+
+ScriptValue ScriptEnv::GetBuiltin(const Symbol& symbol) const {
+  auto iter = builtins_.find(symbol);
+  return iter != builtins_.end() ? iter->second : ScriptValue();
+}
+
 void ScriptEnv::Register(string_view id,
                          const IScriptEngine::ScriptableFn& fn) {
-  std::string name = id.to_string();
-  NativeFunction native([name, fn](ScriptFrame* frame) {
-    ContextAdaptor<FunctionCall> call(name);
-
-    ScriptArgList arg_list(frame->GetEnv(), frame->GetArgs());
-    while (arg_list.HasNext()) {
-      ScriptValue value = arg_list.EvalNext();
-      if (!value.IsNil()) {
-        call.AddArg(*value.GetVariant());
-      } else {
-        call.AddArg(Variant());
-      }
-    }
-
-    if (fn(&call) > 0) {
-      auto result = ScriptValue::Create(0);
-      result.SetFromVariant(call.GetReturnValue());
-      frame->Return(result);
-    }
+  NativeFunction native([fn](ScriptFrame* frame) {
+    ContextAdaptor<ScriptableFnContext> context(frame);
+    fn(&context);
   });
   Register(id, native);
 }
@@ -151,16 +204,17 @@ ScriptByteCode ScriptEnv::Compile(string_view src) {
   return code;
 }
 
-ScriptValue ScriptEnv::Load(const ScriptByteCode& code) {
-  ScriptCompiler compiler(const_cast<ScriptByteCode*>(&code));
+ScriptValue ScriptEnv::Load(Span<uint8_t> code) {
   ScriptAstBuilder builder(this);
-  compiler.Build(&builder);
+  if (!ScriptCompiler::Build(code, &builder)) {
+    return ScriptValue();
+  }
   return Create(builder.GetRoot());
 }
 
 ScriptValue ScriptEnv::LoadOrRead(Span<uint8_t> code) {
   if (ScriptCompiler::IsByteCode(code)) {
-    return Load(ScriptByteCode(code.data(), code.data() + code.size()));
+    return Load(code);
   } else {
     const char* str = reinterpret_cast<const char*>(code.data());
     return Read(string_view(str, code.size()));
@@ -189,6 +243,22 @@ ScriptValue ScriptEnv::GetValue(const Symbol& symbol) const {
   return table_.GetValue(symbol);
 }
 
+ScriptEnv::SymbolSlot ScriptEnv::ResolveSymbol(const Symbol& symbol) {
+  return table_.Resolve(symbol);
+}
+
+void ScriptEnv::SetValue(SymbolSlot slot, ScriptValue value) {
+  table_.SetValue(slot, std::move(value));
+}
+
+void ScriptEnv::LetValue(SymbolSlot slot, ScriptValue value) {
+  table_.LetValue(slot, std::move(value));
+}
+
+ScriptValue ScriptEnv::GetValue(SymbolSlot slot) const {
+  return table_.GetValue(slot);
+}
+
 ScriptValue ScriptEnv::Eval(ScriptValue script) {
   ScriptValue result;
   if (const AstNode* node = script.Get<AstNode>()) {
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <stdint.h>
 #include <cstddef>
+#include <unordered_map>
 #include "lullaby/modules/function/function_call.h"
 #include "lullaby/modules/lullscript/script_scoped_symbol_table.h"
 #include "lullaby/modules/lullscript/script_types.h"
@@ -46,6 +47,7 @@ namespace lull {
 class ScriptEnv {
  public:
   using PrintFn = std::function<void(std::string)>;
+  using SymbolSlot = ScriptScopedSymbolTable::Slot;
 
   ScriptEnv();
 
@@ -55,13 +57,15 @@ class ScriptEnv {
   // Converts source code into byte code.
   ScriptByteCode Compile(string_view src);
 
-  // Converts byte code into an AST stored in a ScriptValue.
-  ScriptValue Load(const ScriptByteCode& code);
+  // Converts byte code into an AST stored in a ScriptValue.  The byte code is
+  // read in place, so it may refer to memory-mapped data.
+  ScriptValue Load(Span<uint8_t> code);
 
   // Converts source code into an AST stored in a ScriptValue.
   ScriptValue Read(string_view src);
 
-  // Evaluates the AST represented by the ScriptValue.
+  // Converts either byte code or source code into an AST stored in a
+  // ScriptValue.
   ScriptValue LoadOrRead(Span<uint8_t> code);
 
   // Evaluates the AST represented by the ScriptValue.
@@ -84,6 +88,18 @@ class ScriptEnv {
   // ScriptScopedSymbolTable.
   ScriptValue GetValue(const Symbol& symbol) const;
 
+  // Resolves |symbol| to a slot in the internal ScriptScopedSymbolTable.  The
+  // slot can then be passed to the functions below to access the symbol's
+  // value without looking it up by name again.
+  SymbolSlot ResolveSymbol(const Symbol& symbol);
+  void SetValue(SymbolSlot slot, ScriptValue value);
+  void LetValue(SymbolSlot slot, ScriptValue value);
+  ScriptValue GetValue(SymbolSlot slot) const;
+
+  // Gets the built-in function that was bound to |symbol| when the ScriptEnv
+  // was created, or nil if |symbol| is not the name of a built-in.
+  ScriptValue GetBuiltin(const Symbol& symbol) const;
+
   // Registers a NativeFunction.
   void Register(string_view id, NativeFunction fn);
 
@@ -131,6 +147,8 @@ class ScriptEnv {
     kMacro,
   };
 
+  void RegisterBuiltin(string_view id, NativeFunction fn);
+
   ScriptValue DoImpl(const ScriptValue& body);
 
   ScriptValue SetImpl(const ScriptValue& args, ValueType type, bool let = true);
@@ -142,6 +160,7 @@ class ScriptEnv {
   bool AssignArgs(ScriptValue params, ScriptValue args, bool eval);
 
   ScriptScopedSymbolTable table_;
+  std::unordered_map<Symbol, ScriptValue, Symbol::Hasher> builtins_;
   PrintFn print_fn_ = nullptr;
 };
 
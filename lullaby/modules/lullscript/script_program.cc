@@ -0,0 +1,605 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/lullscript/script_program.h"
+
+#include <algorithm>
+#include <string>
+#include "lullaby/modules/lullscript/script_env.h"
+#include "lullaby/modules/lullscript/script_frame.h"
+
+namespace lull {
+namespace {
+
+struct AddOp {
+  template <typename T>
+  static T Apply(T lhs, T rhs) { return lhs + rhs; }
+};
+
+struct SubOp {
+  template <typename T>
+  static T Apply(T lhs, T rhs) { return lhs - rhs; }
+};
+
+struct MulOp {
+  template <typename T>
+  static T Apply(T lhs, T rhs) { return lhs * rhs; }
+};
+
+struct DivOp {
+  template <typename T>
+  static T Apply(T lhs, T rhs) { return lhs / rhs; }
+};
+
+struct EqOp {
+  template <typename T>
+  static bool Apply(T lhs, T rhs) { return lhs == rhs; }
+};
+
+struct NeOp {
+  template <typename T>
+  static bool Apply(T lhs, T rhs) { return lhs != rhs; }
+};
+
+struct LtOp {
+  template <typename T>
+  static bool Apply(T lhs, T rhs) { return lhs < rhs; }
+};
+
+struct GtOp {
+  template <typename T>
+  static bool Apply(T lhs, T rhs) { return lhs > rhs; }
+};
+
+struct LeOp {
+  template <typename T>
+  static bool Apply(T lhs, T rhs) { return lhs <= rhs; }
+};
+
+struct GeOp {
+  template <typename T>
+  static bool Apply(T lhs, T rhs) { return lhs >= rhs; }
+};
+
+// Applies Op to two unboxed numbers, converting them to the wider of their
+// types first as the operator functions do.  Returns false if either register
+// does not hold a number.
+template <typename Op, typename Reg>
+bool ApplyNumeric(const Reg& lhs, const Reg& rhs, Reg* out) {
+  if (!lhs.IsNumber() || !rhs.IsNumber()) {
+    return false;
+  }
+  switch (std::max(lhs.type, rhs.type)) {
+    case Reg::kInt:
+      out->Set(Op::Apply(lhs.i, rhs.i));
+      break;
+    case Reg::kFloat:
+      out->Set(Op::Apply(lhs.AsFloat(), rhs.AsFloat()));
+      break;
+    default:
+      out->Set(Op::Apply(lhs.AsDouble(), rhs.AsDouble()));
+      break;
+  }
+  return true;
+}
+
+// Modulo is only defined for integers.
+template <typename Reg>
+bool ApplyMod(const Reg& lhs, const Reg& rhs, Reg* out) {
+  if (lhs.type != Reg::kInt || rhs.type != Reg::kInt) {
+    return false;
+  }
+  out->Set(static_cast<int32_t>(lhs.i % rhs.i));
+  return true;
+}
+
+}  // namespace
+
+void ScriptProgram::Register::Set(bool value) {
+  boxed.Reset();
+  type = kBool;
+  b = value;
+}
+
+void ScriptProgram::Register::Set(int32_t value) {
+  boxed.Reset();
+  type = kInt;
+  i = value;
+}
+
+void ScriptProgram::Register::Set(float value) {
+  boxed.Reset();
+  type = kFloat;
+  f = value;
+}
+
+void ScriptProgram::Register::Set(double value) {
+  boxed.Reset();
+  type = kDouble;
+  d = value;
+}
+
+void ScriptProgram::Register::Set(ScriptValue value) {
+  type = kBoxed;
+  boxed = std::move(value);
+}
+
+void ScriptProgram::Register::Clear() {
+  boxed.Reset();
+  type = kNil;
+}
+
+float ScriptProgram::Register::AsFloat() const {
+  return type == kInt ? static_cast<float>(i) : f;
+}
+
+double ScriptProgram::Register::AsDouble() const {
+  switch (type) {
+    case kInt:
+      return static_cast<double>(i);
+    case kFloat:
+      return static_cast<double>(f);
+    default:
+      return d;
+  }
+}
+
+ScriptProgram::ScriptProgram(ScriptEnv* env, ScriptValue script)
+    : env_(env), script_(std::move(script)) {
+  const uint32_t result = PushRegister();
+  Compile(script_, result);
+  PopRegister();
+}
+
+ScriptValue ScriptProgram::Run() {
+  if (env_ == nullptr) {
+    return ScriptValue();
+  }
+  // The register file can only be used by one invocation at a time, and the
+  // compiled code is only valid while the built-ins it inlined are still bound.
+  if (running_ || !CheckBuiltins()) {
+    return env_->Eval(script_);
+  }
+
+  running_ = true;
+  Register* regs = registers_.data();
+  const Instruction* code = code_.data();
+  const size_t size = code_.size();
+  size_t pc = 0;
+  while (pc < size) {
+    const Instruction& inst = code[pc++];
+    Register& dst = regs[inst.dst];
+    switch (inst.op) {
+      case kLoadConst:
+        dst = constants_[inst.a];
+        break;
+      case kLoadSymbol: {
+        ScriptValue value = env_->GetValue(ScriptEnv::SymbolSlot{inst.a});
+        if (value.Is<AstNode>() || value.Is<Symbol>()) {
+          value = env_->Eval(std::move(value));
+        }
+        Unbox(std::move(value), &dst);
+        break;
+      }
+      case kSetValue:
+        env_->SetValue(ScriptEnv::SymbolSlot{inst.a}, Box(dst));
+        break;
+      case kLetValue:
+        env_->LetValue(ScriptEnv::SymbolSlot{inst.a}, Box(dst));
+        break;
+      case kEval:
+        Unbox(env_->Eval(asts_[inst.a]), &dst);
+        break;
+      case kAdd:
+        if (!ApplyNumeric<AddOp>(regs[inst.a], regs[inst.b], &dst)) {
+          CallBuiltin(inst, 2);
+        }
+        break;
+      case kSub:
+        if (!ApplyNumeric<SubOp>(regs[inst.a], regs[inst.b], &dst)) {
+          CallBuiltin(inst, 2);
+        }
+        break;
+      case kMul:
+        if (!ApplyNumeric<MulOp>(regs[inst.a], regs[inst.b], &dst)) {
+          CallBuiltin(inst, 2);
+        }
+        break;
+      case kDiv:
+        if (!ApplyNumeric<DivOp>(regs[inst.a], regs[inst.b], &dst)) {
+          CallBuiltin(inst, 2);
+        }
+        break;
+      case kMod:
+        if (!ApplyMod(regs[inst.a], regs[inst.b], &dst)) {
+          CallBuiltin(inst, 2);
+        }
+        break;
+      case kEq:
+        if (!ApplyNumeric<EqOp>(regs[inst.a], regs[inst.b], &dst)) {
+          CallBuiltin(inst, 2);
+        }
+        break;
+      case kNe:
+        if (!ApplyNumeric<NeOp>(regs[inst.a], regs[inst.b], &dst)) {
+          CallBuiltin(inst, 2);
+        }
+        break;
+      case kLt:
+        if (!ApplyNumeric<LtOp>(regs[inst.a], regs[inst.b], &dst)) {
+          CallBuiltin(inst, 2);
+        }
+        break;
+      case kGt:
+        if (!ApplyNumeric<GtOp>(regs[inst.a], regs[inst.b], &dst)) {
+          CallBuiltin(inst, 2);
+        }
+        break;
+      case kLe:
+        if (!ApplyNumeric<LeOp>(regs[inst.a], regs[inst.b], &dst)) {
+          CallBuiltin(inst, 2);
+        }
+        break;
+      case kGe:
+        if (!ApplyNumeric<GeOp>(regs[inst.a], regs[inst.b], &dst)) {
+          CallBuiltin(inst, 2);
+        }
+        break;
+      case kNot:
+        if (regs[inst.a].type == Register::kBool) {
+          dst.Set(!regs[inst.a].b);
+        } else {
+          CallBuiltin(inst, 1);
+        }
+        break;
+      case kAnd:
+      case kOr: {
+        const Register& arg = regs[inst.a];
+        if (arg.type != Register::kBool) {
+          env_->Error(inst.op == kAnd ? "and: argument should have type bool."
+                                      : "or: argument should have type bool.",
+                      asts_[inst.c]);
+          dst.Clear();
+          pc = inst.b;
+        } else {
+          dst.Set(arg.b);
+          if (arg.b == (inst.op == kOr)) {
+            pc = inst.b;
+          }
+        }
+        break;
+      }
+      case kJump:
+        pc = inst.b;
+        break;
+      case kJumpIfFalse: {
+        const Register& cond = regs[inst.a];
+        if (cond.type != Register::kBool || !cond.b) {
+          pc = inst.b;
+        }
+        break;
+      }
+      case kJumpIfReturn:
+        if (dst.type == Register::kBoxed) {
+          if (const DefReturn* def_return = dst.boxed.Get<DefReturn>()) {
+            ScriptValue value = def_return->value;
+            Unbox(std::move(value), &dst);
+            pc = inst.b;
+          }
+        }
+        break;
+    }
+  }
+
+  ScriptValue result = Box(regs[0]);
+  for (Register& reg : registers_) {
+    reg.Clear();
+  }
+  running_ = false;
+  return result;
+}
+
+void ScriptProgram::Compile(const ScriptValue& cell, uint32_t dst) {
+  // Mirrors ScriptEnv::Eval: a cell either holds a call or a single value.
+  const AstNode* node = cell.Get<AstNode>();
+  if (node == nullptr) {
+    CompileValue(cell, dst);
+    return;
+  }
+  const AstNode* call = node->first.Get<AstNode>();
+  if (call == nullptr) {
+    CompileValue(node->first, dst);
+  } else if (!CompileCall(cell, *call, dst)) {
+    CompileEval(cell, dst);
+  }
+}
+
+void ScriptProgram::CompileValue(const ScriptValue& value, uint32_t dst) {
+  if (const Symbol* symbol = value.Get<Symbol>()) {
+    Emit(kLoadSymbol, dst, ResolveSymbol(*symbol));
+  } else {
+    Emit(kLoadConst, dst, AddConstant(value));
+  }
+}
+
+bool ScriptProgram::CompileCall(const ScriptValue& cell, const AstNode& call,
+                                uint32_t dst) {
+  const Symbol* symbol = call.first.Get<Symbol>();
+  if (symbol == nullptr) {
+    return false;
+  }
+
+  // Only calls to built-ins that have not been rebound can be compiled.
+  ScriptValue fn = env_->GetValue(*symbol);
+  if (fn.IsNil() ||
+      fn.GetVariant() != env_->GetBuiltin(*symbol).GetVariant()) {
+    return false;
+  }
+
+  std::vector<ScriptValue> args;
+  ScriptValue iter = call.rest;
+  while (!iter.IsNil()) {
+    const AstNode* node = iter.Get<AstNode>();
+    if (node == nullptr) {
+      return false;
+    }
+    args.push_back(iter);
+    iter = node->rest;
+  }
+
+  static const struct {
+    const char* name;
+    OpCode op;
+  } kOperators[] = {
+      {"+", kAdd}, {"-", kSub},  {"*", kMul},  {"/", kDiv},
+      {"%", kMod}, {"==", kEq},  {"!=", kNe},  {"<", kLt},
+      {">", kGt},  {"<=", kLe},  {">=", kGe},  {"not", kNot},
+  };
+
+  const std::string& name = symbol->name;
+  for (const auto& entry : kOperators) {
+    if (name != entry.name) {
+      continue;
+    }
+    const size_t num_args = entry.op == kNot ? 1 : 2;
+    if (args.size() != num_args) {
+      return false;
+    }
+    const uint32_t builtin = AddBuiltin(*symbol, std::move(fn));
+    Compile(args[0], dst);
+    if (num_args == 1) {
+      Emit(entry.op, dst, dst, 0, builtin);
+    } else {
+      const uint32_t rhs = PushRegister();
+      Compile(args[1], rhs);
+      Emit(entry.op, dst, dst, rhs, builtin);
+      PopRegister();
+    }
+    return true;
+  }
+
+  bool compiled = false;
+  if (name == "and") {
+    compiled = CompileAndOr(cell, kAnd, args, dst);
+  } else if (name == "or") {
+    compiled = CompileAndOr(cell, kOr, args, dst);
+  } else if (name == "if") {
+    compiled = CompileIf(args, dst);
+  } else if (name == "do") {
+    compiled = CompileDo(args, dst);
+  } else if (name == "=") {
+    compiled = CompileAssign(call, kSetValue, dst);
+  } else if (name == "var") {
+    compiled = CompileAssign(call, kLetValue, dst);
+  }
+  if (compiled) {
+    AddBuiltin(*symbol, std::move(fn));
+  }
+  return compiled;
+}
+
+bool ScriptProgram::CompileAndOr(const ScriptValue& cell, OpCode op,
+                                 const std::vector<ScriptValue>& args,
+                                 uint32_t dst) {
+  Emit(kLoadConst, dst, AddConstant(ScriptValue::Create(op == kAnd)));
+  const uint32_t context = AddAst(cell);
+  const uint32_t arg = PushRegister();
+  std::vector<size_t> exits;
+  for (const ScriptValue& expr : args) {
+    Compile(expr, arg);
+    exits.push_back(Emit(op, dst, arg, 0, context));
+  }
+  PopRegister();
+  for (size_t exit : exits) {
+    PatchJump(exit);
+  }
+  return true;
+}
+
+bool ScriptProgram::CompileIf(const std::vector<ScriptValue>& args,
+                              uint32_t dst) {
+  // Let the if function report missing conditions and extra paths.
+  if (args.empty() || args.size() > 3) {
+    return false;
+  }
+
+  Compile(args[0], dst);
+  const size_t to_else = Emit(kJumpIfFalse, 0, dst);
+  if (args.size() > 1) {
+    Compile(args[1], dst);
+  } else {
+    Emit(kLoadConst, dst, AddConstant(ScriptValue()));
+  }
+  const size_t to_end = Emit(kJump, 0, 0);
+  PatchJump(to_else);
+  if (args.size() > 2) {
+    Compile(args[2], dst);
+  } else {
+    Emit(kLoadConst, dst, AddConstant(ScriptValue()));
+  }
+  PatchJump(to_end);
+  return true;
+}
+
+bool ScriptProgram::CompileDo(const std::vector<ScriptValue>& args,
+                              uint32_t dst) {
+  if (args.empty()) {
+    return false;
+  }
+
+  // A (return) anywhere in a statement produces a DefReturn which exits the
+  // innermost do.
+  std::vector<size_t> returns;
+  for (const ScriptValue& cell : args) {
+    Compile(cell, dst);
+    returns.push_back(Emit(kJumpIfReturn, dst, 0));
+  }
+  for (size_t ret : returns) {
+    PatchJump(ret);
+  }
+  return true;
+}
+
+bool ScriptProgram::CompileAssign(const AstNode& call, OpCode op,
+                                  uint32_t dst) {
+  const AstNode* args = call.rest.Get<AstNode>();
+  if (args == nullptr || !args->first.Is<Symbol>() ||
+      !args->rest.Is<AstNode>()) {
+    return false;
+  }
+
+  Compile(args->rest, dst);
+  Emit(op, dst, ResolveSymbol(*args->first.Get<Symbol>()));
+  return true;
+}
+
+void ScriptProgram::CompileEval(const ScriptValue& cell, uint32_t dst) {
+  Emit(kEval, dst, AddAst(cell));
+}
+
+size_t ScriptProgram::Emit(OpCode op, uint32_t dst, uint32_t a, uint32_t b,
+                           uint32_t c) {
+  code_.emplace_back(op, dst, a, b, c);
+  return code_.size() - 1;
+}
+
+void ScriptProgram::PatchJump(size_t index) {
+  code_[index].b = static_cast<uint32_t>(code_.size());
+}
+
+uint32_t ScriptProgram::PushRegister() {
+  const uint32_t index = num_live_registers_++;
+  if (registers_.size() < num_live_registers_) {
+    registers_.resize(num_live_registers_);
+  }
+  return index;
+}
+
+void ScriptProgram::PopRegister() { --num_live_registers_; }
+
+uint32_t ScriptProgram::AddConstant(const ScriptValue& value) {
+  constants_.emplace_back();
+  Unbox(value, &constants_.back());
+  return static_cast<uint32_t>(constants_.size() - 1);
+}
+
+uint32_t ScriptProgram::ResolveSymbol(const Symbol& symbol) {
+  return static_cast<uint32_t>(env_->ResolveSymbol(symbol));
+}
+
+uint32_t ScriptProgram::AddBuiltin(const Symbol& symbol, ScriptValue fn) {
+  const ScriptScopedSymbolTable::Slot slot = env_->ResolveSymbol(symbol);
+  for (size_t i = 0; i < builtins_.size(); ++i) {
+    if (builtins_[i].slot == slot) {
+      return static_cast<uint32_t>(i);
+    }
+  }
+  builtins_.emplace_back(slot, std::move(fn));
+  return static_cast<uint32_t>(builtins_.size() - 1);
+}
+
+uint32_t ScriptProgram::AddAst(ScriptValue ast) {
+  asts_.push_back(std::move(ast));
+  return static_cast<uint32_t>(asts_.size() - 1);
+}
+
+bool ScriptProgram::CheckBuiltins() const {
+  for (const Builtin& builtin : builtins_) {
+    if (env_->GetValue(builtin.slot).GetVariant() !=
+        builtin.fn.GetVariant()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ScriptProgram::CallBuiltin(const Instruction& inst, size_t num_args) {
+  // Operands the fast path cannot handle (eg. vectors, durations or errors)
+  // are passed to the original function so that the results and errors match
+  // ScriptEnv::Eval exactly.
+  const uint32_t operands[] = {inst.a, inst.b};
+  ScriptValue args;
+  for (size_t i = num_args; i > 0; --i) {
+    ScriptValue arg = Box(registers_[operands[i - 1]]);
+    // The function evaluates its arguments, which would evaluate these again.
+    if (arg.Is<AstNode>() || arg.Is<Symbol>()) {
+      env_->Error("Unsupported operand type.", arg);
+      registers_[inst.dst].Clear();
+      return;
+    }
+    args = ScriptValue::Create(AstNode(std::move(arg), std::move(args)));
+  }
+
+  ScriptFrame frame(env_, std::move(args));
+  builtins_[inst.c].fn.Get<NativeFunction>()->fn(&frame);
+  Unbox(frame.GetReturnValue(), &registers_[inst.dst]);
+}
+
+ScriptValue ScriptProgram::Box(const Register& reg) {
+  switch (reg.type) {
+    case Register::kBool:
+      return ScriptValue::Create(reg.b);
+    case Register::kInt:
+      return ScriptValue::Create(reg.i);
+    case Register::kFloat:
+      return ScriptValue::Create(reg.f);
+    case Register::kDouble:
+      return ScriptValue::Create(reg.d);
+    case Register::kBoxed:
+      return reg.boxed;
+    default:
+      return ScriptValue();
+  }
+}
+
+void ScriptProgram::Unbox(ScriptValue value, Register* reg) {
+  const TypeId type = value.GetTypeId();
+  if (type == GetTypeId<bool>()) {
+    reg->Set(*value.Get<bool>());
+  } else if (type == GetTypeId<int32_t>()) {
+    reg->Set(*value.Get<int32_t>());
+  } else if (type == GetTypeId<float>()) {
+    reg->Set(*value.Get<float>());
+  } else if (type == GetTypeId<double>()) {
+    reg->Set(*value.Get<double>());
+  } else if (value.GetVariant() == nullptr) {
+    reg->Clear();
+  } else {
+    reg->Set(std::move(value));
+  }
+}
+
+}  // namespace lull
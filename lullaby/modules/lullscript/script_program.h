@@ -0,0 +1,197 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_LULLSCRIPT_SCRIPT_PROGRAM_H_
+#define LULLABY_MODULES_LULLSCRIPT_SCRIPT_PROGRAM_H_
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+#include "lullaby/modules/lullscript/script_scoped_symbol_table.h"
+#include "lullaby/modules/lullscript/script_types.h"
+#include "lullaby/modules/lullscript/script_value.h"
+
+namespace lull {
+
+class ScriptEnv;
+
+// A script AST compiled into a linear stream of register-based instructions.
+//
+// Evaluating an AST with ScriptEnv::Eval walks the tree and creates a new
+// ScriptValue for nearly every intermediate result.  A ScriptProgram instead
+// compiles the AST once into a flat instruction stream with a constant pool and
+// a register file in which bools, ints, floats and doubles are stored unboxed.
+// The symbols it accesses are resolved to ScriptScopedSymbolTable slots.
+// Running the program is a single dispatch loop; arithmetic, comparisons, and,
+// or, not, if, do and assignments are executed directly and only storing a
+// value into a variable allocates.
+//
+// LullScript is dynamically scoped, so variables still live in the ScriptEnv's
+// symbol table where functions and natives called by the script can see them.
+// Slots just avoid looking up their names on every access.
+//
+// Forms the compiler does not understand (eg. def, lambda or calls to other
+// functions) are compiled into an instruction that hands the sub-tree to
+// ScriptEnv::Eval.  The built-in functions that the program executes directly
+// are checked at the start of every Run and, if any of them has been rebound,
+// the whole script is evaluated with ScriptEnv::Eval instead.  Either way, Run
+// returns the same result as ScriptEnv::Eval.
+class ScriptProgram {
+ public:
+  ScriptProgram() {}
+
+  // Compiles the AST |script| (as returned by ScriptEnv::Read or Load) for
+  // execution in |env|.
+  ScriptProgram(ScriptEnv* env, ScriptValue script);
+
+  // Runs the program and returns the result of the script.
+  ScriptValue Run();
+
+  // Returns true if the program was compiled from a script.
+  bool IsValid() const { return env_ != nullptr; }
+
+  // Returns the number of instructions in the program.
+  size_t GetNumInstructions() const { return code_.size(); }
+
+  // Returns the number of registers used by the program.
+  size_t GetNumRegisters() const { return registers_.size(); }
+
+ private:
+  enum OpCode : uint8_t {
+    kLoadConst,
+    kLoadSymbol,
+    kSetValue,
+    kLetValue,
+    kEval,
+    kAdd,
+    kSub,
+    kMul,
+    kDiv,
+    kMod,
+    kEq,
+    kNe,
+    kLt,
+    kGt,
+    kLe,
+    kGe,
+    kNot,
+    kAnd,
+    kOr,
+    kJump,
+    kJumpIfFalse,
+    kJumpIfReturn,
+  };
+
+  // The operands of an instruction are indices into the register file (dst,
+  // and usually a), the constant pool, symbol table slots, the ASTs used by
+  // kEval, or the built-in functions (c, for operators).  Jump targets are
+  // always stored in b.
+  struct Instruction {
+    Instruction(OpCode op, uint32_t dst, uint32_t a, uint32_t b = 0,
+                uint32_t c = 0)
+        : op(op), dst(dst), a(a), b(b), c(c) {}
+    OpCode op;
+    uint32_t dst;
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+  };
+
+  // Stores a value unboxed if it is a bool or a number, or as a ScriptValue
+  // otherwise.  The order of the numeric types matches the C++ arithmetic
+  // conversions the operator functions apply.
+  struct Register {
+    enum Type : uint8_t {
+      kNil,
+      kBool,
+      kInt,
+      kFloat,
+      kDouble,
+      kBoxed,
+    };
+
+    Register() : d(0.0) {}
+
+    void Set(bool value);
+    void Set(int32_t value);
+    void Set(float value);
+    void Set(double value);
+    void Set(ScriptValue value);
+    void Clear();
+
+    bool IsNumber() const { return type >= kInt && type <= kDouble; }
+    float AsFloat() const;
+    double AsDouble() const;
+
+    Type type = kNil;
+    union {
+      bool b;
+      int32_t i;
+      float f;
+      double d;
+    };
+    ScriptValue boxed;
+  };
+
+  // A built-in function the program executes directly, along with the value
+  // it was bound to when the program was compiled.
+  struct Builtin {
+    Builtin(ScriptScopedSymbolTable::Slot slot, ScriptValue fn)
+        : slot(slot), fn(std::move(fn)) {}
+    ScriptScopedSymbolTable::Slot slot;
+    ScriptValue fn;
+  };
+
+  void Compile(const ScriptValue& cell, uint32_t dst);
+  void CompileValue(const ScriptValue& value, uint32_t dst);
+  bool CompileCall(const ScriptValue& cell, const AstNode& call, uint32_t dst);
+  bool CompileAndOr(const ScriptValue& cell, OpCode op,
+                    const std::vector<ScriptValue>& args, uint32_t dst);
+  bool CompileIf(const std::vector<ScriptValue>& args, uint32_t dst);
+  bool CompileDo(const std::vector<ScriptValue>& args, uint32_t dst);
+  bool CompileAssign(const AstNode& call, OpCode op, uint32_t dst);
+  void CompileEval(const ScriptValue& cell, uint32_t dst);
+
+  size_t Emit(OpCode op, uint32_t dst, uint32_t a, uint32_t b = 0,
+              uint32_t c = 0);
+  void PatchJump(size_t index);
+  uint32_t PushRegister();
+  void PopRegister();
+  uint32_t AddConstant(const ScriptValue& value);
+  uint32_t ResolveSymbol(const Symbol& symbol);
+  uint32_t AddBuiltin(const Symbol& symbol, ScriptValue fn);
+  uint32_t AddAst(ScriptValue ast);
+
+  bool CheckBuiltins() const;
+  void CallBuiltin(const Instruction& inst, size_t num_args);
+
+  static ScriptValue Box(const Register& reg);
+  static void Unbox(ScriptValue value, Register* reg);
+
+  ScriptEnv* env_ = nullptr;
+  ScriptValue script_;
+  std::vector<Instruction> code_;
+  std::vector<Register> constants_;
+  std::vector<Builtin> builtins_;
+  std::vector<ScriptValue> asts_;
+  std::vector<Register> registers_;
+  uint32_t num_live_registers_ = 0;
+  bool running_ = false;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_MODULES_LULLSCRIPT_SCRIPT_PROGRAM_H_
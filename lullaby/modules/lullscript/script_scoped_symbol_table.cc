@@ -20,58 +20,54 @@ namespace lull {
 
 ScriptScopedSymbolTable::ScriptScopedSymbolTable() { PushScope(); }
 
-ScriptScopedSymbolTable::ScriptScopedSymbolTable(
-    const ScriptScopedSymbolTable& other)
-    : lookup_(other.lookup_), scopes_(other.scopes_) {
-  for (const auto& v : other.values_) {
-    auto check = other.lookup_.find(v.lookup_entry->first);
-    CHECK(check != other.lookup_.end());
-    auto iter = lookup_.find(v.lookup_entry->first);
-    CHECK(iter != lookup_.end());
-    values_.emplace_back(v.value, &(*iter));
+ScriptScopedSymbolTable::Slot ScriptScopedSymbolTable::Resolve(
+    const Symbol& symbol) {
+  auto pair = lookup_.emplace(symbol, bindings_.size());
+  if (pair.second) {
+    bindings_.emplace_back();
   }
+  return pair.first->second;
 }
 
 void ScriptScopedSymbolTable::SetValue(const Symbol& symbol,
                                        ScriptValue value) {
-  auto pair = lookup_.emplace(symbol, IndexArray());
-  auto iter = pair.first;
+  SetValue(Resolve(symbol), std::move(value));
+}
 
-  IndexArray& array = iter->second;
-  const bool exists = !pair.second;
-  if (exists) {
+void ScriptScopedSymbolTable::SetValue(Slot slot, ScriptValue value) {
+  const IndexArray& array = bindings_[slot];
+  if (array.count > 0) {
     const size_t index = array.index[array.count - 1];
     values_[index].value = std::move(value);
   } else {
-    DCHECK(array.count < IndexArray::kMaxInstancesPerValue);
-
-    const size_t index = values_.size();
-    values_.emplace_back(std::move(value), &(*iter));
-
-    array.index[array.count] = index;
-    array.count++;
+    AddValue(slot, std::move(value));
   }
 }
 
 void ScriptScopedSymbolTable::LetValue(const Symbol& symbol,
                                        ScriptValue value) {
-  auto iter = lookup_.emplace(symbol, IndexArray()).first;
+  LetValue(Resolve(symbol), std::move(value));
+}
 
-  IndexArray& array = iter->second;
+void ScriptScopedSymbolTable::LetValue(Slot slot, ScriptValue value) {
+  const IndexArray& array = bindings_[slot];
   const bool exists_in_current_scope =
       array.count > 0 && array.index[array.count - 1] > scopes_.back();
   if (exists_in_current_scope) {
     const size_t index = array.index[array.count - 1];
     values_[index].value = std::move(value);
   } else {
-    DCHECK(array.count < IndexArray::kMaxInstancesPerValue);
+    AddValue(slot, std::move(value));
+  }
+}
 
-    const size_t index = values_.size();
-    values_.emplace_back(std::move(value), &(*iter));
+void ScriptScopedSymbolTable::AddValue(Slot slot, ScriptValue value) {
+  IndexArray& array = bindings_[slot];
+  DCHECK(array.count < IndexArray::kMaxInstancesPerValue);
 
-    array.index[array.count] = index;
-    array.count++;
-  }
+  array.index[array.count] = values_.size();
+  array.count++;
+  values_.emplace_back(std::move(value), slot);
 }
 
 ScriptValue ScriptScopedSymbolTable::GetValue(const Symbol& symbol) const {
@@ -79,15 +75,15 @@ ScriptValue ScriptScopedSymbolTable::GetValue(const Symbol& symbol) const {
   if (iter == lookup_.end()) {
     return ScriptValue();
   }
+  return GetValue(iter->second);
+}
 
-  const auto& entry = iter->second;
-  if (entry.count == 0) {
-    LOG(DFATAL) << "This entry should have been removed from the lookup table.";
+ScriptValue ScriptScopedSymbolTable::GetValue(Slot slot) const {
+  const IndexArray& array = bindings_[slot];
+  if (array.count == 0) {
     return ScriptValue();
   }
-
-  const size_t index = entry.index[entry.count - 1];
-  return values_[index].value;
+  return values_[array.index[array.count - 1]].value;
 }
 
 void ScriptScopedSymbolTable::PushScope() {
@@ -97,13 +93,7 @@ void ScriptScopedSymbolTable::PushScope() {
 void ScriptScopedSymbolTable::PopScope() {
   const size_t size = scopes_.back();
   while (values_.size() > size) {
-    auto* lookup = values_.back().lookup_entry;
-
-    IndexArray& array = lookup->second;
-    --array.count;
-    if (array.count == 0) {
-      lookup_.erase(lookup->first);
-    }
+    --bindings_[values_.back().slot].count;
     values_.pop_back();
   }
   scopes_.pop_back();
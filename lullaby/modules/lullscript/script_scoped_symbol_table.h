@@ -37,19 +37,31 @@ namespace lull {
 // different scopes to both declare a variable with the same name.
 class ScriptScopedSymbolTable {
  public:
+  // A handle to all the bindings of a symbol.  Resolving a symbol to a Slot
+  // once allows its value to be accessed without hashing the symbol again.
+  // Slots remain valid for the lifetime of the table (and its copies).
+  using Slot = size_t;
+
   ScriptScopedSymbolTable();
-  explicit ScriptScopedSymbolTable(const ScriptScopedSymbolTable& other);
+  explicit ScriptScopedSymbolTable(const ScriptScopedSymbolTable& other) =
+      default;
 
   // Sets a value associated with the symbol.  If there is no binding for
   // the symbol, a new binding will be introduce in the current scope.
   void SetValue(const Symbol& symbol, ScriptValue value);
+  void SetValue(Slot slot, ScriptValue value);
 
   // Like SetValue, but introduces a new binding if the symbol doesn't exist
   // in the current scope (even if it exists in a parent scope).
   void LetValue(const Symbol& symbol, ScriptValue value);
+  void LetValue(Slot slot, ScriptValue value);
 
   // Gets a value associated with the symbol,
   ScriptValue GetValue(const Symbol& symbol) const;
+  ScriptValue GetValue(Slot slot) const;
+
+  // Returns the Slot for the symbol, creating it if necessary.
+  Slot Resolve(const Symbol& symbol);
 
   // Indicates the start of a new scope.  Any values set at this scope will not
   // replace values in a prior scope, even if they have the same key.
@@ -60,12 +72,15 @@ class ScriptScopedSymbolTable {
   void PopScope();
 
  private:
-  // There are two main data structures that are used to represent the data
+  // There are three main data structures that are used to represent the data
   // stored in the ScriptScopedSymbolTable.  The actual ScriptValues are stored
   // in a std::vector.  This allows for an efficient mechanism for removing all
-  // ScriptValues when a scope is popped.  A std::unordered_map is used to
-  // as a lookup table for efficiently locating all the ScriptValues (in all
-  // scopes) associated with a symbol.
+  // ScriptValues when a scope is popped.  Each symbol that has ever been bound
+  // is given a Slot in a second std::vector, which tracks the ScriptValues (in
+  // all scopes) associated with the symbol.  Finally, a std::unordered_map is
+  // used to as a lookup table for efficiently locating the Slot of a symbol.
+  // Slots are never removed, so popping a scope never touches the lookup
+  // table and Slots can be held onto by callers.
 
   // Stores the indices of all ScriptValues associated with the same symbol.
   struct IndexArray {
@@ -77,23 +92,27 @@ class ScriptScopedSymbolTable {
     size_t count = 0;
   };
 
-  using LookupTable = std::unordered_map<Symbol, IndexArray, Symbol::Hasher>;
+  using LookupTable = std::unordered_map<Symbol, Slot, Symbol::Hasher>;
 
   // Stores the actual ScriptValue associated with a symbol at a specific scope,
-  // as well the symbol's corresponding IndexArray in the lookup table.
+  // as well the symbol's corresponding Slot.
   struct ValueEntry {
-    ValueEntry(ScriptValue value, LookupTable::value_type* lookup)
-        : value(std::move(value)), lookup_entry(lookup) {}
+    ValueEntry(ScriptValue value, Slot slot)
+        : value(std::move(value)), slot(slot) {}
 
     // The actual ScriptValue associated with a symbol.
     ScriptValue value;
-    // A pointer to the data in the LookupTable associated with the symbol.
-    LookupTable::value_type* lookup_entry;
+    // The Slot of the symbol, ie. an index into the bindings_ vector.
+    Slot slot;
   };
 
+  void AddValue(Slot slot, ScriptValue value);
+
   // Storage for all the ScriptValues stored in the table for all scopes.
   std::vector<ValueEntry> values_;
-  // Lookup table for finding the ScriptValues associated with a given symbol.
+  // The indices into values_ of the bindings of each Slot.
+  std::vector<IndexArray> bindings_;
+  // Lookup table for finding the Slot associated with a given symbol.
   LookupTable lookup_;
   // An index into the values_ table that represents the starting index of a
   // given scope.
@@ -56,6 +56,11 @@ class Manipulator {
   virtual float CheckRayCollidingIndicator(const Ray& ray,
                                            size_t indicator_index) = 0;
 
+  /// Returns a worldspace box enclosing the specified indicator.  Rays that
+  /// miss the box are assumed to miss the indicator, which allows the
+  /// (potentially expensive) CheckRayCollidingIndicator to be skipped.
+  virtual Aabb GetIndicatorBounds(size_t indicator_index) const = 0;
+
   /// Sets up the indicators around |entity| every time the manipulator is
   /// selected.
   virtual void SetupIndicators(Entity entity) = 0;
@@ -160,8 +160,7 @@ void ManipulatorManager::CancelLastAction() {
   TransformSystem* transform_system = registry_->Get<TransformSystem>();
   transform_system->SetSqt(selected_entity_, original_sqt_);
   manipulators_[current_manipulator_]->ResetIndicators();
-  manipulators_[current_manipulator_]->UpdateIndicatorsTransform(
-      *transform_system->GetWorldFromEntityMatrix(selected_entity_));
+  UpdateIndicatorsTransform();
   UpdateDummyPosition();
   selected_indicator_ = kNoIndicatorSelected;
 }
@@ -176,10 +175,28 @@ size_t ManipulatorManager::CheckRayCollidingManipulatorIndicator(
   auto* input_focus =
       input_processor->GetInputFocus(input_processor->GetPrimaryDevice());
   const Ray& focus_collision_ray = input_focus->collision_ray;
+  // Most rays miss the indicators entirely, so reject them with a single box
+  // test before testing the individual indicators.
+  if (indicator_bounds_.empty() ||
+      CheckRayAABBCollision(focus_collision_ray, all_indicator_bounds_) ==
+          kNoHitDistance) {
+    return kNoIndicatorSelected;
+  }
   float closest_distance = std::numeric_limits<float>::max();  // max value
   size_t indicator_index = kNoIndicatorSelected;
-  for (size_t i = 0;
-       i < manipulators_[current_manipulator_]->GetNumIndicators(); ++i) {
+  for (size_t i = 0; i < indicator_bounds_.size(); ++i) {
+    // The distance to an indicator's bounds is a lower bound on the distance
+    // to the indicator itself (unless the ray starts inside them), so skip
+    // indicators that cannot be closer than the closest one found so far.
+    const float bounds_distance =
+        CheckPointAABBCollision(focus_collision_ray.origin,
+                                indicator_bounds_[i])
+            ? 0.f
+            : CheckRayAABBCollision(focus_collision_ray, indicator_bounds_[i]);
+    if (bounds_distance == kNoHitDistance ||
+        bounds_distance >= closest_distance) {
+      continue;
+    }
     const float current_distance =
         manipulators_[current_manipulator_]->CheckRayCollidingIndicator(
             focus_collision_ray, i);
@@ -195,9 +212,36 @@ size_t ManipulatorManager::CheckRayCollidingManipulatorIndicator(
   return indicator_index;
 }
 
+void ManipulatorManager::UpdateIndicatorBounds() {
+  indicator_bounds_.clear();
+  if (current_manipulator_ == kNumManipulators) {
+    return;
+  }
+  const auto& manipulator = manipulators_[current_manipulator_];
+  const size_t num_indicators = manipulator->GetNumIndicators();
+  for (size_t i = 0; i < num_indicators; ++i) {
+    indicator_bounds_.emplace_back(manipulator->GetIndicatorBounds(i));
+    all_indicator_bounds_ =
+        i == 0 ? indicator_bounds_[i]
+               : MergeAabbs(all_indicator_bounds_, indicator_bounds_[i]);
+  }
+}
+
+void ManipulatorManager::UpdateIndicatorsTransform() {
+  auto* transform_system = registry_->Get<TransformSystem>();
+  const mathfu::mat4* entity_world_from_object =
+      transform_system->GetWorldFromEntityMatrix(selected_entity_);
+  if (entity_world_from_object) {
+    manipulators_[current_manipulator_]->UpdateIndicatorsTransform(
+        *entity_world_from_object);
+  }
+  UpdateIndicatorBounds();
+}
+
 void ManipulatorManager::DisableIndicators() {
   current_manipulator_ = kNumManipulators;
   selected_indicator_ = kNoIndicatorSelected;
+  UpdateIndicatorBounds();
 }
 
 void ManipulatorManager::EnableIndicators(Type manipulator, Entity entity) {
@@ -206,6 +250,7 @@ void ManipulatorManager::EnableIndicators(Type manipulator, Entity entity) {
   manipulators_[manipulator]->SetupIndicators(entity);
   current_manipulator_ = manipulator;
   selected_indicator_ = kNoIndicatorSelected;
+  UpdateIndicatorBounds();
 
   // Move dummy to the entity.
   auto* transform_system = registry_->Get<TransformSystem>();
@@ -254,8 +299,7 @@ void ManipulatorManager::OnRelease(const EventWrapper& event) {
   auto* transform_system = registry_->Get<TransformSystem>();
   // Update the newest state of the entity.
   original_sqt_ = *transform_system->GetSqt(selected_entity_);
-  manipulators_[current_manipulator_]->UpdateIndicatorsTransform(
-      *transform_system->GetWorldFromEntityMatrix(selected_entity_));
+  UpdateIndicatorsTransform();
   UpdateDummyPosition();
   selected_indicator_ = kNoIndicatorSelected;
 }
@@ -314,11 +358,7 @@ void ManipulatorManager::AdvanceFrame(Clock::duration delta_time) {
     }
   }
   // Update the indicators' transforms.
-  auto* transform_system = registry_->Get<TransformSystem>();
-  const mathfu::mat4* entity_world_from_object =
-      transform_system->GetWorldFromEntityMatrix(selected_entity_);
-  manipulators_[current_manipulator_]->UpdateIndicatorsTransform(
-      *entity_world_from_object);
+  UpdateIndicatorsTransform();
   UpdateDummyPosition();
 }
 
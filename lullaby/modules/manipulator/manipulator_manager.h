@@ -18,6 +18,7 @@ limitations under the License.
 #define LULLABY_MODULES_MANIPULATOR_MANAGER_H_
 
 #include <memory>
+#include <vector>
 
 #include "lullaby/modules/input_processor/input_processor.h"
 #include "lullaby/modules/manipulator/manipulator.h"
@@ -86,6 +87,12 @@ class ManipulatorManager {
   // was no collision.
   size_t CheckRayCollidingManipulatorIndicator(float* distance);
 
+  // Rebuilds |indicator_bounds_| from the current manipulator's indicators.
+  void UpdateIndicatorBounds();
+
+  // Moves the current manipulator's indicators to the selected entity.
+  void UpdateIndicatorsTransform();
+
   // Disable the current manipulator indicators at the selected entity
   // entity and resets the current manipulator and direction.
   void DisableIndicators();
@@ -115,6 +122,12 @@ class ManipulatorManager {
   std::unique_ptr<Manipulator> manipulators_[kNumManipulators];
   Type current_manipulator_;
   size_t selected_indicator_;
+
+  // A two level bounding volume hierarchy over the current manipulator's
+  // indicators: rays that miss |all_indicator_bounds_| cannot hit any
+  // indicator, and rays that miss an indicator's bounds cannot hit it.
+  Aabb all_indicator_bounds_;
+  std::vector<Aabb> indicator_bounds_;
 };
 }  // namespace lull
 
@@ -33,6 +33,16 @@ namespace lull {
 namespace {
 const size_t kNumCircleSegments = 180;
 const float kRingRadius = 0.4f;
+const float kRingThickness = 0.01f;
+// The ring meshes are only regenerated once the direction to the camera
+// changes by more than this.
+const float kRingMeshEpsilon = 0.01f;
+const Color4ub kRingColors[] = {
+    {255, 0, 0, 255},  // red
+    {0, 255, 0, 255},  // green
+    {0, 0, 255, 255},  // blue
+};
+const Color4ub kCameraRingColor(0, 0, 0, 255);  // black
 }  //  namespace
 
 RotationManipulator::RotationManipulator(Registry* registry,
@@ -48,6 +58,10 @@ RotationManipulator::RotationManipulator(Registry* registry,
                        kRingRadius * sinf(current_angle), 0.f);
     ring_verts_.emplace_back(point);
   }
+  for (size_t i = 0; i < kNumDirections; ++i) {
+    ring_camera_dirs_[i] = mathfu::kZeros3f;
+  }
+  camera_ring_mesh_ = GenerateRingMesh(kCameraRingColor, 0, kIncludeBackSide);
   // Load the shader once here to prevent a spam of error calls every time
   // the rings are rendered.
   auto* render_system = registry_->Get<RenderSystem>();
@@ -188,7 +202,6 @@ float RotationManipulator::CheckRayCollidingIndicator(const Ray& ray,
   const mathfu::vec3 ring_center =
       indicator_transforms_[indicator_index] * mathfu::kZeros3f;
   const mathfu::vec3 ring_normal = GetRingPlaneNormal(indicator_index);
-  const float kRingThickness = 0.01f;
   mathfu::vec3 collision_point = mathfu::kZeros3f;
   Plane collision_plane(ring_center, ring_normal);
   // Compute a collision against the plane the ring is in and compare the
@@ -224,6 +237,14 @@ float RotationManipulator::CheckRayCollidingIndicator(const Ray& ray,
   return kNoHitDistance;
 }
 
+Aabb RotationManipulator::GetIndicatorBounds(size_t indicator_index) const {
+  const mathfu::vec3 ring_center =
+      indicator_transforms_[indicator_index].TranslationVector3D();
+  const float extent = kRingRadius + kRingThickness;
+  const mathfu::vec3 extents(extent, extent, extent);
+  return Aabb(ring_center - extents, ring_center + extents);
+}
+
 void RotationManipulator::SetupIndicators(Entity entity) {
   auto* transform_system = registry_->Get<TransformSystem>();
   const mathfu::mat4* entity_matrix =
@@ -259,28 +280,22 @@ void RotationManipulator::SetupIndicators(Entity entity) {
 
 void RotationManipulator::Render(Span<RenderView> views) {
   ComputeCameraPosition(views);
+  UpdateRingMeshes();
   const mathfu::mat4 screen_mat = CalculateMatrixForRingFacingCamera();
 
-  const Color4ub kColors[] = {
-      {255, 0, 0, 255},  // red
-      {0, 255, 0, 255},  // green
-      {0, 0, 255, 255},  // blue
-      {0, 0, 0, 255},    // black
-  };
   auto* render_system = registry_->Get<RenderSystem>();
   for (size_t view = 0; view < views.size(); ++view) {
     render_system->SetViewport(views[view]);
     for (size_t indicator = 0; indicator < kNumDirections; ++indicator) {
       render_system->BindShader(shape_shader_);
-      render_system->DrawMesh(
-          GenerateRingMesh(kColors[indicator], indicator, kHideBackSide),
-          views[view].clip_from_world_matrix *
-              indicator_transforms_[indicator]);
+      render_system->DrawMesh(ring_meshes_[indicator],
+                              views[view].clip_from_world_matrix *
+                                  indicator_transforms_[indicator]);
     }
     // Draw the black ring that faces the camera and indicates the border
     // between the back and front side of rotation manipulators.
     render_system->BindShader(shape_shader_);
-    render_system->DrawMesh(GenerateRingMesh(kColors[3], 0, kIncludeBackSide),
+    render_system->DrawMesh(camera_ring_mesh_,
                             views[view].clip_from_world_matrix * screen_mat);
   }
 
@@ -296,6 +311,23 @@ void RotationManipulator::Render(Span<RenderView> views) {
   }
 }
 
+void RotationManipulator::UpdateRingMeshes() {
+  for (size_t indicator = 0; indicator < kNumDirections; ++indicator) {
+    // Which half of the ring is hidden only depends on the direction of the
+    // camera relative to the ring, so keep the mesh until that changes.
+    const mathfu::vec3 camera_dir =
+        (indicator_transforms_[indicator].Inverse() * camera_pos_)
+            .Normalized();
+    if (AreNearlyEqual(camera_dir, ring_camera_dirs_[indicator],
+                       kRingMeshEpsilon)) {
+      continue;
+    }
+    ring_meshes_[indicator] =
+        GenerateRingMesh(kRingColors[indicator], indicator, kHideBackSide);
+    ring_camera_dirs_[indicator] = camera_dir;
+  }
+}
+
 void RotationManipulator::ResetIndicators() { dragging_ = false; }
 
 void RotationManipulator::SetControlMode(ControlMode mode) {
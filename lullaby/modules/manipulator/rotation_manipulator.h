@@ -40,6 +40,8 @@ class RotationManipulator : public Manipulator {
   float CheckRayCollidingIndicator(const Ray& ray,
                                    size_t indicator_index) override;
 
+  Aabb GetIndicatorBounds(size_t indicator_index) const override;
+
   void SetupIndicators(Entity entity) override;
 
   void Render(Span<RenderView> views) override;
@@ -83,6 +85,10 @@ class RotationManipulator : public Manipulator {
   MeshData GenerateRingMesh(Color4ub color, size_t indicator_index,
                             BackSideFlags back_side_flag);
 
+  // Regenerates the meshes of the rings whose direction to the camera has
+  // changed since they were last generated.
+  void UpdateRingMeshes();
+
   // Computes the vector tangent to the circle at where the |collision_pos|
   // ocurred on the indicator indicated by |indicator_index|.
   void ComputeTangentVector(const mathfu::vec3& collision_pos,
@@ -100,6 +106,12 @@ class RotationManipulator : public Manipulator {
   ShaderPtr shape_shader_;
   mathfu::vec3 camera_pos_;
 
+  // The ring meshes, and the direction to the camera (in the space of each
+  // ring) they were generated for.
+  MeshData ring_meshes_[kNumDirections];
+  mathfu::vec3 ring_camera_dirs_[kNumDirections];
+  MeshData camera_ring_mesh_;
+
   // Variables about the tangent line on the currently selected ring.
   bool dragging_;
   bool local_mode_;
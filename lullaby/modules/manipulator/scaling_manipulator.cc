@@ -80,6 +80,10 @@ float ScalingManipulator::CheckRayCollidingIndicator(const Ray& ray,
                               kScaleAabb);
 }
 
+Aabb ScalingManipulator::GetIndicatorBounds(size_t indicator_index) const {
+  return TransformAabb(indicator_transforms_[indicator_index], kScaleAabb);
+}
+
 void ScalingManipulator::SetupIndicators(Entity entity) {
   auto* transform_system = registry_->Get<TransformSystem>();
   const mathfu::mat4* entity_matrix =
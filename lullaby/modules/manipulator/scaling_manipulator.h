@@ -38,6 +38,8 @@ class ScalingManipulator : public Manipulator {
   float CheckRayCollidingIndicator(const Ray& ray,
                                    size_t indicator_index) override;
 
+  Aabb GetIndicatorBounds(size_t indicator_index) const override;
+
   void SetupIndicators(Entity entity) override;
 
   void Render(Span<RenderView> views) override;
@@ -112,6 +112,11 @@ float TranslationManipulator::CheckRayCollidingIndicator(
                               kTranslationAabb);
 }
 
+Aabb TranslationManipulator::GetIndicatorBounds(size_t indicator_index) const {
+  return TransformAabb(indicator_transforms_[indicator_index],
+                       kTranslationAabb);
+}
+
 void TranslationManipulator::SetupIndicators(Entity entity) {
   if (entity == kNullEntity) {
     return;
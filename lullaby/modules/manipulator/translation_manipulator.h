@@ -45,6 +45,9 @@ class TranslationManipulator : public Manipulator {
   float CheckRayCollidingIndicator(const Ray& ray,
                                    size_t indicator_index) override;
 
+  /// Returns the worldspace box enclosing the specified indicator aabb.
+  Aabb GetIndicatorBounds(size_t indicator_index) const override;
+
   /// Set ups the indicators in the proper positions around |entity|.
   void SetupIndicators(Entity entity) override;
 
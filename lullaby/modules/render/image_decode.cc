@@ -17,6 +17,7 @@ limitations under the License.
 #include "lullaby/modules/render/image_decode.h"
 #include "lullaby/modules/render/image_decode_ktx.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 
@@ -135,7 +136,10 @@ ImageData DecodeStbi(const uint8_t* src, size_t len, DecodeImageFlags flags) {
 #endif
 }
 
-ImageData DecodeWebp(const uint8_t* data, size_t len, DecodeImageFlags flags) {
+// Decodes a WebP image.  If |max_size| is non-zero, the image is scaled down
+// during decoding so that it fits within |max_size| x |max_size|.
+ImageData DecodeWebp(const uint8_t* data, size_t len, DecodeImageFlags flags,
+                     int max_size = 0) {
   // TODO: Include the source image name in log messages.
 #if LULLABY_DISABLE_WEBP_LOADER
   // libwebp isn't known to be safe, so we've disabled it to eliminate an
@@ -150,6 +154,17 @@ ImageData DecodeWebp(const uint8_t* data, size_t len, DecodeImageFlags flags) {
     LOG(DFATAL) << "Source image data not an WebP file.";
     return ImageData();
   }
+  if (max_size > 0 &&
+      (config.input.width > max_size || config.input.height > max_size)) {
+    const float scale =
+        static_cast<float>(max_size) /
+        static_cast<float>(std::max(config.input.width, config.input.height));
+    config.options.use_scaling = 1;
+    config.options.scaled_width =
+        std::max(1, static_cast<int>(config.input.width * scale));
+    config.options.scaled_height =
+        std::max(1, static_cast<int>(config.input.height * scale));
+  }
   if (config.input.has_alpha) {
     if (flags & kDecodeImage_PremultiplyAlpha) {
       config.output.colorspace = MODE_rgbA;
@@ -258,6 +273,28 @@ AstcDecoderFn g_astc_decoder = nullptr;
 #endif  // defined(LULLABY_ASTC_CPU_DECODE) &&
         // !defined(LULLABY_DISABLE_ASTC_LOADERS)
 
+// Returns true if ASTC data should be decoded on the CPU.  ASTC data is always
+// passed through as-is when the GPU can decode it.
+bool ShouldCpuDecodeAstc(DecodeImageFlags flags) {
+  return g_astc_decoder != nullptr && !g_gpu_astc_supported &&
+         (flags & kDecodeImage_DecodeAstc);
+}
+
+bool ShouldCpuDecodeAstc(const AstcHeader* header, DecodeImageFlags flags) {
+  return ShouldCpuDecodeAstc(flags) && GetAstcSize(header->zsize) == 1;
+}
+
+bool ShouldCpuDecodeKtx(const KtxHeader* header, DecodeImageFlags flags) {
+  if (!ShouldCpuDecodeAstc(flags)) {
+    return false;
+  }
+  const bool is_simple = header->depth == 0 && header->array_elements == 0;
+  DCHECK(is_simple) << "3D or array textures not yet supported.";
+  const mathfu::vec2i block =
+      GetAstcBlockSizeFromGlInternalFormat(header->internal_format);
+  return is_simple && block.x != 0 && block.y != 0;
+}
+
 #if !LULLABY_DISABLE_WEBP_LOADER
 class WebPAnimatedImage : public lull::AnimatedImage {
  public:
@@ -394,13 +431,31 @@ bool CpuAstcDecodingAvailable() { return g_astc_decoder != nullptr; }
 
 bool GpuAstcDecodingAvailable() { return g_gpu_astc_supported; }
 
+bool IsGpuNativeImage(const uint8_t* data, size_t len,
+                      DecodeImageFlags flags) {
+  if (auto header = GetAstcHeader(data, len)) {
+    return !ShouldCpuDecodeAstc(header, flags);
+  } else if (GetPkmHeader(data, len)) {
+    return true;
+  } else if (auto header = GetKtxHeader(data, len)) {
+    return !ShouldCpuDecodeKtx(header, flags);
+  }
+  return false;
+}
+
+ImageData DecodeImagePreview(const uint8_t* data, size_t len,
+                             DecodeImageFlags flags, int max_size) {
+  if (max_size <= 0 || !GetWebpHeader(data, len) || IsAnimated(data, len)) {
+    return ImageData();
+  }
+  return DecodeWebp(data, len, flags, max_size);
+}
+
 ImageData DecodeImage(const uint8_t* data, size_t len, DecodeImageFlags flags) {
   if (auto header = GetAstcHeader(data, len)) {
     const mathfu::vec2i size = GetAstcImageDimensions(header);
-    const int zsize = GetAstcSize(header->zsize);
-    DCHECK(zsize == 1 || !(flags & kDecodeImage_DecodeAstc));
-    if (g_astc_decoder != nullptr && zsize == 1 &&
-        (flags & kDecodeImage_DecodeAstc)) {
+    DCHECK(GetAstcSize(header->zsize) == 1 || !ShouldCpuDecodeAstc(flags));
+    if (ShouldCpuDecodeAstc(header, flags)) {
       const mathfu::vec2i block(header->blockdim_x, header->blockdim_y);
       DCHECK(header->blockdim_z == 1);
       // Skip the ASTC header.
@@ -415,23 +470,19 @@ ImageData DecodeImage(const uint8_t* data, size_t len, DecodeImageFlags flags) {
     return BuildImageData(data, len, ImageData::kPkm, size);
   } else if (auto header = GetKtxHeader(data, len)) {
     const mathfu::vec2i size(header->width, header->height);
-    if (g_astc_decoder != nullptr && (flags & kDecodeImage_DecodeAstc)) {
-      const bool is_simple = header->depth == 0 && header->array_elements == 0;
-      DCHECK(is_simple) << "3D or array textures not yet supported.";
+    if (ShouldCpuDecodeKtx(header, flags)) {
       const mathfu::vec2i block =
           GetAstcBlockSizeFromGlInternalFormat(header->internal_format);
-      if (is_simple && block.x != 0 && block.y != 0) {
-        // Skip the KTX header.
-        len -= sizeof(*header);
-        data += sizeof(*header);
-        // Skip any key/value data.
-        len -= header->keyvalue_data;
-        data += header->keyvalue_data;
-        // Skip the 32 bits of size data.
-        len -= sizeof(uint32_t);
-        data += sizeof(uint32_t);
-        return g_astc_decoder(size, block, header->faces, data, len);
-      }
+      // Skip the KTX header.
+      len -= sizeof(*header);
+      data += sizeof(*header);
+      // Skip any key/value data.
+      len -= header->keyvalue_data;
+      data += header->keyvalue_data;
+      // Skip the 32 bits of size data.
+      len -= sizeof(uint32_t);
+      data += sizeof(uint32_t);
+      return g_astc_decoder(size, block, header->faces, data, len);
     }
     return BuildImageData(data, len, ImageData::kKtx, size);
   } else if (GetWebpHeader(data, len)) {
@@ -92,9 +92,21 @@ enum DecodeImageFlags {
 };
 
 // Decodes image data that is stored in either jpg, png, webp, tga, ktx, pkm,
-// or astc format.
+// or astc format.  Compressed formats (ktx, pkm, astc) are never decoded on
+// the CPU when the GPU supports them.
 ImageData DecodeImage(const uint8_t* data, size_t len, DecodeImageFlags flags);
 
+// Returns true if DecodeImage would pass the image through to the GPU as
+// compressed data rather than decoding it on the CPU.
+bool IsGpuNativeImage(const uint8_t* data, size_t len, DecodeImageFlags flags);
+
+// Decodes a reduced resolution version of the image that fits within
+// |max_size| x |max_size| pixels.  This is much quicker than a full decode and
+// is useful as a placeholder until the full image is available.  Only webp
+// images support scaled decoding; returns an empty ImageData otherwise.
+ImageData DecodeImagePreview(const uint8_t* data, size_t len,
+                             DecodeImageFlags flags, int max_size);
+
 // Returns whether the image contains animation. Only webp is supported
 // currently.
 bool IsAnimated(const std::uint8_t* data, std::size_t len);
@@ -0,0 +1,117 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/render/image_decoder.h"
+
+#include <utility>
+
+#include "lullaby/util/data_container.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+ImageDecoder::ImageDecoder(size_t num_worker_threads)
+    : processor_(num_worker_threads) {}
+
+void ImageDecoder::Decode(std::string data, const DecodeOptions& options,
+                          DecodeFn callback) {
+  if (!callback) {
+    LOG(DFATAL) << "Must provide a callback for decoded images.";
+    return;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->data = std::move(data);
+  job->flags = options.flags;
+  job->callback = std::move(callback);
+
+  const auto* bytes = reinterpret_cast<const uint8_t*>(job->data.data());
+  const size_t num_bytes = job->data.size();
+
+  // There is nothing to decode for images that are uploaded to the GPU as-is,
+  // so skip the round trip through the worker threads.
+  if (IsGpuNativeImage(bytes, num_bytes, job->flags)) {
+    ImageData image = DecodeImage(bytes, num_bytes, job->flags);
+    job->finished = true;
+    job->callback(KeepAlive(std::move(image), job), true);
+    return;
+  }
+
+  auto process = [](Request* request) {
+    const Job& job = *request->job;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(job.data.data());
+    if (request->preview_size > 0) {
+      request->image = DecodeImagePreview(bytes, job.data.size(), job.flags,
+                                          request->preview_size);
+    } else {
+      request->image = DecodeImage(bytes, job.data.size(), job.flags);
+    }
+  };
+
+  // Previews are queued at a higher priority than the full decode so that they
+  // are normally ready first.
+  if (options.preview_size > 0 && GetWebpHeader(bytes, num_bytes)) {
+    Request preview;
+    preview.job = job;
+    preview.preview_size = options.preview_size;
+    processor_.Enqueue(std::move(preview), process, options.priority + 1);
+  }
+
+  Request request;
+  request.job = std::move(job);
+  processor_.Enqueue(std::move(request), process, options.priority);
+}
+
+void ImageDecoder::ProcessCompleted() {
+  Request request;
+  while (processor_.Dequeue(&request)) {
+    Job* job = request.job.get();
+    // With several worker threads, the full decode may finish before its
+    // preview, in which case the preview is no longer useful.
+    if (job->finished) {
+      continue;
+    }
+
+    const bool is_final = request.preview_size == 0;
+    if (!is_final && request.image.IsEmpty()) {
+      continue;
+    }
+    job->finished = is_final;
+    job->callback(KeepAlive(std::move(request.image), request.job), is_final);
+  }
+}
+
+ImageData ImageDecoder::KeepAlive(ImageData image, const JobPtr& job) {
+  const uint8_t* bytes = image.GetBytes();
+  const auto* begin = reinterpret_cast<const uint8_t*>(job->data.data());
+  const uint8_t* end = begin + job->data.size();
+  if (bytes == nullptr || bytes < begin || bytes >= end) {
+    return image;
+  }
+
+  // The image wraps the job's data (eg. compressed GPU formats), so extend the
+  // lifetime of the job to that of the image.
+  const size_t num_bytes = image.GetDataSize();
+  JobPtr owner = job;
+  DataContainer::DataPtr ptr(const_cast<uint8_t*>(bytes),
+                             [owner](const uint8_t*) {});
+  DataContainer data(std::move(ptr), num_bytes, num_bytes,
+                     DataContainer::kRead);
+  return ImageData(image.GetFormat(), image.GetSize(), std::move(data),
+                   image.GetStride());
+}
+
+}  // namespace lull
@@ -0,0 +1,99 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_RENDER_IMAGE_DECODER_H_
+#define LULLABY_MODULES_RENDER_IMAGE_DECODER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "lullaby/modules/render/image_data.h"
+#include "lullaby/modules/render/image_decode.h"
+#include "lullaby/util/async_processor.h"
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+// Decodes images on a pool of worker threads.
+//
+// Compressed formats that the GPU can consume directly (ASTC, PKM, KTX) are
+// never decoded; they are wrapped and handed back without going through the
+// worker threads at all.  Other formats can optionally be decoded to a small
+// preview first, which is delivered before the full resolution image.
+class ImageDecoder {
+ public:
+  // Called with each decoded image.  |is_final| is false for a preview image,
+  // and true for the full resolution image, which is always delivered last.
+  // An empty |image| with |is_final| set indicates that decoding failed.
+  using DecodeFn = std::function<void(ImageData image, bool is_final)>;
+
+  struct DecodeOptions {
+    DecodeImageFlags flags = kDecodeImage_None;
+
+    // Decodes with higher priorities are processed first.
+    int priority = 0;
+
+    // If non-zero, a preview image no larger than |preview_size| in either
+    // dimension is delivered first for formats that support scaled decoding.
+    int preview_size = 0;
+  };
+
+  // Creates the ImageDecoder with the specified number of worker threads.
+  explicit ImageDecoder(size_t num_worker_threads = 2);
+
+  ImageDecoder(const ImageDecoder&) = delete;
+  ImageDecoder& operator=(const ImageDecoder&) = delete;
+
+  // Queues the image file |data| for decoding.  The |callback| is invoked from
+  // ProcessCompleted(), except for GPU-native images for which it is invoked
+  // immediately.
+  void Decode(std::string data, const DecodeOptions& options,
+              DecodeFn callback);
+
+  // Invokes the callbacks of all the decodes that have completed.  This should
+  // be called regularly from the thread that consumes the images (eg. the
+  // render thread).
+  void ProcessCompleted();
+
+ private:
+  // The state shared by the preview and final decodes of a single image.
+  struct Job {
+    std::string data;
+    DecodeImageFlags flags = kDecodeImage_None;
+    DecodeFn callback;
+    bool finished = false;
+  };
+  using JobPtr = std::shared_ptr<Job>;
+
+  struct Request {
+    JobPtr job;
+    ImageData image;
+    int preview_size = 0;
+  };
+
+  // Returns |image| with ownership of the |job| data if |image| refers to it
+  // rather than to memory of its own.
+  static ImageData KeepAlive(ImageData image, const JobPtr& job);
+
+  AsyncProcessor<Request> processor_;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::ImageDecoder);
+
+#endif  // LULLABY_MODULES_RENDER_IMAGE_DECODER_H_
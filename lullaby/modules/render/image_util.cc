@@ -16,21 +16,94 @@ limitations under the License.
 
 #include "lullaby/modules/render/image_util.h"
 
+#include <string.h>
+#include <algorithm>
+
 #include "lullaby/util/color.h"
 #include "lullaby/util/logging.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LULLABY_IMAGE_UTIL_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LULLABY_IMAGE_UTIL_NEON 1
+#endif
+
 namespace lull {
+namespace {
+
+constexpr uint8_t kOpaque = 255;
+
+// Returns |x| * |alpha| / 255, rounded down.
+inline uint8_t MultiplyByAlpha(uint8_t x, uint8_t alpha) {
+  return static_cast<uint8_t>(
+      (static_cast<uint16_t>(x) * static_cast<uint16_t>(alpha)) / 255);
+}
+
+#if LULLABY_IMAGE_UTIL_SSE
+// Divides each 16-bit lane (which must be at most 255 * 255) by 255, rounding
+// down.  For such values, x / 255 == (x * 0x8081) >> 23.
+inline __m128i DivideBy255(__m128i x) {
+  const __m128i kMagic = _mm_set1_epi16(static_cast<short>(0x8081));
+  return _mm_srli_epi16(_mm_mulhi_epu16(x, kMagic), 7);
+}
+
+// Multiplies the RGB lanes of the two RGBA pixels in |x| (one channel per
+// 16-bit lane) by their alpha lane.  Alpha lanes are multiplied by 255 so that
+// they are unchanged by DivideBy255.
+inline __m128i MultiplyByAlpha(__m128i x) {
+  const __m128i kRgbMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+  const __m128i kAlphaOne = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+  __m128i alpha = _mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3));
+  alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+  alpha = _mm_or_si128(_mm_and_si128(alpha, kRgbMask), kAlphaOne);
+  return DivideBy255(_mm_mullo_epi16(x, alpha));
+}
+#elif LULLABY_IMAGE_UTIL_NEON
+// Divides each 16-bit lane (which must be at most 255 * 255) by 255, rounding
+// down, and narrows the result to 8 bits.  For such values,
+// x / 255 == ((x + 1) + ((x + 1) >> 8)) >> 8.
+inline uint8x8_t DivideBy255(uint16x8_t x) {
+  const uint16x8_t t = vaddq_u16(x, vdupq_n_u16(1));
+  return vshrn_n_u16(vsraq_n_u16(t, t, 8), 8);
+}
+
+inline uint8x16_t MultiplyByAlpha(uint8x16_t x, uint8x16_t alpha) {
+  const uint16x8_t lo = vmull_u8(vget_low_u8(x), vget_low_u8(alpha));
+  const uint16x8_t hi = vmull_u8(vget_high_u8(x), vget_high_u8(alpha));
+  return vcombine_u8(DivideBy255(lo), DivideBy255(hi));
+}
+#endif
+
+}  // namespace
 
 void MultiplyRgbByAlpha(uint8_t* data, const mathfu::vec2i& size) {
   const int num_pixels = size.x * size.y;
-  for (int i = 0; i < num_pixels; ++i, data += 4) {
-    const auto alpha = static_cast<uint16_t>(data[3]);
-    data[0] =
-        static_cast<uint8_t>((static_cast<uint16_t>(data[0]) * alpha) / 255);
-    data[1] =
-        static_cast<uint8_t>((static_cast<uint16_t>(data[1]) * alpha) / 255);
-    data[2] =
-        static_cast<uint8_t>((static_cast<uint16_t>(data[2]) * alpha) / 255);
+  int i = 0;
+#if LULLABY_IMAGE_UTIL_SSE
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 4 <= num_pixels; i += 4) {
+    __m128i* ptr = reinterpret_cast<__m128i*>(data + 4 * i);
+    const __m128i pixels = _mm_loadu_si128(ptr);
+    const __m128i lo = MultiplyByAlpha(_mm_unpacklo_epi8(pixels, zero));
+    const __m128i hi = MultiplyByAlpha(_mm_unpackhi_epi8(pixels, zero));
+    _mm_storeu_si128(ptr, _mm_packus_epi16(lo, hi));
+  }
+#elif LULLABY_IMAGE_UTIL_NEON
+  for (; i + 16 <= num_pixels; i += 16) {
+    uint8x16x4_t pixels = vld4q_u8(data + 4 * i);
+    pixels.val[0] = MultiplyByAlpha(pixels.val[0], pixels.val[3]);
+    pixels.val[1] = MultiplyByAlpha(pixels.val[1], pixels.val[3]);
+    pixels.val[2] = MultiplyByAlpha(pixels.val[2], pixels.val[3]);
+    vst4q_u8(data + 4 * i, pixels);
+  }
+#endif
+  for (data += 4 * i; i < num_pixels; ++i, data += 4) {
+    data[0] = MultiplyByAlpha(data[0], data[3]);
+    data[1] = MultiplyByAlpha(data[1], data[3]);
+    data[2] = MultiplyByAlpha(data[2], data[3]);
   }
 }
 
@@ -42,13 +115,121 @@ void ConvertRgb888ToRgba8888(const uint8_t* rgb_ptr, const mathfu::vec2i& size,
   }
 
   const int num_pixels = size.x * size.y;
-  const uint8_t* src_ptr = rgb_ptr;
-  uint8_t* dst_ptr = out_rgba_ptr;
-  for (int i = 0; i < num_pixels; ++i) {
-    *dst_ptr++ = *src_ptr++;
-    *dst_ptr++ = *src_ptr++;
-    *dst_ptr++ = *src_ptr++;
-    *dst_ptr++ = 255;
+  int i = 0;
+#if LULLABY_IMAGE_UTIL_NEON
+  for (; i + 16 <= num_pixels; i += 16) {
+    const uint8x16x3_t rgb = vld3q_u8(rgb_ptr + 3 * i);
+    const uint8x16x4_t rgba = {
+        {rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(kOpaque)}};
+    vst4q_u8(out_rgba_ptr + 4 * i, rgba);
+  }
+#else
+  // Copy each pixel as a single 32-bit word, which also picks up the first
+  // byte of the next pixel, and then overwrite that byte with the alpha.  The
+  // last pixel is left to the loop below to avoid reading past the source.
+  const uint8_t alpha_bytes[4] = {0, 0, 0, kOpaque};
+  uint32_t alpha_mask;
+  memcpy(&alpha_mask, alpha_bytes, sizeof(alpha_mask));
+  const uint32_t rgb_mask = ~alpha_mask;
+  for (; i + 1 < num_pixels; ++i) {
+    uint32_t pixel;
+    memcpy(&pixel, rgb_ptr + 3 * i, sizeof(pixel));
+    pixel = (pixel & rgb_mask) | alpha_mask;
+    memcpy(out_rgba_ptr + 4 * i, &pixel, sizeof(pixel));
+  }
+#endif
+  for (; i < num_pixels; ++i) {
+    out_rgba_ptr[4 * i + 0] = rgb_ptr[3 * i + 0];
+    out_rgba_ptr[4 * i + 1] = rgb_ptr[3 * i + 1];
+    out_rgba_ptr[4 * i + 2] = rgb_ptr[3 * i + 2];
+    out_rgba_ptr[4 * i + 3] = kOpaque;
+  }
+}
+
+void ConvertRgb888ToRgba8888InPlace(uint8_t* data, const mathfu::vec2i& size) {
+  if (!data) {
+    LOG(DFATAL) << "Failed to convert RGB to RGBA.";
+    return;
+  }
+
+  // Pixels are expanded back to front: the destination of a pixel never
+  // overlaps the source of any pixel before it, so no source pixel is
+  // overwritten before it has been read.
+  int i = size.x * size.y;
+#if LULLABY_IMAGE_UTIL_NEON
+  while (i >= 16) {
+    i -= 16;
+    const uint8x16x3_t rgb = vld3q_u8(data + 3 * i);
+    const uint8x16x4_t rgba = {
+        {rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(kOpaque)}};
+    vst4q_u8(data + 4 * i, rgba);
+  }
+#endif
+  while (i > 0) {
+    --i;
+    const uint8_t r = data[3 * i + 0];
+    const uint8_t g = data[3 * i + 1];
+    const uint8_t b = data[3 * i + 2];
+    data[4 * i + 0] = r;
+    data[4 * i + 1] = g;
+    data[4 * i + 2] = b;
+    data[4 * i + 3] = kOpaque;
+  }
+}
+
+mathfu::vec2i GetNextMipSize(const mathfu::vec2i& size) {
+  return mathfu::vec2i(std::max(size.x / 2, 1), std::max(size.y / 2, 1));
+}
+
+bool CanDownsampleImage(ImageData::Format format) {
+  switch (format) {
+    case ImageData::kAlpha:
+    case ImageData::kLuminance:
+    case ImageData::kLuminanceAlpha:
+    case ImageData::kRg88:
+    case ImageData::kRgb888:
+    case ImageData::kRgba8888:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void DownsampleImageRows(const ImageData& src, ImageData* dst, int begin_row,
+                         int end_row) {
+  if (!dst || src.GetBytes() == nullptr || dst->GetMutableBytes() == nullptr) {
+    LOG(DFATAL) << "Failed to downsample image.";
+    return;
+  }
+  if (src.GetFormat() != dst->GetFormat() ||
+      !CanDownsampleImage(src.GetFormat()) ||
+      dst->GetSize() != GetNextMipSize(src.GetSize())) {
+    LOG(DFATAL) << "Cannot downsample image to the destination.";
+    return;
+  }
+
+  const mathfu::vec2i src_size = src.GetSize();
+  const mathfu::vec2i dst_size = dst->GetSize();
+  const int bytes_per_pixel =
+      static_cast<int>(ImageData::GetBitsPerPixel(src.GetFormat()) / 8);
+  // A dimension of 1 is not halved, so both samples come from the same texel.
+  const int x_step = src_size.x > 1 ? bytes_per_pixel : 0;
+  const size_t y_step = src_size.y > 1 ? src.GetStride() : 0;
+  begin_row = std::max(begin_row, 0);
+  end_row = std::min(end_row, dst_size.y);
+
+  for (int y = begin_row; y < end_row; ++y) {
+    const uint8_t* row0 = src.GetBytes() + 2 * y * y_step;
+    const uint8_t* row1 = row0 + y_step;
+    uint8_t* out = dst->GetMutableBytes() + y * dst->GetStride();
+    for (int x = 0; x < dst_size.x; ++x) {
+      const int offset = (src_size.x > 1 ? 2 * x : x) * bytes_per_pixel;
+      for (int c = 0; c < bytes_per_pixel; ++c) {
+        const int i = offset + c;
+        const int sum = row0[i] + row0[i + x_step] + row1[i] + row1[i + x_step];
+        *out++ = static_cast<uint8_t>((sum + 2) / 4);
+      }
+    }
   }
 }
 
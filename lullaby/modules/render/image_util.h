@@ -29,9 +29,29 @@ namespace lull {
 void ConvertRgb888ToRgba8888(const uint8_t* rgb_ptr, const mathfu::vec2i& size,
                              uint8_t* out_rgba_ptr);
 
+// As above, but converts the RGB pixels at the start of |data| in place.
+// |data| must be large enough to hold the resulting RGBA pixels.
+void ConvertRgb888ToRgba8888InPlace(uint8_t* data, const mathfu::vec2i& size);
+
 // Multiplies the RGB-components of an RGBA image with its Alpha component.
+// Since pixels are processed independently, large images can be split into
+// bands of rows that are processed in parallel.
 void MultiplyRgbByAlpha(uint8_t* data, const mathfu::vec2i& size);
 
+// Returns the size of the mip level below one of |size|, ie. half the size
+// rounded down, but no smaller than 1x1.
+mathfu::vec2i GetNextMipSize(const mathfu::vec2i& size);
+
+// Returns true if DownsampleImageRows supports |format|, ie. it has 8 bits
+// per channel.
+bool CanDownsampleImage(ImageData::Format format);
+
+// Fills rows [|begin_row|, |end_row|) of |dst| by box filtering |src|.  |dst|
+// must be writable, have the same format as |src| and be GetNextMipSize() of
+// it.  Working on a range of rows allows a mip chain to be built in pieces.
+void DownsampleImageRows(const ImageData& src, ImageData* dst, int begin_row,
+                         int end_row);
+
 // Returns a static ImageData containing a 2x2 white texture.
 ImageData CreateWhiteImage();
 
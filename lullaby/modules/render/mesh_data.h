@@ -189,6 +189,11 @@ class MeshData {
     return reinterpret_cast<const uint8_t*>(index_data_.GetReadPtr());
   }
 
+  // Returns a mutable pointer to the index data as bytes. Returns nullptr if
+  // the mesh is not indexed or its index DataContainer does not have read+write
+  // access.
+  uint8_t* GetMutableIndexBytes() { return index_data_.GetData(); }
+
   // Gets a const pointer to the index data of the mesh. Returns nullptr if the
   // index DataContainer does not have read access or IndexT doesn't match the
   // mesh's index type.
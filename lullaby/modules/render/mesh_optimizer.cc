@@ -0,0 +1,417 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/render/mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "lullaby/util/logging.h"
+#include "mathfu/glsl_mappings.h"
+
+namespace lull {
+namespace {
+
+// Tuning values from Forsyth's "Linear-Speed Vertex Cache Optimisation".  The
+// scoring cache is larger than the measured cache so that the order is good
+// for a range of hardware cache sizes.
+constexpr int kForsythCacheSize = 32;
+constexpr float kForsythCacheDecayPower = 1.5f;
+constexpr float kForsythLastTriangleScore = 0.75f;
+constexpr float kForsythValenceBoostScale = 2.0f;
+constexpr float kForsythValenceBoostPower = 0.5f;
+
+constexpr uint32_t kInvalidIndex = ~0u;
+
+bool ValidateIndices(const uint32_t* indices, size_t num_indices,
+                     size_t num_vertices) {
+  if (num_indices % 3 != 0) {
+    LOG(DFATAL) << "Index count must be a multiple of 3: " << num_indices;
+    return false;
+  }
+  for (size_t i = 0; i < num_indices; ++i) {
+    if (indices[i] >= num_vertices) {
+      LOG(DFATAL) << "Index out of range: " << indices[i];
+      return false;
+    }
+  }
+  return true;
+}
+
+float ForsythVertexScore(int cache_position, uint32_t remaining_triangles) {
+  if (remaining_triangles == 0) {
+    // The vertex isn't used by any other triangles.
+    return -1.0f;
+  }
+
+  float score = 0.0f;
+  if (cache_position >= 0) {
+    if (cache_position < 3) {
+      // The vertex was used by the last triangle, so a triangle using it alone
+      // gains little.
+      score = kForsythLastTriangleScore;
+    } else {
+      const float scale = 1.0f / static_cast<float>(kForsythCacheSize - 3);
+      score = std::pow(1.0f - static_cast<float>(cache_position - 3) * scale,
+                       kForsythCacheDecayPower);
+    }
+  }
+
+  // Favor vertices with few remaining triangles so that they're finished off
+  // rather than left as lone triangles at the end.
+  score += kForsythValenceBoostScale *
+           std::pow(static_cast<float>(remaining_triangles),
+                    -kForsythValenceBoostPower);
+  return score;
+}
+
+// Simulates a FIFO post-transform vertex cache.
+class FifoCache {
+ public:
+  FifoCache(size_t num_vertices, size_t cache_size)
+      : timestamps_(num_vertices, 0),
+        cache_size_(cache_size),
+        time_(cache_size + 1) {}
+
+  // Adds the vertices of |triangle| to the cache and returns the number of
+  // them that were not already cached.
+  int AddTriangle(const uint32_t* triangle) {
+    int misses = 0;
+    for (int i = 0; i < 3; ++i) {
+      size_t& timestamp = timestamps_[triangle[i]];
+      if (time_ - timestamp > cache_size_) {
+        timestamp = time_;
+        ++time_;
+        ++misses;
+      }
+    }
+    return misses;
+  }
+
+  // Evicts all vertices from the cache.
+  void Clear() { time_ += cache_size_ + 1; }
+
+ private:
+  std::vector<size_t> timestamps_;
+  const size_t cache_size_;
+  size_t time_;
+};
+
+mathfu::vec3 GetPosition(const uint8_t* positions, size_t position_stride,
+                         uint32_t index) {
+  const float* position =
+      reinterpret_cast<const float*>(positions + index * position_stride);
+  return mathfu::vec3(position[0], position[1], position[2]);
+}
+
+}  // namespace
+
+float CalculateAcmr(const uint32_t* indices, size_t num_indices,
+                    size_t cache_size) {
+  const size_t num_triangles = num_indices / 3;
+  if (num_triangles == 0 || cache_size == 0) {
+    return 0.0f;
+  }
+
+  const uint32_t max_index = *std::max_element(indices, indices + num_indices);
+  FifoCache cache(static_cast<size_t>(max_index) + 1, cache_size);
+  size_t misses = 0;
+  for (size_t i = 0; i < num_triangles; ++i) {
+    misses += cache.AddTriangle(&indices[i * 3]);
+  }
+  return static_cast<float>(misses) / static_cast<float>(num_triangles);
+}
+
+void OptimizeVertexCache(uint32_t* indices, size_t num_indices,
+                         size_t num_vertices) {
+  const size_t num_triangles = num_indices / 3;
+  if (num_triangles < 2 ||
+      !ValidateIndices(indices, num_indices, num_vertices)) {
+    return;
+  }
+
+  // Build the lists of triangles that use each vertex.  The first
+  // |remaining_triangles[vertex]| entries of each list are the triangles that
+  // haven't been emitted yet.
+  std::vector<uint32_t> remaining_triangles(num_vertices, 0);
+  for (size_t i = 0; i < num_indices; ++i) {
+    ++remaining_triangles[indices[i]];
+  }
+  std::vector<uint32_t> offsets(num_vertices + 1, 0);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    offsets[i + 1] = offsets[i] + remaining_triangles[i];
+  }
+  std::vector<uint32_t> vertex_triangles(num_indices);
+  std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+  for (size_t i = 0; i < num_indices; ++i) {
+    vertex_triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+  }
+
+  std::vector<int> cache_positions(num_vertices, -1);
+  std::vector<float> vertex_scores(num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    vertex_scores[i] = ForsythVertexScore(-1, remaining_triangles[i]);
+  }
+  std::vector<float> triangle_scores(num_triangles);
+  for (size_t i = 0; i < num_triangles; ++i) {
+    const uint32_t* triangle = &indices[i * 3];
+    triangle_scores[i] = vertex_scores[triangle[0]] +
+                         vertex_scores[triangle[1]] +
+                         vertex_scores[triangle[2]];
+  }
+  std::vector<bool> emitted(num_triangles, false);
+
+  std::vector<uint32_t> output;
+  output.reserve(num_indices);
+  std::vector<uint32_t> cache;
+  std::vector<uint32_t> next_cache;
+  cache.reserve(kForsythCacheSize + 3);
+  next_cache.reserve(kForsythCacheSize + 3);
+
+  uint32_t best_triangle = static_cast<uint32_t>(
+      std::max_element(triangle_scores.begin(), triangle_scores.end()) -
+      triangle_scores.begin());
+  size_t next_unemitted = 0;
+  while (best_triangle != kInvalidIndex) {
+    emitted[best_triangle] = true;
+    const uint32_t* triangle = &indices[best_triangle * 3];
+    output.insert(output.end(), triangle, triangle + 3);
+
+    // Remove the triangle from the remaining triangles of its vertices.
+    for (int i = 0; i < 3; ++i) {
+      const uint32_t vertex = triangle[i];
+      uint32_t* begin = &vertex_triangles[offsets[vertex]];
+      uint32_t* end = begin + remaining_triangles[vertex];
+      uint32_t* iter = std::find(begin, end, best_triangle);
+      DCHECK(iter != end);
+      std::swap(*iter, *(end - 1));
+      --remaining_triangles[vertex];
+    }
+
+    // Move the triangle's vertices to the front of the cache.
+    next_cache.clear();
+    for (int i = 0; i < 3; ++i) {
+      if (std::find(next_cache.begin(), next_cache.end(), triangle[i]) ==
+          next_cache.end()) {
+        next_cache.push_back(triangle[i]);
+      }
+    }
+    for (const uint32_t vertex : cache) {
+      if (std::find(triangle, triangle + 3, vertex) == triangle + 3) {
+        next_cache.push_back(vertex);
+      }
+    }
+
+    // Rescore the vertices whose cache position changed, including those that
+    // were just evicted, and pick the best triangle that uses any of them.
+    for (size_t i = 0; i < next_cache.size(); ++i) {
+      const uint32_t vertex = next_cache[i];
+      const int position = static_cast<int>(i) < kForsythCacheSize
+                               ? static_cast<int>(i)
+                               : -1;
+      cache_positions[vertex] = position;
+      vertex_scores[vertex] =
+          ForsythVertexScore(position, remaining_triangles[vertex]);
+    }
+    best_triangle = kInvalidIndex;
+    float best_score = -1.0f;
+    for (const uint32_t vertex : next_cache) {
+      const uint32_t begin = offsets[vertex];
+      const uint32_t end = begin + remaining_triangles[vertex];
+      for (uint32_t i = begin; i < end; ++i) {
+        const uint32_t index = vertex_triangles[i];
+        const uint32_t* other = &indices[index * 3];
+        const float score = vertex_scores[other[0]] +
+                            vertex_scores[other[1]] + vertex_scores[other[2]];
+        triangle_scores[index] = score;
+        if (score > best_score) {
+          best_score = score;
+          best_triangle = index;
+        }
+      }
+    }
+    if (next_cache.size() > static_cast<size_t>(kForsythCacheSize)) {
+      next_cache.resize(kForsythCacheSize);
+    }
+    cache.swap(next_cache);
+
+    // If none of the cached vertices have triangles left, continue with any
+    // remaining triangle.
+    if (best_triangle == kInvalidIndex) {
+      while (next_unemitted < num_triangles && emitted[next_unemitted]) {
+        ++next_unemitted;
+      }
+      if (next_unemitted < num_triangles) {
+        best_triangle = static_cast<uint32_t>(next_unemitted);
+      }
+    }
+  }
+
+  std::copy(output.begin(), output.end(), indices);
+}
+
+void OptimizeOverdraw(uint32_t* indices, size_t num_indices,
+                      const uint8_t* positions, size_t position_stride,
+                      size_t num_vertices, float threshold) {
+  const size_t num_triangles = num_indices / 3;
+  if (num_triangles < 2 ||
+      !ValidateIndices(indices, num_indices, num_vertices)) {
+    return;
+  }
+  if (positions == nullptr) {
+    LOG(DFATAL) << "Overdraw optimization requires vertex positions.";
+    return;
+  }
+
+  // Triangles that miss the cache for all of their vertices start a new run
+  // of triangles (a hard boundary), so the order before them doesn't matter.
+  FifoCache cache(num_vertices, kDefaultVertexCacheSize);
+  std::vector<size_t> hard_boundaries = {0};
+  cache.AddTriangle(indices);
+  for (size_t i = 1; i < num_triangles; ++i) {
+    if (cache.AddTriangle(&indices[i * 3]) == 3) {
+      hard_boundaries.push_back(i);
+    }
+  }
+  hard_boundaries.push_back(num_triangles);
+
+  // Split the runs further wherever the triangles so far have a cache miss
+  // ratio within the threshold of the whole run, since starting over with an
+  // empty cache there costs little.
+  std::vector<size_t> clusters;
+  for (size_t i = 0; i + 1 < hard_boundaries.size(); ++i) {
+    const size_t start = hard_boundaries[i];
+    const size_t end = hard_boundaries[i + 1];
+
+    cache.Clear();
+    size_t misses = 0;
+    for (size_t j = start; j < end; ++j) {
+      misses += cache.AddTriangle(&indices[j * 3]);
+    }
+    const float run_threshold = threshold * static_cast<float>(misses) /
+                                static_cast<float>(end - start);
+
+    cache.Clear();
+    misses = 0;
+    size_t cluster_start = start;
+    clusters.push_back(cluster_start);
+    for (size_t j = start; j + 1 < end; ++j) {
+      misses += cache.AddTriangle(&indices[j * 3]);
+      const float acmr = static_cast<float>(misses) /
+                         static_cast<float>(j + 1 - cluster_start);
+      if (acmr <= run_threshold) {
+        cache.Clear();
+        misses = 0;
+        cluster_start = j + 1;
+        clusters.push_back(cluster_start);
+      }
+    }
+  }
+  clusters.push_back(num_triangles);
+
+  // Compute the area-weighted centroid and normal of each cluster.
+  struct Cluster {
+    size_t start;
+    size_t end;
+    mathfu::vec3 centroid;
+    mathfu::vec3 normal;
+    float sort_key;
+  };
+  std::vector<Cluster> cluster_infos(clusters.size() - 1);
+  mathfu::vec3 mesh_centroid = mathfu::kZeros3f;
+  float mesh_area = 0.0f;
+  for (size_t i = 0; i < cluster_infos.size(); ++i) {
+    Cluster& cluster = cluster_infos[i];
+    cluster.start = clusters[i];
+    cluster.end = clusters[i + 1];
+    cluster.centroid = mathfu::kZeros3f;
+    cluster.normal = mathfu::kZeros3f;
+
+    float cluster_area = 0.0f;
+    for (size_t j = cluster.start; j < cluster.end; ++j) {
+      const uint32_t* triangle = &indices[j * 3];
+      const mathfu::vec3 p0 =
+          GetPosition(positions, position_stride, triangle[0]);
+      const mathfu::vec3 p1 =
+          GetPosition(positions, position_stride, triangle[1]);
+      const mathfu::vec3 p2 =
+          GetPosition(positions, position_stride, triangle[2]);
+      const mathfu::vec3 normal = mathfu::vec3::CrossProduct(p1 - p0, p2 - p0);
+      const float area = normal.Length();
+      cluster.centroid += area * (p0 + p1 + p2) / 3.0f;
+      cluster.normal += normal;
+      cluster_area += area;
+    }
+    mesh_centroid += cluster.centroid;
+    mesh_area += cluster_area;
+    if (cluster_area > 0.0f) {
+      cluster.centroid /= cluster_area;
+    }
+  }
+  if (mesh_area > 0.0f) {
+    mesh_centroid /= mesh_area;
+  }
+
+  // Draw the clusters that face furthest away from the center first.
+  for (Cluster& cluster : cluster_infos) {
+    const float length = cluster.normal.Length();
+    cluster.sort_key =
+        length > 0.0f ? mathfu::vec3::DotProduct(
+                            cluster.centroid - mesh_centroid,
+                            cluster.normal / length)
+                      : 0.0f;
+  }
+  std::stable_sort(cluster_infos.begin(), cluster_infos.end(),
+                   [](const Cluster& lhs, const Cluster& rhs) {
+                     return lhs.sort_key > rhs.sort_key;
+                   });
+
+  std::vector<uint32_t> output;
+  output.reserve(num_indices);
+  for (const Cluster& cluster : cluster_infos) {
+    output.insert(output.end(), indices + cluster.start * 3,
+                  indices + cluster.end * 3);
+  }
+  std::copy(output.begin(), output.end(), indices);
+}
+
+std::vector<uint32_t> OptimizeVertexFetch(uint32_t* indices, size_t num_indices,
+                                          size_t num_vertices) {
+  std::vector<uint32_t> remap(num_vertices, kInvalidIndex);
+  if (!ValidateIndices(indices, num_indices, num_vertices)) {
+    for (size_t i = 0; i < num_vertices; ++i) {
+      remap[i] = static_cast<uint32_t>(i);
+    }
+    return remap;
+  }
+
+  uint32_t next_index = 0;
+  for (size_t i = 0; i < num_indices; ++i) {
+    uint32_t& new_index = remap[indices[i]];
+    if (new_index == kInvalidIndex) {
+      new_index = next_index++;
+    }
+    indices[i] = new_index;
+  }
+  for (uint32_t& new_index : remap) {
+    if (new_index == kInvalidIndex) {
+      new_index = next_index++;
+    }
+  }
+  return remap;
+}
+
+}  // namespace lull
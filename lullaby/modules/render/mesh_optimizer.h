@@ -0,0 +1,73 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_RENDER_MESH_OPTIMIZER_H_
+#define LULLABY_MODULES_RENDER_MESH_OPTIMIZER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace lull {
+
+// The functions here reorder indexed triangle lists so that the GPU transforms
+// fewer vertices and shades fewer hidden fragments.  They only depend on the
+// index data (and vertex positions for overdraw) so that they can be shared by
+// runtime mesh generation and the offline model pipeline.  The passes are meant
+// to be run in the order they are declared:
+// 1. OptimizeVertexCache
+// 2. OptimizeOverdraw
+// 3. OptimizeVertexFetch
+
+// The size of the FIFO post-transform cache used to measure and tune the
+// triangle order.  Most mobile GPUs have a cache of at least this size.
+constexpr size_t kDefaultVertexCacheSize = 16;
+
+// Returns the average cache miss ratio (ACMR) of the triangle list |indices|,
+// ie. the number of vertices transformed per triangle, for a FIFO vertex cache
+// with |cache_size| entries.  The ratio is between 0.5 (for a large regular
+// grid) and 3 (when no vertices are shared).
+float CalculateAcmr(const uint32_t* indices, size_t num_indices,
+                    size_t cache_size = kDefaultVertexCacheSize);
+
+// Reorders the triangles in |indices| in-place to improve their locality in the
+// post-transform vertex cache, using Tom Forsyth's linear-speed algorithm.  All
+// indices must be less than |num_vertices|.
+void OptimizeVertexCache(uint32_t* indices, size_t num_indices,
+                         size_t num_vertices);
+
+// Reorders clusters of triangles in |indices| in-place so that triangles facing
+// away from the mesh's center, which are the most likely to occlude others, are
+// drawn first (Sander et al., "Fast Triangle Reordering for Vertex Locality and
+// Reduced Overdraw").  Clusters are split only where doing so keeps the ACMR
+// within |threshold| times that of the input order, so this should be run after
+// OptimizeVertexCache.  |positions| points to |num_vertices| vec3 floats spaced
+// |position_stride| bytes apart.
+void OptimizeOverdraw(uint32_t* indices, size_t num_indices,
+                      const uint8_t* positions, size_t position_stride,
+                      size_t num_vertices, float threshold = 1.05f);
+
+// Renumbers the vertices in the order that they are first referenced by
+// |indices|, which are updated in-place, so that vertex fetches walk through
+// memory sequentially.  Unreferenced vertices are moved to the end, keeping
+// their relative order.  Returns the remapping table, where the vertex at
+// |index| should be moved to |remap[index]|.
+std::vector<uint32_t> OptimizeVertexFetch(uint32_t* indices, size_t num_indices,
+                                          size_t num_vertices);
+
+}  // namespace lull
+
+#endif  // LULLABY_MODULES_RENDER_MESH_OPTIMIZER_H_
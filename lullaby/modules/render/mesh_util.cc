@@ -16,8 +16,11 @@ limitations under the License.
 
 #include "lullaby/modules/render/mesh_util.h"
 
+#include <string.h>
+#include <algorithm>
 #include <array>
 
+#include "lullaby/modules/render/mesh_optimizer.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/util/math.h"
 #include "mathfu/glsl_mappings.h"
@@ -25,6 +28,11 @@ limitations under the License.
 namespace lull {
 
 void ApplyDeformation(MeshData* mesh, const PositionDeformation& deform) {
+  ApplyDeformation(mesh, 0, mesh->GetNumVertices(), deform);
+}
+
+void ApplyDeformation(MeshData* mesh, size_t begin_vertex, size_t end_vertex,
+                      const PositionDeformation& deform) {
   const VertexFormat& format = mesh->GetVertexFormat();
   const VertexAttribute* position =
       format.GetAttributeWithUsage(VertexAttributeUsage_Position);
@@ -42,12 +50,15 @@ void ApplyDeformation(MeshData* mesh, const PositionDeformation& deform) {
   // Formats are always padded out to 4 bytes, so this is safe.
   DCHECK_EQ(format.GetVertexSize() % sizeof(float), 0);
   const size_t stride_in_floats = format.GetVertexSize() / sizeof(float);
-  const size_t length_in_floats = mesh->GetNumVertices() * stride_in_floats;
+  end_vertex =
+      std::min(end_vertex, static_cast<size_t>(mesh->GetNumVertices()));
+  const size_t begin_in_floats = begin_vertex * stride_in_floats;
+  const size_t end_in_floats = end_vertex * stride_in_floats;
 
   DCHECK_EQ(format.GetAttributeOffset(position) % sizeof(float), 0);
   vertex_data += format.GetAttributeOffset(position) / sizeof(float);
 
-  for (size_t i = 0; i < length_in_floats; i += stride_in_floats) {
+  for (size_t i = begin_in_floats; i < end_in_floats; i += stride_in_floats) {
     const mathfu::vec3 original_position(vertex_data[i], vertex_data[i + 1],
                                          vertex_data[i + 2]);
     const mathfu::vec3 deformed_position = deform(original_position);
@@ -57,6 +68,74 @@ void ApplyDeformation(MeshData* mesh, const PositionDeformation& deform) {
   }
 }
 
+bool OptimizeMesh(MeshData* mesh) {
+  const size_t num_indices = mesh->GetNumIndices();
+  if (mesh->GetPrimitiveType() != MeshData::kTriangles || num_indices == 0) {
+    return false;
+  }
+
+  uint8_t* vertex_bytes = mesh->GetMutableVertexBytes();
+  uint8_t* index_bytes = mesh->GetMutableIndexBytes();
+  if (!vertex_bytes || !index_bytes) {
+    LOG(DFATAL) << "Can't optimize mesh without read+write";
+    return false;
+  }
+
+  // Work on 32-bit indices regardless of the mesh's index type.
+  const bool is_u16 = mesh->GetIndexType() == MeshData::kIndexU16;
+  std::vector<uint32_t> indices(num_indices);
+  if (is_u16) {
+    const uint16_t* src = reinterpret_cast<const uint16_t*>(index_bytes);
+    std::copy(src, src + num_indices, indices.begin());
+  } else {
+    memcpy(indices.data(), index_bytes, num_indices * sizeof(uint32_t));
+  }
+
+  const VertexFormat& format = mesh->GetVertexFormat();
+  const size_t vertex_size = format.GetVertexSize();
+  const size_t num_vertices = mesh->GetNumVertices();
+  const VertexAttribute* position =
+      format.GetAttributeWithUsage(VertexAttributeUsage_Position);
+  const uint8_t* positions =
+      position && position->type() == VertexAttributeType_Vec3f
+          ? vertex_bytes + format.GetAttributeOffset(position)
+          : nullptr;
+
+  // Triangles are only reordered within their submesh.
+  for (uint32_t i = 0; i < mesh->GetNumSubMeshes(); ++i) {
+    const MeshData::IndexRange range = mesh->GetSubMesh(i);
+    if (range.end <= range.start || range.end > num_indices) {
+      continue;
+    }
+    uint32_t* submesh_indices = indices.data() + range.start;
+    const size_t count = range.end - range.start;
+    OptimizeVertexCache(submesh_indices, count, num_vertices);
+    if (positions) {
+      OptimizeOverdraw(submesh_indices, count, positions, vertex_size,
+                       num_vertices);
+    }
+  }
+
+  const std::vector<uint32_t> remap =
+      OptimizeVertexFetch(indices.data(), num_indices, num_vertices);
+  const std::vector<uint8_t> old_vertices(
+      vertex_bytes, vertex_bytes + num_vertices * vertex_size);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    memcpy(vertex_bytes + remap[i] * vertex_size,
+           old_vertices.data() + i * vertex_size, vertex_size);
+  }
+
+  if (is_u16) {
+    uint16_t* dst = reinterpret_cast<uint16_t*>(index_bytes);
+    for (size_t i = 0; i < num_indices; ++i) {
+      dst[i] = static_cast<uint16_t>(indices[i]);
+    }
+  } else {
+    memcpy(index_bytes, indices.data(), num_indices * sizeof(uint32_t));
+  }
+  return true;
+}
+
 MeshData CreateLatLonSphere(float radius, int num_parallels,
                             int num_meridians) {
   CHECK_GE(num_parallels, 1);
@@ -35,6 +35,19 @@ using PositionDeformation = std::function<mathfu::vec3(const mathfu::vec3&)>;
 // with a DFATAL if |mesh| doesn't have read+write access.
 void ApplyDeformation(MeshData* mesh, const PositionDeformation& deform);
 
+// Deforms only the vertices in [|begin_vertex|, |end_vertex|) of |mesh|.
+// Disjoint ranges of the same mesh may be deformed concurrently.
+void ApplyDeformation(MeshData* mesh, size_t begin_vertex, size_t end_vertex,
+                      const PositionDeformation& deform);
+
+// Reorders the triangles of each submesh of |mesh| in-place to make better use
+// of the post-transform vertex cache and to reduce overdraw, then reorders the
+// vertices in the order they are first used (see mesh_optimizer.h).  Overdraw
+// is only optimized if the mesh has vec3f positions.  Returns false without
+// modifying the mesh if it isn't an indexed triangle list, and fails with a
+// DFATAL if |mesh| doesn't have read+write access.
+bool OptimizeMesh(MeshData* mesh);
+
 // Creates a VertexPT sphere mesh using latitude-longitude tessellation. The
 // sphere will be external-facing unless |radius| is negative. The mesh will
 // always use 32-bit indices. The 'u' texture coordinate tracks longitude; the
@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "lullaby/modules/render/mesh_data.h"
+#include "lullaby/util/data_container_pool.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/util/math.h"
 #include "mathfu/glsl_mappings.h"
@@ -314,10 +315,9 @@ MeshData CreateQuadMesh(float size_x, float size_y, int num_verts_x = 2,
   CHECK_EQ(Vertex::kFormat.GetVertexSize(), sizeof(Vertex));
   MeshData mesh(
       MeshData::kTriangles, Vertex::kFormat,
-      DataContainer::CreateHeapDataContainer(vertices.size() * sizeof(Vertex)),
+      DataContainerPool::Allocate(vertices.size() * sizeof(Vertex)),
       MeshData::kIndexU16,
-      DataContainer::CreateHeapDataContainer(indices.size() *
-                                             sizeof(uint16_t)));
+      DataContainerPool::Allocate(indices.size() * sizeof(uint16_t)));
   mesh.AddVertices(vertices.data(), vertices.size());
   mesh.AddIndices(indices.data(), indices.size());
   return mesh;
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/modules/render/render_view.h"
 
+#include <algorithm>
+
 #include "lullaby/util/math.h"
 
 namespace lull {
@@ -92,9 +94,20 @@ void PopulateRenderView(RenderView* view, const mathfu::recti& viewport,
   view->clip_from_eye_matrix = clip_from_eye_matrix;
   view->clip_from_world_matrix =
       view->clip_from_eye_matrix * view->eye_from_world_matrix;
+  view->has_frustum_planes = false;
   view->eye = eye;
 }
 
+void GetViewFrustum(const RenderView& view,
+                    mathfu::vec4 frustum_clipping_planes[kNumFrustumPlanes]) {
+  if (view.has_frustum_planes) {
+    std::copy(view.frustum_planes, view.frustum_planes + kNumFrustumPlanes,
+              frustum_clipping_planes);
+  } else {
+    CalculateViewFrustum(view.clip_from_world_matrix, frustum_clipping_planes);
+  }
+}
+
 void PopulateRenderViews(Registry* registry, RenderView* views, size_t num,
                          float near_clip_plane, float far_clip_plane) {
   if (!registry) {
@@ -169,6 +182,7 @@ void GenerateEyeCenteredViews(Span<RenderView> views,
     eye_centered_views[index].clip_from_world_matrix =
         views[index].clip_from_eye_matrix *
         eye_centered_views[index].world_from_eye_matrix.Inverse();
+    eye_centered_views[index].has_frustum_planes = false;
   }
 }
 
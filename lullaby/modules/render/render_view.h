@@ -18,6 +18,7 @@ limitations under the License.
 #define LULLABY_MODULES_RENDER_RENDER_VIEW_H_
 
 #include "lullaby/modules/input/input_manager.h"
+#include "lullaby/util/math.h"
 #include "lullaby/util/registry.h"
 #include "lullaby/util/span.h"
 
@@ -43,8 +44,18 @@ struct RenderView {
   /// The eye this view renders to. 0 = left, 1 = right. For monoscopic
   /// rendering leave this at 0.
   InputManager::EyeType eye = 1;
+  /// The world space view frustum planes, precomputed by the Camera that
+  /// populated this view.  Only valid if |has_frustum_planes| is true; use
+  /// GetViewFrustum() rather than reading them directly.
+  mathfu::vec4 frustum_planes[kNumFrustumPlanes];
+  bool has_frustum_planes = false;
 };
 
+// Fills |frustum_clipping_planes| with the world space view frustum planes of
+// |view|, reusing the precomputed planes if it has them.
+void GetViewFrustum(const RenderView& view,
+                    mathfu::vec4 frustum_clipping_planes[kNumFrustumPlanes]);
+
 // Populates a single RenderView with the data provided.
 void PopulateRenderView(RenderView* view, const mathfu::recti& viewport,
                         const mathfu::mat4& world_from_eye_matrix,
@@ -0,0 +1,137 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/render/skyline_packer.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+SkylinePacker::SkylinePacker(const mathfu::vec2i& size) : size_(size) {
+  Reset();
+}
+
+void SkylinePacker::Reset() {
+  // Initially a single segment spans the bottom of the bin.
+  skyline_.clear();
+  skyline_.emplace_back(0, 0, size_.x);
+}
+
+float SkylinePacker::GetOccupancy() const {
+  if (size_.x <= 0 || size_.y <= 0) {
+    return 0.f;
+  }
+  size_t area = 0;
+  for (const Segment& segment : skyline_) {
+    area += static_cast<size_t>(segment.y) * segment.width;
+  }
+  return static_cast<float>(area) / static_cast<float>(size_.x * size_.y);
+}
+
+bool SkylinePacker::Pack(const mathfu::vec2i& size, mathfu::vec2i* out_pos) {
+  if (size.x <= 0 || size.y <= 0 || out_pos == nullptr) {
+    return false;
+  }
+
+  // Pick the segment that places the top of the rectangle lowest, breaking
+  // ties with the narrowest segment to leave wide segments for wide rectangles.
+  size_t best_index = skyline_.size();
+  int best_top = std::numeric_limits<int>::max();
+  int best_width = std::numeric_limits<int>::max();
+  mathfu::vec2i best_pos(0, 0);
+  for (size_t i = 0; i < skyline_.size(); ++i) {
+    int y = 0;
+    if (!Fits(i, size, &y)) {
+      continue;
+    }
+    const int top = y + size.y;
+    const int width = skyline_[i].width;
+    if (top < best_top || (top == best_top && width < best_width)) {
+      best_index = i;
+      best_top = top;
+      best_width = width;
+      best_pos = mathfu::vec2i(skyline_[i].x, y);
+    }
+  }
+  if (best_index == skyline_.size()) {
+    return false;
+  }
+
+  AddSegment(best_index, best_pos, size);
+  *out_pos = best_pos;
+  return true;
+}
+
+bool SkylinePacker::Fits(size_t index, const mathfu::vec2i& size,
+                         int* y) const {
+  if (skyline_[index].x + size.x > size_.x) {
+    return false;
+  }
+
+  // The rectangle may span several segments, in which case it has to be placed
+  // above the highest of them.
+  *y = skyline_[index].y;
+  int width_remaining = size.x;
+  while (width_remaining > 0) {
+    DCHECK_LT(index, skyline_.size());
+    const Segment& segment = skyline_[index];
+    *y = std::max(*y, segment.y);
+    if (*y + size.y > size_.y) {
+      return false;
+    }
+    width_remaining -= segment.width;
+    ++index;
+  }
+  return true;
+}
+
+void SkylinePacker::AddSegment(size_t index, const mathfu::vec2i& pos,
+                               const mathfu::vec2i& size) {
+  DCHECK_EQ(skyline_[index].x, pos.x);
+  skyline_.insert(skyline_.begin() + index,
+                  Segment(pos.x, pos.y + size.y, size.x));
+
+  // The new segment covers the start of the segments to its right, so shrink
+  // them (or remove them if they are completely covered).
+  const int right_edge = pos.x + size.x;
+  size_t next = index + 1;
+  while (next < skyline_.size() && skyline_[next].x < right_edge) {
+    Segment& segment = skyline_[next];
+    const int segment_end = segment.x + segment.width;
+    if (segment_end <= right_edge) {
+      skyline_.erase(skyline_.begin() + next);
+    } else {
+      segment.width = segment_end - right_edge;
+      segment.x = right_edge;
+      break;
+    }
+  }
+
+  // Merge neighbouring segments at the same height.
+  if (next < skyline_.size() && skyline_[next].y == skyline_[index].y) {
+    skyline_[index].width += skyline_[next].width;
+    skyline_.erase(skyline_.begin() + next);
+  }
+  if (index > 0 && skyline_[index - 1].y == skyline_[index].y) {
+    skyline_[index - 1].width += skyline_[index].width;
+    skyline_.erase(skyline_.begin() + index);
+  }
+}
+
+}  // namespace lull
@@ -0,0 +1,80 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_RENDER_SKYLINE_PACKER_H_
+#define LULLABY_MODULES_RENDER_SKYLINE_PACKER_H_
+
+#include <stddef.h>
+#include <vector>
+
+#include "mathfu/glsl_mappings.h"
+
+namespace lull {
+
+// Packs rectangles into a fixed size bin using the skyline bottom-left
+// algorithm, which is fast and works well for many similarly sized rectangles
+// (eg. icons being added to a texture atlas).
+//
+// Rectangles are placed as low as possible, then as far left as possible.  The
+// packer only tracks the "skyline" across the top of the placed rectangles, so
+// individual rectangles cannot be removed; instead the whole bin is Reset.
+class SkylinePacker {
+ public:
+  explicit SkylinePacker(const mathfu::vec2i& size);
+
+  // Finds space for a rectangle of |size| and reserves it.  Returns true and
+  // sets |out_pos| to the rectangle's minimum corner on success, or returns
+  // false if the rectangle does not fit.
+  bool Pack(const mathfu::vec2i& size, mathfu::vec2i* out_pos);
+
+  // Removes all rectangles from the bin.
+  void Reset();
+
+  // Returns the size of the bin.
+  const mathfu::vec2i& GetSize() const { return size_; }
+
+  // Returns the fraction of the bin which is below the skyline, ie. which is
+  // either used or wasted.
+  float GetOccupancy() const;
+
+ private:
+  // A horizontal segment of the skyline.  There are no rectangles above it, and
+  // the space just below it is occupied, though there may be gaps further down.
+  struct Segment {
+    Segment(int x, int y, int width) : x(x), y(y), width(width) {}
+
+    int x = 0;
+    int y = 0;
+    int width = 0;
+  };
+
+  // Returns true if a rectangle of |size| fits over the skyline starting at the
+  // segment at |index|, and sets |y| to the height at which it would be placed.
+  bool Fits(size_t index, const mathfu::vec2i& size, int* y) const;
+
+  // Adds a segment for a rectangle of |size| placed at |pos| over the segment
+  // at |index|, trimming or removing the segments it covers.
+  void AddSegment(size_t index, const mathfu::vec2i& pos,
+                  const mathfu::vec2i& size);
+
+  mathfu::vec2i size_;
+  // Sorted from left to right, covering the whole width of the bin.
+  std::vector<Segment> skyline_;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_MODULES_RENDER_SKYLINE_PACKER_H_
@@ -0,0 +1,166 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/render/tangent_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <vector>
+
+#include "lullaby/util/filename.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+namespace {
+constexpr uint32_t kTangentCacheMagic = 0x4c54414e;  // 'LTAN'
+// Bump this whenever the tangent generation algorithm changes to invalidate
+// the existing entries.
+constexpr uint32_t kTangentCacheVersion = 1;
+constexpr size_t kTangentSize = sizeof(float) * 4;
+
+struct TangentCacheHeader {
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint32_t key = 0;
+  uint32_t vertex_count = 0;
+};
+
+// FNV-1a over raw bytes.  Hash() treats its input as a string, so it cannot be
+// used for binary data which may contain zeros.
+HashValue HashBytes(HashValue hash, const uint8_t* bytes, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * kHashPrimeMultiplier;
+  }
+  return hash;
+}
+
+HashValue HashStrided(HashValue hash, const uint8_t* data, size_t stride,
+                      size_t element_size, size_t count) {
+  if (data == nullptr) {
+    return hash;
+  }
+  if (stride == element_size) {
+    return HashBytes(hash, data, element_size * count);
+  }
+  for (size_t i = 0; i < count; ++i) {
+    hash = HashBytes(hash, data + i * stride, element_size);
+  }
+  return hash;
+}
+}  // namespace
+
+TangentCache::TangentCache(std::string directory)
+    : directory_(std::move(directory)) {}
+
+HashValue TangentCache::GetKey(const uint8_t* positions,
+                               size_t position_stride, const uint8_t* normals,
+                               size_t normal_stride, const uint8_t* tex_coords,
+                               size_t tex_coord_stride, size_t vertex_count,
+                               const uint8_t* triangle_indices,
+                               size_t sizeof_index, size_t triangle_count) {
+  HashValue key = HashCombine(kHashOffsetBasis, kTangentCacheVersion);
+  key = HashCombine(key, static_cast<HashValue>(vertex_count));
+  key = HashCombine(key, static_cast<HashValue>(triangle_count));
+  key = HashStrided(key, positions, position_stride, sizeof(float) * 3,
+                    vertex_count);
+  key = HashStrided(key, normals, normal_stride, sizeof(float) * 3,
+                    vertex_count);
+  key = HashStrided(key, tex_coords, tex_coord_stride, sizeof(float) * 2,
+                    vertex_count);
+  if (triangle_indices) {
+    key = HashCombine(key, static_cast<HashValue>(sizeof_index));
+    key = HashBytes(key, triangle_indices, sizeof_index * 3 * triangle_count);
+  }
+  return key;
+}
+
+std::string TangentCache::GetPath(HashValue key) const {
+  char name[32];
+  snprintf(name, sizeof(name), "%08x.lulltangents", key);
+  return JoinPath(directory_, name);
+}
+
+bool TangentCache::Load(HashValue key, size_t vertex_count, uint8_t* tangents,
+                        size_t tangent_stride) const {
+  const std::string path = GetPath(key);
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  TangentCacheHeader header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file || header.magic != kTangentCacheMagic ||
+      header.version != kTangentCacheVersion || header.key != key ||
+      header.vertex_count != vertex_count) {
+    LOG(INFO) << "Discarding cached tangents: " << path;
+    file.close();
+    remove(path.c_str());
+    return false;
+  }
+
+  std::vector<uint8_t> data(vertex_count * kTangentSize);
+  file.read(reinterpret_cast<char*>(data.data()), data.size());
+  if (!file) {
+    LOG(INFO) << "Discarding cached tangents: " << path;
+    file.close();
+    remove(path.c_str());
+    return false;
+  }
+
+  for (size_t i = 0; i < vertex_count; ++i) {
+    memcpy(tangents + i * tangent_stride, data.data() + i * kTangentSize,
+           kTangentSize);
+  }
+  return true;
+}
+
+void TangentCache::Save(HashValue key, size_t vertex_count,
+                        const uint8_t* tangents, size_t tangent_stride) {
+  std::vector<uint8_t> data(vertex_count * kTangentSize);
+  for (size_t i = 0; i < vertex_count; ++i) {
+    memcpy(data.data() + i * kTangentSize, tangents + i * tangent_stride,
+           kTangentSize);
+  }
+
+  TangentCacheHeader header;
+  header.magic = kTangentCacheMagic;
+  header.version = kTangentCacheVersion;
+  header.key = key;
+  header.vertex_count = static_cast<uint32_t>(vertex_count);
+
+  // Write to a temporary file first so that an interrupted write never leaves
+  // truncated tangents behind.
+  const std::string path = GetPath(key);
+  const std::string temp_path = path + ".tmp";
+  std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(data.data()), data.size());
+  file.close();
+  if (!file) {
+    LOG(WARNING) << "Failed to write tangents: " << temp_path;
+    remove(temp_path.c_str());
+    return;
+  }
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to store tangents: " << path;
+    remove(temp_path.c_str());
+  }
+}
+
+}  // namespace lull
@@ -0,0 +1,75 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_RENDER_TANGENT_CACHE_H_
+#define LULLABY_MODULES_RENDER_TANGENT_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "lullaby/util/hash.h"
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+// Stores tangents generated at runtime (see tangent_generation.h) on disk so
+// that subsequent loads of the same mesh can skip generating them.
+//
+// Tangents are keyed by a hash of the content they are generated from, so an
+// edited mesh naturally misses the cache.  Only the vec4 tangents are stored;
+// bitangents can be recovered from the normal and the tangent's handedness.
+//
+// Add a TangentCache to the Registry to have assets (such as GltfAssets) use
+// it when they need to generate tangents.
+class TangentCache {
+ public:
+  // Creates a cache that stores tangents in |directory|, which must already
+  // exist and be writable.
+  explicit TangentCache(std::string directory);
+
+  TangentCache(const TangentCache&) = delete;
+  TangentCache& operator=(const TangentCache&) = delete;
+
+  // Returns the key for the tangents generated from the given vertex data and
+  // triangles.  The arguments match ComputeTangentsWithIndexedTriangles();
+  // |triangle_indices| may be null for unindexed triangles.
+  static HashValue GetKey(const uint8_t* positions, size_t position_stride,
+                          const uint8_t* normals, size_t normal_stride,
+                          const uint8_t* tex_coords, size_t tex_coord_stride,
+                          size_t vertex_count, const uint8_t* triangle_indices,
+                          size_t sizeof_index, size_t triangle_count);
+
+  // Copies the |vertex_count| tangents stored for |key| into |tangents|.
+  // Returns false if there are none, in which case |tangents| is unchanged.
+  bool Load(HashValue key, size_t vertex_count, uint8_t* tangents,
+            size_t tangent_stride) const;
+
+  // Stores the |vertex_count| |tangents| for |key|.
+  void Save(HashValue key, size_t vertex_count, const uint8_t* tangents,
+            size_t tangent_stride);
+
+ private:
+  std::string GetPath(HashValue key) const;
+
+  std::string directory_;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::TangentCache);
+
+#endif  // LULLABY_MODULES_RENDER_TANGENT_CACHE_H_
@@ -113,6 +113,12 @@ size_t VertexFormat::GetAttributeSize(const VertexAttribute& attr) {
       return 4 * sizeof(float);
     case VertexAttributeType_Vec2us:
       return 2 * sizeof(uint16_t);
+    case VertexAttributeType_Vec4us:
+      return 4 * sizeof(uint16_t);
+    case VertexAttributeType_Vec2hf:
+      return 2 * sizeof(uint16_t);
+    case VertexAttributeType_Vec4hf:
+      return 4 * sizeof(uint16_t);
     case VertexAttributeType_Vec4ub:
       return 4 * sizeof(uint8_t);
     case VertexAttributeType_Empty:
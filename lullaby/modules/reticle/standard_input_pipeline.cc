@@ -27,6 +27,7 @@ limitations under the License.
 #include "lullaby/modules/script/function_binder.h"
 #include "lullaby/contrib/cursor/cursor_system.h"
 #include "lullaby/contrib/input_behavior/input_behavior_system.h"
+#include "lullaby/systems/render/render_picker.h"
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/device_util.h"
 #include "lullaby/util/math.h"
@@ -34,10 +35,27 @@ limitations under the License.
 #include "mathfu/constants.h"
 
 namespace lull {
+namespace {
+
+// By default, a ray can move by 1mm or turn by ~0.06 degrees and still reuse
+// the previous hit.
+constexpr float kDefaultCoherenceDistance = 0.001f;
+constexpr float kDefaultCoherenceAngle = 0.001f;
+
+void ApplyCollision(const CollisionSystem::CollisionResult& collision,
+                    InputFocus* focus) {
+  focus->target = collision.entity;
+  focus->cursor_position = focus->collision_ray.origin +
+                           focus->collision_ray.direction * collision.distance;
+}
+
+}  // namespace
 
 StandardInputPipeline::StandardInputPipeline(Registry* registry) {
   registry_ = registry;
   device_preference_ = {InputManager::kController, InputManager::kHmd};
+  coherence_distance_ = kDefaultCoherenceDistance;
+  coherence_angle_ = kDefaultCoherenceAngle;
   auto* input_processor = registry_->Get<InputProcessor>();
   if (input_processor) {
     // Set up the standard prefixes for Input events.
@@ -119,28 +137,46 @@ InputFocus StandardInputPipeline::ComputeInputFocus(
     const Clock::duration& delta_time, InputManager::DeviceType device) const {
   InputFocus focus;
   focus.device = device;
+  if (!InitFocus(&focus)) {
+    return focus;
+  }
+
+  // Apply focus locking, input behaviors, collision detection, etc
+  ApplySystemsToInputFocus(&focus);
+
+  return focus;
+}
+
+std::vector<InputFocus> StandardInputPipeline::ComputeInputFoci(
+    const Clock::duration& delta_time,
+    Span<InputManager::DeviceType> devices) const {
+  std::vector<InputFocus> foci(devices.size());
+  std::vector<InputFocus*> initialized_foci;
+  initialized_foci.reserve(devices.size());
+  for (size_t i = 0; i < devices.size(); ++i) {
+    foci[i].device = devices[i];
+    if (InitFocus(&foci[i])) {
+      initialized_foci.push_back(&foci[i]);
+    }
+  }
 
+  ApplySystemsToInputFoci(initialized_foci);
+  return foci;
+}
+
+bool StandardInputPipeline::InitFocus(InputFocus* focus) const {
   auto* input_manager = registry_->Get<InputManager>();
-  const DeviceProfile* profile = input_manager->GetDeviceProfile(device);
+  const DeviceProfile* profile = input_manager->GetDeviceProfile(focus->device);
   bool is_touchscreen = false;
   if (profile) {
     is_touchscreen = profile->type == DeviceProfile::kTouchScreen;
   }
 
   if (is_touchscreen) {
-    if (!InitFocusForTouchScreen(&focus)) {
-      return focus;
-    }
+    return InitFocusForTouchScreen(focus);
   } else {
-    if (!InitFocusForController(&focus)) {
-      return focus;
-    }
+    return InitFocusForController(focus);
   }
-
-  // Apply focus locking, input behaviors, collision detection, etc
-  ApplySystemsToInputFocus(&focus);
-
-  return focus;
 }
 
 void StandardInputPipeline::MaybeMakeRayComeFromHmd(InputFocus* focus) const {
@@ -186,28 +222,40 @@ void StandardInputPipeline::ApplySystemsToInputFocus(InputFocus* focus) const {
     return;
   }
 
+  ApplySystemsToInputFoci(Span<InputFocus*>(&focus, 1));
+}
+
+void StandardInputPipeline::ApplySystemsToInputFoci(
+    Span<InputFocus*> foci) const {
   const auto* collision_system = registry_->Get<CollisionSystem>();
   const auto* input_behavior_system = registry_->Get<InputBehaviorSystem>();
   auto* input_focus_locker = registry_->Get<InputFocusLocker>();
 
   // Check if focus is locked to an entity.
-  bool locked = false;
-  if (input_focus_locker) {
-    locked = input_focus_locker->UpdateInputFocus(focus);
+  unlocked_foci_.clear();
+  for (InputFocus* focus : foci) {
+    bool locked = false;
+    if (input_focus_locker) {
+      locked = input_focus_locker->UpdateInputFocus(focus);
+    }
+    if (!locked) {
+      unlocked_foci_.push_back(focus);
+    }
   }
 
   // If focus isn't locked, try to collide against AABBs in the world.
-  if (!locked) {
-    ApplyCollisionSystemToInputFocus(focus);
-  }
+  ApplyCollisionSystemToInputFoci(unlocked_foci_);
 
-  // Apply input behaviors:
-  if (input_behavior_system && focus->target != kNullEntity) {
-    input_behavior_system->UpdateInputFocus(focus);
-  }
+  for (InputFocus* focus : foci) {
+    // Apply input behaviors:
+    if (input_behavior_system && focus->target != kNullEntity) {
+      input_behavior_system->UpdateInputFocus(focus);
+    }
 
-  if (collision_system) {
-    focus->interactive = collision_system->IsInteractionEnabled(focus->target);
+    if (collision_system) {
+      focus->interactive =
+          collision_system->IsInteractionEnabled(focus->target);
+    }
   }
 }
 
@@ -218,20 +266,109 @@ void StandardInputPipeline::ApplyCollisionSystemToInputFocus(
     return;
   }
 
-  CollisionSystem::CollisionResult collision = {kNullEntity, kNoHitDistance};
-  const auto* collision_system = registry_->Get<CollisionSystem>();
+  ApplyCollisionSystemToInputFoci(Span<InputFocus*>(&focus, 1));
+}
+
+void StandardInputPipeline::ApplyCollisionSystemToInputFoci(
+    Span<InputFocus*> foci) const {
   if (manual_collision_) {
-    collision = *manual_collision_;
-  } else if (collision_system) {
-    collision = collision_system->CheckForCollision(focus->collision_ray);
+    for (InputFocus* focus : foci) {
+      ApplyCollision(*manual_collision_, focus);
+    }
+    return;
+  }
+
+  const auto* collision_system = registry_->Get<CollisionSystem>();
+  auto* render_picker = registry_->Get<RenderPicker>();
+  if ((collision_system == nullptr && render_picker == nullptr) ||
+      foci.empty()) {
+    return;
+  }
+
+  // The primary device is picked on the GPU if there is a RenderPicker.  Its
+  // result is for the ray of a previous frame.  Until a result has been read
+  // back, the ray is cast like the others.
+  const InputManager::DeviceType picked_device =
+      render_picker ? GetPrimaryDevice() : InputManager::kMaxNumDeviceTypes;
+
+  // A ray that barely moved since it was last cast reuses its previous hit if
+  // nothing that can be hit has changed.  The other rays are cast in a single
+  // batch, starting from their previous hits.
+  const uint64_t generation =
+      collision_system ? collision_system->GetCollisionGeneration() : 0;
+  cast_foci_.clear();
+  cast_rays_.clear();
+  cast_results_.clear();
+  for (InputFocus* focus : foci) {
+    if (focus->device == picked_device) {
+      render_picker->SetRay(focus->collision_ray);
+      const RenderPicker::Result picked = render_picker->GetResult();
+      if (picked.valid) {
+        if (picked.entity != kNullEntity) {
+          ApplyCollision({picked.entity, picked.distance}, focus);
+        }
+        continue;
+      }
+    }
+    if (collision_system == nullptr) {
+      continue;
+    }
+
+    const CollisionCache* cache =
+        focus->device < InputManager::kMaxNumDeviceTypes
+            ? &collision_caches_[focus->device]
+            : nullptr;
+    if (cache && cache->valid && cache->generation == generation &&
+        IsNearRay(cache->ray, focus->collision_ray)) {
+      if (cache->result.entity != kNullEntity) {
+        ApplyCollision(cache->result, focus);
+      }
+      continue;
+    }
+
+    cast_foci_.push_back(focus);
+    cast_rays_.push_back(focus->collision_ray);
+    if (cache && cache->valid) {
+      cast_results_.push_back(cache->result);
+    } else {
+      cast_results_.push_back({kNullEntity, kNoHitDistance});
+    }
   }
 
-  if (manual_collision_ || collision.entity != kNullEntity) {
-    focus->target = collision.entity;
-    focus->cursor_position =
-        focus->collision_ray.origin +
-        focus->collision_ray.direction * collision.distance;
+  if (cast_foci_.empty()) {
+    return;
   }
+  collision_system->CheckForCollisions(cast_rays_, cast_results_);
+
+  for (size_t i = 0; i < cast_foci_.size(); ++i) {
+    InputFocus* focus = cast_foci_[i];
+    const CollisionSystem::CollisionResult& collision = cast_results_[i];
+    if (focus->device < InputManager::kMaxNumDeviceTypes) {
+      CollisionCache& cache = collision_caches_[focus->device];
+      cache.ray = focus->collision_ray;
+      cache.result = collision;
+      cache.generation = generation;
+      cache.valid = true;
+    }
+    if (collision.entity != kNullEntity) {
+      ApplyCollision(collision, focus);
+    }
+  }
+}
+
+bool StandardInputPipeline::IsNearRay(const Ray& lhs, const Ray& rhs) const {
+  // For unit directions, the distance between them is about the angle between
+  // them.
+  return (lhs.origin - rhs.origin).LengthSquared() <=
+             coherence_distance_ * coherence_distance_ &&
+         (lhs.direction - rhs.direction).LengthSquared() <=
+             coherence_angle_ * coherence_angle_;
+}
+
+void StandardInputPipeline::SetCollisionCoherence(float max_distance,
+                                                  float max_angle) {
+  coherence_distance_ = max_distance;
+  coherence_angle_ = max_angle;
 }
 
 void StandardInputPipeline::StartManualCollision(Entity entity, float depth) {
@@ -18,6 +18,7 @@ limitations under the License.
 #define LULLABY_UTIL_STANDARD_INPUT_PIPELINE_H_
 
 #include <deque>
+#include <vector>
 
 #include "lullaby/modules/input/input_focus.h"
 #include "lullaby/modules/input/input_manager.h"
@@ -68,6 +69,14 @@ class StandardInputPipeline {
   InputFocus ComputeInputFocus(const Clock::duration& delta_time,
                                InputManager::DeviceType device) const;
 
+  /// Same as ComputeInputFocus, but for each of the |devices|.  The collision
+  /// rays of all the devices are cast against the CollisionSystem in a single
+  /// batch, so this should be preferred over calling ComputeInputFocus for
+  /// each device when using several devices at once.
+  std::vector<InputFocus> ComputeInputFoci(
+      const Clock::duration& delta_time,
+      Span<InputManager::DeviceType> devices) const;
+
   // Triggers a collision as if the reticle was interacting with the given
   // entity at the given depth. Entity may be kNullEntity.
   void StartManualCollision(Entity entity, float depth);
@@ -94,9 +103,19 @@ class StandardInputPipeline {
   /// detection, focus locking, input behavior, etc.
   void ApplySystemsToInputFocus(InputFocus* focus) const;
 
-  /// Applies the collision system to the input focus.
+  /// Applies the collision system to the input focus.  If there is a
+  /// RenderPicker in the Registry, the focus of the primary device is picked
+  /// on the GPU with it instead, once it has read back a result.
   void ApplyCollisionSystemToInputFocus(InputFocus* focus) const;
 
+  /// Sets how far the collision ray of a device can move between frames and
+  /// still reuse the entity hit on the previous frame without casting the ray
+  /// again, as long as nothing that can be hit has changed.  |max_distance| is
+  /// the distance the ray origin can move, and |max_angle| is the angle (in
+  /// radians) that the ray direction can turn.  Pass 0 for both to only reuse
+  /// the hit for the exact same ray.
+  void SetCollisionCoherence(float max_distance, float max_angle);
+
   /// Returns the type of the device currently used as the primary input.
   InputManager::DeviceType GetPrimaryDevice() const;
 
@@ -118,12 +137,33 @@ class StandardInputPipeline {
   bool InitFocusForTouchScreen(InputFocus* focus) const;
 
  private:
+  // The last ray cast for a device and what it hit.
+  struct CollisionCache {
+    Ray ray;
+    CollisionSystem::CollisionResult result = {kNullEntity, kNoHitDistance};
+    uint64_t generation = 0;
+    bool valid = false;
+  };
+
+  bool InitFocus(InputFocus* focus) const;
+  void ApplySystemsToInputFoci(Span<InputFocus*> foci) const;
+  void ApplyCollisionSystemToInputFoci(Span<InputFocus*> foci) const;
+  bool IsNearRay(const Ray& lhs, const Ray& rhs) const;
+
   Registry* registry_;
   std::vector<InputManager::DeviceType> device_preference_;
   Optional<CollisionSystem::CollisionResult> manual_collision_ =
       Optional<CollisionSystem::CollisionResult>();
   ForceRayFromOriginMode forced_ray_from_origin_mode_ =
       ForceRayFromOriginMode::kDefault;
+  float coherence_distance_;
+  float coherence_angle_;
+  mutable CollisionCache collision_caches_[InputManager::kMaxNumDeviceTypes];
+  // Scratch space for the batched collision query.
+  mutable std::vector<InputFocus*> unlocked_foci_;
+  mutable std::vector<InputFocus*> cast_foci_;
+  mutable std::vector<Ray> cast_rays_;
+  mutable std::vector<CollisionSystem::CollisionResult> cast_results_;
 };
 
 }  // namespace lull
@@ -28,14 +28,14 @@ FunctionBinder* FunctionBinder::Create(Registry* registry) {
   return registry->Create<FunctionBinder>(registry);
 }
 
-void FunctionBinder::UnregisterFunction(string_view name) {
+void FunctionBinder::UnregisterFunction(HashedString name) {
 #if !LULLABY_DISABLE_FUNCTION_BINDER
   auto* script_engine = registry_->Get<ScriptEngine>();
   if (script_engine) {
-    script_engine->UnregisterFunction(std::string(name));
+    script_engine->UnregisterFunction(std::string(name.data(), name.size()));
   }
 
-  auto iter = functions_.find(Hash(name));
+  auto iter = functions_.find(name.GetHash());
   if (iter == functions_.end()) {
     LOG(DFATAL) << "Cannot unregister non-existent function: " << name;
     return;
@@ -44,14 +44,19 @@ void FunctionBinder::UnregisterFunction(string_view name) {
 #endif
 }
 
-bool FunctionBinder::IsFunctionRegistered(string_view name) const {
-  return IsFunctionRegistered(Hash(name));
+bool FunctionBinder::IsFunctionRegistered(HashedString name) const {
+  return IsFunctionRegistered(name.GetHash());
 }
 
 bool FunctionBinder::IsFunctionRegistered(HashValue id) const {
   return functions_.count(id) != 0;
 }
 
+FunctionBinder::Handle FunctionBinder::GetHandle(HashedString name) const {
+  const auto iter = functions_.find(name.GetHash());
+  return iter != functions_.end() ? Handle(iter->second.get()) : Handle();
+}
+
 Variant FunctionBinder::Call(FunctionCall* call) {
 #if !LULLABY_DISABLE_FUNCTION_BINDER
   const auto iter = functions_.find(call->GetId());
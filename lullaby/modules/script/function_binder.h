@@ -24,6 +24,7 @@ limitations under the License.
 #include "lullaby/modules/script/script_engine.h"
 #include "lullaby/util/built_in_functions.h"
 #include "lullaby/util/hash.h"
+#include "lullaby/util/hashed_string.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/util/registry.h"
 
@@ -36,7 +37,27 @@ namespace lull {
 // The FunctionBinder provides a centralized location to register functions,
 // by delegating to a number of other systems, such as the ScriptEngine.
 class FunctionBinder {
+  struct FunctionWrapper;
+
  public:
+  // A Handle refers to a registered function that has already been looked up
+  // by name, so that it can be called repeatedly without hashing the name or
+  // searching the registered functions.  A Handle is invalidated when its
+  // function is unregistered.
+  class Handle {
+   public:
+    Handle() {}
+
+    // Returns true if the handle refers to a registered function.
+    bool IsValid() const { return wrapper_ != nullptr; }
+
+   private:
+    friend class FunctionBinder;
+    explicit Handle(FunctionWrapper* wrapper) : wrapper_(wrapper) {}
+
+    FunctionWrapper* wrapper_ = nullptr;
+  };
+
   explicit FunctionBinder(Registry* registry);
 
   // Create and register a new FunctionBinder in the Registry.
@@ -45,39 +66,53 @@ class FunctionBinder {
   // Registers a function with a name. Overloading function names is not
   // supported.
   template <typename Fn>
-  void RegisterFunction(string_view name, Fn function);
+  void RegisterFunction(HashedString name, Fn function);
 
   // Registers a method from a class. The class must be in the Registry.
   template <typename Method>
-  void RegisterMethod(string_view name, Method method);
+  void RegisterMethod(HashedString name, Method method);
 
   // Unregister a function by name.
-  void UnregisterFunction(string_view name);
+  void UnregisterFunction(HashedString name);
 
   // Returns true if the function with the given |name| has been registered.
-  bool IsFunctionRegistered(string_view name) const;
+  bool IsFunctionRegistered(HashedString name) const;
 
   // Returns true if the function with the given |id| (which is simply the Hash
   // of its name) has been registered.
   bool IsFunctionRegistered(HashValue id) const;
 
-  // Call the function with given |name| with the provided |args|.
+  // Returns a Handle to the function with the given |name|, or an invalid
+  // Handle if no such function has been registered.
+  Handle GetHandle(HashedString name) const;
+
+  // Call the function with given |name| with the provided |args|.  Function
+  // names that are string literals are hashed at compile time.
   template <typename... Args>
-  Variant Call(string_view name, Args&&... args);
+  Variant Call(HashedString name, Args&&... args);
+
+  // Call the function referred to by |handle| with the provided |args|.
+  template <typename... Args>
+  Variant Call(Handle handle, Args&&... args);
 
   // Call the function with data bundled in the |call| object.
   Variant Call(FunctionCall* call);
 
  private:
   struct FunctionWrapper {
+    explicit FunctionWrapper(HashValue id) : id(id) {}
     virtual ~FunctionWrapper() {}
     virtual void Call(FunctionCall* call) = 0;
+
+    HashValue id;
   };
 
   template <typename NativeFunction>
   struct TypedFunctionWrapper : public FunctionWrapper {
-    TypedFunctionWrapper(string_view name, NativeFunction fn)
-        : name(name), fn(std::move(fn)) {}
+    TypedFunctionWrapper(HashedString name, NativeFunction fn)
+        : FunctionWrapper(name.GetHash()),
+          name(name.data(), name.size()),
+          fn(std::move(fn)) {}
 
     void Call(FunctionCall* call) override {
       CallNativeFunction(call, name.c_str(), fn);
@@ -95,9 +130,9 @@ class FunctionBinder {
 };
 
 template <typename Fn>
-void FunctionBinder::RegisterFunction(string_view name, Fn function) {
+void FunctionBinder::RegisterFunction(HashedString name, Fn function) {
 #if !LULLABY_DISABLE_FUNCTION_BINDER
-  const HashValue id = Hash(name);
+  const HashValue id = name.GetHash();
   if (IsFunctionRegistered(id)) {
     LOG(ERROR) << "Cannot register function twice: " << name;
     return;
@@ -109,20 +144,20 @@ void FunctionBinder::RegisterFunction(string_view name, Fn function) {
 
   auto* script_engine = registry_->Get<ScriptEngine>();
   if (script_engine) {
-    script_engine->RegisterFunction(std::string(name), ptr->fn);
+    script_engine->RegisterFunction(ptr->name, ptr->fn);
   }
 #endif
 }
 
 template <typename Method>
-void FunctionBinder::RegisterMethod(string_view name, Method method) {
+void FunctionBinder::RegisterMethod(HashedString name, Method method) {
 #if !LULLABY_DISABLE_FUNCTION_BINDER
   RegisterFunction(name, CreateMethodHelper<Method>::Call(registry_, method));
 #endif
 }
 
 template <typename... Args>
-Variant FunctionBinder::Call(string_view name, Args&&... args) {
+Variant FunctionBinder::Call(HashedString name, Args&&... args) {
 #if !LULLABY_DISABLE_FUNCTION_BINDER
   FunctionCall call = FunctionCall::Create(name, std::forward<Args>(args)...);
   return Call(&call);
@@ -131,6 +166,23 @@ Variant FunctionBinder::Call(string_view name, Args&&... args) {
 #endif
 }
 
+template <typename... Args>
+Variant FunctionBinder::Call(Handle handle, Args&&... args) {
+#if !LULLABY_DISABLE_FUNCTION_BINDER
+  if (!handle.IsValid()) {
+    LOG(DFATAL) << "Cannot call function with an invalid handle.";
+    return Variant();
+  }
+  // Create the call by ID so that the name doesn't need to be hashed or copied.
+  FunctionCall call = FunctionCall::Create(handle.wrapper_->id,
+                                           std::forward<Args>(args)...);
+  handle.wrapper_->Call(&call);
+  return call.GetReturnValue();
+#else
+  return Variant();
+#endif
+}
+
 template <typename Class, typename Return, typename... Args>
 struct FunctionBinder::CreateMethodHelper<Return (Class::*)(Args...)> {
   static std::function<Return(Args...)> Call(Registry* registry,
@@ -80,7 +80,9 @@ ScriptId ScriptEngine::LoadInlineScript(const std::string& code,
     LOG(ERROR) << "Unsupported language enum: " << static_cast<int>(lang);
     return ScriptId();
   }
-  return ScriptId(lang, it->second->LoadScript(code, debug_name));
+  const ScriptId id(lang, it->second->LoadScript(code, debug_name));
+  script_stats_[ScriptKey(lang, id.id_)].name = debug_name;
+  return id;
 }
 
 void ScriptEngine::ReloadScript(ScriptId id, const std::string& code) {
@@ -98,7 +100,27 @@ void ScriptEngine::RunScript(ScriptId id) {
     LOG(ERROR) << "Unsupported language enum: " << static_cast<int>(id.lang_);
     return;
   }
-  it->second->RunScript(id.id_);
+  auto stats = script_stats_.find(ScriptKey(id.lang_, id.id_));
+  if (stats == script_stats_.end()) {
+    // The script isn't loaded, so let the engine report the error.
+    it->second->RunScript(id.id_);
+    return;
+  }
+  // The trace keeps a copy of the name, since scripts may be unloaded before
+  // the trace is exported.
+  LULLABY_CPU_TRACE_FORMAT("%s", stats->second.name.c_str());
+  ++num_running_scripts_;
+  {
+    ScopedCall call(this, &stats->second);
+    it->second->RunScript(id.id_);
+  }
+  --num_running_scripts_;
+  if (num_running_scripts_ == 0) {
+    for (const ScriptKey& key : unloaded_scripts_) {
+      script_stats_.erase(key);
+    }
+    unloaded_scripts_.clear();
+  }
 }
 
 void ScriptEngine::UnloadScript(ScriptId id) {
@@ -108,6 +130,12 @@ void ScriptEngine::UnloadScript(ScriptId id) {
     return;
   }
   it->second->UnloadScript(id.id_);
+  // Running scripts may be referring to the stats, so wait until they finish.
+  if (num_running_scripts_ > 0) {
+    unloaded_scripts_.emplace_back(id.lang_, id.id_);
+  } else {
+    script_stats_.erase(ScriptKey(id.lang_, id.id_));
+  }
 }
 
 void ScriptEngine::UnregisterFunction(const std::string& name) {
@@ -124,4 +152,55 @@ size_t ScriptEngine::GetTotalScripts() const {
   return total;
 }
 
+std::vector<ScriptCallStats> ScriptEngine::GetScriptStats() const {
+  std::vector<ScriptCallStats> result;
+  for (const auto& kv : script_stats_) {
+    if (kv.second.num_calls > 0) {
+      result.push_back(kv.second);
+    }
+  }
+  return result;
+}
+
+std::vector<ScriptCallStats> ScriptEngine::GetFunctionStats() const {
+  std::vector<ScriptCallStats> result;
+  for (const auto& kv : function_stats_) {
+    if (kv.second.num_calls > 0) {
+      result.push_back(kv.second);
+    }
+  }
+  return result;
+}
+
+void ScriptEngine::ResetStats() {
+  auto reset = [](ScriptCallStats* stats) {
+    stats->num_calls = 0;
+    stats->total_time = Clock::duration::zero();
+    stats->self_time = Clock::duration::zero();
+  };
+  for (auto& kv : script_stats_) {
+    reset(&kv.second);
+  }
+  for (auto& kv : function_stats_) {
+    reset(&kv.second);
+  }
+}
+
+void ScriptEngine::BeginCall() {
+  active_calls_.emplace_back();
+  active_calls_.back().start_time = Clock::now();
+}
+
+void ScriptEngine::EndCall(ScriptCallStats* stats) {
+  const ActiveCall& call = active_calls_.back();
+  const Clock::duration elapsed = Clock::now() - call.start_time;
+  ++stats->num_calls;
+  stats->total_time += elapsed;
+  stats->self_time += elapsed - call.nested_time;
+  active_calls_.pop_back();
+  if (!active_calls_.empty()) {
+    active_calls_.back().nested_time += elapsed;
+  }
+}
+
 }  // namespace lull
@@ -17,7 +17,9 @@ limitations under the License.
 #ifndef LULLABY_MODULES_SCRIPT_SCRIPT_ENGINE_H_
 #define LULLABY_MODULES_SCRIPT_SCRIPT_ENGINE_H_
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/file/asset_loader.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "lullaby/util/entity.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/util/registry.h"
+#include "lullaby/util/trace.h"
 #include "lullaby/generated/script_def_generated.h"
 
 namespace lull {
@@ -198,6 +201,21 @@ class IScriptEngine {
   virtual size_t GetTotalScripts() const = 0;
 };
 
+// ScriptCallStats accumulates the calls to a script or to a native function
+// that were made while profiling was enabled.
+struct ScriptCallStats {
+  // The debug name of the script, or the name of the native function.
+  std::string name;
+  // The number of calls.
+  uint64_t num_calls = 0;
+  // The time spent in the calls, including any nested script runs and native
+  // function calls.  Recursive calls are counted at every level.
+  Clock::duration total_time = Clock::duration::zero();
+  // The time spent in the calls, excluding nested script runs and native
+  // function calls.
+  Clock::duration self_time = Clock::duration::zero();
+};
+
 // The ScriptEngine loads and runs scripts by delegating to language specific
 // engines.
 class ScriptEngine {
@@ -258,10 +276,76 @@ class ScriptEngine {
   // testing and debugging.
   size_t GetTotalScripts() const;
 
+  // Enables or disables collecting ScriptCallStats for script runs and native
+  // function calls.  Profiling is disabled by default.  Script runs and native
+  // function calls are also traced with LULLABY_CPU_TRACE regardless.
+  void EnableProfiling(bool enable) { profiling_enabled_ = enable; }
+
+  // Returns whether ScriptCallStats are being collected.
+  bool IsProfilingEnabled() const { return profiling_enabled_; }
+
+  // Returns the stats of every loaded script that has been run while profiling
+  // was enabled.
+  std::vector<ScriptCallStats> GetScriptStats() const;
+
+  // Returns the stats of every native function that has been called while
+  // profiling was enabled.
+  std::vector<ScriptCallStats> GetFunctionStats() const;
+
+  // Clears the stats of all scripts and native functions.
+  void ResetStats();
+
  private:
+  // Measures a script run or native function call and adds it to |stats|.  Time
+  // spent in nested calls is removed from the self time of the enclosing call.
+  class ScopedCall {
+   public:
+    ScopedCall(ScriptEngine* engine, ScriptCallStats* stats)
+        : engine_(engine->profiling_enabled_ ? engine : nullptr),
+          stats_(stats) {
+      if (engine_) {
+        engine_->BeginCall();
+      }
+    }
+
+    ~ScopedCall() {
+      if (engine_) {
+        engine_->EndCall(stats_);
+      }
+    }
+
+    ScopedCall(const ScopedCall&) = delete;
+    ScopedCall& operator=(const ScopedCall&) = delete;
+
+   private:
+    ScriptEngine* engine_;
+    ScriptCallStats* stats_;
+  };
+
+  struct ActiveCall {
+    Clock::time_point start_time;
+    Clock::duration nested_time = Clock::duration::zero();
+  };
+
+  using ScriptKey = std::pair<Language, uint64_t>;
+
+  void BeginCall();
+  void EndCall(ScriptCallStats* stats);
+
   Registry* registry_;
 
   std::unordered_map<Language, IScriptEngine*> engines_;
+
+  bool profiling_enabled_ = false;
+  std::vector<ActiveCall> active_calls_;
+  std::map<ScriptKey, ScriptCallStats> script_stats_;
+  // The stats of scripts unloaded while a script was running are removed once
+  // no scripts are running.
+  int num_running_scripts_ = 0;
+  std::vector<ScriptKey> unloaded_scripts_;
+  // The registered native function wrappers keep pointers to these stats, so
+  // entries are never removed.
+  std::unordered_map<std::string, ScriptCallStats> function_stats_;
 };
 
 template <typename Engine, typename... Args>
@@ -280,7 +364,11 @@ void ScriptEngine::CreateEngine(Args&&... args) {
 template <typename Fn>
 void ScriptEngine::RegisterFunction(const std::string& name,
                                     const Fn& function) {
+  ScriptCallStats* stats = &function_stats_[name];
+  stats->name = name;
   auto wrapped = [=](IContext* context) {
+    LULLABY_CPU_TRACE(stats->name.c_str());
+    ScopedCall call(this, stats);
     if (!CallNativeFunction(context, name.c_str(), function)) {
       return -1;
     }
@@ -0,0 +1,712 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_SERIALIZE_DELTA_SERIALIZER_H_
+#define LULLABY_MODULES_SERIALIZE_DELTA_SERIALIZER_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lullaby/modules/serialize/buffer_serializer.h"
+#include "lullaby/modules/serialize/serialize.h"
+#include "lullaby/util/entity.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/logging.h"
+#include "lullaby/util/string_view.h"
+#include "mathfu/glsl_mappings.h"
+
+namespace lull {
+
+// Delta encoding of serializable objects (eg. component state) for replicating
+// them over a network.
+//
+// Each object is flattened into a DeltaSnapshot: the sequence of fields visited
+// by its Serialize function, each quantized to a compact representation:
+// - floats, and the components of vec2/vec3/vec4, are stored as varint
+//   multiples of DeltaOptions::precision (or losslessly if it is zero).
+// - quaternions are stored in 32 bits using the "smallest three" encoding.
+// - integers are stored as varints, other fundamental types are copied.
+// - strings and containers are stored using SaveToBuffer.
+//
+// Each tick, the DeltaEncoder writes all the objects that have changed into a
+// single buffer.  Only the fields that differ from the last state of each
+// object acknowledged by the receiver are written.  The DeltaDecoder reads the
+// buffer by applying those fields to the same acknowledged state, so that
+// deltas remain correct when packets are lost.
+//
+// The encoder and decoder must use the same DeltaOptions, and objects with the
+// same type key must always visit the same fields in the same order.
+
+struct DeltaOptions {
+  // The precision with which floats are quantized, or zero to send them
+  // losslessly.  The default is about a millimeter for positions in meters.
+  float precision = 1.f / 1024.f;
+};
+
+namespace detail {
+
+inline void WriteVarint(uint64_t value, std::vector<uint8_t>* buffer) {
+  while (value >= 0x80) {
+    buffer->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  buffer->push_back(static_cast<uint8_t>(value));
+}
+
+// Reads a varint from |*ptr|, advancing it.  Returns false if the varint is
+// truncated by |end|.
+inline bool ReadVarint(const uint8_t** ptr, const uint8_t* end,
+                       uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; *ptr < end && shift < 64; shift += 7) {
+    const uint8_t byte = *(*ptr)++;
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+inline uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+}  // namespace detail
+
+// Packs a unit quaternion into 32 bits by dropping its largest component,
+// which is recovered from the other three: 2 bits for the index of the dropped
+// component and 10 bits for each of the others.
+inline uint32_t PackQuaternion(const mathfu::quat& quat) {
+  const float kMaxComponent = 0.70710678f;  // 1/sqrt(2)
+  const float components[4] = {quat.scalar(), quat.vector().x,
+                               quat.vector().y, quat.vector().z};
+  uint32_t largest = 0;
+  for (uint32_t i = 1; i < 4; ++i) {
+    if (std::abs(components[i]) > std::abs(components[largest])) {
+      largest = i;
+    }
+  }
+  // q and -q are the same rotation, so make the dropped component positive.
+  const float sign = components[largest] < 0.f ? -1.f : 1.f;
+  uint32_t packed = largest;
+  for (uint32_t i = 0; i < 4; ++i) {
+    if (i == largest) {
+      continue;
+    }
+    const float normalized = sign * components[i] / kMaxComponent;
+    const float clamped = std::max(-1.f, std::min(1.f, normalized));
+    packed = (packed << 10) |
+             static_cast<uint32_t>(std::lround((clamped + 1.f) * 511.5f));
+  }
+  return packed;
+}
+
+// Unpacks a quaternion packed by PackQuaternion.
+inline mathfu::quat UnpackQuaternion(uint32_t packed) {
+  const float kMaxComponent = 0.70710678f;  // 1/sqrt(2)
+  const uint32_t largest = packed >> 30;
+  float components[4];
+  float sum = 0.f;
+  for (int i = 3; i >= 0; --i) {
+    if (static_cast<uint32_t>(i) == largest) {
+      continue;
+    }
+    const float normalized =
+        static_cast<float>(packed & 0x3ff) / 511.5f - 1.f;
+    components[i] = normalized * kMaxComponent;
+    sum += components[i] * components[i];
+    packed >>= 10;
+  }
+  components[largest] = std::sqrt(std::max(0.f, 1.f - sum));
+  return mathfu::quat(components[0], components[1], components[2],
+                      components[3]);
+}
+
+// The quantized fields of an object.
+class DeltaSnapshot {
+ public:
+  using Buffer = std::vector<uint8_t>;
+
+  DeltaSnapshot() {}
+  explicit DeltaSnapshot(const DeltaOptions& options) : options_(options) {}
+
+  // Captures the fields of |value|.
+  template <typename T>
+  void Capture(T* value);
+
+  // Restores the fields of |value|.  Returns false, leaving the remaining
+  // fields untouched, if they do not match the snapshot.
+  template <typename T>
+  bool Restore(T* value) const;
+
+  // Returns the number of fields in the snapshot.
+  size_t GetNumFields() const { return offsets_.size(); }
+
+  // Returns the quantized data of the |index|th field.
+  string_view GetField(size_t index) const {
+    const size_t begin = offsets_[index];
+    const size_t end =
+        index + 1 < offsets_.size() ? offsets_[index + 1] : data_.size();
+    return string_view(reinterpret_cast<const char*>(data_.data()) + begin,
+                       end - begin);
+  }
+
+  // Appends a field with the quantized |data|.
+  void AddField(string_view data) {
+    offsets_.push_back(static_cast<uint32_t>(data_.size()));
+    data_.insert(data_.end(), data.data(), data.data() + data.size());
+  }
+
+  bool operator==(const DeltaSnapshot& rhs) const {
+    return offsets_ == rhs.offsets_ && data_ == rhs.data_;
+  }
+
+  // Used by Archiver when capturing.
+
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value ||
+                              std::is_enum<T>::value,
+                          void>::type
+  operator()(T* ptr, HashValue key);
+  void operator()(Entity* ptr, HashValue key);
+  void operator()(float* ptr, HashValue key);
+  void operator()(mathfu::vec2* ptr, HashValue key);
+  void operator()(mathfu::vec3* ptr, HashValue key);
+  void operator()(mathfu::vec4* ptr, HashValue key);
+  void operator()(mathfu::quat* ptr, HashValue key);
+  template <typename T>
+  typename std::enable_if<!std::is_integral<T>::value &&
+                              !std::is_enum<T>::value &&
+                              !std::is_same<T, Entity>::value &&
+                              !std::is_same<T, float>::value &&
+                              !std::is_same<T, mathfu::vec2>::value &&
+                              !std::is_same<T, mathfu::vec3>::value &&
+                              !std::is_same<T, mathfu::vec4>::value &&
+                              !std::is_same<T, mathfu::quat>::value,
+                          void>::type
+  operator()(T* ptr, HashValue key);
+
+  bool IsDestructive() const { return false; }
+
+ private:
+  class Restorer;
+
+  void BeginField() {
+    offsets_.push_back(static_cast<uint32_t>(data_.size()));
+  }
+  void WriteFloat(float value);
+
+  DeltaOptions options_;
+  Buffer data_;
+  std::vector<uint32_t> offsets_;
+};
+
+// Writes the changes to objects each tick, relative to the state of each object
+// last acknowledged by the receiver.
+//
+//   DeltaEncoder encoder;
+//   encoder.BeginTick();
+//   encoder.Write(entity, ConstHash("TransformDef"), &transform);
+//   ...
+//   SendToHeadsets(encoder.EndTick());
+//
+//   // When a headset acknowledges a tick:
+//   encoder.Acknowledge(sequence);
+//
+// With several receivers, use a DeltaEncoder per receiver.
+class DeltaEncoder {
+ public:
+  using Buffer = std::vector<uint8_t>;
+
+  explicit DeltaEncoder(const DeltaOptions& options = DeltaOptions())
+      : options_(options) {}
+
+  // Starts a new tick.  Returns its sequence number, which is always greater
+  // than that of the previous tick.
+  uint32_t BeginTick();
+
+  // Writes the fields of |value| that differ from the acknowledged state of the
+  // object identified by |entity| and |type|.  Nothing is written if it has
+  // not changed.
+  template <typename T>
+  void Write(Entity entity, HashValue type, T* value);
+
+  // Returns the buffer of all the changes written since BeginTick().
+  Buffer EndTick();
+
+  // Marks the tick |sequence| as received, so that later ticks are encoded
+  // relative to it.
+  void Acknowledge(uint32_t sequence);
+
+  // Forgets the state of the object identified by |entity| and |type| (eg.
+  // when the Entity is destroyed), so that it is sent in full if written
+  // again.
+  void Forget(Entity entity, HashValue type);
+
+ private:
+  using Key = std::pair<Entity, HashValue>;
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return std::hash<uint32_t>()(key.first.AsUint32()) ^
+             (std::hash<uint32_t>()(key.second) << 1);
+    }
+  };
+
+  struct State {
+    DeltaSnapshot acked;
+    uint32_t acked_sequence = 0;
+    // The snapshots sent since the acknowledged one, by sequence.
+    std::map<uint32_t, DeltaSnapshot> sent;
+  };
+
+  DeltaOptions options_;
+  std::unordered_map<Key, State, KeyHash> states_;
+  Buffer buffer_;
+  uint32_t sequence_ = 0;
+};
+
+// Reads the buffers written by a DeltaEncoder.
+class DeltaDecoder {
+ public:
+  using Buffer = std::vector<uint8_t>;
+
+  // Called for each object in a tick with its new state, which can be restored
+  // into the object with DeltaSnapshot::Restore().
+  using ReadFn = std::function<void(Entity entity, HashValue type,
+                                    const DeltaSnapshot& snapshot)>;
+
+  explicit DeltaDecoder(const DeltaOptions& options = DeltaOptions())
+      : options_(options) {}
+
+  // Reads a tick's |buffer|, calling |fn| for each object that changed.
+  // Returns the sequence number of the tick, which should be acknowledged to
+  // the encoder, or zero if the buffer is malformed.  Objects whose
+  // acknowledged state is unknown (eg. because of a decoder reset) are skipped.
+  uint32_t Read(const Buffer& buffer, const ReadFn& fn);
+
+  // Forgets the state of the object identified by |entity| and |type|.
+  void Forget(Entity entity, HashValue type);
+
+ private:
+  using Key = std::pair<Entity, HashValue>;
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return std::hash<uint32_t>()(key.first.AsUint32()) ^
+             (std::hash<uint32_t>()(key.second) << 1);
+    }
+  };
+
+  DeltaOptions options_;
+  // The snapshots received for each object, by sequence.
+  std::unordered_map<Key, std::map<uint32_t, DeltaSnapshot>, KeyHash> states_;
+};
+
+// Restores the fields of an object from a DeltaSnapshot.
+class DeltaSnapshot::Restorer {
+ public:
+  explicit Restorer(const DeltaSnapshot* snapshot) : snapshot_(snapshot) {}
+
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value ||
+                              std::is_enum<T>::value,
+                          void>::type
+  operator()(T* ptr, HashValue key) {
+    uint64_t value = 0;
+    if (ReadVarint(&value)) {
+      *ptr = static_cast<T>(std::is_signed<T>::value
+                                ? static_cast<uint64_t>(
+                                      detail::ZigZagDecode(value))
+                                : value);
+    }
+  }
+
+  void operator()(Entity* ptr, HashValue key) {
+    uint64_t value = 0;
+    if (ReadVarint(&value)) {
+      *ptr = Entity(static_cast<uint32_t>(value));
+    }
+  }
+
+  void operator()(float* ptr, HashValue key) {
+    if (BeginField()) {
+      ReadFloat(ptr);
+    }
+  }
+
+  void operator()(mathfu::vec2* ptr, HashValue key) { ReadVector(ptr, 2); }
+  void operator()(mathfu::vec3* ptr, HashValue key) { ReadVector(ptr, 3); }
+  void operator()(mathfu::vec4* ptr, HashValue key) { ReadVector(ptr, 4); }
+
+  void operator()(mathfu::quat* ptr, HashValue key) {
+    uint32_t packed = 0;
+    if (BeginField() && Read(&packed, sizeof(packed))) {
+      *ptr = UnpackQuaternion(packed);
+    }
+  }
+
+  template <typename T>
+  typename std::enable_if<!std::is_integral<T>::value &&
+                              !std::is_enum<T>::value &&
+                              !std::is_same<T, Entity>::value &&
+                              !std::is_same<T, float>::value &&
+                              !std::is_same<T, mathfu::vec2>::value &&
+                              !std::is_same<T, mathfu::vec3>::value &&
+                              !std::is_same<T, mathfu::vec4>::value &&
+                              !std::is_same<T, mathfu::quat>::value,
+                          void>::type
+  operator()(T* ptr, HashValue key) {
+    if (!BeginField()) {
+      return;
+    }
+    const Buffer buffer(ptr_, end_);
+    LoadFromBuffer loader(&buffer);
+    Serialize(&loader, ptr, key);
+    ptr_ = end_;
+  }
+
+  bool IsDestructive() const { return true; }
+
+  // Returns true if all the fields were restored.
+  bool IsValid() const {
+    return valid_ && field_ == snapshot_->GetNumFields();
+  }
+
+ private:
+  // Moves to the next field.  Returns false if there are no more fields.
+  bool BeginField() {
+    if (!valid_ || field_ >= snapshot_->GetNumFields()) {
+      valid_ = false;
+      return false;
+    }
+    const string_view field = snapshot_->GetField(field_++);
+    ptr_ = reinterpret_cast<const uint8_t*>(field.data());
+    end_ = ptr_ + field.size();
+    return true;
+  }
+
+  bool Read(void* ptr, size_t size) {
+    if (ptr_ + size > end_) {
+      valid_ = false;
+      return false;
+    }
+    memcpy(ptr, ptr_, size);
+    ptr_ += size;
+    return true;
+  }
+
+  bool ReadVarint(uint64_t* value) {
+    if (!BeginField() || !detail::ReadVarint(&ptr_, end_, value)) {
+      valid_ = false;
+      return false;
+    }
+    return true;
+  }
+
+  bool ReadFloat(float* value) {
+    const float precision = snapshot_->options_.precision;
+    if (precision == 0.f) {
+      return Read(value, sizeof(*value));
+    }
+    uint64_t quantized = 0;
+    if (!detail::ReadVarint(&ptr_, end_, &quantized)) {
+      valid_ = false;
+      return false;
+    }
+    *value =
+        static_cast<float>(detail::ZigZagDecode(quantized)) * precision;
+    return true;
+  }
+
+  template <typename Vector>
+  void ReadVector(Vector* ptr, int size) {
+    if (!BeginField()) {
+      return;
+    }
+    for (int i = 0; i < size; ++i) {
+      ReadFloat(&(*ptr)[i]);
+    }
+  }
+
+  const DeltaSnapshot* snapshot_;
+  size_t field_ = 0;
+  const uint8_t* ptr_ = nullptr;
+  const uint8_t* end_ = nullptr;
+  bool valid_ = true;
+};
+
+template <typename T>
+void DeltaSnapshot::Capture(T* value) {
+  data_.clear();
+  offsets_.clear();
+  Serialize(this, value, 0);
+}
+
+template <typename T>
+bool DeltaSnapshot::Restore(T* value) const {
+  Restorer restorer(this);
+  Serialize(&restorer, value, 0);
+  return restorer.IsValid();
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value,
+                        void>::type
+DeltaSnapshot::operator()(T* ptr, HashValue key) {
+  BeginField();
+  if (std::is_signed<T>::value) {
+    detail::WriteVarint(detail::ZigZagEncode(static_cast<int64_t>(*ptr)),
+                        &data_);
+  } else {
+    detail::WriteVarint(static_cast<uint64_t>(*ptr), &data_);
+  }
+}
+
+inline void DeltaSnapshot::operator()(Entity* ptr, HashValue key) {
+  BeginField();
+  detail::WriteVarint(ptr->AsUint32(), &data_);
+}
+
+inline void DeltaSnapshot::operator()(float* ptr, HashValue key) {
+  BeginField();
+  WriteFloat(*ptr);
+}
+
+inline void DeltaSnapshot::operator()(mathfu::vec2* ptr, HashValue key) {
+  BeginField();
+  for (int i = 0; i < 2; ++i) {
+    WriteFloat((*ptr)[i]);
+  }
+}
+
+inline void DeltaSnapshot::operator()(mathfu::vec3* ptr, HashValue key) {
+  BeginField();
+  for (int i = 0; i < 3; ++i) {
+    WriteFloat((*ptr)[i]);
+  }
+}
+
+inline void DeltaSnapshot::operator()(mathfu::vec4* ptr, HashValue key) {
+  BeginField();
+  for (int i = 0; i < 4; ++i) {
+    WriteFloat((*ptr)[i]);
+  }
+}
+
+inline void DeltaSnapshot::operator()(mathfu::quat* ptr, HashValue key) {
+  BeginField();
+  const uint32_t packed = PackQuaternion(ptr->Normalized());
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&packed);
+  data_.insert(data_.end(), bytes, bytes + sizeof(packed));
+}
+
+template <typename T>
+typename std::enable_if<!std::is_integral<T>::value &&
+                            !std::is_enum<T>::value &&
+                            !std::is_same<T, Entity>::value &&
+                            !std::is_same<T, float>::value &&
+                            !std::is_same<T, mathfu::vec2>::value &&
+                            !std::is_same<T, mathfu::vec3>::value &&
+                            !std::is_same<T, mathfu::vec4>::value &&
+                            !std::is_same<T, mathfu::quat>::value,
+                        void>::type
+DeltaSnapshot::operator()(T* ptr, HashValue key) {
+  Buffer buffer;
+  SaveToBuffer saver(&buffer);
+  Serialize(&saver, ptr, key);
+  AddField(string_view(reinterpret_cast<const char*>(buffer.data()),
+                       buffer.size()));
+}
+
+inline void DeltaSnapshot::WriteFloat(float value) {
+  if (options_.precision == 0.f) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    data_.insert(data_.end(), bytes, bytes + sizeof(value));
+  } else {
+    const int64_t quantized = std::llround(value / options_.precision);
+    detail::WriteVarint(detail::ZigZagEncode(quantized), &data_);
+  }
+}
+
+// Each tick is encoded as its sequence number followed by the changed objects,
+// each as:
+// - its Entity, type and the sequence of the snapshot it is relative to (zero
+//   for none).
+// - the number of fields, and a bitmask of the fields that changed.
+// - the size and data of each changed field.
+
+inline uint32_t DeltaEncoder::BeginTick() {
+  buffer_.clear();
+  ++sequence_;
+  detail::WriteVarint(sequence_, &buffer_);
+  return sequence_;
+}
+
+template <typename T>
+void DeltaEncoder::Write(Entity entity, HashValue type, T* value) {
+  DeltaSnapshot snapshot(options_);
+  snapshot.Capture(value);
+
+  State& state = states_[Key(entity, type)];
+  const size_t num_fields = snapshot.GetNumFields();
+  const bool has_baseline =
+      state.acked_sequence != 0 && state.acked.GetNumFields() == num_fields;
+  // Keep writing until a tick with the latest state is acknowledged, in case
+  // the receiver has applied a state that has since been reverted.
+  if (has_baseline && state.sent.empty() && snapshot == state.acked) {
+    return;
+  }
+
+  detail::WriteVarint(entity.AsUint32(), &buffer_);
+  detail::WriteVarint(type, &buffer_);
+  detail::WriteVarint(has_baseline ? state.acked_sequence : 0, &buffer_);
+  detail::WriteVarint(num_fields, &buffer_);
+
+  const size_t mask_offset = buffer_.size();
+  buffer_.resize(mask_offset + (num_fields + 7) / 8, 0);
+  for (size_t i = 0; i < num_fields; ++i) {
+    const string_view field = snapshot.GetField(i);
+    if (has_baseline && field == state.acked.GetField(i)) {
+      continue;
+    }
+    buffer_[mask_offset + i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+    detail::WriteVarint(field.size(), &buffer_);
+    buffer_.insert(buffer_.end(), field.data(), field.data() + field.size());
+  }
+
+  state.sent[sequence_] = std::move(snapshot);
+}
+
+inline DeltaEncoder::Buffer DeltaEncoder::EndTick() {
+  Buffer buffer;
+  buffer.swap(buffer_);
+  return buffer;
+}
+
+inline void DeltaEncoder::Acknowledge(uint32_t sequence) {
+  for (auto& iter : states_) {
+    State& state = iter.second;
+    auto sent = state.sent.find(sequence);
+    if (sent != state.sent.end()) {
+      state.acked = std::move(sent->second);
+      state.acked_sequence = sequence;
+    }
+    // Later acknowledgements never need older snapshots.
+    state.sent.erase(state.sent.begin(), state.sent.upper_bound(sequence));
+  }
+}
+
+inline void DeltaEncoder::Forget(Entity entity, HashValue type) {
+  states_.erase(Key(entity, type));
+}
+
+inline uint32_t DeltaDecoder::Read(const Buffer& buffer, const ReadFn& fn) {
+  const uint8_t* ptr = buffer.data();
+  const uint8_t* end = ptr + buffer.size();
+
+  uint64_t sequence = 0;
+  if (!detail::ReadVarint(&ptr, end, &sequence) || sequence == 0) {
+    return 0;
+  }
+
+  while (ptr < end) {
+    uint64_t entity = 0;
+    uint64_t type = 0;
+    uint64_t baseline = 0;
+    uint64_t num_fields = 0;
+    if (!detail::ReadVarint(&ptr, end, &entity) ||
+        !detail::ReadVarint(&ptr, end, &type) ||
+        !detail::ReadVarint(&ptr, end, &baseline) ||
+        !detail::ReadVarint(&ptr, end, &num_fields)) {
+      return 0;
+    }
+    const uint64_t mask_size = (num_fields + 7) / 8;
+    if (mask_size > static_cast<uint64_t>(end - ptr)) {
+      return 0;
+    }
+    const uint8_t* mask = ptr;
+    ptr += mask_size;
+
+    const Key key(Entity(static_cast<uint32_t>(entity)),
+                  static_cast<HashValue>(type));
+    auto& snapshots = states_[key];
+    const DeltaSnapshot* base = nullptr;
+    if (baseline != 0) {
+      auto iter = snapshots.find(static_cast<uint32_t>(baseline));
+      if (iter != snapshots.end() &&
+          iter->second.GetNumFields() == num_fields) {
+        base = &iter->second;
+      }
+    }
+
+    DeltaSnapshot snapshot(options_);
+    bool valid = baseline == 0 || base != nullptr;
+    for (size_t i = 0; i < num_fields; ++i) {
+      if ((mask[i / 8] & (1 << (i % 8))) == 0) {
+        if (base) {
+          snapshot.AddField(base->GetField(i));
+        } else {
+          valid = false;
+        }
+        continue;
+      }
+      uint64_t size = 0;
+      if (!detail::ReadVarint(&ptr, end, &size) ||
+          size > static_cast<uint64_t>(end - ptr)) {
+        return 0;
+      }
+      snapshot.AddField(
+          string_view(reinterpret_cast<const char*>(ptr), size));
+      ptr += size;
+    }
+    if (!valid) {
+      LOG(WARNING) << "Skipping delta with unknown baseline for entity "
+                   << entity;
+      continue;
+    }
+
+    // The encoder only moves its baseline forward.
+    snapshots.erase(snapshots.begin(),
+                    snapshots.lower_bound(static_cast<uint32_t>(baseline)));
+    fn(key.first, key.second, snapshot);
+    snapshots[static_cast<uint32_t>(sequence)] = std::move(snapshot);
+  }
+  return static_cast<uint32_t>(sequence);
+}
+
+inline void DeltaDecoder::Forget(Entity entity, HashValue type) {
+  states_.erase(Key(entity, type));
+}
+
+}  // namespace lull
+
+#endif  // LULLABY_MODULES_SERIALIZE_DELTA_SERIALIZER_H_
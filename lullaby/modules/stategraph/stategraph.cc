@@ -20,6 +20,9 @@ limitations under the License.
 
 namespace lull {
 
+constexpr size_t Stategraph::kInvalidIndex;
+constexpr uint16_t Stategraph::kNoTransition;
+
 void Stategraph::AddState(std::unique_ptr<StategraphState> state) {
   const HashValue id = state->GetId();
   auto iter = states_.find(id);
@@ -27,6 +30,11 @@ void Stategraph::AddState(std::unique_ptr<StategraphState> state) {
     LOG(DFATAL) << "State already in stategraph: " << id;
   }
   states_[id] = std::move(state);
+
+  compiled_ = false;
+  state_indices_.clear();
+  indexed_states_.clear();
+  next_transitions_.clear();
 }
 
 const StategraphState* Stategraph::GetState(HashValue id) const {
@@ -102,10 +110,110 @@ Stategraph::Path Stategraph::FindPath(HashValue from_state_id,
     return {};
   }
 
+  if (compiled_) {
+    const size_t num_states = indexed_states_.size();
+    const size_t to_index = GetStateIndex(to_state_id);
+    size_t index = GetStateIndex(from_state_id);
+    while (index != to_index) {
+      const uint16_t next = next_transitions_[index * num_states + to_index];
+      if (next == kNoTransition) {
+        return {};
+      }
+      const StategraphTransition& transition =
+          indexed_states_[index]->GetTransitions()[next];
+      path.push_back(transition);
+      index = GetStateIndex(transition.to_state);
+    }
+    return path;
+  }
+
   std::set<HashValue> visited;
   return FindPathHelper(from_state, to_state, visited);
 }
 
+void Stategraph::Compile() {
+  state_indices_.clear();
+  indexed_states_.clear();
+  for (const auto& iter : states_) {
+    state_indices_[iter.first] = indexed_states_.size();
+    indexed_states_.push_back(iter.second.get());
+  }
+
+  // Resolve the destination of every Transition once, rather than once per
+  // search.
+  const size_t num_states = indexed_states_.size();
+  std::vector<std::vector<size_t>> destinations(num_states);
+  for (size_t i = 0; i < num_states; ++i) {
+    const auto& transitions = indexed_states_[i]->GetTransitions();
+    if (transitions.size() >= kNoTransition) {
+      LOG(DFATAL) << "Too many transitions in state: "
+                  << indexed_states_[i]->GetId();
+      return;
+    }
+    destinations[i].reserve(transitions.size());
+    for (const StategraphTransition& transition : transitions) {
+      const size_t to_index = GetStateIndex(transition.to_state);
+      if (to_index == kInvalidIndex) {
+        LOG(DFATAL) << "Found a transition to an invalid state: "
+                    << transition.to_state;
+      }
+      destinations[i].push_back(to_index);
+    }
+  }
+
+  // A breadth-first search from each State finds the shortest paths to all
+  // the others.  Visiting Transitions in order picks the same path as
+  // FindPathHelper() when several paths have the same length.
+  next_transitions_.assign(num_states * num_states, kNoTransition);
+  std::vector<bool> visited(num_states);
+  std::vector<size_t> queue;
+  queue.reserve(num_states);
+  for (size_t from = 0; from < num_states; ++from) {
+    uint16_t* row = &next_transitions_[from * num_states];
+    visited.assign(num_states, false);
+    visited[from] = true;
+    queue.clear();
+    queue.push_back(from);
+    for (size_t head = 0; head < queue.size(); ++head) {
+      const size_t index = queue[head];
+      for (size_t i = 0; i < destinations[index].size(); ++i) {
+        const size_t next = destinations[index][i];
+        if (next == kInvalidIndex || visited[next]) {
+          continue;
+        }
+        visited[next] = true;
+        row[next] = index == from ? static_cast<uint16_t>(i) : row[index];
+        queue.push_back(next);
+      }
+    }
+  }
+  compiled_ = true;
+}
+
+const StategraphTransition* Stategraph::GetNextTransition(
+    HashValue from_state_id, HashValue to_state_id) const {
+  if (!compiled_) {
+    LOG(DFATAL) << "Stategraph must be compiled.";
+    return nullptr;
+  }
+  const size_t from_index = GetStateIndex(from_state_id);
+  const size_t to_index = GetStateIndex(to_state_id);
+  if (from_index == kInvalidIndex || to_index == kInvalidIndex) {
+    return nullptr;
+  }
+  const uint16_t next =
+      next_transitions_[from_index * indexed_states_.size() + to_index];
+  if (next == kNoTransition) {
+    return nullptr;
+  }
+  return &indexed_states_[from_index]->GetTransitions()[next];
+}
+
+size_t Stategraph::GetStateIndex(HashValue id) const {
+  auto iter = state_indices_.find(id);
+  return iter != state_indices_.end() ? iter->second : kInvalidIndex;
+}
+
 std::string Stategraph::GetGraphDebugString() const {
   std::stringstream str;
   str << "digraph {\n";
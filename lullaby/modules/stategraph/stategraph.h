@@ -17,10 +17,12 @@ limitations under the License.
 #ifndef LULLABY_UTIL_STATEGRAPH_STATEGRAPH_H_
 #define LULLABY_UTIL_STATEGRAPH_STATEGRAPH_H_
 
+#include <stdint.h>
 #include <deque>
 #include <memory>
 #include <set>
 #include <unordered_map>
+#include <vector>
 #include "lullaby/modules/stategraph/stategraph_state.h"
 #include "lullaby/util/hash.h"
 #include "lullaby/util/typeid.h"
@@ -34,6 +36,10 @@ namespace lull {
 // Transitions are single-directional, with the State that owns the Transition
 // being the originating State for the Transition.  The Stategraph provides
 // functions to find a path of Transitions between two States.
+//
+// Once all the States have been added, Compile() can be used to precompute the
+// shortest paths between every pair of States, so that paths no longer need to
+// be searched for at runtime.
 class Stategraph {
  public:
   Stategraph() {}
@@ -53,6 +59,20 @@ class Stategraph {
   using Path = std::deque<StategraphTransition>;
   Path FindPath(HashValue from_state_id, HashValue to_state_id) const;
 
+  // Builds a table of the first Transition on the shortest path between every
+  // pair of States.  FindPath() then follows the table instead of searching the
+  // graph, and GetNextTransition() becomes a single lookup.  Adding a State
+  // discards the table.
+  void Compile();
+
+  // Returns true if Compile() has been called since the last State was added.
+  bool IsCompiled() const { return compiled_; }
+
+  // Returns the first Transition of FindPath(|from_state_id|, |to_state_id|),
+  // or nullptr if there is no such path.  The graph must be compiled.
+  const StategraphTransition* GetNextTransition(HashValue from_state_id,
+                                                HashValue to_state_id) const;
+
   // Returns the Graphviz representation of the graph.
   std::string GetGraphDebugString() const;
 
@@ -60,7 +80,22 @@ class Stategraph {
   Path FindPathHelper(const StategraphState* node, const StategraphState* dest,
                       std::set<HashValue> visited) const;
 
+  // Returns the index of the given State in the compiled tables, or
+  // kInvalidIndex if there is no such State.
+  size_t GetStateIndex(HashValue id) const;
+
+  static constexpr size_t kInvalidIndex = ~size_t(0);
+  static constexpr uint16_t kNoTransition = 0xffff;
+
   std::unordered_map<HashValue, std::unique_ptr<StategraphState>> states_;
+
+  // The compiled tables.  The |next_transitions_| entry at
+  // (from * num states + to) is the index, within the Transitions of the
+  // |from| State, of the first Transition on the path to the |to| State.
+  bool compiled_ = false;
+  std::unordered_map<HashValue, size_t> state_indices_;
+  std::vector<const StategraphState*> indexed_states_;
+  std::vector<uint16_t> next_transitions_;
 };
 
 }  // namespace lull
@@ -77,12 +77,54 @@ AnimationChannel::Animation* AnimationChannel::DoInitialize(
 }
 
 void AnimationChannel::Update(std::vector<AnimationId>* completed) {
+  Evaluate();
+  Commit(completed);
+}
+
+void AnimationChannel::Evaluate() {
+  anims_.ForEach([&](Animation& anim) {
+    if (anim.rig_motivator.Valid()) {
+      // The motivator's transforms are passed directly to SetRig().
+    } else if (anim.motivator.Valid()) {
+      // Apply the offsets and multipliers to the motivator's current values.
+      const size_t dimensions = anim.motivator.Dimensions();
+      const size_t num_offsets = anim.base_offset.size();
+      const size_t num_multiplier = anim.multiplier.size();
+      const float* anim_values = anim.motivator.Values();
+      for (int i = 0; i < dimensions; ++i) {
+        anim.scratch[i] =
+            (i < num_offsets ? anim.base_offset[i] : 0.f) +
+            (anim_values[i] * (i < num_multiplier ? anim.multiplier[i] : 1.f));
+      }
+    } else {
+      LOG(ERROR) << "Invalid motivator detected during playback!";
+      anim.total_time = 0;
+    }
+    anim.complete = IsComplete(anim);
+    anim.evaluated = true;
+  });
+}
+
+void AnimationChannel::Commit(std::vector<AnimationId>* completed,
+                              const std::unordered_set<Entity>* skipped) {
   // Track which animations need to be cancelled since we do not want to remove
   // them during iteration.
   std::vector<Entity> anims_to_cancel;
 
   anims_.ForEach([&](Animation& anim) {
+    // Skip animations that were (re)started since Evaluate(), eg. by a Set()
+    // call earlier in this loop.  They will be committed next frame.
+    if (!anim.evaluated) {
+      return;
+    }
+    anim.evaluated = false;
+
+    // Completed animations are always committed so that they end on their
+    // final values.
     const Entity entity = anim.GetEntity();
+    if (skipped && !anim.complete && skipped->count(entity) != 0) {
+      return;
+    }
 
     if (anim.rig_motivator.Valid()) {
       // Update the Component data to match the motivator's transforms.
@@ -96,25 +138,14 @@ void AnimationChannel::Update(std::vector<AnimationId>* completed) {
     } else if (anim.motivator.Valid()) {
       // Update the Component data to match the motivator's current values.
       const size_t dimensions = anim.motivator.Dimensions();
-      const size_t num_offsets = anim.base_offset.size();
-      const size_t num_multiplier = anim.multiplier.size();
-      const float* anim_values = anim.motivator.Values();
-      for (int i = 0; i < dimensions; ++i) {
-        anim.scratch[i] =
-            (i < num_offsets ? anim.base_offset[i] : 0.f) +
-            (anim_values[i] * (i < num_multiplier ? anim.multiplier[i] : 1.f));
-      }
       if (!UsesAnimationContext()) {
         Set(entity, anim.scratch.data(), dimensions);
       } else {
         Set(entity, anim.scratch.data(), dimensions, anim.context);
       }
-    } else {
-      LOG(ERROR) << "Invalid motivator detected during playback!";
-      anim.total_time = 0;
     }
 
-    if (IsComplete(anim)) {
+    if (anim.complete) {
       anims_to_cancel.push_back(anim.GetEntity());
       completed->push_back(anim.id);
     }
@@ -327,6 +358,8 @@ void AnimationChannel::SetLooping(Entity entity, bool looping) {
 AnimationId AnimationChannel::UpdateId(Animation* anim, AnimationId id) {
   const AnimationId previous_id = anim->id;
   anim->id = id;
+  // The new animation will be evaluated on the next frame.
+  anim->evaluated = false;
   return previous_id;
 }
 
@@ -18,6 +18,7 @@ limitations under the License.
 #define LULLABY_SYSTEMS_ANIMATION_ANIMATION_CHANNEL_H_
 
 #include <memory>
+#include <unordered_set>
 #include "lullaby/events/animation_events.h"
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/systems/animation/playback_parameters.h"
@@ -73,8 +74,26 @@ class AnimationChannel {
 
   // Copies all the data from the Motivator into the Component.  Updates the
   // |completed| vector with information about Animations that have completed.
+  // Equivalent to calling Evaluate() followed by Commit().
   void Update(std::vector<AnimationId>* completed);
 
+  // Reads the current values of all the Motivators and determines which
+  // Animations have completed, without modifying any Components.  This only
+  // touches data owned by the channel, so different channels can be evaluated
+  // concurrently (after the MotiveEngine has been advanced).
+  void Evaluate();
+
+  // Copies the values read by the last Evaluate() into the Components, then
+  // cancels completed Animations and adds them to |completed|.  The values of
+  // Entities in |skipped| (if any) are not copied unless their Animation has
+  // completed.  This must be called on the same thread as the other Systems'
+  // updates.
+  void Commit(std::vector<AnimationId>* completed,
+              const std::unordered_set<Entity>* skipped = nullptr);
+
+  // Returns the number of animations currently playing on this channel.
+  size_t GetNumAnimations() const { return anims_.Size(); }
+
   // Plays a new animation (with the given |id|) on the |entity|.  The animation
   // sets the motivator to animate towards the specified |target_value| array
   // (of size |length|) over the given |time| duration, after a |delay|.
@@ -155,6 +174,9 @@ class AnimationChannel {
     std::vector<float> scratch;
     motive::MotiveTime total_time = 0;
     AnimationId id = kNullAnimation;
+    // Set by Evaluate() for the following Commit().
+    bool evaluated = false;
+    bool complete = false;
   };
 
   // Updates the |anim| with the new |id|, returning the previously set
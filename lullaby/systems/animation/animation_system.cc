@@ -16,11 +16,16 @@ limitations under the License.
 
 #include "lullaby/systems/animation/animation_system.h"
 
+#include <algorithm>
+
 #include "lullaby/events/animation_events.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/system_profiler.h"
 #include "lullaby/modules/file/asset_loader.h"
 #include "lullaby/modules/script/function_binder.h"
 #include "lullaby/systems/dispatcher/event.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/job_processor.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/util/time.h"
 #include "lullaby/util/trace.h"
@@ -35,7 +40,11 @@ namespace {
 
 const HashValue kAnimationDef = ConstHash("AnimationDef");
 const HashValue kAnimationResponseDef = ConstHash("AnimationResponseDef");
+const HashValue kAnimationLodDef = ConstHash("AnimationLodDef");
 constexpr const char* kMotiveListExtension = "motivelist";
+// Below this many playing animations, evaluating the channels is faster than
+// dispatching jobs to evaluate them.
+constexpr size_t kMinAnimationsForJobs = 64;
 
 inline bool IsMotiveListFile(const std::string& filename, size_t start_pos,
                              size_t end_pos) {
@@ -51,6 +60,7 @@ AnimationSystem::AnimationSystem(Registry* registry)
     : System(registry), current_id_(kNullAnimation) {
   RegisterDef<AnimationDefT>(this);
   RegisterDef<AnimationResponseDefT>(this);
+  RegisterDef<AnimationLodDefT>(this);
 
   motive::RigInit::Register();
   motive::SqtInit::Register();
@@ -117,6 +127,13 @@ void AnimationSystem::Create(Entity entity, HashValue type, const Def* def) {
     if (data->defining_animation()) {
       LOG(INFO) << "Defining animations are no longer supported or necessary.";
     }
+  } else if (type == kAnimationLodDef) {
+    const AnimationLodDef* data = ConvertDef<AnimationLodDef>(def);
+    LodParams params;
+    params.min_screen_size = data->min_screen_size();
+    params.reduced_update_interval = data->reduced_update_interval();
+    params.freeze_when_offscreen = data->freeze_when_offscreen();
+    SetLodParams(entity, params);
   }
 }
 
@@ -129,6 +146,7 @@ void AnimationSystem::PostCreateInit(Entity e, HashValue type, const Def* def) {
 
 void AnimationSystem::Destroy(Entity entity) {
   CancelAllAnimations(entity);
+  lod_params_.erase(entity);
 }
 
 void AnimationSystem::CancelAllAnimations(Entity entity) {
@@ -185,18 +203,24 @@ void AnimationSystem::UnloadAnimation(const std::string& filename) {
   assets_.Release(Hash(filename));
 }
 
-void AnimationSystem::UnloadAllAnimations() { assets_.Reset(); }
+void AnimationSystem::UnloadAllAnimations() { assets_.ReleaseAll(); }
 
 void AnimationSystem::AdvanceFrame(Clock::duration delta_time) {
+  SystemProfiler::ScopedSample sample(registry_, this);
   LULLABY_CPU_TRACE("AnimAdvance");
   const motive::MotiveTime timestep =
       GetMotiveTimeFromDuration(delta_time + accumulated_time_error_);
   accumulated_time_error_ += (delta_time - GetDurationFromMotiveTime(timestep));
   engine_.AdvanceFrame(timestep);
 
+  // Reading the motivators is independent per channel and can be done in
+  // parallel, but the channels' Set() functions modify other Systems, so the
+  // results are committed serially.
+  EvaluateChannels();
+  UpdateLod();
   std::vector<AnimationId> completed;
   for (auto& channel : channels_) {
-    channel.second->Update(&completed);
+    channel.second->Commit(&completed, &lod_skipped_);
   }
 
   for (const AnimationId id : completed) {
@@ -204,6 +228,118 @@ void AnimationSystem::AdvanceFrame(Clock::duration delta_time) {
   }
 }
 
+void AnimationSystem::EvaluateChannels() {
+  size_t num_animations = 0;
+  active_channels_.clear();
+  for (auto& channel : channels_) {
+    const size_t count = channel.second->GetNumAnimations();
+    if (count > 0) {
+      active_channels_.push_back(channel.second.get());
+      num_animations += count;
+    }
+  }
+
+#if !LULLABY_USE_JAVASCRIPT_TIMERS
+  auto* job_processor = registry_->Get<JobProcessor>();
+  if (job_processor && active_channels_.size() > 1 &&
+      num_animations >= kMinAnimationsForJobs) {
+    // Dispatch all but the first channel to the worker threads, and evaluate
+    // the first channel on this thread while waiting.
+    std::vector<JobProcessor::JobHandle> jobs;
+    jobs.reserve(active_channels_.size() - 1);
+    for (size_t i = 1; i < active_channels_.size(); ++i) {
+      AnimationChannel* channel = active_channels_[i];
+      jobs.emplace_back(job_processor->Run([channel]() {
+        channel->Evaluate();
+      }));
+    }
+    active_channels_[0]->Evaluate();
+    for (const auto& job : jobs) {
+      job_processor->Wait(job);
+    }
+    return;
+  }
+#endif
+  for (AnimationChannel* channel : active_channels_) {
+    channel->Evaluate();
+  }
+}
+
+void AnimationSystem::SetLodParams(Entity entity, const LodParams& params) {
+  if (params.reduced_update_interval < 1) {
+    LOG(DFATAL) << "The reduced update interval must be at least 1.";
+    return;
+  }
+  lod_params_[entity] = params;
+}
+
+void AnimationSystem::ClearLodParams(Entity entity) {
+  lod_params_.erase(entity);
+}
+
+void AnimationSystem::SetLodViews(const RenderView* views, size_t num_views) {
+  lod_views_.resize(num_views);
+  for (size_t i = 0; i < num_views; ++i) {
+    LodView& lod_view = lod_views_[i];
+    GetViewFrustum(views[i], lod_view.frustum);
+    lod_view.eye_position =
+        views[i].world_from_eye_matrix.TranslationVector3D();
+    lod_view.projection_scale = views[i].clip_from_eye_matrix(1, 1);
+  }
+}
+
+void AnimationSystem::UpdateLod() {
+  lod_skipped_.clear();
+  ++lod_frame_;
+
+  const auto* transform_system = registry_->Get<TransformSystem>();
+  if (lod_views_.empty() || lod_params_.empty() || !transform_system) {
+    return;
+  }
+
+  for (const auto& iter : lod_params_) {
+    const Entity entity = iter.first;
+    const LodParams& params = iter.second;
+    const mathfu::mat4* world_from_entity_mat =
+        transform_system->GetWorldFromEntityMatrix(entity);
+    const Aabb* box = transform_system->GetAabb(entity);
+    if (!world_from_entity_mat || !box) {
+      continue;
+    }
+
+    const mathfu::vec4 sphere =
+        TransformSystem::CalculateBoundingSphere(*world_from_entity_mat, *box);
+    const mathfu::vec3 center = sphere.xyz();
+    bool visible = false;
+    float screen_size = 0.f;
+    for (const LodView& view : lod_views_) {
+      if (!CheckSphereInFrustum(center, sphere.w, view.frustum)) {
+        continue;
+      }
+      visible = true;
+      const float distance = (center - view.eye_position).Length();
+      screen_size = distance > sphere.w
+                        ? std::max(screen_size, view.projection_scale *
+                                                    sphere.w / distance)
+                        : 1.f;
+    }
+
+    if (!visible) {
+      if (params.freeze_when_offscreen) {
+        lod_skipped_.insert(entity);
+      }
+    } else if (screen_size < params.min_screen_size) {
+      // Offset the frame by the entity so that the updates of many small
+      // entities are spread over the interval.
+      const uint32_t interval =
+          static_cast<uint32_t>(params.reduced_update_interval);
+      if ((lod_frame_ + entity.AsUint32()) % interval != 0) {
+        lod_skipped_.insert(entity);
+      }
+    }
+  }
+}
+
 void AnimationSystem::CancelAnimation(Entity e, HashValue channel) {
   auto iter = channels_.find(channel);
   if (iter != channels_.end()) {
@@ -20,18 +20,21 @@ limitations under the License.
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "lullaby/generated/animation_def_generated.h"
 #include "lullaby/generated/animation_response_def_generated.h"
 #include "lullaby/events/animation_events.h"
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
+#include "lullaby/modules/render/render_view.h"
 #include "lullaby/systems/animation/animation_asset.h"
 #include "lullaby/systems/animation/animation_channel.h"
 #include "lullaby/systems/animation/playback_parameters.h"
 #include "lullaby/systems/animation/spline_modifiers.h"
 #include "lullaby/systems/dispatcher/event.h"
 #include "lullaby/util/clock.h"
+#include "lullaby/util/math.h"
 #include "lullaby/util/resource_manager.h"
 #include "lullaby/util/span.h"
 #include "motive/common.h"
@@ -85,9 +88,35 @@ class AnimationSystem : public System {
 
   // Advances all animations by the specified |delta_time| and updates all
   // AnimationChannels, pushing the updated animation data to their
-  // corresponding Systems.
+  // corresponding Systems.  If a JobProcessor is available in the Registry, the
+  // channels are evaluated on its worker threads, but the data is always pushed
+  // to the other Systems on this thread, in the same order as without it.
   void AdvanceFrame(Clock::duration delta_time);
 
+  // Level-of-detail settings for an Entity's animations.  See AnimationLodDef
+  // for a description of each setting.
+  struct LodParams {
+    float min_screen_size = 0.f;
+    int reduced_update_interval = 4;
+    bool freeze_when_offscreen = true;
+  };
+
+  // Sets the level-of-detail settings for |entity|'s animations.  They only
+  // take effect while there are views set by SetLodViews().
+  void SetLodParams(Entity entity, const LodParams& params);
+
+  // Removes the level-of-detail settings for |entity|, so its animations are
+  // applied every frame.
+  void ClearLodParams(Entity entity);
+
+  // Sets the views used to determine whether each Entity is on screen, and how
+  // large it is, for level-of-detail.  These are typically the views that were
+  // rendered in the previous frame, and should be updated whenever the camera
+  // moves.  Visibility is based on the Entity's bounding sphere from the
+  // TransformSystem, like the RenderSystem's frustum culling.  Setting no views
+  // disables level-of-detail.
+  void SetLodViews(const RenderView* views, size_t num_views);
+
   // Plays the animation curves specified in the Def on the Entity.  Returns a
   // unique AnimationId, which will be included in the AnimationCompleteEvent
   // dispatched when this animation finishes or is interrupted.
@@ -163,7 +192,9 @@ class AnimationSystem : public System {
   // Remove an animation asset from the cache.
   void UnloadAnimation(const std::string& filename);
 
-  // Remove all animation assets from the cache.
+  // Remove all animation assets from the cache. Assets that are still used
+  // (eg. by playing animations, or by the caller) stay alive and are returned
+  // by later loads of the same file without being loaded again.
   void UnloadAllAnimations();
 
   // A skeleton is defined as a list of Entities that represent the bones of
@@ -223,6 +254,14 @@ class AnimationSystem : public System {
   AnimationChannel* FindChannel(string_view channel_name);
   AnimationChannel* FindChannel(HashValue channel_id);
 
+  // Calls Evaluate() on all the channels with playing animations, fanning out
+  // to the JobProcessor if there is enough work.
+  void EvaluateChannels();
+
+  // Fills |lod_skipped_| with the Entities whose animations should not be
+  // applied this frame.
+  void UpdateLod();
+
   AnimationId GenerateAnimationId();
   AnimationId TrackAnimations(Entity e, AnimationSet anims,
                               const AnimationDef* data);
@@ -250,11 +289,25 @@ class AnimationSystem : public System {
   motive::MotiveEngine engine_;
   ResourceManager<AnimationAsset> assets_;
   std::unordered_map<HashValue, AnimationChannelPtr> channels_;
+  // Channels with playing animations, gathered by EvaluateChannels().
+  std::vector<AnimationChannel*> active_channels_;
   std::unordered_map<AnimationId, AnimationSetEntry> external_id_to_entry_;
   std::unordered_map<AnimationId, AnimationId> internal_to_external_ids_;
   std::unordered_map<Entity, SkeletonComponent> skeletons_;
   Clock::duration accumulated_time_error_ = Clock::duration::zero();
 
+  struct LodView {
+    mathfu::vec4 frustum[kNumFrustumPlanes];
+    mathfu::vec3 eye_position;
+    // Converts a radius over a distance from the eye into a fraction of the
+    // viewport height.
+    float projection_scale;
+  };
+  std::unordered_map<Entity, LodParams> lod_params_;
+  std::vector<LodView> lod_views_;
+  std::unordered_set<Entity> lod_skipped_;
+  uint32_t lod_frame_ = 0;
+
   AnimationSystem(const AnimationSystem&) = delete;
   AnimationSystem& operator=(const AnimationSystem&) = delete;
 };
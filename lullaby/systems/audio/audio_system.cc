@@ -28,6 +28,7 @@ limitations under the License.
 #include "lullaby/events/lifetime_events.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/dispatcher/event_wrapper.h"
+#include "lullaby/modules/ecs/system_profiler.h"
 #include "lullaby/modules/flatbuffers/mathfu_fb_conversions.h"
 #include "lullaby/modules/gvr/mathfu_gvr_conversions.h"
 #include "lullaby/modules/script/function_binder.h"
@@ -157,6 +158,8 @@ AudioSystem::AudioSystem(Registry* registry, std::unique_ptr<gvr::AudioApi> api)
       current_environment_(kNullEntity),
       audio_running_(false),
       transform_flag_(TransformSystem::kInvalidFlag),
+      num_sources_(0),
+      next_play_id_(1),
       master_volume_(1.0),
       muted_(false) {
   if (audio_) {
@@ -320,6 +323,7 @@ AudioSystem::~AudioSystem() {
   }
   auto* transform_system = registry_->Get<TransformSystem>();
   if (transform_system && transform_flag_ != TransformSystem::kInvalidFlag) {
+    transform_system->UntrackChanges(transform_flag_);
     transform_system->ReleaseFlag(transform_flag_);
   }
   auto* binder = registry_->Get<lull::FunctionBinder>();
@@ -349,6 +353,7 @@ AudioSystem::~AudioSystem() {
 void AudioSystem::Initialize() {
   auto* transform_system = registry_->Get<TransformSystem>();
   transform_flag_ = transform_system->RequestFlag();
+  transform_system->TrackChanges(transform_flag_);
 }
 
 void AudioSystem::Create(Entity e, HashValue type, const Def* def) {
@@ -385,6 +390,14 @@ void AudioSystem::Destroy(Entity e) {
   environments_.Destroy(e);
 }
 
+size_t AudioSystem::GetNumComponents() const {
+  return sources_.Size() + environments_.Size();
+}
+
+size_t AudioSystem::GetComponentMemoryUsage() const {
+  return sources_.GetMemoryUsage() + environments_.GetMemoryUsage();
+}
+
 void AudioSystem::CreateEnvironment(Entity e, const AudioEnvironmentDef* data) {
   auto* model = environments_.Emplace(e);
   MathfuVec3FromFbVec3(data->room_dimensions(), &model->room_dimensions);
@@ -546,7 +559,7 @@ void AudioSystem::Play(Entity e, HashValue sound_hash,
     auto iter = source->sounds.find(sound_hash);
     if (iter != source->sounds.end()) {
       LOG(WARNING) << "Restarting sound: " << asset->GetFilename();
-      audio_->StopSound(iter->second.id);
+      StopSound(&iter->second);
       source->sounds.erase(iter);
     }
   }
@@ -557,6 +570,7 @@ void AudioSystem::Play(Entity e, HashValue sound_hash,
   sound.id = kInvalidSourceId;
   sound.asset_handle = asset;
   sound.params = params;
+  sound.play_id = next_play_id_++;
   // Use the sanitized playback type.
   sound.params.playback_type = playback_type;
 
@@ -568,13 +582,20 @@ void AudioSystem::Play(Entity e, HashValue sound_hash,
 
   // Only play-when-ready sounds that are still unloaded should be skipped at
   // this point.
-const bool ready =
-    playback_type != AudioPlaybackType::AudioPlaybackType_PlayWhenReady ||
-    status != SoundAsset::LoadStatus::kUnloaded;
+  const bool ready =
+      playback_type != AudioPlaybackType::AudioPlaybackType_PlayWhenReady ||
+      status != SoundAsset::LoadStatus::kUnloaded;
 
   if (ready) {
     PlaySound(&sound, sqt, asset);
+    if (sound.id == kInvalidSourceId) {
+      source->sounds.erase(sound_hash);
+      TryDestroySource(e);
+      return;
+    }
   }
+
+  watched_sounds_.emplace_back(e, sound_hash, sound.play_id);
 }
 
 void AudioSystem::Stop(Entity e, HashValue key) {
@@ -594,7 +615,7 @@ void AudioSystem::Stop(Entity e, HashValue key) {
       LOG(WARNING) << "Attempted to Stop() an external audio source.";
       return;
     }
-    audio_->StopSound(iter->second.id);
+    StopSound(&iter->second);
     source->sounds.erase(iter);
   } else {
     LOG(WARNING) << "Failed to find the specified sound to Stop().";
@@ -739,7 +760,7 @@ void AudioSystem::StopAll(Entity e) {
     for (auto& iter : source->sounds) {
       if (iter.second.params.playback_type !=
           AudioPlaybackType::AudioPlaybackType_External) {
-        audio_->StopSound(iter.second.id);
+        StopSound(&iter.second);
       }
     }
   }
@@ -761,69 +782,103 @@ void AudioSystem::TryDestroySource(Entity entity) {
   }
 }
 
-void AudioSystem::UpdateSource(AudioSource* source,
-                               const mathfu::mat4& world_from_entity) {
-  // Early-exit on Entities that are enabled in the TransformSystem but haven't
-  // had their OnEnabledEvent dispatched yet.
-  if (!source->enabled) {
-    return;
+AudioSystem::Sound* AudioSystem::GetWatchedSound(
+    const WatchedSound& watched) {
+  auto* source = sources_.Get(watched.entity);
+  if (source == nullptr) {
+    return nullptr;
   }
+  auto iter = source->sounds.find(watched.key);
+  if (iter == source->sounds.end() ||
+      iter->second.play_id != watched.play_id) {
+    return nullptr;
+  }
+  return &iter->second;
+}
 
-  const bool sqt_updated = UpdateSourceSqt(source, world_from_entity);
-  for (auto iter = source->sounds.begin(); iter != source->sounds.end();) {
-    Sound& sound = iter->second;
-    // Skip paused sounds or they'll be deleted.
-    if (sound.paused) {
-      ++iter;
-      continue;
-    }
-    const SourceId source_id = sound.id;
-    SoundAsset::LoadStatus status = SoundAsset::LoadStatus::kUnloaded;
-    SoundAssetPtr asset = nullptr;
+bool AudioSystem::UpdateWatchedSound(const WatchedSound& watched) {
+  Sound* sound = GetWatchedSound(watched);
+  if (sound == nullptr) {
+    // The sound was stopped or stolen, which may have left its source empty.
+    TryDestroySource(watched.entity);
+    return false;
+  }
 
-    // External playback sources will have null assets, but are considered
-    // loaded.
-    if (sound.params.playback_type ==
-        AudioPlaybackType::AudioPlaybackType_External) {
-      status = SoundAsset::LoadStatus::kLoaded;
-    } else {
-      // Non-looping sounds with unloaded assets can be forgotten and will be
-      // cleaned up by GVR Audio. Looping sounds must be held onto else they
-      // cannot be stopped.
-      asset = sound.asset_handle.lock();
-      if (asset) {
-        status = asset->GetLoadStatus();
-      } else if (!sound.params.loop) {
-        status = SoundAsset::LoadStatus::kFailed;
-      }
-    }
+  // Skip paused sounds or they'll be deleted. Also skip Entities that are
+  // enabled in the TransformSystem but haven't had their OnEnabledEvent
+  // dispatched yet.
+  auto* source = sources_.Get(watched.entity);
+  if (sound->paused || !source->enabled) {
+    return true;
+  }
 
-    // 1. Clear out any sounds that failed to load or stream.
-    // 2. If a play-when-ready sound is unloaded, skip it.
-    // 3. If a sound hasn't been assigned an id yet, play it. If it fails to
-    //    play for some reason, it will be cleaned up next Update().
-    // 4. If a sound is currently playing, update its transform.
-    // 5. If none of the above is true, this sound is done playing and should
-    //    be cleaned up.
-    if (status == SoundAsset::LoadStatus::kFailed) {
-      iter = source->sounds.erase(iter);
-    } else if (status == SoundAsset::LoadStatus::kUnloaded) {
-      ++iter;
-    } else if (source_id == kInvalidSourceId) {
-      PlaySound(&sound, source->sqt, asset);
-      ++iter;
-    } else if (audio_->IsSoundPlaying(source_id)) {
-      if (sqt_updated) {
-        UpdateSoundTransform(&sound, source->sqt);
+  // Non-looping sounds with unloaded assets can be forgotten and will be
+  // cleaned up by GVR Audio. Looping sounds must be held onto else they cannot
+  // be stopped.
+  SoundAsset::LoadStatus status = SoundAsset::LoadStatus::kUnloaded;
+  SoundAssetPtr asset = sound->asset_handle.lock();
+  if (asset) {
+    status = asset->GetLoadStatus();
+  } else if (!sound->params.loop) {
+    status = SoundAsset::LoadStatus::kFailed;
+  }
+
+  // 1. Clear out any sounds that failed to load or stream.
+  // 2. If a play-when-ready sound is unloaded, skip it.
+  // 3. If a sound hasn't been assigned an id yet, play it. If it fails to
+  //    play for some reason, clean it up.
+  // 4. If a sound is currently playing, keep watching it.
+  // 5. If none of the above is true, this sound is done playing and should
+  //    be cleaned up.
+  if (status == SoundAsset::LoadStatus::kUnloaded) {
+    return true;
+  } else if (status != SoundAsset::LoadStatus::kFailed) {
+    if (sound->id == kInvalidSourceId) {
+      PlaySound(sound, source->sqt, asset);
+      if (sound->id != kInvalidSourceId) {
+        return true;
       }
-      ++iter;
-    } else {
-      iter = source->sounds.erase(iter);
+    } else if (audio_->IsSoundPlaying(sound->id)) {
+      return true;
     }
   }
 
+  // A looping sound would otherwise keep playing with no way to stop it.
+  if (sound->params.loop) {
+    StopSound(sound);
+  } else {
+    ReleaseSource(sound);
+  }
+  source->sounds.erase(watched.key);
   // This call may invalidate |source|.
-  TryDestroySource(source->GetEntity());
+  TryDestroySource(watched.entity);
+  return false;
+}
+
+void AudioSystem::UpdateChangedTransforms() {
+  auto* transform_system = registry_->Get<TransformSystem>();
+  transform_system->TakeUniqueChangedEntities(transform_flag_,
+                                              &changed_entities_);
+
+  for (const Entity entity : changed_entities_) {
+    auto* source = sources_.Get(entity);
+    // Disabled sources are refreshed by OnEntityEnabled().
+    if (source == nullptr || !source->enabled) {
+      continue;
+    }
+    const mathfu::mat4* world_from_entity_mat =
+        transform_system->GetWorldFromEntityMatrix(entity);
+    if (world_from_entity_mat == nullptr ||
+        !UpdateSourceSqt(source, *world_from_entity_mat)) {
+      continue;
+    }
+    for (auto& iter : source->sounds) {
+      if (iter.second.id != kInvalidSourceId) {
+        UpdateSoundTransform(&iter.second, source->sqt);
+      }
+    }
+  }
+  changed_entities_.clear();
 }
 
 bool AudioSystem::UpdateSourceSqt(AudioSource* source, const mathfu::mat4& m) {
@@ -845,6 +900,7 @@ bool AudioSystem::UpdateSourceSqt(AudioSource* source, const mathfu::mat4& m) {
 }
 
 void AudioSystem::Update() {
+  SystemProfiler::ScopedSample sample(registry_, this);
   // An OnPauseThreadUnsafeEvent may turn off audio playback while updating,
   // which can incorrectly label some sounds as not running anymore.
   std::lock_guard<std::mutex> lock(pause_mutex_);
@@ -863,13 +919,17 @@ void AudioSystem::Update() {
     audio_->SetHeadPose(ConvertToGvrHeadPoseMatrix(*world_mat));
   }
 
-  transform_system->ForEach(
-      transform_flag_,
-      [this](Entity e, const mathfu::mat4& world_from_entity_mat,
-             const Aabb& box) {
-        auto* source = sources_.Get(e);
-        UpdateSource(source, world_from_entity_mat);
-      });
+  UpdateChangedTransforms();
+
+  size_t num_watched = 0;
+  for (const WatchedSound& watched : watched_sounds_) {
+    if (UpdateWatchedSound(watched)) {
+      watched_sounds_[num_watched++] = watched;
+    }
+  }
+  watched_sounds_.erase(watched_sounds_.begin() + num_watched,
+                        watched_sounds_.end());
+  UpdateOrphanedSources();
 
   audio_->Update();
 }
@@ -1115,6 +1175,12 @@ void AudioSystem::PlaySound(Sound* sound, const Sqt& sqt,
     return;
   }
 
+  if (num_sources_ >= kMaxSources && !StealSource()) {
+    LOG(WARNING) << "No audio sources available to play: "
+                 << asset->GetFilename();
+    return;
+  }
+
   SourceId new_id = kInvalidSourceId;
   switch (sound->params.source_type) {
     case AudioSourceType::AudioSourceType_Soundfield:
@@ -1130,6 +1196,7 @@ void AudioSystem::PlaySound(Sound* sound, const Sqt& sqt,
 
   sound->id = new_id;
   if (new_id != kInvalidSourceId) {
+    ++num_sources_;
     if (IsSpatialDirectivityEnabled(sound)) {
       audio_->SetSoundObjectDirectivity(
           sound->id, sound->params.spatial_directivity_alpha,
@@ -1151,6 +1218,53 @@ void AudioSystem::PlaySound(Sound* sound, const Sqt& sqt,
   }
 }
 
+void AudioSystem::StopSound(Sound* sound) {
+  audio_->StopSound(sound->id);
+  ReleaseSource(sound);
+}
+
+void AudioSystem::ReleaseSource(Sound* sound) {
+  if (sound->id != kInvalidSourceId &&
+      sound->params.playback_type !=
+          AudioPlaybackType::AudioPlaybackType_External) {
+    --num_sources_;
+  }
+  sound->id = kInvalidSourceId;
+}
+
+bool AudioSystem::StealSource() {
+  if (!orphaned_sources_.empty()) {
+    audio_->StopSound(orphaned_sources_.front());
+    orphaned_sources_.erase(orphaned_sources_.begin());
+    --num_sources_;
+    return true;
+  }
+  for (const WatchedSound& watched : watched_sounds_) {
+    Sound* sound = GetWatchedSound(watched);
+    if (sound == nullptr || sound->id == kInvalidSourceId ||
+        sound->params.loop) {
+      continue;
+    }
+    // The AudioSource is left for UpdateWatchedSound() to clean up.
+    StopSound(sound);
+    sources_.Get(watched.entity)->sounds.erase(watched.key);
+    return true;
+  }
+  return false;
+}
+
+void AudioSystem::UpdateOrphanedSources() {
+  size_t num_orphaned = 0;
+  for (const SourceId id : orphaned_sources_) {
+    if (audio_->IsSoundPlaying(id)) {
+      orphaned_sources_[num_orphaned++] = id;
+    } else {
+      --num_sources_;
+    }
+  }
+  orphaned_sources_.resize(num_orphaned);
+}
+
 void AudioSystem::UpdateSoundTransform(Sound* sound, const Sqt& sqt) {
   if (sound->params.source_type ==
       AudioSourceType::AudioSourceType_SoundObject) {
@@ -1182,8 +1296,22 @@ void AudioSystem::OnEntityEnabled(Entity entity) {
   if (source && !source->enabled) {
     source->enabled = true;
     if (audio_) {
+      // Transform changes are ignored while the source is disabled, so catch
+      // up on any that were missed.
+      auto* transform_system = registry_->Get<TransformSystem>();
+      const mathfu::mat4* world_from_entity_mat =
+          transform_system->GetWorldFromEntityMatrix(entity);
+      const bool sqt_updated =
+          world_from_entity_mat &&
+          UpdateSourceSqt(source, *world_from_entity_mat);
       for (auto& iter : source->sounds) {
         Sound& sound = iter.second;
+        if (sound.id == kInvalidSourceId) {
+          continue;
+        }
+        if (sqt_updated) {
+          UpdateSoundTransform(&sound, source->sqt);
+        }
         if (!sound.paused) {
           audio_->ResumeSound(sound.id);
         }
@@ -1209,7 +1337,16 @@ void AudioSystem::OnEntityDisabled(Entity entity) {
           ++iter;
         } else {
           // Non-looped sounds are forgotten. They will continue playback if not
-          // finished.
+          // finished, so their sources are only returned to the pool once they
+          // are done.
+          if (sound.id != kInvalidSourceId &&
+              sound.params.playback_type !=
+                  AudioPlaybackType::AudioPlaybackType_External) {
+            orphaned_sources_.push_back(sound.id);
+            sound.id = kInvalidSourceId;
+          } else {
+            ReleaseSource(&sound);
+          }
           iter = source->sounds.erase(iter);
         }
       }
@@ -64,6 +64,9 @@ class AudioSystem : public System {
   // Stop playing all sounds on the Entity.
   void Destroy(Entity e) override;
 
+  size_t GetNumComponents() const override;
+  size_t GetComponentMemoryUsage() const override;
+
   // Play a sound on an Entity based on the hash of the sound name. This assumes
   // the sound asset has been loaded by calling LoadSound().
   void Play(Entity e, HashValue sound_hash, const PlaySoundParameters& params);
@@ -89,7 +92,9 @@ class AudioSystem : public System {
   // Stop tracking the specified sound on the Entity.
   void Untrack(Entity e, HashValue key);
 
-  // Update positions for all audio sources in the world.
+  // Updates the positions of the audio sources whose transforms changed since
+  // the last Update(), starts sounds whose assets finished loading, and cleans
+  // up sounds that finished playing.
   void Update();
 
   // Mute or unmute all audio. Unmute will restore the master volume that was
@@ -166,11 +171,31 @@ class AudioSystem : public System {
   using SourceId = gvr::AudioSourceId;
   static const SourceId kInvalidSourceId = gvr::kInvalidSourceId;
 
+  // The maximum number of sources created by Play() that may be alive at once.
+  // GVR Audio binds each source to a single sound file, so sources cannot be
+  // reused across plays; instead, when the pool is full, the oldest playing
+  // non-looping sound is stopped to make room for the new one. Non-looping
+  // sounds left playing by disabled Entities count until they finish.
+  static const size_t kMaxSources = 32;
+
   struct Sound {
     SourceId id = kInvalidSourceId;
     SoundAssetWeakPtr asset_handle;
     PlaySoundParameters params;
     bool paused = false;
+    // Identifies the call to Play() that created this sound.
+    uint64_t play_id = 0;
+  };
+
+  // A sound started by Play() which may change state without the AudioSystem
+  // being told: it may be waiting for its asset to load, finish on its own, or,
+  // if it is a looping stream, fail.
+  struct WatchedSound {
+    WatchedSound(Entity entity, HashValue key, uint64_t play_id)
+        : entity(entity), key(key), play_id(play_id) {}
+    Entity entity;
+    HashValue key;
+    uint64_t play_id;
   };
 
   struct AudioListener : Component {
@@ -208,11 +233,19 @@ class AudioSystem : public System {
   void CreateResponse(Entity entity, const AudioResponseDef* data);
   void CreateListener(Entity e, const AudioListenerDef* data);
 
-  // Check and update the state of all of |sources|'s sounds. This includes
-  // playing sounds that have just finished loading, updating the transforms of
-  // sounds that are still playing, and cleaning up sounds that either failed
-  // to play or are finished playing.
-  void UpdateSource(AudioSource* source, const mathfu::mat4& world_from_entity);
+  // Returns the sound referred to by |watched|, or null if it has since been
+  // stopped or restarted.
+  Sound* GetWatchedSound(const WatchedSound& watched);
+
+  // Check and update the state of the sound referred to by |watched|. This
+  // includes playing sounds that have just finished loading and cleaning up
+  // sounds that either failed to play or are finished playing. Returns true if
+  // the sound still needs to be watched.
+  bool UpdateWatchedSound(const WatchedSound& watched);
+
+  // Updates the transforms of the sounds on all the Entities whose world
+  // transforms changed since the last call.
+  void UpdateChangedTransforms();
 
   // Check if |source|'s previous SQT is different than |world_from_entity|. If
   // it is, update |sources|'s stored SQT and return true. Otherwise, return
@@ -222,14 +255,31 @@ class AudioSystem : public System {
 
   // Attempts to play |sound| using |sqt| as its transform. If the playback is
   // successful, the |sound|'s id will be set to the source id. If not, it will
-  // be set to the invalid source id, and |asset| will be marked as "failed"
-  // to prevent future playback attempts.
+  // be set to the invalid source id, and, unless the pool of sources was
+  // exhausted, |asset| will be marked as "failed" to prevent future playback
+  // attempts.
   void PlaySound(Sound* sound, const Sqt& sqt, const SoundAssetPtr& asset);
 
   // Pause or resume |sound| and update its tracked pause state.
   void PauseSound(Sound* sound);
   void ResumeSound(Sound* sound);
 
+  // Stop |sound| and return its source to the pool.
+  void StopSound(Sound* sound);
+
+  // Return |sound|'s source to the pool without stopping it, for sounds that
+  // have finished or are left to finish on their own.
+  void ReleaseSource(Sound* sound);
+
+  // Stops the oldest playing non-looping sound to make room in the pool of
+  // sources, preferring those left playing by disabled Entities. Returns false
+  // if there is no such sound. Does not destroy any AudioSource components, so
+  // pointers to them remain valid.
+  bool StealSource();
+
+  // Returns the sources of orphaned sounds that have finished to the pool.
+  void UpdateOrphanedSources();
+
   // Update |sound|'s spatial rendering information to match |sqt|.
   void UpdateSoundTransform(Sound* sound, const Sqt& sqt);
 
@@ -259,6 +309,14 @@ class AudioSystem : public System {
   std::mutex pause_mutex_;
   bool audio_running_;
   TransformSystem::TransformFlags transform_flag_;
+  // Ordered from the oldest to the most recently played.
+  std::vector<WatchedSound> watched_sounds_;
+  // Sources of non-looping sounds forgotten by disabled Entities which may
+  // still be playing. Ordered from the oldest to the most recently orphaned.
+  std::vector<SourceId> orphaned_sources_;
+  std::vector<Entity> changed_entities_;
+  size_t num_sources_;
+  uint64_t next_play_id_;
   float master_volume_;
   bool muted_;
 
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/systems/blend_shape/blend_shape_system.h"
 
+#include <algorithm>
+
 #include "lullaby/generated/blend_shape_def_generated.h"
 #include "lullaby/modules/file/asset_loader.h"
 #include "lullaby/systems/render/render_system.h"
@@ -25,6 +27,24 @@ limitations under the License.
 namespace lull {
 namespace {
 
+// Meshes are only split into jobs if each job gets at least this many
+// vertices.
+constexpr size_t kMinVerticesPerJob = 4096;
+
+// Set on the vertices that were blended by the last update.
+constexpr uint8_t kVertexBlended = 0x1;
+// Set on the vertices that are touched by the current update.
+constexpr uint8_t kVertexTouched = 0x2;
+
+BlendShapeSystem::BlendableVertex NeutralVertex() {
+  BlendShapeSystem::BlendableVertex vertex;
+  vertex.position = mathfu::kZeros3f;
+  vertex.normal = mathfu::kZeros3f;
+  vertex.tangent = mathfu::kZeros3f;
+  vertex.orientation = mathfu::quat::identity;
+  return vertex;
+}
+
 int GetAttributeOffset(const VertexFormat& format, VertexAttributeUsage usage) {
   auto* attribute = format.GetAttributeWithUsage(usage);
   if (attribute) {
@@ -106,82 +126,121 @@ void BlendShapeSystem::BlendData::ReadVertex(
   }
 }
 
-void BlendShapeSystem::BlendData::UpdateMesh(Span<float> weights) {
+void BlendShapeSystem::BlendData::UpdateMesh(Span<float> weights,
+                                             JobProcessor* job_processor) {
   if (weights.size() < blend_shapes.size()) {
     LOG(WARNING) << "Not enough weights specified, missing weights will "
                  << "default to 0.";
   }
-  BlendVertexParams blend_params;
 
-  for (size_t index = 0; index < mesh.GetNumVertices(); ++index) {
-    // Get the original position, normal, and orientation for this vertex.
-    ReadVertex(base_shape.GetReadPtr(), blend_vertex_size, index, blend_offsets,
-               &blend_params.neutral);
-
-    // The calculated position will start at the neutral position and will be
-    // deflected by each applicable blend shape.
-    blend_params.calculated.position = blend_params.neutral.position;
-
-    if (mode == kInterpolate) {
-      // If we knew the total weight available to distribute across the blends,
-      // we could properly weight the neutral_norm. But we don't, so we assume
-      // the neutral norm goes unused unless no other normal is considered.
-      blend_params.calculated.normal = mathfu::kZeros3f;
-      blend_params.calculated.tangent = mathfu::kZeros3f;
-      blend_params.calculated.orientation = mathfu::quat::identity;
-    } else if (mode == kDisplacement) {
-      // Displacement mode simply displaces the normal and tangent and then
-      // re-normalizes them.
-      blend_params.calculated.normal = blend_params.neutral.normal;
-      blend_params.calculated.tangent = blend_params.neutral.tangent;
+  // Don't waste cycles on shapes without weights, or whose clamped weight is
+  // zero.
+  std::vector<ActiveBlendShape> active_shapes;
+  const size_t num_weights = std::min(weights.size(), blend_shapes.size());
+  for (size_t blend_index = 0; blend_index < num_weights; ++blend_index) {
+    const float weight = mathfu::Clamp(weights[blend_index], 0.f, 1.f);
+    if (weight != 0.f) {
+      active_shapes.push_back({&blend_shapes[blend_index], weight});
     }
+  }
 
-    bool blend_shapes_used = false;
-    for (size_t blend_index = 0; blend_index < blend_shapes.size();
-         ++blend_index) {
-      // Don't waste cycles if no weight is present.
-      if (blend_index >= weights.size()) {
-        continue;
-      }
-
-      blend_params.weight = mathfu::Clamp(weights[blend_index], 0.f, 1.f);
+  const size_t num_vertices = mesh.GetNumVertices();
+  const size_t num_jobs = num_vertices / kMinVerticesPerJob;
+#if !LULLABY_USE_JAVASCRIPT_TIMERS
+  if (job_processor && num_jobs > 1) {
+    // Each job updates its own range of vertices, so they don't share any
+    // output. Dispatch all but the first range to the worker threads, and
+    // update the first range on this thread while waiting.
+    const size_t vertices_per_job = (num_vertices + num_jobs - 1) / num_jobs;
+    std::vector<JobProcessor::JobHandle> jobs;
+    jobs.reserve(num_jobs - 1);
+    for (size_t begin = vertices_per_job; begin < num_vertices;
+         begin += vertices_per_job) {
+      const size_t end = std::min(begin + vertices_per_job, num_vertices);
+      jobs.emplace_back(
+          job_processor->Run([this, begin, end, &active_shapes]() {
+            UpdateVertices(begin, end, active_shapes);
+          }));
+    }
+    UpdateVertices(0, vertices_per_job, active_shapes);
+    for (const auto& job : jobs) {
+      job_processor->Wait(job);
+    }
+  } else {
+    UpdateVertices(0, num_vertices, active_shapes);
+  }
+#else
+  (void)job_processor;
+  (void)num_jobs;
+  UpdateVertices(0, num_vertices, active_shapes);
+#endif
+  current_weights.assign(weights.begin(), weights.end());
+}
 
-      // Don't waste cycles if clamped weight is zero.
-      if (blend_params.weight == 0.f) {
-        continue;
+void BlendShapeSystem::BlendData::UpdateVertices(
+    size_t begin, size_t end,
+    const std::vector<ActiveBlendShape>& active_shapes) {
+  // Sum the deltas of the active shapes for the vertices they change.
+  for (const ActiveBlendShape& active : active_shapes) {
+    const SparseBlendShape& shape = *active.shape;
+    auto iter = std::lower_bound(shape.vertices.begin(), shape.vertices.end(),
+                                 static_cast<uint32_t>(begin));
+    for (; iter != shape.vertices.end() && *iter < end; ++iter) {
+      const uint32_t index = *iter;
+      const VertexDelta& delta = shape.deltas[iter - shape.vertices.begin()];
+      VertexDelta& sum = summed_deltas[index];
+      if ((vertex_flags[index] & kVertexTouched) == 0) {
+        vertex_flags[index] |= kVertexTouched;
+        sum = VertexDelta();
       }
-      blend_shapes_used = true;
+      sum.position += delta.position * active.weight;
+      sum.normal += delta.normal * active.weight;
+      sum.tangent += delta.tangent * active.weight;
+    }
+  }
 
-      // Perform the blend on each vertex in turn. The result will be in
-      // blend_params.calculated.
-      ReadVertex(blend_shapes[blend_index].GetReadPtr(), blend_vertex_size,
-                 index, blend_offsets, &blend_params.blend);
-      BlendVertex(&blend_params, mode);
+  // In interpolate mode, the normal and tangent of each vertex is the sum of
+  // Lerp(neutral, blend, weight) over all the active shapes. That is the
+  // neutral value multiplied by the number of active shapes, plus the summed
+  // deltas, which will be normalized anyway.
+  const float neutral_scale = mode == kInterpolate && !active_shapes.empty()
+                                  ? static_cast<float>(active_shapes.size())
+                                  : 1.f;
+
+  // Write the touched vertices, and restore the vertices that were blended by
+  // the last update but aren't anymore.
+  BlendableVertex calculated = NeutralVertex();
+  for (size_t index = begin; index < end; ++index) {
+    const uint8_t flags = vertex_flags[index];
+    if (flags == 0) {
+      continue;
     }
 
-    // If no blend shapes were considered, use the neutral normal and
-    // orientation.
-    if (!blend_shapes_used) {
-      blend_params.calculated.normal = blend_params.neutral.normal;
-      blend_params.calculated.tangent = blend_params.neutral.tangent;
-      blend_params.calculated.orientation = blend_params.neutral.orientation;
+    // Get the original position, normal, and orientation for this vertex.
+    ReadVertex(base_shape.GetReadPtr(), blend_vertex_size, index, blend_offsets,
+               &calculated);
+    if (flags & kVertexTouched) {
+      const VertexDelta& sum = summed_deltas[index];
+      calculated.position += sum.position;
+      calculated.normal = calculated.normal * neutral_scale + sum.normal;
+      calculated.tangent = calculated.tangent * neutral_scale + sum.tangent;
     }
 
     // Only normalize attributes that will actually be used.
     if (mesh_offsets.normal >= 0 && blend_offsets.normal >= 0) {
-      blend_params.calculated.normal.Normalize();
+      calculated.normal.Normalize();
     }
     if (mesh_offsets.tangent >= 0 && blend_offsets.tangent >= 0) {
-      blend_params.calculated.tangent.Normalize();
+      calculated.tangent.Normalize();
     }
     if (mesh_offsets.orientation >= 0 && blend_offsets.orientation >= 0) {
-      blend_params.calculated.orientation.Normalize();
+      calculated.orientation.Normalize();
     }
 
     // Store the vertex into our computed_vertices.
-    UpdateMeshVertex(index, blend_params.calculated);
+    UpdateMeshVertex(index, calculated);
+    vertex_flags[index] = (flags & kVertexTouched) ? kVertexBlended : 0;
   }
-  current_weights.assign(weights.begin(), weights.end());
 }
 
 BlendShapeSystem::BlendShapeSystem(Registry* registry) : System(registry) {}
@@ -207,6 +266,12 @@ void BlendShapeSystem::InitBlendShape(Entity entity, MeshData mesh,
   blend.blend_offsets.tangent = GetTangentAttributeOffset(blend_format);
   blend.blend_vertex_size = blend_format.GetVertexSize();
 
+  // The first update writes every vertex, since the mesh may not match the
+  // base shape.
+  const size_t num_vertices = blend.mesh.GetNumVertices();
+  blend.summed_deltas.resize(num_vertices);
+  blend.vertex_flags.assign(num_vertices, kVertexBlended);
+
   // TODO: fix orientation blends.
   if (GetOrientationAttributeOffset(mesh_format) != -1 &&
       GetOrientationAttributeOffset(blend_format) != -1) {
@@ -223,8 +288,43 @@ void BlendShapeSystem::AddBlendShape(Entity entity, HashValue name,
   }
 
   BlendData& blend = iter->second;
+  const size_t num_vertices = blend.mesh.GetNumVertices();
+  if (blend_shape.GetSize() < num_vertices * blend.blend_vertex_size ||
+      blend.base_shape.GetSize() < num_vertices * blend.blend_vertex_size) {
+    LOG(DFATAL) << "Blend shape does not match the mesh of entity: " << entity;
+    return;
+  }
+
+  // Only keep the vertices that the shape actually changes.
+  SparseBlendShape shape;
+  BlendableVertex neutral = NeutralVertex();
+  BlendableVertex target = NeutralVertex();
+  for (size_t index = 0; index < num_vertices; ++index) {
+    blend.ReadVertex(blend.base_shape.GetReadPtr(), blend.blend_vertex_size,
+                     index, blend.blend_offsets, &neutral);
+    blend.ReadVertex(blend_shape.GetReadPtr(), blend.blend_vertex_size, index,
+                     blend.blend_offsets, &target);
+
+    VertexDelta delta;
+    if (blend.mode == kInterpolate) {
+      delta.position = target.position - neutral.position;
+      delta.normal = target.normal - neutral.normal;
+      delta.tangent = target.tangent - neutral.tangent;
+    } else {
+      delta.position = target.position;
+      delta.normal = target.normal;
+      delta.tangent = target.tangent;
+    }
+    if (delta.position != mathfu::kZeros3f ||
+        delta.normal != mathfu::kZeros3f ||
+        delta.tangent != mathfu::kZeros3f) {
+      shape.vertices.push_back(static_cast<uint32_t>(index));
+      shape.deltas.push_back(delta);
+    }
+  }
+
   blend.blend_names.emplace_back(name);
-  blend.blend_shapes.emplace_back(std::move(blend_shape));
+  blend.blend_shapes.emplace_back(std::move(shape));
 }
 
 bool BlendShapeSystem::IsReady(Entity entity) const {
@@ -343,7 +443,7 @@ void BlendShapeSystem::UpdateWeights(Entity entity, Span<float> weights) {
   if (iter == blends_.end()) {
     return;
   }
-  iter->second.UpdateMesh(weights);
+  iter->second.UpdateMesh(weights, registry_->Get<JobProcessor>());
   auto* render_system = registry_->Get<RenderSystem>();
   render_system->SetMesh(entity, iter->second.mesh);
 }
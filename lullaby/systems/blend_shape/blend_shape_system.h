@@ -21,8 +21,10 @@ limitations under the License.
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/systems/render/render_system.h"
+#include "lullaby/util/job_processor.h"
 #include "lullaby/util/resource_manager.h"
 #include "lullaby/util/string_view.h"
+#include "mathfu/constants.h"
 
 namespace lull {
 
@@ -44,6 +46,12 @@ namespace lull {
 ///
 /// Blend modes determine how to interpret blend data when recomputing vertex
 /// attribute data.
+///
+/// Blend shapes are stored sparsely as the vertices they change and their
+/// deltas, so an update only touches the vertices of the shapes with non-zero
+/// weights (and the vertices that those shapes changed on the previous
+/// update). If a JobProcessor is in the Registry, large meshes are split into
+/// chunks of vertices that are updated on its worker threads.
 class BlendShapeSystem : public System {
  public:
   explicit BlendShapeSystem(Registry* registry);
@@ -65,6 +73,10 @@ class BlendShapeSystem : public System {
   void InitBlendShape(Entity entity, MeshData mesh,
                       const VertexFormat& blend_format,
                       DataContainer base_shape, BlendMode mode);
+
+  /// Adds a blend shape to the |entity|. The |blend_shape| is converted into a
+  /// sparse list of the vertices that differ from the base shape, so it isn't
+  /// retained.
   void AddBlendShape(Entity entity, HashValue name, DataContainer blend_shape);
 
   void Destroy(Entity entity) override;
@@ -123,13 +135,38 @@ class BlendShapeSystem : public System {
   static void BlendVertex(BlendVertexParams* params, BlendMode mode);
 
  private:
+  /// The change to the blendable attributes of a vertex.
+  struct VertexDelta {
+    mathfu::vec3 position = mathfu::kZeros3f;
+    mathfu::vec3 normal = mathfu::kZeros3f;
+    mathfu::vec3 tangent = mathfu::kZeros3f;
+  };
+
+  /// A blend shape stored as the vertices it changes, in increasing order, and
+  /// their deltas. In kInterpolate mode the deltas are relative to the base
+  /// shape, and in kDisplacement mode they are the displacements themselves.
+  struct SparseBlendShape {
+    std::vector<uint32_t> vertices;
+    std::vector<VertexDelta> deltas;
+  };
+
+  /// A blend shape with a non-zero weight in an update.
+  struct ActiveBlendShape {
+    const SparseBlendShape* shape;
+    float weight;
+  };
+
   /// Blend information for a single Entity.
   struct BlendData {
     BlendData() {}
 
     /// Updated the computed vertices so that each blend vertex is merged
     /// according to weights (set between 0..1).
-    void UpdateMesh(Span<float> weights);
+    void UpdateMesh(Span<float> weights, JobProcessor* job_processor);
+
+    /// Updates the vertices in [begin, end) using |active_shapes|.
+    void UpdateVertices(size_t begin, size_t end,
+                        const std::vector<ActiveBlendShape>& active_shapes);
 
     /// Writes a single vertex to our computed vertices.
     void UpdateMeshVertex(size_t index, const BlendableVertex& vertex);
@@ -154,12 +191,17 @@ class BlendShapeSystem : public System {
     DataContainer base_shape;
     /// Names of the different blend shapes.
     std::vector<HashValue> blend_names;
-    /// Vertices for the read-only blend shapes corresponding to blend_names.
-    std::vector<DataContainer> blend_shapes;
+    /// The blend shapes corresponding to blend_names.
+    std::vector<SparseBlendShape> blend_shapes;
     std::vector<float> current_weights;
     size_t blend_vertex_size = 0;
     BlendableAttributeOffsets mesh_offsets;
     BlendableAttributeOffsets blend_offsets;
+    /// Per-vertex scratch space for summing the deltas of the active shapes.
+    std::vector<VertexDelta> summed_deltas;
+    /// Per-vertex flags tracking which vertices were blended by the last
+    /// update, and which are touched by the current one.
+    std::vector<uint8_t> vertex_flags;
   };
 
   std::unordered_map<Entity, BlendData> blends_;
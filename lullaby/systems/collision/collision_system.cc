@@ -16,11 +16,14 @@ limitations under the License.
 
 #include "lullaby/systems/collision/collision_system.h"
 
+#include <limits>
+
 #include "lullaby/generated/collision_def_generated.h"
 #include "lullaby/events/entity_events.h"
 #include "lullaby/modules/flatbuffers/mathfu_fb_conversions.h"
 #include "lullaby/systems/dispatcher/event.h"
 #include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/intersections.h"
 #include "lullaby/util/logging.h"
 
 namespace lull {
@@ -37,7 +40,8 @@ CollisionSystem::CollisionSystem(Registry* registry)
       on_exit_flag_(TransformSystem::kInvalidFlag),
       interaction_flag_(TransformSystem::kInvalidFlag),
       default_interaction_flag_(TransformSystem::kInvalidFlag),
-      clip_flag_(TransformSystem::kInvalidFlag) {
+      clip_flag_(TransformSystem::kInvalidFlag),
+      spatial_index_(nullptr) {
   RegisterDef<CollisionDefT>(this);
   RegisterDef<CollisionClipBoundsDefT>(this);
   RegisterDependency<TransformSystem>(this);
@@ -70,6 +74,9 @@ CollisionSystem::CollisionSystem(Registry* registry)
                         [this](const DisableInteractionDescendantsEvent& e) {
                           DisableInteractionDescendants(e.entity);
                         });
+    dispatcher->Connect(this, [this](const ParentChangedImmediateEvent& e) {
+      OnParentChanged(e);
+    });
   }
 }
 
@@ -87,6 +94,12 @@ void CollisionSystem::Initialize() {
   interaction_flag_ = transform_system_->RequestFlag();
   default_interaction_flag_ = transform_system_->RequestFlag();
   clip_flag_ = transform_system_->RequestFlag();
+
+  // The broadphase is the engine-wide SpatialIndex, which may be shared with
+  // other systems.
+  registry_->Create<SpatialIndex>(registry_);
+  spatial_index_ = registry_->Get<SpatialIndex>();
+  spatial_index_->IndexFlag(collision_flag_);
 }
 
 void CollisionSystem::Create(Entity entity, HashValue type, const Def* def) {
@@ -96,6 +109,8 @@ void CollisionSystem::Create(Entity entity, HashValue type, const Def* def) {
     Aabb aabb;
     AabbFromFbAabb(data->aabb(), &aabb);
     clip_bounds_.emplace(entity, aabb);
+    containing_bounds_.clear();
+    ++generation_;
   } else if (type == kCollisionDefHash) {
     const CollisionDef* data = ConvertDef<CollisionDef>(def);
 
@@ -117,7 +132,12 @@ void CollisionSystem::Create(Entity entity, HashValue type, const Def* def) {
 }
 
 void CollisionSystem::Destroy(Entity entity) {
-  clip_bounds_.erase(entity);
+  if (clip_bounds_.erase(entity) != 0) {
+    containing_bounds_.clear();
+  } else {
+    containing_bounds_.erase(entity);
+  }
+  ++generation_;
   transform_system_->ClearFlag(entity, collision_flag_);
   transform_system_->ClearFlag(entity, on_exit_flag_);
   transform_system_->ClearFlag(entity, interaction_flag_);
@@ -128,49 +148,154 @@ void CollisionSystem::Destroy(Entity entity) {
 CollisionSystem::CollisionResult CollisionSystem::CheckForCollision(
     const Ray& ray) const {
   CollisionResult result = {kNullEntity, kNoHitDistance};
+  spatial_index_->Update();
+  CastRay(ray, &result);
+  return result;
+}
 
-  transform_system_->ForAll([&](Entity entity,
-                                const mathfu::mat4& world_from_entity_mat,
-                                const Aabb& box, Bits flags) {
-    if (!CheckBit(flags, collision_flag_)) {
-      return;
-    }
+void CollisionSystem::CheckForCollisions(
+    Span<Ray> rays, MutableSpan<CollisionResult> results) const {
+  if (rays.size() != results.size()) {
+    LOG(DFATAL) << "Each ray needs a result.";
+    return;
+  }
 
-    const bool check_exit = CheckBit(flags, on_exit_flag_);
-    const float distance =
-        CheckRayOBBCollision(ray, world_from_entity_mat, box, check_exit);
-    if (distance == kNoHitDistance) {
-      return;
+  spatial_index_->Update();
+  for (size_t i = 0; i < rays.size(); ++i) {
+    CastRay(rays[i], &results[i]);
+  }
+}
+
+uint64_t CollisionSystem::GetCollisionGeneration() const {
+  // Both counters only ever increase, so their sum changes whenever either
+  // does.
+  return generation_ + spatial_index_->GetGeneration();
+}
+
+void CollisionSystem::CastRay(const Ray& ray, CollisionResult* result) const {
+  // Only a previous hit that is still hit can bound the search.
+  float max_distance = std::numeric_limits<float>::max();
+  if (result->entity != kNullEntity && IsCollisionEnabled(result->entity) &&
+      spatial_index_->GetWorldAabb(result->entity) != nullptr) {
+    result->distance =
+        CheckForEntityCollision(ray, result->entity, max_distance);
+  } else {
+    result->distance = kNoHitDistance;
+  }
+  if (result->distance == kNoHitDistance) {
+    result->entity = kNullEntity;
+  } else {
+    max_distance = result->distance;
+  }
+
+  // The candidates are tested kRayOBBCollisionBatchSize at a time.  Testing a
+  // batch can only lower |max_distance|, so the broadphase is pruned with a
+  // bound that is at most one batch out of date.
+  constexpr size_t kBatchSize = kRayOBBCollisionBatchSize;
+  Entity batch_entities[kBatchSize];
+  mathfu::mat4 batch_mats[kBatchSize];
+  Aabb batch_boxes[kBatchSize];
+  float batch_distances[kBatchSize];
+  size_t batch_size = 0;
+  auto check_batch = [&]() {
+    CheckRayOBBCollisions(ray, batch_mats, batch_boxes, batch_size,
+                          batch_distances);
+    for (size_t i = 0; i < batch_size; ++i) {
+      const float distance = batch_distances[i];
+      if (distance != kNoHitDistance && distance < max_distance &&
+          !IsHitClipped(ray, batch_entities[i], distance)) {
+        result->entity = batch_entities[i];
+        result->distance = distance;
+        max_distance = distance;
+      }
     }
+    batch_size = 0;
+  };
 
-    if (result.entity != kNullEntity && distance >= result.distance) {
-      return;
+  spatial_index_->Raycast(ray, max_distance, [&](Entity entity) -> float {
+    // The index may hold Entities indexed by other systems.
+    if (!IsCollisionEnabled(entity)) {
+      return max_distance;
     }
 
-    const bool clip_outside_bounds = CheckBit(flags, clip_flag_);
-    if (clip_outside_bounds &&
-        IsCollisionClipped(entity, ray.GetPointAt(distance))) {
-      return;
+    // Collisions on exit are rare, so they are checked one at a time, after the
+    // candidates before them.
+    if (transform_system_->HasFlag(entity, on_exit_flag_)) {
+      if (batch_size > 0) {
+        check_batch();
+      }
+      const float distance = CheckForEntityCollision(ray, entity, max_distance);
+      if (distance != kNoHitDistance) {
+        result->entity = entity;
+        result->distance = distance;
+        max_distance = distance;
+      }
+      return max_distance;
     }
 
-    result.entity = entity;
-    result.distance = distance;
+    const mathfu::mat4* world_from_entity_mat =
+        transform_system_->GetWorldFromEntityMatrix(entity);
+    const Aabb* box = transform_system_->GetAabb(entity);
+    if (!world_from_entity_mat || !box) {
+      return max_distance;
+    }
+    batch_entities[batch_size] = entity;
+    batch_mats[batch_size] = *world_from_entity_mat;
+    batch_boxes[batch_size] = *box;
+    if (++batch_size == kBatchSize) {
+      check_batch();
+    }
+    return max_distance;
   });
+  if (batch_size > 0) {
+    check_batch();
+  }
+}
 
-  return result;
+float CollisionSystem::CheckForEntityCollision(const Ray& ray, Entity entity,
+                                               float max_distance) const {
+  const mathfu::mat4* world_from_entity_mat =
+      transform_system_->GetWorldFromEntityMatrix(entity);
+  const Aabb* box = transform_system_->GetAabb(entity);
+  if (!world_from_entity_mat || !box) {
+    return kNoHitDistance;
+  }
+
+  const bool check_exit = transform_system_->HasFlag(entity, on_exit_flag_);
+  const float distance =
+      CheckRayOBBCollision(ray, *world_from_entity_mat, *box, check_exit);
+  if (distance == kNoHitDistance || distance >= max_distance) {
+    return kNoHitDistance;
+  }
+
+  if (IsHitClipped(ray, entity, distance)) {
+    return kNoHitDistance;
+  }
+  return distance;
+}
+
+bool CollisionSystem::IsHitClipped(const Ray& ray, Entity entity,
+                                   float distance) const {
+  const bool clip_outside_bounds =
+      transform_system_->HasFlag(entity, clip_flag_);
+  return clip_outside_bounds &&
+         IsCollisionClipped(entity, ray.GetPointAt(distance));
 }
 
 std::vector<Entity> CollisionSystem::CheckForPointCollisions(
     const mathfu::vec3& point) {
   std::vector<Entity> collisions;
-
-  transform_system_->ForAll([&](Entity entity,
-                                const mathfu::mat4& world_from_entity_mat,
-                                const Aabb& box, Bits flags) {
-    if (CheckBit(flags, collision_flag_)) {
-      if (CheckPointOBBCollision(point, world_from_entity_mat, box)) {
-        collisions.push_back(entity);
-      }
+  const Aabb point_aabb(point, point);
+  spatial_index_->QueryAabb(point_aabb, [&](Entity entity) {
+    if (!IsCollisionEnabled(entity)) {
+      return;
+    }
+    const mathfu::mat4* world_from_entity_mat =
+        transform_system_->GetWorldFromEntityMatrix(entity);
+    const Aabb* box = transform_system_->GetAabb(entity);
+    if (world_from_entity_mat && box &&
+        CheckPointOBBCollision(point, *world_from_entity_mat, *box)) {
+      collisions.push_back(entity);
     }
   });
   return collisions;
@@ -178,10 +303,12 @@ std::vector<Entity> CollisionSystem::CheckForPointCollisions(
 
 void CollisionSystem::DisableCollision(Entity entity) {
   transform_system_->ClearFlag(entity, collision_flag_);
+  ++generation_;
 }
 
 void CollisionSystem::EnableCollision(Entity entity) {
   transform_system_->SetFlag(entity, collision_flag_);
+  ++generation_;
 }
 
 bool CollisionSystem::IsCollisionEnabled(Entity entity) const {
@@ -241,10 +368,12 @@ void CollisionSystem::RestoreInteractionDescendants(Entity entity) {
 
 void CollisionSystem::DisableClipping(Entity entity) {
   transform_system_->ClearFlag(entity, clip_flag_);
+  ++generation_;
 }
 
 void CollisionSystem::EnableClipping(Entity entity) {
   transform_system_->SetFlag(entity, clip_flag_);
+  ++generation_;
 }
 
 void CollisionSystem::RegisterCollisionProvider(CollisionProvider* provider) {
@@ -260,14 +389,42 @@ size_t CollisionSystem::GetNumCollisionProviders() const {
 }
 
 Entity CollisionSystem::GetContainingBounds(Entity entity) const {
+  auto iter = containing_bounds_.find(entity);
+  if (iter != containing_bounds_.end()) {
+    return iter->second;
+  }
+
+  // Walk up until reaching either clip bounds or an ancestor whose containing
+  // bounds are already known, then record the result for every entity passed
+  // along the way so that their siblings and descendants hit the cache.
+  std::vector<Entity> visited;
+  visited.push_back(entity);
+  Entity bounds = kNullEntity;
   Entity parent = transform_system_->GetParent(entity);
   while (parent != kNullEntity) {
-    if (clip_bounds_.find(parent) != clip_bounds_.end()) {
+    if (clip_bounds_.count(parent) != 0) {
+      bounds = parent;
       break;
     }
+    auto cached = containing_bounds_.find(parent);
+    if (cached != containing_bounds_.end()) {
+      bounds = cached->second;
+      break;
+    }
+    visited.push_back(parent);
     parent = transform_system_->GetParent(parent);
   }
-  return parent;
+
+  for (const Entity e : visited) {
+    containing_bounds_[e] = bounds;
+  }
+  return bounds;
+}
+
+void CollisionSystem::OnParentChanged(
+    const ParentChangedImmediateEvent& /*event*/) {
+  containing_bounds_.clear();
+  ++generation_;
 }
 
 bool CollisionSystem::IsCollisionClipped(Entity entity,
@@ -19,17 +19,29 @@ limitations under the License.
 
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
+#include "lullaby/events/entity_events.h"
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/systems/collision/collision_provider.h"
+#include "lullaby/systems/transform/spatial_index.h"
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/math.h"
+#include "lullaby/util/span.h"
 
 namespace lull {
 
 // The CollisionSystem can be used to provide Entities with collision
 // information that can be used to for raycast tests.
+//
+// Collidable entities are kept in a DynamicAabbTree which is incrementally
+// updated from the changes reported by the TransformSystem, so ray and point
+// queries only need to test the entities near the query.
+//
+// The clip bounds that contain each entity are resolved lazily into a flat
+// table, which is only invalidated when the hierarchy or the set of clip bounds
+// changes, so clipping a hit does not need to walk up the hierarchy.
 class CollisionSystem : public System {
  public:
   explicit CollisionSystem(Registry* registry);
@@ -53,6 +65,20 @@ class CollisionSystem : public System {
   // and the distance to the hit point from the ray's origin.
   CollisionResult CheckForCollision(const Ray& ray) const;
 
+  // Casts each of the |rays| and stores the closest hit of each in the
+  // corresponding element of |results|, which must be the same size.  The
+  // broadphase is only brought up-to-date once for the whole batch.  On input,
+  // |results| may hold the hits of a previous query with similar rays (or
+  // kNullEntity): a previous hit that is still hit bounds the search for the
+  // new closest hit.
+  void CheckForCollisions(Span<Ray> rays,
+                          MutableSpan<CollisionResult> results) const;
+
+  // Returns a value that changes whenever the result of a collision query
+  // might change for the same ray, ie. when collidable entities are added,
+  // removed, moved or have their collision or clipping changed.
+  uint64_t GetCollisionGeneration() const;
+
   // Returns a vector of entities that a point lies within
   std::vector<Entity> CheckForPointCollisions(const mathfu::vec3& point);
 
@@ -115,9 +141,27 @@ class CollisionSystem : public System {
   }
 
  private:
+  // Returns the nearest ancestor of |entity| with clip bounds, or kNullEntity.
   Entity GetContainingBounds(Entity entity) const;
   bool IsCollisionClipped(Entity entity, const mathfu::vec3& point) const;
 
+  // Returns the distance along |ray| to the collision shape of |entity| if it
+  // is hit closer than |max_distance| and not clipped, otherwise
+  // kNoHitDistance.
+  float CheckForEntityCollision(const Ray& ray, Entity entity,
+                                float max_distance) const;
+
+  // Returns true if the hit |distance| along |ray| on |entity| is outside the
+  // clip bounds containing |entity|.
+  bool IsHitClipped(const Ray& ray, Entity entity, float distance) const;
+
+  // Casts |ray| against the broadphase, starting from the hit in |result|.
+  void CastRay(const Ray& ray, CollisionResult* result) const;
+
+  // Clears the cached containing bounds after the hierarchy or clip bounds
+  // change.
+  void OnParentChanged(const ParentChangedImmediateEvent& event);
+
   TransformSystem* transform_system_;
   TransformSystem::TransformFlags collision_flag_;
   TransformSystem::TransformFlags on_exit_flag_;
@@ -125,8 +169,15 @@ class CollisionSystem : public System {
   TransformSystem::TransformFlags default_interaction_flag_;
   TransformSystem::TransformFlags clip_flag_;
   std::unordered_map<Entity, Aabb> clip_bounds_;
+  // Maps entities to their nearest ancestor with clip bounds (or kNullEntity).
+  mutable std::unordered_map<Entity, Entity> containing_bounds_;
   std::unordered_set<CollisionProvider*> collision_providers_;
 
+  // The broadphase, which indexes the Entities with |collision_flag_|.
+  SpatialIndex* spatial_index_;
+  // Counts changes to collision state that the SpatialIndex does not see.
+  uint64_t generation_ = 0;
+
   CollisionSystem(const CollisionSystem&) = delete;
   CollisionSystem& operator=(const CollisionSystem&) = delete;
 };
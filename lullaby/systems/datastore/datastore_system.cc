@@ -76,7 +76,14 @@ void DatastoreSystem::Create(Entity entity, HashValue type, const Def* def) {
   }
 }
 
-void DatastoreSystem::Destroy(Entity entity) { stores_.erase(entity); }
+void DatastoreSystem::Destroy(Entity entity) {
+  stores_.erase(entity);
+  for (auto& iter : columns_) {
+    if (iter.second->Remove(entity)) {
+      NotifyChanged(iter.second.get(), entity, iter.first);
+    }
+  }
+}
 
 void DatastoreSystem::Set(Entity entity, HashValue key,
                           const Variant& variant) {
@@ -84,11 +91,25 @@ void DatastoreSystem::Set(Entity entity, HashValue key,
     return;
   }
 
+  ColumnBase* column = FindColumn(key);
+  if (column) {
+    SetColumnValue(column, entity, key, variant);
+    return;
+  }
+
   const auto store_iter = stores_.emplace(entity, Datastore()).first;
   store_iter->second[key] = variant;
 }
 
 void DatastoreSystem::Remove(Entity entity, HashValue key) {
+  ColumnBase* column = FindColumn(key);
+  if (column) {
+    if (column->Remove(entity)) {
+      NotifyChanged(column, entity, key);
+    }
+    return;
+  }
+
   const auto store_iter = stores_.find(entity);
   if (store_iter == stores_.end()) {
     return;
@@ -100,6 +121,14 @@ void DatastoreSystem::Remove(Entity entity, HashValue key) {
 }
 
 const Variant& DatastoreSystem::GetVariant(Entity entity, HashValue key) const {
+  const ColumnBase* column = FindColumn(key);
+  if (column) {
+    if (column->GetVariant(entity, &column_variant_)) {
+      return column_variant_;
+    }
+    return empty_variant_;
+  }
+
   const auto store_iter = stores_.find(entity);
   if (store_iter == stores_.end()) {
     return empty_variant_;
@@ -114,4 +143,38 @@ const Variant& DatastoreSystem::GetVariant(Entity entity, HashValue key) const {
   return variant_map_iter->second;
 }
 
+void DatastoreSystem::AddChangeListener(HashValue key, ChangeFn fn) {
+  ColumnBase* column = FindColumn(key);
+  if (column == nullptr) {
+    LOG(DFATAL) << "Change listeners require a column for key " << key;
+    return;
+  }
+  column->listeners.emplace_back(std::move(fn));
+}
+
+DatastoreSystem::ColumnBase* DatastoreSystem::FindColumn(HashValue key) const {
+  if (columns_.empty()) {
+    return nullptr;
+  }
+  const auto iter = columns_.find(key);
+  return iter != columns_.end() ? iter->second.get() : nullptr;
+}
+
+void DatastoreSystem::SetColumnValue(ColumnBase* column, Entity entity,
+                                     HashValue key, const Variant& value) {
+  // Setting a column value to an empty Variant clears it.
+  const bool changed = value.Empty() ? column->Remove(entity)
+                                     : column->SetVariant(entity, value);
+  if (changed) {
+    NotifyChanged(column, entity, key);
+  }
+}
+
+void DatastoreSystem::NotifyChanged(ColumnBase* column, Entity entity,
+                                    HashValue key) {
+  for (const ChangeFn& fn : column->listeners) {
+    fn(entity, key);
+  }
+}
+
 }  // namespace lull
@@ -17,9 +17,15 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_DATASTORE_DATASTORE_SYSTEM_H_
 #define LULLABY_SYSTEMS_DATASTORE_DATASTORE_SYSTEM_H_
 
+#include <functional>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
+#include "lullaby/util/logging.h"
+#include "lullaby/util/mapped_structure_of_arrays.h"
+#include "lullaby/util/typeid.h"
 #include "lullaby/util/variant.h"
 
 namespace lull {
@@ -29,8 +35,18 @@ namespace lull {
 // A Datastore is just a dictionary of a HashValue to a Variant.  Adding a
 // datastore to an Entity allows arbitrary key-value pairs to be associated with
 // the Entity.
+//
+// Keys that are accessed frequently can be declared as typed columns using
+// DeclareColumn.  Values for these keys are stored in a dense array of the
+// declared type rather than in per-Entity Variant dictionaries, so they can be
+// read and iterated without any Variant conversions.  Column values can only be
+// set to the declared type, and listeners registered with AddChangeListener are
+// notified only when a value actually changes.
 class DatastoreSystem : public System {
  public:
+  // Invoked when the value associated with |key| on |entity| changes.
+  using ChangeFn = std::function<void(Entity entity, HashValue key)>;
+
   explicit DatastoreSystem(Registry* registry);
 
   ~DatastoreSystem() override;
@@ -57,15 +73,125 @@ class DatastoreSystem : public System {
   const T* Get(Entity entity, HashValue key) const;
 
   // Returns the Variant value associated with the |key| on the |entity|, or an
-  // empty Variant if not set.
+  // empty Variant if not set.  For column keys, the returned reference is only
+  // valid until the next call to GetVariant.
   const Variant& GetVariant(Entity entity, HashValue key) const;
 
+  // Stores all values for |key| in a dense column of type T.  Existing values
+  // of type T for |key| are moved into the column; values of other types are
+  // discarded.  T must be equality comparable.
+  template <typename T>
+  void DeclareColumn(HashValue key);
+
+  // Calls |fn| with each Entity and value in the column for |key|.  Must not
+  // add or remove values for |key| from within |fn|.
+  template <typename T, typename Fn>
+  void ForEachInColumn(HashValue key, const Fn& fn) const;
+
+  // Registers |fn| to be called whenever a value in the column for |key| is
+  // added, changed or removed.
+  void AddChangeListener(HashValue key, ChangeFn fn);
+
  private:
   using Datastore = std::unordered_map<HashValue, Variant>;
   using EntityMap = std::unordered_map<Entity, Datastore>;
 
+  // Type-erased interface to a Column so that Variant-based access and entity
+  // destruction can be handled without knowing the column's type.
+  class ColumnBase {
+   public:
+    virtual ~ColumnBase() {}
+    virtual TypeId GetType() const = 0;
+    virtual bool SetVariant(Entity entity, const Variant& variant) = 0;
+    virtual bool GetVariant(Entity entity, Variant* variant) const = 0;
+    virtual bool Remove(Entity entity) = 0;
+
+    std::vector<ChangeFn> listeners;
+  };
+
+  template <typename T>
+  class Column : public ColumnBase {
+   public:
+    TypeId GetType() const override { return GetTypeId<T>(); }
+
+    // Sets the value for |entity|, returning true if the value changed.
+    bool Set(Entity entity, const T& value) {
+      if (values_.Contains(entity)) {
+        T& existing = values_.template At<1>(entity);
+        if (existing == value) {
+          return false;
+        }
+        existing = value;
+      } else {
+        values_.Insert(entity, entity, value);
+      }
+      return true;
+    }
+
+    const T* Get(Entity entity) const {
+      return values_.Contains(entity) ? &values_.template At<1>(entity)
+                                      : nullptr;
+    }
+
+    bool SetVariant(Entity entity, const Variant& variant) override {
+      const T* value = variant.Get<T>();
+      if (value == nullptr) {
+        LOG(DFATAL) << "Variant does not match the column type.";
+        return false;
+      }
+      return Set(entity, *value);
+    }
+
+    bool GetVariant(Entity entity, Variant* variant) const override {
+      const T* value = Get(entity);
+      if (value == nullptr) {
+        return false;
+      }
+      *variant = *value;
+      return true;
+    }
+
+    bool Remove(Entity entity) override {
+      if (!values_.Contains(entity)) {
+        return false;
+      }
+      values_.Remove(entity);
+      return true;
+    }
+
+    template <typename Fn>
+    void ForEach(const Fn& fn) const {
+      const Entity* entities = values_.template Data<0>();
+      const T* values = values_.template Data<1>();
+      const size_t size = values_.Size();
+      for (size_t i = 0; i < size; ++i) {
+        fn(entities[i], values[i]);
+      }
+    }
+
+   private:
+    // Stores the owning Entity alongside each value so that the Entity for a
+    // given index is available during iteration.
+    MappedStructureOfArrays<Entity, Entity, T> values_;
+  };
+
+  ColumnBase* FindColumn(HashValue key) const;
+
+  template <typename T>
+  Column<T>* GetColumn(ColumnBase* column) const;
+
+  template <typename T>
+  void SetColumnValue(ColumnBase* column, Entity entity, HashValue key,
+                      const T& value);
+  void SetColumnValue(ColumnBase* column, Entity entity, HashValue key,
+                      const Variant& value);
+
+  void NotifyChanged(ColumnBase* column, Entity entity, HashValue key);
+
   EntityMap stores_;
+  std::unordered_map<HashValue, std::unique_ptr<ColumnBase>> columns_;
   Variant empty_variant_;
+  mutable Variant column_variant_;
 
   DatastoreSystem(const DatastoreSystem&);
   DatastoreSystem& operator=(const DatastoreSystem&);
@@ -77,15 +203,86 @@ void DatastoreSystem::Set(Entity entity, HashValue key, const T& value) {
     return;
   }
 
+  ColumnBase* column = FindColumn(key);
+  if (column) {
+    SetColumnValue(column, entity, key, value);
+    return;
+  }
+
   const auto store_iter = stores_.emplace(entity, Datastore()).first;
   store_iter->second[key] = value;
 }
 
 template <typename T>
 const T* DatastoreSystem::Get(Entity entity, HashValue key) const {
+  ColumnBase* column = FindColumn(key);
+  if (column) {
+    const Column<T>* typed_column = GetColumn<T>(column);
+    return typed_column ? typed_column->Get(entity) : nullptr;
+  }
   return GetVariant(entity, key).Get<T>();
 }
 
+template <typename T>
+void DatastoreSystem::DeclareColumn(HashValue key) {
+  ColumnBase* existing = FindColumn(key);
+  if (existing) {
+    DCHECK(existing->GetType() == GetTypeId<T>())
+        << "Column redeclared with a different type.";
+    return;
+  }
+
+  auto* column = new Column<T>();
+  columns_.emplace(key, std::unique_ptr<ColumnBase>(column));
+
+  for (auto iter = stores_.begin(); iter != stores_.end();) {
+    Datastore& store = iter->second;
+    const auto value_iter = store.find(key);
+    if (value_iter != store.end()) {
+      const T* value = value_iter->second.Get<T>();
+      if (value) {
+        column->Set(iter->first, *value);
+      }
+      store.erase(value_iter);
+    }
+    if (store.empty()) {
+      iter = stores_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+template <typename T, typename Fn>
+void DatastoreSystem::ForEachInColumn(HashValue key, const Fn& fn) const {
+  const Column<T>* column = GetColumn<T>(FindColumn(key));
+  if (column) {
+    column->ForEach(fn);
+  }
+}
+
+template <typename T>
+DatastoreSystem::Column<T>* DatastoreSystem::GetColumn(
+    ColumnBase* column) const {
+  if (column == nullptr || column->GetType() != GetTypeId<T>()) {
+    return nullptr;
+  }
+  return static_cast<Column<T>*>(column);
+}
+
+template <typename T>
+void DatastoreSystem::SetColumnValue(ColumnBase* column, Entity entity,
+                                     HashValue key, const T& value) {
+  Column<T>* typed_column = GetColumn<T>(column);
+  if (typed_column == nullptr) {
+    LOG(DFATAL) << "Value does not match the column type for key " << key;
+    return;
+  }
+  if (typed_column->Set(entity, value)) {
+    NotifyChanged(column, entity, key);
+  }
+}
+
 }  // namespace lull
 
 LULLABY_SETUP_TYPEID(lull::DatastoreSystem);
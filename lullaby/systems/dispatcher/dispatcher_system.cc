@@ -94,15 +94,7 @@ void DispatcherSystem::Create(Entity entity, HashValue type, const Def* def) {
 
 void DispatcherSystem::Destroy(Entity entity) {
   connections_.erase(entity);
-  if (dispatch_count_ > 0) {
-    auto iter = dispatchers_.find(entity);
-    if (iter != dispatchers_.end()) {
-      iter->second.DisconnectAll(this);
-    }
-    queued_destruction_.insert(entity);
-  } else {
-    dispatchers_.erase(entity);
-  }
+  handlers_.DisconnectChannel(entity.AsUint32());
 }
 
 void DispatcherSystem::ConnectEvent(Entity entity, const EventDef* input,
@@ -146,53 +138,42 @@ void DispatcherSystem::SendImmediatelyImpl(Entity entity,
 }
 
 void DispatcherSystem::SendImmediatelyImpl(const EntityEvent& entity_event) {
-  ++dispatch_count_;
-  // When an entity has been queued for destruction, treat it as already
-  // destroyed.
-  if (queued_destruction_.count(entity_event.entity) == 0) {
-    auto iter = dispatchers_.find(entity_event.entity);
-    if (iter != dispatchers_.end()) {
-      iter->second.Send(entity_event.event);
-    }
-    universal_dispatcher_.Send(entity_event);
+  if (entity_event.entity != kNullEntity) {
+    handlers_.SendToChannel(entity_event.entity.AsUint32(),
+                            entity_event.event);
   }
-  --dispatch_count_;
-  DestroyQueued();
+  universal_dispatcher_.Send(entity_event);
 }
 
-Dispatcher* DispatcherSystem::GetDispatcher(Entity entity) {
-  if (entity == kNullEntity) {
-    return nullptr;
+void DispatcherSystem::Broadcast(Span<Entity> entities,
+                                 const EventWrapper& event) {
+  Dispatcher* dispatcher = registry_->Get<Dispatcher>();
+  for (Entity entity : entities) {
+    dispatcher->Send(EntityEvent(entity, event));
+  }
+}
+
+void DispatcherSystem::BroadcastImmediately(Span<Entity> entities,
+                                            const EventWrapper& event) {
+  for (Entity entity : entities) {
+    SendImmediatelyImpl(EntityEvent(entity, event));
   }
-  return &dispatchers_[entity];
 }
 
 void DispatcherSystem::Disconnect(Entity entity, TypeId type,
                                   const void* owner) {
-  auto iter = dispatchers_.find(entity);
-  if (iter == dispatchers_.end()) {
+  if (entity == kNullEntity) {
     return;
   }
-
-  Dispatcher& dispatcher = iter->second;
-  dispatcher.Disconnect(type, owner);
-  if (dispatcher.GetHandlerCount() == 0) {
-    Destroy(entity);
-  }
+  handlers_.DisconnectFromChannel(entity.AsUint32(), type, owner);
 }
 
 void DispatcherSystem::Disconnect(Entity entity, TypeId type,
                                   Dispatcher::ConnectionId id) {
-  auto iter = dispatchers_.find(entity);
-  if (iter == dispatchers_.end()) {
+  if (entity == kNullEntity) {
     return;
   }
-
-  Dispatcher& dispatcher = iter->second;
-  dispatcher.Disconnect(type, id);
-  if (dispatcher.GetHandlerCount() == 0) {
-    Destroy(entity);
-  }
+  handlers_.Disconnect(type, id);
 }
 
 Dispatcher::ScopedConnection DispatcherSystem::ConnectToAll(
@@ -201,24 +182,14 @@ Dispatcher::ScopedConnection DispatcherSystem::ConnectToAll(
 }
 
 size_t DispatcherSystem::GetHandlerCount(Entity entity, TypeId type) const {
-  auto iter = dispatchers_.find(entity);
-  if (iter != dispatchers_.end()) {
-    return iter->second.GetHandlerCount(type);
+  if (entity == kNullEntity) {
+    return 0;
   }
-  return 0;
+  return handlers_.GetChannelHandlerCount(entity.AsUint32(), type);
 }
 
 size_t DispatcherSystem::GetUniversalHandlerCount() const {
   return universal_dispatcher_.GetHandlerCount();
 }
 
-void DispatcherSystem::DestroyQueued() {
-  if (dispatch_count_ == 0) {
-    for (Entity entity : queued_destruction_) {
-      dispatchers_.erase(entity);
-    }
-    queued_destruction_.clear();
-  }
-}
-
 }  // namespace lull
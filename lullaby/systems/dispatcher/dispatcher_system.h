@@ -20,11 +20,17 @@ limitations under the License.
 #include "lullaby/generated/dispatcher_def_generated.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/ecs/system.h"
+#include "lullaby/util/span.h"
 #include "lullaby/util/thread_safe_queue.h"
 
 namespace lull {
 
 /// Provides a Dispatcher as a Component for each Entity.
+///
+/// Rather than a separate Dispatcher per Entity, the handlers of all Entities
+/// are stored in a single table keyed by (Entity, TypeId), using a Dispatcher
+/// channel per Entity.  Sending an event to an Entity is therefore a single
+/// lookup, and Entities without handlers use no memory.
 class DispatcherSystem : public System {
  public:
   /// Pair of Entity and EventWrapper. Publicly this is only used to listen for
@@ -53,10 +59,9 @@ class DispatcherSystem : public System {
   /// Associates EventResponses with the Entity based on the |def|.
   void Create(Entity entity, HashValue type, const Def* def) override;
 
-  /// Destroys the Dispatcher and any Connections associated with the Entity.
-  /// If currently dispatching, this will queue the dispatcher to be destroyed
-  /// and prevent other events from being sent to it.  Otherwise it will destroy
-  /// the dispatcher immediately.
+  /// Disconnects all the handlers and Connections associated with the Entity.
+  /// This is safe to do while dispatching: the handlers are not called again,
+  /// and are destroyed once dispatching is complete.
   void Destroy(Entity entity) override;
 
   /// Sends |event| to all functions registered with the dispatcher associated
@@ -82,21 +87,38 @@ class DispatcherSystem : public System {
     SendImmediatelyImpl(entity, event_wrapper);
   }
 
+  /// Sends |event| to each of the |entities| in turn, eg. all the Entities in
+  /// a subtree (as gathered by TransformSystem::ForAllDescendants).  The
+  /// |Event| type must be registered with LULLABY_SETUP_TYPEID.
+  template <typename Event>
+  void Broadcast(Span<Entity> entities, const Event& event) {
+    Broadcast(entities, EventWrapper(event));
+  }
+
+  void Broadcast(Span<Entity> entities, const EventWrapper& event_wrapper);
+
+  /// As Broadcast, but will always send immediately regardless of global
+  /// Dispatcher behavior.
+  template <typename Event>
+  void BroadcastImmediately(Span<Entity> entities, const Event& event) {
+    BroadcastImmediately(entities, EventWrapper(event));
+  }
+
+  void BroadcastImmediately(Span<Entity> entities,
+                            const EventWrapper& event_wrapper);
+
   /// Connects an event handler to the Dispatcher associated with |entity|.
   /// This function is a simple wrapper around the various Dispatcher::Connect
   /// functions.  For more information, please refer to the Dispatcher API.
   template <typename... Args>
-  auto Connect(Entity entity, Args&&... args) -> decltype(
-      std::declval<Dispatcher>().Connect(std::forward<Args>(args)...)) {
-    Dispatcher* dispatcher = GetDispatcher(entity);
-    if (dispatcher) {
-      // If a dispatcher is queued to be destroyed and a new connection is
-      // made, that dispatcher needs to be kept alive.
-      queued_destruction_.erase(entity);
-      return dispatcher->Connect(std::forward<Args>(args)...);
-    } else {
+  auto Connect(Entity entity, Args&&... args)
+      -> decltype(std::declval<Dispatcher>().ConnectToChannel(
+          entity.AsUint32(), std::forward<Args>(args)...)) {
+    if (entity == kNullEntity) {
       return Dispatcher::Connection();
     }
+    return handlers_.ConnectToChannel(entity.AsUint32(),
+                                      std::forward<Args>(args)...);
   }
 
   /// Connects the |handler| to an event as described by the |input|.
@@ -142,7 +164,6 @@ class DispatcherSystem : public System {
   static void EnableQueuedDispatch() {}
 
  private:
-  using EntityDispatcherMap = std::unordered_map<Entity, Dispatcher>;
   using EntityConnections =
       std::unordered_map<Entity, std::vector<Dispatcher::ScopedConnection>>;
 
@@ -150,20 +171,10 @@ class DispatcherSystem : public System {
   void SendImmediatelyImpl(Entity entity, const EventWrapper& event);
   void SendImmediatelyImpl(const EntityEvent& entity_event);
 
-  Dispatcher* GetDispatcher(Entity entity);
-
-  void DestroyQueued();
-
   EntityConnections connections_;
-  EntityDispatcherMap dispatchers_;
-  int dispatch_count_ = 0;
-
-  /// Destroying dispatchers will invalidate any iterators in the dispatchers_
-  /// map, and will cause problems if the code doing the destruction is
-  /// executing in an event sent by the dispatcher being removed.  For safety,
-  /// queue the destruction and handle it once |dispatch_count_| reaches 0.
-  std::unordered_set<Entity> queued_destruction_;
 
+  /// The handlers of every Entity, each in the channel of the Entity's value.
+  Dispatcher handlers_;
 
   Dispatcher universal_dispatcher_;
 
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/modules/dispatcher/dispatcher_jni.h"
 #include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/modules/jni/jni_context.h"
+#include "lullaby/modules/jni/jni_convert.h"
 #include "lullaby/modules/jni/jni_util.h"
 #include "lullaby/modules/jni/registry_jni.h"
 #include "lullaby/systems/dispatcher/dispatcher_system.h"
@@ -61,4 +63,53 @@ LULLABY_JNI_FN(jlong, DispatcherSystem, nativeConnect)
   return static_cast<jlong>(connection.GetId());
 }
 
+// Sends the com.google.lullaby.Event at each index of |jevents| to the entity
+// at the same index of |jentities| in a single call.
+LULLABY_JNI_FN(void, DispatcherSystem, nativeSendBatch)
+(JNIEnv* env, jobject obj, jlong native_registry_handle, jlongArray jentities,
+ jobjectArray jevents, jboolean jimmediately) {
+  auto registry = lull::GetRegistryFromJni(native_registry_handle);
+  if (!registry) {
+    return;
+  }
+
+  auto* ctx = registry->Get<lull::JniContext>();
+  if (!ctx) {
+    LOG(DFATAL) << "No jni context.";
+    return;
+  }
+  ctx->SetJniEnv(env);
+
+  auto* dispatcher_system = registry->Get<lull::DispatcherSystem>();
+  if (dispatcher_system == nullptr) {
+    LOG(DFATAL) << "No DispatcherSystem.";
+    return;
+  }
+
+  const jsize num_events = env->GetArrayLength(jevents);
+  if (env->GetArrayLength(jentities) != num_events) {
+    LOG(DFATAL) << "Mismatched entity and event counts.";
+    return;
+  }
+
+  jlong* entities = env->GetLongArrayElements(jentities, nullptr);
+  for (jsize i = 0; i < num_events; ++i) {
+    const jobject jevent = env->GetObjectArrayElement(jevents, i);
+    const lull::Variant event = ConvertToNativeObject(ctx, jevent);
+    env->DeleteLocalRef(jevent);
+    const auto* event_wrapper = event.Get<lull::EventWrapper>();
+    if (event_wrapper == nullptr) {
+      LOG(DFATAL) << "Expected a com.google.lullaby.Event.";
+      continue;
+    }
+    const auto entity = static_cast<lull::Entity>(entities[i]);
+    if (jimmediately) {
+      dispatcher_system->SendImmediately(entity, *event_wrapper);
+    } else {
+      dispatcher_system->Send(entity, *event_wrapper);
+    }
+  }
+  env->ReleaseLongArrayElements(jentities, entities, JNI_ABORT);
+}
+
 }  // extern "C"
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "lullaby/generated/flatbuffers/vertex_attribute_def_generated.h"
 #include "lullaby/modules/file/asset_loader.h"
+#include "lullaby/modules/render/tangent_cache.h"
 #include "lullaby/modules/render/tangent_generation.h"
 #include "lullaby/modules/tinygltf/tinygltf_util.h"
 #include "lullaby/util/filename.h"
@@ -229,6 +230,8 @@ struct VertexAttributeInfo {
   size_t byte_stride = 0;
   // The byte offset into the associated VertexFormat.
   size_t offset = 0;
+  // The index of the GLTF BufferView containing the data.
+  int buffer_view = kInvalidTinyGltfIndex;
 };
 
 // Creates a vertex attribute for by searching for |name| in |attr_map| and
@@ -257,6 +260,7 @@ Optional<VertexAttributeInfo> VerifyAndCreateVertexAttribute(
   info.data = data;
   info.count = accessor->count;
   info.byte_stride = ByteStrideFromGltfAccessor(model, *accessor);
+  info.buffer_view = accessor->bufferView;
 
   VertexAttribute attribute = CreateVertexAttribute(*accessor, usage);
   vertex_format->AppendAttribute(attribute);
@@ -265,6 +269,65 @@ Optional<VertexAttributeInfo> VerifyAndCreateVertexAttribute(
   return info;
 }
 
+// Returns a pointer to the vertex data if all of |attributes| are already
+// interleaved within a single GLTF BufferView exactly as they are laid out in a
+// vertex of |vertex_size| bytes, in which case the BufferView can be used as
+// the vertex buffer as-is. Otherwise returns nullptr.
+const uint8_t* FindInterleavedVertexData(
+    const tinygltf::Model& model,
+    const std::vector<VertexAttributeInfo>& attributes, size_t vertex_size,
+    size_t num_vertices) {
+  const uint8_t* base = nullptr;
+  for (const VertexAttributeInfo& info : attributes) {
+    if (info.offset == 0) {
+      base = info.data;
+    }
+  }
+  if (base == nullptr) {
+    return nullptr;
+  }
+
+  const int buffer_view_index = attributes.front().buffer_view;
+  for (const VertexAttributeInfo& info : attributes) {
+    if (info.buffer_view != buffer_view_index ||
+        info.byte_stride != vertex_size || info.data != base + info.offset) {
+      return nullptr;
+    }
+  }
+
+  // The final vertex may not be padded out to the full stride, so ensure the
+  // whole range actually lies within the BufferView.
+  const tinygltf::BufferView& buffer_view =
+      model.bufferViews[buffer_view_index];
+  const uint8_t* view_begin =
+      model.buffers[buffer_view.buffer].data.data() + buffer_view.byteOffset;
+  const uint8_t* view_end = view_begin + buffer_view.byteLength;
+  if (base + num_vertices * vertex_size > view_end) {
+    return nullptr;
+  }
+  return base;
+}
+
+// Returns true if the material used by |gltf_primitive| samples a normal map,
+// which is the only use of the tangents of a vertex.
+bool HasNormalMap(const tinygltf::Primitive& gltf_primitive,
+                  const tinygltf::Model& model) {
+  if (gltf_primitive.material < 0 ||
+      gltf_primitive.material >= static_cast<int>(model.materials.size())) {
+    return false;
+  }
+  const tinygltf::Material& material = model.materials[gltf_primitive.material];
+  return material.additionalValues.count("normalTexture") > 0;
+}
+
+// Returns a vector perpendicular to |normal|, for use as the tangent of
+// vertices that are not normal mapped.
+mathfu::vec3 AnyPerpendicular(const mathfu::vec3& normal) {
+  const mathfu::vec3 axis =
+      std::fabs(normal.x) < 0.9f ? mathfu::kAxisX3f : mathfu::kAxisY3f;
+  return mathfu::vec3::CrossProduct(normal, axis);
+}
+
 }  // namespace
 
 GltfAsset::GltfAsset(Registry* registry, bool preserve_normal_tangent,
@@ -304,8 +367,10 @@ void GltfAsset::OnLoad(const std::string& filename, std::string* data) {
   std::string err;
   std::string warn;
   // Don't store the tinygltf representation of the asset; just store the fully
-  // parsed representations.
-  tinygltf::Model model;
+  // parsed representations. The model's buffers are the exception: mesh data
+  // references them directly (see WrapBufferData), so the model is shared.
+  gltf_buffers_ = std::make_shared<tinygltf::Model>();
+  tinygltf::Model& model = *gltf_buffers_;
 
   if (EndsWith(filename, ".glb")) {
     if (!gltf.LoadBinaryFromMemory(&model, &err, &warn, bytes, num_bytes,
@@ -336,6 +401,28 @@ void GltfAsset::OnLoad(const std::string& filename, std::string* data) {
   PrepareAnimations(model);
   PrepareTextures(model, directory);
   PrepareMaterials(model);
+
+  // Everything but the buffers has been converted, so release the rest of the
+  // model. Moving the buffers leaves their data (and so any pointers into it)
+  // untouched.
+  std::vector<tinygltf::Buffer> buffers = std::move(model.buffers);
+  model = tinygltf::Model();
+  model.buffers = std::move(buffers);
+
+  // DataContainers created by WrapBufferData hold their own references.
+  gltf_buffers_.reset();
+}
+
+DataContainer GltfAsset::WrapBufferData(const uint8_t* data,
+                                        size_t size) const {
+  std::shared_ptr<tinygltf::Model> buffers = gltf_buffers_;
+  DataContainer::DataPtr ptr(const_cast<uint8_t*>(data),
+                             [buffers](const uint8_t*) {
+                               // The buffers are released along with the last
+                               // copy of |buffers|.
+                             });
+  return DataContainer(std::move(ptr), size, size,
+                       DataContainer::AccessFlags::kRead);
 }
 
 void GltfAsset::PrepareNodes(const tinygltf::Model& model) {
@@ -428,6 +515,9 @@ MeshData GltfAsset::PreparePrimitive(const tinygltf::Primitive& gltf_primitive,
   VertexFormat vertex_format;
   size_t num_vertices = 0;
 
+  // The attributes that are copied into the vertex without any conversion.
+  std::vector<VertexAttributeInfo> verbatim_attributes;
+
   // According to the spec, the position attribute is required unless an
   // extension specifies them. Since we currently support no extensions,
   // exit if there are no positions. They must be Vec3f.
@@ -442,6 +532,7 @@ MeshData GltfAsset::PreparePrimitive(const tinygltf::Primitive& gltf_primitive,
     positions = positions_info->data;
     positions_stride = positions_info->byte_stride;
     positions_offset = positions_info->offset;
+    verbatim_attributes.push_back(*positions_info);
 
     // Use the position accessor to determine the number of vertices, then
     // verify that all accessors have the same count.
@@ -461,6 +552,7 @@ MeshData GltfAsset::PreparePrimitive(const tinygltf::Primitive& gltf_primitive,
     normals_stride = normals_info->byte_stride;
     if (preserve_normal_tangent_) {
       normals_offset = normals_info->offset;
+      verbatim_attributes.push_back(*normals_info);
     } else {
       orientations_offset = normals_info->offset;
     }
@@ -478,6 +570,7 @@ MeshData GltfAsset::PreparePrimitive(const tinygltf::Primitive& gltf_primitive,
       tangents = tangents_info->data;
       tangents_stride = tangents_info->byte_stride;
       tangents_offset = tangents_info->offset;
+      verbatim_attributes.push_back(*tangents_info);
     }
   } else {
     const auto* tangents_accessor = GetAndVerifyAttributeAccessor(
@@ -504,6 +597,7 @@ MeshData GltfAsset::PreparePrimitive(const tinygltf::Primitive& gltf_primitive,
     uvs_0 = uvs_0_info->data;
     uvs_0_stride = uvs_0_info->byte_stride;
     uvs_0_offset = uvs_0_info->offset;
+    verbatim_attributes.push_back(*uvs_0_info);
   }
 
   // TODO: add support for Vec4us.
@@ -516,6 +610,7 @@ MeshData GltfAsset::PreparePrimitive(const tinygltf::Primitive& gltf_primitive,
     bone_indices = joints_info->data;
     bone_indices_stride = joints_info->byte_stride;
     bone_indices_offset = joints_info->offset;
+    verbatim_attributes.push_back(*joints_info);
   }
 
   // TODO: add support for Vec4ub and Vec4us.
@@ -528,55 +623,50 @@ MeshData GltfAsset::PreparePrimitive(const tinygltf::Primitive& gltf_primitive,
     bone_weights = weights_info->data;
     bone_weights_stride = weights_info->byte_stride;
     bone_weights_offset = weights_info->offset;
+    verbatim_attributes.push_back(*weights_info);
   }
 
-  // Allocate heap storage for the entire primitive.
-  const size_t vertex_size = vertex_format.GetVertexSize();
-  DataContainer vertices =
-      DataContainer::CreateHeapDataContainer(num_vertices * vertex_size);
-  uint8_t* vertex = reinterpret_cast<uint8_t*>(vertices.GetData());
-
   // Create the index buffer (if one exists).
   DataContainer indices;
   MeshData::IndexType index_type = MeshData::IndexType::kIndexU16;
   if (gltf_primitive.indices != kInvalidTinyGltfIndex) {
     const tinygltf::Accessor& accessor =
         model.accessors[gltf_primitive.indices];
-    size_t indices_num_bytes = accessor.count * ElementSizeInBytes(accessor);
+    const size_t indices_num_bytes =
+        accessor.count * ElementSizeInBytes(accessor);
     const auto* index_buffer = DataFromGltfAccessor<uint8_t>(model, accessor);
     if (index_buffer == nullptr) {
       LOG(DFATAL) << "Failed to fetch index buffer data.";
       return MeshData();
     }
 
-    // If the Gltf index buffer is unsigned byte, convert to unsigned short.
-    std::vector<uint16_t> indices_converted_from_unsigned_byte;
     if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
-      indices_converted_from_unsigned_byte.resize(accessor.count);
+      // If the Gltf index buffer is unsigned byte, convert to unsigned short.
+      indices = DataContainer::CreateHeapDataContainer(accessor.count *
+                                                       sizeof(uint16_t));
+      uint16_t* converted = reinterpret_cast<uint16_t*>(indices.GetData());
       for (size_t i = 0; i < accessor.count; ++i) {
-        indices_converted_from_unsigned_byte[i] = index_buffer[i];
+        converted[i] = index_buffer[i];
       }
-
-      index_buffer = reinterpret_cast<uint8_t*>(
-          indices_converted_from_unsigned_byte.data());
-      indices_num_bytes *= 2;
+      indices.Advance(accessor.count * sizeof(uint16_t));
     } else {
+      // Index data is always tightly packed, so it can be used in place.
       index_type = IndexTypeForComponentType(accessor.componentType);
+      indices = WrapBufferData(index_buffer, indices_num_bytes);
     }
-
-    indices = DataContainer::CreateHeapDataContainer(indices_num_bytes);
-    memcpy(indices.GetData(), index_buffer, indices_num_bytes);
-    indices.Advance(indices_num_bytes);
   }
 
-  // Generate tangent spaces if possible and if needed.
+  // Generate tangent spaces if possible and if needed. They are only needed to
+  // compute orientations since there is no tangent attribute to store them in
+  // otherwise, and only matter if the material samples a normal map. Other
+  // orientations get an arbitrary tangent below.
   std::vector<float> generated_tangents;
-  if (positions && normals && uvs_0 && !tangents) {
+  if (positions && normals && uvs_0 && !tangents &&
+      !preserve_normal_tangent_ && HasNormalMap(gltf_primitive, model)) {
     generated_tangents.resize(num_vertices * 4);
     tangents = reinterpret_cast<const uint8_t*>(generated_tangents.data());
-    std::vector<mathfu::vec3_packed> bitangents;
-    bitangents.resize(num_vertices);
-    size_t sizeof_index;
+    tangents_stride = sizeof(mathfu::vec4_packed);
+    size_t sizeof_index = 0;
     switch (index_type) {
       case MeshData::IndexType::kIndexU16:
         sizeof_index = 2;
@@ -588,68 +678,115 @@ MeshData GltfAsset::PreparePrimitive(const tinygltf::Primitive& gltf_primitive,
         LOG(DFATAL) << "Unsupported vertex index type.";
     }
 
-    if (indices.GetSize()) {
-      ComputeTangentsWithIndexedTriangles(
-          positions, positions_stride, normals, normals_stride, uvs_0,
-          uvs_0_stride, num_vertices, indices.GetData(), sizeof_index,
-          indices.GetSize() / sizeof_index / 3,
-          reinterpret_cast<uint8_t*>(generated_tangents.data()),
-          sizeof(mathfu::vec4_packed),
-          reinterpret_cast<uint8_t*>(bitangents.data()),
-          sizeof(mathfu::vec3_packed));
-    } else {
-      ComputeTangentsWithTriangles(
+    const uint8_t* triangle_indices =
+        indices.GetSize() ? indices.GetReadPtr() : nullptr;
+    const size_t num_triangles = triangle_indices
+                                     ? indices.GetSize() / sizeof_index / 3
+                                     : num_vertices / 3;
+    auto* tangent_cache = registry_->Get<TangentCache>();
+    HashValue cache_key = 0;
+    if (tangent_cache) {
+      cache_key = TangentCache::GetKey(
           positions, positions_stride, normals, normals_stride, uvs_0,
-          uvs_0_stride, num_vertices, indices.GetSize() / sizeof_index / 3,
-          reinterpret_cast<uint8_t*>(generated_tangents.data()),
-          sizeof(mathfu::vec4_packed),
-          reinterpret_cast<uint8_t*>(bitangents.data()),
-          sizeof(mathfu::vec3_packed));
+          uvs_0_stride, num_vertices, triangle_indices, sizeof_index,
+          num_triangles);
+    }
+    const bool cached =
+        tangent_cache &&
+        tangent_cache->Load(
+            cache_key, num_vertices,
+            reinterpret_cast<uint8_t*>(generated_tangents.data()),
+            sizeof(mathfu::vec4_packed));
+    if (!cached) {
+      std::vector<mathfu::vec3_packed> bitangents(num_vertices);
+      if (triangle_indices) {
+        ComputeTangentsWithIndexedTriangles(
+            positions, positions_stride, normals, normals_stride, uvs_0,
+            uvs_0_stride, num_vertices, triangle_indices, sizeof_index,
+            num_triangles,
+            reinterpret_cast<uint8_t*>(generated_tangents.data()),
+            sizeof(mathfu::vec4_packed),
+            reinterpret_cast<uint8_t*>(bitangents.data()),
+            sizeof(mathfu::vec3_packed));
+      } else {
+        ComputeTangentsWithTriangles(
+            positions, positions_stride, normals, normals_stride, uvs_0,
+            uvs_0_stride, num_vertices, num_triangles,
+            reinterpret_cast<uint8_t*>(generated_tangents.data()),
+            sizeof(mathfu::vec4_packed),
+            reinterpret_cast<uint8_t*>(bitangents.data()),
+            sizeof(mathfu::vec3_packed));
+      }
+      if (tangent_cache) {
+        tangent_cache->Save(
+            cache_key, num_vertices,
+            reinterpret_cast<const uint8_t*>(generated_tangents.data()),
+            sizeof(mathfu::vec4_packed));
+      }
     }
   }
 
-  // Copy each vertex into array-of-structs format.
-  for (size_t i = 0; i < num_vertices; ++i) {
-    if (positions) {
-      memcpy(vertex + positions_offset, positions + positions_stride * i,
-             sizeof(float) * 3);
-    }
-    if (uvs_0) {
-      memcpy(vertex + uvs_0_offset, uvs_0 + uvs_0_stride * i,
-             sizeof(float) * 2);
-    }
-    if (preserve_normal_tangent_) {
-      if (normals) {
-        memcpy(vertex + normals_offset, normals + normals_stride * i,
+  // If every attribute is used as-is and the GLTF already interleaves them the
+  // same way as |vertex_format|, the vertices are referenced in place.
+  // Otherwise, copy each vertex into array-of-structs format.
+  const size_t vertex_size = vertex_format.GetVertexSize();
+  const uint8_t* interleaved = nullptr;
+  if (verbatim_attributes.size() == vertex_format.GetNumAttributes()) {
+    interleaved = FindInterleavedVertexData(model, verbatim_attributes,
+                                            vertex_size, num_vertices);
+  }
+
+  DataContainer vertices;
+  if (interleaved) {
+    vertices = WrapBufferData(interleaved, num_vertices * vertex_size);
+  } else {
+    vertices =
+        DataContainer::CreateHeapDataContainer(num_vertices * vertex_size);
+    uint8_t* vertex = vertices.GetData();
+    for (size_t i = 0; i < num_vertices; ++i) {
+      if (positions) {
+        memcpy(vertex + positions_offset, positions + positions_stride * i,
                sizeof(float) * 3);
       }
-      if (tangents) {
-        memcpy(vertex + tangents_offset, tangents + tangents_stride * i,
-               sizeof(float) * 4);
+      if (uvs_0) {
+        memcpy(vertex + uvs_0_offset, uvs_0 + uvs_0_stride * i,
+               sizeof(float) * 2);
       }
-    } else if (normals && tangents) {
-      // Create TBN quaternions using the available normals and tangents.
-      const mathfu::vec3 normal = mathfu::vec3(
-          reinterpret_cast<const float*>(normals + normals_stride * i));
-      // TODO: respect the 4th component of the tangent.
-      mathfu::vec3 tangent = mathfu::vec3(
-          reinterpret_cast<const float*>(tangents + tangents_stride * i));
-      mathfu::vec4 quat = OrientationForTbn(normal, tangent);
-      if (quat[3] < 0.f) {
-        quat *= -1.f;
+      if (preserve_normal_tangent_) {
+        if (normals) {
+          memcpy(vertex + normals_offset, normals + normals_stride * i,
+                 sizeof(float) * 3);
+        }
+        if (tangents) {
+          memcpy(vertex + tangents_offset, tangents + tangents_stride * i,
+                 sizeof(float) * 4);
+        }
+      } else if (normals) {
+        // Create TBN quaternions using the available normals and tangents.
+        const mathfu::vec3 normal = mathfu::vec3(
+            reinterpret_cast<const float*>(normals + normals_stride * i));
+        // TODO: respect the 4th component of the tangent.
+        mathfu::vec3 tangent =
+            tangents ? mathfu::vec3(reinterpret_cast<const float*>(
+                           tangents + tangents_stride * i))
+                     : AnyPerpendicular(normal);
+        mathfu::vec4 quat = OrientationForTbn(normal, tangent);
+        if (quat[3] < 0.f) {
+          quat *= -1.f;
+        }
+        memcpy(vertex + orientations_offset, &quat[0], sizeof(float) * 4);
       }
-      memcpy(vertex + orientations_offset, &quat[0], sizeof(float) * 4);
-    }
-    if (bone_indices) {
-      memcpy(vertex + bone_indices_offset,
-             bone_indices + bone_indices_stride * i, sizeof(uint8_t) * 4);
-    }
-    if (bone_weights) {
-      memcpy(vertex + bone_weights_offset,
-             bone_weights + bone_weights_stride * i, sizeof(float) * 4);
+      if (bone_indices) {
+        memcpy(vertex + bone_indices_offset,
+               bone_indices + bone_indices_stride * i, sizeof(uint8_t) * 4);
+      }
+      if (bone_weights) {
+        memcpy(vertex + bone_weights_offset,
+               bone_weights + bone_weights_stride * i, sizeof(float) * 4);
+      }
+      vertex += vertex_size;
+      vertices.Advance(vertex_size);
     }
-    vertex += vertex_size;
-    vertices.Advance(vertex_size);
   }
 
   // If there is no index buffer, return the MeshData as-is.
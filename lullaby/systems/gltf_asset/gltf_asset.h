@@ -189,6 +189,11 @@ class GltfAsset : public Asset {
                          const std::map<std::string, int>& attr_map,
                          const tinygltf::Model& model);
 
+  /// Returns a read-only DataContainer referencing |size| bytes at |data|,
+  /// which must point into |gltf_buffers_|. The container keeps the buffers
+  /// alive so that no copy of the data is needed.
+  DataContainer WrapBufferData(const uint8_t* data, size_t size) const;
+
   Registry* registry_;
   HashValue id_;
   bool preserve_normal_tangent_ = false;
@@ -201,6 +206,12 @@ class GltfAsset : public Asset {
   std::vector<AnimationInfo> anim_infos_;
   std::vector<TextureInfo> texture_infos_;
   std::vector<MaterialInfo> material_infos_;
+
+  /// The parsed GLTF model while the asset is being loaded. Once loading is
+  /// complete, only its buffers (eg. the binary chunk of a GLB) are retained,
+  /// and only for as long as DataContainers created by WrapBufferData
+  /// reference them.
+  std::shared_ptr<tinygltf::Model> gltf_buffers_;
 };
 
 }  // namespace lull
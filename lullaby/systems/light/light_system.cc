@@ -16,7 +16,11 @@ limitations under the License.
 
 #include "lullaby/systems/light/light_system.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "lullaby/events/render_events.h"
+#include "lullaby/modules/ecs/system_profiler.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/render/texture_factory.h"
 #include "mathfu/constants.h"
@@ -24,19 +28,49 @@ limitations under the License.
 
 namespace lull {
 namespace {
-static constexpr char kLightMatrixUniformName[] =
+static constexpr HashedString kLightMatrixUniformName =
     "directional_light_shadow_matrix";
-static constexpr char kColorUniformName[] = "light_directional_color";
-static constexpr char kDirectionUniformName[] = "light_directional_dir";
-static constexpr char kExponentUniformName[] = "light_directional_exponent";
+static constexpr HashedString kColorUniformName = "light_directional_color";
+static constexpr HashedString kDirectionUniformName = "light_directional_dir";
+static constexpr HashedString kExponentUniformName =
+    "light_directional_exponent";
 
-static constexpr char kShadowColorUniformName[] =
+static constexpr HashedString kShadowColorUniformName =
     "light_directional_shadow_color";
-static constexpr char kShadowDirectionUniformName[] =
+static constexpr HashedString kShadowDirectionUniformName =
     "light_directional_shadow_dir";
-static constexpr char kShadowExponentUniformName[] =
+static constexpr HashedString kShadowExponentUniformName =
     "light_directional_shadow_exponent";
 
+// Point lights are assigned to lightables through a uniform grid of cells with
+// this size (in world units).
+static constexpr float kLightGridCellSize = 1.0f;
+
+mathfu::vec3 GetLightGridCoordinates(const mathfu::vec3& position) {
+  return mathfu::vec3(std::floor(position.x / kLightGridCellSize),
+                      std::floor(position.y / kLightGridCellSize),
+                      std::floor(position.z / kLightGridCellSize));
+}
+
+// Packs the 21 low bits of each grid coordinate into a single key.
+uint64_t GetLightGridCell(const mathfu::vec3& position) {
+  const mathfu::vec3 coords = GetLightGridCoordinates(position);
+  const auto pack = [](float coord) {
+    return static_cast<uint64_t>(static_cast<int64_t>(coord)) & 0x1fffff;
+  };
+  return pack(coords.x) | (pack(coords.y) << 21) | (pack(coords.z) << 42);
+}
+
+mathfu::vec3 GetLightGridCellCenter(uint64_t cell) {
+  const auto unpack = [](uint64_t bits) {
+    // Sign extend the 21 bit coordinate.
+    const int64_t coord = static_cast<int64_t>(bits << 43) >> 43;
+    return (static_cast<float>(coord) + 0.5f) * kLightGridCellSize;
+  };
+  return mathfu::vec3(unpack(cell & 0x1fffff), unpack((cell >> 21) & 0x1fffff),
+                      unpack((cell >> 42) & 0x1fffff));
+}
+
 HashValue RenderPassNameFromEntityAndLightGroup(Entity entity,
                                                 HashValue group) {
   return entity.AsUint32() + group;
@@ -200,6 +234,7 @@ void LightSystem::Destroy(Entity entity) {
 }
 
 void LightSystem::AdvanceFrame() {
+  SystemProfiler::ScopedSample sample(registry_, this);
   auto* transform_system = registry_->Get<lull::TransformSystem>();
   UpdateLightTransforms(transform_system, directionals_);
   UpdateLightTransforms(transform_system, points_);
@@ -298,15 +333,25 @@ void LightSystem::LightGroup::AddLightable(Registry* registry, Entity entity,
   }
   if (lightable.shadow_interaction == ShadowInteraction_CastAndReceive) {
     auto* dispatcher_system = registry->Get<lull::DispatcherSystem>();
+    auto* transform_system = registry->Get<lull::TransformSystem>();
     for (const auto& shadow_pass_data : shadow_passes_) {
-      AddLightableToShadowPass(render_system, dispatcher_system, entity,
-                               shadow_pass_data.pass, lightable);
+      AddLightableToShadowPass(render_system, dispatcher_system,
+                               transform_system, entity, shadow_pass_data.pass,
+                               lightable);
     }
   }
 }
 
 void LightSystem::LightGroup::Remove(Registry* registry, Entity entity) {
-  if (lightables_.erase(entity)) {
+  lightable_cells_.erase(entity);
+  shadow_caster_transforms_.erase(entity);
+  auto lightable_iter = lightables_.find(entity);
+  if (lightable_iter != lightables_.end()) {
+    if (lightable_iter->second.shadow_interaction ==
+        ShadowInteraction_CastAndReceive) {
+      InvalidateShadowMaps();
+    }
+    lightables_.erase(lightable_iter);
     auto* render_system = registry->Get<RenderSystem>();
     for (const auto& shadow_pass_data : shadow_passes_) {
       RemoveLightableFromShadowPass(render_system, entity,
@@ -329,6 +374,7 @@ void LightSystem::LightGroup::Remove(Registry* registry, Entity entity) {
     directionals_.erase(directionals_iterator);
   }
   if (points_.erase(entity)) {
+    cell_point_lights_.clear();
     dirty_ = true;
   }
   if (spot_lights_.erase(entity)) {
@@ -345,21 +391,31 @@ void LightSystem::LightGroup::Remove(Registry* registry, Entity entity) {
 
 void LightSystem::LightGroup::Update(TransformSystem* transform_system,
                                      RenderSystem* render_system) {
+  UpdateShadowCasters(transform_system);
   if (dirty_) {
     for (auto& shadow_pass_data : shadow_passes_) {
+      const mathfu::mat4 previous_matrix =
+          shadow_pass_data.view.clip_from_world_matrix;
       UpdateRenderViewTransform(transform_system,
                                 shadow_pass_data.transform_entity,
                                 &shadow_pass_data.view);
+      if (shadow_pass_data.view.clip_from_world_matrix != previous_matrix) {
+        shadow_pass_data.needs_render = true;
+      }
     }
+    cell_point_lights_.clear();
     for (auto& lightable : lightables_) {
-      UpdateLightable(render_system, lightable.first, lightable.second);
+      UpdateLightable(transform_system, render_system, lightable.first,
+                      lightable.second);
     }
     dirty_ = false;
   } else {
+    UpdateLightableCells(transform_system);
     for (Entity dirty_lightable : dirty_lightables_) {
       auto lightable = lightables_.find(dirty_lightable);
       if (lightable != lightables_.end()) {
-        UpdateLightable(render_system, lightable->first, lightable->second);
+        UpdateLightable(transform_system, render_system, lightable->first,
+                        lightable->second);
       }
     }
   }
@@ -409,7 +465,79 @@ void LightSystem::UpdateUniforms(UniformData* uniforms,
   }
 }
 
-void LightSystem::LightGroup::UpdateLightable(RenderSystem* render_system,
+void LightSystem::LightGroup::UpdateLightableCells(
+    TransformSystem* transform_system) {
+  for (auto& iter : lightable_cells_) {
+    const mathfu::mat4* matrix =
+        transform_system->GetWorldFromEntityMatrix(iter.first);
+    if (matrix == nullptr) {
+      continue;
+    }
+    const uint64_t cell = GetLightGridCell(matrix->TranslationVector3D());
+    if (cell != iter.second) {
+      dirty_lightables_.insert(iter.first);
+    }
+  }
+}
+
+void LightSystem::LightGroup::UpdateShadowCasters(
+    TransformSystem* transform_system) {
+  if (shadow_passes_.empty()) {
+    return;
+  }
+  for (auto& iter : shadow_caster_transforms_) {
+    const mathfu::mat4* matrix =
+        transform_system->GetWorldFromEntityMatrix(iter.first);
+    if (matrix && *matrix != iter.second) {
+      iter.second = *matrix;
+      InvalidateShadowMaps();
+    }
+  }
+}
+
+const std::vector<const PointLightDefT*>&
+LightSystem::LightGroup::GetCellPointLights(uint64_t cell) {
+  auto iter = cell_point_lights_.find(cell);
+  if (iter != cell_point_lights_.end()) {
+    return iter->second;
+  }
+
+  std::vector<const PointLightDefT*>& lights = cell_point_lights_[cell];
+  lights.reserve(points_.size());
+  for (const auto& light : points_) {
+    lights.push_back(&light.second);
+  }
+  const mathfu::vec3 center = GetLightGridCellCenter(cell);
+  std::sort(lights.begin(), lights.end(),
+            [&center](const PointLightDefT* lhs, const PointLightDefT* rhs) {
+              return (lhs->position - center).LengthSquared() <
+                     (rhs->position - center).LengthSquared();
+            });
+  return lights;
+}
+
+void LightSystem::LightGroup::AddPointLightUniforms(
+    TransformSystem* transform_system, Entity entity, int max_allowed,
+    UniformData* uniforms) {
+  const mathfu::mat4* matrix =
+      transform_system->GetWorldFromEntityMatrix(entity);
+  if (points_.size() <= static_cast<size_t>(std::max(max_allowed, 0)) ||
+      matrix == nullptr) {
+    lightable_cells_.erase(entity);
+    UpdateUniforms(uniforms, points_, max_allowed, 0);
+    return;
+  }
+
+  const uint64_t cell = GetLightGridCell(matrix->TranslationVector3D());
+  lightable_cells_[entity] = cell;
+  const std::vector<const PointLightDefT*>& lights = GetCellPointLights(cell);
+  for (int i = 0; i < max_allowed; ++i) {
+    uniforms->Add(*lights[i]);
+  }
+}
+
+void LightSystem::LightGroup::UpdateLightable(TransformSystem* transform_system,
+                                              RenderSystem* render_system,
                                               Entity entity,
                                               const LightableDefT& data) {
   UniformData uniforms;
@@ -417,7 +545,8 @@ void LightSystem::LightGroup::UpdateLightable(RenderSystem* render_system,
   UpdateUniforms(
       &uniforms, directionals_, data.max_directional_lights,
       (data.shadow_interaction == ShadowInteraction_CastAndReceive) ? 1 : 0);
-  UpdateUniforms(&uniforms, points_, data.max_point_lights, 0);
+  AddPointLightUniforms(transform_system, entity, data.max_point_lights,
+                        &uniforms);
   UpdateUniforms(&uniforms, spot_lights_, /*max_allowed=*/1, 0);
 
   if (data.apply_environment_light && environment_light_) {
@@ -439,7 +568,7 @@ void LightSystem::LightGroup::UpdateLightable(RenderSystem* render_system,
 
   // Special case: Also update the shadow matrices.
   for (const auto& shadow_pass : shadow_passes_) {
-    render_system->SetUniform(entity, kLightMatrixUniformName,
+    render_system->SetUniform(entity, kLightMatrixUniformName.data(),
                               &shadow_pass.view.clip_from_world_matrix[0],
                               16 /*=dimensions*/, 1 /*=count*/);
   }
@@ -503,8 +632,15 @@ void LightSystem::LightGroup::DestroyShadowPass(RenderSystem* render_system,
 
 void LightSystem::UniformData::Clear() { buffers.clear(); }
 
+LightSystem::UniformData::Buffer& LightSystem::UniformData::GetBuffer(
+    HashedString name) {
+  Buffer& buffer = buffers[name.GetHash()];
+  buffer.name = name;
+  return buffer;
+}
+
 void LightSystem::UniformData::Add(const AmbientLightDefT& light) {
-  auto& colors = buffers["light_ambient_color"];
+  auto& colors = GetBuffer("light_ambient_color");
   colors.dimension = 3;
   colors.data.push_back(light.color.r);
   colors.data.push_back(light.color.g);
@@ -514,14 +650,15 @@ void LightSystem::UniformData::Add(const AmbientLightDefT& light) {
 void LightSystem::UniformData::Add(const DirectionalLightDefT& light) {
   const bool has_shadow = HasShadows(light);
   auto& colors =
-      buffers[has_shadow ? kShadowColorUniformName : kColorUniformName];
+      GetBuffer(has_shadow ? kShadowColorUniformName : kColorUniformName);
   colors.dimension = 3;
   colors.data.push_back(light.color.r);
   colors.data.push_back(light.color.g);
   colors.data.push_back(light.color.b);
 
   auto& directions =
-      buffers[has_shadow ? kShadowDirectionUniformName : kDirectionUniformName];
+      GetBuffer(has_shadow ? kShadowDirectionUniformName
+                           : kDirectionUniformName);
   directions.dimension = 3;
 
   const mathfu::vec3 light_dir = light.rotation * -mathfu::kAxisZ3f;
@@ -531,76 +668,77 @@ void LightSystem::UniformData::Add(const DirectionalLightDefT& light) {
 
   if (light.exponent != 0.0f) {
     auto& exponents =
-        buffers[has_shadow ? kShadowExponentUniformName : kExponentUniformName];
+        GetBuffer(has_shadow ? kShadowExponentUniformName
+                             : kExponentUniformName);
     exponents.dimension = 1;
     exponents.data.push_back(light.exponent);
   }
 }
 
 void LightSystem::UniformData::Add(const SpotLightDefT& light) {
-  auto& colors = buffers["light_spotlight_color"];
+  auto& colors = GetBuffer("light_spotlight_color");
   colors.dimension = 3;
   colors.data.push_back(light.color.r * light.intensity);
   colors.data.push_back(light.color.g * light.intensity);
   colors.data.push_back(light.color.b * light.intensity);
 
-  auto& positions = buffers["light_spotlight_pos"];
+  auto& positions = GetBuffer("light_spotlight_pos");
   positions.dimension = 3;
   positions.data.push_back(light.position.x);
   positions.data.push_back(light.position.y);
   positions.data.push_back(light.position.z);
 
   const mathfu::vec3 light_dir = light.rotation * -mathfu::kAxisZ3f;
-  auto& directions = buffers["light_spotlight_dir"];
+  auto& directions = GetBuffer("light_spotlight_dir");
   directions.dimension = 3;
   directions.data.push_back(light_dir.x);
   directions.data.push_back(light_dir.y);
   directions.data.push_back(light_dir.z);
 
-  auto& decay = buffers["light_spotlight_decay"];
+  auto& decay = GetBuffer("light_spotlight_decay");
   decay.dimension = 1;
   decay.data.push_back(light.decay);
 
   const float angle_in_radians =
       std::min(light.angle, 90.0f) * kDegreesToRadians;
-  auto& angle = buffers["light_spotlight_angle_cos"];
+  auto& angle = GetBuffer("light_spotlight_angle_cos");
   angle.dimension = 1;
   angle.data.push_back(std::cos(angle_in_radians));
 
-  auto& penumbra = buffers["light_spotlight_penumbra_cos"];
+  auto& penumbra = GetBuffer("light_spotlight_penumbra_cos");
   penumbra.dimension = 1;
   penumbra.data.push_back(
       std::cos(mathfu::Clamp(light.penumbra, 0.0f, 1.0f) * angle_in_radians));
 }
 
 void LightSystem::UniformData::Add(const PointLightDefT& light) {
-  auto& colors = buffers["light_point_color"];
+  auto& colors = GetBuffer("light_point_color");
   colors.dimension = 3;
   colors.data.push_back(light.color.r * light.intensity);
   colors.data.push_back(light.color.g * light.intensity);
   colors.data.push_back(light.color.b * light.intensity);
 
-  auto& positions = buffers["light_point_pos"];
+  auto& positions = GetBuffer("light_point_pos");
   positions.dimension = 3;
   positions.data.push_back(light.position.x);
   positions.data.push_back(light.position.y);
   positions.data.push_back(light.position.z);
 
   if (light.exponent != 0.0f) {
-    auto& exponents = buffers["light_point_exponent"];
+    auto& exponents = GetBuffer("light_point_exponent");
     exponents.dimension = 1;
     exponents.data.push_back(light.exponent);
   }
 }
 
 void LightSystem::UniformData::Add(const EnvironmentLightDefT& light) {
-  auto& colors = buffers["light_environment_color_factor"];
+  auto& colors = GetBuffer("light_environment_color_factor");
   colors.dimension = 3;
   colors.data.push_back(light.color.r);
   colors.data.push_back(light.color.g);
   colors.data.push_back(light.color.b);
 
-  auto& mips = buffers["num_mips"];
+  auto& mips = GetBuffer("num_mips");
   mips.dimension = 1;
   mips.data.push_back(static_cast<float>(light.specular_mips));
 }
@@ -610,7 +748,7 @@ void LightSystem::UniformData::Apply(RenderSystem* render_system,
   for (const auto& it : buffers) {
     const auto& buffer = it.second;
     const int count = static_cast<int>(buffer.data.size()) / buffer.dimension;
-    render_system->SetUniform(entity, it.first.c_str(), buffer.data.data(),
+    render_system->SetUniform(entity, buffer.name.data(), buffer.data.data(),
                               buffer.dimension, count);
   }
 }
@@ -618,22 +756,38 @@ void LightSystem::UniformData::Apply(RenderSystem* render_system,
 void LightSystem::RenderShadowMaps() {
   auto* render_system = registry_->Get<RenderSystem>();
 
-  for (const auto& group : groups_) {
+  for (auto& group : groups_) {
     group.second.RenderShadowMaps(render_system);
   }
 }
 
-void LightSystem::LightGroup::RenderShadowMaps(
-    RenderSystem* render_system) const {
-  for (const auto& shadow_pass : shadow_passes_) {
+void LightSystem::InvalidateShadowMaps() {
+  for (auto& group : groups_) {
+    group.second.InvalidateShadowMaps();
+  }
+}
+
+void LightSystem::LightGroup::RenderShadowMaps(RenderSystem* render_system) {
+  for (auto& shadow_pass : shadow_passes_) {
+    if (shadow_pass.cached && !shadow_pass.needs_render) {
+      continue;
+    }
     render_system->Render(&shadow_pass.view, 1,
                           static_cast<RenderPass>(shadow_pass.pass));
+    shadow_pass.needs_render = false;
+  }
+}
+
+void LightSystem::LightGroup::InvalidateShadowMaps() {
+  for (auto& shadow_pass : shadow_passes_) {
+    shadow_pass.needs_render = true;
   }
 }
 
 void LightSystem::LightGroup::AddLightableToShadowPass(
     RenderSystem* render_system, DispatcherSystem* dispatcher_system,
-    Entity entity, HashValue pass, const LightableDefT& lightable) {
+    TransformSystem* transform_system, Entity entity, HashValue pass,
+    const LightableDefT& lightable) {
   if (!dispatcher_system) {
     LOG(FATAL) << "Must create the DispatcherSystem to use shadows.";
     return;
@@ -652,12 +806,21 @@ void LightSystem::LightGroup::AddLightableToShadowPass(
 
   dispatcher_system->Connect(
       entity, this,
-      [render_system, entity, pass](const MeshChangedEvent& event) {
+      [this, render_system, entity, pass](const MeshChangedEvent& event) {
         if (event.pass != pass) {
           render_system->SetMesh({entity, pass},
                                  render_system->GetMesh({entity, event.pass}));
+          InvalidateShadowMaps();
         }
       });
+
+  if (!lightable.static_shadow_caster && transform_system) {
+    const mathfu::mat4* matrix =
+        transform_system->GetWorldFromEntityMatrix(entity);
+    shadow_caster_transforms_[entity] =
+        matrix ? *matrix : mathfu::mat4::Identity();
+  }
+  InvalidateShadowMaps();
   dirty_lightables_.insert(entity);
 }
 
@@ -706,6 +869,7 @@ void LightSystem::LightGroup::CreateShadowPass(
   shadow_pass_data.view.viewport.x = 0;
   shadow_pass_data.view.viewport.y = 0;
   shadow_pass_data.view.dimensions = create_params.dimensions;
+  shadow_pass_data.cached = shadow_def->cache_shadow_map;
 
   // Construct the view and projection matrices.
   const float half_shadow_volume = shadow_def->shadow_volume * 0.5f;
@@ -723,8 +887,8 @@ void LightSystem::LightGroup::CreateShadowPass(
     if (lightable.second.shadow_interaction ==
         ShadowInteraction_CastAndReceive) {
       AddLightableToShadowPass(render_system, dispatcher_system,
-                               lightable.first, shadow_pass_data.pass,
-                               lightable.second);
+                               transform_system, lightable.first,
+                               shadow_pass_data.pass, lightable.second);
     }
   }
 
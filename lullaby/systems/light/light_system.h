@@ -27,6 +27,7 @@ limitations under the License.
 #include "lullaby/systems/dispatcher/dispatcher_system.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/hashed_string.h"
 #include "lullaby/util/math.h"
 #include "lullaby/util/optional.h"
 
@@ -64,6 +65,11 @@ class LightSystem : public System {
   /// RenderSystem::EndRendering().
   void RenderShadowMaps();
 
+  /// Forces all cached shadow maps to be re-rendered on the next call to
+  /// RenderShadowMaps(). Use this when a shadow caster changes in a way the
+  /// LightSystem cannot observe (eg. vertex animation).
+  void InvalidateShadowMaps();
+
   /// Attaches an ambient light.
   /// @param entity The entity to which to attach the ambient light.
   /// @param data The ambient light definition for this light.
@@ -119,10 +125,16 @@ class LightSystem : public System {
 
    private:
     struct Buffer {
+      HashedString name;
       int dimension = 0;
       std::vector<float> data;
     };
-    std::unordered_map<std::string, Buffer> buffers;
+
+    /// Returns the buffer for the uniform |name|, which must be a string
+    /// literal (or otherwise outlive this UniformData).
+    Buffer& GetBuffer(HashedString name);
+
+    std::unordered_map<HashValue, Buffer> buffers;
   };
 
   /// Helper structure to hold lights and lightables associated together.
@@ -156,8 +168,11 @@ class LightSystem : public System {
     /// Remove an entity from the group.
     void Remove(Registry* registry, Entity entity);
 
-    /// Render the shadow maps for the passes.
-    void RenderShadowMaps(RenderSystem* render_system) const;
+    /// Render the shadow maps for the passes that are out of date.
+    void RenderShadowMaps(RenderSystem* render_system);
+
+    /// Marks all of the group's shadow maps as out of date.
+    void InvalidateShadowMaps();
 
     /// Is this group empty?
     bool Empty() const;
@@ -167,14 +182,35 @@ class LightSystem : public System {
       Entity transform_entity = kNullEntity;
       HashValue pass;
       RenderView view;
+      // Whether the shadow map may be reused across frames.
+      bool cached = true;
+      // Whether the shadow map must be rendered on the next RenderShadowMaps.
+      bool needs_render = true;
     };
 
     void UpdateLightable(RenderSystem* render_system, Entity entity);
-    void UpdateLightable(RenderSystem* render_system, Entity entity,
+    void UpdateLightable(TransformSystem* transform_system,
+                         RenderSystem* render_system, Entity entity,
                          const LightableDefT& data);
+    /// Adds the uniforms for the point lights applied to a lightable.  If the
+    /// group has more point lights than the lightable allows, only the lights
+    /// nearest to the lightable's light grid cell are used.
+    void AddPointLightUniforms(TransformSystem* transform_system,
+                               Entity entity, int max_allowed,
+                               UniformData* uniforms);
+    /// Returns the group's point lights ordered by distance to the center of
+    /// |cell|.  The list is computed once per cell and shared by all the
+    /// lightables in it until the lights change.
+    const std::vector<const PointLightDefT*>& GetCellPointLights(
+        uint64_t cell);
+    /// Marks lightables that moved to another light grid cell as dirty.
+    void UpdateLightableCells(TransformSystem* transform_system);
+    /// Invalidates the shadow maps if a dynamic shadow caster moved.
+    void UpdateShadowCasters(TransformSystem* transform_system);
     void DestroyShadowPass(RenderSystem* render_system, HashValue pass);
     void AddLightableToShadowPass(RenderSystem* render_system,
                                   DispatcherSystem* dispatcher_system,
+                                  TransformSystem* transform_system,
                                   Entity entity, HashValue pass,
                                   const LightableDefT& lightable);
     void CreateShadowPass(Registry* registry, Entity entity,
@@ -194,6 +230,15 @@ class LightSystem : public System {
     Optional<EnvironmentLightDefT> environment_light_;
     std::set<Entity> dirty_lightables_;
     std::vector<ShadowPassData> shadow_passes_;
+    /// The last world transform of each non-static shadow caster, used to
+    /// detect when cached shadow maps need to be re-rendered.
+    std::unordered_map<Entity, mathfu::mat4> shadow_caster_transforms_;
+    /// The light grid cell of each lightable that is limited to the point
+    /// lights nearest to it.
+    std::unordered_map<Entity, uint64_t> lightable_cells_;
+    /// The point lights of each light grid cell, nearest first.
+    std::unordered_map<uint64_t, std::vector<const PointLightDefT*>>
+        cell_point_lights_;
   };
 
   // Update the transforms of light objects associated with a set of entities.
@@ -68,6 +68,17 @@ void ModelAssetSystem::ModelAssetInstance::Finalize() {
     }
   }
 
+  // Build a single Skeleton that can be shared between all Entities created
+  // from this model.  Each Entity only stores its own pose.
+  if (model_asset_->HasValidSkeleton()) {
+    skeleton_ = RigSystem::CreateSkeleton(
+        model_asset_->GetParentBoneIndices(),
+        model_asset_->GetInverseBindPose(),
+        model_asset_->GetShaderBoneIndices(),
+        {model_asset_->GetBoneNames().begin(),
+         model_asset_->GetBoneNames().end()});
+  }
+
   auto* texture_factory = registry_->Get<TextureFactory>();
   if (texture_factory) {
     for (ModelAsset::TextureInfo& info : model_asset_->GetMutableTextures()) {
@@ -325,15 +336,7 @@ void ModelAssetSystem::FinalizeEntity(const EntitySetupInfo& setup) {
   if (asset->HasValidSkeleton()) {
     auto* rig_system = registry_->Get<RigSystem>();
     if (rig_system) {
-      const RigSystem::BoneIndices parent_indices =
-          asset->GetParentBoneIndices();
-      const RigSystem::BoneIndices shader_indices =
-          asset->GetShaderBoneIndices();
-      const RigSystem::Pose inverse_bind_pose = asset->GetInverseBindPose();
-      std::vector<std::string> bone_names = {asset->GetBoneNames().begin(),
-                                             asset->GetBoneNames().end()};
-      rig_system->SetRig(setup.entity, parent_indices, inverse_bind_pose,
-                         shader_indices, std::move(bone_names));
+      rig_system->SetRig(setup.entity, setup.instance->GetSkeleton());
     } else if (render_system) {
       const size_t num_bones = asset->GetParentBoneIndices().size();
       if (num_bones > 0) {
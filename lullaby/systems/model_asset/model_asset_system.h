@@ -71,11 +71,13 @@ class ModelAssetSystem : public System {
     void SetReady(bool b) { ready_ = b; }
 
     MeshPtr GetMesh() const;
+    RigSystem::SkeletonPtr GetSkeleton() const { return skeleton_; }
     std::shared_ptr<ModelAsset> GetAsset() const { return model_asset_; }
 
    private:
     Registry* registry_;
     MeshPtr mesh_;
+    RigSystem::SkeletonPtr skeleton_;
     std::unordered_map<HashValue, TexturePtr> textures_;
     std::shared_ptr<ModelAsset> model_asset_;
     bool create_distinct_meshes_ = false;
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "lullaby/systems/name/name_system.h"
 
+#include <algorithm>
 #include <set>
 
 #include "lullaby/modules/dispatcher/dispatcher.h"
@@ -48,6 +49,10 @@ NameSystem::NameSystem(Registry* registry, bool allow_duplicate_names)
     dispatcher->Connect(this, [this](const SetNameEvent& e) {
       SetName(e.entity, e.name);
     });
+    dispatcher->Connect(this, [this](const ParentChangedImmediateEvent& e) {
+      OnParentChanged(e);
+    });
+    cache_descendants_ = true;
   }
 }
 
@@ -83,10 +88,13 @@ void NameSystem::Create(Entity entity, HashValue type, const Def* def) {
 void NameSystem::Destroy(Entity entity) {
   auto iter = entity_to_hash_.find(entity);
   if (iter != entity_to_hash_.end()) {
-    hash_to_entity_.erase(iter->second);
+    RemoveFromIndex(entity, iter->second);
     entity_to_hash_.erase(iter);
+    entity_to_name_.erase(entity);
+    name_suffixes_dirty_ = true;
   }
-  entity_to_name_.erase(entity);
+  // The entity may have been the root of cached searches.
+  InvalidateCaches();
 }
 
 void NameSystem::SetName(Entity entity, const std::string& name) {
@@ -110,11 +118,53 @@ void NameSystem::SetName(Entity entity, const std::string& name) {
       LOG(DFATAL) << "Entity " << name << " already exists!";
       return;
     }
-    hash_to_entity_.erase(Hash(existing_name.c_str()));
-    hash_to_entity_[hash] = entity;
   }
+  auto iter = entity_to_hash_.find(entity);
+  if (iter != entity_to_hash_.end()) {
+    RemoveFromIndex(entity, iter->second);
+  }
+  AddToIndex(entity, hash);
   entity_to_name_[entity] = name;
   entity_to_hash_[entity] = hash;
+  name_suffixes_dirty_ = true;
+  InvalidateCaches();
+}
+
+void NameSystem::AddToIndex(Entity entity, HashValue hash) {
+  if (allow_duplicate_names_) {
+    hash_to_entities_[hash].push_back(entity);
+  } else {
+    hash_to_entity_[hash] = entity;
+  }
+}
+
+void NameSystem::RemoveFromIndex(Entity entity, HashValue hash) {
+  if (allow_duplicate_names_) {
+    auto iter = hash_to_entities_.find(hash);
+    if (iter != hash_to_entities_.end()) {
+      std::vector<Entity>& entities = iter->second;
+      entities.erase(std::remove(entities.begin(), entities.end(), entity),
+                     entities.end());
+      if (entities.empty()) {
+        hash_to_entities_.erase(iter);
+      }
+    }
+  } else {
+    auto iter = hash_to_entity_.find(hash);
+    if (iter != hash_to_entity_.end() && iter->second == entity) {
+      hash_to_entity_.erase(iter);
+    }
+  }
+}
+
+void NameSystem::InvalidateCaches() {
+  if (!descendant_cache_.empty()) {
+    descendant_cache_.clear();
+  }
+}
+
+void NameSystem::OnParentChanged(const ParentChangedImmediateEvent& /*event*/) {
+  InvalidateCaches();
 }
 
 std::string NameSystem::GetName(Entity entity) const {
@@ -126,12 +176,9 @@ std::string NameSystem::GetName(Entity entity) const {
 Entity NameSystem::FindEntity(const std::string& name) const {
   const auto hash = Hash(name.c_str());
   if (allow_duplicate_names_) {
-    for (const auto& entry : entity_to_hash_) {
-      if (entry.second == hash) {
-        return entry.first;
-      }
-    }
-    return kNullEntity;
+    const auto iter = hash_to_entities_.find(hash);
+    return iter != hash_to_entities_.end() ? iter->second.front()
+                                           : kNullEntity;
   } else {
     const auto iter = hash_to_entity_.find(hash);
     return iter != hash_to_entity_.end() ? iter->second : kNullEntity;
@@ -151,51 +198,102 @@ Entity NameSystem::FindDescendant(Entity root, const std::string& name) const {
   }
 
   const HashValue hash = Hash(name.c_str());
+  const uint64_t key = (static_cast<uint64_t>(root.AsUint32()) << 32) | hash;
+  if (cache_descendants_) {
+    const auto iter = descendant_cache_.find(key);
+    if (iter != descendant_cache_.end()) {
+      return iter->second;
+    }
+  }
+
+  Entity result = kNullEntity;
   if (allow_duplicate_names_) {
-    return FindDescendantWithDuplicateNames(transform_system, root, hash);
+    result = FindDescendantWithDuplicateNames(transform_system, root, hash);
   } else {
     const auto iter = hash_to_entity_.find(hash);
     if (iter != hash_to_entity_.end()) {
       const Entity entity = iter->second;
       if (root == entity || transform_system->IsAncestorOf(root, entity)) {
-        return entity;
+        result = entity;
       }
     }
-    return kNullEntity;
   }
+
+  if (cache_descendants_) {
+    descendant_cache_.emplace(key, result);
+  }
+  return result;
 }
 
 Entity NameSystem::FindDescendantWithDuplicateNames(
     TransformSystem* transform_system, Entity root, HashValue hash) const {
-  const auto iter = entity_to_hash_.find(root);
-  if (iter != entity_to_hash_.end() && iter->second == hash) {
-    return root;
-  }
-
-  const auto* children = transform_system->GetChildren(root);
-  if (children) {
-    for (Entity child : *children) {
-      const Entity result =
-          FindDescendantWithDuplicateNames(transform_system, child, hash);
-      if (result != kNullEntity) {
-        return result;
-      }
+  // Only the entities with the name need to be checked, rather than the whole
+  // subtree under |root|.
+  const auto iter = hash_to_entities_.find(hash);
+  if (iter == hash_to_entities_.end()) {
+    return kNullEntity;
+  }
+  for (const Entity entity : iter->second) {
+    if (root == entity || transform_system->IsAncestorOf(root, entity)) {
+      return entity;
     }
   }
-
   return kNullEntity;
 }
 
 std::set<Entity> NameSystem::SearchEntitiesByName(
     const string_view& name) const {
-  std::set<Entity> results;
-  for (const auto& entry : entity_to_name_) {
-    if (entry.second.find(name.data()) != std::string::npos) {
-      results.insert(entry.first);
+  std::vector<Entity> matches;
+  SearchEntitiesByName(name, &matches);
+  return std::set<Entity>(matches.begin(), matches.end());
+}
+
+void NameSystem::SearchEntitiesByName(const string_view& name,
+                                      std::vector<Entity>* results) const {
+  if (name.empty()) {
+    for (const auto& entry : entity_to_name_) {
+      results->push_back(entry.first);
     }
+    return;
   }
 
-  return results;
+  UpdateSearchIndex();
+
+  // Every suffix that starts with |name| is a match, and these are all adjacent
+  // in the sorted array.
+  const size_t first_result = results->size();
+  auto iter = std::lower_bound(
+      name_suffixes_.begin(), name_suffixes_.end(), name,
+      [](const std::pair<string_view, Entity>& suffix, const string_view& key) {
+        return suffix.first < key;
+      });
+  for (; iter != name_suffixes_.end(); ++iter) {
+    if (iter->first.substr(0, name.size()) != name) {
+      break;
+    }
+    results->push_back(iter->second);
+  }
+
+  // A name containing |name| more than once has several matching suffixes.
+  std::sort(results->begin() + first_result, results->end());
+  results->erase(std::unique(results->begin() + first_result, results->end()),
+                 results->end());
+}
+
+void NameSystem::UpdateSearchIndex() const {
+  if (!name_suffixes_dirty_) {
+    return;
+  }
+  name_suffixes_dirty_ = false;
+
+  name_suffixes_.clear();
+  for (const auto& entry : entity_to_name_) {
+    const string_view name(entry.second);
+    for (size_t i = 0; i < name.size(); ++i) {
+      name_suffixes_.emplace_back(name.substr(i), entry.first);
+    }
+  }
+  std::sort(name_suffixes_.begin(), name_suffixes_.end());
 }
 
 }  // namespace lull
@@ -19,7 +19,10 @@ limitations under the License.
 
 #include <set>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "lullaby/events/entity_events.h"
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/systems/transform/transform_system.h"
@@ -29,6 +32,12 @@ limitations under the License.
 namespace lull {
 
 // Associates a name with an entity.
+//
+// Names are indexed by hash, so FindEntity is a single lookup even when
+// duplicate names are allowed.  If a Dispatcher is available, the results of
+// FindDescendant are also cached per root until a name or the hierarchy
+// changes.  Substring searches are served from a lazily built, sorted array of
+// every name suffix.
 class NameSystem : public System {
  public:
   // If |allow_duplicate_names| is true, multiple entities are allowed to be
@@ -56,10 +65,8 @@ class NameSystem : public System {
   // Finds the entity associated with |name|. Returns kNullEntity if no entity
   // is found.
   // If |allow_duplicate_names| is true and more than one entity with the name
-  // is present, which of those entities will be returned is not well defined.
-  // The use of this method is discouraged when |allow_duplicate_names| is true
-  // since it involves a linear search across all entities. Use |FindDescendant|
-  // instead.
+  // is present, which of those entities will be returned is not well defined,
+  // so prefer |FindDescendant| in that case.
   Entity FindEntity(const std::string& name) const;
 
   // Finds the entity associated with |name| within the descendants of |root|,
@@ -68,18 +75,48 @@ class NameSystem : public System {
   // is present, which of those entities will be returned is not well defined.
   Entity FindDescendant(Entity root, const std::string& name) const;
 
-  // SLOW: Should not be called every frame.
-  // Searches all entities for the set of entities with names that
-  // contain the given name substring parameter.
+  // Searches all entities for the set of entities with names that contain the
+  // given name substring parameter.  The first search after names change
+  // rebuilds the search index, so avoid interleaving many SetName calls with
+  // searches.
   std::set<Entity> SearchEntitiesByName(const string_view& name) const;
 
+  // Same as above, but appends the matching entities to |results| in an
+  // unspecified order instead of allocating a set.
+  void SearchEntitiesByName(const string_view& name,
+                            std::vector<Entity>* results) const;
+
  private:
+  // Adds or removes |entity| from the list of entities named |hash|.
+  void AddToIndex(Entity entity, HashValue hash);
+  void RemoveFromIndex(Entity entity, HashValue hash);
+
+  // Clears all the cached lookups after a name or the hierarchy changes.
+  void InvalidateCaches();
+
+  // Rebuilds |name_suffixes_| if any names have changed since it was built.
+  void UpdateSearchIndex() const;
+
+  void OnParentChanged(const ParentChangedImmediateEvent& event);
+
   std::unordered_map<Entity, std::string> entity_to_name_;
   std::unordered_map<Entity, HashValue> entity_to_hash_;
   // Only used when |allow_duplicate_names| is false.
   std::unordered_map<HashValue, Entity> hash_to_entity_;
+  // Only used when |allow_duplicate_names| is true.
+  std::unordered_map<HashValue, std::vector<Entity>> hash_to_entities_;
   bool allow_duplicate_names_;
 
+  // Results of FindDescendant keyed by the root entity and name hash.  Only
+  // used if a Dispatcher is available to report hierarchy changes.
+  mutable std::unordered_map<uint64_t, Entity> descendant_cache_;
+  bool cache_descendants_ = false;
+
+  // Every suffix of every name along with its entity, sorted by suffix, so that
+  // the entities whose names contain a substring form a contiguous range.
+  mutable std::vector<std::pair<string_view, Entity>> name_suffixes_;
+  mutable bool name_suffixes_dirty_ = true;
+
   Entity FindDescendantWithDuplicateNames(
       TransformSystem* transform_system, Entity root, HashValue hash) const;
 };
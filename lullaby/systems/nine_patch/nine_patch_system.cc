@@ -16,11 +16,17 @@ limitations under the License.
 
 #include "lullaby/systems/nine_patch/nine_patch_system.h"
 
+#include <cstring>
+
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/render/mesh_data.h"
+#include "lullaby/modules/render/mesh_util.h"
 #include "lullaby/contrib/layout/layout_box_system.h"
+#include "lullaby/systems/render/mesh_factory.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/data_container_pool.h"
+#include "lullaby/util/hash.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/generated/nine_patch_def_generated.h"
 #include "mathfu/glsl_mappings.h"
@@ -29,8 +35,43 @@ namespace lull {
 
 constexpr HashValue kNinePatchDefHash = ConstHash("NinePatchDef");
 
+namespace {
+
+// Folds the bit pattern of a 32-bit field into |hash|.  The string Hash()
+// functions stop at the first zero byte, so they cannot be used here.
+template <typename T>
+HashValue HashCombineValue(HashValue hash, const T& value) {
+  static_assert(sizeof(T) == sizeof(HashValue), "Expected a 32-bit field.");
+  HashValue bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return HashCombine(hash, bits);
+}
+
+HashValue HashNinePatch(const NinePatch& nine_patch) {
+  HashValue key = ConstHash("NinePatch");
+  key = HashCombineValue(key, nine_patch.size.x);
+  key = HashCombineValue(key, nine_patch.size.y);
+  key = HashCombineValue(key, nine_patch.left_slice);
+  key = HashCombineValue(key, nine_patch.right_slice);
+  key = HashCombineValue(key, nine_patch.bottom_slice);
+  key = HashCombineValue(key, nine_patch.top_slice);
+  key = HashCombineValue(key, nine_patch.original_size.x);
+  key = HashCombineValue(key, nine_patch.original_size.y);
+  key = HashCombineValue(key, nine_patch.subdivisions.x);
+  key = HashCombineValue(key, nine_patch.subdivisions.y);
+  key = HashCombineValue(key, nine_patch.texture_alt_min.x);
+  key = HashCombineValue(key, nine_patch.texture_alt_min.y);
+  key = HashCombineValue(key, nine_patch.texture_alt_max.x);
+  key = HashCombineValue(key, nine_patch.texture_alt_max.y);
+  return key;
+}
+
+}  // namespace
+
 NinePatchSystem::NinePatchSystem(Registry* registry)
-    : System(registry), nine_patches_(16) {
+    : System(registry),
+      nine_patches_(16),
+      meshes_(ResourceManager<Mesh>::kWeakCachingOnly) {
   RegisterDef<NinePatchDefT>(this);
   RegisterDependency<RenderSystem>(this);
   RegisterDependency<Dispatcher>(this);
@@ -81,7 +122,10 @@ void NinePatchSystem::PostCreateInit(Entity entity, DefType type,
   UpdateNinePatchMesh(entity, kNullEntity, &iter->second);
 }
 
-void NinePatchSystem::Destroy(Entity entity) { nine_patches_.erase(entity); }
+void NinePatchSystem::Destroy(Entity entity) {
+  nine_patches_.erase(entity);
+  ReleaseMeshKey(entity);
+}
 
 void NinePatchSystem::SetSize(Entity entity, const mathfu::vec2& size) {
   auto iter = nine_patches_.find(entity);
@@ -127,12 +171,39 @@ void NinePatchSystem::UpdateNinePatchMesh(Entity entity, Entity source,
 
   auto nine_patch_mesh_fn = [&nine_patch](lull::MeshData* mesh) {
     GenerateNinePatchMesh(*nine_patch, mesh);
+    OptimizeMesh(mesh);
   };
 
-  render_system->UpdateDynamicMesh(
-      entity, lull::MeshData::PrimitiveType::kTriangles,
-      lull::VertexPTT::kFormat, nine_patch->GetVertexCount(),
-      nine_patch->GetIndexCount(), nine_patch_mesh_fn);
+  auto* mesh_factory = registry_->Get<MeshFactory>();
+  if (mesh_factory) {
+    const HashValue key = HashNinePatch(*nine_patch);
+    auto iter = mesh_keys_.find(entity);
+    if (iter == mesh_keys_.end() || iter->second != key) {
+      // Generate the mesh only if no other entity is already using it.
+      const MeshPtr mesh = meshes_.Create(key, [&]() {
+        // The mesh data is only needed until the mesh is created, so use pooled
+        // buffers rather than allocating new ones for every nine-patch change.
+        DataContainer vertex_data = DataContainerPool::Allocate(
+            nine_patch->GetVertexCount() * VertexPTT::kFormat.GetVertexSize());
+        DataContainer index_data = DataContainerPool::Allocate(
+            nine_patch->GetIndexCount() *
+            MeshData::GetIndexSize(MeshData::kIndexU16));
+        MeshData data(MeshData::PrimitiveType::kTriangles, VertexPTT::kFormat,
+                      std::move(vertex_data), MeshData::kIndexU16,
+                      std::move(index_data));
+        nine_patch_mesh_fn(&data);
+        return mesh_factory->CreateMesh(std::move(data));
+      });
+      render_system->SetMesh(entity, mesh);
+      ReleaseMeshKey(entity);
+      mesh_keys_[entity] = key;
+    }
+  } else {
+    render_system->UpdateDynamicMesh(
+        entity, lull::MeshData::PrimitiveType::kTriangles,
+        lull::VertexPTT::kFormat, nine_patch->GetVertexCount(),
+        nine_patch->GetIndexCount(), nine_patch_mesh_fn);
+  }
 
   auto *layout_box_system = registry_->Get<LayoutBoxSystem>();
   if (layout_box_system) {
@@ -173,4 +244,18 @@ void NinePatchSystem::OnDesiredSizeChanged(
   }
 }
 
+void NinePatchSystem::ReleaseMeshKey(Entity entity) {
+  auto iter = mesh_keys_.find(entity);
+  if (iter == mesh_keys_.end()) {
+    return;
+  }
+  const HashValue key = iter->second;
+  mesh_keys_.erase(iter);
+  // The cache only holds weak references, so drop the entry once the last
+  // entity using the mesh has moved on.
+  if (!meshes_.Find(key)) {
+    meshes_.Erase(key);
+  }
+}
+
 }  // namespace lull
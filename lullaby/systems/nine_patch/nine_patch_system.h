@@ -20,14 +20,17 @@ limitations under the License.
 #include "lullaby/events/layout_events.h"
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/modules/render/nine_patch.h"
+#include "lullaby/systems/render/mesh.h"
 #include "lullaby/util/optional.h"
+#include "lullaby/util/resource_manager.h"
 
 namespace lull {
 
 // The NinePatchSystem provides a component for rendering nine patches. Given
 // the dimensions of a quad to fill, the original (unaltered) size of the nine
 // patch, and the locations of the slices, a mesh is generated with appropriate
-// vertex locations and texture coordinates.
+// vertex locations and texture coordinates.  Meshes are shared between all
+// entities whose nine patches currently have identical parameters.
 class NinePatchSystem : public System {
  public:
   explicit NinePatchSystem(Registry* registry);
@@ -68,7 +71,13 @@ class NinePatchSystem : public System {
   // Recompute nine_patch based on new desired_size.
   void OnDesiredSizeChanged(const DesiredSizeChangedEvent& event);
 
+  // Stops tracking the mesh used by |entity|, removing it from the cache if no
+  // other entity is still using it.
+  void ReleaseMeshKey(Entity entity);
+
   std::unordered_map<Entity, NinePatch> nine_patches_;
+  std::unordered_map<Entity, HashValue> mesh_keys_;
+  ResourceManager<Mesh> meshes_;
 };
 
 }  // namespace lull
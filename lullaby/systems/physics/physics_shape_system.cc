@@ -17,6 +17,7 @@ limitations under the License.
 #include "lullaby/systems/physics/physics_shape_system.h"
 
 #include "lullaby/events/render_events.h"
+#include "lullaby/modules/ecs/system_profiler.h"
 #include "lullaby/modules/render/vertex.h"
 #include "lullaby/systems/collision/collision_system.h"
 #include "lullaby/systems/model_asset/model_asset_system.h"
@@ -171,6 +172,14 @@ void PhysicsShapeSystem::Destroy(Entity entity) {
   mesh_colliders_.Destroy(entity);
 }
 
+size_t PhysicsShapeSystem::GetNumComponents() const {
+  return mesh_colliders_.Size();
+}
+
+size_t PhysicsShapeSystem::GetComponentMemoryUsage() const {
+  return mesh_colliders_.GetMemoryUsage();
+}
+
 bool PhysicsShapeSystem::FinishLoadingEntity(Entity entity) {
   MeshCollider* collider = mesh_colliders_.Get(entity);
   if (!collider) {
@@ -199,6 +208,7 @@ bool PhysicsShapeSystem::FinishLoadingEntity(Entity entity) {
 }
 
 void PhysicsShapeSystem::AdvanceFrame() {
+  SystemProfiler::ScopedSample sample(registry_, this);
   for (int i = 0; i < pending_entities_.size();) {
     if (FinishLoadingEntity(pending_entities_[i])) {
       pending_entities_[i] = pending_entities_.back();
@@ -42,6 +42,9 @@ class PhysicsShapeSystem : public System, public CollisionProvider {
   void Initialize() override;
   void Create(Entity entity, HashValue type, const Def* def) override;
   void Destroy(Entity entity) override;
+
+  size_t GetNumComponents() const override;
+  size_t GetComponentMemoryUsage() const override;
   void AdvanceFrame();
 
   // Returns whether the ray between from and to hits an entity. If true, also
@@ -17,9 +17,11 @@ limitations under the License.
 #include "lullaby/systems/physics/physics_system.h"
 
 #include <algorithm>
+#include <cmath>
 
 #include "lullaby/events/entity_events.h"
 #include "lullaby/events/physics_events.h"
+#include "lullaby/modules/ecs/system_profiler.h"
 #include "lullaby/modules/flatbuffers/mathfu_fb_conversions.h"
 #include "lullaby/systems/dispatcher/event.h"
 #include "lullaby/systems/physics/bullet_utils.h"
@@ -35,6 +37,18 @@ namespace lull {
 
 const HashValue kRigidBodyDef = ConstHash("RigidBodyDef");
 
+namespace {
+
+// Returns true if |a| and |b| are the same to within the precision lost when
+// converting between simulation transforms and TransformSystem matrices.
+bool AreTransformsEqual(const btTransform& a, const btTransform& b) {
+  const float kEpsilon = 1e-5f;
+  return (a.getOrigin() - b.getOrigin()).length2() < kEpsilon * kEpsilon &&
+         std::abs(a.getRotation().dot(b.getRotation())) > 1.f - kEpsilon;
+}
+
+}  // namespace
+
 PhysicsSystem::PhysicsSystem(Registry* registry)
     : PhysicsSystem(registry, InitParams()) {}
 
@@ -69,6 +83,7 @@ PhysicsSystem::~PhysicsSystem() {
   }
   auto* transform_system = registry_->Get<TransformSystem>();
   if (transform_system && transform_flag_ != TransformSystem::kInvalidFlag) {
+    transform_system->UntrackChanges(transform_flag_);
     transform_system->ReleaseFlag(transform_flag_);
   }
 }
@@ -77,6 +92,7 @@ PhysicsSystem::~PhysicsSystem() {
 void PhysicsSystem::Initialize() {
   transform_system_ = registry_->Get<TransformSystem>();
   transform_flag_ = transform_system_->RequestFlag();
+  transform_system_->TrackChanges(transform_flag_);
 
   auto* dispatcher = registry_->Get<Dispatcher>();
   dispatcher->Connect(this, [this](const OnDisabledEvent& event) {
@@ -113,6 +129,14 @@ void PhysicsSystem::Destroy(Entity entity) {
   rigid_bodies_.Destroy(entity);
 }
 
+size_t PhysicsSystem::GetNumComponents() const {
+  return rigid_bodies_.Size();
+}
+
+size_t PhysicsSystem::GetComponentMemoryUsage() const {
+  return rigid_bodies_.GetMemoryUsage();
+}
+
 void PhysicsSystem::InitRigidBody(Entity entity, const RigidBodyDef* data) {
   auto* body = rigid_bodies_.Get(entity);
   if (!body) {
@@ -179,6 +203,7 @@ void PhysicsSystem::InitRigidBody(Entity entity, const RigidBodyDef* data) {
   }
 
   // Create the motion state and rigid body.
+  body->synced_transform = xform;
   body->bt_motion_state = MakeUnique<MotionState>(xform, this, entity);
 
   btRigidBody::btRigidBodyConstructionInfo construction_info(
@@ -412,19 +437,42 @@ void PhysicsSystem::UpdateSimulationTransform(
   transform.setOrigin(BtVectorFromMathfu(sqt.translation));
   transform.setRotation(BtQuatFromMathfu(sqt.rotation));
 
+  // Apply the Entity scale on top of any local shape scaling. If the overall
+  // shape scale of a dynamic body changes, reset inertial properties as well.
+  const bool rescaled = body->shape->ApplyEntityScale(sqt.scale);
+  if (rescaled && body->type == RigidBodyType::RigidBodyType_Dynamic) {
+    SetupBtInertialProperties(body);
+  }
+
+  // Skip the changes that came from the simulation itself (or that did not
+  // move the body), so that bodies are only woken up when moved by the user.
+  if (!rescaled && AreTransformsEqual(transform, body->synced_transform)) {
+    return;
+  }
+  body->synced_transform = transform;
+
   if (UsesKinematicMotionState(body)) {
     body->bt_motion_state->SetKinematicTransform(transform);
   } else {
     body->bt_body->proceedToTransform(transform);
   }
   body->bt_body->activate(true);
+}
 
-  // Apply the Entity scale on top of any local shape scaling. If the overall
-  // shape scale of a dynamic body changes, reset inertial properties as well.
-  if (body->shape->ApplyEntityScale(sqt.scale)
-      && body->type == RigidBodyType::RigidBodyType_Dynamic) {
-    SetupBtInertialProperties(body);
+void PhysicsSystem::UpdateSimulationTransforms() {
+  transform_system_->TakeUniqueChangedEntities(transform_flag_,
+                                               &changed_entities_);
+  for (const Entity entity : changed_entities_) {
+    if (!IsPhysicsEnabled(entity) || !transform_system_->IsEnabled(entity)) {
+      continue;
+    }
+    const mathfu::mat4* world_from_entity_mat =
+        transform_system_->GetWorldFromEntityMatrix(entity);
+    if (world_from_entity_mat) {
+      UpdateSimulationTransform(entity, *world_from_entity_mat);
+    }
   }
+  changed_entities_.clear();
 }
 
 void PhysicsSystem::MarkForUpdate(Entity entity) {
@@ -439,6 +487,7 @@ void PhysicsSystem::UpdateLullabyTransform(Entity entity) {
 
   // Un-apply any local offset transforms.
   const btTransform& world_transform = body->bt_body->getWorldTransform();
+  body->synced_transform = world_transform;
   Sqt sqt(MathfuVectorFromBt(world_transform.getOrigin()),
           MathfuQuatFromBt(world_transform.getRotation()),
           transform_system_->GetLocalScale(entity));
@@ -448,19 +497,16 @@ void PhysicsSystem::UpdateLullabyTransform(Entity entity) {
 }
 
 void PhysicsSystem::AdvanceFrame(Clock::duration delta_time) {
+  SystemProfiler::ScopedSample sample(registry_, this);
   LULLABY_CPU_TRACE_CALL();
 
   // Ensure that all Bullet transforms match their Lullaby counterparts.
-  transform_system_->ForEach(
-      transform_flag_,
-      [this](Entity e, const mathfu::mat4& world_from_entity_mat,
-             const Aabb& box) {
-        UpdateSimulationTransform(e, world_from_entity_mat);
-      });
+  UpdateSimulationTransforms();
 
   // During one AdvanceFrame() call, do at most a set number of 1/60 second
-  // updates. Bullet will update the MotionStates of every Dynamic Entity that
-  // has a transform update. These Entities will be marked for synchronization.
+  // updates. Bullet will update the MotionStates of every awake Dynamic Entity
+  // that has a transform update, skipping sleeping islands. These Entities will
+  // be marked for synchronization.
   const float delta_time_sec = SecondsFromDuration(delta_time);
   bt_world_->stepSimulation(delta_time_sec, max_substeps_, timestep_);
 
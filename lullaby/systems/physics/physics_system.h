@@ -55,6 +55,9 @@ class PhysicsSystem : public System {
   void PostCreateInit(Entity entity, HashValue type, const Def* def) override;
   void Destroy(Entity entity) override;
 
+  size_t GetNumComponents() const override;
+  size_t GetComponentMemoryUsage() const override;
+
   /// Update the physics simulation by |delta_time| seconds.
   void AdvanceFrame(Clock::duration delta_time);
 
@@ -110,6 +113,9 @@ class PhysicsSystem : public System {
     std::unique_ptr<MotionState> bt_motion_state;
     std::unique_ptr<CollisionShape> shape;
 
+    // The simulation transform as of the last sync in either direction, used
+    // to ignore TransformSystem changes that the PhysicsSystem itself made.
+    btTransform synced_transform = btTransform::getIdentity();
     mathfu::vec3 center_of_mass_translation = mathfu::kZeros3f;
     RigidBodyType type = RigidBodyType::RigidBodyType_Dynamic;
     ColliderType collider_type = ColliderType::ColliderType_Standard;
@@ -140,7 +146,10 @@ class PhysicsSystem : public System {
   static void InternalTickCallback(btDynamicsWorld* world, btScalar time_step);
   void PostSimulationTick();
 
-  // For Lullaby -> simulation transform syncs.
+  // For Lullaby -> simulation transform syncs. Only Entities reported as
+  // changed by the TransformSystem are synced, so sleeping islands are never
+  // woken up by the sync itself.
+  void UpdateSimulationTransforms();
   void UpdateSimulationTransform(
       Entity entity, const mathfu::mat4& world_from_entity_mat);
 
@@ -165,6 +174,8 @@ class PhysicsSystem : public System {
   ComponentPool<RigidBody> rigid_bodies_;
   TransformSystem* transform_system_;
   TransformSystem::TransformFlags transform_flag_;
+  // The Entities whose transforms changed since the last simulation update.
+  std::vector<Entity> changed_entities_;
   // The list of Entities that changed during the most recent set of simulation
   // updates.
   std::vector<Entity> updated_entities_;
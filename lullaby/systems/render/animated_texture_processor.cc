@@ -16,14 +16,19 @@ limitations under the License.
 
 #include "lullaby/systems/render/animated_texture_processor.h"
 
+#include <algorithm>
+
 #include "lullaby/generated/flatbuffers/material_def_generated.h"
 #include "lullaby/systems/render/texture_factory.h"
 
 namespace lull {
 
-AnimatedTextureProcessor::AnimatedTextureProcessor(Registry* registry)
+AnimatedTextureProcessor::AnimatedTextureProcessor(Registry* registry,
+                                                   size_t num_worker_threads,
+                                                   size_t num_lookahead_frames)
     : registry_(registry),
-      decode_queue_(1 /* worker threads */) {}
+      num_lookahead_frames_(std::max<size_t>(num_lookahead_frames, 1)),
+      decode_queue_(std::max<size_t>(num_worker_threads, 1)) {}
 
 void AnimatedTextureProcessor::Animate(const TexturePtr& texture,
                                        AnimatedImagePtr animated_image) {
@@ -35,56 +40,139 @@ void AnimatedTextureProcessor::Animate(const TexturePtr& texture,
   auto anim_texture = std::make_shared<AnimatedTexture>();
   anim_texture->texture = texture;
   anim_texture->animated_image = std::move(animated_image);
-  anim_texture->latest_frame_show_time = time_line_;
+  anim_texture->next_show_time = time_line_;
+  anim_texture->frames.resize(num_lookahead_frames_);
 
-  decode_queue_.Enqueue(anim_texture,
-                        [&](AnimatedTexturePtr* req) { DecodeFrame(*req); });
+  textures_.push_back(anim_texture);
+  RequestDecode(anim_texture);
 }
 
 void AnimatedTextureProcessor::OnAdvanceFrame(Clock::duration delta_time) {
   time_line_ += delta_time;
 
-  // Dequeue any completed tasks from the decoding thread and push into
-  // ready_to_upload_ priority queue.
+  // Dequeue any completed tasks from the decoding threads.
   AnimatedTexturePtr anim_texture;
   while (decode_queue_.Dequeue(&anim_texture)) {
-    ready_to_upload_.push(anim_texture);
+    anim_texture->decoding = false;
   }
 
-  // Pop off ready frames whose timestamp has passed
-  auto* texture_factory = registry_->Get<TextureFactory>();
-  while (!ready_to_upload_.empty()) {
-    // If next ready frame is in the future, we're done.
-    anim_texture = ready_to_upload_.top();
-    if (anim_texture == nullptr ||
-        anim_texture->latest_frame_show_time > time_line_) {
-      break;
+  // Upload any frames whose timestamp has passed and keep the rings filled.
+  // Textures that are no longer used are dropped once they aren't decoding.
+  auto iter = textures_.begin();
+  while (iter != textures_.end()) {
+    AnimatedTexture* anim_texture = iter->get();
+    if (!UploadFrame(anim_texture)) {
+      if (!anim_texture->decoding) {
+        iter = textures_.erase(iter);
+        continue;
+      }
+    } else {
+      RequestDecode(*iter);
     }
-    ready_to_upload_.pop();
+    ++iter;
+  }
+}
+
+bool AnimatedTextureProcessor::UploadFrame(AnimatedTexture* anim_texture) {
+  // Texture is no longer being used.
+  auto texture = anim_texture->texture.lock();
+  if (texture == nullptr) {
+    return false;
+  }
 
-    // Texture is no longer being used.
-    auto texture = anim_texture->texture.lock();
-    if (texture == nullptr) {
-      continue;
+  // Find the newest frame that is due, skipping frames that were missed.
+  size_t index = 0;
+  size_t num_due = 0;
+  {
+    std::lock_guard<std::mutex> lock(anim_texture->mutex);
+    const size_t num_slots = anim_texture->frames.size();
+    while (num_due < anim_texture->num_frames) {
+      const size_t slot = (anim_texture->first_frame + num_due) % num_slots;
+      if (anim_texture->frames[slot].show_time > time_line_) {
+        break;
+      }
+      index = slot;
+      ++num_due;
     }
-    // Upload texture data to GL.
-    // TODO: Investigate a more efficient means of updating the
-    // texture. For example, on Android, we could use an external texture and
-    // decode directly to the GL texture memory.
-    texture_factory->UpdateTexture(TexturePtr(texture),
-                                   std::move(anim_texture->latest_frame));
-
-    // Push onto decoding thread for next update.
-    decode_queue_.Enqueue(anim_texture, [&](AnimatedTexturePtr* anim_texture) {
-      DecodeFrame(*anim_texture);
-    });
   }
+  if (num_due == 0) {
+    return true;
+  }
+
+  // The worker thread never writes to frames that are ready, so the frame can
+  // be read without holding the lock. The ImageData only wraps the frame's
+  // buffer so that the buffer can be reused for a later frame.
+  // TODO: Investigate a more efficient means of updating the
+  // texture. For example, on Android, we could use an external texture and
+  // decode directly to the GL texture memory.
+  const DecodedFrame& frame = anim_texture->frames[index];
+  ImageData image(frame.format, frame.size,
+                  DataContainer::WrapDataAsReadOnly(frame.pixels.data(),
+                                                    frame.pixels.size()));
+  auto* texture_factory = registry_->Get<TextureFactory>();
+  texture_factory->UpdateTexture(texture, std::move(image));
+
+  std::lock_guard<std::mutex> lock(anim_texture->mutex);
+  anim_texture->first_frame =
+      (anim_texture->first_frame + num_due) % anim_texture->frames.size();
+  anim_texture->num_frames -= num_due;
+  return true;
+}
+
+void AnimatedTextureProcessor::RequestDecode(
+    const AnimatedTexturePtr& anim_texture) {
+  if (anim_texture->decoding) {
+    return;
+  }
+
+  size_t num_frames = 0;
+  {
+    std::lock_guard<std::mutex> lock(anim_texture->mutex);
+    num_frames = anim_texture->num_frames;
+  }
+  if (num_frames >= anim_texture->frames.size()) {
+    return;
+  }
+
+  // Textures with fewer frames ready are decoded first.
+  const int priority = static_cast<int>(anim_texture->frames.size() -
+                                        num_frames);
+  anim_texture->decoding = true;
+  decode_queue_.Enqueue(
+      anim_texture,
+      [this](AnimatedTexturePtr* anim_texture) {
+        DecodeFrames(anim_texture->get());
+      },
+      priority);
 }
 
-void AnimatedTextureProcessor::DecodeFrame(AnimatedTexturePtr anim_texture) {
-  anim_texture->latest_frame = anim_texture->animated_image->DecodeNextFrame();
-  anim_texture->latest_frame_show_time +=
-      anim_texture->animated_image->GetCurrentFrameDuration();
+void AnimatedTextureProcessor::DecodeFrames(AnimatedTexture* anim_texture) {
+  const size_t num_slots = anim_texture->frames.size();
+  while (true) {
+    size_t slot = 0;
+    {
+      std::lock_guard<std::mutex> lock(anim_texture->mutex);
+      if (anim_texture->num_frames >= num_slots) {
+        return;
+      }
+      slot = (anim_texture->first_frame + anim_texture->num_frames) % num_slots;
+    }
+
+    // The decoder owns the returned pixels and overwrites them on the next
+    // call, so copy them into the slot's buffer.
+    const ImageData image = anim_texture->animated_image->DecodeNextFrame();
+    DecodedFrame& frame = anim_texture->frames[slot];
+    frame.pixels.assign(image.GetBytes(),
+                        image.GetBytes() + image.GetDataSize());
+    frame.format = image.GetFormat();
+    frame.size = image.GetSize();
+    frame.show_time = anim_texture->next_show_time;
+    anim_texture->next_show_time +=
+        anim_texture->animated_image->GetCurrentFrameDuration();
+
+    std::lock_guard<std::mutex> lock(anim_texture->mutex);
+    ++anim_texture->num_frames;
+  }
 }
 
 }  // namespace lull
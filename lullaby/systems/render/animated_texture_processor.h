@@ -18,9 +18,8 @@ limitations under the License.
 #define LULLABY_SYSTEMS_RENDER_ANIMATED_TEXTURE_PROCESSOR_H_
 
 #include <memory>
-#include <queue>
+#include <mutex>
 #include <string>
-#include <unordered_set>
 #include <vector>
 
 #include "lullaby/modules/render/image_decode.h"
@@ -33,9 +32,18 @@ namespace lull {
 
 // Manages decoding animated textures like WebP files and updating the
 // corresponding texture instance.
+//
+// Frames are decoded ahead of time on a pool of worker threads into a small
+// ring of reusable buffers per texture, so that several animated textures can
+// be decoded in parallel without allocating a new image for every frame.
 class AnimatedTextureProcessor {
  public:
-  explicit AnimatedTextureProcessor(Registry* registry);
+  static constexpr size_t kDefaultNumWorkerThreads = 2;
+  static constexpr size_t kDefaultNumLookaheadFrames = 3;
+
+  explicit AnimatedTextureProcessor(
+      Registry* registry, size_t num_worker_threads = kDefaultNumWorkerThreads,
+      size_t num_lookahead_frames = kDefaultNumLookaheadFrames);
   AnimatedTextureProcessor(const AnimatedTextureProcessor&) = delete;
   AnimatedTextureProcessor& operator=(const AnimatedTextureProcessor&) = delete;
 
@@ -45,43 +53,62 @@ class AnimatedTextureProcessor {
 
  private:
   using WeakTexturePtr = std::weak_ptr<Texture>;
+
+  // A decoded frame. The pixel buffer is owned by the frame and reused once
+  // the frame has been uploaded.
+  struct DecodedFrame {
+    std::vector<uint8_t> pixels;
+    ImageData::Format format = ImageData::kInvalid;
+    mathfu::vec2i size = mathfu::kZeros2i;
+    Clock::time_point show_time;
+  };
+
   struct AnimatedTexture {
-    std::string raw_data;
     WeakTexturePtr texture;
 
-    // Handle for interacting with the underlying image format decoder.
+    // Handle for interacting with the underlying image format decoder. Only
+    // accessed by the worker thread currently decoding this texture.
     AnimatedImagePtr animated_image;
 
-    // Decoded frame data
-    ImageData latest_frame;
-    Clock::time_point latest_frame_show_time;
+    // Time at which the next decoded frame should be shown. Only accessed by
+    // the worker thread currently decoding this texture.
+    Clock::time_point next_show_time;
+
+    // Ring of decoded frames waiting to be shown. |frames| is allocated once
+    // and the first |num_frames| entries starting at |first_frame| are ready.
+    // Guarded by |mutex|.
+    std::mutex mutex;
+    std::vector<DecodedFrame> frames;
+    size_t first_frame = 0;
+    size_t num_frames = 0;
+
+    // Whether a decode task for this texture is queued or running. Only
+    // accessed on the main thread.
+    bool decoding = false;
   };
   using AnimatedTexturePtr = std::shared_ptr<AnimatedTexture>;
 
-  // Used to sort animated textures in a priority queue by time to next frame.
-  // Those frames that should be shown sooner are at the front of the queue.
-  // Both inputs must not be null.
-  struct CompareAnimatedTexturePtr {
-    bool operator()(const AnimatedTexturePtr& a,
-                    const AnimatedTexturePtr& b) const {
-      return a->latest_frame_show_time > b->latest_frame_show_time;
-    }
-  };
+  // Called on background decoding thread. Decodes frames until the texture's
+  // ring is full.
+  void DecodeFrames(AnimatedTexture* anim_texture);
+
+  // Uploads the most recent frame of |anim_texture| whose show time has
+  // passed, dropping any older ones. Returns false if the texture is no longer
+  // in use.
+  bool UploadFrame(AnimatedTexture* anim_texture);
 
-  // Called on background decoding thread.
-  void DecodeFrame(AnimatedTexturePtr texture);
+  // Queues |anim_texture| for decoding if its ring has room.
+  void RequestDecode(const AnimatedTexturePtr& anim_texture);
 
   Registry* registry_;
   Clock::time_point time_line_;
+  size_t num_lookahead_frames_;
 
-  // Queue to process images on background decoding thread.
+  // Queue to process images on background decoding threads.
   AsyncProcessor<AnimatedTexturePtr> decode_queue_;
 
-  // Priority queue of textures with next frame ready, ordered by timestamp of
-  // when to display the next frame.
-  std::priority_queue<AnimatedTexturePtr, std::vector<AnimatedTexturePtr>,
-                      CompareAnimatedTexturePtr>
-      ready_to_upload_;
+  // All the textures being animated.
+  std::vector<AnimatedTexturePtr> textures_;
 };
 
 }  // namespace lull
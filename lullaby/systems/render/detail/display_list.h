@@ -17,10 +17,16 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_RENDER_DETAIL_DISPLAY_LIST_H_
 #define LULLABY_SYSTEMS_RENDER_DETAIL_DISPLAY_LIST_H_
 
+#include <string.h>
+#include <utility>
+#include <vector>
+
 #include "mathfu/constants.h"
 #include "mathfu/glsl_mappings.h"
 #include "lullaby/systems/render/detail/render_pool.h"
+#include "lullaby/systems/render/render_occlusion.h"
 #include "lullaby/systems/render/render_system.h"
+#include "lullaby/util/intersections.h"
 #include "lullaby/util/math.h"
 #include "lullaby/util/trace.h"
 
@@ -41,7 +47,9 @@ class DisplayList {
 
     Entity entity;
     const Component* component = nullptr;
-    mathfu::mat4 world_from_entity_matrix;
+    // Points to the matrix stored by the TransformSystem, so it is only valid
+    // until the transforms are next modified.
+    const mathfu::mat4* world_from_entity_matrix = nullptr;
     SortKey sort_key;
   };
 
@@ -51,11 +59,17 @@ class DisplayList {
   const std::vector<Entry>* GetContents() const { return &list_; }
 
   // Populates the list using |pool|.  |views| is used for camera-based sort
-  // modes.
+  // modes.  The list's buffers and the sorted order are reused by subsequent
+  // calls, so a DisplayList should be kept around and repopulated each frame.
   void Populate(const RenderPool<Component>& pool, const RenderView* views,
                 size_t num_views);
 
  private:
+  // Rasterizes the occluders into |occlusion|'s depth buffers for |views|,
+  // unless they were already built for the same views this frame.
+  void PrepareOcclusion(RenderOcclusion* occlusion, const RenderView* views,
+                        size_t num_views);
+
   void GetComponentsUnsorted(const RenderPool<Component>& pool);
   void GetComponentsWithSortOrder(const RenderPool<Component>& pool);
   void GetComponentsWithWorldSpaceZ(const RenderPool<Component>& pool);
@@ -71,16 +85,78 @@ class DisplayList {
   void SortDecreasingUnsigned();
   void SortIncreasingUnsigned();
 
+  // An entry's sort key (or one 32-bit word of it) and its index in
+  // |unsorted_|.
+  struct KeyIndex {
+    uint32_t key;
+    uint32_t index;
+  };
+
+  // Sorts |unsorted_| into |list_|.  The sort key of an entry is made up of
+  // |num_words| 32-bit words which are returned by |get_word| (word 0 being the
+  // least significant), and |less| compares two KeyIndex entries whose |key| is
+  // word 0.
+  template <typename GetWordFn, typename LessFn>
+  void SortEntries(int num_words, const GetWordFn& get_word,
+                   const LessFn& less);
+
+  // Insertion sorts |keys_| using |less|, giving up and returning false if
+  // more than |max_moves| entries need to be moved.
+  template <typename LessFn>
+  bool InsertionSortKeys(const LessFn& less, size_t max_moves);
+
+  // Stably sorts |keys_| by |key| using an 8-bit LSD radix sort.
+  void RadixSortKeys();
+
+  // Maps a float to an unsigned integer with the same ordering.
+  static uint32_t GetOrderedFloatBits(float value);
+
   static constexpr size_t kMaxViews = 2;
 
+  // The number of moves (in addition to 1/8th of the entries) that the
+  // insertion sort of the previous order may make before a full sort is used.
+  static constexpr size_t kMinInsertionSortMoves = 64;
+
   Registry* registry_;
   std::vector<Entry> list_;
+  // The entries in the order they were gathered from the TransformSystem.
+  std::vector<Entry> unsorted_;
+  // The sorted order of |unsorted_|, which is the starting point for sorting
+  // the next time the list is populated.
+  std::vector<KeyIndex> keys_;
+  std::vector<KeyIndex> scratch_keys_;
 };
 
+template <typename Component>
+void DisplayList<Component>::PrepareOcclusion(RenderOcclusion* occlusion,
+                                              const RenderView* views,
+                                              size_t num_views) {
+  LULLABY_CPU_TRACE_CALL();
+
+  mathfu::mat4 clip_from_world[kMaxViews];
+  for (size_t i = 0; i < num_views; ++i) {
+    clip_from_world[i] = views[i].clip_from_world_matrix;
+  }
+  if (!occlusion->BeginViews(clip_from_world, num_views)) {
+    return;
+  }
+
+  const auto* transform_system = registry_->Get<TransformSystem>();
+  for (Entity occluder : occlusion->GetOccluders()) {
+    const Aabb* box = transform_system->GetAabb(occluder);
+    const mathfu::mat4* world_from_entity =
+        transform_system->GetWorldFromEntityMatrix(occluder);
+    if (box && world_from_entity && transform_system->IsEnabled(occluder)) {
+      occlusion->AddOccluder(*box, *world_from_entity);
+    }
+  }
+  occlusion->EndViews();
+}
+
 template <typename Component>
 void DisplayList<Component>::GetComponentsUnsorted(
     const RenderPool<Component>& pool) {
-  for (auto& info : list_) {
+  for (auto& info : unsorted_) {
     info.component = pool.GetComponent(info.entity);
     if (!info.component) {
       LOG(DFATAL) << "Failed to get component.";
@@ -91,7 +167,7 @@ void DisplayList<Component>::GetComponentsUnsorted(
 template <typename Component>
 void DisplayList<Component>::GetComponentsWithSortOrder(
     const RenderPool<Component>& pool) {
-  for (auto& info : list_) {
+  for (auto& info : unsorted_) {
     info.component = pool.GetComponent(info.entity);
     if (!info.component) {
       LOG(DFATAL) << "Failed to get component.";
@@ -118,14 +194,14 @@ void DisplayList<Component>::GetComponentsWithAverageSpaceZ(
   avg_pos /= static_cast<float>(num_views);
   avg_z.Normalize();
 
-  for (auto& info : list_) {
+  for (auto& info : unsorted_) {
     info.component = pool.GetComponent(info.entity);
     if (!info.component) {
       LOG(DFATAL) << "Failed to get component.";
       return;
     }
     const mathfu::vec3 world_pos =
-        info.world_from_entity_matrix.TranslationVector3D();
+        info.world_from_entity_matrix->TranslationVector3D();
     info.sort_key.f32 = mathfu::vec3::DotProduct(world_pos - avg_pos, avg_z);
   }
 }
@@ -133,27 +209,27 @@ void DisplayList<Component>::GetComponentsWithAverageSpaceZ(
 template <typename Component>
 void DisplayList<Component>::GetComponentsWithWorldSpaceZ(
     const RenderPool<Component>& pool) {
-  for (auto& info : list_) {
+  for (auto& info : unsorted_) {
     info.component = pool.GetComponent(info.entity);
     if (!info.component) {
       LOG(DFATAL) << "Failed to get component.";
       return;
     }
-    info.sort_key.f32 = info.world_from_entity_matrix.TranslationVector3D().z;
+    info.sort_key.f32 = info.world_from_entity_matrix->TranslationVector3D().z;
   }
 }
 
 template <typename Component>
 void DisplayList<Component>::GetComponentsWithWorldSpaceVector(
     const RenderPool<Component>& pool, const mathfu::vec3& vector) {
-  for (auto& info : list_) {
+  for (auto& info : unsorted_) {
     info.component = pool.GetComponent(info.entity);
     if (!info.component) {
       LOG(DFATAL) << "Failed to get component.";
       return;
     }
     const mathfu::vec3 pos =
-        info.world_from_entity_matrix.TranslationVector3D();
+        info.world_from_entity_matrix->TranslationVector3D();
     info.sort_key.f32 = mathfu::vec3::DotProduct(pos, vector);
   }
 }
@@ -161,44 +237,177 @@ void DisplayList<Component>::GetComponentsWithWorldSpaceVector(
 template <typename Component>
 void DisplayList<Component>::GetComponentsWithWorldSpaceZMinusAbsX(
     const RenderPool<Component>& pool) {
-  for (auto& info : list_) {
+  for (auto& info : unsorted_) {
     info.component = pool.GetComponent(info.entity);
     if (!info.component) {
       LOG(DFATAL) << "Failed to get component.";
       return;
     }
     const mathfu::vec3 world_pos =
-        info.world_from_entity_matrix.TranslationVector3D();
+        info.world_from_entity_matrix->TranslationVector3D();
     info.sort_key.f32 = world_pos.z - std::abs(world_pos.x);
   }
 }
 
+template <typename Component>
+uint32_t DisplayList<Component>::GetOrderedFloatBits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  // Flip all the bits of negative numbers (so that larger magnitudes come
+  // first) and only the sign bit of positive numbers (so that they come after
+  // the negative numbers).
+  return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
 template <typename Component>
 void DisplayList<Component>::SortDecreasingFloat() {
-  std::sort(list_.begin(), list_.end(), [](const Entry& a, const Entry& b) {
-    return a.sort_key.f32 > b.sort_key.f32;
-  });
+  SortEntries(1,
+              [](const Entry& entry, int /* word */) {
+                return ~GetOrderedFloatBits(entry.sort_key.f32);
+              },
+              [](const KeyIndex& a, const KeyIndex& b) {
+                return a.key < b.key;
+              });
 }
 
 template <typename Component>
 void DisplayList<Component>::SortIncreasingFloat() {
-  std::sort(list_.begin(), list_.end(), [](const Entry& a, const Entry& b) {
-    return a.sort_key.f32 < b.sort_key.f32;
-  });
+  SortEntries(1,
+              [](const Entry& entry, int /* word */) {
+                return GetOrderedFloatBits(entry.sort_key.f32);
+              },
+              [](const KeyIndex& a, const KeyIndex& b) {
+                return a.key < b.key;
+              });
 }
 
 template <typename Component>
 void DisplayList<Component>::SortDecreasingUnsigned() {
-  std::sort(list_.begin(), list_.end(), [](const Entry& a, const Entry& b) {
-    return a.sort_key.sort_order > b.sort_key.sort_order;
-  });
+  SortEntries(RenderSortOrder::kNumWords,
+              [](const Entry& entry, int word) {
+                return ~entry.sort_key.sort_order.GetWord(word);
+              },
+              [this](const KeyIndex& a, const KeyIndex& b) {
+                return unsorted_[a.index].sort_key.sort_order >
+                       unsorted_[b.index].sort_key.sort_order;
+              });
 }
 
 template <typename Component>
 void DisplayList<Component>::SortIncreasingUnsigned() {
-  std::sort(list_.begin(), list_.end(), [](const Entry& a, const Entry& b) {
-    return a.sort_key.sort_order < b.sort_key.sort_order;
-  });
+  SortEntries(RenderSortOrder::kNumWords,
+              [](const Entry& entry, int word) {
+                return entry.sort_key.sort_order.GetWord(word);
+              },
+              [this](const KeyIndex& a, const KeyIndex& b) {
+                return unsorted_[a.index].sort_key.sort_order <
+                       unsorted_[b.index].sort_key.sort_order;
+              });
+}
+
+template <typename Component>
+template <typename GetWordFn, typename LessFn>
+void DisplayList<Component>::SortEntries(int num_words,
+                                         const GetWordFn& get_word,
+                                         const LessFn& less) {
+  const size_t count = unsorted_.size();
+
+  // Entities usually move very little between frames, so start from the
+  // previous order and fix it up with an insertion sort, falling back to a
+  // full radix sort if too much has changed.
+  bool sorted = false;
+  if (keys_.size() == count) {
+    for (KeyIndex& key : keys_) {
+      key.key = get_word(unsorted_[key.index], 0);
+    }
+    sorted = InsertionSortKeys(less, count / 8 + kMinInsertionSortMoves);
+  }
+
+  if (!sorted) {
+    keys_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      keys_[i].key = get_word(unsorted_[i], 0);
+      keys_[i].index = static_cast<uint32_t>(i);
+    }
+    RadixSortKeys();
+    // Sorting stably by each word in turn, starting from the least
+    // significant, results in the entries being sorted by the whole key.
+    for (int word = 1; word < num_words; ++word) {
+      for (KeyIndex& key : keys_) {
+        key.key = get_word(unsorted_[key.index], word);
+      }
+      RadixSortKeys();
+    }
+  }
+
+  list_.clear();
+  for (const KeyIndex& key : keys_) {
+    list_.push_back(unsorted_[key.index]);
+  }
+}
+
+template <typename Component>
+template <typename LessFn>
+bool DisplayList<Component>::InsertionSortKeys(const LessFn& less,
+                                               size_t max_moves) {
+  size_t num_moves = 0;
+  for (size_t i = 1; i < keys_.size(); ++i) {
+    const KeyIndex key = keys_[i];
+    size_t j = i;
+    while (j > 0 && less(key, keys_[j - 1])) {
+      keys_[j] = keys_[j - 1];
+      --j;
+      if (++num_moves > max_moves) {
+        // |keys_| is reinitialized by the caller, so there is no need to put
+        // |key| back.
+        return false;
+      }
+    }
+    keys_[j] = key;
+  }
+  return true;
+}
+
+template <typename Component>
+void DisplayList<Component>::RadixSortKeys() {
+  static constexpr int kNumDigits = 4;
+  static constexpr uint32_t kDigitMask = 0xff;
+  const size_t count = keys_.size();
+  if (count < 2) {
+    return;
+  }
+
+  // Build the histograms of all the digits in a single pass.
+  uint32_t histograms[kNumDigits][kDigitMask + 1];
+  memset(histograms, 0, sizeof(histograms));
+  for (const KeyIndex& key : keys_) {
+    for (int digit = 0; digit < kNumDigits; ++digit) {
+      ++histograms[digit][(key.key >> (8 * digit)) & kDigitMask];
+    }
+  }
+
+  scratch_keys_.resize(count);
+  for (int digit = 0; digit < kNumDigits; ++digit) {
+    const int shift = 8 * digit;
+    uint32_t* histogram = histograms[digit];
+
+    // Skip digits that are the same for every key, which is common since
+    // keys often only differ in a few bits.
+    if (histogram[(keys_[0].key >> shift) & kDigitMask] == count) {
+      continue;
+    }
+
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i <= kDigitMask; ++i) {
+      const uint32_t num = histogram[i];
+      histogram[i] = offset;
+      offset += num;
+    }
+    for (const KeyIndex& key : keys_) {
+      scratch_keys_[histogram[(key.key >> shift) & kDigitMask]++] = key;
+    }
+    keys_.swap(scratch_keys_);
+  }
 }
 
 template <typename Component>
@@ -207,8 +416,8 @@ void DisplayList<Component>::Populate(const RenderPool<Component>& pool,
                                       size_t num_views) {
   LULLABY_CPU_TRACE_CALL();
 
-  list_.clear();
-  list_.reserve(pool.Size());
+  unsorted_.clear();
+  unsorted_.reserve(pool.Size());
 
   const RenderCullMode cull_mode = pool.GetCullMode();
 
@@ -219,50 +428,92 @@ void DisplayList<Component>::Populate(const RenderPool<Component>& pool,
         pool.GetTransformFlag(),
         [&](Entity e, const mathfu::mat4& world_from_entity_mat,
             const Aabb& box) {
-          // TODO Don't copy transforms.
           Entry info(e);
-          info.world_from_entity_matrix = world_from_entity_mat;
-          list_.push_back(info);
+          info.world_from_entity_matrix = &world_from_entity_mat;
+          unsorted_.push_back(info);
         });
   } else {
-    // Compute the view frustum for all views.
+    // Compute a single view frustum enclosing all the views (eg. both eyes),
+    // so that each entity is only tested once, falling back to testing each
+    // view's frustum if they cannot be combined.
     mathfu::vec4 frustum_clipping_planes[kMaxViews][kNumFrustumPlanes];
     if (num_views > kMaxViews) {
       LOG(DFATAL) << "Cannot have more views than eyes.";
+      list_.clear();
       return;
     }
-    for (size_t i = 0; i < num_views; i++) {
-      CalculateViewFrustum(views[i].clip_from_world_matrix,
-                           frustum_clipping_planes[i]);
+    size_t num_frustums = 1;
+    if (num_views == 1) {
+      GetViewFrustum(views[0], frustum_clipping_planes[0]);
+    } else {
+      mathfu::mat4 clip_from_world[kMaxViews];
+      for (size_t i = 0; i < num_views; i++) {
+        clip_from_world[i] = views[i].clip_from_world_matrix;
+      }
+      if (!CalculateCombinedViewFrustum(clip_from_world, num_views,
+                                        frustum_clipping_planes[0])) {
+        num_frustums = num_views;
+        for (size_t i = 0; i < num_views; i++) {
+          GetViewFrustum(views[i], frustum_clipping_planes[i]);
+        }
+      }
     }
 
-    transform_system->ForEach(
+    RenderOcclusion* occlusion = nullptr;
+    if (cull_mode == RenderCullMode::kVisibleAndUnoccludedInAnyView) {
+      occlusion = registry_->Get<RenderOcclusion>();
+      if (occlusion) {
+        PrepareOcclusion(occlusion, views, num_views);
+      }
+    }
+
+    // Entities are culled in batches: their world space bounding spheres
+    // (which the TransformSystem caches) are gathered, tested against all the
+    // view frusta at once, and only the visible entities are added to the
+    // list.
+    static constexpr size_t kBatchSize = 8 * kSphereFrustumBatchSize;
+    Entity batch_entities[kBatchSize];
+    const mathfu::mat4* batch_matrices[kBatchSize];
+    const Aabb* batch_boxes[kBatchSize];
+    mathfu::vec4 batch_spheres[kBatchSize];
+    uint8_t batch_visible[kBatchSize];
+    size_t batch_size = 0;
+
+    auto flush_batch = [&]() {
+      CheckSpheresInFrustums(batch_spheres, batch_size, frustum_clipping_planes,
+                             num_frustums, batch_visible);
+      for (size_t i = 0; i < batch_size; ++i) {
+        // Occluders are never culled by occlusion, since they would otherwise
+        // hide themselves.
+        if (batch_visible[i] && occlusion &&
+            !occlusion->IsOccluder(batch_entities[i]) &&
+            occlusion->IsOccluded(*batch_boxes[i], *batch_matrices[i])) {
+          continue;
+        }
+        if (batch_visible[i]) {
+          Entry info(batch_entities[i]);
+          info.world_from_entity_matrix = batch_matrices[i];
+          unsorted_.push_back(info);
+        }
+      }
+      batch_size = 0;
+    };
+
+    transform_system->ForEachWithBoundingSphere(
         pool.GetTransformFlag(),
         [&](Entity e, const mathfu::mat4& world_from_entity_mat,
-            const Aabb& box) {
-          // TODO Don't copy transforms.
-          Entry info(e);
-          info.world_from_entity_matrix = world_from_entity_mat;
-
-          // Compute the bounding sphere from bounding box and transform it
-          // to world space because the view's frustum is in world space.
-          // TODO: This should be cached since most entities are
-          // static in nature and will result in improved performance.
-          const float radius = (box.max - box.min).Length() * 0.5f;
-          const mathfu::vec3 center =
-              world_from_entity_mat *
-              mathfu::vec3::Lerp(box.min, box.max, 0.5f);
-
-          // Add the entity to the display list, if it's bounding sphere
-          // intersects at least one render view's frustum.
-          for (size_t i = 0; i < num_views; i++) {
-            if (CheckSphereInFrustum(center, radius,
-                                     frustum_clipping_planes[i])) {
-              list_.push_back(info);
-              break;
-            }
+            const Aabb& box, const mathfu::vec4& sphere) {
+          batch_entities[batch_size] = e;
+          batch_matrices[batch_size] = &world_from_entity_mat;
+          batch_boxes[batch_size] = &box;
+          batch_spheres[batch_size] = sphere;
+          if (++batch_size == kBatchSize) {
+            flush_batch();
           }
         });
+    // The transforms cannot have been modified since they were gathered, so
+    // the matrix and box pointers are still valid.
+    flush_batch();
   }
 
   const SortMode sort_mode = pool.GetSortMode();
@@ -300,6 +551,7 @@ void DisplayList<Component>::Populate(const RenderPool<Component>& pool,
     DCHECK(sort_mode == SortMode_None)
         << "Unsupported sort mode " << static_cast<int>(sort_mode);
     GetComponentsUnsorted(pool);
+    list_.swap(unsorted_);
   }
 }
 
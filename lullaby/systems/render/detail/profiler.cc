@@ -74,6 +74,21 @@ int Profiler::GetNumShaderSwaps() const {
   return (f ? f->num_shader_swaps : 0);
 }
 
+int Profiler::GetNumMaterialSwaps() const {
+  const Frame* f = GetMostRecentProfiledFrame();
+  return (f ? f->num_material_swaps : 0);
+}
+
+int Profiler::GetNumMeshSwaps() const {
+  const Frame* f = GetMostRecentProfiledFrame();
+  return (f ? f->num_mesh_swaps : 0);
+}
+
+int Profiler::GetNumRenderStateChanges() const {
+  const Frame* f = GetMostRecentProfiledFrame();
+  return (f ? f->num_render_state_changes : 0);
+}
+
 int Profiler::GetNumVerts() const {
   const Frame* f = GetMostRecentProfiledFrame();
   return (f ? f->num_verts : 0);
@@ -84,6 +99,18 @@ int Profiler::GetNumTris() const {
   return (f ? f->num_tris : 0);
 }
 
+const std::vector<Profiler::PassStats>& Profiler::GetPassStats() const {
+  static const std::vector<PassStats> kNoPasses;
+  for (int i = kMaxFrames - 1; i >= 0; --i) {
+    const int index = (head_ + i) % kMaxFrames;
+    const Frame& f = frames_[index];
+    if (IsFrameProfiled(f) && ArePassTimersReady(f)) {
+      return f.passes;
+    }
+  }
+  return kNoPasses;
+}
+
 Profiler::Marker Profiler::SetMarker() {
   Marker m;
   m.cpu = Clock::now();
@@ -98,6 +125,18 @@ void Profiler::PollMarker(Marker* m) {
   }
 }
 
+void Profiler::PollPassTimers(Frame* f) {
+  for (size_t i = 0; i < f->pass_timers.size(); ++i) {
+    GpuProfiler::Query& timer = f->pass_timers[i];
+    uint64_t nanoseconds = 0;
+    if (timer != GpuProfiler::kInvalidQuery &&
+        gpu_.GetTime(timer, &nanoseconds)) {
+      f->passes[i].gpu_ms = MillisecondsFromNanoseconds(nanoseconds);
+      timer = GpuProfiler::kInvalidQuery;
+    }
+  }
+}
+
 void Profiler::ResetMarker(Marker* m) {
   if (m->gpu_marker != GpuProfiler::kInvalidQuery) {
     gpu_.Abandon(m->gpu_marker);
@@ -116,10 +155,23 @@ void Profiler::ResetFrame(Frame* f) {
   f->gpu_interval_ms = 0.0f;
 
   f->last_shader.reset();
+  f->last_material = nullptr;
+  f->last_mesh = nullptr;
   f->num_draws = 0;
   f->num_shader_swaps = 0;
+  f->num_material_swaps = 0;
+  f->num_mesh_swaps = 0;
+  f->num_render_state_changes = 0;
   f->num_verts = 0;
   f->num_tris = 0;
+
+  for (GpuProfiler::Query timer : f->pass_timers) {
+    if (timer != GpuProfiler::kInvalidQuery) {
+      gpu_.Abandon(timer);
+    }
+  }
+  f->passes.clear();
+  f->pass_timers.clear();
 }
 
 void Profiler::BeginFrame() {
@@ -131,6 +183,7 @@ void Profiler::BeginFrame() {
     Frame& f = frames_[i];
     PollMarker(&f.begin);
     PollMarker(&f.end);
+    PollPassTimers(&f);
 
     if (f.gpu_duration_ms == 0.0f && f.begin.gpu_time_nanosec != 0 &&
         f.end.gpu_time_nanosec != 0) {
@@ -156,6 +209,11 @@ void Profiler::BeginFrame() {
 void Profiler::EndFrame() {
   CHECK(in_frame_);
 
+  if (active_pass_ >= 0) {
+    LOG(DFATAL) << "Missing EndPass.";
+    EndPass();
+  }
+
   Frame& f = frames_[head_];
   f.end = SetMarker();
 
@@ -175,6 +233,8 @@ void Profiler::EndFrame() {
   }
 
   f.last_shader.reset();
+  f.last_material = nullptr;
+  f.last_mesh = nullptr;
 
   gpu_.EndFrame();
 
@@ -182,6 +242,33 @@ void Profiler::EndFrame() {
   in_frame_ = false;
 }
 
+void Profiler::BeginPass(HashValue pass) {
+  if (!in_frame_) {
+    return;
+  }
+  if (active_pass_ >= 0) {
+    LOG(DFATAL) << "Passes cannot be nested.";
+    return;
+  }
+
+  Frame& f = frames_[head_];
+  PassStats stats;
+  stats.pass = pass;
+  f.passes.push_back(stats);
+  f.pass_timers.push_back(gpu_.BeginTimer());
+  active_pass_ = static_cast<int>(f.passes.size()) - 1;
+}
+
+void Profiler::EndPass() {
+  if (!in_frame_ || active_pass_ < 0) {
+    return;
+  }
+
+  Frame& f = frames_[head_];
+  gpu_.EndTimer(f.pass_timers[active_pass_]);
+  active_pass_ = -1;
+}
+
 void Profiler::RecordDraw(ShaderPtr shader, int num_verts, int num_tris) {
   if (!in_frame_) {
     return;
@@ -197,6 +284,37 @@ void Profiler::RecordDraw(ShaderPtr shader, int num_verts, int num_tris) {
   ++f.num_draws;
   f.num_verts += num_verts;
   f.num_tris += num_tris;
+
+  if (active_pass_ >= 0) {
+    PassStats& pass = f.passes[active_pass_];
+    ++pass.num_draws;
+    pass.num_verts += num_verts;
+    pass.num_tris += num_tris;
+  }
+}
+
+void Profiler::RecordBinds(const void* material, const void* mesh) {
+  if (!in_frame_) {
+    return;
+  }
+
+  Frame& f = frames_[head_];
+
+  if (f.last_material != material) {
+    ++f.num_material_swaps;
+    f.last_material = material;
+  }
+  if (f.last_mesh != mesh) {
+    ++f.num_mesh_swaps;
+    f.last_mesh = mesh;
+  }
+}
+
+void Profiler::RecordRenderStateChanges(int num_changes) {
+  if (!in_frame_) {
+    return;
+  }
+  frames_[head_].num_render_state_changes += num_changes;
 }
 
 bool Profiler::IsFrameProfiled(const Frame& f) const {
@@ -204,6 +322,15 @@ bool Profiler::IsFrameProfiled(const Frame& f) const {
           (!GpuProfiler::IsSupported() || f.gpu_interval_ms != 0.0f));
 }
 
+bool Profiler::ArePassTimersReady(const Frame& f) const {
+  for (GpuProfiler::Query timer : f.pass_timers) {
+    if (timer != GpuProfiler::kInvalidQuery) {
+      return false;
+    }
+  }
+  return true;
+}
+
 float Profiler::GetFrameFps(const Frame& f) const {
   // TODO use max of cpu / gpu when we get accurate gpu timings.
   // return (1000.0f / std::max(f.cpu_interval_ms, f.gpu_interval_ms));
@@ -17,9 +17,12 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_RENDER_DETAIL_PROFILER_H_
 #define LULLABY_SYSTEMS_RENDER_DETAIL_PROFILER_H_
 
+#include <vector>
+
 #include "lullaby/systems/render/detail/gpu_profiler.h"
 #include "lullaby/systems/render/shader.h"
 #include "lullaby/util/clock.h"
+#include "lullaby/util/hash.h"
 #include "lullaby/util/typeid.h"
 
 namespace lull {
@@ -27,6 +30,16 @@ namespace detail {
 
 class Profiler {
  public:
+  // The stats of a single render pass in a frame.
+  struct PassStats {
+    HashValue pass = 0;
+    // The GPU time in milliseconds, or 0.0 if GPU timing is not supported.
+    float gpu_ms = 0.0f;
+    int num_draws = 0;
+    int num_verts = 0;
+    int num_tris = 0;
+  };
+
   Profiler();
 
   // Returns the frame rate filtered over the last several frames.
@@ -48,12 +61,26 @@ class Profiler {
   // Returns the number of shader swaps during the last available frame.
   int GetNumShaderSwaps() const;
 
+  // Returns the number of material swaps during the last available frame.
+  int GetNumMaterialSwaps() const;
+
+  // Returns the number of mesh swaps during the last available frame.
+  int GetNumMeshSwaps() const;
+
+  // Returns the number of GL render state changes (eg. blend, depth, or cull
+  // state) during the last available frame.
+  int GetNumRenderStateChanges() const;
+
   // Returns the number of verts used during the last available frame.
   int GetNumVerts() const;
 
   // Returns the number of tris used during the last available frame.
   int GetNumTris() const;
 
+  // Returns the stats of each pass, in the order they were rendered, for the
+  // last frame whose GPU pass timings are available.
+  const std::vector<PassStats>& GetPassStats() const;
+
   // Returns an estimated number of dropped frames.
   int GetNumDroppedFrames() const { return num_dropped_frames_; }
 
@@ -66,9 +93,23 @@ class Profiler {
   // Marks the end of a frame.
   void EndFrame();
 
+  // Marks the beginning and end of rendering |pass|.  The draws recorded in
+  // between are attributed to the pass, and its GPU time is measured if
+  // supported.  Passes cannot be nested.
+  void BeginPass(HashValue pass);
+  void EndPass();
+
   // Records a draw call using |shader| with |num_verts| and |num_tris|.
   void RecordDraw(ShaderPtr shader, int num_verts,  int num_tris);
 
+  // Records that a draw call used |material| and |mesh|.  These are only
+  // compared with the previous draw call's to count swaps, so they can be
+  // pointers to any backend's types.
+  void RecordBinds(const void* material, const void* mesh);
+
+  // Records |num_changes| changes to the GL render state.
+  void RecordRenderStateChanges(int num_changes);
+
  private:
   static const int kMaxFrames = 10;
 
@@ -87,17 +128,29 @@ class Profiler {
     float gpu_interval_ms = 0;
 
     ShaderPtr last_shader;
+    const void* last_material = nullptr;
+    const void* last_mesh = nullptr;
     int num_draws = 0;
     int num_shader_swaps = 0;
+    int num_material_swaps = 0;
+    int num_mesh_swaps = 0;
+    int num_render_state_changes = 0;
     int num_verts = 0;
     int num_tris = 0;
+
+    // The passes rendered in the frame, and the GPU timer of each pass which
+    // is reset once the pass' time has been retrieved.
+    std::vector<PassStats> passes;
+    std::vector<GpuProfiler::Query> pass_timers;
   };
 
   Marker SetMarker();
   void PollMarker(Marker* m);
+  void PollPassTimers(Frame* f);
   void ResetMarker(Marker* m);
 
   bool IsFrameProfiled(const Frame& f) const;
+  bool ArePassTimersReady(const Frame& f) const;
   float GetFrameFps(const Frame& f) const;
   const Frame* GetMostRecentProfiledFrame() const;
   void ResetFrame(Frame* f);
@@ -106,6 +159,8 @@ class Profiler {
   Frame frames_[kMaxFrames];
   int head_ = 0;
   bool in_frame_ = false;
+  // The index of the active pass in the current frame's passes, or -1.
+  int active_pass_ = -1;
   int num_dropped_frames_ = 0;
 };
 
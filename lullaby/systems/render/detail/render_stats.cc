@@ -17,6 +17,7 @@ limitations under the License.
 #include "lullaby/systems/render/render_stats.h"
 
 #include "lullaby/systems/render/detail/profiler.h"
+#include "lullaby/systems/render/render_occlusion.h"
 #include "lullaby/systems/render/simple_font.h"
 #include "lullaby/util/math.h"
 
@@ -69,6 +70,37 @@ void RenderStats::EnablePerformanceLogging(int interval) {
   }
 }
 
+std::vector<RenderStats::PassStats> RenderStats::GetPassStats() const {
+  std::vector<PassStats> result;
+  const detail::Profiler* profiler = registry_->Get<detail::Profiler>();
+  if (profiler) {
+    for (const detail::Profiler::PassStats& stats : profiler->GetPassStats()) {
+      PassStats pass_stats;
+      pass_stats.pass = stats.pass;
+      pass_stats.gpu_ms = stats.gpu_ms;
+      pass_stats.num_draws = stats.num_draws;
+      pass_stats.num_verts = stats.num_verts;
+      pass_stats.num_tris = stats.num_tris;
+      result.push_back(pass_stats);
+    }
+  }
+  return result;
+}
+
+RenderStats::OcclusionStats RenderStats::GetOcclusionStats() const {
+  OcclusionStats stats;
+  const RenderOcclusion* occlusion = registry_->Get<RenderOcclusion>();
+  if (occlusion) {
+    stats.num_tested = occlusion->GetNumTested();
+    stats.num_occluded = occlusion->GetNumOccluded();
+    if (stats.num_tested > 0) {
+      stats.culled_fraction = static_cast<float>(stats.num_occluded) /
+                              static_cast<float>(stats.num_tested);
+    }
+  }
+  return stats;
+}
+
 void RenderStats::BeginFrame() {
   ++frame_counter_;
 
@@ -88,7 +120,9 @@ void RenderStats::EndFrame() {
     // Print out in CSV-ready format.
     if (!have_logged_headers_) {
       LOG(INFO) << "LullPerf frame #, FPS, CPU, GPU, # draws,"
-                   " # shader swaps, # verts, # tris";
+                   " # shader swaps, # verts, # tris, # material swaps,"
+                   " # mesh swaps, # render state changes";
+      LOG(INFO) << "LullPerfPass frame #, pass, GPU, # draws, # verts, # tris";
       have_logged_headers_ = true;
     }
 
@@ -97,7 +131,15 @@ void RenderStats::EndFrame() {
               << ", " << profiler->GetGpuFrameMs() << ", "
               << profiler->GetNumDraws() << ", "
               << profiler->GetNumShaderSwaps() << ", "
-              << profiler->GetNumVerts() << ", " << profiler->GetNumTris();
+              << profiler->GetNumVerts() << ", " << profiler->GetNumTris()
+              << ", " << profiler->GetNumMaterialSwaps() << ", "
+              << profiler->GetNumMeshSwaps() << ", "
+              << profiler->GetNumRenderStateChanges();
+    for (const detail::Profiler::PassStats& stats : profiler->GetPassStats()) {
+      LOG(INFO) << "LullPerfPass " << frame_counter_ << ", " << stats.pass
+                << ", " << stats.gpu_ms << ", " << stats.num_draws << ", "
+                << stats.num_verts << ", " << stats.num_tris;
+    }
     perf_log_counter_ = perf_log_interval_;
   }
 }
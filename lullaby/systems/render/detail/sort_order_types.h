@@ -88,6 +88,21 @@ class RenderSortOrder {
     return result;
   }
 
+  // The number of 32-bit words used to store the value.
+  constexpr static int kNumWords = SORT_ORDER_SIZE / BITS_PER_INT;
+
+  // Returns the |index|th 32-bit word of the value, where word 0 is the least
+  // significant.  Used to radix sort render sort orders.
+  uint32_t GetWord(int index) const {
+    if (kIntSize == 1) {
+      return value_.u32;
+    }
+    if (kIntSize == 2) {
+      return static_cast<uint32_t>(value_.u64 >> (index * BITS_PER_INT));
+    }
+    return value_.u32s_[kIntSize - 1 - index];
+  }
+
   RenderSortOrder& operator=(const int& v) {
     if (kIntSize == 1 && sizeof(int) > 4) {
       LOG(WARNING) << "Render sort order overflow.";
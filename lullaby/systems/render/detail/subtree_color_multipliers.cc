@@ -0,0 +1,70 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/detail/subtree_color_multipliers.h"
+
+#include "mathfu/constants.h"
+#include "lullaby/systems/transform/transform_system.h"
+
+namespace lull {
+namespace detail {
+
+void SubtreeColorMultipliers::Set(Entity entity,
+                                  const mathfu::vec4& multiplier) {
+  multipliers_[entity] = multiplier;
+  inherited_.clear();
+}
+
+void SubtreeColorMultipliers::Clear(Entity entity) {
+  if (multipliers_.erase(entity) > 0) {
+    inherited_.clear();
+  }
+}
+
+bool SubtreeColorMultipliers::Get(Entity entity,
+                                  mathfu::vec4* multiplier) const {
+  auto iter = multipliers_.find(entity);
+  if (iter == multipliers_.end()) {
+    return false;
+  }
+  *multiplier = iter->second;
+  return true;
+}
+
+mathfu::vec4 SubtreeColorMultipliers::GetInherited(Entity entity) const {
+  if (multipliers_.empty() || entity == kNullEntity) {
+    return mathfu::kOnes4f;
+  }
+  auto cached = inherited_.find(entity);
+  if (cached != inherited_.end()) {
+    return cached->second;
+  }
+
+  mathfu::vec4 multiplier = mathfu::kOnes4f;
+  auto iter = multipliers_.find(entity);
+  if (iter != multipliers_.end()) {
+    multiplier = iter->second;
+  }
+  const auto* transform_system = registry_->Get<TransformSystem>();
+  if (transform_system) {
+    multiplier *= GetInherited(transform_system->GetParent(entity));
+  }
+  inherited_[entity] = multiplier;
+  return multiplier;
+}
+
+}  // namespace detail
+}  // namespace lull
@@ -0,0 +1,72 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_DETAIL_SUBTREE_COLOR_MULTIPLIERS_H_
+#define LULLABY_SYSTEMS_RENDER_DETAIL_SUBTREE_COLOR_MULTIPLIERS_H_
+
+#include <unordered_map>
+
+#include "mathfu/glsl_mappings.h"
+#include "lullaby/util/entity.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace detail {
+
+// A helper class to manage the color multipliers that RenderSystems apply to
+// whole subtrees of entities.  A multiplier is set once on the root of a
+// subtree and every entity drawn below it inherits it, so fading or tinting a
+// large hierarchy costs a single write instead of a color change on every
+// descendant.
+//
+// The multiplier an entity is drawn with is the product of the multipliers set
+// on it and all of its ancestors.  These are resolved lazily and cached until
+// a multiplier or the hierarchy changes.
+class SubtreeColorMultipliers {
+ public:
+  explicit SubtreeColorMultipliers(Registry* registry) : registry_(registry) {}
+
+  // Sets the multiplier of the subtree rooted at |entity|.
+  void Set(Entity entity, const mathfu::vec4& multiplier);
+
+  // Removes the multiplier of the subtree rooted at |entity|.
+  void Clear(Entity entity);
+
+  // Copies the multiplier set directly on |entity| into |multiplier|.  Returns
+  // false if there is none.
+  bool Get(Entity entity, mathfu::vec4* multiplier) const;
+
+  // Returns true if no multipliers are set, in which case every entity draws
+  // with its own color.
+  bool Empty() const { return multipliers_.empty(); }
+
+  // Returns the combined multiplier inherited by |entity|.
+  mathfu::vec4 GetInherited(Entity entity) const;
+
+  // Discards the cached inherited multipliers.  Must be called whenever the
+  // hierarchy changes.
+  void Invalidate() { inherited_.clear(); }
+
+ private:
+  Registry* registry_;
+  std::unordered_map<Entity, mathfu::vec4> multipliers_;
+  mutable std::unordered_map<Entity, mathfu::vec4> inherited_;
+};
+
+}  // namespace detail
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_RENDER_DETAIL_SUBTREE_COLOR_MULTIPLIERS_H_
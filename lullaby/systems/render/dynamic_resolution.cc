@@ -0,0 +1,83 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/dynamic_resolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+// Changes smaller than this are ignored so that small fluctuations in the GPU
+// time do not constantly change the resolution.
+static constexpr float kMinScaleChange = 0.01f;
+
+DynamicResolution::DynamicResolution() : DynamicResolution(Params()) {}
+
+DynamicResolution::DynamicResolution(const Params& params) {
+  SetParams(params);
+  scale_ = params_.max_scale;
+}
+
+void DynamicResolution::SetParams(const Params& params) {
+  params_ = params;
+  if (params_.min_scale <= 0.0f || params_.min_scale > params_.max_scale) {
+    LOG(DFATAL) << "Invalid dynamic resolution scale bounds: "
+                << params_.min_scale << " to " << params_.max_scale;
+    params_.min_scale = std::max(params_.min_scale, 0.1f);
+    params_.max_scale = std::max(params_.max_scale, params_.min_scale);
+  }
+  scale_ = mathfu::Clamp(scale_, params_.min_scale, params_.max_scale);
+}
+
+void DynamicResolution::Update(float gpu_ms) {
+  if (gpu_ms <= 0.0f || params_.target_gpu_ms <= 0.0f) {
+    return;
+  }
+  if (frames_until_update_ > 0) {
+    --frames_until_update_;
+    return;
+  }
+
+  // The GPU time is roughly proportional to the number of pixels, ie. the
+  // square of the scale.
+  const float desired_scale =
+      scale_ * std::sqrt(params_.target_gpu_ms / gpu_ms);
+  const float change =
+      mathfu::Clamp(desired_scale - scale_, -params_.max_scale_down_step,
+                    params_.max_scale_up_step);
+  const float scale =
+      mathfu::Clamp(scale_ + change, params_.min_scale, params_.max_scale);
+  if (std::abs(scale - scale_) < kMinScaleChange &&
+      scale != params_.min_scale && scale != params_.max_scale) {
+    return;
+  }
+  if (scale != scale_) {
+    scale_ = scale;
+    frames_until_update_ = params_.settle_frames;
+  }
+}
+
+mathfu::vec2i DynamicResolution::ScaleSize(const mathfu::vec2i& size,
+                                           float scale) {
+  return mathfu::vec2i(
+      std::max(1, static_cast<int>(std::lround(size.x * scale))),
+      std::max(1, static_cast<int>(std::lround(size.y * scale))));
+}
+
+}  // namespace lull
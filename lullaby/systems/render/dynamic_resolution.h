@@ -0,0 +1,81 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_DYNAMIC_RESOLUTION_H_
+#define LULLABY_SYSTEMS_RENDER_DYNAMIC_RESOLUTION_H_
+
+#include "mathfu/glsl_mappings.h"
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+// Controls the resolution at which the main render target is rendered based
+// on the GPU time of the passes drawn into it.  When the GPU time exceeds the
+// budget (eg. on a thermally throttled device), the resolution is lowered so
+// that frames keep making vsync, and it is raised again once there is
+// headroom.  The scaled image is upscaled to the full resolution when it is
+// presented.
+//
+// The RenderSystem uses the controller while one exists in the registry, eg:
+// registry.Create<DynamicResolution>(params);
+class DynamicResolution {
+ public:
+  struct Params {
+    // The bounds of the scale applied to each axis of the render target.
+    float min_scale = 0.5f;
+    float max_scale = 1.0f;
+    // The GPU time budget in milliseconds of the scaled passes.
+    float target_gpu_ms = 14.0f;
+    // The largest change to the scale per update when lowering or raising the
+    // resolution.  Lowering is faster so that missed frames are short-lived.
+    float max_scale_down_step = 0.1f;
+    float max_scale_up_step = 0.02f;
+    // The number of updates ignored after the scale changes.  GPU timings are
+    // read back a few frames late, so this keeps stale timings from causing
+    // overshoot.
+    int settle_frames = 4;
+  };
+
+  DynamicResolution();
+  explicit DynamicResolution(const Params& params);
+
+  // Sets the controller parameters, clamping the current scale to the new
+  // bounds.
+  void SetParams(const Params& params);
+  const Params& GetParams() const { return params_; }
+
+  // Returns the scale currently applied to each axis of the render target.
+  float GetScale() const { return scale_; }
+
+  // Updates the scale from the GPU time in milliseconds of the passes that
+  // were rendered at the scale.  Non-positive times (ie. no timing available)
+  // are ignored.
+  void Update(float gpu_ms);
+
+  // Returns |size| scaled by |scale|, keeping at least one pixel per axis.
+  static mathfu::vec2i ScaleSize(const mathfu::vec2i& size, float scale);
+
+ private:
+  Params params_;
+  float scale_ = 1.0f;
+  int frames_until_update_ = 0;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::DynamicResolution);
+
+#endif  // LULLABY_SYSTEMS_RENDER_DYNAMIC_RESOLUTION_H_
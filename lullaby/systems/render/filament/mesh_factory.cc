@@ -22,6 +22,28 @@ limitations under the License.
 
 namespace lull {
 
+static filament::VertexBuffer::AttributeType GetFloatAttributeType(
+    VertexAttributeType type) {
+  switch (type) {
+    case VertexAttributeType_Scalar1f:
+      return filament::VertexBuffer::AttributeType::FLOAT;
+    case VertexAttributeType_Vec2f:
+      return filament::VertexBuffer::AttributeType::FLOAT2;
+    case VertexAttributeType_Vec3f:
+      return filament::VertexBuffer::AttributeType::FLOAT3;
+    case VertexAttributeType_Vec4f:
+      return filament::VertexBuffer::AttributeType::FLOAT4;
+    case VertexAttributeType_Vec2hf:
+      return filament::VertexBuffer::AttributeType::HALF2;
+    case VertexAttributeType_Vec4hf:
+      return filament::VertexBuffer::AttributeType::HALF4;
+    default:
+      LOG(DFATAL) << "Unsupported floating point vertex attribute type: "
+                  << EnumNameVertexAttributeType(type);
+      return filament::VertexBuffer::AttributeType::FLOAT3;
+  }
+}
+
 static filament::VertexBuffer* CreateVertexBuffer(filament::Engine* engine,
                                                   const MeshData& data) {
   const VertexFormat& vertex_format = data.GetVertexFormat();
@@ -40,9 +62,8 @@ static filament::VertexBuffer* CreateVertexBuffer(filament::Engine* engine,
     const VertexAttribute* attribute = vertex_format.GetAttributeAt(index);
     switch (attribute->usage()) {
       case VertexAttributeUsage_Position: {
-        CHECK_EQ(attribute->type(), VertexAttributeType_Vec3f);
         builder.attribute(filament::VertexAttribute::POSITION, 0,
-                          filament::VertexBuffer::AttributeType::FLOAT3, offset,
+                          GetFloatAttributeType(attribute->type()), offset,
                           vertex_size);
         break;
       }
@@ -54,19 +75,28 @@ static filament::VertexBuffer* CreateVertexBuffer(filament::Engine* engine,
         break;
       }
       case VertexAttributeUsage_Orientation: {
-        CHECK_EQ(attribute->type(), VertexAttributeType_Vec4f);
+        CHECK(attribute->type() == VertexAttributeType_Vec4f ||
+              attribute->type() == VertexAttributeType_Vec4hf);
         builder.attribute(filament::VertexAttribute::TANGENTS, 0,
-                          filament::VertexBuffer::AttributeType::FLOAT4, offset,
+                          GetFloatAttributeType(attribute->type()), offset,
                           vertex_size);
         break;
       }
       case VertexAttributeUsage_TexCoord: {
-        CHECK_EQ(attribute->type(), VertexAttributeType_Vec2f);
         CHECK_LT(tex_coord_count, 2);
-        builder.attribute(tex_coord_count == 0 ? filament::VertexAttribute::UV0
-                                               : filament::VertexAttribute::UV1,
-                          0, filament::VertexBuffer::AttributeType::FLOAT2,
-                          offset, vertex_size);
+        const filament::VertexAttribute uv =
+            tex_coord_count == 0 ? filament::VertexAttribute::UV0
+                                 : filament::VertexAttribute::UV1;
+        if (attribute->type() == VertexAttributeType_Vec2us) {
+          // Integer texture coordinates are unorm values.
+          builder.attribute(uv, 0,
+                            filament::VertexBuffer::AttributeType::USHORT2,
+                            offset, vertex_size);
+          builder.normalized(uv);
+        } else {
+          builder.attribute(uv, 0, GetFloatAttributeType(attribute->type()),
+                            offset, vertex_size);
+        }
         ++tex_coord_count;
         break;
       }
@@ -36,7 +36,7 @@ constexpr HashValue kFeatureHashUniformColor = ConstHash("UniformColor");
 
 RenderSystemFilament::RenderSystemFilament(
     Registry* registry, const RenderSystem::InitParams& init_params)
-    : System(registry) {
+    : System(registry), subtree_color_multipliers_(registry) {
   RegisterDef<AmbientLightDefT>((RenderSystem*)nullptr);
   RegisterDef<DirectionalLightDefT>((RenderSystem*)nullptr);
   RegisterDef<EnvironmentLightDefT>((RenderSystem*)nullptr);
@@ -58,6 +58,9 @@ RenderSystemFilament::RenderSystemFilament(
     dispatcher->Connect(this, [this](const SetNativeWindowEvent& event) {
       SetNativeWindow(event.native_window);
     });
+    dispatcher->Connect(this, [this](const ParentChangedImmediateEvent& event) {
+      subtree_color_multipliers_.Invalidate();
+    });
   }
 }
 
@@ -212,6 +215,7 @@ void RenderSystemFilament::Destroy(Entity entity) {
     iter.second.components.Destroy(entity);
     iter.second.sceneview->DestroyLight(entity);
   }
+  subtree_color_multipliers_.Clear(entity);
 }
 
 void RenderSystemFilament::Destroy(Entity entity, HashValue pass) {
@@ -281,6 +285,20 @@ void RenderSystemFilament::SetColor(Entity entity, const mathfu::vec4& color) {
   });
 }
 
+void RenderSystemFilament::SetSubtreeColorMultiplier(
+    Entity entity, const mathfu::vec4& multiplier) {
+  subtree_color_multipliers_.Set(entity, multiplier);
+}
+
+void RenderSystemFilament::ClearSubtreeColorMultiplier(Entity entity) {
+  subtree_color_multipliers_.Clear(entity);
+}
+
+bool RenderSystemFilament::GetSubtreeColorMultiplier(
+    Entity entity, mathfu::vec4* multiplier) const {
+  return subtree_color_multipliers_.Get(entity, multiplier);
+}
+
 void RenderSystemFilament::SetUniform(const Drawable& drawable,
                                       string_view name, ShaderDataType type,
                                       Span<uint8_t> data, int count) {
@@ -636,7 +654,10 @@ void RenderSystemFilament::Render(RenderPassObject* render_pass,
   render_pass->components.ForEach([&](RenderComponent& component) {
     const mathfu::mat4* transform =
         transform_system->GetWorldFromEntityMatrix(component.GetEntity());
+    const mathfu::vec4 color_multiplier =
+        subtree_color_multipliers_.GetInherited(component.GetEntity());
     for (auto& renderable : component.renderables) {
+      renderable->SetColorMultiplier(color_multiplier);
       renderable->PrepareForRendering(scene, transform);
     }
   });
@@ -673,6 +694,10 @@ void RenderSystemFilament::SetCullMode(HashValue pass, RenderCullMode mode) {
   LOG(ERROR) << "Unimplemented: " << __FUNCTION__;
 }
 
+void RenderSystemFilament::SetInstancingEnabled(HashValue pass, bool enabled) {
+  LOG(ERROR) << "Unimplemented: " << __FUNCTION__;
+}
+
 void RenderSystemFilament::SetRenderState(HashValue pass,
                                           const fplbase::RenderState& state) {
   LOG(ERROR) << "Unimplemented: " << __FUNCTION__;
@@ -695,6 +720,23 @@ ImageData RenderSystemFilament::GetRenderTargetData(
   return ImageData();
 }
 
+void RenderSystemFilament::ReadRenderTargetDataAsync(
+    HashValue render_target_name, const mathfu::recti& rect) {
+  LOG(ERROR) << "Unimplemented: " << __FUNCTION__;
+}
+
+ImageData RenderSystemFilament::TakeRenderTargetData(
+    HashValue render_target_name) {
+  LOG(ERROR) << "Unimplemented: " << __FUNCTION__;
+  return ImageData();
+}
+
+void RenderSystemFilament::RequestRenderTargetData(
+    HashValue render_target_name, RenderSystem::RenderTargetDataFn fn,
+    const mathfu::vec2i& size) {
+  LOG(ERROR) << "Unimplemented: " << __FUNCTION__;
+}
+
 void RenderSystemFilament::SetDepthTest(bool enabled) {
   LOG(ERROR) << "Unimplemented: " << __FUNCTION__;
 }
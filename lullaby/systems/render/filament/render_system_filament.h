@@ -27,6 +27,7 @@ limitations under the License.
 #include "lullaby/modules/render/mesh_data.h"
 #include "lullaby/modules/render/vertex.h"
 #include "lullaby/systems/render/detail/sort_order.h"
+#include "lullaby/systems/render/detail/subtree_color_multipliers.h"
 #include "lullaby/systems/render/filament/mesh.h"
 #include "lullaby/systems/render/filament/mesh_factory.h"
 #include "lullaby/systems/render/filament/renderable.h"
@@ -78,6 +79,12 @@ class RenderSystemFilament : public System {
   void CreateRenderTarget(HashValue render_target_name,
                           const RenderTargetCreateParams& create_params);
   ImageData GetRenderTargetData(HashValue render_target_name);
+  void ReadRenderTargetDataAsync(HashValue render_target_name,
+                                 const mathfu::recti& rect);
+  ImageData TakeRenderTargetData(HashValue render_target_name);
+  void RequestRenderTargetData(HashValue render_target_name,
+                               RenderSystem::RenderTargetDataFn fn,
+                               const mathfu::vec2i& size);
 
   // Render pass configuration functions.
   void SetDefaultRenderPass(HashValue pass);
@@ -88,6 +95,7 @@ class RenderSystemFilament : public System {
   void SetSortMode(HashValue pass, SortMode mode);
   void SetSortVector(HashValue pass, const mathfu::vec3& vector);
   void SetCullMode(HashValue pass, RenderCullMode mode);
+  void SetInstancingEnabled(HashValue pass, bool enabled);
 
   // Entity creation/destruction functions.
   void Create(Entity entity, HashValue type, const Def* def) override;
@@ -131,6 +139,10 @@ class RenderSystemFilament : public System {
   void SetDefaultColor(Entity entity, const mathfu::vec4& color);
   bool GetColor(Entity entity, mathfu::vec4* color) const;
   void SetColor(Entity entity, const mathfu::vec4& color);
+  void SetSubtreeColorMultiplier(Entity entity, const mathfu::vec4& multiplier);
+  void ClearSubtreeColorMultiplier(Entity entity);
+  bool GetSubtreeColorMultiplier(Entity entity,
+                                 mathfu::vec4* multiplier) const;
 
   // Texture functions.
   void SetTexture(const Drawable& drawable, TextureUsageInfo usage,
@@ -239,6 +251,7 @@ class RenderSystemFilament : public System {
   std::unique_ptr<Renderer> renderer_;
 
   std::unordered_map<HashValue, RenderPassObject> render_passes_;
+  detail::SubtreeColorMultipliers subtree_color_multipliers_;
 
   MeshFactoryImpl* mesh_factory_ = nullptr;
   TextureFactoryImpl* texture_factory_ = nullptr;
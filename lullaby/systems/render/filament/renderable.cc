@@ -82,6 +82,10 @@ void Renderable::SetColor(const mathfu::vec4& color) {
   data_.color = color;
 }
 
+void Renderable::SetColorMultiplier(const mathfu::vec4& multiplier) {
+  color_multiplier_ = multiplier;
+}
+
 void Renderable::SetTexture(TextureUsageInfo usage, const TexturePtr& texture) {
   data_.textures[usage] = texture;
 }
@@ -309,7 +313,8 @@ void Renderable::UpdateMaterialInstance() {
       shader_->GetFilamentPropertyName(ConstHash("color"));
   if (color_pname) {
     material_instance_->setParameter(color_pname, filament::RgbaType::LINEAR,
-                                     ToLinearColorA(data_.color));
+                                     ToLinearColorA(data_.color *
+                                                    color_multiplier_));
   }
 
   for (auto& iter : data_.uniforms) {
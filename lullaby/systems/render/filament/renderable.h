@@ -17,6 +17,7 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_RENDER_FILAMENT_RENDERABLE_H_
 #define LULLABY_SYSTEMS_RENDER_FILAMENT_RENDERABLE_H_
 
+#include "mathfu/constants.h"
 #include "lullaby/systems/render/filament/renderer.h"
 #include "lullaby/systems/render/filament/mesh.h"
 #include "lullaby/systems/render/filament/shader.h"
@@ -83,6 +84,10 @@ class Renderable {
   // Sets the color associated with the renderable.
   void SetColor(const mathfu::vec4& color);
 
+  // Sets the multiplier applied to the color when it is sent to the material,
+  // which is how inherited subtree color multipliers are applied.
+  void SetColorMultiplier(const mathfu::vec4& multiplier);
+
   // Stores the data as a uniform.
   template <typename T>
   void SetUniform(HashValue name, ShaderDataType type, Span<T> data);
@@ -127,6 +132,7 @@ class Renderable {
   MeshPtr mesh_;
   ShaderPtr shader_;
   MaterialData data_;
+  mathfu::vec4 color_multiplier_ = mathfu::kOnes4f;
 };
 
 template <typename T>
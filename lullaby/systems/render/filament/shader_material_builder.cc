@@ -64,6 +64,10 @@ static const char* ToFilamentCodeString(VertexAttributeType type) {
       return "uvec4";
     case VertexAttributeType_Vec4ub:
       return "bvec4";
+    case VertexAttributeType_Vec2hf:
+      return "vec2";
+    case VertexAttributeType_Vec4hf:
+      return "vec4";
   }
 }
 
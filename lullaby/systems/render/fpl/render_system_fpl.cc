@@ -34,7 +34,9 @@ limitations under the License.
 #include "lullaby/systems/render/detail/profiler.h"
 #include "lullaby/systems/render/fpl/shader.h"
 #include "lullaby/systems/render/render_helpers.h"
+#include "lullaby/systems/render/render_occlusion.h"
 #include "lullaby/systems/render/render_stats.h"
+#include "lullaby/systems/render/render_visibility.h"
 #include "lullaby/systems/render/simple_font.h"
 #include "lullaby/systems/text/text_system.h"
 #include "lullaby/util/filename.h"
@@ -95,10 +97,19 @@ RenderSystemFpl::RenderSystemFpl(Registry* registry,
     : System(registry),
       render_component_pools_(registry),
       sort_order_manager_(registry_),
+      subtree_color_multipliers_(registry_),
       multiview_enabled_(init_params.enable_stereo_multiview) {
   renderer_.Initialize(mathfu::kZeros2i, "lull::RenderSystem");
 
   factory_ = registry->Create<RenderFactory>(registry, &renderer_);
+  visibility_ = registry->Get<RenderVisibility>();
+  if (!visibility_) {
+    visibility_ = registry->Create<RenderVisibility>(registry);
+  }
+  occlusion_ = registry->Get<RenderOcclusion>();
+  if (!occlusion_) {
+    occlusion_ = registry->Create<RenderOcclusion>(registry);
+  }
 
   SetSortMode(RenderPass_Opaque, SortMode_AverageSpaceOriginFrontToBack);
 
@@ -110,6 +121,7 @@ RenderSystemFpl::RenderSystemFpl(Registry* registry,
   auto* dispatcher = registry->Get<Dispatcher>();
   dispatcher->Connect(this, [this](const ParentChangedImmediateEvent& event) {
     UpdateSortOrder(event.target);
+    subtree_color_multipliers_.Invalidate();
   });
   dispatcher->Connect(this,
                       [this](const ChildIndexChangedImmediateEvent& event) {
@@ -346,6 +358,7 @@ void RenderSystemFpl::Destroy(Entity e) {
   render_component_pools_.DestroyComponent(e);
   deformations_.erase(e);
   sort_order_manager_.Destroy(e);
+  subtree_color_multipliers_.Clear(e);
 }
 
 HashValue RenderSystemFpl::GetRenderPass(Entity entity) const {
@@ -410,6 +423,20 @@ void RenderSystemFpl::SetColor(Entity entity, const mathfu::vec4& color) {
   SetUniform(entity, kColorUniform, &color[0], 4, 1);
 }
 
+void RenderSystemFpl::SetSubtreeColorMultiplier(
+    Entity entity, const mathfu::vec4& multiplier) {
+  subtree_color_multipliers_.Set(entity, multiplier);
+}
+
+void RenderSystemFpl::ClearSubtreeColorMultiplier(Entity entity) {
+  subtree_color_multipliers_.Clear(entity);
+}
+
+bool RenderSystemFpl::GetSubtreeColorMultiplier(
+    Entity entity, mathfu::vec4* multiplier) const {
+  return subtree_color_multipliers_.Get(entity, multiplier);
+}
+
 void RenderSystemFpl::SetUniform(Entity entity, Optional<HashValue> pass,
                                  Optional<int> submesh_index, string_view name,
                                  ShaderDataType type, Span<uint8_t> data,
@@ -1025,6 +1052,12 @@ void RenderSystemFpl::SetCullMode(HashValue pass, CullMode mode) {
   pool.SetCullMode(mode);
 }
 
+void RenderSystemFpl::SetInstancingEnabled(HashValue pass, bool enabled) {
+  if (enabled) {
+    LOG(DFATAL) << "This feature is only implemented in RenderSystemNext.";
+  }
+}
+
 void RenderSystemFpl::SetDefaultFrontFace(FrontFace face) {
   default_front_face_ = face;
 }
@@ -1173,6 +1206,9 @@ void RenderSystemFpl::SetClearParams(HashValue pass,
 
 void RenderSystemFpl::BeginFrame() {
   LULLABY_CPU_TRACE_CALL();
+  visibility_->BeginFrame();
+  occlusion_->BeginFrame();
+
   GLbitfield options = 0;
   if (CheckBit(clear_params_.clear_options, ClearParams::kColor)) {
     GL_CALL(
@@ -1196,6 +1232,9 @@ void RenderSystemFpl::BeginFrame() {
 }
 
 void RenderSystemFpl::EndFrame() {
+  visibility_->EndFrame();
+  occlusion_->EndFrame();
+
   // Something in later passes seems to expect depth write to be on. Setting
   // this here until the culprit is identified (b/36200233).
   const auto* config = registry_->Get<Config>();
@@ -1237,6 +1276,7 @@ void RenderSystemFpl::RenderAt(const RenderComponent* component,
 
   BindShader(shader);
   SetShaderUniforms(shader, component->material.GetUniforms());
+  BindSubtreeColorMultiplier(shader, component);
 
   const Shader::UniformHnd mat_normal_uniform_handle =
       shader->FindUniform("mat_normal");
@@ -1296,6 +1336,7 @@ void RenderSystemFpl::RenderAtMultiview(
 
   BindShader(shader);
   SetShaderUniforms(shader, component->material.GetUniforms());
+  BindSubtreeColorMultiplier(shader, component);
 
   const Shader::UniformHnd mvp_uniform_handle =
       shader->FindUniform("model_view_projection");
@@ -1350,6 +1391,28 @@ void RenderSystemFpl::SetShaderUniforms(const ShaderPtr& shader,
   }
 }
 
+void RenderSystemFpl::BindSubtreeColorMultiplier(
+    const ShaderPtr& shader, const RenderComponent* component) {
+  if (subtree_color_multipliers_.Empty()) {
+    return;
+  }
+  const mathfu::vec4 multiplier =
+      subtree_color_multipliers_.GetInherited(component->GetEntity());
+  if (multiplier == mathfu::kOnes4f) {
+    return;
+  }
+  const Uniform* color = component->material.GetUniformByName(kColorUniform);
+  if (!color || color->GetDescription().type != ShaderDataType_Float4) {
+    return;
+  }
+  const Shader::UniformHnd handle = shader->FindUniform(kColorUniform);
+  if (fplbase::ValidUniformHandle(handle)) {
+    const mathfu::vec4 value =
+        mathfu::vec4(color->GetData<float>()) * multiplier;
+    GL_CALL(glUniform4fv(fplbase::GlUniformHandle(handle), 1, &value[0]));
+  }
+}
+
 void RenderSystemFpl::DrawMeshFromComponent(const RenderComponent* component) {
   if (component->mesh) {
     component->mesh->Render(&renderer_, blend_mode_);
@@ -1369,7 +1432,7 @@ void RenderSystemFpl::RenderDisplayList(const View& view,
   std::for_each(
       list->begin(), list->end(), [&](const DisplayList::Entry& info) {
         if (info.component) {
-          RenderAt(info.component, info.world_from_entity_matrix, view);
+          RenderAt(info.component, *info.world_from_entity_matrix, view);
         }
       });
 }
@@ -1382,7 +1445,7 @@ void RenderSystemFpl::RenderDisplayListMultiview(
                 [&](const DisplayList::Entry& info) {
                   if (info.component) {
                     RenderAtMultiview(info.component,
-                                      info.world_from_entity_matrix, views);
+                                      *info.world_from_entity_matrix, views);
                   }
                 });
 }
@@ -1392,8 +1455,15 @@ void RenderSystemFpl::RenderComponentsInPass(const View* views,
   pass = FixRenderPass(pass);
   const RenderPool& pool =
       render_component_pools_.GetPool(static_cast<RenderPass>(pass));
-  DisplayList display_list(registry_);
+  auto iter = display_lists_.find(pass);
+  if (iter == display_lists_.end()) {
+    iter = display_lists_.emplace(pass, DisplayList(registry_)).first;
+  }
+  DisplayList& display_list = iter->second;
   display_list.Populate(pool, views, num_views);
+  for (const auto& info : *display_list.GetContents()) {
+    visibility_->MarkVisible(info.entity);
+  }
 
   if (multiview_enabled_) {
     SetViewport(views[0]);
@@ -1797,6 +1867,25 @@ ImageData RenderSystemFpl::GetRenderTargetData(HashValue render_target_name) {
   return ImageData();
 }
 
+void RenderSystemFpl::ReadRenderTargetDataAsync(HashValue render_target_name,
+                                                const mathfu::recti& rect) {
+  LOG(DFATAL)
+      << "ReadRenderTargetDataAsync is not supported with Render System Fpl.";
+}
+
+ImageData RenderSystemFpl::TakeRenderTargetData(HashValue render_target_name) {
+  LOG(DFATAL)
+      << "TakeRenderTargetData is not supported with Render System Fpl.";
+  return ImageData();
+}
+
+void RenderSystemFpl::RequestRenderTargetData(
+    HashValue render_target_name, RenderSystem::RenderTargetDataFn fn,
+    const mathfu::vec2i& size) {
+  LOG(DFATAL)
+      << "RequestRenderTargetData is not supported with Render System Fpl.";
+}
+
 void RenderSystemFpl::Destroy(Entity /*e*/, HashValue pass) {
   LOG(DFATAL) << "This feature is only implemented in RenderSystemNext.";
 }
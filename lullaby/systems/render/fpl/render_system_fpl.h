@@ -27,6 +27,7 @@ limitations under the License.
 #include "lullaby/systems/render/detail/display_list.h"
 #include "lullaby/systems/render/detail/render_pool_map.h"
 #include "lullaby/systems/render/detail/sort_order.h"
+#include "lullaby/systems/render/detail/subtree_color_multipliers.h"
 #include "lullaby/systems/render/fpl/mesh.h"
 #include "lullaby/util/async_processor.h"
 #include "lullaby/generated/render_def_generated.h"
@@ -40,6 +41,9 @@ limitations under the License.
 
 namespace lull {
 
+class RenderOcclusion;
+class RenderVisibility;
+
 // The FPL implementation of RenderSystem.  For documentation of the public
 // functions, refer to the RenderSystem class declaration.
 class RenderSystemFpl : public System {
@@ -93,6 +97,10 @@ class RenderSystemFpl : public System {
 
   bool GetColor(Entity entity, mathfu::vec4* color) const;
   void SetColor(Entity entity, const mathfu::vec4& color);
+  void SetSubtreeColorMultiplier(Entity entity, const mathfu::vec4& multiplier);
+  void ClearSubtreeColorMultiplier(Entity entity);
+  bool GetSubtreeColorMultiplier(Entity entity,
+                                 mathfu::vec4* multiplier) const;
 
   void SetUniform(Entity entity, Optional<HashValue> pass,
                   Optional<int> submesh_index, string_view name,
@@ -220,12 +228,19 @@ class RenderSystemFpl : public System {
   void SetClearParams(HashValue pass, const ClearParams& clear_params);
 
   void SetCullMode(HashValue pass, CullMode mode);
+  void SetInstancingEnabled(HashValue pass, bool enabled);
 
   void SetDefaultFrontFace(FrontFace face);
 
   void SetRenderTarget(HashValue pass, HashValue render_target_name);
 
   ImageData GetRenderTargetData(HashValue render_target_name);
+  void ReadRenderTargetDataAsync(HashValue render_target_name,
+                                 const mathfu::recti& rect);
+  ImageData TakeRenderTargetData(HashValue render_target_name);
+  void RequestRenderTargetData(HashValue render_target_name,
+                               RenderSystem::RenderTargetDataFn fn,
+                               const mathfu::vec2i& size);
 
   void SetDepthTest(const bool enabled);
   void SetDepthWrite(const bool enabled);
@@ -329,6 +344,10 @@ class RenderSystemFpl : public System {
   bool IsReadyToRenderImpl(const RenderComponent& component) const;
   void SetShaderUniforms(const ShaderPtr& shader,
                          const UniformVector& uniforms);
+  // Rebinds the color uniform of |component| scaled by the subtree color
+  // multiplier it inherits, if any.
+  void BindSubtreeColorMultiplier(const ShaderPtr& shader,
+                                  const RenderComponent* component);
   void DrawMeshFromComponent(const RenderComponent* component);
 
   // Thread-specific render API. Holds rendering context.
@@ -336,7 +355,13 @@ class RenderSystemFpl : public System {
   fplbase::Renderer renderer_;
 
   RenderFactory* factory_;
+  // Receives the entities that pass culling each frame.
+  RenderVisibility* visibility_ = nullptr;
+  RenderOcclusion* occlusion_ = nullptr;
   RenderPoolMap render_component_pools_;
+  // The display list of each pass, which are kept so that their buffers and
+  // sorted orders can be reused each frame.
+  std::unordered_map<HashValue, DisplayList> display_lists_;
   fplbase::BlendMode blend_mode_ = fplbase::kBlendModeOff;
   int max_texture_unit_ = 0;
 
@@ -352,6 +377,7 @@ class RenderSystemFpl : public System {
 
   // Stores sort order offsets and calculates sort orders.
   detail::SortOrderManager sort_order_manager_;
+  detail::SubtreeColorMultipliers subtree_color_multipliers_;
 
   // This lets us know if can skip ResetState() when we're about to start a
   // render pass.
@@ -0,0 +1,57 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/draw_commands.h"
+
+namespace lull {
+
+void RecordDrawCommands(size_t num_objects, bool use_instancing,
+                        const std::function<size_t(size_t)>& count_instanceable,
+                        std::vector<DrawCommand>* draws) {
+  draws->clear();
+  size_t index = 0;
+  while (index < num_objects) {
+    const size_t count = use_instancing ? count_instanceable(index) : 1;
+    DrawCommand draw;
+    draw.index = static_cast<uint32_t>(index);
+    draw.count = static_cast<uint32_t>(count);
+    draws->push_back(draw);
+    index += count;
+  }
+}
+
+void RecordConcurrently(JobProcessor* job_processor, size_t count,
+                        const std::function<void(size_t)>& record) {
+  if (job_processor == nullptr || job_processor->GetNumWorkerThreads() == 0 ||
+      count < 2) {
+    for (size_t i = 0; i < count; ++i) {
+      record(i);
+    }
+    return;
+  }
+
+  std::vector<JobProcessor::JobHandle> jobs;
+  jobs.reserve(count - 1);
+  for (size_t i = 1; i < count; ++i) {
+    jobs.push_back(job_processor->Run([&record, i]() { record(i); }));
+  }
+  record(0);
+  for (const JobProcessor::JobHandle& job : jobs) {
+    job_processor->Wait(job);
+  }
+}
+
+}  // namespace lull
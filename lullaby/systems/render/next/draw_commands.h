@@ -0,0 +1,53 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_NEXT_DRAW_COMMANDS_H_
+#define LULLABY_SYSTEMS_RENDER_NEXT_DRAW_COMMANDS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+#include "lullaby/util/job_processor.h"
+
+namespace lull {
+
+// A single draw of |count| consecutive objects starting at |index|.  Draws of
+// more than one object are instanced.
+struct DrawCommand {
+  uint32_t index = 0;
+  uint32_t count = 0;
+};
+
+// Fills |draws| with the draws needed to render |num_objects| objects.  If
+// |use_instancing|, |count_instanceable| is called with the index of the first
+// object of each draw and returns how many consecutive objects (at least one)
+// can be drawn together with it.  Otherwise each object gets its own draw.
+void RecordDrawCommands(size_t num_objects, bool use_instancing,
+                        const std::function<size_t(size_t)>& count_instanceable,
+                        std::vector<DrawCommand>* draws);
+
+// Calls |record| with each index in [0, |count|) and returns once all the
+// calls are done.  The calls are spread over the worker threads of the
+// |job_processor|, if there is one with workers, and the calling thread takes
+// part.  Otherwise they are made in order on the calling thread.
+void RecordConcurrently(JobProcessor* job_processor, size_t count,
+                        const std::function<void(size_t)>& record);
+
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_RENDER_NEXT_DRAW_COMMANDS_H_
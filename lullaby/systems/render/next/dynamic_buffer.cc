@@ -0,0 +1,55 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/dynamic_buffer.h"
+
+#include <algorithm>
+
+namespace lull {
+
+DynamicBuffer::Upload DynamicBuffer::Update(const uint8_t* data, size_t size) {
+  Upload upload;
+  if (size > capacity_) {
+    capacity_ = std::max(size, capacity_ * 2);
+    upload.type = Upload::kReallocate;
+    upload.size = size;
+  } else if (size > 0) {
+    // Find the range of bytes that differ from the current contents.  Bytes
+    // beyond the previous size are always considered changed.
+    const size_t common = std::min(size, contents_.size());
+    const size_t begin =
+        std::mismatch(data, data + common, contents_.begin()).first - data;
+    size_t end = size;
+    if (size <= contents_.size()) {
+      while (end > begin && data[end - 1] == contents_[end - 1]) {
+        --end;
+      }
+    }
+
+    if (end - begin > size / 2) {
+      upload.type = Upload::kOrphan;
+      upload.size = size;
+    } else if (end > begin) {
+      upload.type = Upload::kPartial;
+      upload.offset = begin;
+      upload.size = end - begin;
+    }
+  }
+  contents_.assign(data, data + size);
+  return upload;
+}
+
+}  // namespace lull
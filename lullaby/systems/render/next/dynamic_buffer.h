@@ -0,0 +1,70 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_NEXT_DYNAMIC_BUFFER_H_
+#define LULLABY_SYSTEMS_RENDER_NEXT_DYNAMIC_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace lull {
+
+// Decides how to upload new contents to a frequently updated GPU buffer,
+// independently of GL.  It keeps a CPU copy of the contents and the size of
+// the GPU allocation.
+class DynamicBuffer {
+ public:
+  // How to upload the new contents.
+  struct Upload {
+    enum Type {
+      // Nothing changed.
+      kNone,
+      // The contents no longer fit, so the storage must be reallocated with
+      // GetCapacity() bytes.
+      kReallocate,
+      // Most of the contents changed, so the storage should be orphaned (ie.
+      // reallocated with GetCapacity() bytes) so that the driver need not wait
+      // for the GPU to finish reading the previous contents.
+      kOrphan,
+      // Only part of the contents changed, and can be uploaded into the
+      // existing storage.
+      kPartial,
+    };
+
+    Type type = kNone;
+    // The range of bytes to upload.
+    size_t offset = 0;
+    size_t size = 0;
+  };
+
+  // Replaces the contents with |size| bytes of |data| and returns how to
+  // upload them.
+  Upload Update(const uint8_t* data, size_t size);
+
+  // Returns the size of the GPU allocation, in bytes.  It grows geometrically
+  // so that buffers which grow a little at a time (eg. text being typed) are
+  // not reallocated on every change.
+  size_t GetCapacity() const { return capacity_; }
+
+ private:
+  size_t capacity_ = 0;
+  std::vector<uint8_t> contents_;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_RENDER_NEXT_DYNAMIC_BUFFER_H_
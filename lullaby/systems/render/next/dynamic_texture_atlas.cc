@@ -0,0 +1,201 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/dynamic_texture_atlas.h"
+
+#include <algorithm>
+#include <string>
+
+#include "lullaby/modules/render/image_util.h"
+#include "lullaby/systems/render/next/detail/glplatform.h"
+#include "lullaby/systems/render/next/texture_factory.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+namespace {
+bool IsClamped(TextureWrap wrap) {
+  return wrap == TextureWrap_ClampToEdge || wrap == TextureWrap_ClampToBorder;
+}
+}  // namespace
+
+DynamicTextureAtlas::DynamicTextureAtlas(TextureFactoryImpl* texture_factory,
+                                         const Params& params)
+    : texture_factory_(texture_factory), params_(params) {}
+
+bool DynamicTextureAtlas::CanAdd(const ImageData& image,
+                                 const TextureParams& params) const {
+  if (params.generate_mipmaps || params.is_cubemap ||
+      !IsClamped(params.wrap_s) || !IsClamped(params.wrap_t)) {
+    return false;
+  }
+  if (image.GetFormat() != ImageData::kRgba8888 &&
+      image.GetFormat() != ImageData::kRgb888) {
+    return false;
+  }
+  if (image.IsEmpty() || image.GetBytes() == nullptr) {
+    return false;
+  }
+  const mathfu::vec2i size = image.GetSize();
+  const int padding = 2 * params_.padding;
+  const int max_x = std::min(params_.max_image_size,
+                             params_.page_size.x - padding);
+  const int max_y = std::min(params_.max_image_size,
+                             params_.page_size.y - padding);
+  return size.x <= max_x && size.y <= max_y;
+}
+
+bool DynamicTextureAtlas::Add(HashValue name, const TexturePtr& texture,
+                              const ImageData& image) {
+  const mathfu::vec2i padded_size =
+      image.GetSize() + mathfu::vec2i(2 * params_.padding, 2 * params_.padding);
+  mathfu::vec2i pos(0, 0);
+  int index = FindSpace(padded_size, &pos);
+  if (index < 0) {
+    index = static_cast<int>(pages_.size()) < params_.max_pages ? CreatePage()
+                                                                : EvictPage();
+    if (index < 0 || !pages_[index].packer.Pack(padded_size, &pos)) {
+      return false;
+    }
+  }
+
+  Page& page = pages_[index];
+  pos += mathfu::vec2i(params_.padding, params_.padding);
+  Upload(page, pos, image);
+
+  const mathfu::vec2 page_size(params_.page_size);
+  const mathfu::vec2 min = mathfu::vec2(pos) / page_size;
+  const mathfu::vec2 size = mathfu::vec2(image.GetSize()) / page_size;
+  texture->Init(page.texture, mathfu::vec4(min.x, min.y, size.x, size.y));
+
+  page.images.emplace_back(name, texture);
+  page.last_used = ++clock_;
+  page_indices_[name] = index;
+  return true;
+}
+
+void DynamicTextureAtlas::Touch(HashValue name) {
+  auto iter = page_indices_.find(name);
+  if (iter != page_indices_.end()) {
+    pages_[iter->second].last_used = ++clock_;
+  }
+}
+
+int DynamicTextureAtlas::FindSpace(const mathfu::vec2i& size,
+                                   mathfu::vec2i* pos) {
+  // Prefer the most recently used pages, which are the least likely to be
+  // evicted.
+  int best = -1;
+  for (int i = 0; i < static_cast<int>(pages_.size()); ++i) {
+    if (best < 0 || pages_[i].last_used > pages_[best].last_used) {
+      best = i;
+    }
+  }
+  if (best >= 0 && pages_[best].packer.Pack(size, pos)) {
+    return best;
+  }
+  for (int i = 0; i < static_cast<int>(pages_.size()); ++i) {
+    if (i != best && pages_[i].packer.Pack(size, pos)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int DynamicTextureAtlas::CreatePage() {
+  TextureParams params;
+  params.format = ImageData::kRgba8888;
+  params.min_filter = TextureFiltering_Linear;
+  params.mag_filter = TextureFiltering_Linear;
+  params.wrap_s = TextureWrap_ClampToEdge;
+  params.wrap_t = TextureWrap_ClampToEdge;
+  params.generate_mipmaps = false;
+
+  Page page(params_.page_size);
+  page.texture = texture_factory_->CreateTexture(params_.page_size, params);
+  if (!page.texture) {
+    return -1;
+  }
+  page.texture->SetName("dynamic atlas page " +
+                        std::to_string(pages_.size()));
+  pages_.emplace_back(std::move(page));
+  return static_cast<int>(pages_.size()) - 1;
+}
+
+int DynamicTextureAtlas::EvictPage() {
+  // Pages with images that are still referenced cannot be cleared, since those
+  // objects would start sampling whatever replaces them.
+  int lru = -1;
+  for (int i = 0; i < static_cast<int>(pages_.size()); ++i) {
+    const Page& page = pages_[i];
+    bool in_use = false;
+    for (const auto& image : page.images) {
+      if (image.second.use_count() > 1) {
+        in_use = true;
+        break;
+      }
+    }
+    if (!in_use && (lru < 0 || page.last_used < pages_[lru].last_used)) {
+      lru = i;
+    }
+  }
+  if (lru < 0) {
+    return -1;
+  }
+
+  Page& page = pages_[lru];
+  for (const auto& image : page.images) {
+    auto iter = page_indices_.find(image.first);
+    if (iter != page_indices_.end() && iter->second == lru) {
+      page_indices_.erase(iter);
+    }
+  }
+  page.images.clear();
+  page.packer.Reset();
+  return lru;
+}
+
+void DynamicTextureAtlas::Upload(const Page& page, const mathfu::vec2i& pos,
+                                 const ImageData& image) {
+  const mathfu::vec2i size = image.GetSize();
+  const uint8_t* pixels = image.GetBytes();
+  int alignment = image.GetRowAlignment();
+  int row_length = image.GetStrideInPixels();
+
+  // Pages are RGBA, so expand RGB images first.
+  std::vector<uint8_t> rgba;
+  if (image.GetFormat() == ImageData::kRgb888) {
+    rgba.resize(4 * size.x * size.y);
+    for (int y = 0; y < size.y; ++y) {
+      ConvertRgb888ToRgba8888(pixels + y * image.GetStride(),
+                              mathfu::vec2i(size.x, 1),
+                              rgba.data() + 4 * y * size.x);
+    }
+    pixels = rgba.data();
+    alignment = 4;
+    row_length = 0;
+  }
+
+  GL_CALL(glActiveTexture(GL_TEXTURE0));
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, *page.texture->GetResourceId()));
+  GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, alignment));
+  GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length));
+  GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y,
+                          GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+  GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+  GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+}
+
+}  // namespace lull
@@ -0,0 +1,110 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_NEXT_DYNAMIC_TEXTURE_ATLAS_H_
+#define LULLABY_SYSTEMS_RENDER_NEXT_DYNAMIC_TEXTURE_ATLAS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "lullaby/modules/render/image_data.h"
+#include "lullaby/modules/render/skyline_packer.h"
+#include "lullaby/modules/render/texture_params.h"
+#include "lullaby/systems/render/next/texture.h"
+#include "lullaby/util/hash.h"
+#include "mathfu/glsl_mappings.h"
+
+namespace lull {
+
+class TextureFactoryImpl;
+
+// Packs small images into shared texture pages at runtime, so that many
+// objects (eg. UI icons) sample from the same GL texture.
+//
+// Each image becomes a subtexture of a page, so its UVs are remapped by the
+// "uv_bounds" uniform like the subtextures of prebuilt atlases.  Pages are
+// packed with a SkylinePacker, which cannot free individual images, so when
+// all pages are full the least recently used page whose images are no longer
+// referenced outside the atlas is cleared and reused.
+class DynamicTextureAtlas {
+ public:
+  struct Params {
+    // The size of each page.
+    mathfu::vec2i page_size = {1024, 1024};
+    // The maximum number of pages to allocate.
+    int max_pages = 4;
+    // Images larger than this in either dimension are not atlased.
+    int max_image_size = 128;
+    // Empty texels around each image to keep filtering from bleeding between
+    // neighbours.
+    int padding = 1;
+  };
+
+  DynamicTextureAtlas(TextureFactoryImpl* texture_factory,
+                      const Params& params);
+
+  DynamicTextureAtlas(const DynamicTextureAtlas&) = delete;
+  DynamicTextureAtlas& operator=(const DynamicTextureAtlas&) = delete;
+
+  // Returns true if an |image| created with |params| can be atlased.  This
+  // requires a small uncompressed 2D RGB or RGBA image without mipmaps that is
+  // clamped rather than repeated, since its UVs are confined to the page.
+  bool CanAdd(const ImageData& image, const TextureParams& params) const;
+
+  // Copies |image| into a page and initializes |texture| as a subtexture of it.
+  // The atlas keeps |texture| alive until its page is evicted.  Returns false
+  // if there is no space, in which case |texture| is left untouched.
+  bool Add(HashValue name, const TexturePtr& texture, const ImageData& image);
+
+  // Marks the image called |name| (if any) as recently used.
+  void Touch(HashValue name);
+
+  // Returns the number of allocated pages.
+  size_t GetNumPages() const { return pages_.size(); }
+
+  // Returns the number of images in all pages.
+  size_t GetNumImages() const { return page_indices_.size(); }
+
+ private:
+  struct Page {
+    explicit Page(const mathfu::vec2i& size) : packer(size) {}
+
+    TexturePtr texture;
+    SkylinePacker packer;
+    std::vector<std::pair<HashValue, TexturePtr>> images;
+    uint64_t last_used = 0;
+  };
+
+  // Returns the index of a page with space for |size| and sets |pos| to the
+  // reserved space, or returns -1 if there is none.
+  int FindSpace(const mathfu::vec2i& size, mathfu::vec2i* pos);
+  int CreatePage();
+  int EvictPage();
+  void Upload(const Page& page, const mathfu::vec2i& pos,
+              const ImageData& image);
+
+  TextureFactoryImpl* texture_factory_;
+  const Params params_;
+  std::vector<Page> pages_;
+  std::unordered_map<HashValue, int> page_indices_;
+  uint64_t clock_ = 0;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_RENDER_NEXT_DYNAMIC_TEXTURE_ATLAS_H_
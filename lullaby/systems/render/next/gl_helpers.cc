@@ -204,6 +204,14 @@ GLenum GetGlVertexType(VertexAttributeType type) {
       return GL_UNSIGNED_SHORT;
     case VertexAttributeType_Vec4ub:
       return GL_UNSIGNED_BYTE;
+    case VertexAttributeType_Vec2hf:
+    case VertexAttributeType_Vec4hf:
+#ifdef GL_HALF_FLOAT
+      return GL_HALF_FLOAT;
+#else
+      LOG(DFATAL) << "Half-float vertex attributes are not supported.";
+      return GL_FLOAT;
+#endif
     default:
       LOG(DFATAL) << "Unknown vertex attribute type.";
       return GL_UNSIGNED_BYTE;
@@ -226,6 +234,10 @@ GLint GetNumElementsInVertexType(VertexAttributeType type) {
       return 4;
     case VertexAttributeType_Vec4ub:
       return 4;
+    case VertexAttributeType_Vec2hf:
+      return 2;
+    case VertexAttributeType_Vec4hf:
+      return 4;
     default:
       LOG(DFATAL) << "Unknown vertex attribute type.";
       return 0;
@@ -410,7 +422,9 @@ void SetVertexAttributes(const VertexFormat& vertex_format,
       case VertexAttributeUsage_TexCoord:
         DCHECK(kAttribTexCoord + tex_coord_count < kAttribTexCoordMax);
         location = kAttribTexCoord + tex_coord_count;
-        normalized = (gl_type != GL_FLOAT);
+        // Integer texture coordinates are unorm values.
+        normalized =
+            (gl_type == GL_UNSIGNED_SHORT || gl_type == GL_UNSIGNED_BYTE);
         ++tex_coord_count;
         break;
       default:
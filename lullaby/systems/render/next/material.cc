@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "lullaby/systems/render/next/material.h"
 
+#include <cstring>
 #include <utility>
 
 #include "lullaby/generated/flatbuffers/render_state_def_generated.h"
@@ -28,12 +29,16 @@ limitations under the License.
 
 namespace lull {
 
-void Material::SetShader(const ShaderPtr& shader) { shader_ = shader; }
+void Material::SetShader(const ShaderPtr& shader) {
+  shader_ = shader;
+  ++state_version_;
+}
 
 const ShaderPtr& Material::GetShader() const { return shader_; }
 
 void Material::SetTexture(TextureUsageInfo usage, const TexturePtr& texture) {
   textures_[usage] = texture;
+  ++state_version_;
 }
 
 TexturePtr Material::GetTexture(TextureUsageInfo usage) const {
@@ -43,7 +48,9 @@ TexturePtr Material::GetTexture(TextureUsageInfo usage) const {
 
 void Material::SetUniform(HashValue name, ShaderDataType type,
                           Span<uint8_t> data) {
-  uniforms_[name].SetData(type, data);
+  Uniform& uniform = uniforms_[name];
+  uniform.SetData(type, data);
+  uniform.SetVersion(++uniforms_version_);
 }
 
 const detail::UniformData* Material::GetUniformData(HashValue name) const {
@@ -142,14 +149,23 @@ bool Material::IsLoaded() const {
   return true;
 }
 
-void Material::Bind() {
+void Material::Bind(UniformBufferRing* ring) {
   if (shader_ == nullptr) {
     return;
   }
 
   for (auto& iter : uniforms_) {
     if (shader_->IsUniformBlock(iter.first)) {
-      shader_->BindUniformBlock(iter.first, iter.second.UniformBuffer());
+      Uniform& uniform = iter.second;
+      if (ring && uniform.IsStreaming()) {
+        const UniformBufferRing::Range range = uniform.RingRange(ring);
+        if (range.buffer) {
+          shader_->BindUniformBlockRange(iter.first, range.buffer, range.offset,
+                                         range.size);
+          continue;
+        }
+      }
+      shader_->BindUniformBlock(iter.first, uniform.UniformBuffer());
     } else {
       shader_->BindUniform(iter.first, iter.second.Type(), iter.second.Data());
     }
@@ -182,12 +198,86 @@ void Material::CopyUniforms(const Material& rhs) {
   }
 }
 
+void Material::UpdateSnapshot(const Material& source) {
+  if (snapshot_state_version_ != source.state_version_) {
+    hidden_ = source.hidden_;
+    shader_ = source.shader_;
+    textures_ = source.textures_;
+    requested_shader_features_ = source.requested_shader_features_;
+    blend_state_ = source.blend_state_;
+    cull_state_ = source.cull_state_;
+    depth_state_ = source.depth_state_;
+    point_state_ = source.point_state_;
+    stencil_state_ = source.stencil_state_;
+    snapshot_state_version_ = source.state_version_;
+  }
+
+  if (snapshot_uniforms_version_ != source.uniforms_version_) {
+    // Only the uniforms set since the last update are copied, so only their
+    // uniform buffers are uploaded again when the snapshot is bound.
+    for (const auto& iter : source.uniforms_) {
+      if (iter.second.Version() > snapshot_uniforms_version_) {
+        uniforms_[iter.first].SetData(iter.second.Type(), iter.second.Data());
+      }
+    }
+    snapshot_uniforms_version_ = source.uniforms_version_;
+  }
+}
+
+bool Material::IsInstanceCompatible(const Material& rhs,
+                                    HashValue per_instance_uniform) const {
+  if (this == &rhs) {
+    return true;
+  }
+  if (shader_ != rhs.shader_ || hidden_ != rhs.hidden_) {
+    return false;
+  }
+  if (HasRenderStateOverrides() || rhs.HasRenderStateOverrides()) {
+    return false;
+  }
+  if (textures_ != rhs.textures_) {
+    return false;
+  }
+
+  // Every shared uniform must match, except the one that is provided per
+  // instance, which may also be missing from either material.
+  for (const auto& iter : uniforms_) {
+    if (iter.first == per_instance_uniform) {
+      continue;
+    }
+    auto other = rhs.uniforms_.find(iter.first);
+    if (other == rhs.uniforms_.end()) {
+      return false;
+    }
+    const Span<uint8_t> data = iter.second.Data();
+    const Span<uint8_t> other_data = other->second.Data();
+    if (iter.second.Type() != other->second.Type() ||
+        data.size() != other_data.size() ||
+        memcmp(data.data(), other_data.data(), data.size()) != 0) {
+      return false;
+    }
+  }
+  for (const auto& iter : rhs.uniforms_) {
+    if (iter.first != per_instance_uniform &&
+        uniforms_.find(iter.first) == uniforms_.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Material::HasRenderStateOverrides() const {
+  return blend_state_ || cull_state_ || depth_state_ || point_state_ ||
+         stencil_state_;
+}
+
 void Material::SetBlendState(const BlendStateT* blend_state) {
   if (blend_state) {
     blend_state_ = *blend_state;
   } else {
     blend_state_.reset();
   }
+  ++state_version_;
 }
 
 void Material::SetCullState(const CullStateT* cull_state) {
@@ -196,6 +286,7 @@ void Material::SetCullState(const CullStateT* cull_state) {
   } else {
     cull_state_.reset();
   }
+  ++state_version_;
 }
 
 void Material::SetDepthState(const DepthStateT* depth_state) {
@@ -204,6 +295,7 @@ void Material::SetDepthState(const DepthStateT* depth_state) {
   } else {
     depth_state_.reset();
   }
+  ++state_version_;
 }
 
 void Material::SetPointState(const PointStateT* point_state) {
@@ -212,6 +304,7 @@ void Material::SetPointState(const PointStateT* point_state) {
   } else {
     point_state_.reset();
   }
+  ++state_version_;
 }
 
 void Material::SetStencilState(const StencilStateT* stencil_state) {
@@ -220,6 +313,7 @@ void Material::SetStencilState(const StencilStateT* stencil_state) {
   } else {
     stencil_state_.reset();
   }
+  ++state_version_;
 }
 
 const BlendStateT* Material::GetBlendState() const {
@@ -242,10 +336,12 @@ const StencilStateT* Material::GetStencilState() const {
 
 void Material::RequestShaderFeature(HashValue feature) {
   requested_shader_features_.insert(feature);
+  ++state_version_;
 }
 
 void Material::ClearShaderFeature(HashValue feature) {
   requested_shader_features_.erase(feature);
+  ++state_version_;
 }
 
 bool Material::IsShaderFeatureRequested(HashValue feature) const {
@@ -288,7 +384,11 @@ const detail::UniformData& Material::Uniform::GetUniformDataObject() const {
 
 void Material::Uniform::SetData(ShaderDataType type, Span<uint8_t> data) {
   uniform_data_.SetData(type, data);
+  if (ubo_.Valid() || ring_range_.buffer) {
+    streaming_ = true;
+  }
   dirty_ = true;
+  ring_range_ = UniformBufferRing::Range();
 }
 
 UniformBufferHnd Material::Uniform::UniformBuffer() {
@@ -316,9 +416,25 @@ UniformBufferHnd Material::Uniform::UniformBuffer() {
     ubo_size_ = data.size();
   }
   GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+  dirty_ = false;
   return ubo_;
 }
 
+UniformBufferRing::Range Material::Uniform::RingRange(UniformBufferRing* ring) {
+  // Data written to the ring is only valid for the frame it was written in.
+  if (ring_range_.buffer && ring_frame_id_ == ring->GetFrameId()) {
+    return ring_range_;
+  }
+
+  ring_range_ = ring->Write(Data());
+  ring_frame_id_ = ring->GetFrameId();
+  if (ring_range_.buffer) {
+    // The uniform's own buffer is no longer needed while it is streaming.
+    DestroyUbo();
+  }
+  return ring_range_;
+}
+
 void Material::Uniform::DestroyUbo() {
   if (ubo_.Valid()) {
     GLuint gl_ubo = *ubo_;
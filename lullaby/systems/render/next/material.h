@@ -26,6 +26,7 @@ limitations under the License.
 #include "lullaby/modules/render/material_info.h"
 #include "lullaby/systems/render/next/render_handle.h"
 #include "lullaby/systems/render/next/render_state.h"
+#include "lullaby/systems/render/next/uniform_buffer_ring.h"
 #include "lullaby/systems/render/shader.h"
 #include "lullaby/systems/render/texture.h"
 #include "lullaby/util/enum_hash.h"
@@ -44,8 +45,14 @@ class Material {
  public:
   Material() {}
 
-  void Show() { hidden_ = false; }
-  void Hide() { hidden_ = true; }
+  void Show() {
+    hidden_ = false;
+    ++state_version_;
+  }
+  void Hide() {
+    hidden_ = true;
+    ++state_version_;
+  }
   bool IsHidden() const { return hidden_; }
 
   /// Sets the material's shader.
@@ -60,6 +67,16 @@ class Material {
   /// Returns a texture associated with a TextureUsageInfo.
   TexturePtr GetTexture(TextureUsageInfo usage) const;
 
+  /// Calls |fn| with each texture set on the material.
+  template <typename Fn>
+  void ForEachTexture(const Fn& fn) const {
+    for (const auto& iter : textures_) {
+      if (iter.second) {
+        fn(iter.second);
+      }
+    }
+  }
+
   /// Sets a uniform, replacing the existing one.
   template <typename T>
   void SetUniform(HashValue name, ShaderDataType type, Span<T> data);
@@ -79,13 +96,28 @@ class Material {
   /// Copies the uniforms the |rhs| into this material.
   void CopyUniforms(const Material& rhs);
 
+  /// Makes this material a copy of |source| that can be bound on the render
+  /// thread while |source| is modified on another thread.  Only the state and
+  /// uniforms that changed since the previous call are copied, so the same
+  /// |source| must be used for every call.
+  void UpdateSnapshot(const Material& source);
+
+  /// Returns true if this material and |rhs| can be drawn together in a single
+  /// instanced draw call.  This requires the same shader and textures, and the
+  /// same data for every uniform other than |per_instance_uniform|.  Materials
+  /// that override any render state are never considered compatible with a
+  /// different material.
+  bool IsInstanceCompatible(const Material& rhs,
+                            HashValue per_instance_uniform) const;
+
   /// Returns true if the shader and textures for this material have been loaded
   /// into OpenGL.
   bool IsLoaded() const;
 
   /// Binds the uniforms and samplers to the shader and prepares textures for
-  /// rendering.
-  void Bind();
+  /// rendering.  If |ring| is provided, uniform blocks that are updated
+  /// repeatedly are written into it rather than into their own buffers.
+  void Bind(UniformBufferRing* ring = nullptr);
 
   /// Sets the blend state associated with the material. If |nullptr|, the blend
   /// state will be unset.
@@ -149,6 +181,7 @@ class Material {
   void SetIsOpaque(bool is_opaque);
   void SetDoubleSided(bool double_sided);
   void BindDefaultUniformValues();
+  bool HasRenderStateOverrides() const;
 
   /// Stores the data for single uniform instance.
   class Uniform {
@@ -162,6 +195,19 @@ class Material {
     ShaderDataType Type() const;
     UniformBufferHnd UniformBuffer();
 
+    // Returns the range of |ring| holding the uniform's data for the current
+    // frame, writing it if needed.  Returns an invalid range if the ring is
+    // full.
+    UniformBufferRing::Range RingRange(UniformBufferRing* ring);
+
+    // Returns true if the data has changed after it was first uploaded, in
+    // which case it is expected to keep changing.
+    bool IsStreaming() const { return streaming_; }
+
+    // The value of the material's |uniforms_version_| when the data was set.
+    uint64_t Version() const { return version_; }
+    void SetVersion(uint64_t version) { version_ = version; }
+
     const detail::UniformData& GetUniformDataObject() const;
 
    private:
@@ -171,6 +217,10 @@ class Material {
     UniformBufferHnd ubo_;
     size_t ubo_size_ = 0;
     bool dirty_ = true;
+    bool streaming_ = false;
+    UniformBufferRing::Range ring_range_;
+    uint64_t ring_frame_id_ = 0;
+    uint64_t version_ = 0;
   };
 
   using FeatureSet = std::unordered_set<HashValue>;
@@ -184,6 +234,14 @@ class Material {
   TextureMap textures_;
   FeatureSet requested_shader_features_;
 
+  // Incremented whenever a uniform is set, or any other state is changed.
+  // They start at 1 so that the first UpdateSnapshot() copies everything.
+  uint64_t uniforms_version_ = 1;
+  uint64_t state_version_ = 1;
+  // The versions of the source material copied by UpdateSnapshot().
+  uint64_t snapshot_uniforms_version_ = 0;
+  uint64_t snapshot_state_version_ = 0;
+
   // Render State.
   Optional<BlendStateT> blend_state_;
   Optional<CullStateT> cull_state_;
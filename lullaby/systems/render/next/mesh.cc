@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "lullaby/systems/render/next/mesh.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "lullaby/systems/render/next/detail/glplatform.h"
@@ -54,6 +55,28 @@ void Mesh::Init(const MeshData* mesh_datas, size_t len) {
   on_load_callbacks_.clear();
 }
 
+void Mesh::InitDynamic(const MeshData& mesh_data) {
+  if (mesh_data.GetNumSubMeshes() > 1) {
+    LOG(DFATAL) << "Dynamic meshes cannot have multiple submeshes.";
+  }
+  dynamic_ = true;
+  Init(&mesh_data, 1);
+}
+
+bool Mesh::UpdateDynamic(const MeshData& mesh_data) {
+  if (!dynamic_ || submeshes_.size() != 1 || mesh_data.GetNumVertices() == 0 ||
+      mesh_data.GetNumSubMeshes() > 1 ||
+      mesh_data.GetVertexFormat() != submeshes_[0].vertex_format) {
+    return false;
+  }
+  // An index buffer can't be added to a mesh that was created without one.
+  if (mesh_data.GetIndexBytes() && submeshes_[0].ibo_index < 0) {
+    return false;
+  }
+  ReplaceSubmesh(0, mesh_data);
+  return true;
+}
+
 void Mesh::CreateSubmeshes(const MeshData& mesh) {
   // Configure global mesh properties, primarily used for profiling.
   num_vertices_ += mesh.GetNumVertices();
@@ -136,7 +159,6 @@ void Mesh::ReplaceSubmesh(size_t index, const MeshData& mesh) {
       MeshData::GetNumPrimitives(mesh.GetPrimitiveType(), mesh.GetNumIndices());
 
   // Reconfigure the specific Submesh.
-  submesh.vertex_format = mesh.GetVertexFormat();
   submesh.primitive_type = mesh.GetPrimitiveType();
   submesh.index_type = mesh.GetIndexType();
   submesh.num_vertices = mesh.GetNumVertices();
@@ -154,10 +176,17 @@ void Mesh::ReplaceSubmesh(size_t index, const MeshData& mesh) {
     }
   }
 
-  // Instead of allocating new buffers, just re-fill the existing ones.
+  // Instead of allocating new buffers, just re-fill the existing ones.  The
+  // vertex array only needs to be rebuilt if the vertex format changed.
+  const bool format_changed = submesh.vertex_format != mesh.GetVertexFormat();
+  submesh.vertex_format = mesh.GetVertexFormat();
   FillVbo(submesh.vbo_index, mesh);
-  FillVao(submesh.vao_index, mesh, submesh.vbo_index);
-  FillIbo(submesh.ibo_index, mesh);
+  if (format_changed && submesh.vao_index >= 0) {
+    FillVao(submesh.vao_index, mesh, submesh.vbo_index);
+  }
+  if (submesh.ibo_index >= 0 || mesh.GetIndexBytes()) {
+    FillIbo(submesh.ibo_index, mesh);
+  }
 
   // Recompute the Aabb.
   aabb_ = Aabb(mathfu::vec3(std::numeric_limits<float>::max()),
@@ -193,17 +222,21 @@ Aabb Mesh::GetSubmeshAabb(size_t index) const {
   }
 }
 
-void Mesh::Render() {
+void Mesh::Render() { RenderInstanced(1); }
+
+void Mesh::RenderSubmesh(size_t index) { RenderSubmeshInstanced(index, 1); }
+
+void Mesh::RenderInstanced(int instance_count) {
   if (!IsLoaded()) {
     return;
   }
 
   for (size_t i = 0; i < submeshes_.size(); ++i) {
-    RenderSubmesh(i);
+    RenderSubmeshInstanced(i, instance_count);
   }
 }
 
-void Mesh::RenderSubmesh(size_t index) {
+void Mesh::RenderSubmeshInstanced(size_t index, int instance_count) {
   if (!IsLoaded()) {
     return;
   }
@@ -216,28 +249,47 @@ void Mesh::RenderSubmesh(size_t index) {
   const auto& submesh = submeshes_[index];
   BindAttributes(submesh);
   if (submesh.ibo_index == -1) {
-    DrawArrays(submesh);
+    DrawArrays(submesh, instance_count);
   } else {
-    DrawElements(submesh);
+    DrawElements(submesh, instance_count);
   }
   UnbindAttributes(submesh);
 }
 
-void Mesh::DrawArrays(const Submesh& submesh) {
+void Mesh::DrawArrays(const Submesh& submesh, int instance_count) {
   const GLenum gl_mode = GetGlPrimitiveType(submesh.primitive_type);
-  GL_CALL(glDrawArrays(gl_mode, 0, static_cast<int32_t>(submesh.num_vertices)));
+  const int32_t num_vertices = static_cast<int32_t>(submesh.num_vertices);
+  if (instance_count > 1) {
+// Instanced draws are part of GLES3 & GL3.1 specs.
+#if GL_ES_VERSION_3_0 || defined(GL_VERSION_3_1)
+    GL_CALL(glDrawArraysInstanced(gl_mode, 0, num_vertices, instance_count));
+#else
+    LOG(DFATAL) << "Instanced rendering is not supported.";
+#endif  // GL_ES_VERSION_3_0 || GL_VERSION_3_1
+  } else {
+    GL_CALL(glDrawArrays(gl_mode, 0, num_vertices));
+  }
 }
 
-void Mesh::DrawElements(const Submesh& submesh) {
+void Mesh::DrawElements(const Submesh& submesh, int instance_count) {
   const GLenum gl_mode = GetGlPrimitiveType(submesh.primitive_type);
   const GLenum gl_type = GetGlIndexType(submesh.index_type);
+  const int32_t num_indices = static_cast<int32_t>(
+      submesh.index_range.end - submesh.index_range.start);
   const void* offset = reinterpret_cast<void*>(
       MeshData::GetIndexSize(submesh.index_type) * submesh.index_range.start);
 
   GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *ibos_[submesh.ibo_index]));
-  GL_CALL(glDrawElements(gl_mode,
-                         submesh.index_range.end - submesh.index_range.start,
-                         gl_type, offset));
+  if (instance_count > 1) {
+#if GL_ES_VERSION_3_0 || defined(GL_VERSION_3_1)
+    GL_CALL(glDrawElementsInstanced(gl_mode, num_indices, gl_type, offset,
+                                    instance_count));
+#else
+    LOG(DFATAL) << "Instanced rendering is not supported.";
+#endif  // GL_ES_VERSION_3_0 || GL_VERSION_3_1
+  } else {
+    GL_CALL(glDrawElements(gl_mode, num_indices, gl_type, offset));
+  }
   GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 }
 
@@ -283,6 +335,11 @@ void Mesh::FillVbo(int vbo_index, const MeshData& mesh) {
   const size_t vbo_size =
       mesh.GetVertexFormat().GetVertexSize() * mesh.GetNumVertices();
   const GLuint gl_vbo = vbos_[vbo_index].Get();
+  if (dynamic_) {
+    UploadDynamicBuffer(GL_ARRAY_BUFFER, gl_vbo, mesh.GetVertexBytes(),
+                        vbo_size, &dynamic_vbo_);
+    return;
+  }
   GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, gl_vbo));
   GL_CALL(glBufferData(GL_ARRAY_BUFFER, vbo_size, mesh.GetVertexBytes(),
                        GL_STATIC_DRAW));
@@ -343,12 +400,35 @@ void Mesh::FillIbo(int ibo_index, const MeshData& mesh) {
   }
   const GLuint gl_ibo = ibos_[ibo_index].Get();
   const size_t ibo_size = mesh.GetIndexSize() * mesh.GetNumIndices();
+  if (dynamic_) {
+    UploadDynamicBuffer(GL_ELEMENT_ARRAY_BUFFER, gl_ibo, mesh.GetIndexBytes(),
+                        ibo_size, &dynamic_ibo_);
+    return;
+  }
   GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl_ibo));
   GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, ibo_size, mesh.GetIndexBytes(),
                        GL_STATIC_DRAW));
   GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 }
 
+void Mesh::UploadDynamicBuffer(uint32_t target, uint32_t buffer,
+                               const uint8_t* data, size_t size,
+                               DynamicBuffer* dynamic_buffer) {
+  const DynamicBuffer::Upload upload = dynamic_buffer->Update(data, size);
+  if (upload.type == DynamicBuffer::Upload::kNone) {
+    return;
+  }
+
+  GL_CALL(glBindBuffer(target, buffer));
+  if (upload.type != DynamicBuffer::Upload::kPartial) {
+    GL_CALL(glBufferData(target, dynamic_buffer->GetCapacity(), nullptr,
+                         GL_DYNAMIC_DRAW));
+  }
+  GL_CALL(glBufferSubData(target, upload.offset, upload.size,
+                          data + upload.offset));
+  GL_CALL(glBindBuffer(target, 0));
+}
+
 void Mesh::ReleaseGpuResources() {
   if (remote_gpu_buffers_) {
     return;
@@ -24,6 +24,7 @@ limitations under the License.
 #include "lullaby/modules/file/asset.h"
 #include "lullaby/modules/render/mesh_data.h"
 #include "lullaby/systems/render/mesh.h"
+#include "lullaby/systems/render/next/dynamic_buffer.h"
 #include "lullaby/systems/render/next/render_handle.h"
 #include "lullaby/util/math.h"
 #include "lullaby/generated/render_def_generated.h"
@@ -40,6 +41,20 @@ class Mesh {
   // Creates the actual mesh from the provided MeshData.
   void Init(const MeshData* mesh_datas, size_t len);
 
+  // Creates a mesh from |mesh_data| whose GPU buffers are expected to be
+  // updated frequently with UpdateDynamic().
+  void InitDynamic(const MeshData& mesh_data);
+
+  // Returns true if the mesh was created with InitDynamic().
+  bool IsDynamic() const { return dynamic_; }
+
+  // Updates a dynamic mesh in place with |mesh_data|, reusing its GPU buffers
+  // and uploading only the byte ranges that changed.  Returns false (without
+  // modifying the mesh) if the mesh isn't dynamic or |mesh_data| can't be
+  // stored in it, ie. it is empty, has multiple submeshes or has a different
+  // vertex format.
+  bool UpdateDynamic(const MeshData& mesh_data);
+
   // Returns if this mesh has been loaded into OpenGL.
   bool IsLoaded() const;
 
@@ -69,6 +84,13 @@ class Mesh {
   // Draws a portion of the mesh.
   void RenderSubmesh(size_t index);
 
+  // Draws |instance_count| instances of the mesh.  This requires a context
+  // that supports instanced rendering (see NextRenderer::SupportsInstancing).
+  void RenderInstanced(int instance_count);
+
+  // Draws |instance_count| instances of a portion of the mesh.
+  void RenderSubmeshInstanced(size_t index, int instance_count);
+
   // Returns the vertex format of the specified submesh index of the geometry,
   // or an empty VertexFormat if the index is invalid.
   VertexFormat GetVertexFormat(size_t submesh_index) const;
@@ -102,8 +124,8 @@ class Mesh {
     MeshData::IndexType index_type = MeshData::kIndexU16;
   };
 
-  void DrawArrays(const Submesh& submesh);
-  void DrawElements(const Submesh& submesh);
+  void DrawArrays(const Submesh& submesh, int instance_count);
+  void DrawElements(const Submesh& submesh, int instance_count);
   void BindAttributes(const Submesh& submesh);
   void UnbindAttributes(const Submesh& submesh);
 
@@ -122,6 +144,12 @@ class Mesh {
   // Properly releases all BufferHnds below and clears their vectors.
   void ReleaseGpuResources();
 
+  // Uploads |size| bytes of |data| to the dynamic |buffer| bound to |target|,
+  // as planned by |dynamic_buffer|.
+  static void UploadDynamicBuffer(uint32_t target, uint32_t buffer,
+                                  const uint8_t* data, size_t size,
+                                  DynamicBuffer* dynamic_buffer);
+
   // Buffer and array objects used by geometry.
   std::vector<BufferHnd> vbos_;
   std::vector<BufferHnd> vaos_;
@@ -137,6 +165,9 @@ class Mesh {
   std::vector<std::function<void()>> on_load_callbacks_;
   bool remote_gpu_buffers_ = false;
   bool index_range_submeshes_ = false;
+  bool dynamic_ = false;
+  DynamicBuffer dynamic_vbo_;
+  DynamicBuffer dynamic_ibo_;
 };
 
 }  // namespace lull
@@ -370,6 +370,15 @@ MeshPtr MeshFactoryImpl::CreateMesh(HashValue name, const MeshData* mesh_data) {
   return meshes_.Create(name, [&]() { return CreateMesh(mesh_data); });
 }
 
+MeshPtr MeshFactoryImpl::CreateDynamicMesh(const MeshData* mesh_data) {
+  if (mesh_data->GetNumVertices() == 0) {
+    return MeshPtr();
+  }
+  MeshPtr mesh = std::make_shared<Mesh>();
+  mesh->InitDynamic(*mesh_data);
+  return mesh;
+}
+
 MeshPtr MeshFactoryImpl::EmptyMesh() {
   if (!empty_) {
     empty_ = std::make_shared<Mesh>();
@@ -62,6 +62,10 @@ class MeshFactoryImpl : public MeshFactory {
   MeshPtr CreateMesh(const MeshData* mesh_data);
   MeshPtr CreateMesh(HashValue name, const MeshData* mesh_data);
 
+  // Creates a mesh whose GPU buffers can be updated in place with
+  // Mesh::UpdateDynamic(), for meshes that are rebuilt often.
+  MeshPtr CreateDynamicMesh(const MeshData* mesh_data);
+
  private:
   Registry* registry_;
   ResourceManager<Mesh> meshes_;
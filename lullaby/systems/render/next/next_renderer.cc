@@ -50,6 +50,12 @@ int GetIosContextClientVersion();
 #endif  // TARGET_OS_IPHONE || TARGET_IPHONE_SIMULATOR
 
 constexpr HashValue kEnvironmentHashMultiview = ConstHash("MULTIVIEW");
+constexpr HashValue kEnvironmentHashInstanced = ConstHash("INSTANCED");
+
+// Three regions let the GPU still read the data of the previous two frames
+// while the current frame's uniforms are written.
+constexpr size_t kUniformBufferRingFrameSize = 256 * 1024;
+constexpr int kUniformBufferRingNumFrames = 3;
 
 struct ContextCapabilities {
   ContextCapabilities()
@@ -61,6 +67,9 @@ struct ContextCapabilities {
         supports_astc_textures(false),
         supports_etc2_textures(false),
         supports_uniform_buffer_objects(false),
+        supports_instancing(false),
+        supports_program_binaries(false),
+        supports_pixel_buffer_objects(false),
         max_shader_version(0),
         max_texture_units(0) {}
 
@@ -72,6 +81,9 @@ struct ContextCapabilities {
   std::atomic<bool> supports_astc_textures;
   std::atomic<bool> supports_etc2_textures;
   std::atomic<bool> supports_uniform_buffer_objects;
+  std::atomic<bool> supports_instancing;
+  std::atomic<bool> supports_program_binaries;
+  std::atomic<bool> supports_pixel_buffer_objects;
   std::atomic<int> max_shader_version;
   std::atomic<int> max_texture_units;
 
@@ -329,6 +341,36 @@ NextRenderer::NextRenderer(Optional<int> gl_major_version_override) {
     gContextCapabilities.supports_uniform_buffer_objects = true;
   }
 
+  // Instanced draws are core in GLES3 & GL3.1, and the per-instance data is
+  // read from a uniform block.
+#if GL_ES_VERSION_3_0 || defined(GL_VERSION_3_1)
+  if (gContextCapabilities.feature_level_3 &&
+      gContextCapabilities.supports_uniform_buffer_objects) {
+    gContextCapabilities.supports_instancing = true;
+    environment_flags_.insert(kEnvironmentHashInstanced);
+  }
+#endif  // GL_ES_VERSION_3_0 || GL_VERSION_3_1
+
+  // Program binaries are core in GLES3 & GL4.1, but drivers may not support
+  // any binary formats.
+#if GL_ES_VERSION_3_0 || defined(GL_VERSION_4_1)
+  if (gContextCapabilities.feature_level_3) {
+    GLint num_binary_formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_binary_formats);
+    if (glGetError() == GL_NO_ERROR && num_binary_formats > 0) {
+      gContextCapabilities.supports_program_binaries = true;
+    }
+  }
+#endif  // GL_ES_VERSION_3_0 || GL_VERSION_4_1
+
+  // Pixel buffer objects are core in GLES3 & GL2.1, but are only used with
+  // glMapBufferRange, which requires GLES3 & GL3.0.
+#if GL_ES_VERSION_3_0 || defined(GL_VERSION_3_0)
+  if (gContextCapabilities.feature_level_3) {
+    gContextCapabilities.supports_pixel_buffer_objects = true;
+  }
+#endif  // GL_ES_VERSION_3_0 || GL_VERSION_3_0
+
   gContextCapabilities.max_shader_version = GetShaderVersion();
 
   int max_texture_units = 0;
@@ -336,6 +378,12 @@ NextRenderer::NextRenderer(Optional<int> gl_major_version_override) {
   gContextCapabilities.max_texture_units = max_texture_units;
 
   mesh_helper_ = MakeUnique<MeshHelper>();
+
+  if (gContextCapabilities.feature_level_3 &&
+      gContextCapabilities.supports_uniform_buffer_objects) {
+    uniform_buffer_ring_ = MakeUnique<UniformBufferRing>(
+        kUniformBufferRingFrameSize, kUniformBufferRingNumFrames);
+  }
 }
 
 NextRenderer::~NextRenderer() {}
@@ -413,6 +461,18 @@ bool NextRenderer::SupportsUniformBufferObjects() {
   return gContextCapabilities.supports_uniform_buffer_objects;
 }
 
+bool NextRenderer::SupportsInstancing() {
+  return gContextCapabilities.supports_instancing;
+}
+
+bool NextRenderer::SupportsProgramBinaries() {
+  return gContextCapabilities.supports_program_binaries;
+}
+
+bool NextRenderer::SupportsPixelBufferObjects() {
+  return gContextCapabilities.supports_pixel_buffer_objects;
+}
+
 int NextRenderer::MaxTextureUnits() {
   return gContextCapabilities.max_texture_units;
 }
@@ -437,6 +497,22 @@ const std::set<HashValue>& NextRenderer::GetEnvironmentFlags() const {
   return environment_flags_;
 }
 
+void NextRenderer::BeginFrame() {
+  if (uniform_buffer_ring_) {
+    uniform_buffer_ring_->BeginFrame();
+  }
+}
+
+void NextRenderer::EndFrame() {
+  if (uniform_buffer_ring_) {
+    uniform_buffer_ring_->EndFrame();
+  }
+}
+
+UniformBufferRing* NextRenderer::GetUniformBufferRing() {
+  return uniform_buffer_ring_.get();
+}
+
 void NextRenderer::Begin(RenderTarget* render_target) {
 #ifdef LULLABY_VERIFY_GPU_STATE
   render_state_manager_.Validate();
@@ -504,7 +580,7 @@ void NextRenderer::ApplyMaterial(const std::shared_ptr<Material>& material) {
     return;
   }
 
-  material->Bind();
+  material->Bind(uniform_buffer_ring_.get());
 
   if (material->GetBlendState()) {
     render_state_manager_.SetBlendState(*material->GetBlendState());
@@ -533,4 +609,13 @@ void NextRenderer::Draw(const MeshPtr& mesh,
   }
 }
 
+void NextRenderer::DrawInstanced(const MeshPtr& mesh, int instance_count,
+                                 int submesh_index) {
+  if (submesh_index >= 0) {
+    mesh->RenderSubmeshInstanced(submesh_index, instance_count);
+  } else {
+    mesh->RenderInstanced(instance_count);
+  }
+}
+
 }  // namespace lull
@@ -25,6 +25,7 @@ limitations under the License.
 #include "lullaby/systems/render/next/render_state_manager.h"
 #include "lullaby/systems/render/next/render_target.h"
 #include "lullaby/systems/render/next/shader.h"
+#include "lullaby/systems/render/next/uniform_buffer_ring.h"
 #include "lullaby/systems/render/render_types.h"
 #include "mathfu/glsl_mappings.h"
 
@@ -40,6 +41,15 @@ class NextRenderer {
   NextRenderer(const NextRenderer&) = delete;
   NextRenderer& operator=(const NextRenderer&) = delete;
 
+  /// Marks the start and end of the rendering for a frame.  Uniform data that
+  /// is written into the uniform buffer ring is only valid until EndFrame.
+  void BeginFrame();
+  void EndFrame();
+
+  /// Returns the ring used for streaming uniform data, or nullptr if uniform
+  /// buffer objects are not supported.
+  UniformBufferRing* GetUniformBufferRing();
+
   /// Prepares the specified render target (or the default target in none
   /// provided) for rendering.
   void Begin(RenderTarget* render_target = nullptr);
@@ -55,6 +65,10 @@ class NextRenderer {
   void Draw(const std::shared_ptr<Mesh>& mesh,
             const mathfu::mat4& world_from_object, int submesh_index = -1);
 
+  /// Renders |instance_count| instances of the submesh in a single draw call.
+  void DrawInstanced(const std::shared_ptr<Mesh>& mesh, int instance_count,
+                     int submesh_index = -1);
+
   void DrawMeshData(const MeshData& mesh_data) {
     mesh_helper_->DrawMeshData(mesh_data);
   }
@@ -106,6 +120,18 @@ class NextRenderer {
   /// Returns true if the current context supports uniform buffer objects.
   static bool SupportsUniformBufferObjects();
 
+  /// Returns true if the current context supports instanced draw calls with
+  /// per-instance data provided through uniform buffer objects.
+  static bool SupportsInstancing();
+
+  /// Returns true if the current context can save and load linked shader
+  /// programs as binaries.
+  static bool SupportsProgramBinaries();
+
+  /// Returns true if the current context can stage texture uploads in mapped
+  /// pixel buffer objects.
+  static bool SupportsPixelBufferObjects();
+
   /// Returns the maximum supported number of texture units.
   static int MaxTextureUnits();
 
@@ -116,6 +142,7 @@ class NextRenderer {
   std::set<HashValue> environment_flags_;
 
   std::unique_ptr<MeshHelper> mesh_helper_;
+  std::unique_ptr<UniformBufferRing> uniform_buffer_ring_;
   RenderStateManager render_state_manager_;
   bool multiview_enabled_ = false;
   RenderTarget* render_target_ = nullptr;
@@ -0,0 +1,170 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/program_binary_cache.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <fstream>
+#include <vector>
+
+#include "lullaby/systems/render/next/detail/glplatform.h"
+#include "lullaby/systems/render/next/next_renderer.h"
+#include "lullaby/util/filename.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+namespace {
+constexpr uint32_t kProgramBinaryMagic = 0x4c505242;  // 'LPRB'
+// Bump this whenever the way programs are linked changes (eg. the default
+// attribute bindings) to invalidate the existing binaries.
+constexpr uint32_t kProgramBinaryVersion = 1;
+
+struct ProgramBinaryHeader {
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint32_t key = 0;
+  uint32_t format = 0;
+  uint32_t size = 0;
+};
+
+HashValue HashGlString(HashValue hash, GLenum name) {
+  const GLubyte* str = glGetString(name);
+  if (str == nullptr) {
+    return hash;
+  }
+  return HashCombine(hash, Hash(reinterpret_cast<const char*>(str)));
+}
+}  // namespace
+
+ProgramBinaryCache::ProgramBinaryCache(std::string directory)
+    : directory_(std::move(directory)) {
+  driver_hash_ = HashGlString(driver_hash_, GL_VENDOR);
+  driver_hash_ = HashGlString(driver_hash_, GL_RENDERER);
+  driver_hash_ = HashGlString(driver_hash_, GL_VERSION);
+}
+
+bool ProgramBinaryCache::IsSupported() {
+  return NextRenderer::SupportsProgramBinaries();
+}
+
+HashValue ProgramBinaryCache::GetKey(string_view vs_source,
+                                     string_view fs_source) const {
+  HashValue key = HashCombine(driver_hash_, kProgramBinaryVersion);
+  key = HashCombine(key, Hash(vs_source));
+  key = HashCombine(key, Hash(fs_source));
+  return key;
+}
+
+std::string ProgramBinaryCache::GetPath(HashValue key) const {
+  char name[32];
+  snprintf(name, sizeof(name), "%08x.lullprogram", key);
+  return JoinPath(directory_, name);
+}
+
+ProgramHnd ProgramBinaryCache::Load(HashValue key) {
+#if LULLABY_PROGRAM_BINARIES
+  const std::string path = GetPath(key);
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return ProgramHnd();
+  }
+
+  ProgramBinaryHeader header;
+  std::vector<char> binary;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (file && header.magic == kProgramBinaryMagic &&
+      header.version == kProgramBinaryVersion && header.key == key &&
+      header.size > 0) {
+    binary.resize(header.size);
+    file.read(binary.data(), binary.size());
+  }
+  const bool valid = file && !binary.empty();
+  file.close();
+
+  if (valid) {
+    const ProgramHnd program = glCreateProgram();
+    if (!program) {
+      LOG(DFATAL) << "Could not create program object.";
+      return ProgramHnd();
+    }
+    GL_CALL(glProgramBinary(*program, static_cast<GLenum>(header.format),
+                            binary.data(), static_cast<GLsizei>(header.size)));
+    GLint status = GL_FALSE;
+    GL_CALL(glGetProgramiv(*program, GL_LINK_STATUS, &status));
+    if (status == GL_TRUE) {
+      return program;
+    }
+    GL_CALL(glDeleteProgram(*program));
+  }
+
+  // The binary is corrupt or no longer accepted by the driver, so remove it
+  // and let it be rebuilt from source.
+  LOG(INFO) << "Discarding program binary: " << path;
+  remove(path.c_str());
+#endif  // LULLABY_PROGRAM_BINARIES
+  return ProgramHnd();
+}
+
+void ProgramBinaryCache::Save(HashValue key, ProgramHnd program) {
+#if LULLABY_PROGRAM_BINARIES
+  if (!program) {
+    return;
+  }
+
+  GLint length = 0;
+  GL_CALL(glGetProgramiv(*program, GL_PROGRAM_BINARY_LENGTH, &length));
+  if (length <= 0) {
+    return;
+  }
+
+  std::vector<char> binary(length);
+  GLenum format = 0;
+  GL_CALL(glGetProgramBinary(*program, length, &length, &format,
+                             binary.data()));
+  if (length <= 0) {
+    return;
+  }
+
+  ProgramBinaryHeader header;
+  header.magic = kProgramBinaryMagic;
+  header.version = kProgramBinaryVersion;
+  header.key = key;
+  header.format = static_cast<uint32_t>(format);
+  header.size = static_cast<uint32_t>(length);
+
+  // Write to a temporary file first so that an interrupted write never leaves a
+  // truncated binary behind.
+  const std::string path = GetPath(key);
+  const std::string temp_path = path + ".tmp";
+  std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(binary.data(), length);
+  file.close();
+  if (!file) {
+    LOG(WARNING) << "Failed to write program binary: " << temp_path;
+    remove(temp_path.c_str());
+    return;
+  }
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to store program binary: " << path;
+    remove(temp_path.c_str());
+  }
+#endif  // LULLABY_PROGRAM_BINARIES
+}
+
+}  // namespace lull
@@ -0,0 +1,74 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_NEXT_PROGRAM_BINARY_CACHE_H_
+#define LULLABY_SYSTEMS_RENDER_NEXT_PROGRAM_BINARY_CACHE_H_
+
+#include <string>
+
+#include "lullaby/systems/render/next/detail/glplatform.h"
+#include "lullaby/systems/render/next/render_handle.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/string_view.h"
+
+// Program binaries are part of GLES3 & GL4.1 specs.
+#if GL_ES_VERSION_3_0 || defined(GL_VERSION_4_1)
+#define LULLABY_PROGRAM_BINARIES 1
+#endif
+
+namespace lull {
+
+// Stores linked shader programs on disk (using glGetProgramBinary) so that
+// subsequent runs can skip compiling and linking them from source.
+//
+// Programs are keyed by the hash of their final stage sources (which include
+// all the defines generated for the shader's environment and features) and
+// the GL vendor, renderer and version strings, so that a driver update
+// naturally invalidates the old binaries.
+class ProgramBinaryCache {
+ public:
+  // Creates a cache that stores binaries in |directory|, which must already
+  // exist and be writable.  Must be called with a current GL context.
+  explicit ProgramBinaryCache(std::string directory);
+
+  ProgramBinaryCache(const ProgramBinaryCache&) = delete;
+  ProgramBinaryCache& operator=(const ProgramBinaryCache&) = delete;
+
+  // Returns true if the current GL context can save and load program binaries.
+  static bool IsSupported();
+
+  // Returns the key for the program linked from the given stage sources.
+  HashValue GetKey(string_view vs_source, string_view fs_source) const;
+
+  // Creates a program from the binary stored for |key|.  Returns an invalid
+  // handle if there is no binary or if the driver rejects it, in which case the
+  // stale binary is deleted.
+  ProgramHnd Load(HashValue key);
+
+  // Stores the binary of the linked |program| for |key|.  The program should
+  // have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+  void Save(HashValue key, ProgramHnd program);
+
+ private:
+  std::string GetPath(HashValue key) const;
+
+  std::string directory_;
+  HashValue driver_hash_ = 0;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_RENDER_NEXT_PROGRAM_BINARY_CACHE_H_
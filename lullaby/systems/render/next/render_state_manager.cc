@@ -405,6 +405,7 @@ void RenderStateManager::SetAlphaTestState(const AlphaTestStateT& state) {
   }
 
   if (update) {
+    ++num_state_changes_;
     state_.alpha_test_state = state;
   }
 }
@@ -440,6 +441,7 @@ void RenderStateManager::SetBlendState(const BlendStateT& state) {
   }
 
   if (update) {
+    ++num_state_changes_;
     state_.blend_state = state;
   }
 }
@@ -464,6 +466,7 @@ void RenderStateManager::SetColorState(const ColorStateT& state) {
   }
 
   if (update) {
+    ++num_state_changes_;
     state_.color_state = state;
   }
 }
@@ -504,6 +507,7 @@ void RenderStateManager::SetCullState(const CullStateT& state) {
   }
 
   if (update) {
+    ++num_state_changes_;
     state_.cull_state = state;
   }
 }
@@ -561,6 +565,7 @@ void RenderStateManager::SetDepthState(const DepthStateT& state) {
   }
 
   if (update) {
+    ++num_state_changes_;
     state_.depth_state = state;
   }
 }
@@ -624,6 +629,7 @@ void RenderStateManager::SetPointState(const PointStateT& state) {
   }
 
   if (update) {
+    ++num_state_changes_;
     state_.point_state = state;
   }
 }
@@ -652,6 +658,7 @@ void RenderStateManager::SetScissorState(const ScissorStateT& state) {
   }
 
   if (update) {
+    ++num_state_changes_;
     state_.scissor_state = state;
   }
 }
@@ -718,6 +725,7 @@ void RenderStateManager::SetStencilState(const StencilStateT& state) {
   }
 
   if (update) {
+    ++num_state_changes_;
     state_.stencil_state = state;
   }
 }
@@ -738,6 +746,7 @@ void RenderStateManager::SetViewport(const mathfu::recti& rect) {
   }
 
   if (update) {
+    ++num_state_changes_;
     state_.viewport = rect;
   }
 }
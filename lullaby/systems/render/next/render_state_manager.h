@@ -76,8 +76,14 @@ class RenderStateManager {
   /// Sets the viewport state.
   void SetViewport(const mathfu::recti& rect);
 
+  /// Returns the number of times the GL hardware state has been changed by this
+  /// class, counting each state (eg. blend or depth) separately.  Redundant
+  /// changes that are filtered out are not counted.
+  int GetNumStateChanges() const { return num_state_changes_; }
+
  private:
   RenderStateT state_;
+  int num_state_changes_ = 0;
 };
 
 }  // namespace lull
@@ -20,7 +20,11 @@ limitations under the License.
 #include <stdio.h>
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <utility>
 
 #include "lullaby/events/render_events.h"
 #include "lullaby/modules/config/config.h"
@@ -43,6 +47,8 @@ limitations under the License.
 #include "lullaby/systems/render/render_stats.h"
 #include "lullaby/systems/render/simple_font.h"
 #include "lullaby/util/filename.h"
+#include "lullaby/util/intersections.h"
+#include "lullaby/util/job_processor.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/util/make_unique.h"
 #include "lullaby/util/math.h"
@@ -62,6 +68,16 @@ constexpr HashValue kFeatureHashUniformColor = ConstHash("UniformColor");
 constexpr HashValue kFeatureHashIBL = ConstHash("IBL");
 constexpr HashValue kFeatureHashOcclusion = ConstHash("Occlusion");
 
+// The uniform block from which instanced shaders read their per-instance data.
+// Its layout must match vertex_position_instanced.jsonnet: an array of
+// world-from-entity matrices followed by an array of colors.
+constexpr HashValue kInstanceDataHash = ConstHash("InstanceData");
+constexpr size_t kMaxInstancesPerDraw = 64;
+constexpr size_t kInstanceMatrixSize = 16 * sizeof(float);
+constexpr size_t kInstanceColorSize = 4 * sizeof(float);
+constexpr size_t kInstanceMatricesSize =
+    kMaxInstancesPerDraw * kInstanceMatrixSize;
+
 bool IsSupportedUniformDimension(int dimension) {
   return (dimension == 1 || dimension == 2 || dimension == 3 ||
           dimension == 4 || dimension == 9 || dimension == 16);
@@ -156,6 +172,7 @@ RenderSystemNext::RenderSystemNext(Registry* registry,
     : System(registry),
       renderer_(init_params.gl_major_version_override),
       sort_order_manager_(registry_),
+      subtree_color_multipliers_(registry_),
       shading_model_path_(kDefaultMaterialShaderDirectory) {
   if (init_params.enable_stereo_multiview) {
     renderer_.EnableMultiview();
@@ -178,6 +195,7 @@ RenderSystemNext::RenderSystemNext(Registry* registry,
   auto* dispatcher = registry->Get<Dispatcher>();
   dispatcher->Connect(this, [this](const ParentChangedImmediateEvent& event) {
     UpdateSortOrder(event.target);
+    subtree_color_multipliers_.Invalidate();
   });
   dispatcher->Connect(this,
                       [this](const ChildIndexChangedImmediateEvent& event) {
@@ -200,6 +218,11 @@ RenderSystemNext::~RenderSystemNext() {
     binder->UnregisterFunction("lull.Render.GetTextureId");
   }
   registry_->Get<Dispatcher>()->DisconnectAll(this);
+
+  if (instance_ubo_.Valid()) {
+    GLuint gl_ubo = *instance_ubo_;
+    GL_CALL(glDeleteBuffers(1, &gl_ubo));
+  }
 }
 
 void RenderSystemNext::Initialize() {
@@ -389,6 +412,7 @@ void RenderSystemNext::Destroy(Entity entity) {
     pass.second.components.Destroy(entity);
     sort_order_manager_.Destroy(entity_id_pair);
   }
+  subtree_color_multipliers_.Clear(entity);
 }
 
 void RenderSystemNext::Destroy(Entity entity, HashValue pass) {
@@ -430,6 +454,20 @@ void RenderSystemNext::SetColor(Entity entity, const mathfu::vec4& color) {
              {reinterpret_cast<const uint8_t*>(&color[0]), sizeof(color)});
 }
 
+void RenderSystemNext::SetSubtreeColorMultiplier(
+    Entity entity, const mathfu::vec4& multiplier) {
+  subtree_color_multipliers_.Set(entity, multiplier);
+}
+
+void RenderSystemNext::ClearSubtreeColorMultiplier(Entity entity) {
+  subtree_color_multipliers_.Clear(entity);
+}
+
+bool RenderSystemNext::GetSubtreeColorMultiplier(
+    Entity entity, mathfu::vec4* multiplier) const {
+  return subtree_color_multipliers_.Get(entity, multiplier);
+}
+
 void RenderSystemNext::SetUniform(const Drawable& drawable, string_view name,
                                   ShaderDataType type, Span<uint8_t> data,
                                   int count) {
@@ -627,7 +665,28 @@ void RenderSystemNext::SetMesh(const Drawable& drawable,
 }
 
 void RenderSystemNext::SetMesh(const Drawable& drawable, const MeshData& mesh) {
-  SetMesh(drawable, mesh_factory_->CreateMesh(&mesh));
+  // Meshes set from MeshData (eg. text and nine-patches) tend to be rebuilt
+  // often, so update the GPU buffers of the drawable's own dynamic mesh in
+  // place when possible instead of re-creating them.
+  MeshPtr new_mesh;
+  bool created = false;
+  ForEachComponent(drawable, [&](RenderComponent* component, HashValue pass) {
+    MeshPtr& existing = component->mesh;
+    if (existing && existing.use_count() == 1 &&
+        existing->UpdateDynamic(mesh)) {
+      auto* transform_system = registry_->Get<TransformSystem>();
+      transform_system->SetAabb(drawable.entity, existing->GetAabb());
+      SendEvent(registry_, drawable.entity,
+                MeshChangedEvent(drawable.entity, pass));
+      return;
+    }
+    // Components that can't be updated share a single new mesh.
+    if (!created) {
+      new_mesh = mesh_factory_->CreateDynamicMesh(&mesh);
+      created = true;
+    }
+    SetMeshImpl(drawable.entity, pass, new_mesh);
+  });
 }
 
 MeshPtr RenderSystemNext::GetMesh(const Drawable& drawable) {
@@ -1023,6 +1082,16 @@ void RenderSystemNext::SetCullMode(HashValue pass, RenderCullMode mode) {
   }
 }
 
+void RenderSystemNext::SetInstancingEnabled(HashValue pass, bool enabled) {
+  if (enabled && !NextRenderer::SupportsInstancing()) {
+    LOG(WARNING) << "Instanced rendering is not supported by this context.";
+  }
+  RenderPassObject* render_pass_object = GetRenderPassObject(pass);
+  if (render_pass_object) {
+    render_pass_object->instancing_enabled = enabled;
+  }
+}
+
 void RenderSystemNext::SetDefaultFrontFace(RenderFrontFace face) {
   CHECK(render_passes_.empty())
       << "Must set the default FrontFace before Initializing passes.";
@@ -1062,12 +1131,28 @@ void RenderSystemNext::SubmitRenderData() {
   if (!data) {
     return;
   }
-  data->clear();
+
+  // Reuse the containers (and their allocations) from the last time this
+  // buffer was written.
+  for (auto iter = data->passes.begin(); iter != data->passes.end();) {
+    if (render_passes_.count(iter->first) == 0) {
+      iter = data->passes.erase(iter);
+      continue;
+    }
+    iter->second.render_target.reset();
+    for (RenderLayer& layer : iter->second.layers) {
+      layer.render_objects.clear();
+    }
+    ++iter;
+  }
+  for (auto& iter : data->materials) {
+    iter.second.used = false;
+  }
 
   const auto* transform_system = registry_->Get<TransformSystem>();
 
   for (const auto& iter : render_passes_) {
-    RenderPassDrawContainer& pass_container = (*data)[iter.first];
+    RenderPassDrawContainer& pass_container = data->passes[iter.first];
 
     // Copy the pass' properties.
     pass_container.clear_params = iter.second.clear_params;
@@ -1088,6 +1173,10 @@ void RenderSystemNext::SubmitRenderData() {
       // the blend mode.
       opaque_layer.sort_mode = SortMode_AverageSpaceOriginFrontToBack;
       blend_layer.sort_mode = SortMode_AverageSpaceOriginBackToFront;
+    } else if (iter.second.sort_mode == SortMode_MinimizeStateChanges) {
+      // Blended objects must still be drawn back to front to look correct.
+      opaque_layer.sort_mode = SortMode_MinimizeStateChanges;
+      blend_layer.sort_mode = SortMode_AverageSpaceOriginBackToFront;
     } else {
       // Otherwise assign the user's chosen sort modes.
       for (RenderLayer& layer : pass_container.layers) {
@@ -1096,6 +1185,8 @@ void RenderSystemNext::SubmitRenderData() {
     }
     opaque_layer.cull_mode = iter.second.cull_mode;
     blend_layer.cull_mode = iter.second.cull_mode;
+    opaque_layer.instancing_enabled = iter.second.instancing_enabled;
+    blend_layer.instancing_enabled = iter.second.instancing_enabled;
 
     // Set the render states.
     // Opaque remains as is.
@@ -1144,17 +1235,27 @@ void RenderSystemNext::SubmitRenderData() {
             return;
           }
 
+          // Bounding spheres are scaled by the largest axis scale so that they
+          // still enclose the submeshes.
+          const mathfu::mat4& mat = *world_from_entity_matrix;
+          const float max_scale =
+              std::max(std::max(GetMatrixColumn3D(mat, 0).Length(),
+                                GetMatrixColumn3D(mat, 1).Length()),
+                       GetMatrixColumn3D(mat, 2).Length());
+
           RenderObject obj;
           obj.mesh = render_component.mesh;
           obj.world_from_entity_matrix = *world_from_entity_matrix;
+          obj.color_multiplier =
+              subtree_color_multipliers_.GetInherited(entity);
           obj.sort_order = render_component.sort_order;
 
           // Add each material as a single render object where each material
           // references a submesh.
           for (size_t i = 0; i < render_component.materials.size(); ++i) {
-            obj.material = render_component.materials[i];
-            if (!obj.material || obj.material->IsHidden() ||
-                !obj.material->IsLoaded()) {
+            const std::shared_ptr<Material>& material =
+                render_component.materials[i];
+            if (!material || material->IsHidden() || !material->IsLoaded()) {
               continue;
             }
             obj.submesh_index = static_cast<int>(i);
@@ -1162,21 +1263,24 @@ void RenderSystemNext::SubmitRenderData() {
             const Aabb aabb = render_component.mesh->GetSubmeshAabb(i);
             obj.world_position =
                 obj.world_from_entity_matrix * (aabb.min + aabb.max) * .5f;
+            obj.world_radius = (aabb.max - aabb.min).Length() * .5f *
+                               max_scale;
 
             const RenderPassDrawContainer::LayerType type =
                 ((pass_render_state.blend_state &&
                   pass_render_state.blend_state->enabled) ||
-                 IsAlphaEnabled(*obj.material))
+                 IsAlphaEnabled(*material))
                     ? RenderPassDrawContainer::kBlendEnabled
                     : RenderPassDrawContainer::kOpaque;
             if (type == RenderPassDrawContainer::kBlendEnabled) {
-              const BlendStateT* blend_state = obj.material->GetBlendState();
+              const BlendStateT* blend_state = material->GetBlendState();
               if (blend_state && !blend_state->enabled) {
                 // Set the blend state to null, effectively letting the layer
                 // use its own blend state.
-                obj.material->SetBlendState(nullptr);
+                material->SetBlendState(nullptr);
               }
             }
+            obj.material = GetMaterialSnapshot(data, material);
             pass_container.layers[type].render_objects.push_back(obj);
           }
         });
@@ -1190,14 +1294,44 @@ void RenderSystemNext::SubmitRenderData() {
     }
   }
 
+  // Release the snapshots of materials that are no longer drawn.
+  for (auto iter = data->materials.begin(); iter != data->materials.end();) {
+    if (iter->second.used) {
+      ++iter;
+    } else {
+      iter = data->materials.erase(iter);
+    }
+  }
+
   render_data_buffer_.UnlockWriteBuffer();
 }
 
+const std::shared_ptr<Material>& RenderSystemNext::GetMaterialSnapshot(
+    RenderData* data, const std::shared_ptr<Material>& material) {
+  MaterialSnapshot& snapshot = data->materials[material.get()];
+  if (snapshot.source.lock() != material) {
+    // Either a new material, or a new one allocated at the address of a
+    // destroyed one, so start again from a full copy.
+    snapshot.source = material;
+    snapshot.material = std::make_shared<Material>();
+  }
+  if (!snapshot.used) {
+    snapshot.material->UpdateSnapshot(*material);
+    snapshot.used = true;
+  }
+  return snapshot.material;
+}
+
 void RenderSystemNext::BeginRendering() {
   active_render_data_ = render_data_buffer_.LockReadBuffer();
+  renderer_.BeginFrame();
+  texture_factory_->ProcessTextureStreaming();
+  FinishReadbacks();
 }
 
 void RenderSystemNext::EndRendering() {
+  StartReadbacks();
+  renderer_.EndFrame();
   render_data_buffer_.UnlockReadBuffer();
   active_render_data_ = nullptr;
 }
@@ -1270,8 +1404,8 @@ void RenderSystemNext::RenderAt(const RenderObject* render_object,
   shader->SetUniform(kCameraDir, camera_dir[0].data_, 3, count);
 
   constexpr HashValue kCameraPos = ConstHash("camera_pos");
-  // camera_pos is not currently multiview enabled, so only set 1 value.
-  shader->SetUniform(kCameraPos, camera_pos[0].data_, 3, 1);
+  // Shaders that declare a single camera_pos only receive the first view's.
+  shader->SetUniform(kCameraPos, camera_pos[0].data_, 3, count);
 
   // We break the naming convention here for compatibility with early VR apps.
   constexpr HashValue kIsRightEye = ConstHash("uIsRightEye");
@@ -1287,8 +1421,22 @@ void RenderSystemNext::RenderAt(const RenderObject* render_object,
     shader->SetUniform(kUvBounds, bounds.data_, 4);
   }
 
-  renderer_.GetRenderStateManager().SetRenderState(render_state);
+  RenderStateManager& render_state_manager = renderer_.GetRenderStateManager();
+  const int num_state_changes = render_state_manager.GetNumStateChanges();
+  render_state_manager.SetRenderState(render_state);
   renderer_.ApplyMaterial(render_object->material);
+  if (render_object->color_multiplier != mathfu::kOnes4f) {
+    // Binding the material binds its own color, so scale it by the inherited
+    // subtree multiplier.
+    const HashValue color_hash = Hash(kColorUniform);
+    const detail::UniformData* color = material->GetUniformData(color_hash);
+    if (color && color->Type() == ShaderDataType_Float4) {
+      const mathfu::vec4 value =
+          mathfu::vec4(color->GetData<float>()) *
+          render_object->color_multiplier;
+      shader->SetUniform(color_hash, &value[0], 4);
+    }
+  }
   renderer_.Draw(mesh, render_object->world_from_entity_matrix,
                  render_object->submesh_index);
 
@@ -1296,78 +1444,543 @@ void RenderSystemNext::RenderAt(const RenderObject* render_object,
   if (profiler) {
     profiler->RecordDraw(material->GetShader(), mesh->GetNumVertices(),
                          mesh->GetNumPrimitives());
+    profiler->RecordBinds(material.get(), mesh.get());
+    profiler->RecordRenderStateChanges(
+        render_state_manager.GetNumStateChanges() - num_state_changes);
   }
 }
 
 void RenderSystemNext::Render(const RenderView* views, size_t num_views) {
+  DynamicResolution* dynamic_resolution = registry_->Get<DynamicResolution>();
+  if (dynamic_resolution && num_views > 0) {
+    RenderScaled(views, num_views, dynamic_resolution);
+  } else {
+    RenderDefaultPasses(views, num_views);
+  }
+}
+
+void RenderSystemNext::RenderDefaultPasses(const RenderView* views,
+                                           size_t num_views) {
+  if (!active_render_data_) {
+    LOG(DFATAL) << "Render between BeginRendering() and EndRendering()!";
+    return;
+  }
+
   // Assume a max of 2 views, one for each eye.
   RenderView pano_views[2];
   CHECK_LE(num_views, 2);
   GenerateEyeCenteredViews({views, num_views}, pano_views);
-  Render(pano_views, num_views, ConstHash("Pano"));
-  Render(views, num_views, ConstHash("Opaque"));
-  Render(views, num_views, ConstHash("Main"));
-  Render(views, num_views, ConstHash("OverDraw"));
-  Render(views, num_views, ConstHash("OverDrawGlow"));
+
+  // Record all the passes up front (in parallel, if possible) and then
+  // execute them in order.
+  static const HashValue kPasses[] = {
+      ConstHash("Pano"), ConstHash("Opaque"), ConstHash("Main"),
+      ConstHash("OverDraw"), ConstHash("OverDrawGlow"),
+  };
+  static const size_t kNumPasses = sizeof(kPasses) / sizeof(kPasses[0]);
+  const RenderView* pass_views[kNumPasses] = {pano_views, views, views, views,
+                                              views};
+  RecordPasses(pass_views, num_views, kPasses, kNumPasses);
+  for (size_t i = 0; i < kNumPasses; ++i) {
+    ExecutePass(pass_views[i], num_views, pass_commands_[i]);
+  }
+}
+
+void RenderSystemNext::RecordPasses(const RenderView* const* views,
+                                    size_t num_views, const HashValue* passes,
+                                    size_t num_passes) {
+  LULLABY_CPU_TRACE_CALL();
+  if (pass_commands_.size() < num_passes) {
+    pass_commands_.resize(num_passes);
+  }
+
+  // The instancing support is read from the GL context, so query it here on
+  // the render thread.
+  const bool supports_instancing = NextRenderer::SupportsInstancing();
+  RecordConcurrently(registry_->Get<JobProcessor>(), num_passes,
+                     [&](size_t i) {
+                       RecordPass(views[i], num_views, passes[i],
+                                  supports_instancing, &pass_commands_[i]);
+                     });
+}
+
+void RenderSystemNext::RecordPass(const RenderView* views, size_t num_views,
+                                  HashValue pass, bool supports_instancing,
+                                  PassCommands* commands) {
+  LULLABY_CPU_TRACE_CALL();
+  commands->pass = pass;
+  commands->container = nullptr;
+  for (LayerCommands& layer_commands : commands->layers) {
+    layer_commands.layer = nullptr;
+    layer_commands.objects = nullptr;
+  }
+
+  if (!active_render_data_) {
+    return;
+  }
+  auto iter = active_render_data_->passes.find(pass);
+  if (iter == active_render_data_->passes.end()) {
+    // No data associated with this pass.
+    return;
+  }
+  commands->container = &iter->second;
+  if (pass == ConstHash("Debug")) {
+    // The debug pass is drawn immediately.
+    return;
+  }
+
+  for (size_t i = 0; i < RenderPassDrawContainer::kNumLayers; ++i) {
+    RenderLayer& layer = iter->second.layers[i];
+    LayerCommands& layer_commands = commands->layers[i];
+    layer_commands.layer = &layer;
+    if (!IsSortModeViewIndependent(layer.sort_mode)) {
+      SortObjectsUsingView(&layer.render_objects, layer.sort_mode, views,
+                           num_views);
+    }
+    if (layer.cull_mode == RenderCullMode::kNone) {
+      layer_commands.objects = &layer.render_objects;
+    } else {
+      CullObjects(layer.render_objects, views, num_views,
+                  &layer_commands.culled);
+      layer_commands.objects = &layer_commands.culled;
+    }
+    const RenderObjectVector& objects = *layer_commands.objects;
+    RecordDrawCommands(
+        objects.size(), supports_instancing && layer.instancing_enabled,
+        [&objects](size_t index) {
+          return CountInstanceableObjects(objects, index);
+        },
+        &layer_commands.draws);
+  }
+}
+
+void RenderSystemNext::RenderScaled(const RenderView* views, size_t num_views,
+                                    DynamicResolution* dynamic_resolution) {
+  // The resolution is driven by the GPU pass timings, which are only
+  // collected while there is a profiler.
+  if (!registry_->Get<RenderStats>()) {
+    registry_->Create<RenderStats>(registry_);
+  }
+  if (!registry_->Get<detail::Profiler>()) {
+    registry_->Create<detail::Profiler>();
+  }
+  dynamic_resolution->Update(GetScaledPassesGpuMs());
+  const float scale = dynamic_resolution->GetScale();
+
+  // The region covered by all the views at full resolution.
+  mathfu::vec2i full_size = mathfu::kZeros2i;
+  for (size_t i = 0; i < num_views; ++i) {
+    full_size = mathfu::vec2i::Max(full_size,
+                                   views[i].viewport + views[i].dimensions);
+  }
+  if (full_size.x <= 0 || full_size.y <= 0) {
+    RenderDefaultPasses(views, num_views);
+    return;
+  }
+
+  if (!scaled_target_ || scaled_target_->GetDimensions() != full_size) {
+    RenderTargetCreateParams params;
+    params.dimensions = full_size;
+    params.texture_format = TextureFormat_RGBA8;
+    params.depth_stencil_format = DepthStencilFormat_Depth24Stencil8;
+    scaled_target_ = MakeUnique<RenderTarget>(params);
+  }
+
+  // Passes are not required to clear the framebuffer, so clear the offscreen
+  // target in their place.
+  RenderClearParams clear_params;
+  clear_params.clear_options = RenderClearParams::kColor |
+                               RenderClearParams::kDepth |
+                               RenderClearParams::kStencil;
+  renderer_.Begin(scaled_target_.get());
+  renderer_.Clear(clear_params);
+  renderer_.End();
+
+  active_scaled_target_ = scaled_target_.get();
+  active_scale_ = scale;
+  RenderDefaultPasses(views, num_views);
+  active_scaled_target_ = nullptr;
+  active_scale_ = 1.0f;
+
+  scaled_target_->BlitToBoundFrameBuffer(
+      DynamicResolution::ScaleSize(full_size, scale), mathfu::kZeros2i,
+      full_size);
+}
+
+float RenderSystemNext::GetScaledPassesGpuMs() const {
+  const detail::Profiler* profiler = registry_->Get<detail::Profiler>();
+  if (!profiler) {
+    return 0.0f;
+  }
+  float gpu_ms = 0.0f;
+  for (const detail::Profiler::PassStats& stats : profiler->GetPassStats()) {
+    auto iter = render_passes_.find(stats.pass);
+    if (iter == render_passes_.end() || iter->second.render_target == 0) {
+      gpu_ms += stats.gpu_ms;
+    }
+  }
+  return gpu_ms;
 }
 
 void RenderSystemNext::Render(const RenderView* views, size_t num_views,
                               HashValue pass) {
-  LULLABY_CPU_TRACE_FORMAT("Render(pass=0x%08x)", pass);
-
   if (!active_render_data_) {
     LOG(DFATAL) << "Render between BeginRendering() and EndRendering()!";
     return;
   }
-  auto iter = active_render_data_->find(pass);
-  if (iter == active_render_data_->end()) {
+  RecordPasses(&views, num_views, &pass, 1);
+  ExecutePass(views, num_views, pass_commands_[0]);
+}
+
+void RenderSystemNext::ExecutePass(const RenderView* views, size_t num_views,
+                                   const PassCommands& commands) {
+  const HashValue pass = commands.pass;
+  LULLABY_CPU_TRACE_FORMAT("Render(pass=0x%08x)", pass);
+  if (commands.container == nullptr) {
     // No data associated with this pass.
     return;
   }
+  const RenderPassDrawContainer& draw_container = *commands.container;
+
+  detail::Profiler* profiler = registry_->Get<detail::Profiler>();
+  if (profiler) {
+    profiler->BeginPass(pass);
+  }
 
-  RenderPassDrawContainer& draw_container = iter->second;
+  // While rendering at a dynamic resolution, passes that would draw into the
+  // bound framebuffer draw into the scaled offscreen target instead.
+  RenderTarget* render_target = draw_container.render_target.get();
+  RenderView scaled_views[2];
+  if (!render_target && active_scaled_target_) {
+    CHECK_LE(num_views, 2);
+    render_target = active_scaled_target_;
+    for (size_t i = 0; i < num_views; ++i) {
+      scaled_views[i] = views[i];
+      scaled_views[i].viewport =
+          mathfu::vec2i(static_cast<int>(views[i].viewport.x * active_scale_),
+                        static_cast<int>(views[i].viewport.y * active_scale_));
+      scaled_views[i].dimensions =
+          DynamicResolution::ScaleSize(views[i].dimensions, active_scale_);
+    }
+    views = scaled_views;
+  }
 
-  renderer_.Begin(draw_container.render_target.get());
+  renderer_.Begin(render_target);
   renderer_.Clear(draw_container.clear_params);
 
   // Draw the elements.
   if (pass == ConstHash("Debug")) {
     RenderDebugStats(views, num_views);
   } else {
-    for (RenderLayer& layer : draw_container.layers) {
-      if (!IsSortModeViewIndependent(layer.sort_mode)) {
-        SortObjectsUsingView(&layer.render_objects, layer.sort_mode, views,
-                             num_views);
+    for (const LayerCommands& layer_commands : commands.layers) {
+      if (layer_commands.layer) {
+        RenderObjects(*layer_commands.objects,
+                      layer_commands.layer->render_state, views, num_views,
+                      layer_commands.draws);
       }
-      RenderObjects(layer.render_objects, layer.render_state, views, num_views);
     }
   }
 
   renderer_.End();
+
+  if (profiler) {
+    profiler->EndPass();
+  }
+}
+
+void RenderSystemNext::RenderInstancedAt(const RenderObject* render_objects,
+                                         size_t count,
+                                         const RenderStateT& render_state,
+                                         const RenderView* views,
+                                         size_t num_views) {
+  LULLABY_CPU_TRACE("RenderInstancedAt");
+  static const size_t kMaxNumViews = 2;
+  if (views == nullptr || num_views == 0 || num_views > kMaxNumViews) {
+    return;
+  }
+
+  // CountInstanceableObjects has already ensured that all the objects have the
+  // same mesh and shader.
+  const RenderObject& first = render_objects[0];
+  const std::shared_ptr<Mesh>& mesh = first.mesh;
+  const std::shared_ptr<Material>& material = first.material;
+  const std::shared_ptr<Shader>& shader = material->GetShader();
+
+  BindShader(shader);
+
+  // The entity transforms come from the instance data, so the shared
+  // transforms start from world space rather than entity space.
+  constexpr HashValue kModel = ConstHash("model");
+  const mathfu::mat4 identity = mathfu::mat4::Identity();
+  shader->SetUniform(kModel, &identity[0], 16);
+
+  constexpr HashValue kMatNormal = ConstHash("mat_normal");
+  mathfu::vec3_packed normal_matrix[3];
+  mathfu::mat3::Identity().Pack(normal_matrix);
+  shader->SetUniform(kMatNormal, normal_matrix[0].data_, 9);
+
+  int is_right_eye[kMaxNumViews] = {0};
+  mathfu::vec3_packed camera_dir[kMaxNumViews];
+  mathfu::vec3_packed camera_pos[kMaxNumViews];
+  mathfu::mat4 clip_from_world_matrix[kMaxNumViews];
+  mathfu::mat4 view_matrix[kMaxNumViews];
+
+  const int view_count = static_cast<int>(num_views);
+  for (int i = 0; i < view_count; ++i) {
+    is_right_eye[i] = views[i].eye == 1 ? 1 : 0;
+    view_matrix[i] = views[i].eye_from_world_matrix;
+    views[i].world_from_eye_matrix.TranslationVector3D().Pack(&camera_pos[i]);
+    CalculateCameraDirection(views[i].world_from_eye_matrix)
+        .Pack(&camera_dir[i]);
+    clip_from_world_matrix[i] = views[i].clip_from_world_matrix;
+  }
+
+  constexpr HashValue kView = ConstHash("view");
+  shader->SetUniform(kView, &(view_matrix[0][0]), 16, view_count);
+
+  constexpr HashValue kModelViewProjection = ConstHash("model_view_projection");
+  shader->SetUniform(kModelViewProjection, &(clip_from_world_matrix[0][0]), 16,
+                     view_count);
+
+  constexpr HashValue kCameraDir = ConstHash("camera_dir");
+  shader->SetUniform(kCameraDir, camera_dir[0].data_, 3, view_count);
+
+  constexpr HashValue kCameraPos = ConstHash("camera_pos");
+  shader->SetUniform(kCameraPos, camera_pos[0].data_, 3, view_count);
+
+  constexpr HashValue kIsRightEye = ConstHash("uIsRightEye");
+  shader->SetUniform(kIsRightEye, is_right_eye, 1, view_count);
+
+  auto texture = material->GetTexture(TextureUsageInfo(0));
+  if (texture) {
+    constexpr HashValue kUvBounds = ConstHash("uv_bounds");
+    const mathfu::vec4 bounds = texture->UvBounds();
+    shader->SetUniform(kUvBounds, bounds.data_, 4);
+  }
+
+  RenderStateManager& render_state_manager = renderer_.GetRenderStateManager();
+  const int num_state_changes = render_state_manager.GetNumStateChanges();
+  render_state_manager.SetRenderState(render_state);
+  renderer_.ApplyMaterial(material);
+
+  // Binding the material binds the shader's default instance data and the
+  // first object's color, so override them with the per-instance data.
+  constexpr HashValue kColor = ConstHash("color");
+  shader->SetUniform(kColor, &mathfu::kOnes4f[0], 4);
+  UpdateInstanceBuffer(render_objects, count);
+  UniformBufferRing* ring = renderer_.GetUniformBufferRing();
+  const UniformBufferRing::Range range =
+      ring ? ring->Write(instance_data_) : UniformBufferRing::Range();
+  if (range.buffer) {
+    shader->BindUniformBlockRange(kInstanceDataHash, range.buffer, range.offset,
+                                  range.size);
+  } else {
+    UploadInstanceBuffer(count);
+    shader->BindUniformBlock(kInstanceDataHash, instance_ubo_);
+  }
+  renderer_.DrawInstanced(mesh, static_cast<int>(count), first.submesh_index);
+
+  detail::Profiler* profiler = registry_->Get<detail::Profiler>();
+  if (profiler) {
+    const int instance_count = static_cast<int>(count);
+    profiler->RecordDraw(shader, mesh->GetNumVertices() * instance_count,
+                         mesh->GetNumPrimitives() * instance_count);
+    profiler->RecordBinds(material.get(), mesh.get());
+    profiler->RecordRenderStateChanges(
+        render_state_manager.GetNumStateChanges() - num_state_changes);
+  }
 }
 
 void RenderSystemNext::RenderObjects(const std::vector<RenderObject>& objects,
                                      const RenderStateT& render_state,
-                                     const RenderView* views,
-                                     size_t num_views) {
+                                     const RenderView* views, size_t num_views,
+                                     const std::vector<DrawCommand>& draws) {
   if (objects.empty()) {
     return;
   }
 
+  if (texture_factory_->IsTextureBudgetEnabled()) {
+    RequestTextureSizes(objects, views, num_views);
+  }
+
+  auto render_all = [&](const RenderView* render_views,
+                        size_t num_render_views) {
+    for (const DrawCommand& draw : draws) {
+      if (draw.count > 1) {
+        RenderInstancedAt(&objects[draw.index], draw.count, render_state,
+                          render_views, num_render_views);
+      } else {
+        RenderAt(&objects[draw.index], render_state, render_views,
+                 num_render_views);
+      }
+    }
+  };
 
   if (renderer_.IsMultiviewEnabled()) {
     SetViewport(views[0]);
-    for (const RenderObject& obj : objects) {
-      RenderAt(&obj, render_state, views, num_views);
-    }
+    render_all(views, num_views);
   } else {
     for (size_t i = 0; i < num_views; ++i) {
       SetViewport(views[i]);
-      for (const RenderObject& obj : objects) {
-        RenderAt(&obj, render_state, &views[i], 1);
+      render_all(&views[i], 1);
+    }
+  }
+}
+
+void RenderSystemNext::CullObjects(const RenderObjectVector& objects,
+                                   const RenderView* views, size_t num_views,
+                                   RenderObjectVector* culled) {
+  LULLABY_CPU_TRACE_CALL();
+  culled->clear();
+  static const size_t kMaxNumViews = 2;
+  if (views == nullptr || num_views == 0 || num_views > kMaxNumViews) {
+    return;
+  }
+
+  mathfu::vec4 frustums[kMaxNumViews][kNumFrustumPlanes];
+  size_t num_frustums = 1;
+  if (num_views == 1) {
+    GetViewFrustum(views[0], frustums[0]);
+  } else {
+    mathfu::mat4 clip_from_world[kMaxNumViews];
+    for (size_t i = 0; i < num_views; ++i) {
+      clip_from_world[i] = views[i].clip_from_world_matrix;
+    }
+    if (!CalculateCombinedViewFrustum(clip_from_world, num_views,
+                                      frustums[0])) {
+      num_frustums = num_views;
+      for (size_t i = 0; i < num_views; ++i) {
+        GetViewFrustum(views[i], frustums[i]);
+      }
+    }
+  }
+
+  mathfu::vec4 spheres[kSphereFrustumBatchSize];
+  uint8_t visible[kSphereFrustumBatchSize];
+  for (size_t begin = 0; begin < objects.size();
+       begin += kSphereFrustumBatchSize) {
+    const size_t count =
+        std::min(kSphereFrustumBatchSize, objects.size() - begin);
+    for (size_t i = 0; i < count; ++i) {
+      const RenderObject& obj = objects[begin + i];
+      spheres[i] = mathfu::vec4(obj.world_position, obj.world_radius);
+    }
+    CheckSpheresInFrustums(spheres, count, frustums, num_frustums, visible);
+    for (size_t i = 0; i < count; ++i) {
+      if (visible[i]) {
+        culled->push_back(objects[begin + i]);
+      }
+    }
+  }
+}
+
+void RenderSystemNext::RequestTextureSizes(const RenderObjectVector& objects,
+                                           const RenderView* views,
+                                           size_t num_views) {
+  for (const RenderObject& obj : objects) {
+    if (!obj.material) {
+      continue;
+    }
+    // Estimate the number of pixels across the object's bounding sphere in the
+    // view in which it is largest.  Objects without bounds get full detail.
+    float screen_size =
+        obj.world_radius > 0.f ? 0.f : std::numeric_limits<float>::max();
+    for (size_t i = 0; i < num_views && obj.world_radius > 0.f; ++i) {
+      const RenderView& view = views[i];
+      const float depth =
+          -(view.eye_from_world_matrix * obj.world_position).z;
+      if (depth <= obj.world_radius) {
+        screen_size = std::numeric_limits<float>::max();
+        break;
       }
+      const float pixels_per_unit = view.clip_from_eye_matrix(1, 1) * 0.5f *
+                                    static_cast<float>(view.dimensions.y) /
+                                    depth;
+      screen_size =
+          std::max(screen_size, 2.f * obj.world_radius * pixels_per_unit);
+    }
+    obj.material->ForEachTexture(
+        [this, screen_size](const TexturePtr& texture) {
+          texture_factory_->RequestTextureSize(texture, screen_size);
+        });
+  }
+}
+
+size_t RenderSystemNext::CountInstanceableObjects(
+    const RenderObjectVector& objects, size_t index) {
+  const RenderObject& first = objects[index];
+  if (first.mesh == nullptr || first.material == nullptr) {
+    return 1;
+  }
+  const ShaderPtr& shader = first.material->GetShader();
+  if (shader == nullptr || !shader->IsUniformBlock(kInstanceDataHash)) {
+    return 1;
+  }
+
+  const HashValue color_hash = Hash(kColorUniform);
+  const size_t end = std::min(objects.size(), index + kMaxInstancesPerDraw);
+  size_t count = 1;
+  while (index + count < end) {
+    const RenderObject& obj = objects[index + count];
+    if (obj.mesh != first.mesh || obj.submesh_index != first.submesh_index ||
+        obj.material == nullptr) {
+      break;
     }
+    if (obj.material != first.material &&
+        !obj.material->IsInstanceCompatible(*first.material, color_hash)) {
+      break;
+    }
+    ++count;
+  }
+  return count;
+}
+
+void RenderSystemNext::UpdateInstanceBuffer(const RenderObject* render_objects,
+                                            size_t count) {
+  const size_t buffer_size =
+      kInstanceMatricesSize + kMaxInstancesPerDraw * kInstanceColorSize;
+  instance_data_.resize(buffer_size);
+  uint8_t* matrices = instance_data_.data();
+  uint8_t* colors = instance_data_.data() + kInstanceMatricesSize;
+
+  // Materials without a color are drawn untinted.
+  const HashValue color_hash = Hash(kColorUniform);
+  for (size_t i = 0; i < count; ++i) {
+    const RenderObject& obj = render_objects[i];
+    memcpy(matrices + i * kInstanceMatrixSize,
+           &obj.world_from_entity_matrix[0], kInstanceMatrixSize);
+
+    const detail::UniformData* color =
+        obj.material->GetUniformData(color_hash);
+    mathfu::vec4 color_value = mathfu::kOnes4f;
+    if (color && color->Type() == ShaderDataType_Float4) {
+      color_value = mathfu::vec4(color->GetData<float>());
+    }
+    color_value *= obj.color_multiplier;
+    memcpy(colors + i * kInstanceColorSize, &color_value[0],
+           kInstanceColorSize);
+  }
+}
+
+void RenderSystemNext::UploadInstanceBuffer(size_t count) {
+  if (!instance_ubo_.Valid()) {
+    GLuint gl_ubo = 0;
+    GL_CALL(glGenBuffers(1, &gl_ubo));
+    instance_ubo_ = gl_ubo;
   }
+
+  // Orphan the previous contents so that the driver does not need to wait for
+  // earlier draws that are still reading from the buffer.
+  const uint8_t* matrices = instance_data_.data();
+  const uint8_t* colors = instance_data_.data() + kInstanceMatricesSize;
+  GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, *instance_ubo_));
+  GL_CALL(glBufferData(GL_UNIFORM_BUFFER, instance_data_.size(), nullptr,
+                       GL_STREAM_DRAW));
+  GL_CALL(glBufferSubData(GL_UNIFORM_BUFFER, 0, count * kInstanceMatrixSize,
+                          matrices));
+  GL_CALL(glBufferSubData(GL_UNIFORM_BUFFER, kInstanceMatricesSize,
+                          count * kInstanceColorSize, colors));
+  GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, 0));
 }
 
 void RenderSystemNext::BindShader(const ShaderPtr& shader) {
@@ -1514,11 +2127,16 @@ void RenderSystemNext::RenderDebugStats(const RenderView* views,
                "GPU ms         %0.2f\n"
                "# draws        %d\n"
                "# shader swaps %d\n"
+               "# mat swaps    %d\n"
+               "# mesh swaps   %d\n"
+               "# state chgs   %d\n"
                "# verts        %d\n"
                "# tris         %d",
                profiler->GetFilteredFps(), profiler->GetCpuFrameMs(),
                profiler->GetGpuFrameMs(), profiler->GetNumDraws(),
-               profiler->GetNumShaderSwaps(), profiler->GetNumVerts(),
+               profiler->GetNumShaderSwaps(), profiler->GetNumMaterialSwaps(),
+               profiler->GetNumMeshSwaps(),
+               profiler->GetNumRenderStateChanges(), profiler->GetNumVerts(),
                profiler->GetNumTris());
       text.Print(buf);
     } else if (profiler) {
@@ -1866,6 +2484,24 @@ namespace {
 inline float GetZBackToFrontXOutToMiddleDistance(const mathfu::vec3& pos) {
   return pos.z - std::abs(pos.x);
 }
+
+// Hashes |ptr| into 16 bits.  Different pointers can collide, which only makes
+// the grouping of objects slightly less effective.
+inline uint64_t GetStateSortKeyBits(const void* ptr) {
+  const uint64_t value =
+      static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr));
+  return (value * 0x9e3779b97f4a7c15ull) >> 48;
+}
+
+// Returns a key which groups draws by their shader, then texture, then
+// material, and then mesh, since rebinding those is roughly decreasingly
+// expensive.
+inline uint64_t GetStateSortKey(const void* shader, const void* texture,
+                                const void* material, const void* mesh) {
+  return (GetStateSortKeyBits(shader) << 48) |
+         (GetStateSortKeyBits(texture) << 32) |
+         (GetStateSortKeyBits(material) << 16) | GetStateSortKeyBits(mesh);
+}
 }  // namespace
 
 void RenderSystemNext::SortObjects(std::vector<RenderObject>* objects,
@@ -1906,6 +2542,23 @@ void RenderSystemNext::SortObjects(std::vector<RenderObject>* objects,
                 });
       break;
 
+    case SortMode_MinimizeStateChanges:
+      for (RenderObject& obj : *objects) {
+        const TexturePtr texture =
+            obj.material ? obj.material->GetTexture(TextureUsageInfo(0))
+                         : nullptr;
+        obj.state_sort_key = GetStateSortKey(
+            obj.material ? obj.material->GetShader().get() : nullptr,
+            texture.get(), obj.material.get(), obj.mesh.get());
+      }
+      // Use a stable sort so that objects with the same state keep their
+      // relative order.
+      std::stable_sort(objects->begin(), objects->end(),
+                       [](const RenderObject& a, const RenderObject& b) {
+                         return a.state_sort_key < b.state_sort_key;
+                       });
+      break;
+
     case SortMode_WorldSpaceZBackToFrontXOutToMiddle:
       std::sort(objects->begin(), objects->end(),
                 [](const RenderObject& a, const RenderObject& b) {
@@ -2092,6 +2745,104 @@ ImageData RenderSystemNext::GetRenderTargetData(HashValue render_target_name) {
   return iter->second->GetFrameBufferData();
 }
 
+void RenderSystemNext::ReadRenderTargetDataAsync(HashValue render_target_name,
+                                                 const mathfu::recti& rect) {
+  auto iter = render_targets_.find(render_target_name);
+  if (iter == render_targets_.end()) {
+    LOG(DFATAL) << "ReadRenderTargetDataAsync called with non-existent render "
+                   "target: "
+                << render_target_name;
+    return;
+  }
+  iter->second->BeginReadPixels(rect);
+}
+
+ImageData RenderSystemNext::TakeRenderTargetData(HashValue render_target_name) {
+  auto iter = render_targets_.find(render_target_name);
+  if (iter == render_targets_.end()) {
+    LOG(DFATAL) << "TakeRenderTargetData called with non-existent render "
+                   "target: "
+                << render_target_name;
+    return ImageData();
+  }
+  return iter->second->TakeReadPixels();
+}
+
+void RenderSystemNext::RequestRenderTargetData(
+    HashValue render_target_name, RenderSystem::RenderTargetDataFn fn,
+    const mathfu::vec2i& size) {
+  RenderTargetReadback readback;
+  readback.render_target = render_target_name;
+  readback.size = size;
+  readback.fn = std::move(fn);
+  std::lock_guard<std::mutex> lock(readback_mutex_);
+  requested_readbacks_.emplace_back(std::move(readback));
+}
+
+void RenderSystemNext::StartReadbacks() {
+  std::vector<RenderTargetReadback> readbacks;
+  {
+    std::lock_guard<std::mutex> lock(readback_mutex_);
+    readbacks.swap(requested_readbacks_);
+  }
+
+  std::vector<RenderTargetReadback> deferred;
+  for (RenderTargetReadback& readback : readbacks) {
+    auto iter = render_targets_.find(readback.render_target);
+    if (iter == render_targets_.end()) {
+      LOG(DFATAL) << "RequestRenderTargetData called with non-existent render "
+                     "target: "
+                  << readback.render_target;
+      readback.fn(ImageData());
+      continue;
+    }
+    if (active_readbacks_.count(readback.render_target) != 0) {
+      // A render target only has one read in flight at a time.
+      deferred.emplace_back(std::move(readback));
+      continue;
+    }
+
+    RenderTarget* render_target = iter->second.get();
+    const mathfu::recti rect(mathfu::kZeros2i, render_target->GetDimensions());
+    const mathfu::vec2i size =
+        readback.size.x > 0 && readback.size.y > 0 ? readback.size : rect.size;
+    render_target->BeginReadPixels(rect, size);
+    active_readbacks_[readback.render_target] = std::move(readback);
+  }
+
+  if (!deferred.empty()) {
+    std::lock_guard<std::mutex> lock(readback_mutex_);
+    requested_readbacks_.insert(requested_readbacks_.begin(),
+                                std::make_move_iterator(deferred.begin()),
+                                std::make_move_iterator(deferred.end()));
+  }
+}
+
+void RenderSystemNext::FinishReadbacks() {
+  std::vector<std::pair<RenderTargetReadback, ImageData>> finished;
+  for (auto iter = active_readbacks_.begin();
+       iter != active_readbacks_.end();) {
+    auto target = render_targets_.find(iter->first);
+    if (target == render_targets_.end()) {
+      // The render target was replaced or removed.
+      finished.emplace_back(std::move(iter->second), ImageData());
+      iter = active_readbacks_.erase(iter);
+      continue;
+    }
+    ImageData data = target->second->TakeReadPixels();
+    if (target->second->IsReadingPixels()) {
+      ++iter;
+      continue;
+    }
+    finished.emplace_back(std::move(iter->second), std::move(data));
+    iter = active_readbacks_.erase(iter);
+  }
+  // Called after updating |active_readbacks_| in case they request more.
+  for (auto& readback : finished) {
+    readback.first.fn(std::move(readback.second));
+  }
+}
+
 void RenderSystemNext::ForEachComponent(const Drawable& drawable,
                                         const OnMutableComponentFn& fn) {
   if (drawable.pass) {
@@ -18,6 +18,7 @@ limitations under the License.
 #define LULLABY_SYSTEMS_RENDER_NEXT_RENDER_SYSTEM_NEXT_H_
 
 #include <array>
+#include <mutex>
 #include <queue>
 #include <set>
 #include <string>
@@ -31,6 +32,9 @@ limitations under the License.
 #include "lullaby/modules/render/mesh_data.h"
 #include "lullaby/modules/render/vertex.h"
 #include "lullaby/systems/render/detail/sort_order.h"
+#include "lullaby/systems/render/detail/subtree_color_multipliers.h"
+#include "lullaby/systems/render/dynamic_resolution.h"
+#include "lullaby/systems/render/next/draw_commands.h"
 #include "lullaby/systems/render/next/material.h"
 #include "lullaby/systems/render/next/mesh.h"
 #include "lullaby/systems/render/next/mesh_factory.h"
@@ -80,6 +84,12 @@ class RenderSystemNext : public System {
   void CreateRenderTarget(HashValue render_target_name,
                           const RenderTargetCreateParams& create_params);
   ImageData GetRenderTargetData(HashValue render_target_name);
+  void ReadRenderTargetDataAsync(HashValue render_target_name,
+                                 const mathfu::recti& rect);
+  ImageData TakeRenderTargetData(HashValue render_target_name);
+  void RequestRenderTargetData(HashValue render_target_name,
+                               RenderSystem::RenderTargetDataFn fn,
+                               const mathfu::vec2i& size);
 
   // Render pass configuration functions.
   void SetDefaultRenderPass(HashValue pass);
@@ -90,6 +100,7 @@ class RenderSystemNext : public System {
   void SetSortMode(HashValue pass, SortMode mode);
   void SetSortVector(HashValue pass, const mathfu::vec3& vector);
   void SetCullMode(HashValue pass, RenderCullMode mode);
+  void SetInstancingEnabled(HashValue pass, bool enabled);
 
   // Entity creation/destruction functions.
   void Create(Entity entity, HashValue type, const Def* def) override;
@@ -133,6 +144,10 @@ class RenderSystemNext : public System {
   void SetDefaultColor(Entity entity, const mathfu::vec4& color);
   bool GetColor(Entity entity, mathfu::vec4* color) const;
   void SetColor(Entity entity, const mathfu::vec4& color);
+  void SetSubtreeColorMultiplier(Entity entity, const mathfu::vec4& multiplier);
+  void ClearSubtreeColorMultiplier(Entity entity);
+  bool GetSubtreeColorMultiplier(Entity entity,
+                                 mathfu::vec4* multiplier) const;
 
   // Texture functions.
   void SetTexture(const Drawable& drawable, TextureUsageInfo usage,
@@ -191,12 +206,19 @@ class RenderSystemNext : public System {
     std::shared_ptr<Material> material;
     // The world-space transform of the object being drawn.
     mathfu::mat4 world_from_entity_matrix;
+    // The subtree color multiplier inherited by the object, applied to the
+    // material's color when drawn.
+    mathfu::vec4 color_multiplier = mathfu::kOnes4f;
     // The position in world space.
     mathfu::vec3 world_position;
+    // The radius of a world space bounding sphere centered on |world_position|,
+    // used for frustum culling and to estimate the size of textures on screen.
+    float world_radius = 0.f;
     // A value used to optionally sort the RenderObjects.
     union {
       RenderSortOrder sort_order;
       double depth_sort_order;
+      uint64_t state_sort_key;
     };
     // A negative submesh index indicates a request to draw the entire mesh.
     int submesh_index = -1;
@@ -211,6 +233,7 @@ class RenderSystemNext : public System {
     SortMode sort_mode = SortMode_None;
     RenderCullMode cull_mode = RenderCullMode::kNone;
     HashValue render_target = 0;
+    bool instancing_enabled = false;
 
     ComponentPool<RenderComponent> components;
   };
@@ -223,6 +246,7 @@ class RenderSystemNext : public System {
     RenderStateT render_state;
     SortMode sort_mode = SortMode_None;
     RenderCullMode cull_mode = RenderCullMode::kNone;
+    bool instancing_enabled = false;
     RenderObjectVector render_objects;
   };
 
@@ -235,16 +259,99 @@ class RenderSystemNext : public System {
     RenderLayer layers[kNumLayers];
   };
 
+  /// A copy of a Material owned by the render thread, see
+  /// Material::UpdateSnapshot.
+  struct MaterialSnapshot {
+    std::weak_ptr<Material> source;
+    std::shared_ptr<Material> material;
+    bool used = false;
+  };
+
   /// The complete set of passes and associated data for drawing the frame.
-  using RenderData = std::unordered_map<HashValue, RenderPassDrawContainer>;
+  /// Everything the render thread reads is copied in here by SubmitRenderData,
+  /// so the next frame can be simulated while this one is drawn.
+  struct RenderData {
+    std::unordered_map<HashValue, RenderPassDrawContainer> passes;
+    /// Snapshots of the materials of the RenderObjects in |passes|, keyed by
+    /// the source material.
+    std::unordered_map<const Material*, MaterialSnapshot> materials;
+  };
+
+  /// The draws recorded for a RenderLayer.  The culled objects are stored in
+  /// |culled| if the layer is culled, otherwise the layer's own objects are
+  /// drawn directly.
+  struct LayerCommands {
+    const RenderLayer* layer = nullptr;
+    const RenderObjectVector* objects = nullptr;
+    RenderObjectVector culled;
+    std::vector<DrawCommand> draws;
+  };
+
+  /// The commands recorded for a pass.  Recording performs all of the CPU work
+  /// of drawing a pass (view-dependent sorting, culling and instance batching)
+  /// without issuing any GL calls, so that several passes can be recorded in
+  /// parallel and then executed in order on the render thread.  The storage is
+  /// reused from frame to frame.
+  struct PassCommands {
+    HashValue pass = 0;
+    RenderPassDrawContainer* container = nullptr;
+    LayerCommands layers[RenderPassDrawContainer::kNumLayers];
+  };
 
   void RenderAt(const RenderObject* render_object,
                 const RenderStateT& render_state, const RenderView* views,
                 size_t num_views);
 
+  /// Draws |count| consecutive RenderObjects that share a mesh and compatible
+  /// materials using a single instanced draw call.
+  void RenderInstancedAt(const RenderObject* render_objects, size_t count,
+                         const RenderStateT& render_state,
+                         const RenderView* views, size_t num_views);
+
+  /// Executes the recorded |draws| of the |objects|.
   void RenderObjects(const RenderObjectVector& objects,
                      const RenderStateT& render_state, const RenderView* views,
-                     size_t num_views);
+                     size_t num_views, const std::vector<DrawCommand>& draws);
+
+  /// Records the commands for drawing |pass| with the |views| into |commands|.
+  /// Does not issue any GL calls and only modifies the pass's own data, so
+  /// different passes can be recorded concurrently.
+  void RecordPass(const RenderView* views, size_t num_views, HashValue pass,
+                  bool supports_instancing, PassCommands* commands);
+
+  /// Records the |num_passes| |passes| into |pass_commands_|, in parallel on
+  /// the JobProcessor if there is one.
+  void RecordPasses(const RenderView* const* views, size_t num_views,
+                    const HashValue* passes, size_t num_passes);
+
+  /// Executes the previously recorded |commands| on the render thread.
+  void ExecutePass(const RenderView* views, size_t num_views,
+                   const PassCommands& commands);
+
+  /// Fills |culled| with the |objects| that are inside the frustum of any of
+  /// the views.  When possible the views are culled together using a single
+  /// frustum enclosing them all (eg. both eyes in stereo multiview).
+  static void CullObjects(const RenderObjectVector& objects,
+                          const RenderView* views, size_t num_views,
+                          RenderObjectVector* culled);
+
+  /// Requests enough texture detail from the TextureFactory's texture budget
+  /// for the size of each of the |objects| on screen.
+  void RequestTextureSizes(const RenderObjectVector& objects,
+                           const RenderView* views, size_t num_views);
+
+  /// Returns the number of objects starting at |index| that can be drawn
+  /// together by RenderInstancedAt.
+  static size_t CountInstanceableObjects(const RenderObjectVector& objects,
+                                         size_t index);
+
+  /// Copies the per-instance data of |count| RenderObjects into
+  /// |instance_data_|.
+  void UpdateInstanceBuffer(const RenderObject* render_objects, size_t count);
+
+  /// Uploads the first |count| instances in |instance_data_| into
+  /// |instance_ubo_|.  Used when the uniform buffer ring is unavailable.
+  void UploadInstanceBuffer(size_t count);
 
   void SetMeshImpl(Entity entity, HashValue pass, const MeshPtr& mesh);
 
@@ -302,6 +409,10 @@ class RenderSystemNext : public System {
   /// and RenderPass_OverDrawGlow.
   void InitDefaultRenderPassObjects();
 
+  /// Returns the snapshot of |material| in |data|, bringing it up to date.
+  static const std::shared_ptr<Material>& GetMaterialSnapshot(
+      RenderData* data, const std::shared_ptr<Material>& material);
+
   // Returns a render pass. This creates the pass if needed.
   RenderPassObject* GetRenderPassObject(HashValue pass);
   // Returns a render pass or nullptr if the pass doesn't exist.
@@ -352,9 +463,23 @@ class RenderSystemNext : public System {
   void RebuildShader(RenderComponent* component, int submesh_index,
                      std::shared_ptr<Material> material);
 
+  // Renders the default passes.
+  void RenderDefaultPasses(const RenderView* views, size_t num_views);
+
+  // Renders the default passes that draw into the bound framebuffer at the
+  // DynamicResolution's scale into |scaled_target_|, and then upscales the
+  // result into the bound framebuffer.
+  void RenderScaled(const RenderView* views, size_t num_views,
+                    DynamicResolution* dynamic_resolution);
+
+  // Returns the GPU time of the passes that drew into the bound framebuffer in
+  // the last frame with available timings.
+  float GetScaledPassesGpuMs() const;
+
   NextRenderer renderer_;
   fplbase::RenderState render_state_;
   detail::SortOrderManager sort_order_manager_;
+  detail::SubtreeColorMultipliers subtree_color_multipliers_;
 
   /// Factories used for creating rendering-related objects.
   MeshFactoryImpl* mesh_factory_;
@@ -376,10 +501,46 @@ class RenderSystemNext : public System {
   std::unordered_map<HashValue, RenderPassObject> render_passes_;
   std::unordered_map<HashValue, std::shared_ptr<RenderTarget>> render_targets_;
 
+  // A copy of a render target requested by RequestRenderTargetData.
+  struct RenderTargetReadback {
+    HashValue render_target = 0;
+    mathfu::vec2i size = {0, 0};
+    RenderSystem::RenderTargetDataFn fn;
+  };
+
+  // Starts the requested readbacks once the frame has been rendered.
+  void StartReadbacks();
+
+  // Delivers the data of the readbacks the GPU has finished.
+  void FinishReadbacks();
+
+  // Readbacks that have been requested but not started, guarded by
+  // |readback_mutex_| since they may be requested from any thread.
+  std::mutex readback_mutex_;
+  std::vector<RenderTargetReadback> requested_readbacks_;
+
+  // Readbacks waiting for the GPU, by render target.  Only accessed by the
+  // render thread.
+  std::unordered_map<HashValue, RenderTargetReadback> active_readbacks_;
+
+  // The offscreen target used for dynamic resolution, and the scale at which
+  // passes without their own render target draw into it while it is active.
+  std::unique_ptr<RenderTarget> scaled_target_;
+  RenderTarget* active_scaled_target_ = nullptr;
+  float active_scale_ = 1.0f;
+
   // Cached state for immediate mode rendering.
   ShaderPtr bound_shader_;
   std::vector<TexturePtr> bound_textures_;
 
+  // Uniform buffer (and its CPU-side staging data) holding the per-instance
+  // data for instanced draws.
+  UniformBufferHnd instance_ubo_;
+  std::vector<uint8_t> instance_data_;
+
+  // The commands recorded for the passes being rendered.
+  std::vector<PassCommands> pass_commands_;
+
   std::string shading_model_path_;
   RenderFrontFace default_front_face_ = RenderFrontFace::kCounterClockwise;
 
@@ -16,7 +16,15 @@ limitations under the License.
 
 #include "lullaby/systems/render/next/render_target.h"
 
+#include <string.h>
+
 #include "lullaby/systems/render/next/gl_helpers.h"
+#include "mathfu/constants.h"
+
+// Pixel pack buffers and fences are part of GLES3 & GL3.2 specs.
+#if GL_ES_VERSION_3_0 || defined(GL_VERSION_3_2)
+#define LULLABY_RENDER_TARGET_ASYNC_READS 1
+#endif
 
 namespace {
 const int kRgbaStride = 4;
@@ -101,6 +109,23 @@ RenderTarget::RenderTarget(const RenderTargetCreateParams& create_params)
 }
 
 RenderTarget::~RenderTarget() {
+#if LULLABY_RENDER_TARGET_ASYNC_READS
+  if (read_fence_) {
+    GL_CALL(glDeleteSync(static_cast<GLsync>(read_fence_)));
+  }
+  if (pack_buffer_) {
+    GLuint handle = *pack_buffer_;
+    GL_CALL(glDeleteBuffers(1, &handle));
+  }
+#endif
+  if (scaled_frame_buffer_) {
+    GLuint handle = *scaled_frame_buffer_;
+    GL_CALL(glDeleteFramebuffers(1, &handle));
+  }
+  if (scaled_color_buffer_) {
+    GLuint handle = *scaled_color_buffer_;
+    GL_CALL(glDeleteRenderbuffers(1, &handle));
+  }
   if (frame_buffer_) {
     GLuint handle = *frame_buffer_;
     GL_CALL(glDeleteFramebuffers(1, &handle));
@@ -137,6 +162,24 @@ void RenderTarget::Unbind() const {
   prev_frame_buffer_ = 0;
 }
 
+void RenderTarget::BlitToBoundFrameBuffer(const mathfu::vec2i& src_size,
+                                          const mathfu::vec2i& dst_offset,
+                                          const mathfu::vec2i& dst_size) const {
+  if (!frame_buffer_) {
+    return;
+  }
+  GLint original_read_frame_buffer = 0;
+  GL_CALL(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING,
+                        &original_read_frame_buffer));
+  GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, *frame_buffer_));
+  const GLenum filter = src_size == dst_size ? GL_NEAREST : GL_LINEAR;
+  GL_CALL(glBlitFramebuffer(0, 0, src_size.x, src_size.y, dst_offset.x,
+                            dst_offset.y, dst_offset.x + dst_size.x,
+                            dst_offset.y + dst_size.y, GL_COLOR_BUFFER_BIT,
+                            filter));
+  GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, original_read_frame_buffer));
+}
+
 ImageData RenderTarget::GetFrameBufferData() const {
   if (!frame_buffer_) {
     LOG(WARNING) << "No Framebuffer!";
@@ -167,4 +210,145 @@ ImageData RenderTarget::GetFrameBufferData() const {
 
   return ImageData(ImageData::kRgba8888, dimensions_, std::move(container));
 }
+
+void RenderTarget::BeginReadPixels(const mathfu::recti& rect) {
+  BeginReadPixels(rect, rect.size);
+}
+
+void RenderTarget::PrepareScaledFrameBuffer(const mathfu::vec2i& size) {
+  if (scaled_frame_buffer_ && size == scaled_size_) {
+    return;
+  }
+  GLint prev_frame_buffer = 0;
+  GLint prev_render_buffer = 0;
+  GL_CALL(glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_frame_buffer));
+  GL_CALL(glGetIntegerv(GL_RENDERBUFFER_BINDING, &prev_render_buffer));
+
+  if (!scaled_frame_buffer_) {
+    GLuint gl_framebuffer_id = 0;
+    GL_CALL(glGenFramebuffers(1, &gl_framebuffer_id));
+    scaled_frame_buffer_ = gl_framebuffer_id;
+    GLuint gl_renderbuffer_id = 0;
+    GL_CALL(glGenRenderbuffers(1, &gl_renderbuffer_id));
+    scaled_color_buffer_ = gl_renderbuffer_id;
+  }
+  GL_CALL(glBindRenderbuffer(GL_RENDERBUFFER, *scaled_color_buffer_));
+  GL_CALL(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y));
+  GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, *scaled_frame_buffer_));
+  GL_CALL(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                    GL_RENDERBUFFER, *scaled_color_buffer_));
+  DCHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+  scaled_size_ = size;
+
+  GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, prev_frame_buffer));
+  GL_CALL(glBindRenderbuffer(GL_RENDERBUFFER, prev_render_buffer));
+}
+
+void RenderTarget::BeginReadPixels(const mathfu::recti& rect,
+                                   const mathfu::vec2i& size) {
+  if (!frame_buffer_) {
+    LOG(WARNING) << "No Framebuffer!";
+    return;
+  }
+#if LULLABY_RENDER_TARGET_ASYNC_READS
+  if (read_fence_) {
+    GL_CALL(glDeleteSync(static_cast<GLsync>(read_fence_)));
+    read_fence_ = nullptr;
+  }
+#endif
+  read_data_ = ImageData();
+  read_size_ = size;
+  read_pending_ = true;
+
+  GLint prev_read_frame_buffer = 0;
+  GL_CALL(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prev_read_frame_buffer));
+  GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, *frame_buffer_));
+  GL_CALL(glReadBuffer(GL_COLOR_ATTACHMENT0));
+  GL_CALL(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+
+  // Scale the region on the GPU so that only |size| pixels are read back.
+  mathfu::recti read_rect = rect;
+  if (size != rect.size) {
+    PrepareScaledFrameBuffer(size);
+    GLint prev_draw_frame_buffer = 0;
+    GL_CALL(
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prev_draw_frame_buffer));
+    GL_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, *scaled_frame_buffer_));
+    GL_CALL(glBlitFramebuffer(rect.pos.x, rect.pos.y, rect.pos.x + rect.size.x,
+                              rect.pos.y + rect.size.y, 0, 0, size.x, size.y,
+                              GL_COLOR_BUFFER_BIT, GL_LINEAR));
+    GL_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, prev_draw_frame_buffer));
+    GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, *scaled_frame_buffer_));
+    GL_CALL(glReadBuffer(GL_COLOR_ATTACHMENT0));
+    read_rect = mathfu::recti(mathfu::kZeros2i, size);
+  }
+
+  const int num_bytes = size.x * size.y * kRgbaStride;
+#if LULLABY_RENDER_TARGET_ASYNC_READS
+  if (!pack_buffer_) {
+    GLuint gl_buffer_id = 0;
+    GL_CALL(glGenBuffers(1, &gl_buffer_id));
+    pack_buffer_ = gl_buffer_id;
+  }
+  GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, *pack_buffer_));
+  if (num_bytes > pack_buffer_size_) {
+    GL_CALL(glBufferData(GL_PIXEL_PACK_BUFFER, num_bytes, nullptr,
+                         GL_STREAM_READ));
+    pack_buffer_size_ = num_bytes;
+  }
+  // With a pack buffer bound, glReadPixels only queues the copy.
+  GL_CALL(glReadPixels(read_rect.pos.x, read_rect.pos.y, read_rect.size.x,
+                       read_rect.size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+  GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+  read_fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#else
+  DataContainer container = DataContainer::CreateHeapDataContainer(num_bytes);
+  uint8_t* pixels = container.GetAppendPtr(num_bytes);
+  GL_CALL(glReadPixels(read_rect.pos.x, read_rect.pos.y, read_rect.size.x,
+                       read_rect.size.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+  read_data_ =
+      ImageData(ImageData::kRgba8888, read_size_, std::move(container));
+#endif
+
+  GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, prev_read_frame_buffer));
+}
+
+ImageData RenderTarget::TakeReadPixels() {
+  if (!read_pending_) {
+    return ImageData();
+  }
+#if LULLABY_RENDER_TARGET_ASYNC_READS
+  const GLsync sync = static_cast<GLsync>(read_fence_);
+  const GLenum result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+  if (result == GL_TIMEOUT_EXPIRED) {
+    return ImageData();
+  }
+  GL_CALL(glDeleteSync(sync));
+  read_fence_ = nullptr;
+  read_pending_ = false;
+  if (result == GL_WAIT_FAILED) {
+    LOG(ERROR) << "Failed to wait for render target read fence.";
+    return ImageData();
+  }
+
+  const int size = read_size_.x * read_size_.y * kRgbaStride;
+  GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, *pack_buffer_));
+  const void* mapped =
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+  if (mapped == nullptr) {
+    LOG(ERROR) << "Failed to map render target pixels.";
+    GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    return ImageData();
+  }
+  DataContainer container = DataContainer::CreateHeapDataContainer(size);
+  memcpy(container.GetAppendPtr(size), mapped, size);
+  GL_CALL(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+  GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+  return ImageData(ImageData::kRgba8888, read_size_, std::move(container));
+#else
+  read_pending_ = false;
+  return std::move(read_data_);
+#endif
+}
+
 }  // namespace lull
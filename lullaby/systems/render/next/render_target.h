@@ -46,6 +46,33 @@ class RenderTarget {
   // Gets the framebuffer data.
   ImageData GetFrameBufferData() const;
 
+  // Starts copying the |rect| region of the framebuffer into a pixel pack
+  // buffer without waiting for the GPU to finish rendering.  Any previous read
+  // that has not been taken is discarded.
+  void BeginReadPixels(const mathfu::recti& rect);
+
+  // As above, but first scales the |rect| region to |size| on the GPU, eg. to
+  // read back a thumbnail.
+  void BeginReadPixels(const mathfu::recti& rect, const mathfu::vec2i& size);
+
+  // Returns the pixels requested by the last BeginReadPixels() once the GPU
+  // has written them.  Returns an empty ImageData if they are not ready yet, or
+  // if there is no read in progress.
+  ImageData TakeReadPixels();
+
+  // Returns true if a read started by BeginReadPixels() has not been taken.
+  bool IsReadingPixels() const { return read_pending_; }
+
+  // Copies the |src_size| region at the origin of the render target into the
+  // |dst_size| region at |dst_offset| of the currently bound draw framebuffer,
+  // filtering linearly if the sizes differ.
+  void BlitToBoundFrameBuffer(const mathfu::vec2i& src_size,
+                              const mathfu::vec2i& dst_offset,
+                              const mathfu::vec2i& dst_size) const;
+
+  // Returns the width and height of the render target.
+  const mathfu::vec2i& GetDimensions() const { return dimensions_; }
+
  private:
   BufferHnd frame_buffer_;
   BufferHnd depth_buffer_;
@@ -53,6 +80,23 @@ class RenderTarget {
   mathfu::vec2i dimensions_ = {0, 0};
   int num_mip_levels_ = 0;
   mutable int prev_frame_buffer_ = 0;
+
+  // Creates or resizes the framebuffer that reads are scaled into.
+  void PrepareScaledFrameBuffer(const mathfu::vec2i& size);
+
+  // The framebuffer that reads are scaled into, with its color buffer.
+  BufferHnd scaled_frame_buffer_;
+  BufferHnd scaled_color_buffer_;
+  mathfu::vec2i scaled_size_ = {0, 0};
+
+  // The state of the asynchronous read.  |read_fence_| is a GLsync, and
+  // |read_data_| holds the pixels if they had to be read synchronously.
+  BufferHnd pack_buffer_;
+  int pack_buffer_size_ = 0;
+  void* read_fence_ = nullptr;
+  mathfu::vec2i read_size_ = {0, 0};
+  ImageData read_data_;
+  bool read_pending_ = false;
 };
 
 }  // namespace lull
@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #include "lullaby/systems/render/next/shader.h"
+#include <algorithm>
 #include <vector>
 
 #include "lullaby/generated/flatbuffers/shader_def_generated.h"
@@ -69,7 +70,8 @@ std::vector<uint8_t> BuildDefaultDataBuffer(const ShaderUniformDefT& parent) {
 }  // namespace
 
 void Shader::Init(ProgramHnd program, ShaderHnd vs, ShaderHnd fs) {
-  if (!program || !vs || !fs) {
+  // Programs loaded from binaries have no shader objects.
+  if (!program || (vs && !fs) || (!vs && fs)) {
     LOG(DFATAL) << "Initializing shader with invalid objects.";
     return;
   }
@@ -96,6 +98,9 @@ void Shader::Init(ProgramHnd program, ShaderHnd vs, ShaderHnd fs) {
     }
     const UniformHnd location = glGetUniformLocation(*program, name);
     uniforms_[Hash(name)] = location;
+    if (size > 1) {
+      uniform_array_sizes_[Hash(name)] = size;
+    }
   }
 
   if (NextRenderer::SupportsUniformBufferObjects()) {
@@ -171,6 +176,11 @@ UniformHnd Shader::FindUniform(HashValue hash) const {
   return iter != uniforms_.end() ? iter->second : UniformHnd();
 }
 
+int Shader::GetUniformArraySize(HashValue hash) const {
+  auto iter = uniform_array_sizes_.find(hash);
+  return iter != uniform_array_sizes_.end() ? iter->second : 1;
+}
+
 UniformHnd Shader::FindUniformBlock(HashValue hash) const {
   auto iter = uniform_blocks_.find(hash);
   return iter != uniform_blocks_.end() ? iter->second : UniformHnd();
@@ -186,6 +196,7 @@ bool Shader::SetUniform(HashValue name, const int* data, size_t len,
                         int count) {
   UniformHnd id = FindUniform(name);
   if (program_ && id) {
+    count = std::min(count, GetUniformArraySize(name));
     switch (len) {
       case 1:
         GL_CALL(glUniform1iv(*id, count, data));
@@ -210,6 +221,7 @@ bool Shader::SetUniform(HashValue name, const float* data, size_t len,
                         int count) {
   UniformHnd id = FindUniform(name);
   if (program_ && id) {
+    count = std::min(count, GetUniformArraySize(name));
     switch (len) {
       case 1:
         GL_CALL(glUniform1fv(*id, count, data));
@@ -305,6 +317,20 @@ void Shader::BindUniformBlock(HashValue name, UniformBufferHnd ubo) {
   GL_CALL(glBindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(*hnd), *ubo));
 }
 
+void Shader::BindUniformBlockRange(HashValue name, UniformBufferHnd ubo,
+                                   size_t offset, size_t size) {
+  if (!ubo) {
+    return;
+  }
+  UniformHnd hnd = FindUniformBlock(name);
+  if (!hnd) {
+    return;
+  }
+  GL_CALL(glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(*hnd), *ubo,
+                            static_cast<GLintptr>(offset),
+                            static_cast<GLsizeiptr>(size)));
+}
+
 void Shader::BindSampler(TextureUsageInfo usage, const TexturePtr& texture) {
   auto iter = samplers_.find(usage);
   if (iter == samplers_.end()) {
@@ -46,7 +46,10 @@ class Shader {
 
   bool IsUniformBlock(HashValue name) const;
 
-  // Sets the data for the specified uniform.
+  // Sets the data for the specified uniform.  For uniform arrays, |count| is
+  // clamped to the number of elements declared by the shader, so per-view
+  // arrays (eg. for multiview) can be passed to shaders that only declare a
+  // single element.
   bool SetUniform(HashValue name, const int* data, size_t len, int count = 1);
   bool SetUniform(HashValue name, const float* data, size_t len, int count = 1);
 
@@ -60,6 +63,8 @@ class Shader {
   void BindSampler(TextureUsageInfo usage, const TexturePtr& texture);
   void BindUniform(HashValue name, ShaderDataType type, Span<uint8_t> data);
   void BindUniformBlock(HashValue name, UniformBufferHnd ubo);
+  void BindUniformBlockRange(HashValue name, UniformBufferHnd ubo,
+                             size_t offset, size_t size);
   void BindShaderUniformDef(const ShaderUniformDefT& uniform);
   void BindShaderSamplerDef(const ShaderSamplerDefT& sampler);
 
@@ -68,6 +73,7 @@ class Shader {
   void Init(ProgramHnd program, ShaderHnd vs, ShaderHnd fs);
 
   UniformHnd FindUniform(HashValue hash) const;
+  int GetUniformArraySize(HashValue hash) const;
   UniformHnd FindUniformBlock(HashValue hash) const;
   UniformBufferHnd GetDefaultUbo(const ShaderUniformDefT& uniform);
   void BindTexture(UniformHnd uniform, TextureHnd texture, int type, int unit);
@@ -86,6 +92,8 @@ class Shader {
 
 
   std::unordered_map<HashValue, UniformHnd> uniforms_;
+  // The number of elements of the uniforms that are arrays.
+  std::unordered_map<HashValue, int> uniform_array_sizes_;
   std::unordered_map<HashValue, UniformHnd> uniform_blocks_;
   std::unordered_map<HashValue, UniformBufferHnd> default_ubos_;
   std::unordered_map<TextureUsageInfo, Sampler, TextureUsageInfo::Hasher>
@@ -26,8 +26,10 @@ limitations under the License.
 #include "lullaby/util/flatbuffer_reader.h"
 #include "lullaby/util/hash.h"
 #include "lullaby/util/logging.h"
+#include "lullaby/util/make_unique.h"
 
 namespace lull {
+
 namespace {
 constexpr const char kFallbackVS[] =
     "attribute vec4 aPosition;\n"
@@ -114,6 +116,19 @@ ShaderPtr ShaderFactory::LoadShaderFromDef(const ShaderDefT& shader_def,
     return std::make_shared<Shader>(shader_data.GetDescription());
   }
 
+  // Skip building the program if its binary is already cached.
+  HashValue binary_key = 0;
+  if (program_binary_cache_) {
+    binary_key = program_binary_cache_->GetKey(
+        shader_data.GetStageCode(ShaderStageType_Vertex),
+        shader_data.GetStageCode(ShaderStageType_Fragment));
+    ShaderPtr shader =
+        LoadCachedProgram(binary_key, shader_data.GetDescription());
+    if (shader) {
+      return shader;
+    }
+  }
+
   // Construct the shader handles.
   std::array<ShaderHnd, ShaderData::kNumStages> shader_handles;
   for (int i = static_cast<int>(ShaderStageType_MIN);
@@ -153,6 +168,9 @@ ShaderPtr ShaderFactory::LoadShaderFromDef(const ShaderDefT& shader_def,
     ReleaseShadersArray(shader_handles);
     return nullptr;
   }
+  if (program_binary_cache_) {
+    program_binary_cache_->Save(binary_key, program);
+  }
 
   // Initialize and return the shader.
   ShaderPtr shader = std::make_shared<Shader>(shader_data.GetDescription());
@@ -173,6 +191,36 @@ void ShaderFactory::ReleaseShaderFromCache(HashValue key) {
   shaders_.Release(key);
 }
 
+void ShaderFactory::EnableProgramBinaryCache(const std::string& directory) {
+  if (!ProgramBinaryCache::IsSupported()) {
+    LOG(WARNING) << "Program binaries are not supported.";
+    return;
+  }
+  program_binary_cache_ = MakeUnique<ProgramBinaryCache>(directory);
+}
+
+void ShaderFactory::PrewarmShaders(Span<ShaderCreateParams> params) {
+  for (const ShaderCreateParams& shader_params : params) {
+    ShaderPtr shader = LoadShader(shader_params);
+    if (shader) {
+      prewarmed_shaders_.push_back(std::move(shader));
+    }
+  }
+}
+
+void ShaderFactory::ReleasePrewarmedShaders() { prewarmed_shaders_.clear(); }
+
+ShaderPtr ShaderFactory::LoadCachedProgram(
+    HashValue binary_key, const ShaderDescription& description) {
+  const ProgramHnd program = program_binary_cache_->Load(binary_key);
+  if (!program) {
+    return nullptr;
+  }
+  ShaderPtr shader = std::make_shared<Shader>(description);
+  shader->Init(program, ShaderHnd(), ShaderHnd());
+  return shader;
+}
+
 ShaderPtr ShaderFactory::LoadLullShaderImpl(const std::string& filename,
                                             const ShaderCreateParams& params) {
   auto* asset_loader = registry_->Get<AssetLoader>();
@@ -283,6 +331,12 @@ ProgramHnd ShaderFactory::LinkProgram(ShaderHnd vs, ShaderHnd fs,
 
   GL_CALL(glAttachShader(*program, *vs));
   GL_CALL(glAttachShader(*program, *fs));
+#if LULLABY_PROGRAM_BINARIES
+  if (program_binary_cache_) {
+    GL_CALL(glProgramParameteri(*program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                                GL_TRUE));
+  }
+#endif  // LULLABY_PROGRAM_BINARIES
   if (attributes.empty()) {
     const auto mesh_default_attributes = GetDefaultVertexAttributes();
     for (size_t i = 0; i < mesh_default_attributes.size(); ++i) {
@@ -315,6 +369,16 @@ ProgramHnd ShaderFactory::LinkProgram(ShaderHnd vs, ShaderHnd fs,
 
 ShaderPtr ShaderFactory::CompileAndLink(
     string_view vs_source, string_view fs_source, const std::string& log_name) {
+  HashValue binary_key = 0;
+  if (program_binary_cache_) {
+    binary_key = program_binary_cache_->GetKey(vs_source, fs_source);
+    ShaderPtr shader =
+        LoadCachedProgram(binary_key, ShaderDescription(log_name));
+    if (shader) {
+      return shader;
+    }
+  }
+
   const ShaderHnd vs =
       CompileShader(vs_source, ShaderStageType_Vertex, log_name);
   const ShaderHnd fs =
@@ -326,6 +390,9 @@ ShaderPtr ShaderFactory::CompileAndLink(
   }
 
   if (program && fs && vs) {
+    if (program_binary_cache_) {
+      program_binary_cache_->Save(binary_key, program);
+    }
     ShaderPtr shader = std::make_shared<Shader>(ShaderDescription(log_name));
     shader->Init(program, fs, vs);
     return shader;
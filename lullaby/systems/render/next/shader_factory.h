@@ -17,7 +17,12 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_RENDER_NEXT_SHADER_FACTORY_H_
 #define LULLABY_SYSTEMS_RENDER_NEXT_SHADER_FACTORY_H_
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "lullaby/modules/render/vertex_format.h"
+#include "lullaby/systems/render/next/program_binary_cache.h"
 #include "lullaby/systems/render/next/shader.h"
 #include "lullaby/systems/render/next/shader_data.h"
 #include "lullaby/util/registry.h"
@@ -58,6 +63,20 @@ class ShaderFactory {
   /// Releases the cached shader associated with |key|.
   void ReleaseShaderFromCache(HashValue key);
 
+  /// Stores linked shader programs in |directory| so that later runs can load
+  /// them instead of compiling and linking shaders from source.  Does nothing
+  /// if the GL context does not support program binaries.
+  void EnableProgramBinaryCache(const std::string& directory);
+
+  /// Loads the shaders for all of |params| and keeps them alive until
+  /// ReleasePrewarmedShaders is called, so that later loads are free.  This
+  /// creates GL objects, so it must be called on the render thread, eg. while a
+  /// splash screen is shown.
+  void PrewarmShaders(Span<ShaderCreateParams> params);
+
+  /// Releases the references held by PrewarmShaders.
+  void ReleasePrewarmedShaders();
+
  private:
   ShaderPtr LoadImpl(const ShaderCreateParams& params);
   ShaderPtr LoadShaderFromDef(const ShaderDefT& shader_def,
@@ -76,9 +95,13 @@ class ShaderFactory {
                           const std::string& log_name);
   ProgramHnd LinkProgram(ShaderHnd vs, ShaderHnd fs,
                          Span<ShaderAttributeDefT> attributes = {});
+  ShaderPtr LoadCachedProgram(HashValue binary_key,
+                              const ShaderDescription& description);
 
   Registry* registry_;
   ResourceManager<Shader> shaders_;
+  std::unique_ptr<ProgramBinaryCache> program_binary_cache_;
+  std::vector<ShaderPtr> prewarmed_shaders_;
 };
 
 }  // namespace lull
@@ -109,6 +109,11 @@ TextureHnd Texture::GetResourceId() const {
   return containing_texture_ ? containing_texture_->GetResourceId() : hnd_;
 }
 
+int Texture::GetResidentMipLevel() const {
+  return containing_texture_ ? containing_texture_->GetResidentMipLevel()
+                             : resident_level_;
+}
+
 bool IsTextureLoaded(const TexturePtr& texture) {
   return texture && texture->IsLoaded();
 }
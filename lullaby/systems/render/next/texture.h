@@ -84,13 +84,20 @@ class Texture {
   // Returns the GL resource id.
   TextureHnd GetResourceId() const;
 
+  // Returns the most detailed mip of the image that is resident on the GPU.
+  // This is 0 unless the texture is managed by a texture memory budget, in
+  // which case level 0 of the GL texture holds this mip of the image.
+  int GetResidentMipLevel() const;
+
  private:
   enum Flags {
     kIsExternal = 0x01 << 0,
     kHasMipMaps = 0x01 << 1,
   };
 
+  friend class DynamicTextureAtlas;
   friend class TextureFactoryImpl;
+  friend class TextureStreamer;
   void Init(TextureHnd texture, Target texture_target,
             const mathfu::vec2i& size, uint32_t flags);
   void Init(std::shared_ptr<Texture> containing_texture,
@@ -105,6 +112,10 @@ class Texture {
   mathfu::vec4 uv_bounds_ = mathfu::vec4(0, 0, 1, 1);
 
   std::string name_;
+  int resident_level_ = 0;
+  // The id of the texture in the TextureFactoryImpl's TextureResidency, or 0
+  // if the texture is not managed by a texture memory budget.
+  uint32_t residency_id_ = 0;
   std::vector<std::function<void()>> on_load_callbacks_;
 };
 
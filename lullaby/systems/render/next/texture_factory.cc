@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #include "lullaby/systems/render/next/texture_factory.h"
+#include <algorithm>
 #include <cmath>
 
 #include "fplbase/texture_atlas_generated.h"
@@ -27,6 +28,7 @@ limitations under the License.
 #include "lullaby/systems/render/next/gl_helpers.h"
 #include "lullaby/systems/render/texture_factory.h"
 #include "lullaby/util/filename.h"
+#include "lullaby/util/make_unique.h"
 
 namespace lull {
 namespace {
@@ -462,7 +464,10 @@ TextureFactoryImpl::TextureFactoryImpl(Registry* registry)
 TexturePtr TextureFactoryImpl::LoadTexture(string_view filename,
                                            const TextureParams& params) {
   const HashValue name = Hash(filename);
-  return textures_.Create(name, [this, filename, &params]() {
+  if (dynamic_atlas_) {
+    dynamic_atlas_->Touch(name);
+  }
+  return textures_.Create(name, [this, name, filename, &params]() {
     std::string resolved(filename);
     if (!IsExtensionSupported(GetExtensionFromFilename(resolved))) {
       resolved = RemoveExtensionFromFilename(resolved) + ".webp";
@@ -480,7 +485,18 @@ TexturePtr TextureFactoryImpl::LoadTexture(string_view filename,
     auto* asset_loader = registry_->Get<AssetLoader>();
     asset_loader->LoadAsync<TextureAsset>(
         resolved, params,
-        [this, texture](TextureAsset* asset) {
+        [this, name, texture](TextureAsset* asset) {
+          if (dynamic_atlas_ && asset->animated_image_ == nullptr &&
+              dynamic_atlas_->CanAdd(asset->image_data_, asset->params_) &&
+              dynamic_atlas_->Add(name, texture, asset->image_data_)) {
+            return;
+          }
+          if (texture_streamer_ && asset->animated_image_ == nullptr &&
+              TextureStreamer::CanStream(asset->image_data_, asset->params_)) {
+            StreamTexture(texture, std::move(asset->image_data_),
+                          asset->params_);
+            return;
+          }
           InitTextureImpl(texture, &asset->image_data_, asset->params_);
           if (asset->animated_image_ != nullptr) {
             auto* animated_texture_processor =
@@ -685,6 +701,238 @@ TexturePtr TextureFactoryImpl::GetInvalidTexture() const {
   return invalid_texture_;
 }
 
+void TextureFactoryImpl::EnableTextureAtlasing(
+    const DynamicTextureAtlas::Params& params) {
+  dynamic_atlas_ = MakeUnique<DynamicTextureAtlas>(this, params);
+}
+
+void TextureFactoryImpl::EnableTextureStreaming(size_t bytes_per_frame) {
+  if (!TextureStreamer::IsSupported()) {
+    LOG(WARNING) << "Texture streaming is not supported.";
+    return;
+  }
+  texture_streamer_ = MakeUnique<TextureStreamer>(bytes_per_frame);
+}
+
+void TextureFactoryImpl::ProcessTextureStreaming() {
+  if (residency_) {
+    UpdateTextureResidency();
+  }
+  if (texture_streamer_) {
+    texture_streamer_->ProcessUploads();
+  }
+}
+
+void TextureFactoryImpl::EnableTextureBudget(
+    const TextureResidency::Params& params) {
+  if (!texture_streamer_) {
+    LOG(WARNING) << "Texture budget requires texture streaming.";
+    return;
+  }
+  if (residency_) {
+    residency_->SetParams(params);
+  } else {
+    residency_ = MakeUnique<TextureResidency>(params);
+  }
+}
+
+void TextureFactoryImpl::RequestTextureSize(const TexturePtr& texture,
+                                            float screen_size) {
+  if (!residency_ || !texture) {
+    return;
+  }
+  const Texture* target = texture.get();
+  if (target->containing_texture_) {
+    // The subtexture only covers part of the containing texture.
+    const mathfu::vec4& uv_bounds = target->uv_bounds_;
+    const float extent = std::max(uv_bounds.z, uv_bounds.w);
+    if (extent > 0.f) {
+      screen_size /= extent;
+    }
+    target = target->containing_texture_.get();
+  }
+  if (target->residency_id_ != TextureResidency::kInvalidTextureId) {
+    residency_->RequestScreenSize(target->residency_id_, screen_size);
+  }
+}
+
+size_t TextureFactoryImpl::GetTotalResidentTextureBytes() const {
+  return residency_ ? residency_->GetTotalResidentBytes() : 0;
+}
+
+void TextureFactoryImpl::ForEachTextureResidency(
+    const std::function<void(const TextureResidencyInfo&)>& fn) const {
+  if (!residency_) {
+    return;
+  }
+  for (const auto& iter : resident_textures_) {
+    const TexturePtr texture = iter.second.texture.lock();
+    if (!texture) {
+      continue;
+    }
+    TextureResidencyInfo info;
+    info.name = texture->GetName();
+    info.size = texture->GetDimensions();
+    info.num_levels = iter.second.num_levels;
+    info.resident_level = residency_->GetResidentLevel(iter.first);
+    info.resident_bytes = residency_->GetResidentBytes(iter.first);
+    info.streaming = residency_->IsStreaming(iter.first);
+    fn(info);
+  }
+}
+
+void TextureFactoryImpl::StreamTexture(const TexturePtr& texture,
+                                       ImageData image,
+                                       const TextureParams& params) {
+  if (!residency_) {
+    texture_streamer_->Stream(texture, std::move(image), params);
+    return;
+  }
+
+  ResidentTexture resident;
+  resident.texture = texture;
+  resident.params = params;
+  resident.format =
+      image.GetFormat() == ImageData::kRgb888 ? GL_RGB : GL_RGBA;
+  resident.num_levels = params.generate_mipmaps
+                            ? TextureResidency::CountMipLevels(image.GetSize())
+                            : 1;
+  const size_t bytes_per_texel = resident.format == GL_RGB ? 3 : 4;
+  const TextureResidency::TextureId id = residency_->Add(
+      image.GetSize(), bytes_per_texel, resident.num_levels);
+  if (id == TextureResidency::kInvalidTextureId) {
+    texture_streamer_->Stream(texture, std::move(image), params);
+    return;
+  }
+  texture->residency_id_ = id;
+  resident_textures_.emplace(id, resident);
+
+  const int level = residency_->GetResidentLevel(id);
+  texture_streamer_->Stream(texture, std::move(image), params, level,
+                            [this, id, level]() {
+                              residency_->SetResidentLevel(id, level);
+                            });
+}
+
+void TextureFactoryImpl::UpdateTextureResidency() {
+  for (auto iter = resident_textures_.begin();
+       iter != resident_textures_.end();) {
+    if (iter->second.texture.expired()) {
+      residency_->Remove(iter->first);
+      iter = resident_textures_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  residency_->Update(&trims_, &restreams_);
+  for (const TextureResidency::LevelChange& trim : trims_) {
+    const ResidentTexture& resident = resident_textures_[trim.id];
+    const TexturePtr texture = resident.texture.lock();
+    if (texture) {
+      TrimTexture(texture.get(), resident, trim.level);
+    }
+  }
+  for (const TextureResidency::LevelChange& restream : restreams_) {
+    RestreamTexture(restream.id, restream.level);
+  }
+}
+
+void TextureFactoryImpl::TrimTexture(Texture* texture,
+                                     const ResidentTexture& resident,
+                                     int level) {
+#if GL_ES_VERSION_3_0 || defined(GL_VERSION_3_0)
+  const int old_level = texture->resident_level_;
+  if (level <= old_level || !texture->hnd_) {
+    return;
+  }
+
+  // Copy the remaining mips into a new texture on the GPU, which frees the
+  // memory of the dropped mips without reloading the image.
+  GLint prev_framebuffer = 0;
+  GL_CALL(glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_framebuffer));
+  GLuint framebuffer = 0;
+  GL_CALL(glGenFramebuffers(1, &framebuffer));
+  GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+  GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+  GLuint texture_id = 0;
+  GL_CALL(glGenTextures(1, &texture_id));
+  GL_CALL(glActiveTexture(GL_TEXTURE0));
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, texture_id));
+  const TextureParams& params = resident.params;
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+                          GetGlTextureWrap(params.wrap_s)));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
+                          GetGlTextureWrap(params.wrap_t)));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+                          GetGlTextureFiltering(params.mag_filter)));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                          GL_LINEAR_MIPMAP_LINEAR));
+
+  const int last_level = resident.num_levels - 1;
+  for (int i = level; i <= last_level; ++i) {
+    const int width = std::max(1, texture->size_.x >> i);
+    const int height = std::max(1, texture->size_.y >> i);
+    GL_CALL(glTexImage2D(GL_TEXTURE_2D, i - level, resident.format, width,
+                         height, 0, resident.format, GL_UNSIGNED_BYTE,
+                         nullptr));
+    GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                   GL_TEXTURE_2D, *texture->hnd_,
+                                   i - old_level));
+    GL_CALL(glCopyTexSubImage2D(GL_TEXTURE_2D, i - level, 0, 0, 0, 0, width,
+                                height));
+  }
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                          last_level - level));
+
+  GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, prev_framebuffer));
+  GL_CALL(glDeleteFramebuffers(1, &framebuffer));
+  GLuint old_texture_id = *texture->hnd_;
+  GL_CALL(glDeleteTextures(1, &old_texture_id));
+  texture->hnd_ = texture_id;
+  texture->resident_level_ = level;
+#endif  // GL_ES_VERSION_3_0 || defined(GL_VERSION_3_0)
+}
+
+void TextureFactoryImpl::RestreamTexture(TextureResidency::TextureId id,
+                                         int level) {
+  const ResidentTexture& resident = resident_textures_[id];
+  const TexturePtr texture = resident.texture.lock();
+  if (!texture) {
+    return;
+  }
+
+  // The larger mips were freed, so the image is decoded from disk again.
+  std::weak_ptr<Texture> weak_texture = texture;
+  auto* asset_loader = registry_->Get<AssetLoader>();
+  asset_loader->LoadAsync<TextureAsset>(
+      texture->GetName(), resident.params,
+      [this, id, level, weak_texture](TextureAsset* asset) {
+        const TexturePtr texture = weak_texture.lock();
+        if (!texture || !residency_) {
+          return;
+        }
+        if (texture_streamer_ &&
+            TextureStreamer::CanStream(asset->image_data_, asset->params_)) {
+          texture_streamer_->Stream(texture, std::move(asset->image_data_),
+                                    asset->params_, level,
+                                    [this, id, level]() {
+                                      residency_->SetResidentLevel(id, level);
+                                    });
+        } else {
+          residency_->SetResidentLevel(id, texture->resident_level_);
+        }
+      },
+      [this, id, weak_texture](ErrorCode error) {
+        const TexturePtr texture = weak_texture.lock();
+        if (texture && residency_) {
+          residency_->SetResidentLevel(id, texture->resident_level_);
+        }
+      });
+}
+
 TexturePtr TextureFactoryImpl::CreateTextureDeprecated(
     const ImageData* image, const TextureParams& params) {
   auto texture = std::make_shared<Texture>();
@@ -18,10 +18,13 @@ limitations under the License.
 #define LULLABY_SYSTEMS_RENDER_NEXT_TEXTURE_FACTORY_H_
 
 #include "lullaby/modules/render/image_data.h"
+#include "lullaby/systems/render/next/dynamic_texture_atlas.h"
 #include "lullaby/systems/render/next/texture.h"
 #include "lullaby/systems/render/next/texture_atlas.h"
+#include "lullaby/systems/render/next/texture_streamer.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/render/texture_factory.h"
+#include "lullaby/systems/render/texture_residency.h"
 #include "lullaby/util/registry.h"
 #include "lullaby/util/resource_manager.h"
 
@@ -122,15 +125,77 @@ class TextureFactoryImpl : public TextureFactory {
   TexturePtr CreateTextureDeprecated(const ImageData* image,
                                      const TextureParams& params) override;
 
+  /// Packs small textures loaded from disk into shared atlas pages, see
+  /// DynamicTextureAtlas for the textures that qualify.
+  void EnableTextureAtlasing(const DynamicTextureAtlas::Params& params);
+
+  /// Returns the runtime texture atlas, or nullptr if atlasing is disabled.
+  const DynamicTextureAtlas* GetDynamicAtlas() const {
+    return dynamic_atlas_.get();
+  }
+
+  /// Uploads textures loaded from disk over several frames instead of all at
+  /// once, spending up to |bytes_per_frame| bytes each frame.  Textures become
+  /// loaded as soon as their smallest mip is uploaded.  Does nothing if the GL
+  /// context does not support pixel buffer objects.
+  void EnableTextureStreaming(size_t bytes_per_frame);
+
+  /// Continues streaming texture uploads.  Must be called once per frame on the
+  /// render thread.
+  void ProcessTextureStreaming();
+
+  /// Keeps the mips of streamed textures within the memory budget in |params|.
+  /// Textures drop their largest mips when they are small on screen, have not
+  /// been drawn for a while, or the memory is needed for other textures, and
+  /// have them streamed back in from disk when needed again.  Requires texture
+  /// streaming to be enabled.
+  void EnableTextureBudget(const TextureResidency::Params& params);
+
+  /// Returns true if streamed textures are kept within a memory budget.
+  bool IsTextureBudgetEnabled() const { return residency_ != nullptr; }
+
+  /// Requests enough detail in |texture| for it to be drawn |screen_size|
+  /// pixels across this frame.  Does nothing if the texture budget is disabled
+  /// or the texture is not managed by it.
+  void RequestTextureSize(const TexturePtr& texture, float screen_size);
+
+  /// Returns the number of bytes used by the resident mips of textures managed
+  /// by the texture budget.
+  size_t GetTotalResidentTextureBytes() const;
+
+  void ForEachTextureResidency(
+      const std::function<void(const TextureResidencyInfo&)>& fn)
+      const override;
+
  private:
+  struct ResidentTexture {
+    std::weak_ptr<Texture> texture;
+    TextureParams params;
+    uint32_t format = 0;
+    int num_levels = 1;
+  };
+
   void InitTextureImpl(const TexturePtr& texture, const ImageData* image,
                        const TextureParams& params);
+  void StreamTexture(const TexturePtr& texture, ImageData image,
+                     const TextureParams& params);
+  void UpdateTextureResidency();
+  void TrimTexture(Texture* texture, const ResidentTexture& resident,
+                   int level);
+  void RestreamTexture(TextureResidency::TextureId id, int level);
 
   Registry* registry_;
   ResourceManager<Texture> textures_;
   ResourceManager<TextureAtlas> atlases_;
   TexturePtr white_texture_;
   TexturePtr invalid_texture_;
+  std::unique_ptr<DynamicTextureAtlas> dynamic_atlas_;
+  std::unique_ptr<TextureStreamer> texture_streamer_;
+  std::unique_ptr<TextureResidency> residency_;
+  std::unordered_map<TextureResidency::TextureId, ResidentTexture>
+      resident_textures_;
+  std::vector<TextureResidency::LevelChange> trims_;
+  std::vector<TextureResidency::LevelChange> restreams_;
 };
 
 }  // namespace lull
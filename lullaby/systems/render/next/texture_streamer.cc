@@ -0,0 +1,371 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/texture_streamer.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include "lullaby/modules/render/image_util.h"
+#include "lullaby/systems/render/next/detail/glplatform.h"
+#include "lullaby/systems/render/next/gl_helpers.h"
+#include "lullaby/systems/render/next/next_renderer.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+// Pixel unpack buffers, mapped buffer ranges and texture base levels are part
+// of GLES3 & GL3.0 specs.
+#if GL_ES_VERSION_3_0 || defined(GL_VERSION_3_0)
+#define LULLABY_TEXTURE_STREAMING 1
+#endif
+
+namespace {
+int CountMipLevels(const mathfu::vec2i& size) {
+  int num_levels = 1;
+  for (int dim = std::max(size.x, size.y); dim > 1; dim /= 2) {
+    ++num_levels;
+  }
+  return num_levels;
+}
+
+size_t GetRowSize(const ImageData& image) {
+  return ImageData::CalculateMinStride(image.GetFormat(), image.GetSize());
+}
+
+// Returns the number of rows, out of |rows_left|, that fit in |budget|.  This
+// is always at least one so that rows larger than the budget still progress.
+int GetNumRows(int rows_left, size_t row_cost, size_t budget) {
+  const size_t num_rows = row_cost > 0 ? budget / row_cost : rows_left;
+  return std::max(1, static_cast<int>(std::min<size_t>(rows_left, num_rows)));
+}
+}  // namespace
+
+TextureStreamer::TextureStreamer(size_t bytes_per_frame)
+    : bytes_per_frame_(bytes_per_frame) {
+  GLuint gl_pbo = 0;
+  GL_CALL(glGenBuffers(1, &gl_pbo));
+  pbo_ = gl_pbo;
+}
+
+TextureStreamer::~TextureStreamer() {
+  for (Upload& upload : uploads_) {
+    Discard(&upload);
+  }
+  if (pbo_.Valid()) {
+    GLuint gl_pbo = *pbo_;
+    GL_CALL(glDeleteBuffers(1, &gl_pbo));
+  }
+}
+
+bool TextureStreamer::IsSupported() {
+  return NextRenderer::SupportsPixelBufferObjects();
+}
+
+bool TextureStreamer::CanStream(const ImageData& image,
+                                const TextureParams& params) {
+  if (params.is_cubemap || image.IsEmpty() || image.GetBytes() == nullptr) {
+    return false;
+  }
+  return image.GetFormat() == ImageData::kRgb888 ||
+         image.GetFormat() == ImageData::kRgba8888;
+}
+
+void TextureStreamer::Stream(const TexturePtr& texture, ImageData image,
+                             const TextureParams& params, int min_level,
+                             std::function<void()> on_done) {
+  if (!texture || !CanStream(image, params)) {
+    LOG(DFATAL) << "Cannot stream texture.";
+    return;
+  }
+
+  Upload upload;
+  upload.texture = texture;
+  upload.params = params;
+  upload.size = image.GetSize();
+  upload.format =
+      image.GetFormat() == ImageData::kRgb888 ? GL_RGB : GL_RGBA;
+  upload.type = GL_UNSIGNED_BYTE;
+  upload.num_levels =
+      params.generate_mipmaps ? CountMipLevels(image.GetSize()) : 1;
+  upload.min_level = std::max(0, std::min(min_level, upload.num_levels - 1));
+  upload.upload_level = upload.num_levels - 1;
+  upload.replace = texture->IsLoaded();
+  upload.on_done = std::move(on_done);
+  upload.levels.reserve(upload.num_levels);
+  upload.levels.emplace_back(std::move(image));
+  uploads_.emplace_back(std::move(upload));
+}
+
+void TextureStreamer::ProcessUploads() {
+#if LULLABY_TEXTURE_STREAMING
+  if (uploads_.empty()) {
+    return;
+  }
+
+  staging_offset_ = 0;
+  staging_orphaned_ = false;
+  size_t budget = bytes_per_frame_;
+
+  GL_CALL(glActiveTexture(GL_TEXTURE0));
+  GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, *pbo_));
+  while (!uploads_.empty() && budget > 0) {
+    Upload& upload = uploads_.front();
+    if (upload.texture.expired()) {
+      Discard(&upload);
+    } else if (!Process(&upload, &budget)) {
+      break;
+    }
+    uploads_.pop_front();
+  }
+  GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+#endif  // LULLABY_TEXTURE_STREAMING
+}
+
+bool TextureStreamer::Process(Upload* upload, size_t* budget) {
+  if (!BuildLevels(upload, budget)) {
+    return false;
+  }
+  if (!upload->hnd) {
+    // The more detailed levels were only needed to build the smaller ones.
+    for (int i = 0; i < upload->min_level; ++i) {
+      upload->levels[i] = ImageData();
+    }
+    AllocateTexture(upload);
+  }
+
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, *upload->hnd));
+  while (*budget > 0) {
+    const ImageData& level = upload->levels[upload->upload_level];
+    const size_t row_size = GetRowSize(level);
+    const int num_rows = GetNumRows(level.GetSize().y - upload->upload_row,
+                                    row_size, *budget);
+    UploadRows(upload, num_rows);
+    *budget -= std::min(*budget, num_rows * row_size);
+
+    if (upload->upload_row == level.GetSize().y) {
+      FinishLevel(upload);
+      if (upload->upload_level == upload->min_level) {
+        Complete(upload);
+        return true;
+      }
+      --upload->upload_level;
+      upload->upload_row = 0;
+    }
+  }
+  return false;
+}
+
+bool TextureStreamer::BuildLevels(Upload* upload, size_t* budget) {
+  while (upload->build_level < upload->num_levels) {
+    if (*budget == 0) {
+      return false;
+    }
+
+    if (upload->build_row == 0) {
+      const ImageData& src = upload->levels[upload->build_level - 1];
+      const mathfu::vec2i size = GetNextMipSize(src.GetSize());
+      const size_t data_size =
+          ImageData::CalculateDataSize(src.GetFormat(), size);
+      upload->levels.emplace_back(
+          src.GetFormat(), size,
+          DataContainer::CreateHeapDataContainer(data_size));
+    }
+
+    const ImageData& src = upload->levels[upload->build_level - 1];
+    ImageData* dst = &upload->levels[upload->build_level];
+    // Each destination row reads two source rows.
+    const size_t row_cost = 2 * src.GetStride();
+    const int num_rows =
+        GetNumRows(dst->GetSize().y - upload->build_row, row_cost, *budget);
+    DownsampleImageRows(src, dst, upload->build_row,
+                        upload->build_row + num_rows);
+    upload->build_row += num_rows;
+    *budget -= std::min(*budget, num_rows * row_cost);
+
+    if (upload->build_row == dst->GetSize().y) {
+      ++upload->build_level;
+      upload->build_row = 0;
+    }
+  }
+  return true;
+}
+
+void TextureStreamer::AllocateTexture(Upload* upload) {
+#if LULLABY_TEXTURE_STREAMING
+  GLuint texture_id = 0;
+  GL_CALL(glGenTextures(1, &texture_id));
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, texture_id));
+
+  const TextureParams& params = upload->params;
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+                          GetGlTextureWrap(params.wrap_s)));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
+                          GetGlTextureWrap(params.wrap_t)));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+                          GetGlTextureFiltering(params.mag_filter)));
+  // Matches the minification filters used by TextureFactoryImpl.
+  if (params.generate_mipmaps) {
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                            GL_LINEAR_MIPMAP_LINEAR));
+  } else {
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+  }
+
+  // Allocate every level up front, without a bound unpack buffer so that the
+  // null data pointer is not treated as an offset into it.
+  GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+  for (int i = upload->min_level; i < upload->num_levels; ++i) {
+    const mathfu::vec2i& size = upload->levels[i].GetSize();
+    GL_CALL(glTexImage2D(GL_TEXTURE_2D, i - upload->min_level, upload->format,
+                         size.x, size.y, 0, upload->format, upload->type,
+                         nullptr));
+  }
+  GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, *pbo_));
+
+  // Only sample the levels which have been uploaded, starting with the
+  // smallest.
+  const int last_level = upload->num_levels - 1 - upload->min_level;
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, last_level));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, last_level));
+  upload->hnd = texture_id;
+#endif  // LULLABY_TEXTURE_STREAMING
+}
+
+void TextureStreamer::UploadRows(Upload* upload, int num_rows) {
+#if LULLABY_TEXTURE_STREAMING
+  const ImageData& level = upload->levels[upload->upload_level];
+  const int level_index = upload->upload_level - upload->min_level;
+  const size_t row_size = GetRowSize(level);
+  const uint8_t* src =
+      level.GetBytes() + upload->upload_row * level.GetStride();
+  const int width = level.GetSize().x;
+
+  size_t offset = 0;
+  uint8_t* staging = MapStaging(num_rows * row_size, &offset);
+  if (staging) {
+    for (int i = 0; i < num_rows; ++i) {
+      memcpy(staging + i * row_size, src + i * level.GetStride(), row_size);
+    }
+    GL_CALL(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+    // The staged rows are tightly packed.
+    GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, level_index, 0, upload->upload_row,
+                            width, num_rows, upload->format, upload->type,
+                            reinterpret_cast<const void*>(offset)));
+  } else {
+    // The rows do not fit in this frame's staging buffer, so upload them
+    // directly from the image instead.
+    GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+    GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, level.GetRowAlignment()));
+    GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, level.GetStrideInPixels()));
+    GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, level_index, 0, upload->upload_row,
+                            width, num_rows, upload->format, upload->type,
+                            src));
+    GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+    GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, *pbo_));
+  }
+  GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+  upload->upload_row += num_rows;
+#endif  // LULLABY_TEXTURE_STREAMING
+}
+
+void TextureStreamer::FinishLevel(Upload* upload) {
+#if LULLABY_TEXTURE_STREAMING
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL,
+                          upload->upload_level - upload->min_level));
+#endif  // LULLABY_TEXTURE_STREAMING
+
+  // The pixels are no longer needed now that they are on the GPU, and smaller
+  // levels have already been built from them.
+  upload->levels[upload->upload_level] = ImageData();
+
+  if (upload->replace) {
+    return;
+  }
+  const TexturePtr texture = upload->texture.lock();
+  if (!texture) {
+    return;
+  }
+  texture->resident_level_ = upload->upload_level;
+  if (!upload->initialized) {
+    const uint32_t flags =
+        upload->params.generate_mipmaps ? Texture::kHasMipMaps : 0;
+    texture->Init(upload->hnd, GL_TEXTURE_2D, upload->size, flags);
+    upload->initialized = true;
+  }
+}
+
+void TextureStreamer::Complete(Upload* upload) {
+  const TexturePtr texture = upload->texture.lock();
+  if (texture && upload->replace) {
+    // Swap in the new mips only once they are all available, so the texture
+    // never shows less detail than it had before.
+    if (texture->hnd_ && (texture->flags_ & Texture::kIsExternal) == 0) {
+      GLuint texture_id = *texture->hnd_;
+      GL_CALL(glDeleteTextures(1, &texture_id));
+    }
+    texture->hnd_ = upload->hnd;
+    texture->resident_level_ = upload->min_level;
+    upload->initialized = true;
+  }
+  if (upload->on_done) {
+    upload->on_done();
+  }
+}
+
+void TextureStreamer::Discard(Upload* upload) {
+  // Initialized textures own their handle.
+  if (upload->hnd && !upload->initialized) {
+    GLuint texture_id = *upload->hnd;
+    GL_CALL(glDeleteTextures(1, &texture_id));
+  }
+  upload->hnd = TextureHnd();
+}
+
+uint8_t* TextureStreamer::MapStaging(size_t size, size_t* offset) {
+#if LULLABY_TEXTURE_STREAMING
+  if (staging_offset_ + size > bytes_per_frame_) {
+    return nullptr;
+  }
+
+  if (!staging_orphaned_) {
+    // Give the buffer new storage each frame rather than waiting for the GPU
+    // to finish reading the previous frame's rows.
+    GL_CALL(glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes_per_frame_, nullptr,
+                         GL_STREAM_DRAW));
+    staging_orphaned_ = true;
+  }
+
+  // Writes within a frame never overlap, so there is no need for the driver
+  // to synchronize.
+  void* ptr = glMapBufferRange(
+      GL_PIXEL_UNPACK_BUFFER, staging_offset_, size,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+          GL_MAP_UNSYNCHRONIZED_BIT);
+  if (ptr == nullptr) {
+    return nullptr;
+  }
+  *offset = staging_offset_;
+  staging_offset_ += size;
+  return static_cast<uint8_t*>(ptr);
+#else
+  return nullptr;
+#endif  // LULLABY_TEXTURE_STREAMING
+}
+
+}  // namespace lull
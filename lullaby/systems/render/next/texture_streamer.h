@@ -0,0 +1,128 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_NEXT_TEXTURE_STREAMER_H_
+#define LULLABY_SYSTEMS_RENDER_NEXT_TEXTURE_STREAMER_H_
+
+#include <stddef.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "lullaby/modules/render/image_data.h"
+#include "lullaby/modules/render/texture_params.h"
+#include "lullaby/systems/render/next/render_handle.h"
+#include "lullaby/systems/render/next/texture.h"
+#include "mathfu/glsl_mappings.h"
+
+namespace lull {
+
+// Uploads decoded images to textures over several frames, so that loading a
+// large image does not stall the render thread for the whole glTexImage2D.
+//
+// Each frame, ProcessUploads spends up to a fixed number of bytes: first on
+// building the image's mip chain on the CPU, and then on copying rows into a
+// pixel buffer object from which the texture is updated, starting from the
+// smallest mip.  The texture is marked as loaded as soon as its smallest mip
+// is uploaded and GL_TEXTURE_BASE_LEVEL is lowered as each larger mip is
+// finished, so a blurry version of the image is shown while the rest streams.
+//
+// Textures are streamed one at a time in the order they were queued.  All
+// functions must be called on the render thread.
+class TextureStreamer {
+ public:
+  // Creates a streamer that processes up to |bytes_per_frame| bytes each frame.
+  // Must be called with a GL context that supports pixel buffer objects.
+  explicit TextureStreamer(size_t bytes_per_frame);
+  ~TextureStreamer();
+
+  TextureStreamer(const TextureStreamer&) = delete;
+  TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+  // Returns true if the current GL context supports streaming textures.
+  static bool IsSupported();
+
+  // Returns true if a texture with the given |image| and |params| can be
+  // streamed.  Only uncompressed 2D RGB and RGBA images are supported.
+  static bool CanStream(const ImageData& image, const TextureParams& params);
+
+  // Queues |image| to be uploaded into |texture|, which is initialized once the
+  // first mip is available.  The upload is dropped if the texture is destroyed
+  // before then.
+  //
+  // Only the mips from |min_level| down are uploaded, with |min_level| becoming
+  // level 0 of the GL texture.  If |texture| is already loaded, its contents
+  // are replaced once all of the mips have been uploaded rather than as each
+  // one is finished.  |on_done| is called once the upload is complete.
+  void Stream(const TexturePtr& texture, ImageData image,
+              const TextureParams& params, int min_level = 0,
+              std::function<void()> on_done = nullptr);
+
+  // Continues the queued uploads within the per-frame byte budget.
+  void ProcessUploads();
+
+  // Returns the number of textures that have not been fully uploaded.
+  size_t GetNumPendingUploads() const { return uploads_.size(); }
+
+ private:
+  struct Upload {
+    std::weak_ptr<Texture> texture;
+    // Owned by the streamer until the texture is initialized.
+    TextureHnd hnd;
+    bool initialized = false;
+    // True if the texture's existing contents are swapped out when done.
+    bool replace = false;
+    TextureParams params;
+    mathfu::vec2i size = {0, 0};
+    uint32_t format = 0;
+    uint32_t type = 0;
+    // Level 0 is the source image.
+    std::vector<ImageData> levels;
+    int num_levels = 1;
+    // The level whose rows are being downsampled, or num_levels once the chain
+    // is complete.
+    int build_level = 1;
+    int build_row = 0;
+    // The most detailed level to upload, which is GL texture level 0.
+    int min_level = 0;
+    // The level whose rows are being uploaded, counting down to min_level.
+    int upload_level = 0;
+    int upload_row = 0;
+    std::function<void()> on_done;
+  };
+
+  // Spends up to |budget| bytes on |upload|.  Returns true once it is done.
+  bool Process(Upload* upload, size_t* budget);
+  bool BuildLevels(Upload* upload, size_t* budget);
+  void AllocateTexture(Upload* upload);
+  void UploadRows(Upload* upload, int num_rows);
+  void FinishLevel(Upload* upload);
+  void Complete(Upload* upload);
+  void Discard(Upload* upload);
+  uint8_t* MapStaging(size_t size, size_t* offset);
+
+  const size_t bytes_per_frame_;
+  BufferHnd pbo_;
+  // The number of bytes written into the pixel buffer object this frame.
+  size_t staging_offset_ = 0;
+  bool staging_orphaned_ = false;
+  std::deque<Upload> uploads_;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_RENDER_NEXT_TEXTURE_STREAMER_H_
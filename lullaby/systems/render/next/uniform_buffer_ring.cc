@@ -0,0 +1,131 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/uniform_buffer_ring.h"
+
+#include <string.h>
+
+#include "lullaby/systems/render/next/detail/glplatform.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+// Fences are part of GLES3 & GL3.2 specs.
+#if GL_ES_VERSION_3_0 || defined(GL_VERSION_3_2)
+#define LULLABY_UNIFORM_BUFFER_RING_FENCES 1
+#endif
+
+UniformBufferRing::UniformBufferRing(size_t frame_size, int num_frames)
+    : allocator_(frame_size, num_frames, GetOffsetAlignment()) {
+  fences_.resize(num_frames, nullptr);
+
+  GLuint gl_ubo = 0;
+  GL_CALL(glGenBuffers(1, &gl_ubo));
+  GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, gl_ubo));
+  GL_CALL(glBufferData(GL_UNIFORM_BUFFER, allocator_.GetSize(), nullptr,
+                       GL_STREAM_DRAW));
+  GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+  ubo_ = gl_ubo;
+}
+
+UniformBufferRing::~UniformBufferRing() {
+#if LULLABY_UNIFORM_BUFFER_RING_FENCES
+  for (void* fence : fences_) {
+    if (fence) {
+      GL_CALL(glDeleteSync(static_cast<GLsync>(fence)));
+    }
+  }
+#endif
+  if (ubo_.Valid()) {
+    GLuint gl_ubo = *ubo_;
+    GL_CALL(glDeleteBuffers(1, &gl_ubo));
+  }
+}
+
+size_t UniformBufferRing::GetOffsetAlignment() {
+  GLint alignment = 0;
+  GL_CALL(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+  return alignment > 0 ? static_cast<size_t>(alignment) : 1;
+}
+
+void UniformBufferRing::BeginFrame() {
+  allocator_.BeginFrame();
+
+#if LULLABY_UNIFORM_BUFFER_RING_FENCES
+  void*& fence = fences_[allocator_.GetFrameIndex()];
+  if (fence) {
+    // Usually the fence has long been signaled, since the region was last used
+    // |num_frames_| frames ago.
+    const GLsync sync = static_cast<GLsync>(fence);
+    GLenum result = glClientWaitSync(sync, 0, 0);
+    while (result == GL_TIMEOUT_EXPIRED) {
+      static const GLuint64 kTimeoutNs = 1000000;
+      result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, kTimeoutNs);
+    }
+    if (result == GL_WAIT_FAILED) {
+      LOG(ERROR) << "Failed to wait for uniform buffer fence.";
+    }
+    GL_CALL(glDeleteSync(sync));
+    fence = nullptr;
+  }
+#endif
+}
+
+void UniformBufferRing::EndFrame() {
+#if LULLABY_UNIFORM_BUFFER_RING_FENCES
+  void*& fence = fences_[allocator_.GetFrameIndex()];
+  if (fence == nullptr && !allocator_.IsFrameEmpty()) {
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+#endif
+}
+
+UniformBufferRing::Range UniformBufferRing::Write(Span<uint8_t> data) {
+  Range range;
+  if (data.empty()) {
+    return range;
+  }
+
+  const size_t offset = allocator_.Allocate(data.size());
+  if (offset == UniformRingAllocator::kInvalidOffset) {
+    return range;
+  }
+
+// Mapping buffer ranges is part of GLES3 & GL3.0 specs.
+#if GL_ES_VERSION_3_0 || defined(GL_VERSION_3_0)
+  // The region is not in use by the GPU (see BeginFrame) and distinct writes
+  // never overlap, so there is no need for the driver to synchronize.
+  GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, *ubo_));
+  void* ptr = glMapBufferRange(
+      GL_UNIFORM_BUFFER, offset, data.size(),
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+          GL_MAP_UNSYNCHRONIZED_BIT);
+  if (ptr == nullptr) {
+    GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+    return range;
+  }
+  memcpy(ptr, data.data(), data.size());
+  GL_CALL(glUnmapBuffer(GL_UNIFORM_BUFFER));
+  GL_CALL(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+
+  range.buffer = ubo_;
+  range.offset = offset;
+  range.size = data.size();
+#endif  // GL_ES_VERSION_3_0 || GL_VERSION_3_0
+  return range;
+}
+
+}  // namespace lull
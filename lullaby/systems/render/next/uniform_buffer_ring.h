@@ -0,0 +1,83 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_NEXT_UNIFORM_BUFFER_RING_H_
+#define LULLABY_SYSTEMS_RENDER_NEXT_UNIFORM_BUFFER_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "lullaby/systems/render/next/render_handle.h"
+#include "lullaby/systems/render/next/uniform_ring_allocator.h"
+#include "lullaby/util/span.h"
+
+namespace lull {
+
+// Suballocates per-frame ranges of uniform data from a single uniform buffer
+// object, so that uniform blocks which change every frame can be written once
+// per frame and bound with glBindBufferRange instead of each owning a buffer
+// that is re-uploaded (and possibly stalls on the GPU) whenever it changes.
+//
+// The buffer is split into one region per frame in flight.  Each frame writes
+// into its own region with unsynchronized mappings, and a fence inserted at the
+// end of the frame ensures that a region is not overwritten until the GPU has
+// finished reading from it.
+class UniformBufferRing {
+ public:
+  // A range of the ring that holds a single write.
+  struct Range {
+    UniformBufferHnd buffer;
+    size_t offset = 0;
+    size_t size = 0;
+  };
+
+  // Creates a ring with |num_frames| regions of |frame_size| bytes each.  Must
+  // be called with a GL context that supports uniform buffer objects.
+  UniformBufferRing(size_t frame_size, int num_frames);
+  ~UniformBufferRing();
+
+  UniformBufferRing(const UniformBufferRing&) = delete;
+  UniformBufferRing& operator=(const UniformBufferRing&) = delete;
+
+  // Starts writing into the next frame's region, waiting for the GPU to finish
+  // with it if necessary.
+  void BeginFrame();
+
+  // Marks the end of the writes for the current frame.
+  void EndFrame();
+
+  // Copies |data| into the current frame's region and returns the range it was
+  // written to.  Returns a range with an invalid buffer if the region is full.
+  Range Write(Span<uint8_t> data);
+
+  // Returns a counter that is incremented by each BeginFrame.  Ranges returned
+  // by Write are only valid while this value is unchanged.
+  uint64_t GetFrameId() const { return allocator_.GetFrameId(); }
+
+ private:
+  // Returns the alignment required for the offsets of uniform buffer bindings.
+  static size_t GetOffsetAlignment();
+
+  UniformBufferHnd ubo_;
+  UniformRingAllocator allocator_;
+  // One fence (a GLsync) per region, or null if the region is not in use.
+  std::vector<void*> fences_;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_RENDER_NEXT_UNIFORM_BUFFER_RING_H_
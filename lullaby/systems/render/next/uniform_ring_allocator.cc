@@ -0,0 +1,52 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/uniform_ring_allocator.h"
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+constexpr size_t UniformRingAllocator::kInvalidOffset;
+
+UniformRingAllocator::UniformRingAllocator(size_t frame_size, int num_frames,
+                                           size_t alignment)
+    : frame_size_(frame_size),
+      num_frames_(num_frames),
+      alignment_(alignment > 0 ? alignment : 1) {
+  CHECK_GT(num_frames_, 0);
+}
+
+void UniformRingAllocator::BeginFrame() {
+  ++frame_id_;
+  frame_index_ = (frame_index_ + 1) % num_frames_;
+  frame_offset_ = 0;
+}
+
+size_t UniformRingAllocator::Allocate(size_t size) {
+  // Offsets must be aligned, but the region size need not be.
+  const size_t frame_start = frame_index_ * frame_size_;
+  const size_t frame_end = frame_start + frame_size_;
+  const size_t offset =
+      (frame_start + frame_offset_ + alignment_ - 1) / alignment_ * alignment_;
+  if (size == 0 || offset + size > frame_end) {
+    return kInvalidOffset;
+  }
+  frame_offset_ = offset + size - frame_start;
+  return offset;
+}
+
+}  // namespace lull
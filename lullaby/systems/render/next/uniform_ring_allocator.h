@@ -0,0 +1,68 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_NEXT_UNIFORM_RING_ALLOCATOR_H_
+#define LULLABY_SYSTEMS_RENDER_NEXT_UNIFORM_RING_ALLOCATOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace lull {
+
+// Decides where the writes to a UniformBufferRing go, independently of GL.
+//
+// The ring is split into |num_frames| regions of |frame_size| bytes, one per
+// frame in flight.  Each frame allocates from the start of its own region, with
+// every allocation starting at a multiple of |alignment| bytes from the start
+// of the ring.
+class UniformRingAllocator {
+ public:
+  // Returned by Allocate() if the current region is full.
+  static constexpr size_t kInvalidOffset = static_cast<size_t>(-1);
+
+  UniformRingAllocator(size_t frame_size, int num_frames, size_t alignment);
+
+  // Moves to the next frame's region and empties it.
+  void BeginFrame();
+
+  // Returns the offset from the start of the ring of |size| bytes in the
+  // current region, or kInvalidOffset if they do not fit.
+  size_t Allocate(size_t size);
+
+  // Returns the index of the current frame's region.
+  int GetFrameIndex() const { return frame_index_; }
+
+  // Returns true if nothing has been allocated in the current region.
+  bool IsFrameEmpty() const { return frame_offset_ == 0; }
+
+  // Returns a counter that is incremented by each BeginFrame().
+  uint64_t GetFrameId() const { return frame_id_; }
+
+  // Returns the size of the whole ring, in bytes.
+  size_t GetSize() const { return frame_size_ * num_frames_; }
+
+ private:
+  const size_t frame_size_;
+  const int num_frames_;
+  const size_t alignment_;
+  int frame_index_ = 0;
+  size_t frame_offset_ = 0;
+  uint64_t frame_id_ = 0;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_RENDER_NEXT_UNIFORM_RING_ALLOCATOR_H_
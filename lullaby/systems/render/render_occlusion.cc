@@ -0,0 +1,297 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/render_occlusion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+namespace {
+
+// Boxes with a corner closer than this (in clip space w) are treated as
+// crossing the near plane.
+constexpr float kMinClipW = 1e-4f;
+
+// The value of depth buffer texels not covered by any occluder.
+constexpr float kFarDepth = std::numeric_limits<float>::max();
+
+// The corners of each face of a box, where bit 0, 1 and 2 of a corner index
+// select the max x, y and z respectively.
+constexpr int kBoxFaces[6][4] = {
+    {0, 1, 3, 2}, {4, 5, 7, 6}, {0, 1, 5, 4},
+    {2, 3, 7, 6}, {0, 2, 6, 4}, {1, 3, 7, 5},
+};
+
+float EdgeFunction(const mathfu::vec3& a, const mathfu::vec3& b, float x,
+                   float y) {
+  return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+}
+
+bool AreMatricesEqual(const mathfu::mat4& a, const mathfu::mat4& b) {
+  for (int i = 0; i < 16; ++i) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+RenderOcclusion::RenderOcclusion(Registry* registry, int width, int height)
+    : registry_(registry), width_(width), height_(height) {
+  if (width_ <= 0 || height_ <= 0) {
+    LOG(DFATAL) << "Invalid occlusion buffer size: " << width_ << "x"
+                << height_;
+    width_ = kDefaultWidth;
+    height_ = kDefaultHeight;
+  }
+}
+
+RenderOcclusion::~RenderOcclusion() {}
+
+void RenderOcclusion::SetOccluder(Entity entity, bool occluder) {
+  if (occluder) {
+    occluders_.insert(entity);
+  } else {
+    occluders_.erase(entity);
+  }
+}
+
+bool RenderOcclusion::IsOccluder(Entity entity) const {
+  return occluders_.count(entity) != 0;
+}
+
+void RenderOcclusion::BeginFrame() {
+  views_valid_ = false;
+  pending_num_tested_ = 0;
+  pending_num_occluded_ = 0;
+}
+
+void RenderOcclusion::EndFrame() {
+  num_tested_ = pending_num_tested_;
+  num_occluded_ = pending_num_occluded_;
+}
+
+bool RenderOcclusion::BeginViews(const mathfu::mat4* clip_from_world_matrices,
+                                 size_t num_views) {
+  if (views_valid_ && views_.size() == num_views) {
+    bool same_views = true;
+    for (size_t i = 0; i < num_views && same_views; ++i) {
+      same_views = AreMatricesEqual(views_[i].clip_from_world,
+                                    clip_from_world_matrices[i]);
+    }
+    if (same_views) {
+      return false;
+    }
+  }
+
+  views_.resize(num_views);
+  for (size_t i = 0; i < num_views; ++i) {
+    views_[i].clip_from_world = clip_from_world_matrices[i];
+    views_[i].levels.resize(1);
+    views_[i].levels[0].assign(width_ * height_, kFarDepth);
+  }
+  views_valid_ = true;
+  return true;
+}
+
+void RenderOcclusion::AddOccluder(const Aabb& box,
+                                  const mathfu::mat4& world_from_entity) {
+  ScreenBox screen_box;
+  for (View& view : views_) {
+    if (!ProjectBox(box, view.clip_from_world * world_from_entity,
+                    &screen_box)) {
+      // Skipping an occluder only makes the culling less aggressive.
+      continue;
+    }
+    const mathfu::vec3* corners = screen_box.corners;
+    for (const auto& face : kBoxFaces) {
+      RasterizeTriangle(corners[face[0]], corners[face[1]], corners[face[2]],
+                        &view.levels[0]);
+      RasterizeTriangle(corners[face[0]], corners[face[2]], corners[face[3]],
+                        &view.levels[0]);
+    }
+  }
+}
+
+void RenderOcclusion::EndViews() {
+  for (View& view : views_) {
+    view.levels.resize(1);
+    int level = 0;
+    while (LevelWidth(level) > 1 || LevelHeight(level) > 1) {
+      const int src_width = LevelWidth(level);
+      const int src_height = LevelHeight(level);
+      const int dst_width = LevelWidth(level + 1);
+      const int dst_height = LevelHeight(level + 1);
+
+      std::vector<float> dst(dst_width * dst_height);
+      const std::vector<float>& src = view.levels[level];
+      for (int y = 0; y < dst_height; ++y) {
+        const int y0 = 2 * y;
+        const int y1 = std::min(y0 + 1, src_height - 1);
+        for (int x = 0; x < dst_width; ++x) {
+          const int x0 = 2 * x;
+          const int x1 = std::min(x0 + 1, src_width - 1);
+          dst[y * dst_width + x] = std::max(
+              std::max(src[y0 * src_width + x0], src[y0 * src_width + x1]),
+              std::max(src[y1 * src_width + x0], src[y1 * src_width + x1]));
+        }
+      }
+      view.levels.emplace_back(std::move(dst));
+      ++level;
+    }
+  }
+}
+
+bool RenderOcclusion::IsOccluded(const Aabb& box,
+                                 const mathfu::mat4& world_from_entity) {
+  if (!views_valid_ || views_.empty()) {
+    return false;
+  }
+
+  ++pending_num_tested_;
+  ScreenBox screen_box;
+  for (const View& view : views_) {
+    if (!ProjectBox(box, view.clip_from_world * world_from_entity,
+                    &screen_box)) {
+      return false;
+    }
+    if (!IsOccludedInView(view, screen_box)) {
+      return false;
+    }
+  }
+  ++pending_num_occluded_;
+  return true;
+}
+
+bool RenderOcclusion::ProjectBox(const Aabb& box,
+                                 const mathfu::mat4& screen_from_entity,
+                                 ScreenBox* out) const {
+  for (int i = 0; i < 8; ++i) {
+    const mathfu::vec4 corner((i & 1) ? box.max.x : box.min.x,
+                              (i & 2) ? box.max.y : box.min.y,
+                              (i & 4) ? box.max.z : box.min.z, 1.0f);
+    const mathfu::vec4 clip = screen_from_entity * corner;
+    if (clip.w < kMinClipW) {
+      return false;
+    }
+    const float inv_w = 1.0f / clip.w;
+    out->corners[i] =
+        mathfu::vec3((clip.x * inv_w * 0.5f + 0.5f) * width_,
+                     (clip.y * inv_w * 0.5f + 0.5f) * height_, clip.z * inv_w);
+  }
+  return true;
+}
+
+void RenderOcclusion::RasterizeTriangle(const mathfu::vec3& a,
+                                        const mathfu::vec3& b,
+                                        const mathfu::vec3& c,
+                                        std::vector<float>* depth) {
+  const float area = EdgeFunction(a, b, c.x, c.y);
+  if (std::abs(area) < 1e-6f) {
+    return;
+  }
+  // Faces are rasterized regardless of their winding.
+  const float sign = area > 0.0f ? 1.0f : -1.0f;
+
+  // Writing the farthest depth of the triangle keeps the buffer conservative.
+  const float triangle_depth = std::max(std::max(a.z, b.z), c.z);
+
+  const float min_x = std::min(std::min(a.x, b.x), c.x);
+  const float max_x = std::max(std::max(a.x, b.x), c.x);
+  const float min_y = std::min(std::min(a.y, b.y), c.y);
+  const float max_y = std::max(std::max(a.y, b.y), c.y);
+  const int x0 = std::max(0, static_cast<int>(std::floor(min_x)));
+  const int x1 = std::min(width_ - 1, static_cast<int>(std::floor(max_x)));
+  const int y0 = std::max(0, static_cast<int>(std::floor(min_y)));
+  const int y1 = std::min(height_ - 1, static_cast<int>(std::floor(max_y)));
+
+  for (int y = y0; y <= y1; ++y) {
+    const float py = static_cast<float>(y) + 0.5f;
+    for (int x = x0; x <= x1; ++x) {
+      const float px = static_cast<float>(x) + 0.5f;
+      if (sign * EdgeFunction(a, b, px, py) < 0.0f ||
+          sign * EdgeFunction(b, c, px, py) < 0.0f ||
+          sign * EdgeFunction(c, a, px, py) < 0.0f) {
+        continue;
+      }
+      float& texel = (*depth)[y * width_ + x];
+      texel = std::min(texel, triangle_depth);
+    }
+  }
+}
+
+bool RenderOcclusion::IsOccludedInView(const View& view,
+                                       const ScreenBox& box) const {
+  mathfu::vec3 min = box.corners[0];
+  mathfu::vec3 max = box.corners[0];
+  for (int i = 1; i < 8; ++i) {
+    min = mathfu::vec3::Min(min, box.corners[i]);
+    max = mathfu::vec3::Max(max, box.corners[i]);
+  }
+
+  const int x0 = std::max(0, static_cast<int>(std::floor(min.x)));
+  const int x1 = std::min(width_ - 1, static_cast<int>(std::floor(max.x)));
+  const int y0 = std::max(0, static_cast<int>(std::floor(min.y)));
+  const int y1 = std::min(height_ - 1, static_cast<int>(std::floor(max.y)));
+  if (x0 > x1 || y0 > y1) {
+    // Off screen, which is left to frustum culling.
+    return false;
+  }
+
+  // Pick the finest level at which the rectangle spans at most 2x2 texels.
+  int level = 0;
+  const int max_level = static_cast<int>(view.levels.size()) - 1;
+  while (level < max_level &&
+         ((x1 >> level) - (x0 >> level) > 1 ||
+          (y1 >> level) - (y0 >> level) > 1)) {
+    ++level;
+  }
+
+  const std::vector<float>& depth = view.levels[level];
+  const int level_width = LevelWidth(level);
+  for (int y = y0 >> level; y <= (y1 >> level); ++y) {
+    for (int x = x0 >> level; x <= (x1 >> level); ++x) {
+      if (depth[y * level_width + x] >= min.z) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int RenderOcclusion::LevelWidth(int level) const {
+  int width = width_;
+  for (int i = 0; i < level; ++i) {
+    width = (width + 1) / 2;
+  }
+  return width;
+}
+
+int RenderOcclusion::LevelHeight(int level) const {
+  int height = height_;
+  for (int i = 0; i < level; ++i) {
+    height = (height + 1) / 2;
+  }
+  return height;
+}
+
+}  // namespace lull
@@ -0,0 +1,131 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_RENDER_OCCLUSION_H_
+#define LULLABY_SYSTEMS_RENDER_RENDER_OCCLUSION_H_
+
+#include <unordered_set>
+#include <vector>
+
+#include "mathfu/glsl_mappings.h"
+#include "lullaby/util/entity.h"
+#include "lullaby/util/math.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+// Culls Entities that are hidden behind designated occluders (eg. walls and
+// floors of indoor scenes) for render passes using
+// RenderCullMode::kVisibleAndUnoccludedInAnyView.
+//
+// The bounding boxes of the occluders are rasterized into a low resolution
+// depth buffer for each view, from which a hierarchical-Z (max depth) pyramid
+// is built.  An Entity is occluded if the screen rectangle of its bounding box
+// is entirely covered by occluders that are closer than the nearest point of
+// the box in every view.  Occluders are assumed to fill their bounding boxes.
+class RenderOcclusion {
+ public:
+  static constexpr int kDefaultWidth = 128;
+  static constexpr int kDefaultHeight = 64;
+
+  // Do not create RenderOcclusion directly.  Instead, create via registry, eg:
+  // registry.Create<RenderOcclusion>(&registry);
+  explicit RenderOcclusion(Registry* registry, int width = kDefaultWidth,
+                           int height = kDefaultHeight);
+
+  ~RenderOcclusion();
+
+  // Sets whether |entity|'s bounding box should occlude other Entities.
+  void SetOccluder(Entity entity, bool occluder);
+
+  // Returns true if |entity| is an occluder.
+  bool IsOccluder(Entity entity) const;
+
+  // Returns the set of occluders.
+  const std::unordered_set<Entity>& GetOccluders() const { return occluders_; }
+
+  // Returns the number of Entities tested for occlusion in the last completed
+  // frame.
+  int GetNumTested() const { return num_tested_; }
+
+  // Returns the number of Entities found to be occluded in the last completed
+  // frame.
+  int GetNumOccluded() const { return num_occluded_; }
+
+  // Called automatically by RenderSystem.
+  void BeginFrame();
+
+  // Called automatically by RenderSystem.  Publishes the frame's statistics.
+  void EndFrame();
+
+  // Clears the depth buffers for the given views.  Returns false if the depth
+  // buffers were already built for the same views during this frame, in which
+  // case they are reused and there is no need to add the occluders again.
+  bool BeginViews(const mathfu::mat4* clip_from_world_matrices,
+                  size_t num_views);
+
+  // Rasterizes the bounding box of an occluder into the depth buffers.
+  void AddOccluder(const Aabb& box, const mathfu::mat4& world_from_entity);
+
+  // Builds the hierarchical-Z pyramids once all occluders have been added.
+  void EndViews();
+
+  // Returns true if |box| is hidden behind the occluders in every view.
+  bool IsOccluded(const Aabb& box, const mathfu::mat4& world_from_entity);
+
+ private:
+  struct View {
+    mathfu::mat4 clip_from_world;
+    // The max depth pyramid, where level 0 is the full resolution depth
+    // buffer and each level halves the resolution of the one before it.
+    std::vector<std::vector<float>> levels;
+  };
+
+  struct ScreenBox {
+    mathfu::vec3 corners[8];
+  };
+
+  // Projects the corners of |box| into screen space (pixels and NDC depth).
+  // Returns false if the box crosses the near plane.
+  bool ProjectBox(const Aabb& box, const mathfu::mat4& screen_from_entity,
+                  ScreenBox* out) const;
+
+  void RasterizeTriangle(const mathfu::vec3& a, const mathfu::vec3& b,
+                         const mathfu::vec3& c, std::vector<float>* depth);
+
+  bool IsOccludedInView(const View& view, const ScreenBox& box) const;
+
+  int LevelWidth(int level) const;
+  int LevelHeight(int level) const;
+
+  Registry* registry_;
+  int width_;
+  int height_;
+  std::unordered_set<Entity> occluders_;
+  std::vector<View> views_;
+  bool views_valid_ = false;
+  int pending_num_tested_ = 0;
+  int pending_num_occluded_ = 0;
+  int num_tested_ = 0;
+  int num_occluded_ = 0;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::RenderOcclusion);
+
+#endif  // LULLABY_SYSTEMS_RENDER_RENDER_OCCLUSION_H_
@@ -0,0 +1,275 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/render_picker.h"
+
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "lullaby/modules/render/image_data.h"
+#include "lullaby/modules/render/material_info.h"
+#include "lullaby/modules/render/render_view.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/render_target.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/logging.h"
+#include "mathfu/constants.h"
+
+namespace lull {
+namespace {
+
+constexpr int kRgbaStride = 4;
+
+// The near clip plane of the pick view, close enough to pick Entities right
+// in front of the ray's origin (eg. a controller).
+constexpr float kNearClipPlane = 0.01f;
+
+// A pick that has not been read back after this many frames is assumed to have
+// failed, and is replaced by a new one.
+constexpr int kMaxFramesInFlight = 8;
+
+}  // namespace
+
+RenderPicker::RenderPicker(Registry* registry, std::string shading_model,
+                           int size, float angle)
+    : registry_(registry),
+      shading_model_(std::move(shading_model)),
+      size_(size),
+      angle_(angle),
+      pass_(ConstHash("RenderPicker")),
+      render_target_(ConstHash("RenderPickerTarget")) {
+  auto* render_system = registry_->Get<RenderSystem>();
+  if (render_system == nullptr) {
+    LOG(DFATAL) << "RenderPicker depends on RenderSystem.";
+    return;
+  }
+
+  RenderTargetCreateParams params;
+  params.dimensions = mathfu::vec2i(size_, size_);
+  params.texture_format = TextureFormat_RGBA8;
+  params.depth_stencil_format = DepthStencilFormat_Depth24;
+  render_system->CreateRenderTarget(render_target_, params);
+  render_system->SetRenderTarget(pass_, render_target_);
+
+  // Pixels not covered by any pickable Entity decode to kNullEntity.
+  RenderClearParams clear_params;
+  clear_params.clear_options =
+      RenderClearParams::kColor | RenderClearParams::kDepth;
+  clear_params.color_value = mathfu::kZeros4f;
+  render_system->SetClearParams(pass_, clear_params);
+}
+
+RenderPicker::~RenderPicker() {
+  auto* render_system = registry_->Get<RenderSystem>();
+  if (render_system) {
+    for (Entity entity : pickables_) {
+      render_system->Destroy(entity, pass_);
+    }
+  }
+}
+
+void RenderPicker::AddPickable(Entity entity) {
+  auto* render_system = registry_->Get<RenderSystem>();
+  if (render_system == nullptr || !pickables_.insert(entity).second) {
+    return;
+  }
+
+  render_system->Create(entity, pass_);
+  render_system->SetMaterial({entity, pass_}, MaterialInfo(shading_model_));
+  const mathfu::vec4 color = EncodeEntity(entity);
+  render_system->SetUniform(
+      {entity, pass_}, "color", ShaderDataType_Float4,
+      {reinterpret_cast<const uint8_t*>(&color[0]), sizeof(color)});
+
+  // The mesh of the default pass may still be loading.
+  const RenderSystem::Drawable drawable(entity, RenderSystem::kDefaultPass);
+  render_system->OnReadyToRender(drawable, [this, drawable]() {
+    if (pickables_.count(drawable.entity) == 0) {
+      return;
+    }
+    auto* render_system = registry_->Get<RenderSystem>();
+    const MeshPtr mesh = render_system->GetMesh(drawable);
+    if (mesh) {
+      render_system->SetMesh({drawable.entity, pass_}, mesh);
+    }
+  });
+}
+
+void RenderPicker::RemovePickable(Entity entity) {
+  if (pickables_.erase(entity) == 0) {
+    return;
+  }
+  auto* render_system = registry_->Get<RenderSystem>();
+  if (render_system) {
+    render_system->Destroy(entity, pass_);
+  }
+}
+
+bool RenderPicker::IsPickable(Entity entity) const {
+  return pickables_.count(entity) != 0;
+}
+
+void RenderPicker::SetRay(const Ray& ray) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ray_ = ray;
+  has_ray_ = true;
+}
+
+void RenderPicker::ClearRay() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  has_ray_ = false;
+  picked_valid_ = false;
+  picked_entity_ = kNullEntity;
+}
+
+RenderPicker::Result RenderPicker::GetResult() const {
+  Result result;
+  Ray picked_ray;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.valid = picked_valid_;
+    result.entity = picked_entity_;
+    picked_ray = picked_ray_;
+  }
+  if (pickables_.count(result.entity) == 0) {
+    // Either nothing was picked, or the Entity was removed since.
+    result.entity = kNullEntity;
+  } else {
+    // The distance is computed here rather than in Render(), since the
+    // transforms belong to the calling thread.
+    result.distance = ComputeDistance(picked_ray, result.entity);
+  }
+  return result;
+}
+
+void RenderPicker::Render() {
+  auto* render_system = registry_->Get<RenderSystem>();
+  if (render_system == nullptr) {
+    return;
+  }
+
+  if (frames_in_flight_ > 0) {
+    const ImageData pixels =
+        render_system->TakeRenderTargetData(render_target_);
+    if (!pixels.IsEmpty()) {
+      const Entity entity = FindNearestToCenter(pixels.GetBytes());
+      frames_in_flight_ = 0;
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (has_ray_) {
+        picked_valid_ = true;
+        picked_entity_ = entity;
+        picked_ray_ = pending_ray_;
+      }
+    } else if (++frames_in_flight_ <= kMaxFramesInFlight) {
+      // Wait for the GPU rather than discarding the pick.
+      return;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!has_ray_) {
+      return;
+    }
+    pending_ray_ = ray_;
+  }
+
+  // Look down the ray with a view just wide enough to cover |angle_|.
+  const mathfu::vec3 up = std::abs(pending_ray_.direction.y) > 0.99f
+                              ? mathfu::kAxisZ3f
+                              : mathfu::kAxisY3f;
+  const mathfu::mat4 eye_from_world = CalculateLookAtMatrixFromDir(
+      pending_ray_.origin, pending_ray_.direction, up);
+  const mathfu::mat4 clip_from_eye = CalculatePerspectiveMatrixFromView(
+      angle_, 1.f, kNearClipPlane, RenderView::kDefaultFarClipPlane);
+  const float half_angle = angle_ / 2.f;
+  const mathfu::recti viewport(0, 0, size_, size_);
+  RenderView view;
+  PopulateRenderView(
+      &view, viewport, eye_from_world.Inverse(), clip_from_eye,
+      mathfu::rectf(half_angle, half_angle, half_angle, half_angle), 0);
+
+  render_system->Render(&view, 1, pass_);
+  render_system->ReadRenderTargetDataAsync(render_target_, viewport);
+  frames_in_flight_ = 1;
+}
+
+mathfu::vec4 RenderPicker::EncodeEntity(Entity entity) {
+  const uint32_t id = static_cast<uint32_t>(entity);
+  return mathfu::vec4(static_cast<float>(id & 0xff),
+                      static_cast<float>((id >> 8) & 0xff),
+                      static_cast<float>((id >> 16) & 0xff),
+                      static_cast<float>((id >> 24) & 0xff)) /
+         255.f;
+}
+
+Entity RenderPicker::DecodeEntity(const uint8_t* pixel) {
+  return static_cast<Entity>(static_cast<uint32_t>(pixel[0]) |
+                             (static_cast<uint32_t>(pixel[1]) << 8) |
+                             (static_cast<uint32_t>(pixel[2]) << 16) |
+                             (static_cast<uint32_t>(pixel[3]) << 24));
+}
+
+Entity RenderPicker::FindNearestToCenter(const uint8_t* pixels) const {
+  // Prefer the Entity under the ray, but tolerate near misses so that thin
+  // Entities remain easy to pick.
+  const float center = static_cast<float>(size_ - 1) / 2.f;
+  Entity nearest = kNullEntity;
+  float nearest_distance = std::numeric_limits<float>::max();
+  for (int y = 0; y < size_; ++y) {
+    for (int x = 0; x < size_; ++x) {
+      const Entity entity =
+          DecodeEntity(pixels + (y * size_ + x) * kRgbaStride);
+      if (entity == kNullEntity) {
+        continue;
+      }
+      const float dx = static_cast<float>(x) - center;
+      const float dy = static_cast<float>(y) - center;
+      const float distance = dx * dx + dy * dy;
+      if (distance < nearest_distance) {
+        nearest = entity;
+        nearest_distance = distance;
+      }
+    }
+  }
+  return nearest;
+}
+
+float RenderPicker::ComputeDistance(const Ray& ray, Entity entity) const {
+  const auto* transform_system = registry_->Get<TransformSystem>();
+  if (transform_system == nullptr) {
+    return kNoHitDistance;
+  }
+  const mathfu::mat4* world_from_entity =
+      transform_system->GetWorldFromEntityMatrix(entity);
+  if (world_from_entity == nullptr) {
+    return kNoHitDistance;
+  }
+  const Aabb* aabb = transform_system->GetAabb(entity);
+  if (aabb) {
+    const float distance = CheckRayOBBCollision(ray, *world_from_entity, *aabb);
+    if (distance != kNoHitDistance) {
+      return distance;
+    }
+  }
+  // The ray may just miss the bounding box if it picked the Entity with a
+  // neighboring pixel, so fall back to the Entity's origin.
+  return ProjectPointOntoRay(ray, world_from_entity->TranslationVector3D());
+}
+
+}  // namespace lull
@@ -0,0 +1,148 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_RENDER_PICKER_H_
+#define LULLABY_SYSTEMS_RENDER_RENDER_PICKER_H_
+
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include "lullaby/util/entity.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/math.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/util/typeid.h"
+#include "mathfu/glsl_mappings.h"
+
+namespace lull {
+
+// Picks the Entity under a ray by rendering Entity ids into a small offscreen
+// render target, as an alternative to the CollisionSystem's bounding box tests
+// for scenes with many or irregularly shaped meshes.
+//
+// Pickable Entities are drawn into a dedicated render pass using a shader that
+// writes its "color" uniform unmodified (no lighting, blending or color
+// multipliers), which the picker sets to the Entity's encoded id.  Each frame,
+// Render() draws the pass with a narrow view looking down the pick ray and
+// starts reading the pixels back asynchronously.  The result is picked up by a
+// later Render(), once the GPU has written it, so neither thread ever waits for
+// the GPU and the CPU cost does not depend on the number of Entities.  Results
+// are therefore a frame or more behind the ray.
+//
+// Render() may be called from a different thread than the other functions, eg.
+// the render thread.
+//
+// When a RenderPicker is in the Registry, the StandardInputPipeline uses it
+// instead of the CollisionSystem to find the target of the primary device,
+// once it has a result.  Until then, eg. on the first frames or with a
+// backend that cannot read render targets back, the CollisionSystem is used.
+class RenderPicker {
+ public:
+  struct Result {
+    // False if no pick along the current ray has been read back yet, in which
+    // case |entity| is kNullEntity but does not mean the ray missed.
+    bool valid = false;
+    Entity entity = kNullEntity;
+    // The distance along the ray that was picked to the Entity's bounding box.
+    float distance = kNoHitDistance;
+  };
+
+  static constexpr int kDefaultSize = 8;
+
+  // Do not create RenderPicker directly.  Instead, create via registry, eg:
+  // registry.Create<RenderPicker>(&registry, "picking_shader");
+  //
+  // |shading_model| is the shader used to draw the pickable Entities.  The
+  // render target is |size| pixels square and covers a cone of |angle|
+  // radians around the ray.
+  RenderPicker(Registry* registry, std::string shading_model,
+               int size = kDefaultSize, float angle = 0.02f);
+
+  ~RenderPicker();
+
+  RenderPicker(const RenderPicker&) = delete;
+  RenderPicker& operator=(const RenderPicker&) = delete;
+
+  // Makes |entity| pickable, using the mesh of its default render pass.
+  void AddPickable(Entity entity);
+
+  // Stops |entity| from being picked.
+  void RemovePickable(Entity entity);
+
+  // Returns true if |entity| is pickable.
+  bool IsPickable(Entity entity) const;
+
+  // Sets the world space ray to pick along in the next Render().
+  void SetRay(const Ray& ray);
+
+  // Stops picking until the next SetRay(), and clears the result.
+  void ClearRay();
+
+  // Returns the most recent result that has been read back from the GPU.  Must
+  // be called from the thread that updates the transforms.
+  Result GetResult() const;
+
+  // Picks up the result of the previous pick if the GPU has finished it, then
+  // renders the pick pass along the current ray.  Must be called between
+  // RenderSystem::BeginRendering() and EndRendering(), after the frame's
+  // render data has been submitted.
+  void Render();
+
+  // Returns the render pass the pickable Entities are drawn in.
+  HashValue GetPass() const { return pass_; }
+
+  // Returns the color that encodes |entity| in the pick pass.
+  static mathfu::vec4 EncodeEntity(Entity entity);
+
+  // Returns the Entity encoded in the RGBA8 |pixel|.
+  static Entity DecodeEntity(const uint8_t* pixel);
+
+ private:
+  // Returns the Entity nearest the center of the |size_| square RGBA8
+  // |pixels|.
+  Entity FindNearestToCenter(const uint8_t* pixels) const;
+
+  // Returns the distance along |ray| to |entity|'s bounding box.
+  float ComputeDistance(const Ray& ray, Entity entity) const;
+
+  Registry* registry_;
+  const std::string shading_model_;
+  const int size_;
+  const float angle_;
+  const HashValue pass_;
+  const HashValue render_target_;
+  std::unordered_set<Entity> pickables_;
+
+  // The pick being read back, only used by Render().
+  Ray pending_ray_;
+  int frames_in_flight_ = 0;
+
+  // State shared by SetRay(), GetResult() and Render(), guarded by |mutex_|.
+  mutable std::mutex mutex_;
+  Ray ray_;
+  bool has_ray_ = false;
+  bool picked_valid_ = false;
+  Entity picked_entity_ = kNullEntity;
+  Ray picked_ray_;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::RenderPicker);
+
+#endif  // LULLABY_SYSTEMS_RENDER_RENDER_PICKER_H_
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include "mathfu/glsl_mappings.h"
 #include "lullaby/util/registry.h"
@@ -37,6 +38,25 @@ class RenderStats {
     kTextureSize,  // Checks for potentially erroneous texture sizes.
   };
 
+  // The stats of a single render pass.
+  struct PassStats {
+    HashValue pass = 0;
+    // The GPU time in milliseconds, or 0.0 if GPU timing is not supported.
+    float gpu_ms = 0.0f;
+    int num_draws = 0;
+    int num_verts = 0;
+    int num_tris = 0;
+  };
+
+  // The occlusion culling stats of a frame.
+  struct OcclusionStats {
+    int num_tested = 0;
+    int num_occluded = 0;
+    // The fraction of the tested Entities that were culled, or 0.0 if none
+    // were tested.
+    float culled_fraction = 0.0f;
+  };
+
   struct EnumClassHash {
     template <typename T>
     std::size_t operator()(T t) const {
@@ -66,6 +86,15 @@ class RenderStats {
   // lullaby/tools/perf_log_to_csv.sh.
   void EnablePerformanceLogging(int interval);
 
+  // Returns the stats of each pass, in the order they were rendered, for the
+  // most recent frame whose GPU timings have been read back (typically a few
+  // frames ago).  Stats are only collected while the FPS counter or render
+  // stats layers or performance logging are enabled.
+  std::vector<PassStats> GetPassStats() const;
+
+  // Returns the occlusion culling stats of the most recently completed frame.
+  OcclusionStats GetOcclusionStats() const;
+
   // Called automatically by RenderSystem.
   void BeginFrame();
 
@@ -143,9 +143,33 @@ class RenderSystem : public System {
   void CreateRenderTarget(HashValue render_target_name,
                           const RenderTargetCreateParams& create_params);
 
-  // Gets the content of the render target on the CPU.
+  // Gets the content of the render target on the CPU.  This waits for the GPU
+  // to finish rendering; prefer RequestRenderTargetData() where possible.
   ImageData GetRenderTargetData(HashValue render_target_name);
 
+  /// Starts copying the |rect| region of the render target to the CPU without
+  /// waiting for the GPU to finish rendering to it.  Collect the data with
+  /// TakeRenderTargetData(), usually in a later frame.
+  void ReadRenderTargetDataAsync(HashValue render_target_name,
+                                 const mathfu::recti& rect);
+
+  /// Returns the data requested by the last ReadRenderTargetDataAsync() call
+  /// for the render target once the GPU has written it, or an empty ImageData
+  /// if it is not ready yet.
+  ImageData TakeRenderTargetData(HashValue render_target_name);
+
+  /// Copies the content of the render target to the CPU at the end of the
+  /// current frame without stalling rendering, and calls |fn| with it on the
+  /// render thread once the GPU has written it, usually a few frames later.
+  /// If |size| is non-zero, the content is first scaled to |size| on the GPU,
+  /// eg. for thumbnails.  |fn| is called with an empty ImageData if the copy
+  /// fails.  Must not be mixed with ReadRenderTargetDataAsync() on the same
+  /// render target.
+  using RenderTargetDataFn = std::function<void(ImageData)>;
+  void RequestRenderTargetData(HashValue render_target_name,
+                               RenderTargetDataFn fn,
+                               const mathfu::vec2i& size = {0, 0});
+
   /// Sets the RenderPass value to use when RenderSystem::kDefaultPass is
   /// specified as an argument to a function.
   void SetDefaultRenderPass(HashValue pass);
@@ -174,6 +198,14 @@ class RenderSystem : public System {
   /// Sets |pass|'s cull mode.
   void SetCullMode(HashValue pass, RenderCullMode mode);
 
+  /// Enables or disables instanced rendering for |pass|.  When enabled,
+  /// consecutive objects in the pass that share a mesh and a compatible
+  /// material are drawn with a single instanced draw call.  This works best
+  /// with a sort mode that groups such objects together (eg.
+  /// SortMode_MinimizeStateChanges).  Only shaders that read their transform
+  /// from the InstanceData uniform block can be instanced.
+  void SetInstancingEnabled(HashValue pass, bool enabled);
+
   /// Adds a mesh and corresponding rendering information with the Entity using
   /// the specified ComponentDef.
   void Create(Entity entity, HashValue type, const Def* def) override;
@@ -279,6 +311,20 @@ class RenderSystem : public System {
   /// Sets the shader's color uniform for the specified |entity|.
   void SetColor(Entity entity, const mathfu::vec4& color);
 
+  /// Multiplies the color of |entity| and all of its descendants by
+  /// |multiplier| when they are drawn, combined with any multipliers set on
+  /// their ancestors.  This fades or tints a whole hierarchy with a single call
+  /// instead of setting the color of every entity in it.
+  void SetSubtreeColorMultiplier(Entity entity, const mathfu::vec4& multiplier);
+
+  /// Removes the multiplier set on |entity| by SetSubtreeColorMultiplier.
+  void ClearSubtreeColorMultiplier(Entity entity);
+
+  /// Copies the multiplier set on |entity| by SetSubtreeColorMultiplier into
+  /// |multiplier|.  Returns false if there is none.
+  bool GetSubtreeColorMultiplier(Entity entity,
+                                 mathfu::vec4* multiplier) const;
+
   /// Attaches a texture to the specified Entity for all passes.
   void SetTexture(const Drawable& drawable, int unit,
                   const TexturePtr& texture);
@@ -34,6 +34,9 @@ enum class RenderStencilMode {
 enum class RenderCullMode {
   kNone,
   kVisibleInAnyView,
+  // Like kVisibleInAnyView, but also culls Entities hidden behind the
+  // occluders registered with RenderOcclusion.
+  kVisibleAndUnoccludedInAnyView,
 };
 
 enum class RenderFrontFace {
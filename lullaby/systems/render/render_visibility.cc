@@ -0,0 +1,101 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/render_visibility.h"
+
+#include <algorithm>
+
+#include "lullaby/events/render_events.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+RenderVisibility::RenderVisibility(Registry* registry) : registry_(registry) {}
+
+RenderVisibility::~RenderVisibility() {}
+
+bool RenderVisibility::TestBit(const std::vector<uint64_t>& bits,
+                               uint32_t index) {
+  const size_t word = index / 64;
+  return word < bits.size() && (bits[word] & (uint64_t(1) << (index % 64)));
+}
+
+bool RenderVisibility::IsVisible(Entity entity) const {
+  return TestBit(visible_, entity.AsUint32());
+}
+
+void RenderVisibility::BeginFrame() {
+  std::fill(pending_.begin(), pending_.end(), 0);
+  in_frame_ = true;
+}
+
+void RenderVisibility::MarkVisible(Entity entity) {
+  if (!in_frame_ || entity == kNullEntity) {
+    return;
+  }
+  const uint32_t index = entity.AsUint32();
+  const size_t word = index / 64;
+  if (word >= pending_.size()) {
+    pending_.resize(word + 1, 0);
+  }
+  pending_[word] |= uint64_t(1) << (index % 64);
+}
+
+void RenderVisibility::EndFrame() {
+  if (!in_frame_) {
+    LOG(DFATAL) << "EndFrame called without BeginFrame.";
+    return;
+  }
+  in_frame_ = false;
+
+  const size_t num_words = std::max(visible_.size(), pending_.size());
+  visible_.resize(num_words, 0);
+  pending_.resize(num_words, 0);
+
+  entered_.clear();
+  exited_.clear();
+  for (size_t i = 0; i < num_words; ++i) {
+    const uint64_t changed = visible_[i] ^ pending_[i];
+    if (changed == 0) {
+      continue;
+    }
+    for (uint32_t bit = 0; bit < 64; ++bit) {
+      const uint64_t mask = uint64_t(1) << bit;
+      if (changed & mask) {
+        const Entity entity(static_cast<uint32_t>(i * 64 + bit));
+        if (pending_[i] & mask) {
+          entered_.push_back(entity);
+        } else {
+          exited_.push_back(entity);
+        }
+      }
+    }
+  }
+  visible_.swap(pending_);
+
+  auto* dispatcher = registry_->Get<Dispatcher>();
+  if (dispatcher) {
+    for (Entity entity : exited_) {
+      dispatcher->Send(ExitedViewEvent(entity));
+    }
+    for (Entity entity : entered_) {
+      dispatcher->Send(EnteredViewEvent(entity));
+    }
+  }
+}
+
+}  // namespace lull
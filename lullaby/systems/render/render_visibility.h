@@ -0,0 +1,86 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_RENDER_VISIBILITY_H_
+#define LULLABY_SYSTEMS_RENDER_RENDER_VISIBILITY_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "lullaby/util/entity.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+// Publishes the results of the RenderSystem's per-frame view frustum culling
+// so that other systems (eg. animation LOD, audio virtualization, scripts) can
+// query whether an Entity was drawn instead of repeating the frustum tests
+// themselves.
+//
+// An Entity is visible if it passed culling in any render pass during the most
+// recently completed frame.  When the visible set changes, an EnteredViewEvent
+// or ExitedViewEvent is sent through the Dispatcher at the end of the frame.
+class RenderVisibility {
+ public:
+  // Do not create RenderVisibility directly.  Instead, create via registry, eg:
+  // registry.Create<RenderVisibility>(&registry);
+  explicit RenderVisibility(Registry* registry);
+
+  ~RenderVisibility();
+
+  // Returns true if |entity| passed culling in the last completed frame.
+  bool IsVisible(Entity entity) const;
+
+  // Returns the entities that became visible in the last completed frame.
+  const std::vector<Entity>& GetEnteredEntities() const { return entered_; }
+
+  // Returns the entities that stopped being visible in the last completed
+  // frame.
+  const std::vector<Entity>& GetExitedEntities() const { return exited_; }
+
+  // Returns the bitset of visible entities for the last completed frame, where
+  // bit (value % 64) of word (value / 64) is set for each visible Entity value.
+  const std::vector<uint64_t>& GetVisibleBits() const { return visible_; }
+
+  // Called automatically by RenderSystem to begin gathering a new frame.
+  void BeginFrame();
+
+  // Called automatically by RenderSystem for each Entity that passes culling.
+  void MarkVisible(Entity entity);
+
+  // Called automatically by RenderSystem.  Publishes the gathered frame and
+  // sends the enter/exit events.
+  void EndFrame();
+
+ private:
+  static bool TestBit(const std::vector<uint64_t>& bits, uint32_t index);
+
+  Registry* registry_;
+  // The visible set of the last completed frame.
+  std::vector<uint64_t> visible_;
+  // The visible set of the frame being gathered.
+  std::vector<uint64_t> pending_;
+  std::vector<Entity> entered_;
+  std::vector<Entity> exited_;
+  bool in_frame_ = false;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::RenderVisibility);
+
+#endif  // LULLABY_SYSTEMS_RENDER_RENDER_VISIBILITY_H_
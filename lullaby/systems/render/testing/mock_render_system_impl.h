@@ -95,6 +95,11 @@ class RenderSystemImplInternal {
 
   MOCK_METHOD2(GetColor, bool(Entity entity, mathfu::vec4* color));
   MOCK_METHOD2(SetColor, void(Entity e, const mathfu::vec4& color));
+  MOCK_METHOD2(SetSubtreeColorMultiplier,
+               void(Entity e, const mathfu::vec4& multiplier));
+  MOCK_METHOD1(ClearSubtreeColorMultiplier, void(Entity e));
+  MOCK_CONST_METHOD2(GetSubtreeColorMultiplier,
+                     bool(Entity e, mathfu::vec4* multiplier));
 
   MOCK_METHOD4(SetUniform, void(Entity e, const char* name, const float* data,
                                 int dimension));
@@ -175,6 +180,7 @@ class RenderSystemImplInternal {
   MOCK_METHOD2(SetClearParams,
                void(HashValue pass, const RenderClearParams& clear_params));
   MOCK_METHOD2(SetCullMode, void(HashValue pass, RenderCullMode mode));
+  MOCK_METHOD2(SetInstancingEnabled, void(HashValue pass, bool enabled));
   MOCK_METHOD1(SetDefaultFrontFace, void(RenderFrontFace face));
   MOCK_METHOD2(CreateRenderTarget,
                void(HashValue render_target_name,
@@ -242,6 +248,13 @@ class RenderSystemImplInternal {
   MOCK_METHOD2(SetRenderTarget,
                void(HashValue pass, HashValue render_target_name));
   MOCK_METHOD1(GetRenderTargetData, ImageData(HashValue render_target_name));
+  MOCK_METHOD2(ReadRenderTargetDataAsync,
+               void(HashValue render_target_name, const mathfu::recti& rect));
+  MOCK_METHOD1(TakeRenderTargetData, ImageData(HashValue render_target_name));
+  MOCK_METHOD3(RequestRenderTargetData,
+               void(HashValue render_target_name,
+                    RenderSystem::RenderTargetDataFn fn,
+                    const mathfu::vec2i& size));
 
   MOCK_METHOD1(GetGroupId, Optional<HashValue>(Entity entity));
   MOCK_METHOD2(SetGroupId,
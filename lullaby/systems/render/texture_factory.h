@@ -141,6 +141,23 @@ class TextureFactory {
   // pointer to the ImageData instead of by-value.
   virtual TexturePtr CreateTextureDeprecated(const ImageData* image,
                                              const TextureParams& params) = 0;
+
+  /// The GPU residency of a texture whose mips are kept within a memory
+  /// budget.
+  struct TextureResidencyInfo {
+    std::string name;
+    mathfu::vec2i size = {0, 0};
+    int num_levels = 1;
+    /// The most detailed mip that is (or is being streamed to be) resident.
+    int resident_level = 0;
+    size_t resident_bytes = 0;
+    bool streaming = false;
+  };
+
+  /// Calls |fn| with the residency of every texture managed by a texture
+  /// memory budget.  Backends that do not support a budget report nothing.
+  virtual void ForEachTextureResidency(
+      const std::function<void(const TextureResidencyInfo&)>& fn) const {}
 };
 
 }  // namespace lull
@@ -0,0 +1,288 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/texture_residency.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+TextureResidency::TextureResidency() {}
+
+TextureResidency::TextureResidency(const Params& params) : params_(params) {}
+
+TextureResidency::TextureId TextureResidency::Add(const mathfu::vec2i& size,
+                                                  size_t bytes_per_texel,
+                                                  int num_levels) {
+  if (size.x <= 0 || size.y <= 0 || num_levels <= 0) {
+    LOG(DFATAL) << "Invalid texture: " << size.x << "x" << size.y << " with "
+                << num_levels << " levels";
+    return kInvalidTextureId;
+  }
+
+  Entry entry;
+  entry.size = size;
+  entry.bytes_per_texel = bytes_per_texel;
+  entry.num_levels = num_levels;
+  entry.requested_level = num_levels;
+  entry.last_used_frame = frame_;
+  entry.streaming = true;
+
+  // Start with as much detail as fits, since it is not yet known how large the
+  // texture will be on screen.
+  int level = 0;
+  while (level < num_levels - 1 &&
+         total_bytes_ + GetBytes(entry, level) > params_.budget_bytes) {
+    ++level;
+  }
+  entry.level = level;
+  total_bytes_ += GetBytes(entry, level);
+
+  const TextureId id = next_id_++;
+  entries_.emplace(id, entry);
+  return id;
+}
+
+void TextureResidency::Remove(TextureId id) {
+  auto iter = entries_.find(id);
+  if (iter != entries_.end()) {
+    total_bytes_ -= GetBytes(iter->second, iter->second.level);
+    entries_.erase(iter);
+  }
+}
+
+void TextureResidency::RequestScreenSize(TextureId id, float screen_size) {
+  auto iter = entries_.find(id);
+  if (iter != entries_.end()) {
+    Entry& entry = iter->second;
+    entry.requested_level = std::min(
+        entry.requested_level, GetLevelForScreenSize(entry, screen_size));
+  }
+}
+
+void TextureResidency::SetResidentLevel(TextureId id, int level) {
+  auto iter = entries_.find(id);
+  if (iter != entries_.end()) {
+    Entry& entry = iter->second;
+    SetLevel(&entry, std::max(0, std::min(level, entry.num_levels - 1)));
+    entry.streaming = false;
+  }
+}
+
+bool TextureResidency::IsStreaming(TextureId id) const {
+  auto iter = entries_.find(id);
+  return iter != entries_.end() && iter->second.streaming;
+}
+
+int TextureResidency::GetResidentLevel(TextureId id) const {
+  auto iter = entries_.find(id);
+  return iter != entries_.end() ? iter->second.level : -1;
+}
+
+size_t TextureResidency::GetResidentBytes(TextureId id) const {
+  auto iter = entries_.find(id);
+  return iter != entries_.end() ? GetBytes(iter->second, iter->second.level)
+                                : 0;
+}
+
+void TextureResidency::Update(std::vector<LevelChange>* trims,
+                              std::vector<LevelChange>* restreams) {
+  trims->clear();
+  restreams->clear();
+
+  std::unordered_map<TextureId, int> trim_levels;
+  std::vector<LevelChange> wanted;
+  for (auto& iter : entries_) {
+    Entry& entry = iter.second;
+    const bool used = entry.requested_level < entry.num_levels;
+    if (used) {
+      entry.last_used_frame = frame_;
+    }
+    if (entry.streaming) {
+      continue;
+    }
+
+    int level = entry.level;
+    if (used) {
+      if (entry.requested_level < entry.level) {
+        level = entry.requested_level;
+      } else if (entry.requested_level >
+                 entry.level + params_.hysteresis_levels) {
+        level = entry.requested_level - params_.hysteresis_levels;
+      }
+    } else if (frame_ - entry.last_used_frame >=
+               static_cast<uint64_t>(params_.unused_frames)) {
+      level = std::max(entry.level, GetUnusedLevel(entry));
+    }
+
+    if (level > entry.level) {
+      SetLevel(&entry, level);
+      trim_levels[iter.first] = level;
+    } else if (level < entry.level) {
+      wanted.push_back({iter.first, level});
+    }
+  }
+
+  // Memory is reclaimed by dropping mips from the least recently drawn
+  // textures first and, among those drawn equally recently, from the ones which
+  // need the least detail.
+  std::vector<std::pair<TextureId, Entry*>> evictable;
+  for (auto& iter : entries_) {
+    const Entry& entry = iter.second;
+    if (!entry.streaming && entry.level < entry.num_levels - 1) {
+      evictable.emplace_back(iter.first, &iter.second);
+    }
+  }
+  std::sort(evictable.begin(), evictable.end(),
+            [](const std::pair<TextureId, Entry*>& lhs,
+               const std::pair<TextureId, Entry*>& rhs) {
+              if (lhs.second->last_used_frame !=
+                  rhs.second->last_used_frame) {
+                return lhs.second->last_used_frame <
+                       rhs.second->last_used_frame;
+              }
+              if (lhs.second->requested_level !=
+                  rhs.second->requested_level) {
+                return lhs.second->requested_level >
+                       rhs.second->requested_level;
+              }
+              return lhs.first < rhs.first;
+            });
+  auto evict = [&](size_t max_bytes, bool only_unused) {
+    for (auto& iter : evictable) {
+      if (total_bytes_ <= max_bytes) {
+        return;
+      }
+      Entry* entry = iter.second;
+      if (only_unused && entry->last_used_frame == frame_) {
+        continue;
+      }
+      while (total_bytes_ > max_bytes && entry->level < entry->num_levels - 1) {
+        SetLevel(entry, entry->level + 1);
+        trim_levels[iter.first] = entry->level;
+      }
+    }
+  };
+
+  // Textures drawn this update are only reduced below the detail they need if
+  // the budget is exceeded regardless.
+  evict(params_.budget_bytes, false);
+
+  // Stream in the most missing detail first, making room by dropping mips of
+  // textures that were not drawn this update, and settling for less detail if
+  // there is still not enough room.
+  std::sort(wanted.begin(), wanted.end(),
+            [this](const LevelChange& lhs, const LevelChange& rhs) {
+              const int lhs_missing = entries_[lhs.id].level - lhs.level;
+              const int rhs_missing = entries_[rhs.id].level - rhs.level;
+              if (lhs_missing != rhs_missing) {
+                return lhs_missing > rhs_missing;
+              }
+              return lhs.id < rhs.id;
+            });
+  const size_t max_restreams =
+      static_cast<size_t>(std::max(0, params_.max_restreams_per_frame));
+  for (const LevelChange& change : wanted) {
+    if (restreams->size() >= max_restreams) {
+      break;
+    }
+    if (trim_levels.count(change.id)) {
+      continue;
+    }
+    Entry& entry = entries_[change.id];
+    const size_t extra_bytes =
+        GetBytes(entry, change.level) - GetBytes(entry, entry.level);
+    if (extra_bytes <= params_.budget_bytes) {
+      evict(params_.budget_bytes - extra_bytes, true);
+    }
+    const size_t other_bytes = total_bytes_ - GetBytes(entry, entry.level);
+    for (int level = change.level; level < entry.level; ++level) {
+      if (other_bytes + GetBytes(entry, level) <= params_.budget_bytes) {
+        SetLevel(&entry, level);
+        entry.streaming = true;
+        restreams->push_back({change.id, level});
+        break;
+      }
+    }
+  }
+
+  for (const auto& iter : trim_levels) {
+    trims->push_back({iter.first, iter.second});
+  }
+  for (auto& iter : entries_) {
+    iter.second.requested_level = iter.second.num_levels;
+  }
+  ++frame_;
+}
+
+int TextureResidency::CountMipLevels(const mathfu::vec2i& size) {
+  int num_levels = 1;
+  for (int dim = std::max(size.x, size.y); dim > 1; dim /= 2) {
+    ++num_levels;
+  }
+  return num_levels;
+}
+
+size_t TextureResidency::CalculateBytes(const mathfu::vec2i& size,
+                                        size_t bytes_per_texel, int num_levels,
+                                        int level) {
+  size_t num_texels = 0;
+  for (int i = std::max(0, level); i < num_levels; ++i) {
+    const size_t width = std::max(1, size.x >> i);
+    const size_t height = std::max(1, size.y >> i);
+    num_texels += width * height;
+  }
+  return num_texels * bytes_per_texel;
+}
+
+size_t TextureResidency::GetBytes(const Entry& entry, int level) const {
+  return CalculateBytes(entry.size, entry.bytes_per_texel, entry.num_levels,
+                        level);
+}
+
+int TextureResidency::GetLevelForScreenSize(const Entry& entry,
+                                            float screen_size) const {
+  const int max_level = entry.num_levels - 1;
+  const float size = static_cast<float>(std::max(entry.size.x, entry.size.y));
+  if (screen_size <= 0.f) {
+    return max_level;
+  } else if (screen_size >= size) {
+    return 0;
+  }
+  const int level = static_cast<int>(std::floor(std::log2(size / screen_size)));
+  return std::max(0, std::min(level, max_level));
+}
+
+int TextureResidency::GetUnusedLevel(const Entry& entry) const {
+  int level = 0;
+  while (level < entry.num_levels - 1 &&
+         std::max(entry.size.x >> level, entry.size.y >> level) >
+             params_.unused_max_size) {
+    ++level;
+  }
+  return level;
+}
+
+void TextureResidency::SetLevel(Entry* entry, int level) {
+  total_bytes_ -= GetBytes(*entry, entry->level);
+  entry->level = level;
+  total_bytes_ += GetBytes(*entry, entry->level);
+}
+
+}  // namespace lull
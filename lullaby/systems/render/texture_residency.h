@@ -0,0 +1,153 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_TEXTURE_RESIDENCY_H_
+#define LULLABY_SYSTEMS_RENDER_TEXTURE_RESIDENCY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "mathfu/glsl_mappings.h"
+
+namespace lull {
+
+// Decides which mips of textures should be resident on the GPU in order to
+// keep their memory within a budget.
+//
+// Each frame, the renderer requests the detail it needs for every texture it
+// draws based on the texture's size on screen.  Update() then decides which
+// textures should drop their largest mips (because they are small on screen,
+// have not been drawn for a while, or the memory is needed for other
+// textures) and which should have their larger mips streamed back in.
+// Applying those decisions is left to the renderer, which reports back through
+// SetResidentLevel() once streamed mips are available.
+//
+// Levels are the mip levels of the full image: a texture resident at level n
+// has all the mips from n down to the smallest one.
+class TextureResidency {
+ public:
+  using TextureId = uint32_t;
+  static constexpr TextureId kInvalidTextureId = 0;
+
+  struct Params {
+    // The number of bytes that the resident mips of all textures may use.
+    size_t budget_bytes = 256 * 1024 * 1024;
+    // Textures that are not drawn for this many updates are reduced to the
+    // mips which are at most |unused_max_size| texels on each side.
+    int unused_frames = 120;
+    int unused_max_size = 64;
+    // Drawn textures only drop mips once they have at least this many more
+    // levels than needed, and then keep this many extra levels, so that small
+    // changes in size on screen do not repeatedly drop and stream the same
+    // mip.
+    int hysteresis_levels = 1;
+    // The maximum number of textures to stream mips back into per update.
+    int max_restreams_per_frame = 2;
+  };
+
+  // A change to the resident level of a texture.
+  struct LevelChange {
+    TextureId id;
+    int level;
+  };
+
+  TextureResidency();
+  explicit TextureResidency(const Params& params);
+
+  void SetParams(const Params& params) { params_ = params; }
+  const Params& GetParams() const { return params_; }
+
+  // Starts tracking a texture of |size| texels with |num_levels| mips.  The
+  // texture starts out at the most detailed level that fits in the remaining
+  // budget (see GetResidentLevel()) and is considered to be streaming in
+  // until SetResidentLevel() is called.
+  TextureId Add(const mathfu::vec2i& size, size_t bytes_per_texel,
+                int num_levels);
+
+  // Stops tracking the texture.
+  void Remove(TextureId id);
+
+  // Requests enough detail for the texture to be drawn |screen_size| pixels
+  // across (along its larger side) during this update.  When several sizes
+  // are requested the largest one is used.
+  void RequestScreenSize(TextureId id, float screen_size);
+
+  // Records that the texture's mips from |level| down are resident, ie. that
+  // streaming mips in has finished or been abandoned.
+  void SetResidentLevel(TextureId id, int level);
+
+  // Returns true if mips are being streamed into the texture.
+  bool IsStreaming(TextureId id) const;
+
+  // Decides the resident level of each texture for the requests made since
+  // the last update.  |trims| is filled with the textures that should drop
+  // their largest mips, which are immediately considered resident at the new
+  // level.  |restreams| is filled with the textures that should have larger
+  // mips streamed in, which are considered to be streaming until
+  // SetResidentLevel() is called.
+  void Update(std::vector<LevelChange>* trims,
+              std::vector<LevelChange>* restreams);
+
+  // Returns the level at which the texture is (or is being streamed to be)
+  // resident, or -1 if the texture is not tracked.
+  int GetResidentLevel(TextureId id) const;
+
+  // Returns the number of bytes used by the texture's resident mips.
+  size_t GetResidentBytes(TextureId id) const;
+
+  // Returns the number of bytes used by the resident mips of all textures,
+  // including the mips being streamed in.
+  size_t GetTotalResidentBytes() const { return total_bytes_; }
+
+  // Returns the number of mips in a full mip chain for |size|.
+  static int CountMipLevels(const mathfu::vec2i& size);
+
+  // Returns the number of bytes used by the mips from |level| down of a
+  // texture of |size| texels with |num_levels| mips.
+  static size_t CalculateBytes(const mathfu::vec2i& size,
+                               size_t bytes_per_texel, int num_levels,
+                               int level);
+
+ private:
+  struct Entry {
+    mathfu::vec2i size = {0, 0};
+    size_t bytes_per_texel = 0;
+    int num_levels = 1;
+    int level = 0;
+    bool streaming = false;
+    // The most detailed level requested since the last update, or
+    // |num_levels| if the texture was not drawn.
+    int requested_level = 0;
+    uint64_t last_used_frame = 0;
+  };
+
+  size_t GetBytes(const Entry& entry, int level) const;
+  int GetLevelForScreenSize(const Entry& entry, float screen_size) const;
+  int GetUnusedLevel(const Entry& entry) const;
+  void SetLevel(Entry* entry, int level);
+
+  Params params_;
+  std::unordered_map<TextureId, Entry> entries_;
+  TextureId next_id_ = kInvalidTextureId + 1;
+  uint64_t frame_ = 0;
+  size_t total_bytes_ = 0;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_RENDER_TEXTURE_RESIDENCY_H_
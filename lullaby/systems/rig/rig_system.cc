@@ -16,8 +16,11 @@ limitations under the License.
 
 #include "lullaby/systems/rig/rig_system.h"
 
+#include <algorithm>
+
 #include "lullaby/systems/animation/animation_system.h"
 #include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/make_unique.h"
 #include "lullaby/util/math.h"
 
@@ -45,7 +48,17 @@ class RigChannel : public AnimationChannel {
 };
 
 RigSystem::RigSystem(Registry* registry, bool use_ubo)
-    : System(registry), use_ubo_(use_ubo) {}
+    : System(registry),
+      use_ubo_(use_ubo),
+      transform_flag_(TransformSystem::kInvalidFlag) {}
+
+RigSystem::~RigSystem() {
+  auto* transform_system = registry_->Get<TransformSystem>();
+  if (transform_system && transform_flag_ != TransformSystem::kInvalidFlag) {
+    transform_system->UntrackChanges(transform_flag_);
+    transform_system->ReleaseFlag(transform_flag_);
+  }
+}
 
 void RigSystem::Initialize() {
   auto* animation_system = registry_->Get<AnimationSystem>();
@@ -55,67 +68,107 @@ void RigSystem::Initialize() {
   } else {
     LOG(DFATAL) << "Failed to setup RigChannel.";
   }
+
+  auto* transform_system = registry_->Get<TransformSystem>();
+  if (transform_system) {
+    transform_flag_ = transform_system->RequestFlag();
+    transform_system->TrackChanges(transform_flag_);
+  }
 }
 
-void RigSystem::SetRig(Entity entity, BoneIndices parent_indices,
-                       Pose inverse_bind_pose, BoneIndices shader_indices,
-                       std::vector<std::string> bone_names) {
+RigSystem::SkeletonPtr RigSystem::CreateSkeleton(
+    BoneIndices parent_indices, Pose inverse_bind_pose,
+    BoneIndices shader_indices, std::vector<std::string> bone_names) {
   const size_t num_bones = parent_indices.size();
   if (num_bones == 0) {
-    return;
+    return nullptr;
   } else if (num_bones != inverse_bind_pose.size()) {
-    return;
+    return nullptr;
   }
 
-  auto res = rigs_.emplace(entity, RigComponent());
-  if (!res.second) {
-    return;
-  }
-  RigComponent& rig = res.first->second;
-  rig.parent_indices.assign(parent_indices.begin(), parent_indices.end());
+  auto skeleton = std::make_shared<Skeleton>();
+  skeleton->parent_indices.assign(parent_indices.begin(), parent_indices.end());
 
 #if 0
-  rig.inverse_bind_pose.assign(inverse_bind_pose.begin(),
-                               inverse_bind_pose.end());
+  skeleton->inverse_bind_pose.assign(inverse_bind_pose.begin(),
+                                     inverse_bind_pose.end());
 #else
   // TODO: The data in the inverse_bind_pose may not be aligned
-  // correctly, so manually copy the floats into the rig's inverse_bind_pose.
-  const size_t num_bind_bones = inverse_bind_pose.size();
-  rig.inverse_bind_pose.reserve(num_bind_bones);
-  for (size_t i = 0; i < num_bind_bones; ++i) {
+  // correctly, so manually copy the floats into the skeleton's
+  // inverse_bind_pose.
+  skeleton->inverse_bind_pose.reserve(num_bones);
+  for (size_t i = 0; i < num_bones; ++i) {
     const auto& m = inverse_bind_pose[i];
-    rig.inverse_bind_pose.emplace_back(m[0], m[1], m[2], m[3],
-                                       m[4], m[5], m[6], m[7],
-                                       m[8], m[9], m[10], m[11]);
+    skeleton->inverse_bind_pose.emplace_back(m[0], m[1], m[2], m[3],
+                                             m[4], m[5], m[6], m[7],
+                                             m[8], m[9], m[10], m[11]);
   }
 #endif
 
-  rig.shader_indices.assign(shader_indices.begin(), shader_indices.end());
-  rig.bone_names = std::move(bone_names);
+  skeleton->shader_indices.assign(shader_indices.begin(),
+                                  shader_indices.end());
+  skeleton->bone_names = std::move(bone_names);
+
+  // The bind pose is the inverse of the inverse bind pose. See
+  // UpdateShaderTransforms() for a discussion of space changes in skinning.
+  skeleton->bind_pose.reserve(num_bones);
+  for (size_t i = 0; i < num_bones; ++i) {
+    const mathfu::mat4 inverse_bind =
+        mathfu::mat4::FromAffineTransform(skeleton->inverse_bind_pose[i]);
+    skeleton->bind_pose.push_back(
+        mathfu::mat4::ToAffineTransform(inverse_bind.Inverse()));
+  }
+  return skeleton;
+}
+
+void RigSystem::SetRig(Entity entity, BoneIndices parent_indices,
+                       Pose inverse_bind_pose, BoneIndices shader_indices,
+                       std::vector<std::string> bone_names) {
+  if (rigs_.count(entity)) {
+    return;
+  }
+  SetRig(entity, CreateSkeleton(parent_indices, inverse_bind_pose,
+                                shader_indices, std::move(bone_names)));
+}
 
-  // Clear out any previous pose.
-  rig.pose.resize(num_bones);
-  for (size_t i = 0; i < rig.pose.size(); ++i) {
-    rig.pose[i] = mathfu::mat4::ToAffineTransform(mathfu::mat4::Identity());
+void RigSystem::SetRig(Entity entity, SkeletonPtr skeleton) {
+  if (!skeleton) {
+    return;
   }
 
-  // Initialize the pose to the inverse of the inverse bind pose, which is just
-  // the bind pose. See UpdateShaderTransforms() for a discussion of space
-  // changes in skinning.
-  for (uint8_t i = 0; i < rig.parent_indices.size(); ++i) {
-    const mathfu::mat4 inverse_bind =
-        mathfu::mat4::FromAffineTransform(rig.inverse_bind_pose[i]);
-    rig.pose[i] = mathfu::mat4::ToAffineTransform(inverse_bind.Inverse());
+  auto res = rigs_.emplace(entity, RigComponent());
+  if (!res.second) {
+    return;
   }
+  RigComponent& rig = res.first->second;
+  rig.skeleton = std::move(skeleton);
+
+  // Initialize the pose to the bind pose.
+  rig.pose = rig.skeleton->bind_pose;
   UpdateShaderTransforms(entity, &rig);
 }
 
-void RigSystem::Destroy(Entity entity) { rigs_.erase(entity); }
+void RigSystem::Destroy(Entity entity) {
+  DetachFromBone(entity);
+
+  auto iter = rigs_.find(entity);
+  if (iter == rigs_.end()) {
+    return;
+  }
+  if (!iter->second.attachments.empty()) {
+    for (const Entity attachment : iter->second.attachments) {
+      bone_attachments_.erase(attachment);
+    }
+    auto* transform_system = registry_->Get<TransformSystem>();
+    transform_system->ClearFlag(entity, transform_flag_);
+  }
+  rigs_.erase(iter);
+}
 
 size_t RigSystem::GetNumBones(Entity entity) const {
   auto iter = rigs_.find(entity);
   if (iter != rigs_.end()) {
-    return iter->second.parent_indices.size();
+    return iter->second.skeleton->parent_indices.size();
   }
   return 0;
 }
@@ -123,7 +176,7 @@ size_t RigSystem::GetNumBones(Entity entity) const {
 Span<uint8_t> RigSystem::GetBoneParentIndices(Entity entity) const {
   auto iter = rigs_.find(entity);
   if (iter != rigs_.end()) {
-    return iter->second.parent_indices;
+    return iter->second.skeleton->parent_indices;
   }
   return {};
 }
@@ -131,7 +184,7 @@ Span<uint8_t> RigSystem::GetBoneParentIndices(Entity entity) const {
 Span<std::string> RigSystem::GetBoneNames(Entity entity) const {
   auto iter = rigs_.find(entity);
   if (iter != rigs_.end()) {
-    return iter->second.bone_names;
+    return iter->second.skeleton->bone_names;
   }
   return {};
 }
@@ -140,7 +193,7 @@ RigSystem::Pose RigSystem::GetDefaultBoneTransformInverses(
     Entity entity) const {
   auto iter = rigs_.find(entity);
   if (iter != rigs_.end()) {
-    return iter->second.inverse_bind_pose;
+    return iter->second.skeleton->inverse_bind_pose;
   }
   return {};
 }
@@ -160,29 +213,149 @@ void RigSystem::SetPose(Entity entity, Pose pose) {
   }
 
   RigComponent& rig = iter->second;
-  if (pose.size() != rig.parent_indices.size()) {
-    LOG(DFATAL) << "Bone count mismatch. Expected " << rig.parent_indices.size()
+  const size_t num_bones = rig.skeleton->parent_indices.size();
+  if (pose.size() != num_bones) {
+    LOG(DFATAL) << "Bone count mismatch. Expected " << num_bones
                 << " got " << pose.size() << ".";
     return;
   }
 
   rig.pose.assign(pose.begin(), pose.end());
   UpdateShaderTransforms(entity, &rig);
+  MarkAttachmentsDirty(entity, &rig);
+}
+
+void RigSystem::AttachToBone(Entity attachment, Entity rig_entity, size_t bone,
+                             const Sqt& bone_from_attachment) {
+  auto* transform_system = registry_->Get<TransformSystem>();
+  if (transform_system == nullptr ||
+      transform_flag_ == TransformSystem::kInvalidFlag) {
+    LOG(DFATAL) << "Bone attachments require the TransformSystem.";
+    return;
+  }
+  if (attachment == rig_entity) {
+    LOG(DFATAL) << "Cannot attach an Entity to its own rig.";
+    return;
+  }
+  auto iter = rigs_.find(rig_entity);
+  if (iter == rigs_.end()) {
+    LOG(ERROR) << "Cannot attach to an Entity without a rig.";
+    return;
+  }
+  RigComponent& rig = iter->second;
+  if (bone >= rig.skeleton->parent_indices.size()) {
+    LOG(DFATAL) << "Invalid bone index " << bone << " for a rig with "
+                << rig.skeleton->parent_indices.size() << " bones.";
+    return;
+  }
+
+  DetachFromBone(attachment);
+
+  BoneAttachment& data = bone_attachments_[attachment];
+  data.rig_entity = rig_entity;
+  data.bone = static_cast<uint8_t>(bone);
+  data.bone_from_attachment = CalculateTransformMatrix(bone_from_attachment);
+
+  if (rig.attachments.empty()) {
+    transform_system->SetFlag(rig_entity, transform_flag_);
+  }
+  rig.attachments.push_back(attachment);
+  MarkAttachmentsDirty(rig_entity, &rig);
+}
+
+void RigSystem::DetachFromBone(Entity attachment) {
+  auto iter = bone_attachments_.find(attachment);
+  if (iter == bone_attachments_.end()) {
+    return;
+  }
+  const Entity rig_entity = iter->second.rig_entity;
+  bone_attachments_.erase(iter);
+
+  auto rig_iter = rigs_.find(rig_entity);
+  if (rig_iter == rigs_.end()) {
+    return;
+  }
+  std::vector<Entity>& attachments = rig_iter->second.attachments;
+  attachments.erase(
+      std::remove(attachments.begin(), attachments.end(), attachment),
+      attachments.end());
+  if (attachments.empty()) {
+    auto* transform_system = registry_->Get<TransformSystem>();
+    transform_system->ClearFlag(rig_entity, transform_flag_);
+  }
+}
+
+void RigSystem::MarkAttachmentsDirty(Entity entity, RigComponent* rig) {
+  if (!rig->attachments.empty() && !rig->attachments_dirty) {
+    rig->attachments_dirty = true;
+    dirty_rigs_.push_back(entity);
+  }
+}
+
+void RigSystem::UpdateBoneAttachments() {
+  auto* transform_system = registry_->Get<TransformSystem>();
+  if (transform_system == nullptr ||
+      transform_flag_ == TransformSystem::kInvalidFlag) {
+    return;
+  }
+
+  // Rigs that moved (or were enabled) need their attachments updated even if
+  // they were not posed.
+  transform_system->TakeChangedEntities(transform_flag_, &changed_entities_);
+  for (const Entity entity : changed_entities_) {
+    auto iter = rigs_.find(entity);
+    if (iter != rigs_.end()) {
+      MarkAttachmentsDirty(entity, &iter->second);
+    }
+  }
+  changed_entities_.clear();
+
+  for (const Entity entity : dirty_rigs_) {
+    auto iter = rigs_.find(entity);
+    if (iter == rigs_.end()) {
+      continue;
+    }
+    RigComponent& rig = iter->second;
+    rig.attachments_dirty = false;
+
+    // Disabled rigs have no world transform, and are recorded as changed when
+    // they are enabled again.
+    const mathfu::mat4* world_from_rig =
+        transform_system->GetWorldFromEntityMatrix(entity);
+    if (world_from_rig == nullptr) {
+      continue;
+    }
+
+    // The pose matrices are already in the space of the rig's Entity (see
+    // UpdateShaderTransforms()), so no walk up the skeleton is needed.
+    for (const Entity attachment : rig.attachments) {
+      const BoneAttachment& data = bone_attachments_[attachment];
+      const mathfu::mat4 world_from_attachment =
+          *world_from_rig *
+          mathfu::mat4::FromAffineTransform(rig.pose[data.bone]) *
+          data.bone_from_attachment;
+      transform_system->SetWorldFromEntityMatrix(attachment,
+                                                 world_from_attachment);
+    }
+  }
+  dirty_rigs_.clear();
 }
 
 void RigSystem::UpdateShaderTransforms(Entity entity, RigComponent* rig) {
-  if (rig->pose.empty() || rig->parent_indices.empty()) {
+  const Skeleton& skeleton = *rig->skeleton;
+  if (rig->pose.empty() || skeleton.parent_indices.empty()) {
     return;
   }
 
-  const size_t num_bones = rig->shader_indices.size();
+  const size_t num_bones = skeleton.shader_indices.size();
   rig->shader_pose.resize(num_bones);
   for (size_t i = 0; i < num_bones; ++i) {
-    const uint8_t bone_index = rig->shader_indices[i];
-    CHECK(bone_index < rig->parent_indices.size());
+    const uint8_t bone_index = skeleton.shader_indices[i];
+    CHECK(bone_index < skeleton.parent_indices.size());
 
     const mathfu::AffineTransform& transform = rig->pose[bone_index];
-    const mathfu::AffineTransform& inverse = rig->inverse_bind_pose[bone_index];
+    const mathfu::AffineTransform& inverse =
+        skeleton.inverse_bind_pose[bone_index];
 
     // The shader_pose matrix transforms a vertex from "baked object space" to
     // "skinned object space". As a formula:
@@ -17,12 +17,15 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_RIG_RIG_SYSTEM_H_
 #define LULLABY_SYSTEMS_RIG_RIG_SYSTEM_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/math.h"
 #include "lullaby/util/span.h"
 #include "mathfu/glsl_mappings.h"
 
@@ -42,8 +45,47 @@ class RigSystem : public System {
   // A pose is defined by a transform for each bone in the rig.
   using Pose = Span<mathfu::AffineTransform>;
 
+  using AffineMatrixAllocator = mathfu::simd_allocator<mathfu::AffineTransform>;
+
+  // The immutable description of a skeletal rig.  A Skeleton can be shared by
+  // any number of Entities (eg. every instance of a model), each of which only
+  // stores its own pose.
+  struct Skeleton {
+    // The number of elements represents the number of bones in the rig, and
+    // each element refers to the parent bone for the bone at that index. A
+    // value of kInvalidBoneIdx (0xff or 255) indicates a root bone with no
+    // parent.
+    std::vector<uint8_t> parent_indices;
+
+    // An (optional) list of bone names useful for debugging.
+    std::vector<std::string> bone_names;
+
+    // The default inverse bind pose of each bone in the rig. These matrices
+    // transform vertices into the space of each bone so that skinning can be
+    // applied. They are mulitplied with the individual bone pose transforms to
+    // generate the final flattened pose that is sent to skinning shaders.
+    std::vector<mathfu::AffineTransform, AffineMatrixAllocator>
+        inverse_bind_pose;
+
+    // The bind pose of each bone, ie. the inverse of |inverse_bind_pose|,
+    // which is the initial pose of each Entity using the Skeleton.
+    std::vector<mathfu::AffineTransform, AffineMatrixAllocator> bind_pose;
+
+    // Maps a bone to a given uniform index in the skinning shader. Since not
+    // all bones are required for skinning and may just be necessary for
+    // computing their descendants' transforms, we only upload bones used for
+    // skinning to the shader. Each value in this vector is an index into
+    // the pose, |inverse_bind_pose|, and |parent_indices| to get the matrices
+    // necessary for the final shader pose.
+    std::vector<uint8_t> shader_indices;
+  };
+
+  using SkeletonPtr = std::shared_ptr<const Skeleton>;
+
   explicit RigSystem(Registry* registry, bool use_ubo = false);
 
+  ~RigSystem() override;
+
   // Initializes the "rig" animation channel to pass pose information from
   // the AnimationSystem to the RenderSystem.
   void Initialize() override;
@@ -51,14 +93,27 @@ class RigSystem : public System {
   RigSystem(const RigSystem&) = delete;
   RigSystem& operator=(const RigSystem&) = delete;
 
-  // Removes the rig and poses from the Entity.
+  // Removes the rig and poses from the Entity, and detaches it from any bone
+  // it is attached to.
   void Destroy(Entity entity) override;
 
+  // Creates a Skeleton which can be passed to SetRig() for any number of
+  // Entities.  Returns nullptr if the rig is empty or the number of bones in
+  // |parent_indices| and |inverse_bind_pose| do not match.
+  static SkeletonPtr CreateSkeleton(BoneIndices parent_indices,
+                                    Pose inverse_bind_pose,
+                                    BoneIndices shader_indices,
+                                    std::vector<std::string> bone_names = {});
+
   // Sets the skeletal rig for the Entity.
   void SetRig(Entity entity, BoneIndices parent_indices, Pose inverse_bind_pose,
               BoneIndices shader_indices,
               std::vector<std::string> bone_names = {});
 
+  // Sets the skeletal rig for the Entity to a shared |skeleton|, and resets
+  // the Entity's pose to the bind pose.
+  void SetRig(Entity entity, SkeletonPtr skeleton);
+
   // Sets the current pose for the Entity.
   void SetPose(Entity entity, Pose pose);
 
@@ -79,53 +134,69 @@ class RigSystem : public System {
   // associated with |entity|.
   Pose GetPose(Entity entity) const;
 
+  // Attaches |attachment| to the bone at index |bone| in |rig_entity|'s rig,
+  // offset by |bone_from_attachment|.  Unlike making |attachment| a child in
+  // the TransformSystem, the attachment's world transform is set directly from
+  // the rig's pose by UpdateBoneAttachments(), so |attachment| should not have
+  // a parent.  Replaces any previous bone attachment of |attachment|.
+  void AttachToBone(Entity attachment, Entity rig_entity, size_t bone,
+                    const Sqt& bone_from_attachment = Sqt());
+
+  // Detaches |attachment| from its bone, leaving it at its current transform.
+  void DetachFromBone(Entity attachment);
+
+  // Sets the world transforms of the bone attachments of every rig that was
+  // posed or moved since the last call, in a single pass.  Should be called
+  // once per frame after the AnimationSystem has advanced.
+  void UpdateBoneAttachments();
+
   // Whether to use Uniform Buffer Objects for bone transforms. Allows more
   // bones to be used without exceeding driver limits, but requires the skinning
   // shaders to accept the transforms as UBOs rather than plain uniforms.
   bool UseUbo() const { return use_ubo_; }
 
  private:
-  using AffineMatrixAllocator = mathfu::simd_allocator<mathfu::AffineTransform>;
-
   struct RigComponent {
-    // The number of elements represents the number of bones in the rig, and
-    // each element refers to the parent bone for the bone at that index. A
-    // value of kInvalidBoneIdx (0xff or 255) indicates a root bone with no
-    // parent.
-    std::vector<uint8_t> parent_indices;
-
-    // An (optional) list of bone names useful for debugging.
-    std::vector<std::string> bone_names;
+    // The skeleton of the rig, which may be shared with other Entities.
+    SkeletonPtr skeleton;
 
     // The current pose of the Entity represented by the local transform of each
     // bone. Typically updated once per-frame by a rig animation.
     std::vector<mathfu::AffineTransform, AffineMatrixAllocator> pose;
 
-    // The default inverse bind pose of each bone in the rig. These matrices
-    // transform vertices into the space of each bone so that skinning can be
-    // applied. They are mulitplied with the individual bone pose transforms to
-    // generate the final flattened pose that is sent to skinning shaders.
-    std::vector<mathfu::AffineTransform, AffineMatrixAllocator>
-        inverse_bind_pose;
-
-    // Maps a bone to a given uniform index in the skinning shader. Since not
-    // all bones are required for skinning and may just be necessary for
-    // computing their descendants' transforms, we only upload bones used for
-    // skinning to the shader. Each value in this vector is an index into
-    // |pose|, |inverse_bind_pose|, and |root_indices| to get the matrices
-    // necessary for the final |shader_pose|.
-    std::vector<uint8_t> shader_indices;
-
     // The flattened pose data passed to the shader for skinning. See the
     // comments in UpdateShaderTransforms() for an explanation of how these are
     // computed.
     std::vector<mathfu::AffineTransform, AffineMatrixAllocator> shader_pose;
+
+    // The Entities attached to bones of this rig.
+    std::vector<Entity> attachments;
+
+    // Set when the attachments need to be updated by UpdateBoneAttachments().
+    bool attachments_dirty = false;
+  };
+
+  struct BoneAttachment {
+    Entity rig_entity = kNullEntity;
+    uint8_t bone = 0;
+    mathfu::mat4 bone_from_attachment;
   };
 
   void UpdateShaderTransforms(Entity entity, RigComponent* rig);
 
+  // Queues |rig|'s attachments to be updated by UpdateBoneAttachments().
+  void MarkAttachmentsDirty(Entity entity, RigComponent* rig);
+
   const bool use_ubo_;
   std::unordered_map<Entity, RigComponent> rigs_;
+
+  // Bone attachments keyed by the attached Entity.
+  std::unordered_map<Entity, BoneAttachment> bone_attachments_;
+  // Rigs whose attachments need to be updated.
+  std::vector<Entity> dirty_rigs_;
+  std::vector<Entity> changed_entities_;
+  // Set on rigs with attachments to track their world transform changes.
+  TransformSystem::TransformFlags transform_flag_;
 };
 
 }  // namespace lull
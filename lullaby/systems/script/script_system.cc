@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "lullaby/generated/script_def_generated.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/system_profiler.h"
 #include "lullaby/modules/file/asset.h"
 #include "lullaby/modules/file/asset_loader.h"
 #include "lullaby/systems/dispatcher/event.h"
@@ -32,13 +33,27 @@ const HashValue kScriptOnCreateDefHash = ConstHash("ScriptOnCreateDef");
 const HashValue kScriptOnPostCreateInitDefHash =
     ConstHash("ScriptOnPostCreateInitDef");
 const HashValue kScriptOnDestroyDefHash = ConstHash("ScriptOnDestroyDef");
+
+// Returns a key identifying the code of a script, so that batched event
+// scripts with the same code can share a single script instance.
+HashValue GetEventBatchKey(const ScriptDef* script) {
+  HashValue key = static_cast<HashValue>(script->language());
+  if (script->filename()) {
+    key = HashCombine(key, Hash(script->filename()->c_str()));
+  }
+  if (script->code()) {
+    key = HashCombine(key, Hash(script->code()->c_str()));
+  }
+  return key;
+}
 }  // namespace
 
 ScriptSystem::ScriptSystem(Registry* registry)
     : System(registry),
       every_frame_scripts_(8),
       on_destroy_scripts_(8),
-      event_scripts_(8) {
+      event_scripts_(8),
+      batched_event_scripts_(8) {
   RegisterDef<ScriptOnEventDefT>(this);
   RegisterDef<ScriptEveryFrameDefT>(this);
   RegisterDef<ScriptOnCreateDefT>(this);
@@ -69,6 +84,10 @@ void ScriptSystem::PostCreateInit(Entity entity, HashValue type,
                                   const Def* def) {
   if (type == kScriptOnEventDefHash) {
     auto data = ConvertDef<ScriptOnEventDef>(def);
+    if (data->batched()) {
+      AddBatchedEventScript(entity, data);
+      return;
+    }
     auto script_id = LoadScriptDef(data->script(), entity);
     if (data->inputs() && script_id.IsValid()) {
       AddScript(&event_scripts_, entity, script_id);
@@ -110,6 +129,96 @@ void ScriptSystem::AddScript(ComponentPool<Scripts>* pool, Entity entity,
   }
 }
 
+void ScriptSystem::AddBatchedEventScript(Entity entity,
+                                         const ScriptOnEventDef* data) {
+  if (!data->script()) {
+    LOG(ERROR) << "No script def";
+    return;
+  }
+  if (!data->inputs()) {
+    return;
+  }
+  const HashValue key = GetEventBatchKey(data->script());
+  EventBatch& batch = event_batches_[key];
+  if (!batch.id.IsValid()) {
+    batch.id = LoadScriptDef(data->script());
+    if (!batch.id.IsValid()) {
+      event_batches_.erase(key);
+      return;
+    }
+  }
+  ++batch.num_entities;
+
+  BatchedScripts* scripts = batched_event_scripts_.Get(entity);
+  if (scripts) {
+    scripts->keys.emplace_back(key);
+  } else {
+    batched_event_scripts_.Emplace(entity, key);
+  }
+  ConnectEventDefs(registry_, entity, data->inputs(),
+                   [this, entity, key](const EventWrapper& event) {
+                     auto iter = event_batches_.find(key);
+                     if (iter != event_batches_.end()) {
+                       iter->second.entities.emplace_back(entity);
+                       iter->second.events.emplace_back(event);
+                     }
+                   });
+}
+
+void ScriptSystem::RemoveFromEventBatch(Entity entity, HashValue key) {
+  auto iter = event_batches_.find(key);
+  if (iter == event_batches_.end()) {
+    return;
+  }
+  EventBatch& batch = iter->second;
+  --batch.num_entities;
+  if (batch.num_entities == 0) {
+    engine_->UnloadScript(batch.id);
+    event_batches_.erase(iter);
+    return;
+  }
+
+  // Drop any events that the entity has received but not yet been delivered.
+  size_t count = 0;
+  for (size_t i = 0; i < batch.entities.size(); ++i) {
+    if (batch.entities[i] != entity) {
+      batch.entities[count] = batch.entities[i];
+      batch.events[count] = std::move(batch.events[i]);
+      ++count;
+    }
+  }
+  batch.entities.resize(count);
+  batch.events.resize(count);
+}
+
+void ScriptSystem::DeliverEventBatches() {
+  std::vector<HashValue> keys;
+  for (const auto& kv : event_batches_) {
+    if (!kv.second.entities.empty()) {
+      keys.emplace_back(kv.first);
+    }
+  }
+
+  // Scripts may send events or destroy entities, so the pending events are
+  // moved out of the batch before running its script.
+  std::vector<Entity> entities;
+  std::vector<EventWrapper> events;
+  for (HashValue key : keys) {
+    auto iter = event_batches_.find(key);
+    if (iter == event_batches_.end()) {
+      continue;
+    }
+    const ScriptId id = iter->second.id;
+    entities.swap(iter->second.entities);
+    events.swap(iter->second.events);
+    engine_->SetValue(id, "entities", entities);
+    engine_->SetValue(id, "events", events);
+    engine_->RunScript(id);
+    entities.clear();
+    events.clear();
+  }
+}
+
 ScriptId ScriptSystem::LoadScriptDef(const ScriptDef* script, Entity entity) {
   auto script_id = LoadScriptDef(script);
   if (script_id.IsValid()) {
@@ -171,9 +280,31 @@ void ScriptSystem::Destroy(Entity entity) {
     }
   }
   event_scripts_.Destroy(entity);
+  BatchedScripts* batched = batched_event_scripts_.Get(entity);
+  if (batched) {
+    for (HashValue key : batched->keys) {
+      RemoveFromEventBatch(entity, key);
+    }
+  }
+  batched_event_scripts_.Destroy(entity);
+}
+
+size_t ScriptSystem::GetNumComponents() const {
+  return every_frame_scripts_.Size() + on_destroy_scripts_.Size() +
+         event_scripts_.Size() + batched_event_scripts_.Size();
+}
+
+size_t ScriptSystem::GetComponentMemoryUsage() const {
+  return every_frame_scripts_.GetMemoryUsage() +
+         on_destroy_scripts_.GetMemoryUsage() +
+         event_scripts_.GetMemoryUsage() +
+         batched_event_scripts_.GetMemoryUsage();
 }
 
 void ScriptSystem::AdvanceFrame(Clock::duration delta_time) {
+  SystemProfiler::ScopedSample sample(registry_, this);
+  DeliverEventBatches();
+
   double delta_time_double = std::chrono::duration<double>(delta_time).count();
   auto* transform_system = registry_->Get<TransformSystem>();
   for (const Scripts& scripts : every_frame_scripts_) {
@@ -17,7 +17,11 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_SCRIPT_SCRIPT_SYSTEM_H_
 #define LULLABY_SYSTEMS_SCRIPT_SCRIPT_SYSTEM_H_
 
+#include <unordered_map>
+#include <vector>
+
 #include "lullaby/generated/script_def_generated.h"
+#include "lullaby/modules/dispatcher/event_wrapper.h"
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/modules/script/script_engine.h"
@@ -39,6 +43,11 @@ class ScriptSystem : public System {
 
   void Destroy(Entity e) override;
 
+  size_t GetNumComponents() const override;
+  size_t GetComponentMemoryUsage() const override;
+
+  // Delivers the events collected for batched ScriptOnEventDefs, and then runs
+  // the every frame scripts.
   void AdvanceFrame(Clock::duration delta_time);
 
  private:
@@ -47,9 +56,30 @@ class ScriptSystem : public System {
     std::vector<ScriptId> ids;
   };
 
+  // The keys of the EventBatches that an entity is part of.
+  struct BatchedScripts : Component {
+    BatchedScripts(Entity e, HashValue key) : Component(e), keys{key} {}
+    std::vector<HashValue> keys;
+  };
+
+  // A script shared by all the entities with a batched ScriptOnEventDef using
+  // it, and the events that they have received since it was last run.
+  struct EventBatch {
+    ScriptId id;
+    size_t num_entities = 0;
+    std::vector<Entity> entities;
+    std::vector<EventWrapper> events;
+  };
+
   static void AddScript(ComponentPool<Scripts>* pool, Entity entity,
                         ScriptId id);
 
+  void AddBatchedEventScript(Entity entity, const ScriptOnEventDef* data);
+
+  void RemoveFromEventBatch(Entity entity, HashValue key);
+
+  void DeliverEventBatches();
+
   ScriptId LoadScriptDef(const ScriptDef* data, Entity entity);
 
   ScriptId LoadScriptDef(const ScriptDef* data);
@@ -58,6 +88,8 @@ class ScriptSystem : public System {
   ComponentPool<Scripts> every_frame_scripts_;
   ComponentPool<Scripts> on_destroy_scripts_;
   ComponentPool<Scripts> event_scripts_;
+  ComponentPool<BatchedScripts> batched_event_scripts_;
+  std::unordered_map<HashValue, EventBatch> event_batches_;
 };
 
 }  // namespace lull
@@ -16,12 +16,30 @@ limitations under the License.
 
 #include "lullaby/systems/shape/shape_system.h"
 
+#include <cstring>
+
 #include "lullaby/modules/render/mesh_util.h"
+#include "lullaby/systems/render/mesh_factory.h"
 #include "lullaby/systems/render/render_system.h"
+#include "lullaby/util/hash.h"
 
 namespace lull {
+namespace {
+
+// Folds the bit pattern of a 32-bit field into |hash|.  The string Hash()
+// functions stop at the first zero byte, so they cannot be used here.
+template <typename T>
+HashValue HashCombineValue(HashValue hash, const T& value) {
+  static_assert(sizeof(T) == sizeof(HashValue), "Expected a 32-bit field.");
+  HashValue bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return HashCombine(hash, bits);
+}
+
+}  // namespace
 
-ShapeSystem::ShapeSystem(Registry* registry) : System(registry) {
+ShapeSystem::ShapeSystem(Registry* registry)
+    : System(registry), meshes_(ResourceManager<Mesh>::kWeakCachingOnly) {
   RegisterDef<SphereDefT>(this);
   RegisterDef<RectMeshDefT>(this);
   RegisterDependency<RenderSystem>(this);
@@ -43,25 +61,54 @@ void ShapeSystem::PostCreateComponent(Entity entity,
 }
 
 void ShapeSystem::CreateRect(Entity entity, const RectMeshDefT& rect) {
-  MeshData mesh = CreateQuadMesh<VertexPT>(
-      rect.size_x, rect.size_y, rect.verts_x, rect.verts_y, rect.corner_radius,
-      rect.corner_verts);
-  CreateShape(entity, rect.pass, std::move(mesh));
+  HashValue key = ConstHash("RectMesh");
+  key = HashCombineValue(key, rect.size_x);
+  key = HashCombineValue(key, rect.size_y);
+  key = HashCombineValue(key, rect.verts_x);
+  key = HashCombineValue(key, rect.verts_y);
+  key = HashCombineValue(key, rect.corner_radius);
+  key = HashCombineValue(key, rect.corner_verts);
+  CreateShape(entity, rect.pass, key, [&rect]() {
+    return CreateQuadMesh<VertexPT>(rect.size_x, rect.size_y, rect.verts_x,
+                                    rect.verts_y, rect.corner_radius,
+                                    rect.corner_verts);
+  });
 }
 
 void ShapeSystem::CreateSphere(Entity entity, const SphereDefT& sphere) {
-  MeshData mesh = CreateLatLonSphere(sphere.radius, sphere.num_parallels,
-                                     sphere.num_meridians);
-  CreateShape(entity, sphere.pass, std::move(mesh));
+  HashValue key = ConstHash("LatLonSphere");
+  key = HashCombineValue(key, sphere.radius);
+  key = HashCombineValue(key, sphere.num_parallels);
+  key = HashCombineValue(key, sphere.num_meridians);
+  CreateShape(entity, sphere.pass, key, [&sphere]() {
+    return CreateLatLonSphere(sphere.radius, sphere.num_parallels,
+                              sphere.num_meridians);
+  });
 }
 
-void ShapeSystem::CreateShape(Entity entity, HashValue pass,
-                              MeshData mesh_data) {
+void ShapeSystem::CreateShape(Entity entity, HashValue pass, HashValue key,
+                              const GenerateMeshFn& generate) {
   auto* render_system = registry_->Get<RenderSystem>();
   if (pass == 0) {
     pass = render_system->GetDefaultRenderPass();
   }
-  render_system->SetMesh({entity, pass}, mesh_data);
+
+  auto* mesh_factory = registry_->Get<MeshFactory>();
+  if (mesh_factory == nullptr) {
+    // Without a MeshFactory the mesh cannot be shared, so just generate it.
+    MeshData mesh_data = generate();
+    OptimizeMesh(&mesh_data);
+    render_system->SetMesh({entity, pass}, mesh_data);
+    return;
+  }
+
+  const MeshPtr mesh = meshes_.Create(key, [&]() {
+    MeshData mesh_data = generate();
+    // Shapes are generated in row order, so reorder them for the vertex cache.
+    OptimizeMesh(&mesh_data);
+    return mesh_factory->CreateMesh(std::move(mesh_data));
+  });
+  render_system->SetMesh({entity, pass}, mesh);
 }
 
 }  // namespace lull
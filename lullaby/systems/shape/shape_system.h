@@ -19,11 +19,15 @@ limitations under the License.
 
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/modules/render/mesh_data.h"
+#include "lullaby/systems/render/mesh.h"
+#include "lullaby/util/resource_manager.h"
 #include "lullaby/generated/shape_def_generated.h"
 
 namespace lull {
 
-// The ShapeSystem generates common mesh shapes for entities.
+// The ShapeSystem generates common mesh shapes for entities.  Generated meshes
+// are cached by their shape parameters, so entities with identical shapes share
+// a single mesh for as long as any of them is using it.
 class ShapeSystem : public System {
  public:
   explicit ShapeSystem(Registry* registry);
@@ -37,7 +41,14 @@ class ShapeSystem : public System {
   void CreateSphere(Entity entity, const SphereDefT& sphere);
 
  private:
-  void CreateShape(Entity entity, HashValue pass, MeshData mesh_data);
+  using GenerateMeshFn = std::function<MeshData()>;
+
+  // Sets the mesh with the given |key| on |entity|, calling |generate| to
+  // create it only if no other entity is already using it.
+  void CreateShape(Entity entity, HashValue pass, HashValue key,
+                   const GenerateMeshFn& generate);
+
+  ResourceManager<Mesh> meshes_;
 };
 
 }  // namespace lull
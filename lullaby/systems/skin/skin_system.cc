@@ -16,12 +16,22 @@ limitations under the License.
 
 #include "lullaby/systems/skin/skin_system.h"
 
+#include <algorithm>
+
+#include "lullaby/modules/ecs/system_profiler.h"
 #include "lullaby/modules/script/function_binder.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/job_processor.h"
 #include "lullaby/util/math.h"
 
 namespace lull {
+namespace {
+
+// The fewest skins worth computing in a separate job.
+constexpr size_t kMinSkinsPerJob = 8;
+
+}  // namespace
 
 SkinSystem::SkinSystem(Registry* registry, bool use_ubo)
     : System(registry), use_ubo_(use_ubo) {
@@ -42,8 +52,49 @@ SkinSystem::~SkinSystem() {
 }
 
 void SkinSystem::AdvanceFrame() {
+  SystemProfiler::ScopedSample sample(registry_, this);
+  skins_to_update_.clear();
   for (auto iter = skins_.begin(); iter != skins_.end(); ++iter) {
-    UpdateShaderTransforms(iter->first, &iter->second);
+    skins_to_update_.emplace_back(iter->first, &iter->second);
+  }
+
+  const size_t num_skins = skins_to_update_.size();
+  auto compute = [this](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      ComputeShaderPose(skins_to_update_[i].first, skins_to_update_[i].second);
+    }
+  };
+
+#if !LULLABY_USE_JAVASCRIPT_TIMERS
+  JobProcessor* job_processor = registry_->Get<JobProcessor>();
+  const size_t num_jobs = num_skins / kMinSkinsPerJob;
+  if (job_processor && num_jobs > 1) {
+    // Each job computes the poses of its own range of skins.  Dispatch all but
+    // the first range to the worker threads, and compute the first range on
+    // this thread while waiting.
+    const size_t skins_per_job = (num_skins + num_jobs - 1) / num_jobs;
+    std::vector<JobProcessor::JobHandle> jobs;
+    jobs.reserve(num_jobs - 1);
+    for (size_t begin = skins_per_job; begin < num_skins;
+         begin += skins_per_job) {
+      const size_t end = std::min(begin + skins_per_job, num_skins);
+      jobs.emplace_back(job_processor->Run(
+          [&compute, begin, end]() { compute(begin, end); }));
+    }
+    compute(0, skins_per_job);
+    for (const auto& job : jobs) {
+      job_processor->Wait(job);
+    }
+  } else {
+    compute(0, num_skins);
+  }
+#else
+  compute(0, num_skins);
+#endif
+
+  // The RenderSystem is not thread-safe, so the uploads happen here.
+  for (const auto& skin : skins_to_update_) {
+    UploadShaderPose(skin.first, *skin.second);
   }
 }
 
@@ -98,7 +149,12 @@ SkinSystem::Pose SkinSystem::GetInverseBindPose(Entity entity) const {
 }
 
 void SkinSystem::UpdateShaderTransforms(Entity entity, SkinComponent* skin) {
-  auto* transform_system = registry_->Get<TransformSystem>();
+  ComputeShaderPose(entity, skin);
+  UploadShaderPose(entity, *skin);
+}
+
+void SkinSystem::ComputeShaderPose(Entity entity, SkinComponent* skin) const {
+  const auto* transform_system = registry_->Get<TransformSystem>();
 
   const mathfu::mat4 skin_from_world =
       transform_system->GetWorldFromEntityMatrix(entity)->Inverse();
@@ -143,12 +199,15 @@ void SkinSystem::UpdateShaderTransforms(Entity entity, SkinComponent* skin) {
         *world_from_bone *
         mathfu::mat4::FromAffineTransform(skin->inverse_bind_pose[i]));
   }
+}
 
+void SkinSystem::UploadShaderPose(Entity entity, const SkinComponent& skin) {
   constexpr int kDimension = 4;
   constexpr int kNumVec4sInAffineTransform = 3;
   constexpr const char* kUniform = "bone_transforms";
-  const float* data = &skin->shader_pose[0][0];
-  const int count = kNumVec4sInAffineTransform * static_cast<int>(num_bones);
+  const float* data = &skin.shader_pose[0][0];
+  const int count =
+      kNumVec4sInAffineTransform * static_cast<int>(skin.shader_pose.size());
   auto* render_system = registry_->Get<RenderSystem>();
   if (UseUbo()) {
     render_system->SetUniform(entity, kUniform,
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "lullaby/modules/ecs/component.h"
@@ -50,7 +51,9 @@ class SkinSystem : public System {
   /// Removes the skinning information for an Entity.
   void Destroy(Entity entity) override;
 
-  /// Update the skinning uniforms for all skinned Entities.
+  /// Update the skinning uniforms for all skinned Entities.  If the Registry
+  /// has a JobProcessor, the bone transforms of many skins are computed in
+  /// parallel before being uploaded to the RenderSystem.
   void AdvanceFrame();
 
   /// Sets the skin defining |entity| to the list of Entities representing the
@@ -84,7 +87,15 @@ class SkinSystem : public System {
 
   void UpdateShaderTransforms(Entity entity, SkinComponent* skin);
 
+  // Computes the shader pose of the |skin|.  This only reads from the
+  // TransformSystem, so it may be called for several skins at once.
+  void ComputeShaderPose(Entity entity, SkinComponent* skin) const;
+
+  // Passes the shader pose of the |skin| to the RenderSystem.
+  void UploadShaderPose(Entity entity, const SkinComponent& skin);
+
   std::unordered_map<Entity, SkinComponent> skins_;
+  std::vector<std::pair<Entity, SkinComponent*>> skins_to_update_;
   const bool use_ubo_;
 };
 
@@ -184,6 +184,7 @@ void StategraphAsset::OnFinalize(const std::string& filename,
   for (const AnimationStateDef* state_def : *stategraph_def->states()) {
     stategraph_->AddState(CreateState(state_def));
   }
+  stategraph_->Compile();
 }
 
 StategraphTransition StategraphAsset::CreateTransition(
@@ -348,6 +349,12 @@ Stategraph::Path StategraphAsset::FindPath(HashValue from_state,
                      : Stategraph::Path();
 }
 
+const StategraphTransition* StategraphAsset::GetNextTransition(
+    HashValue from_state, HashValue to_state) const {
+  return stategraph_ ? stategraph_->GetNextTransition(from_state, to_state)
+                     : nullptr;
+}
+
 const StategraphTrack* StategraphAsset::SelectTrack(
     HashValue state, const VariantMap& args) const {
   if (stategraph_ == nullptr) {
@@ -42,6 +42,11 @@ class StategraphAsset : public Asset {
   /// Returns the path in the stategraph between the two states.
   Stategraph::Path FindPath(HashValue from_state, HashValue to_state) const;
 
+  /// Returns the first transition on the path in the stategraph between the
+  /// two states, or nullptr if there is no path.
+  const StategraphTransition* GetNextTransition(HashValue from_state,
+                                                HashValue to_state) const;
+
   /// Returns the default (0-th) transition out of the given state.
   const StategraphTransition* GetDefaultTransition(HashValue state) const;
 
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "lullaby/systems/stategraph/stategraph_system.h"
 
+#include "lullaby/modules/ecs/system_profiler.h"
 #include "lullaby/modules/file/asset_loader.h"
 #include "lullaby/modules/lullscript/lull_script_engine.h"
 #include "lullaby/modules/script/function_binder.h"
@@ -82,7 +83,16 @@ void StategraphSystem::Create(Entity entity, HashValue type, const Def* def) {
 
 void StategraphSystem::Destroy(Entity entity) { components_.Destroy(entity); }
 
+size_t StategraphSystem::GetNumComponents() const {
+  return components_.Size();
+}
+
+size_t StategraphSystem::GetComponentMemoryUsage() const {
+  return components_.GetMemoryUsage();
+}
+
 void StategraphSystem::AdvanceFrame(Clock::duration delta_time) {
+  SystemProfiler::ScopedSample sample(registry_, this);
   components_.ForEach([this, delta_time](StategraphComponent& component) {
     AdvanceFrame(&component, delta_time);
   });
@@ -105,7 +115,7 @@ void StategraphSystem::SetDesiredState(Entity entity, HashValue state) {
 void StategraphSystem::SnapToState(Entity entity, HashValue state) {
   StategraphComponent* component = components_.Get(entity);
   if (component) {
-    component->path.clear();
+    component->target_state = 0;
     EnterState(component, state, 0, Clock::duration(0), Clock::duration(0));
   }
 }
@@ -114,7 +124,7 @@ void StategraphSystem::SnapToStateAtSignal(Entity entity, HashValue state,
                                            HashValue signal) {
   StategraphComponent* component = components_.Get(entity);
   if (component) {
-    component->path.clear();
+    component->target_state = 0;
     EnterState(component, state, signal, Clock::duration(0),
                Clock::duration(0));
   }
@@ -124,7 +134,7 @@ void StategraphSystem::SnapToStateAtTime(Entity entity, HashValue state,
                                          Clock::duration timestamp) {
   StategraphComponent* component = components_.Get(entity);
   if (component) {
-    component->path.clear();
+    component->target_state = 0;
     EnterState(component, state, 0, timestamp, Clock::duration(0));
   }
 }
@@ -192,12 +202,13 @@ void StategraphSystem::UpdatePathToTargetState(StategraphComponent* component,
     return;
   }
 
-  component->path.clear();
+  component->target_state = 0;
   if (component->current_state != state) {
-    component->path =
-        component->stategraph->FindPath(component->current_state, state);
-    if (component->path.empty()) {
+    if (component->stategraph->GetNextTransition(component->current_state,
+                                                 state) == nullptr) {
       LOG(DFATAL) << "No path to target state: " << state;
+    } else {
+      component->target_state = state;
     }
   }
 }
@@ -227,11 +238,11 @@ void StategraphSystem::AdvanceFrame(StategraphComponent* component,
       component->stategraph->IsTransitionValid(*transition, component->track,
                                                component->time);
   if (valid_transition) {
-    if (!component->path.empty()) {
-      component->path.pop_front();
-    }
     EnterState(component, transition->to_state, *valid_transition,
                Clock::duration(0), transition->transition_time);
+    if (component->current_state == component->target_state) {
+      component->target_state = 0;
+    }
   }
 
   // Advance the track playback by the given time, adjusting for any track
@@ -247,19 +258,20 @@ void StategraphSystem::AdvanceFrame(StategraphComponent* component,
 const StategraphTransition* StategraphSystem::GetNextTransition(
     const StategraphComponent* component) const {
   CHECK_NOTNULL(component);
-  if (component->path.empty()) {
+  if (component->target_state == 0) {
     return component->stategraph->GetDefaultTransition(
         component->current_state);
   } else {
-    return &component->path.front();
+    return component->stategraph->GetNextTransition(component->current_state,
+                                                    component->target_state);
   }
 }
 
 HashValue StategraphSystem::GetTargetState(
     const StategraphComponent* component) const {
   CHECK_NOTNULL(component);
-  return component->path.empty() ? component->current_state
-                                 : component->path.back().to_state;
+  return component->target_state ? component->target_state
+                                 : component->current_state;
 }
 
 std::shared_ptr<StategraphAsset> StategraphSystem::LoadStategraph(
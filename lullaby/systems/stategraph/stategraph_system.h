@@ -51,6 +51,9 @@ class StategraphSystem : public System {
   /// Disassociates entity from all stategraphs.
   void Destroy(Entity entity) override;
 
+  size_t GetNumComponents() const override;
+  size_t GetComponentMemoryUsage() const override;
+
   /// Updates the progress of all associated Entities through their individual
   /// stategraphs.
   void AdvanceFrame(Clock::duration delta_time);
@@ -102,9 +105,10 @@ class StategraphSystem : public System {
     /// The current time within the track playback.
     Clock::duration time = Clock::duration(0);
 
-    /// The current path within the stategraph that gets us to the desired
-    /// state.
-    Stategraph::Path path;
+    /// The desired state, or 0 if the component should just follow the default
+    /// transitions.  The path to it is looked up in the compiled stategraph
+    /// one transition at a time.
+    HashValue target_state = 0;
 
     /// The arguments that will be used to select the next track.
     VariantMap selection_args;
@@ -127,8 +131,8 @@ class StategraphSystem : public System {
   const StategraphTransition* GetNextTransition(
       const StategraphComponent* component) const;
 
-  // Returns the state at the end of the path or the current state if there is
-  // no path.
+  // Returns the desired state or the current state if there is no desired
+  // state.
   HashValue GetTargetState(const StategraphComponent* component) const;
 
   /// Returns the StategraphAsset for the given filename.
@@ -199,6 +199,15 @@ void FlatuiTextSystem::SetGlyphCacheSize(const mathfu::vec2i& size,
   max_glyph_cache_slices_ = max_slices;
 }
 
+void FlatuiTextSystem::SetNumWorkerThreads(size_t num_threads) {
+  if (num_threads == 0) {
+    LOG(DFATAL) << "Text generation requires at least one worker thread.";
+    return;
+  }
+  task_queue_.Stop();
+  task_queue_.Start(num_threads);
+}
+
 void FlatuiTextSystem::Initialize() {
   std::unique_ptr<flatui::FontManager> font_manager(
       new flatui::FontManager(glyph_cache_size_, max_glyph_cache_slices_));
@@ -287,6 +296,7 @@ void FlatuiTextSystem::Create(Entity entity, DefType type, const Def* def) {
   // for apps that don't need it and helps keeps tests running.
   if (component->text_buffer_params.wrap_mode == TextWrapMode_Hyphenate &&
       !hyphenation_initialized_) {
+    std::lock_guard<std::mutex> lock(font_manager_mutex_);
     font_manager_->SetupHyphenationPatternPath(kHyphenationPatternPath);
     hyphenation_initialized_ = true;
   }
@@ -410,11 +420,6 @@ void FlatuiTextSystem::Destroy(Entity entity) {
 void FlatuiTextSystem::ProcessTasks() {
   LULLABY_CPU_TRACE("FlatuiTasks");
 
-  for (const auto& entry : update_map_) {
-    GenerateText(entry.first, entry.second);
-  }
-  update_map_.clear();
-
   TextTaskPtr task = nullptr;
   // Dequeue all completed tasks, but only apply the newest for each entity.
   while (DequeueTask(&task)) {
@@ -427,6 +432,16 @@ void FlatuiTextSystem::ProcessTasks() {
     }
   }
 
+  // Start the pending updates now that finished tasks have been dequeued.
+  // Entities whose task is still running keep their entry for the next frame.
+  for (auto iter = update_map_.begin(); iter != update_map_.end();) {
+    if (GenerateText(iter->first, iter->second)) {
+      iter = update_map_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
   if (font_manager_->StartRenderPass()) {
     // Once we have successfully started the font render pass we can assume that
     // the font texture atlases have been successfully updated and it is now
@@ -446,9 +461,7 @@ void FlatuiTextSystem::WaitForAllTasks() {
 }
 
 void FlatuiTextSystem::EnqueueTask(TextComponent* component, TextTaskPtr task) {
-  if (component->task_id != TextTaskQueue::kInvalidTaskId) {
-    task_queue_.Cancel(component->task_id);
-  }
+  DCHECK(component->task_id == TextTaskQueue::kInvalidTaskId);
   component->task = task;
   component->task_id = task_queue_.Enqueue(
       std::move(task), [](TextTaskPtr* task) { (*task)->Process(); });
@@ -513,20 +526,31 @@ void FlatuiTextSystem::SetText(Entity entity, const std::string& text) {
   update_map_[entity] = kNullEntity;
 }
 
-void FlatuiTextSystem::GenerateText(Entity entity, Entity desired_size_source) {
+bool FlatuiTextSystem::GenerateText(Entity entity, Entity desired_size_source) {
   TextComponent* component = components_.Get(entity);
   if (!component) {
-    return;
+    return true;
+  }
+
+  // Only keep a single task per entity.  A queued task is replaced, but one
+  // that has already started must finish before the next one is queued.
+  if (component->task_id != TextTaskQueue::kInvalidTaskId) {
+    if (!task_queue_.Cancel(component->task_id)) {
+      return false;
+    }
+    component->task.reset();
+    component->task_id = TextTaskQueue::kInvalidTaskId;
+    --num_pending_tasks_;
   }
 
   if (component->text.empty()) {
     SetTextBuffer(component, nullptr);
-    return;
+    return true;
   }
 
   auto* preprocessor = registry_->Get<StringPreprocessor>();
   component->rendered_text =
-      preprocessor ? preprocessor->ProcessString(component->text)
+      preprocessor ? preprocessor->ProcessStringCached(component->text)
                    : component->text;
 
   component->loading_buffer = true;
@@ -545,10 +569,13 @@ void FlatuiTextSystem::GenerateText(Entity entity, Entity desired_size_source) {
       params.bounds.y = *y;
     }
   }
-  EnqueueTask(component, TextTaskPtr(new TextTask(entity, desired_size_source,
-                                                  component->font,
-                                                  component->rendered_text,
-                                                  params)));
+  EnqueueTask(component,
+              TextTaskPtr(new TextTask(
+                  entity, desired_size_source, component->font,
+                  component->rendered_text, params, &font_manager_mutex_,
+                  std::move(component->spare_vertices))));
+  component->spare_vertices.clear();
+  return true;
 }
 
 void FlatuiTextSystem::ReprocessAllText() {
@@ -643,7 +670,18 @@ const std::vector<LinkTag>* FlatuiTextSystem::GetLinkTags(Entity entity) const {
 void FlatuiTextSystem::SetTextBuffer(TextComponent* component,
                                      TextBufferPtr text_buffer,
                                      Entity desired_size_source) {
-  DestroyRenderEntities(component);
+  // Keep the existing render entities if the new buffer has the same slices
+  // (e.g. while typing into a text field), and only replace their meshes.
+  const bool reuse_entities = CanReuseRenderEntities(*component, text_buffer);
+  if (!reuse_entities) {
+    DestroyRenderEntities(component);
+  }
+
+  // The render entities hold their own copies of the meshes, so the storage of
+  // an unshared buffer can be reused by the next relayout.
+  if (component->buffer && component->buffer.use_count() == 1) {
+    component->spare_vertices = component->buffer->ReleaseVertices();
+  }
 
   component->loading_buffer = false;
   component->buffer = std::move(text_buffer);
@@ -664,13 +702,18 @@ void FlatuiTextSystem::SetTextBuffer(TextComponent* component,
       }
     }
 
-    CreateTextEntities(component);
-    CreateLinkUnderlineEntity(component);
-
-    // If our entity is already hidden, hide its newly-created render entities.
-    const auto* render_system = registry_->Get<RenderSystem>();
-    if (render_system->IsHidden(entity)) {
-      HideRenderEntities(*component);
+    if (reuse_entities) {
+      UpdateTextEntities(component);
+    } else {
+      CreateTextEntities(component);
+      CreateLinkUnderlineEntity(component);
+
+      // If our entity is already hidden, hide its newly-created render
+      // entities.
+      const auto* render_system = registry_->Get<RenderSystem>();
+      if (render_system->IsHidden(entity)) {
+        HideRenderEntities(*component);
+      }
     }
   } else {
     transform_system->SetAabb(entity, Aabb());
@@ -730,17 +773,35 @@ Entity FlatuiTextSystem::CreateEntity(TextComponent* component,
   return entity;
 }
 
-void FlatuiTextSystem::CreateTextEntities(TextComponent* component) {
-  const size_t num_slices = component->buffer->GetNumSlices();
-
+mathfu::vec4 FlatuiTextSystem::GetSdfParams(
+    const TextComponent& component) const {
   const int32_t text_size_mm = static_cast<int>(
-      component->text_buffer_params.font_size / kMetersFromMillimeters);
+      component.text_buffer_params.font_size / kMetersFromMillimeters);
   const float softness_scale =
       static_cast<float>(GetGlyphSizeForTextSize(text_size_mm)) *
-      kMetersFromMillimeters / component->text_buffer_params.font_size;
-  const mathfu::vec4 sdf_params = CalcSdfParams(
-      component->edge_softness * softness_scale, kSdfDistOffset, kSdfDistScale);
+      kMetersFromMillimeters / component.text_buffer_params.font_size;
+  return CalcSdfParams(component.edge_softness * softness_scale,
+                       kSdfDistOffset, kSdfDistScale);
+}
+
+void FlatuiTextSystem::SetSliceRenderData(const TextComponent& component,
+                                          Entity entity, size_t slice,
+                                          const mathfu::vec4& sdf_params) {
   auto* render_system = registry_->Get<RenderSystem>();
+  const fplbase::Texture* texture = component.buffer->GetSliceTexture(slice);
+  render_system->SetAndDeformMesh(entity,
+                                  component.buffer->BuildSliceMesh(slice));
+  render_system->SetTextureId(entity, 0, GL_TEXTURE_2D,
+                              fplbase::GlTextureHandle(texture->id()));
+  const mathfu::vec2 texture_size = mathfu::vec2(texture->size());
+  render_system->SetUniform(entity, kTextureSizeUniform, &texture_size[0], 2,
+                            1);
+  render_system->SetUniform(entity, kSdfParamsUniform, &sdf_params[0], 4, 1);
+}
+
+void FlatuiTextSystem::CreateTextEntities(TextComponent* component) {
+  const size_t num_slices = component->buffer->GetNumSlices();
+  const mathfu::vec4 sdf_params = GetSdfParams(*component);
   for (size_t i = 0; i < num_slices; ++i) {
     Entity entity;
     if (component->buffer->IsLinkSlice(i)) {
@@ -755,15 +816,55 @@ void FlatuiTextSystem::CreateTextEntities(TextComponent* component) {
       component->plain_entities.emplace_back(entity);
     }
 
-    const fplbase::Texture* texture = component->buffer->GetSliceTexture(i);
-    render_system->SetAndDeformMesh(entity,
-                                    component->buffer->BuildSliceMesh(i));
-    render_system->SetTextureId(entity, 0, GL_TEXTURE_2D,
-                                fplbase::GlTextureHandle(texture->id()));
-    const mathfu::vec2 texture_size = mathfu::vec2(texture->size());
-    render_system->SetUniform(entity, kTextureSizeUniform, &texture_size[0], 2,
-                              1);
-    render_system->SetUniform(entity, kSdfParamsUniform, &sdf_params[0], 4, 1);
+    SetSliceRenderData(*component, entity, i, sdf_params);
+  }
+}
+
+bool FlatuiTextSystem::CanReuseRenderEntities(
+    const TextComponent& component, const TextBufferPtr& text_buffer) const {
+  if (!component.buffer || !text_buffer) {
+    return false;
+  }
+
+  // Every slice needs an entity of the same kind (plain or link).
+  size_t num_plain = 0;
+  size_t num_links = 0;
+  const size_t num_slices = text_buffer->GetNumSlices();
+  for (size_t i = 0; i < num_slices; ++i) {
+    if (text_buffer->IsLinkSlice(i)) {
+      ++num_links;
+    } else {
+      ++num_plain;
+    }
+  }
+  if (num_plain != component.plain_entities.size() ||
+      num_links != component.link_entities.size()) {
+    return false;
+  }
+
+  const bool needs_underline =
+      component.text_buffer_params.html_mode == TextHtmlMode_ExtractLinks &&
+      !text_buffer->GetUnderlineVertices().empty() &&
+      !component.link_underline_blueprint.empty();
+  return needs_underline == (component.underline_entity != kNullEntity);
+}
+
+void FlatuiTextSystem::UpdateTextEntities(TextComponent* component) {
+  const size_t num_slices = component->buffer->GetNumSlices();
+  const mathfu::vec4 sdf_params = GetSdfParams(*component);
+  size_t plain_index = 0;
+  size_t link_index = 0;
+  for (size_t i = 0; i < num_slices; ++i) {
+    const Entity entity = component->buffer->IsLinkSlice(i)
+                              ? component->link_entities[link_index++]
+                              : component->plain_entities[plain_index++];
+    SetSliceRenderData(*component, entity, i, sdf_params);
+  }
+
+  if (component->underline_entity != kNullEntity) {
+    auto* render_system = registry_->Get<RenderSystem>();
+    render_system->SetAndDeformMesh(component->underline_entity,
+                                    component->buffer->BuildUnderlineMesh());
   }
 }
 
@@ -18,6 +18,7 @@ limitations under the License.
 #define LULLABY_SYSTEMS_TEXT_FLATUI_FLATUI_TEXT_SYSTEM_H_
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
@@ -49,6 +50,12 @@ class FlatuiTextSystem : public TextSystemImpl {
   // via EntityFactory::Initialize.
   void SetGlyphCacheSize(const mathfu::vec2i& size, int max_slices);
 
+  // Sets the number of worker threads used to generate text buffers.  Calls
+  // into flatui's FontManager are serialized, so additional threads only
+  // overlap the remaining per-buffer processing.  Blocks until the tasks that
+  // are currently running have completed.
+  void SetNumWorkerThreads(size_t num_threads);
+
   void Initialize() override;
   void Create(Entity entity, DefType type, const Def* def) override;
   void CreateEmpty(Entity entity) override;
@@ -93,7 +100,10 @@ class FlatuiTextSystem : public TextSystemImpl {
   void ReprocessAllText() override;
 
  private:
-  void GenerateText(Entity entity, Entity desired_size_source = kNullEntity);
+  // Starts generating the text buffer for |entity|.  Returns false if the
+  // entity's previous task has already started, in which case the update must
+  // be retried once that task has completed.
+  bool GenerateText(Entity entity, Entity desired_size_source = kNullEntity);
 
   // Sets and activates |task.text_buffer_| on |component|.
   void SetTextBuffer(TextComponent* component, TextBufferPtr text_buffer,
@@ -109,7 +119,15 @@ class FlatuiTextSystem : public TextSystemImpl {
   bool DequeueTask(TextTaskPtr* task);
 
   Entity CreateEntity(TextComponent* component, const std::string& blueprint);
+  mathfu::vec4 GetSdfParams(const TextComponent& component) const;
+  void SetSliceRenderData(const TextComponent& component, Entity entity,
+                          size_t slice, const mathfu::vec4& sdf_params);
   void CreateTextEntities(TextComponent* component);
+  // Returns true if the render entities of |component| match the slices of
+  // |text_buffer|, so that they can be updated in place.
+  bool CanReuseRenderEntities(const TextComponent& component,
+                              const TextBufferPtr& text_buffer) const;
+  void UpdateTextEntities(TextComponent* component);
   void CreateLinkUnderlineEntity(TextComponent* component);
   void DestroyRenderEntities(TextComponent* component);
   void UpdateComponentUniform(Entity entity, HashValue pass, int submesh_index,
@@ -147,6 +165,9 @@ class FlatuiTextSystem : public TextSystemImpl {
   // List of text buffer generation tasks.
   TextTaskQueue task_queue_;
 
+  // Guards the state of font_manager_ across the tasks in task_queue_.
+  std::mutex font_manager_mutex_;
+
   // Number of pending tasks.
   int num_pending_tasks_ = 0;
 
@@ -162,7 +183,9 @@ class FlatuiTextSystem : public TextSystemImpl {
   TextDirection text_direction_ = TextDirection_LeftToRight;
 
   // Set of entities which need to have their rendering data refreshed. The
-  // value of the map is the entity's desired_size_source.
+  // value of the map is the entity's desired_size_source.  Entities stay in
+  // the map while their previous task is still running, so that any number of
+  // changes are coalesced into a single task.
   std::unordered_map<Entity, Entity> update_map_;
 };
 
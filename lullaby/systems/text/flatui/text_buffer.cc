@@ -83,14 +83,19 @@ Aabb GetBoundingBox(const mathfu::vec4& rect) {
 
 TextBuffer::TextBuffer(flatui::FontManager* manager,
                        flatui::FontBuffer* font_buffer,
-                       const TextBufferParams& params)
-    : font_manager_(manager), font_buffer_(font_buffer), params_(params) {
+                       const TextBufferParams& params,
+                       std::vector<VertexPT> vertex_storage)
+    : font_manager_(manager),
+      font_buffer_(font_buffer),
+      vertices_(std::move(vertex_storage)),
+      params_(params) {
   font_manager_->StartLayoutPass();
 
   // TODO: Don't make copy once flatui support creating font
   // buffer without cache.
-  const std::vector<flatui::FontVertex> glyph_vertices =
+  const std::vector<flatui::FontVertex>& glyph_vertices =
       font_buffer_->get_vertices();
+  vertices_.clear();
   vertices_.reserve(glyph_vertices.size());
   for (const auto& v : glyph_vertices) {
     vertices_.emplace_back(mathfu::vec3(v.position_), mathfu::vec2(v.uv_));
@@ -134,6 +139,23 @@ TextBuffer::TextBuffer(flatui::FontManager* manager,
         underline_vertices_.emplace_back(mathfu::vec3(position),
                                          mathfu::vec2(0.5f, 0.5f));
       }
+
+      // Underline vertices are arranged in triangle strips.  Convert them into
+      // a triangle list.
+      if (underline_vertices_.size() >= 3) {
+        underline_indices_.reserve(3 * (underline_vertices_.size() - 2));
+      }
+      for (size_t i = 2; i < underline_vertices_.size(); ++i) {
+        const uint16_t index = static_cast<uint16_t>(i);
+        std::array<uint16_t, 3> triangle = {static_cast<uint16_t>(index - 2),
+                                            static_cast<uint16_t>(index - 1),
+                                            index};
+        if (i % 2) {
+          std::swap(triangle[1], triangle[2]);
+        }
+        underline_indices_.insert(underline_indices_.end(), triangle.begin(),
+                                  triangle.end());
+      }
     }
   }
 
@@ -319,21 +341,13 @@ MeshData TextBuffer::BuildSliceMesh(size_t slice) const {
       static_cast<const flatui::FontBuffer*>(font_buffer_)
           ->get_indices(static_cast<int>(slice));
 
-  const size_t vertex_data_size = vertices_.size() * sizeof(vertices_[0]);
-  DataContainer vertex_data =
-      DataContainer::CreateHeapDataContainer(vertex_data_size);
-
-  const size_t index_data_size = indices.size() * sizeof(indices[0]);
-  DataContainer index_data =
-      DataContainer::CreateHeapDataContainer(index_data_size);
-
-  MeshData mesh(MeshData::kTriangles, VertexPT::kFormat, std::move(vertex_data),
-                MeshData::kIndexU16, std::move(index_data));
-
-  mesh.AddVertices(vertices_.data(), vertices_.size());
-  mesh.AddIndices(indices.data(), indices.size());
-
-  return mesh;
+  return MeshData(
+      MeshData::kTriangles, VertexPT::kFormat,
+      DataContainer::WrapDataAsReadOnly(
+          vertices_.data(), vertices_.size() * sizeof(vertices_[0])),
+      MeshData::kIndexU16,
+      DataContainer::WrapDataAsReadOnly(indices.data(),
+                                        indices.size() * sizeof(indices[0])));
 }
 
 MeshData TextBuffer::BuildUnderlineMesh() const {
@@ -341,48 +355,21 @@ MeshData TextBuffer::BuildUnderlineMesh() const {
     return MeshData();
   }
 
-  const size_t vertex_data_size =
-      underline_vertices_.size() * sizeof(underline_vertices_[0]);
-  DataContainer vertex_data =
-      DataContainer::CreateHeapDataContainer(vertex_data_size);
-
-  // Underline vertices are arranged in triangle strips.  Convert them into
-  // a triangle list.
-  size_t index_data_size;
-  if (params_.underline_padding) {
-    index_data_size = underline_indices_.size() * sizeof(uint16_t);
-  } else {
-    const size_t num_triangles = underline_vertices_.size() - 2;
-    index_data_size = 3 * num_triangles * sizeof(uint16_t);
-  }
-  DataContainer index_data =
-      DataContainer::CreateHeapDataContainer(index_data_size);
-
-  MeshData mesh(MeshData::kTriangles, VertexPT::kFormat, std::move(vertex_data),
-                MeshData::kIndexU16, std::move(index_data));
-  mesh.AddVertices(underline_vertices_.data(), underline_vertices_.size());
-
-  if (params_.underline_padding) {
-    mesh.AddIndices(underline_indices_.data(), underline_indices_.size());
-  } else {
-    for (size_t i = 2; i < underline_vertices_.size(); ++i) {
-      const uint16_t index = static_cast<uint16_t>(i);
-      std::array<uint16_t, 3> triangle = {static_cast<uint16_t>(index - 2),
-                                          static_cast<uint16_t>(index - 1),
-                                          index};
-      if (i % 2) {
-        std::swap(triangle[1], triangle[2]);
-      }
-      mesh.AddIndices(triangle.data(), triangle.size());
-    }
-  }
-
-  return mesh;
+  return MeshData(
+      MeshData::kTriangles, VertexPT::kFormat,
+      DataContainer::WrapDataAsReadOnly(
+          underline_vertices_.data(),
+          underline_vertices_.size() * sizeof(underline_vertices_[0])),
+      MeshData::kIndexU16,
+      DataContainer::WrapDataAsReadOnly(
+          underline_indices_.data(),
+          underline_indices_.size() * sizeof(underline_indices_[0])));
 }
 
 TextBufferPtr TextBuffer::Create(flatui::FontManager* manager,
                                  const std::string& text,
-                                 const TextBufferParams& params) {
+                                 const TextBufferParams& params,
+                                 std::vector<VertexPT> vertex_storage) {
   CHECK_GT(params.font_size, 0);  // Otherwise this leads to a crash in flatui.
 
   manager->SetTextEllipsis(params.ellipsis.c_str());
@@ -467,7 +454,8 @@ TextBufferPtr TextBuffer::Create(flatui::FontManager* manager,
     return TextBufferPtr();
   }
 
-  return TextBufferPtr(new TextBuffer(manager, font_buffer, params));
+  return TextBufferPtr(
+      new TextBuffer(manager, font_buffer, params, std::move(vertex_storage)));
 }
 
 }  // namespace lull
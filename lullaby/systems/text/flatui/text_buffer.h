@@ -55,9 +55,13 @@ struct TextBufferParams {
 // atlases. We also break the underlined text from links into their own slices.
 class TextBuffer {
  public:
-  static std::shared_ptr<TextBuffer> Create(flatui::FontManager* manager,
-                                            const std::string& text,
-                                            const TextBufferParams& params);
+  // Lays out |text| using the currently bound font of |manager|.  If provided,
+  // |vertex_storage| is cleared and used to hold the buffer's vertices so that
+  // relayouts can reuse the allocation of a previous buffer.
+  static std::shared_ptr<TextBuffer> Create(
+      flatui::FontManager* manager, const std::string& text,
+      const TextBufferParams& params,
+      std::vector<VertexPT> vertex_storage = std::vector<VertexPT>());
 
   ~TextBuffer();
 
@@ -72,6 +76,10 @@ class TextBuffer {
 
   const std::vector<VertexPT>& GetVertices() const { return vertices_; }
 
+  // Moves the vertices out of the buffer so that their storage can be passed
+  // to a later call to Create.
+  std::vector<VertexPT> ReleaseVertices() { return std::move(vertices_); }
+
   const std::vector<VertexPT>& GetUnderlineVertices() const {
     return underline_vertices_;
   }
@@ -79,6 +87,8 @@ class TextBuffer {
   fplbase::Texture* GetSliceTexture(size_t i) const;
   bool IsLinkSlice(size_t i) const;
 
+  // The meshes returned by these functions reference the buffer's vertices and
+  // indices without copying them, so they must not outlive the buffer.
   MeshData BuildSliceMesh(size_t slice) const;
 
   MeshData BuildUnderlineMesh() const;
@@ -95,7 +105,8 @@ class TextBuffer {
 
  private:
   TextBuffer(flatui::FontManager* manager, flatui::FontBuffer* buffer,
-             const TextBufferParams& params);
+             const TextBufferParams& params,
+             std::vector<VertexPT> vertex_storage);
 
   flatui::FontManager* font_manager_;
   flatui::FontBuffer* font_buffer_;
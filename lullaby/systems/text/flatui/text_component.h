@@ -52,6 +52,8 @@ struct TextComponent : Component {
   Dispatcher::ScopedConnection on_unhidden;
   TextTaskQueue::TaskId task_id = TextTaskQueue::kInvalidTaskId;
   TextTaskPtr task;
+  // Storage from a previous text buffer that is reused by the next task.
+  std::vector<VertexPT> spare_vertices;
 
   explicit TextComponent(Entity entity) : Component(entity) {}
 };
@@ -18,30 +18,42 @@ limitations under the License.
 
 namespace lull {
 
-TextTask::TextTask(
-    Entity target_entity, Entity desired_size_source, const FontPtr& font,
-    const std::string& text, const TextBufferParams& params)
+TextTask::TextTask(Entity target_entity, Entity desired_size_source,
+                   const FontPtr& font, const std::string& text,
+                   const TextBufferParams& params,
+                   std::mutex* font_manager_mutex,
+                   std::vector<VertexPT> vertex_storage)
     : target_entity_(target_entity),
       desired_size_source_(desired_size_source),
       font_(font),
       text_(text),
       params_(params),
+      font_manager_mutex_(font_manager_mutex),
+      vertex_storage_(std::move(vertex_storage)),
       text_buffer_(nullptr),
       output_text_buffer_(nullptr) {}
 
 void TextTask::Process() {
+  // The FontManager keeps the selected font, layout direction, and ellipsis as
+  // global state, and finalizing reads the metrics of the cached FontBuffer,
+  // so only one task may lay out text at a time.
+  std::lock_guard<std::mutex> lock(*font_manager_mutex_);
   if (font_ && font_->Bind()) {
-    text_buffer_ = TextBuffer::Create(font_->GetFontManager(), text_, params_);
+    text_buffer_ = TextBuffer::Create(font_->GetFontManager(), text_, params_,
+                                      std::move(vertex_storage_));
   } else {
     LOG(ERROR) << "Font is null or failed to bind in "
                   "GenerateTextBufferTask::Process()";
   }
-}
 
-void TextTask::Finalize() {
   if (text_buffer_) {
     // TODO Remove Finalize.
     text_buffer_->Finalize();
+  }
+}
+
+void TextTask::Finalize() {
+  if (text_buffer_) {
     using std::swap;
     swap(text_buffer_, output_text_buffer_);
   }
@@ -17,6 +17,10 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_TEXT_FLATUI_TEXT_TASK_H_
 #define LULLABY_SYSTEMS_TEXT_FLATUI_TEXT_TASK_H_
 
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "lullaby/util/entity.h"
 #include "lullaby/systems/text/flatui/font.h"
 #include "lullaby/systems/text/flatui/text_buffer.h"
@@ -27,19 +31,23 @@ namespace lull {
 // Task to generate a text buffer.
 class TextTask {
  public:
+  // |font_manager_mutex| guards the state of the FontManager used by |font|
+  // and must be held by every task that uses it.  The contents of
+  // |vertex_storage| are discarded, but its allocation is reused for the
+  // generated text buffer.
   TextTask(Entity target_entity, Entity desired_size_source,
            const FontPtr& font, const std::string& text,
-           const TextBufferParams& params);
+           const TextBufferParams& params, std::mutex* font_manager_mutex,
+           std::vector<VertexPT> vertex_storage = std::vector<VertexPT>());
 
   Entity GetTarget() const { return target_entity_; }
 
   Entity GetDesiredSizeSource() const { return desired_size_source_; }
 
-  // Called on a worker thread, this initializes the text buffer.
+  // Called on a worker thread, this initializes and finalizes the text buffer.
   void Process();
 
-  // Called on the host thread, this performs post-processing such as
-  // deformation (if applicable).
+  // Called on the host thread, this makes the output text buffer available.
   void Finalize();
 
   const TextBufferPtr& GetOutputTextBuffer() const {
@@ -52,6 +60,8 @@ class TextTask {
   FontPtr font_;
   std::string text_;
   TextBufferParams params_;
+  std::mutex* font_manager_mutex_;
+  std::vector<VertexPT> vertex_storage_;
   TextBufferPtr text_buffer_;
   TextBufferPtr output_text_buffer_;
 };
@@ -0,0 +1,252 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/transform/progressive_loader.h"
+
+#include <algorithm>
+#include <list>
+#include <utility>
+
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/dispatcher/event.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/logging.h"
+#include "lullaby/util/make_unique.h"
+
+namespace lull {
+
+ProgressiveLoader::ProgressiveLoader(Registry* registry, int priority)
+    : registry_(registry) {
+  auto* frame_budget = registry_->Get<FrameBudget>();
+  if (frame_budget) {
+    work_id_ =
+        frame_budget->Register([this]() { return CreateNext(); }, priority);
+  }
+}
+
+ProgressiveLoader::~ProgressiveLoader() {
+  auto* frame_budget = registry_->Get<FrameBudget>();
+  if (frame_budget && work_id_ != FrameBudget::kInvalidWorkId) {
+    frame_budget->Unregister(work_id_);
+  }
+}
+
+Entity ProgressiveLoader::Load(const std::string& name) {
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  if (entity_factory == nullptr) {
+    LOG(DFATAL) << "ProgressiveLoader depends on EntityFactory.";
+    return kNullEntity;
+  }
+
+  auto load = MakeUnique<PendingLoad>();
+  load->asset = entity_factory->GetBlueprintAsset(name);
+  Optional<BlueprintTree> blueprint = entity_factory->CreateBlueprint(name);
+  if (!load->asset || !blueprint) {
+    return kNullEntity;
+  }
+  load->blueprint = std::move(*blueprint);
+  return StartLoad(std::move(load));
+}
+
+Entity ProgressiveLoader::Load(BlueprintTree blueprint) {
+  auto load = MakeUnique<PendingLoad>();
+  load->blueprint = std::move(blueprint);
+  return StartLoad(std::move(load));
+}
+
+Entity ProgressiveLoader::StartLoad(std::unique_ptr<PendingLoad> load) {
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  if (entity_factory == nullptr) {
+    LOG(DFATAL) << "ProgressiveLoader depends on EntityFactory.";
+    return kNullEntity;
+  }
+
+  const Entity root = entity_factory->Create();
+  if (entity_factory->CreateWithoutChildren(root, &load->blueprint) ==
+      kNullEntity) {
+    return kNullEntity;
+  }
+
+  load->root = root;
+  PendingLoad* ptr = load.get();
+  loads_[root] = std::move(load);
+  QueueChildren(ptr, kNullEntity, root, &ptr->blueprint, 0);
+  return root;
+}
+
+void ProgressiveLoader::Cancel(Entity root) {
+  auto iter = loads_.find(root);
+  if (iter == loads_.end()) {
+    return;
+  }
+  const PendingLoad* load = iter->second.get();
+
+  for (Level& level : levels_) {
+    level.tasks.erase(level.tasks.begin(), level.tasks.begin() + level.next);
+    level.next = 0;
+    const size_t size = level.tasks.size();
+    level.tasks.erase(
+        std::remove_if(level.tasks.begin(), level.tasks.end(),
+                       [load](const Task& task) { return task.load == load; }),
+        level.tasks.end());
+    num_queued_ -= size - level.tasks.size();
+  }
+  for (auto it = subtrees_.begin(); it != subtrees_.end();) {
+    if (it->second.load == load) {
+      it = subtrees_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  loads_.erase(iter);
+}
+
+bool ProgressiveLoader::IsLoading(Entity root) const {
+  return loads_.count(root) != 0;
+}
+
+void ProgressiveLoader::SetFocus(const mathfu::vec3& position) {
+  focus_ = position;
+  has_focus_ = true;
+  for (Level& level : levels_) {
+    level.sorted = false;
+  }
+}
+
+void ProgressiveLoader::ClearFocus() { has_focus_ = false; }
+
+bool ProgressiveLoader::CreateNext() {
+  // Breadth-first: always work on the shallowest queued Entities.
+  size_t depth = 0;
+  while (depth < levels_.size() &&
+         levels_[depth].next == levels_[depth].tasks.size()) {
+    ++depth;
+  }
+  if (depth == levels_.size()) {
+    return false;
+  }
+
+  Level& level = levels_[depth];
+  if (!level.sorted) {
+    Sort(&level);
+  }
+  const Task task = level.tasks[level.next++];
+  if (level.next == level.tasks.size()) {
+    level.tasks.clear();
+    level.next = 0;
+    level.sorted = true;
+  }
+  --num_queued_;
+
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  const Entity entity =
+      entity_factory->CreateChildWithoutChildren(task.parent, task.blueprint);
+  if (entity == kNullEntity) {
+    // Treat the failed subtree as complete so that its ancestors finish.
+    Complete(task.load, task.parent, kNullEntity, false);
+  } else {
+    QueueChildren(task.load, task.parent, entity, task.blueprint, depth + 1);
+  }
+  return true;
+}
+
+void ProgressiveLoader::QueueChildren(PendingLoad* load, Entity parent,
+                                      Entity entity, BlueprintTree* blueprint,
+                                      size_t depth) {
+  std::list<BlueprintTree>* children = blueprint->Children();
+  if (children->empty()) {
+    Complete(load, parent, entity, false);
+    return;
+  }
+
+  Subtree& subtree = subtrees_[entity];
+  subtree.load = load;
+  subtree.parent = parent;
+  subtree.remaining = children->size();
+
+  if (levels_.size() <= depth) {
+    levels_.resize(depth + 1);
+  }
+  Level& level = levels_[depth];
+  for (BlueprintTree& child : *children) {
+    Task task;
+    task.load = load;
+    task.parent = entity;
+    task.blueprint = &child;
+    level.tasks.push_back(task);
+  }
+  num_queued_ += children->size();
+  if (has_focus_) {
+    level.sorted = false;
+  }
+}
+
+void ProgressiveLoader::Complete(PendingLoad* load, Entity parent,
+                                 Entity entity, bool has_children) {
+  const Entity root = load->root;
+  if (entity == root) {
+    // Release the blueprint before the event, in case it starts another load.
+    loads_.erase(root);
+    SendEvent(registry_, entity, ProgressiveLoadCompleteEvent(entity, root));
+    return;
+  }
+  if (has_children) {
+    SendEvent(registry_, entity, ProgressiveLoadCompleteEvent(entity, root));
+    if (loads_.count(root) == 0) {
+      // The load was cancelled by the event.
+      return;
+    }
+  }
+
+  auto iter = subtrees_.find(parent);
+  if (iter == subtrees_.end() || --iter->second.remaining > 0) {
+    return;
+  }
+  const Entity grandparent = iter->second.parent;
+  subtrees_.erase(iter);
+  Complete(load, grandparent, parent, true);
+}
+
+void ProgressiveLoader::Sort(Level* level) {
+  level->tasks.erase(level->tasks.begin(),
+                     level->tasks.begin() + level->next);
+  level->next = 0;
+  level->sorted = true;
+  if (!has_focus_) {
+    return;
+  }
+
+  const auto* transform_system = registry_->Get<TransformSystem>();
+  for (Task& task : level->tasks) {
+    const mathfu::mat4* world_from_parent =
+        transform_system
+            ? transform_system->GetWorldFromEntityMatrix(task.parent)
+            : nullptr;
+    if (world_from_parent) {
+      const mathfu::vec3 offset =
+          world_from_parent->TranslationVector3D() - focus_;
+      task.distance = offset.LengthSquared();
+    } else {
+      task.distance = 0.f;
+    }
+  }
+  std::stable_sort(level->tasks.begin(), level->tasks.end(),
+                   [](const Task& lhs, const Task& rhs) {
+                     return lhs.distance < rhs.distance;
+                   });
+}
+
+}  // namespace lull
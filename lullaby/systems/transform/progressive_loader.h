@@ -0,0 +1,181 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_TRANSFORM_PROGRESSIVE_LOADER_H_
+#define LULLABY_SYSTEMS_TRANSFORM_PROGRESSIVE_LOADER_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lullaby/modules/ecs/blueprint_tree.h"
+#include "lullaby/modules/file/asset.h"
+#include "lullaby/util/entity.h"
+#include "lullaby/util/frame_budget.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/util/typeid.h"
+#include "mathfu/constants.h"
+#include "mathfu/glsl_mappings.h"
+
+namespace lull {
+
+// Instantiates large blueprint hierarchies a few Entities at a time, instead of
+// all at once like EntityFactory::Create, so that entering a scene does not
+// drop frames.
+//
+// Load() creates the root Entity of the blueprint immediately, as a coarse
+// placeholder for the scene, and queues its children.  Each call to
+// CreateNext() then creates a single queued Entity (without its children,
+// which are queued in turn).  The hierarchy is created breadth-first: all the
+// queued Entities at one depth are created before any deeper ones.  Within a
+// depth, the children of the parents nearest the focus (see SetFocus) are
+// created first.
+//
+// When a FrameBudget is in the Registry, CreateNext() is registered with it so
+// that the hierarchy is created within the per-frame time budget.
+//
+// Once an Entity with children and all its descendants have been created, a
+// ProgressiveLoadCompleteEvent is sent for it, ending with the root.
+//
+// Unlike EntityFactory::Create, Components are post-created before the children
+// of their Entity exist, so blueprints that rely on discovering their children
+// in PostCreateComponent should not be loaded progressively.
+class ProgressiveLoader {
+ public:
+  static constexpr int kDefaultPriority = 0;
+
+  // Do not create ProgressiveLoader directly.  Instead, create via registry,
+  // eg:
+  // registry.Create<ProgressiveLoader>(&registry);
+  //
+  // |priority| is the priority of the loader's work in the FrameBudget.
+  explicit ProgressiveLoader(Registry* registry,
+                             int priority = kDefaultPriority);
+
+  ~ProgressiveLoader();
+
+  ProgressiveLoader(const ProgressiveLoader&) = delete;
+  ProgressiveLoader& operator=(const ProgressiveLoader&) = delete;
+
+  // Creates the root Entity of the blueprint |name| and queues its descendants.
+  // Returns the root, or kNullEntity if the blueprint could not be loaded.
+  Entity Load(const std::string& name);
+
+  // As above, but loads the hierarchy in |blueprint|.
+  Entity Load(BlueprintTree blueprint);
+
+  // Stops creating the descendants of |root| that have not yet been created.
+  // The Entities that have been created are left untouched.  Must be called
+  // before destroying a hierarchy that is still loading.
+  void Cancel(Entity root);
+
+  // Returns true if descendants of |root| are still queued.
+  bool IsLoading(Entity root) const;
+
+  // Sets the world space position (typically the camera's) whose nearest
+  // subtrees are created first.
+  void SetFocus(const mathfu::vec3& position);
+
+  // Stops prioritizing subtrees by distance.
+  void ClearFocus();
+
+  // Creates the next queued Entity.  Returns false if there are none.
+  bool CreateNext();
+
+  // Returns the number of queued Entities.
+  size_t GetNumQueued() const { return num_queued_; }
+
+ private:
+  // A hierarchy being loaded.
+  struct PendingLoad {
+    Entity root = kNullEntity;
+    // Keeps the blueprint data referenced by |blueprint| alive.
+    std::shared_ptr<MappedAsset> asset;
+    BlueprintTree blueprint;
+  };
+
+  // A queued Entity.
+  struct Task {
+    PendingLoad* load = nullptr;
+    Entity parent = kNullEntity;
+    BlueprintTree* blueprint = nullptr;
+    float distance = 0.f;
+  };
+
+  // The queued Entities at one depth of the hierarchies.
+  struct Level {
+    std::vector<Task> tasks;
+    // The index of the next task to perform.
+    size_t next = 0;
+    bool sorted = true;
+  };
+
+  // An Entity whose descendants are still being created.
+  struct Subtree {
+    PendingLoad* load = nullptr;
+    Entity parent = kNullEntity;
+    size_t remaining = 0;
+  };
+
+  Entity StartLoad(std::unique_ptr<PendingLoad> load);
+
+  // Queues the children of the newly created |entity| at |depth|.
+  void QueueChildren(PendingLoad* load, Entity parent, Entity entity,
+                     BlueprintTree* blueprint, size_t depth);
+
+  // Called once |entity| and all its descendants have been created.
+  void Complete(PendingLoad* load, Entity parent, Entity entity,
+                bool has_children);
+
+  // Orders the tasks of |level| by the distance from their parent to the
+  // focus.
+  void Sort(Level* level);
+
+  Registry* registry_;
+  FrameBudget::WorkId work_id_ = FrameBudget::kInvalidWorkId;
+  std::unordered_map<Entity, std::unique_ptr<PendingLoad>> loads_;
+  std::unordered_map<Entity, Subtree> subtrees_;
+  std::vector<Level> levels_;
+  size_t num_queued_ = 0;
+  mathfu::vec3 focus_ = mathfu::kZeros3f;
+  bool has_focus_ = false;
+};
+
+// Sent when |entity| and all of its descendants have been created by the
+// ProgressiveLoader.  |root| is the Entity that was returned by Load().
+struct ProgressiveLoadCompleteEvent {
+  ProgressiveLoadCompleteEvent() {}
+  ProgressiveLoadCompleteEvent(Entity entity, Entity root)
+      : entity(entity), root(root) {}
+
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(&entity, ConstHash("entity"));
+    archive(&root, ConstHash("root"));
+  }
+
+  Entity entity = kNullEntity;
+  Entity root = kNullEntity;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::ProgressiveLoader);
+LULLABY_SETUP_TYPEID(lull::ProgressiveLoadCompleteEvent);
+
+#endif  // LULLABY_SYSTEMS_TRANSFORM_PROGRESSIVE_LOADER_H_
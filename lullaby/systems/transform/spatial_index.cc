@@ -0,0 +1,185 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/transform/spatial_index.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+namespace {
+
+// The padding added to the bounds in the tree so that small movements do not
+// require the tree to be restructured.
+constexpr float kSpatialIndexMargin = 0.05f;
+
+}  // namespace
+
+SpatialIndex::SpatialIndex(Registry* registry)
+    : registry_(registry),
+      transform_system_(registry->Get<TransformSystem>()),
+      tree_(kSpatialIndexMargin) {
+  if (transform_system_ == nullptr) {
+    LOG(DFATAL) << "The SpatialIndex requires the TransformSystem.";
+  }
+}
+
+SpatialIndex::~SpatialIndex() {
+  // The TransformSystem may already have been destroyed.
+  auto* transform_system = registry_->Get<TransformSystem>();
+  if (transform_system) {
+    for (const TransformSystem::TransformFlags flag : flags_) {
+      transform_system->UntrackChanges(flag);
+    }
+  }
+}
+
+void SpatialIndex::IndexFlag(TransformSystem::TransformFlags flag) {
+  if (transform_system_ == nullptr || flag == TransformSystem::kInvalidFlag ||
+      std::find(flags_.begin(), flags_.end(), flag) != flags_.end()) {
+    return;
+  }
+  flags_.push_back(flag);
+  flag_mask_ |= flag;
+  transform_system_->TrackChanges(flag);
+
+  // Entities which already have the flag have no change records.
+  transform_system_->ForEach(
+      flag, [this](Entity entity, const mathfu::mat4&, const Aabb&) {
+        changed_entities_.push_back(entity);
+      });
+}
+
+void SpatialIndex::UnindexFlag(TransformSystem::TransformFlags flag) {
+  auto iter = std::find(flags_.begin(), flags_.end(), flag);
+  if (iter == flags_.end()) {
+    return;
+  }
+  flags_.erase(iter);
+  flag_mask_ &= ~flag;
+  transform_system_->UntrackChanges(flag);
+
+  transform_system_->ForEach(
+      flag, [this](Entity entity, const mathfu::mat4&, const Aabb&) {
+        changed_entities_.push_back(entity);
+      });
+}
+
+void SpatialIndex::Update() const {
+  for (const TransformSystem::TransformFlags flag : flags_) {
+    transform_system_->TakeUniqueChangedEntities(flag, &changed_entities_);
+  }
+  if (changed_entities_.empty()) {
+    return;
+  }
+
+  ++generation_;
+  for (const Entity entity : changed_entities_) {
+    UpdateProxy(entity);
+  }
+  changed_entities_.clear();
+}
+
+uint64_t SpatialIndex::GetGeneration() const {
+  Update();
+  return generation_;
+}
+
+size_t SpatialIndex::Size() const {
+  Update();
+  return tree_.Size();
+}
+
+const Aabb* SpatialIndex::GetWorldAabb(Entity entity) const {
+  Update();
+  auto iter = proxies_.find(entity);
+  return iter != proxies_.end() ? &iter->second.world_aabb : nullptr;
+}
+
+void SpatialIndex::FindNearest(const mathfu::vec3& point, size_t count,
+                               float max_distance,
+                               std::vector<Entity>* entities) const {
+  entities->clear();
+  if (count == 0) {
+    return;
+  }
+  Update();
+
+  // A max-heap of the nearest Entities found so far, with the distances to
+  // their exact bounds rather than the padded bounds in the tree.
+  using Candidate = std::pair<float, Entity>;
+  std::vector<Candidate> nearest;
+  nearest.reserve(count + 1);
+  tree_.QueryNearest(point, max_distance, [&](Entity entity) -> float {
+    const Aabb& world_aabb = proxies_.find(entity)->second.world_aabb;
+    const mathfu::vec3 closest = mathfu::vec3::Max(
+        world_aabb.min, mathfu::vec3::Min(point, world_aabb.max));
+    const float distance = (point - closest).Length();
+    if (distance <= max_distance) {
+      nearest.emplace_back(distance, entity);
+      std::push_heap(nearest.begin(), nearest.end());
+      if (nearest.size() > count) {
+        std::pop_heap(nearest.begin(), nearest.end());
+        nearest.pop_back();
+      }
+      // Once |count| Entities have been found, only nearer ones matter.
+      if (nearest.size() == count) {
+        max_distance = nearest.front().first;
+      }
+    }
+    return max_distance;
+  });
+
+  std::sort_heap(nearest.begin(), nearest.end());
+  entities->reserve(nearest.size());
+  for (const Candidate& candidate : nearest) {
+    entities->push_back(candidate.second);
+  }
+}
+
+void SpatialIndex::UpdateProxy(Entity entity) const {
+  const mathfu::mat4* world_from_entity_mat =
+      transform_system_->GetWorldFromEntityMatrix(entity);
+  const Aabb* box = transform_system_->GetAabb(entity);
+  if (!world_from_entity_mat || !box || !transform_system_->IsEnabled(entity) ||
+      !transform_system_->HasFlag(entity, flag_mask_)) {
+    RemoveProxy(entity);
+    return;
+  }
+
+  const Aabb world_aabb = TransformAabb(*world_from_entity_mat, *box);
+  auto iter = proxies_.find(entity);
+  if (iter == proxies_.end()) {
+    Proxy& proxy = proxies_[entity];
+    proxy.id = tree_.Insert(world_aabb, entity);
+    proxy.world_aabb = world_aabb;
+  } else {
+    tree_.Update(iter->second.id, world_aabb);
+    iter->second.world_aabb = world_aabb;
+  }
+}
+
+void SpatialIndex::RemoveProxy(Entity entity) const {
+  auto iter = proxies_.find(entity);
+  if (iter != proxies_.end()) {
+    tree_.Remove(iter->second.id);
+    proxies_.erase(iter);
+  }
+}
+
+}  // namespace lull
@@ -0,0 +1,188 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_TRANSFORM_SPATIAL_INDEX_H_
+#define LULLABY_SYSTEMS_TRANSFORM_SPATIAL_INDEX_H_
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/dynamic_aabb_tree.h"
+#include "lullaby/util/entity.h"
+#include "lullaby/util/math.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+// An engine-wide bounding volume hierarchy of the world space bounds of
+// Entities, so that systems needing spatial queries (collision, culling,
+// proximity, etc.) can share one incrementally updated structure rather than
+// each iterating over every transform.
+//
+// Systems choose which Entities are indexed by calling IndexFlag() with a
+// TransformFlag they set on their Entities; an Entity is indexed while it is
+// enabled and has any of the indexed flags.  The index is brought up-to-date
+// lazily by the queries, using the TransformSystem's change records, so it only
+// does work for the Entities that moved, changed their aabb, were enabled or
+// disabled, or gained or lost an indexed flag since the last query.
+//
+// Queries report every indexed Entity that matches, whichever system indexed
+// it, so callers should check for their own flag if they only want their own
+// Entities.  The queries may be called from const functions, but the index must
+// only be used from a single thread.
+//
+// Systems usually create the index on demand in their Initialize():
+//   registry_->Create<SpatialIndex>(registry_);
+//   spatial_index_ = registry_->Get<SpatialIndex>();
+//   spatial_index_->IndexFlag(my_flag_);
+class SpatialIndex {
+ public:
+  explicit SpatialIndex(Registry* registry);
+  ~SpatialIndex();
+
+  SpatialIndex(const SpatialIndex&) = delete;
+  SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+  // Indexes all the Entities with |flag|.  The SpatialIndex takes over the
+  // TransformSystem's change tracking for |flag| (see TrackChanges()), so the
+  // caller must not call TakeChangedEntities() with it.
+  void IndexFlag(TransformSystem::TransformFlags flag);
+
+  // Stops indexing the Entities with |flag|, unless they have another indexed
+  // flag.
+  void UnindexFlag(TransformSystem::TransformFlags flag);
+
+  // Applies all the changes recorded since the last update.  Queries do this
+  // automatically, so this only needs to be called to control when the work is
+  // done, eg. once per frame after the transforms have been updated.
+  void Update() const;
+
+  // Returns a value that changes whenever an Entity is added to or removed from
+  // the index, or the bounds of an indexed Entity change.
+  uint64_t GetGeneration() const;
+
+  // Returns the number of indexed Entities.
+  size_t Size() const;
+
+  // Returns the world space Aabb of |entity|, or null if it is not indexed.
+  const Aabb* GetWorldAabb(Entity entity) const;
+
+  // Calls |fn| with every indexed Entity whose world space Aabb overlaps
+  // |aabb|.
+  template <typename Fn>
+  void QueryAabb(const Aabb& aabb, Fn&& fn) const;
+
+  // Calls |fn| with every indexed Entity whose world space Aabb is no further
+  // than |radius| from |center|.
+  template <typename Fn>
+  void QuerySphere(const mathfu::vec3& center, float radius, Fn&& fn) const;
+
+  // Calls |fn| with every indexed Entity whose bounds may be inside the
+  // frustum bounded by |planes|, as computed by CalculateViewFrustum().  This
+  // is conservative: Entities slightly outside the frustum may be reported.
+  template <typename Fn>
+  void QueryFrustum(const mathfu::vec4 planes[kNumFrustumPlanes],
+                    Fn&& fn) const;
+
+  // Calls |fn| with every indexed Entity whose bounds may be hit by |ray| no
+  // further than |max_distance| away, nearest first.  As with
+  // DynamicAabbTree::Raycast(), |fn| must return the new maximum distance for
+  // the rest of the query.  This is a broadphase: callers should test the
+  // Entities' exact shapes.
+  template <typename Fn>
+  void Raycast(const Ray& ray, float max_distance, Fn&& fn) const;
+
+  // Sets |entities| to the (up to) |count| indexed Entities whose world space
+  // Aabbs are nearest to |point| and no further than |max_distance| away,
+  // ordered from nearest to furthest.
+  void FindNearest(const mathfu::vec3& point, size_t count, float max_distance,
+                   std::vector<Entity>* entities) const;
+
+ private:
+  struct Proxy {
+    DynamicAabbTree::ProxyId id = DynamicAabbTree::kInvalidProxy;
+    Aabb world_aabb;
+  };
+
+  // Inserts, updates or removes the proxy of |entity| to match its current
+  // transform and flags.
+  void UpdateProxy(Entity entity) const;
+
+  // Removes the proxy of |entity|, if any.
+  void RemoveProxy(Entity entity) const;
+
+  Registry* registry_;
+  TransformSystem* transform_system_;
+  std::vector<TransformSystem::TransformFlags> flags_;
+  TransformSystem::TransformFlags flag_mask_ = 0;
+
+  // The index is lazily brought up-to-date by the (const) queries.
+  mutable DynamicAabbTree tree_;
+  mutable std::unordered_map<Entity, Proxy> proxies_;
+  mutable std::vector<Entity> changed_entities_;
+  mutable uint64_t generation_ = 0;
+};
+
+template <typename Fn>
+void SpatialIndex::QueryAabb(const Aabb& aabb, Fn&& fn) const {
+  Update();
+  tree_.QueryAabb(aabb, [&](Entity entity) {
+    const Aabb& world_aabb = proxies_.find(entity)->second.world_aabb;
+    if (aabb.min.x <= world_aabb.max.x && world_aabb.min.x <= aabb.max.x &&
+        aabb.min.y <= world_aabb.max.y && world_aabb.min.y <= aabb.max.y &&
+        aabb.min.z <= world_aabb.max.z && world_aabb.min.z <= aabb.max.z) {
+      fn(entity);
+    }
+  });
+}
+
+template <typename Fn>
+void SpatialIndex::QuerySphere(const mathfu::vec3& center, float radius,
+                               Fn&& fn) const {
+  const Aabb bounds(center - mathfu::vec3(radius),
+                    center + mathfu::vec3(radius));
+  const float radius_squared = radius * radius;
+  QueryAabb(bounds, [&](Entity entity) {
+    const Aabb& world_aabb = proxies_.find(entity)->second.world_aabb;
+    const mathfu::vec3 closest = mathfu::vec3::Max(
+        world_aabb.min, mathfu::vec3::Min(center, world_aabb.max));
+    if ((center - closest).LengthSquared() <= radius_squared) {
+      fn(entity);
+    }
+  });
+}
+
+template <typename Fn>
+void SpatialIndex::QueryFrustum(const mathfu::vec4 planes[kNumFrustumPlanes],
+                                Fn&& fn) const {
+  Update();
+  tree_.QueryFrustum(planes, std::forward<Fn>(fn));
+}
+
+template <typename Fn>
+void SpatialIndex::Raycast(const Ray& ray, float max_distance, Fn&& fn) const {
+  Update();
+  tree_.Raycast(ray, max_distance, std::forward<Fn>(fn));
+}
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::SpatialIndex);
+
+#endif  // LULLABY_SYSTEMS_TRANSFORM_SPATIAL_INDEX_H_
@@ -0,0 +1,56 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/transform/sqt_batch.h"
+
+namespace lull {
+
+void SetSqtBatch(TransformSystem* transform_system, Span<SqtRecord> records) {
+  for (const SqtRecord& record : records) {
+    const Sqt sqt(
+        mathfu::vec3(record.translation[0], record.translation[1],
+                     record.translation[2]),
+        mathfu::quat(record.rotation[3], record.rotation[0],
+                     record.rotation[1], record.rotation[2]),
+        mathfu::vec3(record.scale[0], record.scale[1], record.scale[2]));
+    transform_system->SetSqt(Entity(record.entity), sqt);
+  }
+}
+
+size_t GetSqtBatch(const TransformSystem* transform_system,
+                   MutableSpan<SqtRecord> records) {
+  size_t num_found = 0;
+  for (SqtRecord& record : records) {
+    const Sqt* sqt = transform_system->GetSqt(Entity(record.entity));
+    if (sqt == nullptr) {
+      continue;
+    }
+    record.translation[0] = sqt->translation.x;
+    record.translation[1] = sqt->translation.y;
+    record.translation[2] = sqt->translation.z;
+    record.rotation[0] = sqt->rotation.vector().x;
+    record.rotation[1] = sqt->rotation.vector().y;
+    record.rotation[2] = sqt->rotation.vector().z;
+    record.rotation[3] = sqt->rotation.scalar();
+    record.scale[0] = sqt->scale.x;
+    record.scale[1] = sqt->scale.y;
+    record.scale[2] = sqt->scale.z;
+    ++num_found;
+  }
+  return num_found;
+}
+
+}  // namespace lull
@@ -0,0 +1,50 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_TRANSFORM_SQT_BATCH_H_
+#define LULLABY_SYSTEMS_TRANSFORM_SQT_BATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/span.h"
+
+namespace lull {
+
+// A single (entity, translation, rotation, scale) record, as packed by callers
+// that batch transform updates across a language boundary (eg. the JNI
+// TransformSystem.nativeSetSqtBatch).  The rotation is stored as x, y, z, w.
+struct SqtRecord {
+  uint32_t entity;
+  float translation[3];
+  float rotation[4];
+  float scale[3];
+};
+static_assert(sizeof(SqtRecord) == 44, "Unexpected SqtRecord padding.");
+
+// Sets the local Sqt of the entity in each of |records|.
+void SetSqtBatch(TransformSystem* transform_system, Span<SqtRecord> records);
+
+// Fills in the local Sqt of the entity in each of |records|.  Records of
+// entities without a transform are left unchanged.  Returns the number of
+// records that were filled in.
+size_t GetSqtBatch(const TransformSystem* transform_system,
+                   MutableSpan<SqtRecord> records);
+
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_TRANSFORM_SQT_BATCH_H_
@@ -25,6 +25,7 @@ limitations under the License.
 #include "lullaby/modules/flatbuffers/mathfu_fb_conversions.h"
 #include "lullaby/modules/script/function_binder.h"
 #include "lullaby/systems/dispatcher/event.h"
+#include "lullaby/util/job_processor.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/generated/transform_def_generated.h"
 
@@ -48,12 +49,25 @@ size_t RoundAndClampIndex(int index, size_t list_size) {
     }
   }
 }
+
+// The minimum number of dirty roots processed by a single job in Flush().
+// Smaller batches are not worth the overhead of dispatching to a worker.
+constexpr size_t kMinDirtyRootsPerJob = 32;
+
+// The maximum number of jobs a single Flush() will dispatch.
+constexpr size_t kMaxFlushJobs = 8;
+
+// Flush() recalculates individual dirty subtrees as long as fewer than 1 in
+// this many transforms are dirty, and otherwise does a single linear pass over
+// all the packed transforms.
+constexpr size_t kMaxDirtyRatioForSubtreeFlush = 8;
 }  // namespace
 
 namespace lull {
 
 const TransformSystem::TransformFlags TransformSystem::kInvalidFlag = 0;
 const TransformSystem::TransformFlags TransformSystem::kAllFlags = ~0;
+const uint32_t TransformSystem::kInvalidPackedIndex = ~0u;
 const HashValue kTransformDefHash = ConstHash("TransformDef");
 
 TransformSystem::TransformSystem(Registry* registry)
@@ -61,7 +75,11 @@ TransformSystem::TransformSystem(Registry* registry)
       nodes_(16),
       world_transforms_(16),
       disabled_transforms_(16),
-      reserved_flags_(0) {
+      reserved_flags_(0),
+      deferred_updates_(false),
+      tracked_flags_(0),
+      packed_dirty_(true),
+      packed_iteration_depth_(0) {
   RegisterDef<TransformDefT>(this);
 
   EntityFactory* entity_factory = registry_->Get<EntityFactory>();
@@ -80,6 +98,24 @@ TransformSystem::TransformSystem(Registry* registry)
           pending_children_.erase(child);
           return created_child;
         });
+    entity_factory->SetRecreateFn(
+        [this, entity_factory](Entity entity, const std::string& name) {
+          // Keep the re-created Entity in the same place in the scene graph.
+          const Entity parent = GetParent(entity);
+          const int index = static_cast<int>(GetChildIndex(entity));
+          entity_factory->Destroy(entity);
+          if (parent == kNullEntity) {
+            entity_factory->Create(entity, name);
+          } else {
+            CreateChildWithEntity(parent, entity, name);
+            MoveChild(entity, index);
+          }
+        });
+    entity_factory->SetReleaseFn([this](Entity entity) {
+      // Pooled Entities should neither be visible nor move with their parent.
+      RemoveParent(entity);
+      Disable(entity);
+    });
   }
 
   FunctionBinder* binder = registry->Get<FunctionBinder>();
@@ -250,6 +286,7 @@ void TransformSystem::Create(Entity e, HashValue type, const Def* def) {
   }
 
   node->enable_self = data->enabled();
+  InvalidatePackedTransforms();
 
   MathfuVec3FromFbVec3(data->position(), &node->local_sqt.translation);
   if (data->quaternion()) {
@@ -286,12 +323,56 @@ void TransformSystem::Create(Entity e, const Sqt& sqt) {
     world_transforms_.Emplace(e);
     node->world_from_entity_matrix_function = CalculateWorldFromEntityMatrix;
     node->local_sqt_function = CalculateLocalSqt;
+    InvalidatePackedTransforms();
   }
 
   node->local_sqt = sqt;
   RecalculateWorldFromEntityMatrix(e);
 }
 
+void TransformSystem::CreateMany(Span<Entity> entities,
+                                 const Blueprint& blueprint) {
+  nodes_.Reserve(nodes_.Size() + entities.size());
+  world_transforms_.Reserve(world_transforms_.Size() + entities.size());
+  System::CreateMany(entities, blueprint);
+}
+
+bool TransformSystem::ResetComponent(Entity e, const Blueprint& blueprint) {
+  if (blueprint.GetLegacyDefType() != kTransformDefHash) {
+    return false;
+  }
+  GraphNode* node = nodes_.Get(e);
+  if (!node || !GetWorldTransform(e)) {
+    return false;
+  }
+  const auto* data = ConvertDef<TransformDef>(blueprint.GetLegacyDefData());
+
+  Sqt sqt;
+  MathfuVec3FromFbVec3(data->position(), &sqt.translation);
+  if (data->quaternion()) {
+    MathfuQuatFromFbVec4(data->quaternion(), &sqt.rotation);
+  } else {
+    MathfuQuatFromFbVec3(data->rotation(), &sqt.rotation);
+  }
+  MathfuVec3FromFbVec3(data->scale(), &sqt.scale);
+  SetSqt(e, sqt);
+
+  node->aabb_padding = Aabb();
+  if (data->aabb_padding()) {
+    AabbFromFbAabb(data->aabb_padding(), &node->aabb_padding);
+  }
+  Aabb box;
+  AabbFromFbAabb(data->aabb(), &box);
+  SetAabb(e, box);
+
+  if (data->enabled()) {
+    Enable(e);
+  } else {
+    Disable(e);
+  }
+  return true;
+}
+
 void TransformSystem::PostCreateInit(Entity e, HashValue type, const Def* def) {
   if (type != kTransformDefHash) {
     LOG(DFATAL)
@@ -346,22 +427,50 @@ void TransformSystem::Destroy(Entity e) {
     }
 
     nodes_.Destroy(e);
+    InvalidatePackedTransforms();
+  }
+  const WorldTransform* transform = GetWorldTransform(e);
+  if (transform) {
+    RecordChange(e, transform->flags);
   }
   world_transforms_.Destroy(e);
   disabled_transforms_.Destroy(e);
 }
 
+size_t TransformSystem::GetNumComponents() const {
+  return nodes_.Size();
+}
+
+size_t TransformSystem::GetComponentMemoryUsage() const {
+  return nodes_.GetMemoryUsage() + world_transforms_.GetMemoryUsage() +
+         disabled_transforms_.GetMemoryUsage();
+}
+
 void TransformSystem::SetFlag(Entity e, TransformFlags flag) {
   auto transform = GetWorldTransform(e);
   if (transform) {
+    if (!CheckBit(transform->flags, flag)) {
+      RecordChange(e, flag);
+    }
     transform->flags = SetBit(transform->flags, flag);
+    const uint32_t index = GetPackedIndex(transform);
+    if (index != kInvalidPackedIndex) {
+      packed_.At<kPackedFlags>(index) = transform->flags;
+    }
   }
 }
 
 void TransformSystem::ClearFlag(Entity e, TransformFlags flag) {
   auto transform = GetWorldTransform(e);
   if (transform) {
+    if (CheckBit(transform->flags, flag)) {
+      RecordChange(e, flag);
+    }
     transform->flags = ClearBit(transform->flags, flag);
+    const uint32_t index = GetPackedIndex(transform);
+    if (index != kInvalidPackedIndex) {
+      packed_.At<kPackedFlags>(index) = transform->flags;
+    }
   }
 }
 
@@ -380,6 +489,13 @@ void TransformSystem::SetAabb(Entity e, Aabb box) {
       transform->box.min += node->aabb_padding.min;
       transform->box.max += node->aabb_padding.max;
     }
+
+    const uint32_t index = GetPackedIndex(transform);
+    if (index != kInvalidPackedIndex) {
+      packed_.At<kPackedAabb>(index) = transform->box;
+      packed_.At<kPackedBoundingSphereStale>(index) = 1;
+    }
+    RecordChange(e, transform->flags);
   }
 
   SendEvent(registry_, e, AabbChangedEvent(e));
@@ -400,6 +516,13 @@ void TransformSystem::SetAabbPadding(Entity e, const Aabb& padding) {
   if (transform) {
     transform->box.min += -node->aabb_padding.min + padding.min;
     transform->box.max += -node->aabb_padding.max + padding.max;
+
+    const uint32_t index = GetPackedIndex(transform);
+    if (index != kInvalidPackedIndex) {
+      packed_.At<kPackedAabb>(index) = transform->box;
+      packed_.At<kPackedBoundingSphereStale>(index) = 1;
+    }
+    RecordChange(e, transform->flags);
   }
 
   node->aabb_padding = padding;
@@ -429,7 +552,7 @@ void TransformSystem::SetSqt(Entity e, const Sqt& sqt) {
   auto node = nodes_.Get(e);
   if (node) {
     node->local_sqt = sqt;
-    RecalculateWorldFromEntityMatrix(e);
+    OnLocalTransformChanged(e);
   }
 }
 
@@ -444,7 +567,7 @@ void TransformSystem::ApplySqt(Entity e, const Sqt& modifier) {
     node->local_sqt.translation += modifier.translation;
     node->local_sqt.rotation = node->local_sqt.rotation * modifier.rotation;
     node->local_sqt.scale *= modifier.scale;
-    RecalculateWorldFromEntityMatrix(e);
+    OnLocalTransformChanged(e);
   }
 }
 
@@ -453,7 +576,7 @@ void TransformSystem::SetLocalTranslation(Entity e,
   auto node = nodes_.Get(e);
   if (node) {
     node->local_sqt.translation = translation;
-    RecalculateWorldFromEntityMatrix(e);
+    OnLocalTransformChanged(e);
   }
 }
 
@@ -466,7 +589,7 @@ void TransformSystem::SetLocalRotation(Entity e, const mathfu::quat& rotation) {
   auto node = nodes_.Get(e);
   if (node) {
     node->local_sqt.rotation = rotation;
-    RecalculateWorldFromEntityMatrix(e);
+    OnLocalTransformChanged(e);
   }
 }
 
@@ -479,7 +602,7 @@ void TransformSystem::SetLocalScale(Entity e, const mathfu::vec3& scale) {
   auto node = nodes_.Get(e);
   if (node) {
     node->local_sqt.scale = scale;
-    RecalculateWorldFromEntityMatrix(e);
+    OnLocalTransformChanged(e);
   }
 }
 
@@ -495,6 +618,12 @@ void TransformSystem::SetWorldFromEntityMatrix(
     return;
   }
 
+  // The local sqt is derived from the parent's world transform, so make sure
+  // it is not stale.
+  if (deferred_updates_) {
+    UpdateDirtyAncestors(node->parent);
+  }
+
   mathfu::mat4* world_from_parent_mat = nullptr;
   auto parent = GetWorldTransform(node->parent);
   if (parent) {
@@ -503,7 +632,7 @@ void TransformSystem::SetWorldFromEntityMatrix(
   node->local_sqt =
       node->local_sqt_function(world_from_entity_mat, world_from_parent_mat);
 
-  RecalculateWorldFromEntityMatrix(e);
+  OnLocalTransformChanged(e);
 }
 
 const mathfu::mat4* TransformSystem::GetWorldFromEntityMatrix(Entity e) const {
@@ -537,7 +666,7 @@ void TransformSystem::SetWorldFromEntityMatrixFunction(
           };
     }
 #endif
-    RecalculateWorldFromEntityMatrix(e);
+    OnLocalTransformChanged(e);
   }
 }
 
@@ -588,6 +717,9 @@ bool TransformSystem::AddChildNoEvent(Entity parent, Entity child,
   }
   const mathfu::mat4* matrix_ptr = nullptr;
   if (mode == ModifyParentChildMode::kPreserveWorldToEntityTransform) {
+    if (deferred_updates_) {
+      UpdateDirtyAncestors(child);
+    }
     matrix_ptr = GetWorldFromEntityMatrix(child);
     if (!matrix_ptr) {
       LOG(DFATAL) << "No world from entity matrix to keep.";
@@ -602,6 +734,7 @@ bool TransformSystem::AddChildNoEvent(Entity parent, Entity child,
 
   parent_node->children.emplace_back(child);
   child_node->parent = parent;
+  InvalidatePackedTransforms();
   if (mode == ModifyParentChildMode::kPreserveWorldToEntityTransform) {
     // This will call RecalculateWorldFromEntityMatrix().
     SetWorldFromEntityMatrix(child, *matrix_ptr);
@@ -720,6 +853,7 @@ void TransformSystem::RemoveParentNoEvent(Entity child) {
           parent_node->children.end());
     }
     child_node->parent = kNullEntity;
+    InvalidatePackedTransforms();
   }
 }
 
@@ -733,6 +867,10 @@ void TransformSystem::RemoveParent(Entity child, ModifyParentChildMode mode) {
   if (parent == kNullEntity) {
     return;
   }
+  if (deferred_updates_ &&
+      mode == ModifyParentChildMode::kPreserveWorldToEntityTransform) {
+    UpdateDirtyAncestors(child);
+  }
   RemoveParentNoEvent(child);
 
   if (mode == ModifyParentChildMode::kPreserveParentToEntityTransform) {
@@ -833,20 +971,229 @@ Sqt TransformSystem::CalculateLocalSqt(
 }
 
 void TransformSystem::RecalculateWorldFromEntityMatrix(Entity child) {
-  const auto* node = nodes_.Get(child);
+  auto* node = nodes_.Get(child);
   auto* world_transform = GetWorldTransform(child);
   if (!node || !world_transform) {
     return;
   }
 
+  node->dirty = false;
   world_transform->world_from_entity_mat =
       node->world_from_entity_matrix_function(
           node->local_sqt, GetWorldFromEntityMatrix(node->parent));
+  const uint32_t index = GetPackedIndex(world_transform);
+  if (index != kInvalidPackedIndex) {
+    packed_.At<kPackedWorldFromEntityMatrix>(index) =
+        world_transform->world_from_entity_mat;
+    packed_.At<kPackedBoundingSphereStale>(index) = 1;
+  }
+  RecordChange(child, world_transform->flags);
   for (const auto& grand_child : node->children) {
     RecalculateWorldFromEntityMatrix(grand_child);
   }
 }
 
+void TransformSystem::OnLocalTransformChanged(Entity e) {
+  if (!deferred_updates_) {
+    RecalculateWorldFromEntityMatrix(e);
+    return;
+  }
+
+  auto* node = nodes_.Get(e);
+  if (node && !node->dirty) {
+    node->dirty = true;
+    dirty_entities_.emplace_back(e);
+  }
+}
+
+void TransformSystem::UpdateDirtyAncestors(Entity e) {
+  Entity top_most_dirty = kNullEntity;
+  const auto* node = nodes_.Get(e);
+  while (node) {
+    if (node->dirty) {
+      top_most_dirty = e;
+    }
+    e = node->parent;
+    node = nodes_.Get(e);
+  }
+  if (top_most_dirty != kNullEntity) {
+    RecalculateWorldFromEntityMatrix(top_most_dirty);
+  }
+}
+
+bool TransformSystem::HasDirtyAncestor(Entity e) const {
+  const auto* node = nodes_.Get(e);
+  while (node && node->parent != kNullEntity) {
+    node = nodes_.Get(node->parent);
+    if (node && node->dirty) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void TransformSystem::SetDeferredUpdates(bool deferred) {
+  if (deferred_updates_ && !deferred) {
+    Flush();
+  }
+  deferred_updates_ = deferred;
+}
+
+void TransformSystem::Flush() {
+  if (dirty_entities_.empty()) {
+    return;
+  }
+
+  // If a large portion of the transforms are dirty, a single streaming pass in
+  // hierarchy order is cheaper than chasing each dirty subtree.
+  if (!registry_->Get<JobProcessor>() &&
+      dirty_entities_.size() * kMaxDirtyRatioForSubtreeFlush >=
+          nodes_.Size() &&
+      UpdatePackedTransforms()) {
+    FlushPacked();
+    return;
+  }
+
+  // Only the top-most dirty entity of each hierarchy needs to be recalculated
+  // since the recalculation recurses through all of its descendants.  The
+  // resulting roots are all independent of each other.
+  dirty_roots_.clear();
+  for (const Entity e : dirty_entities_) {
+    const auto* node = nodes_.Get(e);
+    if (node && node->dirty && !HasDirtyAncestor(e)) {
+      dirty_roots_.emplace_back(e);
+    }
+  }
+  dirty_entities_.clear();
+
+  const size_t num_roots = dirty_roots_.size();
+#if !LULLABY_USE_JAVASCRIPT_TIMERS
+  auto* job_processor = registry_->Get<JobProcessor>();
+  if (job_processor && num_roots >= 2 * kMinDirtyRootsPerJob) {
+    const size_t num_jobs =
+        std::min(kMaxFlushJobs, num_roots / kMinDirtyRootsPerJob);
+    const size_t roots_per_job = (num_roots + num_jobs - 1) / num_jobs;
+
+    // Dispatch all but the first batch to the worker threads, and process the
+    // first batch on this thread while waiting.
+    std::vector<JobProcessor::JobHandle> jobs;
+    jobs.reserve(num_jobs - 1);
+    for (size_t begin = roots_per_job; begin < num_roots;
+         begin += roots_per_job) {
+      const size_t end = std::min(begin + roots_per_job, num_roots);
+      jobs.emplace_back(job_processor->Run([this, begin, end]() {
+        for (size_t i = begin; i < end; ++i) {
+          RecalculateWorldFromEntityMatrix(dirty_roots_[i]);
+        }
+      }));
+    }
+    for (size_t i = 0; i < roots_per_job; ++i) {
+      RecalculateWorldFromEntityMatrix(dirty_roots_[i]);
+    }
+    for (const auto& job : jobs) {
+      job_processor->Wait(job);
+    }
+    return;
+  }
+#endif
+  for (const Entity root : dirty_roots_) {
+    RecalculateWorldFromEntityMatrix(root);
+  }
+}
+
+void TransformSystem::FlushPacked() {
+  const size_t count = packed_.Size();
+  packed_dirty_marks_.assign(count, 0);
+  for (const Entity e : dirty_entities_) {
+    const auto* node = nodes_.Get(e);
+    const auto* transform = GetWorldTransform(e);
+    if (node && node->dirty && transform && transform->packed_index < count) {
+      packed_dirty_marks_[transform->packed_index] = 1;
+    }
+  }
+  dirty_entities_.clear();
+
+  // Since parents always precede their children, a transform needs to be
+  // recalculated if it or its parent has been marked.
+  const Entity* entities = packed_.Data<kPackedEntity>();
+  const uint32_t* parents = packed_.Data<kPackedParentIndex>();
+  mathfu::mat4* matrices = packed_.Data<kPackedWorldFromEntityMatrix>();
+  uint8_t* spheres_stale = packed_.Data<kPackedBoundingSphereStale>();
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t parent = parents[i];
+    const bool is_root = parent == kInvalidPackedIndex;
+    if (!packed_dirty_marks_[i] && (is_root || !packed_dirty_marks_[parent])) {
+      continue;
+    }
+    packed_dirty_marks_[i] = 1;
+
+    auto* node = nodes_.Get(entities[i]);
+    auto* transform = GetWorldTransform(entities[i]);
+    node->dirty = false;
+    transform->world_from_entity_mat = node->world_from_entity_matrix_function(
+        node->local_sqt, is_root ? nullptr : &matrices[parent]);
+    matrices[i] = transform->world_from_entity_mat;
+    spheres_stale[i] = 1;
+    RecordChange(entities[i], transform->flags);
+  }
+}
+
+mathfu::vec4 TransformSystem::CalculateBoundingSphere(
+    const mathfu::mat4& world_from_entity_mat, const Aabb& box) {
+  const float radius = (box.max - box.min).Length() * 0.5f;
+  const mathfu::vec3 center =
+      world_from_entity_mat * mathfu::vec3::Lerp(box.min, box.max, 0.5f);
+  return mathfu::vec4(center, radius);
+}
+
+uint32_t TransformSystem::GetPackedIndex(
+    const WorldTransform* transform) const {
+  return packed_dirty_ ? kInvalidPackedIndex : transform->packed_index;
+}
+
+bool TransformSystem::UpdatePackedTransforms() const {
+  if (!packed_dirty_) {
+    return true;
+  }
+  if (packed_iteration_depth_ > 0) {
+    return false;
+  }
+
+  auto append = [this](Entity e, uint32_t parent_index) {
+    const WorldTransform* transform = world_transforms_.Get(e);
+    const uint8_t enabled = transform ? 1 : 0;
+    if (!transform) {
+      transform = disabled_transforms_.Get(e);
+      if (!transform) {
+        return;
+      }
+    }
+    transform->packed_index = static_cast<uint32_t>(packed_.Size());
+    packed_.Push(e, parent_index, enabled, transform->flags,
+                 transform->world_from_entity_mat, transform->box,
+                 mathfu::kZeros4f, static_cast<uint8_t>(1));
+  };
+
+  // Add all the roots first, and then add the children of each packed entry in
+  // order, which results in a breadth-first, depth-sorted layout.
+  packed_.Resize(0);
+  packed_.Reserve(nodes_.Size());
+  for (const auto& node : nodes_) {
+    if (node.parent == kNullEntity) {
+      append(node.GetEntity(), kInvalidPackedIndex);
+    }
+  }
+  for (size_t i = 0; i < packed_.Size(); ++i) {
+    const GraphNode* node = nodes_.Get(packed_.At<kPackedEntity>(i));
+    for (const Entity child : node->children) {
+      append(child, static_cast<uint32_t>(i));
+    }
+  }
+
+  packed_dirty_ = false;
+  return true;
+}
+
 void TransformSystem::SetEnabled(Entity e, bool enabled) {
   auto node = nodes_.Get(e);
   if (node && node->enable_self != enabled) {
@@ -868,6 +1215,11 @@ void TransformSystem::UpdateEnabled(Entity e, bool parent_enabled) {
   if (transform) {
     if (!enabled || !parent_enabled) {
       changed = true;
+      const uint32_t index = GetPackedIndex(transform);
+      if (index != kInvalidPackedIndex) {
+        packed_.At<kPackedEnabled>(index) = 0;
+      }
+      RecordChange(e, transform->flags);
       disabled_transforms_.Emplace(std::move(*transform));
       world_transforms_.Destroy(e);
       SendEvent(registry_, e, OnDisabledEvent(e));
@@ -877,6 +1229,11 @@ void TransformSystem::UpdateEnabled(Entity e, bool parent_enabled) {
     if (transform) {
       if (enabled && parent_enabled) {
         changed = true;
+        const uint32_t index = GetPackedIndex(transform);
+        if (index != kInvalidPackedIndex) {
+          packed_.At<kPackedEnabled>(index) = 1;
+        }
+        RecordChange(e, transform->flags);
         world_transforms_.Emplace(std::move(*transform));
         disabled_transforms_.Destroy(e);
         SendEvent(registry_, e, OnEnabledEvent(e));
@@ -929,6 +1286,59 @@ void TransformSystem::ReleaseFlag(TransformFlags flag) {
   reserved_flags_ = ClearBit(reserved_flags_, flag);
 }
 
+void TransformSystem::TrackChanges(TransformFlags flag) {
+  if (flag == kInvalidFlag || CheckBit(tracked_flags_, flag)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(change_records_mutex_);
+  tracked_flags_ = SetBit(tracked_flags_, flag);
+  change_records_.push_back({flag, {}});
+}
+
+void TransformSystem::UntrackChanges(TransformFlags flag) {
+  std::lock_guard<std::mutex> lock(change_records_mutex_);
+  tracked_flags_ = ClearBit(tracked_flags_, flag);
+  change_records_.erase(
+      std::remove_if(change_records_.begin(), change_records_.end(),
+                     [flag](const ChangeRecord& record) {
+                       return record.flag == flag;
+                     }),
+      change_records_.end());
+}
+
+void TransformSystem::TakeChangedEntities(TransformFlags flag,
+                                          std::vector<Entity>* entities) {
+  std::lock_guard<std::mutex> lock(change_records_mutex_);
+  for (auto& record : change_records_) {
+    if (record.flag == flag) {
+      entities->insert(entities->end(), record.entities.begin(),
+                       record.entities.end());
+      record.entities.clear();
+      return;
+    }
+  }
+}
+
+void TransformSystem::TakeUniqueChangedEntities(
+    TransformFlags flag, std::vector<Entity>* entities) {
+  TakeChangedEntities(flag, entities);
+  std::sort(entities->begin(), entities->end());
+  entities->erase(std::unique(entities->begin(), entities->end()),
+                  entities->end());
+}
+
+void TransformSystem::RecordChange(Entity e, Bits flags) {
+  if ((flags & tracked_flags_) == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(change_records_mutex_);
+  for (auto& record : change_records_) {
+    if (CheckBit(flags, record.flag)) {
+      record.entities.emplace_back(e);
+    }
+  }
+}
+
 std::string TransformSystem::GetEntityTreeDebugString(bool enabled_only) const {
   const auto& blueprints =
       registry_->Get<EntityFactory>()->GetEntityToBlueprintMap();
@@ -17,10 +17,14 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_TRANSFORM_TRANSFORM_SYSTEM_H_
 #define LULLABY_SYSTEMS_TRANSFORM_TRANSFORM_SYSTEM_H_
 
+#include <mutex>
+#include <vector>
+
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/util/bits.h"
 #include "lullaby/util/math.h"
+#include "lullaby/util/structure_of_arrays.h"
 #include "mathfu/constants.h"
 #include "mathfu/glsl_mappings.h"
 
@@ -73,12 +77,21 @@ class TransformSystem : public System {
   /// sets sqt.
   void Create(Entity e, const Sqt& sqt);
 
+  /// Adds transforms to all the |entities|, reserving storage for them first.
+  void CreateMany(Span<Entity> entities, const Blueprint& blueprint) override;
+
+  /// Resets the transform of a pooled Entity to the data in |blueprint|.
+  bool ResetComponent(Entity e, const Blueprint& blueprint) override;
+
   /// Performs post creation initialization.
   void PostCreateInit(Entity e, HashValue type, const Def* def) override;
 
   /// Removes the transform from the Entity.
   void Destroy(Entity e) override;
 
+  size_t GetNumComponents() const override;
+  size_t GetComponentMemoryUsage() const override;
+
   /// Sets the specified transform to be included when calling foreach with the
   /// provided flag.
   void SetFlag(Entity e, TransformFlags flag);
@@ -236,14 +249,58 @@ class TransformSystem : public System {
   /// kInvalidFlag.
   void ReleaseFlag(TransformFlags flag);
 
+  /// Starts recording every entity with |flag| whose world transform, aabb or
+  /// enabled state changes, as well as every entity that gains or loses
+  /// |flag|.  This allows systems to incrementally maintain their own data
+  /// (eg. spatial acceleration structures) instead of iterating through all
+  /// transforms.
+  void TrackChanges(TransformFlags flag);
+
+  /// Stops recording changes for |flag|.
+  void UntrackChanges(TransformFlags flag);
+
+  /// Appends all the entities recorded for |flag| since the last call to
+  /// |entities| and clears the record.  An entity may be reported more than
+  /// once, and may have been destroyed since it was recorded.
+  void TakeChangedEntities(TransformFlags flag, std::vector<Entity>* entities);
+
+  /// Same as TakeChangedEntities(), but then sorts |entities| and removes
+  /// duplicates from it, so that each entity is only reported once.
+  void TakeUniqueChangedEntities(TransformFlags flag,
+                                 std::vector<Entity>* entities);
+
   /// Calls the provided function with every Transform and provides the
   /// TransformFlags.
+  ///
+  /// Transforms are visited in hierarchy-depth order (ie. parents before their
+  /// children) by streaming through the packed transform arrays.  Although
+  /// const, this rebuilds the packed arrays if the hierarchy has changed, so it
+  /// must not be called concurrently with other TransformSystem functions.
   template <typename Fn>
   void ForAll(Fn fn) const {
-    world_transforms_.ForEach([&](const WorldTransform& transform) {
-      fn(transform.GetEntity(), transform.world_from_entity_mat, transform.box,
-         transform.flags);
-    });
+    if (!UpdatePackedTransforms()) {
+      // The packed arrays cannot be rebuilt while they are being iterated, so
+      // fall back to the component pool for nested calls.
+      world_transforms_.ForEach([&](const WorldTransform& transform) {
+        fn(transform.GetEntity(), transform.world_from_entity_mat,
+           transform.box, transform.flags);
+      });
+      return;
+    }
+
+    ++packed_iteration_depth_;
+    const size_t count = packed_.Size();
+    const Entity* entities = packed_.Data<kPackedEntity>();
+    const uint8_t* enabled = packed_.Data<kPackedEnabled>();
+    const Bits* flags = packed_.Data<kPackedFlags>();
+    const mathfu::mat4* matrices = packed_.Data<kPackedWorldFromEntityMatrix>();
+    const Aabb* boxes = packed_.Data<kPackedAabb>();
+    for (size_t i = 0; i < count; ++i) {
+      if (enabled[i]) {
+        fn(entities[i], matrices[i], boxes[i], flags[i]);
+      }
+    }
+    --packed_iteration_depth_;
   }
 
   /// Calls the provided function with a Transform for every Entity which has
@@ -271,6 +328,43 @@ class TransformSystem : public System {
     }
   }
 
+  /// Like ForEach(), but also provides the world space bounding sphere of each
+  /// entity's aabb, with the center in xyz and the radius in w.  The spheres
+  /// are cached, and are only recomputed after the entity's world transform or
+  /// aabb changes.
+  template <typename Fn>
+  void ForEachWithBoundingSphere(TransformFlags flag, Fn fn) const {
+    if (!UpdatePackedTransforms()) {
+      ForEach(flag, [&](Entity e, const mathfu::mat4& world_from_entity_mat,
+                        const Aabb& box) {
+        fn(e, world_from_entity_mat, box,
+           CalculateBoundingSphere(world_from_entity_mat, box));
+      });
+      return;
+    }
+
+    ++packed_iteration_depth_;
+    const size_t count = packed_.Size();
+    const Entity* entities = packed_.Data<kPackedEntity>();
+    const uint8_t* enabled = packed_.Data<kPackedEnabled>();
+    const Bits* flags = packed_.Data<kPackedFlags>();
+    const mathfu::mat4* matrices = packed_.Data<kPackedWorldFromEntityMatrix>();
+    const Aabb* boxes = packed_.Data<kPackedAabb>();
+    mathfu::vec4* spheres = packed_.Data<kPackedBoundingSphere>();
+    uint8_t* stale = packed_.Data<kPackedBoundingSphereStale>();
+    for (size_t i = 0; i < count; ++i) {
+      if (!enabled[i] || (flag != kAllFlags && !CheckBit(flags[i], flag))) {
+        continue;
+      }
+      if (stale[i]) {
+        spheres[i] = CalculateBoundingSphere(matrices[i], boxes[i]);
+        stale[i] = 0;
+      }
+      fn(entities[i], matrices[i], boxes[i], spheres[i]);
+    }
+    --packed_iteration_depth_;
+  }
+
   /// Calls the provided function on the provided entity and all of it's
   /// descendants.
   template <typename Fn>
@@ -293,6 +387,24 @@ class TransformSystem : public System {
   // all of its children. Potentially expensive, so should be called sparingly.
   void RecalculateWorldFromEntityMatrix(Entity child);
 
+  /// Controls whether changes to an entity's local transform are immediately
+  /// propagated to the world transforms of the entity and all its descendants
+  /// (the default), or whether the entity is just marked dirty until the next
+  /// call to Flush().  Deferring is useful when the same hierarchy is modified
+  /// several times in a single frame.  Turning deferred updates off will flush
+  /// any pending changes.
+  void SetDeferredUpdates(bool deferred);
+
+  /// Returns true if world transform updates are deferred until Flush().
+  bool AreUpdatesDeferred() const { return deferred_updates_; }
+
+  /// Recalculates the world transforms of all entities that were marked dirty
+  /// since the last Flush().  Each dirty subtree is only visited once.  If a
+  /// JobProcessor is available in the Registry, independent subtrees are
+  /// processed on its worker threads, so any custom
+  /// CalculateWorldFromEntityMatrixFunc must be safe to call concurrently.
+  void Flush();
+
   // Calculates the world_from_entity_matrix for the given local sqt and
   // world_from_parent_matrix.
   static mathfu::mat4 CalculateWorldFromEntityMatrix(
@@ -304,7 +416,8 @@ class TransformSystem : public System {
         : Component(e),
           local_sqt(mathfu::kZeros3f, mathfu::quat::identity, mathfu::kOnes3f),
           parent(kNullEntity),
-          enable_self(true) {}
+          enable_self(true),
+          dirty(false) {}
 
     Sqt local_sqt;
     Aabb aabb_padding;
@@ -313,17 +426,66 @@ class TransformSystem : public System {
     std::vector<Entity> children;
     Entity parent;
     bool enable_self;
+    // Set when the world transform needs to be recalculated by Flush().
+    bool dirty;
   };
 
   struct WorldTransform : Component {
     // This struct should be kept as small as possible to reduce cache misses
     // when iterating.
-    explicit WorldTransform(Entity e) : Component(e), flags(0) {}
+    explicit WorldTransform(Entity e)
+        : Component(e), flags(0), packed_index(kInvalidPackedIndex) {}
     Bits flags;
+    // Index of this transform in the packed arrays.  Mutable since the arrays
+    // are rebuilt by const queries (see |packed_|).
+    mutable uint32_t packed_index;
     mathfu::mat4 world_from_entity_mat;
     Aabb box;
   };
 
+  // Packed copies of the per-transform data that is streamed through by
+  // ForAll() and Flush().  Entries are sorted by hierarchy depth so parents
+  // always precede their children.  The arrays are rebuilt lazily whenever
+  // the hierarchy changes, and are otherwise kept up-to-date by writing
+  // through any changes to the matrices, flags and aabbs.
+  enum PackedArray {
+    kPackedEntity,
+    kPackedParentIndex,
+    kPackedEnabled,
+    kPackedFlags,
+    kPackedWorldFromEntityMatrix,
+    kPackedAabb,
+    // Cached by ForEachWithBoundingSphere(), which recomputes the sphere if it
+    // has been marked as stale by a change to the matrix or aabb.
+    kPackedBoundingSphere,
+    kPackedBoundingSphereStale,
+  };
+  using PackedTransforms =
+      StructureOfArrays<Entity, uint32_t, uint8_t, Bits, mathfu::mat4, Aabb,
+                        mathfu::vec4, uint8_t>;
+  static const uint32_t kInvalidPackedIndex;
+
+  // Rebuilds the packed arrays if the hierarchy has changed.  Returns false if
+  // the arrays are out-of-date but cannot be rebuilt because they are being
+  // iterated.
+  bool UpdatePackedTransforms() const;
+
+  // Returns the world space bounding sphere of |box| transformed by
+  // |world_from_entity_mat|.
+  static mathfu::vec4 CalculateBoundingSphere(
+      const mathfu::mat4& world_from_entity_mat, const Aabb& box);
+
+  // Marks the packed arrays as needing to be rebuilt.
+  void InvalidatePackedTransforms() { packed_dirty_ = true; }
+
+  // Returns the index of |transform| in the packed arrays, or
+  // kInvalidPackedIndex if the packed arrays are out-of-date.
+  uint32_t GetPackedIndex(const WorldTransform* transform) const;
+
+  // Recalculates the world transforms of all dirty entities with a single pass
+  // over the packed arrays.
+  void FlushPacked();
+
   static Sqt CalculateLocalSqt(const mathfu::mat4& world_from_entity_mat,
                                const mathfu::mat4* world_from_parent_mat);
   void SetEnabled(Entity e, bool enabled);
@@ -331,6 +493,21 @@ class TransformSystem : public System {
   const WorldTransform* GetWorldTransform(Entity e) const;
   WorldTransform* GetWorldTransform(Entity e);
 
+  // Either recalculates the world transforms of |e| and its descendants, or
+  // marks |e| as dirty if updates are deferred.
+  void OnLocalTransformChanged(Entity e);
+
+  // Recalculates the world transform of the top-most dirty entity in the
+  // parent chain of |e| (including |e| itself) so that the world transform of
+  // |e| is up-to-date.
+  void UpdateDirtyAncestors(Entity e);
+
+  // Returns true if any ancestor of |e| is waiting to be flushed.
+  bool HasDirtyAncestor(Entity e) const;
+
+  // Records |e| for every tracked flag set in |flags|.
+  void RecordChange(Entity e, Bits flags);
+
   // Break a child's connection to its parent without sending any events.
   void RemoveParentNoEvent(Entity child);
 
@@ -343,6 +520,30 @@ class TransformSystem : public System {
   ComponentPool<WorldTransform> disabled_transforms_;
   uint32_t reserved_flags_;
 
+  // Entities whose local transforms were modified while updates are deferred.
+  std::vector<Entity> dirty_entities_;
+  std::vector<Entity> dirty_roots_;
+  bool deferred_updates_;
+
+  // Entities that changed for each flag passed to TrackChanges().  The mutex
+  // guards the records since Flush() may modify transforms on several threads.
+  struct ChangeRecord {
+    TransformFlags flag;
+    std::vector<Entity> entities;
+  };
+  std::vector<ChangeRecord> change_records_;
+  TransformFlags tracked_flags_;
+  std::mutex change_records_mutex_;
+
+  // The packed arrays are a cache of state owned by the component pools, so
+  // they are mutable to let const queries such as ForAll() rebuild them (and
+  // refresh the cached bounding spheres) on demand.  As a result, const
+  // queries must not be called concurrently with each other either.
+  mutable PackedTransforms packed_;
+  mutable bool packed_dirty_;
+  mutable int packed_iteration_depth_;
+  std::vector<uint8_t> packed_dirty_marks_;
+
   // A map of parent/child relationships requested by CreateChild, which need to
   // be handled during Create().
   std::unordered_map<Entity, Entity> pending_children_;
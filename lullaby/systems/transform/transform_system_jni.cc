@@ -15,6 +15,78 @@ limitations under the License.
 */
 
 #include "lullaby/modules/ecs/entity_factory_jni.h"
+#include "lullaby/systems/transform/sqt_batch.h"
 #include "lullaby/systems/transform/transform_system.h"
 
 LULLABY_JNI_CREATE_SYSTEM(TransformSystem, nativeCreate)
+
+namespace {
+
+// Returns the records in the direct |jbuffer|, or null if |jbuffer| is not a
+// direct buffer or is too small to hold |count| records.  The buffers passed to
+// the batch functions below hold SqtRecords in the native byte order.
+lull::SqtRecord* GetSqtRecords(JNIEnv* env, jobject jbuffer, jint count) {
+  if (count <= 0) {
+    return nullptr;
+  }
+  void* address = env->GetDirectBufferAddress(jbuffer);
+  const jlong capacity = env->GetDirectBufferCapacity(jbuffer);
+  if (address == nullptr || capacity < 0) {
+    LOG(DFATAL) << "Transform batches require a direct ByteBuffer.";
+    return nullptr;
+  }
+  if (static_cast<size_t>(capacity) <
+      static_cast<size_t>(count) * sizeof(lull::SqtRecord)) {
+    LOG(DFATAL) << "ByteBuffer too small for " << count << " transforms.";
+    return nullptr;
+  }
+  return static_cast<lull::SqtRecord*>(address);
+}
+
+lull::TransformSystem* GetTransformSystem(jlong native_registry_handle) {
+  auto registry = lull::GetRegistryFromJni(native_registry_handle);
+  if (!registry) {
+    return nullptr;
+  }
+  auto* transform_system = registry->Get<lull::TransformSystem>();
+  if (!transform_system) {
+    LOG(DFATAL) << "No TransformSystem.";
+  }
+  return transform_system;
+}
+
+}  // namespace
+
+extern "C" {
+
+// Sets the local Sqt of each entity in the first |count| records of |jbuffer|.
+LULLABY_JNI_FN(void, TransformSystem, nativeSetSqtBatch)
+(JNIEnv* env, jobject obj, jlong native_registry_handle, jobject jbuffer,
+ jint count) {
+  auto* transform_system = GetTransformSystem(native_registry_handle);
+  const lull::SqtRecord* records = GetSqtRecords(env, jbuffer, count);
+  if (!transform_system || !records) {
+    return;
+  }
+
+  lull::SetSqtBatch(transform_system,
+                    lull::Span<lull::SqtRecord>(records, count));
+}
+
+// Fills in the local Sqt of each entity in the first |count| records of
+// |jbuffer|. Records of entities without a transform are left unchanged.
+// Returns the number of records that were filled in.
+LULLABY_JNI_FN(jint, TransformSystem, nativeGetSqtBatch)
+(JNIEnv* env, jobject obj, jlong native_registry_handle, jobject jbuffer,
+ jint count) {
+  auto* transform_system = GetTransformSystem(native_registry_handle);
+  lull::SqtRecord* records = GetSqtRecords(env, jbuffer, count);
+  if (!transform_system || !records) {
+    return 0;
+  }
+
+  return static_cast<jint>(lull::GetSqtBatch(
+      transform_system, lull::MutableSpan<lull::SqtRecord>(records, count)));
+}
+
+}  // extern "C"
@@ -0,0 +1,162 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/animated_texture_processor.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lullaby/modules/render/image_data.h"
+#include "lullaby/modules/render/image_decode.h"
+#include "lullaby/systems/render/testing/texture.h"
+#include "lullaby/systems/render/texture_factory.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+constexpr Clock::duration kFrameDuration = std::chrono::milliseconds(100);
+
+// Decodes 1x1 frames whose pixels hold the frame number.
+class FakeAnimatedImage : public AnimatedImage {
+ public:
+  explicit FakeAnimatedImage(std::atomic<int>* num_decoded)
+      : num_decoded_(num_decoded) {}
+
+  ImageData DecodeNextFrame() override {
+    for (uint8_t& byte : pixel_) {
+      byte = static_cast<uint8_t>(next_frame_);
+    }
+    ++next_frame_;
+    ++(*num_decoded_);
+    return GetCurrentFrame();
+  }
+
+  ImageData GetCurrentFrame() override {
+    return ImageData(ImageData::kRgba8888, mathfu::vec2i(1, 1),
+                     DataContainer::WrapDataAsReadOnly(pixel_, sizeof(pixel_)));
+  }
+
+  std::size_t GetFrameSize() override { return sizeof(pixel_); }
+
+  Clock::duration GetCurrentFrameDuration() override { return kFrameDuration; }
+
+ private:
+  std::atomic<int>* num_decoded_;
+  int next_frame_ = 0;
+  uint8_t pixel_[4] = {0, 0, 0, 0};
+};
+
+// Records the frame number of every texture update.
+class FakeTextureFactory : public TextureFactory {
+ public:
+  TexturePtr GetWhiteTexture() const override { return nullptr; }
+  TexturePtr GetInvalidTexture() const override { return nullptr; }
+  void CacheTexture(HashValue name, const TexturePtr& texture) override {}
+  TexturePtr GetTexture(HashValue name) const override { return nullptr; }
+  void ReleaseTexture(HashValue name) override {}
+  TexturePtr CreateTexture(ImageData image,
+                           const TextureParams& params) override {
+    return nullptr;
+  }
+  TexturePtr CreateTexture(HashValue name, ImageData image,
+                           const TextureParams& params) override {
+    return nullptr;
+  }
+  TexturePtr LoadTexture(string_view filename,
+                         const TextureParams& params) override {
+    return nullptr;
+  }
+  void LoadAtlas(const std::string& filename,
+                 const TextureParams& params) override {}
+  TexturePtr CreateExternalTexture(const mathfu::vec2i& size) override {
+    return nullptr;
+  }
+  bool UpdateTexture(TexturePtr texture, ImageData image) override {
+    uploaded_frames.push_back(image.GetBytes()[0]);
+    return true;
+  }
+  TexturePtr CreateTextureDeprecated(const ImageData* image,
+                                     const TextureParams& params) override {
+    return nullptr;
+  }
+
+  std::vector<int> uploaded_frames;
+};
+
+class AnimatedTextureProcessorTest : public ::testing::Test {
+ public:
+  AnimatedTextureProcessorTest() {
+    texture_factory_ = new FakeTextureFactory();
+    registry_.Register(std::unique_ptr<TextureFactory>(texture_factory_));
+  }
+
+ protected:
+  // Advances the processor without moving its time line until the decoder has
+  // been asked for |num_frames| frames.  Every frame but the last one is then
+  // ready to be uploaded.
+  void WaitForDecodes(AnimatedTextureProcessor* processor, int num_frames) {
+    while (num_decoded_ < num_frames) {
+      processor->OnAdvanceFrame(Clock::duration(0));
+      std::this_thread::yield();
+    }
+  }
+
+  Registry registry_;
+  FakeTextureFactory* texture_factory_ = nullptr;
+  std::atomic<int> num_decoded_{0};
+};
+
+TEST_F(AnimatedTextureProcessorTest, UploadsNewestDueFrame) {
+  AnimatedTextureProcessor processor(&registry_, /* num_worker_threads = */ 1,
+                                     /* num_lookahead_frames = */ 3);
+  TexturePtr texture = std::make_shared<Texture>();
+  processor.Animate(texture, AnimatedImagePtr(
+                                 new FakeAnimatedImage(&num_decoded_)));
+
+  WaitForDecodes(&processor, 2);
+  processor.OnAdvanceFrame(Clock::duration(0));
+  EXPECT_EQ(texture_factory_->uploaded_frames, std::vector<int>({0}));
+
+  // Uploading the first frame frees a slot in the ring for a fourth frame.
+  WaitForDecodes(&processor, 4);
+  EXPECT_EQ(texture_factory_->uploaded_frames, std::vector<int>({0}));
+
+  // Frames 1 and 2 are both due, so frame 1 is skipped.
+  processor.OnAdvanceFrame(kFrameDuration * 2 + kFrameDuration / 2);
+  EXPECT_EQ(texture_factory_->uploaded_frames, std::vector<int>({0, 2}));
+}
+
+TEST_F(AnimatedTextureProcessorTest, StopsUploadingReleasedTextures) {
+  AnimatedTextureProcessor processor(&registry_);
+  TexturePtr texture = std::make_shared<Texture>();
+  processor.Animate(texture, AnimatedImagePtr(
+                                 new FakeAnimatedImage(&num_decoded_)));
+
+  WaitForDecodes(&processor, 2);
+  processor.OnAdvanceFrame(Clock::duration(0));
+  EXPECT_EQ(texture_factory_->uploaded_frames, std::vector<int>({0}));
+
+  texture.reset();
+  processor.OnAdvanceFrame(kFrameDuration * 10);
+  EXPECT_EQ(texture_factory_->uploaded_frames, std::vector<int>({0}));
+}
+
+}  // namespace
+}  // namespace lull
@@ -21,6 +21,8 @@ limitations under the License.
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/tests/portable_test_macros.h"
+#include "lullaby/util/job_processor.h"
+#include "lullaby/generated/animation_def_generated.h"
 #include "lullaby/generated/transform_def_generated.h"
 
 namespace lull {
@@ -131,6 +133,102 @@ TEST_F(AnimationSystemTest, CreateWithDelay) {
   EXPECT_NEAR(sqt->scale.z, 30.f, kEpsilon);
 }
 
+TEST_F(AnimationSystemTest, AdvanceFrameWithJobProcessor) {
+  registry_->Create<JobProcessor>(4);
+
+  Blueprint blueprint(512);
+  {
+    TransformDefT transform;
+    transform.position = mathfu::vec3(0.f, 0.f, 0.f);
+    transform.rotation = mathfu::vec3(0.f, 0.f, 0.f);
+    transform.scale = mathfu::vec3(1.f, 1.f, 1.f);
+    blueprint.Write(&transform);
+  }
+
+  // Use enough animations for the channels to be evaluated on the workers.
+  static const int kNumEntities = 50;
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  auto animation_system = registry_->Get<AnimationSystem>();
+  std::vector<Entity> entities;
+  for (int i = 0; i < kNumEntities; ++i) {
+    const Entity entity = entity_factory->Create(&blueprint);
+    const mathfu::vec3 target_pos(static_cast<float>(i), 2.f, 3.f);
+    const mathfu::vec3 target_scale(10.f, static_cast<float>(i), 30.f);
+    animation_system->SetTarget(entity, PositionChannel::kChannelName,
+                                &target_pos.x, 3, std::chrono::seconds(1));
+    animation_system->SetTarget(entity, ScaleChannel::kChannelName,
+                                &target_scale.x, 3, std::chrono::seconds(1));
+    entities.push_back(entity);
+  }
+  animation_system->AdvanceFrame(std::chrono::seconds(1));
+
+  static const float kEpsilon = 0.001f;
+  auto transform_system = registry_->Get<TransformSystem>();
+  for (int i = 0; i < kNumEntities; ++i) {
+    const Sqt* sqt = transform_system->GetSqt(entities[i]);
+    ASSERT_NE(sqt, nullptr);
+    EXPECT_NEAR(sqt->translation.x, static_cast<float>(i), kEpsilon);
+    EXPECT_NEAR(sqt->translation.y, 2.f, kEpsilon);
+    EXPECT_NEAR(sqt->translation.z, 3.f, kEpsilon);
+    EXPECT_NEAR(sqt->scale.x, 10.f, kEpsilon);
+    EXPECT_NEAR(sqt->scale.y, static_cast<float>(i), kEpsilon);
+    EXPECT_NEAR(sqt->scale.z, 30.f, kEpsilon);
+  }
+}
+
+TEST_F(AnimationSystemTest, LodFreezesOffscreenEntities) {
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  auto animation_system = registry_->Get<AnimationSystem>();
+  auto transform_system = registry_->Get<TransformSystem>();
+
+  // The view looks down the -z axis from the origin.
+  RenderView view;
+  view.clip_from_eye_matrix =
+      mathfu::mat4::Perspective(kPi / 2.f, 1.f, 0.1f, 100.f);
+  view.clip_from_world_matrix = view.clip_from_eye_matrix;
+  animation_system->SetLodViews(&view, 1);
+
+  auto create_entity = [&](const mathfu::vec3& position) {
+    Blueprint blueprint(512);
+    TransformDefT transform;
+    transform.position = position;
+    transform.rotation = mathfu::vec3(0.f, 0.f, 0.f);
+    transform.scale = mathfu::vec3(1.f, 1.f, 1.f);
+    blueprint.Write(&transform);
+    AnimationLodDefT lod;
+    lod.freeze_when_offscreen = true;
+    blueprint.Write(&lod);
+    return entity_factory->Create(&blueprint);
+  };
+  const Entity visible = create_entity(mathfu::vec3(0.f, 0.f, -5.f));
+  const Entity offscreen = create_entity(mathfu::vec3(0.f, 0.f, 5.f));
+
+  const mathfu::vec3 offset(0.f, 1.f, 0.f);
+  for (const Entity entity : {visible, offscreen}) {
+    const mathfu::vec3 target =
+        transform_system->GetLocalTranslation(entity) + offset;
+    animation_system->SetTarget(entity, PositionChannel::kChannelName,
+                                &target.x, 3, std::chrono::seconds(2));
+  }
+  animation_system->AdvanceFrame(std::chrono::seconds(1));
+
+  static const float kEpsilon = 0.001f;
+  EXPECT_GT(transform_system->GetLocalTranslation(visible).y, kEpsilon);
+  EXPECT_NEAR(transform_system->GetLocalTranslation(offscreen).y, 0.f,
+              kEpsilon);
+
+  // Without LOD, the animation is applied immediately.
+  animation_system->ClearLodParams(offscreen);
+  animation_system->AdvanceFrame(std::chrono::milliseconds(500));
+  EXPECT_GT(transform_system->GetLocalTranslation(offscreen).y, kEpsilon);
+
+  // Completed animations always land on their final values.
+  animation_system->SetLodParams(offscreen, AnimationSystem::LodParams());
+  animation_system->AdvanceFrame(std::chrono::seconds(1));
+  EXPECT_NEAR(transform_system->GetLocalTranslation(offscreen).y, 1.f,
+              kEpsilon);
+}
+
 TEST(AnimationSystemDeathTest, SplitListFilenameAndIndex) {
   std::string filename;
   int index = 0;
@@ -14,7 +14,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
 
 #include "gtest/gtest.h"
 #include "lullaby/modules/file/asset_loader.h"
@@ -156,6 +160,56 @@ TEST(AssetLoader, SimpleAsset) {
   EXPECT_EQ(kDummyData, str);
 }
 
+TEST(AssetLoader, MappedAssetFallsBackToLoadFunction) {
+  AssetLoader loader(LoadFile);
+  auto asset = loader.LoadNow<MappedAsset>("filename.txt");
+
+  ASSERT_EQ(sizeof(kDummyData), asset->GetSize() + 1);
+  EXPECT_EQ(kDummyData,
+            std::string(static_cast<const char*>(asset->GetData()),
+                        asset->GetSize()));
+}
+
+TEST(AssetLoader, MappedAssetUsesMapFunction) {
+  AssetLoader loader(LoadFile);
+  int num_maps = 0;
+  loader.SetMapFunction([&](const char* filename) {
+    ++num_maps;
+    return MappedFile::FromString(kDummyData2);
+  });
+
+  auto mapped = loader.LoadNow<MappedAsset>("filename.txt");
+  EXPECT_EQ(1, num_maps);
+  EXPECT_EQ(kDummyData2,
+            std::string(static_cast<const char*>(mapped->GetData()),
+                        mapped->GetSize()));
+
+  // Assets that want their own copy of the data still use the load function.
+  auto simple = loader.LoadNow<SimpleAsset>("filename.txt");
+  EXPECT_EQ(1, num_maps);
+  EXPECT_EQ(kDummyData, simple->GetStringData());
+}
+
+TEST(AssetLoader, MappedAssetFromDisk) {
+  const std::string filename = ::testing::TempDir() + "mapped_asset_test.bin";
+  {
+    std::ofstream file(filename, std::ios::binary);
+    file << kDummyData2;
+  }
+
+  AssetLoader loader(LoadFileBad);
+  loader.SetMapFunction(
+      [](const char* filename) { return MappedFile::Map(filename); });
+  auto asset = loader.LoadAsync<MappedAsset>(filename);
+  while (loader.Finalize() != 0) {
+  }
+  std::remove(filename.c_str());
+
+  EXPECT_EQ(kDummyData2,
+            std::string(static_cast<const char*>(asset->GetData()),
+                        asset->GetSize()));
+}
+
 TEST(AssetLoader, SetFileLoader) {
   AssetLoader loader(LoadFile);
   auto asset1 = loader.LoadNow<TestAsset>("filename.txt");
@@ -223,6 +277,142 @@ TEST(AssetLoader, OnErrorCallback) {
   EXPECT_EQ(kErrorCode_NotFound, error_code);
 }
 
+// Records the order in which assets are finalized.
+struct OrderedTestAsset : public TestAsset {
+  explicit OrderedTestAsset(std::vector<std::string>* order) : order(order) {}
+
+  ErrorCode OnFinalizeWithError(const std::string& filename,
+                                std::string* data) override {
+    order->push_back(filename);
+    return TestAsset::OnFinalizeWithError(filename, data);
+  }
+
+  std::vector<std::string>* order;
+};
+
+TEST(AssetLoader, LoadAsyncPriority) {
+  AssetLoader loader(LoadFile);
+  loader.StopAsyncLoads();
+
+  std::vector<std::string> order;
+  AssetLoader::AsyncLoadOptions options;
+  const char* filenames[] = {"low.txt", "high.txt", "mid.txt", "raised.txt"};
+  const int priorities[] = {0, 2, 1, -1};
+  std::shared_ptr<OrderedTestAsset> assets[4];
+  for (int i = 0; i < 4; ++i) {
+    assets[i] = std::make_shared<OrderedTestAsset>(&order);
+    options.priority = priorities[i];
+    loader.LoadIntoAsync(filenames[i], assets[i], options);
+  }
+  EXPECT_TRUE(loader.SetLoadPriority(assets[3], 3));
+
+  loader.StartAsyncLoads();
+  while (loader.Finalize() != 0) {
+  }
+
+  const std::vector<std::string> expected = {"raised.txt", "high.txt",
+                                             "mid.txt", "low.txt"};
+  EXPECT_EQ(expected, order);
+  EXPECT_FALSE(loader.SetLoadPriority(assets[0], 1));
+}
+
+TEST(AssetLoader, CancelLoad) {
+  AssetLoader loader(LoadFile);
+  loader.StopAsyncLoads();
+
+  AssetLoader::AsyncLoadOptions options;
+  options.tag = Hash("group");
+  auto asset1 = std::make_shared<TestAsset>();
+  auto asset2 = std::make_shared<TestAsset>();
+  auto asset3 = std::make_shared<TestAsset>();
+  auto asset4 = std::make_shared<TestAsset>();
+  loader.LoadIntoAsync("1.txt", asset1);
+  loader.LoadIntoAsync("2.txt", asset2, options);
+  loader.LoadIntoAsync("3.txt", asset3, options);
+  loader.LoadIntoAsync("4.txt", asset4);
+
+  EXPECT_TRUE(loader.CancelLoad(asset1));
+  EXPECT_FALSE(loader.CancelLoad(asset1));
+  EXPECT_EQ(2, loader.CancelLoads(Hash("group")));
+  EXPECT_EQ(0, loader.CancelLoads(Hash("group")));
+
+  loader.StartAsyncLoads();
+  while (loader.Finalize() != 0) {
+  }
+
+  for (const auto& asset : {asset1, asset2, asset3}) {
+    EXPECT_EQ(kErrorCode_Cancelled, asset->error_callback);
+    EXPECT_EQ(2, static_cast<int>(asset->callbacks.size()));
+    EXPECT_EQ(TestAsset::kOnError, asset->callbacks[1]);
+  }
+  EXPECT_EQ(kErrorCode_Ok, asset4->error_callback);
+  EXPECT_EQ(kDummyData, asset4->on_final_data);
+}
+
+// Signals when it has been loaded on the worker thread.
+struct SignalingTestAsset : public TestAsset {
+  ErrorCode OnLoadWithError(const std::string& filename,
+                            std::string* data) override {
+    const ErrorCode result = TestAsset::OnLoadWithError(filename, data);
+    loaded = true;
+    return result;
+  }
+
+  std::atomic<bool> loaded{false};
+};
+
+TEST(AssetLoader, CancelLoadAfterLoad) {
+  AssetLoader loader(LoadFile);
+  auto asset = std::make_shared<SignalingTestAsset>();
+  loader.LoadIntoAsync("filename.txt", asset);
+
+  // Wait for the load to complete without finalizing it.
+  while (!asset->loaded) {
+    std::this_thread::yield();
+  }
+  loader.StopAsyncLoads();
+  EXPECT_TRUE(loader.CancelLoad(asset));
+  EXPECT_EQ(0, loader.Finalize());
+
+  EXPECT_EQ(3, static_cast<int>(asset->callbacks.size()));
+  EXPECT_EQ(TestAsset::kOnLoad, asset->callbacks[1]);
+  EXPECT_EQ(TestAsset::kOnError, asset->callbacks[2]);
+  EXPECT_EQ(kErrorCode_Cancelled, asset->error_callback);
+}
+
+TEST(AssetLoader, FinalizeTimeBudget) {
+  AssetLoader loader(LoadFile);
+  loader.StopAsyncLoads();
+  auto asset1 = std::make_shared<TestAsset>();
+  auto asset2 = std::make_shared<TestAsset>();
+  loader.LoadIntoAsync("1.txt", asset1);
+  loader.LoadIntoAsync("2.txt", asset2);
+  loader.StartAsyncLoads();
+
+  // A zero budget never finalizes anything.
+  EXPECT_EQ(2, loader.Finalize(Clock::duration::zero()));
+
+  while (loader.Finalize(std::chrono::milliseconds(10)) != 0) {
+  }
+  EXPECT_EQ(kDummyData, asset1->on_final_data);
+  EXPECT_EQ(kDummyData, asset2->on_final_data);
+}
+
+TEST(AssetLoader, SetNumAsyncLoadThreads) {
+  AssetLoader loader(LoadFile);
+  loader.SetNumAsyncLoadThreads(4);
+
+  std::vector<std::shared_ptr<TestAsset>> assets;
+  for (int i = 0; i < 16; ++i) {
+    assets.push_back(loader.LoadAsync<TestAsset>("filename.txt"));
+  }
+  while (loader.Finalize() != 0) {
+  }
+  for (const auto& asset : assets) {
+    EXPECT_EQ(kDummyData, asset->on_final_data);
+  }
+}
+
 }  // namespace
 }  // namespace lull
 
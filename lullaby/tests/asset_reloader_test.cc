@@ -0,0 +1,164 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/file/asset_reloader.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+class AssetReloaderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    reloader_.SetModificationTimeFn(
+        [this](const std::string& filename) -> int64_t {
+          std::lock_guard<std::mutex> lock(mutex_);
+          return times_[filename];
+        });
+  }
+
+  void Touch(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++times_[filename];
+  }
+
+  void AddResource(const std::string& name) {
+    reloader_.AddResource(Hash(name), [this, name]() {
+      reloaded_.push_back(name);
+    });
+  }
+
+  AssetReloader reloader_;
+  std::mutex mutex_;
+  std::unordered_map<std::string, int64_t> times_;
+  std::vector<std::string> reloaded_;
+};
+
+TEST_F(AssetReloaderTest, ReloadsChangedFile) {
+  AddResource("a");
+  AddResource("b");
+  reloader_.AddFileDependency(Hash("a"), "a.bin");
+  reloader_.AddFileDependency(Hash("b"), "b.bin");
+
+  EXPECT_EQ(reloader_.CheckForChanges(), 0u);
+  EXPECT_EQ(reloader_.ProcessChanges(), 0u);
+
+  Touch("a.bin");
+  EXPECT_EQ(reloader_.CheckForChanges(), 1u);
+  EXPECT_EQ(reloader_.ProcessChanges(), 1u);
+  EXPECT_EQ(reloaded_, std::vector<std::string>({"a"}));
+
+  // Changes are only processed once.
+  EXPECT_EQ(reloader_.ProcessChanges(), 0u);
+}
+
+TEST_F(AssetReloaderTest, ReloadsDependentsAfterDependencies) {
+  // shader <- material <- blueprint -> texture
+  AddResource("shader");
+  AddResource("material");
+  AddResource("blueprint");
+  AddResource("texture");
+  reloader_.AddFileDependency(Hash("shader"), "shader.fplshader");
+  reloader_.AddFileDependency(Hash("texture"), "texture.webp");
+  reloader_.AddDependency(Hash("material"), Hash("shader"));
+  reloader_.AddDependency(Hash("blueprint"), Hash("material"));
+  reloader_.AddDependency(Hash("blueprint"), Hash("texture"));
+
+  reloader_.NotifyFileChanged("shader.fplshader");
+  EXPECT_EQ(reloader_.ProcessChanges(), 3u);
+  EXPECT_EQ(reloaded_,
+            std::vector<std::string>({"shader", "material", "blueprint"}));
+}
+
+TEST_F(AssetReloaderTest, ReloadsSharedDependentOnce) {
+  AddResource("texture1");
+  AddResource("texture2");
+  AddResource("blueprint");
+  reloader_.AddFileDependency(Hash("texture1"), "texture1.webp");
+  reloader_.AddFileDependency(Hash("texture2"), "texture2.webp");
+  reloader_.AddDependency(Hash("blueprint"), Hash("texture1"));
+  reloader_.AddDependency(Hash("blueprint"), Hash("texture2"));
+
+  reloader_.NotifyFileChanged("texture1.webp");
+  reloader_.NotifyFileChanged("texture2.webp");
+  EXPECT_EQ(reloader_.ProcessChanges(), 3u);
+  EXPECT_EQ(reloaded_.back(), "blueprint");
+}
+
+TEST_F(AssetReloaderTest, IgnoresUnwatchedFiles) {
+  AddResource("a");
+  reloader_.AddFileDependency(Hash("a"), "a.bin");
+
+  reloader_.NotifyFileChanged("other.bin");
+  EXPECT_EQ(reloader_.ProcessChanges(), 0u);
+}
+
+TEST_F(AssetReloaderTest, RemoveResource) {
+  AddResource("a");
+  AddResource("b");
+  reloader_.AddFileDependency(Hash("a"), "a.bin");
+  reloader_.AddDependency(Hash("b"), Hash("a"));
+
+  reloader_.RemoveResource(Hash("a"));
+  reloader_.NotifyFileChanged("a.bin");
+  EXPECT_EQ(reloader_.ProcessChanges(), 0u);
+  EXPECT_TRUE(reloaded_.empty());
+}
+
+TEST_F(AssetReloaderTest, ReloadCanReregister) {
+  // Reloading a resource typically re-registers it, which must not deadlock
+  // or duplicate the reload.
+  reloader_.AddResource(Hash("a"), [this]() {
+    reloaded_.push_back("a");
+    reloader_.AddResource(Hash("a"), [this]() { reloaded_.push_back("a2"); });
+    reloader_.AddFileDependency(Hash("a"), "a.bin");
+  });
+  reloader_.AddFileDependency(Hash("a"), "a.bin");
+
+  reloader_.NotifyFileChanged("a.bin");
+  EXPECT_EQ(reloader_.ProcessChanges(), 1u);
+  reloader_.NotifyFileChanged("a.bin");
+  EXPECT_EQ(reloader_.ProcessChanges(), 1u);
+  EXPECT_EQ(reloaded_, std::vector<std::string>({"a", "a2"}));
+}
+
+TEST_F(AssetReloaderTest, WatchesInBackground) {
+  AddResource("a");
+  reloader_.AddFileDependency(Hash("a"), "a.bin");
+  reloader_.StartWatching(std::chrono::milliseconds(1));
+
+  Touch("a.bin");
+  size_t count = 0;
+  for (int i = 0; i < 1000 && count == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    count = reloader_.ProcessChanges();
+  }
+  reloader_.StopWatching();
+
+  EXPECT_EQ(count, 1u);
+  EXPECT_EQ(reloaded_, std::vector<std::string>({"a"}));
+}
+
+}  // namespace
+}  // namespace lull
@@ -14,16 +14,40 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <atomic>
 #include <chrono>            
 #include <condition_variable>
+#include <cstdlib>
 #include <mutex>             
+#include <new>
 #include <thread>            
 #include <unordered_set>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "lullaby/util/async_processor.h"
 
+// Counts the allocations made through operator new while enabled, so that tests
+// can check that recycled requests do not allocate.
+static std::atomic<bool> g_count_allocations(false);
+static std::atomic<size_t> g_num_allocations(0);
+
+void* operator new(size_t size) {
+  if (g_count_allocations) {
+    ++g_num_allocations;
+  }
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
 namespace lull {
 namespace {
 
@@ -196,6 +220,34 @@ TEST(AsyncProcessor, Cancel) {
   StopAndDrainCompletedQueue(&processor);
 }
 
+TEST(AsyncProcessor, Priority) {
+  AsyncProcessor<TestObjectPtr> processor;
+  processor.Stop();
+
+  std::vector<int> order;
+  auto record = [&order](TestObjectPtr* object) {
+    order.push_back((*object)->value);
+  };
+  TestObjectPtr objects[4];
+  for (int i = 0; i < 4; ++i) {
+    objects[i] = std::make_shared<TestObject>();
+    objects[i]->value = i;
+  }
+  processor.Enqueue(objects[0], record, 0);
+  processor.Enqueue(objects[1], record, 2);
+  processor.Enqueue(objects[2], record);
+  const auto task_id = processor.Enqueue(objects[3], record, -1);
+  EXPECT_TRUE(processor.SetPriority(task_id, 1));
+  EXPECT_FALSE(
+      processor.SetPriority(AsyncProcessor<TestObjectPtr>::kInvalidTaskId, 1));
+
+  // Equal priorities keep their submission order.
+  processor.Start();
+  WaitForNJobs(&processor, 4);
+  StopAndDrainCompletedQueue(&processor);
+  EXPECT_THAT(order, Eq(std::vector<int>({1, 3, 0, 2})));
+}
+
 TEST(AsyncProcessor, EnqueueThreadSafety) {
   using Lock = std::unique_lock<std::mutex>;
   using TaskId = AsyncProcessor<TestObjectPtr>::TaskId;
@@ -226,5 +278,36 @@ TEST(AsyncProcessor, EnqueueThreadSafety) {
   }
 }
 
+TEST(AsyncProcessor, RecyclesRequestsWithoutAllocating) {
+  constexpr int kBatchSize = 16;
+  AsyncProcessor<int> processor;
+  int sum = 0;
+  auto run_batch = [&]() {
+    for (int i = 0; i < kBatchSize; ++i) {
+      processor.Enqueue(i, [](int* value) { *value *= 2; });
+    }
+    for (int count = 0; count < kBatchSize;) {
+      int value = 0;
+      if (processor.Dequeue(&value)) {
+        sum += value;
+        ++count;
+      }
+    }
+  };
+
+  // The first batch creates the pooled requests.
+  run_batch();
+
+  g_num_allocations = 0;
+  g_count_allocations = true;
+  for (int i = 0; i < 10; ++i) {
+    run_batch();
+  }
+  g_count_allocations = false;
+
+  EXPECT_THAT(g_num_allocations.load(), Eq(0u));
+  EXPECT_THAT(sum, Eq(11 * kBatchSize * (kBatchSize - 1)));
+}
+
 }  // namespace
 }  // namespace lull
@@ -0,0 +1,290 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/audio/audio_system.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/dispatcher/dispatcher_system.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/make_unique.h"
+#include "lullaby/generated/transform_def_generated.h"
+
+// A fake GVR Audio backend. gvr::AudioApi is a thin wrapper around the GVR
+// Audio C API, so providing the C entry points here fakes the whole AudioApi.
+// Sources play until they are stopped or marked as finished by the test.
+namespace {
+
+struct FakeGvrAudio {
+  int dummy_context = 0;
+  gvr_audio_source_id next_id = 1;
+  int num_created = 0;
+  std::set<gvr_audio_source_id> playing;
+  std::vector<gvr_audio_source_id> stopped;
+
+  void Reset() { *this = FakeGvrAudio(); }
+
+  // Number of sources created and not yet stopped or finished.
+  size_t NumPlaying() const { return playing.size(); }
+
+  gvr_audio_source_id Create() {
+    ++num_created;
+    return next_id++;
+  }
+};
+
+FakeGvrAudio g_audio;
+
+gvr_audio_context* FakeContext() {
+  return reinterpret_cast<gvr_audio_context*>(&g_audio.dummy_context);
+}
+
+}  // namespace
+
+gvr_audio_context* gvr_audio_create(int32_t rendering_mode) {
+  return FakeContext();
+}
+void gvr_audio_destroy(gvr_audio_context** api) { *api = nullptr; }
+void gvr_audio_resume(gvr_audio_context* api) {}
+void gvr_audio_pause(gvr_audio_context* api) {}
+void gvr_audio_update(gvr_audio_context* api) {}
+bool gvr_audio_preload_soundfile(gvr_audio_context* api,
+                                 const char* filename) {
+  return true;
+}
+void gvr_audio_unload_soundfile(gvr_audio_context* api,
+                                const char* filename) {}
+gvr_audio_source_id gvr_audio_create_sound_object(gvr_audio_context* api,
+                                                  const char* filename) {
+  return g_audio.Create();
+}
+gvr_audio_source_id gvr_audio_create_soundfield(gvr_audio_context* api,
+                                                const char* filename) {
+  return g_audio.Create();
+}
+gvr_audio_source_id gvr_audio_create_stereo_sound(gvr_audio_context* api,
+                                                  const char* filename) {
+  return g_audio.Create();
+}
+void gvr_audio_play_sound(gvr_audio_context* api, gvr_audio_source_id id,
+                          bool looping_enabled) {
+  g_audio.playing.insert(id);
+}
+void gvr_audio_pause_sound(gvr_audio_context* api, gvr_audio_source_id id) {}
+void gvr_audio_resume_sound(gvr_audio_context* api, gvr_audio_source_id id) {}
+void gvr_audio_stop_sound(gvr_audio_context* api, gvr_audio_source_id id) {
+  if (g_audio.playing.erase(id)) {
+    g_audio.stopped.push_back(id);
+  }
+}
+bool gvr_audio_is_sound_playing(const gvr_audio_context* api,
+                                gvr_audio_source_id id) {
+  return g_audio.playing.count(id) != 0;
+}
+bool gvr_audio_is_source_id_valid(const gvr_audio_context* api,
+                                  gvr_audio_source_id id) {
+  return id != gvr::kInvalidSourceId;
+}
+void gvr_audio_set_sound_volume(gvr_audio_context* api,
+                                gvr_audio_source_id id, float volume) {}
+void gvr_audio_set_sound_object_directivity(gvr_audio_context* api,
+                                            gvr_audio_source_id id,
+                                            float alpha, float order) {}
+void gvr_audio_set_sound_object_rotation(gvr_audio_context* api,
+                                         gvr_audio_source_id id,
+                                         gvr_quatf rotation) {}
+void gvr_audio_set_soundfield_rotation(gvr_audio_context* api,
+                                       gvr_audio_source_id id,
+                                       gvr_quatf rotation) {}
+void gvr_audio_set_sound_object_position(gvr_audio_context* api,
+                                         gvr_audio_source_id id, float x,
+                                         float y, float z) {}
+void gvr_audio_set_sound_object_distance_rolloff_model(
+    gvr_audio_context* api, gvr_audio_source_id id, int32_t rolloff_model,
+    float min_distance, float max_distance) {}
+void gvr_audio_enable_room(gvr_audio_context* api, bool enable) {}
+void gvr_audio_set_room_properties(gvr_audio_context* api, float size_x,
+                                   float size_y, float size_z,
+                                   int32_t wall_material,
+                                   int32_t ceiling_material,
+                                   int32_t floor_material) {}
+void gvr_audio_set_room_reverb_adjustments(gvr_audio_context* api,
+                                           float gain, float time_adjust,
+                                           float brightness_adjust) {}
+void gvr_audio_enable_stereo_speaker_mode(gvr_audio_context* api,
+                                          bool enable) {}
+void gvr_audio_set_master_volume(gvr_audio_context* api, float volume) {}
+void gvr_audio_set_head_pose(gvr_audio_context* api,
+                             gvr_mat4f head_space_from_start_space) {}
+
+namespace lull {
+namespace {
+
+// Mirrors AudioSystem::kMaxSources.
+constexpr size_t kMaxSources = 32;
+
+class AudioSystemTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    g_audio.Reset();
+    registry_ = MakeUnique<Registry>();
+    registry_->Create<Dispatcher>();
+
+    auto* entity_factory = registry_->Create<EntityFactory>(registry_.get());
+    entity_factory->CreateSystem<DispatcherSystem>();
+    entity_factory->CreateSystem<TransformSystem>();
+    audio_system_ = entity_factory->CreateSystem<AudioSystem>();
+    entity_factory->Initialize();
+  }
+
+  Entity CreateEntity() {
+    Blueprint blueprint(512);
+    TransformDefT transform;
+    blueprint.Write(&transform);
+    return registry_->Get<EntityFactory>()->Create(&blueprint);
+  }
+
+  // Streams a new sound file and returns its hash.
+  HashValue LoadSound(int index) {
+    const std::string filename = "sound" + std::to_string(index) + ".ogg";
+    audio_system_->LoadSound(filename, AudioLoadType::AudioLoadType_Stream);
+    return Hash(filename);
+  }
+
+  void Play(Entity entity, HashValue sound, bool loop) {
+    PlaySoundParameters params;
+    params.loop = loop;
+    audio_system_->Play(entity, sound, params);
+  }
+
+ protected:
+  std::unique_ptr<Registry> registry_;
+  AudioSystem* audio_system_ = nullptr;
+};
+
+TEST_F(AudioSystemTest, StealsOldestOneShotWhenFull) {
+  std::vector<Entity> entities;
+  for (size_t i = 0; i < kMaxSources; ++i) {
+    entities.push_back(CreateEntity());
+    Play(entities.back(), LoadSound(static_cast<int>(i)), i % 2 == 0);
+  }
+  audio_system_->Update();
+  EXPECT_EQ(g_audio.NumPlaying(), kMaxSources);
+
+  // Entity 0 loops, so entity 1 holds the oldest one-shot.
+  const Entity extra = CreateEntity();
+  Play(extra, LoadSound(static_cast<int>(kMaxSources)), false);
+  EXPECT_EQ(g_audio.stopped.size(), 1u);
+  EXPECT_EQ(g_audio.NumPlaying(), kMaxSources);
+  EXPECT_TRUE(audio_system_->HasSound(extra));
+  EXPECT_TRUE(audio_system_->HasSound(entities[0]));
+  EXPECT_FALSE(audio_system_->HasSound(entities[1]));
+
+  // The next steal takes the following one-shot.
+  Play(CreateEntity(), LoadSound(static_cast<int>(kMaxSources) + 1), true);
+  EXPECT_EQ(g_audio.stopped.size(), 2u);
+  EXPECT_FALSE(audio_system_->HasSound(entities[3]));
+  audio_system_->Update();
+  EXPECT_EQ(g_audio.NumPlaying(), kMaxSources);
+}
+
+TEST_F(AudioSystemTest, DropsPlayWhenAllSourcesLoop) {
+  for (size_t i = 0; i < kMaxSources; ++i) {
+    Play(CreateEntity(), LoadSound(static_cast<int>(i)), true);
+  }
+  audio_system_->Update();
+  EXPECT_EQ(g_audio.num_created, static_cast<int>(kMaxSources));
+
+  const Entity extra = CreateEntity();
+  Play(extra, LoadSound(static_cast<int>(kMaxSources)), false);
+  EXPECT_EQ(g_audio.num_created, static_cast<int>(kMaxSources));
+  EXPECT_TRUE(g_audio.stopped.empty());
+  EXPECT_FALSE(audio_system_->HasSound(extra));
+}
+
+TEST_F(AudioSystemTest, FinishedOneShotsFreeTheirSources) {
+  std::vector<Entity> entities;
+  for (size_t i = 0; i < kMaxSources; ++i) {
+    entities.push_back(CreateEntity());
+    Play(entities.back(), LoadSound(static_cast<int>(i)), false);
+  }
+
+  // Finishing a one-shot returns its source without stealing another.
+  g_audio.playing.erase(g_audio.playing.begin());
+  audio_system_->Update();
+  EXPECT_FALSE(audio_system_->HasSound(entities[0]));
+
+  Play(CreateEntity(), LoadSound(static_cast<int>(kMaxSources)), true);
+  EXPECT_TRUE(g_audio.stopped.empty());
+  EXPECT_EQ(g_audio.NumPlaying(), kMaxSources);
+}
+
+TEST_F(AudioSystemTest, OrphanedOneShotsCountUntilFinished) {
+  auto* transform_system = registry_->Get<TransformSystem>();
+
+  // Fill the pool with one-shots on a single Entity, then disable it. The
+  // sounds keep playing, so they must still hold their sources.
+  const Entity orphaner = CreateEntity();
+  for (size_t i = 0; i < kMaxSources; ++i) {
+    Play(orphaner, LoadSound(static_cast<int>(i)), false);
+  }
+  transform_system->Disable(orphaner);
+  EXPECT_FALSE(audio_system_->HasSound(orphaner));
+  audio_system_->Update();
+  EXPECT_EQ(g_audio.NumPlaying(), kMaxSources);
+
+  // A new sound stops the oldest orphan to make room.
+  const Entity entity = CreateEntity();
+  Play(entity, LoadSound(static_cast<int>(kMaxSources)), true);
+  ASSERT_EQ(g_audio.stopped.size(), 1u);
+  EXPECT_EQ(g_audio.stopped[0], 1);
+  EXPECT_EQ(g_audio.NumPlaying(), kMaxSources);
+
+  // Once the orphans finish, their sources are available again.
+  const std::set<gvr_audio_source_id> orphans = g_audio.playing;
+  for (const gvr_audio_source_id id : orphans) {
+    if (id != g_audio.next_id - 1) {
+      g_audio.playing.erase(id);
+    }
+  }
+  audio_system_->Update();
+  for (size_t i = 1; i < kMaxSources; ++i) {
+    Play(CreateEntity(), LoadSound(static_cast<int>(kMaxSources + i)), true);
+  }
+  EXPECT_EQ(g_audio.stopped.size(), 1u);
+  EXPECT_EQ(g_audio.NumPlaying(), kMaxSources);
+}
+
+TEST_F(AudioSystemTest, FailedLoopingStreamIsCleanedUp) {
+  const Entity entity = CreateEntity();
+  Play(entity, LoadSound(0), true);
+  audio_system_->Update();
+  EXPECT_TRUE(audio_system_->HasSound(entity));
+
+  // The stream fails, so GVR Audio stops playing it.
+  g_audio.playing.clear();
+  audio_system_->Update();
+  EXPECT_FALSE(audio_system_->HasSound(entity));
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,231 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/blend_shape/blend_shape_system.h"
+
+#include <random>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/modules/render/mesh_data.h"
+#include "lullaby/modules/render/vertex.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/job_processor.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/tests/mathfu_matchers.h"
+
+namespace lull {
+namespace {
+
+using testing::NearMathfu;
+
+constexpr float kEpsilon = 1e-5f;
+
+using BlendMode = BlendShapeSystem::BlendMode;
+
+DataContainer CopyVertices(const std::vector<VertexPN>& vertices) {
+  return DataContainer::CreateDataCopy(
+      reinterpret_cast<const uint8_t*>(vertices.data()),
+      vertices.size() * sizeof(VertexPN));
+}
+
+BlendShapeSystem::BlendableVertex ToBlendable(const VertexPN& vertex) {
+  BlendShapeSystem::BlendableVertex result;
+  result.position = mathfu::vec3(vertex.x, vertex.y, vertex.z);
+  result.normal = mathfu::vec3(vertex.nx, vertex.ny, vertex.nz);
+  result.tangent = mathfu::kZeros3f;
+  result.orientation = mathfu::quat::identity;
+  return result;
+}
+
+// Blends every vertex of every shape, the way BlendShapeSystem did before it
+// stored shapes sparsely.
+std::vector<BlendShapeSystem::BlendableVertex> BlendDense(
+    const std::vector<VertexPN>& base,
+    const std::vector<std::vector<VertexPN>>& shapes,
+    const std::vector<float>& weights, BlendMode mode) {
+  std::vector<BlendShapeSystem::BlendableVertex> result;
+  for (size_t index = 0; index < base.size(); ++index) {
+    BlendShapeSystem::BlendVertexParams params;
+    params.neutral = ToBlendable(base[index]);
+    params.calculated = params.neutral;
+    if (mode == BlendShapeSystem::kInterpolate) {
+      params.calculated.normal = mathfu::kZeros3f;
+    }
+
+    bool used = false;
+    for (size_t i = 0; i < shapes.size() && i < weights.size(); ++i) {
+      params.weight = mathfu::Clamp(weights[i], 0.f, 1.f);
+      if (params.weight == 0.f) {
+        continue;
+      }
+      used = true;
+      params.blend = ToBlendable(shapes[i][index]);
+      BlendShapeSystem::BlendVertex(&params, mode);
+    }
+    if (!used) {
+      params.calculated.normal = params.neutral.normal;
+    }
+    params.calculated.normal.Normalize();
+    result.push_back(params.calculated);
+  }
+  return result;
+}
+
+class BlendShapeSystemTest : public ::testing::Test {
+ protected:
+  BlendShapeSystemTest() {
+    registry_.Create<Dispatcher>();
+    auto* entity_factory = registry_.Create<EntityFactory>(&registry_);
+    entity_factory->CreateSystem<RenderSystem>();
+    entity_factory->CreateSystem<TransformSystem>();
+    blend_shape_system_ = entity_factory->CreateSystem<BlendShapeSystem>();
+    entity_factory->Initialize();
+  }
+
+  // Sets up |entity| with |base| as both its mesh and its base shape, then
+  // adds |shapes|.
+  void InitEntity(Entity entity, const std::vector<VertexPN>& base,
+                  const std::vector<std::vector<VertexPN>>& shapes,
+                  BlendMode mode) {
+    MeshData mesh(MeshData::kTriangles, VertexPN::kFormat, CopyVertices(base));
+    blend_shape_system_->InitBlendShape(entity, std::move(mesh),
+                                        VertexPN::kFormat, CopyVertices(base),
+                                        mode);
+    for (size_t i = 0; i < shapes.size(); ++i) {
+      blend_shape_system_->AddBlendShape(entity, static_cast<HashValue>(i + 1),
+                                         CopyVertices(shapes[i]));
+    }
+  }
+
+  // Updates the weights of |entity| and compares every vertex with the dense
+  // calculation.
+  void ExpectMatchesDense(Entity entity, const std::vector<VertexPN>& base,
+                          const std::vector<std::vector<VertexPN>>& shapes,
+                          std::vector<float> weights, BlendMode mode) {
+    blend_shape_system_->UpdateWeights(entity, weights);
+    const auto expected = BlendDense(base, shapes, weights, mode);
+    for (size_t i = 0; i < base.size(); ++i) {
+      BlendShapeSystem::BlendableVertex actual;
+      ASSERT_TRUE(blend_shape_system_->ReadVertex(entity, i, &actual));
+      EXPECT_THAT(actual.position,
+                  NearMathfu(expected[i].position, kEpsilon))
+          << "vertex " << i;
+      EXPECT_THAT(actual.normal, NearMathfu(expected[i].normal, kEpsilon))
+          << "vertex " << i;
+    }
+  }
+
+  Registry registry_;
+  BlendShapeSystem* blend_shape_system_ = nullptr;
+};
+
+std::vector<VertexPN> MakeBase(size_t num_vertices) {
+  std::vector<VertexPN> base;
+  for (size_t i = 0; i < num_vertices; ++i) {
+    const float f = static_cast<float>(i);
+    base.emplace_back(mathfu::vec3(f, 2.f * f, -f), mathfu::kAxisY3f);
+  }
+  return base;
+}
+
+// Returns shapes which each change a different subset of the vertices of
+// |base|, with some vertices changed by more than one shape.
+std::vector<std::vector<VertexPN>> MakeShapes(const std::vector<VertexPN>& base,
+                                              BlendMode mode) {
+  // Displacement shapes are deltas, so an unchanged vertex is all zeros.
+  const bool displace = mode == BlendShapeSystem::kDisplacement;
+  std::vector<std::vector<VertexPN>> shapes(3);
+  for (size_t i = 0; i < base.size(); ++i) {
+    for (auto& shape : shapes) {
+      shape.push_back(displace ? VertexPN(0.f, 0.f, 0.f, 0.f, 0.f, 0.f)
+                               : base[i]);
+    }
+    // Shape 0 moves the first half of the mesh.
+    if (i < base.size() / 2) {
+      shapes[0][i].y += 1.f;
+    }
+    // Shape 1 moves and tilts every third vertex.
+    if (i % 3 == 0) {
+      shapes[1][i].x -= 2.f;
+      shapes[1][i].nx += 1.f;
+    }
+    // Shape 2 tilts the normals of the last few vertices.
+    if (i + 4 >= base.size()) {
+      shapes[2][i].nz += 1.f;
+    }
+  }
+  return shapes;
+}
+
+TEST_F(BlendShapeSystemTest, SparseMatchesDenseInterpolate) {
+  const BlendMode mode = BlendShapeSystem::kInterpolate;
+  const Entity entity = 1;
+  const auto base = MakeBase(10);
+  const auto shapes = MakeShapes(base, mode);
+  InitEntity(entity, base, shapes, mode);
+
+  ExpectMatchesDense(entity, base, shapes, {1.f, 0.f, 0.f}, mode);
+  ExpectMatchesDense(entity, base, shapes, {0.5f, 0.25f, 0.f}, mode);
+  ExpectMatchesDense(entity, base, shapes, {0.f, 0.f, 0.75f}, mode);
+  ExpectMatchesDense(entity, base, shapes, {0.3f, 0.6f, 0.9f}, mode);
+  // Every weight going to zero restores the base shape.
+  ExpectMatchesDense(entity, base, shapes, {0.f, 0.f, 0.f}, mode);
+  // Weights are clamped, and missing weights are treated as zero.
+  ExpectMatchesDense(entity, base, shapes, {-1.f, 2.f}, mode);
+  ExpectMatchesDense(entity, base, shapes, {}, mode);
+}
+
+TEST_F(BlendShapeSystemTest, SparseMatchesDenseDisplacement) {
+  const BlendMode mode = BlendShapeSystem::kDisplacement;
+  const Entity entity = 1;
+  const auto base = MakeBase(10);
+  const auto shapes = MakeShapes(base, mode);
+  InitEntity(entity, base, shapes, mode);
+
+  ExpectMatchesDense(entity, base, shapes, {1.f, 0.f, 0.f}, mode);
+  ExpectMatchesDense(entity, base, shapes, {0.5f, 0.25f, 0.f}, mode);
+  ExpectMatchesDense(entity, base, shapes, {0.f, 1.f, 0.75f}, mode);
+  ExpectMatchesDense(entity, base, shapes, {0.f, 0.f, 0.f}, mode);
+  ExpectMatchesDense(entity, base, shapes, {0.2f, 2.f, -3.f}, mode);
+}
+
+TEST_F(BlendShapeSystemTest, SparseMatchesDenseOnWorkerThreads) {
+  registry_.Create<JobProcessor>(4);
+
+  const BlendMode mode = BlendShapeSystem::kInterpolate;
+  const Entity entity = 1;
+  const auto base = MakeBase(3 * 4096 + 17);
+  auto shapes = MakeShapes(base, mode);
+  // Scatter some extra changes so that every range of vertices has work.
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<size_t> pick(0, base.size() - 1);
+  for (int i = 0; i < 500; ++i) {
+    shapes[2][pick(rng)].z += 0.5f;
+  }
+  InitEntity(entity, base, shapes, mode);
+
+  ExpectMatchesDense(entity, base, shapes, {0.5f, 0.f, 1.f}, mode);
+  ExpectMatchesDense(entity, base, shapes, {0.f, 0.7f, 0.f}, mode);
+  ExpectMatchesDense(entity, base, shapes, {0.f, 0.f, 0.f}, mode);
+}
+
+}  // namespace
+}  // namespace lull
@@ -199,6 +199,40 @@ TEST(BlueprintDeathTest, Legacy) {
   EXPECT_THAT(other->value()->str(), Eq("Hello"));
 }
 
+TEST(BlueprintTest, DefArray) {
+  DataIntT data_int;
+  data_int.value = 123;
+  Blueprint int_bp(&data_int);
+
+  DataStringT data_str;
+  data_str.value = "Hello";
+  Blueprint str_bp(&data_str);
+
+  const Blueprint::TypedFlatbuffer defs[] = {
+      {int_bp.GetLegacyDefType(), int_bp.GetLegacyDefData()},
+      {str_bp.GetLegacyDefType(), str_bp.GetLegacyDefData()},
+  };
+  Blueprint bp(defs, 2);
+
+  int count = 0;
+  bp.ForEachComponent([&](const Blueprint& blueprint) {
+    if (count == 0) {
+      EXPECT_TRUE(blueprint.Is<DataIntT>());
+      DataIntT tmp;
+      blueprint.Read(&tmp);
+      EXPECT_THAT(tmp.value, Eq(123));
+    } else if (count == 1) {
+      EXPECT_TRUE(blueprint.Is<DataStringT>());
+      EXPECT_THAT(blueprint.GetLegacyDefData(), Eq(defs[1].second));
+      DataStringT tmp;
+      blueprint.Read(&tmp);
+      EXPECT_THAT(tmp.value, Eq("Hello"));
+    }
+    ++count;
+  });
+  EXPECT_THAT(count, Eq(2));
+}
+
 TEST(BlueprintTypeTest, TypeEquality) {
   BlueprintType type1a = BlueprintType::Create<ClassOne>();
   BlueprintType type1b = BlueprintType::Create<ClassOne>();
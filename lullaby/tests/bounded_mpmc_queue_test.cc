@@ -0,0 +1,123 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lullaby/util/bounded_mpmc_queue.h"
+
+namespace lull {
+namespace {
+
+TEST(BoundedMpmcQueue, Capacity) {
+  EXPECT_EQ(static_cast<size_t>(2), BoundedMpmcQueue<int>(1).Capacity());
+  EXPECT_EQ(static_cast<size_t>(8), BoundedMpmcQueue<int>(8).Capacity());
+  EXPECT_EQ(static_cast<size_t>(16), BoundedMpmcQueue<int>(9).Capacity());
+}
+
+TEST(BoundedMpmcQueue, FifoAndFull) {
+  BoundedMpmcQueue<int> queue(4);
+  EXPECT_TRUE(queue.Empty());
+
+  for (int i = 0; i < 4; ++i) {
+    int value = i;
+    EXPECT_TRUE(queue.TryEnqueue(&value));
+  }
+  EXPECT_FALSE(queue.Empty());
+
+  int value = 4;
+  EXPECT_FALSE(queue.TryEnqueue(&value));
+  EXPECT_EQ(4, value);
+
+  // Wrap around the ring a few times.
+  for (int i = 0; i < 20; ++i) {
+    int out = -1;
+    EXPECT_TRUE(queue.Dequeue(&out));
+    EXPECT_EQ(i, out);
+    queue.Enqueue(i + 4);
+  }
+  for (int i = 20; i < 24; ++i) {
+    EXPECT_EQ(i, queue.WaitDequeue());
+  }
+
+  int out = -1;
+  EXPECT_FALSE(queue.Dequeue(&out));
+  EXPECT_EQ(-1, out);
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(BoundedMpmcQueue, ReleasesDequeuedElements) {
+  BoundedMpmcQueue<std::shared_ptr<int>> queue(2);
+  std::shared_ptr<int> ptr = std::make_shared<int>(123);
+  std::weak_ptr<int> weak = ptr;
+
+  queue.Enqueue(std::move(ptr));
+  EXPECT_TRUE(queue.Dequeue(nullptr));
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(BoundedMpmcQueue, MultiProducerMultiConsumer) {
+  static const int kSentinel = -1;
+  static const int kNumProducers = 8;
+  static const int kNumConsumers = 4;
+  static const int kNumValues = 1000;
+  BoundedMpmcQueue<int> queue(64);
+
+  // Use a small queue relative to the number of values so that the producers
+  // frequently find it full.
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kNumProducers; ++i) {
+    producers.emplace_back([&queue]() {
+      for (int j = 1; j <= kNumValues; ++j) {
+        queue.Enqueue(j);
+      }
+    });
+  }
+
+  std::atomic<int64_t> total(0);
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < kNumConsumers; ++i) {
+    consumers.emplace_back([&queue, &total]() {
+      int64_t sum = 0;
+      for (int value = queue.WaitDequeue(); value != kSentinel;
+           value = queue.WaitDequeue()) {
+        sum += value;
+      }
+      total += sum;
+    });
+  }
+
+  for (auto& thread : producers) {
+    thread.join();
+  }
+  for (int i = 0; i < kNumConsumers; ++i) {
+    queue.Enqueue(kSentinel);
+  }
+  for (auto& thread : consumers) {
+    thread.join();
+  }
+
+  const int64_t expected_total =
+      static_cast<int64_t>(kNumProducers) * kNumValues * (kNumValues + 1) / 2;
+  EXPECT_EQ(expected_total, total.load());
+  EXPECT_TRUE(queue.Empty());
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,123 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lullaby/util/bounded_mpsc_queue.h"
+
+namespace lull {
+namespace {
+
+TEST(BoundedMpscQueue, Capacity) {
+  EXPECT_EQ(static_cast<size_t>(2), BoundedMpscQueue<int>(1).Capacity());
+  EXPECT_EQ(static_cast<size_t>(8), BoundedMpscQueue<int>(8).Capacity());
+  EXPECT_EQ(static_cast<size_t>(16), BoundedMpscQueue<int>(9).Capacity());
+}
+
+TEST(BoundedMpscQueue, FifoAndFull) {
+  BoundedMpscQueue<int> queue(4);
+  EXPECT_TRUE(queue.Empty());
+
+  for (int i = 0; i < 4; ++i) {
+    int value = i;
+    EXPECT_TRUE(queue.TryEnqueue(&value));
+  }
+  EXPECT_FALSE(queue.Empty());
+
+  int value = 4;
+  EXPECT_FALSE(queue.TryEnqueue(&value));
+  EXPECT_EQ(4, value);
+
+  // Wrap around the ring a few times.
+  for (int i = 0; i < 20; ++i) {
+    int out = -1;
+    EXPECT_TRUE(queue.Dequeue(&out));
+    EXPECT_EQ(i, out);
+    int next = i + 4;
+    EXPECT_TRUE(queue.TryEnqueue(&next));
+  }
+  for (int i = 20; i < 24; ++i) {
+    int out = -1;
+    EXPECT_TRUE(queue.Dequeue(&out));
+    EXPECT_EQ(i, out);
+  }
+
+  int out = -1;
+  EXPECT_FALSE(queue.Dequeue(&out));
+  EXPECT_EQ(-1, out);
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(BoundedMpscQueue, ReleasesDequeuedElements) {
+  BoundedMpscQueue<std::shared_ptr<int>> queue(2);
+  std::shared_ptr<int> ptr = std::make_shared<int>(123);
+  std::weak_ptr<int> weak = ptr;
+
+  std::shared_ptr<int> obj = ptr;
+  ptr.reset();
+  EXPECT_TRUE(queue.TryEnqueue(&obj));
+  EXPECT_TRUE(queue.Dequeue(nullptr));
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(BoundedMpscQueue, MultiProducerSingleConsumer) {
+  static const int kSentinel = -1;
+  static const int kNumProducers = 16;
+  static const int kNumValues = 1000;
+  BoundedMpscQueue<int> queue(64);
+
+  // Use a small queue relative to the number of values so that the producers
+  // frequently find it full.
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kNumProducers; ++i) {
+    producers.emplace_back([&queue]() {
+      for (int j = 0; j <= kNumValues; ++j) {
+        int value = j < kNumValues ? j + 1 : kSentinel;
+        while (!queue.TryEnqueue(&value)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  int end_count = 0;
+  int64_t total = 0;
+  while (end_count < kNumProducers) {
+    int value = 0;
+    if (queue.Dequeue(&value)) {
+      if (value == kSentinel) {
+        ++end_count;
+      } else {
+        total += value;
+      }
+    }
+  }
+
+  for (auto& thread : producers) {
+    thread.join();
+  }
+
+  const int64_t expected_total =
+      static_cast<int64_t>(kNumProducers) * kNumValues * (kNumValues + 1) / 2;
+  EXPECT_EQ(expected_total, total);
+  EXPECT_TRUE(queue.Empty());
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,93 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "lullaby/util/bounded_spsc_queue.h"
+
+namespace lull {
+namespace {
+
+TEST(BoundedSpscQueue, Capacity) {
+  EXPECT_EQ(static_cast<size_t>(1), BoundedSpscQueue<int>(1).Capacity());
+  EXPECT_EQ(static_cast<size_t>(8), BoundedSpscQueue<int>(8).Capacity());
+  EXPECT_EQ(static_cast<size_t>(16), BoundedSpscQueue<int>(9).Capacity());
+}
+
+TEST(BoundedSpscQueue, FifoAndFull) {
+  BoundedSpscQueue<int> queue(4);
+  EXPECT_TRUE(queue.Empty());
+
+  for (int i = 0; i < 4; ++i) {
+    int value = i;
+    EXPECT_TRUE(queue.TryEnqueue(&value));
+  }
+  EXPECT_FALSE(queue.Empty());
+
+  int value = 4;
+  EXPECT_FALSE(queue.TryEnqueue(&value));
+  EXPECT_EQ(4, value);
+
+  // Wrap around the ring a few times.
+  for (int i = 0; i < 20; ++i) {
+    int out = -1;
+    EXPECT_TRUE(queue.Dequeue(&out));
+    EXPECT_EQ(i, out);
+    queue.Enqueue(i + 4);
+  }
+  for (int i = 20; i < 24; ++i) {
+    EXPECT_EQ(i, queue.WaitDequeue());
+  }
+
+  int out = -1;
+  EXPECT_FALSE(queue.Dequeue(&out));
+  EXPECT_EQ(-1, out);
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(BoundedSpscQueue, ReleasesDequeuedElements) {
+  BoundedSpscQueue<std::shared_ptr<int>> queue(2);
+  std::shared_ptr<int> ptr = std::make_shared<int>(123);
+  std::weak_ptr<int> weak = ptr;
+
+  queue.Enqueue(std::move(ptr));
+  EXPECT_TRUE(queue.Dequeue(nullptr));
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(BoundedSpscQueue, SingleProducerSingleConsumer) {
+  static const int kNumValues = 100000;
+  BoundedSpscQueue<int> queue(16);
+
+  std::thread producer([&queue]() {
+    for (int i = 0; i < kNumValues; ++i) {
+      queue.Enqueue(i);
+    }
+  });
+
+  // Values must arrive in the order they were enqueued.
+  for (int i = 0; i < kNumValues; ++i) {
+    EXPECT_EQ(i, queue.WaitDequeue());
+  }
+
+  producer.join();
+  EXPECT_TRUE(queue.Empty());
+}
+
+}  // namespace
+}  // namespace lull
@@ -402,6 +402,54 @@ TEST_F(CollisionSystemTest, CheckForClipFailureCases) {
   }
 }
 
+TEST_F(CollisionSystemTest, CheckForClipAfterReparent) {
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  auto* collision_system = registry_->Get<CollisionSystem>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+
+  Blueprint clip_blueprint;
+  Blueprint plain_blueprint;
+  Blueprint child_blueprint;
+  {
+    TransformDefT transform;
+    transform.position = mathfu::vec3(4.f, 4.f, -4.f);
+    CollisionClipBoundsDefT clip_bounds;
+    clip_bounds.aabb = Aabb(mathfu::vec3(0.4f), mathfu::vec3(0.6f));
+    clip_blueprint.Write(&transform);
+    clip_blueprint.Write(&clip_bounds);
+  }
+  {
+    TransformDefT transform;
+    transform.position = mathfu::vec3(4.f, 4.f, -4.f);
+    plain_blueprint.Write(&transform);
+  }
+  {
+    TransformDefT transform;
+    transform.position = mathfu::vec3(0.f, 0.f, 0.5f);
+    transform.aabb =
+        Aabb(mathfu::vec3(-1.f, -1.f, 0.f), mathfu::vec3(1.f, 1.f, 0.f));
+    CollisionDefT collision;
+    collision.clip_outside_bounds = true;
+    child_blueprint.Write(&transform);
+    child_blueprint.Write(&collision);
+  }
+  const Entity clip_parent = entity_factory->Create(&clip_blueprint);
+  const Entity plain_parent = entity_factory->Create(&plain_blueprint);
+  const Entity child = entity_factory->Create(&child_blueprint);
+  transform_system->AddChild(clip_parent, child);
+
+  const Ray outside(mathfu::vec3(4.75f, 4.75f, 0.f), -mathfu::kAxisZ3f);
+  EXPECT_EQ(collision_system->CheckForCollision(outside).entity, kNullEntity);
+
+  // Moving the child out from under the clip bounds must not reuse the cached
+  // bounds from the previous query.
+  transform_system->AddChild(plain_parent, child);
+  EXPECT_EQ(collision_system->CheckForCollision(outside).entity, child);
+
+  transform_system->AddChild(clip_parent, child);
+  EXPECT_EQ(collision_system->CheckForCollision(outside).entity, kNullEntity);
+}
+
 TEST_F(CollisionSystemTest, CheckForPointCollisions) {
   Blueprint blueprint1;
   {
@@ -470,6 +518,154 @@ TEST_F(CollisionSystemTest, CheckForPointCollisions) {
   }
 }
 
+TEST_F(CollisionSystemTest, CheckForCollisionAfterChanges) {
+  Blueprint blueprint;
+  {
+    TransformDefT transform;
+    transform.position = mathfu::vec3(0.f, 0.f, -4.f);
+    transform.aabb = Aabb(-mathfu::kOnes3f, mathfu::kOnes3f);
+    CollisionDefT collision;
+    blueprint.Write(&transform);
+    blueprint.Write(&collision);
+  }
+
+  static const float kEpsilon = 0.001f;
+  const Ray ray(mathfu::kZeros3f, -mathfu::kAxisZ3f);
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  auto* collision_system = registry_->Get<CollisionSystem>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+
+  const Entity entity = entity_factory->Create(&blueprint);
+  EXPECT_EQ(collision_system->CheckForCollision(ray).entity, entity);
+
+  // Moving the entity out of the way should be picked up by the next query.
+  transform_system->SetLocalTranslation(entity, mathfu::vec3(5.f, 0.f, -4.f));
+  EXPECT_EQ(collision_system->CheckForCollision(ray).entity, kNullEntity);
+
+  transform_system->SetLocalTranslation(entity, mathfu::vec3(0.f, 0.f, -8.f));
+  {
+    const auto result = collision_system->CheckForCollision(ray);
+    EXPECT_EQ(result.entity, entity);
+    EXPECT_NEAR(result.distance, 7.f, kEpsilon);
+  }
+
+  // Disabled entities and entities without collision should not be hit.
+  transform_system->Disable(entity);
+  EXPECT_EQ(collision_system->CheckForCollision(ray).entity, kNullEntity);
+  transform_system->Enable(entity);
+  EXPECT_EQ(collision_system->CheckForCollision(ray).entity, entity);
+
+  collision_system->DisableCollision(entity);
+  EXPECT_EQ(collision_system->CheckForCollision(ray).entity, kNullEntity);
+  collision_system->EnableCollision(entity);
+  EXPECT_EQ(collision_system->CheckForCollision(ray).entity, entity);
+
+  entity_factory->Destroy(entity);
+  EXPECT_EQ(collision_system->CheckForCollision(ray).entity, kNullEntity);
+}
+
+TEST_F(CollisionSystemTest, CheckForCollisions) {
+  Blueprint far_blueprint;
+  {
+    TransformDefT transform;
+    transform.position = mathfu::vec3(0.f, 0.f, -4.f);
+    transform.aabb = Aabb(-mathfu::kOnes3f, mathfu::kOnes3f);
+    CollisionDefT collision;
+    far_blueprint.Write(&transform);
+    far_blueprint.Write(&collision);
+  }
+  Blueprint near_blueprint;
+  {
+    TransformDefT transform;
+    transform.position = mathfu::vec3(0.f, 0.f, -2.f);
+    transform.aabb = Aabb(-mathfu::kOnes3f / 2.f, mathfu::kOnes3f / 2.f);
+    CollisionDefT collision;
+    near_blueprint.Write(&transform);
+    near_blueprint.Write(&collision);
+  }
+
+  static const float kEpsilon = 0.001f;
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  auto* collision_system = registry_->Get<CollisionSystem>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+  const Entity far_entity = entity_factory->Create(&far_blueprint);
+  const Entity near_entity = entity_factory->Create(&near_blueprint);
+
+  const std::vector<Ray> rays = {
+      Ray(mathfu::kZeros3f, -mathfu::kAxisZ3f),
+      Ray(mathfu::vec3(0.75f, 0.f, 0.f), -mathfu::kAxisZ3f),
+      Ray(mathfu::vec3(2.f, 0.f, 0.f), -mathfu::kAxisZ3f),
+  };
+  std::vector<CollisionSystem::CollisionResult> results(
+      rays.size(), {kNullEntity, kNoHitDistance});
+  collision_system->CheckForCollisions(rays, results);
+  EXPECT_EQ(results[0].entity, near_entity);
+  EXPECT_NEAR(results[0].distance, 1.5f, kEpsilon);
+  EXPECT_EQ(results[1].entity, far_entity);
+  EXPECT_NEAR(results[1].distance, 3.f, kEpsilon);
+  EXPECT_EQ(results[2].entity, kNullEntity);
+  EXPECT_EQ(results[2].distance, kNoHitDistance);
+
+  // Previous hits are only kept if they are still the closest hit.
+  const uint64_t generation = collision_system->GetCollisionGeneration();
+  EXPECT_EQ(collision_system->GetCollisionGeneration(), generation);
+  transform_system->SetLocalTranslation(near_entity,
+                                        mathfu::vec3(0.75f, 0.f, -1.f));
+  EXPECT_NE(collision_system->GetCollisionGeneration(), generation);
+
+  collision_system->CheckForCollisions(rays, results);
+  EXPECT_EQ(results[0].entity, far_entity);
+  EXPECT_NEAR(results[0].distance, 3.f, kEpsilon);
+  EXPECT_EQ(results[1].entity, near_entity);
+  EXPECT_NEAR(results[1].distance, 0.5f, kEpsilon);
+  EXPECT_EQ(results[2].entity, kNullEntity);
+
+  collision_system->DisableCollision(near_entity);
+  collision_system->CheckForCollisions(rays, results);
+  EXPECT_EQ(results[1].entity, far_entity);
+  EXPECT_NEAR(results[1].distance, 3.f, kEpsilon);
+}
+
+TEST_F(CollisionSystemTest, CheckForCollisionManyCandidates) {
+  // More candidates than fit in one batch, some of them rotated and one that
+  // collides on exit.
+  static const int kNumEntities = 11;
+  static const int kOnExitIndex = 5;
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  auto* collision_system = registry_->Get<CollisionSystem>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+  std::vector<Entity> entities;
+  for (int i = 0; i < kNumEntities; ++i) {
+    TransformDefT transform;
+    transform.position = mathfu::vec3(0.f, 0.f, -3.f - 2.f * i);
+    transform.rotation = mathfu::vec3(0.f, 15.f * i, 0.f);
+    transform.aabb = Aabb(-mathfu::kOnes3f / 2.f, mathfu::kOnes3f / 2.f);
+    CollisionDefT collision;
+    collision.collision_on_exit = i == kOnExitIndex;
+    Blueprint blueprint;
+    blueprint.Write(&transform);
+    blueprint.Write(&collision);
+    entities.push_back(entity_factory->Create(&blueprint));
+  }
+
+  // Each Entity is hit in turn as the ones in front of it are disabled.
+  static const float kEpsilon = 0.001f;
+  const Ray ray(mathfu::vec3(0.1f, 0.1f, 0.f), -mathfu::kAxisZ3f);
+  for (int i = 0; i < kNumEntities; ++i) {
+    const Entity entity = entities[i];
+    const float expected_distance = CheckRayOBBCollision(
+        ray, *transform_system->GetWorldFromEntityMatrix(entity),
+        *transform_system->GetAabb(entity), i == kOnExitIndex);
+    ASSERT_NE(expected_distance, kNoHitDistance);
+
+    const auto result = collision_system->CheckForCollision(ray);
+    EXPECT_EQ(result.entity, entity);
+    EXPECT_NEAR(result.distance, expected_distance, kEpsilon);
+    collision_system->DisableCollision(entity);
+  }
+  EXPECT_EQ(collision_system->CheckForCollision(ray).entity, kNullEntity);
+}
+
 TEST_F(CollisionSystemTest, DefaultInteraction) {
   TransformDefT transform;
   CollisionDefT collision;
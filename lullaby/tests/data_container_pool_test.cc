@@ -0,0 +1,88 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/data_container_pool.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+TEST(DataContainerPoolTest, Allocate) {
+  DataContainerPool::Trim();
+
+  DataContainer container = DataContainerPool::Allocate(100, 16);
+  EXPECT_EQ(100u, container.GetCapacity());
+  EXPECT_EQ(0u, container.GetSize());
+  EXPECT_TRUE(container.IsReadable());
+  EXPECT_TRUE(container.IsWritable());
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(container.GetData()) % 16);
+
+  const uint8_t bytes[] = {1, 2, 3, 4};
+  EXPECT_TRUE(container.Append(bytes, sizeof(bytes)));
+  EXPECT_EQ(3, container.GetReadPtr()[2]);
+}
+
+TEST(DataContainerPoolTest, ReusesBuffers) {
+  DataContainerPool::Trim();
+  const DataContainerPool::Stats start = DataContainerPool::GetStats();
+
+  const uint8_t* ptr = nullptr;
+  {
+    DataContainer container = DataContainerPool::Allocate(1000);
+    ptr = container.GetReadPtr();
+    EXPECT_EQ(start.num_in_use + 1, DataContainerPool::GetStats().num_in_use);
+  }
+  DataContainerPool::Stats stats = DataContainerPool::GetStats();
+  EXPECT_EQ(start.num_in_use, stats.num_in_use);
+  EXPECT_EQ(1u, stats.num_free);
+  EXPECT_EQ(1024u, stats.free_bytes);
+
+  // An allocation of the same size class reuses the returned buffer.
+  DataContainer container = DataContainerPool::Allocate(600, 64);
+  EXPECT_EQ(ptr, container.GetReadPtr());
+  stats = DataContainerPool::GetStats();
+  EXPECT_EQ(start.num_allocations + 2, stats.num_allocations);
+  EXPECT_EQ(start.num_reused + 1, stats.num_reused);
+  EXPECT_EQ(0u, stats.num_free);
+  EXPECT_EQ(0u, stats.free_bytes);
+}
+
+TEST(DataContainerPoolTest, LargeAllocationsAreNotPooled) {
+  DataContainerPool::Trim();
+  const DataContainerPool::Stats start = DataContainerPool::GetStats();
+  {
+    DataContainer container =
+        DataContainerPool::Allocate(DataContainerPool::kMaxPooledSize + 1);
+    EXPECT_EQ(DataContainerPool::kMaxPooledSize + 1, container.GetCapacity());
+  }
+  const DataContainerPool::Stats stats = DataContainerPool::GetStats();
+  EXPECT_EQ(start.num_unpooled + 1, stats.num_unpooled);
+  EXPECT_EQ(0u, stats.num_free);
+}
+
+TEST(DataContainerPoolTest, Trim) {
+  { DataContainer container = DataContainerPool::Allocate(10); }
+  EXPECT_LT(0u, DataContainerPool::GetStats().num_free);
+  DataContainerPool::Trim();
+  EXPECT_EQ(0u, DataContainerPool::GetStats().num_free);
+  EXPECT_EQ(0u, DataContainerPool::GetStats().free_bytes);
+}
+
+}  // namespace
+}  // namespace lull
@@ -260,5 +260,107 @@ TEST(DatastoreSystem, CreateFromDatastoreDef) {
               Eq("hello"));
 }
 
+TEST(DatastoreSystem, ColumnSetGet) {
+  Registry r;
+  DatastoreSystem d(&r);
+  d.DeclareColumn<int>(kTestKey1);
+
+  d.Set(kTestEntity1, kTestKey1, 123);
+  EXPECT_THAT(d.Get<float>(kTestEntity1, kTestKey1), IsNull());
+  ASSERT_THAT(d.Get<int>(kTestEntity1, kTestKey1), NotNull());
+  EXPECT_THAT(*d.Get<int>(kTestEntity1, kTestKey1), Eq(123));
+  EXPECT_THAT(d.Get<int>(kTestEntity2, kTestKey1), IsNull());
+
+  const Variant& var = d.GetVariant(kTestEntity1, kTestKey1);
+  ASSERT_THAT(var.Get<int>(), NotNull());
+  EXPECT_THAT(*var.Get<int>(), Eq(123));
+
+  d.Set(kTestEntity2, kTestKey1, Variant(456));
+  ASSERT_THAT(d.Get<int>(kTestEntity2, kTestKey1), NotNull());
+  EXPECT_THAT(*d.Get<int>(kTestEntity2, kTestKey1), Eq(456));
+
+  // Keys without a column are unaffected.
+  d.Set(kTestEntity1, kTestKey2, 1.f);
+  ASSERT_THAT(d.Get<float>(kTestEntity1, kTestKey2), NotNull());
+  EXPECT_THAT(*d.Get<float>(kTestEntity1, kTestKey2), Eq(1.f));
+}
+
+TEST(DatastoreSystem, ColumnMovesExistingValues) {
+  Registry r;
+  DatastoreSystem d(&r);
+
+  d.Set(kTestEntity1, kTestKey1, 123);
+  d.Set(kTestEntity1, kTestKey2, 456);
+  d.DeclareColumn<int>(kTestKey1);
+
+  ASSERT_THAT(d.Get<int>(kTestEntity1, kTestKey1), NotNull());
+  EXPECT_THAT(*d.Get<int>(kTestEntity1, kTestKey1), Eq(123));
+  ASSERT_THAT(d.Get<int>(kTestEntity1, kTestKey2), NotNull());
+  EXPECT_THAT(*d.Get<int>(kTestEntity1, kTestKey2), Eq(456));
+}
+
+TEST(DatastoreSystem, ColumnRemoveAndDestroy) {
+  Registry r;
+  DatastoreSystem d(&r);
+  d.DeclareColumn<int>(kTestKey1);
+
+  d.Set(kTestEntity1, kTestKey1, 123);
+  d.Set(kTestEntity2, kTestKey1, 456);
+  d.Remove(kTestEntity1, kTestKey1);
+  EXPECT_THAT(d.Get<int>(kTestEntity1, kTestKey1), IsNull());
+  EXPECT_THAT(d.Get<int>(kTestEntity2, kTestKey1), NotNull());
+
+  d.Destroy(kTestEntity2);
+  EXPECT_THAT(d.Get<int>(kTestEntity2, kTestKey1), IsNull());
+  EXPECT_TRUE(d.GetVariant(kTestEntity2, kTestKey1).Empty());
+}
+
+TEST(DatastoreSystem, ColumnForEach) {
+  Registry r;
+  DatastoreSystem d(&r);
+  d.DeclareColumn<int>(kTestKey1);
+
+  d.Set(kTestEntity1, kTestKey1, 1);
+  d.Set(kTestEntity2, kTestKey1, 2);
+
+  std::unordered_map<Entity, int> values;
+  d.ForEachInColumn<int>(kTestKey1, [&](Entity entity, const int& value) {
+    values[entity] = value;
+  });
+  EXPECT_THAT(values.size(), Eq(2ul));
+  EXPECT_THAT(values[kTestEntity1], Eq(1));
+  EXPECT_THAT(values[kTestEntity2], Eq(2));
+
+  // Iterating with the wrong type does nothing.
+  int count = 0;
+  d.ForEachInColumn<float>(kTestKey1,
+                           [&](Entity entity, const float& value) { ++count; });
+  EXPECT_THAT(count, Eq(0));
+}
+
+TEST(DatastoreSystem, ColumnChangeListener) {
+  Registry r;
+  DatastoreSystem d(&r);
+  d.DeclareColumn<int>(kTestKey1);
+
+  int count = 0;
+  d.AddChangeListener(kTestKey1, [&](Entity entity, HashValue key) {
+    EXPECT_THAT(entity, Eq(kTestEntity1));
+    EXPECT_THAT(key, Eq(kTestKey1));
+    ++count;
+  });
+
+  d.Set(kTestEntity1, kTestKey1, 1);
+  EXPECT_THAT(count, Eq(1));
+  d.Set(kTestEntity1, kTestKey1, 1);
+  EXPECT_THAT(count, Eq(1));
+  d.Set(kTestEntity1, kTestKey1, Variant(2));
+  EXPECT_THAT(count, Eq(2));
+  d.Remove(kTestEntity1, kTestKey1);
+  EXPECT_THAT(count, Eq(3));
+  d.Remove(kTestEntity1, kTestKey1);
+  EXPECT_THAT(count, Eq(3));
+}
+
 }  // namespace
 }  // namespace lull
@@ -0,0 +1,126 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/debug/debug_render_impl.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/modules/render/render_view.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/testing/mock_render_system_impl.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+using ::testing::_;
+using ::testing::Invoke;
+
+const Color4ub kOpaque(255, 0, 0, 255);
+const Color4ub kTransparent(0, 255, 0, 128);
+
+// A single DrawMesh call made by the DebugRenderImpl.
+struct DrawCall {
+  MeshData::PrimitiveType primitive_type;
+  size_t num_vertices;
+  size_t num_indices;
+  bool depth_write;
+};
+
+class DebugRenderImplTest : public ::testing::Test {
+ public:
+  DebugRenderImplTest() {
+    auto* entity_factory = registry_.Create<EntityFactory>(&registry_);
+    render_system_ = entity_factory->CreateSystem<RenderSystem>()->GetImpl();
+
+    ON_CALL(*render_system_, SetDepthWrite(_))
+        .WillByDefault(
+            Invoke([this](bool enabled) { depth_write_ = enabled; }));
+    ON_CALL(*render_system_, DrawMesh(_, _))
+        .WillByDefault(Invoke(
+            [this](const MeshData& mesh, Optional<mathfu::mat4> matrix) {
+              draws_.push_back({mesh.GetPrimitiveType(), mesh.GetNumVertices(),
+                                mesh.GetNumIndices(), depth_write_});
+            }));
+
+    debug_render_.reset(new DebugRenderImpl(&registry_));
+  }
+
+ protected:
+  Registry registry_;
+  RenderSystemImpl* render_system_ = nullptr;
+  std::unique_ptr<DebugRenderImpl> debug_render_;
+  std::vector<DrawCall> draws_;
+  bool depth_write_ = false;
+};
+
+TEST_F(DebugRenderImplTest, BatchesShapesPerState) {
+  RenderView views[2];
+  debug_render_->Begin(views, 2);
+
+  const Aabb box(mathfu::vec3(-1.0f), mathfu::vec3(1.0f));
+  debug_render_->DrawLine(mathfu::kZeros3f, mathfu::kAxisX3f, kOpaque);
+  debug_render_->DrawLine(mathfu::kZeros3f, mathfu::kAxisY3f, kOpaque);
+  debug_render_->DrawLine(mathfu::kZeros3f, mathfu::kAxisZ3f, kTransparent);
+  debug_render_->DrawBox3D(mathfu::mat4::Identity(), box, kOpaque);
+  debug_render_->DrawBox3D(mathfu::mat4::Identity(), box, kOpaque);
+
+  // Nothing is drawn until the batches are flushed.
+  EXPECT_TRUE(draws_.empty());
+  debug_render_->End();
+
+  // Per view: opaque boxes, opaque lines, then transparent lines.
+  ASSERT_EQ(draws_.size(), 6u);
+  for (size_t i = 0; i < draws_.size(); i += 3) {
+    EXPECT_EQ(draws_[i].primitive_type, MeshData::PrimitiveType::kTriangles);
+    EXPECT_EQ(draws_[i].num_vertices, 16u);
+    EXPECT_EQ(draws_[i].num_indices, 72u);
+    EXPECT_TRUE(draws_[i].depth_write);
+
+    EXPECT_EQ(draws_[i + 1].primitive_type, MeshData::PrimitiveType::kLines);
+    EXPECT_EQ(draws_[i + 1].num_vertices, 4u);
+    EXPECT_TRUE(draws_[i + 1].depth_write);
+
+    EXPECT_EQ(draws_[i + 2].primitive_type, MeshData::PrimitiveType::kLines);
+    EXPECT_EQ(draws_[i + 2].num_vertices, 2u);
+    EXPECT_FALSE(draws_[i + 2].depth_write);
+  }
+}
+
+TEST_F(DebugRenderImplTest, FlushClearsBatches) {
+  RenderView view;
+  debug_render_->Begin(&view, 1);
+
+  debug_render_->DrawLine(mathfu::kZeros3f, mathfu::kAxisX3f, kOpaque);
+  debug_render_->Flush();
+  ASSERT_EQ(draws_.size(), 1u);
+
+  // Shapes already drawn are not drawn again.
+  debug_render_->DrawLine(mathfu::kZeros3f, mathfu::kAxisY3f, kOpaque);
+  debug_render_->End();
+  ASSERT_EQ(draws_.size(), 2u);
+  EXPECT_EQ(draws_[1].num_vertices, 2u);
+
+  debug_render_->End();
+  EXPECT_EQ(draws_.size(), 2u);
+}
+
+}  // namespace
+}  // namespace lull
@@ -14,6 +14,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -25,6 +30,7 @@ limitations under the License.
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/render/testing/mock_render_system_impl.h"
 #include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/job_processor.h"
 #include "lullaby/util/registry.h"
 #include "lullaby/tests/mathfu_matchers.h"
 #include "lullaby/generated/transform_def_generated.h"
@@ -100,6 +106,20 @@ class DeformSystemTest : public ::testing::Test {
                 NearMathfu(mathfu::vec3(2.45548f, 8.0f, -4.5552f), kEpsilon));
   }
 
+  // Runs the deformation function set on the render system for |e| over
+  // |verts| in place.
+  void DeformVertices(Entity e, std::vector<VertexP>* verts) {
+    ASSERT_THAT(deformation_fns_, Contains(Key(e)));
+    const size_t num_bytes = verts->size() * sizeof(VertexP);
+    DataContainer vertex_data(
+        DataContainer::DataPtr(reinterpret_cast<uint8_t*>(verts->data()),
+                               [](const void*) {}),
+        num_bytes, num_bytes, DataContainer::kAll);
+    MeshData mesh(MeshData::kTriangles, VertexP::kFormat,
+                  std::move(vertex_data));
+    deformation_fns_[e](&mesh);
+  }
+
   // Checks that the deform system reports the entity as undeformed and that
   // there is a deformation function set that either is null or reports an error
   // when called.
@@ -463,6 +483,99 @@ TEST_F(DeformSystemTest, DeformedInCode) {
   ExpectDeformedTransform(deformed, offset);
 }
 
+TEST_F(DeformSystemTest, LargeMeshDeformedOnJobProcessor) {
+  Blueprint blueprint;
+  {
+    TransformDefT transform;
+    blueprint.Write(&transform);
+
+    DeformerDefT deformer;
+    deformer.horizontal_radius = kDeformRadius;
+    blueprint.Write(&deformer);
+  }
+  Entity deformer = entity_factory_->Create(&blueprint);
+
+  lull::Sqt sqt;
+  sqt.translation = mathfu::vec3(1.0f, 0.0f, 0.0f);
+  Entity deformed = entity_factory_->Create();
+  transform_system_->Create(deformed, sqt);
+  deform_system_->SetAsDeformed(deformed);
+  transform_system_->AddChild(deformer, deformed);
+
+  // Enough vertices to be split into several jobs, with a partial last range.
+  std::vector<VertexP> expected;
+  for (int i = 0; i < 10000; ++i) {
+    const float t = static_cast<float>(i) * 0.001f;
+    expected.emplace_back(t, 2.0f * t, 3.0f - t);
+  }
+  std::vector<VertexP> actual = expected;
+
+  DeformVertices(deformed, &expected);
+  registry_.Create<JobProcessor>(/* num_worker_threads = */ 3);
+  DeformVertices(deformed, &actual);
+
+  ASSERT_THAT(actual.size(), Eq(expected.size()));
+  for (size_t i = 0; i < actual.size(); ++i) {
+    EXPECT_THAT(GetPosition(actual[i]),
+                NearMathfu(GetPosition(expected[i]), kEpsilon));
+  }
+}
+
+TEST_F(DeformSystemTest, GpuDeformSetsUniformsInsteadOfDeformingMesh) {
+  Blueprint blueprint;
+  {
+    TransformDefT transform;
+    blueprint.Write(&transform);
+
+    DeformerDefT deformer;
+    deformer.horizontal_radius = kDeformRadius;
+    deformer.gpu_deform = true;
+    blueprint.Write(&deformer);
+  }
+  Entity deformer = entity_factory_->Create(&blueprint);
+
+  lull::Sqt sqt;
+  sqt.translation = mathfu::vec3(1.0f, 0.0f, 0.0f);
+  Entity deformed = entity_factory_->Create();
+  transform_system_->Create(deformed, sqt);
+  deform_system_->SetAsDeformed(deformed);
+  transform_system_->AddChild(deformer, deformed);
+
+  std::map<std::string, ShaderDataType> uniforms;
+  float radius = 0.0f;
+  ON_CALL(*mock_render_system_, SetUniform(deformed, _, _, _, _, _, _))
+      .WillByDefault(Invoke([&](Entity e, Optional<HashValue> pass,
+                                Optional<int> submesh_index, string_view name,
+                                ShaderDataType type, Span<uint8_t> data,
+                                int count) {
+        uniforms[name.to_string()] = type;
+        if (name == "deform_radius") {
+          std::memcpy(&radius, data.data(), sizeof(radius));
+        }
+      }));
+
+  std::vector<VertexP> verts = {
+      VertexP(1.0f, 2.0f, 3.0f),
+      VertexP(4.0f, 5.0f, 6.0f),
+  };
+  const std::vector<VertexP> undeformed = verts;
+  DeformVertices(deformed, &verts);
+
+  for (size_t i = 0; i < verts.size(); ++i) {
+    EXPECT_THAT(GetPosition(verts[i]),
+                NearMathfu(GetPosition(undeformed[i]), kEpsilon));
+  }
+  EXPECT_THAT(uniforms, Contains(std::make_pair(std::string("deform_radius"),
+                                                ShaderDataType_Float1)));
+  EXPECT_THAT(uniforms,
+              Contains(std::make_pair(std::string("deform_root_from_entity"),
+                                      ShaderDataType_Float4x4)));
+  EXPECT_THAT(uniforms,
+              Contains(std::make_pair(std::string("deform_entity_from_root"),
+                                      ShaderDataType_Float4x4)));
+  EXPECT_THAT(radius, FloatNear(kDeformRadius, kEpsilon));
+}
+
 TEST_F(DeformSystemTest, DeformedSetWorldFromEntityMatrix) {
   const mathfu::vec3 offset(0.5f, 0.0f, 0.0f);
   Blueprint blueprint1;
@@ -0,0 +1,202 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/serialize/delta_serializer.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lullaby/util/hash.h"
+#include "mathfu/constants.h"
+
+namespace lull {
+namespace {
+
+constexpr HashValue kStateType = ConstHash("State");
+constexpr float kEpsilon = 1e-3f;
+
+struct State {
+  mathfu::vec3 position = mathfu::kZeros3f;
+  mathfu::quat rotation = mathfu::quat::identity;
+  int count = 0;
+  std::string name;
+
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(&position, ConstHash("position"));
+    archive(&rotation, ConstHash("rotation"));
+    archive(&count, ConstHash("count"));
+    archive(&name, ConstHash("name"));
+  }
+};
+
+// Reads |buffer| with |decoder|, restoring the state of |entity| into |state|.
+uint32_t ReadState(DeltaDecoder* decoder, const DeltaEncoder::Buffer& buffer,
+                   Entity entity, State* state) {
+  return decoder->Read(buffer, [&](Entity e, HashValue type,
+                                   const DeltaSnapshot& snapshot) {
+    EXPECT_EQ(e, entity);
+    EXPECT_EQ(type, kStateType);
+    EXPECT_TRUE(snapshot.Restore(state));
+  });
+}
+
+TEST(DeltaSerializer, PacksQuaternions) {
+  const mathfu::quat rotations[] = {
+      mathfu::quat::identity,
+      mathfu::quat::FromEulerAngles(mathfu::vec3(0.5f, -1.f, 2.f)),
+      mathfu::quat(-0.5f, 0.5f, -0.5f, 0.5f),
+  };
+  for (const mathfu::quat& rotation : rotations) {
+    const mathfu::quat unpacked = UnpackQuaternion(PackQuaternion(rotation));
+    // q and -q are the same rotation.
+    EXPECT_NEAR(std::abs(mathfu::quat::DotProduct(rotation, unpacked)), 1.f,
+                kEpsilon);
+  }
+}
+
+TEST(DeltaSerializer, WritesOnlyChangedFields) {
+  const Entity entity(7);
+  DeltaEncoder encoder;
+  DeltaDecoder decoder;
+
+  State state;
+  state.position = mathfu::vec3(1.f, 2.f, 3.f);
+  state.rotation = mathfu::quat::FromEulerAngles(mathfu::vec3(0.f, 1.f, 0.f));
+  state.count = -5;
+  state.name = "hello";
+
+  uint32_t sequence = encoder.BeginTick();
+  encoder.Write(entity, kStateType, &state);
+  const DeltaEncoder::Buffer full = encoder.EndTick();
+
+  State received;
+  EXPECT_EQ(ReadState(&decoder, full, entity, &received), sequence);
+  EXPECT_NEAR(received.position.x, 1.f, kEpsilon);
+  EXPECT_NEAR(received.position.y, 2.f, kEpsilon);
+  EXPECT_NEAR(received.position.z, 3.f, kEpsilon);
+  EXPECT_NEAR(mathfu::quat::DotProduct(received.rotation, state.rotation), 1.f,
+              kEpsilon);
+  EXPECT_EQ(received.count, -5);
+  EXPECT_EQ(received.name, "hello");
+  encoder.Acknowledge(sequence);
+
+  state.count = 10;
+  sequence = encoder.BeginTick();
+  encoder.Write(entity, kStateType, &state);
+  const DeltaEncoder::Buffer delta = encoder.EndTick();
+  EXPECT_LT(delta.size(), full.size());
+
+  received.name.clear();
+  EXPECT_EQ(ReadState(&decoder, delta, entity, &received), sequence);
+  EXPECT_EQ(received.count, 10);
+  EXPECT_EQ(received.name, "hello");
+}
+
+TEST(DeltaSerializer, SkipsUnchanged) {
+  const Entity entity(1);
+  DeltaEncoder encoder;
+  State state;
+
+  const uint32_t sequence = encoder.BeginTick();
+  encoder.Write(entity, kStateType, &state);
+  encoder.EndTick();
+  encoder.Acknowledge(sequence);
+
+  encoder.BeginTick();
+  encoder.Write(entity, kStateType, &state);
+  // Only the tick's sequence number.
+  EXPECT_EQ(encoder.EndTick().size(), 1u);
+}
+
+TEST(DeltaSerializer, ToleratesLostTicks) {
+  const Entity entity(3);
+  DeltaEncoder encoder;
+  DeltaDecoder decoder;
+  State state;
+  State received;
+
+  state.count = 1;
+  uint32_t sequence = encoder.BeginTick();
+  encoder.Write(entity, kStateType, &state);
+  ReadState(&decoder, encoder.EndTick(), entity, &received);
+  encoder.Acknowledge(sequence);
+
+  // Lost.
+  state.count = 2;
+  state.name = "lost";
+  encoder.BeginTick();
+  encoder.Write(entity, kStateType, &state);
+  encoder.EndTick();
+
+  state.count = 3;
+  sequence = encoder.BeginTick();
+  encoder.Write(entity, kStateType, &state);
+  EXPECT_EQ(ReadState(&decoder, encoder.EndTick(), entity, &received),
+            sequence);
+  EXPECT_EQ(received.count, 3);
+  EXPECT_EQ(received.name, "lost");
+}
+
+TEST(DeltaSerializer, SendsRevertedChanges) {
+  const Entity entity(3);
+  DeltaEncoder encoder;
+  DeltaDecoder decoder;
+  State state;
+  State received;
+
+  state.count = 1;
+  uint32_t sequence = encoder.BeginTick();
+  encoder.Write(entity, kStateType, &state);
+  ReadState(&decoder, encoder.EndTick(), entity, &received);
+  encoder.Acknowledge(sequence);
+
+  // Received, but not yet acknowledged.
+  state.count = 2;
+  encoder.BeginTick();
+  encoder.Write(entity, kStateType, &state);
+  ReadState(&decoder, encoder.EndTick(), entity, &received);
+  EXPECT_EQ(received.count, 2);
+
+  state.count = 1;
+  encoder.BeginTick();
+  encoder.Write(entity, kStateType, &state);
+  ReadState(&decoder, encoder.EndTick(), entity, &received);
+  EXPECT_EQ(received.count, 1);
+}
+
+TEST(DeltaSerializer, RejectsTruncatedBuffers) {
+  DeltaEncoder encoder;
+  DeltaDecoder decoder;
+  State state;
+  state.name = "truncated";
+
+  encoder.BeginTick();
+  encoder.Write(Entity(1), kStateType, &state);
+  DeltaEncoder::Buffer buffer = encoder.EndTick();
+  buffer.resize(buffer.size() - 2);
+
+  int count = 0;
+  EXPECT_EQ(decoder.Read(buffer, [&](Entity, HashValue,
+                                     const DeltaSnapshot&) { ++count; }),
+            0u);
+  EXPECT_EQ(count, 0);
+}
+
+}  // namespace
+}  // namespace lull
@@ -256,6 +256,85 @@ TEST(Dispatcher, RemoveRentrant) {
   EXPECT_EQ(123, h.value);
 }
 
+TEST(Dispatcher, RemoveRentrantSkipsRemoved) {
+  Dispatcher d;
+  EventHandlerClass h;
+
+  Dispatcher::ScopedConnection c2;
+  auto c1 = d.Connect([&](const Event& event) { c2.Disconnect(); });
+  c2 = d.Connect([&](const Event& event) { h.HandleEvent(event); });
+
+  d.Send(Event(123));
+  EXPECT_EQ(static_cast<size_t>(1), d.GetHandlerCount());
+  EXPECT_EQ(0, h.value);
+}
+
+TEST(Dispatcher, AddAndRemoveRentrant) {
+  Dispatcher d;
+  EventHandlerClass h;
+
+  auto c1 = d.Connect([&](const Event& event) {
+    auto c2 = d.Connect([&](const Event& event) { h.HandleEvent(event); });
+    c2.Disconnect();
+    d.Connect(&h, [&](const Event& event) { h.HandleEvent(event); });
+    d.DisconnectAll(&h);
+  });
+
+  d.Send(Event(123));
+  EXPECT_EQ(static_cast<size_t>(1), d.GetHandlerCount());
+
+  d.Send(Event(456));
+  EXPECT_EQ(static_cast<size_t>(1), d.GetHandlerCount());
+  EXPECT_EQ(0, h.value);
+}
+
+TEST(Dispatcher, StaleConnectionId) {
+  Dispatcher d;
+  EventHandlerClass h;
+
+  auto c1 = d.Connect(&h, [&](const Event& event) { h.HandleEvent(event); });
+  const Dispatcher::ConnectionId id = c1.GetId();
+  c1.Disconnect();
+  EXPECT_EQ(static_cast<size_t>(0), d.GetHandlerCount());
+
+  // Disconnecting with an id that is no longer in use should not affect newer
+  // connections, even if they reuse the same internal storage.
+  auto c2 = d.Connect(&h, [&](const Event& event) { h.HandleEvent(event); });
+  EXPECT_NE(id, c2.GetId());
+  d.Disconnect(GetTypeId<Event>(), id);
+  EXPECT_EQ(static_cast<size_t>(1), d.GetHandlerCount());
+
+  d.Send(Event(123));
+  EXPECT_EQ(123, h.value);
+}
+
+TEST(Dispatcher, ManyConnections) {
+  Dispatcher d;
+  int sum = 0;
+
+  std::vector<Dispatcher::ScopedConnection> connections;
+  for (int i = 0; i < 100; ++i) {
+    connections.emplace_back(
+        d.Connect([&sum, i](const Event& event) { sum += i; }));
+  }
+  for (int i = 1; i < 100; i += 2) {
+    connections[i].Disconnect();
+  }
+  EXPECT_EQ(static_cast<size_t>(50), d.GetHandlerCount(GetTypeId<Event>()));
+
+  d.Send(Event(123));
+  EXPECT_EQ(2450, sum);
+
+  // Removing the remaining connections in reverse order should leave the
+  // earlier connections intact.
+  for (int i = 98; i >= 50; i -= 2) {
+    connections[i].Disconnect();
+  }
+  sum = 0;
+  d.Send(Event(123));
+  EXPECT_EQ(600, sum);
+}
+
 TEST(Dispatcher, DisconnectAfterDelete) {
   {
     Dispatcher::ScopedConnection c;
@@ -554,5 +633,79 @@ TEST(Dispatcher, ConnectToAll) {
   EXPECT_EQ(456, h.value);
 }
 
+TEST(Dispatcher, Channels) {
+  Dispatcher d;
+  int value0 = 0;
+  int value1 = 0;
+  int value2 = 0;
+  int count2 = 0;
+
+  auto c0 = d.Connect([&](const Event& event) { value0 = event.value; });
+  auto c1 = d.ConnectToChannel(
+      1, [&](const Event& event) { value1 = event.value; });
+  d.ConnectToChannel(2, &value2,
+                     [&](const Event& event) { value2 = event.value; });
+  d.ConnectToChannel(2, 0, &value2,
+                     [&](const EventWrapper& event) { ++count2; });
+
+  EXPECT_EQ(static_cast<size_t>(4), d.GetHandlerCount());
+  EXPECT_EQ(static_cast<size_t>(1), d.GetHandlerCount(GetTypeId<Event>()));
+  EXPECT_EQ(static_cast<size_t>(1), d.GetChannelHandlerCount(1));
+  EXPECT_EQ(static_cast<size_t>(2), d.GetChannelHandlerCount(2));
+  EXPECT_EQ(static_cast<size_t>(1),
+            d.GetChannelHandlerCount(2, GetTypeId<Event>()));
+
+  d.Send(Event(123));
+  EXPECT_EQ(123, value0);
+  EXPECT_EQ(0, value1);
+  EXPECT_EQ(0, value2);
+
+  d.SendToChannel(1, EventWrapper(Event(456)));
+  EXPECT_EQ(123, value0);
+  EXPECT_EQ(456, value1);
+  EXPECT_EQ(0, value2);
+
+  d.SendToChannel(2, EventWrapper(Event(789)));
+  d.SendToChannel(2, EventWrapper(OtherEvent("Hello")));
+  EXPECT_EQ(456, value1);
+  EXPECT_EQ(789, value2);
+  EXPECT_EQ(2, count2);
+
+  d.DisconnectFromChannel(2, GetTypeId<Event>(), &value2);
+  EXPECT_EQ(static_cast<size_t>(1), d.GetChannelHandlerCount(2));
+  d.SendToChannel(2, EventWrapper(Event(1)));
+  EXPECT_EQ(789, value2);
+  EXPECT_EQ(3, count2);
+
+  d.DisconnectChannel(2);
+  EXPECT_EQ(static_cast<size_t>(0), d.GetChannelHandlerCount(2));
+  d.SendToChannel(2, EventWrapper(Event(1)));
+  EXPECT_EQ(3, count2);
+
+  c1.Disconnect();
+  EXPECT_EQ(static_cast<size_t>(0), d.GetChannelHandlerCount(1));
+  EXPECT_EQ(static_cast<size_t>(1), d.GetHandlerCount());
+}
+
+TEST(Dispatcher, DisconnectChannelWhileSending) {
+  Dispatcher d;
+  int count = 0;
+  d.ConnectToChannel(1, &count, [&](const Event& event) {
+    ++count;
+    d.DisconnectChannel(1);
+  });
+  d.ConnectToChannel(1, &count, [&](const Event& event) { ++count; });
+
+  d.SendToChannel(1, EventWrapper(Event(1)));
+  EXPECT_EQ(1, count);
+  EXPECT_EQ(static_cast<size_t>(0), d.GetChannelHandlerCount(1));
+
+  // Connecting again after the channel is empty works as normal.
+  d.ConnectToChannel(1, &count, [&](const Event& event) { ++count; });
+  d.SendToChannel(1, EventWrapper(Event(1)));
+  EXPECT_EQ(2, count);
+  EXPECT_EQ(static_cast<size_t>(1), d.GetHandlerCount());
+}
+
 }  // namespace
 }  // namespace lull
@@ -199,5 +199,72 @@ TEST_F(DisplayListTest, AverageSpaceOriginBackToFront) {
   }
 }
 
+TEST_F(DisplayListTest, WorldSpaceZRepopulate) {
+  pool_->SetSortMode(SortMode_WorldSpaceZBackToFront);
+  auto* transform_system = registry_->Get<TransformSystem>();
+
+  auto expect_sorted = [&](const DisplayList& list) {
+    const std::vector<DisplayList::Entry>& contents = *list.GetContents();
+    EXPECT_EQ(entities_.size(), contents.size());
+    for (size_t i = 0; i < contents.size(); ++i) {
+      EXPECT_EQ(transform_system->GetWorldFromEntityMatrix(contents[i].entity),
+                contents[i].world_from_entity_matrix);
+      if (i > 0) {
+        EXPECT_LE(contents[i - 1].world_from_entity_matrix->
+                      TranslationVector3D().z,
+                  contents[i].world_from_entity_matrix->
+                      TranslationVector3D().z);
+      }
+    }
+  };
+
+  DisplayList list(registry_.get());
+  list.Populate(*pool_, nullptr, 0);
+  expect_sorted(list);
+
+  // Slightly move a few entities, which only requires fixing up the previous
+  // order.
+  for (size_t i = 0; i < entities_.size(); i += 10) {
+    Sqt sqt = *transform_system->GetSqt(entities_[i]);
+    sqt.translation.z += 5.f;
+    transform_system->SetSqt(entities_[i], sqt);
+  }
+  list.Populate(*pool_, nullptr, 0);
+  expect_sorted(list);
+
+  // Reverse the order of all the entities, which requires a full sort.
+  for (Entity entity : entities_) {
+    Sqt sqt = *transform_system->GetSqt(entity);
+    sqt.translation.z = -sqt.translation.z;
+    transform_system->SetSqt(entity, sqt);
+  }
+  list.Populate(*pool_, nullptr, 0);
+  expect_sorted(list);
+
+  // Changes to the number of entities are also handled.
+  CreateEntities(10);
+  list.Populate(*pool_, nullptr, 0);
+  expect_sorted(list);
+}
+
+TEST_F(DisplayListTest, SortOrderRepopulate) {
+  pool_->SetSortMode(SortMode_SortOrderIncreasing);
+
+  DisplayList list(registry_.get());
+  list.Populate(*pool_, nullptr, 0);
+
+  for (size_t i = 0; i < entities_.size(); ++i) {
+    pool_->GetComponent(entities_[i])->sort_order =
+        static_cast<uint32_t>(entities_.size() - i);
+  }
+  list.Populate(*pool_, nullptr, 0);
+
+  const std::vector<DisplayList::Entry> contents = *list.GetContents();
+  ASSERT_EQ(entities_.size(), contents.size());
+  for (size_t i = 0; i < contents.size(); ++i) {
+    EXPECT_EQ(entities_[entities_.size() - 1 - i], contents[i].entity);
+  }
+}
+
 }  // namespace
 }  // namespace lull
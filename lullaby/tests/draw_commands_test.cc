@@ -0,0 +1,112 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/draw_commands.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+MATCHER_P2(IsDraw, index, count, "") {
+  return arg.index == static_cast<uint32_t>(index) &&
+         arg.count == static_cast<uint32_t>(count);
+}
+
+TEST(DrawCommandsTest, OneDrawPerObjectWithoutInstancing) {
+  std::vector<DrawCommand> draws;
+  RecordDrawCommands(
+      3, false, [](size_t) -> size_t {
+        ADD_FAILURE() << "Instancing is disabled.";
+        return 1;
+      },
+      &draws);
+  EXPECT_THAT(draws, ElementsAre(IsDraw(0, 1), IsDraw(1, 1), IsDraw(2, 1)));
+}
+
+TEST(DrawCommandsTest, GroupsInstanceableObjects) {
+  // Objects 1-3 and 4-5 can be drawn together.
+  const size_t counts[] = {1, 3, 0, 0, 2, 0, 1};
+  std::vector<size_t> queried;
+  std::vector<DrawCommand> draws;
+  RecordDrawCommands(7, true,
+                     [&](size_t index) {
+                       queried.push_back(index);
+                       return counts[index];
+                     },
+                     &draws);
+  EXPECT_THAT(draws, ElementsAre(IsDraw(0, 1), IsDraw(1, 3), IsDraw(4, 2),
+                                 IsDraw(6, 1)));
+  EXPECT_THAT(queried, ElementsAre(0, 1, 4, 6));
+}
+
+TEST(DrawCommandsTest, ReusesStorage) {
+  std::vector<DrawCommand> draws;
+  RecordDrawCommands(4, false, nullptr, &draws);
+  EXPECT_EQ(draws.size(), 4u);
+
+  RecordDrawCommands(0, false, nullptr, &draws);
+  EXPECT_THAT(draws, IsEmpty());
+}
+
+TEST(DrawCommandsTest, RecordsInOrderWithoutJobProcessor) {
+  std::vector<size_t> recorded;
+  RecordConcurrently(nullptr, 4, [&](size_t i) { recorded.push_back(i); });
+  EXPECT_THAT(recorded, ElementsAre(0, 1, 2, 3));
+}
+
+TEST(DrawCommandsTest, RecordsInOrderWithoutWorkers) {
+  JobProcessor job_processor(0);
+  std::vector<size_t> recorded;
+  RecordConcurrently(&job_processor, 3,
+                     [&](size_t i) { recorded.push_back(i); });
+  EXPECT_THAT(recorded, ElementsAre(0, 1, 2));
+}
+
+TEST(DrawCommandsTest, RecordsEveryIndexConcurrently) {
+  JobProcessor job_processor(2);
+  const std::thread::id caller = std::this_thread::get_id();
+  const size_t kCount = 5;
+  std::atomic<int> calls[kCount];
+  for (auto& c : calls) {
+    c = 0;
+  }
+  std::thread::id first_thread;
+  RecordConcurrently(&job_processor, kCount, [&](size_t i) {
+    ++calls[i];
+    if (i == 0) {
+      first_thread = std::this_thread::get_id();
+    }
+  });
+
+  // Every call has finished once RecordConcurrently returns.
+  for (const auto& c : calls) {
+    EXPECT_EQ(c, 1);
+  }
+  // The calling thread records the first index itself.
+  EXPECT_EQ(first_thread, caller);
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,237 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/dynamic_aabb_tree.h"
+
+#include <limits>
+#include <unordered_set>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Le;
+
+constexpr float kEpsilon = 0.001f;
+constexpr float kMaxDistance = std::numeric_limits<float>::max();
+
+Aabb UnitBoxAt(const mathfu::vec3& center) {
+  return Aabb(center - mathfu::vec3(0.5f), center + mathfu::vec3(0.5f));
+}
+
+TEST(DynamicAabbTreeTest, Empty) {
+  DynamicAabbTree tree;
+  EXPECT_THAT(tree.Size(), Eq(size_t(0)));
+  EXPECT_THAT(tree.GetHeight(), Eq(0));
+
+  int count = 0;
+  tree.QueryPoint(mathfu::kZeros3f, [&](Entity) { ++count; });
+  tree.Raycast(Ray(mathfu::kZeros3f, -mathfu::kAxisZ3f), kMaxDistance,
+               [&](Entity) {
+                 ++count;
+                 return kMaxDistance;
+               });
+  EXPECT_THAT(count, Eq(0));
+}
+
+TEST(DynamicAabbTreeTest, QueryPoint) {
+  DynamicAabbTree tree;
+  tree.Insert(UnitBoxAt(mathfu::vec3(0.f, 0.f, 0.f)), Entity(1));
+  tree.Insert(UnitBoxAt(mathfu::vec3(0.25f, 0.f, 0.f)), Entity(2));
+  tree.Insert(UnitBoxAt(mathfu::vec3(5.f, 0.f, 0.f)), Entity(3));
+
+  std::unordered_set<Entity> hits;
+  tree.QueryPoint(mathfu::vec3(0.1f, 0.f, 0.f),
+                  [&](Entity e) { hits.insert(e); });
+  EXPECT_THAT(hits, Eq(std::unordered_set<Entity>{1, 2}));
+
+  hits.clear();
+  tree.QueryPoint(mathfu::vec3(5.f, 0.f, 0.f),
+                  [&](Entity e) { hits.insert(e); });
+  EXPECT_THAT(hits, Eq(std::unordered_set<Entity>{3}));
+
+  hits.clear();
+  tree.QueryPoint(mathfu::vec3(2.f, 0.f, 0.f),
+                  [&](Entity e) { hits.insert(e); });
+  EXPECT_TRUE(hits.empty());
+}
+
+TEST(DynamicAabbTreeTest, RaycastVisitsNearestFirst) {
+  DynamicAabbTree tree;
+  for (int i = 1; i <= 16; ++i) {
+    tree.Insert(UnitBoxAt(mathfu::vec3(0.f, 0.f, -2.f * static_cast<float>(i))),
+                Entity(i));
+  }
+
+  // Report the distance to the front face of each box as the exact hit, which
+  // should prune every box behind the first one.
+  std::vector<Entity> visited;
+  tree.Raycast(Ray(mathfu::kZeros3f, -mathfu::kAxisZ3f), kMaxDistance,
+               [&](Entity e) {
+                 visited.push_back(e);
+                 return 2.f * static_cast<float>(e.AsUint32()) - 0.5f;
+               });
+  ASSERT_THAT(visited.size(), Le(size_t(2)));
+  EXPECT_THAT(visited[0], Eq(Entity(1)));
+}
+
+TEST(DynamicAabbTreeTest, RaycastDistanceIgnoresDirectionLength) {
+  DynamicAabbTree tree;
+  tree.Insert(UnitBoxAt(mathfu::vec3(0.f, 0.f, -3.f)), Entity(1));
+
+  float max_distance = kMaxDistance;
+  tree.Raycast(Ray(mathfu::kZeros3f, mathfu::vec3(0.f, 0.f, -10.f)),
+               max_distance, [&](Entity e) {
+                 EXPECT_THAT(e, Eq(Entity(1)));
+                 return kMaxDistance;
+               });
+
+  // A maximum distance in front of the box should prevent any hits.
+  int count = 0;
+  tree.Raycast(Ray(mathfu::kZeros3f, mathfu::vec3(0.f, 0.f, -10.f)), 2.f,
+               [&](Entity) {
+                 ++count;
+                 return 2.f;
+               });
+  EXPECT_THAT(count, Eq(0));
+}
+
+TEST(DynamicAabbTreeTest, RaycastFromInside) {
+  DynamicAabbTree tree;
+  tree.Insert(UnitBoxAt(mathfu::kZeros3f), Entity(1));
+
+  int count = 0;
+  tree.Raycast(Ray(mathfu::kZeros3f, mathfu::kAxisX3f), 0.f, [&](Entity) {
+    ++count;
+    return 0.f;
+  });
+  EXPECT_THAT(count, Eq(1));
+}
+
+TEST(DynamicAabbTreeTest, QueryAabb) {
+  DynamicAabbTree tree;
+  tree.Insert(UnitBoxAt(mathfu::vec3(0.f, 0.f, 0.f)), Entity(1));
+  tree.Insert(UnitBoxAt(mathfu::vec3(2.f, 0.f, 0.f)), Entity(2));
+  tree.Insert(UnitBoxAt(mathfu::vec3(4.f, 0.f, 0.f)), Entity(3));
+
+  std::unordered_set<Entity> hits;
+  tree.QueryAabb(Aabb(mathfu::vec3(0.25f, -1.f, -1.f),
+                      mathfu::vec3(1.75f, 1.f, 1.f)),
+                 [&](Entity e) { hits.insert(e); });
+  EXPECT_THAT(hits, Eq(std::unordered_set<Entity>{1, 2}));
+}
+
+TEST(DynamicAabbTreeTest, QueryFrustum) {
+  DynamicAabbTree tree;
+  tree.Insert(UnitBoxAt(mathfu::vec3(0.f, 0.f, -5.f)), Entity(1));
+  tree.Insert(UnitBoxAt(mathfu::vec3(0.f, 0.f, 5.f)), Entity(2));
+  tree.Insert(UnitBoxAt(mathfu::vec3(50.f, 0.f, -5.f)), Entity(3));
+  // Straddles the left plane.
+  tree.Insert(UnitBoxAt(mathfu::vec3(-10.f, 0.f, -10.f)), Entity(4));
+
+  // A 90 degree frustum looking down -z.
+  mathfu::vec4 planes[kNumFrustumPlanes];
+  CalculateViewFrustum(
+      mathfu::mat4::Perspective(0.5f * kPi, 1.f, 0.1f, 100.f), planes);
+
+  std::unordered_set<Entity> hits;
+  tree.QueryFrustum(planes, [&](Entity e) { hits.insert(e); });
+  EXPECT_THAT(hits, Eq(std::unordered_set<Entity>{1, 4}));
+}
+
+TEST(DynamicAabbTreeTest, QueryNearestVisitsNearestFirst) {
+  DynamicAabbTree tree;
+  for (int i = 0; i < 16; ++i) {
+    tree.Insert(UnitBoxAt(mathfu::vec3(2.f * static_cast<float>(i), 0.f, 0.f)),
+                Entity(i + 1));
+  }
+
+  // Stop after the three nearest.
+  std::vector<Entity> hits;
+  tree.QueryNearest(mathfu::vec3(13.f, 0.f, 0.f), kMaxDistance,
+                    [&](Entity e) {
+                      hits.push_back(e);
+                      return hits.size() < 3 ? kMaxDistance : 0.f;
+                    });
+  ASSERT_THAT(hits.size(), Eq(size_t(3)));
+  // Entities 7 and 8 are both 0.5 away from the point.
+  EXPECT_THAT(std::unordered_set<Entity>(hits.begin(), hits.begin() + 2),
+              Eq(std::unordered_set<Entity>{7, 8}));
+  EXPECT_TRUE(hits[2] == Entity(6) || hits[2] == Entity(9));
+
+  hits.clear();
+  tree.QueryNearest(mathfu::vec3(-3.f, 0.f, 0.f), 3.f, [&](Entity e) {
+    hits.push_back(e);
+    return 3.f;
+  });
+  EXPECT_THAT(hits, Eq(std::vector<Entity>{Entity(1)}));
+}
+
+TEST(DynamicAabbTreeTest, UpdateAndRemove) {
+  DynamicAabbTree tree(/* margin = */ 0.1f);
+  const auto id = tree.Insert(UnitBoxAt(mathfu::kZeros3f), Entity(1));
+  tree.Insert(UnitBoxAt(mathfu::vec3(3.f, 0.f, 0.f)), Entity(2));
+  EXPECT_THAT(tree.GetEntity(id), Eq(Entity(1)));
+  EXPECT_NEAR(tree.GetFatAabb(id).min.x, -0.6f, kEpsilon);
+
+  // Small movements fit in the fat aabb.
+  EXPECT_FALSE(tree.Update(id, UnitBoxAt(mathfu::vec3(0.05f, 0.f, 0.f))));
+  EXPECT_TRUE(tree.Update(id, UnitBoxAt(mathfu::vec3(-3.f, 0.f, 0.f))));
+
+  std::unordered_set<Entity> hits;
+  tree.QueryPoint(mathfu::vec3(-3.f, 0.f, 0.f),
+                  [&](Entity e) { hits.insert(e); });
+  EXPECT_THAT(hits, Eq(std::unordered_set<Entity>{1}));
+
+  tree.Remove(id);
+  EXPECT_THAT(tree.Size(), Eq(size_t(1)));
+  hits.clear();
+  tree.QueryPoint(mathfu::vec3(-3.f, 0.f, 0.f),
+                  [&](Entity e) { hits.insert(e); });
+  EXPECT_TRUE(hits.empty());
+}
+
+TEST(DynamicAabbTreeTest, StaysBalanced) {
+  DynamicAabbTree tree;
+  std::vector<DynamicAabbTree::ProxyId> ids;
+  const int kNumProxies = 1024;
+  for (int i = 0; i < kNumProxies; ++i) {
+    ids.push_back(tree.Insert(
+        UnitBoxAt(mathfu::vec3(static_cast<float>(i), 0.f, 0.f)), Entity(i)));
+  }
+  EXPECT_THAT(tree.Size(), Eq(size_t(kNumProxies)));
+  // A perfectly balanced tree would have a height of 10.
+  EXPECT_THAT(tree.GetHeight(), Le(20));
+
+  for (int i = 0; i < kNumProxies; i += 2) {
+    tree.Remove(ids[i]);
+  }
+  EXPECT_THAT(tree.Size(), Eq(size_t(kNumProxies / 2)));
+
+  for (int i = 1; i < kNumProxies; i += 2) {
+    std::vector<Entity> hits;
+    tree.QueryPoint(mathfu::vec3(static_cast<float>(i), 0.f, 0.f),
+                    [&](Entity e) { hits.push_back(e); });
+    EXPECT_THAT(hits, Eq(std::vector<Entity>{Entity(i)}));
+  }
+}
+
+}  // namespace
+}  // namespace lull
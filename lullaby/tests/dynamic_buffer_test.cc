@@ -0,0 +1,134 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/dynamic_buffer.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using Upload = DynamicBuffer::Upload;
+
+TEST(DynamicBufferTest, AllocatesOnFirstUpdate) {
+  DynamicBuffer buffer;
+  const std::vector<uint8_t> data(100, 1);
+  const Upload upload = buffer.Update(data.data(), data.size());
+  EXPECT_EQ(upload.type, Upload::kReallocate);
+  EXPECT_EQ(upload.offset, 0u);
+  EXPECT_EQ(upload.size, 100u);
+  EXPECT_EQ(buffer.GetCapacity(), 100u);
+}
+
+TEST(DynamicBufferTest, SkipsUnchangedData) {
+  DynamicBuffer buffer;
+  const std::vector<uint8_t> data(100, 1);
+  buffer.Update(data.data(), data.size());
+  EXPECT_EQ(buffer.Update(data.data(), data.size()).type, Upload::kNone);
+  EXPECT_EQ(buffer.Update(nullptr, 0).type, Upload::kNone);
+}
+
+TEST(DynamicBufferTest, UploadsChangedRange) {
+  DynamicBuffer buffer;
+  std::vector<uint8_t> data(100, 1);
+  buffer.Update(data.data(), data.size());
+
+  data[10] = 2;
+  data[19] = 2;
+  const Upload upload = buffer.Update(data.data(), data.size());
+  EXPECT_EQ(upload.type, Upload::kPartial);
+  EXPECT_EQ(upload.offset, 10u);
+  EXPECT_EQ(upload.size, 10u);
+  EXPECT_EQ(buffer.GetCapacity(), 100u);
+
+  // The contents were updated, so the same data needs no upload.
+  EXPECT_EQ(buffer.Update(data.data(), data.size()).type, Upload::kNone);
+}
+
+TEST(DynamicBufferTest, OrphansMostlyChangedData) {
+  DynamicBuffer buffer;
+  std::vector<uint8_t> data(100, 1);
+  buffer.Update(data.data(), data.size());
+
+  for (size_t i = 20; i < 80; ++i) {
+    data[i] = 2;
+  }
+  const Upload upload = buffer.Update(data.data(), data.size());
+  EXPECT_EQ(upload.type, Upload::kOrphan);
+  EXPECT_EQ(upload.offset, 0u);
+  EXPECT_EQ(upload.size, 100u);
+  EXPECT_EQ(buffer.GetCapacity(), 100u);
+}
+
+TEST(DynamicBufferTest, ShrinksWithinCapacity) {
+  DynamicBuffer buffer;
+  std::vector<uint8_t> data(100, 1);
+  buffer.Update(data.data(), data.size());
+
+  // Only the first byte changed, and the storage is large enough.
+  data.resize(60);
+  data[0] = 2;
+  const Upload upload = buffer.Update(data.data(), data.size());
+  EXPECT_EQ(upload.type, Upload::kPartial);
+  EXPECT_EQ(upload.offset, 0u);
+  EXPECT_EQ(upload.size, 1u);
+  EXPECT_EQ(buffer.GetCapacity(), 100u);
+}
+
+TEST(DynamicBufferTest, TreatsAppendedBytesAsChanged) {
+  DynamicBuffer buffer;
+  std::vector<uint8_t> data(100, 1);
+  buffer.Update(data.data(), data.size());
+  data.resize(60);
+  buffer.Update(data.data(), data.size());
+
+  // The bytes beyond the previous 60 must be uploaded even though they match
+  // what the storage held before.
+  data.resize(80, 1);
+  const Upload upload = buffer.Update(data.data(), data.size());
+  EXPECT_EQ(upload.type, Upload::kPartial);
+  EXPECT_EQ(upload.offset, 60u);
+  EXPECT_EQ(upload.size, 20u);
+}
+
+TEST(DynamicBufferTest, GrowsGeometrically) {
+  DynamicBuffer buffer;
+  std::vector<uint8_t> data(100, 1);
+  buffer.Update(data.data(), data.size());
+
+  data.resize(101, 1);
+  Upload upload = buffer.Update(data.data(), data.size());
+  EXPECT_EQ(upload.type, Upload::kReallocate);
+  EXPECT_EQ(upload.size, 101u);
+  EXPECT_EQ(buffer.GetCapacity(), 200u);
+
+  // Growing within the new capacity does not reallocate.
+  data.resize(150, 1);
+  upload = buffer.Update(data.data(), data.size());
+  EXPECT_EQ(upload.type, Upload::kPartial);
+  EXPECT_EQ(buffer.GetCapacity(), 200u);
+
+  // A large jump allocates exactly what is needed.
+  data.resize(500, 1);
+  upload = buffer.Update(data.data(), data.size());
+  EXPECT_EQ(upload.type, Upload::kReallocate);
+  EXPECT_EQ(buffer.GetCapacity(), 500u);
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,115 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/dynamic_resolution.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::FloatEq;
+using ::testing::Gt;
+using ::testing::Lt;
+
+DynamicResolution::Params GetParams() {
+  DynamicResolution::Params params;
+  params.min_scale = 0.5f;
+  params.max_scale = 1.0f;
+  params.target_gpu_ms = 10.0f;
+  params.settle_frames = 0;
+  return params;
+}
+
+TEST(DynamicResolutionTest, StartsAtMaxScale) {
+  DynamicResolution controller(GetParams());
+  EXPECT_THAT(controller.GetScale(), FloatEq(1.0f));
+}
+
+TEST(DynamicResolutionTest, LowersScaleWhenOverBudget) {
+  DynamicResolution controller(GetParams());
+  controller.Update(20.0f);
+  EXPECT_THAT(controller.GetScale(), Lt(1.0f));
+
+  // The scale never drops below the minimum.
+  for (int i = 0; i < 100; ++i) {
+    controller.Update(40.0f);
+  }
+  EXPECT_THAT(controller.GetScale(), FloatEq(0.5f));
+}
+
+TEST(DynamicResolutionTest, RaisesScaleWhenUnderBudget) {
+  DynamicResolution controller(GetParams());
+  for (int i = 0; i < 100; ++i) {
+    controller.Update(40.0f);
+  }
+  const float lowered = controller.GetScale();
+
+  controller.Update(2.0f);
+  EXPECT_THAT(controller.GetScale(), Gt(lowered));
+
+  for (int i = 0; i < 100; ++i) {
+    controller.Update(2.0f);
+  }
+  EXPECT_THAT(controller.GetScale(), FloatEq(1.0f));
+}
+
+TEST(DynamicResolutionTest, ConvergesToBudget) {
+  DynamicResolution controller(GetParams());
+  // Simulate a GPU time proportional to the number of pixels, which is 16ms
+  // at full resolution.
+  for (int i = 0; i < 200; ++i) {
+    const float scale = controller.GetScale();
+    controller.Update(16.0f * scale * scale);
+  }
+  const float scale = controller.GetScale();
+  EXPECT_NEAR(16.0f * scale * scale, 10.0f, 0.5f);
+}
+
+TEST(DynamicResolutionTest, WaitsForTimingsToSettle) {
+  DynamicResolution::Params params = GetParams();
+  params.settle_frames = 2;
+  DynamicResolution controller(params);
+
+  controller.Update(20.0f);
+  const float scale = controller.GetScale();
+  EXPECT_THAT(scale, Lt(1.0f));
+
+  // Timings of frames rendered before the change are ignored.
+  controller.Update(20.0f);
+  controller.Update(20.0f);
+  EXPECT_THAT(controller.GetScale(), FloatEq(scale));
+  controller.Update(20.0f);
+  EXPECT_THAT(controller.GetScale(), Lt(scale));
+}
+
+TEST(DynamicResolutionTest, IgnoresMissingTimings) {
+  DynamicResolution controller(GetParams());
+  controller.Update(0.0f);
+  EXPECT_THAT(controller.GetScale(), FloatEq(1.0f));
+}
+
+TEST(DynamicResolutionTest, ScaleSize) {
+  EXPECT_THAT(DynamicResolution::ScaleSize(mathfu::vec2i(100, 50), 0.5f),
+              Eq(mathfu::vec2i(50, 25)));
+  EXPECT_THAT(DynamicResolution::ScaleSize(mathfu::vec2i(1, 1), 0.5f),
+              Eq(mathfu::vec2i(1, 1)));
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,320 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/blueprint.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/collision/collision_system.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/util/structure_of_arrays.h"
+#include "lullaby/util/typeid.h"
+#include "lullaby/util/unordered_vector_map.h"
+#include "lullaby/generated/collision_def_generated.h"
+#include "lullaby/generated/transform_def_generated.h"
+
+// Benchmarks for the containers, event dispatch and systems that most of the
+// per-frame work goes through.  All scenes are synthetic and built the same way
+// on every run (no random seeds, no wall clock), so results can be compared
+// between commits.
+
+namespace lull {
+namespace {
+
+struct BenchmarkEvent {
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(&value, Hash("value"));
+  }
+
+  int value = 0;
+};
+
+}  // namespace
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::BenchmarkEvent);
+
+namespace lull {
+namespace {
+
+struct Component {
+  Component(int key, float value) : key(key), value(value) {}
+  int key;
+  float value;
+};
+
+struct ComponentKeyFn {
+  int operator()(const Component& c) const { return c.key; }
+};
+
+using ComponentMap = UnorderedVectorMap<int, Component, ComponentKeyFn>;
+
+// Returns the i-th key of a fixed pseudo-random sequence.
+static int MakeKey(int i) {
+  return static_cast<int>(static_cast<uint32_t>(i) * 2654435761u >> 1);
+}
+
+// Creates a registry with an EntityFactory, TransformSystem and
+// CollisionSystem.
+static std::unique_ptr<Registry> CreateRegistry() {
+  std::unique_ptr<Registry> registry(new Registry());
+  registry->Create<Dispatcher>();
+  auto* entity_factory = registry->Create<EntityFactory>(registry.get());
+  entity_factory->CreateSystem<TransformSystem>();
+  entity_factory->CreateSystem<CollisionSystem>();
+  entity_factory->Initialize();
+  return registry;
+}
+
+static void BM_UnorderedVectorMapEmplace(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    ComponentMap map(256);
+    for (int i = 0; i < count; ++i) {
+      map.Emplace(MakeKey(i), 1.f);
+    }
+    benchmark::DoNotOptimize(map.Size());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_UnorderedVectorMapEmplace)->Arg(1 << 10)->Arg(1 << 14);
+
+static void BM_UnorderedVectorMapGet(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  ComponentMap map(256);
+  for (int i = 0; i < count; ++i) {
+    map.Emplace(MakeKey(i), 1.f);
+  }
+
+  int i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.Get(MakeKey(i)));
+    i = (i + 7919) % count;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UnorderedVectorMapGet)->Arg(1 << 10)->Arg(1 << 14);
+
+static void BM_UnorderedVectorMapDestroy(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    ComponentMap map(256);
+    for (int i = 0; i < count; ++i) {
+      map.Emplace(MakeKey(i), 1.f);
+    }
+    state.ResumeTiming();
+
+    for (int i = 0; i < count; i += 2) {
+      map.Destroy(MakeKey(i));
+    }
+    benchmark::DoNotOptimize(map.Size());
+  }
+  state.SetItemsProcessed(state.iterations() * (count / 2));
+}
+BENCHMARK(BM_UnorderedVectorMapDestroy)->Arg(1 << 10)->Arg(1 << 14);
+
+static void BM_UnorderedVectorMapForEach(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  ComponentMap map(256);
+  for (int i = 0; i < count; ++i) {
+    map.Emplace(MakeKey(i), 1.f);
+  }
+
+  for (auto _ : state) {
+    map.ForEach([](Component& c) { c.value += 1.f; });
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_UnorderedVectorMapForEach)->Arg(1 << 10)->Arg(1 << 14);
+
+static void BM_StructureOfArraysPush(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    StructureOfArrays<int, float, mathfu::vec3> soa;
+    for (int i = 0; i < count; ++i) {
+      soa.Emplace(int(i), 1.f, mathfu::vec3(1.f, 2.f, 3.f));
+    }
+    benchmark::DoNotOptimize(soa.Size());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_StructureOfArraysPush)->Arg(1 << 10)->Arg(1 << 14);
+
+static void BM_StructureOfArraysIterate(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  StructureOfArrays<int, float, mathfu::vec3> soa;
+  for (int i = 0; i < count; ++i) {
+    soa.Emplace(int(i), 1.f, mathfu::vec3(1.f, 2.f, 3.f));
+  }
+
+  for (auto _ : state) {
+    float* values = soa.Data<1>();
+    const mathfu::vec3* positions = soa.Data<2>();
+    for (size_t i = 0; i < soa.Size(); ++i) {
+      values[i] += positions[i].x;
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_StructureOfArraysIterate)->Arg(1 << 10)->Arg(1 << 14);
+
+// state.range(0) is the number of handlers connected to the event.
+static void BM_DispatcherSend(benchmark::State& state) {
+  const int num_handlers = static_cast<int>(state.range(0));
+  Dispatcher dispatcher;
+  int sum = 0;
+  std::vector<Dispatcher::ScopedConnection> connections;
+  for (int i = 0; i < num_handlers; ++i) {
+    connections.emplace_back(dispatcher.Connect(
+        [&sum](const BenchmarkEvent& event) { sum += event.value; }));
+  }
+
+  BenchmarkEvent event;
+  event.value = 1;
+  for (auto _ : state) {
+    dispatcher.Send(event);
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DispatcherSend)->Arg(0)->Arg(1)->Arg(16);
+
+static void BM_EntityFactoryCreateDestroy(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  auto registry = CreateRegistry();
+  auto* entity_factory = registry->Get<EntityFactory>();
+
+  std::vector<Entity> entities(count);
+  for (auto _ : state) {
+    for (Entity& entity : entities) {
+      TransformDefT transform;
+      Blueprint blueprint;
+      blueprint.Write(&transform);
+      entity = entity_factory->Create(&blueprint);
+    }
+    for (Entity entity : entities) {
+      entity_factory->Destroy(entity);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_EntityFactoryCreateDestroy)->Arg(1 << 8)->Arg(1 << 12);
+
+// Builds state.range(1) chains of state.range(0) entities under a single root,
+// then measures moving the root, which updates the world transform of every
+// entity in the scene.
+static void BM_TransformSystemPropagation(benchmark::State& state) {
+  const int depth = static_cast<int>(state.range(0));
+  const int width = static_cast<int>(state.range(1));
+  auto registry = CreateRegistry();
+  auto* entity_factory = registry->Get<EntityFactory>();
+  auto* transform_system = registry->Get<TransformSystem>();
+
+  TransformDefT transform;
+  transform.position = mathfu::vec3(0.f, 1.f, 0.f);
+  Blueprint blueprint;
+  blueprint.Write(&transform);
+
+  const Entity root = entity_factory->Create(&blueprint);
+  for (int i = 0; i < width; ++i) {
+    Entity parent = root;
+    for (int j = 0; j < depth; ++j) {
+      blueprint.Write(&transform);
+      const Entity child = entity_factory->Create(&blueprint);
+      transform_system->AddChild(parent, child);
+      parent = child;
+    }
+  }
+
+  float x = 0.f;
+  for (auto _ : state) {
+    x += 1.f;
+    transform_system->SetLocalTranslation(root, mathfu::vec3(x, 0.f, 0.f));
+  }
+  state.SetItemsProcessed(state.iterations() * (depth * width + 1));
+}
+BENCHMARK(BM_TransformSystemPropagation)
+    ->Args({1, 1024})
+    ->Args({8, 128})
+    ->Args({64, 16})
+    ->Args({1024, 1});
+
+// Places state.range(0) unit boxes on a square grid in front of the origin and
+// measures casting a ray from the origin towards them.  Every fourth ray
+// misses the grid.
+static void BM_CollisionSystemCheckForCollision(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  auto registry = CreateRegistry();
+  auto* entity_factory = registry->Get<EntityFactory>();
+  auto* transform_system = registry->Get<TransformSystem>();
+  auto* collision_system = registry->Get<CollisionSystem>();
+
+  int side = 1;
+  while (side * side < count) {
+    ++side;
+  }
+  const float half_extent = static_cast<float>(side);
+  for (int i = 0; i < count; ++i) {
+    TransformDefT transform;
+    transform.position =
+        mathfu::vec3(2.f * static_cast<float>(i % side) - half_extent,
+                     2.f * static_cast<float>(i / side) - half_extent, -10.f);
+    CollisionDefT collision;
+    Blueprint blueprint;
+    blueprint.Write(&transform);
+    blueprint.Write(&collision);
+    const Entity entity = entity_factory->Create(&blueprint);
+    transform_system->SetAabb(
+        entity, Aabb(-mathfu::kOnes3f / 2.f, mathfu::kOnes3f / 2.f));
+  }
+
+  std::vector<Ray> rays;
+  for (int i = 0; i < 64; ++i) {
+    const int target = MakeKey(i) % count;
+    mathfu::vec3 point(2.f * static_cast<float>(target % side) - half_extent,
+                       2.f * static_cast<float>(target / side) - half_extent,
+                       -10.f);
+    if (i % 4 == 3) {
+      point.x += 1.f;
+    }
+    rays.emplace_back(mathfu::kZeros3f, point.Normalized());
+  }
+
+  // Build any acceleration structures before timing.
+  collision_system->CheckForCollision(rays[0]);
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(collision_system->CheckForCollision(rays[i]));
+    i = (i + 1) % rays.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CollisionSystemCheckForCollision)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Arg(100000);
+
+}  // namespace
+}  // namespace lull
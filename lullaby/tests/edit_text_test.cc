@@ -157,6 +157,22 @@ TEST(InsertTestWithoutSelection, InsertTestWithoutSelection) {
   EXPECT_EQ(caret_pos, 11UL);
 }
 
+TEST(InsertReportsChanges, InsertReportsChanges) {
+  EditText edit_text;
+  edit_text.SetText("0123456789");
+  edit_text.SetCaretPosition(3);
+  EXPECT_FALSE(edit_text.Insert(""));
+  EXPECT_TRUE(edit_text.Insert("a"));
+  EXPECT_EQ(edit_text.str(), "012a3456789");
+
+  // Replacing a selection with the same text doesn't change anything.
+  edit_text.SetSelectionRegion(4, 6);
+  EXPECT_FALSE(edit_text.Insert("34"));
+  EXPECT_EQ(edit_text.str(), "012a3456789");
+  EXPECT_TRUE(edit_text.Insert("x"));
+  EXPECT_EQ(edit_text.str(), "012a34x56789");
+}
+
 TEST(InsertAffectsComposingRegion, InsertAffectsComposingRegion) {
   size_t start, end;
   EditText edit_text;
@@ -54,6 +54,18 @@ struct UnserializableEvent {
   std::string word;
 };
 
+struct LargeEvent {
+  Event event;
+  char padding[EventWrapper::kInlineSize] = {0};
+};
+
+// Returns true if |ptr| points into the memory of |wrapper| itself.
+bool IsInside(const void* ptr, const EventWrapper& wrapper) {
+  const char* begin = reinterpret_cast<const char*>(&wrapper);
+  const char* byte = static_cast<const char*>(ptr);
+  return byte >= begin && byte < begin + sizeof(wrapper);
+}
+
 }  // namespace
 }  // namespace lull
 
@@ -61,6 +73,7 @@ struct UnserializableEvent {
 // using it.
 LULLABY_SETUP_TYPEID(lull::Event);
 LULLABY_SETUP_TYPEID(lull::UnserializableEvent);
+LULLABY_SETUP_TYPEID(lull::LargeEvent);
 
 namespace lull {
 namespace {
@@ -79,6 +92,48 @@ TEST(EventWrapper, ConcreteToConcrete) {
   EXPECT_THAT(event.word, Eq(ptr->word));
 }
 
+TEST(EventWrapper, CopySmallEventInline) {
+  const Event event(123, "hello");
+  const EventWrapper wrapper(event);
+  const EventWrapper copy(wrapper);
+  const Event* ptr = copy.Get<Event>();
+  ASSERT_THAT(ptr, Not(IsNull()));
+  EXPECT_THAT(ptr, Not(Eq(&event)));
+  EXPECT_TRUE(IsInside(ptr, copy));
+  EXPECT_THAT(ptr->number, Eq(123));
+  EXPECT_THAT(ptr->word, Eq("hello"));
+
+  // The inline Event is moved along with the EventWrapper.
+  EventWrapper moved(wrapper);
+  moved = EventWrapper(copy);
+  ptr = moved.Get<Event>();
+  ASSERT_THAT(ptr, Not(IsNull()));
+  EXPECT_TRUE(IsInside(ptr, moved));
+  EXPECT_THAT(ptr->number, Eq(123));
+  EXPECT_THAT(ptr->word, Eq("hello"));
+}
+
+TEST(EventWrapper, CopyLargeEvent) {
+  LargeEvent event;
+  event.event.number = 123;
+  event.padding[EventWrapper::kInlineSize - 1] = 'x';
+  const EventWrapper wrapper(event);
+  const EventWrapper copy(wrapper);
+  const LargeEvent* ptr = copy.Get<LargeEvent>();
+  ASSERT_THAT(ptr, Not(IsNull()));
+  EXPECT_FALSE(IsInside(ptr, copy));
+  EXPECT_THAT(ptr->event.number, Eq(123));
+  EXPECT_THAT(ptr->padding[EventWrapper::kInlineSize - 1], Eq('x'));
+
+  // The allocated Event is handed over without being copied.
+  EventWrapper moved(wrapper);
+  EventWrapper source(copy);
+  const LargeEvent* source_ptr = source.Get<LargeEvent>();
+  moved = std::move(source);
+  EXPECT_THAT(moved.Get<LargeEvent>(), Eq(source_ptr));
+  EXPECT_THAT(moved.Get<LargeEvent>()->event.number, Eq(123));
+}
+
 TEST(EventWrapper, RuntimeToRuntime) {
   EventWrapper wrapper(GetTypeId<Event>());
   wrapper.SetValue(kWordHash, std::string("hello"));
@@ -194,6 +249,26 @@ TEST(EventWrapper, RuntimeMap) {
   EXPECT_THAT(*var1.Get<std::string>(), Eq(*var2.Get<std::string>()));
 }
 
+TEST(EventWrapper, WrapToRuntime) {
+  const HashValue type = Hash("WrappedEvent");
+  const Event event(123, "hello");
+  EventWrapper wrapper = EventWrapper::Wrap(type, event);
+
+  EXPECT_THAT(wrapper.GetTypeId(), Eq(type));
+  EXPECT_THAT(wrapper.IsRuntimeEvent(), Eq(false));
+  EXPECT_THAT(wrapper.IsSerializable(), Eq(true));
+
+  // Copies own their wrapped event.
+  const EventWrapper copy(wrapper);
+  EXPECT_THAT(copy.GetTypeId(), Eq(type));
+
+  EXPECT_THAT(*wrapper.GetValue<int>(kNumberHash), Eq(123));
+  EXPECT_THAT(*wrapper.GetValue<std::string>(kWordHash), Eq("hello"));
+  EXPECT_THAT(wrapper.IsRuntimeEvent(), Eq(true));
+  EXPECT_THAT(*copy.GetValue<int>(kNumberHash), Eq(123));
+  EXPECT_THAT(*copy.GetValue<std::string>(kWordHash), Eq("hello"));
+}
+
 TEST(EventWrapper, IsSerializable) {
   EventWrapper wrapper(UnserializableEvent(123, "hello"));
   EXPECT_THAT(wrapper.IsSerializable(), false);
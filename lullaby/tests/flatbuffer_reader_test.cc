@@ -20,6 +20,8 @@ limitations under the License.
 #include "flatbuffers/flatbuffers.h"
 #include "flatbuffers/util.h"
 #include "lullaby/util/math.h"
+#include "lullaby/util/span.h"
+#include "lullaby/util/string_view.h"
 #include "lullaby/util/typeid.h"
 #include "lullaby/lullaby/generated/flatc_generated.h"
 
@@ -37,6 +39,22 @@ flatbuffers::Offset<T> Finish(Builder* builder) {
   return offset;
 }
 
+// Mirrors the name and numbers fields of ComplexT as they are generated when
+// marked with the "zero_copy" attribute.
+struct ComplexViewT {
+  using FlatBufferType = Complex;
+  using NumberType = decltype(ComplexT::numbers)::value_type;
+
+  string_view name;
+  Span<NumberType> numbers;
+
+  template <typename Archive>
+  void SerializeFlatbuffer(Archive archive) {
+    archive.String(&name, Complex::VT_NAME);
+    archive.VectorOfScalars(&numbers, Complex::VT_NUMBERS);
+  }
+};
+
 lull::ComplexT Create(const flatbuffers::FlatBufferBuilder& fbb) {
   const uint8_t* buffer = fbb.GetBufferPointer();
   auto table = flatbuffers::GetRoot<flatbuffers::Table>(buffer);
@@ -180,6 +198,50 @@ TEST(FlatbufferReader, ArrayOfStrings) {
   EXPECT_THAT(obj.names[1], Eq("world"));
 }
 
+TEST(FlatbufferReader, ZeroCopy) {
+  flatbuffers::FlatBufferBuilder fbb;
+
+  const std::vector<ComplexViewT::NumberType> vec = {1, 2, 3};
+  const auto str = fbb.CreateString("hello");
+  const auto arr = fbb.CreateVector(vec);
+
+  ComplexBuilder complex(fbb);
+  complex.add_name(str);
+  complex.add_numbers(arr);
+  Finish<Complex>(&complex);
+
+  const uint8_t* begin = fbb.GetBufferPointer();
+  const uint8_t* end = begin + fbb.GetSize();
+
+  ComplexViewT obj;
+  ReadFlatbuffer(&obj, flatbuffers::GetRoot<flatbuffers::Table>(begin));
+  EXPECT_THAT(obj.name.to_string(), Eq("hello"));
+  ASSERT_THAT(obj.numbers.size(), Eq(3ul));
+  EXPECT_THAT(obj.numbers[0], Eq(1));
+  EXPECT_THAT(obj.numbers[1], Eq(2));
+  EXPECT_THAT(obj.numbers[2], Eq(3));
+
+  // The data should not have been copied out of the flatbuffer.
+  const auto* name = reinterpret_cast<const uint8_t*>(obj.name.data());
+  const auto* numbers = reinterpret_cast<const uint8_t*>(obj.numbers.data());
+  EXPECT_TRUE(name >= begin && name < end);
+  EXPECT_TRUE(numbers >= begin && numbers < end);
+}
+
+TEST(FlatbufferReader, ZeroCopyEmpty) {
+  flatbuffers::FlatBufferBuilder fbb;
+
+  ComplexBuilder complex(fbb);
+  Finish<Complex>(&complex);
+
+  ComplexViewT obj;
+  obj.name = "stale";
+  ReadFlatbuffer(&obj, flatbuffers::GetRoot<flatbuffers::Table>(
+                           fbb.GetBufferPointer()));
+  EXPECT_TRUE(obj.name.empty());
+  EXPECT_TRUE(obj.numbers.empty());
+}
+
 TEST(FlatbufferReader, Structs) {
   flatbuffers::FlatBufferBuilder fbb;
 
@@ -20,6 +20,8 @@ limitations under the License.
 #include "flatbuffers/flatbuffers.h"
 #include "flatbuffers/util.h"
 #include "lullaby/util/math.h"
+#include "lullaby/util/span.h"
+#include "lullaby/util/string_view.h"
 #include "lullaby/util/typeid.h"
 #include "lullaby/tests/test_def_generated.h"
 #include "lullaby/lullaby/generated/flatc_generated.h"
@@ -31,6 +33,24 @@ using ::testing::Eq;
 using ::testing::IsNull;
 using ::testing::NotNull;
 
+// Mirrors the name and numbers fields of ComplexT as they are generated when
+// marked with the "zero_copy" attribute.
+struct ComplexViewT {
+  using FlatBufferType = Complex;
+  using NumberType = decltype(ComplexT::numbers)::value_type;
+
+  string_view name;
+  Span<NumberType> numbers;
+
+  static const char* FileIdentifier() { return nullptr; }
+
+  template <typename Archive>
+  void SerializeFlatbuffer(Archive archive) {
+    archive.String(&name, Complex::VT_NAME);
+    archive.VectorOfScalars(&numbers, Complex::VT_NUMBERS);
+  }
+};
+
 TEST(FlatbufferWriter, Tables) {
   ComplexT obj;
   obj.basic.b = true;
@@ -160,6 +180,28 @@ TEST(FlatbufferWriter, ArrayOfStrings) {
   EXPECT_THAT(c->names()->Get(2)->str(), Eq("def"));
 }
 
+TEST(FlatbufferWriter, ZeroCopy) {
+  const std::string name = "hello";
+  const ComplexViewT::NumberType numbers[] = {1, 2, 3};
+
+  ComplexViewT obj;
+  obj.name = name;
+  obj.numbers = numbers;
+
+  InwardBuffer buffer(32);
+  const void* flatbuffer = WriteFlatbuffer(&obj, &buffer);
+  const Complex* c = flatbuffers::GetRoot<Complex>(flatbuffer);
+
+  flatbuffers::Verifier verifier((const uint8_t*)flatbuffer, buffer.BackSize());
+  EXPECT_TRUE(verifier.VerifyBuffer<Complex>());
+
+  EXPECT_THAT(c->name()->str(), Eq("hello"));
+  EXPECT_THAT(c->numbers()->size(), Eq(3u));
+  EXPECT_THAT(c->numbers()->Get(0), Eq(1));
+  EXPECT_THAT(c->numbers()->Get(1), Eq(2));
+  EXPECT_THAT(c->numbers()->Get(2), Eq(3));
+}
+
 TEST(FlatbufferWriter, Structs) {
   ComplexT obj;
   obj.out.mid.in.a = 1;
@@ -0,0 +1,112 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/frame_budget.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+TEST(FrameBudgetTest, Priority) {
+  FrameBudget frame_budget;
+  frame_budget.SetBudgetRange(Clock::duration::zero(),
+                              Clock::duration::zero());
+
+  std::vector<int> order;
+  int low_count = 2;
+  int high_count = 2;
+  frame_budget.Register(
+      [&]() {
+        if (low_count == 0) {
+          return false;
+        }
+        --low_count;
+        order.push_back(1);
+        return true;
+      },
+      1);
+  frame_budget.Register(
+      [&]() {
+        if (high_count == 0) {
+          return false;
+        }
+        --high_count;
+        order.push_back(2);
+        return true;
+      },
+      2);
+
+  // With no budget, a single unit of work is performed each frame.
+  for (int i = 0; i < 5; ++i) {
+    frame_budget.AdvanceFrame(std::chrono::milliseconds(16));
+  }
+  EXPECT_EQ(order, (std::vector<int>{2, 2, 1, 1}));
+}
+
+TEST(FrameBudgetTest, SpendsBudget) {
+  FrameBudget frame_budget;
+  frame_budget.SetBudgetRange(std::chrono::seconds(10),
+                              std::chrono::seconds(10));
+
+  int count = 0;
+  frame_budget.Register([&]() { return ++count < 100; });
+  frame_budget.AdvanceFrame(std::chrono::milliseconds(16));
+  EXPECT_EQ(count, 100);
+  EXPECT_LT(frame_budget.GetTimeSpent(), frame_budget.GetBudget());
+}
+
+TEST(FrameBudgetTest, Unregister) {
+  FrameBudget frame_budget;
+
+  int count = 0;
+  const FrameBudget::WorkId id = frame_budget.Register([&]() {
+    ++count;
+    return false;
+  });
+  frame_budget.AdvanceFrame(std::chrono::milliseconds(16));
+  EXPECT_EQ(count, 1);
+
+  frame_budget.Unregister(id);
+  frame_budget.AdvanceFrame(std::chrono::milliseconds(16));
+  EXPECT_EQ(count, 1);
+}
+
+TEST(FrameBudgetTest, AdaptsToFrameTime) {
+  FrameBudget frame_budget;
+  frame_budget.SetTargetFrameTime(std::chrono::milliseconds(16));
+  frame_budget.SetBudgetRange(std::chrono::milliseconds(1),
+                              std::chrono::milliseconds(8));
+
+  // Frames finishing early allow the budget to grow up to the maximum.
+  for (int i = 0; i < 10; ++i) {
+    frame_budget.AdvanceFrame(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(frame_budget.GetBudget(), std::chrono::milliseconds(8));
+
+  // Frames running over shrink the budget down to the minimum.
+  frame_budget.AdvanceFrame(std::chrono::milliseconds(20));
+  EXPECT_EQ(frame_budget.GetBudget(), std::chrono::milliseconds(6));
+  for (int i = 0; i < 10; ++i) {
+    frame_budget.AdvanceFrame(std::chrono::milliseconds(20));
+  }
+  EXPECT_EQ(frame_budget.GetBudget(), std::chrono::milliseconds(1));
+}
+
+}  // namespace
+}  // namespace lull
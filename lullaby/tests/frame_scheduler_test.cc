@@ -0,0 +1,125 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/ecs/frame_scheduler.h"
+
+#include <atomic>
+#include <mutex>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/queued_dispatcher.h"
+#include "lullaby/util/job_processor.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+struct DataA {};
+struct DataB {};
+struct DataC {};
+
+struct TestEvent {
+  template <typename Archive>
+  void Serialize(Archive archive) {}
+};
+
+class CountingSystem {
+ public:
+  void AdvanceFrame(Clock::duration delta_time) { ++count; }
+  int count = 0;
+};
+
+TEST(FrameSchedulerTest, GroupsTasksIntoPhases) {
+  Registry registry;
+  FrameScheduler scheduler(&registry);
+  auto noop = [](Clock::duration) {};
+
+  scheduler.Add("write_a", noop).Writes<DataA>();
+  scheduler.Add("write_b", noop).Writes<DataB>();
+  scheduler.Add("read_a", noop).Reads<DataA>();
+  scheduler.Add("read_a_write_c", noop).Reads<DataA>().Writes<DataC>();
+  scheduler.Add("write_a_again", noop).Writes<DataA>();
+  scheduler.Add("independent", noop);
+
+  ASSERT_THAT(scheduler.GetNumPhases(), Eq(3u));
+  EXPECT_THAT(scheduler.GetPhaseTaskNames(0),
+              ElementsAre("write_a", "write_b", "independent"));
+  EXPECT_THAT(scheduler.GetPhaseTaskNames(1),
+              ElementsAre("read_a", "read_a_write_c"));
+  EXPECT_THAT(scheduler.GetPhaseTaskNames(2), ElementsAre("write_a_again"));
+}
+
+TEST(FrameSchedulerTest, RunsConflictingTasksInOrder) {
+  Registry registry;
+  registry.Create<JobProcessor>(4);
+  FrameScheduler scheduler(&registry);
+
+  std::mutex mutex;
+  std::vector<int> order;
+  std::atomic<int> num_independent(0);
+  for (int i = 0; i < 4; ++i) {
+    scheduler.Add("ordered", [&, i](Clock::duration) {
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(i);
+    }).Writes<DataA>();
+    scheduler.Add("independent", [&](Clock::duration) {
+      ++num_independent;
+    }).Writes<DataB>().RunOnCallingThread();
+  }
+
+  CountingSystem system;
+  scheduler.Add(&system, &CountingSystem::AdvanceFrame);
+
+  scheduler.AdvanceFrame(Clock::duration::zero());
+  scheduler.AdvanceFrame(Clock::duration::zero());
+  EXPECT_THAT(order, ElementsAre(0, 1, 2, 3, 0, 1, 2, 3));
+  EXPECT_THAT(num_independent.load(), Eq(8));
+  EXPECT_THAT(system.count, Eq(2));
+}
+
+TEST(FrameSchedulerTest, DispatchesBetweenPhases) {
+  Registry registry;
+  QueuedDispatcher dispatcher;
+  FrameScheduler scheduler(&registry, &dispatcher);
+
+  int num_events = 0;
+  dispatcher.Connect(&num_events,
+                     [&](const TestEvent& event) { ++num_events; });
+
+  int events_seen = -1;
+  scheduler.Add("send", [&](Clock::duration) {
+    dispatcher.Send(TestEvent());
+  }).Writes<DataA>();
+  scheduler.Add("receive", [&](Clock::duration) {
+    events_seen = num_events;
+  }).Reads<DataA>();
+
+  scheduler.AdvanceFrame(Clock::duration::zero());
+  EXPECT_THAT(events_seen, Eq(1));
+  EXPECT_THAT(num_events, Eq(1));
+}
+
+}  // namespace
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::DataA);
+LULLABY_SETUP_TYPEID(lull::DataB);
+LULLABY_SETUP_TYPEID(lull::DataC);
+LULLABY_SETUP_TYPEID(lull::TestEvent);
+LULLABY_SETUP_TYPEID(lull::CountingSystem);
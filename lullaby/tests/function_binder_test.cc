@@ -38,6 +38,22 @@ TEST(FunctionBinderTest, BasicUsage) {
   EXPECT_EQ("abcdef", *result.Get<std::string>());
 }
 
+TEST(FunctionBinderTest, Handle) {
+  Registry registry;
+  FunctionBinder binder(&registry);
+
+  binder.RegisterFunction("Scale", [](float a, float b) { return a * b; });
+  FunctionBinder::Handle handle = binder.GetHandle("Scale");
+  EXPECT_TRUE(handle.IsValid());
+  EXPECT_FALSE(binder.GetHandle("Unknown").IsValid());
+  EXPECT_FALSE(FunctionBinder::Handle().IsValid());
+
+  Variant result = binder.Call(handle, 2.f, 3.f);
+  EXPECT_EQ(6.f, *result.Get<float>());
+  result = binder.Call(handle, 4.f, 5.f);
+  EXPECT_EQ(20.f, *result.Get<float>());
+}
+
 TEST(FunctionBinderTest, Vectors) {
   Registry registry;
   FunctionBinder binder(&registry);
@@ -198,6 +214,16 @@ TEST(FunctionBinderDeathTest, WrongNumberOfArgsError) {
   EXPECT_TRUE(result.Empty());
 }
 
+TEST(FunctionBinderDeathTest, InvalidHandleError) {
+  Registry registry;
+  FunctionBinder binder(&registry);
+
+  Variant result;
+  PORT_EXPECT_DEBUG_DEATH(result = binder.Call(FunctionBinder::Handle(), 1.f),
+                          "");
+  EXPECT_TRUE(result.Empty());
+}
+
 TEST(FunctionBinderDeathTest, WrongArgTypeError) {
   Registry registry;
   FunctionBinder binder(&registry);
@@ -0,0 +1,298 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/gltf_asset/gltf_asset.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/render/mesh_data.h"
+#include "lullaby/modules/render/vertex.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::NotNull;
+
+constexpr size_t kNumVertices = 3;
+constexpr float kPositions[kNumVertices][3] = {
+    {0.f, 1.f, 2.f}, {3.f, 4.f, 5.f}, {6.f, 7.f, 8.f}};
+constexpr float kUvs[kNumVertices][2] = {
+    {0.f, .25f}, {.5f, .75f}, {1.f, 0.f}};
+constexpr uint16_t kIndices[kNumVertices] = {2, 0, 1};
+
+// Builds the binary chunk of a GLB.
+class BinaryChunk {
+ public:
+  size_t Size() const { return bytes_.size(); }
+
+  template <typename T>
+  void Append(const T* data, size_t count) {
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(data);
+    bytes_.insert(bytes_.end(), begin, begin + count * sizeof(T));
+  }
+
+  void Pad(size_t alignment) {
+    while (bytes_.size() % alignment != 0) {
+      bytes_.push_back(0);
+    }
+  }
+
+  const std::vector<uint8_t>& Bytes() const { return bytes_; }
+
+ private:
+  std::vector<uint8_t> bytes_;
+};
+
+void AppendU32(std::string* out, uint32_t value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Returns a GLB with a single mesh whose primitive uses accessor 0 for its
+// positions, accessor 1 for its texture coordinates and accessor 2 for its
+// indices. |buffer_views| and |accessors| are the JSON arrays describing how
+// these are laid out in |bin|.
+std::string MakeGlb(const std::string& buffer_views,
+                    const std::string& accessors, BinaryChunk bin) {
+  bin.Pad(4);
+  std::string json = R"({
+      "asset": {"version": "2.0"},
+      "scenes": [{"nodes": [0]}],
+      "nodes": [{"mesh": 0}],
+      "meshes": [{"primitives": [{
+          "attributes": {"POSITION": 0, "TEXCOORD_0": 1},
+          "indices": 2}]}],
+      "buffers": [{"byteLength": )" +
+                     std::to_string(bin.Size()) + R"(}],
+      "bufferViews": )" + buffer_views + R"(,
+      "accessors": )" + accessors + "}";
+  while (json.size() % 4 != 0) {
+    json.push_back(' ');
+  }
+
+  std::string glb;
+  AppendU32(&glb, 0x46546C67);  // "glTF"
+  AppendU32(&glb, 2);
+  AppendU32(&glb, static_cast<uint32_t>(12 + 8 + json.size() + 8 +
+                                        bin.Size()));
+  AppendU32(&glb, static_cast<uint32_t>(json.size()));
+  AppendU32(&glb, 0x4E4F534A);  // "JSON"
+  glb += json;
+  AppendU32(&glb, static_cast<uint32_t>(bin.Size()));
+  AppendU32(&glb, 0x004E4942);  // "BIN"
+  glb.append(reinterpret_cast<const char*>(bin.Bytes().data()), bin.Size());
+  return glb;
+}
+
+// Returns the accessor JSON for the positions and texture coordinates at the
+// given BufferViews and offsets, and for |index_type| indices in BufferView
+// |index_view|.
+std::string MakeAccessors(int position_view, size_t position_offset,
+                          int uv_view, size_t uv_offset, int index_view,
+                          int index_type) {
+  auto accessor = [](int view, size_t offset, int component_type,
+                     const char* type) {
+    return "{\"bufferView\": " + std::to_string(view) +
+           ", \"byteOffset\": " + std::to_string(offset) +
+           ", \"componentType\": " + std::to_string(component_type) +
+           ", \"count\": " + std::to_string(kNumVertices) +
+           ", \"type\": \"" + type + "\"}";
+  };
+  return "[" + accessor(position_view, position_offset, 5126, "VEC3") + ", " +
+         accessor(uv_view, uv_offset, 5126, "VEC2") + ", " +
+         accessor(index_view, 0, index_type, "SCALAR") + "]";
+}
+
+class GltfAssetTest : public ::testing::Test {
+ protected:
+  // Loads |glb| and returns the MeshData of its only mesh. The asset is
+  // destroyed before returning, so the MeshData must keep any GLTF buffer it
+  // references alive.
+  MeshData LoadMesh(std::string glb) {
+    GltfAsset asset(&registry_, false, nullptr);
+    asset.OnLoad("test.glb", &glb);
+    std::vector<GltfAsset::MeshInfo>& meshes = asset.GetMutableMeshInfos();
+    EXPECT_THAT(meshes.size(), Eq(1u));
+    return meshes.empty() ? MeshData() : std::move(meshes[0].mesh_data);
+  }
+
+  Registry registry_;
+};
+
+void ExpectVertices(const MeshData& mesh) {
+  ASSERT_THAT(mesh.GetNumVertices(), Eq(kNumVertices));
+  ASSERT_THAT(mesh.GetVertexFormat().GetVertexSize(), Eq(sizeof(VertexPT)));
+  ASSERT_THAT(mesh.GetVertexBytes(), NotNull());
+  for (size_t i = 0; i < kNumVertices; ++i) {
+    VertexPT vertex;
+    std::memcpy(&vertex, mesh.GetVertexBytes() + i * sizeof(VertexPT),
+                sizeof(VertexPT));
+    EXPECT_THAT(vertex.x, Eq(kPositions[i][0]));
+    EXPECT_THAT(vertex.y, Eq(kPositions[i][1]));
+    EXPECT_THAT(vertex.z, Eq(kPositions[i][2]));
+    EXPECT_THAT(vertex.u0, Eq(kUvs[i][0]));
+    EXPECT_THAT(vertex.v0, Eq(kUvs[i][1]));
+  }
+}
+
+void ExpectIndices(const MeshData& mesh) {
+  ASSERT_THAT(mesh.GetIndexType(), Eq(MeshData::kIndexU16));
+  ASSERT_THAT(mesh.GetNumIndices(), Eq(kNumVertices));
+  const uint16_t* indices = mesh.GetIndexData<uint16_t>();
+  ASSERT_THAT(indices, NotNull());
+  EXPECT_THAT(std::vector<uint16_t>(indices, indices + kNumVertices),
+              ElementsAre(kIndices[0], kIndices[1], kIndices[2]));
+}
+
+TEST_F(GltfAssetTest, InterleavedVerticesAreReferencedInPlace) {
+  BinaryChunk bin;
+  for (size_t i = 0; i < kNumVertices; ++i) {
+    bin.Append(kPositions[i], 3);
+    bin.Append(kUvs[i], 2);
+  }
+  const size_t index_offset = bin.Size();
+  bin.Append(kIndices, kNumVertices);
+
+  const std::string views =
+      "[{\"buffer\": 0, \"byteOffset\": 0, \"byteLength\": " +
+      std::to_string(index_offset) + ", \"byteStride\": 20}, " +
+      "{\"buffer\": 0, \"byteOffset\": " + std::to_string(index_offset) +
+      ", \"byteLength\": 6}]";
+  MeshData mesh =
+      LoadMesh(MakeGlb(views, MakeAccessors(0, 0, 0, 12, 1, 5123), bin));
+
+  // Both the vertices and the 16-bit indices point into the GLTF buffer, which
+  // is read-only.
+  EXPECT_THAT(mesh.GetMutableVertexBytes(), IsNull());
+  EXPECT_THAT(mesh.GetMutableIndexBytes(), IsNull());
+  ExpectVertices(mesh);
+  ExpectIndices(mesh);
+}
+
+TEST_F(GltfAssetTest, SeparateBufferViewsAreInterleaved) {
+  BinaryChunk bin;
+  for (size_t i = 0; i < kNumVertices; ++i) {
+    bin.Append(kPositions[i], 3);
+  }
+  const size_t uv_offset = bin.Size();
+  for (size_t i = 0; i < kNumVertices; ++i) {
+    bin.Append(kUvs[i], 2);
+  }
+  const size_t index_offset = bin.Size();
+  bin.Append(kIndices, kNumVertices);
+
+  const std::string views =
+      "[{\"buffer\": 0, \"byteOffset\": 0, \"byteLength\": " +
+      std::to_string(uv_offset) + "}, " +
+      "{\"buffer\": 0, \"byteOffset\": " + std::to_string(uv_offset) +
+      ", \"byteLength\": " + std::to_string(index_offset - uv_offset) + "}, " +
+      "{\"buffer\": 0, \"byteOffset\": " + std::to_string(index_offset) +
+      ", \"byteLength\": 6}]";
+  MeshData mesh =
+      LoadMesh(MakeGlb(views, MakeAccessors(0, 0, 1, 0, 2, 5123), bin));
+
+  EXPECT_THAT(mesh.GetMutableVertexBytes(), NotNull());
+  EXPECT_THAT(mesh.GetMutableIndexBytes(), IsNull());
+  ExpectVertices(mesh);
+  ExpectIndices(mesh);
+}
+
+TEST_F(GltfAssetTest, PaddedStrideIsCopied) {
+  // Each vertex is padded out to 24 bytes, which doesn't match the 20 byte
+  // VertexFormat, so the vertices can't be used in place.
+  const float kPadding = 0.f;
+  BinaryChunk bin;
+  for (size_t i = 0; i < kNumVertices; ++i) {
+    bin.Append(kPositions[i], 3);
+    bin.Append(kUvs[i], 2);
+    bin.Append(&kPadding, 1);
+  }
+  const size_t index_offset = bin.Size();
+  bin.Append(kIndices, kNumVertices);
+
+  const std::string views =
+      "[{\"buffer\": 0, \"byteOffset\": 0, \"byteLength\": " +
+      std::to_string(index_offset) + ", \"byteStride\": 24}, " +
+      "{\"buffer\": 0, \"byteOffset\": " + std::to_string(index_offset) +
+      ", \"byteLength\": 6}]";
+  MeshData mesh =
+      LoadMesh(MakeGlb(views, MakeAccessors(0, 0, 0, 12, 1, 5123), bin));
+
+  EXPECT_THAT(mesh.GetMutableVertexBytes(), NotNull());
+  ExpectVertices(mesh);
+  ExpectIndices(mesh);
+}
+
+TEST_F(GltfAssetTest, DifferentAttributeOrderIsCopied) {
+  // The texture coordinates come before the positions, the reverse of the
+  // VertexFormat.
+  BinaryChunk bin;
+  for (size_t i = 0; i < kNumVertices; ++i) {
+    bin.Append(kUvs[i], 2);
+    bin.Append(kPositions[i], 3);
+  }
+  const size_t index_offset = bin.Size();
+  bin.Append(kIndices, kNumVertices);
+
+  const std::string views =
+      "[{\"buffer\": 0, \"byteOffset\": 0, \"byteLength\": " +
+      std::to_string(index_offset) + ", \"byteStride\": 20}, " +
+      "{\"buffer\": 0, \"byteOffset\": " + std::to_string(index_offset) +
+      ", \"byteLength\": 6}]";
+  MeshData mesh =
+      LoadMesh(MakeGlb(views, MakeAccessors(0, 8, 0, 0, 1, 5123), bin));
+
+  EXPECT_THAT(mesh.GetMutableVertexBytes(), NotNull());
+  ExpectVertices(mesh);
+  ExpectIndices(mesh);
+}
+
+TEST_F(GltfAssetTest, ByteIndicesAreWidened) {
+  BinaryChunk bin;
+  for (size_t i = 0; i < kNumVertices; ++i) {
+    bin.Append(kPositions[i], 3);
+    bin.Append(kUvs[i], 2);
+  }
+  const size_t index_offset = bin.Size();
+  for (uint16_t index : kIndices) {
+    const uint8_t byte_index = static_cast<uint8_t>(index);
+    bin.Append(&byte_index, 1);
+  }
+
+  const std::string views =
+      "[{\"buffer\": 0, \"byteOffset\": 0, \"byteLength\": " +
+      std::to_string(index_offset) + ", \"byteStride\": 20}, " +
+      "{\"buffer\": 0, \"byteOffset\": " + std::to_string(index_offset) +
+      ", \"byteLength\": 3}]";
+  MeshData mesh =
+      LoadMesh(MakeGlb(views, MakeAccessors(0, 0, 0, 12, 1, 5121), bin));
+
+  // The vertices are still used in place; only the indices are converted.
+  EXPECT_THAT(mesh.GetMutableVertexBytes(), IsNull());
+  EXPECT_THAT(mesh.GetMutableIndexBytes(), NotNull());
+  ExpectVertices(mesh);
+  ExpectIndices(mesh);
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,77 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/half_float.h"
+
+#include <cmath>
+#include <limits>
+
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+TEST(HalfFloatTest, ExactValues) {
+  EXPECT_EQ(0x0000, FloatToHalf(0.f));
+  EXPECT_EQ(0x8000, FloatToHalf(-0.f));
+  EXPECT_EQ(0x3c00, FloatToHalf(1.f));
+  EXPECT_EQ(0xc000, FloatToHalf(-2.f));
+  EXPECT_EQ(0x3800, FloatToHalf(0.5f));
+  EXPECT_EQ(0x7bff, FloatToHalf(65504.f));
+
+  EXPECT_EQ(1.f, HalfToFloat(0x3c00));
+  EXPECT_EQ(-2.f, HalfToFloat(0xc000));
+  EXPECT_EQ(65504.f, HalfToFloat(0x7bff));
+}
+
+TEST(HalfFloatTest, RoundTrip) {
+  for (uint32_t bits = 0; bits < 0x10000; ++bits) {
+    const HalfFloat half = static_cast<HalfFloat>(bits);
+    const float value = HalfToFloat(half);
+    if (std::isnan(value)) {
+      EXPECT_TRUE(std::isnan(HalfToFloat(FloatToHalf(value))));
+    } else {
+      EXPECT_EQ(half, FloatToHalf(value)) << bits;
+    }
+  }
+}
+
+TEST(HalfFloatTest, Rounding) {
+  // 1 + 2^-11 is halfway between 1 and the next half-float, so it rounds to
+  // even.
+  EXPECT_EQ(0x3c00, FloatToHalf(1.f + std::ldexp(1.f, -11)));
+  EXPECT_EQ(0x3c01, FloatToHalf(1.f + std::ldexp(1.5f, -11)));
+  EXPECT_NEAR(0.1f, HalfToFloat(FloatToHalf(0.1f)), 1e-4f);
+}
+
+TEST(HalfFloatTest, Denormals) {
+  const float smallest = std::ldexp(1.f, -24);
+  EXPECT_EQ(0x0001, FloatToHalf(smallest));
+  EXPECT_EQ(smallest, HalfToFloat(0x0001));
+  EXPECT_EQ(0x0000, FloatToHalf(std::ldexp(1.f, -26)));
+}
+
+TEST(HalfFloatTest, Overflow) {
+  const float inf = std::numeric_limits<float>::infinity();
+  EXPECT_EQ(0x7c00, FloatToHalf(70000.f));
+  EXPECT_EQ(0xfc00, FloatToHalf(-inf));
+  EXPECT_EQ(inf, HalfToFloat(0x7c00));
+  EXPECT_TRUE(std::isnan(HalfToFloat(
+      FloatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+}  // namespace
+}  // namespace lull
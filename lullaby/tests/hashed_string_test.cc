@@ -0,0 +1,77 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/hashed_string.h"
+
+#include <cstring>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+
+constexpr HashedString kApple("apple");
+static_assert(kApple.GetHash() == ConstHash("apple"),
+              "Literals must be hashed at compile time.");
+static_assert(kApple.size() == 5, "");
+
+HashValue GetHash(HashedString str) { return str.GetHash(); }
+
+TEST(HashedString, Literal) {
+  EXPECT_THAT(kApple.GetHash(), Eq(Hash("apple")));
+  EXPECT_THAT(kApple.GetString(), Eq("apple"));
+  EXPECT_THAT(GetHash("banana"), Eq(Hash("banana")));
+}
+
+TEST(HashedString, RuntimeStrings) {
+  const char* c_str = "carrot";
+  const std::string str = "dragon fruit";
+  const string_view view(str.data(), 6);
+
+  EXPECT_THAT(GetHash(c_str), Eq(Hash("carrot")));
+  EXPECT_THAT(GetHash(str), Eq(Hash("dragon fruit")));
+  EXPECT_THAT(GetHash(view), Eq(Hash("dragon")));
+  EXPECT_THAT(HashedString(view).GetString(), Eq("dragon"));
+}
+
+TEST(HashedString, CharBuffer) {
+  char buffer[32] = {};
+  std::strncpy(buffer, "apple", sizeof(buffer) - 1);
+
+  const HashedString str(buffer);
+  EXPECT_THAT(str.size(), Eq(5u));
+  EXPECT_THAT(str.GetString(), Eq("apple"));
+  EXPECT_THAT(GetHash(buffer), Eq(Hash("apple")));
+}
+
+TEST(HashedString, Empty) {
+  EXPECT_TRUE(HashedString().empty());
+  EXPECT_THAT(HashedString().GetHash(), Eq(HashValue(0)));
+  EXPECT_THAT(HashedString("").GetHash(), Eq(HashValue(0)));
+  EXPECT_THAT(HashedString(std::string()).GetHash(), Eq(HashValue(0)));
+}
+
+TEST(HashedString, PrecomputedHash) {
+  const HashedString str("elderberry", 5, 123);
+  EXPECT_THAT(str.GetHash(), Eq(HashValue(123)));
+  EXPECT_THAT(str.GetString(), Eq("elder"));
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,141 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/render/image_decoder.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+// Returns a 2x2 uncompressed, top-left origin, 24-bit TGA image file.
+std::string CreateTga() {
+  const uint8_t header[18] = {0, 0, 2, 0, 0, 0, 0, 0, 0,
+                              0, 0, 0, 2, 0, 2, 0, 24, 0x20};
+  std::string data(reinterpret_cast<const char*>(header), sizeof(header));
+  for (int i = 0; i < 4; ++i) {
+    // Pixels are stored as BGR.
+    data.push_back(static_cast<char>(i));
+    data.push_back(static_cast<char>(10 + i));
+    data.push_back(static_cast<char>(20 + i));
+  }
+  return data;
+}
+
+// Returns a 4x4 PKM image file.
+std::string CreatePkm() {
+  PkmHeader header;
+  memcpy(header.magic, "PKM ", sizeof(header.magic));
+  memcpy(header.version, "10", sizeof(header.version));
+  header.data_type[0] = header.data_type[1] = 0;
+  header.ext_width[0] = header.width[0] = 0;
+  header.ext_width[1] = header.width[1] = 4;
+  header.ext_height[0] = header.height[0] = 0;
+  header.ext_height[1] = header.height[1] = 4;
+  std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+  data.append(8, '\0');
+  return data;
+}
+
+TEST(ImageDecoder, DecodesOnWorkerThread) {
+  ImageDecoder decoder;
+
+  int num_calls = 0;
+  ImageData result;
+  decoder.Decode(CreateTga(), {}, [&](ImageData image, bool is_final) {
+    EXPECT_TRUE(is_final);
+    result = std::move(image);
+    ++num_calls;
+  });
+
+  while (num_calls == 0) {
+    decoder.ProcessCompleted();
+  }
+  EXPECT_EQ(num_calls, 1);
+  EXPECT_EQ(result.GetFormat(), ImageData::kRgb888);
+  EXPECT_EQ(result.GetSize(), mathfu::vec2i(2, 2));
+  ASSERT_NE(result.GetBytes(), nullptr);
+  EXPECT_EQ(result.GetBytes()[0], 20);
+  EXPECT_EQ(result.GetBytes()[1], 10);
+  EXPECT_EQ(result.GetBytes()[2], 0);
+}
+
+TEST(ImageDecoder, PassesThroughGpuNativeImages) {
+  ImageDecoder decoder;
+
+  const std::string pkm = CreatePkm();
+  int num_calls = 0;
+  ImageData result;
+  decoder.Decode(pkm, {}, [&](ImageData image, bool is_final) {
+    EXPECT_TRUE(is_final);
+    result = std::move(image);
+    ++num_calls;
+  });
+
+  // The callback is invoked without waiting for a worker thread, and the image
+  // still refers to the original (compressed) data.
+  EXPECT_EQ(num_calls, 1);
+  EXPECT_EQ(result.GetFormat(), ImageData::kPkm);
+  EXPECT_EQ(result.GetSize(), mathfu::vec2i(4, 4));
+  ASSERT_EQ(result.GetDataSize(), pkm.size());
+  EXPECT_EQ(memcmp(result.GetBytes(), pkm.data(), pkm.size()), 0);
+}
+
+TEST(ImageDecoder, NoPreviewForUnscalableFormats) {
+  ImageDecoder decoder;
+
+  ImageDecoder::DecodeOptions options;
+  options.preview_size = 1;
+
+  std::vector<bool> calls;
+  decoder.Decode(CreateTga(), options, [&](ImageData image, bool is_final) {
+    EXPECT_FALSE(image.IsEmpty());
+    calls.push_back(is_final);
+  });
+
+  while (calls.empty()) {
+    decoder.ProcessCompleted();
+  }
+  EXPECT_EQ(calls, std::vector<bool>{true});
+}
+
+TEST(ImageDecoder, ManyDecodes) {
+  ImageDecoder decoder(4);
+
+  const int kNumImages = 32;
+  int num_calls = 0;
+  for (int i = 0; i < kNumImages; ++i) {
+    ImageDecoder::DecodeOptions options;
+    options.priority = i % 3;
+    decoder.Decode(CreateTga(), options, [&](ImageData image, bool is_final) {
+      EXPECT_TRUE(is_final);
+      EXPECT_EQ(image.GetSize(), mathfu::vec2i(2, 2));
+      ++num_calls;
+    });
+  }
+
+  while (num_calls < kNumImages) {
+    decoder.ProcessCompleted();
+  }
+  EXPECT_EQ(num_calls, kNumImages);
+}
+
+}  // namespace
+}  // namespace lull
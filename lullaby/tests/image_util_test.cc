@@ -16,6 +16,9 @@ limitations under the License.
 
 #include "lullaby/modules/render/image_util.h"
 
+#include <string.h>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "mathfu/constants.h"
 
@@ -56,5 +59,157 @@ TEST(ConvertRgb888ToRgba8888, ExpectedValues) {
   }
 }
 
+TEST(ConvertRgb888ToRgba8888InPlace, ExpectedValues) {
+  // An odd number of pixels exercises both the vectorized and scalar paths.
+  constexpr int kWidth = 7;
+  constexpr int kHeight = 5;
+  constexpr int kNumPixels = kWidth * kHeight;
+
+  uint8_t rgb_data[3 * kNumPixels];
+  for (int i = 0; i < 3 * kNumPixels; ++i) {
+    rgb_data[i] = static_cast<uint8_t>(i);
+  }
+
+  uint8_t data[4 * kNumPixels];
+  memcpy(data, rgb_data, sizeof(rgb_data));
+  ConvertRgb888ToRgba8888InPlace(data, mathfu::vec2i(kWidth, kHeight));
+
+  for (int i = 0; i < kNumPixels; ++i) {
+    EXPECT_EQ(data[4 * i + 0], rgb_data[3 * i + 0]);
+    EXPECT_EQ(data[4 * i + 1], rgb_data[3 * i + 1]);
+    EXPECT_EQ(data[4 * i + 2], rgb_data[3 * i + 2]);
+    EXPECT_EQ(data[4 * i + 3], 255);
+  }
+}
+
+TEST(MultiplyRgbByAlpha, ExpectedValues) {
+  // Every combination of channel and alpha value.
+  constexpr int kWidth = 256;
+  constexpr int kHeight = 256;
+  std::vector<uint8_t> data(4 * kWidth * kHeight);
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      uint8_t* pixel = &data[4 * (y * kWidth + x)];
+      pixel[0] = static_cast<uint8_t>(x);
+      pixel[1] = static_cast<uint8_t>(255 - x);
+      pixel[2] = static_cast<uint8_t>(x / 2);
+      pixel[3] = static_cast<uint8_t>(y);
+    }
+  }
+  const std::vector<uint8_t> original = data;
+
+  MultiplyRgbByAlpha(data.data(), mathfu::vec2i(kWidth, kHeight));
+
+  for (size_t i = 0; i < data.size(); i += 4) {
+    const int alpha = original[i + 3];
+    EXPECT_EQ(data[i + 0], original[i + 0] * alpha / 255);
+    EXPECT_EQ(data[i + 1], original[i + 1] * alpha / 255);
+    EXPECT_EQ(data[i + 2], original[i + 2] * alpha / 255);
+    EXPECT_EQ(data[i + 3], alpha);
+  }
+}
+
+TEST(GetNextMipSize, HalvesToOne) {
+  EXPECT_EQ(mathfu::vec2i(32, 8), GetNextMipSize(mathfu::vec2i(64, 16)));
+  EXPECT_EQ(mathfu::vec2i(2, 1), GetNextMipSize(mathfu::vec2i(5, 1)));
+  EXPECT_EQ(mathfu::vec2i(1, 1), GetNextMipSize(mathfu::vec2i(1, 1)));
+}
+
+TEST(DownsampleImageRows, AveragesBlocks) {
+  const uint8_t src_data[] = {
+      0,  0,  100, 100,  // row 0
+      40, 40, 200, 200,  // row 1
+  };
+  const ImageData src(
+      ImageData::kLuminanceAlpha, mathfu::vec2i(2, 2),
+      DataContainer::WrapDataAsReadOnly(src_data, sizeof(src_data)));
+  ImageData dst(ImageData::kLuminanceAlpha, mathfu::vec2i(1, 1),
+                DataContainer::CreateHeapDataContainer(2));
+
+  DownsampleImageRows(src, &dst, 0, 1);
+  EXPECT_EQ(85, dst.GetBytes()[0]);
+  EXPECT_EQ(85, dst.GetBytes()[1]);
+}
+
+TEST(DownsampleImageRows, BuildsRowsInPieces) {
+  constexpr int kWidth = 4;
+  constexpr int kHeight = 8;
+  uint8_t src_data[kWidth * kHeight];
+  for (int i = 0; i < kWidth * kHeight; ++i) {
+    src_data[i] = static_cast<uint8_t>(i / kWidth * 10);
+  }
+  const ImageData src(
+      ImageData::kLuminance, mathfu::vec2i(kWidth, kHeight),
+      DataContainer::WrapDataAsReadOnly(src_data, sizeof(src_data)));
+  const mathfu::vec2i dst_size = GetNextMipSize(src.GetSize());
+  ImageData dst(ImageData::kLuminance, dst_size,
+                DataContainer::CreateHeapDataContainer(dst_size.x *
+                                                       dst_size.y));
+
+  DownsampleImageRows(src, &dst, 0, 1);
+  DownsampleImageRows(src, &dst, 1, dst_size.y);
+  for (int y = 0; y < dst_size.y; ++y) {
+    for (int x = 0; x < dst_size.x; ++x) {
+      // Rows 2y and 2y + 1 are averaged.
+      EXPECT_EQ(20 * y + 5, dst.GetBytes()[y * dst_size.x + x]);
+    }
+  }
+}
+
+TEST(DownsampleImageRows, KeepsSingleTexelDimensions) {
+  const uint8_t src_data[] = {10, 20, 30, 40};
+  const ImageData src(
+      ImageData::kAlpha, mathfu::vec2i(4, 1),
+      DataContainer::WrapDataAsReadOnly(src_data, sizeof(src_data)));
+  ImageData dst(ImageData::kAlpha, mathfu::vec2i(2, 1),
+                DataContainer::CreateHeapDataContainer(2));
+
+  DownsampleImageRows(src, &dst, 0, 1);
+  EXPECT_EQ(15, dst.GetBytes()[0]);
+  EXPECT_EQ(35, dst.GetBytes()[1]);
+}
+
+TEST(DownsampleImageRows, DropsLastTexelOfOddDimensions) {
+  // A 5x3 image with padded rows.  The last column and row have no partner
+  // texel, so they do not contribute to the 2x1 mip.
+  constexpr int kWidth = 5;
+  constexpr int kHeight = 3;
+  constexpr int kStride = 16;
+  uint8_t src_data[kStride * kHeight];
+  for (int y = 0; y < kHeight; ++y) {
+    for (int i = 0; i < kStride; ++i) {
+      const int x = i / 3;
+      const bool used = x < kWidth - 1 && y < kHeight - 1;
+      src_data[y * kStride + i] =
+          static_cast<uint8_t>(used ? 10 * x + 50 * y + i % 3 : 255);
+    }
+  }
+  const ImageData src(
+      ImageData::kRgb888, mathfu::vec2i(kWidth, kHeight),
+      DataContainer::WrapDataAsReadOnly(src_data, sizeof(src_data)), kStride);
+  ImageData dst(ImageData::kRgb888, mathfu::vec2i(2, 1),
+                DataContainer::CreateHeapDataContainer(6));
+
+  DownsampleImageRows(src, &dst, 0, 1);
+  for (int x = 0; x < 2; ++x) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_EQ(20 * x + 30 + c, dst.GetBytes()[3 * x + c]);
+    }
+  }
+}
+
+TEST(DownsampleImageRows, DropsLastRowOfOddHeightColumn) {
+  const uint8_t src_data[] = {10, 20, 30, 40, 255};
+  const ImageData src(
+      ImageData::kLuminance, mathfu::vec2i(1, 5),
+      DataContainer::WrapDataAsReadOnly(src_data, sizeof(src_data)));
+  ImageData dst(ImageData::kLuminance, mathfu::vec2i(1, 2),
+                DataContainer::CreateHeapDataContainer(2));
+
+  DownsampleImageRows(src, &dst, 0, 2);
+  EXPECT_EQ(15, dst.GetBytes()[0]);
+  EXPECT_EQ(35, dst.GetBytes()[1]);
+}
+
 }  // namespace
 }  // namespace lull
@@ -16,9 +16,12 @@ limitations under the License.
 
 #include "lullaby/modules/input/input_manager.h"
 
+#include <cmath>
+
 #include "gtest/gtest.h"
 #include "lullaby/util/bits.h"
 #include "lullaby/util/clock.h"
+#include "lullaby/util/time.h"
 #include "lullaby/tests/mathfu_matchers.h"
 #include "lullaby/tests/portable_test_macros.h"
 
@@ -1355,5 +1358,95 @@ TEST(InputManagerDeathTest, Battery) {
   input.DisconnectDevice(device);
   EXPECT_TRUE(!input.IsConnected(device));
 }
+TEST(InputManager, LatestPose) {
+  InputManager input;
+  const auto device = InputManager::kHmd;
+
+  DeviceProfile profile;
+  profile.rotation_dof = DeviceProfile::kRealDof;
+  profile.position_dof = DeviceProfile::kRealDof;
+  input.ConnectDevice(device, profile);
+
+  InputManager::PoseSample sample;
+  EXPECT_FALSE(input.GetLatestPose(device, &sample));
+
+  const Clock::time_point t0 = Clock::time_point() + std::chrono::seconds(1);
+  const Clock::time_point t1 = t0 + std::chrono::milliseconds(10);
+  const mathfu::quat rot = mathfu::quat::FromAngleAxis(0.01f, mathfu::kAxisY3f);
+  input.UpdatePose(device, mathfu::kZeros3f, mathfu::quat::identity, t0);
+  input.UpdatePose(device, mathfu::vec3(0.01f, 0, 0), rot, t1);
+
+  // The latest sample is available immediately, without advancing the frame.
+  EXPECT_TRUE(input.GetLatestPose(device, &sample));
+  EXPECT_TRUE(sample.time == t1);
+  EXPECT_THAT(sample.position, NearMathfu(mathfu::vec3(0.01f, 0, 0), kEpsilon));
+  EXPECT_THAT(sample.linear_velocity, NearMathfu(mathfu::vec3(1, 0, 0), 1e-3f));
+  EXPECT_THAT(sample.angular_velocity,
+              NearMathfu(mathfu::vec3(0, 1, 0), 1e-3f));
+  EXPECT_NEAR(input.GetDofPosition(device)[0], 0, kEpsilon);
+
+  // The pose is extrapolated to the requested time.
+  const mathfu::mat4 predicted = input.GetDofWorldFromObjectMatrix(
+      device, t1 + std::chrono::milliseconds(10));
+  EXPECT_NEAR(predicted(0, 3), 0.02f, 1e-4f);
+  EXPECT_NEAR(predicted(0, 2), std::sin(0.02f), 1e-4f);
+
+  // But no further than kMaxPosePredictionTime.
+  const mathfu::mat4 limited =
+      input.GetDofWorldFromObjectMatrix(device, t1 + std::chrono::seconds(1));
+  const float max_dt =
+      SecondsFromDuration(InputManager::kMaxPosePredictionTime);
+  EXPECT_NEAR(limited(0, 3), 0.01f + max_dt, 1e-4f);
+
+  // Poses are also recorded in the frame state.
+  input.AdvanceFrame(kDeltaTime);
+  EXPECT_NEAR(input.GetDofPosition(device)[0], 0.01f, kEpsilon);
+
+  input.DisconnectDevice(device);
+  EXPECT_FALSE(input.GetLatestPose(device, &sample));
+}
+
+TEST(InputManager, KeyCodes) {
+  InputManager input;
+  const auto device = InputManager::kKeyboard;
+
+  DeviceProfile profile;
+  profile.long_press_time = kLongPressTime;
+  input.ConnectDevice(device, profile);
+  EXPECT_TRUE(input.GetKeysDown(device).none());
+  EXPECT_TRUE(CheckBit(input.GetKeyState(device, kKeyCodeA),
+                       InputManager::kReleased));
+
+  input.UpdateKey(device, kKeyCodeA, true, false);
+  input.AdvanceFrame(kDeltaTime);
+  EXPECT_TRUE(input.GetKeysDown(device).test(kKeyCodeA));
+  EXPECT_EQ(input.GetKeysDown(device).count(), 1u);
+  EXPECT_TRUE(CheckBit(input.GetKeyState(device, kKeyCodeA),
+                       InputManager::kJustPressed));
+  EXPECT_TRUE(CheckBit(input.GetKeyState(device, kKeyCodeB),
+                       InputManager::kReleased));
+
+  input.UpdateKey(device, kKeyCodeLeftShift, true, false);
+  input.AdvanceFrame(kDeltaTime);
+  EXPECT_EQ(input.GetKeysDown(device).count(), 2u);
+  EXPECT_TRUE(CheckBit(input.GetKeyState(device, kKeyCodeA),
+                       InputManager::kPressed));
+  EXPECT_FALSE(CheckBit(input.GetKeyState(device, kKeyCodeA),
+                        InputManager::kJustPressed));
+
+  input.AdvanceFrame(kLongPressTime);
+  EXPECT_TRUE(CheckBit(input.GetKeyState(device, kKeyCodeA),
+                       InputManager::kLongPressed));
+
+  input.UpdateKey(device, kKeyCodeA, false, false);
+  input.AdvanceFrame(kDeltaTime);
+  EXPECT_FALSE(input.GetKeysDown(device).test(kKeyCodeA));
+  EXPECT_TRUE(input.GetKeysDown(device).test(kKeyCodeLeftShift));
+  EXPECT_TRUE(CheckBit(input.GetKeyState(device, kKeyCodeA),
+                       InputManager::kJustReleased));
+
+  input.DisconnectDevice(device);
+}
+
 }  // namespace
 }  // namespace lull
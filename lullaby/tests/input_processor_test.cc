@@ -15,12 +15,19 @@ limitations under the License.
 */
 
 #include "lullaby/modules/input_processor/input_processor.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "lullaby/events/input_events.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/dispatcher/queued_dispatcher.h"
 #include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/modules/input_processor/gesture.h"
+#include "lullaby/modules/input_processor/touchscreen_gestures.h"
 #include "lullaby/systems/dispatcher/dispatcher_system.h"
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/generated/transform_def_generated.h"
@@ -1128,5 +1135,179 @@ TEST_F(InputProcessorTest, TouchClickEvent) {
   listener.touch_event_calls_[kTouchClick] = InputManager::kMaxNumDeviceTypes;
   listener.ExpectDefaultState();
 }
+
+// A gesture that keeps its touches until they are released.
+class HoldGesture : public Gesture {
+ public:
+  Gesture::State AdvanceFrame(const Clock::duration& delta_time) override {
+    return kRunning;
+  }
+};
+
+// A custom recognizer that only overrides TryStart, recording the touches it
+// is offered.  It starts a HoldGesture for the first offer including
+// |claimed_id|.
+class ClaimRecognizer : public GestureRecognizer {
+ public:
+  ClaimRecognizer(Registry* registry, size_t num_touches,
+                  InputManager::TouchId claimed_id)
+      : GestureRecognizer(registry, "Claim", num_touches),
+        claimed_id_(claimed_id) {}
+
+  GesturePtr TryStart(InputManager::DeviceType device,
+                      InputManager::TouchpadId touchpad,
+                      Gesture::TouchIdSpan ids) override {
+    offers.emplace_back(ids.begin(), ids.end());
+    const bool claim =
+        std::find(ids.begin(), ids.end(), claimed_id_) != ids.end();
+    if (gesture == nullptr && claim) {
+      gesture = std::make_shared<HoldGesture>();
+      return gesture;
+    }
+    return nullptr;
+  }
+
+  std::vector<Gesture::TouchIdVector> offers;
+  GesturePtr gesture;
+
+ private:
+  InputManager::TouchId claimed_id_;
+};
+
+// Ignores the callbacks of the built in gestures.
+struct IgnoreGestureCallback {
+  void operator()(Gesture::State state, Entity entity,
+                  const mathfu::vec2& value) const {}
+  void operator()(Gesture::State state, Entity entity, float value) const {}
+};
+
+// Wraps one of the built in recognizers to record the touches it is offered.
+template <typename Recognizer>
+class SpyRecognizer : public Recognizer {
+ public:
+  explicit SpyRecognizer(Registry* registry)
+      : Recognizer(registry, "Spy",
+                   typename Recognizer::Callback(IgnoreGestureCallback())) {}
+
+  GesturePtr TryStartFromSamples(InputManager::DeviceType device,
+                                 InputManager::TouchpadId touchpad,
+                                 Span<const TouchSample*> samples) override {
+    Gesture::TouchIdVector ids;
+    for (size_t i = 0; i < samples.size(); ++i) {
+      ids.push_back(samples[i]->id);
+    }
+    offers.emplace_back(std::move(ids));
+    return Recognizer::TryStartFromSamples(device, touchpad, samples);
+  }
+
+  std::vector<Gesture::TouchIdVector> offers;
+};
+
+const InputManager::TouchId kFirstTouch = 1;
+const InputManager::TouchId kSecondTouch = 2;
+const InputManager::TouchId kUnusedTouch = 3;
+
+class InputProcessorGestureTest : public InputProcessorTest {
+ protected:
+  void SetUp() override {
+    InputProcessorTest::SetUp();
+    input_manager_->UpdateTouchpadSize(kDevice, kTouchpad,
+                                       mathfu::vec2(10.f, 10.f));
+  }
+
+  // Updates both touches and runs gesture recognition for a frame.
+  void Touch(const mathfu::vec2& first, const mathfu::vec2& second) {
+    input_manager_->UpdateTouch(kDevice, kTouchpad, kFirstTouch, first, true);
+    input_manager_->UpdateTouch(kDevice, kTouchpad, kSecondTouch, second,
+                                true);
+    input_manager_->AdvanceFrame(kDeltaTime);
+    InputFocus focus;
+    focus.device = kDevice;
+    input_processor_->UpdateDevice(kDeltaTime, focus);
+  }
+
+  const InputManager::DeviceType kDevice = InputManager::kController;
+  const InputManager::TouchpadId kTouchpad = InputManager::kPrimaryTouchpadId;
+};
+
+TEST_F(InputProcessorGestureTest, OwnedTouchNotOfferedToDragOrPinch) {
+  auto claim = std::make_shared<ClaimRecognizer>(registry_.get(), 1,
+                                                 kFirstTouch);
+  auto drag =
+      std::make_shared<SpyRecognizer<OneFingerDragRecognizer>>(registry_.get());
+  auto pinch =
+      std::make_shared<SpyRecognizer<PinchRecognizer>>(registry_.get());
+  input_processor_->SetTouchGestureRecognizers(kDevice, kTouchpad,
+                                               {claim, drag, pinch});
+
+  // The first touch is claimed in the same frame that drag and pinch run, so
+  // only the second touch is offered and there is no pair to pinch.
+  Touch(mathfu::vec2(.4f, .5f), mathfu::vec2(.6f, .5f));
+  ASSERT_NE(claim->gesture, nullptr);
+  EXPECT_EQ(input_processor_->GetTouchOwner(kDevice, kTouchpad, kFirstTouch),
+            claim->gesture);
+  EXPECT_EQ(input_processor_->GetTouchOwner(kDevice, kTouchpad, kSecondTouch),
+            nullptr);
+  EXPECT_THAT(drag->offers,
+              testing::ElementsAre(Gesture::TouchIdVector{kSecondTouch}));
+  EXPECT_TRUE(pinch->offers.empty());
+
+  // The same holds once the touch was owned before recognition started.
+  drag->offers.clear();
+  Touch(mathfu::vec2(.4f, .5f), mathfu::vec2(.6f, .5f));
+  EXPECT_THAT(drag->offers,
+              testing::ElementsAre(Gesture::TouchIdVector{kSecondTouch}));
+  EXPECT_TRUE(pinch->offers.empty());
+}
+
+TEST_F(InputProcessorGestureTest, StationaryTouchesNotOfferedToTwist) {
+  auto twist =
+      std::make_shared<SpyRecognizer<TwistRecognizer>>(registry_.get());
+  auto pinch =
+      std::make_shared<SpyRecognizer<PinchRecognizer>>(registry_.get());
+  input_processor_->SetTouchGestureRecognizers(kDevice, kTouchpad,
+                                               {twist, pinch});
+
+  Touch(mathfu::vec2(.4f, .5f), mathfu::vec2(.6f, .5f));
+  twist->offers.clear();
+  pinch->offers.clear();
+
+  // Pinch is offered the stationary pair, twist is not.
+  Touch(mathfu::vec2(.4f, .5f), mathfu::vec2(.6f, .5f));
+  EXPECT_TRUE(twist->offers.empty());
+  EXPECT_EQ(pinch->offers.size(), 1u);
+
+  // Once both touches move, twist is offered the pair.
+  Touch(mathfu::vec2(.4f, .45f), mathfu::vec2(.6f, .55f));
+  ASSERT_EQ(twist->offers.size(), 1u);
+  EXPECT_THAT(twist->offers[0],
+              testing::UnorderedElementsAre(kFirstTouch, kSecondTouch));
+}
+
+TEST_F(InputProcessorGestureTest, CustomRecognizerOverridingTryStart) {
+  auto single = std::make_shared<ClaimRecognizer>(registry_.get(), 1,
+                                                  kUnusedTouch);
+  auto pair = std::make_shared<ClaimRecognizer>(registry_.get(), 2,
+                                                kFirstTouch);
+  input_processor_->SetTouchGestureRecognizers(kDevice, kTouchpad,
+                                               {pair, single});
+
+  // Custom recognizers receive the touch ids through the default
+  // TryStartFromSamples and can start gestures, which own their touches.
+  Touch(mathfu::vec2(.4f, .5f), mathfu::vec2(.6f, .5f));
+  ASSERT_EQ(pair->offers.size(), 1u);
+  EXPECT_THAT(pair->offers[0],
+              testing::UnorderedElementsAre(kFirstTouch, kSecondTouch));
+  ASSERT_NE(pair->gesture, nullptr);
+  EXPECT_EQ(input_processor_->GetTouchOwner(kDevice, kTouchpad, kFirstTouch),
+            pair->gesture);
+  EXPECT_EQ(input_processor_->GetTouchOwner(kDevice, kTouchpad, kSecondTouch),
+            pair->gesture);
+
+  // Custom recognizers don't reject anything, so they are still offered
+  // owned touches.
+  EXPECT_EQ(single->offers.size(), 2u);
+}
+
 }  // namespace
 }  // namespace lull
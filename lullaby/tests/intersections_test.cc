@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/util/intersections.h"
 
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "lullaby/tests/mathfu_matchers.h"
 #include "lullaby/tests/portable_test_macros.h"
@@ -25,6 +27,8 @@ namespace {
 
 using testing::EqualsMathfu;
 
+constexpr float kEpsilon = 0.0001f;
+
 TEST(IntersectionsTest, Basic) {
   mathfu::vec3 intersection_position;
   EXPECT_TRUE(
@@ -100,6 +104,92 @@ TEST(IntersectionsTest, QuadRotated45) {
               EqualsMathfu(mathfu::vec3(1.0f, 0.0f, 0.0f)));
 }
 
+TEST(IntersectionsTest, CheckRayOBBCollisions) {
+  // Use a number of boxes that doesn't fill the last batch.
+  const size_t kNumBoxes = 4 * kRayOBBCollisionBatchSize + 3;
+  std::vector<mathfu::mat4> world_mats;
+  std::vector<Aabb> boxes;
+  for (size_t i = 0; i < kNumBoxes; ++i) {
+    const float f = static_cast<float>(i);
+    const mathfu::vec3 translation(0.05f * f, 0.02f * f, -2.f * f);
+    const mathfu::quat rotation =
+        mathfu::quat::FromAngleAxis(0.4f * f, mathfu::vec3(1.f, 2.f, 3.f));
+    const mathfu::vec3 scale(1.f + 0.1f * f, 1.f, 2.f - 0.05f * f);
+    world_mats.push_back(
+        mathfu::mat4::Transform(translation, rotation.ToMatrix(), scale));
+    boxes.emplace_back(mathfu::vec3(-1.f, -0.5f, -1.f),
+                       mathfu::vec3(1.f, 0.5f, 0.25f));
+  }
+  // A degenerate transform should never be hit.
+  world_mats[5] = mathfu::mat4::FromScaleVector(mathfu::vec3(1.f, 0.f, 1.f));
+
+  const Ray rays[] = {
+      Ray(mathfu::kZeros3f, -mathfu::kAxisZ3f),
+      Ray(mathfu::vec3(0.f, 0.25f, 1.f), mathfu::vec3(0.1f, 0.f, -3.f)),
+      Ray(mathfu::vec3(-0.5f, 0.f, 0.f), mathfu::kAxisX3f),
+  };
+  std::vector<float> distances(kNumBoxes);
+  for (const Ray& ray : rays) {
+    for (const bool collision_on_exit : {false, true}) {
+      CheckRayOBBCollisions(ray, world_mats.data(), boxes.data(), kNumBoxes,
+                            distances.data(), collision_on_exit);
+      int num_hits = 0;
+      for (size_t i = 0; i < kNumBoxes; ++i) {
+        const float expected = CheckRayOBBCollision(
+            ray, world_mats[i], boxes[i], collision_on_exit);
+        EXPECT_NEAR(distances[i], expected, kEpsilon) << "box " << i;
+        if (expected != kNoHitDistance) {
+          ++num_hits;
+        }
+      }
+      EXPECT_GT(num_hits, 0);
+      EXPECT_EQ(distances[5], kNoHitDistance);
+    }
+  }
+}
+
+TEST(IntersectionsTest, CheckSpheresInFrustums) {
+  // Two views looking down -z, offset along x like a pair of eyes.
+  const mathfu::mat4 clip_from_eye = mathfu::mat4::Perspective(
+      0.5f * kPi, 1.f, 0.1f, 100.f);
+  mathfu::vec4 frustums[2][kNumFrustumPlanes];
+  CalculateViewFrustum(clip_from_eye * mathfu::mat4::FromTranslationVector(
+                                           mathfu::vec3(0.5f, 0.f, 0.f)),
+                       frustums[0]);
+  CalculateViewFrustum(clip_from_eye * mathfu::mat4::FromTranslationVector(
+                                           mathfu::vec3(-0.5f, 0.f, 0.f)),
+                       frustums[1]);
+
+  // Use a number of spheres that doesn't fill the last batch.
+  std::vector<mathfu::vec4> spheres;
+  for (int x = -12; x <= 12; x += 3) {
+    for (int z = -120; z <= 20; z += 10) {
+      const float radius = 0.25f * static_cast<float>((x + z) & 7);
+      spheres.emplace_back(static_cast<float>(x), 0.f, static_cast<float>(z),
+                           radius);
+    }
+  }
+  ASSERT_NE(spheres.size() % kSphereFrustumBatchSize, size_t(0));
+
+  std::vector<uint8_t> visible(spheres.size());
+  for (size_t num_views = 1; num_views <= 2; ++num_views) {
+    CheckSpheresInFrustums(spheres.data(), spheres.size(), frustums,
+                           num_views, visible.data());
+    int num_visible = 0;
+    for (size_t i = 0; i < spheres.size(); ++i) {
+      bool expected = false;
+      for (size_t j = 0; j < num_views; ++j) {
+        expected |= CheckSphereInFrustum(spheres[i].xyz(), spheres[i].w,
+                                         frustums[j]);
+      }
+      EXPECT_EQ(expected, visible[i] != 0) << "sphere " << i;
+      num_visible += expected ? 1 : 0;
+    }
+    EXPECT_GT(num_visible, 0);
+    EXPECT_LT(num_visible, static_cast<int>(spheres.size()));
+  }
+}
+
 TEST(IntersectionsDeathTest, UnnormalizedVectors) {
   PORT_EXPECT_DEBUG_DEATH(
       IntersectRayPlane(
@@ -16,7 +16,10 @@ limitations under the License.
 
 #include "lullaby/util/job_processor.h"
 
+#include <atomic>
 #include <future>
+#include <memory>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -53,5 +56,138 @@ TEST(JobProcessorTest, ManyJobs) {
   }
 }
 
+TEST(JobProcessorTest, Dependencies) {
+  JobProcessor job_processor(/* num_worker_threads = */ 4);
+
+  // A diamond: |first| -> |left|, |right| -> |last|.
+  std::atomic<int> order(0);
+  int first_order = -1;
+  int left_order = -1;
+  int right_order = -1;
+  int last_order = -1;
+  auto first = job_processor.Create([&]() { first_order = order++; });
+  auto left = job_processor.Create([&]() { left_order = order++; });
+  auto right = job_processor.Create([&]() { right_order = order++; });
+  auto last = job_processor.Create([&]() { last_order = order++; });
+  job_processor.AddDependency(left, first);
+  job_processor.AddDependency(right, first);
+  job_processor.AddDependency(last, left);
+  job_processor.AddDependency(last, right);
+
+  // Submit in reverse order to make sure the dependencies are respected.
+  job_processor.Submit(last);
+  job_processor.Submit(right);
+  job_processor.Submit(left);
+  EXPECT_FALSE(job_processor.IsDone(left));
+  job_processor.Submit(first);
+
+  job_processor.Wait(last);
+  EXPECT_TRUE(job_processor.IsDone(first));
+  EXPECT_TRUE(job_processor.IsDone(left));
+  EXPECT_TRUE(job_processor.IsDone(right));
+  EXPECT_TRUE(job_processor.IsDone(last));
+  EXPECT_THAT(first_order, Eq(0));
+  EXPECT_THAT(last_order, Eq(3));
+  EXPECT_THAT(left_order + right_order, Eq(3));
+}
+
+TEST(JobProcessorTest, DependencyOnCompletedJob) {
+  JobProcessor job_processor(/* num_worker_threads = */ 1);
+
+  auto first = job_processor.Run([]() {});
+  job_processor.Wait(first);
+
+  int value = 0;
+  auto second = job_processor.Create([&value]() { value = 1; });
+  job_processor.AddDependency(second, first);
+  job_processor.Submit(second);
+  job_processor.Wait(second);
+  EXPECT_THAT(value, Eq(1));
+}
+
+TEST(JobProcessorTest, FanOutFanIn) {
+  static const int kNumBatches = 64;
+  static const int kBatchSize = 100;
+
+  JobProcessor job_processor(/* num_worker_threads = */ 4);
+
+  std::vector<int> values(kNumBatches * kBatchSize, 0);
+  int total = 0;
+  auto sum = job_processor.Create([&]() {
+    for (int value : values) {
+      total += value;
+    }
+  });
+
+  // Each batch spawns nested jobs from inside a worker thread.
+  for (int batch = 0; batch < kNumBatches; ++batch) {
+    auto job = job_processor.Create([&, batch]() {
+      std::vector<JobProcessor::JobHandle> children;
+      for (int i = 0; i < kBatchSize; i += 10) {
+        children.emplace_back(job_processor.Run([&, batch, i]() {
+          for (int j = i; j < i + 10; ++j) {
+            values[batch * kBatchSize + j] = 1;
+          }
+        }));
+      }
+      for (auto& child : children) {
+        job_processor.Wait(child);
+      }
+    });
+    job_processor.AddDependency(sum, job);
+    job_processor.Submit(job);
+  }
+  job_processor.Submit(sum);
+  job_processor.Wait(sum);
+
+  EXPECT_THAT(total, Eq(kNumBatches * kBatchSize));
+}
+
+TEST(JobProcessorTest, NoWorkerThreads) {
+  JobProcessor job_processor(/* num_worker_threads = */ 0);
+  EXPECT_THAT(job_processor.GetNumWorkerThreads(), Eq(size_t(0)));
+
+  int value = 0;
+  auto first = job_processor.Create([&value]() { value = value * 10 + 1; });
+  auto second = job_processor.Run([&value]() { value = value * 10 + 2; });
+  job_processor.Wait(second);
+  EXPECT_THAT(value, Eq(2));
+
+  job_processor.Submit(first);
+  EXPECT_TRUE(job_processor.IsDone(first));
+  EXPECT_THAT(value, Eq(21));
+
+  std::future<void> job = RunJob(&job_processor, [&value]() { value = 0; });
+  job.wait();
+  EXPECT_THAT(value, Eq(0));
+}
+
+TEST(JobProcessorTest, LargeFunctor) {
+  JobProcessor job_processor(/* num_worker_threads = */ 2);
+
+  // Functors too large for the inline storage are stored on the heap, and are
+  // destroyed once the job has run.
+  struct Large {
+    int values[64];
+  };
+  Large large;
+  for (int i = 0; i < 64; ++i) {
+    large.values[i] = i;
+  }
+  auto shared = std::make_shared<int>(0);
+  std::weak_ptr<int> weak = shared;
+
+  int total = 0;
+  auto job = job_processor.Run([large, shared, &total]() {
+    for (int value : large.values) {
+      total += value;
+    }
+  });
+  shared.reset();
+  job_processor.Wait(job);
+  EXPECT_THAT(total, Eq(2016));
+  EXPECT_TRUE(weak.expired());
+}
+
 }  // namespace
 }  // namespace lull
@@ -982,5 +982,47 @@ TEST_F(QueuedLayoutSystemTest, ActualBoxClosestSource_Second) {
                      actual_sources_);
 }
 
+// Test that a layout whose inputs have not changed since its previous pass is
+// not reapplied, unless explicitly requested with Layout().
+TEST_F(QueuedLayoutSystemTest, UnchangedInputsSkipLayout) {
+  const Entity parent = CreateParent();
+  CreateChild(parent, 1.0f);
+
+  dispatcher_->Dispatch();
+  layout_system_->SetCanvasSizeX(parent, 2.f);
+  dispatcher_->Dispatch();
+  ClearListeners();
+
+  layout_system_->SetCanvasSizeX(parent, 2.f);
+  dispatcher_->Dispatch();
+  AssertListenersEmpty();
+
+  layout_system_->Layout(parent);
+  dispatcher_->Dispatch();
+  AssertListenerMatch({ {parent, 1} }, layouts_changed_);
+}
+
+// Test that nested layouts dirtied in the same frame are processed before the
+// layouts containing them.
+TEST_F(QueuedLayoutSystemTest, DirtyLayoutsProcessedDeepestFirst) {
+  const Entity parent = CreateParent();
+  const Entity nested = CreateChild(parent, 0.f, true);
+  CreateChild(nested);
+
+  dispatcher_->Dispatch();
+
+  std::vector<Entity> order;
+  auto connection = dispatcher_->Connect(
+      [&order](const LayoutChangedEvent& e) { order.push_back(e.target); });
+
+  layout_system_->SetSpacingX(parent, 0.5f);
+  layout_system_->SetSpacingX(nested, 0.5f);
+  dispatcher_->Dispatch();
+
+  ASSERT_GE(order.size(), 2u);
+  EXPECT_EQ(nested, order[0]);
+  EXPECT_EQ(parent, order[1]);
+}
+
 }  // namespace
 }  // namespace lull
@@ -0,0 +1,207 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/light/light_system.h"
+
+#include <cstring>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/dispatcher/dispatcher_system.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/testing/mock_render_system_impl.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/tests/mathfu_matchers.h"
+
+namespace lull {
+namespace {
+
+using ::testing::_;
+using ::testing::Invoke;
+using testing::NearMathfu;
+
+constexpr float kEpsilon = 1e-5f;
+constexpr HashValue kGroup = ConstHash("group");
+
+class LightSystemTest : public ::testing::Test {
+ public:
+  LightSystemTest() {
+    registry_.Create<Dispatcher>();
+    entity_factory_ = registry_.Create<EntityFactory>(&registry_);
+    entity_factory_->CreateSystem<DispatcherSystem>();
+    transform_system_ = entity_factory_->CreateSystem<TransformSystem>();
+    render_system_ = entity_factory_->CreateSystem<RenderSystem>()->GetImpl();
+    light_system_ = entity_factory_->CreateSystem<LightSystem>();
+    entity_factory_->Initialize();
+  }
+
+ protected:
+  Entity CreateEntity(const mathfu::vec3& position) {
+    const Entity entity = entity_factory_->Create();
+    Sqt sqt;
+    sqt.translation = position;
+    transform_system_->Create(entity, sqt);
+    return entity;
+  }
+
+  void MoveTo(Entity entity, const mathfu::vec3& position) {
+    Sqt sqt;
+    sqt.translation = position;
+    transform_system_->SetSqt(entity, sqt);
+  }
+
+  // Creates a directional light with a shadow map.
+  Entity CreateShadowLight(bool cache_shadow_map) {
+    const Entity entity = CreateEntity(mathfu::kZeros3f);
+    DirectionalLightDefT light;
+    light.group = kGroup;
+    light.shadow_def.set<ShadowMapDefT>()->cache_shadow_map = cache_shadow_map;
+    light_system_->CreateLight(entity, light);
+    return entity;
+  }
+
+  Entity CreateShadowCaster(const mathfu::vec3& position, bool is_static) {
+    const Entity entity = CreateEntity(position);
+    LightableDefT lightable;
+    lightable.group = kGroup;
+    lightable.shadow_interaction = ShadowInteraction_CastAndReceive;
+    lightable.depth_shader = "shaders/depth.fplshader";
+    lightable.static_shadow_caster = is_static;
+    light_system_->CreateLight(entity, lightable);
+    return entity;
+  }
+
+  // Counts the shadow passes rendered by the LightSystem.
+  void CountShadowRenders() {
+    ON_CALL(*render_system_, Render(_, _, _))
+        .WillByDefault(Invoke(
+            [this](const RenderView* views, size_t num_views,
+                   HashValue pass) { ++num_shadow_renders_; }));
+  }
+
+  Registry registry_;
+  EntityFactory* entity_factory_ = nullptr;
+  TransformSystem* transform_system_ = nullptr;
+  RenderSystemImpl* render_system_ = nullptr;
+  LightSystem* light_system_ = nullptr;
+  int num_shadow_renders_ = 0;
+};
+
+TEST_F(LightSystemTest, LightableUsesNearestPointLight) {
+  const mathfu::vec3 positions[] = {
+      mathfu::vec3(0.5f, 0.5f, 0.5f),
+      mathfu::vec3(5.5f, 0.5f, 0.5f),
+      mathfu::vec3(10.5f, 0.5f, 0.5f),
+  };
+  for (const mathfu::vec3& position : positions) {
+    PointLightDefT light;
+    light.group = kGroup;
+    light_system_->CreateLight(CreateEntity(position), light);
+  }
+
+  // The lightable accepts fewer point lights than the group has.
+  const Entity lightable = CreateEntity(mathfu::vec3(5.2f, 0.3f, 0.4f));
+  LightableDefT lightable_def;
+  lightable_def.group = kGroup;
+  lightable_def.max_point_lights = 1;
+  light_system_->CreateLight(lightable, lightable_def);
+
+  mathfu::vec3 light_position = mathfu::kZeros3f;
+  ON_CALL(*render_system_, SetUniform(lightable, _, _, _, _))
+      .WillByDefault(Invoke([&](Entity e, const char* name, const float* data,
+                                int dimension, int count) {
+        if (std::strcmp(name, "light_point_pos") == 0) {
+          ASSERT_EQ(dimension, 3);
+          ASSERT_EQ(count, 1);
+          light_position = mathfu::vec3(data);
+        }
+      }));
+
+  light_system_->AdvanceFrame();
+  EXPECT_THAT(light_position, NearMathfu(positions[1], kEpsilon));
+
+  // Moving into another light grid cell re-lights the lightable.
+  MoveTo(lightable, mathfu::vec3(10.1f, 0.9f, 0.2f));
+  light_system_->AdvanceFrame();
+  EXPECT_THAT(light_position, NearMathfu(positions[2], kEpsilon));
+
+  MoveTo(lightable, mathfu::vec3(0.1f, 0.1f, 0.1f));
+  light_system_->AdvanceFrame();
+  EXPECT_THAT(light_position, NearMathfu(positions[0], kEpsilon));
+}
+
+TEST_F(LightSystemTest, ShadowMapRenderedOnlyWhenOutOfDate) {
+  CountShadowRenders();
+  CreateShadowLight(/* cache_shadow_map = */ true);
+  const Entity caster = CreateShadowCaster(mathfu::vec3(0.0f, 0.0f, -2.0f),
+                                           /* is_static = */ false);
+
+  light_system_->AdvanceFrame();
+  light_system_->RenderShadowMaps();
+  EXPECT_EQ(num_shadow_renders_, 1);
+
+  light_system_->AdvanceFrame();
+  light_system_->RenderShadowMaps();
+  EXPECT_EQ(num_shadow_renders_, 1);
+
+  // Moving a caster invalidates the shadow map once.
+  MoveTo(caster, mathfu::vec3(1.0f, 0.0f, -2.0f));
+  light_system_->AdvanceFrame();
+  light_system_->RenderShadowMaps();
+  EXPECT_EQ(num_shadow_renders_, 2);
+
+  light_system_->AdvanceFrame();
+  light_system_->RenderShadowMaps();
+  EXPECT_EQ(num_shadow_renders_, 2);
+
+  light_system_->InvalidateShadowMaps();
+  light_system_->RenderShadowMaps();
+  EXPECT_EQ(num_shadow_renders_, 3);
+}
+
+TEST_F(LightSystemTest, StaticCasterDoesNotInvalidateShadowMap) {
+  CountShadowRenders();
+  CreateShadowLight(/* cache_shadow_map = */ true);
+  const Entity caster = CreateShadowCaster(mathfu::vec3(0.0f, 0.0f, -2.0f),
+                                           /* is_static = */ true);
+
+  light_system_->AdvanceFrame();
+  light_system_->RenderShadowMaps();
+  EXPECT_EQ(num_shadow_renders_, 1);
+
+  MoveTo(caster, mathfu::vec3(1.0f, 0.0f, -2.0f));
+  light_system_->AdvanceFrame();
+  light_system_->RenderShadowMaps();
+  EXPECT_EQ(num_shadow_renders_, 1);
+}
+
+TEST_F(LightSystemTest, UncachedShadowMapRenderedEveryFrame) {
+  CountShadowRenders();
+  CreateShadowLight(/* cache_shadow_map = */ false);
+  CreateShadowCaster(mathfu::vec3(0.0f, 0.0f, -2.0f), /* is_static = */ false);
+
+  for (int i = 1; i <= 3; ++i) {
+    light_system_->AdvanceFrame();
+    light_system_->RenderShadowMaps();
+    EXPECT_EQ(num_shadow_renders_, i);
+  }
+}
+
+}  // namespace
+}  // namespace lull
@@ -62,6 +62,21 @@ TEST_F(LullScriptEngineTest, SimpleScript) {
   EXPECT_EQ(27, value);
 }
 
+TEST_F(LullScriptEngineTest, ByteCodeScript) {
+  ScriptEnv env;
+  const ScriptByteCode code = env.Compile("(= y (+ (* (+ x 3) 2) 1))");
+  const std::string blob(code.begin(), code.end());
+
+  const ScriptId id =
+      engine_->LoadInlineScript(blob, "script", Language_LullScript);
+  engine_->SetValue(id, "x", 10);
+  engine_->RunScript(id);
+
+  int value = 0;
+  EXPECT_TRUE(engine_->GetValue(id, "y", &value));
+  EXPECT_EQ(27, value);
+}
+
 TEST_F(LullScriptEngineTest, RegisterFunction) {
   int x = 10;
   FunctionBinder* binder = registry_.Get<FunctionBinder>();
@@ -249,5 +264,45 @@ TEST_F(LullScriptEngineTest, Optional) {
   EXPECT_EQ(q, Optional<int>(3));
 }
 
+TEST_F(LullScriptEngineTest, Profiling) {
+  FunctionBinder* binder = registry_.Get<FunctionBinder>();
+  binder->RegisterFunction("Foo", [](int y) { return y + 1; });
+
+  const ScriptId id = engine_->LoadInlineScript(
+      "(= x (Foo (Foo 1)))", "profiled", Language_LullScript);
+  engine_->RunScript(id);
+  EXPECT_FALSE(engine_->IsProfilingEnabled());
+  EXPECT_TRUE(engine_->GetScriptStats().empty());
+  EXPECT_TRUE(engine_->GetFunctionStats().empty());
+
+  engine_->EnableProfiling(true);
+  engine_->RunScript(id);
+  engine_->RunScript(id);
+
+  const std::vector<ScriptCallStats> scripts = engine_->GetScriptStats();
+  ASSERT_EQ(1u, scripts.size());
+  EXPECT_EQ("profiled", scripts[0].name);
+  EXPECT_EQ(2u, scripts[0].num_calls);
+
+  const std::vector<ScriptCallStats> functions = engine_->GetFunctionStats();
+  ASSERT_EQ(1u, functions.size());
+  EXPECT_EQ("Foo", functions[0].name);
+  EXPECT_EQ(4u, functions[0].num_calls);
+  EXPECT_EQ(functions[0].total_time, functions[0].self_time);
+
+  // The time spent in Foo is only counted in the self time of Foo.
+  EXPECT_EQ(scripts[0].total_time - functions[0].total_time,
+            scripts[0].self_time);
+
+  engine_->ResetStats();
+  EXPECT_TRUE(engine_->GetScriptStats().empty());
+  EXPECT_TRUE(engine_->GetFunctionStats().empty());
+
+  engine_->RunScript(id);
+  EXPECT_EQ(1u, engine_->GetScriptStats().size());
+  engine_->UnloadScript(id);
+  EXPECT_TRUE(engine_->GetScriptStats().empty());
+}
+
 }  // namespace
 }  // namespace lull
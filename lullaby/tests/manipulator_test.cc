@@ -0,0 +1,114 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/modules/manipulator/manipulator.h"
+#include "lullaby/modules/manipulator/scaling_manipulator.h"
+#include "lullaby/modules/manipulator/translation_manipulator.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/testing/mock_render_system_impl.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/math.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+constexpr float kEpsilon = 1e-4f;
+
+class ManipulatorTest : public ::testing::Test {
+ public:
+  ManipulatorTest() {
+    entity_factory_ = registry_.Create<EntityFactory>(&registry_);
+    transform_system_ = entity_factory_->CreateSystem<TransformSystem>();
+    entity_factory_->CreateSystem<RenderSystem>();
+    entity_factory_->Initialize();
+  }
+
+ protected:
+  // Creates an entity that is translated and rotated off every axis, so that
+  // the indicators are oriented boxes rather than axis aligned ones.
+  Entity CreateEntity() {
+    const Entity entity = entity_factory_->Create();
+    Sqt sqt;
+    sqt.translation = mathfu::vec3(1.f, 2.f, -3.f);
+    sqt.rotation = mathfu::quat::FromAngleAxis(
+        30.f * mathfu::kDegreesToRadians,
+        mathfu::vec3(1.f, 1.f, 0.f).Normalized());
+    transform_system_->Create(entity, sqt);
+    return entity;
+  }
+
+  // ManipulatorManager skips an indicator whenever the ray misses its bounds
+  // or the bounds are further away than a closer hit, so a ray hitting an
+  // indicator must hit its bounds no further along the ray.
+  void ExpectBoundsEncloseIndicators(Manipulator* manipulator) {
+    const std::vector<mathfu::vec3> directions = {
+        mathfu::kAxisX3f,  -mathfu::kAxisX3f, mathfu::kAxisY3f,
+        -mathfu::kAxisY3f, mathfu::kAxisZ3f,  -mathfu::kAxisZ3f,
+        mathfu::vec3(1.f, 1.f, 1.f).Normalized(),
+    };
+    for (size_t i = 0; i < manipulator->GetNumIndicators(); ++i) {
+      const Aabb bounds = manipulator->GetIndicatorBounds(i);
+      const mathfu::vec3 center = (bounds.min + bounds.max) * 0.5f;
+      for (const mathfu::vec3& direction : directions) {
+        const Ray ray(center + 5.f * direction, -direction);
+        const float hit = manipulator->CheckRayCollidingIndicator(ray, i);
+        const float bounds_hit = CheckRayAABBCollision(ray, bounds);
+        EXPECT_NE(hit, kNoHitDistance);
+        EXPECT_NE(bounds_hit, kNoHitDistance);
+        EXPECT_LE(bounds_hit, hit + kEpsilon);
+      }
+
+      // A ray passing just outside the bounds misses the indicator.
+      const Ray miss(bounds.max + mathfu::vec3(kEpsilon, kEpsilon, -10.f),
+                     mathfu::kAxisZ3f);
+      EXPECT_EQ(CheckRayAABBCollision(miss, bounds), kNoHitDistance);
+      EXPECT_EQ(manipulator->CheckRayCollidingIndicator(miss, i),
+                kNoHitDistance);
+    }
+  }
+
+  Registry registry_;
+  EntityFactory* entity_factory_;
+  TransformSystem* transform_system_;
+};
+
+TEST_F(ManipulatorTest, TranslationBoundsEncloseIndicators) {
+  TranslationManipulator manipulator(&registry_, "");
+  manipulator.SetControlMode(Manipulator::kLocal);
+  const Entity entity = CreateEntity();
+  manipulator.SetupIndicators(entity);
+  ExpectBoundsEncloseIndicators(&manipulator);
+
+  // The bounds follow the indicators when the entity moves.
+  transform_system_->SetLocalTranslation(entity, mathfu::vec3(-4.f, 0.f, 2.f));
+  manipulator.UpdateIndicatorsTransform(
+      *transform_system_->GetWorldFromEntityMatrix(entity));
+  ExpectBoundsEncloseIndicators(&manipulator);
+}
+
+TEST_F(ManipulatorTest, ScalingBoundsEncloseIndicators) {
+  ScalingManipulator manipulator(&registry_);
+  manipulator.SetupIndicators(CreateEntity());
+  ExpectBoundsEncloseIndicators(&manipulator);
+}
+
+}  // namespace
+}  // namespace lull
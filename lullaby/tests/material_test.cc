@@ -97,5 +97,107 @@ TEST(Material, SetGetTexture) {
   EXPECT_THAT(material.GetTexture(specular), Pointee(TextureIdEquals(15)));
 }
 
+TEST(Material, IsInstanceCompatible) {
+  static constexpr HashValue kColor = ConstHash("color");
+  static constexpr HashValue kOther = ConstHash("other");
+  static constexpr float kRed[] = {1.0f, 0.0f, 0.0f, 1.0f};
+  static constexpr float kBlue[] = {0.0f, 0.0f, 1.0f, 1.0f};
+
+  Material a;
+  Material b;
+  EXPECT_TRUE(a.IsInstanceCompatible(b, kColor));
+
+  // The per-instance uniform can differ or be missing.
+  a.SetUniform<float>(kColor, ShaderDataType_Float4, {kRed, 1});
+  EXPECT_TRUE(a.IsInstanceCompatible(b, kColor));
+  b.SetUniform<float>(kColor, ShaderDataType_Float4, {kBlue, 1});
+  EXPECT_TRUE(a.IsInstanceCompatible(b, kColor));
+  EXPECT_TRUE(b.IsInstanceCompatible(a, kColor));
+
+  // Other uniforms must match.
+  a.SetUniform<float>(kOther, ShaderDataType_Float4, {kRed, 1});
+  EXPECT_FALSE(a.IsInstanceCompatible(b, kColor));
+  EXPECT_FALSE(b.IsInstanceCompatible(a, kColor));
+  b.SetUniform<float>(kOther, ShaderDataType_Float4, {kBlue, 1});
+  EXPECT_FALSE(a.IsInstanceCompatible(b, kColor));
+  b.SetUniform<float>(kOther, ShaderDataType_Float4, {kRed, 1});
+  EXPECT_TRUE(a.IsInstanceCompatible(b, kColor));
+
+  // Render state overrides prevent instancing with other materials.
+  DepthStateT depth_state;
+  b.SetDepthState(&depth_state);
+  EXPECT_FALSE(a.IsInstanceCompatible(b, kColor));
+  EXPECT_TRUE(b.IsInstanceCompatible(b, kColor));
+}
+
+TEST(Material, UpdateSnapshot) {
+  static constexpr HashValue kColor = ConstHash("color");
+  static constexpr HashValue kFeature = ConstHash("feature");
+  static constexpr float kRed[] = {1.0f, 0.0f, 0.0f, 1.0f};
+  static constexpr float kBlue[] = {0.0f, 0.0f, 1.0f, 1.0f};
+
+  Material source;
+  source.SetUniform<float>(kColor, ShaderDataType_Float4, {kRed, 1});
+  source.RequestShaderFeature(kFeature);
+  source.Hide();
+  DepthStateT depth_state;
+  source.SetDepthState(&depth_state);
+
+  Material snapshot;
+  snapshot.UpdateSnapshot(source);
+  const detail::UniformData* color = snapshot.GetUniformData(kColor);
+  ASSERT_THAT(color, NotNull());
+  EXPECT_THAT(color->GetData<float>()[0], Eq(1.0f));
+  EXPECT_TRUE(snapshot.IsShaderFeatureRequested(kFeature));
+  EXPECT_TRUE(snapshot.IsHidden());
+  EXPECT_THAT(snapshot.GetDepthState(), NotNull());
+
+  // Changes to the source are not visible until the next update.
+  source.SetUniform<float>(kColor, ShaderDataType_Float4, {kBlue, 1});
+  source.ClearShaderFeature(kFeature);
+  source.Show();
+  source.SetDepthState(nullptr);
+  EXPECT_THAT(snapshot.GetUniformData(kColor)->GetData<float>()[0], Eq(1.0f));
+  EXPECT_TRUE(snapshot.IsShaderFeatureRequested(kFeature));
+  EXPECT_TRUE(snapshot.IsHidden());
+
+  snapshot.UpdateSnapshot(source);
+  EXPECT_THAT(snapshot.GetUniformData(kColor)->GetData<float>()[0], Eq(0.0f));
+  EXPECT_THAT(snapshot.GetUniformData(kColor)->GetData<float>()[2], Eq(1.0f));
+  EXPECT_FALSE(snapshot.IsShaderFeatureRequested(kFeature));
+  EXPECT_FALSE(snapshot.IsHidden());
+  EXPECT_THAT(snapshot.GetDepthState(), IsNull());
+}
+
+TEST(Material, UpdateSnapshotCopiesOnlyChangedUniforms) {
+  static constexpr HashValue kColor = ConstHash("color");
+  static constexpr HashValue kOther = ConstHash("other");
+  static constexpr float kRed[] = {1.0f, 0.0f, 0.0f, 1.0f};
+  static constexpr float kBlue[] = {0.0f, 0.0f, 1.0f, 1.0f};
+
+  Material source;
+  source.SetUniform<float>(kColor, ShaderDataType_Float4, {kRed, 1});
+  source.SetUniform<float>(kOther, ShaderDataType_Float4, {kRed, 1});
+
+  Material snapshot;
+  snapshot.UpdateSnapshot(source);
+
+  // Overwrite both uniforms in the snapshot so that a copy from the source
+  // can be detected.
+  snapshot.SetUniform<float>(kColor, ShaderDataType_Float4, {kBlue, 1});
+  snapshot.SetUniform<float>(kOther, ShaderDataType_Float4, {kBlue, 1});
+
+  // Nothing changed in the source, so nothing is copied.
+  snapshot.UpdateSnapshot(source);
+  EXPECT_THAT(snapshot.GetUniformData(kColor)->GetData<float>()[2], Eq(1.0f));
+  EXPECT_THAT(snapshot.GetUniformData(kOther)->GetData<float>()[2], Eq(1.0f));
+
+  // Only the uniform set since the last update is copied.
+  source.SetUniform<float>(kColor, ShaderDataType_Float4, {kRed, 1});
+  snapshot.UpdateSnapshot(source);
+  EXPECT_THAT(snapshot.GetUniformData(kColor)->GetData<float>()[0], Eq(1.0f));
+  EXPECT_THAT(snapshot.GetUniformData(kOther)->GetData<float>()[2], Eq(1.0f));
+}
+
 }  // namespace
 }  // namespace lull
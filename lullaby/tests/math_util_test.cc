@@ -1868,6 +1868,62 @@ TEST(CheckSphereInFrustum, Outside) {
   EXPECT_FALSE(near_side);
 }
 
+TEST(CalculateCombinedViewFrustum, ContainsAllViews) {
+  const mathfu::mat4 clip_from_eye =
+      CalculatePerspectiveMatrixFromView(.5f * kPi, 1.0f, 1.0f, 10.0f);
+  mathfu::mat4 clip_from_world_matrices[2];
+  clip_from_world_matrices[0] =
+      clip_from_eye *
+      mathfu::mat4::FromTranslationVector(mathfu::vec3(.5f, 0, 0));
+  clip_from_world_matrices[1] =
+      clip_from_eye *
+      mathfu::mat4::FromTranslationVector(mathfu::vec3(-.5f, 0, 0));
+
+  mathfu::vec4 planes[kNumFrustumPlanes];
+  EXPECT_TRUE(
+      CalculateCombinedViewFrustum(clip_from_world_matrices, 2, planes));
+
+  mathfu::vec4 view_planes[2][kNumFrustumPlanes];
+  CalculateViewFrustum(clip_from_world_matrices[0], view_planes[0]);
+  CalculateViewFrustum(clip_from_world_matrices[1], view_planes[1]);
+  for (float x = -12.f; x <= 12.f; x += .5f) {
+    for (float z = -12.f; z <= 0.f; z += .5f) {
+      const mathfu::vec3 point(x, 1.f, z);
+      if (CheckSphereInFrustum(point, 0.f, view_planes[0]) ||
+          CheckSphereInFrustum(point, 0.f, view_planes[1])) {
+        EXPECT_TRUE(CheckSphereInFrustum(point, kEpsilon, planes))
+            << x << ", " << z;
+      }
+    }
+  }
+
+  // Only visible to the left eye.
+  EXPECT_TRUE(CheckSphereInFrustum(mathfu::vec3(-5.2f, 0, -5.f), .1f, planes));
+  // Only visible to the right eye.
+  EXPECT_TRUE(CheckSphereInFrustum(mathfu::vec3(5.2f, 0, -5.f), .1f, planes));
+  // Not visible to either eye.
+  EXPECT_FALSE(CheckSphereInFrustum(mathfu::vec3(-6.f, 0, -5.f), .3f, planes));
+  EXPECT_FALSE(CheckSphereInFrustum(mathfu::vec3(6.f, 0, -5.f), .3f, planes));
+  EXPECT_FALSE(CheckSphereInFrustum(mathfu::vec3(0, 0, -11.f), .5f, planes));
+  EXPECT_FALSE(CheckSphereInFrustum(mathfu::vec3(0, 0, -.5f), .3f, planes));
+}
+
+TEST(CalculateCombinedViewFrustum, SingleView) {
+  const mathfu::mat4 clip_from_world_matrix =
+      CalculatePerspectiveMatrixFromView(.5f * kPi, 1.0f, 1.0f, 10.0f);
+
+  mathfu::vec4 expected[kNumFrustumPlanes];
+  CalculateViewFrustum(clip_from_world_matrix, expected);
+  mathfu::vec4 planes[kNumFrustumPlanes];
+  EXPECT_TRUE(CalculateCombinedViewFrustum(&clip_from_world_matrix, 1, planes));
+  for (int i = 0; i < kNumFrustumPlanes; ++i) {
+    EXPECT_THAT(planes[i], NearMathfu(expected[i], kEpsilon));
+  }
+
+  EXPECT_FALSE(
+      CalculateCombinedViewFrustum(&clip_from_world_matrix, 0, planes));
+}
+
 TEST(FindPositionBetweenPoints, Edges) {
   const std::vector<float> points{-2, -1, 0, 1, 2};
   size_t min_index;
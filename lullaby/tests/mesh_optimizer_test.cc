@@ -0,0 +1,155 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/render/mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using Triangle = std::array<uint32_t, 3>;
+
+// Creates a triangle list for a grid of |size| x |size| quads, in a random
+// triangle order.
+std::vector<uint32_t> CreateShuffledGrid(uint32_t size,
+                                         std::vector<float>* positions) {
+  const uint32_t row = size + 1;
+  for (uint32_t y = 0; y <= size; ++y) {
+    for (uint32_t x = 0; x <= size; ++x) {
+      positions->push_back(static_cast<float>(x));
+      positions->push_back(static_cast<float>(y));
+      positions->push_back(0.0f);
+    }
+  }
+
+  std::vector<Triangle> triangles;
+  for (uint32_t y = 0; y < size; ++y) {
+    for (uint32_t x = 0; x < size; ++x) {
+      const uint32_t i = y * row + x;
+      triangles.push_back({{i, i + 1, i + row}});
+      triangles.push_back({{i + 1, i + row + 1, i + row}});
+    }
+  }
+  std::mt19937 random(1234);
+  std::shuffle(triangles.begin(), triangles.end(), random);
+
+  std::vector<uint32_t> indices;
+  for (const Triangle& triangle : triangles) {
+    indices.insert(indices.end(), triangle.begin(), triangle.end());
+  }
+  return indices;
+}
+
+// Returns the triangles in |indices|, each rotated so that its smallest index
+// is first (which preserves the winding), in sorted order.
+std::vector<Triangle> GetSortedTriangles(const std::vector<uint32_t>& indices) {
+  std::vector<Triangle> triangles;
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    Triangle triangle = {{indices[i], indices[i + 1], indices[i + 2]}};
+    std::rotate(triangle.begin(),
+                std::min_element(triangle.begin(), triangle.end()),
+                triangle.end());
+    triangles.push_back(triangle);
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+TEST(MeshOptimizer, CalculateAcmr) {
+  // Two separate triangles transform every vertex.
+  const uint32_t separate[] = {0, 1, 2, 3, 4, 5};
+  EXPECT_FLOAT_EQ(3.0f, CalculateAcmr(separate, 6));
+
+  // A quad shares two vertices between its triangles.
+  const uint32_t quad[] = {0, 1, 2, 2, 1, 3};
+  EXPECT_FLOAT_EQ(2.0f, CalculateAcmr(quad, 6));
+
+  // Repeating the quad with a one entry cache misses every vertex again.
+  const uint32_t repeated[] = {0, 1, 2, 0, 1, 2};
+  EXPECT_FLOAT_EQ(1.5f, CalculateAcmr(repeated, 6));
+  EXPECT_FLOAT_EQ(3.0f, CalculateAcmr(repeated, 6, 1));
+
+  EXPECT_FLOAT_EQ(0.0f, CalculateAcmr(nullptr, 0));
+}
+
+TEST(MeshOptimizer, OptimizeVertexCacheKeepsTriangles) {
+  std::vector<float> positions;
+  std::vector<uint32_t> indices = CreateShuffledGrid(16, &positions);
+  const std::vector<Triangle> expected = GetSortedTriangles(indices);
+  const size_t num_vertices = positions.size() / 3;
+
+  const float before = CalculateAcmr(indices.data(), indices.size());
+  OptimizeVertexCache(indices.data(), indices.size(), num_vertices);
+  const float after = CalculateAcmr(indices.data(), indices.size());
+
+  EXPECT_EQ(expected, GetSortedTriangles(indices));
+  EXPECT_LT(after, before);
+  // A regular grid should get close to its ideal ratio of 0.5.
+  EXPECT_LT(after, 0.8f);
+}
+
+TEST(MeshOptimizer, OptimizeOverdrawKeepsTrianglesAndLocality) {
+  std::vector<float> positions;
+  std::vector<uint32_t> indices = CreateShuffledGrid(16, &positions);
+  const size_t num_vertices = positions.size() / 3;
+  OptimizeVertexCache(indices.data(), indices.size(), num_vertices);
+  const std::vector<Triangle> expected = GetSortedTriangles(indices);
+  const float before = CalculateAcmr(indices.data(), indices.size());
+
+  const float kThreshold = 1.05f;
+  OptimizeOverdraw(indices.data(), indices.size(),
+                   reinterpret_cast<const uint8_t*>(positions.data()),
+                   3 * sizeof(float), num_vertices, kThreshold);
+  const float after = CalculateAcmr(indices.data(), indices.size());
+
+  EXPECT_EQ(expected, GetSortedTriangles(indices));
+  // Clusters are reordered as a whole, so the ratio can only get worse by the
+  // cost of restarting the cache at each cluster.
+  EXPECT_LT(after, before * 1.5f);
+}
+
+TEST(MeshOptimizer, OptimizeOverdrawDrawsOutwardFacingClustersFirst) {
+  // Two disconnected triangles on opposite sides of the origin, one facing
+  // towards it and one facing away.
+  const float positions[] = {
+      -1, -1, -1, 1, -1, -1, 0, 1, -1,  // z = -1, facing +z (inwards)
+      -1, -1, 1,  1, -1, 1,  0, 1, 1,   // z = 1, facing +z (outwards)
+  };
+  std::vector<uint32_t> indices = {0, 1, 2, 3, 4, 5};
+  OptimizeOverdraw(indices.data(), indices.size(),
+                   reinterpret_cast<const uint8_t*>(positions),
+                   3 * sizeof(float), 6);
+  EXPECT_EQ(std::vector<uint32_t>({3, 4, 5, 0, 1, 2}), indices);
+}
+
+TEST(MeshOptimizer, OptimizeVertexFetch) {
+  std::vector<uint32_t> indices = {4, 2, 0, 0, 2, 3};
+  const std::vector<uint32_t> remap =
+      OptimizeVertexFetch(indices.data(), indices.size(), 5);
+
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 2, 2, 1, 3}), indices);
+  // Vertex 1 is unused, so it moves to the end.
+  EXPECT_EQ(std::vector<uint32_t>({2, 4, 1, 3, 0}), remap);
+}
+
+}  // namespace
+}  // namespace lull
@@ -15,7 +15,13 @@ limitations under the License.
 */
 
 #include "lullaby/modules/render/mesh_util.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
 #include "gtest/gtest.h"
+#include "lullaby/modules/render/mesh_optimizer.h"
 #include "lullaby/modules/render/vertex.h"
 #include "lullaby/tests/mathfu_matchers.h"
 #include "lullaby/tests/portable_test_macros.h"
@@ -408,6 +414,65 @@ TEST(ApplyDeformationDeathTest, FailsWithInsufficientAccess) {
   PORT_EXPECT_DEBUG_DEATH(ApplyDeformation(&unwriteable_mesh, deform), "");
 }
 
+// Returns the positions of the triangles of |mesh|, each rotated so that the
+// smallest position is first (which preserves the winding), in sorted order.
+std::vector<std::array<float, 9>> GetSortedTrianglePositions(
+    const MeshData& mesh) {
+  const VertexPT* vertices = mesh.GetVertexData<VertexPT>();
+  const uint32_t* indices = mesh.GetIndexData<uint32_t>();
+  std::vector<std::array<float, 9>> triangles;
+  for (size_t i = 0; i < mesh.GetNumIndices(); i += 3) {
+    std::array<std::array<float, 3>, 3> triangle;
+    for (size_t j = 0; j < 3; ++j) {
+      const VertexPT& v = vertices[indices[i + j]];
+      triangle[j] = {{v.x, v.y, v.z}};
+    }
+    std::rotate(triangle.begin(),
+                std::min_element(triangle.begin(), triangle.end()),
+                triangle.end());
+    std::array<float, 9> flat;
+    for (size_t j = 0; j < 9; ++j) {
+      flat[j] = triangle[j / 3][j % 3];
+    }
+    triangles.push_back(flat);
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+TEST(OptimizeMesh, KeepsTrianglesAndImprovesVertexCache) {
+  MeshData mesh = CreateLatLonSphere(1.0f, 16, 32);
+  const uint32_t num_vertices = mesh.GetNumVertices();
+  const size_t num_indices = mesh.GetNumIndices();
+  const auto expected = GetSortedTrianglePositions(mesh);
+  const float before =
+      CalculateAcmr(mesh.GetIndexData<uint32_t>(), num_indices);
+
+  EXPECT_TRUE(OptimizeMesh(&mesh));
+
+  EXPECT_EQ(mesh.GetNumVertices(), num_vertices);
+  EXPECT_EQ(mesh.GetNumIndices(), num_indices);
+  EXPECT_EQ(GetSortedTrianglePositions(mesh), expected);
+  EXPECT_LT(CalculateAcmr(mesh.GetIndexData<uint32_t>(), num_indices), before);
+
+  // The vertices should be in the order of their first use.
+  const uint32_t* indices = mesh.GetIndexData<uint32_t>();
+  uint32_t next_vertex = 0;
+  for (size_t i = 0; i < num_indices; ++i) {
+    EXPECT_LE(indices[i], next_vertex);
+    if (indices[i] == next_vertex) {
+      ++next_vertex;
+    }
+  }
+}
+
+TEST(OptimizeMesh, IgnoresNonTriangleMeshes) {
+  MeshData mesh(MeshData::kPoints, VertexPT::kFormat,
+                DataContainer::CreateHeapDataContainer(sizeof(VertexPT)));
+  mesh.AddVertex<VertexPT>(1.0f, 2.0f, 3.0f, 0.1f, 0.2f);
+  EXPECT_FALSE(OptimizeMesh(&mesh));
+}
+
 TEST(CreateLatLonSphereDeathTest, CatchesBadArguments) {
   const float radius = 1.0f;
   PORT_EXPECT_DEATH(CreateLatLonSphere(radius, /* num_parallels = */ 0,
@@ -160,6 +160,44 @@ TEST(MutableCameraTest, PopulateRenderView) {
   EXPECT_EQ(view.eye_from_world_matrix, world_from_camera.Inverse());
   EXPECT_EQ(view.clip_from_eye_matrix, clip_from_camera);
   EXPECT_EQ(view.clip_from_world_matrix, clip_from_world);
+  EXPECT_TRUE(view.has_frustum_planes);
+}
+
+TEST(MutableCameraTest, FrameData) {
+  MutableCamera camera(nullptr);
+  camera.SetupDisplay(kNearClip, kFarClip, kFov, kViewport);
+
+  const mathfu::vec3 sensor_pos(0.0f, 0.0f, 1.0f);
+  camera.SetSensorPose(sensor_pos, mathfu::kQuatIdentityf);
+
+  const CameraFrameData& data = camera.FrameData();
+  EXPECT_EQ(&camera.ClipFromWorld(), &data.clip_from_world);
+  EXPECT_EQ(&camera.WorldFromClip(), &data.world_from_clip);
+  EXPECT_THAT(data.world_from_camera.TranslationVector3D(),
+              NearMathfuVec3(sensor_pos, kEpsilon));
+
+  mathfu::vec4 planes[kNumFrustumPlanes];
+  CalculateViewFrustum(data.clip_from_world, planes);
+  for (int i = 0; i < kNumFrustumPlanes; ++i) {
+    EXPECT_EQ(planes[i], camera.FrustumPlanes()[i]);
+  }
+
+  // Changing the pose updates the frame data the next time it is requested.
+  const mathfu::vec3 new_sensor_pos(1.0f, 2.0f, 3.0f);
+  camera.SetSensorPose(new_sensor_pos, mathfu::kQuatIdentityf);
+  EXPECT_THAT(camera.WorldPosition(), NearMathfuVec3(new_sensor_pos, kEpsilon));
+  CalculateViewFrustum(camera.ClipFromWorld(), planes);
+  for (int i = 0; i < kNumFrustumPlanes; ++i) {
+    EXPECT_EQ(planes[i], camera.FrustumPlanes()[i]);
+  }
+
+  RenderView view;
+  camera.PopulateRenderView(&view);
+  mathfu::vec4 view_planes[kNumFrustumPlanes];
+  GetViewFrustum(view, view_planes);
+  for (int i = 0; i < kNumFrustumPlanes; ++i) {
+    EXPECT_EQ(planes[i], view_planes[i]);
+  }
 }
 
 TEST(MutableCameraTest, WorldRayFromClipPoint) {
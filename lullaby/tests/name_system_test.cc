@@ -27,6 +27,7 @@ namespace lull {
 namespace {
 
 using ::testing::Eq;
+using ::testing::UnorderedElementsAre;
 
 class NameSystemTest : public ::testing::Test {
  protected:
@@ -193,5 +194,66 @@ TEST_F(NameSystemTest, FindDescendantWithDuplicateNames) {
               Eq(kChildEntity2));
 }
 
+TEST_F(NameSystemTest, FindDescendantAfterReparent) {
+  const Entity kRootEntity1 = 1;
+  const Entity kRootEntity2 = 2;
+  const Entity kChildEntity = 3;
+  Sqt sqt;
+  registry_.Create<Dispatcher>();
+  auto* transform_system = registry_.Create<TransformSystem>(&registry_);
+  transform_system->Create(kRootEntity1, sqt);
+  transform_system->Create(kRootEntity2, sqt);
+  transform_system->Create(kChildEntity, sqt);
+  transform_system->AddChild(kRootEntity1, kChildEntity);
+  NameSystem* name_system = registry_.Create<NameSystem>(&registry_);
+  name_system->SetName(kChildEntity, "child");
+
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity1, "child"),
+              Eq(kChildEntity));
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity2, "child"),
+              Eq(kNullEntity));
+
+  // Cached results must not survive a change to the hierarchy.
+  transform_system->AddChild(kRootEntity2, kChildEntity);
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity1, "child"),
+              Eq(kNullEntity));
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity2, "child"),
+              Eq(kChildEntity));
+
+  // Or to the names.
+  name_system->SetName(kChildEntity, "renamed");
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity2, "child"),
+              Eq(kNullEntity));
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity2, "renamed"),
+              Eq(kChildEntity));
+}
+
+TEST_F(NameSystemTest, SearchEntitiesByName) {
+  const Entity kEntity1 = 1;
+  const Entity kEntity2 = 2;
+  const Entity kEntity3 = 3;
+  NameSystem* name_system = registry_.Create<NameSystem>(&registry_);
+  name_system->SetName(kEntity1, "left_button");
+  name_system->SetName(kEntity2, "right_button");
+  name_system->SetName(kEntity3, "button_button_label");
+
+  EXPECT_THAT(name_system->SearchEntitiesByName("button"),
+              UnorderedElementsAre(kEntity1, kEntity2, kEntity3));
+  EXPECT_THAT(name_system->SearchEntitiesByName("t_b"),
+              UnorderedElementsAre(kEntity1, kEntity2));
+  EXPECT_THAT(name_system->SearchEntitiesByName("label"),
+              UnorderedElementsAre(kEntity3));
+  EXPECT_TRUE(name_system->SearchEntitiesByName("missing").empty());
+  EXPECT_THAT(name_system->SearchEntitiesByName(""),
+              UnorderedElementsAre(kEntity1, kEntity2, kEntity3));
+
+  // The index is rebuilt after names change.
+  name_system->SetName(kEntity2, "right_label");
+  name_system->Destroy(kEntity3);
+  std::vector<Entity> results;
+  name_system->SearchEntitiesByName("label", &results);
+  EXPECT_THAT(results, UnorderedElementsAre(kEntity2));
+}
+
 }  // namespace
 }  // namespace lull
@@ -16,9 +16,14 @@ limitations under the License.
 
 #include "lullaby/systems/nine_patch/nine_patch_system.h"
 
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/render/mesh_factory.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/render/testing/mock_render_system_impl.h"
 #include "lullaby/systems/transform/transform_system.h"
@@ -30,9 +35,40 @@ limitations under the License.
 namespace lull {
 namespace {
 
+using ::testing::_;
+using ::testing::A;
+using ::testing::Invoke;
 using testing::NearMathfuVec3;
 static const float kEpsilon = 0.001f;
 
+// Hands out empty meshes and counts how many were created.
+class FakeMeshFactory : public MeshFactory {
+ public:
+  void CacheMesh(HashValue name, const MeshPtr& mesh) override {}
+  MeshPtr GetMesh(HashValue name) const override { return nullptr; }
+  void ReleaseMesh(HashValue name) override {}
+  MeshPtr CreateMesh(MeshData mesh_data) override { return NewMesh(); }
+  MeshPtr CreateMesh(MeshData* mesh_datas, size_t len) override {
+    return NewMesh();
+  }
+  MeshPtr CreateMesh(HashValue name, MeshData mesh_data) override {
+    return NewMesh();
+  }
+  MeshPtr CreateMesh(HashValue name, MeshData* mesh_datas,
+                     size_t len) override {
+    return NewMesh();
+  }
+  MeshPtr EmptyMesh() override { return std::make_shared<Mesh>(); }
+
+  int num_created = 0;
+
+ private:
+  MeshPtr NewMesh() {
+    ++num_created;
+    return std::make_shared<Mesh>();
+  }
+};
+
 class NinePatchSystemTest : public ::testing::Test {
  public:
   void SetUp() override {
@@ -89,5 +125,45 @@ TEST_F(NinePatchSystemTest, Aabb) {
   EXPECT_THAT(aabb->max, NearMathfuVec3(half_dims, kEpsilon));
 }
 
+TEST_F(NinePatchSystemTest, SharesMeshesBetweenEqualNinePatches) {
+  auto* mesh_factory = new FakeMeshFactory();
+  registry_->Register(std::unique_ptr<MeshFactory>(mesh_factory));
+
+  // The render system mock does not hold on to meshes, so keep them alive here
+  // the way a real render system would.
+  std::vector<MeshPtr> meshes;
+  EXPECT_CALL(*render_system_, SetMesh(_, _, A<MeshPtr>()))
+      .WillRepeatedly(Invoke([&](Entity e, HashValue pass, MeshPtr mesh) {
+        meshes.push_back(mesh);
+      }));
+
+  auto create = [this]() {
+    Blueprint blueprint;
+    TransformDefT transform;
+    blueprint.Write(&transform);
+    NinePatchDefT nine_patch;
+    nine_patch.size = mathfu::vec2(2.0f, 1.0f);
+    blueprint.Write(&nine_patch);
+    return entity_factory_->Create(&blueprint);
+  };
+
+  create();
+  const Entity entity = create();
+  EXPECT_EQ(mesh_factory->num_created, 1);
+  ASSERT_EQ(meshes.size(), 2u);
+  EXPECT_EQ(meshes[0], meshes[1]);
+
+  nine_patch_system_->SetSize(entity, mathfu::vec2(3.0f, 1.0f));
+  EXPECT_EQ(mesh_factory->num_created, 2);
+  ASSERT_EQ(meshes.size(), 3u);
+  EXPECT_NE(meshes[2], meshes[0]);
+
+  // Going back to the original size reuses the first mesh.
+  nine_patch_system_->SetSize(entity, mathfu::vec2(2.0f, 1.0f));
+  EXPECT_EQ(mesh_factory->num_created, 2);
+  ASSERT_EQ(meshes.size(), 4u);
+  EXPECT_EQ(meshes[3], meshes[0]);
+}
+
 }  // namespace
 }  // namespace lull
@@ -0,0 +1,115 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/file/pack_file.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "lullaby/tools/compile_pack_file/pack_file_builder.h"
+
+namespace lull {
+namespace {
+
+std::unique_ptr<PackFile> OpenPack(const tool::PackFileBuilder& builder) {
+  return PackFile::Open(MappedFile::FromString(builder.Build()));
+}
+
+TEST(PackFile, Empty) {
+  tool::PackFileBuilder builder;
+  auto pack = OpenPack(builder);
+  ASSERT_NE(nullptr, pack);
+  EXPECT_EQ(0u, pack->GetNumEntries());
+  EXPECT_FALSE(pack->Contains("file.txt"));
+
+  std::string data;
+  EXPECT_FALSE(pack->Load("file.txt", &data));
+}
+
+TEST(PackFile, Load) {
+  const std::string repetitive(10000, 'a');
+  tool::PackFileBuilder builder;
+  EXPECT_TRUE(builder.AddEntry("a.txt", "hello world", false));
+  EXPECT_TRUE(builder.AddEntry("dir/b.txt", repetitive, true));
+  EXPECT_TRUE(builder.AddEntry("empty.txt", "", true));
+  EXPECT_FALSE(builder.AddEntry("a.txt", "duplicate", false));
+
+  auto pack = OpenPack(builder);
+  ASSERT_NE(nullptr, pack);
+  EXPECT_EQ(3u, pack->GetNumEntries());
+
+  std::string data;
+  EXPECT_TRUE(pack->Load("a.txt", &data));
+  EXPECT_EQ("hello world", data);
+  EXPECT_TRUE(pack->Load("dir/b.txt", &data));
+  EXPECT_EQ(repetitive, data);
+  EXPECT_TRUE(pack->Load("empty.txt", &data));
+  EXPECT_EQ("", data);
+  EXPECT_FALSE(pack->Load("b.txt", &data));
+  EXPECT_FALSE(pack->Contains("dir"));
+}
+
+TEST(PackFile, UncompressedContents) {
+  tool::PackFileBuilder builder;
+  builder.AddEntry("raw.txt", "raw", false);
+  builder.AddEntry("compressed.txt", std::string(1000, 'b'), true);
+  const MappedFilePtr file = MappedFile::FromString(builder.Build());
+  auto pack = PackFile::Open(file);
+  ASSERT_NE(nullptr, pack);
+
+  // Uncompressed entries are aligned views into the file.
+  const string_view raw = pack->GetUncompressedContents("raw.txt");
+  EXPECT_EQ("raw", raw.to_string());
+  EXPECT_EQ(0u, (raw.data() - reinterpret_cast<const char*>(file->GetData())) %
+                    kPackFileAlignment);
+
+  EXPECT_TRUE(pack->GetUncompressedContents("compressed.txt").empty());
+  EXPECT_TRUE(pack->GetUncompressedContents("missing.txt").empty());
+}
+
+TEST(PackFile, ManyEntries) {
+  tool::PackFileBuilder builder;
+  for (int i = 0; i < 100; ++i) {
+    const std::string name = "file" + std::to_string(i);
+    builder.AddEntry(name, name + " contents", i % 2 == 0);
+  }
+  auto pack = OpenPack(builder);
+  ASSERT_NE(nullptr, pack);
+  for (int i = 0; i < 100; ++i) {
+    const std::string name = "file" + std::to_string(i);
+    std::string data;
+    EXPECT_TRUE(pack->Load(name, &data));
+    EXPECT_EQ(name + " contents", data);
+  }
+}
+
+TEST(PackFile, Invalid) {
+  EXPECT_EQ(nullptr, PackFile::Open(nullptr));
+  EXPECT_EQ(nullptr, PackFile::Open(MappedFile::FromString("LPAK")));
+  EXPECT_EQ(nullptr, PackFile::Open(MappedFile::FromString(
+                         "not a pack file, just some text")));
+
+  tool::PackFileBuilder builder;
+  builder.AddEntry("a.txt", "hello world", false);
+  std::string data = builder.Build();
+
+  // Truncating the contents of an entry makes the pack invalid.
+  data.resize(data.size() - 1);
+  EXPECT_EQ(nullptr, PackFile::Open(MappedFile::FromString(data)));
+}
+
+}  // namespace
+}  // namespace lull
@@ -30,6 +30,7 @@ namespace lull {
 namespace {
 
 using ::testing::Eq;
+using ::testing::Lt;
 using ::testing::Ne;
 using testing::NearMathfuVec3;
 using testing::NearMathfuQuat;
@@ -545,5 +546,111 @@ TEST_F(PhysicsSystemTest, MultipleTimesteps) {
   EXPECT_THAT(sqt->translation, NearMathfuVec3(next_position, kDefaultEpsilon));
 }
 
+// Test that a Kinematic body moved through the TransformSystem is pushed to the
+// simulation on the next frame.
+TEST_F(PhysicsSystemTest, KinematicSqtChange) {
+  auto* physics_system = registry_->Get<PhysicsSystem>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+
+  // Create a Static Trigger box at the origin.
+  const Entity origin = CreateBasicRigidBody(
+      mathfu::kZeros3f, RigidBodyType::RigidBodyType_Static,
+      ColliderType::ColliderType_Trigger);
+  EXPECT_THAT(origin, Ne(kNullEntity));
+
+  // Create a Kinematic Trigger box far enough away to not be in contact.
+  const Entity kinematic = CreateBasicRigidBody(
+      mathfu::vec3(0.f, 5.f, 0.f), RigidBodyType::RigidBodyType_Kinematic,
+      ColliderType::ColliderType_Trigger);
+  EXPECT_THAT(kinematic, Ne(kNullEntity));
+
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_FALSE(physics_system->AreInContact(origin, kinematic));
+
+  // Move it onto the origin with a whole Sqt and confirm contact.
+  Sqt sqt = *transform_system->GetSqt(kinematic);
+  sqt.translation = mathfu::kZeros3f;
+  transform_system->SetSqt(kinematic, sqt);
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_TRUE(physics_system->AreInContact(origin, kinematic));
+
+  // Move it back and confirm the contact ends.
+  sqt.translation = mathfu::vec3(0.f, 5.f, 0.f);
+  transform_system->SetSqt(kinematic, sqt);
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_FALSE(physics_system->AreInContact(origin, kinematic));
+}
+
+// Test that a Dynamic body's own transform write-back is not pushed back into
+// the simulation. Pushing it would wake the body every frame, so check that a
+// resting body is allowed to fall asleep instead. Bullet only applies a new
+// world gravity to awake bodies.
+TEST_F(PhysicsSystemTest, DynamicBodyWriteBackNotPushed) {
+  auto* physics_system = registry_->Get<PhysicsSystem>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+
+  // Disable gravity.
+  physics_system->SetGravity(mathfu::kZeros3f);
+
+  // Create a Dynamic box at the origin.
+  const Entity entity = CreateBasicRigidBody(
+      mathfu::kZeros3f, RigidBodyType::RigidBodyType_Dynamic);
+  EXPECT_THAT(entity, Ne(kNullEntity));
+
+  // Rest for longer than Bullet's deactivation time.
+  for (int i = 0; i < 240; ++i) {
+    physics_system->AdvanceFrame(kFrameDuration);
+  }
+  const mathfu::vec3 resting = transform_system->GetSqt(entity)->translation;
+
+  // A sleeping body ignores the new gravity and stays put.
+  physics_system->SetGravity(mathfu::vec3(0.f, -10.f, 0.f));
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_THAT(transform_system->GetSqt(entity)->translation,
+              NearMathfuVec3(resting, kDefaultEpsilon));
+
+  // An explicit move still wakes the body, which then falls.
+  transform_system->SetLocalTranslation(entity, mathfu::vec3(0.f, 1.f, 0.f));
+  physics_system->AdvanceFrame(kFrameDuration);
+  physics_system->SetGravity(mathfu::vec3(0.f, -10.f, 0.f));
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_THAT(transform_system->GetSqt(entity)->translation.y, Lt(1.f));
+}
+
+// Test that a body moved while its Entity is disabled is resynced when the
+// Entity is enabled again.
+TEST_F(PhysicsSystemTest, MovedWhileDisabled) {
+  auto* physics_system = registry_->Get<PhysicsSystem>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+
+  // Create a Static Trigger box at the origin.
+  const Entity origin = CreateBasicRigidBody(
+      mathfu::kZeros3f, RigidBodyType::RigidBodyType_Static,
+      ColliderType::ColliderType_Trigger);
+  EXPECT_THAT(origin, Ne(kNullEntity));
+
+  // Create a Kinematic Trigger box out of contact.
+  const Entity kinematic = CreateBasicRigidBody(
+      mathfu::vec3(0.f, 5.f, 0.f), RigidBodyType::RigidBodyType_Kinematic,
+      ColliderType::ColliderType_Trigger);
+  EXPECT_THAT(kinematic, Ne(kNullEntity));
+
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_FALSE(physics_system->AreInContact(origin, kinematic));
+
+  // Disable it, move it into contact, and let a frame pass while disabled.
+  transform_system->Disable(kinematic);
+  Sqt sqt = *transform_system->GetSqt(kinematic);
+  sqt.translation = mathfu::kZeros3f;
+  transform_system->SetSqt(kinematic, sqt);
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_FALSE(physics_system->AreInContact(origin, kinematic));
+
+  // Enabling it pushes the new transform to the simulation.
+  transform_system->Enable(kinematic);
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_TRUE(physics_system->AreInContact(origin, kinematic));
+}
+
 }  // namespace
 }  // namespace lull
@@ -170,5 +170,86 @@ TEST_F(ProfilerTest, Times) {
             GetSampleDurationInSeconds(profile_data->samples[0]));
 }
 
+void SleepForMilliseconds(int amount) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(amount));
+}
+
+TEST_F(ProfilerTest, SampleStats) {
+  ProfilerSampleStats stats;
+  EXPECT_FALSE(GetProfilerSampleStats("test_scope_stats", &stats));
+
+  // Make one call out of every ten much slower than the others.
+  for (int i = 0; i < 20; ++i) {
+    LULL_PROFILE(test_scope_stats);
+    SleepForMilliseconds(i % 10 == 9 ? 50 : 1);
+  }
+
+  EXPECT_TRUE(GetProfilerSampleStats("test_scope_stats", &stats));
+  EXPECT_EQ("test_scope_stats", stats.name);
+  EXPECT_EQ(size_t(20), stats.num_calls);
+  EXPECT_LT(stats.p50_ms, 25.0);
+  EXPECT_GE(stats.p95_ms, 50.0);
+  EXPECT_GE(stats.p99_ms, stats.p95_ms);
+  EXPECT_GE(stats.max_ms, stats.p99_ms);
+  EXPECT_GT(stats.mean_ms, stats.p50_ms);
+
+  uint32_t total = 0;
+  for (const uint32_t count : stats.histogram) {
+    total += count;
+  }
+  EXPECT_EQ(uint32_t(20), total);
+  // The slow calls last between 2^15 and 2^16 microseconds (but may take a
+  // little longer on a heavily loaded machine).
+  EXPECT_LE(uint32_t(2), stats.histogram[16] + stats.histogram[17]);
+}
+
+TEST_F(ProfilerTest, SampleStatsWindow) {
+  for (size_t i = 0; i < kProfilerHistorySize + 10; ++i) {
+    LULL_PROFILE(test_scope_window);
+  }
+
+  ProfilerSampleStats stats;
+  EXPECT_TRUE(GetProfilerSampleStats("test_scope_window", &stats));
+  EXPECT_EQ(kProfilerHistorySize, stats.num_calls);
+}
+
+TEST_F(ProfilerTest, AllThreadStats) {
+  {
+    LULL_PROFILE(test_scope_main);
+  }
+  std::thread thread([]() {
+    {
+      LULL_PROFILE(test_scope_worker);
+    }
+    {
+      LULL_PROFILE(test_scope_worker_two);
+    }
+
+    bool found_main = false;
+    bool found_worker = false;
+    for (const ProfilerThreadStats& thread_stats : GetAllProfilerStats()) {
+      for (const ProfilerSampleStats& stats : thread_stats.samples) {
+        if (stats.name == "test_scope_main") {
+          found_main = true;
+          EXPECT_EQ(size_t(1), stats.num_calls);
+        } else if (stats.name == "test_scope_worker") {
+          found_worker = true;
+          EXPECT_EQ(size_t(1), stats.num_calls);
+        }
+      }
+    }
+    EXPECT_TRUE(found_main);
+    EXPECT_TRUE(found_worker);
+    CleanupProfiler();
+  });
+  thread.join();
+
+  for (const ProfilerThreadStats& thread_stats : GetAllProfilerStats()) {
+    for (const ProfilerSampleStats& stats : thread_stats.samples) {
+      EXPECT_NE("test_scope_worker", stats.name);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace lull
@@ -0,0 +1,174 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/transform/progressive_loader.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/blueprint_tree.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/generated/transform_def_generated.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsNull;
+using ::testing::NotNull;
+using ::testing::SizeIs;
+
+class ProgressiveLoaderTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    registry_.Create<Dispatcher>();
+    auto* entity_factory = registry_.Create<EntityFactory>(&registry_);
+    transform_system_ = entity_factory->CreateSystem<TransformSystem>();
+    entity_factory->Initialize();
+    loader_ = registry_.Create<ProgressiveLoader>(&registry_);
+  }
+
+  // Writes a TransformDef at |position| into |blueprint|.
+  static void WriteTransform(BlueprintTree* blueprint,
+                             const mathfu::vec3& position) {
+    TransformDefT transform;
+    transform.position = position;
+    blueprint->Write(&transform);
+  }
+
+  // Returns a blueprint of a root with two children, at -x and +x, each with
+  // one child of their own.
+  static BlueprintTree MakeScene() {
+    BlueprintTree root;
+    WriteTransform(&root, mathfu::kZeros3f);
+    BlueprintTree* left = root.NewChild();
+    WriteTransform(left, mathfu::vec3(-10.f, 0.f, 0.f));
+    WriteTransform(left->NewChild(), mathfu::kZeros3f);
+    BlueprintTree* right = root.NewChild();
+    WriteTransform(right, mathfu::vec3(10.f, 0.f, 0.f));
+    WriteTransform(right->NewChild(), mathfu::kZeros3f);
+    return root;
+  }
+
+ protected:
+  Registry registry_;
+  TransformSystem* transform_system_ = nullptr;
+  ProgressiveLoader* loader_ = nullptr;
+};
+
+TEST_F(ProgressiveLoaderTest, CreatesRootImmediately) {
+  const Entity root = loader_->Load(MakeScene());
+  EXPECT_NE(root, kNullEntity);
+  EXPECT_THAT(transform_system_->GetWorldFromEntityMatrix(root), NotNull());
+  EXPECT_THAT(transform_system_->GetChildren(root), IsNull());
+  EXPECT_EQ(loader_->GetNumQueued(), 2u);
+  EXPECT_TRUE(loader_->IsLoading(root));
+}
+
+TEST_F(ProgressiveLoaderTest, CreatesBreadthFirst) {
+  const Entity root = loader_->Load(MakeScene());
+
+  EXPECT_TRUE(loader_->CreateNext());
+  EXPECT_TRUE(loader_->CreateNext());
+  const std::vector<Entity>* children = transform_system_->GetChildren(root);
+  ASSERT_THAT(children, NotNull());
+  ASSERT_THAT(*children, SizeIs(2));
+  // Both children are created before any grandchildren.
+  EXPECT_THAT(transform_system_->GetChildren((*children)[0]), IsNull());
+  EXPECT_THAT(transform_system_->GetChildren((*children)[1]), IsNull());
+  EXPECT_EQ(loader_->GetNumQueued(), 2u);
+
+  EXPECT_TRUE(loader_->CreateNext());
+  EXPECT_TRUE(loader_->CreateNext());
+  EXPECT_FALSE(loader_->CreateNext());
+  EXPECT_THAT(transform_system_->GetChildren((*children)[0]), NotNull());
+  EXPECT_THAT(transform_system_->GetChildren((*children)[1]), NotNull());
+  EXPECT_EQ(loader_->GetNumQueued(), 0u);
+  EXPECT_FALSE(loader_->IsLoading(root));
+}
+
+TEST_F(ProgressiveLoaderTest, PrioritizesNearestSubtree) {
+  const Entity root = loader_->Load(MakeScene());
+  EXPECT_TRUE(loader_->CreateNext());
+  EXPECT_TRUE(loader_->CreateNext());
+  const std::vector<Entity> children = *transform_system_->GetChildren(root);
+  const Entity left = children[0];
+  const Entity right = children[1];
+
+  loader_->SetFocus(mathfu::vec3(10.f, 0.f, 0.f));
+  EXPECT_TRUE(loader_->CreateNext());
+  EXPECT_THAT(transform_system_->GetChildren(right), NotNull());
+  EXPECT_THAT(transform_system_->GetChildren(left), IsNull());
+}
+
+TEST_F(ProgressiveLoaderTest, SendsCompleteEventPerSubtree) {
+  std::vector<ProgressiveLoadCompleteEvent> events;
+  auto connection = registry_.Get<Dispatcher>()->Connect(
+      [&](const ProgressiveLoadCompleteEvent& event) {
+        events.push_back(event);
+      });
+
+  const Entity root = loader_->Load(MakeScene());
+  while (loader_->CreateNext()) {
+  }
+
+  const std::vector<Entity>& children = *transform_system_->GetChildren(root);
+  ASSERT_THAT(events, SizeIs(3));
+  EXPECT_EQ(events[0].entity, children[0]);
+  EXPECT_EQ(events[1].entity, children[1]);
+  EXPECT_EQ(events[2].entity, root);
+  for (const ProgressiveLoadCompleteEvent& event : events) {
+    EXPECT_EQ(event.root, root);
+  }
+}
+
+TEST_F(ProgressiveLoaderTest, Cancel) {
+  std::vector<Entity> completed;
+  auto connection = registry_.Get<Dispatcher>()->Connect(
+      [&](const ProgressiveLoadCompleteEvent& event) {
+        completed.push_back(event.entity);
+      });
+
+  const Entity root = loader_->Load(MakeScene());
+  EXPECT_TRUE(loader_->CreateNext());
+  loader_->Cancel(root);
+  EXPECT_FALSE(loader_->IsLoading(root));
+  EXPECT_EQ(loader_->GetNumQueued(), 0u);
+  EXPECT_FALSE(loader_->CreateNext());
+  EXPECT_THAT(*transform_system_->GetChildren(root), SizeIs(1));
+  EXPECT_THAT(completed, ElementsAre());
+}
+
+TEST_F(ProgressiveLoaderTest, LoadsLeaf) {
+  std::vector<Entity> completed;
+  auto connection = registry_.Get<Dispatcher>()->Connect(
+      [&](const ProgressiveLoadCompleteEvent& event) {
+        completed.push_back(event.entity);
+      });
+
+  BlueprintTree blueprint;
+  WriteTransform(&blueprint, mathfu::kZeros3f);
+  const Entity root = loader_->Load(std::move(blueprint));
+  EXPECT_FALSE(loader_->IsLoading(root));
+  EXPECT_FALSE(loader_->CreateNext());
+  EXPECT_THAT(completed, ElementsAre(root));
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,130 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lullaby/util/bounded_mpmc_queue.h"
+#include "lullaby/util/bounded_mpsc_queue.h"
+#include "lullaby/util/bounded_spsc_queue.h"
+#include "lullaby/util/thread_safe_queue.h"
+
+// Compares the mutex-guarded ThreadSafeQueue against the lock-free bounded
+// queues.  Each benchmark iteration passes kNumValues values from the producer
+// threads to the consumer threads, with state.range(0) producers and
+// state.range(1) consumers.
+
+namespace lull {
+namespace {
+
+static const int kNumValues = 1 << 16;
+static const size_t kCapacity = 1024;
+
+// Adapts BoundedMpscQueue, which only provides TryEnqueue, to the interface
+// used by the other queues.
+template <typename T>
+class MpscAdapter : public BoundedMpscQueue<T> {
+ public:
+  explicit MpscAdapter(size_t capacity) : BoundedMpscQueue<T>(capacity) {}
+
+  void Enqueue(T obj) {
+    while (!this->TryEnqueue(&obj)) {
+      std::this_thread::yield();
+    }
+  }
+};
+
+template <typename Queue>
+static Queue* CreateQueue() {
+  return new Queue(kCapacity);
+}
+
+template <>
+ThreadSafeQueue<int>* CreateQueue<ThreadSafeQueue<int>>() {
+  return new ThreadSafeQueue<int>();
+}
+
+template <typename Queue>
+static void RunContention(benchmark::State& state) {
+  const int num_producers = static_cast<int>(state.range(0));
+  const int num_consumers = static_cast<int>(state.range(1));
+  std::unique_ptr<Queue> queue(CreateQueue<Queue>());
+
+  for (auto _ : state) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_producers; ++i) {
+      const int count = kNumValues / num_producers +
+                        (i < kNumValues % num_producers ? 1 : 0);
+      threads.emplace_back([&queue, count]() {
+        for (int j = 0; j < count; ++j) {
+          queue->Enqueue(j);
+        }
+      });
+    }
+    for (int i = 0; i < num_consumers; ++i) {
+      const int count = kNumValues / num_consumers +
+                        (i < kNumValues % num_consumers ? 1 : 0);
+      threads.emplace_back([&queue, count]() {
+        int64_t sum = 0;
+        for (int j = 0; j < count; ++j) {
+          int value = 0;
+          while (!queue->Dequeue(&value)) {
+            std::this_thread::yield();
+          }
+          sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumValues);
+}
+
+static void BM_ThreadSafeQueue(benchmark::State& state) {
+  RunContention<ThreadSafeQueue<int>>(state);
+}
+BENCHMARK(BM_ThreadSafeQueue)
+    ->Args({1, 1})
+    ->Args({4, 1})
+    ->Args({4, 4})
+    ->UseRealTime();
+
+static void BM_BoundedSpscQueue(benchmark::State& state) {
+  RunContention<BoundedSpscQueue<int>>(state);
+}
+BENCHMARK(BM_BoundedSpscQueue)->Args({1, 1})->UseRealTime();
+
+static void BM_BoundedMpscQueue(benchmark::State& state) {
+  RunContention<MpscAdapter<int>>(state);
+}
+BENCHMARK(BM_BoundedMpscQueue)->Args({1, 1})->Args({4, 1})->UseRealTime();
+
+static void BM_BoundedMpmcQueue(benchmark::State& state) {
+  RunContention<BoundedMpmcQueue<int>>(state);
+}
+BENCHMARK(BM_BoundedMpmcQueue)
+    ->Args({1, 1})
+    ->Args({4, 1})
+    ->Args({4, 4})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace lull
@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #include "lullaby/modules/dispatcher/queued_dispatcher.h"
+#include <atomic>
 #include <string>
 #include <thread>
 #include <vector>
@@ -181,6 +182,100 @@ TEST(QueuedDispatcher, Unregister) {
   EXPECT_EQ(e.value, h.static_value);
 }
 
+TEST(QueuedDispatcher, RingBuffer) {
+  QueuedDispatcher d(/* capacity = */ 4);
+  QueuedEventHandlerClass h;
+  auto c = d.Connect([&](const QueuedEvent& event) { h.HandleEvent(event); });
+
+  EXPECT_TRUE(d.Empty());
+  d.Send(QueuedEvent(1, "hello"));
+  d.Send(QueuedEvent(2, "world"));
+  EXPECT_FALSE(d.Empty());
+  EXPECT_EQ(0, h.accumulator);
+
+  d.Dispatch();
+  EXPECT_TRUE(d.Empty());
+  EXPECT_EQ(3, h.accumulator);
+  EXPECT_EQ(2, h.value);
+  EXPECT_EQ("world", h.text);
+}
+
+TEST(QueuedDispatcher, RingBufferOverflowOnDispatchThread) {
+  QueuedDispatcher d(/* capacity = */ 2);
+  std::vector<int> values;
+  auto c = d.Connect([&](const QueuedEvent& event) {
+    values.push_back(event.value);
+    // Sending from a handler while the ring buffer is full should not block.
+    if (event.value < 10) {
+      d.Send(QueuedEvent(event.value + 10));
+      d.Send(QueuedEvent(event.value + 20));
+    }
+  });
+
+  for (int i = 1; i <= 4; ++i) {
+    d.Send(QueuedEvent(i));
+  }
+  d.Dispatch();
+  EXPECT_TRUE(d.Empty());
+  EXPECT_EQ(static_cast<size_t>(0), d.GetNumDiscardedEvents());
+
+  // Events sent from the same thread are dispatched in order.
+  EXPECT_EQ(static_cast<size_t>(12), values.size());
+  const std::vector<int> expected = {1, 2, 3, 4, 11, 21, 12, 22,
+                                     13, 23, 14, 24};
+  EXPECT_EQ(expected, values);
+}
+
+TEST(QueuedDispatcher, RingBufferDiscardWhenFull) {
+  QueuedDispatcher d(/* capacity = */ 2, /* wait_when_full = */ false);
+  QueuedEventHandlerClass h;
+  auto c = d.Connect([&](const QueuedEvent& event) { h.HandleEvent(event); });
+
+  std::thread producer([&d]() {
+    for (int i = 0; i < 4; ++i) {
+      d.Send(QueuedEvent(1));
+    }
+  });
+  producer.join();
+
+  EXPECT_EQ(static_cast<size_t>(2), d.GetNumDiscardedEvents());
+  d.Dispatch();
+  EXPECT_EQ(2, h.accumulator);
+}
+
+TEST(QueuedDispatcher, RingBufferMultiProducer) {
+  static const int kNumProducers = 8;
+  static const int kNumEvents = 500;
+  QueuedDispatcher d(/* capacity = */ 16);
+  QueuedEventHandlerClass h;
+  auto c = d.Connect([&](const QueuedEvent& event) { h.HandleEvent(event); });
+
+  std::atomic<int> num_finished(0);
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kNumProducers; ++i) {
+    producers.emplace_back([&]() {
+      for (int j = 0; j < kNumEvents; ++j) {
+        d.Send(QueuedEvent(1));
+      }
+      ++num_finished;
+    });
+  }
+
+  // The producers wait for room in the ring buffer while this thread drains it.
+  while (num_finished < kNumProducers) {
+    d.Dispatch();
+    std::this_thread::yield();
+  }
+  d.Dispatch();
+
+  for (auto& thread : producers) {
+    thread.join();
+  }
+  EXPECT_EQ(kNumProducers * kNumEvents, h.accumulator);
+  EXPECT_EQ(static_cast<size_t>(0), d.GetNumDiscardedEvents());
+  EXPECT_TRUE(d.Empty());
+}
+
 TEST(QueuedDispatcher, EventWrapper) {
   static const TypeId kTestTypeId = 123;
 
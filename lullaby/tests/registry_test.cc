@@ -30,6 +30,15 @@ struct ClassTwo {
   int value;
 };
 
+// Checks that it can still be found in the registry while being destroyed.
+struct ClassThree {
+  explicit ClassThree(Registry* registry, bool* found)
+      : registry(registry), found(found) {}
+  ~ClassThree() { *found = registry->Get<ClassThree>() == this; }
+  Registry* registry;
+  bool* found;
+};
+
 TEST(Registry, Empty) {
   Registry r;
   EXPECT_EQ(nullptr, r.Get<ClassOne>());
@@ -71,8 +80,35 @@ TEST(Registry, ConstGet) {
   EXPECT_EQ(c1, const_r->Get<ClassOne>());
 }
 
+TEST(Registry, MultipleRegistries) {
+  Registry r1;
+  Registry r2;
+  auto c1 = r1.Create<ClassOne>();
+  auto c2 = r2.Create<ClassOne>();
+  EXPECT_NE(c1, c2);
+  EXPECT_EQ(c1, r1.Get<ClassOne>());
+  EXPECT_EQ(c2, r2.Get<ClassOne>());
+
+  {
+    Registry r3;
+    r3.Create<ClassTwo>();
+  }
+  EXPECT_EQ(nullptr, r1.Get<ClassTwo>());
+  EXPECT_EQ(nullptr, r2.Get<ClassTwo>());
+}
+
+TEST(Registry, GetDuringDestruction) {
+  bool found = false;
+  {
+    Registry r;
+    r.Create<ClassThree>(&r, &found);
+  }
+  EXPECT_TRUE(found);
+}
+
 }  // namespace
 }  // namespace lull
 
 LULLABY_SETUP_TYPEID(ClassOne);
 LULLABY_SETUP_TYPEID(ClassTwo);
+LULLABY_SETUP_TYPEID(ClassThree);
@@ -0,0 +1,123 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/render_occlusion.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::IsEmpty;
+
+// A view looking down -z from the origin, with a wall centered in front of it.
+class RenderOcclusionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    occlusion_ = registry_.Create<RenderOcclusion>(&registry_);
+    clip_from_world_ =
+        mathfu::mat4::Perspective(0.5f * kPi, 1.f, 0.1f, 100.f);
+
+    occlusion_->BeginFrame();
+    EXPECT_TRUE(occlusion_->BeginViews(&clip_from_world_, 1));
+    occlusion_->AddOccluder(kWall, mathfu::mat4::Identity());
+    occlusion_->EndViews();
+  }
+
+  const Aabb kWall = Aabb(mathfu::vec3(-2.f, -2.f, -5.5f),
+                          mathfu::vec3(2.f, 2.f, -5.f));
+
+  Registry registry_;
+  RenderOcclusion* occlusion_ = nullptr;
+  mathfu::mat4 clip_from_world_;
+};
+
+TEST_F(RenderOcclusionTest, Occluders) {
+  const Entity entity(1);
+  EXPECT_FALSE(occlusion_->IsOccluder(entity));
+  occlusion_->SetOccluder(entity, true);
+  EXPECT_TRUE(occlusion_->IsOccluder(entity));
+  occlusion_->SetOccluder(entity, false);
+  EXPECT_FALSE(occlusion_->IsOccluder(entity));
+  EXPECT_THAT(occlusion_->GetOccluders(), IsEmpty());
+}
+
+TEST_F(RenderOcclusionTest, BoxBehindWallIsOccluded) {
+  const Aabb box(mathfu::vec3(-0.5f, -0.5f, -0.5f),
+                 mathfu::vec3(0.5f, 0.5f, 0.5f));
+  EXPECT_TRUE(occlusion_->IsOccluded(
+      box, mathfu::mat4::FromTranslationVector(mathfu::vec3(0, 0, -20.f))));
+}
+
+TEST_F(RenderOcclusionTest, BoxInFrontOfWallIsVisible) {
+  const Aabb box(mathfu::vec3(-0.5f, -0.5f, -0.5f),
+                 mathfu::vec3(0.5f, 0.5f, 0.5f));
+  EXPECT_FALSE(occlusion_->IsOccluded(
+      box, mathfu::mat4::FromTranslationVector(mathfu::vec3(0, 0, -2.f))));
+}
+
+TEST_F(RenderOcclusionTest, BoxBesideWallIsVisible) {
+  const Aabb box(mathfu::vec3(-0.5f, -0.5f, -0.5f),
+                 mathfu::vec3(0.5f, 0.5f, 0.5f));
+  EXPECT_FALSE(occlusion_->IsOccluded(
+      box, mathfu::mat4::FromTranslationVector(mathfu::vec3(10.f, 0, -20.f))));
+}
+
+TEST_F(RenderOcclusionTest, BoxPartiallyBehindWallIsVisible) {
+  const Aabb box(mathfu::vec3(-10.f, -0.5f, -0.5f),
+                 mathfu::vec3(10.f, 0.5f, 0.5f));
+  EXPECT_FALSE(occlusion_->IsOccluded(
+      box, mathfu::mat4::FromTranslationVector(mathfu::vec3(0, 0, -20.f))));
+}
+
+TEST_F(RenderOcclusionTest, BoxCrossingNearPlaneIsVisible) {
+  const Aabb box(mathfu::vec3(-0.5f, -0.5f, -0.5f),
+                 mathfu::vec3(0.5f, 0.5f, 0.5f));
+  EXPECT_FALSE(occlusion_->IsOccluded(box, mathfu::mat4::Identity()));
+}
+
+TEST_F(RenderOcclusionTest, ReusesViewsWithinFrame) {
+  EXPECT_FALSE(occlusion_->BeginViews(&clip_from_world_, 1));
+
+  const mathfu::mat4 other =
+      clip_from_world_ *
+      mathfu::mat4::FromTranslationVector(mathfu::vec3(1.f, 0, 0));
+  EXPECT_TRUE(occlusion_->BeginViews(&other, 1));
+
+  occlusion_->EndFrame();
+  occlusion_->BeginFrame();
+  EXPECT_TRUE(occlusion_->BeginViews(&other, 1));
+}
+
+TEST_F(RenderOcclusionTest, Stats) {
+  const Aabb box(mathfu::vec3(-0.5f, -0.5f, -0.5f),
+                 mathfu::vec3(0.5f, 0.5f, 0.5f));
+  occlusion_->IsOccluded(
+      box, mathfu::mat4::FromTranslationVector(mathfu::vec3(0, 0, -20.f)));
+  occlusion_->IsOccluded(
+      box, mathfu::mat4::FromTranslationVector(mathfu::vec3(0, 0, -2.f)));
+
+  // Stats are only published at the end of the frame.
+  EXPECT_THAT(occlusion_->GetNumTested(), Eq(0));
+  occlusion_->EndFrame();
+  EXPECT_THAT(occlusion_->GetNumTested(), Eq(2));
+  EXPECT_THAT(occlusion_->GetNumOccluded(), Eq(1));
+}
+
+}  // namespace
+}  // namespace lull
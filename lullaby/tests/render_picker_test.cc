@@ -0,0 +1,159 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/render_picker.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/testing/mock_render_system_impl.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+using ::testing::_;
+using ::testing::ByMove;
+using ::testing::Invoke;
+using ::testing::Return;
+
+constexpr int kSize = 4;
+
+class RenderPickerTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    registry_.reset(new Registry());
+
+    registry_->Register(std::unique_ptr<Dispatcher>(new Dispatcher()));
+    entity_factory_ = registry_->Create<EntityFactory>(registry_.get());
+    transform_system_ = entity_factory_->CreateSystem<TransformSystem>();
+    render_system_ = entity_factory_->CreateSystem<RenderSystem>()->GetImpl();
+    entity_factory_->Initialize();
+
+    picker_ =
+        registry_->Create<RenderPicker>(registry_.get(), "picking", kSize);
+  }
+
+ protected:
+  // Returns a pick pass image of the kSize * kSize |entities|.
+  static ImageData MakeImage(const Entity* entities) {
+    const size_t size = kSize * kSize * 4;
+    DataContainer data = DataContainer::CreateHeapDataContainer(size);
+    uint8_t* pixels = data.GetAppendPtr(size);
+    for (int i = 0; i < kSize * kSize; ++i) {
+      WritePixel(pixels + i * 4, entities[i]);
+    }
+    return ImageData(ImageData::kRgba8888, mathfu::vec2i(kSize, kSize),
+                     std::move(data));
+  }
+
+  // Writes the color encoding |entity| as the GPU would.
+  static void WritePixel(uint8_t* pixel, Entity entity) {
+    const mathfu::vec4 color = RenderPicker::EncodeEntity(entity);
+    for (int i = 0; i < 4; ++i) {
+      pixel[i] = static_cast<uint8_t>(std::round(color[i] * 255.f));
+    }
+  }
+
+  std::unique_ptr<Registry> registry_;
+  EntityFactory* entity_factory_ = nullptr;
+  TransformSystem* transform_system_ = nullptr;
+  MockRenderSystemImpl* render_system_ = nullptr;
+  RenderPicker* picker_ = nullptr;
+};
+
+TEST_F(RenderPickerTest, EncodesEntities) {
+  const Entity entities[] = {Entity(1), Entity(0x12345678), Entity(0xffffffff)};
+  for (Entity entity : entities) {
+    uint8_t pixel[4];
+    WritePixel(pixel, entity);
+    EXPECT_EQ(RenderPicker::DecodeEntity(pixel), entity);
+  }
+}
+
+TEST_F(RenderPickerTest, PicksAfterReadback) {
+  const Entity entity = entity_factory_->Create();
+  transform_system_->Create(entity, Sqt());
+  transform_system_->SetAabb(entity, Aabb(mathfu::vec3(-1.f, -1.f, -1.f),
+                                          mathfu::vec3(1.f, 1.f, 1.f)));
+  picker_->AddPickable(entity);
+  picker_->SetRay(Ray(mathfu::vec3(0.f, 0.f, 5.f), -mathfu::kAxisZ3f));
+
+  Entity entities[kSize * kSize] = {kNullEntity};
+  entities[2 * kSize + 1] = entity;
+  EXPECT_CALL(*render_system_, ReadRenderTargetDataAsync(_, _)).Times(2);
+  EXPECT_CALL(*render_system_, TakeRenderTargetData(_))
+      .WillOnce(Return(ByMove(ImageData())))
+      .WillOnce(Return(ByMove(MakeImage(entities))));
+  picker_->Render();
+  EXPECT_FALSE(picker_->GetResult().valid);
+  EXPECT_EQ(picker_->GetResult().entity, kNullEntity);
+
+  // The GPU has not finished yet.
+  picker_->Render();
+  EXPECT_FALSE(picker_->GetResult().valid);
+  EXPECT_EQ(picker_->GetResult().entity, kNullEntity);
+
+  picker_->Render();
+  const RenderPicker::Result result = picker_->GetResult();
+  EXPECT_TRUE(result.valid);
+  EXPECT_EQ(result.entity, entity);
+  EXPECT_NEAR(result.distance, 4.f, 1e-4f);
+
+  // A removed Entity is a miss.
+  picker_->RemovePickable(entity);
+  EXPECT_TRUE(picker_->GetResult().valid);
+  EXPECT_EQ(picker_->GetResult().entity, kNullEntity);
+
+  picker_->ClearRay();
+  EXPECT_FALSE(picker_->GetResult().valid);
+}
+
+TEST_F(RenderPickerTest, InvalidWithoutReadback) {
+  picker_->SetRay(Ray());
+
+  // The backend never returns the pixels.
+  EXPECT_CALL(*render_system_, TakeRenderTargetData(_))
+      .WillRepeatedly(Invoke([](HashValue) { return ImageData(); }));
+  for (int i = 0; i < 10; ++i) {
+    picker_->Render();
+    EXPECT_FALSE(picker_->GetResult().valid);
+  }
+}
+
+TEST_F(RenderPickerTest, PrefersCenter) {
+  const Entity center = entity_factory_->Create();
+  const Entity corner = entity_factory_->Create();
+  picker_->AddPickable(center);
+  picker_->AddPickable(corner);
+  picker_->SetRay(Ray());
+
+  Entity entities[kSize * kSize] = {kNullEntity};
+  entities[0] = corner;
+  entities[2 * kSize + 2] = center;
+  EXPECT_CALL(*render_system_, TakeRenderTargetData(_))
+      .WillOnce(Return(ByMove(MakeImage(entities))));
+  picker_->Render();
+  picker_->Render();
+  EXPECT_EQ(picker_->GetResult().entity, center);
+}
+
+}  // namespace
+}  // namespace lull
@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "lullaby/systems/render/detail/profiler.h"
@@ -80,5 +81,80 @@ TEST(RenderProfilerTest, Stats) {
   EXPECT_EQ(profiler.GetNumTris(), 134 + 3 + 73);
 }
 
+TEST(RenderProfilerTest, BindStats) {
+  detail::Profiler profiler;
+
+  // Skip first frame since it can't be complete.
+  profiler.BeginFrame();
+  profiler.EndFrame();
+
+  const int material1 = 0;
+  const int material2 = 0;
+  const int mesh1 = 0;
+  const int mesh2 = 0;
+
+  // Binds and state changes outside of a frame are ignored.
+  profiler.RecordBinds(&material1, &mesh1);
+  profiler.RecordRenderStateChanges(5);
+
+  profiler.BeginFrame();
+  profiler.RecordBinds(&material1, &mesh1);
+  profiler.RecordRenderStateChanges(3);
+  profiler.RecordBinds(&material1, &mesh2);
+  profiler.RecordBinds(&material2, &mesh2);
+  profiler.RecordRenderStateChanges(1);
+  profiler.RecordBinds(&material2, &mesh2);
+  profiler.EndFrame();
+
+  EXPECT_EQ(profiler.GetNumMaterialSwaps(), 2);
+  EXPECT_EQ(profiler.GetNumMeshSwaps(), 2);
+  EXPECT_EQ(profiler.GetNumRenderStateChanges(), 4);
+}
+
+TEST(RenderProfilerTest, PassStats) {
+  detail::Profiler profiler;
+
+  // Skip first frame since it can't be complete.
+  profiler.BeginFrame();
+  profiler.EndFrame();
+
+  ShaderPtr shader(new Shader);
+
+  profiler.BeginFrame();
+  profiler.BeginPass(ConstHash("Opaque"));
+  profiler.RecordDraw(shader, 100, 134);
+  profiler.RecordDraw(shader, 37, 3);
+  profiler.EndPass();
+  // Draws outside of a pass only count towards the frame.
+  profiler.RecordDraw(shader, 5, 5);
+  profiler.BeginPass(ConstHash("Main"));
+  profiler.RecordDraw(shader, 40, 73);
+  profiler.EndPass();
+  profiler.EndFrame();
+
+  EXPECT_EQ(profiler.GetNumDraws(), 4);
+
+  const std::vector<detail::Profiler::PassStats>& passes =
+      profiler.GetPassStats();
+  ASSERT_EQ(passes.size(), static_cast<size_t>(2));
+  EXPECT_EQ(passes[0].pass, ConstHash("Opaque"));
+  EXPECT_EQ(passes[0].num_draws, 2);
+  EXPECT_EQ(passes[0].num_verts, 100 + 37);
+  EXPECT_EQ(passes[0].num_tris, 134 + 3);
+  EXPECT_EQ(passes[1].pass, ConstHash("Main"));
+  EXPECT_EQ(passes[1].num_draws, 1);
+  EXPECT_EQ(passes[1].num_verts, 40);
+  EXPECT_EQ(passes[1].num_tris, 73);
+
+  // The next frame's passes replace the previous ones.
+  profiler.BeginFrame();
+  profiler.BeginPass(ConstHash("Main"));
+  profiler.EndPass();
+  profiler.EndFrame();
+
+  ASSERT_EQ(profiler.GetPassStats().size(), static_cast<size_t>(1));
+  EXPECT_EQ(profiler.GetPassStats()[0].num_draws, 0);
+}
+
 }  // namespace
 }  // namespace lull
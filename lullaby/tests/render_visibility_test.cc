@@ -0,0 +1,100 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/render_visibility.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/events/render_events.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(RenderVisibility, EnterAndExit) {
+  Registry registry;
+  auto* dispatcher = registry.Create<Dispatcher>();
+  auto* visibility = registry.Create<RenderVisibility>(&registry);
+
+  std::vector<Entity> entered;
+  std::vector<Entity> exited;
+  dispatcher->Connect(this, [&](const EnteredViewEvent& e) {
+    entered.push_back(e.entity);
+  });
+  dispatcher->Connect(this, [&](const ExitedViewEvent& e) {
+    exited.push_back(e.entity);
+  });
+
+  visibility->BeginFrame();
+  visibility->MarkVisible(Entity(3));
+  visibility->MarkVisible(Entity(200));
+  // Entities drawn in several passes are only reported once.
+  visibility->MarkVisible(Entity(3));
+  // Nothing is published until the frame ends.
+  EXPECT_FALSE(visibility->IsVisible(Entity(3)));
+  visibility->EndFrame();
+
+  EXPECT_TRUE(visibility->IsVisible(Entity(3)));
+  EXPECT_TRUE(visibility->IsVisible(Entity(200)));
+  EXPECT_FALSE(visibility->IsVisible(Entity(4)));
+  EXPECT_FALSE(visibility->IsVisible(Entity(100000)));
+  EXPECT_THAT(visibility->GetEnteredEntities(),
+              ElementsAre(Entity(3), Entity(200)));
+  EXPECT_THAT(visibility->GetExitedEntities(), IsEmpty());
+  EXPECT_THAT(entered, ElementsAre(Entity(3), Entity(200)));
+  EXPECT_THAT(exited, IsEmpty());
+
+  entered.clear();
+  visibility->BeginFrame();
+  visibility->MarkVisible(Entity(200));
+  visibility->MarkVisible(Entity(5));
+  visibility->EndFrame();
+
+  EXPECT_FALSE(visibility->IsVisible(Entity(3)));
+  EXPECT_TRUE(visibility->IsVisible(Entity(5)));
+  EXPECT_TRUE(visibility->IsVisible(Entity(200)));
+  EXPECT_THAT(entered, ElementsAre(Entity(5)));
+  EXPECT_THAT(exited, ElementsAre(Entity(3)));
+
+  // A frame with nothing drawn exits everything.
+  entered.clear();
+  exited.clear();
+  visibility->BeginFrame();
+  visibility->EndFrame();
+  EXPECT_THAT(entered, IsEmpty());
+  EXPECT_THAT(exited, ElementsAre(Entity(5), Entity(200)));
+
+  dispatcher->DisconnectAll(this);
+}
+
+TEST(RenderVisibility, IgnoresMarksOutsideFrame) {
+  Registry registry;
+  auto* visibility = registry.Create<RenderVisibility>(&registry);
+
+  visibility->MarkVisible(Entity(1));
+  visibility->BeginFrame();
+  visibility->EndFrame();
+  EXPECT_FALSE(visibility->IsVisible(Entity(1)));
+  EXPECT_THAT(visibility->GetEnteredEntities(), IsEmpty());
+}
+
+}  // namespace
+}  // namespace lull
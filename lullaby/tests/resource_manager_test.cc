@@ -163,6 +163,33 @@ TEST(ResourceManagerTest, RecreateAlive) {
   EXPECT_EQ(res, res2);
 }
 
+TEST(ResourceManagerTest, ReleaseAll) {
+  ResourceManager<TestResource> manager;
+  manager.Create(123, []() {
+    return std::shared_ptr<TestResource>(new TestResource(456));
+  });
+  manager.Create(456, []() {
+    return std::shared_ptr<TestResource>(new TestResource(789));
+  });
+  auto res = manager.Find(123);
+
+  manager.ReleaseAll();
+
+  // Objects that are still referenced are reused, the others are freed.
+  EXPECT_EQ(res, manager.Find(123));
+  EXPECT_EQ(nullptr, manager.Find(456));
+
+  auto res2 = manager.Create(123, []() {
+    return std::shared_ptr<TestResource>(new TestResource(0));
+  });
+  EXPECT_EQ(res, res2);
+
+  // The object was reacquired by Create(), so it remains cached.
+  res.reset();
+  res2.reset();
+  EXPECT_NE(nullptr, manager.Find(123));
+}
+
 TEST(ResourceManagerTest, ExplicitCache) {
   ResourceManager<TestResource> manager(
       ResourceManager<TestResource>::kCacheExplicitly);
@@ -242,5 +269,109 @@ TEST(ResourceManagerTest, TrackNewInstances) {
   }
 }
 
+size_t GetTestResourceSize(const TestResource& res) {
+  return static_cast<size_t>(res.value);
+}
+
+std::shared_ptr<TestResource> CreateTestResource(int value) {
+  return std::shared_ptr<TestResource>(new TestResource(value));
+}
+
+TEST(ResourceManagerTest, BudgetEvictsLeastRecentlyUsed) {
+  ResourceManager<TestResource> manager;
+  manager.SetSizeFn(GetTestResourceSize);
+  manager.SetBudget(10);
+
+  manager.Create(1, []() { return CreateTestResource(4); });
+  manager.Create(2, []() { return CreateTestResource(4); });
+  EXPECT_NE(nullptr, manager.Find(1));
+
+  // Exceeding the budget evicts the object that was used least recently.
+  manager.Create(3, []() { return CreateTestResource(4); });
+  EXPECT_NE(nullptr, manager.Find(1));
+  EXPECT_EQ(nullptr, manager.Find(2));
+  EXPECT_NE(nullptr, manager.Find(3));
+
+  const auto stats = manager.GetStats();
+  EXPECT_EQ(2u, stats.num_objects);
+  EXPECT_EQ(8u, stats.resident_bytes);
+  EXPECT_EQ(8u, stats.unreferenced_bytes);
+  EXPECT_EQ(10u, stats.budget_bytes);
+  EXPECT_EQ(1u, stats.num_evicted);
+}
+
+TEST(ResourceManagerTest, BudgetKeepsReferencedObjects) {
+  ResourceManager<TestResource> manager;
+  manager.SetSizeFn(GetTestResourceSize);
+  manager.SetBudget(10);
+
+  auto res1 = manager.Create(1, []() { return CreateTestResource(6); });
+  auto res2 = manager.Create(2, []() { return CreateTestResource(6); });
+  EXPECT_EQ(res1, manager.Find(1));
+  EXPECT_EQ(res2, manager.Find(2));
+
+  auto stats = manager.GetStats();
+  EXPECT_EQ(12u, stats.resident_bytes);
+  EXPECT_EQ(0u, stats.unreferenced_bytes);
+  EXPECT_EQ(0u, stats.num_evicted);
+
+  // Once unreferenced, the object can be evicted.
+  res1.reset();
+  manager.EnforceBudget();
+  EXPECT_EQ(nullptr, manager.Find(1));
+  EXPECT_EQ(res2, manager.Find(2));
+
+  stats = manager.GetStats();
+  EXPECT_EQ(1u, stats.num_objects);
+  EXPECT_EQ(6u, stats.resident_bytes);
+  EXPECT_EQ(1u, stats.num_evicted);
+}
+
+TEST(ResourceManagerTest, UpdateSize) {
+  ResourceManager<TestResource> manager;
+  manager.SetSizeFn(GetTestResourceSize);
+
+  auto res = manager.Create(1, []() { return CreateTestResource(4); });
+  EXPECT_EQ(4u, manager.GetStats().resident_bytes);
+
+  res->value = 20;
+  manager.UpdateSize(1);
+  EXPECT_EQ(20u, manager.GetStats().resident_bytes);
+
+  // Without a budget, nothing is evicted.
+  res.reset();
+  manager.EnforceBudget();
+  EXPECT_NE(nullptr, manager.Find(1));
+  EXPECT_EQ(20u, manager.GetStats().unreferenced_bytes);
+}
+
+TEST(ResourceManagerTest, BudgetEvictionAllowsReentrantDestructors) {
+  ResourceManager<TestResource> manager;
+  manager.SetSizeFn(GetTestResourceSize);
+  manager.SetBudget(10);
+
+  // The deleter uses the cache, as a resource releasing its own dependencies
+  // would, so it must only run once the eviction has been recorded.
+  size_t num_deleted = 0;
+  ResourceManager<TestResource>::Stats stats_in_deleter;
+  std::shared_ptr<TestResource> found_in_deleter;
+  manager.Create(1, [&]() {
+    return std::shared_ptr<TestResource>(
+        new TestResource(6), [&](TestResource* res) {
+          ++num_deleted;
+          stats_in_deleter = manager.GetStats();
+          found_in_deleter = manager.Find(2);
+          delete res;
+        });
+  });
+  manager.Create(2, []() { return CreateTestResource(6); });
+
+  EXPECT_EQ(1u, num_deleted);
+  EXPECT_EQ(1u, stats_in_deleter.num_objects);
+  EXPECT_EQ(1u, stats_in_deleter.num_evicted);
+  EXPECT_EQ(manager.Find(2), found_in_deleter);
+  EXPECT_EQ(nullptr, manager.Find(1));
+}
+
 }  // namespace
 }  // namespace lull
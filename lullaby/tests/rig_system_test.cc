@@ -0,0 +1,212 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/rig/rig_system.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/animation/animation_system.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/testing/mock_render_system_impl.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/tests/mathfu_matchers.h"
+
+namespace lull {
+namespace {
+
+using testing::NearMathfu;
+
+constexpr float kEpsilon = 1e-5f;
+
+using PoseVector = std::vector<mathfu::AffineTransform,
+                               RigSystem::AffineMatrixAllocator>;
+
+mathfu::AffineTransform Translation(const mathfu::vec3& translation) {
+  return mathfu::mat4::ToAffineTransform(
+      mathfu::mat4::FromTranslationVector(translation));
+}
+
+mathfu::vec3 GetTranslation(const mathfu::AffineTransform& transform) {
+  return mathfu::mat4::FromAffineTransform(transform).TranslationVector3D();
+}
+
+class RigSystemTest : public ::testing::Test {
+ public:
+  RigSystemTest() {
+    entity_factory_ = registry_.Create<EntityFactory>(&registry_);
+    transform_system_ = entity_factory_->CreateSystem<TransformSystem>();
+    entity_factory_->CreateSystem<AnimationSystem>();
+    entity_factory_->CreateSystem<RenderSystem>();
+    rig_system_ = entity_factory_->CreateSystem<RigSystem>();
+    entity_factory_->Initialize();
+  }
+
+ protected:
+  Entity CreateEntity(const mathfu::vec3& position) {
+    const Entity entity = entity_factory_->Create();
+    Sqt sqt;
+    sqt.translation = position;
+    transform_system_->Create(entity, sqt);
+    return entity;
+  }
+
+  // Creates a two bone skeleton: a root at the origin and a child bone one
+  // unit above it.
+  RigSystem::SkeletonPtr CreateSkeleton() {
+    const uint8_t parents[] = {kInvalidBoneIdx, 0};
+    const uint8_t shader_indices[] = {0, 1};
+    const PoseVector inverse_bind_pose = {
+        Translation(mathfu::kZeros3f),
+        Translation(mathfu::vec3(0.0f, -1.0f, 0.0f)),
+    };
+    return RigSystem::CreateSkeleton(parents, inverse_bind_pose,
+                                     shader_indices, {"root", "child"});
+  }
+
+  mathfu::vec3 GetWorldPosition(Entity entity) const {
+    return transform_system_->GetWorldFromEntityMatrix(entity)
+        ->TranslationVector3D();
+  }
+
+  Registry registry_;
+  EntityFactory* entity_factory_ = nullptr;
+  TransformSystem* transform_system_ = nullptr;
+  RigSystem* rig_system_ = nullptr;
+};
+
+TEST_F(RigSystemTest, CreateSkeletonRejectsMismatchedBones) {
+  const uint8_t parents[] = {kInvalidBoneIdx, 0};
+  const uint8_t shader_indices[] = {0};
+  const PoseVector inverse_bind_pose = {Translation(mathfu::kZeros3f)};
+  EXPECT_EQ(RigSystem::CreateSkeleton(parents, inverse_bind_pose,
+                                      shader_indices),
+            nullptr);
+  EXPECT_EQ(RigSystem::CreateSkeleton({}, {}, {}), nullptr);
+}
+
+TEST_F(RigSystemTest, SharedSkeletonKeepsPerEntityPoses) {
+  const RigSystem::SkeletonPtr skeleton = CreateSkeleton();
+  ASSERT_NE(skeleton, nullptr);
+
+  const Entity first = CreateEntity(mathfu::kZeros3f);
+  const Entity second = CreateEntity(mathfu::kZeros3f);
+  rig_system_->SetRig(first, skeleton);
+  rig_system_->SetRig(second, skeleton);
+
+  // Both entities reference the same skeleton data.
+  EXPECT_EQ(rig_system_->GetNumBones(first), 2u);
+  EXPECT_EQ(rig_system_->GetBoneParentIndices(first).data(),
+            rig_system_->GetBoneParentIndices(second).data());
+  EXPECT_EQ(rig_system_->GetDefaultBoneTransformInverses(first).data(),
+            rig_system_->GetDefaultBoneTransformInverses(second).data());
+  EXPECT_EQ(rig_system_->GetBoneNames(second)[1], "child");
+
+  // Each pose starts out as the bind pose.
+  const RigSystem::Pose bind_pose = rig_system_->GetPose(second);
+  ASSERT_EQ(bind_pose.size(), 2u);
+  EXPECT_THAT(GetTranslation(bind_pose[1]),
+              NearMathfu(mathfu::vec3(0.0f, 1.0f, 0.0f), kEpsilon));
+
+  // Posing one entity leaves the other alone.
+  const PoseVector pose = {
+      Translation(mathfu::kZeros3f),
+      Translation(mathfu::vec3(0.0f, 3.0f, 0.0f)),
+  };
+  rig_system_->SetPose(first, pose);
+  EXPECT_THAT(GetTranslation(rig_system_->GetPose(first)[1]),
+              NearMathfu(mathfu::vec3(0.0f, 3.0f, 0.0f), kEpsilon));
+  EXPECT_THAT(GetTranslation(rig_system_->GetPose(second)[1]),
+              NearMathfu(mathfu::vec3(0.0f, 1.0f, 0.0f), kEpsilon));
+}
+
+TEST_F(RigSystemTest, AttachmentFollowsPosedBone) {
+  const Entity rig = CreateEntity(mathfu::vec3(10.0f, 0.0f, 0.0f));
+  const Entity attachment = CreateEntity(mathfu::kZeros3f);
+  rig_system_->SetRig(rig, CreateSkeleton());
+
+  Sqt bone_from_attachment;
+  bone_from_attachment.translation = mathfu::vec3(0.0f, 0.0f, 1.0f);
+  rig_system_->AttachToBone(attachment, rig, 1, bone_from_attachment);
+  rig_system_->UpdateBoneAttachments();
+  EXPECT_THAT(GetWorldPosition(attachment),
+              NearMathfu(mathfu::vec3(10.0f, 1.0f, 1.0f), kEpsilon));
+
+  // Posing the rig only moves the attachment once the attachments are
+  // updated.
+  const PoseVector pose = {
+      Translation(mathfu::kZeros3f),
+      Translation(mathfu::vec3(0.0f, 3.0f, 0.0f)),
+  };
+  rig_system_->SetPose(rig, pose);
+  EXPECT_THAT(GetWorldPosition(attachment),
+              NearMathfu(mathfu::vec3(10.0f, 1.0f, 1.0f), kEpsilon));
+  rig_system_->UpdateBoneAttachments();
+  EXPECT_THAT(GetWorldPosition(attachment),
+              NearMathfu(mathfu::vec3(10.0f, 3.0f, 1.0f), kEpsilon));
+}
+
+TEST_F(RigSystemTest, AttachmentFollowsMovingRig) {
+  const Entity rig = CreateEntity(mathfu::kZeros3f);
+  const Entity attachment = CreateEntity(mathfu::kZeros3f);
+  rig_system_->SetRig(rig, CreateSkeleton());
+  rig_system_->AttachToBone(attachment, rig, 1);
+  rig_system_->UpdateBoneAttachments();
+  EXPECT_THAT(GetWorldPosition(attachment),
+              NearMathfu(mathfu::vec3(0.0f, 1.0f, 0.0f), kEpsilon));
+
+  transform_system_->SetLocalTranslation(rig, mathfu::vec3(0.0f, 0.0f, -5.0f));
+  rig_system_->UpdateBoneAttachments();
+  EXPECT_THAT(GetWorldPosition(attachment),
+              NearMathfu(mathfu::vec3(0.0f, 1.0f, -5.0f), kEpsilon));
+}
+
+TEST_F(RigSystemTest, DetachedAttachmentStaysInPlace) {
+  const Entity rig = CreateEntity(mathfu::kZeros3f);
+  const Entity first = CreateEntity(mathfu::kZeros3f);
+  const Entity second = CreateEntity(mathfu::kZeros3f);
+  rig_system_->SetRig(rig, CreateSkeleton());
+  rig_system_->AttachToBone(first, rig, 1);
+  rig_system_->AttachToBone(second, rig, 1);
+  rig_system_->UpdateBoneAttachments();
+
+  const PoseVector pose = {
+      Translation(mathfu::kZeros3f),
+      Translation(mathfu::vec3(0.0f, 3.0f, 0.0f)),
+  };
+
+  // A detached Entity is left where it was while the others keep following
+  // the rig.
+  rig_system_->DetachFromBone(first);
+  rig_system_->SetPose(rig, pose);
+  rig_system_->UpdateBoneAttachments();
+  EXPECT_THAT(GetWorldPosition(first),
+              NearMathfu(mathfu::vec3(0.0f, 1.0f, 0.0f), kEpsilon));
+  EXPECT_THAT(GetWorldPosition(second),
+              NearMathfu(mathfu::vec3(0.0f, 3.0f, 0.0f), kEpsilon));
+
+  // Destroying the rig detaches the remaining attachments.
+  entity_factory_->Destroy(rig);
+  entity_factory_->DestroyQueuedEntities();
+  rig_system_->UpdateBoneAttachments();
+  EXPECT_THAT(GetWorldPosition(second),
+              NearMathfu(mathfu::vec3(0.0f, 3.0f, 0.0f), kEpsilon));
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,78 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/sample_history.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+TEST(SampleHistoryTest, StartsWithZeros) {
+  const SampleHistory history(4);
+  EXPECT_EQ(history.GetSize(), 4);
+  EXPECT_EQ(history.GetOffset(), 0);
+  EXPECT_EQ(history.GetLatest(), 0.f);
+  EXPECT_EQ(history.GetMax(), 0.f);
+  EXPECT_EQ(history.GetValues(), std::vector<float>(4, 0.f));
+}
+
+TEST(SampleHistoryTest, Add) {
+  SampleHistory history(4);
+  history.Add(1.f);
+  history.Add(3.f);
+  history.Add(2.f);
+  EXPECT_EQ(history.GetOffset(), 3);
+  EXPECT_EQ(history.GetLatest(), 2.f);
+  EXPECT_EQ(history.GetMax(), 3.f);
+  EXPECT_EQ(history.GetValues(), std::vector<float>({1.f, 3.f, 2.f, 0.f}));
+}
+
+TEST(SampleHistoryTest, ReplacesOldestSample) {
+  SampleHistory history(3);
+  history.Add(5.f);
+  history.Add(1.f);
+  history.Add(2.f);
+  EXPECT_EQ(history.GetOffset(), 0);
+  EXPECT_EQ(history.GetLatest(), 2.f);
+
+  // The 5 falls out of the history once it is the oldest sample.
+  history.Add(3.f);
+  EXPECT_EQ(history.GetOffset(), 1);
+  EXPECT_EQ(history.GetLatest(), 3.f);
+  EXPECT_EQ(history.GetMax(), 3.f);
+  EXPECT_EQ(history.GetValues(), std::vector<float>({3.f, 1.f, 2.f}));
+}
+
+TEST(SampleHistoryTest, NegativeSamples) {
+  SampleHistory history(2);
+  history.Add(-1.f);
+  history.Add(-2.f);
+  EXPECT_EQ(history.GetMax(), -1.f);
+}
+
+TEST(SampleHistoryTest, HoldsAtLeastOneSample) {
+  SampleHistory history(0);
+  EXPECT_EQ(history.GetSize(), 1);
+  history.Add(7.f);
+  EXPECT_EQ(history.GetOffset(), 0);
+  EXPECT_EQ(history.GetLatest(), 7.f);
+}
+
+}  // namespace
+}  // namespace lull
@@ -16,14 +16,20 @@ limitations under the License.
 
 #include "lullaby/util/scheduled_processor.h"
 
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "lullaby/tests/portable_test_macros.h"
 
 namespace lull {
 namespace {
 
-TEST(ScheduledProcessorTest, Scheduling) {
-  ScheduledProcessor scheduled_processor;
+// Runs each test against both ScheduledProcessor backends.
+class ScheduledProcessorTest
+    : public ::testing::TestWithParam<ScheduledProcessor::Backend> {};
+
+TEST_P(ScheduledProcessorTest, Scheduling) {
+  ScheduledProcessor scheduled_processor(GetParam());
 
   bool array[] = {false, false, false, false};
 
@@ -103,10 +109,10 @@ TEST(ScheduledProcessorTest, Scheduling) {
   EXPECT_TRUE(scheduled_processor.Empty());
 }
 
-TEST(ScheduledProcessorTest, Cancel) {
+TEST_P(ScheduledProcessorTest, Cancel) {
   using TaskId = ScheduledProcessor::TaskId;
 
-  ScheduledProcessor scheduled_processor;
+  ScheduledProcessor scheduled_processor(GetParam());
 
   // First test that it works in the simple case.
   EXPECT_TRUE(scheduled_processor.Empty());
@@ -154,5 +160,70 @@ TEST(ScheduledProcessorTest, Cancel) {
                           kErrorMessage);
 }
 
+TEST_P(ScheduledProcessorTest, LongDelays) {
+  ScheduledProcessor scheduled_processor(GetParam());
+
+  // Add tasks in reverse order with delays spanning milliseconds to hours.
+  std::vector<int> order;
+  const int kDelays[] = {0, 1, 2, 255, 256, 257, 65535, 65536, 70000,
+                         16777216, 20000000};
+  const int kNumDelays = sizeof(kDelays) / sizeof(kDelays[0]);
+  for (int i = kNumDelays - 1; i >= 0; --i) {
+    scheduled_processor.Add([&order, i]() { order.push_back(i); },
+                            std::chrono::milliseconds(kDelays[i]));
+  }
+
+  // A task that is cancelled while waiting in a higher level of the wheel.
+  const ScheduledProcessor::TaskId cancelled = scheduled_processor.Add(
+      [&]() { EXPECT_TRUE(false); }, std::chrono::milliseconds(70000));
+  scheduled_processor.Tick(std::chrono::milliseconds(60000));
+  scheduled_processor.Cancel(cancelled);
+
+  // Tick in irregular steps and check that tasks only run once their delay
+  // has passed.
+  int64_t elapsed = 60000;
+  while (!scheduled_processor.Empty()) {
+    for (size_t i = 0; i < order.size(); ++i) {
+      EXPECT_LE(kDelays[order[i]], elapsed);
+    }
+    for (int i = static_cast<int>(order.size()); i < kNumDelays; ++i) {
+      EXPECT_GT(kDelays[i], elapsed);
+    }
+    scheduled_processor.Tick(std::chrono::milliseconds(1000));
+    elapsed += 1000;
+  }
+
+  ASSERT_EQ(order.size(), static_cast<size_t>(kNumDelays));
+  for (int i = 0; i < kNumDelays; ++i) {
+    EXPECT_EQ(order[i], i);
+  }
+}
+
+TEST_P(ScheduledProcessorTest, ManyTasks) {
+  ScheduledProcessor scheduled_processor(GetParam());
+
+  std::vector<ScheduledProcessor::TaskId> ids;
+  int count = 0;
+  for (int i = 0; i < 5000; ++i) {
+    ids.push_back(scheduled_processor.Add(
+        [&count]() { ++count; }, std::chrono::milliseconds(i % 997)));
+  }
+  for (size_t i = 0; i < ids.size(); i += 2) {
+    scheduled_processor.Cancel(ids[i]);
+  }
+  EXPECT_EQ(2500ul, scheduled_processor.Size());
+
+  scheduled_processor.Tick(std::chrono::milliseconds(500));
+  EXPECT_GT(count, 0);
+  EXPECT_LT(count, 2500);
+  scheduled_processor.Tick(std::chrono::milliseconds(500));
+  EXPECT_EQ(2500, count);
+  EXPECT_TRUE(scheduled_processor.Empty());
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, ScheduledProcessorTest,
+                         ::testing::Values(ScheduledProcessor::kSortedQueue,
+                                           ScheduledProcessor::kTimingWheel));
+
 }  // namespace
 }  // namespace lull
@@ -200,5 +200,46 @@ TEST(ScriptCompilerTest, CompileAndBuild) {
   EXPECT_THAT(callbacks.parsed, Eq(callbacks.expected));
 }
 
+TEST(ScriptCompilerTest, InternsSymbols) {
+  std::vector<uint8_t> once;
+  ScriptCompiler once_saver(&once);
+  ParseScript("(foo)", &once_saver);
+
+  std::vector<uint8_t> twice;
+  ScriptCompiler twice_saver(&twice);
+  ParseScript("(foo foo)", &twice_saver);
+
+  // The second use of the symbol only adds a token and an index to the byte
+  // code, not another copy of the name.
+  EXPECT_THAT(twice.size() - once.size(), Eq(1 + sizeof(uint32_t)));
+
+  TestParserCallbacks callbacks;
+  EXPECT_TRUE(ScriptCompiler::Build(twice, &callbacks));
+
+  callbacks.Expect(ParserCallbacks::kPush);
+  callbacks.Expect(ParserCallbacks::kSymbol, Symbol("foo"));
+  callbacks.Expect(ParserCallbacks::kSymbol, Symbol("foo"));
+  callbacks.Expect(ParserCallbacks::kPop);
+  callbacks.Expect(ParserCallbacks::kEof);
+
+  EXPECT_THAT(callbacks.parsed, Eq(callbacks.expected));
+}
+
+TEST(ScriptCompilerTest, RejectsInvalidByteCode) {
+  std::vector<uint8_t> buffer;
+  ScriptCompiler saver(&buffer);
+  ParseScript("(1 'hello' world)", &saver);
+  EXPECT_TRUE(ScriptCompiler::IsByteCode(buffer));
+
+  std::vector<uint8_t> wrong_version = buffer;
+  wrong_version[1] ^= 0xff;
+  TestParserCallbacks callbacks;
+  EXPECT_FALSE(ScriptCompiler::Build(wrong_version, &callbacks));
+  EXPECT_TRUE(callbacks.parsed.empty());
+
+  std::vector<uint8_t> truncated(buffer.begin(), buffer.end() - 4);
+  EXPECT_FALSE(ScriptCompiler::Build(truncated, &callbacks));
+}
+
 }  // namespace
 }  // namespace lull
@@ -17,42 +17,55 @@ limitations under the License.
 #include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
-#include "lullaby/modules/script/function_binder.h"
+#include "lullaby/modules/function/call_native_function.h"
 #include "lullaby/modules/lullscript/script_env.h"
+#include "lullaby/modules/lullscript/script_program.h"
 #include "lullaby/util/math.h"
-#include "lullaby/util/registry.h"
 
 namespace lull {
 namespace {
 
 using ::testing::Eq;
 
-static void RegisterTestFunctions(FunctionBinder* binder) {
-  binder->RegisterFunction("FlipBool", [](bool x) { return !x; });
-  binder->RegisterFunction(
-      "AddInt16", [](int16_t x) { return static_cast<int16_t>(x + 1); });
-  binder->RegisterFunction(
-      "AddInt32", [](int32_t x) { return static_cast<int32_t>(x + 1); });
-  binder->RegisterFunction(
-      "AddInt64", [](int64_t x) { return static_cast<int64_t>(x + 1); });
-  binder->RegisterFunction(
-      "AddUInt16", [](uint16_t x) { return static_cast<uint16_t>(x + 1); });
-  binder->RegisterFunction(
-      "AddUInt32", [](uint32_t x) { return static_cast<uint32_t>(x + 1); });
-  binder->RegisterFunction(
-      "AddUInt64", [](uint64_t x) { return static_cast<uint64_t>(x + 1); });
-  binder->RegisterFunction("RepeatString",
-                           [](const std::string& s) { return s + s; });
-  binder->RegisterFunction("RotateVec2", [](const mathfu::vec2& v) {
+template <typename Fn>
+static void RegisterTestFunction(ScriptEnv* env, const char* name, Fn fn) {
+  env->Register(name, [name, fn](IContext* context) {
+    return CallNativeFunction(context, name, fn) ? 1 : -1;
+  });
+}
+
+static void RegisterTestFunctions(ScriptEnv* env) {
+  RegisterTestFunction(env, "FlipBool", [](bool x) { return !x; });
+  RegisterTestFunction(env, "AddInt16", [](int16_t x) {
+    return static_cast<int16_t>(x + 1);
+  });
+  RegisterTestFunction(env, "AddInt32", [](int32_t x) {
+    return static_cast<int32_t>(x + 1);
+  });
+  RegisterTestFunction(env, "AddInt64", [](int64_t x) {
+    return static_cast<int64_t>(x + 1);
+  });
+  RegisterTestFunction(env, "AddUInt16", [](uint16_t x) {
+    return static_cast<uint16_t>(x + 1);
+  });
+  RegisterTestFunction(env, "AddUInt32", [](uint32_t x) {
+    return static_cast<uint32_t>(x + 1);
+  });
+  RegisterTestFunction(env, "AddUInt64", [](uint64_t x) {
+    return static_cast<uint64_t>(x + 1);
+  });
+  RegisterTestFunction(env, "RepeatString",
+                       [](const std::string& s) { return s + s; });
+  RegisterTestFunction(env, "RotateVec2", [](const mathfu::vec2& v) {
     return mathfu::vec2(v.y, v.x);
   });
-  binder->RegisterFunction("RotateVec3", [](const mathfu::vec3& v) {
+  RegisterTestFunction(env, "RotateVec3", [](const mathfu::vec3& v) {
     return mathfu::vec3(v.y, v.z, v.x);
   });
-  binder->RegisterFunction("RotateVec4", [](const mathfu::vec4& v) {
+  RegisterTestFunction(env, "RotateVec4", [](const mathfu::vec4& v) {
     return mathfu::vec4(v.y, v.z, v.w, v.x);
   });
-  binder->RegisterFunction("RotateQuat", [](const mathfu::quat& v) {
+  RegisterTestFunction(env, "RotateQuat", [](const mathfu::quat& v) {
     return mathfu::quat(v.vector().x, v.vector().y, v.vector().z, v.scalar());
   });
 }
@@ -76,13 +89,8 @@ static const char* kBenchmarkTestSrc =
     ")";
 
 static void BM_Lullscript(benchmark::State& state) {
-  Registry registry;
-  FunctionBinder binder(&registry);
-  RegisterTestFunctions(&binder);
-
   ScriptEnv env;
-  env.SetFunctionCallHandler(
-      [&binder](FunctionCall* call) { binder.Call(call); });
+  RegisterTestFunctions(&env);
 
   auto script = env.Read(kBenchmarkTestSrc);
   while (state.KeepRunning()) {
@@ -91,19 +99,57 @@ static void BM_Lullscript(benchmark::State& state) {
 }
 BENCHMARK(BM_Lullscript);
 
-// This test verifies that the benchmark code actually behaves correctly.
-TEST(ScriptEnvBenchmarkTest, BenchmarkTestVerification) {
-  Registry registry;
-  FunctionBinder binder(&registry);
-  RegisterTestFunctions(&binder);
+static void BM_LullscriptProgram(benchmark::State& state) {
+  ScriptEnv env;
+  RegisterTestFunctions(&env);
+
+  ScriptProgram program(&env, env.Read(kBenchmarkTestSrc));
+  while (state.KeepRunning()) {
+    program.Run();
+  }
+}
+BENCHMARK(BM_LullscriptProgram);
+
+// A per-frame behaviour that is dominated by arithmetic, comparisons and
+// branches rather than calls into native functions.
+static const char* kArithmeticTestSrc =
+    "(do "
+    "(= frame (+ frame 1)) "
+    "(= t (* frame 0.016f)) "
+    "(= phase (% frame 60)) "
+    "(= x (+ (* t 2.0f) (/ phase 4))) "
+    "(= y (- (* x x) (* 3 t))) "
+    "(= in_range (and (>= x 0.0f) (< y 1000.0f))) "
+    "(= speed (if in_range (* x 0.5f) (- 0.0f x))) "
+    "(= flip (not (== phase 0))) "
+    "(if (and flip (> speed 1.0f)) (= speed (/ speed 2)) speed) "
+    "(+ speed y) "
+    ")";
 
+static void BM_LullscriptArithmetic(benchmark::State& state) {
   ScriptEnv env;
-  env.SetFunctionCallHandler(
-      [&binder](FunctionCall* call) { binder.Call(call); });
+  env.SetValue(Symbol("frame"), env.Create(0));
 
-  auto script = env.Read(kBenchmarkTestSrc);
-  env.Eval(script);
+  auto script = env.Read(kArithmeticTestSrc);
+  while (state.KeepRunning()) {
+    env.Eval(script);
+  }
+}
+BENCHMARK(BM_LullscriptArithmetic);
+
+static void BM_LullscriptArithmeticProgram(benchmark::State& state) {
+  ScriptEnv env;
+  env.SetValue(Symbol("frame"), env.Create(0));
+
+  ScriptProgram program(&env, env.Read(kArithmeticTestSrc));
+  while (state.KeepRunning()) {
+    program.Run();
+  }
+}
+BENCHMARK(BM_LullscriptArithmeticProgram);
 
+// Checks the values set by kBenchmarkTestSrc.
+static void VerifyBenchmarkTestValues(const ScriptEnv& env) {
   EXPECT_THAT(*env.GetValue(Symbol("bool")).Get<bool>(), Eq(false));
   EXPECT_THAT(*env.GetValue(Symbol("int16")).Get<int32_t>(), Eq(124));
   EXPECT_THAT(*env.GetValue(Symbol("int32")).Get<int32_t>(), Eq(124));
@@ -126,5 +172,47 @@ TEST(ScriptEnvBenchmarkTest, BenchmarkTestVerification) {
   EXPECT_THAT(qt.scalar(), Eq(mathfu::quat(2, 3, 4, 1).scalar()));
 }
 
+// This test verifies that the benchmark code actually behaves correctly.
+TEST(ScriptEnvBenchmarkTest, BenchmarkTestVerification) {
+  ScriptEnv env;
+  RegisterTestFunctions(&env);
+
+  auto script = env.Read(kBenchmarkTestSrc);
+  env.Eval(script);
+  VerifyBenchmarkTestValues(env);
+}
+
+TEST(ScriptEnvBenchmarkTest, ProgramTestVerification) {
+  ScriptEnv env;
+  RegisterTestFunctions(&env);
+
+  ScriptProgram program(&env, env.Read(kBenchmarkTestSrc));
+  program.Run();
+  VerifyBenchmarkTestValues(env);
+}
+
+// Runs the arithmetic script for a number of frames through both Eval and a
+// ScriptProgram and checks that they agree.
+TEST(ScriptEnvBenchmarkTest, ArithmeticTestVerification) {
+  ScriptEnv eval_env;
+  eval_env.SetValue(Symbol("frame"), eval_env.Create(0));
+  auto script = eval_env.Read(kArithmeticTestSrc);
+
+  ScriptEnv program_env;
+  program_env.SetValue(Symbol("frame"), program_env.Create(0));
+  ScriptProgram program(&program_env, program_env.Read(kArithmeticTestSrc));
+
+  for (int i = 0; i < 120; ++i) {
+    ScriptValue expected = eval_env.Eval(script);
+    ScriptValue actual = program.Run();
+    ASSERT_THAT(expected.Is<float>(), Eq(true));
+    ASSERT_THAT(actual.Is<float>(), Eq(true));
+    EXPECT_THAT(*actual.Get<float>(), Eq(*expected.Get<float>()));
+  }
+  EXPECT_THAT(*program_env.GetValue(Symbol("frame")).Get<int>(), Eq(120));
+  EXPECT_THAT(*program_env.GetValue(Symbol("speed")).Get<float>(),
+              Eq(*eval_env.GetValue(Symbol("speed")).Get<float>()));
+}
+
 }  // namespace
 }  // namespace lull
@@ -220,6 +220,38 @@ TEST(ScriptEnvTest, CallRegisteredFunction) {
   EXPECT_THAT(*res.Get<int>(), Eq(5));
 }
 
+TEST(ScriptEnvTest, CallRegisteredFunctionConvertsArgs) {
+  ScriptEnv env;
+  float total = 0.f;
+  env.Register("add", [&total](IContext* context) {
+    if (!CallNativeFunction(context, "add",
+                            [&total](float x) { total += x; })) {
+      return -1;
+    }
+    return 0;
+  });
+  env.Register("scale", [](IContext* context) {
+    if (!CallNativeFunction(context, "scale",
+                            [](const mathfu::vec3& v, float s) {
+                              return v * s;
+                            })) {
+      return -1;
+    }
+    return 1;
+  });
+
+  ScriptValue res = env.Eval(env.Read("(add 1.5f)"));
+  EXPECT_THAT(res.IsNil(), Eq(true));
+  EXPECT_THAT(total, Eq(1.5f));
+
+  env.SetValue(Symbol("v"), env.Create(mathfu::vec3(1.f, 2.f, 3.f)));
+  res = env.Eval(env.Read("(scale v 2.f)"));
+  EXPECT_THAT(res.Is<mathfu::vec3>(), Eq(true));
+  EXPECT_THAT(res.Get<mathfu::vec3>()->x, Eq(2.f));
+  EXPECT_THAT(res.Get<mathfu::vec3>()->y, Eq(4.f));
+  EXPECT_THAT(res.Get<mathfu::vec3>()->z, Eq(6.f));
+}
+
 TEST(ScriptEnvTest, Recurse) {
   ScriptEnv env;
 
@@ -0,0 +1,206 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/lullscript/script_program.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/lullscript/functions/functions.h"
+#include "lullaby/modules/lullscript/script_env.h"
+#include "lullaby/modules/lullscript/script_frame.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Gt;
+
+// Runs |src| both as a compiled program and through ScriptEnv::Eval in two
+// separate environments and expects identical results.
+void ExpectSameAsEval(const char* src) {
+  ScriptEnv eval_env;
+  ScriptValue expected = eval_env.Eval(eval_env.Read(src));
+
+  ScriptEnv program_env;
+  ScriptProgram program(&program_env, program_env.Read(src));
+  ScriptValue actual = program.Run();
+
+  EXPECT_THAT(actual.GetTypeId(), Eq(expected.GetTypeId())) << src;
+  EXPECT_THAT(Stringify(actual), Eq(Stringify(expected))) << src;
+}
+
+TEST(ScriptProgramTest, Arithmetic) {
+  ScriptEnv env;
+  ScriptProgram program(&env, env.Read("(+ 1 (* 2 3))"));
+  EXPECT_THAT(program.IsValid(), Eq(true));
+  EXPECT_THAT(program.GetNumInstructions(), Gt(0u));
+
+  ScriptValue res = program.Run();
+  EXPECT_THAT(res.Is<int>(), Eq(true));
+  EXPECT_THAT(*res.Get<int>(), Eq(7));
+
+  ExpectSameAsEval("(- 10 3)");
+  ExpectSameAsEval("(/ 7 2)");
+  ExpectSameAsEval("(% 7 3)");
+  ExpectSameAsEval("(* 2 1.5f)");
+  ExpectSameAsEval("(/ 1 4.0)");
+  ExpectSameAsEval("(+ 1.5f 2.5)");
+  ExpectSameAsEval("(- 3.5f 1)");
+}
+
+TEST(ScriptProgramTest, Comparisons) {
+  ExpectSameAsEval("(== 1 1)");
+  ExpectSameAsEval("(!= 1 1.0f)");
+  ExpectSameAsEval("(< 1 2.5)");
+  ExpectSameAsEval("(> 1.5f 2)");
+  ExpectSameAsEval("(<= 2 2)");
+  ExpectSameAsEval("(>= 1 2)");
+}
+
+TEST(ScriptProgramTest, OtherOperandTypes) {
+  // Anything but int, float and double is handled by the operator functions.
+  ExpectSameAsEval("(+ 1u 2u)");
+  ExpectSameAsEval("(* 2l 3)");
+  ExpectSameAsEval("(+ (seconds 1) (seconds 2))");
+  ExpectSameAsEval("(< (seconds 1) (seconds 2))");
+  ExpectSameAsEval("(% 5.0f 2)");
+  ExpectSameAsEval("(+ 'a' 1)");
+  ExpectSameAsEval("(+ true 1)");
+}
+
+TEST(ScriptProgramTest, Logic) {
+  ExpectSameAsEval("(and true true)");
+  ExpectSameAsEval("(and true false)");
+  ExpectSameAsEval("(and)");
+  ExpectSameAsEval("(or false true)");
+  ExpectSameAsEval("(or false false)");
+  ExpectSameAsEval("(or)");
+  ExpectSameAsEval("(and true 1)");
+  ExpectSameAsEval("(not false)");
+  ExpectSameAsEval("(not (< 1 2))");
+  ExpectSameAsEval("(not 1)");
+}
+
+TEST(ScriptProgramTest, ShortCircuits) {
+  ScriptEnv env;
+  ScriptProgram program(
+      &env, env.Read("(do (= x 0) (or true (= x 1)) (and false (= x 2)) x)"));
+  ScriptValue res = program.Run();
+  EXPECT_THAT(res.Is<int>(), Eq(true));
+  EXPECT_THAT(*res.Get<int>(), Eq(0));
+}
+
+TEST(ScriptProgramTest, If) {
+  ExpectSameAsEval("(if true 1 2)");
+  ExpectSameAsEval("(if false 1 2)");
+  ExpectSameAsEval("(if (< 1 2) (+ 1 1) (- 1 1))");
+  ExpectSameAsEval("(if false 1)");
+  ExpectSameAsEval("(if true)");
+  ExpectSameAsEval("(if 1 2 3)");
+  ExpectSameAsEval("(if true 1 2 3)");
+}
+
+TEST(ScriptProgramTest, Variables) {
+  ScriptEnv env;
+  env.SetValue(Symbol("y"), env.Create(10));
+
+  ScriptProgram program(&env, env.Read("(do (= x (+ y 1)) (var z (* x 2)))"));
+  ScriptValue res = program.Run();
+  EXPECT_THAT(*res.Get<int>(), Eq(22));
+  EXPECT_THAT(*env.GetValue(Symbol("x")).Get<int>(), Eq(11));
+  EXPECT_THAT(*env.GetValue(Symbol("z")).Get<int>(), Eq(22));
+
+  // Variables are read from the environment every time the program runs.
+  env.SetValue(Symbol("y"), env.Create(20));
+  res = program.Run();
+  EXPECT_THAT(*res.Get<int>(), Eq(42));
+  EXPECT_THAT(*env.GetValue(Symbol("x")).Get<int>(), Eq(21));
+}
+
+TEST(ScriptProgramTest, NullValues) {
+  ScriptEnv env;
+  ScriptProgram program(&env, env.Read("(= x null)"));
+  program.Run();
+
+  // Like Eval, the variable holds a null value rather than being unset.
+  const ScriptValue x = env.GetValue(Symbol("x"));
+  EXPECT_THAT(x.IsNil(), Eq(true));
+  EXPECT_THAT(x.GetVariant() != nullptr, Eq(true));
+}
+
+TEST(ScriptProgramTest, Functions) {
+  const char* src =
+      "(do"
+      "  (def fact (n)"
+      "    (if (<= n 1)"
+      "      1"
+      "      (* n (fact (- n 1)))"
+      "    )"
+      "  )"
+      "  (fact 5)"
+      ")";
+  ExpectSameAsEval(src);
+
+  ScriptEnv env;
+  ScriptProgram program(&env, env.Read(src));
+  ScriptValue res = program.Run();
+  EXPECT_THAT(*res.Get<int>(), Eq(120));
+}
+
+TEST(ScriptProgramTest, Return) {
+  ExpectSameAsEval("(do 1 (return 2) 3)");
+  ExpectSameAsEval("(do (if true (return (+ 1 1))) 3)");
+  ExpectSameAsEval("(do (do (return 1) 2) 3)");
+  ExpectSameAsEval("(return 4)");
+  ExpectSameAsEval("(do (def f (x) (do (if (< x 0) (return 0)) x)) (f -1))");
+}
+
+TEST(ScriptProgramTest, CallsNativeFunctions) {
+  ScriptEnv env;
+  int count = 0;
+  env.Register("inc", NativeFunction{[&count](ScriptFrame* frame) {
+                 ++count;
+                 frame->Return(*frame->EvalNext().Get<int>() + 1);
+               }});
+
+  ScriptProgram program(&env, env.Read("(* (inc 1) (inc (+ 1 1)))"));
+  ScriptValue res = program.Run();
+  EXPECT_THAT(*res.Get<int>(), Eq(6));
+  EXPECT_THAT(count, Eq(2));
+}
+
+TEST(ScriptProgramTest, RebindingBuiltinsFallsBackToEval) {
+  ScriptEnv env;
+  ScriptProgram program(&env, env.Read("(+ 1 2)"));
+  EXPECT_THAT(*program.Run().Get<int>(), Eq(3));
+
+  env.Register("+", NativeFunction{[](ScriptFrame* frame) {
+                 frame->Return(100);
+               }});
+  EXPECT_THAT(*program.Run().Get<int>(), Eq(100));
+
+  // Programs compiled while a built-in is rebound simply call the new value.
+  ScriptProgram rebound(&env, env.Read("(+ 1 2)"));
+  EXPECT_THAT(*rebound.Run().Get<int>(), Eq(100));
+}
+
+TEST(ScriptProgramTest, Invalid) {
+  ScriptProgram program;
+  EXPECT_THAT(program.IsValid(), Eq(false));
+  EXPECT_THAT(program.Run().IsNil(), Eq(true));
+}
+
+}  // namespace
+}  // namespace lull
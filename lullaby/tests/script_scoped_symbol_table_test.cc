@@ -102,5 +102,40 @@ TEST(ScriptScopedSymbolTableTest, PushPop) {
   EXPECT_THAT(*value.Get<int>(), Eq(456));
 }
 
+TEST(ScriptScopedSymbolTableTest, Slots) {
+  ScriptScopedSymbolTable table;
+  const Symbol key1("123");
+  const Symbol key2("456");
+
+  const ScriptScopedSymbolTable::Slot slot1 = table.Resolve(key1);
+  const ScriptScopedSymbolTable::Slot slot2 = table.Resolve(key2);
+  EXPECT_THAT(table.Resolve(key1), Eq(slot1));
+  EXPECT_TRUE(slot1 != slot2);
+  EXPECT_TRUE(table.GetValue(slot1).IsNil());
+
+  table.SetValue(slot1, ScriptValue::Create(123));
+  EXPECT_THAT(*table.GetValue(key1).Get<int>(), Eq(123));
+
+  table.PushScope();
+  table.LetValue(slot1, ScriptValue::Create(456));
+  table.SetValue(key2, ScriptValue::Create(789));
+  EXPECT_THAT(*table.GetValue(slot1).Get<int>(), Eq(456));
+  EXPECT_THAT(*table.GetValue(slot2).Get<int>(), Eq(789));
+  table.PopScope();
+
+  // Slots remain valid after all of their bindings have been popped.
+  EXPECT_THAT(*table.GetValue(slot1).Get<int>(), Eq(123));
+  EXPECT_TRUE(table.GetValue(slot2).IsNil());
+  EXPECT_TRUE(table.GetValue(key2).IsNil());
+
+  table.SetValue(slot2, ScriptValue::Create(1.f));
+  EXPECT_THAT(*table.GetValue(key2).Get<float>(), Eq(1.f));
+
+  // Copies share the same slots.
+  ScriptScopedSymbolTable copy(table);
+  EXPECT_THAT(*copy.GetValue(slot1).Get<int>(), Eq(123));
+  EXPECT_THAT(copy.Resolve(key2), Eq(slot2));
+}
+
 }  // namespace
 }  // namespace lull
@@ -15,6 +15,9 @@ limitations under the License.
 */
 
 #include "lullaby/systems/script/script_system.h"
+
+#include <algorithm>
+
 #include "gtest/gtest.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/ecs/entity_factory.h"
@@ -81,6 +84,66 @@ TEST_F(ScriptSystemTest, ScriptOnEventDef) {
   EXPECT_EQ(0u, script_engine_->GetTotalScripts());
 }
 
+TEST_F(ScriptSystemTest, BatchedScriptOnEventDef) {
+  TransformDefT transform;
+  ScriptOnEventDefT script_on_event;
+  EventDefT event_def;
+  event_def.global = true;
+  event_def.event = "SomeEvent";
+  script_on_event.inputs.push_back(event_def);
+  script_on_event.script.code = "(setbatch entities events)";
+  script_on_event.script.debug_name = "BatchedEventScript";
+  script_on_event.script.language = Language_LullScript;
+  script_on_event.batched = true;
+  Blueprint blueprint;
+  blueprint.Write(&transform);
+  blueprint.Write(&script_on_event);
+
+  int num_runs = 0;
+  std::vector<Entity> entities;
+  std::vector<EventWrapper> events;
+  binder_->RegisterFunction(
+      "setbatch", [&](const std::vector<Entity>& new_entities,
+                      const std::vector<EventWrapper>& new_events) {
+        ++num_runs;
+        entities = new_entities;
+        events = new_events;
+        std::sort(entities.begin(), entities.end());
+      });
+
+  Entity entity1 = entity_factory_->Create(&blueprint);
+  Entity entity2 = entity_factory_->Create(&blueprint);
+  Entity entity3 = entity_factory_->Create(&blueprint);
+  EXPECT_EQ(1u, script_engine_->GetTotalScripts());
+
+  // Events are only delivered in AdvanceFrame.
+  dispatcher_->Send(EventWrapper(Hash("SomeEvent")));
+  EXPECT_EQ(0, num_runs);
+
+  script_system_->AdvanceFrame(std::chrono::seconds(1));
+  EXPECT_EQ(1, num_runs);
+  EXPECT_EQ(entities, std::vector<Entity>({entity1, entity2, entity3}));
+  ASSERT_EQ(3u, events.size());
+  EXPECT_EQ(events[0].GetTypeId(), Hash("SomeEvent"));
+
+  // Nothing is delivered if there are no new events.
+  script_system_->AdvanceFrame(std::chrono::seconds(1));
+  EXPECT_EQ(1, num_runs);
+
+  // Pending events of destroyed entities are dropped.
+  dispatcher_->Send(EventWrapper(Hash("SomeEvent")));
+  entity_factory_->Destroy(entity2);
+  script_system_->AdvanceFrame(std::chrono::seconds(1));
+  EXPECT_EQ(2, num_runs);
+  EXPECT_EQ(entities, std::vector<Entity>({entity1, entity3}));
+  EXPECT_EQ(2u, events.size());
+
+  entity_factory_->Destroy(entity1);
+  EXPECT_EQ(1u, script_engine_->GetTotalScripts());
+  entity_factory_->Destroy(entity3);
+  EXPECT_EQ(0u, script_engine_->GetTotalScripts());
+}
+
 TEST_F(ScriptSystemTest, ScriptEveryFrameDef) {
   TransformDefT transform;
   ScriptEveryFrameDefT script_every_frame;
@@ -0,0 +1,269 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/contrib/scroll/scroll_virtual_list_system.h"
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/contrib/scroll/scroll_system.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/blueprint_tree.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/modules/file/asset_loader.h"
+#include "lullaby/modules/input/input_manager.h"
+#include "lullaby/systems/animation/animation_system.h"
+#include "lullaby/systems/dispatcher/dispatcher_system.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/generated/scroll_def_generated.h"
+#include "lullaby/generated/transform_def_generated.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::Eq;
+using ::testing::Ne;
+
+constexpr float kEpsilon = 1e-5f;
+constexpr size_t kNumRows = 100;
+constexpr size_t kMarginRows = 2;
+// Four rows of size 1 are visible at a time.
+constexpr float kViewSize = 4.f;
+
+const Clock::duration kDeltaTime = std::chrono::milliseconds(16);
+
+class ScrollVirtualListTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    registry_.Create<Dispatcher>();
+    registry_.Create<InputManager>();
+    registry_.Create<AssetLoader>(
+        [this](const char* filename, std::string* data) {
+          auto iter = files_.find(filename);
+          if (iter == files_.end()) {
+            return false;
+          }
+          *data = iter->second;
+          return true;
+        });
+
+    entity_factory_ = registry_.Create<EntityFactory>(&registry_);
+    entity_factory_->CreateSystem<AnimationSystem>();
+    entity_factory_->CreateSystem<DispatcherSystem>();
+    entity_factory_->CreateSystem<ScrollSystem>();
+    entity_factory_->CreateSystem<ScrollVirtualListSystem>();
+    entity_factory_->CreateSystem<TransformSystem>();
+    entity_factory_->Initialize();
+
+    scroll_system_ = registry_.Get<ScrollSystem>();
+    list_system_ = registry_.Get<ScrollVirtualListSystem>();
+    transform_system_ = registry_.Get<TransformSystem>();
+
+    AddRowBlueprint("row");
+    AddRowBlueprint("header");
+  }
+
+  // Makes a blueprint with just a transform available as |name|.
+  void AddRowBlueprint(const std::string& name) {
+    TransformDefT transform;
+    BlueprintTree blueprint;
+    blueprint.Write(&transform);
+    const flatbuffers::DetachedBuffer buffer =
+        entity_factory_->Finalize(&blueprint);
+    files_[name + ".bin"] = std::string(
+        reinterpret_cast<const char*>(buffer.data()), buffer.size());
+  }
+
+  Entity CreateList() {
+    TransformDefT transform;
+    ScrollDefT scroll;
+    ScrollVirtualListDefT list;
+    list.row_size = 1.f;
+    list.view_size = kViewSize;
+    list.num_rows = static_cast<int>(kNumRows);
+    list.margin_rows = static_cast<int>(kMarginRows);
+    list.row_blueprint = "row";
+
+    Blueprint blueprint;
+    blueprint.Write(&transform);
+    blueprint.Write(&scroll);
+    blueprint.Write(&list);
+    return entity_factory_->Create(&blueprint);
+  }
+
+  // Scrolls |list| so that its first visible row starts at |distance|.
+  void ScrollTo(Entity list, float distance) {
+    scroll_system_->ForceViewOffset(list, mathfu::vec2(0.f, -distance));
+    list_system_->AdvanceFrame(kDeltaTime);
+  }
+
+  // Returns the indices of all instantiated rows of |list|.
+  std::vector<size_t> GetRowIndices(Entity list) const {
+    std::vector<size_t> indices;
+    for (size_t i = 0; i < kNumRows; ++i) {
+      if (list_system_->GetRowEntity(list, i) != kNullEntity) {
+        indices.push_back(i);
+      }
+    }
+    return indices;
+  }
+
+  // Returns the entities of all instantiated rows of |list|.
+  std::set<Entity> GetRowEntities(Entity list) const {
+    std::set<Entity> rows;
+    for (size_t index : GetRowIndices(list)) {
+      rows.insert(list_system_->GetRowEntity(list, index));
+    }
+    return rows;
+  }
+
+  static std::vector<size_t> Range(size_t begin, size_t end) {
+    std::vector<size_t> range;
+    for (size_t i = begin; i < end; ++i) {
+      range.push_back(i);
+    }
+    return range;
+  }
+
+  Registry registry_;
+  std::unordered_map<std::string, std::string> files_;
+  EntityFactory* entity_factory_ = nullptr;
+  ScrollSystem* scroll_system_ = nullptr;
+  ScrollVirtualListSystem* list_system_ = nullptr;
+  TransformSystem* transform_system_ = nullptr;
+};
+
+TEST_F(ScrollVirtualListTest, VisibleRangeWithMargins) {
+  const Entity list = CreateList();
+  ASSERT_THAT(list, Ne(kNullEntity));
+
+  // At the start, there is only a margin after the visible rows.
+  EXPECT_THAT(GetRowIndices(list), ElementsAreArray(Range(0, 6)));
+
+  // In the middle, there is a margin on both sides.
+  ScrollTo(list, 10.f);
+  EXPECT_THAT(GetRowIndices(list), ElementsAreArray(Range(8, 16)));
+
+  // A partially visible row counts as visible.
+  ScrollTo(list, 10.5f);
+  EXPECT_THAT(GetRowIndices(list), ElementsAreArray(Range(8, 17)));
+
+  // At the end, there is only a margin before the visible rows.
+  ScrollTo(list, kNumRows - kViewSize);
+  EXPECT_THAT(GetRowIndices(list), ElementsAreArray(Range(94, kNumRows)));
+
+  // Each row is positioned at its place in the list less the view offset.
+  const Entity row = list_system_->GetRowEntity(list, 97);
+  EXPECT_NEAR(transform_system_->GetLocalTranslation(row).y, -1.5f,
+              kEpsilon);
+}
+
+TEST_F(ScrollVirtualListTest, ReusesRowsFromPool) {
+  const Entity list = CreateList();
+  const std::set<Entity> first_rows = GetRowEntities(list);
+  ASSERT_THAT(first_rows.size(), Eq(6u));
+
+  // None of the first rows are in range anymore, so they are all reused and
+  // only the two extra rows are created.
+  ScrollTo(list, 50.f);
+  const std::set<Entity> middle_rows = GetRowEntities(list);
+  ASSERT_THAT(middle_rows.size(), Eq(8u));
+  for (Entity row : first_rows) {
+    EXPECT_THAT(middle_rows.count(row), Eq(1u));
+  }
+  for (Entity row : middle_rows) {
+    EXPECT_TRUE(transform_system_->IsEnabled(row));
+  }
+
+  // Scrolling back releases two rows to the pool, which disables them.
+  ScrollTo(list, 0.f);
+  const std::set<Entity> last_rows = GetRowEntities(list);
+  ASSERT_THAT(last_rows.size(), Eq(6u));
+  size_t num_disabled = 0;
+  for (Entity row : middle_rows) {
+    if (last_rows.count(row) == 0) {
+      EXPECT_FALSE(transform_system_->IsEnabled(row));
+      ++num_disabled;
+    }
+  }
+  EXPECT_THAT(num_disabled, Eq(2u));
+}
+
+TEST_F(ScrollVirtualListTest, RebindChangesRowType) {
+  const Entity list = CreateList();
+  std::vector<size_t> bound;
+  list_system_->SetBindRowFn(
+      list, [&bound](Entity row, size_t index) { bound.push_back(index); });
+  const Entity old_row = list_system_->GetRowEntity(list, 2);
+  const Entity other_row = list_system_->GetRowEntity(list, 3);
+
+  // Only the row whose type changed is replaced.
+  bool header = true;
+  list_system_->SetRowBlueprintFn(list, [&header](size_t index) {
+    return header && index == 2 ? "header" : "row";
+  });
+  const Entity header_row = list_system_->GetRowEntity(list, 2);
+  EXPECT_THAT(header_row, Ne(old_row));
+  EXPECT_THAT(list_system_->GetRowEntity(list, 3), Eq(other_row));
+  EXPECT_FALSE(transform_system_->IsEnabled(old_row));
+
+  // Changing it back reuses the pooled row of the original type.
+  header = false;
+  bound.clear();
+  list_system_->RebindRows(list);
+  EXPECT_THAT(list_system_->GetRowEntity(list, 2), Eq(old_row));
+  EXPECT_TRUE(transform_system_->IsEnabled(old_row));
+  EXPECT_FALSE(transform_system_->IsEnabled(header_row));
+
+  // Every instantiated row is rebound.
+  EXPECT_THAT(bound, ElementsAreArray(Range(0, 6)));
+}
+
+TEST_F(ScrollVirtualListTest, IndexForPositionAfterScrolling) {
+  const Entity list = CreateList();
+  ScrollTo(list, 10.25f);
+
+  // The top of the view is a quarter of the way into row 10.
+  EXPECT_THAT(list_system_->GetIndexForPosition(list, mathfu::kZeros3f),
+              Eq(10u));
+  EXPECT_THAT(list_system_->GetIndexForPosition(
+                  list, mathfu::vec3(0.f, -0.8f, 0.f)),
+              Eq(11u));
+
+  // Every instantiated row maps back to its own index.
+  for (size_t index : GetRowIndices(list)) {
+    const Entity row = list_system_->GetRowEntity(list, index);
+    EXPECT_THAT(list_system_->GetIndexForPosition(
+                    list, transform_system_->GetLocalTranslation(row)),
+                Eq(index));
+  }
+
+  // Positions outside of the list are clamped to the first and last rows.
+  EXPECT_THAT(list_system_->GetIndexForPosition(
+                  list, mathfu::vec3(0.f, 20.f, 0.f)),
+              Eq(0u));
+  EXPECT_THAT(list_system_->GetIndexForPosition(
+                  list, mathfu::vec3(0.f, -200.f, 0.f)),
+              Eq(kNumRows - 1));
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,164 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/skin/skin_system.h"
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/testing/mock_render_system_impl.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/job_processor.h"
+#include "lullaby/util/math.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+using ::testing::_;
+using ::testing::Eq;
+using ::testing::FloatNear;
+using ::testing::Invoke;
+using ::testing::SizeIs;
+
+constexpr size_t kNumSkins = 40;
+constexpr size_t kNumBones = 4;
+constexpr float kEpsilon = 1e-4f;
+
+class SkinSystemTest : public ::testing::Test {
+ protected:
+  SkinSystemTest() : rng_(1234) {
+    registry_.Create<Dispatcher>();
+
+    entity_factory_ = registry_.Create<EntityFactory>(&registry_);
+    transform_system_ = entity_factory_->CreateSystem<TransformSystem>();
+    render_system_ = entity_factory_->CreateSystem<RenderSystem>();
+    skin_system_ = entity_factory_->CreateSystem<SkinSystem>();
+
+    auto* mock_render_system = render_system_->GetImpl();
+    ON_CALL(*mock_render_system, SetUniform(_, _, _, _, _))
+        .WillByDefault(Invoke([this](Entity e, const char* name,
+                                     const float* data, int dimension,
+                                     int count) {
+          uploads_[e].assign(data, data + dimension * count);
+        }));
+
+    entity_factory_->Initialize();
+  }
+
+  Sqt RandomSqt() {
+    std::uniform_real_distribution<float> offset(-2.f, 2.f);
+    std::uniform_real_distribution<float> angle(-3.f, 3.f);
+    std::uniform_real_distribution<float> scale(0.5f, 1.5f);
+    Sqt sqt;
+    sqt.translation = mathfu::vec3(offset(rng_), offset(rng_), offset(rng_));
+    sqt.rotation = FromEulerAnglesYXZ(
+        mathfu::vec3(angle(rng_), angle(rng_), angle(rng_)));
+    sqt.scale = mathfu::vec3(scale(rng_), scale(rng_), scale(rng_));
+    return sqt;
+  }
+
+  Entity CreateEntity(Entity parent = kNullEntity) {
+    const Entity entity = entity_factory_->Create();
+    transform_system_->Create(entity, RandomSqt());
+    if (parent != kNullEntity) {
+      transform_system_->AddChild(parent, entity);
+    }
+    return entity;
+  }
+
+  // Creates a skinned Entity whose bones form a chain, so that each bone's
+  // world matrix depends on all of the bones before it.
+  Entity CreateSkin() {
+    const Entity entity = CreateEntity();
+    std::vector<Entity> bones;
+    std::vector<mathfu::AffineTransform> inverse_bind_pose;
+    Entity parent = kNullEntity;
+    for (size_t i = 0; i < kNumBones; ++i) {
+      parent = CreateEntity(parent);
+      bones.push_back(parent);
+      inverse_bind_pose.push_back(mathfu::mat4::ToAffineTransform(
+          CalculateTransformMatrix(RandomSqt())));
+    }
+    skin_system_->SetSkin(entity, bones, inverse_bind_pose);
+    bones_[entity] = bones;
+    return entity;
+  }
+
+  Registry registry_;
+  EntityFactory* entity_factory_ = nullptr;
+  TransformSystem* transform_system_ = nullptr;
+  RenderSystem* render_system_ = nullptr;
+  SkinSystem* skin_system_ = nullptr;
+  std::mt19937 rng_;
+  std::unordered_map<Entity, std::vector<Entity>> bones_;
+  std::unordered_map<Entity, std::vector<float>> uploads_;
+};
+
+TEST_F(SkinSystemTest, UploadsShaderPose) {
+  const Entity entity = CreateSkin();
+  uploads_.clear();
+  skin_system_->AdvanceFrame();
+  ASSERT_THAT(uploads_[entity], SizeIs(kNumBones * 12));
+
+  const std::vector<Entity>& bones = bones_[entity];
+  const SkinSystem::Pose inverse_bind_pose =
+      skin_system_->GetInverseBindPose(entity);
+  const mathfu::mat4 skin_from_world =
+      transform_system_->GetWorldFromEntityMatrix(entity)->Inverse();
+  for (size_t i = 0; i < kNumBones; ++i) {
+    const mathfu::mat4* world_from_bone =
+        transform_system_->GetWorldFromEntityMatrix(bones[i]);
+    const mathfu::AffineTransform expected = mathfu::mat4::ToAffineTransform(
+        skin_from_world * *world_from_bone *
+        mathfu::mat4::FromAffineTransform(inverse_bind_pose[i]));
+    for (int j = 0; j < 12; ++j) {
+      EXPECT_THAT(uploads_[entity][i * 12 + j],
+                  FloatNear(expected[j], kEpsilon));
+    }
+  }
+}
+
+TEST_F(SkinSystemTest, ParallelMatchesSerial) {
+  std::vector<Entity> skins;
+  for (size_t i = 0; i < kNumSkins; ++i) {
+    skins.push_back(CreateSkin());
+  }
+
+  uploads_.clear();
+  skin_system_->AdvanceFrame();
+  const auto serial = uploads_;
+  ASSERT_THAT(serial, SizeIs(kNumSkins));
+
+  // With a JobProcessor, the skins are split across several jobs.
+  registry_.Create<JobProcessor>(4);
+  uploads_.clear();
+  skin_system_->AdvanceFrame();
+  ASSERT_THAT(uploads_, SizeIs(kNumSkins));
+  for (const Entity skin : skins) {
+    ASSERT_THAT(serial.at(skin), SizeIs(kNumBones * 12));
+    EXPECT_THAT(uploads_[skin], Eq(serial.at(skin))) << "skin " << skin;
+  }
+}
+
+}  // namespace
+}  // namespace lull
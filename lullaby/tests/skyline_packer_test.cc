@@ -0,0 +1,100 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/render/skyline_packer.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+struct Rect {
+  mathfu::vec2i pos;
+  mathfu::vec2i size;
+};
+
+bool Overlaps(const Rect& a, const Rect& b) {
+  return a.pos.x < b.pos.x + b.size.x && b.pos.x < a.pos.x + a.size.x &&
+         a.pos.y < b.pos.y + b.size.y && b.pos.y < a.pos.y + a.size.y;
+}
+
+TEST(SkylinePacker, PacksBottomLeft) {
+  SkylinePacker packer(mathfu::vec2i(8, 8));
+  mathfu::vec2i pos(-1, -1);
+
+  EXPECT_TRUE(packer.Pack(mathfu::vec2i(4, 2), &pos));
+  EXPECT_EQ(mathfu::vec2i(0, 0), pos);
+  EXPECT_TRUE(packer.Pack(mathfu::vec2i(4, 4), &pos));
+  EXPECT_EQ(mathfu::vec2i(4, 0), pos);
+  // Fits over the shorter first rectangle rather than the taller second one.
+  EXPECT_TRUE(packer.Pack(mathfu::vec2i(4, 2), &pos));
+  EXPECT_EQ(mathfu::vec2i(0, 2), pos);
+  // Spans both columns, so it goes above the tallest.
+  EXPECT_TRUE(packer.Pack(mathfu::vec2i(8, 4), &pos));
+  EXPECT_EQ(mathfu::vec2i(0, 4), pos);
+  EXPECT_FLOAT_EQ(1.f, packer.GetOccupancy());
+
+  EXPECT_FALSE(packer.Pack(mathfu::vec2i(1, 1), &pos));
+}
+
+TEST(SkylinePacker, RejectsOversizedRectangles) {
+  SkylinePacker packer(mathfu::vec2i(8, 8));
+  mathfu::vec2i pos;
+  EXPECT_FALSE(packer.Pack(mathfu::vec2i(9, 1), &pos));
+  EXPECT_FALSE(packer.Pack(mathfu::vec2i(1, 9), &pos));
+  EXPECT_FALSE(packer.Pack(mathfu::vec2i(0, 1), &pos));
+  EXPECT_FLOAT_EQ(0.f, packer.GetOccupancy());
+}
+
+TEST(SkylinePacker, Reset) {
+  SkylinePacker packer(mathfu::vec2i(4, 4));
+  mathfu::vec2i pos;
+  EXPECT_TRUE(packer.Pack(mathfu::vec2i(4, 4), &pos));
+  EXPECT_FALSE(packer.Pack(mathfu::vec2i(1, 1), &pos));
+
+  packer.Reset();
+  EXPECT_TRUE(packer.Pack(mathfu::vec2i(4, 4), &pos));
+  EXPECT_EQ(mathfu::vec2i(0, 0), pos);
+}
+
+TEST(SkylinePacker, RectanglesNeverOverlap) {
+  const mathfu::vec2i kBinSize(64, 64);
+  SkylinePacker packer(kBinSize);
+  std::vector<Rect> rects;
+  for (int i = 0; i < 200; ++i) {
+    const mathfu::vec2i size(1 + (i * 7) % 13, 1 + (i * 5) % 11);
+    mathfu::vec2i pos;
+    if (packer.Pack(size, &pos)) {
+      rects.push_back({pos, size});
+    }
+  }
+  EXPECT_GT(rects.size(), 20u);
+
+  for (size_t i = 0; i < rects.size(); ++i) {
+    EXPECT_GE(rects[i].pos.x, 0);
+    EXPECT_GE(rects[i].pos.y, 0);
+    EXPECT_LE(rects[i].pos.x + rects[i].size.x, kBinSize.x);
+    EXPECT_LE(rects[i].pos.y + rects[i].size.y, kBinSize.y);
+    for (size_t j = i + 1; j < rects.size(); ++j) {
+      EXPECT_FALSE(Overlaps(rects[i], rects[j])) << i << " " << j;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace lull
@@ -116,4 +116,22 @@ TEST(SpanTest, ContainerToByteSpan) {
   EXPECT_EQ(6, sum);
 }
 
+TEST(MutableSpanTest, ModifiesElements) {
+  std::vector<int> vec = {1, 2, 3};
+  MutableSpan<int> span(vec);
+
+  EXPECT_EQ(3u, span.size());
+  EXPECT_FALSE(span.empty());
+  EXPECT_EQ(vec.data(), span.data());
+  for (int& value : span) {
+    value *= 2;
+  }
+  span[0] = 7;
+  EXPECT_EQ(std::vector<int>({7, 4, 6}), vec);
+
+  const Span<int> view = span;
+  EXPECT_EQ(vec.data(), view.data());
+  EXPECT_EQ(3u, view.size());
+}
+
 }  // namespace lull
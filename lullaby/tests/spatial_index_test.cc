@@ -0,0 +1,204 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/transform/spatial_index.h"
+
+#include <limits>
+#include <unordered_set>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/blueprint.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/generated/transform_def_generated.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::NotNull;
+using ::testing::UnorderedElementsAre;
+
+constexpr float kMaxDistance = std::numeric_limits<float>::max();
+
+class SpatialIndexTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    registry_.Create<Dispatcher>();
+    auto* entity_factory = registry_.Create<EntityFactory>(&registry_);
+    transform_system_ = entity_factory->CreateSystem<TransformSystem>();
+    entity_factory->Initialize();
+
+    flag_ = transform_system_->RequestFlag();
+    registry_.Create<SpatialIndex>(&registry_);
+    spatial_index_ = registry_.Get<SpatialIndex>();
+    spatial_index_->IndexFlag(flag_);
+  }
+
+  // Creates an indexed Entity with a unit box at |position|.
+  Entity CreateEntity(const mathfu::vec3& position) {
+    TransformDefT transform;
+    transform.position = position;
+    Blueprint blueprint(&transform);
+    const Entity entity = registry_.Get<EntityFactory>()->Create(&blueprint);
+    transform_system_->SetAabb(
+        entity, Aabb(mathfu::vec3(-0.5f), mathfu::vec3(0.5f)));
+    transform_system_->SetFlag(entity, flag_);
+    return entity;
+  }
+
+  std::vector<Entity> QueryAabb(const Aabb& aabb) {
+    std::vector<Entity> entities;
+    spatial_index_->QueryAabb(
+        aabb, [&](Entity entity) { entities.push_back(entity); });
+    return entities;
+  }
+
+ protected:
+  Registry registry_;
+  TransformSystem* transform_system_ = nullptr;
+  SpatialIndex* spatial_index_ = nullptr;
+  TransformSystem::TransformFlags flag_ = TransformSystem::kInvalidFlag;
+};
+
+TEST_F(SpatialIndexTest, IndexesFlaggedEntities) {
+  const Entity entity1 = CreateEntity(mathfu::vec3(0.f, 0.f, 0.f));
+  const Entity entity2 = CreateEntity(mathfu::vec3(5.f, 0.f, 0.f));
+
+  TransformDefT transform;
+  Blueprint blueprint(&transform);
+  const Entity unflagged = registry_.Get<EntityFactory>()->Create(&blueprint);
+
+  EXPECT_THAT(spatial_index_->Size(), Eq(size_t(2)));
+  EXPECT_THAT(spatial_index_->GetWorldAabb(entity1), NotNull());
+  EXPECT_THAT(spatial_index_->GetWorldAabb(entity2), NotNull());
+  EXPECT_THAT(spatial_index_->GetWorldAabb(unflagged), IsNull());
+
+  transform_system_->ClearFlag(entity2, flag_);
+  EXPECT_THAT(spatial_index_->GetWorldAabb(entity2), IsNull());
+  transform_system_->SetFlag(unflagged, flag_);
+  EXPECT_THAT(spatial_index_->GetWorldAabb(unflagged), NotNull());
+
+  transform_system_->Disable(entity1);
+  EXPECT_THAT(spatial_index_->GetWorldAabb(entity1), IsNull());
+  transform_system_->Enable(entity1);
+  EXPECT_THAT(spatial_index_->GetWorldAabb(entity1), NotNull());
+
+  registry_.Get<EntityFactory>()->Destroy(entity1);
+  EXPECT_THAT(spatial_index_->GetWorldAabb(entity1), IsNull());
+}
+
+TEST_F(SpatialIndexTest, IndexesExistingEntities) {
+  const TransformSystem::TransformFlags flag = transform_system_->RequestFlag();
+  const Entity entity = CreateEntity(mathfu::vec3(0.f, 0.f, 0.f));
+  transform_system_->SetFlag(entity, flag);
+  transform_system_->ClearFlag(entity, flag_);
+  EXPECT_THAT(spatial_index_->GetWorldAabb(entity), IsNull());
+
+  spatial_index_->IndexFlag(flag);
+  EXPECT_THAT(spatial_index_->GetWorldAabb(entity), NotNull());
+
+  spatial_index_->UnindexFlag(flag);
+  EXPECT_THAT(spatial_index_->GetWorldAabb(entity), IsNull());
+}
+
+TEST_F(SpatialIndexTest, TracksMovement) {
+  const Entity entity = CreateEntity(mathfu::vec3(0.f, 0.f, 0.f));
+  const Aabb query(mathfu::vec3(9.f, -1.f, -1.f), mathfu::vec3(11.f, 1.f, 1.f));
+  EXPECT_THAT(QueryAabb(query), ElementsAre());
+
+  const uint64_t generation = spatial_index_->GetGeneration();
+  EXPECT_THAT(spatial_index_->GetGeneration(), Eq(generation));
+  transform_system_->SetLocalTranslation(entity, mathfu::vec3(10.f, 0.f, 0.f));
+  EXPECT_NE(spatial_index_->GetGeneration(), generation);
+  EXPECT_THAT(QueryAabb(query), ElementsAre(entity));
+
+  const Aabb* world_aabb = spatial_index_->GetWorldAabb(entity);
+  ASSERT_THAT(world_aabb, NotNull());
+  EXPECT_NEAR(world_aabb->min.x, 9.5f, 0.001f);
+  EXPECT_NEAR(world_aabb->max.x, 10.5f, 0.001f);
+}
+
+TEST_F(SpatialIndexTest, QuerySphere) {
+  const Entity entity1 = CreateEntity(mathfu::vec3(0.f, 0.f, 0.f));
+  const Entity entity2 = CreateEntity(mathfu::vec3(3.f, 0.f, 0.f));
+  CreateEntity(mathfu::vec3(3.f, 3.f, 0.f));
+
+  // The corner of the third box is ~3.5 away, beyond the radius even though it
+  // is within the sphere's bounding box.
+  std::unordered_set<Entity> entities;
+  spatial_index_->QuerySphere(mathfu::kZeros3f, 3.f,
+                              [&](Entity entity) { entities.insert(entity); });
+  EXPECT_THAT(entities, UnorderedElementsAre(entity1, entity2));
+}
+
+TEST_F(SpatialIndexTest, QueryFrustum) {
+  const Entity in_front = CreateEntity(mathfu::vec3(0.f, 0.f, -5.f));
+  CreateEntity(mathfu::vec3(0.f, 0.f, 5.f));
+  CreateEntity(mathfu::vec3(50.f, 0.f, -5.f));
+
+  // Looking down -z.
+  mathfu::vec4 planes[kNumFrustumPlanes];
+  CalculateViewFrustum(mathfu::mat4::Perspective(1.f, 1.f, 0.1f, 100.f),
+                       planes);
+
+  std::vector<Entity> entities;
+  spatial_index_->QueryFrustum(
+      planes, [&](Entity entity) { entities.push_back(entity); });
+  EXPECT_THAT(entities, ElementsAre(in_front));
+}
+
+TEST_F(SpatialIndexTest, Raycast) {
+  const Entity near_entity = CreateEntity(mathfu::vec3(0.f, 0.f, -2.f));
+  const Entity far_entity = CreateEntity(mathfu::vec3(0.f, 0.f, -6.f));
+  CreateEntity(mathfu::vec3(5.f, 0.f, -2.f));
+
+  std::vector<Entity> entities;
+  spatial_index_->Raycast(Ray(mathfu::kZeros3f, -mathfu::kAxisZ3f),
+                          kMaxDistance, [&](Entity entity) {
+                            entities.push_back(entity);
+                            return kMaxDistance;
+                          });
+  EXPECT_THAT(entities, ElementsAre(near_entity, far_entity));
+}
+
+TEST_F(SpatialIndexTest, FindNearest) {
+  std::vector<Entity> entities;
+  for (int i = 0; i < 10; ++i) {
+    entities.push_back(CreateEntity(mathfu::vec3(2.f * i, 0.f, 0.f)));
+  }
+
+  std::vector<Entity> nearest;
+  spatial_index_->FindNearest(mathfu::vec3(7.1f, 0.f, 0.f), 3, kMaxDistance,
+                              &nearest);
+  EXPECT_THAT(nearest, ElementsAre(entities[4], entities[3], entities[5]));
+
+  spatial_index_->FindNearest(mathfu::vec3(-10.f, 0.f, 0.f), 3, 10.f,
+                              &nearest);
+  EXPECT_THAT(nearest, ElementsAre(entities[0]));
+
+  spatial_index_->FindNearest(mathfu::vec3(-10.f, 0.f, 0.f), 0, kMaxDistance,
+                              &nearest);
+  EXPECT_THAT(nearest, ElementsAre());
+}
+
+}  // namespace
+}  // namespace lull
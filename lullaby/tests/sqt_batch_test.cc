@@ -0,0 +1,135 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/transform/sqt_batch.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/tests/mathfu_matchers.h"
+#include "lullaby/generated/transform_def_generated.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::FloatEq;
+using testing::NearMathfuQuat;
+using testing::NearMathfuVec3;
+static const float kEpsilon = 0.001f;
+
+class SqtBatchTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    registry_.Create<Dispatcher>();
+    auto entity_factory = registry_.Create<EntityFactory>(&registry_);
+    transform_system_ = entity_factory->CreateSystem<TransformSystem>();
+  }
+
+  Entity CreateTransform() {
+    const Entity entity = registry_.Get<EntityFactory>()->Create();
+    TransformDefT transform;
+    Blueprint blueprint(&transform);
+    transform_system_->CreateComponent(entity, blueprint);
+    return entity;
+  }
+
+ protected:
+  Registry registry_;
+  TransformSystem* transform_system_ = nullptr;
+};
+
+TEST_F(SqtBatchTest, SetSqtBatch) {
+  const Entity a = CreateTransform();
+  const Entity b = CreateTransform();
+  const mathfu::quat rotation =
+      mathfu::quat::FromAngleAxis(0.5f, mathfu::vec3(0.f, 1.f, 0.f));
+
+  SqtRecord records[2] = {
+      {a.AsUint32(), {1.f, 2.f, 3.f}, {0.f, 0.f, 0.f, 1.f}, {1.f, 1.f, 1.f}},
+      {b.AsUint32(),
+       {4.f, 5.f, 6.f},
+       {rotation.vector().x, rotation.vector().y, rotation.vector().z,
+        rotation.scalar()},
+       {2.f, 3.f, 4.f}},
+  };
+  SetSqtBatch(transform_system_, records);
+
+  const Sqt* sqt_a = transform_system_->GetSqt(a);
+  ASSERT_TRUE(sqt_a != nullptr);
+  EXPECT_THAT(sqt_a->translation,
+              NearMathfuVec3(mathfu::vec3(1.f, 2.f, 3.f), kEpsilon));
+  EXPECT_THAT(sqt_a->rotation,
+              NearMathfuQuat(mathfu::quat::identity, kEpsilon));
+
+  const Sqt* sqt_b = transform_system_->GetSqt(b);
+  ASSERT_TRUE(sqt_b != nullptr);
+  EXPECT_THAT(sqt_b->translation,
+              NearMathfuVec3(mathfu::vec3(4.f, 5.f, 6.f), kEpsilon));
+  EXPECT_THAT(sqt_b->rotation, NearMathfuQuat(rotation, kEpsilon));
+  EXPECT_THAT(sqt_b->scale,
+              NearMathfuVec3(mathfu::vec3(2.f, 3.f, 4.f), kEpsilon));
+}
+
+TEST_F(SqtBatchTest, GetSqtBatch) {
+  const Entity a = CreateTransform();
+  const Entity missing = registry_.Get<EntityFactory>()->Create();
+  const mathfu::quat rotation =
+      mathfu::quat::FromAngleAxis(0.5f, mathfu::vec3(1.f, 0.f, 0.f));
+  transform_system_->SetSqt(
+      a, Sqt(mathfu::vec3(1.f, 2.f, 3.f), rotation,
+             mathfu::vec3(4.f, 5.f, 6.f)));
+
+  SqtRecord records[2] = {};
+  records[0].entity = a.AsUint32();
+  records[1].entity = missing.AsUint32();
+  records[1].translation[0] = 7.f;
+  EXPECT_THAT(GetSqtBatch(transform_system_, records), Eq(1u));
+
+  EXPECT_THAT(records[0].translation[0], FloatEq(1.f));
+  EXPECT_THAT(records[0].translation[1], FloatEq(2.f));
+  EXPECT_THAT(records[0].translation[2], FloatEq(3.f));
+  EXPECT_THAT(records[0].rotation[0], FloatEq(rotation.vector().x));
+  EXPECT_THAT(records[0].rotation[1], FloatEq(rotation.vector().y));
+  EXPECT_THAT(records[0].rotation[2], FloatEq(rotation.vector().z));
+  EXPECT_THAT(records[0].rotation[3], FloatEq(rotation.scalar()));
+  EXPECT_THAT(records[0].scale[0], FloatEq(4.f));
+  EXPECT_THAT(records[0].scale[1], FloatEq(5.f));
+  EXPECT_THAT(records[0].scale[2], FloatEq(6.f));
+
+  // Records of entities without a transform are left unchanged.
+  EXPECT_THAT(records[1].translation[0], FloatEq(7.f));
+}
+
+TEST_F(SqtBatchTest, RoundTrip) {
+  const Entity a = CreateTransform();
+  SqtRecord record = {a.AsUint32(), {1.f, -2.f, 3.f}, {0.f, 0.f, 0.f, 1.f},
+                      {0.5f, 0.5f, 0.5f}};
+  SetSqtBatch(transform_system_, Span<SqtRecord>(&record, 1));
+
+  SqtRecord result = {};
+  result.entity = a.AsUint32();
+  EXPECT_THAT(
+      GetSqtBatch(transform_system_, MutableSpan<SqtRecord>(&result, 1)),
+      Eq(1u));
+  EXPECT_THAT(result.translation[1], FloatEq(-2.f));
+  EXPECT_THAT(result.rotation[3], FloatEq(1.f));
+  EXPECT_THAT(result.scale[2], FloatEq(0.5f));
+}
+
+}  // namespace
+}  // namespace lull
@@ -18,11 +18,16 @@ limitations under the License.
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "lullaby/generated/collision_def_generated.h"
+#include "lullaby/generated/transform_def_generated.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/blueprint.h"
 #include "lullaby/modules/ecs/entity_factory.h"
 #include "lullaby/modules/input/input_manager.h"
 #include "lullaby/modules/input_processor/input_processor.h"
+#include "lullaby/systems/collision/collision_system.h"
 #include "lullaby/systems/dispatcher/dispatcher_system.h"
+#include "lullaby/systems/render/render_picker.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/math.h"
@@ -197,5 +202,47 @@ TEST_F(StandardInputPipelineTest,
               testing::NearMathfuVec3(kExpectedRayDirection, kDefaultEpsilon));
 }
 
+TEST(StandardInputPipelinePickerTest, CastsRayUntilPickerHasResult) {
+  Registry registry;
+  auto* entity_factory = registry.Create<EntityFactory>(&registry);
+  auto* input = registry.Create<InputManager>();
+  registry.Create<Dispatcher>();
+  entity_factory->CreateSystem<TransformSystem>();
+  entity_factory->CreateSystem<DispatcherSystem>();
+  entity_factory->CreateSystem<CollisionSystem>();
+  entity_factory->CreateSystem<RenderSystem>();
+  registry.Create<InputProcessor>(&registry);
+  auto* input_pipeline = registry.Create<StandardInputPipeline>(&registry);
+  entity_factory->Initialize();
+  auto* picker = registry.Create<RenderPicker>(&registry, "picking");
+
+  Connect6DoFController(input);
+  ASSERT_EQ(input_pipeline->GetPrimaryDevice(), InputManager::kController);
+
+  Blueprint blueprint;
+  {
+    TransformDefT transform;
+    transform.position = mathfu::vec3(0.f, 0.f, -4.f);
+    transform.aabb = Aabb(-mathfu::kOnes3f, mathfu::kOnes3f);
+    CollisionDefT collision;
+    blueprint.Write(&transform);
+    blueprint.Write(&collision);
+  }
+  const Entity entity = entity_factory->Create(&blueprint);
+  picker->AddPickable(entity);
+
+  // Nothing has been read back from the GPU, so the primary device still
+  // hits the Entity through the CollisionSystem.
+  InputFocus focus;
+  focus.device = InputManager::kController;
+  focus.collision_ray = Ray(mathfu::kZeros3f, -mathfu::kAxisZ3f);
+  input_pipeline->ApplyCollisionSystemToInputFocus(&focus);
+  EXPECT_FALSE(picker->GetResult().valid);
+  EXPECT_EQ(focus.target, entity);
+  EXPECT_THAT(focus.cursor_position,
+              testing::NearMathfuVec3(mathfu::vec3(0.f, 0.f, -3.f),
+                                      kDefaultEpsilon));
+}
+
 }  // namespace
 }  // namespace lull
@@ -249,12 +249,90 @@ TEST(StategraphTest, StraightLineWithCyclesAndTwoPaths) {
   EXPECT_TRANSITION(path[1], 1, 4);
 }
 
+TEST(StategraphTest, CompiledMatchesSearch) {
+  // Uses the graph from StraightLineWithCyclesAndTwoPaths, plus a second path
+  // of the same length to [4] to check that ties are broken the same way.
+  auto populate = [](Stategraph* sg) {
+    StategraphPopulator(sg)
+        .AddStates(15)
+        .AddTransition(0, 1)
+        .AddTransition(1, 2)
+        .AddTransition(2, 3)
+        .AddTransition(3, 4)
+        .AddTransition(0, 5)
+        .AddTransition(5, 6)
+        .AddTransition(1, 7)
+        .AddTransition(7, 8)
+        .AddTransition(1, 9)
+        .AddTransition(9, 10)
+        .AddTransition(2, 11)
+        .AddTransition(11, 12)
+        .AddTransition(3, 13)
+        .AddTransition(13, 14)
+        .AddTransition(1, 0)
+        .AddTransition(2, 1)
+        .AddTransition(3, 2)
+        .AddTransition(7, 5)
+        .AddTransition(11, 7)
+        .AddTransition(12, 8)
+        .AddTransition(1, 4)
+        .AddTransition(5, 4);
+  };
+
+  Stategraph searched;
+  populate(&searched);
+  Stategraph compiled;
+  populate(&compiled);
+  compiled.Compile();
+  EXPECT_FALSE(searched.IsCompiled());
+  EXPECT_TRUE(compiled.IsCompiled());
+
+  for (size_t from = 0; from < 15; ++from) {
+    for (size_t to = 0; to < 15; ++to) {
+      const auto expected = searched.FindPath(IndexToId(from), IndexToId(to));
+      const auto actual = compiled.FindPath(IndexToId(from), IndexToId(to));
+      ASSERT_THAT(actual.size(), Eq(expected.size()));
+      for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_THAT(actual[i].from_state, Eq(expected[i].from_state));
+        EXPECT_THAT(actual[i].to_state, Eq(expected[i].to_state));
+      }
+
+      const StategraphTransition* next =
+          compiled.GetNextTransition(IndexToId(from), IndexToId(to));
+      if (expected.empty()) {
+        EXPECT_THAT(next, Eq(nullptr));
+      } else {
+        ASSERT_THAT(next, ::testing::NotNull());
+        EXPECT_THAT(next->to_state, Eq(expected[0].to_state));
+      }
+    }
+  }
+}
+
+TEST(StategraphTest, AddStateDiscardsCompiledTables) {
+  Stategraph sg;
+  StategraphPopulator(&sg).AddStates(2).AddTransition(0, 1);
+  sg.Compile();
+  EXPECT_TRUE(sg.IsCompiled());
+
+  sg.AddState(MakeUnique<TestState>(IndexToId(2)));
+  EXPECT_FALSE(sg.IsCompiled());
+
+  auto path = sg.FindPath(IndexToId(0), IndexToId(1));
+  EXPECT_THAT(path.size(), Eq(size_t(1)));
+  EXPECT_TRANSITION(path[0], 0, 1);
+}
+
 TEST(StategraphDeathTest, InvalidState) {
   Stategraph sg;
   StategraphPopulator(&sg).AddStates(2).AddTransition(0, 1);
 
   PORT_EXPECT_DEBUG_DEATH(sg.FindPath(IndexToId(0), IndexToId(2)), "");
   PORT_EXPECT_DEBUG_DEATH(sg.FindPath(IndexToId(2), IndexToId(0)), "");
+
+  sg.Compile();
+  PORT_EXPECT_DEBUG_DEATH(sg.FindPath(IndexToId(0), IndexToId(2)), "");
+  PORT_EXPECT_DEBUG_DEATH(sg.FindPath(IndexToId(2), IndexToId(0)), "");
 }
 
 }  // namespace
@@ -26,6 +26,16 @@ class StringLocalizer : public StringPreprocessor {
   std::string ProcessString(const std::string& input) override { return input; }
 };
 
+class CountingLocalizer : public StringPreprocessor {
+ public:
+  std::string ProcessString(const std::string& input) override {
+    ++num_calls;
+    return "<" + input + ">";
+  }
+
+  int num_calls = 0;
+};
+
 // NOTE: StringPreprocessor is not actually functional by itself.  This file
 // just tests the prefix processing.
 TEST(SringPreprocessorTest, Localized) {
@@ -75,5 +85,31 @@ TEST(SringPreprocessorTest, Empty) {
   EXPECT_EQ(StringPreprocessor::kNoPrefix, result.mode);
 }
 
+TEST(SringPreprocessorTest, CachingDisabledByDefault) {
+  CountingLocalizer localizer;
+  EXPECT_EQ("<a>", localizer.ProcessStringCached("a"));
+  EXPECT_EQ("<a>", localizer.ProcessStringCached("a"));
+  EXPECT_EQ(2, localizer.num_calls);
+  EXPECT_EQ(0u, localizer.GetCacheSize());
+}
+
+TEST(SringPreprocessorTest, Caching) {
+  CountingLocalizer localizer;
+  localizer.SetCachingEnabled(true);
+
+  EXPECT_EQ("<a>", localizer.ProcessStringCached("a"));
+  EXPECT_EQ("<b>", localizer.ProcessStringCached("b"));
+  EXPECT_EQ("<a>", localizer.ProcessStringCached("a"));
+  EXPECT_EQ(2, localizer.num_calls);
+  EXPECT_EQ(2u, localizer.GetCacheSize());
+
+  localizer.ClearCache();
+  EXPECT_EQ("<a>", localizer.ProcessStringCached("a"));
+  EXPECT_EQ(3, localizer.num_calls);
+
+  localizer.SetCachingEnabled(false);
+  EXPECT_EQ(0u, localizer.GetCacheSize());
+}
+
 }  // namespace
 }  // namespace lull
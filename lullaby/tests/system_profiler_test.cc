@@ -0,0 +1,115 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/ecs/system_profiler.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/modules/ecs/system.h"
+
+namespace lull {
+namespace {
+
+class ProfiledSystem : public System {
+ public:
+  explicit ProfiledSystem(Registry* registry) : System(registry) {}
+
+  void AdvanceFrame(int num_allocations) {
+    SystemProfiler::ScopedSample sample(registry_, this);
+    for (int i = 0; i < num_allocations; ++i) {
+      allocations_.emplace_back(new int(i));
+    }
+  }
+
+  size_t GetNumComponents() const override { return 3; }
+  size_t GetComponentMemoryUsage() const override { return 128; }
+
+ private:
+  std::vector<std::unique_ptr<int>> allocations_;
+};
+
+}  // namespace
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::ProfiledSystem);
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Ge;
+using ::testing::IsNull;
+using ::testing::NotNull;
+
+class SystemProfilerTest : public ::testing::Test {
+ protected:
+  SystemProfilerTest() {
+    auto* entity_factory = registry_.Create<EntityFactory>(&registry_);
+    system_ = entity_factory->CreateSystem<ProfiledSystem>();
+  }
+
+  Registry registry_;
+  ProfiledSystem* system_ = nullptr;
+};
+
+TEST_F(SystemProfilerTest, DisabledWithoutProfiler) {
+  system_->AdvanceFrame(1);
+  EXPECT_THAT(registry_.Get<SystemProfiler>(), IsNull());
+}
+
+TEST_F(SystemProfilerTest, RecordsSamples) {
+  auto* profiler = registry_.Create<SystemProfiler>(&registry_);
+  system_->AdvanceFrame(0);
+  system_->AdvanceFrame(0);
+
+  const SystemProfiler::Stats* stats = profiler->GetStats<ProfiledSystem>();
+  ASSERT_THAT(stats, NotNull());
+  EXPECT_THAT(stats->num_samples, Eq(2u));
+  EXPECT_THAT(stats->name, Eq("lull::ProfiledSystem"));
+  EXPECT_THAT(stats->max_time, Ge(stats->last_time));
+  EXPECT_THAT(stats->total_time, Ge(stats->max_time));
+
+  profiler->Reset();
+  EXPECT_THAT(profiler->GetStats<ProfiledSystem>(), IsNull());
+}
+
+TEST_F(SystemProfilerTest, CountsAllocations) {
+  auto* profiler = registry_.Create<SystemProfiler>(&registry_);
+  system_->AdvanceFrame(4);
+
+  const SystemProfiler::Stats* stats = profiler->GetStats<ProfiledSystem>();
+  ASSERT_THAT(stats, NotNull());
+  EXPECT_THAT(stats->last_allocations, Ge(4u));
+  EXPECT_THAT(stats->total_allocations, Eq(stats->last_allocations));
+}
+
+TEST_F(SystemProfilerTest, UpdateComponentStats) {
+  auto* profiler = registry_.Create<SystemProfiler>(&registry_);
+  profiler->UpdateComponentStats();
+
+  const auto all_stats = profiler->GetAllStats();
+  ASSERT_THAT(all_stats.size(), Eq(1u));
+  EXPECT_THAT(all_stats[0].system, Eq(GetTypeId<ProfiledSystem>()));
+  EXPECT_THAT(all_stats[0].num_samples, Eq(0u));
+  EXPECT_THAT(all_stats[0].num_components, Eq(3u));
+  EXPECT_THAT(all_stats[0].component_memory_usage, Eq(128u));
+}
+
+}  // namespace
+}  // namespace lull
@@ -17,8 +17,10 @@ limitations under the License.
 #include "lullaby/modules/file/tagged_file_loader.h"
 
 #include "gtest/gtest.h"
+#include "lullaby/modules/file/pack_file.h"
 #include "lullaby/modules/file/test/mock_tagged_file_loader.h"
 #include "lullaby/tests/portable_test_macros.h"
+#include "lullaby/tools/compile_pack_file/pack_file_builder.h"
 
 namespace lull {
 namespace {
@@ -215,6 +217,43 @@ TEST(TaggedFileLoaderTest, FailToLoad) {
   EXPECT_FALSE(res);
 }
 
+TEST(TaggedFileLoaderTest, PackFile) {
+  tool::PackFileBuilder builder;
+  builder.AddEntry("file.txt", "packed", false);
+  builder.AddEntry("dir/other.txt", "packed other", true);
+  std::shared_ptr<const PackFile> pack =
+      PackFile::Open(MappedFile::FromString(builder.Build()));
+  ASSERT_NE(nullptr, pack);
+
+  MockTaggedFileLoader loader;
+  loader.RegisterTag("foo", "bar/");
+  loader.RegisterPackFile("foo", pack);
+  loader.RegisterPackFile("packed", pack);
+  TaggedFileLoader::SetTaggedFileLoader(&loader);
+
+  std::string last_mock_filename;
+  loader.SetMockLoadFn(
+      [&](const char* filename, std::string* dest, const std::string& tag) {
+        last_mock_filename = filename;
+        *dest = "loose";
+        return true;
+      });
+
+  std::string data;
+  EXPECT_TRUE(TaggedFileLoader::LoadTaggedFile("foo:file.txt", &data));
+  EXPECT_EQ("packed", data);
+  EXPECT_TRUE(TaggedFileLoader::LoadTaggedFile("packed:dir/other.txt", &data));
+  EXPECT_EQ("packed other", data);
+  EXPECT_EQ("", last_mock_filename);
+
+  // Files missing from the pack are loaded as usual.
+  EXPECT_TRUE(TaggedFileLoader::LoadTaggedFile("foo:missing.txt", &data));
+  EXPECT_EQ("loose", data);
+  EXPECT_EQ("bar/missing.txt", last_mock_filename);
+  EXPECT_TRUE(TaggedFileLoader::LoadTaggedFile("packed:missing.txt", &data));
+  EXPECT_EQ("missing.txt", last_mock_filename);
+}
+
 TEST(TaggedFileLoaderDeathTest, NoGlobal) {
   PORT_EXPECT_DEBUG_DEATH(TaggedFileLoader::LoadTaggedFile("file.txt", nullptr),
                           "");
@@ -0,0 +1,92 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/render/tangent_cache.h"
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+// vec3 position, vec3 normal, vec2 texcoord
+const float kVertices[] = {
+    0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1, 0,
+    0, 1, 0, 0, 0, 1, 0, 1, 1, 1, 0, 0, 0, 1, 1, 1,
+};
+const uint16_t kIndices[] = {0, 1, 2, 2, 1, 3};
+constexpr size_t kVertexStride = sizeof(float) * (3 + 3 + 2);
+
+HashValue GetQuadKey(const float* vertices, const uint16_t* indices) {
+  return TangentCache::GetKey(
+      reinterpret_cast<const uint8_t*>(vertices), kVertexStride,
+      reinterpret_cast<const uint8_t*>(vertices + 3), kVertexStride,
+      reinterpret_cast<const uint8_t*>(vertices + 3 + 3), kVertexStride, 4,
+      reinterpret_cast<const uint8_t*>(indices), sizeof(indices[0]), 2);
+}
+
+TEST(TangentCache, KeyDependsOnContent) {
+  const HashValue key = GetQuadKey(kVertices, kIndices);
+  EXPECT_EQ(key, GetQuadKey(kVertices, kIndices));
+
+  float vertices[sizeof(kVertices) / sizeof(kVertices[0])];
+  memcpy(vertices, kVertices, sizeof(kVertices));
+  vertices[6] = 0.5f;
+  EXPECT_NE(key, GetQuadKey(vertices, kIndices));
+
+  const uint16_t indices[] = {0, 1, 2, 1, 2, 3};
+  EXPECT_NE(key, GetQuadKey(kVertices, indices));
+}
+
+TEST(TangentCache, SaveAndLoad) {
+  TangentCache cache(::testing::TempDir());
+  const HashValue key = GetQuadKey(kVertices, kIndices);
+
+  // vec4 tangent, vec3 bitangent
+  float saved[4 * (4 + 3)];
+  for (size_t i = 0; i < sizeof(saved) / sizeof(saved[0]); ++i) {
+    saved[i] = static_cast<float>(i);
+  }
+  const size_t stride = sizeof(float) * (4 + 3);
+  cache.Save(key, 4, reinterpret_cast<const uint8_t*>(saved), stride);
+
+  float loaded[4 * 4] = {0};
+  EXPECT_TRUE(cache.Load(key, 4, reinterpret_cast<uint8_t*>(loaded),
+                         sizeof(float) * 4));
+  for (size_t i = 0; i < 4; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      EXPECT_EQ(loaded[i * 4 + j], saved[i * (4 + 3) + j]);
+    }
+  }
+
+  // A different vertex count is treated as a stale entry.
+  EXPECT_FALSE(cache.Load(key, 3, reinterpret_cast<uint8_t*>(loaded),
+                          sizeof(float) * 4));
+  EXPECT_FALSE(cache.Load(key, 4, reinterpret_cast<uint8_t*>(loaded),
+                          sizeof(float) * 4));
+}
+
+TEST(TangentCache, LoadMissing) {
+  TangentCache cache(::testing::TempDir());
+  float tangents[4] = {1, 2, 3, 4};
+  EXPECT_FALSE(cache.Load(0x1234, 1, reinterpret_cast<uint8_t*>(tangents),
+                          sizeof(tangents)));
+  EXPECT_EQ(tangents[0], 1.f);
+}
+
+}  // namespace
+}  // namespace lull
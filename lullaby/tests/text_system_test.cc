@@ -16,11 +16,16 @@ limitations under the License.
 
 #include "lullaby/systems/text/text_system.h"
 
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/ecs/entity_factory.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/render/testing/mock_render_system_impl.h"
+#include "lullaby/systems/text/flatui/flatui_text_system.h"
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/registry.h"
 #include "lullaby/generated/text_def_generated.h"
@@ -29,7 +34,9 @@ limitations under the License.
 namespace lull {
 namespace {
 
+using ::testing::Eq;
 using ::testing::IsNull;
+using ::testing::NotNull;
 
 class TextSystemTest : public testing::Test {
  public:
@@ -65,6 +72,37 @@ TEST_F(TextSystemTest, UnknownEntityHasNoData) {
   EXPECT_THAT(text_system_->GetCaretPositions(entity), IsNull());
 }
 
+TEST_F(TextSystemTest, CoalescesUpdatesAcrossWorkerThreads) {
+  constexpr int kNumEntities = 16;
+  constexpr int kNumUpdates = 20;
+  auto* impl = static_cast<FlatuiTextSystem*>(text_system_->GetImpl());
+  impl->SetNumWorkerThreads(4);
+
+  std::vector<Entity> entities;
+  for (int i = 0; i < kNumEntities; ++i) {
+    const Entity entity = entity_factory_->Create();
+    text_system_->CreateEmpty(entity);
+    entities.push_back(entity);
+  }
+
+  // Each entity keeps at most one task, so updates made while a task is
+  // running must be applied once it completes rather than being dropped.
+  // No font is loaded, so the tasks produce no text buffers.
+  for (int i = 0; i < kNumUpdates; ++i) {
+    for (Entity entity : entities) {
+      text_system_->SetText(entity, "update " + std::to_string(i));
+    }
+    text_system_->ProcessTasks();
+  }
+  text_system_->WaitForAllTasks();
+
+  const std::string last = "update " + std::to_string(kNumUpdates - 1);
+  for (Entity entity : entities) {
+    ASSERT_THAT(text_system_->GetRenderedText(entity), NotNull());
+    EXPECT_THAT(*text_system_->GetRenderedText(entity), Eq(last));
+  }
+}
+
 // TODO Write more tests.
 
 }  // namespace
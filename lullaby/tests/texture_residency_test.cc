@@ -0,0 +1,253 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/texture_residency.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::IsEmpty;
+
+constexpr int kSize = 256;
+constexpr int kNumLevels = 9;
+constexpr size_t kBytesPerTexel = 4;
+
+size_t GetBytes(int level) {
+  return TextureResidency::CalculateBytes(mathfu::vec2i(kSize, kSize),
+                                          kBytesPerTexel, kNumLevels, level);
+}
+
+TextureResidency::Params GetParams() {
+  TextureResidency::Params params;
+  params.budget_bytes = 4 * GetBytes(0);
+  params.unused_frames = 2;
+  params.unused_max_size = 64;
+  params.hysteresis_levels = 1;
+  params.max_restreams_per_frame = 2;
+  return params;
+}
+
+TextureResidency::TextureId AddTexture(TextureResidency* residency) {
+  const TextureResidency::TextureId id = residency->Add(
+      mathfu::vec2i(kSize, kSize), kBytesPerTexel, kNumLevels);
+  residency->SetResidentLevel(id, residency->GetResidentLevel(id));
+  return id;
+}
+
+TEST(TextureResidencyTest, CalculateBytes) {
+  EXPECT_THAT(TextureResidency::CountMipLevels(mathfu::vec2i(4, 2)), Eq(3));
+  EXPECT_THAT(TextureResidency::CountMipLevels(mathfu::vec2i(1, 1)), Eq(1));
+  EXPECT_THAT(TextureResidency::CountMipLevels(mathfu::vec2i(256, 256)),
+              Eq(kNumLevels));
+
+  // 4x2 + 2x1 + 1x1 texels.
+  EXPECT_THAT(TextureResidency::CalculateBytes(mathfu::vec2i(4, 2), 1, 3, 0),
+              Eq(11u));
+  EXPECT_THAT(TextureResidency::CalculateBytes(mathfu::vec2i(4, 2), 1, 3, 1),
+              Eq(3u));
+  EXPECT_THAT(TextureResidency::CalculateBytes(mathfu::vec2i(4, 2), 3, 1, 0),
+              Eq(24u));
+}
+
+TEST(TextureResidencyTest, AddsTexturesWithinBudget) {
+  TextureResidency::Params params = GetParams();
+  params.budget_bytes = GetBytes(0) + GetBytes(2);
+  TextureResidency residency(params);
+
+  const auto first = residency.Add(mathfu::vec2i(kSize, kSize),
+                                   kBytesPerTexel, kNumLevels);
+  EXPECT_THAT(residency.GetResidentLevel(first), Eq(0));
+  EXPECT_TRUE(residency.IsStreaming(first));
+
+  // Only the mips from level 2 down fit in the remaining budget.
+  const auto second = residency.Add(mathfu::vec2i(kSize, kSize),
+                                    kBytesPerTexel, kNumLevels);
+  EXPECT_THAT(residency.GetResidentLevel(second), Eq(2));
+  EXPECT_THAT(residency.GetResidentBytes(second), Eq(GetBytes(2)));
+  EXPECT_THAT(residency.GetTotalResidentBytes(),
+              Eq(GetBytes(0) + GetBytes(2)));
+
+  residency.SetResidentLevel(first, 0);
+  EXPECT_FALSE(residency.IsStreaming(first));
+
+  residency.Remove(first);
+  EXPECT_THAT(residency.GetResidentLevel(first), Eq(-1));
+  EXPECT_THAT(residency.GetTotalResidentBytes(), Eq(GetBytes(2)));
+}
+
+TEST(TextureResidencyTest, TrimsTexturesSmallOnScreen) {
+  TextureResidency residency(GetParams());
+  const auto id = AddTexture(&residency);
+  std::vector<TextureResidency::LevelChange> trims;
+  std::vector<TextureResidency::LevelChange> restreams;
+
+  // Within the hysteresis, nothing changes.
+  residency.RequestScreenSize(id, 128.f);
+  residency.Update(&trims, &restreams);
+  EXPECT_THAT(trims, IsEmpty());
+  EXPECT_THAT(restreams, IsEmpty());
+
+  // Level 3 is enough, so the texture keeps one extra level.
+  residency.RequestScreenSize(id, 32.f);
+  residency.Update(&trims, &restreams);
+  ASSERT_THAT(trims.size(), Eq(1u));
+  EXPECT_THAT(trims[0].id, Eq(id));
+  EXPECT_THAT(trims[0].level, Eq(2));
+  EXPECT_THAT(restreams, IsEmpty());
+  EXPECT_THAT(residency.GetResidentLevel(id), Eq(2));
+  EXPECT_THAT(residency.GetResidentBytes(id), Eq(GetBytes(2)));
+}
+
+TEST(TextureResidencyTest, RestreamsTexturesLargeOnScreen) {
+  TextureResidency residency(GetParams());
+  const auto id = AddTexture(&residency);
+  std::vector<TextureResidency::LevelChange> trims;
+  std::vector<TextureResidency::LevelChange> restreams;
+
+  residency.RequestScreenSize(id, 16.f);
+  residency.Update(&trims, &restreams);
+  EXPECT_THAT(residency.GetResidentLevel(id), Eq(3));
+
+  // The largest of the requested sizes is used.
+  residency.RequestScreenSize(id, 16.f);
+  residency.RequestScreenSize(id, 1000.f);
+  residency.Update(&trims, &restreams);
+  EXPECT_THAT(trims, IsEmpty());
+  ASSERT_THAT(restreams.size(), Eq(1u));
+  EXPECT_THAT(restreams[0].id, Eq(id));
+  EXPECT_THAT(restreams[0].level, Eq(0));
+  EXPECT_TRUE(residency.IsStreaming(id));
+
+  // Streaming textures are left alone.
+  residency.RequestScreenSize(id, 16.f);
+  residency.Update(&trims, &restreams);
+  EXPECT_THAT(trims, IsEmpty());
+  EXPECT_THAT(restreams, IsEmpty());
+
+  residency.SetResidentLevel(id, 0);
+  EXPECT_FALSE(residency.IsStreaming(id));
+  EXPECT_THAT(residency.GetResidentBytes(id), Eq(GetBytes(0)));
+}
+
+TEST(TextureResidencyTest, ReducesUnusedTextures) {
+  TextureResidency residency(GetParams());
+  const auto used = AddTexture(&residency);
+  const auto unused = AddTexture(&residency);
+  std::vector<TextureResidency::LevelChange> trims;
+  std::vector<TextureResidency::LevelChange> restreams;
+
+  for (int i = 0; i < 2; ++i) {
+    residency.RequestScreenSize(used, 1000.f);
+    residency.Update(&trims, &restreams);
+    EXPECT_THAT(trims, IsEmpty());
+  }
+
+  // The unused texture keeps the mips no larger than 64x64.
+  residency.RequestScreenSize(used, 1000.f);
+  residency.Update(&trims, &restreams);
+  ASSERT_THAT(trims.size(), Eq(1u));
+  EXPECT_THAT(trims[0].id, Eq(unused));
+  EXPECT_THAT(trims[0].level, Eq(2));
+  EXPECT_THAT(residency.GetResidentLevel(used), Eq(0));
+}
+
+TEST(TextureResidencyTest, EvictsLeastRecentlyUsedToMakeRoom) {
+  TextureResidency::Params params = GetParams();
+  params.budget_bytes = 2 * GetBytes(0) + GetBytes(kNumLevels - 1);
+  params.unused_frames = 100;
+  TextureResidency residency(params);
+  std::vector<TextureResidency::LevelChange> trims;
+  std::vector<TextureResidency::LevelChange> restreams;
+
+  const auto older = AddTexture(&residency);
+  const auto newer = AddTexture(&residency);
+  residency.RequestScreenSize(older, 1000.f);
+  residency.RequestScreenSize(newer, 1000.f);
+  residency.Update(&trims, &restreams);
+
+  residency.RequestScreenSize(newer, 1000.f);
+  residency.Update(&trims, &restreams);
+
+  // Streaming in the third texture requires dropping mips from the texture
+  // that was drawn least recently.
+  const auto third = residency.Add(mathfu::vec2i(kSize, kSize),
+                                   kBytesPerTexel, kNumLevels);
+  EXPECT_THAT(residency.GetResidentLevel(third), Eq(kNumLevels - 1));
+  residency.SetResidentLevel(third, kNumLevels - 1);
+
+  residency.RequestScreenSize(newer, 1000.f);
+  residency.RequestScreenSize(third, 1000.f);
+  residency.Update(&trims, &restreams);
+  ASSERT_THAT(restreams.size(), Eq(1u));
+  EXPECT_THAT(restreams[0].id, Eq(third));
+  EXPECT_THAT(restreams[0].level, Eq(0));
+  ASSERT_THAT(trims.size(), Eq(1u));
+  EXPECT_THAT(trims[0].id, Eq(older));
+  EXPECT_THAT(residency.GetResidentLevel(newer), Eq(0));
+  EXPECT_LE(residency.GetTotalResidentBytes(), params.budget_bytes);
+}
+
+TEST(TextureResidencyTest, SettlesForLessDetailWhenFull) {
+  TextureResidency::Params params = GetParams();
+  params.budget_bytes = GetBytes(0) + GetBytes(1);
+  TextureResidency residency(params);
+  std::vector<TextureResidency::LevelChange> trims;
+  std::vector<TextureResidency::LevelChange> restreams;
+
+  const auto first = AddTexture(&residency);
+  const auto second = residency.Add(mathfu::vec2i(kSize, kSize),
+                                    kBytesPerTexel, kNumLevels);
+  residency.SetResidentLevel(second, kNumLevels - 1);
+
+  // Both textures are drawn, so neither gives up detail for the other and the
+  // second texture only gets the detail that fits.
+  residency.RequestScreenSize(first, 1000.f);
+  residency.RequestScreenSize(second, 1000.f);
+  residency.Update(&trims, &restreams);
+  EXPECT_THAT(trims, IsEmpty());
+  ASSERT_THAT(restreams.size(), Eq(1u));
+  EXPECT_THAT(restreams[0].id, Eq(second));
+  EXPECT_THAT(restreams[0].level, Eq(1));
+  EXPECT_THAT(residency.GetResidentLevel(first), Eq(0));
+}
+
+TEST(TextureResidencyTest, ReducesTexturesInUseWhenOverBudget) {
+  TextureResidency residency(GetParams());
+  std::vector<TextureResidency::LevelChange> trims;
+  std::vector<TextureResidency::LevelChange> restreams;
+
+  const auto near = AddTexture(&residency);
+  const auto far = AddTexture(&residency);
+
+  // Shrinking the budget reduces the texture needing the least detail first.
+  TextureResidency::Params params = GetParams();
+  params.budget_bytes = GetBytes(0) + GetBytes(2);
+  residency.SetParams(params);
+  residency.RequestScreenSize(near, 1000.f);
+  residency.RequestScreenSize(far, 100.f);
+  residency.Update(&trims, &restreams);
+  ASSERT_THAT(trims.size(), Eq(1u));
+  EXPECT_THAT(trims[0].id, Eq(far));
+  EXPECT_THAT(trims[0].level, Eq(2));
+  EXPECT_THAT(residency.GetResidentLevel(near), Eq(0));
+}
+
+}  // namespace
+}  // namespace lull
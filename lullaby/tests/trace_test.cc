@@ -0,0 +1,131 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#undef LULLABY_ENABLE_TRACING
+#define LULLABY_ENABLE_TRACING 1
+
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "lullaby/util/trace.h"
+
+namespace lull {
+namespace {
+
+size_t CountOccurrences(const std::string& str, const std::string& substr) {
+  size_t count = 0;
+  for (size_t pos = str.find(substr); pos != std::string::npos;
+       pos = str.find(substr, pos + substr.size())) {
+    ++count;
+  }
+  return count;
+}
+
+void TracedFunction() { LULLABY_CPU_TRACE_CALL(); }
+
+TEST(Trace, NotTracing) {
+  StopTracing();
+  EXPECT_FALSE(IsTracing());
+  StartTracing();
+  StopTracing();
+  {
+    LULLABY_CPU_TRACE("Ignored");
+  }
+  EXPECT_EQ("{\"traceEvents\":[]}", GetChromeTraceJson());
+}
+
+TEST(Trace, Scopes) {
+  StartTracing();
+  EXPECT_TRUE(IsTracing());
+  {
+    LULLABY_CPU_TRACE("Outer");
+    TracedFunction();
+    LULLABY_CPU_TRACE_FORMAT("Inner %d", 7);
+    LULLABY_CPU_TRACE_INT("Counter", 42);
+  }
+  StopTracing();
+
+  const std::string json = GetChromeTraceJson();
+  EXPECT_EQ(0u,
+            json.find("{\"traceEvents\":[{\"name\":\"Outer\",\"ph\":\"B\""));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"TracedFunction\""));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"Inner 7\""));
+  EXPECT_NE(std::string::npos, json.find("\"args\":{\"value\":42}"));
+  EXPECT_EQ(3u, CountOccurrences(json, "\"ph\":\"B\""));
+  EXPECT_EQ(3u, CountOccurrences(json, "\"ph\":\"E\""));
+  EXPECT_EQ(1u, CountOccurrences(json, "\"ph\":\"C\""));
+}
+
+TEST(Trace, EscapesNames) {
+  StartTracing();
+  {
+    LULLABY_CPU_TRACE("Quote\"Slash\\");
+  }
+  StopTracing();
+
+  const std::string json = GetChromeTraceJson();
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"Quote\\\"Slash\\\\\""));
+}
+
+TEST(Trace, EndsScopesAfterStop) {
+  StartTracing();
+  {
+    LULLABY_CPU_TRACE("Scope");
+    StopTracing();
+  }
+
+  const std::string json = GetChromeTraceJson();
+  EXPECT_EQ(1u, CountOccurrences(json, "\"ph\":\"B\""));
+  EXPECT_EQ(1u, CountOccurrences(json, "\"ph\":\"E\""));
+}
+
+TEST(Trace, DropsEventsWhenFull) {
+  StartTracing(5);
+  {
+    LULLABY_CPU_TRACE("A");
+    {
+      LULLABY_CPU_TRACE("B");
+      // There is only room for the ends of A and B, so these are dropped.
+      LULLABY_CPU_TRACE("C");
+      LULLABY_CPU_TRACE_INT("Counter", 1);
+    }
+  }
+  StopTracing();
+
+  const std::string json = GetChromeTraceJson();
+  EXPECT_EQ(2u, CountOccurrences(json, "\"ph\":\"B\""));
+  EXPECT_EQ(2u, CountOccurrences(json, "\"ph\":\"E\""));
+  EXPECT_EQ(std::string::npos, json.find("\"name\":\"C\""));
+}
+
+TEST(Trace, MultipleThreads) {
+  StartTracing();
+  std::thread thread([]() { LULLABY_CPU_TRACE("Worker"); });
+  thread.join();
+  {
+    LULLABY_CPU_TRACE("Main");
+  }
+  StopTracing();
+
+  const std::string json = GetChromeTraceJson();
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"Worker\""));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"Main\""));
+  EXPECT_EQ(2u, CountOccurrences(json, "\"ph\":\"E\""));
+}
+
+}  // namespace
+}  // namespace lull
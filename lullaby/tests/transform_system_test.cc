@@ -14,7 +14,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <cmath>
 #include <deque>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "gmock/gmock.h"
@@ -25,12 +27,16 @@ limitations under the License.
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/tests/mathfu_matchers.h"
 #include "lullaby/tests/portable_test_macros.h"
+#include "lullaby/util/job_processor.h"
 #include "lullaby/generated/transform_def_generated.h"
 
 namespace lull {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::Eq;
+using ::testing::FloatEq;
+using ::testing::IsEmpty;
 using ::testing::IsNull;
 using ::testing::NotNull;
 using testing::EqualsMathfuVec3;
@@ -212,6 +218,25 @@ TEST_F(TransformSystemTest, CreatePositionRotationScale) {
   EXPECT_THAT(sqt->scale, EqualsMathfuVec3({1.f, 1.f, 1.f}));
 }
 
+TEST_F(TransformSystemTest, CreateMany) {
+  auto* transform_system = registry_.Get<TransformSystem>();
+
+  TransformDefT transform;
+  transform.position = mathfu::vec3(1.f, 2.f, 3.f);
+  transform.scale = mathfu::vec3(1.f, 1.f, 1.f);
+  Blueprint blueprint(&transform);
+
+  const std::vector<Entity> entities = {1, 2, 3};
+  transform_system->CreateMany(entities, blueprint);
+  transform_system->PostCreateMany(entities, blueprint);
+
+  for (const Entity entity : entities) {
+    const Sqt* sqt = transform_system->GetSqt(entity);
+    ASSERT_THAT(sqt, NotNull());
+    EXPECT_THAT(sqt->translation, EqualsMathfuVec3({1.f, 2.f, 3.f}));
+  }
+}
+
 TEST_F(TransformSystemTest, CreatePositionQuaternionScale) {
   auto* transform_system = registry_.Get<TransformSystem>();
 
@@ -965,6 +990,41 @@ TEST_F(TransformSystemTest, ForAll) {
   EXPECT_THAT(seen, Eq(std::unordered_set<Entity>{1, 3}));
 }
 
+TEST_F(TransformSystemTest, ForAllDepthOrder) {
+  CreateDefaultTransform(1);
+  CreateDefaultTransform(2);
+  CreateDefaultTransform(3);
+  CreateDefaultTransform(4);
+
+  auto* transform_system = registry_.Get<TransformSystem>();
+  transform_system->AddChild(3, 2);
+  transform_system->AddChild(2, 1);
+  transform_system->AddChild(4, 3);
+
+  std::vector<Entity> order;
+  auto fn = [&](Entity entity, const mathfu::mat4& matrix, const Aabb& aabb,
+                uint32_t flags) { order.emplace_back(entity); };
+  transform_system->ForAll(fn);
+  EXPECT_THAT(order, Eq(std::vector<Entity>{4, 3, 2, 1}));
+  order.clear();
+
+  // Changes that do not modify the hierarchy should still be visible.
+  transform_system->Disable(2);
+  transform_system->ForAll(fn);
+  EXPECT_THAT(order, Eq(std::vector<Entity>{4, 3}));
+  order.clear();
+
+  transform_system->Enable(2);
+  transform_system->SetLocalTranslation(4, mathfu::vec3(1.f, 2.f, 3.f));
+  transform_system->ForAll([&](Entity entity, const mathfu::mat4& matrix,
+                               const Aabb& aabb, uint32_t flags) {
+    EXPECT_THAT(matrix.TranslationVector3D(),
+                NearMathfuVec3(mathfu::vec3(1.f, 2.f, 3.f), kEpsilon));
+    order.emplace_back(entity);
+  });
+  EXPECT_THAT(order, Eq(std::vector<Entity>{4, 3, 2, 1}));
+}
+
 TEST_F(TransformSystemTest, ForEach) {
   CreateDefaultTransform(1);
   CreateDefaultTransform(2);
@@ -1009,6 +1069,48 @@ TEST_F(TransformSystemTest, ForEachFiltered) {
   EXPECT_THAT(seen, Eq(std::unordered_set<Entity>{1}));
 }
 
+TEST_F(TransformSystemTest, ForEachWithBoundingSphere) {
+  auto* transform_system = registry_.Get<TransformSystem>();
+  CreateDefaultTransform(1);
+  CreateDefaultTransform(2);
+  transform_system->SetAabb(1, Aabb(mathfu::vec3(-1.f, -1.f, -1.f),
+                                    mathfu::vec3(1.f, 1.f, 1.f)));
+  transform_system->SetAabb(2, Aabb(mathfu::vec3(0.f, 0.f, 0.f),
+                                    mathfu::vec3(2.f, 0.f, 0.f)));
+
+  std::unordered_map<Entity, mathfu::vec4> spheres;
+  auto fn = [&](Entity entity, const mathfu::mat4& matrix, const Aabb& aabb,
+                const mathfu::vec4& sphere) { spheres[entity] = sphere; };
+
+  transform_system->ForEachWithBoundingSphere(TransformSystem::kAllFlags, fn);
+  EXPECT_THAT(spheres.size(), Eq(size_t(2)));
+  EXPECT_THAT(spheres[1].xyz(), EqualsMathfuVec3(mathfu::kZeros3f));
+  EXPECT_THAT(spheres[1].w, FloatEq(std::sqrt(3.f)));
+  EXPECT_THAT(spheres[2].xyz(), EqualsMathfuVec3({1.f, 0.f, 0.f}));
+  EXPECT_THAT(spheres[2].w, FloatEq(1.f));
+
+  // The cached spheres must be updated when the transform or aabb changes.
+  Sqt sqt;
+  sqt.translation = mathfu::vec3(0.f, 5.f, 0.f);
+  transform_system->SetSqt(1, sqt);
+  transform_system->SetAabb(2, Aabb(mathfu::vec3(0.f, 0.f, 0.f),
+                                    mathfu::vec3(4.f, 0.f, 0.f)));
+  spheres.clear();
+  transform_system->ForEachWithBoundingSphere(TransformSystem::kAllFlags, fn);
+  EXPECT_THAT(spheres[1].xyz(), EqualsMathfuVec3({0.f, 5.f, 0.f}));
+  EXPECT_THAT(spheres[1].w, FloatEq(std::sqrt(3.f)));
+  EXPECT_THAT(spheres[2].xyz(), EqualsMathfuVec3({2.f, 0.f, 0.f}));
+  EXPECT_THAT(spheres[2].w, FloatEq(2.f));
+
+  // Only entities with the flag are visited.
+  const TransformSystem::TransformFlags flag = transform_system->RequestFlag();
+  transform_system->SetFlag(2, flag);
+  spheres.clear();
+  transform_system->ForEachWithBoundingSphere(flag, fn);
+  EXPECT_THAT(spheres.size(), Eq(size_t(1)));
+  EXPECT_THAT(spheres.count(2), Eq(size_t(1)));
+}
+
 TEST_F(TransformSystemTest, ForAllDescendants) {
   CreateDefaultTransform(1);
   CreateDefaultTransform(2);
@@ -1038,6 +1140,82 @@ TEST_F(TransformSystemTest, ForAllDescendants) {
   EXPECT_THAT(seen, Eq(std::unordered_set<Entity>{1, 2, 3}));
 }
 
+TEST_F(TransformSystemTest, DeferredUpdates) {
+  CreateDefaultTransform(1);
+  CreateDefaultTransform(2);
+  CreateDefaultTransform(3);
+
+  auto* transform_system = registry_.Get<TransformSystem>();
+  transform_system->AddChild(1, 2);
+  transform_system->AddChild(2, 3);
+
+  transform_system->SetDeferredUpdates(true);
+  EXPECT_TRUE(transform_system->AreUpdatesDeferred());
+
+  transform_system->SetLocalTranslation(1, mathfu::vec3(1.f, 0.f, 0.f));
+  transform_system->SetLocalTranslation(2, mathfu::vec3(2.f, 0.f, 0.f));
+  transform_system->SetLocalTranslation(3, mathfu::vec3(3.f, 0.f, 0.f));
+
+  // World transforms should not change until the system is flushed.
+  EXPECT_NEAR((*transform_system->GetWorldFromEntityMatrix(1))(0, 3), 0.f,
+              kEpsilon);
+  EXPECT_NEAR((*transform_system->GetWorldFromEntityMatrix(3))(0, 3), 0.f,
+              kEpsilon);
+
+  transform_system->Flush();
+  EXPECT_NEAR((*transform_system->GetWorldFromEntityMatrix(1))(0, 3), 1.f,
+              kEpsilon);
+  EXPECT_NEAR((*transform_system->GetWorldFromEntityMatrix(2))(0, 3), 3.f,
+              kEpsilon);
+  EXPECT_NEAR((*transform_system->GetWorldFromEntityMatrix(3))(0, 3), 6.f,
+              kEpsilon);
+
+  // Setting a world matrix should account for pending changes to the parent.
+  transform_system->SetLocalTranslation(1, mathfu::vec3(2.f, 0.f, 0.f));
+  transform_system->SetWorldFromEntityMatrix(
+      3, mathfu::mat4::FromTranslationVector(mathfu::vec3(10.f, 0.f, 0.f)));
+  EXPECT_NEAR(transform_system->GetLocalTranslation(3).x, 6.f, kEpsilon);
+
+  // Disabling deferred updates flushes the pending changes.
+  transform_system->SetDeferredUpdates(false);
+  EXPECT_NEAR((*transform_system->GetWorldFromEntityMatrix(3))(0, 3), 10.f,
+              kEpsilon);
+
+  transform_system->SetLocalTranslation(3, mathfu::vec3(1.f, 0.f, 0.f));
+  EXPECT_NEAR((*transform_system->GetWorldFromEntityMatrix(3))(0, 3), 5.f,
+              kEpsilon);
+}
+
+TEST_F(TransformSystemTest, DeferredUpdatesWithJobProcessor) {
+  registry_.Create<JobProcessor>(4);
+
+  const int kNumRoots = 256;
+  auto* transform_system = registry_.Get<TransformSystem>();
+  for (int i = 0; i < kNumRoots; ++i) {
+    const Entity parent = static_cast<Entity>(2 * i + 1);
+    const Entity child = static_cast<Entity>(2 * i + 2);
+    CreateDefaultTransform(parent);
+    CreateDefaultTransform(child);
+    transform_system->AddChild(parent, child);
+  }
+
+  transform_system->SetDeferredUpdates(true);
+  for (int i = 0; i < kNumRoots; ++i) {
+    const Entity parent = static_cast<Entity>(2 * i + 1);
+    const Entity child = static_cast<Entity>(2 * i + 2);
+    transform_system->SetLocalTranslation(
+        parent, mathfu::vec3(static_cast<float>(i), 0.f, 0.f));
+    transform_system->SetLocalTranslation(child, mathfu::vec3(1.f, 0.f, 0.f));
+  }
+  transform_system->Flush();
+
+  for (int i = 0; i < kNumRoots; ++i) {
+    const Entity child = static_cast<Entity>(2 * i + 2);
+    EXPECT_NEAR((*transform_system->GetWorldFromEntityMatrix(child))(0, 3),
+                static_cast<float>(i + 1), kEpsilon);
+  }
+}
+
 TEST_F(TransformSystemTest, Parenting) {
   SetupEventHandlers();
 
@@ -1508,5 +1686,30 @@ void TransformSystemTest::ExpectTransformsCount(int n) {
   EXPECT_EQ(count, n);
 }
 
+TEST_F(TransformSystemTest, TakeUniqueChangedEntities) {
+  auto* transform_system = registry_.Get<TransformSystem>();
+  const TransformSystem::TransformFlags flag = transform_system->RequestFlag();
+  transform_system->TrackChanges(flag);
+
+  const Entity entities[] = {3, 1, 2};
+  for (const Entity entity : entities) {
+    CreateDefaultTransform(entity);
+    transform_system->SetFlag(entity, flag);
+  }
+  for (const Entity entity : entities) {
+    transform_system->SetLocalTranslation(entity, mathfu::kOnes3f);
+  }
+  transform_system->SetLocalTranslation(1, mathfu::kZeros3f);
+
+  std::vector<Entity> changed;
+  transform_system->TakeUniqueChangedEntities(flag, &changed);
+  EXPECT_THAT(changed, ElementsAre(Entity(1), Entity(2), Entity(3)));
+
+  // The record was cleared.
+  changed.clear();
+  transform_system->TakeUniqueChangedEntities(flag, &changed);
+  EXPECT_THAT(changed, IsEmpty());
+}
+
 }  // namespace
 }  // namespace lull
@@ -75,5 +75,35 @@ TEST(TypedScheduledProcessorTest, All) {
   EXPECT_TRUE(typed_scheduled_processor.Empty(three));
 }
 
+TEST(TypedScheduledProcessorTest, TimingWheel) {
+  TypedScheduledProcessor typed_scheduled_processor(
+      ScheduledProcessor::kTimingWheel);
+
+  int value = 0;
+  const TypeId one = Hash("one");
+  const TypeId two = Hash("two");
+
+  typed_scheduled_processor.Add(one, [&]() { value = 1; },
+                                std::chrono::milliseconds(100));
+  typed_scheduled_processor.Add(two, [&]() { value = 2; },
+                                std::chrono::milliseconds(200));
+  typed_scheduled_processor.Add(two, [&]() { value = 3; },
+                                std::chrono::seconds(600));
+  EXPECT_EQ(1ul, typed_scheduled_processor.Size(one));
+  EXPECT_EQ(2ul, typed_scheduled_processor.Size(two));
+
+  typed_scheduled_processor.Tick(std::chrono::milliseconds(100));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(typed_scheduled_processor.Empty(one));
+  typed_scheduled_processor.Tick(std::chrono::milliseconds(100));
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(1ul, typed_scheduled_processor.Size(two));
+
+  typed_scheduled_processor.ClearTasksOfType(two);
+  typed_scheduled_processor.Tick(std::chrono::seconds(600));
+  EXPECT_EQ(2, value);
+  EXPECT_TRUE(typed_scheduled_processor.Empty(two));
+}
+
 }  // namespace
 }  // namespace lull
@@ -0,0 +1,88 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/uniform_ring_allocator.h"
+
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+constexpr size_t kFrameSize = 100;
+constexpr int kNumFrames = 3;
+constexpr size_t kAlignment = 16;
+
+TEST(UniformRingAllocatorTest, AlignsAllocations) {
+  UniformRingAllocator allocator(kFrameSize, kNumFrames, kAlignment);
+  EXPECT_EQ(allocator.GetSize(), kFrameSize * kNumFrames);
+  EXPECT_TRUE(allocator.IsFrameEmpty());
+
+  EXPECT_EQ(allocator.Allocate(10), 0u);
+  EXPECT_FALSE(allocator.IsFrameEmpty());
+  EXPECT_EQ(allocator.Allocate(20), 16u);
+  EXPECT_EQ(allocator.Allocate(1), 48u);
+}
+
+TEST(UniformRingAllocatorTest, StaysInsideFrameRegion) {
+  UniformRingAllocator allocator(kFrameSize, kNumFrames, kAlignment);
+  EXPECT_EQ(allocator.Allocate(kFrameSize + 1),
+            UniformRingAllocator::kInvalidOffset);
+  EXPECT_EQ(allocator.Allocate(0), UniformRingAllocator::kInvalidOffset);
+  EXPECT_TRUE(allocator.IsFrameEmpty());
+
+  EXPECT_EQ(allocator.Allocate(90), 0u);
+  // The next aligned offset is 96, which leaves only 4 bytes.
+  EXPECT_EQ(allocator.Allocate(5), UniformRingAllocator::kInvalidOffset);
+  EXPECT_EQ(allocator.Allocate(4), 96u);
+  EXPECT_EQ(allocator.Allocate(1), UniformRingAllocator::kInvalidOffset);
+}
+
+TEST(UniformRingAllocatorTest, CyclesThroughFrameRegions) {
+  UniformRingAllocator allocator(kFrameSize, kNumFrames, kAlignment);
+  EXPECT_EQ(allocator.GetFrameIndex(), 0);
+  EXPECT_EQ(allocator.GetFrameId(), 0u);
+  allocator.Allocate(kFrameSize);
+
+  // The regions do not start on aligned offsets, so the first allocation of
+  // each frame is aligned up from the region start.
+  allocator.BeginFrame();
+  EXPECT_EQ(allocator.GetFrameIndex(), 1);
+  EXPECT_EQ(allocator.GetFrameId(), 1u);
+  EXPECT_TRUE(allocator.IsFrameEmpty());
+  EXPECT_EQ(allocator.Allocate(4), 112u);
+  EXPECT_EQ(allocator.Allocate(kFrameSize),
+            UniformRingAllocator::kInvalidOffset);
+
+  allocator.BeginFrame();
+  EXPECT_EQ(allocator.GetFrameIndex(), 2);
+  EXPECT_EQ(allocator.Allocate(4), 208u);
+
+  // The first region is reused once every frame has had its turn.
+  allocator.BeginFrame();
+  EXPECT_EQ(allocator.GetFrameIndex(), 0);
+  EXPECT_EQ(allocator.GetFrameId(), 3u);
+  EXPECT_TRUE(allocator.IsFrameEmpty());
+  EXPECT_EQ(allocator.Allocate(kFrameSize), 0u);
+}
+
+TEST(UniformRingAllocatorTest, DefaultsToUnaligned) {
+  UniformRingAllocator allocator(kFrameSize, kNumFrames, 0);
+  EXPECT_EQ(allocator.Allocate(3), 0u);
+  EXPECT_EQ(allocator.Allocate(3), 3u);
+}
+
+}  // namespace
+}  // namespace lull
@@ -103,6 +103,22 @@ TEST(UnorderedVectorMap, Multipage) {
   EXPECT_EQ(static_cast<int>(map.Size()), 128);
 }
 
+TEST(UnorderedVectorMap, Reserve) {
+  TestUnorderedVectorMap map(32);
+  map.Emplace(0, 0);
+  map.Reserve(100);
+  EXPECT_EQ(static_cast<int>(map.Size()), 1);
+
+  for (int i = 1; i < 100; ++i) {
+    map.Emplace(i, 10 * i);
+  }
+  EXPECT_EQ(static_cast<int>(map.Size()), 100);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_NE(map.Get(i), nullptr);
+    EXPECT_EQ(map.Get(i)->value, 10 * i);
+  }
+}
+
 TEST(UnorderedVectorMap, ForEach) {
   TestUnorderedVectorMap map(32);
 
@@ -176,6 +192,103 @@ TEST(UnorderedVectorMap, AddRemove) {
   EXPECT_EQ(static_cast<int>(map.Size()), 128 - 101 + 55);
 }
 
+TEST(UnorderedVectorMap, RemoveAndReinsert) {
+  TestUnorderedVectorMap map(8);
+
+  for (int i = 0; i < 1000; ++i) {
+    map.Emplace(i, i);
+  }
+  for (int i = 0; i < 1000; i += 3) {
+    map.Destroy(i);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    const TestClass* obj = map.Get(i);
+    if (i % 3 == 0) {
+      EXPECT_EQ(obj, nullptr);
+    } else {
+      ASSERT_NE(obj, nullptr);
+      EXPECT_EQ(obj->value, i);
+    }
+  }
+
+  for (int i = 0; i < 1000; i += 3) {
+    EXPECT_NE(map.Emplace(i, -i), nullptr);
+  }
+  EXPECT_EQ(static_cast<int>(map.Size()), 1000);
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_NE(map.Get(i), nullptr);
+    EXPECT_EQ(map.Get(i)->value, i % 3 == 0 ? -i : i);
+  }
+}
+
+TEST(UnorderedVectorMap, PageAlignment) {
+  TestUnorderedVectorMap map(3);
+  for (int i = 0; i < 10; ++i) {
+    map.Emplace(i, i);
+  }
+  for (int i = 0; i < 10; i += 3) {
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(map.Get(i));
+    EXPECT_EQ(addr % TestUnorderedVectorMap::kCacheLineSize, 0U);
+  }
+
+  EXPECT_EQ(TestUnorderedVectorMap::GetPageSizeForBytes(4096),
+            4096 / sizeof(TestClass));
+  EXPECT_EQ(TestUnorderedVectorMap::GetPageSizeForBytes(1), 1U);
+}
+
+TEST(UnorderedVectorMap, SortByKey) {
+  TestUnorderedVectorMap map(4);
+  for (int i = 0; i < 20; ++i) {
+    map.Emplace(i, 10 * i);
+  }
+  for (int i = 0; i < 20; i += 4) {
+    map.Destroy(i);
+  }
+  for (int i = 0; i < 20; i += 4) {
+    map.Emplace(i, 10 * i);
+  }
+
+  map.SortByKey();
+  int expected = 0;
+  for (const TestClass& t : map) {
+    EXPECT_EQ(t.key, expected);
+    EXPECT_EQ(t.value, 10 * expected);
+    ++expected;
+  }
+  EXPECT_EQ(expected, 20);
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_NE(map.Get(i), nullptr);
+    EXPECT_EQ(map.Get(i)->key, i);
+  }
+
+  map.SortByKey(std::greater<int>());
+  expected = 19;
+  for (const TestClass& t : map) {
+    EXPECT_EQ(t.key, expected);
+    --expected;
+  }
+  EXPECT_EQ(map.Get(7)->value, 70);
+}
+
+TEST(UnorderedVectorMap, Compact) {
+  TestUnorderedVectorMap map(4);
+  for (int i = 0; i < 256; ++i) {
+    map.Emplace(i, i);
+  }
+  for (int i = 8; i < 256; ++i) {
+    map.Destroy(i);
+  }
+  const size_t before = map.GetMemoryUsage();
+  map.Compact();
+  EXPECT_LT(map.GetMemoryUsage(), before);
+  EXPECT_EQ(static_cast<int>(map.Size()), 8);
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_NE(map.Get(i), nullptr);
+    EXPECT_EQ(map.Get(i)->value, i);
+  }
+  EXPECT_EQ(map.Get(8), nullptr);
+}
+
 TEST(UnorderedVectorMap, Clear) {
   TestUnorderedVectorMap map(32);
 
@@ -15,6 +15,9 @@ limitations under the License.
 */
 
 #include "lullaby/util/utf8_string.h"
+
+#include <string.h>
+
 #include "gtest/gtest.h"
 
 namespace lull {
@@ -75,5 +78,63 @@ TEST(UTF8StringTest, Simple) {
   EXPECT_EQ(tos, cats);
 }
 
+TEST(UTF8StringTest, LongStrings) {
+  // Mix ASCII runs longer than a machine word with multi-byte characters at
+  // unaligned offsets.
+  const std::string ascii = "The quick brown fox jumps over the lazy dog";
+  std::string text = ascii + foo + ascii + "!" + bar;
+  UTF8String utf8_string(text);
+  EXPECT_EQ(ascii.size() * 2 + 1 + 9 + 6, utf8_string.CharSize());
+  EXPECT_EQ(utf8_string.CharSize(),
+            UTF8String::CountChars(text.data(), text.size()));
+  EXPECT_EQ("\xC3\x8E", utf8_string.CharAt(ascii.size()));
+  EXPECT_EQ("T", utf8_string.CharAt(ascii.size() + 9));
+  EXPECT_EQ("!", utf8_string.CharAt(ascii.size() * 2 + 9));
+
+  utf8_string.DeleteChars(ascii.size(), 9);
+  utf8_string.Insert(ascii.size(), ascii);
+  utf8_string.Insert(0, bar);
+  UTF8String expected(bar + ascii + ascii + ascii + "!" + bar);
+  EXPECT_EQ(expected, utf8_string);
+  EXPECT_EQ(expected.CharSize(), utf8_string.CharSize());
+  for (size_t i = 0; i < expected.CharSize(); ++i) {
+    EXPECT_EQ(expected.CharAt(i), utf8_string.CharAt(i));
+  }
+
+  utf8_string.DeleteChars(6, 1000);
+  EXPECT_EQ(UTF8String(bar), utf8_string);
+}
+
+TEST(UTF8StringTest, DecodeCodePoints) {
+  std::vector<char32_t> code_points;
+  UTF8String(std::string("abcdefghij") + foo).DecodeCodePoints(&code_points);
+  const std::vector<char32_t> expected = {
+      'a',  'b',  'c',   'd',  'e', 'f',  'g',  'h',    'i',     'j',
+      0xce, 0xf1, 0x163, 0xe9, 'r', 0xf1, 0xe5, 0x10a0, 0x2f940,
+  };
+  EXPECT_EQ(expected, code_points);
+
+  // The buffer is reused, and invalid or truncated characters are replaced.
+  UTF8String("a\x80\xC0\xAF\xE1\x82").DecodeCodePoints(&code_points);
+  const std::vector<char32_t> invalid = {'a', UTF8String::kReplacementChar,
+                                         UTF8String::kReplacementChar,
+                                         UTF8String::kReplacementChar};
+  EXPECT_EQ(invalid, code_points);
+}
+
+TEST(UTF8StringTest, IsValid) {
+  const std::string valid = std::string("plain ascii text, ") + foo + bar;
+  EXPECT_TRUE(UTF8String::IsValid(valid.data(), valid.size()));
+  EXPECT_TRUE(UTF8String::IsValid("", 0));
+
+  // Stray continuation byte, overlong encoding, surrogate, truncated sequence
+  // and a code point beyond U+10FFFF.
+  const char* invalid[] = {"abcdefgh\x80", "\xC0\xAF", "\xED\xA0\x80",
+                           "abc\xE1\x82", "\xF4\x90\x80\x80"};
+  for (const char* str : invalid) {
+    EXPECT_FALSE(UTF8String::IsValid(str, strlen(str))) << str;
+  }
+}
+
 }  // namespace
 }  // namespace lull
@@ -129,6 +129,11 @@ class TestSystem : public System {
     }
   }
 
+  void CreateMany(Span<Entity> entities, const Blueprint& blueprint) override {
+    ++num_create_many_calls_;
+    System::CreateMany(entities, blueprint);
+  }
+
   // TODO test order of create and post create.
 
   void Destroy(Entity e) override { components_.Destroy(e); }
@@ -160,8 +165,11 @@ class TestSystem : public System {
 
   const ComponentPool<TestComponent>& GetComponents() { return components_; }
 
+  int GetNumCreateManyCalls() const { return num_create_many_calls_; }
+
  private:
   ComponentPool<TestComponent> components_;
+  int num_create_many_calls_ = 0;
 };
 
 // Tiny system for testing the EntityFactory's behavior when a registered
@@ -336,6 +344,64 @@ TYPED_TEST_P(EntityFactoryTest, CreateFromFlatbuffer) {
   EXPECT_THAT(system->GetComplexValue(entity), Eq(256));
 }
 
+TYPED_TEST_P(EntityFactoryTest, CreateBatch) {
+  using ComponentDef = typename TypeParam::component_type;
+  using EntityDefBuilder = typename TypeParam::entity_builder_type;
+  using ComponentDefBuilder = typename TypeParam::component_builder_type;
+
+  auto entity_factory = this->registry_.template Get<EntityFactory>();
+  auto* system = entity_factory->template CreateSystem<TestSystem>();
+  this->InitializeEntityFactory();
+
+  flatbuffers::FlatBufferBuilder fbb;
+  {
+    std::vector<flatbuffers::Offset<ComponentDef>> components;
+    {
+      auto value_def_offset = CreateValueDefDirect(fbb, "hello world", 42);
+      ComponentDefBuilder value_component_builder(fbb);
+      value_component_builder.add_def_type(
+          TypeParam::template component_def_type_value<ValueDef>());
+      value_component_builder.add_def(value_def_offset.Union());
+      components.push_back(value_component_builder.Finish());
+    }
+    {
+      auto complex_def_offset =
+          CreateComplexDefDirect(fbb, "foo bar baz", CreateIntData(fbb, 256));
+      ComponentDefBuilder complex_component_builder(fbb);
+      complex_component_builder.add_def_type(
+          TypeParam::template component_def_type_value<ComplexDef>());
+      complex_component_builder.add_def(complex_def_offset.Union());
+      components.push_back(complex_component_builder.Finish());
+    }
+    auto components_offset = fbb.CreateVector(components);
+    EntityDefBuilder entity_builder(fbb);
+    entity_builder.add_components(components_offset);
+    fbb.Finish(entity_builder.Finish(), EntityFactory::kLegacyFileIdentifier);
+  }
+  this->fake_file_system_.SaveToDisk("test_entity.bin", fbb.GetBufferPointer(),
+                                     fbb.GetSize());
+
+  EXPECT_TRUE(entity_factory->CreateBatch("test_entity", 0).empty());
+  EXPECT_TRUE(entity_factory->CreateBatch("missing_entity", 10).empty());
+
+  const std::vector<Entity> entities =
+      entity_factory->CreateBatch("test_entity", 10);
+  EXPECT_THAT(entities.size(), Eq(size_t(10)));
+  // Each System is called once per component in the blueprint.
+  EXPECT_THAT(system->GetNumCreateManyCalls(), Eq(2));
+  EXPECT_THAT(system->GetComponents().Size(), Eq(size_t(10)));
+
+  const auto& blueprint_map = entity_factory->GetEntityToBlueprintMap();
+  for (const Entity entity : entities) {
+    EXPECT_THAT(entity, Not(Eq(kNullEntity)));
+    EXPECT_THAT(system->GetSimpleName(entity), Eq("hello world"));
+    EXPECT_THAT(system->GetSimpleValue(entity), Eq(42));
+    EXPECT_THAT(system->GetComplexName(entity), Eq("foo bar baz"));
+    EXPECT_THAT(system->GetComplexValue(entity), Eq(256));
+    EXPECT_THAT(blueprint_map.at(entity), Eq("test_entity"));
+  }
+}
+
 TYPED_TEST_P(EntityFactoryTest, CreateFromBlueprint) {
   auto entity_factory = this->registry_.template Get<EntityFactory>();
   auto* system = entity_factory->template CreateSystem<TestSystem>();
@@ -712,6 +778,175 @@ TYPED_TEST_P(EntityFactoryTest, CreateNestedBlueprintFromBuilder) {
               Eq(std::unordered_map<int, int>{{1, 0}, {2, 1}, {3, 2}, {4, 1}}));
 }
 
+TYPED_TEST_P(EntityFactoryTest, CreateNestedBlueprintTwice) {
+  auto entity_factory = this->registry_.template Get<EntityFactory>();
+  auto* system = entity_factory->template CreateSystem<TestSystem>(
+      TestSystem::DefTTemplate);
+  this->InitializeEntityFactory();
+  system->SetCreateChildFn();
+
+  detail::BlueprintBuilder builder;
+  flatbuffers::FlatBufferBuilder fbb;
+  auto create_component = [&fbb, &builder](char* simple_name,
+                                           int simple_value) {
+    auto value_def_offset =
+        CreateValueDefDirect(fbb, simple_name, simple_value);
+    fbb.Finish(value_def_offset);
+    builder.AddComponent("ValueDef", {fbb.GetBufferPointer(), fbb.GetSize()});
+    fbb.Clear();
+  };
+
+  // Create a hierarchy:
+  //   A -> B -> C
+  {
+    builder.StartChildren();
+    {
+      builder.StartChildren();
+      create_component("C", 3);
+      EXPECT_TRUE(builder.FinishChild());
+      EXPECT_TRUE(builder.FinishChildren());
+    }
+    create_component("B", 2);
+    EXPECT_TRUE(builder.FinishChild());
+    EXPECT_TRUE(builder.FinishChildren());
+  }
+  create_component("A", 1);
+  flatbuffers::DetachedBuffer data = builder.Finish();
+  this->fake_file_system_.SaveToDisk("test_entity.bin", data.data(),
+                                     data.size());
+
+  // The second Entity is created from the cached blueprint, and should get its
+  // own copy of the hierarchy.
+  const Entity entity1 = entity_factory->Create("test_entity");
+  const Entity entity2 = entity_factory->Create("test_entity");
+  EXPECT_THAT(entity1, Not(Eq(kNullEntity)));
+  EXPECT_THAT(entity2, Not(Eq(kNullEntity)));
+  EXPECT_THAT(system->GetComponents().Size(), Eq(size_t(6)));
+
+  std::unordered_map<Entity, int> num_children;
+  system->GetComponents().ForEach(
+      [&](const TestSystem::TestComponent& component) {
+        const Entity parent = system->GetParent(component.GetEntity());
+        if (parent != kNullEntity) {
+          EXPECT_THAT(system->GetSimpleValue(parent) + 1,
+                      Eq(component.simple_value));
+          ++num_children[parent];
+        }
+      });
+  EXPECT_THAT(num_children.size(), Eq(size_t(4)));
+  EXPECT_THAT(num_children[entity1], Eq(1));
+  EXPECT_THAT(num_children[entity2], Eq(1));
+}
+
+TYPED_TEST_P(EntityFactoryTest, ForgetCachedBlueprint) {
+  auto entity_factory = this->registry_.template Get<EntityFactory>();
+  auto* system = entity_factory->template CreateSystem<TestSystem>();
+  this->InitializeEntityFactory();
+
+  ValueDefT value_def;
+  value_def.name = "hello";
+  Blueprint blueprint1;
+  blueprint1.Write(&value_def);
+  auto data1 = entity_factory->Finalize(&blueprint1);
+  this->fake_file_system_.SaveToDisk("test_entity.bin", data1.data(),
+                                     data1.size());
+  const Entity entity1 = entity_factory->Create("test_entity");
+  EXPECT_THAT(system->GetSimpleName(entity1), Eq("hello"));
+
+  // Changing the file does not affect the cached blueprint.
+  value_def.name = "world";
+  Blueprint blueprint2;
+  blueprint2.Write(&value_def);
+  auto data2 = entity_factory->Finalize(&blueprint2);
+  this->fake_file_system_.SaveToDisk("test_entity.bin", data2.data(),
+                                     data2.size());
+  const Entity entity2 = entity_factory->Create("test_entity");
+  EXPECT_THAT(system->GetSimpleName(entity2), Eq("hello"));
+
+  entity_factory->ForgetCachedBlueprint("test_entity");
+  const Entity entity3 = entity_factory->Create("test_entity");
+  EXPECT_THAT(system->GetSimpleName(entity3), Eq("world"));
+}
+
+TYPED_TEST_P(EntityFactoryTest, ReloadBlueprint) {
+  auto entity_factory = this->registry_.template Get<EntityFactory>();
+  auto* system = entity_factory->template CreateSystem<TestSystem>();
+  this->InitializeEntityFactory();
+
+  ValueDefT value_def;
+  value_def.name = "hello";
+  Blueprint blueprint1;
+  blueprint1.Write(&value_def);
+  auto data1 = entity_factory->Finalize(&blueprint1);
+  this->fake_file_system_.SaveToDisk("test_entity.bin", data1.data(),
+                                     data1.size());
+  const Entity entity1 = entity_factory->Create("test_entity");
+  const Entity entity2 = entity_factory->Create("test_entity");
+  const Entity other = entity_factory->Create();
+  EXPECT_THAT(system->GetSimpleName(entity1), Eq("hello"));
+
+  value_def.name = "world";
+  Blueprint blueprint2;
+  blueprint2.Write(&value_def);
+  auto data2 = entity_factory->Finalize(&blueprint2);
+  this->fake_file_system_.SaveToDisk("test_entity.bin", data2.data(),
+                                     data2.size());
+
+  // Only the Entities created from the blueprint are re-created, and they keep
+  // their ids.
+  EXPECT_THAT(entity_factory->ReloadBlueprint("test_entity"), Eq(2u));
+  EXPECT_THAT(system->GetSimpleName(entity1), Eq("world"));
+  EXPECT_THAT(system->GetSimpleName(entity2), Eq("world"));
+  EXPECT_THAT(system->GetSimpleName(other), Eq(""));
+  EXPECT_THAT(entity_factory->GetEntityToBlueprintMap().at(entity1),
+              Eq("test_entity"));
+}
+
+TYPED_TEST_P(EntityFactoryTest, AcquirePooled) {
+  auto entity_factory = this->registry_.template Get<EntityFactory>();
+  auto* system = entity_factory->template CreateSystem<TestSystem>();
+  this->InitializeEntityFactory();
+
+  ValueDefT value_def;
+  value_def.name = "hello";
+  Blueprint blueprint;
+  blueprint.Write(&value_def);
+  auto data = entity_factory->Finalize(&blueprint);
+  this->fake_file_system_.SaveToDisk("test_entity.bin", data.data(),
+                                     data.size());
+
+  // An empty pool creates a new Entity.
+  const Entity entity1 = entity_factory->AcquirePooled("test_entity");
+  EXPECT_THAT(entity1, Not(Eq(kNullEntity)));
+  EXPECT_THAT(system->GetSimpleName(entity1), Eq("hello"));
+
+  // Only Entities created from a named blueprint can be pooled.
+  const Entity other = entity_factory->Create(&blueprint);
+  EXPECT_FALSE(entity_factory->ReleaseToPool(other));
+
+  EXPECT_TRUE(entity_factory->ReleaseToPool(entity1));
+  EXPECT_THAT(entity_factory->GetPoolSize("test_entity"), Eq(1u));
+
+  // Re-acquiring reuses the Entity with its Components reset.
+  const Entity entity2 = entity_factory->AcquirePooled("test_entity");
+  EXPECT_THAT(entity2, Eq(entity1));
+  EXPECT_THAT(system->GetSimpleName(entity2), Eq("hello"));
+  EXPECT_THAT(entity_factory->GetPoolSize("test_entity"), Eq(0u));
+
+  // Destroying a pooled Entity removes it from the pool.
+  EXPECT_TRUE(entity_factory->ReleaseToPool(entity2));
+  entity_factory->Destroy(entity2);
+  EXPECT_THAT(entity_factory->GetPoolSize("test_entity"), Eq(0u));
+  EXPECT_THAT(system->GetSimpleName(entity2), Eq(""));
+
+  const Entity entity3 = entity_factory->AcquirePooled("test_entity");
+  EXPECT_THAT(entity3, Not(Eq(entity1)));
+  EXPECT_TRUE(entity_factory->ReleaseToPool(entity3));
+  entity_factory->ClearPools();
+  EXPECT_THAT(entity_factory->GetPoolSize("test_entity"), Eq(0u));
+  EXPECT_THAT(system->GetSimpleName(entity3), Eq(""));
+}
+
 TYPED_TEST_P(EntityFactoryDeathTest,
              CreateBlueprintFromBuilderRegisterDefTypeHash) {
   auto entity_factory = this->registry_.template Get<EntityFactory>();
@@ -1342,13 +1577,15 @@ TYPED_TEST_P(EntityFactoryTest, CreateBlueprintTree) {
 
 REGISTER_TYPED_TEST_SUITE_P(
     EntityFactoryTest, LoadNonExistantBlueprint, CreateFromFlatbuffer,
-    CreateFromBlueprint, CreateFromBlueprintRegisterDefTTemplate,
+    CreateBatch, CreateFromBlueprint, CreateFromBlueprintRegisterDefTTemplate,
     CreateFromBlueprintTree, CreateFromBlueprintTreeWithEntity,
     CreateFromFinalizedBlueprint, CreateFromFinalizedBlueprintTree,
     CreateBlueprintFromBuilder, CreateNestedBlueprintFromBuilder,
-    BlueprintBuilderErrors, CreateFromBadBlueprintCorrectIdentifier, Destroy,
-    QueuedDestroy, GetEntityToBlueprintMap, MultipleSchemas,
-    FinalizeMultipleSchemas, CreateBlueprint, CreateBlueprintTree);
+    CreateNestedBlueprintTwice, ForgetCachedBlueprint, ReloadBlueprint,
+    AcquirePooled, BlueprintBuilderErrors,
+    CreateFromBadBlueprintCorrectIdentifier, Destroy, QueuedDestroy,
+    GetEntityToBlueprintMap, MultipleSchemas, FinalizeMultipleSchemas,
+    CreateBlueprint, CreateBlueprintTree);
 
 REGISTER_TYPED_TEST_SUITE_P(
     EntityFactoryDeathTest, NoSystems, MissingDependency, MissingSystem,
@@ -0,0 +1,212 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <dlfcn.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "lullaby/util/variant.h"
+#include "lullaby/util/variant_arena.h"
+
+// Counts every allocation made through operator new or posix_memalign (which
+// lull::AlignedAlloc uses), so that the benchmarks can report the number of
+// allocations per iteration.
+static std::atomic<size_t> g_num_allocations(0);
+
+void* operator new(size_t size) {
+  ++g_num_allocations;
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+extern "C" int posix_memalign(void** ptr, size_t align, size_t size) {
+  using Fn = int (*)(void**, size_t, size_t);
+  static const Fn next =
+      reinterpret_cast<Fn>(dlsym(RTLD_NEXT, "posix_memalign"));
+  ++g_num_allocations;
+  return next(ptr, align, size);
+}
+
+namespace lull {
+namespace {
+
+static VariantArray MakeArray() {
+  VariantArray array;
+  for (int i = 0; i < 8; ++i) {
+    array.emplace_back(std::string(32, static_cast<char>('a' + i)));
+  }
+  return array;
+}
+
+static VariantMap MakeMap() {
+  VariantMap map;
+  for (int i = 0; i < 8; ++i) {
+    const char c = static_cast<char>('a' + i);
+    map[static_cast<HashValue>(i)] = std::string(32, c);
+  }
+  return map;
+}
+
+static const mathfu::mat4 kMatrix(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+                                  14, 15, 16);
+
+// Returns the number of allocations made by |fn|.
+template <typename Fn>
+static size_t CountAllocations(const Fn& fn) {
+  const size_t start = g_num_allocations;
+  fn();
+  return g_num_allocations - start;
+}
+
+// Copies |value| into a Variant, and then copies that Variant, as when sending
+// an event or reading a value out of a data store.
+template <typename Fn>
+static void CopyVariant(benchmark::State& state, const Fn& make_value,
+                        VariantArena* arena) {
+  const Variant original = make_value();
+  size_t num_allocations = 0;
+  size_t num_iterations = 0;
+  while (state.KeepRunning()) {
+    num_allocations += CountAllocations([&]() {
+      // The arena (if any) only backs the transient copies.
+      VariantArena::Scope scope(arena);
+      Variant copy = original;
+      Variant copy_of_copy = copy;
+      benchmark::DoNotOptimize(copy_of_copy);
+    });
+    ++num_iterations;
+    if (arena) {
+      arena->Reset();
+    }
+  }
+  const size_t count = std::max<size_t>(num_iterations, 1);
+  state.counters["allocs"] = static_cast<double>(num_allocations) / count;
+}
+
+static void BM_CopyInt(benchmark::State& state) {
+  CopyVariant(state, []() { return 123; }, nullptr);
+}
+BENCHMARK(BM_CopyInt);
+
+static void BM_CopyMat4(benchmark::State& state) {
+  CopyVariant(state, []() { return kMatrix; }, nullptr);
+}
+BENCHMARK(BM_CopyMat4);
+
+static void BM_CopyShortString(benchmark::State& state) {
+  CopyVariant(state, []() { return std::string("abc"); }, nullptr);
+}
+BENCHMARK(BM_CopyShortString);
+
+static void BM_CopyLongString(benchmark::State& state) {
+  CopyVariant(state, []() { return std::string(100, 'a'); }, nullptr);
+}
+BENCHMARK(BM_CopyLongString);
+
+static void BM_CopyArray(benchmark::State& state) {
+  CopyVariant(state, MakeArray, nullptr);
+}
+BENCHMARK(BM_CopyArray);
+
+static void BM_CopyMap(benchmark::State& state) {
+  CopyVariant(state, MakeMap, nullptr);
+}
+BENCHMARK(BM_CopyMap);
+
+// Sets transient Variants to new values, as when building event payloads
+// during a frame.
+static void SetTransientVariants(benchmark::State& state,
+                                 VariantArena* arena) {
+  const std::string long_string(100, 'a');
+  size_t num_allocations = 0;
+  size_t num_iterations = 0;
+  while (state.KeepRunning()) {
+    num_allocations += CountAllocations([&]() {
+      VariantArena::Scope scope(arena);
+      Variant matrix = kMatrix;
+      Variant str = long_string;
+      Variant copy = str;
+      benchmark::DoNotOptimize(matrix);
+      benchmark::DoNotOptimize(copy);
+    });
+    ++num_iterations;
+    if (arena) {
+      arena->Reset();
+    }
+  }
+  const size_t count = std::max<size_t>(num_iterations, 1);
+  state.counters["allocs"] = static_cast<double>(num_allocations) / count;
+}
+
+static void BM_SetTransientVariants(benchmark::State& state) {
+  SetTransientVariants(state, nullptr);
+}
+BENCHMARK(BM_SetTransientVariants);
+
+static void BM_SetTransientVariantsInArena(benchmark::State& state) {
+  VariantArena arena;
+  SetTransientVariants(state, &arena);
+}
+BENCHMARK(BM_SetTransientVariantsInArena);
+
+// These tests verify the allocation counts that the benchmarks report.
+TEST(VariantBenchmarkTest, CopiesDoNotAllocate) {
+  const Variant matrix = kMatrix;
+  const Variant short_string = std::string("abc");
+  const Variant long_string = std::string(100, 'a');
+  const Variant array = MakeArray();
+  const Variant map = MakeMap();
+  EXPECT_EQ(CountAllocations([&]() { Variant copy = matrix; }), 0u);
+  EXPECT_EQ(CountAllocations([&]() { Variant copy = short_string; }), 0u);
+  EXPECT_EQ(CountAllocations([&]() { Variant copy = long_string; }), 0u);
+  EXPECT_EQ(CountAllocations([&]() { Variant copy = array; }), 0u);
+  EXPECT_EQ(CountAllocations([&]() { Variant copy = map; }), 0u);
+}
+
+TEST(VariantBenchmarkTest, ArenaVariantsDoNotAllocate) {
+  VariantArena arena;
+  const std::string long_string(100, 'a');
+  // Warm up the arena's first page.
+  {
+    VariantArena::Scope scope(&arena);
+    Variant str = long_string;
+  }
+  arena.Reset();
+
+  // Only the contents of the string itself are allocated from the heap.
+  EXPECT_EQ(CountAllocations([&]() {
+              VariantArena::Scope scope(&arena);
+              Variant str = long_string;
+              Variant copy = str;
+            }),
+            1u);
+  arena.Reset();
+}
+
+}  // namespace
+}  // namespace lull
@@ -506,6 +506,98 @@ TEST(Variant, LargeTypes) {
   EXPECT_EQ(*result_move_d6, i6);
 }
 
+TEST(Variant, SharedValues) {
+  const std::string long_string(100, 'a');
+  Variant v0 = long_string;
+  const Variant& const_v0 = v0;
+
+  // Copies of a long string share the same storage.
+  Variant v1 = v0;
+  const Variant& const_v1 = v1;
+  ASSERT_NE(const_v1.Get<std::string>(), nullptr);
+  EXPECT_EQ(const_v0.Get<std::string>(), const_v1.Get<std::string>());
+
+  // Modifying a copy gives it its own storage, leaving the original as it was.
+  std::string* str = v1.Get<std::string>();
+  ASSERT_NE(str, nullptr);
+  EXPECT_NE(str, const_v0.Get<std::string>());
+  *str = "changed";
+  EXPECT_EQ(*const_v0.Get<std::string>(), long_string);
+  EXPECT_EQ(*const_v1.Get<std::string>(), "changed");
+
+  // Once a mutable pointer has been handed out, the value is no longer shared
+  // so that writes through the pointer can't be seen by later copies.
+  Variant v2 = v1;
+  const Variant& const_v2 = v2;
+  EXPECT_NE(const_v1.Get<std::string>(), const_v2.Get<std::string>());
+  *str = "changed again";
+  EXPECT_EQ(*const_v2.Get<std::string>(), "changed");
+
+  // Short strings are always stored in the Variant itself.
+  Variant v3 = std::string("abc");
+  Variant v4 = v3;
+  const Variant& const_v3 = v3;
+  const Variant& const_v4 = v4;
+  EXPECT_NE(const_v3.Get<std::string>(), const_v4.Get<std::string>());
+  EXPECT_EQ(*const_v4.Get<std::string>(), "abc");
+}
+
+TEST(Variant, SharedArrays) {
+  VariantArray array;
+  array.emplace_back(1);
+  array.emplace_back(std::string(50, 'b'));
+  Variant v0 = array;
+  Variant v1 = v0;
+  const Variant& const_v0 = v0;
+  const Variant& const_v1 = v1;
+  EXPECT_EQ(const_v0.Get<VariantArray>(), const_v1.Get<VariantArray>());
+
+  VariantArray* copy = v1.Get<VariantArray>();
+  ASSERT_NE(copy, nullptr);
+  copy->emplace_back(2.f);
+  (*copy)[0] = 3;
+  ASSERT_EQ(const_v0.Get<VariantArray>()->size(), 2u);
+  EXPECT_EQ(*(*const_v0.Get<VariantArray>())[0].Get<int>(), 1);
+  ASSERT_EQ(const_v1.Get<VariantArray>()->size(), 3u);
+  EXPECT_EQ(*(*const_v1.Get<VariantArray>())[0].Get<int>(), 3);
+
+  // Moving a shared value keeps its storage.
+  const VariantArray* storage = const_v0.Get<VariantArray>();
+  Variant v2 = std::move(v0);
+  const Variant& const_v2 = v2;
+  EXPECT_EQ(const_v2.Get<VariantArray>(), storage);
+  EXPECT_TRUE(v0.Empty());
+}
+
+TEST(Variant, Arena) {
+  VariantArena arena;
+  const std::string long_string(100, 'c');
+  Variant outside;
+  {
+    VariantArena::Scope scope(&arena);
+    Variant v0 = long_string;
+    EXPECT_EQ(arena.GetNumLiveAllocations(), 1u);
+
+    // Copies share the arena block, while values that fit in the Variant don't
+    // need the arena at all.
+    Variant v1 = v0;
+    Variant v2 = 123;
+    EXPECT_EQ(arena.GetNumLiveAllocations(), 1u);
+
+    // Modifying a copy takes another block from the arena.
+    *v1.Get<std::string>() = long_string + long_string;
+    EXPECT_EQ(arena.GetNumLiveAllocations(), 2u);
+    EXPECT_EQ(*v0.Get<std::string>(), long_string);
+  }
+  EXPECT_EQ(arena.GetNumLiveAllocations(), 0u);
+  arena.Reset();
+
+  // Outside of a scope, the heap is used.
+  outside = long_string;
+  EXPECT_EQ(arena.GetNumLiveAllocations(), 0u);
+  EXPECT_EQ(*outside.Get<std::string>(), long_string);
+}
+
 TEST(Variant, ImplicitCastNumeric) {
   int i = 1;
   Variant vi = i;
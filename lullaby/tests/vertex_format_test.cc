@@ -52,6 +52,22 @@ TEST(VertexFormat, VertexSize) {
   EXPECT_EQ(VertexPTN::kFormat.GetVertexSize(), 32U);
 }
 
+TEST(VertexFormat, PackedVertexSize) {
+  const VertexFormat packed({
+      VertexAttribute(VertexAttributeUsage_Position,
+                      VertexAttributeType_Vec4hf),
+      VertexAttribute(VertexAttributeUsage_TexCoord,
+                      VertexAttributeType_Vec2hf),
+      VertexAttribute(VertexAttributeUsage_TexCoord,
+                      VertexAttributeType_Vec2us),
+      VertexAttribute(VertexAttributeUsage_Color,
+                      VertexAttributeType_Vec4ub),
+  });
+  EXPECT_EQ(packed.GetVertexSize(), 20U);
+  EXPECT_EQ(packed.GetAttributeOffsetAt(1), 8U);
+  EXPECT_EQ(packed.GetAttributeOffsetAt(3), 16U);
+}
+
 TEST(VertexFormat, GetAttributeWithUsage) {
   // Test some formats for attributes we know they have.
   /*
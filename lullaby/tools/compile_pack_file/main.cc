@@ -0,0 +1,106 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <string>
+#include <utility>
+
+#include "lullaby/tools/common/file_utils.h"
+#include "lullaby/tools/compile_pack_file/pack_file_builder.h"
+#include "lullaby/util/arg_parser.h"
+#include "lullaby/util/logging.h"
+
+// This tool bundles files into a single pack file that can be loaded with
+// lull::PackFile, for example by registering it with a TaggedFileLoader.
+
+namespace lull {
+namespace tool {
+namespace {
+
+// Returns the name of the pack entry for |src|, which is |src| relative to
+// |root|.
+string_view GetEntryName(string_view root, string_view src) {
+  if (!root.empty() && src.length() > root.length() &&
+      src.substr(0, root.length()) == root) {
+    src = src.substr(root.length());
+    if (src[0] == '/') {
+      src = src.substr(1);
+    }
+  }
+  return src;
+}
+
+}  // namespace
+
+int Run(int argc, const char* argv[]) {
+  ArgParser args;
+  args.AddArg("output")
+      .SetShortName('o')
+      .SetNumArgs(1)
+      .SetDescription("Filename of the generated pack file.")
+      .SetRequired();
+  args.AddArg("root")
+      .SetShortName('r')
+      .SetNumArgs(1)
+      .SetDescription(
+          "Directory that entry names are relative to.  Inputs outside of it "
+          "are named by their paths as given.");
+  args.AddArg("compress")
+      .SetShortName('c')
+      .SetDescription("Compress entries where that makes them smaller.");
+  args.AddArg("inputs")
+      .SetShortName('i')
+      .SetVariableNumArgs()
+      .SetDescription("List of files to pack.")
+      .SetRequired();
+  if (!args.Parse(argc, argv)) {
+    auto& errors = args.GetErrors();
+    for (auto& err : errors) {
+      LOG(ERROR) << "Error: " << err;
+    }
+    LOG(ERROR) << args.GetUsage();
+    return -1;
+  }
+
+  const bool compress = args.IsSet("compress");
+  const string_view root = args.GetString("root");
+  PackFileBuilder builder;
+  for (auto input : args.GetValues("inputs")) {
+    const std::string input_string(input);
+    std::string contents;
+    if (!LoadFile(input_string.c_str(), true, &contents)) {
+      LOG(ERROR) << "Unable to read file: " << input;
+      return -1;
+    }
+    const string_view name = GetEntryName(root, input);
+    if (!builder.AddEntry(name, std::move(contents), compress)) {
+      LOG(ERROR) << "Duplicate entry: " << name;
+      return -1;
+    }
+  }
+
+  const std::string output = args.GetString("output").to_string();
+  const std::string pack = builder.Build();
+  if (!SaveFile(pack.data(), pack.size(), output.c_str(), true)) {
+    LOG(ERROR) << "Error saving file: " << output;
+    return -1;
+  }
+  return 0;
+}
+
+}  // namespace tool
+}  // namespace lull
+
+int main(int argc, const char** argv) { return lull::tool::Run(argc, argv); }
@@ -0,0 +1,133 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/tools/compile_pack_file/pack_file_builder.h"
+
+#include <string.h>
+#include <algorithm>
+#include <utility>
+
+#include "lullaby/modules/file/pack_file.h"
+#include "lullaby/util/hash.h"
+#include "zlib.h"
+
+namespace lull {
+namespace tool {
+namespace {
+
+size_t Align(size_t offset) {
+  return (offset + kPackFileAlignment - 1) / kPackFileAlignment *
+         kPackFileAlignment;
+}
+
+// Compresses |contents| with zlib and returns true if that made them smaller.
+bool Compress(const std::string& contents, std::string* out) {
+  uLongf size = compressBound(static_cast<uLong>(contents.size()));
+  out->resize(size);
+  const int result = compress2(reinterpret_cast<Bytef*>(&(*out)[0]), &size,
+                               reinterpret_cast<const Bytef*>(contents.data()),
+                               static_cast<uLong>(contents.size()),
+                               Z_BEST_COMPRESSION);
+  if (result != Z_OK || size >= contents.size()) {
+    return false;
+  }
+  out->resize(size);
+  return true;
+}
+
+}  // namespace
+
+bool PackFileBuilder::AddEntry(string_view name, std::string contents,
+                               bool compress) {
+  for (const Entry& entry : entries_) {
+    if (entry.name == name) {
+      return false;
+    }
+  }
+
+  Entry entry;
+  entry.name = name.to_string();
+  entry.size = contents.size();
+  std::string compressed;
+  if (compress && !contents.empty() && Compress(contents, &compressed)) {
+    entry.contents = std::move(compressed);
+    entry.compressed = true;
+  } else {
+    entry.contents = std::move(contents);
+  }
+  entries_.push_back(std::move(entry));
+  return true;
+}
+
+std::string PackFileBuilder::Build() const {
+  // Sort the index by hash so that PackFile can binary search it, breaking
+  // ties by name so that the output is deterministic.
+  std::vector<std::pair<HashValue, const Entry*>> sorted;
+  sorted.reserve(entries_.size());
+  for (const Entry& entry : entries_) {
+    sorted.emplace_back(Hash(entry.name), &entry);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const std::pair<HashValue, const Entry*>& lhs,
+               const std::pair<HashValue, const Entry*>& rhs) {
+              if (lhs.first != rhs.first) {
+                return lhs.first < rhs.first;
+              }
+              return lhs.second->name < rhs.second->name;
+            });
+
+  PackFileHeader header;
+  header.magic = kPackFileMagic;
+  header.version = kPackFileVersion;
+  header.num_entries = static_cast<uint32_t>(sorted.size());
+  header.reserved = 0;
+
+  std::vector<PackFileEntry> index(sorted.size());
+  size_t offset = sizeof(header) + index.size() * sizeof(PackFileEntry);
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    index[i].hash = sorted[i].first;
+    index[i].name_offset = static_cast<uint32_t>(offset);
+    index[i].name_size = static_cast<uint32_t>(sorted[i].second->name.size());
+    offset += index[i].name_size;
+  }
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    const Entry& entry = *sorted[i].second;
+    offset = Align(offset);
+    index[i].compression = entry.compressed ? kPackFileCompression_Zlib
+                                            : kPackFileCompression_None;
+    index[i].offset = offset;
+    index[i].stored_size = entry.contents.size();
+    index[i].size = entry.size;
+    offset += entry.contents.size();
+  }
+
+  std::string out(offset, '\0');
+  memcpy(&out[0], &header, sizeof(header));
+  if (!index.empty()) {
+    memcpy(&out[sizeof(header)], index.data(),
+           index.size() * sizeof(PackFileEntry));
+  }
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    const Entry& entry = *sorted[i].second;
+    memcpy(&out[index[i].name_offset], entry.name.data(), entry.name.size());
+    memcpy(&out[index[i].offset], entry.contents.data(),
+           entry.contents.size());
+  }
+  return out;
+}
+
+}  // namespace tool
+}  // namespace lull
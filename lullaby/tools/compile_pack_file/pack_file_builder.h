@@ -0,0 +1,54 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_TOOLS_COMPILE_PACK_FILE_PACK_FILE_BUILDER_H_
+#define LULLABY_TOOLS_COMPILE_PACK_FILE_PACK_FILE_BUILDER_H_
+
+#include <string>
+#include <vector>
+
+#include "lullaby/util/string_view.h"
+
+namespace lull {
+namespace tool {
+
+// Collects files and writes them out as a pack file readable by
+// lull::PackFile.
+class PackFileBuilder {
+ public:
+  // Adds an entry called |name| with |contents|.  If |compress| is true, the
+  // contents are compressed, unless that would not make them smaller.  Returns
+  // false if there already is an entry called |name|.
+  bool AddEntry(string_view name, std::string contents, bool compress);
+
+  // Returns the pack file containing all the added entries.
+  std::string Build() const;
+
+ private:
+  struct Entry {
+    std::string name;
+    std::string contents;
+    size_t size = 0;
+    bool compressed = false;
+  };
+
+  std::vector<Entry> entries_;
+};
+
+}  // namespace tool
+}  // namespace lull
+
+#endif  // LULLABY_TOOLS_COMPILE_PACK_FILE_PACK_FILE_BUILDER_H_
@@ -43,6 +43,10 @@ limitations under the License.
 //   std::unique_ptr.  This is useful for supporting cyclical data dependencies
 //   (eg. Table X has a field of table X) and is the same as the default
 //   flatbuffer gen-object-api support.
+// * The "zero_copy" attribute can be used to make a string field use
+//   lull::string_view and a vector-of-scalars field use lull::Span.  When read
+//   by the FlatbufferReader, these members point directly into the flatbuffer
+//   instead of copying its data, so the flatbuffer must outlive the object.
 class CodeGenerator : public flatbuffers::BaseGenerator {
  public:
   CodeGenerator(const flatbuffers::Parser& parser, const std::string& path,
@@ -114,6 +118,25 @@ const std::string* GetAttribute(const flatbuffers::Definition& def,
   }
 }
 
+// Returns true if the given field should be generated as a view into the
+// flatbuffer rather than a copy of its data.  Only strings and vectors of
+// non-enum, non-bool scalars have a native layout matching the wire format.
+bool IsZeroCopyField(const flatbuffers::FieldDef& field) {
+  if (GetAttribute(field, "zero_copy") == nullptr) {
+    return false;
+  }
+  const flatbuffers::Type& type = field.value.type;
+  if (type.base_type == flatbuffers::BASE_TYPE_STRING) {
+    return true;
+  } else if (type.base_type == flatbuffers::BASE_TYPE_VECTOR) {
+    const flatbuffers::Type vector_type = type.VectorType();
+    return IsScalar(vector_type.base_type) &&
+           vector_type.base_type != flatbuffers::BASE_TYPE_BOOL &&
+           vector_type.enum_def == nullptr;
+  }
+  return false;
+}
+
 // Gets the default value for a given field.
 std::string CodeGenerator::GetDefaultValue(
     const flatbuffers::FieldDef& field) const {
@@ -219,14 +242,22 @@ std::string CodeGenerator::GetType(const flatbuffers::Type& type,
     case flatbuffers::BASE_TYPE_ULONG:
     case flatbuffers::BASE_TYPE_FLOAT:
     case flatbuffers::BASE_TYPE_DOUBLE:
-    case flatbuffers::BASE_TYPE_STRING:
       return GetBasicType(type.base_type);
+    case flatbuffers::BASE_TYPE_STRING: {
+      const bool zero_copy =
+          field && field->value.type.base_type == type.base_type &&
+          IsZeroCopyField(*field);
+      return zero_copy ? "lull::string_view" : GetBasicType(type.base_type);
+    }
     case flatbuffers::BASE_TYPE_UINT: {
       const auto* hashvalue = GetAttribute(*field, "hashvalue");
       return hashvalue ? "lull::HashValue" : GetBasicType(type.base_type);
     }
     case flatbuffers::BASE_TYPE_VECTOR: {
       const std::string name = GetType(type.VectorType(), field);
+      if (field && IsZeroCopyField(*field)) {
+        return "lull::Span<" + name + ">";
+      }
       return "std::vector<" + name + ">";
     }
     case flatbuffers::BASE_TYPE_STRUCT: {
@@ -754,6 +785,8 @@ bool CodeGenerator::generate() {
   code_ += "#include \"lullaby/util/common_types.h\"";
   code_ += "#include \"lullaby/util/math.h\"";
   code_ += "#include \"lullaby/util/optional.h\"";
+  code_ += "#include \"lullaby/util/span.h\"";
+  code_ += "#include \"lullaby/util/string_view.h\"";
   code_ += "#include \"lullaby/util/typeid.h\"";
   for (auto& it : parser_.included_files_) {
     GenerateInclude(it.first);
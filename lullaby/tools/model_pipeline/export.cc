@@ -22,6 +22,7 @@ limitations under the License.
 #include <unordered_set>
 #include "lullaby/util/filename.h"
 #include "lullaby/util/flatbuffer_writer.h"
+#include "lullaby/util/half_float.h"
 #include "lullaby/util/inward_buffer.h"
 #include "lullaby/generated/model_def_generated.h"
 #include "lullaby/generated/model_pipeline_def_generated.h"
@@ -90,6 +91,43 @@ struct VertexBuilder {
   std::vector<Op> ops;
 };
 
+// Packed half-float vectors written to quantized vertex buffers.
+struct HalfVec2 {
+  HalfFloat x, y;
+};
+
+struct HalfVec4 {
+  HalfFloat x, y, z, w;
+};
+
+static HalfVec2 ToHalfVec2(const mathfu::vec2& v) {
+  return {FloatToHalf(v.x), FloatToHalf(v.y)};
+}
+
+static HalfVec4 ToHalfVec4(const mathfu::vec4& v) {
+  return {FloatToHalf(v.x), FloatToHalf(v.y), FloatToHalf(v.z),
+          FloatToHalf(v.w)};
+}
+
+// Adds the texture coordinate returned by |fn| to the |builder| and |out|
+// vertex format, as half-floats if |quantize| is set.
+template <typename Fn>
+static void AddTexCoordOp(VertexBuilder<Vertex>* builder,
+                          ModelInstanceDefT* out, bool quantize, Fn fn) {
+  VertexAttributeT attr;
+  attr.usage = VertexAttributeUsage_TexCoord;
+  if (quantize) {
+    builder->AddOp(
+        [fn](const Vertex& vertex) { return ToHalfVec2(fn(vertex)); });
+    attr.type = VertexAttributeType_Vec2hf;
+  } else {
+    builder->AddOp(
+        [fn](const Vertex& vertex) { return mathfu::vec2_packed(fn(vertex)); });
+    attr.type = VertexAttributeType_Vec2f;
+  }
+  out->vertex_attributes.emplace_back(attr);
+}
+
 void ExportCollidable(const Model& model, ModelPipelineCollidableDefT* config) {
   config->source = model.GetImportDef().name;
 }
@@ -116,19 +154,28 @@ void ExportModelInstance(const Model& model, ModelInstanceDefT* out,
 
   VertexBuilder<Vertex> builder;
   VertexBuilder<Vertex::Blend> blend_builder;
+  const bool quantize = options.quantize_vertices;
 
   if (model.CheckAttrib(Vertex::kAttribBit_Position)) {
-    builder.AddOp([](const Vertex& vertex) {
-      return mathfu::vec3_packed(vertex.position);
-    });
-
-    blend_builder.AddOp([](const Vertex::Blend& blend) {
-      return mathfu::vec3_packed(blend.position);
-    });
-
     VertexAttributeT attr;
     attr.usage = VertexAttributeUsage_Position;
-    attr.type = VertexAttributeType_Vec3f;
+    if (quantize) {
+      builder.AddOp([](const Vertex& vertex) {
+        return ToHalfVec4(mathfu::vec4(vertex.position, 1.f));
+      });
+      blend_builder.AddOp([](const Vertex::Blend& blend) {
+        return ToHalfVec4(mathfu::vec4(blend.position, 1.f));
+      });
+      attr.type = VertexAttributeType_Vec4hf;
+    } else {
+      builder.AddOp([](const Vertex& vertex) {
+        return mathfu::vec3_packed(vertex.position);
+      });
+      blend_builder.AddOp([](const Vertex::Blend& blend) {
+        return mathfu::vec3_packed(blend.position);
+      });
+      attr.type = VertexAttributeType_Vec3f;
+    }
     out->vertex_attributes.emplace_back(attr);
     out->blend_attributes.emplace_back(attr);
   }
@@ -169,116 +216,103 @@ void ExportModelInstance(const Model& model, ModelInstanceDefT* out,
     out->vertex_attributes.emplace_back(attr);
   }
   if (model.CheckAttrib(Vertex::kAttribBit_Uv0)) {
-    builder.AddOp(
-        [](const Vertex& vertex) { return mathfu::vec2_packed(vertex.uv0); });
-
-    VertexAttributeT attr;
-    attr.usage = VertexAttributeUsage_TexCoord;
-    attr.type = VertexAttributeType_Vec2f;
-    out->vertex_attributes.emplace_back(attr);
+    AddTexCoordOp(&builder, out, quantize,
+                  [](const Vertex& vertex) { return vertex.uv0; });
   }
   if (model.CheckAttrib(Vertex::kAttribBit_Uv1)) {
-    builder.AddOp(
-        [](const Vertex& vertex) { return mathfu::vec2_packed(vertex.uv1); });
-
-    VertexAttributeT attr;
-    attr.usage = VertexAttributeUsage_TexCoord;
-    attr.type = VertexAttributeType_Vec2f;
-    out->vertex_attributes.emplace_back(attr);
+    AddTexCoordOp(&builder, out, quantize,
+                  [](const Vertex& vertex) { return vertex.uv1; });
   }
   if (model.CheckAttrib(Vertex::kAttribBit_Uv2)) {
-    builder.AddOp(
-        [](const Vertex& vertex) { return mathfu::vec2_packed(vertex.uv2); });
-
-    VertexAttributeT attr;
-    attr.usage = VertexAttributeUsage_TexCoord;
-    attr.type = VertexAttributeType_Vec2f;
-    out->vertex_attributes.emplace_back(attr);
+    AddTexCoordOp(&builder, out, quantize,
+                  [](const Vertex& vertex) { return vertex.uv2; });
   }
   if (model.CheckAttrib(Vertex::kAttribBit_Uv3)) {
-    builder.AddOp(
-        [](const Vertex& vertex) { return mathfu::vec2_packed(vertex.uv3); });
-
-    VertexAttributeT attr;
-    attr.usage = VertexAttributeUsage_TexCoord;
-    attr.type = VertexAttributeType_Vec2f;
-    out->vertex_attributes.emplace_back(attr);
+    AddTexCoordOp(&builder, out, quantize,
+                  [](const Vertex& vertex) { return vertex.uv3; });
   }
   if (model.CheckAttrib(Vertex::kAttribBit_Uv4)) {
-    builder.AddOp(
-        [](const Vertex& vertex) { return mathfu::vec2_packed(vertex.uv4); });
-
-    VertexAttributeT attr;
-    attr.usage = VertexAttributeUsage_TexCoord;
-    attr.type = VertexAttributeType_Vec2f;
-    out->vertex_attributes.emplace_back(attr);
+    AddTexCoordOp(&builder, out, quantize,
+                  [](const Vertex& vertex) { return vertex.uv4; });
   }
   if (model.CheckAttrib(Vertex::kAttribBit_Uv5)) {
-    builder.AddOp(
-        [](const Vertex& vertex) { return mathfu::vec2_packed(vertex.uv5); });
-
-    VertexAttributeT attr;
-    attr.usage = VertexAttributeUsage_TexCoord;
-    attr.type = VertexAttributeType_Vec2f;
-    out->vertex_attributes.emplace_back(attr);
+    AddTexCoordOp(&builder, out, quantize,
+                  [](const Vertex& vertex) { return vertex.uv5; });
   }
   if (model.CheckAttrib(Vertex::kAttribBit_Uv6)) {
-    builder.AddOp(
-        [](const Vertex& vertex) { return mathfu::vec2_packed(vertex.uv6); });
-
-    VertexAttributeT attr;
-    attr.usage = VertexAttributeUsage_TexCoord;
-    attr.type = VertexAttributeType_Vec2f;
-    out->vertex_attributes.emplace_back(attr);
+    AddTexCoordOp(&builder, out, quantize,
+                  [](const Vertex& vertex) { return vertex.uv6; });
   }
   if (model.CheckAttrib(Vertex::kAttribBit_Uv7)) {
-    builder.AddOp(
-        [](const Vertex& vertex) { return mathfu::vec2_packed(vertex.uv7); });
-
-    VertexAttributeT attr;
-    attr.usage = VertexAttributeUsage_TexCoord;
-    attr.type = VertexAttributeType_Vec2f;
-    out->vertex_attributes.emplace_back(attr);
+    AddTexCoordOp(&builder, out, quantize,
+                  [](const Vertex& vertex) { return vertex.uv7; });
   }
   if (model.CheckAttrib(Vertex::kAttribBit_Normal)) {
-    builder.AddOp([](const Vertex& vertex) {
-      return mathfu::vec3_packed(vertex.normal);
-    });
-    blend_builder.AddOp([](const Vertex::Blend& blend) {
-      return mathfu::vec3_packed(blend.normal);
-    });
-
     VertexAttributeT attr;
     attr.usage = VertexAttributeUsage_Normal;
-    attr.type = VertexAttributeType_Vec3f;
+    if (quantize) {
+      builder.AddOp([](const Vertex& vertex) {
+        return ToHalfVec4(mathfu::vec4(vertex.normal, 0.f));
+      });
+      blend_builder.AddOp([](const Vertex::Blend& blend) {
+        return ToHalfVec4(mathfu::vec4(blend.normal, 0.f));
+      });
+      attr.type = VertexAttributeType_Vec4hf;
+    } else {
+      builder.AddOp([](const Vertex& vertex) {
+        return mathfu::vec3_packed(vertex.normal);
+      });
+      blend_builder.AddOp([](const Vertex::Blend& blend) {
+        return mathfu::vec3_packed(blend.normal);
+      });
+      attr.type = VertexAttributeType_Vec3f;
+    }
     out->vertex_attributes.emplace_back(attr);
     out->blend_attributes.emplace_back(attr);
   }
   if (model.CheckAttrib(Vertex::kAttribBit_Tangent)) {
-    builder.AddOp([](const Vertex& vertex) {
-      return mathfu::vec4_packed(vertex.tangent);
-    });
-    blend_builder.AddOp([](const Vertex::Blend& blend) {
-      return mathfu::vec4_packed(blend.tangent);
-    });
-
     VertexAttributeT attr;
     attr.usage = VertexAttributeUsage_Tangent;
-    attr.type = VertexAttributeType_Vec4f;
+    if (quantize) {
+      builder.AddOp([](const Vertex& vertex) {
+        return ToHalfVec4(vertex.tangent);
+      });
+      blend_builder.AddOp([](const Vertex::Blend& blend) {
+        return ToHalfVec4(blend.tangent);
+      });
+      attr.type = VertexAttributeType_Vec4hf;
+    } else {
+      builder.AddOp([](const Vertex& vertex) {
+        return mathfu::vec4_packed(vertex.tangent);
+      });
+      blend_builder.AddOp([](const Vertex::Blend& blend) {
+        return mathfu::vec4_packed(blend.tangent);
+      });
+      attr.type = VertexAttributeType_Vec4f;
+    }
     out->vertex_attributes.emplace_back(attr);
     out->blend_attributes.emplace_back(attr);
   }
   if (model.CheckAttrib(Vertex::kAttribBit_Orientation)) {
-    builder.AddOp([](const Vertex& vertex) {
-      return mathfu::vec4_packed(vertex.orientation);
-    });
-    blend_builder.AddOp([](const Vertex::Blend& blend) {
-      return mathfu::vec4_packed(blend.orientation);
-    });
-
     VertexAttributeT attr;
     attr.usage = VertexAttributeUsage_Orientation;
-    attr.type = VertexAttributeType_Vec4f;
+    if (quantize) {
+      builder.AddOp([](const Vertex& vertex) {
+        return ToHalfVec4(vertex.orientation);
+      });
+      blend_builder.AddOp([](const Vertex::Blend& blend) {
+        return ToHalfVec4(blend.orientation);
+      });
+      attr.type = VertexAttributeType_Vec4hf;
+    } else {
+      builder.AddOp([](const Vertex& vertex) {
+        return mathfu::vec4_packed(vertex.orientation);
+      });
+      blend_builder.AddOp([](const Vertex::Blend& blend) {
+        return mathfu::vec4_packed(blend.orientation);
+      });
+      attr.type = VertexAttributeType_Vec4f;
+    }
     out->vertex_attributes.emplace_back(attr);
     out->blend_attributes.emplace_back(attr);
   }
@@ -38,6 +38,17 @@ struct ExportOptions {
   // If true, attempt a saving-throw on untextured materials by performing
   // a texture lookup based on the surface name.
   bool look_for_unlinked_textures = false;
+
+  // If true, reorder the triangles and vertices of each model for the
+  // post-transform vertex cache, overdraw and vertex fetch locality.
+  bool optimize_meshes = false;
+
+  // If true, store positions, normals, tangents, orientations and texture
+  // coordinates as half-floats instead of floats.  This roughly halves the
+  // size of the vertex data, at the cost of precision.  Quantized positions
+  // are not supported by the CPU-side mesh utilities (eg. raycasts), which
+  // require Vec3f positions.
+  bool quantize_vertices = false;
 };
 
 }  // namespace tool
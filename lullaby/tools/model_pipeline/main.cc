@@ -78,6 +78,14 @@ int Run(int argc, const char** argv) {
   args.AddArg("use-relative-paths")
       .SetDescription(
           "Paths embeded within the lullmodel will use relative paths.");
+  args.AddArg("optimize-meshes")
+      .SetDescription("Reorder triangles and vertices for the GPU's vertex"
+                      " cache, overdraw and vertex fetch. The vertex cache miss"
+                      " ratio before and after is written to the log.");
+  args.AddArg("quantize-vertices")
+      .SetDescription("Store vertex positions, normals, tangents and texture"
+                      " coordinates as half-floats to reduce the vertex buffer"
+                      " size.");
 
   // Parse the command-line arguments.
   if (!args.Parse(argc, argv)) {
@@ -181,6 +189,8 @@ int Run(int argc, const char** argv) {
   ExportOptions options;
   options.embed_textures = !args.IsSet("discrete-textures");
   options.relative_path = args.IsSet("use-relative-paths");
+  options.optimize_meshes = args.IsSet("optimize-meshes");
+  options.quantize_vertices = args.IsSet("quantize-vertices");
   if (args.IsSet("config-json")) {
     const string_view json = args.GetString("config-json");
     if (!pipeline.ImportUsingConfig(std::string(json))) {
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "lullaby/tools/model_pipeline/model.h"
 
+#include "lullaby/modules/render/mesh_optimizer.h"
 #include "lullaby/modules/render/tangent_generation.h"
 #include "lullaby/tools/model_pipeline/util.h"
 
@@ -243,6 +244,61 @@ void Model::ComputeTangentSpacesFromNormalsAndUvs() {
   }
 }
 
+void Model::OptimizeMesh() {
+  if (vertices_.empty()) {
+    return;
+  }
+
+  // Reorder the triangles within each drawable, and gather the indices of all
+  // drawables so that the shared vertices can be reordered.
+  std::vector<uint32_t> indices;
+  for (const Drawable& drawable : drawables_) {
+    const size_t start = indices.size();
+    indices.insert(indices.end(), drawable.indices.begin(),
+                   drawable.indices.end());
+    uint32_t* drawable_indices = indices.data() + start;
+    OptimizeVertexCache(drawable_indices, drawable.indices.size(),
+                        vertices_.size());
+    OptimizeOverdraw(drawable_indices, drawable.indices.size(),
+                     reinterpret_cast<const uint8_t*>(&vertices_[0].position),
+                     sizeof(vertices_[0]), vertices_.size());
+  }
+
+  const std::vector<uint32_t> remap =
+      OptimizeVertexFetch(indices.data(), indices.size(), vertices_.size());
+
+  size_t offset = 0;
+  for (Drawable& drawable : drawables_) {
+    for (size_t& index : drawable.indices) {
+      index = indices[offset++];
+    }
+  }
+
+  std::vector<Vertex> vertices(vertices_.size());
+  for (size_t i = 0; i < vertices_.size(); ++i) {
+    vertices[remap[i]] = std::move(vertices_[i]);
+  }
+  vertices_ = std::move(vertices);
+  for (auto& iter : vertex_map_) {
+    iter.second = remap[iter.second];
+  }
+}
+
+float Model::CalculateAcmr() const {
+  size_t num_triangles = 0;
+  float total_misses = 0.0f;
+  for (const Drawable& drawable : drawables_) {
+    const std::vector<uint32_t> indices(drawable.indices.begin(),
+                                        drawable.indices.end());
+    const size_t drawable_triangles = indices.size() / 3;
+    total_misses += lull::CalculateAcmr(indices.data(), indices.size()) *
+                    static_cast<float>(drawable_triangles);
+    num_triangles += drawable_triangles;
+  }
+  return num_triangles > 0 ? total_misses / static_cast<float>(num_triangles)
+                           : 0.0f;
+}
+
 void Model::ComputeOrientationsFromTangentSpaces(bool ensure_w_not_zero) {
   if (CheckAttrib(Vertex::kAttribBit_Orientation)) {
     return;
@@ -101,6 +101,13 @@ class Model {
 
   // Uses positions, normals, and tex coords to compute tangents and bitangents.
   void ComputeTangentSpacesFromNormalsAndUvs();
+  // Reorders the triangles of each drawable to make better use of the
+  // post-transform vertex cache and to reduce overdraw, then reorders the
+  // vertices in the order they are first used.
+  void OptimizeMesh();
+  // Returns the average cache miss ratio (vertices transformed per triangle)
+  // of the triangles in all drawables.
+  float CalculateAcmr() const;
   // Uses normals and tangents to compute orientation quaternions. If
   // ensure_w_nonzero is true, and the computed orientation quaternion results
   // in w == 0, w will be set to a small value such that its sign can be used to
@@ -23,6 +23,7 @@ limitations under the License.
 #include "lullaby/util/flatbuffer_writer.h"
 #include "lullaby/util/inward_buffer.h"
 #include "lullaby/tools/common/file_utils.h"
+#include "lullaby/tools/common/log.h"
 #include "lullaby/tools/model_pipeline/export.h"
 #include "lullaby/tools/model_pipeline/model.h"
 
@@ -342,6 +343,16 @@ bool ModelPipeline::Validate(const ExportOptions& options) {
 }
 
 bool ModelPipeline::Build(const ExportOptions options) {
+  if (options.optimize_meshes) {
+    for (auto& pair : imported_models_) {
+      Model& model = pair.second;
+      const float before = model.CalculateAcmr();
+      model.OptimizeMesh();
+      LogWrite("  Optimized %s: ACMR %.3f -> %.3f\n", pair.first.c_str(),
+               before, model.CalculateAcmr());
+    }
+  }
+
   lull_model_ =
       ExportModel(imported_models_, imported_textures_, options, &config_);
   for (const auto& pair : imported_models_) {
@@ -17,13 +17,16 @@ limitations under the License.
 #ifndef LULLABY_UTIL_ASYNC_PROCESSOR_H_
 #define LULLABY_UTIL_ASYNC_PROCESSOR_H_
 
+#include <condition_variable>
 #include <functional>
 #include <memory>
-#include <mutex> 
+#include <mutex>
 #include <thread>
+#include <utility>
 #include <vector>
 
-#include "lullaby/util/thread_safe_deque.h"
+#include "lullaby/util/inline_function.h"
+#include "lullaby/util/optional.h"
 
 #if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
 #define LULLABY_USE_JAVASCRIPT_TIMERS 1
@@ -37,10 +40,16 @@ namespace lull {
 
 // The AsyncProcessor is used for performing async operations on objects of type
 // |T| using worker threads.
+//
+// Requests are recycled through a free list and small processing functions are
+// stored inline, so once enough requests have been created to cover the peak
+// number in flight, submitting and dequeuing objects does not allocate.
 template <typename T>
 class AsyncProcessor {
  public:
-  // The function to be called on the object on the worker thread.
+  // The function to be called on the object on the worker thread.  Any functor
+  // callable with a T* may be used instead; those no larger than
+  // InlineFunction::kInlineSize are stored without allocating.
   using ProcessFn = std::function<void(T*)>;
 
   using TaskId = unsigned int;
@@ -69,15 +78,28 @@ class AsyncProcessor {
   // Queues an object and its processing function to be run on a worker thread.
   // Once completed, the object will be available to Dequeue().  Returns the
   // task ID.
-  TaskId Enqueue(T obj, ProcessFn fn) {
-    return EnqueueWithCompletionFlag(std::move(obj), fn, kAddToCompleteQueue);
+  template <typename Fn>
+  TaskId Enqueue(T obj, Fn&& fn) {
+    return EnqueueWithCompletionFlag(std::move(obj), std::forward<Fn>(fn),
+                                     kAddToCompleteQueue, 0);
+  }
+
+  // Like Enqueue, but with a |priority|.  Objects with higher priorities are
+  // processed, and become available to Dequeue(), before objects with lower
+  // priorities.  Objects with the same priority are handled in order.
+  template <typename Fn>
+  TaskId Enqueue(T obj, Fn&& fn, int priority) {
+    return EnqueueWithCompletionFlag(std::move(obj), std::forward<Fn>(fn),
+                                     kAddToCompleteQueue, priority);
   }
 
   // Queues an object and its processing function to be run on a worker thread.
   // Unlike Enqueue, once the processing is completed, the object will go out
   // of scope.  Returns the task ID.
-  TaskId Execute(T obj, ProcessFn fn) {
-    return EnqueueWithCompletionFlag(std::move(obj), fn, kExecuteOnly);
+  template <typename Fn>
+  TaskId Execute(T obj, Fn&& fn) {
+    return EnqueueWithCompletionFlag(std::move(obj), std::forward<Fn>(fn),
+                                     kExecuteOnly, 0);
   }
 
   // Dequeues a processed object by moving it to |out| and returns true.  If
@@ -89,6 +111,11 @@ class AsyncProcessor {
   // is executing, or has already completed.
   bool Cancel(TaskId id);
 
+  // Changes the priority of the task with |id|, whether it is waiting to be
+  // processed or to be dequeued.  Returns false if |id| isn't valid, is
+  // executing, or has already been dequeued.
+  bool SetPriority(TaskId id, int priority);
+
  private:
   // Indicate what to do with an object once its been processed.
   enum CompletionFlag {
@@ -96,26 +123,76 @@ class AsyncProcessor {
     kAddToCompleteQueue,
   };
 
-  // Internal data structure to represent the async request.
+  // Internal data structure to represent the async request.  Requests are
+  // pooled, so |object| and |process| are reset when a request is released.
   struct Request {
-    Request(TaskId id, T obj, ProcessFn fn, CompletionFlag completion_flag)
-        : id(id),
-          object(std::move(obj)),
-          process(std::move(fn)),
-          completion_flag(completion_flag) {}
-    TaskId id;
-    T object;
-    ProcessFn process;
-    CompletionFlag completion_flag;
+    TaskId id = kInvalidTaskId;
+    Optional<T> object;
+    InlineFunction<void(T*)> process;
+    CompletionFlag completion_flag = kExecuteOnly;
+    int priority = 0;
+    // The next request in the queue or free list holding this request.
+    Request* next = nullptr;
+  };
+
+  // An intrusive list of requests, ordered by descending priority, which
+  // unlike a std::deque never allocates.
+  class RequestQueue {
+   public:
+    RequestQueue() {}
+
+    RequestQueue(const RequestQueue&) = delete;
+    RequestQueue& operator=(const RequestQueue&) = delete;
+
+    // Inserts |req| after all requests with the same or a higher priority.
+    void InsertSorted(Request* req);
+
+    // Removes and returns the front request, or nullptr if there is none.
+    Request* PopFront();
+
+    // Removes and returns the front request, blocking the calling thread until
+    // one is available.  Returns nullptr if a stop signal was pushed instead,
+    // which takes precedence over all requests.
+    Request* WaitPopFront();
+
+    // Signals one thread waiting in WaitPopFront() to stop.
+    void PushStop();
+
+    // Removes and returns the first request for which test(request) returns
+    // true, or nullptr if there is none.
+    template <typename Fn>
+    Request* RemoveIf(Fn test);
+
+    // Calls update(request) on all requests and then re-sorts the queue,
+    // keeping the existing order of requests with the same priority.
+    template <typename Fn>
+    void UpdateSorted(Fn update);
+
+   private:
+    // Inserts |req| into the list at |head| without locking.
+    static void Insert(Request** head, Request** tail, Request* req);
+
+    std::mutex mutex_;
+    std::condition_variable condvar_;
+    Request* head_ = nullptr;
+    Request* tail_ = nullptr;
+    size_t num_stops_ = 0;
   };
-  using RequestPtr = std::unique_ptr<Request>;
 
   using Lock = std::unique_lock<std::mutex>;
 
   TaskId GetNextTaskId();
 
-  TaskId EnqueueWithCompletionFlag(T obj, ProcessFn fn,
-                                   CompletionFlag completion_flag);
+  template <typename Fn>
+  TaskId EnqueueWithCompletionFlag(T obj, Fn&& fn,
+                                   CompletionFlag completion_flag,
+                                   int priority);
+
+  // Returns a request from the free list, or a new one if it is empty.
+  Request* AcquireRequest();
+
+  // Resets |req| and returns it to the free list.
+  void ReleaseRequest(Request* req);
 
   void WorkerThread();
 
@@ -124,17 +201,20 @@ class AsyncProcessor {
 
   bool ProcessNextRequestNoWait();
 
-  void ProcessRequest(RequestPtr req);
+  void ProcessRequest(Request* req);
 
   void ScheduleNextRequest();
 
-  ThreadSafeDeque<RequestPtr> process_queue_;
-  ThreadSafeDeque<RequestPtr> complete_queue_;
+  RequestQueue process_queue_;
+  RequestQueue complete_queue_;
   std::vector<std::thread> worker_threads_;
 
   std::mutex mutex_;
   TaskId next_task_id_ = 1;
 
+  std::mutex free_list_mutex_;
+  Request* free_list_ = nullptr;
+
 #if LULLABY_USE_JAVASCRIPT_TIMERS
   using ThisType = AsyncProcessor<T>;
   struct WeakThisType {
@@ -145,6 +225,115 @@ class AsyncProcessor {
 #endif
 };
 
+template <typename T>
+void AsyncProcessor<T>::RequestQueue::Insert(Request** head, Request** tail,
+                                             Request* req) {
+  // Requests are usually queued with the same priority, so check the tail
+  // before searching the list.
+  if (*tail == nullptr || (*tail)->priority >= req->priority) {
+    req->next = nullptr;
+    if (*tail) {
+      (*tail)->next = req;
+    } else {
+      *head = req;
+    }
+    *tail = req;
+    return;
+  }
+  Request** link = head;
+  while ((*link)->priority >= req->priority) {
+    link = &(*link)->next;
+  }
+  req->next = *link;
+  *link = req;
+}
+
+template <typename T>
+void AsyncProcessor<T>::RequestQueue::InsertSorted(Request* req) {
+  Lock lock(mutex_);
+  Insert(&head_, &tail_, req);
+  condvar_.notify_one();
+}
+
+template <typename T>
+typename AsyncProcessor<T>::Request*
+AsyncProcessor<T>::RequestQueue::PopFront() {
+  Lock lock(mutex_);
+  Request* req = head_;
+  if (req) {
+    head_ = req->next;
+    if (head_ == nullptr) {
+      tail_ = nullptr;
+    }
+    req->next = nullptr;
+  }
+  return req;
+}
+
+template <typename T>
+typename AsyncProcessor<T>::Request*
+AsyncProcessor<T>::RequestQueue::WaitPopFront() {
+  Lock lock(mutex_);
+  while (head_ == nullptr && num_stops_ == 0) {
+    condvar_.wait(lock);
+  }
+  if (num_stops_ > 0) {
+    --num_stops_;
+    return nullptr;
+  }
+  Request* req = head_;
+  head_ = req->next;
+  if (head_ == nullptr) {
+    tail_ = nullptr;
+  }
+  req->next = nullptr;
+  return req;
+}
+
+template <typename T>
+void AsyncProcessor<T>::RequestQueue::PushStop() {
+  Lock lock(mutex_);
+  ++num_stops_;
+  condvar_.notify_one();
+}
+
+template <typename T>
+template <typename Fn>
+typename AsyncProcessor<T>::Request* AsyncProcessor<T>::RequestQueue::RemoveIf(
+    Fn test) {
+  Lock lock(mutex_);
+  Request* prev = nullptr;
+  for (Request** link = &head_; *link; link = &(*link)->next) {
+    Request* req = *link;
+    if (test(*req)) {
+      *link = req->next;
+      if (tail_ == req) {
+        tail_ = prev;
+      }
+      req->next = nullptr;
+      return req;
+    }
+    prev = req;
+  }
+  return nullptr;
+}
+
+template <typename T>
+template <typename Fn>
+void AsyncProcessor<T>::RequestQueue::UpdateSorted(Fn update) {
+  Lock lock(mutex_);
+  Request* req = head_;
+  head_ = nullptr;
+  tail_ = nullptr;
+  // Re-inserting in the existing order keeps the sort stable.
+  while (req) {
+    Request* next = req->next;
+    update(*req);
+    Insert(&head_, &tail_, req);
+    req = next;
+  }
+}
+
 template <typename T>
 AsyncProcessor<T>::AsyncProcessor(size_t num_worker_threads) {
   Start(num_worker_threads);
@@ -156,13 +345,22 @@ AsyncProcessor<T>::AsyncProcessor(size_t num_worker_threads) {
 template <typename T>
 AsyncProcessor<T>::~AsyncProcessor() {
   // Drain the queue of any remaining requests.
-  RequestPtr req = nullptr;
-  while (process_queue_.PopFront(&req)) {
+  while (Request* req = process_queue_.PopFront()) {
+    ReleaseRequest(req);
   }
   Stop();
 #if LULLABY_USE_JAVASCRIPT_TIMERS
   weak_this_ptr_->this_ptr = nullptr;
 #endif
+
+  while (Request* req = complete_queue_.PopFront()) {
+    delete req;
+  }
+  while (free_list_) {
+    Request* req = free_list_;
+    free_list_ = req->next;
+    delete req;
+  }
 }
 
 template <typename T>
@@ -190,9 +388,8 @@ void AsyncProcessor<T>::Start(size_t num_worker_threads) {
 template <typename T>
 void AsyncProcessor<T>::Stop() {
 #if !LULLABY_USE_JAVASCRIPT_TIMERS
-  // An empty (nullptr) request signals the thread to finish.
   for (size_t i = 0; i < worker_threads_.size(); ++i) {
-    process_queue_.PushFront(nullptr);
+    process_queue_.PushStop();
   }
   for (auto& thread : worker_threads_) {
     thread.join();
@@ -202,20 +399,50 @@ void AsyncProcessor<T>::Stop() {
 }
 
 template <typename T>
+typename AsyncProcessor<T>::Request* AsyncProcessor<T>::AcquireRequest() {
+  {
+    Lock lock(free_list_mutex_);
+    if (free_list_) {
+      Request* req = free_list_;
+      free_list_ = req->next;
+      req->next = nullptr;
+      return req;
+    }
+  }
+  return new Request();
+}
+
+template <typename T>
+void AsyncProcessor<T>::ReleaseRequest(Request* req) {
+  req->object.reset();
+  req->process.Reset();
+  Lock lock(free_list_mutex_);
+  req->next = free_list_;
+  free_list_ = req;
+}
+
+template <typename T>
+template <typename Fn>
 typename AsyncProcessor<T>::TaskId AsyncProcessor<T>::EnqueueWithCompletionFlag(
-    T obj, ProcessFn fn, CompletionFlag completion_flag) {
-  const TaskId id = GetNextTaskId();
-  RequestPtr req(new Request(id, std::move(obj), fn, kAddToCompleteQueue));
-  process_queue_.PushBack(std::move(req));
+    T obj, Fn&& fn, CompletionFlag completion_flag, int priority) {
+  Request* req = AcquireRequest();
+  req->id = GetNextTaskId();
+  req->object.emplace(std::move(obj));
+  req->process.Set(std::forward<Fn>(fn));
+  req->completion_flag = completion_flag;
+  req->priority = priority;
+  const TaskId id = req->id;
+  process_queue_.InsertSorted(req);
   ScheduleNextRequest();
   return id;
 }
 
 template <typename T>
 bool AsyncProcessor<T>::Dequeue(T* out) {
-  RequestPtr req = nullptr;
-  if (complete_queue_.PopFront(&req)) {
-    *out = std::move(req->object);
+  Request* req = complete_queue_.PopFront();
+  if (req) {
+    *out = std::move(*req->object);
+    ReleaseRequest(req);
     return true;
   }
 #if LULLABY_USE_JAVASCRIPT_TIMERS
@@ -226,15 +453,29 @@ bool AsyncProcessor<T>::Dequeue(T* out) {
 
 template <typename T>
 bool AsyncProcessor<T>::Cancel(TaskId id) {
-  bool removed = false;
-  process_queue_.RemoveIf([id, &removed](const RequestPtr& ptr) {
-    if (ptr->id == id) {
-      removed = true;
-      return true;
-    }
+  Request* req = process_queue_.RemoveIf(
+      [id](const Request& req) { return req.id == id; });
+  if (req == nullptr) {
     return false;
-  });
-  return removed;
+  }
+  ReleaseRequest(req);
+  return true;
+}
+
+template <typename T>
+bool AsyncProcessor<T>::SetPriority(TaskId id, int priority) {
+  bool found = false;
+  auto update = [id, priority, &found](Request& req) {
+    if (req.id == id) {
+      req.priority = priority;
+      found = true;
+    }
+  };
+  process_queue_.UpdateSorted(update);
+  if (!found) {
+    complete_queue_.UpdateSorted(update);
+  }
+  return found;
 }
 
 template <typename T>
@@ -246,9 +487,9 @@ void AsyncProcessor<T>::WorkerThread() {
 
 template <typename T>
 bool AsyncProcessor<T>::ProcessNextRequest() {
-  RequestPtr req = process_queue_.WaitPopFront();
+  Request* req = process_queue_.WaitPopFront();
   if (req) {
-    ProcessRequest(std::move(req));
+    ProcessRequest(req);
     return true;
   }
   // A nullptr request signals the thread to finish.
@@ -257,19 +498,21 @@ bool AsyncProcessor<T>::ProcessNextRequest() {
 
 template <typename T>
 bool AsyncProcessor<T>::ProcessNextRequestNoWait() {
-  RequestPtr req = nullptr;
-  if (process_queue_.PopFront(&req)) {
-    ProcessRequest(std::move(req));
+  Request* req = process_queue_.PopFront();
+  if (req) {
+    ProcessRequest(req);
     return true;
   }
   return false;
 }
 
 template <typename T>
-void AsyncProcessor<T>::ProcessRequest(RequestPtr req) {
-  req->process(&req->object);
+void AsyncProcessor<T>::ProcessRequest(Request* req) {
+  req->process(req->object.get());
   if (req->completion_flag == kAddToCompleteQueue) {
-    complete_queue_.PushBack(std::move(req));
+    complete_queue_.InsertSorted(req);
+  } else {
+    ReleaseRequest(req);
   }
 }
 
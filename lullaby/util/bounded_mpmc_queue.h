@@ -0,0 +1,209 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_BOUNDED_MPMC_QUEUE_H_
+#define LULLABY_UTIL_BOUNDED_MPMC_QUEUE_H_
+
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+// A fixed-capacity, lock-free queue that supports multiple producer threads and
+// multiple consumer threads.
+//
+// The queue is a ring buffer of preallocated elements, so the queue itself does
+// not allocate memory after construction.  Each element in the ring is paired
+// with a sequence number which producers and consumers use to claim elements
+// without locking (based on Dmitry Vyukov's bounded MPMC queue).  See
+// BoundedMpscQueue for a cheaper variant when there is a single consumer.
+//
+// The Enqueue/Dequeue/WaitDequeue/Empty functions mirror ThreadSafeQueue so the
+// two can be swapped at a use site.
+//
+// T must be default constructible and move assignable.  Elements that have been
+// dequeued are reset to a default constructed T so that the ring does not keep
+// any resources owned by dequeued elements alive.
+template <typename T>
+class BoundedMpmcQueue {
+ public:
+  // Creates a queue that can hold at least |capacity| elements.  The capacity
+  // is rounded up to the next power of two (and is at least 2).
+  explicit BoundedMpmcQueue(size_t capacity);
+
+  BoundedMpmcQueue(const BoundedMpmcQueue&) = delete;
+  BoundedMpmcQueue& operator=(const BoundedMpmcQueue&) = delete;
+
+  // Moves |obj| into the queue and returns true, or returns false without
+  // modifying |obj| if the queue is full.  Can be called from any thread.
+  bool TryEnqueue(T* obj);
+
+  // Enqueues an object into the queue, yielding the calling thread while the
+  // queue is full.  Can be called from any thread.
+  void Enqueue(T obj);
+
+  // Dequeues the next element in the queue by moving it into the object as
+  // specified by |out| and returns true.  If the queue is empty, the function
+  // does not modify the |out| parameter and returns false.  Can be called from
+  // any thread.
+  bool Dequeue(T* out);
+
+  // Dequeues the next element in the queue, yielding the calling thread until
+  // an element is available.  Can be called from any thread.
+  T WaitDequeue();
+
+  // Reports whether the queue is empty or not.  If other threads are using the
+  // queue concurrently, the result may already be out of date.
+  bool Empty() const;
+
+  // Returns the maximum number of elements the queue can hold.
+  size_t Capacity() const { return mask_ + 1; }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static size_t RoundUpToPowerOfTwo(size_t value);
+
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  // The position of the next element to enqueue, shared by all producers.
+  alignas(kCacheLineSize) std::atomic<size_t> tail_;
+  // The position of the next element to dequeue, shared by all consumers.
+  alignas(kCacheLineSize) std::atomic<size_t> head_;
+};
+
+template <typename T>
+BoundedMpmcQueue<T>::BoundedMpmcQueue(size_t capacity)
+    : mask_(RoundUpToPowerOfTwo(capacity) - 1),
+      cells_(new Cell[mask_ + 1]),
+      tail_(0),
+      head_(0) {
+  for (size_t i = 0; i <= mask_; ++i) {
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+bool BoundedMpmcQueue<T>::TryEnqueue(T* obj) {
+  size_t pos = tail_.load(std::memory_order_relaxed);
+  Cell* cell = nullptr;
+  while (true) {
+    cell = &cells_[pos & mask_];
+    const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    const ptrdiff_t diff =
+        static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos);
+    if (diff == 0) {
+      // The cell is free, so try to claim it.
+      if (tail_.compare_exchange_weak(pos, pos + 1,
+                                      std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // The cell still holds an element from the previous lap of the ring.
+      return false;
+    } else {
+      // Another producer claimed the cell first.
+      pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->value = std::move(*obj);
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+void BoundedMpmcQueue<T>::Enqueue(T obj) {
+  while (!TryEnqueue(&obj)) {
+    std::this_thread::yield();
+  }
+}
+
+template <typename T>
+bool BoundedMpmcQueue<T>::Dequeue(T* out) {
+  size_t pos = head_.load(std::memory_order_relaxed);
+  Cell* cell = nullptr;
+  while (true) {
+    cell = &cells_[pos & mask_];
+    const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    const ptrdiff_t diff =
+        static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos + 1);
+    if (diff == 0) {
+      // The cell holds an element, so try to claim it.
+      if (head_.compare_exchange_weak(pos, pos + 1,
+                                      std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // The cell has not been filled yet, so the queue is empty.
+      return false;
+    } else {
+      // Another consumer claimed the cell first.
+      pos = head_.load(std::memory_order_relaxed);
+    }
+  }
+
+  if (out != nullptr) {
+    *out = std::move(cell->value);
+  }
+  cell->value = T();
+  // Release the cell for the producers in the next lap of the ring.
+  cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+T BoundedMpmcQueue<T>::WaitDequeue() {
+  T obj;
+  while (!Dequeue(&obj)) {
+    std::this_thread::yield();
+  }
+  return obj;
+}
+
+template <typename T>
+bool BoundedMpmcQueue<T>::Empty() const {
+  const size_t pos = head_.load(std::memory_order_relaxed);
+  const Cell& cell = cells_[pos & mask_];
+  return cell.sequence.load(std::memory_order_acquire) != pos + 1;
+}
+
+template <typename T>
+size_t BoundedMpmcQueue<T>::RoundUpToPowerOfTwo(size_t value) {
+  if (value == 0) {
+    LOG(DFATAL) << "BoundedMpmcQueue capacity must be non-zero.";
+  }
+  // The sequence numbers cannot distinguish a full cell from an empty one in a
+  // ring with a single cell, so use at least two.
+  size_t result = 2;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+}  // namespace lull
+
+#endif  // LULLABY_UTIL_BOUNDED_MPMC_QUEUE_H_
@@ -0,0 +1,164 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_BOUNDED_MPSC_QUEUE_H_
+#define LULLABY_UTIL_BOUNDED_MPSC_QUEUE_H_
+
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+// A fixed-capacity, lock-free queue that supports multiple producer threads and
+// a single consumer thread.
+//
+// The queue is a ring buffer of preallocated elements, so the queue itself does
+// not allocate memory after construction.  Each element in the ring is paired
+// with a sequence number which producers and the consumer use to claim elements
+// without locking (based on Dmitry Vyukov's bounded MPMC queue).
+//
+// T must be default constructible and move assignable.  Elements that have been
+// dequeued are reset to a default constructed T so that the ring does not keep
+// any resources owned by dequeued elements alive.
+template <typename T>
+class BoundedMpscQueue {
+ public:
+  // Creates a queue that can hold at least |capacity| elements.  The capacity
+  // is rounded up to the next power of two (and is at least 2).
+  explicit BoundedMpscQueue(size_t capacity);
+
+  BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+  BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+  // Moves |obj| into the queue and returns true, or returns false without
+  // modifying |obj| if the queue is full.  Can be called from any thread.
+  bool TryEnqueue(T* obj);
+
+  // Dequeues the next element in the queue by moving it into the object as
+  // specified by |out| and returns true.  If the queue is empty, the function
+  // does not modify the |out| parameter and returns false.  Must only be called
+  // by a single thread at a time.
+  bool Dequeue(T* out);
+
+  // Reports whether the queue is empty or not.  If producers are enqueuing
+  // concurrently, the result may already be out of date.
+  bool Empty() const;
+
+  // Returns the maximum number of elements the queue can hold.
+  size_t Capacity() const { return mask_ + 1; }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static size_t RoundUpToPowerOfTwo(size_t value);
+
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  // The position of the next element to enqueue, shared by all producers.
+  std::atomic<size_t> tail_;
+  // The position of the next element to dequeue, owned by the consumer.
+  std::atomic<size_t> head_;
+};
+
+template <typename T>
+BoundedMpscQueue<T>::BoundedMpscQueue(size_t capacity)
+    : mask_(RoundUpToPowerOfTwo(capacity) - 1),
+      cells_(new Cell[mask_ + 1]),
+      tail_(0),
+      head_(0) {
+  for (size_t i = 0; i <= mask_; ++i) {
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+bool BoundedMpscQueue<T>::TryEnqueue(T* obj) {
+  size_t pos = tail_.load(std::memory_order_relaxed);
+  Cell* cell = nullptr;
+  while (true) {
+    cell = &cells_[pos & mask_];
+    const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    const ptrdiff_t diff =
+        static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos);
+    if (diff == 0) {
+      // The cell is free, so try to claim it.
+      if (tail_.compare_exchange_weak(pos, pos + 1,
+                                      std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // The cell still holds an element from the previous lap of the ring.
+      return false;
+    } else {
+      // Another producer claimed the cell first.
+      pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->value = std::move(*obj);
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+bool BoundedMpscQueue<T>::Dequeue(T* out) {
+  const size_t pos = head_.load(std::memory_order_relaxed);
+  Cell* cell = &cells_[pos & mask_];
+  const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+  if (sequence != pos + 1) {
+    return false;
+  }
+
+  if (out != nullptr) {
+    *out = std::move(cell->value);
+  }
+  cell->value = T();
+  // Release the cell for the producers in the next lap of the ring.
+  cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+  head_.store(pos + 1, std::memory_order_relaxed);
+  return true;
+}
+
+template <typename T>
+bool BoundedMpscQueue<T>::Empty() const {
+  const size_t pos = head_.load(std::memory_order_relaxed);
+  const Cell& cell = cells_[pos & mask_];
+  return cell.sequence.load(std::memory_order_acquire) != pos + 1;
+}
+
+template <typename T>
+size_t BoundedMpscQueue<T>::RoundUpToPowerOfTwo(size_t value) {
+  if (value == 0) {
+    LOG(DFATAL) << "BoundedMpscQueue capacity must be non-zero.";
+  }
+  // The sequence numbers cannot distinguish a full cell from an empty one in a
+  // ring with a single cell, so use at least two.
+  size_t result = 2;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+}  // namespace lull
+
+#endif  // LULLABY_UTIL_BOUNDED_MPSC_QUEUE_H_
@@ -0,0 +1,176 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_BOUNDED_SPSC_QUEUE_H_
+#define LULLABY_UTIL_BOUNDED_SPSC_QUEUE_H_
+
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+// A fixed-capacity, lock-free queue that supports a single producer thread and
+// a single consumer thread.
+//
+// The queue is a ring buffer of preallocated elements indexed by a head and a
+// tail counter.  Each counter is only written by one side, and each side keeps
+// a cached copy of the other side's counter so that it only needs to touch the
+// other side's cache line when the ring appears full (or empty).
+//
+// The Enqueue/Dequeue/WaitDequeue/Empty functions mirror ThreadSafeQueue so the
+// two can be swapped at a use site with a single producer and consumer.
+//
+// T must be default constructible and move assignable.  Elements that have been
+// dequeued are reset to a default constructed T so that the ring does not keep
+// any resources owned by dequeued elements alive.
+template <typename T>
+class BoundedSpscQueue {
+ public:
+  // Creates a queue that can hold at least |capacity| elements.  The capacity
+  // is rounded up to the next power of two.
+  explicit BoundedSpscQueue(size_t capacity);
+
+  BoundedSpscQueue(const BoundedSpscQueue&) = delete;
+  BoundedSpscQueue& operator=(const BoundedSpscQueue&) = delete;
+
+  // Moves |obj| into the queue and returns true, or returns false without
+  // modifying |obj| if the queue is full.  Must only be called by the producer.
+  bool TryEnqueue(T* obj);
+
+  // Enqueues an object into the queue, yielding the calling thread while the
+  // queue is full.  Must only be called by the producer.
+  void Enqueue(T obj);
+
+  // Dequeues the next element in the queue by moving it into the object as
+  // specified by |out| and returns true.  If the queue is empty, the function
+  // does not modify the |out| parameter and returns false.  Must only be called
+  // by the consumer.
+  bool Dequeue(T* out);
+
+  // Dequeues the next element in the queue, yielding the calling thread until
+  // an element is available.  Must only be called by the consumer.
+  T WaitDequeue();
+
+  // Reports whether the queue is empty or not.  If the other thread is using
+  // the queue concurrently, the result may already be out of date.
+  bool Empty() const;
+
+  // Returns the maximum number of elements the queue can hold.
+  size_t Capacity() const { return mask_ + 1; }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  static size_t RoundUpToPowerOfTwo(size_t value);
+
+  const size_t mask_;
+  std::unique_ptr<T[]> elements_;
+
+  // The position of the next element to dequeue, written by the consumer, and
+  // the consumer's cached copy of tail_.
+  alignas(kCacheLineSize) std::atomic<size_t> head_;
+  size_t cached_tail_;
+
+  // The position of the next element to enqueue, written by the producer, and
+  // the producer's cached copy of head_.
+  alignas(kCacheLineSize) std::atomic<size_t> tail_;
+  size_t cached_head_;
+};
+
+template <typename T>
+BoundedSpscQueue<T>::BoundedSpscQueue(size_t capacity)
+    : mask_(RoundUpToPowerOfTwo(capacity) - 1),
+      elements_(new T[mask_ + 1]),
+      head_(0),
+      cached_tail_(0),
+      tail_(0),
+      cached_head_(0) {}
+
+template <typename T>
+bool BoundedSpscQueue<T>::TryEnqueue(T* obj) {
+  const size_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail - cached_head_ > mask_) {
+    cached_head_ = head_.load(std::memory_order_acquire);
+    if (tail - cached_head_ > mask_) {
+      return false;
+    }
+  }
+
+  elements_[tail & mask_] = std::move(*obj);
+  tail_.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+void BoundedSpscQueue<T>::Enqueue(T obj) {
+  while (!TryEnqueue(&obj)) {
+    std::this_thread::yield();
+  }
+}
+
+template <typename T>
+bool BoundedSpscQueue<T>::Dequeue(T* out) {
+  const size_t head = head_.load(std::memory_order_relaxed);
+  if (head == cached_tail_) {
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    if (head == cached_tail_) {
+      return false;
+    }
+  }
+
+  T& element = elements_[head & mask_];
+  if (out != nullptr) {
+    *out = std::move(element);
+  }
+  element = T();
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+T BoundedSpscQueue<T>::WaitDequeue() {
+  T obj;
+  while (!Dequeue(&obj)) {
+    std::this_thread::yield();
+  }
+  return obj;
+}
+
+template <typename T>
+bool BoundedSpscQueue<T>::Empty() const {
+  return head_.load(std::memory_order_acquire) ==
+         tail_.load(std::memory_order_acquire);
+}
+
+template <typename T>
+size_t BoundedSpscQueue<T>::RoundUpToPowerOfTwo(size_t value) {
+  if (value == 0) {
+    LOG(DFATAL) << "BoundedSpscQueue capacity must be non-zero.";
+  }
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+}  // namespace lull
+
+#endif  // LULLABY_UTIL_BOUNDED_SPSC_QUEUE_H_
@@ -0,0 +1,155 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/data_container_pool.h"
+
+#include <mutex>
+#include <vector>
+
+#include "lullaby/util/aligned_alloc.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+namespace {
+
+// One size class for each power of two from kMinPooledSize to kMaxPooledSize.
+constexpr int kNumSizeClasses = 17;
+static_assert((DataContainerPool::kMinPooledSize << (kNumSizeClasses - 1)) ==
+                  DataContainerPool::kMaxPooledSize,
+              "Size classes must cover all pooled sizes.");
+
+struct PoolState {
+  std::mutex mutex;
+  std::vector<uint8_t*> free_buffers[kNumSizeClasses];
+  DataContainerPool::Stats stats;
+};
+
+// The state is never destroyed so that DataContainers released during static
+// destruction can still return their buffers.
+PoolState* GetState() {
+  static PoolState* state = new PoolState();
+  return state;
+}
+
+int GetSizeClass(size_t size) {
+  int size_class = 0;
+  size_t class_size = DataContainerPool::kMinPooledSize;
+  while (class_size < size) {
+    class_size <<= 1;
+    ++size_class;
+  }
+  return size_class;
+}
+
+size_t GetClassSize(int size_class) {
+  return DataContainerPool::kMinPooledSize << size_class;
+}
+
+void ReleaseBuffer(const uint8_t* ptr, int size_class) {
+  uint8_t* buffer = const_cast<uint8_t*>(ptr);
+  const size_t class_size = GetClassSize(size_class);
+
+  PoolState* state = GetState();
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    --state->stats.num_in_use;
+    if (state->stats.free_bytes + class_size <=
+        DataContainerPool::kMaxFreeBytes) {
+      state->free_buffers[size_class].push_back(buffer);
+      ++state->stats.num_free;
+      state->stats.free_bytes += class_size;
+      return;
+    }
+  }
+  AlignedFree(buffer);
+}
+
+}  // namespace
+
+DataContainer DataContainerPool::Allocate(size_t capacity, size_t alignment) {
+  if (alignment > kMaxAlignment || (alignment & (alignment - 1)) != 0) {
+    LOG(DFATAL) << "Unsupported DataContainer alignment: " << alignment;
+    alignment = kMaxAlignment;
+  }
+
+  PoolState* state = GetState();
+  if (capacity > kMaxPooledSize) {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      ++state->stats.num_allocations;
+      ++state->stats.num_unpooled;
+    }
+    auto* buffer =
+        static_cast<uint8_t*>(AlignedAlloc(capacity, kMaxAlignment));
+    return DataContainer(
+        DataContainer::DataPtr(
+            buffer,
+            [](const uint8_t* ptr) { AlignedFree(const_cast<uint8_t*>(ptr)); }),
+        capacity, DataContainer::kAll);
+  }
+
+  const int size_class = GetSizeClass(capacity);
+  uint8_t* buffer = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    ++state->stats.num_allocations;
+    ++state->stats.num_in_use;
+    std::vector<uint8_t*>& free_buffers = state->free_buffers[size_class];
+    if (!free_buffers.empty()) {
+      buffer = free_buffers.back();
+      free_buffers.pop_back();
+      ++state->stats.num_reused;
+      --state->stats.num_free;
+      state->stats.free_bytes -= GetClassSize(size_class);
+    }
+  }
+  if (buffer == nullptr) {
+    buffer = static_cast<uint8_t*>(
+        AlignedAlloc(GetClassSize(size_class), kMaxAlignment));
+  }
+
+  return DataContainer(
+      DataContainer::DataPtr(buffer,
+                             [size_class](const uint8_t* ptr) {
+                               ReleaseBuffer(ptr, size_class);
+                             }),
+      capacity, DataContainer::kAll);
+}
+
+DataContainerPool::Stats DataContainerPool::GetStats() {
+  PoolState* state = GetState();
+  std::lock_guard<std::mutex> lock(state->mutex);
+  return state->stats;
+}
+
+void DataContainerPool::Trim() {
+  std::vector<uint8_t*> buffers;
+  PoolState* state = GetState();
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    for (auto& free_buffers : state->free_buffers) {
+      buffers.insert(buffers.end(), free_buffers.begin(), free_buffers.end());
+      free_buffers.clear();
+    }
+    state->stats.num_free = 0;
+    state->stats.free_bytes = 0;
+  }
+  for (uint8_t* buffer : buffers) {
+    AlignedFree(buffer);
+  }
+}
+
+}  // namespace lull
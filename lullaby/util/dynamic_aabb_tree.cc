@@ -0,0 +1,340 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/dynamic_aabb_tree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+namespace {
+
+float SurfaceArea(const Aabb& aabb) {
+  const mathfu::vec3 size = aabb.max - aabb.min;
+  return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool Contains(const Aabb& outer, const Aabb& inner) {
+  return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y &&
+         outer.min.z <= inner.min.z && inner.max.x <= outer.max.x &&
+         inner.max.y <= outer.max.y && inner.max.z <= outer.max.z;
+}
+
+}  // namespace
+
+const DynamicAabbTree::ProxyId DynamicAabbTree::kInvalidProxy = -1;
+
+DynamicAabbTree::DynamicAabbTree(float margin) : margin_(margin) {}
+
+DynamicAabbTree::ProxyId DynamicAabbTree::Insert(const Aabb& aabb,
+                                                 Entity entity) {
+  const ProxyId id = AllocateNode();
+  Node& node = nodes_[id];
+  node.aabb.min = aabb.min - mathfu::vec3(margin_);
+  node.aabb.max = aabb.max + mathfu::vec3(margin_);
+  node.entity = entity;
+  node.height = 0;
+  InsertLeaf(id);
+  ++num_proxies_;
+  return id;
+}
+
+void DynamicAabbTree::Remove(ProxyId id) {
+  if (id < 0 || id >= static_cast<ProxyId>(nodes_.size()) ||
+      !nodes_[id].IsLeaf() || nodes_[id].height < 0) {
+    LOG(DFATAL) << "Invalid proxy: " << id;
+    return;
+  }
+  RemoveLeaf(id);
+  FreeNode(id);
+  --num_proxies_;
+}
+
+bool DynamicAabbTree::Update(ProxyId id, const Aabb& aabb) {
+  if (id < 0 || id >= static_cast<ProxyId>(nodes_.size()) ||
+      !nodes_[id].IsLeaf() || nodes_[id].height < 0) {
+    LOG(DFATAL) << "Invalid proxy: " << id;
+    return false;
+  }
+  if (Contains(nodes_[id].aabb, aabb)) {
+    return false;
+  }
+
+  RemoveLeaf(id);
+  nodes_[id].aabb.min = aabb.min - mathfu::vec3(margin_);
+  nodes_[id].aabb.max = aabb.max + mathfu::vec3(margin_);
+  InsertLeaf(id);
+  return true;
+}
+
+void DynamicAabbTree::Clear() {
+  nodes_.clear();
+  root_ = kInvalidProxy;
+  free_list_ = kInvalidProxy;
+  num_proxies_ = 0;
+}
+
+Entity DynamicAabbTree::GetEntity(ProxyId id) const {
+  return nodes_[id].entity;
+}
+
+const Aabb& DynamicAabbTree::GetFatAabb(ProxyId id) const {
+  return nodes_[id].aabb;
+}
+
+int DynamicAabbTree::GetHeight() const {
+  return root_ == kInvalidProxy ? 0 : nodes_[root_].height;
+}
+
+DynamicAabbTree::ProxyId DynamicAabbTree::AllocateNode() {
+  if (free_list_ == kInvalidProxy) {
+    nodes_.emplace_back();
+    return static_cast<ProxyId>(nodes_.size() - 1);
+  }
+
+  const ProxyId id = free_list_;
+  free_list_ = nodes_[id].parent;
+  nodes_[id] = Node();
+  return id;
+}
+
+void DynamicAabbTree::FreeNode(ProxyId id) {
+  nodes_[id] = Node();
+  nodes_[id].parent = free_list_;
+  free_list_ = id;
+}
+
+void DynamicAabbTree::InsertLeaf(ProxyId leaf) {
+  if (root_ == kInvalidProxy) {
+    root_ = leaf;
+    nodes_[leaf].parent = kInvalidProxy;
+    return;
+  }
+
+  // Find the best sibling for the leaf by descending the tree, using the
+  // surface area of the merged bounds as the cost.
+  const Aabb leaf_aabb = nodes_[leaf].aabb;
+  ProxyId index = root_;
+  while (!nodes_[index].IsLeaf()) {
+    const Node& node = nodes_[index];
+    const float area = SurfaceArea(node.aabb);
+    const float combined_area = SurfaceArea(MergeAabbs(node.aabb, leaf_aabb));
+
+    // Cost of creating a new parent for this node and the new leaf.
+    const float cost = 2.f * combined_area;
+    // Minimum cost of pushing the leaf further down the tree.
+    const float inheritance_cost = 2.f * (combined_area - area);
+
+    auto descend_cost = [&](ProxyId child) {
+      const Node& child_node = nodes_[child];
+      const float merged = SurfaceArea(MergeAabbs(leaf_aabb, child_node.aabb));
+      if (child_node.IsLeaf()) {
+        return merged + inheritance_cost;
+      }
+      return merged - SurfaceArea(child_node.aabb) + inheritance_cost;
+    };
+    const float cost1 = descend_cost(node.child1);
+    const float cost2 = descend_cost(node.child2);
+
+    if (cost < cost1 && cost < cost2) {
+      break;
+    }
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+  const ProxyId sibling = index;
+
+  // Create a new parent for the sibling and the leaf.
+  const ProxyId old_parent = nodes_[sibling].parent;
+  const ProxyId new_parent = AllocateNode();
+  nodes_[new_parent].parent = old_parent;
+  nodes_[new_parent].aabb = MergeAabbs(leaf_aabb, nodes_[sibling].aabb);
+  nodes_[new_parent].height = nodes_[sibling].height + 1;
+  nodes_[new_parent].child1 = sibling;
+  nodes_[new_parent].child2 = leaf;
+  nodes_[sibling].parent = new_parent;
+  nodes_[leaf].parent = new_parent;
+
+  if (old_parent == kInvalidProxy) {
+    root_ = new_parent;
+  } else if (nodes_[old_parent].child1 == sibling) {
+    nodes_[old_parent].child1 = new_parent;
+  } else {
+    nodes_[old_parent].child2 = new_parent;
+  }
+
+  Refit(nodes_[leaf].parent);
+}
+
+void DynamicAabbTree::RemoveLeaf(ProxyId leaf) {
+  if (leaf == root_) {
+    root_ = kInvalidProxy;
+    return;
+  }
+
+  const ProxyId parent = nodes_[leaf].parent;
+  const ProxyId grand_parent = nodes_[parent].parent;
+  const ProxyId sibling = nodes_[parent].child1 == leaf
+                              ? nodes_[parent].child2
+                              : nodes_[parent].child1;
+
+  if (grand_parent == kInvalidProxy) {
+    root_ = sibling;
+    nodes_[sibling].parent = kInvalidProxy;
+  } else {
+    // Replace the parent with the sibling.
+    if (nodes_[grand_parent].child1 == parent) {
+      nodes_[grand_parent].child1 = sibling;
+    } else {
+      nodes_[grand_parent].child2 = sibling;
+    }
+    nodes_[sibling].parent = grand_parent;
+    Refit(grand_parent);
+  }
+  FreeNode(parent);
+  nodes_[leaf].parent = kInvalidProxy;
+}
+
+void DynamicAabbTree::Refit(ProxyId id) {
+  while (id != kInvalidProxy) {
+    id = Balance(id);
+
+    Node& node = nodes_[id];
+    const Node& child1 = nodes_[node.child1];
+    const Node& child2 = nodes_[node.child2];
+    node.height = 1 + std::max(child1.height, child2.height);
+    node.aabb = MergeAabbs(child1.aabb, child2.aabb);
+    id = node.parent;
+  }
+}
+
+// Performs a left or right rotation if the node |a| is imbalanced, and returns
+// the index of the node that replaced it.
+DynamicAabbTree::ProxyId DynamicAabbTree::Balance(ProxyId a) {
+  if (nodes_[a].IsLeaf() || nodes_[a].height < 2) {
+    return a;
+  }
+
+  const ProxyId b = nodes_[a].child1;
+  const ProxyId c = nodes_[a].child2;
+  const int balance = nodes_[c].height - nodes_[b].height;
+
+  // Rotates |child| up to replace |a|, with |other| being the remaining child
+  // of |a|.
+  auto rotate_up = [this, a](ProxyId child, ProxyId other) {
+    Node& node_a = nodes_[a];
+    Node& node_child = nodes_[child];
+    const ProxyId f = node_child.child1;
+    const ProxyId g = node_child.child2;
+
+    // Swap |a| and |child|.
+    node_child.child1 = a;
+    node_child.parent = node_a.parent;
+    node_a.parent = child;
+
+    // |a|'s old parent should point to |child|.
+    if (node_child.parent == kInvalidProxy) {
+      root_ = child;
+    } else if (nodes_[node_child.parent].child1 == a) {
+      nodes_[node_child.parent].child1 = child;
+    } else {
+      nodes_[node_child.parent].child2 = child;
+    }
+
+    // Keep the taller grandchild under |child|, and move the other under |a|.
+    const bool keep_f = nodes_[f].height > nodes_[g].height;
+    const ProxyId kept = keep_f ? f : g;
+    const ProxyId moved = keep_f ? g : f;
+    node_child.child2 = kept;
+    if (node_a.child1 == child) {
+      node_a.child1 = moved;
+    } else {
+      node_a.child2 = moved;
+    }
+    nodes_[moved].parent = a;
+
+    node_a.aabb = MergeAabbs(nodes_[other].aabb, nodes_[moved].aabb);
+    node_a.height = 1 + std::max(nodes_[other].height, nodes_[moved].height);
+    node_child.aabb = MergeAabbs(node_a.aabb, nodes_[kept].aabb);
+    node_child.height = 1 + std::max(node_a.height, nodes_[kept].height);
+    return child;
+  };
+
+  if (balance > 1) {
+    return rotate_up(c, b);
+  } else if (balance < -1) {
+    return rotate_up(b, c);
+  }
+  return a;
+}
+
+float DynamicAabbTree::IntersectRay(const RayTestData& ray, const Aabb& aabb) {
+  // Standard slab test.  NaNs (from 0 * infinity) are discarded by the min/max
+  // ordering below, which treats the ray as parallel to that slab.
+  float t_min = 0.f;
+  float t_max = std::numeric_limits<float>::max();
+  for (int i = 0; i < 3; ++i) {
+    const float t1 = (aabb.min[i] - ray.origin[i]) * ray.inv_direction[i];
+    const float t2 = (aabb.max[i] - ray.origin[i]) * ray.inv_direction[i];
+    t_min = std::max(t_min, std::min(t1, t2));
+    t_max = std::min(t_max, std::max(t1, t2));
+  }
+  if (t_min > t_max) {
+    return kNoHitDistance;
+  }
+  return t_min * ray.length;
+}
+
+DynamicAabbTree::FrustumTestResult DynamicAabbTree::TestFrustum(
+    const mathfu::vec4* planes, const Aabb& aabb) {
+  const mathfu::vec3 center = (aabb.min + aabb.max) * 0.5f;
+  const mathfu::vec3 extents = (aabb.max - aabb.min) * 0.5f;
+  FrustumTestResult result = kInsideFrustum;
+  for (int i = 0; i < kNumFrustumPlanes; ++i) {
+    const mathfu::vec4& plane = planes[i];
+    // The signed distance from the plane to the center of the box, and the
+    // largest distance from the center to a corner along the plane's normal.
+    const float distance =
+        mathfu::vec4::DotProduct(plane, mathfu::vec4(center, 1.f));
+    const float radius = std::abs(plane.x) * extents.x +
+                         std::abs(plane.y) * extents.y +
+                         std::abs(plane.z) * extents.z;
+    if (distance < -radius) {
+      return kOutsideFrustum;
+    } else if (distance < radius) {
+      result = kIntersectsFrustum;
+    }
+  }
+  return result;
+}
+
+bool DynamicAabbTree::Overlaps(const Aabb& a, const Aabb& b) {
+  return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y &&
+         b.min.y <= a.max.y && a.min.z <= b.max.z && b.min.z <= a.max.z;
+}
+
+float DynamicAabbTree::DistanceToAabb(const mathfu::vec3& point,
+                                      const Aabb& aabb) {
+  const mathfu::vec3 closest(
+      mathfu::Clamp(point.x, aabb.min.x, aabb.max.x),
+      mathfu::Clamp(point.y, aabb.min.y, aabb.max.y),
+      mathfu::Clamp(point.z, aabb.min.z, aabb.max.z));
+  return (point - closest).Length();
+}
+
+}  // namespace lull
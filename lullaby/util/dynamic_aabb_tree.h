@@ -0,0 +1,355 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_DYNAMIC_AABB_TREE_H_
+#define LULLABY_UTIL_DYNAMIC_AABB_TREE_H_
+
+#include <stdint.h>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "lullaby/util/entity.h"
+#include "lullaby/util/math.h"
+
+namespace lull {
+
+// A bounding volume hierarchy of Aabbs that can be incrementally updated as the
+// volumes move.  Each leaf (or "proxy") stores a "fat" Aabb that is padded by a
+// margin so that small movements do not require the tree to be restructured.
+// The tree is kept balanced using tree rotations, so ray and point queries run
+// in logarithmic time.
+//
+// Example usage:
+// DynamicAabbTree tree(/* margin = */ 0.1f);
+// const DynamicAabbTree::ProxyId id = tree.Insert(world_aabb, entity);
+// tree.Update(id, new_world_aabb);
+// tree.QueryPoint(point, [](Entity e) { ... });
+class DynamicAabbTree {
+ public:
+  using ProxyId = int32_t;
+  static const ProxyId kInvalidProxy;
+
+  explicit DynamicAabbTree(float margin = 0.f);
+
+  DynamicAabbTree(const DynamicAabbTree&) = delete;
+  DynamicAabbTree& operator=(const DynamicAabbTree&) = delete;
+
+  // Adds a proxy for |entity| bounded by |aabb| to the tree, returning its id.
+  ProxyId Insert(const Aabb& aabb, Entity entity);
+
+  // Removes the proxy with |id| from the tree.
+  void Remove(ProxyId id);
+
+  // Updates the bounds of the proxy with |id|.  The tree is only restructured
+  // if |aabb| no longer fits in the fat Aabb of the proxy, in which case this
+  // function returns true.
+  bool Update(ProxyId id, const Aabb& aabb);
+
+  // Removes all proxies from the tree.
+  void Clear();
+
+  // Returns the Entity associated with the proxy |id|.
+  Entity GetEntity(ProxyId id) const;
+
+  // Returns the padded bounds of the proxy |id|.
+  const Aabb& GetFatAabb(ProxyId id) const;
+
+  // Returns the number of proxies in the tree.
+  size_t Size() const { return num_proxies_; }
+
+  // Returns the height of the tree, or 0 if it is empty.
+  int GetHeight() const;
+
+  // Calls |fn| with the Entity of every proxy whose fat Aabb is hit by |ray|
+  // no further than |max_distance| away from the ray origin.  |fn| must return
+  // the new maximum distance for the rest of the query (eg. the distance to the
+  // closest exact hit so far), which allows the query to skip any subtree that
+  // lies further away.  Nearer subtrees are visited first.  Distances are
+  // measured from the ray origin in world units (ie. they do not depend on the
+  // length of the ray direction).
+  template <typename Fn>
+  void Raycast(const Ray& ray, float max_distance, Fn&& fn) const;
+
+  // Calls |fn| with the Entity of every proxy whose fat Aabb contains |point|.
+  template <typename Fn>
+  void QueryPoint(const mathfu::vec3& point, Fn&& fn) const;
+
+  // Calls |fn| with the Entity of every proxy whose fat Aabb overlaps |aabb|.
+  template <typename Fn>
+  void QueryAabb(const Aabb& aabb, Fn&& fn) const;
+
+  // Calls |fn| with the Entity of every proxy whose fat Aabb is at least partly
+  // inside the frustum bounded by the (normalized, inward facing) |planes|, as
+  // computed by CalculateViewFrustum().  Subtrees that are entirely inside the
+  // frustum are reported without testing their descendants.
+  template <typename Fn>
+  void QueryFrustum(const mathfu::vec4 planes[kNumFrustumPlanes],
+                    Fn&& fn) const;
+
+  // Calls |fn| with the Entity of every proxy whose fat Aabb is no further than
+  // |max_distance| away from |point|, in order of increasing distance.  As for
+  // Raycast(), |fn| must return the new maximum distance for the rest of the
+  // query, which allows k-nearest queries to stop once k close enough proxies
+  // have been found.
+  template <typename Fn>
+  void QueryNearest(const mathfu::vec3& point, float max_distance,
+                    Fn&& fn) const;
+
+ private:
+  struct Node {
+    bool IsLeaf() const { return child1 == kInvalidProxy; }
+
+    Aabb aabb;
+    Entity entity = kNullEntity;
+    // The parent node when in use, or the next free node when in the free list.
+    ProxyId parent = kInvalidProxy;
+    ProxyId child1 = kInvalidProxy;
+    ProxyId child2 = kInvalidProxy;
+    // Leaves have a height of 0, and free nodes a height of -1.
+    int height = -1;
+  };
+
+  // Precomputed values used to test a ray against many Aabbs.
+  struct RayTestData {
+    mathfu::vec3 origin;
+    mathfu::vec3 inv_direction;
+    float length;
+  };
+
+  ProxyId AllocateNode();
+  void FreeNode(ProxyId id);
+  void InsertLeaf(ProxyId leaf);
+  void RemoveLeaf(ProxyId leaf);
+  ProxyId Balance(ProxyId id);
+  void Refit(ProxyId id);
+
+  // Returns the distance along the ray to the entry point of |aabb|, or
+  // kNoHitDistance if the ray misses.  The distance is 0 if the ray origin is
+  // inside the |aabb|.
+  static float IntersectRay(const RayTestData& ray, const Aabb& aabb);
+
+  enum FrustumTestResult {
+    kOutsideFrustum,
+    kIntersectsFrustum,
+    kInsideFrustum,
+  };
+
+  // Classifies |aabb| against the frustum bounded by |planes|.  Boxes that
+  // straddle the corners of the frustum may be reported as intersecting it.
+  static FrustumTestResult TestFrustum(const mathfu::vec4* planes,
+                                       const Aabb& aabb);
+
+  // Returns true if |a| and |b| overlap.
+  static bool Overlaps(const Aabb& a, const Aabb& b);
+
+  // Returns the distance from |point| to |aabb|, or 0 if it is inside.
+  static float DistanceToAabb(const mathfu::vec3& point, const Aabb& aabb);
+
+  std::vector<Node> nodes_;
+  ProxyId root_ = kInvalidProxy;
+  ProxyId free_list_ = kInvalidProxy;
+  size_t num_proxies_ = 0;
+  float margin_;
+};
+
+template <typename Fn>
+void DynamicAabbTree::Raycast(const Ray& ray, float max_distance,
+                              Fn&& fn) const {
+  if (root_ == kInvalidProxy) {
+    return;
+  }
+
+  RayTestData data;
+  data.origin = ray.origin;
+  data.length = ray.direction.Length();
+  // Division by zero results in infinity, which the slab test below handles.
+  data.inv_direction = mathfu::vec3(1.f / ray.direction.x,
+                                    1.f / ray.direction.y,
+                                    1.f / ray.direction.z);
+
+  // Each entry is a node and the distance to its Aabb.
+  std::vector<std::pair<ProxyId, float>> stack;
+  stack.reserve(64);
+
+  const float root_distance = IntersectRay(data, nodes_[root_].aabb);
+  if (root_distance == kNoHitDistance) {
+    return;
+  }
+  stack.emplace_back(root_, root_distance);
+
+  while (!stack.empty()) {
+    const ProxyId id = stack.back().first;
+    const float distance = stack.back().second;
+    stack.pop_back();
+    if (distance > max_distance) {
+      continue;
+    }
+
+    const Node& node = nodes_[id];
+    if (node.IsLeaf()) {
+      max_distance = fn(node.entity);
+      continue;
+    }
+
+    const float distance1 = IntersectRay(data, nodes_[node.child1].aabb);
+    const float distance2 = IntersectRay(data, nodes_[node.child2].aabb);
+    const bool hit1 = distance1 != kNoHitDistance && distance1 <= max_distance;
+    const bool hit2 = distance2 != kNoHitDistance && distance2 <= max_distance;
+
+    // Push the further child first so the nearer one is visited first.
+    if (hit1 && hit2) {
+      if (distance1 <= distance2) {
+        stack.emplace_back(node.child2, distance2);
+        stack.emplace_back(node.child1, distance1);
+      } else {
+        stack.emplace_back(node.child1, distance1);
+        stack.emplace_back(node.child2, distance2);
+      }
+    } else if (hit1) {
+      stack.emplace_back(node.child1, distance1);
+    } else if (hit2) {
+      stack.emplace_back(node.child2, distance2);
+    }
+  }
+}
+
+template <typename Fn>
+void DynamicAabbTree::QueryPoint(const mathfu::vec3& point, Fn&& fn) const {
+  if (root_ == kInvalidProxy) {
+    return;
+  }
+
+  std::vector<ProxyId> stack;
+  stack.reserve(64);
+  stack.push_back(root_);
+  while (!stack.empty()) {
+    const ProxyId id = stack.back();
+    stack.pop_back();
+
+    const Node& node = nodes_[id];
+    if (!CheckPointAABBCollision(point, node.aabb)) {
+      continue;
+    }
+    if (node.IsLeaf()) {
+      fn(node.entity);
+    } else {
+      stack.push_back(node.child2);
+      stack.push_back(node.child1);
+    }
+  }
+}
+
+template <typename Fn>
+void DynamicAabbTree::QueryAabb(const Aabb& aabb, Fn&& fn) const {
+  if (root_ == kInvalidProxy) {
+    return;
+  }
+
+  std::vector<ProxyId> stack;
+  stack.reserve(64);
+  stack.push_back(root_);
+  while (!stack.empty()) {
+    const ProxyId id = stack.back();
+    stack.pop_back();
+
+    const Node& node = nodes_[id];
+    if (!Overlaps(aabb, node.aabb)) {
+      continue;
+    }
+    if (node.IsLeaf()) {
+      fn(node.entity);
+    } else {
+      stack.push_back(node.child2);
+      stack.push_back(node.child1);
+    }
+  }
+}
+
+template <typename Fn>
+void DynamicAabbTree::QueryFrustum(const mathfu::vec4 planes[kNumFrustumPlanes],
+                                   Fn&& fn) const {
+  if (root_ == kInvalidProxy) {
+    return;
+  }
+
+  // Each entry is a node and whether it is known to be inside the frustum.
+  std::vector<std::pair<ProxyId, bool>> stack;
+  stack.reserve(64);
+  stack.emplace_back(root_, false);
+  while (!stack.empty()) {
+    const ProxyId id = stack.back().first;
+    bool inside = stack.back().second;
+    stack.pop_back();
+
+    const Node& node = nodes_[id];
+    if (!inside) {
+      const FrustumTestResult result = TestFrustum(planes, node.aabb);
+      if (result == kOutsideFrustum) {
+        continue;
+      }
+      inside = result == kInsideFrustum;
+    }
+    if (node.IsLeaf()) {
+      fn(node.entity);
+    } else {
+      stack.emplace_back(node.child2, inside);
+      stack.emplace_back(node.child1, inside);
+    }
+  }
+}
+
+template <typename Fn>
+void DynamicAabbTree::QueryNearest(const mathfu::vec3& point,
+                                   float max_distance, Fn&& fn) const {
+  if (root_ == kInvalidProxy) {
+    return;
+  }
+
+  // Each entry is the distance to a node and the node, nearest first.
+  using Entry = std::pair<float, ProxyId>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  queue.emplace(DistanceToAabb(point, nodes_[root_].aabb), root_);
+  while (!queue.empty()) {
+    const float distance = queue.top().first;
+    const ProxyId id = queue.top().second;
+    queue.pop();
+    if (distance > max_distance) {
+      // Every other node in the queue is at least as far away.
+      break;
+    }
+
+    const Node& node = nodes_[id];
+    if (node.IsLeaf()) {
+      max_distance = fn(node.entity);
+      continue;
+    }
+
+    const float distance1 = DistanceToAabb(point, nodes_[node.child1].aabb);
+    const float distance2 = DistanceToAabb(point, nodes_[node.child2].aabb);
+    if (distance1 <= max_distance) {
+      queue.emplace(distance1, node.child1);
+    }
+    if (distance2 <= max_distance) {
+      queue.emplace(distance2, node.child2);
+    }
+  }
+}
+
+}  // namespace lull
+
+#endif  // LULLABY_UTIL_DYNAMIC_AABB_TREE_H_
@@ -18,15 +18,22 @@ limitations under the License.
 #define LULLABY_UTIL_FLATBUFFER_READER_H_
 
 #include <memory>
+#include <type_traits>
 #include "flatbuffers/flatbuffers.h"
 #include "lullaby/util/flatbuffer_native_types.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/util/optional.h"
+#include "lullaby/util/span.h"
+#include "lullaby/util/string_view.h"
 
 namespace lull {
 
 // Reads data from a flatbuffer into an instance of an object class generated
 // by the Lullaby flatc code generator.
+//
+// Fields marked with the "zero_copy" attribute are generated as string_view and
+// Span members.  These are pointed directly at the data in the flatbuffer
+// rather than copied, so the flatbuffer must outlive the object being read.
 class FlatbufferReader {
  public:
   // Reads data from the flatbuffer::Table into the specified object.
@@ -56,12 +63,22 @@ class FlatbufferReader {
     // by calling GetPointer.
     const auto* rhs = GetPointer<flatbuffers::String>(offset);
     if (rhs) {
-      *value = rhs->str();
+      value->assign(rhs->c_str(), rhs->size());
     } else {
       value->clear();
     }
   }
 
+  // Points |value| at a string in the internal flatbuffer without copying it.
+  void String(string_view* value, uint16_t offset) {
+    const auto* rhs = GetPointer<flatbuffers::String>(offset);
+    if (rhs) {
+      *value = string_view(rhs->c_str(), rhs->size());
+    } else {
+      *value = string_view();
+    }
+  }
+
   // Reads a struct of type T from the internal flatbuffer into |value|.
   template <typename T>
   void Struct(T* value, uint16_t offset) {
@@ -176,15 +193,35 @@ class FlatbufferReader {
     const auto* vec = GetPointer<flatbuffers::Vector<U>>(offset);
     if (vec) {
       const size_t num = vec->size();
-      value->resize(num);
-      for (unsigned int i = 0; i < num; ++i) {
-        value->at(i) = static_cast<T>(vec->Get(i));
+      if (CanCopyScalars<T, U>()) {
+        // The wire format matches the native format, so copy the whole block.
+        const T* data = reinterpret_cast<const T*>(vec->Data());
+        value->assign(data, data + num);
+      } else {
+        value->resize(num);
+        for (unsigned int i = 0; i < num; ++i) {
+          (*value)[i] = static_cast<T>(vec->Get(i));
+        }
       }
     } else {
       value->clear();
     }
   }
 
+  // Points |value| at an array of scalar values in the internal flatbuffer
+  // without copying it.
+  template <typename T, typename U = T>
+  void VectorOfScalars(Span<T>* value, uint16_t offset) {
+    static_assert(CanCopyScalars<T, U>(),
+                  "Zero-copy vectors must match the flatbuffer wire format.");
+    const auto* vec = GetPointer<flatbuffers::Vector<U>>(offset);
+    if (vec) {
+      *value = Span<T>(reinterpret_cast<const T*>(vec->Data()), vec->size());
+    } else {
+      *value = Span<T>();
+    }
+  }
+
   // Serializes an array of strings.
   void VectorOfStrings(std::vector<std::string>* value, uint16_t offset) {
     using StringRef = flatbuffers::Offset<flatbuffers::String>;
@@ -197,7 +234,7 @@ class FlatbufferReader {
       for (unsigned int i = 0; i < num; ++i) {
         const flatbuffers::String* src = vec->Get(i);
         if (src) {
-          value->at(i) = src->str();
+          value->at(i).assign(src->c_str(), src->size());
         } else {
           value->at(i).clear();
         }
@@ -303,6 +340,14 @@ class FlatbufferReader {
     }
   }
 
+  // Returns true if an array of U in a flatbuffer has the same memory layout as
+  // an array of T, allowing it to be copied or viewed directly.
+  template <typename T, typename U>
+  static constexpr bool CanCopyScalars() {
+    return std::is_same<T, U>::value && std::is_arithmetic<T>::value &&
+           !std::is_same<T, bool>::value && FLATBUFFERS_LITTLEENDIAN;
+  }
+
   template <typename T>
   static T Read(const uint8_t* ptr) {
     return *reinterpret_cast<const T*>(ptr);
@@ -18,11 +18,14 @@ limitations under the License.
 #define LULLABY_UTIL_FLATBUFFER_WRITER_H_
 
 #include <memory>
+#include <type_traits>
 #include "flatbuffers/flatbuffers.h"
 #include "lullaby/util/flatbuffer_native_types.h"
 #include "lullaby/util/inward_buffer.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/util/optional.h"
+#include "lullaby/util/span.h"
+#include "lullaby/util/string_view.h"
 
 namespace lull {
 
@@ -119,6 +122,12 @@ class FlatbufferWriter {
     AddReferenceField(offset / 2, reference);
   }
 
+  // Serializes a string from a zero-copy field.
+  void String(string_view* value, uint16_t offset) {
+    const size_t reference = CreateString(*value);
+    AddReferenceField(offset / 2, reference);
+  }
+
   // Serializes a flatbuffer struct-type.
   template <typename T>
   void Struct(T* value, uint16_t offset) {
@@ -202,18 +211,33 @@ class FlatbufferWriter {
   // Serializes an array of scalar values.
   template <typename T, typename U = T>
   void VectorOfScalars(std::vector<T>* value, uint16_t offset) {
-    const size_t total_bytes = value->size() * sizeof(T);
-    Prealign(alignof(uint32_t), total_bytes);
+    const size_t reference =
+        CreateVectorOfScalars<T, U>(value->data(), value->size());
+    AddReferenceField(offset / 2, reference);
+  }
+
+  // Serializes an array of booleans.  std::vector<bool> does not store its
+  // values contiguously, so they are written one at a time.
+  void VectorOfScalars(std::vector<bool>* value, uint16_t offset) {
+    Prealign(alignof(uint32_t), value->size());
 
     const size_t start = StartVector();
     for (auto iter = value->rbegin(); iter != value->rend(); ++iter) {
-      const U u = *iter;
+      const uint8_t u = *iter ? 1 : 0;
       AddVectorValue(&u);
     }
     const size_t reference = EndVector(start, value->size());
     AddReferenceField(offset / 2, reference);
   }
 
+  // Serializes an array of scalar values from a zero-copy field.
+  template <typename T, typename U = T>
+  void VectorOfScalars(Span<T>* value, uint16_t offset) {
+    const size_t reference =
+        CreateVectorOfScalars<T, U>(value->data(), value->size());
+    AddReferenceField(offset / 2, reference);
+  }
+
   // Serializes an array of strings.
   void VectorOfStrings(std::vector<std::string>* value, uint16_t offset) {
     Prealign(alignof(uint32_t));
@@ -430,7 +454,7 @@ class FlatbufferWriter {
     buffer_->WriteBack(offset);
   }
 
-  size_t CreateString(const std::string& str) {
+  size_t CreateString(string_view str) {
     if (str.empty()) {
       return 0;
     }
@@ -443,6 +467,25 @@ class FlatbufferWriter {
     return buffer_->BackSize();
   }
 
+  template <typename T, typename U>
+  size_t CreateVectorOfScalars(const T* data, size_t num) {
+    const size_t total_bytes = num * sizeof(U);
+    Prealign(alignof(uint32_t), total_bytes);
+
+    const size_t start = StartVector();
+    if (std::is_same<T, U>::value && std::is_arithmetic<T>::value &&
+        FLATBUFFERS_LITTLEENDIAN) {
+      // The native format matches the wire format, so copy the whole block.
+      buffer_->WriteBack(data, total_bytes);
+    } else {
+      for (size_t i = num; i > 0; --i) {
+        const U u = static_cast<U>(data[i - 1]);
+        AddVectorValue(&u);
+      }
+    }
+    return EndVector(start, num);
+  }
+
   size_t WriteTable(size_t start, size_t end, size_t* object_size,
                     size_t* vtable_size) {
     size_t max_field = 2;
@@ -0,0 +1,99 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/frame_budget.h"
+
+#include <algorithm>
+
+#include "lullaby/util/logging.h"
+#include "lullaby/util/time.h"
+
+namespace lull {
+
+const FrameBudget::WorkId FrameBudget::kInvalidWorkId;
+
+FrameBudget::FrameBudget()
+    : target_frame_time_(DurationFromSeconds(1.f / 60.f)),
+      min_budget_(std::chrono::microseconds(250)),
+      max_budget_(std::chrono::milliseconds(8)),
+      budget_(std::chrono::milliseconds(2)) {}
+
+FrameBudget::WorkId FrameBudget::Register(WorkFn fn, int priority) {
+  DCHECK(!running_) << "Cannot register work during AdvanceFrame.";
+  const WorkId id = next_work_id_;
+  if (++next_work_id_ == kInvalidWorkId) {
+    ++next_work_id_;
+  }
+
+  // Insert after any existing work with the same priority.
+  auto pos = std::upper_bound(
+      work_.begin(), work_.end(), priority,
+      [](int priority, const Work& work) { return priority > work.priority; });
+  work_.insert(pos, Work{id, priority, std::move(fn)});
+  return id;
+}
+
+void FrameBudget::Unregister(WorkId id) {
+  DCHECK(!running_) << "Cannot unregister work during AdvanceFrame.";
+  auto iter = std::find_if(work_.begin(), work_.end(),
+                           [id](const Work& work) { return work.id == id; });
+  if (iter != work_.end()) {
+    work_.erase(iter);
+  }
+}
+
+void FrameBudget::SetTargetFrameTime(Clock::duration target_frame_time) {
+  target_frame_time_ = target_frame_time;
+}
+
+void FrameBudget::SetBudgetRange(Clock::duration min_budget,
+                                 Clock::duration max_budget) {
+  DCHECK(min_budget <= max_budget);
+  min_budget_ = min_budget;
+  max_budget_ = max_budget;
+  budget_ = std::min(std::max(budget_, min_budget_), max_budget_);
+}
+
+void FrameBudget::UpdateBudget(Clock::duration delta_time) {
+  // Move halfway towards the budget that would have hit the target frame time
+  // exactly.  This converges quickly without oscillating on noisy frames.
+  const Clock::duration error = target_frame_time_ - delta_time;
+  budget_ += error / 2;
+  budget_ = std::min(std::max(budget_, min_budget_), max_budget_);
+}
+
+void FrameBudget::AdvanceFrame(Clock::duration delta_time) {
+  UpdateBudget(delta_time);
+
+  running_ = true;
+  const Timer timer;
+  bool performed_work = false;
+  for (Work& work : work_) {
+    while (!performed_work || timer.GetElapsedTime() < budget_) {
+      if (!work.fn()) {
+        break;
+      }
+      performed_work = true;
+    }
+    if (performed_work && timer.GetElapsedTime() >= budget_) {
+      break;
+    }
+  }
+  time_spent_ = timer.GetElapsedTime();
+  running_ = false;
+}
+
+}  // namespace lull
@@ -0,0 +1,107 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_FRAME_BUDGET_H_
+#define LULLABY_UTIL_FRAME_BUDGET_H_
+
+#include <functional>
+#include <vector>
+
+#include "lullaby/util/clock.h"
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+// Spends a slice of time each frame performing deferrable work (eg. asset
+// finalization, queued entity destruction, texture uploads).
+//
+// Work is registered as a function that performs a single unit of work along
+// with a priority:
+//
+// frame_budget->Register([=]() { return asset_loader->FinalizeNext(); }, 10);
+//
+// Each call to AdvanceFrame performs units of work, highest priority first,
+// until the frame's time budget has been spent.  The budget adapts to the
+// measured frame time, growing when frames finish ahead of the target frame
+// time and shrinking when they run over, so that the target frame rate can be
+// held during heavy loads.
+class FrameBudget {
+ public:
+  // Performs a single unit of work.  Returns false if there was no work to
+  // perform.
+  using WorkFn = std::function<bool()>;
+  using WorkId = unsigned int;
+
+  static const WorkId kInvalidWorkId = 0;
+
+  FrameBudget();
+
+  // Registers a function to perform deferrable work.  Work with a higher
+  // |priority| is performed first; work with equal priority is performed in
+  // the order it was registered.  Returns an ID that can be used to unregister
+  // the work.
+  WorkId Register(WorkFn fn, int priority = 0);
+
+  // Unregisters work previously registered with Register.
+  void Unregister(WorkId id);
+
+  // Sets the duration of a frame at the desired frame rate (eg. 1/72s).
+  void SetTargetFrameTime(Clock::duration target_frame_time);
+
+  // Sets the range within which the per-frame time budget is adapted.
+  void SetBudgetRange(Clock::duration min_budget, Clock::duration max_budget);
+
+  // Adapts the time budget based on the measured duration of the last frame,
+  // |delta_time|, and then spends the budget performing registered work.  At
+  // least one unit of work is performed (if there is any) so that progress is
+  // always made.  Must not be called from within a WorkFn.
+  void AdvanceFrame(Clock::duration delta_time);
+
+  // Returns the current per-frame time budget.
+  Clock::duration GetBudget() const { return budget_; }
+
+  // Returns the time spent performing work during the last AdvanceFrame.
+  Clock::duration GetTimeSpent() const { return time_spent_; }
+
+ private:
+  struct Work {
+    WorkId id;
+    int priority;
+    WorkFn fn;
+  };
+
+  // Updates budget_ based on the measured duration of the last frame.
+  void UpdateBudget(Clock::duration delta_time);
+
+  // Work sorted by descending priority.
+  std::vector<Work> work_;
+  WorkId next_work_id_ = 1;
+  Clock::duration target_frame_time_;
+  Clock::duration min_budget_;
+  Clock::duration max_budget_;
+  Clock::duration budget_;
+  Clock::duration time_spent_ = Clock::duration::zero();
+  bool running_ = false;
+
+  FrameBudget(const FrameBudget&) = delete;
+  FrameBudget& operator=(const FrameBudget&) = delete;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::FrameBudget);
+
+#endif  // LULLABY_UTIL_FRAME_BUDGET_H_
@@ -0,0 +1,97 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_HALF_FLOAT_H_
+#define LULLABY_UTIL_HALF_FLOAT_H_
+
+#include <stdint.h>
+#include <string.h>
+
+namespace lull {
+
+// IEEE 754 binary16 ("half") floating point values stored as raw bits, as used
+// by the half-float vertex attribute types.
+typedef uint16_t HalfFloat;
+
+// Converts |value| to a half-float, rounding to the nearest representable
+// value.  Values too large for a half-float become infinity.
+inline HalfFloat FloatToHalf(float value) {
+  static const uint32_t kFloatInfinity = 255u << 23;
+  static const uint32_t kHalfOverflow = (127u + 16u) << 23;
+  static const uint32_t kHalfMinNormal = 113u << 23;
+  static const uint32_t kDenormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const uint32_t sign = bits & 0x80000000u;
+  bits ^= sign;
+
+  uint32_t result;
+  if (bits >= kHalfOverflow) {
+    // Infinity stays infinity, NaN becomes a quiet NaN.
+    result = bits > kFloatInfinity ? 0x7e00u : 0x7c00u;
+  } else if (bits < kHalfMinNormal) {
+    // Let the FPU do the rounding of denormals by aligning the mantissa with an
+    // addition.
+    float magic;
+    memcpy(&magic, &kDenormMagic, sizeof(magic));
+    float denorm;
+    memcpy(&denorm, &bits, sizeof(denorm));
+    denorm += magic;
+    memcpy(&bits, &denorm, sizeof(bits));
+    result = bits - kDenormMagic;
+  } else {
+    // Rebias the exponent and round the mantissa to nearest even.
+    const uint32_t mantissa_odd = (bits >> 13) & 1u;
+    bits -= (127u - 15u) << 23;
+    bits += 0xfffu + mantissa_odd;
+    result = bits >> 13;
+  }
+  return static_cast<HalfFloat>(result | (sign >> 16));
+}
+
+// Converts the half-float |value| to a float.  All half-floats are exactly
+// representable as floats.
+inline float HalfToFloat(HalfFloat value) {
+  static const uint32_t kShiftedExponent = 0x7c00u << 13;
+  static const uint32_t kDenormMagic = 113u << 23;
+
+  uint32_t bits = (value & 0x7fffu) << 13;
+  const uint32_t exponent = bits & kShiftedExponent;
+  bits += (127u - 15u) << 23;
+  if (exponent == kShiftedExponent) {
+    // Infinity or NaN.
+    bits += (128u - 16u) << 23;
+  } else if (exponent == 0) {
+    // Zero or denormal; renormalize with an FPU subtraction.
+    bits += 1u << 23;
+    float magic;
+    memcpy(&magic, &kDenormMagic, sizeof(magic));
+    float denorm;
+    memcpy(&denorm, &bits, sizeof(denorm));
+    denorm -= magic;
+    memcpy(&bits, &denorm, sizeof(bits));
+  }
+  bits |= static_cast<uint32_t>(value & 0x8000u) << 16;
+
+  float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+}  // namespace lull
+
+#endif  // LULLABY_UTIL_HALF_FLOAT_H_
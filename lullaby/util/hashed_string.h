@@ -0,0 +1,105 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_HASHED_STRING_H_
+#define LULLABY_UTIL_HASHED_STRING_H_
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+#include "lullaby/util/hash.h"
+#include "lullaby/util/string_view.h"
+
+namespace lull {
+
+/// A non-owning reference to a string along with its HashValue.
+///
+/// APIs that need both the name of something and its hash can take a
+/// HashedString instead of a string_view so that the name is hashed by the
+/// caller, once.  For string literals, the hash is computed at compile time:
+///
+///     constexpr HashedString kName("name");
+///     binder->Call(kName);          // No hashing at all.
+///     binder->Call("other_name");   // Hashed at compile time if possible.
+///     binder->Call(some_string);    // Hashed at runtime, as before.
+///
+/// Like string_view, a HashedString does not own the string it references, so
+/// it must not outlive it.
+class HashedString {
+ public:
+  /// Creates an empty string, whose hash is 0.
+  constexpr HashedString() : str_(""), len_(0), hash_(0) {}
+
+  /// Creates a HashedString for the string literal |str|, hashing it at
+  /// compile time.
+  template <std::size_t N>
+  constexpr HashedString(const char (&str)[N])
+      : str_(str), len_(N > 0 ? N - 1 : 0), hash_(ConstHash(str)) {}
+
+  /// Creates a HashedString for the null-terminated string in the buffer
+  /// |str|, hashing it at runtime.  Unlike a literal, the string in a mutable
+  /// buffer may be shorter than the buffer.
+  template <std::size_t N>
+  HashedString(char (&str)[N]) : HashedString(string_view(str)) {}
+
+  /// Creates a HashedString for the null-terminated string |str|.  (This is a
+  /// template so that string literals prefer the constructor above.)
+  template <typename T,
+            typename = typename std::enable_if<
+                std::is_same<T, const char*>::value ||
+                std::is_same<T, char*>::value>::type>
+  HashedString(T str) : HashedString(string_view(str)) {}
+
+  /// Creates a HashedString for |str|, hashing it at runtime.
+  HashedString(string_view str)
+      : str_(str.data()), len_(str.size()), hash_(Hash(str)) {}
+  HashedString(const std::string& str)
+      : str_(str.c_str()), len_(str.size()), hash_(Hash(str)) {}
+
+  /// Creates a HashedString for |str| whose hash is already known.
+  constexpr HashedString(const char* str, std::size_t len, HashValue hash)
+      : str_(str), len_(len), hash_(hash) {}
+
+  /// Returns the hash of the string.
+  constexpr HashValue GetHash() const { return hash_; }
+
+  /// Returns the string.
+  string_view GetString() const { return string_view(str_, len_); }
+
+  /// Returns a pointer to the characters of the string, which is only null
+  /// terminated if the string used to create the HashedString was.
+  constexpr const char* data() const { return str_; }
+
+  /// Returns the length of the string.
+  constexpr std::size_t size() const { return len_; }
+
+  /// Returns true if the string is empty.
+  constexpr bool empty() const { return len_ == 0; }
+
+ private:
+  const char* str_;
+  std::size_t len_;
+  HashValue hash_;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const HashedString& str) {
+  return os << str.GetString();
+}
+
+}  // namespace lull
+
+#endif  // LULLABY_UTIL_HASHED_STRING_H_
@@ -0,0 +1,102 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_INLINE_FUNCTION_H_
+#define LULLABY_UTIL_INLINE_FUNCTION_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace lull {
+
+template <typename Signature>
+class InlineFunction;
+
+// A type-erased function that stores small functors inline rather than
+// allocating them on the heap.  Unlike std::function, the stored functor does
+// not need to be copyable, and the InlineFunction itself can never be copied or
+// moved (so that the inline storage can be referenced directly).  It is meant
+// to be embedded in pooled objects and reassigned with Set() as they are
+// reused.
+template <typename R, typename... Args>
+class InlineFunction<R(Args...)> {
+ public:
+  // Functors up to this size (such as a lambda capturing a handful of pointers,
+  // or a std::function) are stored without any heap allocation.
+  static constexpr size_t kInlineSize = 64;
+
+  InlineFunction() {}
+  ~InlineFunction() { Reset(); }
+
+  InlineFunction(const InlineFunction&) = delete;
+  InlineFunction& operator=(const InlineFunction&) = delete;
+
+  template <typename Fn>
+  void Set(Fn&& fn) {
+    using Functor = typename std::decay<Fn>::type;
+    using FitsInline =
+        std::integral_constant<bool, sizeof(Functor) <= kInlineSize &&
+                                         alignof(Functor) <= alignof(Storage)>;
+    Reset();
+    Construct<Functor>(std::forward<Fn>(fn), FitsInline());
+  }
+
+  void Reset() {
+    if (destroy_) {
+      destroy_(&storage_);
+      invoke_ = nullptr;
+      destroy_ = nullptr;
+    }
+  }
+
+  R operator()(Args... args) {
+    return invoke_(&storage_, std::forward<Args>(args)...);
+  }
+
+  explicit operator bool() const { return invoke_ != nullptr; }
+
+ private:
+  using Storage = typename std::aligned_storage<
+      kInlineSize, alignof(std::max_align_t)>::type;
+
+  template <typename Functor, typename Fn>
+  void Construct(Fn&& fn, std::true_type /* fits_inline */) {
+    new (&storage_) Functor(std::forward<Fn>(fn));
+    invoke_ = [](void* ptr, Args... args) -> R {
+      return (*static_cast<Functor*>(ptr))(std::forward<Args>(args)...);
+    };
+    destroy_ = [](void* ptr) { static_cast<Functor*>(ptr)->~Functor(); };
+  }
+
+  template <typename Functor, typename Fn>
+  void Construct(Fn&& fn, std::false_type /* fits_inline */) {
+    *reinterpret_cast<Functor**>(&storage_) = new Functor(std::forward<Fn>(fn));
+    invoke_ = [](void* ptr, Args... args) -> R {
+      return (**static_cast<Functor**>(ptr))(std::forward<Args>(args)...);
+    };
+    destroy_ = [](void* ptr) { delete *static_cast<Functor**>(ptr); };
+  }
+
+  Storage storage_;
+  R (*invoke_)(void*, Args...) = nullptr;
+  void (*destroy_)(void*) = nullptr;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_UTIL_INLINE_FUNCTION_H_
@@ -16,7 +16,283 @@ limitations under the License.
 
 #include "lullaby/util/intersections.h"
 
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LULLABY_INTERSECTIONS_SSE 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define LULLABY_INTERSECTIONS_NEON 1
+#endif
+
 namespace lull {
+namespace {
+
+// A minimal set of 4-wide float operations used by the batched intersection
+// kernel.  Comparisons return all-bits-set lanes for true and zero for false,
+// which can be combined with And/Or/AndNot and used by Select.
+#if LULLABY_INTERSECTIONS_SSE
+using Lanes = __m128;
+inline Lanes Load(const float* p) { return _mm_loadu_ps(p); }
+inline void Store(float* p, Lanes a) { _mm_storeu_ps(p, a); }
+inline Lanes Splat(float f) { return _mm_set1_ps(f); }
+inline Lanes Add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+inline Lanes Sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+inline Lanes Mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+inline Lanes Div(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+inline Lanes Min(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+inline Lanes Max(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+inline Lanes Abs(Lanes a) {
+  return _mm_andnot_ps(_mm_set1_ps(-0.f), a);
+}
+inline Lanes Equal(Lanes a, Lanes b) { return _mm_cmpeq_ps(a, b); }
+inline Lanes Less(Lanes a, Lanes b) { return _mm_cmplt_ps(a, b); }
+inline Lanes LessEqual(Lanes a, Lanes b) { return _mm_cmple_ps(a, b); }
+inline Lanes And(Lanes a, Lanes b) { return _mm_and_ps(a, b); }
+inline Lanes Or(Lanes a, Lanes b) { return _mm_or_ps(a, b); }
+inline Lanes AndNot(Lanes a, Lanes b) { return _mm_andnot_ps(b, a); }
+inline Lanes Select(Lanes mask, Lanes a, Lanes b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+#elif LULLABY_INTERSECTIONS_NEON
+using Lanes = float32x4_t;
+inline Lanes Load(const float* p) { return vld1q_f32(p); }
+inline void Store(float* p, Lanes a) { vst1q_f32(p, a); }
+inline Lanes Splat(float f) { return vdupq_n_f32(f); }
+inline Lanes Add(Lanes a, Lanes b) { return vaddq_f32(a, b); }
+inline Lanes Sub(Lanes a, Lanes b) { return vsubq_f32(a, b); }
+inline Lanes Mul(Lanes a, Lanes b) { return vmulq_f32(a, b); }
+inline Lanes Div(Lanes a, Lanes b) { return vdivq_f32(a, b); }
+inline Lanes Min(Lanes a, Lanes b) { return vminq_f32(a, b); }
+inline Lanes Max(Lanes a, Lanes b) { return vmaxq_f32(a, b); }
+inline Lanes Abs(Lanes a) { return vabsq_f32(a); }
+inline Lanes Equal(Lanes a, Lanes b) {
+  return vreinterpretq_f32_u32(vceqq_f32(a, b));
+}
+inline Lanes Less(Lanes a, Lanes b) {
+  return vreinterpretq_f32_u32(vcltq_f32(a, b));
+}
+inline Lanes LessEqual(Lanes a, Lanes b) {
+  return vreinterpretq_f32_u32(vcleq_f32(a, b));
+}
+inline Lanes And(Lanes a, Lanes b) {
+  return vreinterpretq_f32_u32(
+      vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+inline Lanes Or(Lanes a, Lanes b) {
+  return vreinterpretq_f32_u32(
+      vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+inline Lanes AndNot(Lanes a, Lanes b) {
+  return vreinterpretq_f32_u32(
+      vbicq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+inline Lanes Select(Lanes mask, Lanes a, Lanes b) {
+  return vbslq_f32(vreinterpretq_u32_f32(mask), a, b);
+}
+#else
+struct Lanes {
+  float v[4];
+};
+template <typename Fn>
+inline Lanes Apply(Lanes a, Lanes b, Fn fn) {
+  Lanes r;
+  for (int i = 0; i < 4; ++i) {
+    r.v[i] = fn(a.v[i], b.v[i]);
+  }
+  return r;
+}
+inline float MaskFromBool(bool b) {
+  uint32_t bits = b ? ~0u : 0u;
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+inline uint32_t BitsFromFloat(float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  return bits;
+}
+inline float FloatFromBits(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+inline Lanes Load(const float* p) {
+  Lanes r;
+  memcpy(r.v, p, sizeof(r.v));
+  return r;
+}
+inline void Store(float* p, Lanes a) { memcpy(p, a.v, sizeof(a.v)); }
+inline Lanes Splat(float f) { return Lanes{{f, f, f, f}}; }
+inline Lanes Add(Lanes a, Lanes b) {
+  return Apply(a, b, [](float x, float y) { return x + y; });
+}
+inline Lanes Sub(Lanes a, Lanes b) {
+  return Apply(a, b, [](float x, float y) { return x - y; });
+}
+inline Lanes Mul(Lanes a, Lanes b) {
+  return Apply(a, b, [](float x, float y) { return x * y; });
+}
+inline Lanes Div(Lanes a, Lanes b) {
+  return Apply(a, b, [](float x, float y) { return x / y; });
+}
+inline Lanes Min(Lanes a, Lanes b) {
+  return Apply(a, b, [](float x, float y) { return x < y ? x : y; });
+}
+inline Lanes Max(Lanes a, Lanes b) {
+  return Apply(a, b, [](float x, float y) { return x > y ? x : y; });
+}
+inline Lanes Abs(Lanes a) {
+  return Apply(a, a, [](float x, float) { return std::fabs(x); });
+}
+inline Lanes Equal(Lanes a, Lanes b) {
+  return Apply(a, b, [](float x, float y) { return MaskFromBool(x == y); });
+}
+inline Lanes Less(Lanes a, Lanes b) {
+  return Apply(a, b, [](float x, float y) { return MaskFromBool(x < y); });
+}
+inline Lanes LessEqual(Lanes a, Lanes b) {
+  return Apply(a, b, [](float x, float y) { return MaskFromBool(x <= y); });
+}
+inline Lanes And(Lanes a, Lanes b) {
+  return Apply(a, b, [](float x, float y) {
+    return FloatFromBits(BitsFromFloat(x) & BitsFromFloat(y));
+  });
+}
+inline Lanes Or(Lanes a, Lanes b) {
+  return Apply(a, b, [](float x, float y) {
+    return FloatFromBits(BitsFromFloat(x) | BitsFromFloat(y));
+  });
+}
+inline Lanes AndNot(Lanes a, Lanes b) {
+  return Apply(a, b, [](float x, float y) {
+    return FloatFromBits(BitsFromFloat(x) & ~BitsFromFloat(y));
+  });
+}
+inline Lanes Select(Lanes mask, Lanes a, Lanes b) {
+  return Or(And(mask, a), AndNot(b, mask));
+}
+#endif
+
+// Clips the parametric range [t_min, t_max] of a ray against a single slab of
+// the box, or sets |miss| if the ray is parallel to the slab and outside of it.
+inline void ClipSlab(Lanes origin, Lanes direction, Lanes slab_min,
+                     Lanes slab_max, Lanes* t_min, Lanes* t_max, Lanes* miss) {
+  const Lanes zero = Splat(0.f);
+  const Lanes parallel = Equal(direction, zero);
+  const Lanes outside =
+      Or(Less(origin, slab_min), Less(slab_max, origin));
+  *miss = Or(*miss, And(parallel, outside));
+
+  const Lanes t1 = Div(Sub(slab_min, origin), direction);
+  const Lanes t2 = Div(Sub(slab_max, origin), direction);
+  *t_min = Select(parallel, *t_min, Max(*t_min, Min(t1, t2)));
+  *t_max = Select(parallel, *t_max, Min(*t_max, Max(t1, t2)));
+}
+
+// Tests a single batch of kRayOBBCollisionBatchSize boxes.  The matrix and box
+// elements are stored in lane order, ie. m[row][col][lane].
+void CheckRayOBBCollisionBatch(const Ray& ray, const float m[3][4][4],
+                               const float box_min[3][4],
+                               const float box_max[3][4],
+                               bool collision_on_exit, float* out_distances) {
+  const Lanes m00 = Load(m[0][0]), m01 = Load(m[0][1]), m02 = Load(m[0][2]);
+  const Lanes m10 = Load(m[1][0]), m11 = Load(m[1][1]), m12 = Load(m[1][2]);
+  const Lanes m20 = Load(m[2][0]), m21 = Load(m[2][1]), m22 = Load(m[2][2]);
+
+  // Invert the upper 3x3 of the affine transforms using the adjugate.
+  const Lanes c00 = Sub(Mul(m11, m22), Mul(m12, m21));
+  const Lanes c01 = Sub(Mul(m12, m20), Mul(m10, m22));
+  const Lanes c02 = Sub(Mul(m10, m21), Mul(m11, m20));
+  const Lanes det = Add(Add(Mul(m00, c00), Mul(m01, c01)), Mul(m02, c02));
+  const Lanes invertible = LessEqual(Splat(kDeterminantThreshold), Abs(det));
+  const Lanes inv_det = Div(Splat(1.f), det);
+
+  const Lanes i00 = Mul(c00, inv_det);
+  const Lanes i01 = Mul(Sub(Mul(m02, m21), Mul(m01, m22)), inv_det);
+  const Lanes i02 = Mul(Sub(Mul(m01, m12), Mul(m02, m11)), inv_det);
+  const Lanes i10 = Mul(c01, inv_det);
+  const Lanes i11 = Mul(Sub(Mul(m00, m22), Mul(m02, m20)), inv_det);
+  const Lanes i12 = Mul(Sub(Mul(m02, m10), Mul(m00, m12)), inv_det);
+  const Lanes i20 = Mul(c02, inv_det);
+  const Lanes i21 = Mul(Sub(Mul(m01, m20), Mul(m00, m21)), inv_det);
+  const Lanes i22 = Mul(Sub(Mul(m00, m11), Mul(m01, m10)), inv_det);
+
+  // Transform the ray into the local space of each box.
+  const Lanes ox = Sub(Splat(ray.origin.x), Load(m[0][3]));
+  const Lanes oy = Sub(Splat(ray.origin.y), Load(m[1][3]));
+  const Lanes oz = Sub(Splat(ray.origin.z), Load(m[2][3]));
+  const Lanes dx = Splat(ray.direction.x);
+  const Lanes dy = Splat(ray.direction.y);
+  const Lanes dz = Splat(ray.direction.z);
+  const Lanes local_ox = Add(Add(Mul(i00, ox), Mul(i01, oy)), Mul(i02, oz));
+  const Lanes local_oy = Add(Add(Mul(i10, ox), Mul(i11, oy)), Mul(i12, oz));
+  const Lanes local_oz = Add(Add(Mul(i20, ox), Mul(i21, oy)), Mul(i22, oz));
+  const Lanes local_dx = Add(Add(Mul(i00, dx), Mul(i01, dy)), Mul(i02, dz));
+  const Lanes local_dy = Add(Add(Mul(i10, dx), Mul(i11, dy)), Mul(i12, dz));
+  const Lanes local_dz = Add(Add(Mul(i20, dx), Mul(i21, dy)), Mul(i22, dz));
+
+  Lanes t_min = Splat(-std::numeric_limits<float>::infinity());
+  Lanes t_max = Splat(std::numeric_limits<float>::infinity());
+  Lanes miss = Splat(0.f);
+  ClipSlab(local_ox, local_dx, Load(box_min[0]), Load(box_max[0]), &t_min,
+           &t_max, &miss);
+  ClipSlab(local_oy, local_dy, Load(box_min[1]), Load(box_max[1]), &t_min,
+           &t_max, &miss);
+  ClipSlab(local_oz, local_dz, Load(box_min[2]), Load(box_max[2]), &t_min,
+           &t_max, &miss);
+
+  // If the box encloses the ray origin, the hit is where the ray exits.
+  const Lanes zero = Splat(0.f);
+  const Lanes hit = AndNot(
+      And(invertible, And(LessEqual(t_min, t_max), LessEqual(zero, t_max))),
+      miss);
+  const Lanes t = collision_on_exit ? t_max
+                                    : Select(Less(t_min, zero), t_max, t_min);
+
+  // Affine transforms preserve the ray parameterization, so the world space
+  // distance is simply scaled by the length of the ray direction.
+  const Lanes distance = Mul(t, Splat(ray.direction.Length()));
+  Store(out_distances, Select(hit, distance, Splat(kNoHitDistance)));
+}
+
+// Tests a single batch of kSphereFrustumBatchSize spheres, stored in lane
+// order, against all the frustums.  Returns a mask of the visible spheres.
+Lanes CheckSphereFrustumBatch(const float center[3][kSphereFrustumBatchSize],
+                              const float radius[kSphereFrustumBatchSize],
+                              const mathfu::vec4 (*frustums)[kNumFrustumPlanes],
+                              size_t num_frustums) {
+  const Lanes zero = Splat(0.f);
+  const Lanes all = Equal(zero, zero);
+  const Lanes x = Load(center[0]);
+  const Lanes y = Load(center[1]);
+  const Lanes z = Load(center[2]);
+  const Lanes neg_radius = Sub(zero, Load(radius));
+
+  Lanes visible = zero;
+  for (size_t i = 0; i < num_frustums; ++i) {
+    // A sphere is outside the frustum if it is entirely behind any plane.
+    Lanes outside = zero;
+    for (int j = 0; j < kNumFrustumPlanes; ++j) {
+      const mathfu::vec4& plane = frustums[i][j];
+      const Lanes distance =
+          Add(Add(Mul(Splat(plane.x), x), Mul(Splat(plane.y), y)),
+              Add(Mul(Splat(plane.z), z), Splat(plane.w)));
+      outside = Or(outside, Less(distance, neg_radius));
+    }
+    visible = Or(visible, AndNot(all, outside));
+  }
+  return visible;
+}
+
+}  // namespace
 
 bool IntersectRayPlane(const mathfu::vec3& plane_normal, float plane_offset,
                        const mathfu::vec3& ray_position,
@@ -47,4 +323,79 @@ bool IntersectRayPlane(const mathfu::vec3& plane_normal, float plane_offset,
   return true;
 }
 
+void CheckRayOBBCollisions(const Ray& ray, const mathfu::mat4* world_mats,
+                           const Aabb* boxes, size_t count,
+                           float* out_distances, bool collision_on_exit) {
+  constexpr size_t kBatchSize = kRayOBBCollisionBatchSize;
+  float m[3][4][kBatchSize];
+  float box_min[3][kBatchSize];
+  float box_max[3][kBatchSize];
+  float distances[kBatchSize];
+
+  for (size_t begin = 0; begin < count; begin += kBatchSize) {
+    const size_t num = std::min(kBatchSize, count - begin);
+
+    // Transpose the batch into lane order.  Unused lanes of the last batch are
+    // filled with a degenerate transform, which never results in a hit.
+    for (size_t lane = 0; lane < kBatchSize; ++lane) {
+      if (lane < num) {
+        const mathfu::mat4& mat = world_mats[begin + lane];
+        const Aabb& box = boxes[begin + lane];
+        for (int row = 0; row < 3; ++row) {
+          for (int col = 0; col < 4; ++col) {
+            m[row][col][lane] = mat(row, col);
+          }
+          box_min[row][lane] = box.min[row];
+          box_max[row][lane] = box.max[row];
+        }
+      } else {
+        for (int row = 0; row < 3; ++row) {
+          for (int col = 0; col < 4; ++col) {
+            m[row][col][lane] = 0.f;
+          }
+          box_min[row][lane] = 0.f;
+          box_max[row][lane] = 0.f;
+        }
+      }
+    }
+
+    CheckRayOBBCollisionBatch(ray, m, box_min, box_max, collision_on_exit,
+                              distances);
+    std::copy(distances, distances + num, out_distances + begin);
+  }
+}
+
+void CheckSpheresInFrustums(
+    const mathfu::vec4* spheres, size_t count,
+    const mathfu::vec4 (*frustums)[kNumFrustumPlanes], size_t num_frustums,
+    uint8_t* out_visible) {
+  constexpr size_t kBatchSize = kSphereFrustumBatchSize;
+  float center[3][kBatchSize];
+  float radius[kBatchSize];
+  float mask[kBatchSize];
+
+  for (size_t begin = 0; begin < count; begin += kBatchSize) {
+    const size_t num = std::min(kBatchSize, count - begin);
+
+    // Transpose the batch into lane order, padding the last batch with empty
+    // spheres whose results are ignored.
+    for (size_t lane = 0; lane < kBatchSize; ++lane) {
+      const mathfu::vec4 sphere =
+          lane < num ? spheres[begin + lane] : mathfu::vec4(0.f, 0.f, 0.f, 0.f);
+      center[0][lane] = sphere.x;
+      center[1][lane] = sphere.y;
+      center[2][lane] = sphere.z;
+      radius[lane] = sphere.w;
+    }
+
+    Store(mask,
+          CheckSphereFrustumBatch(center, radius, frustums, num_frustums));
+    for (size_t lane = 0; lane < num; ++lane) {
+      uint32_t bits;
+      memcpy(&bits, &mask[lane], sizeof(bits));
+      out_visible[begin + lane] = bits != 0 ? 1 : 0;
+    }
+  }
+}
+
 }  // namespace lull
@@ -30,6 +30,36 @@ bool IntersectRayPlane(const mathfu::vec3& plane_normal, float plane_offset,
                        const mathfu::vec3& ray_direction,
                        mathfu::vec3* intersection_position = nullptr);
 
+// The number of boxes CheckRayOBBCollisions() tests at once.  Callers that
+// gather candidates into arrays should prefer multiples of this size.
+constexpr size_t kRayOBBCollisionBatchSize = 4;
+
+// Tests |ray| against |count| OBBs, each of which is defined by an Aabb in
+// |boxes| and the matching affine transform in |world_mats|.  The distance from
+// the ray origin to each hit (or kNoHitDistance on a miss) is written to the
+// matching index of |out_distances|.  This produces the same results as calling
+// CheckRayOBBCollision() on each box, but tests kRayOBBCollisionBatchSize boxes
+// at a time using SIMD instructions where available.
+void CheckRayOBBCollisions(const Ray& ray, const mathfu::mat4* world_mats,
+                           const Aabb* boxes, size_t count,
+                           float* out_distances,
+                           bool collision_on_exit = false);
+
+// The number of spheres CheckSpheresInFrustums() tests at once.
+constexpr size_t kSphereFrustumBatchSize = 4;
+
+// Tests |count| bounding spheres against |num_frustums| view frustums (as
+// computed by CalculateViewFrustum()).  Each sphere in |spheres| stores its
+// center in xyz and its radius in w.  |out_visible| is set to 1 for each sphere
+// that intersects at least one of the frustums, and to 0 otherwise.  This
+// produces the same results as calling CheckSphereInFrustum() on each sphere
+// and frustum, but tests kSphereFrustumBatchSize spheres against all the
+// frustums at a time using SIMD instructions where available.
+void CheckSpheresInFrustums(
+    const mathfu::vec4* spheres, size_t count,
+    const mathfu::vec4 (*frustums)[kNumFrustumPlanes], size_t num_frustums,
+    uint8_t* out_visible);
+
 }  // namespace lull
 
 #endif  // LULLABY_UTIL_INTERSECTIONS_H_
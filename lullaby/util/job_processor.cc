@@ -0,0 +1,298 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/job_processor.h"
+
+namespace lull {
+namespace {
+
+// The JobProcessor and worker index of the calling thread, if it is a worker.
+thread_local const JobProcessor* g_worker_processor = nullptr;
+thread_local size_t g_worker_index = 0;
+
+// Whether the calling thread is inside JobProcessor::RunReadyJobs().
+thread_local bool g_running_ready_jobs = false;
+
+}  // namespace
+
+JobProcessor::JobHandle::JobHandle(Job* job) : job_(job) { AddRef(job_); }
+
+JobProcessor::JobHandle::JobHandle(const JobHandle& rhs) : job_(rhs.job_) {
+  if (job_) {
+    AddRef(job_);
+  }
+}
+
+JobProcessor::JobHandle::JobHandle(JobHandle&& rhs) : job_(rhs.job_) {
+  rhs.job_ = nullptr;
+}
+
+JobProcessor::JobHandle& JobProcessor::JobHandle::operator=(JobHandle rhs) {
+  std::swap(job_, rhs.job_);
+  return *this;
+}
+
+JobProcessor::JobHandle::~JobHandle() {
+  if (job_) {
+    Release(job_);
+  }
+}
+
+JobProcessor::JobProcessor(size_t num_worker_threads) {
+#if LULLABY_USE_JAVASCRIPT_TIMERS
+  num_worker_threads = 0;
+#endif
+  const size_t num_queues = num_worker_threads > 0 ? num_worker_threads : 1;
+  for (size_t i = 0; i < num_queues; ++i) {
+    queues_.emplace_back(new ThreadSafeDeque<Job*>());
+  }
+  for (size_t i = 0; i < num_worker_threads; ++i) {
+    worker_threads_.emplace_back([this, i]() { WorkerThread(i); });
+  }
+}
+
+JobProcessor::~JobProcessor() {
+  {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    stop_ = true;
+  }
+  wait_condition_.notify_all();
+  for (auto& thread : worker_threads_) {
+    thread.join();
+  }
+  // Run anything left over (eg. if there are no worker threads).
+  RunReadyJobs();
+}
+
+JobProcessor::Job* JobProcessor::AllocateJob() {
+  Job* job = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (free_list_) {
+      job = free_list_;
+      free_list_ = job->next_free;
+    } else {
+      jobs_.emplace_back(new Job());
+      job = jobs_.back().get();
+    }
+  }
+
+  job->processor = this;
+  job->num_pending = 1;
+  job->done = false;
+  job->submitted = false;
+  job->next_free = nullptr;
+  return job;
+}
+
+void JobProcessor::AddRef(Job* job) {
+  job->ref_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void JobProcessor::Release(Job* job) {
+  if (job->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    job->processor->FreeJob(job);
+  }
+}
+
+void JobProcessor::FreeJob(Job* job) {
+  job->task.Reset();
+  job->continuations.clear();
+
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  job->next_free = free_list_;
+  free_list_ = job;
+}
+
+void JobProcessor::AddDependency(const JobHandle& job,
+                                 const JobHandle& prerequisite) {
+  if (!job || !prerequisite) {
+    LOG(DFATAL) << "Invalid job.";
+    return;
+  }
+  if (job.job_->submitted) {
+    LOG(DFATAL) << "Dependencies must be added before a job is submitted.";
+    return;
+  }
+
+  Job* prereq = prerequisite.job_;
+  std::lock_guard<std::mutex> lock(prereq->mutex);
+  if (prereq->done) {
+    return;
+  }
+  job.job_->num_pending.fetch_add(1);
+  AddRef(job.job_);
+  prereq->continuations.push_back(job.job_);
+}
+
+void JobProcessor::Submit(const JobHandle& job) {
+  if (!job) {
+    LOG(DFATAL) << "Invalid job.";
+    return;
+  }
+  if (job.job_->submitted) {
+    LOG(DFATAL) << "Jobs must only be submitted once.";
+    return;
+  }
+  job.job_->submitted = true;
+
+  // If the job still has dependencies, the last one to complete will schedule
+  // it instead.
+  if (job.job_->num_pending.fetch_sub(1) == 1) {
+    AddRef(job.job_);
+    Schedule(job.job_);
+  }
+
+  if (worker_threads_.empty()) {
+    RunReadyJobs();
+  }
+}
+
+bool JobProcessor::IsDone(const JobHandle& job) const {
+  return job && job.job_->done;
+}
+
+void JobProcessor::Wait(const JobHandle& job) {
+  if (!job) {
+    return;
+  }
+  if (!job.job_->submitted) {
+    LOG(DFATAL) << "Waiting on a job that has not been submitted.";
+    return;
+  }
+
+  const size_t worker_index = GetWorkerIndex();
+  while (!job.job_->done) {
+    Job* next = FindJob(worker_index);
+    if (next) {
+      Execute(next);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    ++num_sleepers_;
+    ++num_waiters_;
+    wait_condition_.wait(lock, [&]() {
+      return job.job_->done || num_queued_ > 0;
+    });
+    --num_waiters_;
+    --num_sleepers_;
+  }
+}
+
+void JobProcessor::Schedule(Job* job) {
+  const size_t worker_index = GetWorkerIndex();
+  if (worker_index != kNotAWorker) {
+    queues_[worker_index]->PushFront(job);
+  } else {
+    const size_t index = next_queue_++ % queues_.size();
+    queues_[index]->PushBack(job);
+  }
+
+  ++num_queued_;
+  if (num_sleepers_ > 0) {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    wait_condition_.notify_one();
+  }
+}
+
+JobProcessor::Job* JobProcessor::FindJob(size_t worker_index) {
+  Job* job = nullptr;
+  const size_t num_queues = queues_.size();
+  if (worker_index != kNotAWorker) {
+    if (queues_[worker_index]->PopFront(&job)) {
+      --num_queued_;
+      return job;
+    }
+  } else {
+    worker_index = 0;
+  }
+
+  for (size_t i = 1; i <= num_queues; ++i) {
+    const size_t victim = (worker_index + i) % num_queues;
+    if (queues_[victim]->PopBack(&job)) {
+      --num_queued_;
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+void JobProcessor::Execute(Job* job) {
+  job->task();
+  job->task.Reset();
+
+  {
+    std::lock_guard<std::mutex> lock(job->mutex);
+    job->done = true;
+    for (Job* continuation : job->continuations) {
+      // Transfer the reference held by |job| to the deque.
+      if (continuation->num_pending.fetch_sub(1) == 1) {
+        Schedule(continuation);
+      } else {
+        Release(continuation);
+      }
+    }
+    job->continuations.clear();
+  }
+
+  // Wake any threads waiting for |job|.
+  if (num_waiters_ > 0) {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    wait_condition_.notify_all();
+  }
+  Release(job);
+}
+
+void JobProcessor::RunReadyJobs() {
+  if (g_running_ready_jobs) {
+    return;
+  }
+  g_running_ready_jobs = true;
+  while (Job* job = FindJob(kNotAWorker)) {
+    Execute(job);
+  }
+  g_running_ready_jobs = false;
+}
+
+void JobProcessor::WorkerThread(size_t worker_index) {
+  g_worker_processor = this;
+  g_worker_index = worker_index;
+
+  while (true) {
+    Job* job = FindJob(worker_index);
+    if (job) {
+      Execute(job);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    if (stop_ && num_queued_ == 0) {
+      break;
+    }
+    ++num_sleepers_;
+    wait_condition_.wait(lock, [this]() { return stop_ || num_queued_ > 0; });
+    --num_sleepers_;
+  }
+
+  g_worker_processor = nullptr;
+}
+
+size_t JobProcessor::GetWorkerIndex() const {
+  return g_worker_processor == this ? g_worker_index : kNotAWorker;
+}
+
+}  // namespace lull
@@ -17,19 +17,188 @@ limitations under the License.
 #ifndef LULLABY_UTIL_JOB_PROCESSOR_H_
 #define LULLABY_UTIL_JOB_PROCESSOR_H_
 
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <utility>
+#include <vector>
 
-#include "lullaby/util/async_processor.h"
+#include "lullaby/util/async_processor.h"  // LULLABY_USE_JAVASCRIPT_TIMERS
+#include "lullaby/util/inline_function.h"
 #include "lullaby/util/logging.h"
+#include "lullaby/util/thread_safe_deque.h"
 #include "lullaby/util/typeid.h"
 
 namespace lull {
 
-// AsyncProcessor that can be used to execute functions asynchronously. This
-// type of processor has an associated lullaby typeid, which allows it to be
-// used in the lullaby Registry.
-using JobProcessor = AsyncProcessor<std::packaged_task<void()>>;
+// Executes jobs on a pool of worker threads.  This class has an associated
+// lullaby typeid, which allows it to be used in the lullaby Registry.
+//
+// Each worker thread has its own deque of jobs.  Jobs scheduled from a worker
+// thread are added to that worker's deque and are run in LIFO order by it,
+// which keeps related work on the same thread.  Idle workers steal the oldest
+// jobs from the other workers' deques.  Job storage is pooled and small
+// functors are stored inline, so running jobs does not allocate in the steady
+// state.
+//
+// Jobs can also depend on each other, which makes it simple to express
+// fan-out/fan-in work:
+//
+// auto done = processor->Create([]() { /* Runs after all the batches. */ });
+// for (...) {
+//   auto batch = processor->Create([]() { /* Process a batch. */ });
+//   processor->AddDependency(done, batch);
+//   processor->Submit(batch);
+// }
+// processor->Submit(done);
+// processor->Wait(done);
+//
+// If the JobProcessor has no worker threads, jobs are run on the submitting
+// thread as soon as they become ready.
+class JobProcessor {
+ private:
+  struct Job;
+
+ public:
+  // A reference to a job created by the JobProcessor.  JobHandles must not
+  // outlive the JobProcessor that created them.
+  class JobHandle {
+   public:
+    JobHandle() {}
+    JobHandle(const JobHandle& rhs);
+    JobHandle(JobHandle&& rhs);
+    JobHandle& operator=(JobHandle rhs);
+    ~JobHandle();
+
+    explicit operator bool() const { return job_ != nullptr; }
+
+   private:
+    friend class JobProcessor;
+    explicit JobHandle(Job* job);
+
+    Job* job_ = nullptr;
+  };
+
+  // Creates the JobProcessor with the specified number of worker threads.
+  explicit JobProcessor(size_t num_worker_threads = 1);
+
+  JobProcessor(const JobProcessor&) = delete;
+  JobProcessor& operator=(const JobProcessor&) = delete;
+
+  // Waits for all submitted jobs to complete before stopping the worker
+  // threads.
+  ~JobProcessor();
+
+  // Creates a job that will call |fn| once it has been submitted and all of its
+  // dependencies have completed.
+  template <typename Fn>
+  JobHandle Create(Fn&& fn);
+
+  // Creates and submits a job that will call |fn|.
+  template <typename Fn>
+  JobHandle Run(Fn&& fn);
+
+  // Ensures that |job| will not start until |prerequisite| has completed.  This
+  // must be called before |job| is submitted.
+  void AddDependency(const JobHandle& job, const JobHandle& prerequisite);
+
+  // Allows |job| to run as soon as all its dependencies are complete.  Each job
+  // must only be submitted once.
+  void Submit(const JobHandle& job);
+
+  // Returns true if |job| has completed.
+  bool IsDone(const JobHandle& job) const;
+
+  // Blocks until |job| has completed.  While waiting, the calling thread runs
+  // other queued jobs rather than sitting idle.
+  void Wait(const JobHandle& job);
+
+  // Returns the number of worker threads.
+  size_t GetNumWorkerThreads() const { return worker_threads_.size(); }
+
+ private:
+  struct Job {
+    InlineFunction<void()> task;
+    JobProcessor* processor = nullptr;
+    // The number of incomplete dependencies, plus one until the job has been
+    // submitted.
+    std::atomic<int> num_pending{1};
+    std::atomic<int> ref_count{0};
+    std::atomic<bool> done{false};
+    std::atomic<bool> submitted{false};
+    // Guards |continuations| and the transition of |done| to true.
+    std::mutex mutex;
+    // The jobs that depend on this job, each of which holds a reference.
+    std::vector<Job*> continuations;
+    // The next job in the free list.
+    Job* next_free = nullptr;
+  };
+
+  Job* AllocateJob();
+  static void AddRef(Job* job);
+  static void Release(Job* job);
+  void FreeJob(Job* job);
+
+  // Adds a job whose dependencies are complete to a deque, transferring a
+  // reference to the deque.
+  void Schedule(Job* job);
+
+  // Pops a job from the deque of |worker_index|, or steals one from another
+  // deque.
+  Job* FindJob(size_t worker_index);
+
+  // Runs |job| and schedules any continuations that become ready as a result.
+  void Execute(Job* job);
+
+  // Runs jobs on the calling thread until there are none left.  Used when
+  // there are no worker threads.
+  void RunReadyJobs();
+
+  void WorkerThread(size_t worker_index);
+
+  // Index used by threads which are not workers of this JobProcessor.
+  static const size_t kNotAWorker = ~size_t(0);
+
+  // Returns the index of the calling thread if it is a worker of this
+  // JobProcessor, or kNotAWorker.
+  size_t GetWorkerIndex() const;
+
+  std::vector<std::unique_ptr<ThreadSafeDeque<Job*>>> queues_;
+  std::vector<std::thread> worker_threads_;
+  std::atomic<size_t> next_queue_{0};
+  std::atomic<size_t> num_queued_{0};
+
+  // Used to put idle workers and threads inside Wait() to sleep.
+  std::mutex wait_mutex_;
+  std::condition_variable wait_condition_;
+  std::atomic<int> num_sleepers_{0};
+  // The number of sleeping threads inside Wait().
+  std::atomic<int> num_waiters_{0};
+  bool stop_ = false;
+
+  // Pooled job storage.
+  std::mutex pool_mutex_;
+  std::vector<std::unique_ptr<Job>> jobs_;
+  Job* free_list_ = nullptr;
+};
+
+template <typename Fn>
+JobProcessor::JobHandle JobProcessor::Create(Fn&& fn) {
+  Job* job = AllocateJob();
+  job->task.Set(std::forward<Fn>(fn));
+  return JobHandle(job);
+}
+
+template <typename Fn>
+JobProcessor::JobHandle JobProcessor::Run(Fn&& fn) {
+  JobHandle job = Create(std::forward<Fn>(fn));
+  Submit(job);
+  return job;
+}
 
 // Queues the specified function for execution and returns a future which can
 // be used to query the status. Execution will begin as soon as worker thread
@@ -40,8 +209,7 @@ std::future<void> RunJob(JobProcessor* processor, Func&& func) {
 
   std::packaged_task<void()> task(std::forward<Func>(func));
   auto job = task.get_future();
-  processor->Execute(std::move(task),
-                     [](std::packaged_task<void()>* task) { (*task)(); });
+  processor->Run(std::move(task));
   return job;
 }
 
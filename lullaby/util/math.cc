@@ -749,6 +749,73 @@ void CalculateViewFrustum(
   }
 }
 
+bool CalculateCombinedViewFrustum(
+    const mathfu::mat4* clip_from_world_matrices, size_t num_views,
+    mathfu::vec4 frustum_clipping_planes[kNumFrustumPlanes]) {
+  if (num_views == 0) {
+    return false;
+  }
+  if (num_views == 1) {
+    CalculateViewFrustum(clip_from_world_matrices[0], frustum_clipping_planes);
+    return true;
+  }
+
+  // Each combined plane is oriented halfway between the matching planes of
+  // the views, and pushed out until all the corners of all the frusta are on
+  // its inner side.  Since each frustum is the convex hull of its corners, it
+  // then lies entirely inside the combined frustum.
+  mathfu::vec3 normals[kNumFrustumPlanes];
+  for (int i = 0; i < kNumFrustumPlanes; ++i) {
+    normals[i] = mathfu::kZeros3f;
+  }
+  mathfu::vec4 view_planes[kNumFrustumPlanes];
+  for (size_t view = 0; view < num_views; ++view) {
+    CalculateViewFrustum(clip_from_world_matrices[view], view_planes);
+    for (int i = 0; i < kNumFrustumPlanes; ++i) {
+      normals[i] += view_planes[i].xyz();
+    }
+  }
+  CalculateViewFrustum(clip_from_world_matrices[0], view_planes);
+  for (int i = 0; i < kNumFrustumPlanes; ++i) {
+    const float length = normals[i].Length();
+    // Opposing planes cancel out, in which case the first view's plane is
+    // used as is.
+    normals[i] =
+        length > kDefaultEpsilon ? normals[i] / length : view_planes[i].xyz();
+  }
+
+  float min_distances[kNumFrustumPlanes];
+  for (int i = 0; i < kNumFrustumPlanes; ++i) {
+    min_distances[i] = std::numeric_limits<float>::max();
+  }
+  for (size_t view = 0; view < num_views; ++view) {
+    const mathfu::mat4 world_from_clip =
+        clip_from_world_matrices[view].Inverse();
+    for (int corner = 0; corner < 8; ++corner) {
+      const mathfu::vec4 clip((corner & 1) ? 1.f : -1.f,
+                              (corner & 2) ? 1.f : -1.f,
+                              (corner & 4) ? 1.f : -1.f, 1.f);
+      const mathfu::vec4 world = world_from_clip * clip;
+      if (std::abs(world.w) < kDefaultEpsilon) {
+        return false;
+      }
+      const mathfu::vec3 point = world.xyz() / world.w;
+      for (int i = 0; i < kNumFrustumPlanes; ++i) {
+        const float distance = mathfu::vec3::DotProduct(normals[i], point);
+        if (!std::isfinite(distance)) {
+          return false;
+        }
+        min_distances[i] = std::min(min_distances[i], distance);
+      }
+    }
+  }
+
+  for (int i = 0; i < kNumFrustumPlanes; ++i) {
+    frustum_clipping_planes[i] = mathfu::vec4(normals[i], -min_distances[i]);
+  }
+  return true;
+}
+
 bool CheckSphereInFrustum(
     const mathfu::vec3& center, const float radius,
     const mathfu::vec4 frustum_clipping_planes[kNumFrustumPlanes]) {
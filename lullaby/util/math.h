@@ -473,6 +473,16 @@ void CalculateViewFrustum(
     const mathfu::mat4& clip_from_world_matrix,
     mathfu::vec4 frustum_clipping_planes[kNumFrustumPlanes]);
 
+// Calculates a single set of frustum clipping planes that encloses the view
+// frusta of all |num_views| view projection matrices (eg. both eyes of a
+// stereo camera), so that culling can be done once for all views.  Anything
+// inside any of the frusta is inside the combined frustum, though the reverse
+// is not true.  Returns false if the frusta are not bounded (eg. they have an
+// infinite far plane), in which case the views need to be culled separately.
+bool CalculateCombinedViewFrustum(
+    const mathfu::mat4* clip_from_world_matrices, size_t num_views,
+    mathfu::vec4 frustum_clipping_planes[kNumFrustumPlanes]);
+
 // Returns true if a bounding sphere intersects the frustum clipping planes.
 // The center of the sphere and frustum clipping planes are assumed to be in the
 // same view space.
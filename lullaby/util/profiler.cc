@@ -16,7 +16,10 @@ limitations under the License.
 
 #include "lullaby/util/profiler.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iomanip>
+#include <mutex>
 
 #include "absl/base/config.h"
 #include "lullaby/util/logging.h"
@@ -34,21 +37,121 @@ thread_local ProfilerData* g_profiler_data = nullptr;
 ThreadLocal<ProfilerData*> g_profiler_data(nullptr);
 #endif
 
+// All the ProfilerData instances, so that their statistics can be read from
+// any thread.  The mutex is only locked when a thread starts or stops being
+// profiled, and while reading statistics.
+std::mutex g_all_profiler_data_mutex;
+std::vector<ProfilerData*> g_all_profiler_data;
+size_t g_next_thread_index = 0;
+
+ProfilerData* CreateProfilerData() {
+  ProfilerData* data = new ProfilerData();
+  std::lock_guard<std::mutex> lock(g_all_profiler_data_mutex);
+  data->thread_index = g_next_thread_index++;
+  g_all_profiler_data.push_back(data);
+  return data;
+}
+
+void DestroyProfilerData(ProfilerData* data) {
+  if (!data) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(g_all_profiler_data_mutex);
+    g_all_profiler_data.erase(std::remove(g_all_profiler_data.begin(),
+                                          g_all_profiler_data.end(), data),
+                              g_all_profiler_data.end());
+  }
+  delete data;
+}
+
 ProfilerData* GetMutableProfilerData() {
 #if defined(ABSL_HAVE_THREAD_LOCAL)
   if (!g_profiler_data) {
-    g_profiler_data = new ProfilerData();
+    g_profiler_data = CreateProfilerData();
   }
 
   return g_profiler_data;
 #else
   if (!g_profiler_data.get()) {
-    g_profiler_data.set(new ProfilerData());
+    g_profiler_data.set(CreateProfilerData());
   }
   return *(g_profiler_data.pointer());
 #endif
 }
 
+detail::ProfilerSampleHistory* GetSampleHistory(ProfilerData* profile,
+                                                size_t index) {
+  detail::ProfilerSampleHistory* history =
+      profile->histories[index].load(std::memory_order_relaxed);
+  if (!history) {
+    history = new detail::ProfilerSampleHistory();
+    history->name = profile->samples[index].name.data();
+    profile->histories[index].store(history, std::memory_order_release);
+    if (index >= profile->num_histories.load(std::memory_order_relaxed)) {
+      profile->num_histories.store(index + 1, std::memory_order_release);
+    }
+  }
+  return history;
+}
+
+void RecordDuration(detail::ProfilerSampleHistory* history,
+                    float duration_ms) {
+  // Only the owning thread writes to the history, so the count does not need
+  // an atomic increment.
+  const uint64_t count = history->num_recorded.load(std::memory_order_relaxed);
+  history->durations_ms[count % kProfilerHistorySize].store(
+      duration_ms, std::memory_order_relaxed);
+  history->num_recorded.store(count + 1, std::memory_order_release);
+}
+
+size_t GetHistogramBucket(double duration_ms) {
+  const double duration_us = duration_ms * 1000.0;
+  if (duration_us < 1.0) {
+    return 0;
+  }
+  const size_t bucket = static_cast<size_t>(std::log2(duration_us)) + 1;
+  return std::min(bucket, kProfilerHistogramBuckets - 1);
+}
+
+// Returns the value at |percentile| (in [0, 1]) of the sorted |values|, using
+// the nearest-rank method.
+double GetPercentile(const std::vector<float>& values, double percentile) {
+  const size_t rank =
+      static_cast<size_t>(std::ceil(percentile * values.size()));
+  return values[rank > 0 ? rank - 1 : 0];
+}
+
+void ComputeStats(const detail::ProfilerSampleHistory& history,
+                  ProfilerSampleStats* stats) {
+  const uint64_t count = history.num_recorded.load(std::memory_order_acquire);
+  const size_t num_calls =
+      static_cast<size_t>(std::min<uint64_t>(count, kProfilerHistorySize));
+  std::vector<float> durations(num_calls);
+  for (size_t i = 0; i < num_calls; ++i) {
+    durations[i] = history.durations_ms[i].load(std::memory_order_relaxed);
+  }
+
+  *stats = ProfilerSampleStats();
+  stats->name = history.name;
+  stats->num_calls = num_calls;
+  if (num_calls == 0) {
+    return;
+  }
+
+  std::sort(durations.begin(), durations.end());
+  double total = 0.0;
+  for (const float duration : durations) {
+    total += duration;
+    ++stats->histogram[GetHistogramBucket(duration)];
+  }
+  stats->mean_ms = total / static_cast<double>(num_calls);
+  stats->p50_ms = GetPercentile(durations, 0.50);
+  stats->p95_ms = GetPercentile(durations, 0.95);
+  stats->p99_ms = GetPercentile(durations, 0.99);
+  stats->max_ms = durations.back();
+}
+
 ProfilerSampleData* GetSampleData(size_t* index,
                                   const char* sample_name = nullptr) {
   ProfilerData* profile = GetMutableProfilerData();
@@ -88,23 +191,81 @@ void ProfileSampleEnd(size_t* index) {
   if (sample->current_unfinished_call == 0) {
     sample->end_time_point = std::chrono::high_resolution_clock::now();
     profiler->current_sample_index = sample->parent_index;
+    RecordDuration(GetSampleHistory(profiler, *index),
+                   std::chrono::duration<float, std::milli>(
+                       sample->end_time_point - sample->start_time_point)
+                       .count());
   }
 }
 
 }  // namespace detail
 
+ProfilerData::ProfilerData()
+    : samples(kProfilerMaxSamples),
+      histories(new std::atomic<detail::ProfilerSampleHistory*>[
+          kProfilerMaxSamples]) {
+  for (size_t i = 0; i < kProfilerMaxSamples; ++i) {
+    histories[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+ProfilerData::~ProfilerData() {
+  for (size_t i = 0; i < kProfilerMaxSamples; ++i) {
+    delete histories[i].load(std::memory_order_relaxed);
+  }
+}
+
 const ProfilerData* GetProfilerData() { return GetMutableProfilerData(); }
 
 void CleanupProfiler() {
 #if defined(ABSL_HAVE_THREAD_LOCAL)
-  delete g_profiler_data;
+  DestroyProfilerData(g_profiler_data);
   g_profiler_data = nullptr;
 #else
-  delete g_profiler_data.get();
+  DestroyProfilerData(g_profiler_data.get());
   g_profiler_data.set(nullptr);
 #endif
 }
 
+bool GetProfilerSampleStats(string_view name, ProfilerSampleStats* stats) {
+  ProfilerData* profile = GetMutableProfilerData();
+  const size_t num_histories =
+      profile->num_histories.load(std::memory_order_acquire);
+  for (size_t i = 0; i < num_histories; ++i) {
+    const detail::ProfilerSampleHistory* history =
+        profile->histories[i].load(std::memory_order_acquire);
+    if (history && name == history->name) {
+      ComputeStats(*history, stats);
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<ProfilerThreadStats> GetAllProfilerStats() {
+  std::vector<ProfilerThreadStats> result;
+
+  std::lock_guard<std::mutex> lock(g_all_profiler_data_mutex);
+  result.reserve(g_all_profiler_data.size());
+  for (const ProfilerData* profile : g_all_profiler_data) {
+    result.emplace_back();
+    ProfilerThreadStats& thread_stats = result.back();
+    thread_stats.thread_index = profile->thread_index;
+
+    const size_t num_histories =
+        profile->num_histories.load(std::memory_order_acquire);
+    for (size_t i = 0; i < num_histories; ++i) {
+      const detail::ProfilerSampleHistory* history =
+          profile->histories[i].load(std::memory_order_acquire);
+      if (history) {
+        thread_stats.samples.emplace_back();
+        ComputeStats(*history, &thread_stats.samples.back());
+      }
+    }
+  }
+  return result;
+}
+
 std::ostream& operator<<(std::ostream& os, const ProfilerData& profiler) {
   os << std::endl;
   os << std::setw(40) << "Sample Name "
@@ -116,7 +277,7 @@ std::ostream& operator<<(std::ostream& os, const ProfilerData& profiler) {
   os << std::endl;
 
   size_t count = 0;
-  for (auto sample : profiler.samples) {
+  for (const auto& sample : profiler.samples) {
     if (count++ == profiler.next_allocated_index) break;
     if (sample.current_unfinished_call > 0) {
       continue;
@@ -40,9 +40,24 @@ limitations under the License.
 /// Note that samples of recursion functions will include the time for the
 /// entire duration of the first call to the function including all its
 /// recursive calls.
+///
+/// The profiler also keeps the durations of the most recent calls to each
+/// sample, which can be used to monitor percentiles of the running time (eg. to
+/// detect frame time regressions while the app is running):
+/// ProfilerSampleStats stats;
+/// if (GetProfilerSampleStats("my_function", &stats) && stats.p99_ms > 5.0) {
+///   LOG(WARNING) << "my_function is running slowly.";
+/// }
+///
+/// GetAllProfilerStats() returns the same statistics for every thread that is
+/// being profiled.
 
+#include <stdint.h>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <iostream>
+#include <memory>
 #include <stack>
 #include <vector>
 
@@ -66,6 +81,26 @@ void ProfileSampleEnd(size_t* index);
 static const size_t kUninitializedProfileSampleIndex = size_t(-1);
 /// Constant value defining the maximum number of samples in each profiler.
 static const size_t kProfilerMaxSamples = 4000;
+/// Constant value defining the number of recent durations kept for each sample.
+static const size_t kProfilerHistorySize = 256;
+/// Constant value defining the number of buckets in ProfilerSampleStats
+/// histograms.
+static const size_t kProfilerHistogramBuckets = 20;
+
+namespace detail {
+
+/// A ring buffer of the most recent durations of a sample.  It is only written
+/// to by the thread that owns the sample, but can be read from any thread.
+struct ProfilerSampleHistory {
+  /// The name of the sample.
+  const char* name = nullptr;
+  /// The total number of durations that have been recorded.
+  std::atomic<uint64_t> num_recorded{0};
+  /// The recorded durations in milliseconds.
+  std::array<std::atomic<float>, kProfilerHistorySize> durations_ms;
+};
+
+}  // namespace detail
 
 /// Cleans the profiler data for the thread it was called.
 void CleanupProfiler();
@@ -100,13 +135,60 @@ struct ProfilerData {
   size_t current_sample_index = 0;
   /// The next allocated index is used to give an index for new samples.
   size_t next_allocated_index = 0;
-
-  ProfilerData() : samples(kProfilerMaxSamples) {}
+  /// A number identifying the thread this data was collected on.
+  size_t thread_index = 0;
+  /// The recent durations of each sample, indexed like |samples|.  Histories
+  /// are allocated when a sample is first used, and |num_histories| is only
+  /// incremented once the history for the new sample has been published.
+  std::unique_ptr<std::atomic<detail::ProfilerSampleHistory*>[]> histories;
+  std::atomic<size_t> num_histories{0};
+
+  ProfilerData();
+  ~ProfilerData();
+
+  ProfilerData(const ProfilerData&) = delete;
+  ProfilerData& operator=(const ProfilerData&) = delete;
 };
 
 /// Retrieves the profiler data for the current thread.
 const ProfilerData* GetProfilerData();
 
+/// ProfilerSampleStats summarizes the most recent (up to kProfilerHistorySize)
+/// calls to a sample.  All times are in milliseconds.
+struct ProfilerSampleStats {
+  /// The name of the sample.
+  string_view name;
+  /// The number of calls included in the statistics.
+  size_t num_calls = 0;
+  double mean_ms = 0.0;
+  double p50_ms = 0.0;
+  double p95_ms = 0.0;
+  double p99_ms = 0.0;
+  double max_ms = 0.0;
+  /// The number of calls by duration.  The first bucket holds calls shorter
+  /// than 1 microsecond, bucket i holds calls of [2^(i-1), 2^i) microseconds,
+  /// and the last bucket also holds any longer calls.
+  std::array<uint32_t, kProfilerHistogramBuckets> histogram;
+
+  ProfilerSampleStats() { histogram.fill(0); }
+};
+
+/// ProfilerThreadStats holds the statistics of all samples on one thread.
+struct ProfilerThreadStats {
+  /// The ProfilerData::thread_index of the thread.
+  size_t thread_index = 0;
+  std::vector<ProfilerSampleStats> samples;
+};
+
+/// Computes the statistics of the sample |name| on the current thread.  Returns
+/// false if the sample has not been called on this thread.
+bool GetProfilerSampleStats(string_view name, ProfilerSampleStats* stats);
+
+/// Computes the statistics of every sample of every thread that is being
+/// profiled.  This can be called from any thread, and does not block the
+/// profiled threads.
+std::vector<ProfilerThreadStats> GetAllProfilerStats();
+
 /// The ScopedSampleProfiler is a helper class for profiling samples of code. It
 /// calls |ProfileSampleStart| at its construction and |ProfileSampleEnd| at its
 /// destruction.
@@ -135,5 +217,28 @@ std::ostream& operator<<(std::ostream& os, const ProfilerData& profiler);
 
 }  // namespace lull
 
+#ifdef PROFILE_LULLABY
+
+#define LULL_PROFILE_START(sample_name)                        \
+  static size_t lull_profile_index_##sample_name =             \
+      ::lull::kUninitializedProfileSampleIndex;                \
+  ::lull::detail::ProfileSampleStart(#sample_name,             \
+                                     &lull_profile_index_##sample_name)
+#define LULL_PROFILE_END(sample_name) \
+  ::lull::detail::ProfileSampleEnd(&lull_profile_index_##sample_name)
+#define LULL_PROFILE(sample_name)                               \
+  static size_t lull_profile_index_##sample_name =              \
+      ::lull::kUninitializedProfileSampleIndex;                 \
+  ::lull::ScopedSampleProfiler lull_profile_scope_##sample_name( \
+      #sample_name, &lull_profile_index_##sample_name)
+
+#else  // PROFILE_LULLABY
+
+#define LULL_PROFILE_START(sample_name)
+#define LULL_PROFILE_END(sample_name)
+#define LULL_PROFILE(sample_name)
+
+#endif  // PROFILE_LULLABY
+
 
 #endif  // LULLABY_UTIL_PROFILER_H_
@@ -18,6 +18,8 @@ limitations under the License.
 #define LULLABY_UTIL_REGISTRY_H_
 
 #include <assert.h>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -45,10 +47,18 @@ namespace lull {
 // destroy all objects (in reverse order of creation/registration) when it
 // itself is destroyed.
 //
+// Each type that is used with a Registry is assigned a dense slot index the
+// first time it is used, so Get() is a lock-free array lookup rather than a
+// locked hash table lookup.
+//
 // All operations on the Registry are thread-safe.
 class Registry {
  public:
-  Registry() {}
+  Registry() {
+    for (auto& slot : slots_) {
+      slot.store(nullptr, std::memory_order_relaxed);
+    }
+  }
 
   ~Registry() {
     // Destroy objects in reverse order of registration.
@@ -59,6 +69,10 @@ class Registry {
       // Destroy the object before removing it from the ObjectTable in case
       // the object is referenced in the registry in its destructor.
       iter->second.reset();
+      const size_t slot = AssignSlot(iter->first);
+      if (slot < kMaxSlots) {
+        slots_[slot].store(nullptr, std::memory_order_release);
+      }
 #if LULLABY_REGISTRY_LOG_DESTRUCTION
       {
         const auto dt = MillisecondsFromDuration(timer.GetElapsedTime());
@@ -108,8 +122,11 @@ class Registry {
     // ability to correctly delete the object.
     Pointer ptr(std::static_pointer_cast<void>(shared));
 
+    const size_t slot = GetSlot<T>();
     std::unique_lock<std::mutex> lock(mutex_);
-    table_.emplace(type, ptr.get());
+    if (table_.emplace(type, ptr.get()).second && slot < kMaxSlots) {
+      slots_[slot].store(ptr.get(), std::memory_order_release);
+    }
     objects_.emplace_back(type, ptr);
     dependency_checker_.SatisfyDependency(type);
   }
@@ -118,6 +135,10 @@ class Registry {
   // it has not been registered.
   template<typename T>
   T* Get() {
+    const size_t slot = GetSlot<T>();
+    if (slot < kMaxSlots) {
+      return static_cast<T*>(slots_[slot].load(std::memory_order_acquire));
+    }
     std::unique_lock<std::mutex> lock(mutex_);
     auto iter = table_.find(GetTypeId<T>());
     if (iter == table_.end()) {
@@ -130,6 +151,11 @@ class Registry {
   // it has not been registered.
   template<typename T>
   const T* Get() const {
+    const size_t slot = GetSlot<T>();
+    if (slot < kMaxSlots) {
+      return static_cast<const T*>(
+          slots_[slot].load(std::memory_order_acquire));
+    }
     std::unique_lock<std::mutex> lock(mutex_);
     auto iter = table_.find(GetTypeId<T>());
     if (iter == table_.end()) {
@@ -169,10 +195,31 @@ class Registry {
   // can be more explicitly controlled (and for slightly better performance).
   using ObjectTable = std::unordered_map<TypeId, void*>;
 
+  // The number of types that can be looked up by slot.  Types beyond this
+  // limit fall back to the (locked) ObjectTable.
+  static constexpr size_t kMaxSlots = 512;
+
+  // Returns the slot index assigned to |type|, assigning the next free index
+  // if it does not have one yet.  Slots are shared by all Registries.
+  static size_t AssignSlot(TypeId type) {
+    static std::mutex mutex;
+    static std::unordered_map<TypeId, size_t> slots;
+    std::unique_lock<std::mutex> lock(mutex);
+    return slots.emplace(type, slots.size()).first->second;
+  }
+
+  // Returns the slot index for |T|, caching it after the first lookup.
+  template <typename T>
+  static size_t GetSlot() {
+    static const size_t slot = AssignSlot(GetTypeId<T>());
+    return slot;
+  }
+
   mutable std::mutex mutex_;  // Mutex for protecting all operations.
   ObjectList objects_;  // List of Objects in order of creation that is used to
                         // destroy them in reverse order.
   ObjectTable table_;   // Map of Objects and their TypeIds for lookup.
+  std::array<std::atomic<void*>, kMaxSlots> slots_;  // Objects by slot index.
 
   DependencyChecker dependency_checker_;  // Used to validate dependencies.
 
@@ -17,11 +17,16 @@ limitations under the License.
 #ifndef LULLABY_BASE_RESOURCE_MANAGER_H_
 #define LULLABY_BASE_RESOURCE_MANAGER_H_
 
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "lullaby/util/hash.h"
 
@@ -59,6 +64,11 @@ namespace lull {
 // is possible to still "leak" some memory even after releasing all references.
 // The Erase() function will remove all references to the object. And Reset()
 // will erase all object references entirely.
+//
+// The ResourceManager can also keep the memory used by its objects within a
+// budget.  Objects report their size through a SizeFn, and once the live
+// objects use more than the budget, the least recently used objects that are
+// only referenced by the ResourceManager itself are erased.
 template <typename T>
 class ResourceManager {
  public:
@@ -105,6 +115,52 @@ class ResourceManager {
   // Releases all the objects from the internal cache.
   void Reset();
 
+  // Releases the strong-references to all the objects, like calling Release()
+  // on every key, and erases the entries of objects that are no longer alive.
+  // Objects that are still referenced elsewhere will be returned by later
+  // calls to Create() and Find() rather than being recreated.
+  void ReleaseAll();
+
+  // Returns the number of bytes of memory used by an object.
+  using SizeFn = std::function<size_t(const T&)>;
+
+  // Sets the function used to measure objects, which happens when they are
+  // added to the cache and when UpdateSize() is called.
+  void SetSizeFn(SizeFn size_fn) { size_fn_ = std::move(size_fn); }
+
+  // Measures the object associated with |key| again, eg. once it has finished
+  // loading asynchronously.
+  void UpdateSize(HashValue key);
+
+  // Limits the number of bytes used by live objects, or removes the limit if
+  // |budget_bytes| is 0 (the default).  Only objects owned by the cache (see
+  // kCacheFullyOnCreate and Register()) can be evicted to meet the budget.
+  void SetBudget(size_t budget_bytes);
+
+  // Erases the least recently used objects that are not referenced outside of
+  // the cache until the live objects fit in the budget.  This happens
+  // automatically when objects are added, but should also be called
+  // periodically since objects count against the budget until they are
+  // unreferenced.
+  void EnforceBudget();
+
+  struct Stats {
+    // The number of live objects in the cache.
+    size_t num_objects = 0;
+    // The number of bytes used by the live objects.
+    size_t resident_bytes = 0;
+    // The number of bytes used by objects that are only kept alive by the
+    // cache, and so could be evicted.
+    size_t unreferenced_bytes = 0;
+    size_t budget_bytes = 0;
+    // The number of objects evicted to meet the budget so far.
+    size_t num_evicted = 0;
+  };
+
+  // Returns the memory statistics of the cache.  Since each ResourceManager
+  // manages a single type of object, these are the statistics for that type.
+  Stats GetStats() const;
+
   // Creates and attaches a new ResourceGroup.  All resource allocations from
   // now on will be associated with this group.
   void PushNewResourceGroup();
@@ -127,14 +183,32 @@ class ResourceManager {
   struct ObjectCacheEntry {
     ObjectPtr strong_ref;
     WeakPtr weak_ref;
+    size_t size = 0;
+    // The value of |clock_| when the object was last created or found.
+    mutable uint64_t last_used = 0;
   };
 
+  void Touch(const ObjectCacheEntry& entry) const {
+    entry.last_used = ++clock_;
+  }
+  size_t Measure(const ObjectPtr& obj) const {
+    return size_fn_ && obj ? size_fn_(*obj) : 0;
+  }
+  static bool IsUnreferenced(const ObjectCacheEntry& entry) {
+    return entry.strong_ref && entry.strong_ref.use_count() == 1;
+  }
+
   CacheMode mode_ = kCacheFullyOnCreate;
   std::unordered_map<HashValue, ObjectCacheEntry> objects_;
 
   // std::list allows us to use the address of the contained object safely.
   std::list<KeyList> attached_groups_;
   std::list<KeyList> detached_groups_;
+
+  SizeFn size_fn_;
+  size_t budget_bytes_ = 0;
+  size_t num_evicted_ = 0;
+  mutable uint64_t clock_ = 0;
 };
 
 template <typename T>
@@ -160,17 +234,28 @@ typename ResourceManager<T>::ObjectPtr ResourceManager<T>::Create(
     if (mode_ == kCacheFullyOnCreate) {
       entry.strong_ref = obj;
     }
+    bool added = false;
     if (iter != objects_.end()) {
       // If the cached shared_ptr was released, reacquire it.
       if (iter->second.strong_ref == nullptr) {
+        entry.size = iter->second.weak_ref.expired() ? Measure(obj)
+                                                     : iter->second.size;
+        added = true;
         iter->second = std::move(entry);
       }
+      Touch(iter->second);
     } else {
+      entry.size = Measure(obj);
+      Touch(entry);
       objects_.emplace(key, std::move(entry));
+      added = true;
     }
     if (!attached_groups_.empty()) {
       attached_groups_.front().push_front(key);
     }
+    if (added) {
+      EnforceBudget();
+    }
   }
   return obj;
 }
@@ -180,6 +265,8 @@ void ResourceManager<T>::Register(HashValue key, const ObjectPtr& obj) {
   ObjectCacheEntry entry;
   entry.strong_ref = obj;
   entry.weak_ref = obj;
+  entry.size = Measure(obj);
+  Touch(entry);
 
   auto iter = objects_.find(key);
   if (iter != objects_.end()) {
@@ -187,6 +274,7 @@ void ResourceManager<T>::Register(HashValue key, const ObjectPtr& obj) {
   } else {
     objects_.emplace(key, std::move(entry));
   }
+  EnforceBudget();
 }
 
 template <typename T>
@@ -195,6 +283,7 @@ auto ResourceManager<T>::Find(HashValue key) const -> ObjectPtr {
   if (iter != objects_.end()) {
     // Acquire the object from the weak_ref in case it has been released from
     // the cache but is still actually alive.
+    Touch(iter->second);
     return iter->second.weak_ref.lock();
   } else {
     return nullptr;
@@ -219,6 +308,92 @@ void ResourceManager<T>::Reset() {
   objects_.clear();
 }
 
+template <typename T>
+void ResourceManager<T>::UpdateSize(HashValue key) {
+  auto iter = objects_.find(key);
+  if (iter != objects_.end()) {
+    iter->second.size = Measure(iter->second.weak_ref.lock());
+    EnforceBudget();
+  }
+}
+
+template <typename T>
+void ResourceManager<T>::SetBudget(size_t budget_bytes) {
+  budget_bytes_ = budget_bytes;
+  EnforceBudget();
+}
+
+template <typename T>
+void ResourceManager<T>::EnforceBudget() {
+  if (budget_bytes_ == 0) {
+    return;
+  }
+
+  size_t resident_bytes = 0;
+  std::vector<std::pair<uint64_t, HashValue>> evictable;
+  for (const auto& iter : objects_) {
+    if (!iter.second.weak_ref.expired()) {
+      resident_bytes += iter.second.size;
+      if (IsUnreferenced(iter.second)) {
+        evictable.emplace_back(iter.second.last_used, iter.first);
+      }
+    }
+  }
+  if (resident_bytes <= budget_bytes_) {
+    return;
+  }
+
+  std::sort(evictable.begin(), evictable.end(),
+            [](const std::pair<uint64_t, HashValue>& lhs,
+               const std::pair<uint64_t, HashValue>& rhs) {
+              return lhs.first < rhs.first;
+            });
+
+  // The evicted objects are only destroyed once the cache has been updated,
+  // since their destructors may call back into this ResourceManager.
+  std::vector<ObjectPtr> evicted;
+  for (const auto& candidate : evictable) {
+    if (resident_bytes <= budget_bytes_) {
+      break;
+    }
+    auto iter = objects_.find(candidate.second);
+    resident_bytes -= iter->second.size;
+    evicted.emplace_back(std::move(iter->second.strong_ref));
+    objects_.erase(iter);
+    ++num_evicted_;
+  }
+  evicted.clear();
+}
+
+template <typename T>
+auto ResourceManager<T>::GetStats() const -> Stats {
+  Stats stats;
+  for (const auto& iter : objects_) {
+    if (!iter.second.weak_ref.expired()) {
+      ++stats.num_objects;
+      stats.resident_bytes += iter.second.size;
+      if (IsUnreferenced(iter.second)) {
+        stats.unreferenced_bytes += iter.second.size;
+      }
+    }
+  }
+  stats.budget_bytes = budget_bytes_;
+  stats.num_evicted = num_evicted_;
+  return stats;
+}
+
+template <typename T>
+void ResourceManager<T>::ReleaseAll() {
+  for (auto iter = objects_.begin(); iter != objects_.end();) {
+    iter->second.strong_ref.reset();
+    if (iter->second.weak_ref.expired()) {
+      objects_.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+}
+
 template <typename T>
 void ResourceManager<T>::PushNewResourceGroup() {
   attached_groups_.emplace_front();
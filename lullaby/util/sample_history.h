@@ -0,0 +1,62 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_SAMPLE_HISTORY_H_
+#define LULLABY_UTIL_SAMPLE_HISTORY_H_
+
+#include <algorithm>
+#include <vector>
+
+namespace lull {
+
+// A ring buffer of the most recent samples of a value (eg. a frame time),
+// used to plot rolling graphs.  It starts out filled with zeros.
+class SampleHistory {
+ public:
+  explicit SampleHistory(int size) : values_(std::max(size, 1), 0.f) {}
+
+  // Replaces the oldest sample with |value|.
+  void Add(float value) {
+    values_[offset_] = value;
+    offset_ = (offset_ + 1) % GetSize();
+  }
+
+  // Returns the most recently added sample.
+  float GetLatest() const {
+    return values_[(offset_ + GetSize() - 1) % GetSize()];
+  }
+
+  // Returns the largest sample.
+  float GetMax() const {
+    return *std::max_element(values_.begin(), values_.end());
+  }
+
+  // Returns all the samples in storage order.  The oldest sample is at
+  // GetOffset().
+  const std::vector<float>& GetValues() const { return values_; }
+
+  int GetOffset() const { return offset_; }
+
+  int GetSize() const { return static_cast<int>(values_.size()); }
+
+ private:
+  std::vector<float> values_;
+  int offset_ = 0;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_UTIL_SAMPLE_HISTORY_H_
@@ -17,25 +17,278 @@ limitations under the License.
 #include "lullaby/util/scheduled_processor.h"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 
 #include "lullaby/util/logging.h"
 
 namespace lull {
+namespace {
+
+// Each level of the timing wheel has 2^kSlotBits slots, with each slot in a
+// level spanning all the slots in the level below it.
+constexpr int kSlotBits = 8;
+constexpr size_t kNumSlots = 1 << kSlotBits;
+constexpr uint64_t kSlotMask = kNumSlots - 1;
+constexpr int kNumLevels = 4;
+
+// The duration of a single slot at the lowest level of the timing wheel. Tasks
+// within the same slot are still processed in trigger time order.
+constexpr Clock::duration kTickDuration = std::chrono::milliseconds(1);
+
+constexpr uint32_t kNullNode = ~0u;
+
+uint64_t GetTick(Clock::duration time) {
+  return time <= Clock::duration::zero()
+             ? 0
+             : static_cast<uint64_t>(time / kTickDuration);
+}
+
+}  // namespace
 
 const ScheduledProcessor::TaskId ScheduledProcessor::kInvalidTaskId;
 
+// A hierarchical timing wheel. Tasks are stored in a pool of nodes which are
+// linked into the slot for their trigger time, so adding and cancelling a task
+// is O(1). As time advances, tasks in higher levels are cascaded down into the
+// lower levels until they reach the lowest level from which they are processed.
+class ScheduledProcessor::TimingWheel {
+ public:
+  // The trigger time and ID of a task that is ready to be processed.
+  struct DueTask {
+    Clock::duration trigger_time;
+    TaskId task_id;
+
+    bool operator<(const DueTask& rhs) const {
+      if (trigger_time != rhs.trigger_time) {
+        return trigger_time < rhs.trigger_time;
+      }
+      return task_id < rhs.task_id;
+    }
+  };
+
+  TimingWheel() { heads_.fill(kNullNode); }
+
+  // Scratch storage for the tasks collected in ScheduledProcessor::Tick, kept
+  // to avoid reallocating it every Tick.
+  std::vector<DueTask> due_buffer;
+
+  size_t Size() const { return lookup_.size(); }
+
+  void Add(Task task, TaskId task_id, Clock::duration trigger_time) {
+    uint32_t index = free_;
+    if (index != kNullNode) {
+      free_ = nodes_[index].next;
+    } else {
+      index = static_cast<uint32_t>(nodes_.size());
+      nodes_.emplace_back();
+    }
+
+    Node& node = nodes_[index];
+    node.task = std::move(task);
+    node.task_id = task_id;
+    node.trigger_time = trigger_time;
+    lookup_.emplace(task_id, index);
+    Link(index);
+  }
+
+  // Removes the task from the wheel, returning false if it is not pending.
+  bool Cancel(TaskId task_id) {
+    auto iter = lookup_.find(task_id);
+    if (iter == lookup_.end()) {
+      return false;
+    }
+    const uint32_t index = iter->second;
+    lookup_.erase(iter);
+    Unlink(index);
+    Release(index);
+    return true;
+  }
+
+  // Moves the task out of the wheel, returning false if it is not pending.
+  bool Take(TaskId task_id, Task* task) {
+    auto iter = lookup_.find(task_id);
+    if (iter == lookup_.end()) {
+      return false;
+    }
+    const uint32_t index = iter->second;
+    lookup_.erase(iter);
+    Unlink(index);
+    *task = std::move(nodes_[index].task);
+    Release(index);
+    return true;
+  }
+
+  // Advances the wheel to |timer|, appending all the tasks whose trigger time
+  // has been reached to |due| in the order they should be processed. The tasks
+  // remain pending until they are taken or cancelled.
+  void Advance(Clock::duration timer, std::vector<DueTask>* due) {
+    const size_t first = due->size();
+    const uint64_t end_tick = std::max(GetTick(timer), current_tick_);
+    for (uint64_t tick = current_tick_;; ++tick) {
+      if (num_scheduled_ == 0) {
+        current_tick_ = end_tick;
+        break;
+      }
+      if (tick != current_tick_) {
+        current_tick_ = tick;
+        Cascade(tick);
+      }
+
+      uint32_t index = heads_[tick & kSlotMask];
+      while (index != kNullNode) {
+        const uint32_t next = nodes_[index].next;
+        if (tick < end_tick || nodes_[index].trigger_time <= timer) {
+          Unlink(index);
+          due->push_back({nodes_[index].trigger_time, nodes_[index].task_id});
+        }
+        index = next;
+      }
+
+      if (tick == end_tick) {
+        break;
+      }
+    }
+    std::sort(due->begin() + first, due->end());
+  }
+
+ private:
+  struct Node {
+    Task task;
+    Clock::duration trigger_time = Clock::duration::zero();
+    TaskId task_id = kInvalidTaskId;
+    uint32_t slot = kNullNode;
+    uint32_t prev = kNullNode;
+    uint32_t next = kNullNode;
+  };
+
+  // Inserts the node into the slot for its trigger time.
+  void Link(uint32_t index) {
+    Node& node = nodes_[index];
+    const uint64_t tick = std::max(GetTick(node.trigger_time), current_tick_);
+
+    // Find the lowest level at which the tick shares all its higher slots with
+    // the current tick.
+    int level = 0;
+    while (level < kNumLevels - 1 &&
+           (tick >> (kSlotBits * (level + 1))) !=
+               (current_tick_ >> (kSlotBits * (level + 1)))) {
+      ++level;
+    }
+
+    const uint32_t slot = static_cast<uint32_t>(
+        level * kNumSlots + ((tick >> (kSlotBits * level)) & kSlotMask));
+    node.slot = slot;
+    node.prev = kNullNode;
+    node.next = heads_[slot];
+    if (node.next != kNullNode) {
+      nodes_[node.next].prev = index;
+    }
+    heads_[slot] = index;
+    ++num_scheduled_;
+  }
+
+  // Removes the node from its slot, if it is in one.
+  void Unlink(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.slot == kNullNode) {
+      return;
+    }
+    if (node.prev != kNullNode) {
+      nodes_[node.prev].next = node.next;
+    } else {
+      heads_[node.slot] = node.next;
+    }
+    if (node.next != kNullNode) {
+      nodes_[node.next].prev = node.prev;
+    }
+    node.slot = kNullNode;
+    node.prev = kNullNode;
+    node.next = kNullNode;
+    --num_scheduled_;
+  }
+
+  void Release(uint32_t index) {
+    Node& node = nodes_[index];
+    node.task = nullptr;
+    node.task_id = kInvalidTaskId;
+    node.next = free_;
+    free_ = index;
+  }
+
+  // Moves the tasks in the higher level slots that start at |tick| down into
+  // the lower levels.
+  void Cascade(uint64_t tick) {
+    int level = 0;
+    while (level < kNumLevels - 1 &&
+           (tick & ((uint64_t{1} << (kSlotBits * (level + 1))) - 1)) == 0) {
+      ++level;
+    }
+    for (; level > 0; --level) {
+      const size_t slot =
+          level * kNumSlots + ((tick >> (kSlotBits * level)) & kSlotMask);
+      uint32_t index = heads_[slot];
+      while (index != kNullNode) {
+        const uint32_t next = nodes_[index].next;
+        Unlink(index);
+        Link(index);
+        index = next;
+      }
+    }
+  }
+
+  std::vector<Node> nodes_;
+  std::array<uint32_t, kNumLevels * kNumSlots> heads_;
+  std::unordered_map<TaskId, uint32_t> lookup_;
+  uint32_t free_ = kNullNode;
+  size_t num_scheduled_ = 0;
+  uint64_t current_tick_ = 0;
+};
+
+ScheduledProcessor::ScheduledProcessor() {}
+
+ScheduledProcessor::ScheduledProcessor(Backend backend) {
+  if (backend == kTimingWheel) {
+    wheel_.reset(new TimingWheel());
+  }
+}
+
+ScheduledProcessor::~ScheduledProcessor() {}
+
 ScheduledProcessor::QueueItem::QueueItem(Task task, TaskId task_id,
                                          Clock::duration trigger_time)
     : trigger_time(trigger_time), task(std::move(task)), task_id(task_id) {}
 
-bool ScheduledProcessor::Empty() const { return queue_.empty(); }
+bool ScheduledProcessor::Empty() const { return Size() == 0; }
 
-size_t ScheduledProcessor::Size() const { return queue_.size(); }
+size_t ScheduledProcessor::Size() const {
+  return wheel_ ? wheel_->Size() : queue_.size();
+}
 
 void ScheduledProcessor::Tick(Clock::duration delta_time) {
   const TaskId first_invalid_task_id = next_task_id_;
   timer_ += delta_time;
 
+  if (wheel_) {
+    // Tasks added while processing are not collected until the next Tick.
+    // The buffer is swapped out in case a task re-entrantly ticks the
+    // processor.
+    std::vector<TimingWheel::DueTask> due;
+    due.swap(wheel_->due_buffer);
+    wheel_->Advance(timer_, &due);
+    for (const TimingWheel::DueTask& entry : due) {
+      Task task;
+      if (wheel_->Take(entry.task_id, &task)) {
+        task();
+      }
+    }
+    due.clear();
+    wheel_->due_buffer.swap(due);
+    return;
+  }
+
   while (!queue_.empty()) {
     if (timer_ < queue_.front().trigger_time) {
       break;
@@ -60,6 +313,10 @@ ScheduledProcessor::TaskId ScheduledProcessor::Add(
   if (++next_task_id_ == kInvalidTaskId) {
     ++next_task_id_;
   }
+  if (wheel_) {
+    wheel_->Add(std::move(task), task_id, timer_ + delay_ms);
+    return task_id;
+  }
   QueueItem item(std::move(task), task_id, timer_ + delay_ms);
   auto pos = std::lower_bound(queue_.begin(), queue_.end(), item);
   queue_.insert(pos, std::move(item));
@@ -71,6 +328,13 @@ ScheduledProcessor::TaskId ScheduledProcessor::Add(Task task) {
 }
 
 void ScheduledProcessor::Cancel(TaskId id) {
+  if (wheel_) {
+    if (!wheel_->Cancel(id)) {
+      DCHECK(false) << "Tried to cancel unknown task " << id;
+    }
+    return;
+  }
+
   for (auto iter = queue_.begin(); iter != queue_.end(); ++iter) {
     if (iter->task_id == id) {
       queue_.erase(iter);
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <deque>
 #include <functional>
+#include <memory>
 
 #include "lullaby/util/typeid.h"
 #include "lullaby/util/clock.h"
@@ -37,6 +38,11 @@ namespace lull {
 // delay had passed and should be processed. The order in which tasks are
 // processed is determined first by their delay and then by the order in which
 // they were added.
+//
+// By default, tasks are stored in a sorted queue, which makes adding and
+// cancelling tasks O(n). Processors that hold many pending tasks (eg. UI
+// timeouts) can instead use a hierarchical timing wheel, in which adding and
+// cancelling a task is O(1) and task storage is recycled between tasks.
 class ScheduledProcessor {
  public:
   using Task = std::function<void()>;
@@ -44,7 +50,15 @@ class ScheduledProcessor {
 
   static const TaskId kInvalidTaskId = 0;
 
-  ScheduledProcessor() {}
+  // The data structures that can be used to store pending tasks.
+  enum Backend {
+    kSortedQueue,
+    kTimingWheel,
+  };
+
+  ScheduledProcessor();
+  explicit ScheduledProcessor(Backend backend);
+  ~ScheduledProcessor();
 
   // Tick the queue and process all tasks whose delay had passed.
   void Tick(Clock::duration delta_time);
@@ -104,9 +118,15 @@ class ScheduledProcessor {
 
   using TaskQueue = std::deque<QueueItem>;
 
+  // Storage for the kTimingWheel backend; defined in the .cc file.
+  class TimingWheel;
+
   // A queue to hold all the tasks sorted manually by time.
   TaskQueue queue_;
 
+  // The timing wheel holding all the tasks, if using the kTimingWheel backend.
+  std::unique_ptr<TimingWheel> wheel_;
+
   ScheduledProcessor(const ScheduledProcessor&) = delete;
   ScheduledProcessor& operator=(const ScheduledProcessor&) = delete;
 };
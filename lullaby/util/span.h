@@ -68,6 +68,53 @@ class Span {
   size_t size_ = 0;
 };
 
+// A MutableSpan points to an array of non-const data that it does not own
+// itself, so that a function can modify the elements of the array, but not its
+// size.
+template <typename T>
+class MutableSpan {
+ public:
+  // Constructors.
+  MutableSpan() : data_(nullptr), size_(0) {}
+
+  MutableSpan(T* data, size_t size) : data_(data), size_(size) {}
+
+  template <typename Alloc>
+  MutableSpan(std::vector<T, Alloc>& vec)
+      : data_(vec.data()), size_(vec.size()) {}
+
+  template <size_t N>
+  MutableSpan(T (&data)[N])
+      : data_(data), size_(N) {}
+
+  template <size_t N>
+  MutableSpan(std::array<T, N>& arr)
+      : data_(arr.data()), size_(arr.size()) {}
+
+  // Returns the elements as a read-only Span.
+  operator Span<T>() const { return Span<T>(data_, size_); }
+
+  // Returns the number of elements in the span.
+  size_t size() const { return size_; }
+
+  // Returns whether the span is empty.
+  bool empty() const { return size_ == 0; }
+
+  // Returns an element from the span. Does not do bounds checking.
+  T& operator[](size_t i) const { return data_[i]; }
+
+  // Get the raw data of the span.
+  T* data() const { return data_; }
+
+  // Iteration methods.
+  T* begin() const { return data_; }
+  T* end() const { return data_ + size_; }
+
+ private:
+  T* data_ = nullptr;
+  size_t size_ = 0;
+};
+
 template <typename T>
 Span<uint8_t> ToByteSpan(const T* data, size_t count = 1) {
   return {reinterpret_cast<const uint8_t*>(data), sizeof(T) * count};
@@ -46,4 +46,41 @@ StringPreprocessor::ProcessStringRequest StringPreprocessor::CheckPrefix(
   }
   return result;
 }
+
+const std::string& StringPreprocessor::ProcessStringCached(
+    const std::string& input) {
+  if (!caching_enabled_) {
+    uncached_output_ = ProcessString(input);
+    return uncached_output_;
+  }
+
+  const HashValue key = Hash(input);
+  auto iter = cache_.find(key);
+  if (iter != cache_.end()) {
+    if (iter->second.input == input) {
+      return iter->second.output;
+    }
+    // A hash collision, so don't cache this input.
+    uncached_output_ = ProcessString(input);
+    return uncached_output_;
+  }
+
+  if (cache_.size() >= kMaxCacheSize) {
+    cache_.clear();
+  }
+  CacheEntry& entry = cache_[key];
+  entry.input = input;
+  entry.output = ProcessString(input);
+  return entry.output;
+}
+
+void StringPreprocessor::SetCachingEnabled(bool enabled) {
+  caching_enabled_ = enabled;
+  if (!enabled) {
+    ClearCache();
+  }
+}
+
+void StringPreprocessor::ClearCache() { cache_.clear(); }
+
 }  // namespace lull
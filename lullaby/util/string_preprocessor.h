@@ -18,7 +18,9 @@ limitations under the License.
 #define LULLABY_UTIL_STRING_PREPROCESSOR_H_
 
 #include <string>
+#include <unordered_map>
 
+#include "lullaby/util/hash.h"
 #include "lullaby/util/typeid.h"
 
 namespace lull {
@@ -93,6 +95,39 @@ class StringPreprocessor {
   //     locale).
   //   kLiteralStringPrefix - The remainder of the string is returned unchanged.
   static ProcessStringRequest CheckPrefix(const std::string& input);
+
+  // Returns the result of ProcessString(input).  If caching is enabled, each
+  // distinct |input| is only processed once and later calls return the stored
+  // result, so text that is re-rendered frequently is not re-localized every
+  // time.  The returned reference is valid until the next call to this
+  // function or to ClearCache().  Not thread-safe.
+  const std::string& ProcessStringCached(const std::string& input);
+
+  // Enables or disables caching the results of ProcessStringCached().  Only
+  // enable caching if ProcessString() always returns the same output for the
+  // same input, and call ClearCache() whenever that stops being true (eg. when
+  // the locale changes).  Disabled by default.
+  void SetCachingEnabled(bool enabled);
+
+  // Removes all the cached results.
+  void ClearCache();
+
+  // Returns the number of cached results.
+  size_t GetCacheSize() const { return cache_.size(); }
+
+ private:
+  // The maximum number of cached results.  The cache is cleared when it is
+  // full so that unbounded user-generated text cannot grow it indefinitely.
+  static constexpr size_t kMaxCacheSize = 1024;
+
+  struct CacheEntry {
+    std::string input;
+    std::string output;
+  };
+
+  std::unordered_map<HashValue, CacheEntry> cache_;
+  std::string uncached_output_;
+  bool caching_enabled_ = false;
 };
 
 }  // namespace lull
@@ -17,6 +17,7 @@ limitations under the License.
 #ifndef LULLABY_UTIL_THREAD_SAFE_DEQUE_H_
 #define LULLABY_UTIL_THREAD_SAFE_DEQUE_H_
 
+#include <algorithm>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
@@ -53,6 +54,28 @@ class ThreadSafeDeque {
     condvar_.notify_one();
   }
 
+  // Inserts an object before the first element that |less| orders after it, so
+  // that a deque sorted by |less| remains sorted.  Objects that compare equal
+  // stay in the order in which they were inserted.
+  template <typename Compare>
+  void InsertSorted(T obj, Compare less) {
+    Lock lock(mutex_);
+    auto iter = std::upper_bound(deque_.begin(), deque_.end(), obj, less);
+    deque_.insert(iter, std::move(obj));
+    condvar_.notify_one();
+  }
+
+  // Calls update(entry) on all entries and then re-sorts the deque by |less|,
+  // keeping the existing order of entries that compare equal.
+  template <typename Fn, typename Compare>
+  void UpdateSorted(Fn update, Compare less) {
+    Lock lock(mutex_);
+    for (T& entry : deque_) {
+      update(entry);
+    }
+    std::stable_sort(deque_.begin(), deque_.end(), less);
+  }
+
   // Pops the front element from the deque by moving it into the object as
   // specified by |out| and returns true.  If the deque is empty, the function
   // does not modify the |out| parameter and returns false.
@@ -68,6 +91,21 @@ class ThreadSafeDeque {
     return true;
   }
 
+  // Pops the back element from the deque by moving it into the object as
+  // specified by |out| and returns true.  If the deque is empty, the function
+  // does not modify the |out| parameter and returns false.
+  bool PopBack(T* out) {
+    Lock lock(mutex_);
+    if (deque_.empty()) {
+      return false;
+    }
+    if (out != nullptr) {
+      *out = std::move(deque_.back());
+    }
+    deque_.pop_back();
+    return true;
+  }
+
   // Pops the front element from the deque.  This function will block the
   // calling thread until an element is available to be popped.
   T WaitPopFront() {
@@ -0,0 +1,279 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/trace.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lull {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The maximum length of a name generated by LULLABY_CPU_TRACE_FORMAT.
+constexpr size_t kMaxFormattedNameLength = 64;
+
+struct TraceEvent {
+  enum Type : uint8_t {
+    kBegin,
+    kEnd,
+    kCounter,
+  };
+
+  int64_t timestamp_ns = 0;
+  // Either a pointer to a string literal, or nullptr if the name is stored in
+  // |formatted_name|.
+  const char* name = nullptr;
+  int64_t value = 0;
+  Type type = kBegin;
+  char formatted_name[kMaxFormattedNameLength];
+};
+
+// The events recorded by a single thread.  Only the owning thread writes to the
+// buffer, and it publishes each event by incrementing |size| so that the buffer
+// can be read without locking once tracing has stopped.
+struct ThreadBuffer {
+  uint32_t thread_id = 0;
+  // The tracing session that |events| belongs to.
+  uint32_t generation = 0;
+  std::unique_ptr<TraceEvent[]> events;
+  size_t capacity = 0;
+  std::atomic<size_t> size{0};
+  // The number of scopes that have begun but not ended.  Room is reserved at
+  // the end of the buffer to end all of them.
+  size_t open_scopes = 0;
+  size_t num_dropped = 0;
+};
+
+std::atomic<bool> g_tracing{false};
+std::atomic<uint32_t> g_generation{0};
+std::atomic<size_t> g_max_events_per_thread{kDefaultMaxTraceEventsPerThread};
+Clock::time_point g_start_time;
+
+std::mutex g_buffers_mutex;
+thread_local ThreadBuffer* g_thread_buffer = nullptr;
+
+std::vector<std::unique_ptr<ThreadBuffer>>& GetThreadBuffers() {
+  // Buffers are never destroyed so that the events of threads that have exited
+  // can still be exported.
+  static auto* buffers = new std::vector<std::unique_ptr<ThreadBuffer>>();
+  return *buffers;
+}
+
+// Returns the buffer for the calling thread, resetting it if it belongs to a
+// previous tracing session.
+ThreadBuffer* GetThreadBuffer() {
+  ThreadBuffer* buffer = g_thread_buffer;
+  if (buffer == nullptr) {
+    std::lock_guard<std::mutex> lock(g_buffers_mutex);
+    auto& buffers = GetThreadBuffers();
+    buffers.emplace_back(new ThreadBuffer());
+    buffer = buffers.back().get();
+    buffer->thread_id = static_cast<uint32_t>(buffers.size());
+    g_thread_buffer = buffer;
+  }
+
+  const uint32_t generation = g_generation.load(std::memory_order_acquire);
+  if (buffer->generation != generation) {
+    const size_t capacity =
+        g_max_events_per_thread.load(std::memory_order_relaxed);
+    if (buffer->capacity != capacity) {
+      buffer->capacity = capacity;
+      buffer->events.reset(new TraceEvent[buffer->capacity]);
+    }
+    buffer->size.store(0, std::memory_order_relaxed);
+    buffer->open_scopes = 0;
+    buffer->num_dropped = 0;
+    buffer->generation = generation;
+  }
+  return buffer;
+}
+
+int64_t GetTimestamp() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                              g_start_time)
+      .count();
+}
+
+// Returns the next event to write in |buffer|, or nullptr if the buffer does
+// not have room for it and the events needed to close any open scopes.
+TraceEvent* AllocateEvent(ThreadBuffer* buffer, TraceEvent::Type type) {
+  const size_t size = buffer->size.load(std::memory_order_relaxed);
+  const size_t reserved = type == TraceEvent::kEnd ? 0 : buffer->open_scopes;
+  const size_t needed = type == TraceEvent::kBegin ? 2 : 1;
+  if (size + reserved + needed > buffer->capacity) {
+    ++buffer->num_dropped;
+    return nullptr;
+  }
+  TraceEvent* event = &buffer->events[size];
+  event->type = type;
+  event->name = nullptr;
+  event->value = 0;
+  return event;
+}
+
+void PublishEvent(ThreadBuffer* buffer, TraceEvent* event) {
+  event->timestamp_ns = GetTimestamp();
+  buffer->size.fetch_add(1, std::memory_order_release);
+}
+
+void AppendEscaped(const char* str, std::string* out) {
+  for (; *str; ++str) {
+    const char c = *str;
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out->append(escaped);
+    } else {
+      out->push_back(c);
+    }
+  }
+}
+
+}  // namespace
+
+void StartTracing(size_t max_events_per_thread) {
+  g_tracing.store(false, std::memory_order_release);
+  g_max_events_per_thread.store(max_events_per_thread,
+                                std::memory_order_relaxed);
+  g_start_time = Clock::now();
+  g_generation.fetch_add(1, std::memory_order_release);
+  g_tracing.store(true, std::memory_order_release);
+}
+
+void StopTracing() { g_tracing.store(false, std::memory_order_release); }
+
+bool IsTracing() { return g_tracing.load(std::memory_order_acquire); }
+
+std::string GetChromeTraceJson() {
+  std::string json = "{\"traceEvents\":[";
+  bool first = true;
+  char buffer[128];
+
+  std::lock_guard<std::mutex> lock(g_buffers_mutex);
+  const uint32_t generation = g_generation.load(std::memory_order_acquire);
+  for (const auto& thread : GetThreadBuffers()) {
+    if (thread->generation != generation) {
+      continue;
+    }
+    const size_t size = thread->size.load(std::memory_order_acquire);
+    for (size_t i = 0; i < size; ++i) {
+      const TraceEvent& event = thread->events[i];
+      if (!first) {
+        json.push_back(',');
+      }
+      first = false;
+
+      json.append("{\"name\":\"");
+      if (event.type != TraceEvent::kEnd) {
+        AppendEscaped(event.name ? event.name : event.formatted_name, &json);
+      }
+      const char phase = event.type == TraceEvent::kBegin
+                             ? 'B'
+                             : event.type == TraceEvent::kEnd ? 'E' : 'C';
+      snprintf(buffer, sizeof(buffer),
+               "\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u", phase,
+               static_cast<double>(event.timestamp_ns) / 1000.0,
+               thread->thread_id);
+      json.append(buffer);
+      if (event.type == TraceEvent::kCounter) {
+        snprintf(buffer, sizeof(buffer), ",\"args\":{\"value\":%lld}",
+                 static_cast<long long>(event.value));
+        json.append(buffer);
+      }
+      json.push_back('}');
+    }
+  }
+  json.append("]}");
+  return json;
+}
+
+namespace detail {
+
+bool TraceBegin(const char* name) {
+  if (!g_tracing.load(std::memory_order_acquire)) {
+    return false;
+  }
+  ThreadBuffer* buffer = GetThreadBuffer();
+  TraceEvent* event = AllocateEvent(buffer, TraceEvent::kBegin);
+  if (event == nullptr) {
+    return false;
+  }
+  event->name = name;
+  ++buffer->open_scopes;
+  PublishEvent(buffer, event);
+  return true;
+}
+
+bool TraceBeginFormat(const char* format, ...) {
+  if (!g_tracing.load(std::memory_order_acquire)) {
+    return false;
+  }
+  ThreadBuffer* buffer = GetThreadBuffer();
+  TraceEvent* event = AllocateEvent(buffer, TraceEvent::kBegin);
+  if (event == nullptr) {
+    return false;
+  }
+  va_list args;
+  va_start(args, format);
+  vsnprintf(event->formatted_name, kMaxFormattedNameLength, format, args);
+  va_end(args);
+  ++buffer->open_scopes;
+  PublishEvent(buffer, event);
+  return true;
+}
+
+void TraceEnd() {
+  // Scopes are ended even if tracing has since stopped so that the recorded
+  // events stay balanced, unless a new tracing session has started.
+  ThreadBuffer* buffer = g_thread_buffer;
+  if (buffer == nullptr || buffer->open_scopes == 0 ||
+      buffer->generation != g_generation.load(std::memory_order_acquire)) {
+    return;
+  }
+  TraceEvent* event = AllocateEvent(buffer, TraceEvent::kEnd);
+  if (event == nullptr) {
+    return;
+  }
+  --buffer->open_scopes;
+  PublishEvent(buffer, event);
+}
+
+void TraceCounter(const char* name, int64_t value) {
+  if (!g_tracing.load(std::memory_order_acquire)) {
+    return;
+  }
+  ThreadBuffer* buffer = GetThreadBuffer();
+  TraceEvent* event = AllocateEvent(buffer, TraceEvent::kCounter);
+  if (event == nullptr) {
+    return;
+  }
+  event->name = name;
+  event->value = value;
+  PublishEvent(buffer, event);
+}
+
+}  // namespace detail
+}  // namespace lull
@@ -17,9 +17,115 @@ limitations under the License.
 #ifndef LULLABY_UTIL_TRACE_H_
 #define LULLABY_UTIL_TRACE_H_
 
+/// @file
+/// Macros for annotating code with CPU trace events.
+///
+/// LULLABY_CPU_TRACE_CALL() traces the enclosing function until the end of the
+/// scope, LULLABY_CPU_TRACE(name) traces the rest of the scope with the given
+/// name, LULLABY_CPU_TRACE_FORMAT(format, ...) does the same with a
+/// printf-style formatted name, and LULLABY_CPU_TRACE_INT(name, value) records
+/// the value of a counter.
+///
+/// By default, the macros compile to nothing.  Building with
+/// LULLABY_ENABLE_TRACING=1 routes them to the built-in recorder below, which
+/// stores events in per-thread buffers while tracing is active so that they can
+/// be exported in the Chrome trace event format (which Perfetto can also
+/// load).  Alternatively, platforms can plug in their own tracing backend by
+/// defining all of the macros before this header is included.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace lull {
+
+/// The default number of events that can be recorded per thread.
+static const size_t kDefaultMaxTraceEventsPerThread = 16 * 1024;
+
+/// Discards any previously recorded events and starts recording new events.
+/// Each thread will record at most |max_events_per_thread| events, after which
+/// any further events on that thread are dropped.
+void StartTracing(
+    size_t max_events_per_thread = kDefaultMaxTraceEventsPerThread);
+
+/// Stops recording events.  The recorded events remain available until the next
+/// call to StartTracing().
+void StopTracing();
+
+/// Returns true if events are being recorded.
+bool IsTracing();
+
+/// Returns the recorded events in the Chrome trace event JSON format.  This
+/// must only be called while tracing is stopped.
+std::string GetChromeTraceJson();
+
+namespace detail {
+
+/// Records the start of a trace scope, returning false if tracing is inactive.
+/// These should not be used directly and are only public so the macros can
+/// access them.
+bool TraceBegin(const char* name);
+bool TraceBeginFormat(const char* format, ...)
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((format(printf, 1, 2)))
+#endif
+    ;
+
+/// Records the end of the most recent trace scope on this thread.
+void TraceEnd();
+
+/// Records the |value| of the counter |name|.
+void TraceCounter(const char* name, int64_t value);
+
+/// Records a trace scope for the lifetime of the object.
+class ScopedTrace {
+ public:
+  explicit ScopedTrace(bool began) : began_(began) {}
+  ~ScopedTrace() {
+    if (began_) {
+      TraceEnd();
+    }
+  }
+
+  ScopedTrace(const ScopedTrace&) = delete;
+  ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+ private:
+  bool began_;
+};
+
+}  // namespace detail
+}  // namespace lull
+
+#if !defined(LULLABY_CPU_TRACE_CALL)
+
+#if LULLABY_ENABLE_TRACING
+
+#define LULLABY_TRACE_CONCAT_IMPL(a, b) a##b
+#define LULLABY_TRACE_CONCAT(a, b) LULLABY_TRACE_CONCAT_IMPL(a, b)
+#define LULLABY_TRACE_SCOPE_NAME LULLABY_TRACE_CONCAT(lullaby_trace_, __LINE__)
+
+#define LULLABY_CPU_TRACE_CALL() \
+  ::lull::detail::ScopedTrace LULLABY_TRACE_SCOPE_NAME( \
+      ::lull::detail::TraceBegin(__func__))
+#define LULLABY_CPU_TRACE(name)                         \
+  ::lull::detail::ScopedTrace LULLABY_TRACE_SCOPE_NAME( \
+      ::lull::detail::TraceBegin(name))
+#define LULLABY_CPU_TRACE_INT(name, value) \
+  ::lull::detail::TraceCounter(name, static_cast<int64_t>(value))
+#define LULLABY_CPU_TRACE_FORMAT(format, ...)           \
+  ::lull::detail::ScopedTrace LULLABY_TRACE_SCOPE_NAME( \
+      ::lull::detail::TraceBeginFormat(format, __VA_ARGS__))
+
+#else  // LULLABY_ENABLE_TRACING
+
 #define LULLABY_CPU_TRACE_CALL()
 #define LULLABY_CPU_TRACE(name)
 #define LULLABY_CPU_TRACE_INT(name, value)
 #define LULLABY_CPU_TRACE_FORMAT(format, ...)
 
+#endif  // LULLABY_ENABLE_TRACING
+
+#endif  // !defined(LULLABY_CPU_TRACE_CALL)
+
 #endif  // LULLABY_UTIL_TRACE_H_
@@ -16,6 +16,9 @@ limitations under the License.
 
 #include "lullaby/util/typed_scheduled_processor.h"
 
+#include <tuple>
+#include <utility>
+
 namespace lull {
 
 void TypedScheduledProcessor::Tick(Clock::duration delta_time) {
@@ -34,12 +37,18 @@ void TypedScheduledProcessor::Tick(Clock::duration delta_time) {
 void TypedScheduledProcessor::Add(TypeId type, Task task,
                                   Clock::duration delay_ms) {
   // Lazily get or create a ScheduleProcessor for the type.
-  auto& scheduled_processor = typed_scheduled_processor_map_[type];
-  scheduled_processor.Add(task, delay_ms);
+  auto iter = typed_scheduled_processor_map_.find(type);
+  if (iter == typed_scheduled_processor_map_.end()) {
+    iter = typed_scheduled_processor_map_
+               .emplace(std::piecewise_construct, std::forward_as_tuple(type),
+                        std::forward_as_tuple(backend_))
+               .first;
+  }
+  iter->second.Add(std::move(task), delay_ms);
 }
 
 void TypedScheduledProcessor::Add(TypeId type, Task task) {
-  Add(type, task, std::chrono::milliseconds(0));
+  Add(type, std::move(task), std::chrono::milliseconds(0));
 }
 
 void TypedScheduledProcessor::ClearTasksOfType(TypeId type) {
@@ -43,8 +43,13 @@ namespace lull {
 class TypedScheduledProcessor {
  public:
   using Task = ScheduledProcessor::Task;
+  using Backend = ScheduledProcessor::Backend;
+
   TypedScheduledProcessor() {}
 
+  // Creates the ScheduledProcessor for each TypeId using the given backend.
+  explicit TypedScheduledProcessor(Backend backend) : backend_(backend) {}
+
   // Ticks all the queues for every TypeId and and process all tasks whose delay
   // has passed.
   void Tick(Clock::duration delta_time);
@@ -73,6 +78,9 @@ class TypedScheduledProcessor {
   // A map of scheduled processors associated with different type IDs.
   std::unordered_map<TypeId, ScheduledProcessor> typed_scheduled_processor_map_;
 
+  // The backend used by each ScheduledProcessor.
+  Backend backend_ = ScheduledProcessor::kSortedQueue;
+
   TypedScheduledProcessor(const TypedScheduledProcessor&) = delete;
   TypedScheduledProcessor& operator=(const TypedScheduledProcessor&) = delete;
 };
@@ -18,9 +18,11 @@ limitations under the License.
 #define LULLABY_UTIL_UNORDERED_VECTOR_MAP_H_
 
 #include <assert.h>
+#include <stdint.h>
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <type_traits>
-#include <unordered_map>
 #include <vector>
 
 namespace lull {
@@ -28,17 +30,19 @@ namespace lull {
 // A map-like container of Key to Object.
 //
 // Objects are stored in a vector of arrays to ensure good locality of reference
-// when iterating over them.  Efficient iteration can be done by calling ForEach
-// or by using the provided iterators. An unordered_map is used to provide O(1)
-// access to individual objects.
+// when iterating over them.  Each array starts on a cache line boundary.
+// Efficient iteration can be done by calling ForEach or by using the provided
+// iterators.  A flat open-addressing hash table is used to provide O(1) access
+// to individual objects.  Keys should be small, cheap to copy, and default
+// constructible (eg. Entity), as the table stores them inline.
 //
 // New objects are always inserted at the "end" of the vector of arrays.
-// Objects are removed by first swapping the "target" object with the "end"
-// object, then popping the last object of the end.  The swap is performed
-// using std::swap.
+// Objects are removed by first move-assigning the "end" object into the
+// "target" object, then popping the last object of the end.
 //
 // This container does not provide any order guarantees.  Objects stored in
-// the containers will be shuffled around during removal operations.  Any
+// the containers will be shuffled around during removal operations, though
+// SortByKey can be used to restore a specific iteration order.  Any
 // pointers to objects in the container should be used with care.  This
 // container is also not thread safe.  Finally, the ForEach function is not
 // re-entrant - do not insert/remove objects from the container during
@@ -53,10 +57,20 @@ class UnorderedVectorMap {
   using iterator = Iterator<false>;
   using const_iterator = Iterator<true>;
 
+  // The alignment, in bytes, of the start of each page of Objects.
+  static constexpr size_t kCacheLineSize = 64;
+
   // The |page_size| specifies the number of elements to store in contiguous
   // memory before allocating a new "page" for more elements.
   explicit UnorderedVectorMap(size_t page_size) : page_size_(page_size) {}
 
+  // Returns the number of Objects that fit in a page of |num_bytes| bytes,
+  // eg. a 4KB memory page.  Returns at least 1.
+  static size_t GetPageSizeForBytes(size_t num_bytes) {
+    const size_t count = num_bytes / sizeof(Object);
+    return count > 0 ? count : 1;
+  }
+
   UnorderedVectorMap(const UnorderedVectorMap& rhs) = delete;
   UnorderedVectorMap& operator=(const UnorderedVectorMap& rhs) = delete;
 
@@ -103,9 +117,10 @@ class UnorderedVectorMap {
     // only check the key after we have created the object.
     KeyFn key_fn;
     const auto& key = key_fn(*obj);
-    const Index index(objects_.size() - 1, back_page.Size() - 1);
+    const Index index = {static_cast<uint32_t>(objects_.size() - 1),
+                         static_cast<uint32_t>(back_page.Size() - 1)};
 
-    if (lookup_table_.emplace(key, index).second) {
+    if (lookup_table_.Insert(key, index)) {
       return obj;
     } else {
       Destroy(index);
@@ -113,47 +128,39 @@ class UnorderedVectorMap {
     }
   }
 
-  // Destroys the Object associated with |key|.  The Object being destroyed will
-  // be swapped with the object at the end of the internal storage structure,
-  // and then will be "popped" off the back.
+  // Destroys the Object associated with |key|.  The object at the end of the
+  // internal storage structure will be moved into the destroyed Object's
+  // place, and then will be "popped" off the back.
   void Destroy(const Key& key) {
-    auto iter = lookup_table_.find(key);
-    if (iter == lookup_table_.end()) {
-      return;
+    Index index;
+    if (lookup_table_.Erase(key, &index)) {
+      Destroy(index);
     }
-    Destroy(iter->second);
-    lookup_table_.erase(iter);
   }
 
   // Returns true if an Object is associated with the |key|.
   bool Contains(const Key& key) const {
-    return lookup_table_.count(key) > 0;
+    return lookup_table_.Find(key) != nullptr;
   }
 
   // Returns a pointer to the Object associated with |key|, or nullptr if no
   // such Object exists.
   Object* Get(const Key& key) {
-    auto iter = lookup_table_.find(key);
-    if (iter == lookup_table_.end()) {
+    const Index* index = lookup_table_.Find(key);
+    if (index == nullptr) {
       return nullptr;
     }
-
-    const Index& index = iter->second;
-    Object* obj = objects_[index.first].Get(index.second);
-    return obj;
+    return objects_[index->page].Get(index->offset);
   }
 
   // Returns a pointer to the Object associated with |key|, or nullptr if no
   // such Object exists.
   const Object* Get(const Key& key) const {
-    auto iter = lookup_table_.find(key);
-    if (iter == lookup_table_.end()) {
+    const Index* index = lookup_table_.Find(key);
+    if (index == nullptr) {
       return nullptr;
     }
-
-    const Index& index = iter->second;
-    const Object* obj = objects_[index.first].Get(index.second);
-    return obj;
+    return objects_[index->page].Get(index->offset);
   }
 
   // Iterates over all Objects, passing them to the given function |Fn|.
@@ -172,6 +179,54 @@ class UnorderedVectorMap {
     }
   }
 
+  // Preallocates the lookup table and page list so that up to |count| Objects
+  // can be stored in the container without rehashing.  The pages themselves are
+  // still allocated as they are filled.
+  void Reserve(size_t count) {
+    lookup_table_.Reserve(count);
+    objects_.reserve((count + page_size_ - 1) / page_size_);
+  }
+
+  // Reorders the Objects so that iteration visits them in ascending order of
+  // their keys as determined by |comp|, a strict weak ordering over Keys.
+  // This can be used to restore a meaningful iteration order (eg. hierarchy
+  // order) after many insertions and removals.  Objects are moved into freshly
+  // allocated pages, so all pointers to Objects are invalidated.
+  template <typename Compare>
+  void SortByKey(Compare comp) {
+    KeyFn key_fn;
+    std::vector<Object*> order;
+    order.reserve(Size());
+    for (auto& object : *this) {
+      order.push_back(&object);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](const Object* lhs, const Object* rhs) {
+                       return comp(key_fn(*lhs), key_fn(*rhs));
+                     });
+
+    ArrayVector sorted;
+    sorted.reserve(objects_.size());
+    for (Object* obj : order) {
+      if (sorted.empty() || sorted.back().Size() == page_size_) {
+        sorted.emplace_back(page_size_);
+      }
+      sorted.back().Push(std::move(*obj));
+    }
+    objects_ = std::move(sorted);
+    RebuildLookupTable();
+  }
+
+  // Reorders the Objects so that iteration visits them in ascending key order.
+  void SortByKey() { SortByKey(std::less<Key>()); }
+
+  // Releases any memory not needed to store the current Objects, ie. unused
+  // page slots in the page list and excess lookup table capacity.
+  void Compact() {
+    objects_.shrink_to_fit();
+    RebuildLookupTable();
+  }
+
   // Returns the number of Objects stored in the container.
   size_t Size() const {
     const size_t objects_size = objects_.size();
@@ -183,10 +238,17 @@ class UnorderedVectorMap {
     return ((objects_size - 1) * page_size_) + back_size;
   }
 
+  // Returns the approximate number of bytes allocated by the container, ie.
+  // its pages of Objects and its lookup table.
+  size_t GetMemoryUsage() const {
+    return (objects_.size() * page_size_ * sizeof(Object)) +
+           lookup_table_.GetMemoryUsage();
+  }
+
   // Clears the container, destroying the contained objects.
   void Clear() {
     objects_.clear();
-    lookup_table_.clear();
+    lookup_table_.Clear();
   }
 
   iterator begin() { return iterator(objects_.begin(), objects_.end()); }
@@ -218,18 +280,23 @@ class UnorderedVectorMap {
     using iterator = Object*;
     using const_iterator = Object const*;
 
-    // Allocates an array that can hold the specified number of Objects.
-    explicit ObjectArray(size_t max) : memory_(nullptr), count_(0), max_(max) {
+    // Allocates an array that can hold the specified number of Objects.  The
+    // array starts on a cache line boundary so that iteration over a page
+    // touches as few cache lines as possible.
+    explicit ObjectArray(size_t max)
+        : allocation_(nullptr), memory_(nullptr), count_(0), max_(max) {
 #ifdef _MSC_VER
-      const size_t kAlignment = __alignof(Object);
+      const size_t kObjectAlignment = __alignof(Object);
 #else
-      const size_t kAlignment = alignof(Object);
+      const size_t kObjectAlignment = alignof(Object);
 #endif
-      ObjectBuffer* ptr = new ObjectBuffer[max];
-      assert(reinterpret_cast<intptr_t>(ptr) % kAlignment == 0);
-      // "Use" kAlignment variable since it seems unused in non-dbg.
-      (void)kAlignment;
-      memory_.reset(ptr);
+      const size_t kAlignment = kObjectAlignment > kCacheLineSize
+                                    ? kObjectAlignment
+                                    : kCacheLineSize;
+      allocation_.reset(new uint8_t[max * sizeof(ObjectBuffer) + kAlignment]);
+      const uintptr_t addr = reinterpret_cast<uintptr_t>(allocation_.get());
+      const uintptr_t aligned = (addr + kAlignment - 1) & ~(kAlignment - 1);
+      memory_ = reinterpret_cast<ObjectBuffer*>(aligned);
     }
 
     ObjectArray(const ObjectArray&) = delete;
@@ -237,7 +304,11 @@ class UnorderedVectorMap {
 
     // Moves allocated memory from |rhs| to |this|.
     ObjectArray(ObjectArray&& rhs)
-        : memory_(std::move(rhs.memory_)), count_(rhs.count_), max_(rhs.max_) {
+        : allocation_(std::move(rhs.allocation_)),
+          memory_(rhs.memory_),
+          count_(rhs.count_),
+          max_(rhs.max_) {
+      rhs.memory_ = nullptr;
       rhs.count_ = 0;
       rhs.max_ = 0;
     }
@@ -289,8 +360,11 @@ class UnorderedVectorMap {
     const_iterator end() const { return Get(count_); }
 
    private:
-    // Memory for storing Object instances.
-    std::unique_ptr<ObjectBuffer[]> memory_;
+    // The underlying allocation, padded so that |memory_| can be aligned.
+    std::unique_ptr<uint8_t[]> allocation_;
+
+    // Cache line aligned memory for storing Object instances.
+    ObjectBuffer* memory_;
 
     // Number of Objects that have been constructed/emplaced.
     size_t count_;
@@ -303,10 +377,176 @@ class UnorderedVectorMap {
   using ArrayVector = std::vector<ObjectArray>;
 
   // A pair of indices to the two arrays in the ArrayVector.
-  using Index = std::pair<size_t, size_t>;
+  struct Index {
+    uint32_t page;
+    uint32_t offset;
+  };
 
   // Table that maps a Key to a specific element in the ArrayVector.
-  using LookupTable = std::unordered_map<Key, Index, LookupHash>;
+  //
+  // This is an open-addressing hash table using linear probing, with keys and
+  // indices stored inline in a single power-of-two sized array.  Removal uses
+  // backward-shift deletion so that no tombstones are left behind and probe
+  // sequences stay short regardless of churn.
+  class LookupTable {
+   public:
+    LookupTable() : size_(0), mask_(0) {}
+
+    // Returns the Index associated with |key|, or nullptr if there is none.
+    const Index* Find(const Key& key) const {
+      if (size_ == 0) {
+        return nullptr;
+      }
+      std::equal_to<Key> equal;
+      for (size_t pos = GetHome(key);; pos = (pos + 1) & mask_) {
+        const Slot& slot = slots_[pos];
+        if (slot.index.page == kEmpty) {
+          return nullptr;
+        } else if (equal(slot.key, key)) {
+          return &slot.index;
+        }
+      }
+    }
+
+    // Returns the Index associated with |key|, or nullptr if there is none.
+    Index* Find(const Key& key) {
+      const LookupTable* self = this;
+      return const_cast<Index*>(self->Find(key));
+    }
+
+    // Associates |key| with |index|.  Returns false if |key| is already in the
+    // table, in which case the table is unchanged.
+    bool Insert(const Key& key, const Index& index) {
+      if (Find(key) != nullptr) {
+        return false;
+      }
+      if (GetMinCapacity(size_ + 1) > slots_.size()) {
+        Rehash(GetMinCapacity(size_ + 1));
+      }
+      InsertUnique(key, index);
+      return true;
+    }
+
+    // Removes |key| from the table, storing its Index in |out|.  Returns false
+    // if the |key| was not in the table.
+    bool Erase(const Key& key, Index* out) {
+      if (size_ == 0) {
+        return false;
+      }
+      std::equal_to<Key> equal;
+      size_t hole = GetHome(key);
+      while (true) {
+        if (slots_[hole].index.page == kEmpty) {
+          return false;
+        } else if (equal(slots_[hole].key, key)) {
+          break;
+        }
+        hole = (hole + 1) & mask_;
+      }
+      *out = slots_[hole].index;
+
+      // Shift back any following entries whose probe sequence passes through
+      // the hole, so that lookups never need to skip over deleted slots.
+      for (size_t pos = (hole + 1) & mask_; slots_[pos].index.page != kEmpty;
+           pos = (pos + 1) & mask_) {
+        const size_t home = GetHome(slots_[pos].key);
+        if (((pos - home) & mask_) >= ((pos - hole) & mask_)) {
+          slots_[hole] = slots_[pos];
+          hole = pos;
+        }
+      }
+      slots_[hole].index.page = kEmpty;
+      --size_;
+      return true;
+    }
+
+    // Ensures |count| keys can be inserted without rehashing.
+    void Reserve(size_t count) {
+      if (GetMinCapacity(count) > slots_.size()) {
+        Rehash(GetMinCapacity(count));
+      }
+    }
+
+    // Removes all keys and frees the table memory.
+    void Clear() {
+      slots_.clear();
+      slots_.shrink_to_fit();
+      size_ = 0;
+      mask_ = 0;
+    }
+
+    // Removes all keys and resizes the table to fit |count| keys.
+    void Reset(size_t count) {
+      const size_t capacity = count > 0 ? GetMinCapacity(count) : 0;
+      std::vector<Slot>(capacity).swap(slots_);
+      for (Slot& slot : slots_) {
+        slot.index.page = kEmpty;
+      }
+      size_ = 0;
+      mask_ = capacity > 0 ? capacity - 1 : 0;
+    }
+
+    // Inserts a |key| that is known to not be in the table and for which
+    // capacity has already been reserved.
+    void InsertUnique(const Key& key, const Index& index) {
+      size_t pos = GetHome(key);
+      while (slots_[pos].index.page != kEmpty) {
+        pos = (pos + 1) & mask_;
+      }
+      slots_[pos].key = key;
+      slots_[pos].index = index;
+      ++size_;
+    }
+
+    size_t GetMemoryUsage() const { return slots_.capacity() * sizeof(Slot); }
+
+   private:
+    // Marks a Slot as unused.
+    static constexpr uint32_t kEmpty = ~uint32_t(0);
+
+    struct Slot {
+      Key key;
+      Index index;
+    };
+
+    // Returns the smallest power-of-two capacity that keeps the load factor of
+    // |count| keys at or below 3/4.
+    static size_t GetMinCapacity(size_t count) {
+      size_t capacity = 8;
+      while (capacity * 3 < count * 4) {
+        capacity *= 2;
+      }
+      return capacity;
+    }
+
+    // Returns the first slot in the probe sequence for |key|.  The hash is
+    // scrambled with a Fibonacci multiply so that weak hashes (eg. identity
+    // hashes of sequential Entities) still spread across the table.
+    size_t GetHome(const Key& key) const {
+      const uint64_t hash = static_cast<uint64_t>(LookupHash()(key));
+      return static_cast<size_t>((hash * 0x9e3779b97f4a7c15ull) >> 32) & mask_;
+    }
+
+    void Rehash(size_t capacity) {
+      std::vector<Slot> old;
+      old.swap(slots_);
+      slots_.resize(capacity);
+      for (Slot& slot : slots_) {
+        slot.index.page = kEmpty;
+      }
+      size_ = 0;
+      mask_ = capacity - 1;
+      for (const Slot& slot : old) {
+        if (slot.index.page != kEmpty) {
+          InsertUnique(slot.key, slot.index);
+        }
+      }
+    }
+
+    std::vector<Slot> slots_;
+    size_t size_;
+    size_t mask_;
+  };
 
   // An STL style iterator for accessing the elements of an UnorderedVectorMap.
   // This class provides both the const and non-const implementation. If the
@@ -420,21 +660,22 @@ class UnorderedVectorMap {
     InnerIterator inner_;
   };
 
-  // Destroys the Object at the specified |index|.  Performs a swap-and-pop for
+  // Destroys the Object at the specified |index|.  Performs a move-and-pop for
   // Objects not at the end of the ArrayVector.
   void Destroy(const Index& index) {
-    // The object to remove is in the "middle" of the ArrayVector, so swap it
+    // The object to remove is in the "middle" of the ArrayVector, so replace it
     // with the one at the very end.
     auto& back_page = objects_.back();
-    const bool is_in_last_page = (index.first == objects_.size() - 1);
-    const bool is_last_element = (index.second == back_page.Size() - 1);
+    const bool is_in_last_page = (index.page == objects_.size() - 1);
+    const bool is_last_element = (index.offset == back_page.Size() - 1);
     if (!is_in_last_page || !is_last_element) {
-      Object* obj = objects_[index.first].Get(index.second);
+      Object* obj = objects_[index.page].Get(index.offset);
       Object* other = back_page.Get(back_page.Size() - 1);
       KeyFn key_fn;
-      lookup_table_[key_fn(*other)] = index;
-      using std::swap;
-      swap(*obj, *other);
+      Index* other_index = lookup_table_.Find(key_fn(*other));
+      assert(other_index != nullptr);
+      *other_index = index;
+      *obj = std::move(*other);
     }
 
     // The object we want to destroy is at the very back, so just pop it.
@@ -446,6 +687,20 @@ class UnorderedVectorMap {
     }
   }
 
+  // Rebuilds the lookup table from the current location of every Object.
+  void RebuildLookupTable() {
+    lookup_table_.Reset(Size());
+    KeyFn key_fn;
+    for (size_t page = 0; page < objects_.size(); ++page) {
+      const ObjectArray& array = objects_[page];
+      for (size_t offset = 0; offset < array.Size(); ++offset) {
+        const Index index = {static_cast<uint32_t>(page),
+                             static_cast<uint32_t>(offset)};
+        lookup_table_.InsertUnique(key_fn(*array.Get(offset)), index);
+      }
+    }
+  }
+
   // The vector of arrays used to store Object instances.
   ArrayVector objects_;
 
@@ -456,6 +711,10 @@ class UnorderedVectorMap {
   size_t page_size_;
 };
 
+template <typename Key, typename Object, typename KeyFn, typename LookupHash>
+constexpr size_t
+    UnorderedVectorMap<Key, Object, KeyFn, LookupHash>::kCacheLineSize;
+
 }  // namespace lull
 
 #endif  // LULLABY_UTIL_UNORDERED_VECTOR_MAP_H_
@@ -16,18 +16,61 @@ limitations under the License.
 
 #include "lullaby/util/utf8_string.h"
 
+#include <stdint.h>
+#include <string.h>
 #include <algorithm>
 
 namespace lull {
+namespace {
+
+// ASCII text is processed a machine word at a time, which is the common case
+// for most of the strings being edited and laid out.
+const size_t kWordSize = sizeof(uint64_t);
+
+// Returns true if all the bytes in the word starting at |p| are ASCII.
+bool IsAsciiWord(const char* p) {
+  uint64_t word;
+  memcpy(&word, p, sizeof(word));
+  return (word & 0x8080808080808080ull) == 0;
+}
+
+// Decodes the UTF8 character of |len| bytes (as given by its lead byte) at |p|
+// into |code_point|.  Returns false if the bytes are not a valid encoding.
+bool DecodeChar(const char* p, size_t len, char32_t* code_point) {
+  static const char32_t kMinCodePoint[] = {0, 0, 0x80, 0x800, 0x10000};
+
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(p);
+  if (len == 1) {
+    *code_point = bytes[0];
+    return bytes[0] < 0x80;
+  } else if (len > 4) {
+    return false;
+  }
+
+  char32_t value = bytes[0] & (0x7f >> len);
+  for (size_t i = 1; i < len; ++i) {
+    if ((bytes[i] & 0xc0) != 0x80) {
+      return false;
+    }
+    value = (value << 6) | (bytes[i] & 0x3f);
+  }
+  *code_point = value;
+  return value >= kMinCodePoint[len] && value <= 0x10ffff &&
+         (value < 0xd800 || value > 0xdfff);
+}
+
+}  // namespace
+
+constexpr char32_t UTF8String::kReplacementChar;
 
 UTF8String::UTF8String() {}
 
 UTF8String::UTF8String(const char* cstr) : string_(cstr) {
-  AppendOffsets(0, cstr);
+  AppendOffsets(0, string_.data(), string_.size(), &char_offsets_);
 }
 
 UTF8String::UTF8String(std::string str) : string_(std::move(str)) {
-  AppendOffsets(0, string_.c_str());
+  AppendOffsets(0, string_.data(), string_.size(), &char_offsets_);
 }
 
 size_t UTF8String::OneCharLen(const char* p) {
@@ -45,11 +88,79 @@ size_t UTF8String::OneCharLen(const char* p) {
   return 1;
 }
 
-void UTF8String::AppendOffsets(size_t offset, const char* cstr) {
-  const char* p = cstr;
-  while (*p) {
-    char_offsets_.push_back(offset + p - cstr);
-    p += OneCharLen(p);
+void UTF8String::AppendOffsets(size_t offset, const char* data, size_t len,
+                               std::vector<size_t>* offsets) {
+  size_t i = 0;
+  while (i < len) {
+    if (len - i >= kWordSize && IsAsciiWord(data + i)) {
+      for (size_t j = 0; j < kWordSize; ++j) {
+        offsets->push_back(offset + i + j);
+      }
+      i += kWordSize;
+    } else {
+      offsets->push_back(offset + i);
+      // A truncated character at the end of the data ends at the end.
+      i += std::min(OneCharLen(data + i), len - i);
+    }
+  }
+}
+
+size_t UTF8String::CountChars(const char* data, size_t len) {
+  size_t count = 0;
+  size_t i = 0;
+  while (i < len) {
+    if (len - i >= kWordSize && IsAsciiWord(data + i)) {
+      count += kWordSize;
+      i += kWordSize;
+    } else {
+      ++count;
+      i += std::min(OneCharLen(data + i), len - i);
+    }
+  }
+  return count;
+}
+
+bool UTF8String::IsValid(const char* data, size_t len) {
+  size_t i = 0;
+  while (i < len) {
+    if (len - i >= kWordSize && IsAsciiWord(data + i)) {
+      i += kWordSize;
+      continue;
+    }
+    const size_t char_len = OneCharLen(data + i);
+    char32_t code_point;
+    if (char_len > len - i || !DecodeChar(data + i, char_len, &code_point)) {
+      return false;
+    }
+    i += char_len;
+  }
+  return true;
+}
+
+void UTF8String::DecodeCodePoints(std::vector<char32_t>* code_points) const {
+  code_points->clear();
+  code_points->reserve(CharSize());
+
+  const char* data = string_.data();
+  const size_t len = string_.size();
+  size_t i = 0;
+  while (i < len) {
+    if (len - i >= kWordSize && IsAsciiWord(data + i)) {
+      code_points->insert(code_points->end(), data + i, data + i + kWordSize);
+      i += kWordSize;
+      continue;
+    }
+    const size_t char_len = OneCharLen(data + i);
+    char32_t code_point = kReplacementChar;
+    if (char_len > len - i) {
+      i = len;
+    } else {
+      if (!DecodeChar(data + i, char_len, &code_point)) {
+        code_point = kReplacementChar;
+      }
+      i += char_len;
+    }
+    code_points->push_back(code_point);
   }
 }
 
@@ -66,27 +177,18 @@ void UTF8String::DeleteChars(size_t index, size_t count) {
   if (index >= size) {
     return;
   }
+  const size_t end_index = index + std::min(count, size - index);
   const size_t start = char_offsets_[index];
-  size_t utf8_index = index;
-  size_t num_utf8_chars = 0;
-  size_t num_bytes = 0;
-  while (utf8_index < size && num_utf8_chars < count) {
-    const size_t offset = char_offsets_[utf8_index];
-    num_bytes += OneCharLen(string_.c_str() + offset);
-    ++num_utf8_chars;
-    ++utf8_index;
-  }
+  const size_t end = end_index < size ? char_offsets_[end_index] : ByteSize();
+  const size_t num_bytes = end - start;
   string_.erase(start, num_bytes);
   // Remove the char offsets for the deleted characters and shift any offsets
   // after those that are being removed.
-  const size_t delta_end_index =
-      std::min(index + num_utf8_chars, char_offsets_.size() - 1);
-  const size_t delta = char_offsets_[delta_end_index] - char_offsets_[index];
-  for (size_t i = index + num_utf8_chars; i < char_offsets_.size(); ++i) {
-    char_offsets_[i] -= delta;
+  for (size_t i = end_index; i < size; ++i) {
+    char_offsets_[i] -= num_bytes;
   }
   char_offsets_.erase(char_offsets_.begin() + index,
-                      char_offsets_.begin() + index + num_utf8_chars);
+                      char_offsets_.begin() + end_index);
 }
 
 size_t UTF8String::Insert(size_t index, const std::string& str) {
@@ -96,19 +198,16 @@ size_t UTF8String::Insert(size_t index, const std::string& str) {
   }
 
   const size_t start_offset = index < size ? char_offsets_[index] : ByteSize();
-  size_t utf8_index = index;
-
-  // Insert new offsets.
-  const char* p = str.c_str();
-  while (*p) {
-    char_offsets_.insert(char_offsets_.begin() + utf8_index++,
-                         start_offset + p - str.c_str());
-    p += OneCharLen(p);
-  }
-  // Shift values after |str| insertion.
-  while (utf8_index < char_offsets_.size()) {
-    char_offsets_[utf8_index++] += str.size();
+
+  // Shift values after |str| insertion, then insert the new offsets all at
+  // once rather than one character at a time.
+  for (size_t i = index; i < size; ++i) {
+    char_offsets_[i] += str.size();
   }
+  std::vector<size_t> offsets;
+  AppendOffsets(start_offset, str.data(), str.size(), &offsets);
+  char_offsets_.insert(char_offsets_.begin() + index, offsets.begin(),
+                       offsets.end());
   string_.insert(start_offset, str);
 
   return CharSize() - size;
@@ -126,13 +225,13 @@ void UTF8String::DeleteLast() {
 void UTF8String::Append(const std::string& str) {
   const size_t byte_len = ByteSize();
   string_.append(str);
-  AppendOffsets(byte_len, str.c_str());
+  AppendOffsets(byte_len, str.data(), str.size(), &char_offsets_);
 }
 
 void UTF8String::Set(std::string str) {
   string_ = std::move(str);
   char_offsets_.clear();
-  AppendOffsets(0, string_.c_str());
+  AppendOffsets(0, string_.data(), string_.size(), &char_offsets_);
 }
 
 std::string UTF8String::CharAt(size_t index) const {
@@ -28,6 +28,9 @@ namespace lull {
 // start positions.
 class UTF8String {
  public:
+  // The code point used by DecodeCodePoints for invalid UTF8 characters.
+  static constexpr char32_t kReplacementChar = 0xfffd;
+
   UTF8String();
   explicit UTF8String(const char* cstr);
   explicit UTF8String(std::string str);
@@ -66,11 +69,27 @@ class UTF8String {
   // Returns true if empty.
   const bool empty() const;
 
+  // Decodes the string into Unicode code points, one per UTF8 character,
+  // replacing the contents of |code_points|.  Invalid characters are decoded
+  // as kReplacementChar.  Reusing the same vector avoids reallocating it.
+  void DecodeCodePoints(std::vector<char32_t>* code_points) const;
+
+  // Returns the UTF8 character count of the |len| bytes at |data|.
+  static size_t CountChars(const char* data, size_t len);
+
+  // Returns true if the |len| bytes at |data| are valid UTF8, ie. contain no
+  // truncated, overlong, or surrogate sequences and no code points above
+  // U+10FFFF.
+  static bool IsValid(const char* data, size_t len);
+
  private:
   std::string string_;
   std::vector<size_t> char_offsets_;
 
-  void AppendOffsets(size_t offset, const char* cstr);
+  // Appends the offsets of the characters in the |len| bytes at |data|, plus
+  // |offset|, to |offsets|.
+  static void AppendOffsets(size_t offset, const char* data, size_t len,
+                            std::vector<size_t>* offsets);
   static size_t OneCharLen(const char* s);
 };
 
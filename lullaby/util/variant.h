@@ -17,7 +17,9 @@ limitations under the License.
 #ifndef LULLABY_BASE_VARIANT_H_
 #define LULLABY_BASE_VARIANT_H_
 
+#include <atomic>
 #include <functional>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -28,8 +30,15 @@ limitations under the License.
 #include "lullaby/util/logging.h"
 #include "lullaby/util/type_util.h"
 #include "lullaby/util/typeid.h"
+#include "lullaby/util/variant_arena.h"
 #include "mathfu/glsl_mappings.h"
 
+// The size of the buffer embedded in each Variant, which must be a multiple of
+// 16.  The default is large enough for a mathfu::mat4.
+#ifndef LULLABY_VARIANT_STORE_SIZE
+#define LULLABY_VARIANT_STORE_SIZE 64
+#endif
+
 namespace lull {
 
 class Variant;
@@ -49,10 +58,16 @@ namespace lull {
 // This class is similar to C++17 std::any, but differs in the following ways:
 //
 // * Returns a Lullaby TypeId instead of the C++ RTTI type_info class.
-// * Does not do any dynamic allocations.  It is effectively just the
-//   "small-object optimization" (SOO) part of std::any.
-// * Stored objects are limited to 64 bytes and 16-byte alignment.  This is
-//   designed to store common types including std containers and mathfu types.
+// * Objects that fit in the embedded buffer (LULLABY_VARIANT_STORE_SIZE bytes)
+//   are stored without any dynamic allocation.  This is designed to store
+//   common types including std containers and mathfu types.
+// * Larger objects, as well as long strings and non-empty VariantArrays,
+//   VariantMaps and ByteArrays, are stored in a reference-counted block that
+//   is shared by copies of the Variant.  The block is copied on write: a
+//   non-const Get() gives the Variant its own copy of the value, which is then
+//   no longer shared by later copies.  Blocks are taken from the VariantArena
+//   of the calling thread, if any.
+// * Stored objects are limited to 16-byte alignment.
 class Variant {
  private:
   // Helper for determining if U is actually a Variant.  This is used to ensure
@@ -81,19 +96,17 @@ class Variant {
 
  public:
   // Default constructor, no value set.
-  Variant() : type_(0), size_(0), handler_(nullptr) {}
+  Variant() : type_(0), size_(0), shared_(0), handler_(nullptr) {}
 
   // Copy constructor, copies variant value stored in |rhs|.
-  Variant(const Variant& rhs)
-      : type_(rhs.type_), size_(0), handler_(rhs.handler_) {
+  Variant(const Variant& rhs) : Variant() {
     if (!rhs.Empty()) {
-      Resize(rhs.size_);
-      DoOp(kCopy, Data(), rhs.Data(), nullptr);
+      CopyFrom(rhs);
     }
   }
 
   // Move constructor, copies variant value stored in |rhs|.
-  Variant(Variant&& rhs) : type_(0), size_(0), handler_(nullptr) {
+  Variant(Variant&& rhs) : Variant() {
     if (!rhs.Empty()) {
       Move(&rhs, this);
     }
@@ -114,10 +127,7 @@ class Variant {
     if (this != &rhs) {
       Clear();
       if (!rhs.Empty()) {
-        type_ = rhs.type_;
-        handler_ = rhs.handler_;
-        Resize(rhs.size_);
-        DoOp(kCopy, Data(), rhs.Data(), nullptr);
+        CopyFrom(rhs);
       }
     }
     return *this;
@@ -147,10 +157,10 @@ class Variant {
   // Resets the Variant back to an unset state, destroying any stored value.
   void Clear() {
     if (!Empty()) {
-      DoOp(kDestroy, nullptr, nullptr, Data());
-      FreeHeapData();
+      Release();
       type_ = 0;
       size_ = 0;
+      shared_ = 0;
       handler_ = nullptr;
     }
   }
@@ -226,7 +236,8 @@ class Variant {
       archive(&t, ConstHash("data"));       \
       operator=(std::move(t));              \
     } else {                                \
-      archive(Get<T>(), ConstHash("data")); \
+      archive(const_cast<T*>(GetConst<T>()), \
+              ConstHash("data"));           \
     }                                       \
     return;                                 \
   }
@@ -237,6 +248,12 @@ class Variant {
     bool is_enum = IsEnum();
     archive(&is_enum, ConstHash("is_enum"));
     if (is_enum) {
+      if (archive.IsDestructive()) {
+        // Destroy the previous value, which may not have been an enum.
+        const TypeId type = type_;
+        Clear();
+        type_ = type;
+      }
       size_ = sizeof(EnumType);
       handler_ = nullptr;
       EnumType* ptr = reinterpret_cast<EnumType*>(Data());
@@ -264,12 +281,33 @@ class Variant {
 
  private:
   enum {
-    // Embedded buffer size. Any types larger than this will be heap-allocated.
-    // This is chosen to be just large enough to contain the common primitive
-    // types (e.g. int, float, vector, string), so most variants don't require a
-    // separate allocation.
-    kStoreSize = 32,
+    // Embedded buffer size. Any types larger than this will be stored in a
+    // shared block. This is chosen to be just large enough to contain the
+    // common types (e.g. int, float, vector, string, mat4), so most variants
+    // don't require a separate allocation.
+    kStoreSize = LULLABY_VARIANT_STORE_SIZE,
     kStoreAlign = 16,  // Aligned for mathfu types.
+    // Strings longer than this are assumed to have heap-allocated contents,
+    // which makes them worth sharing.
+    kMaxUnsharedStringSize = 15,
+  };
+  static_assert(kStoreSize % kStoreAlign == 0, "");
+  static_assert(kStoreSize >= sizeof(void*), "");
+
+  // Header of the block used to store a value outside of the embedded buffer,
+  // which is followed by the value itself.
+  struct SharedBlock {
+    std::atomic<int> ref_count;
+    // Set once a mutable pointer to the value has been handed out, after which
+    // the block can no longer be shared.
+    bool exclusive;
+    // The arena that owns the block's memory, or nullptr for the heap.
+    VariantArena* arena;
+  };
+
+  enum {
+    kBlockHeaderSize =
+        (sizeof(SharedBlock) + kStoreAlign - 1) / kStoreAlign * kStoreAlign,
   };
 
   // Enum types are assumed to be no larger than a uint64_t.
@@ -327,11 +365,23 @@ class Variant {
     using RetType = typename std::decay<Ret>::type;
     const TypeId type = lull::GetTypeId<RetType>();
     if (type == variant->type_) {
-      return static_cast<Ret*>(variant->Data());
+      return static_cast<Ret*>(AccessData(variant));
     }
     return nullptr;
   }
 
+  // Const access to the value never needs to copy it, whereas mutable access
+  // must first give the Variant its own copy of a shared value.
+  static const void* AccessData(const Variant* variant) {
+    return variant->Data();
+  }
+  static void* AccessData(Variant* variant) { return variant->MutableData(); }
+
+  template <typename T>
+  const T* GetConst() const {
+    return Get<T>();
+  }
+
   // Overload for when Ret does not have a TypeId. In this case, the type could
   // never be stored in a Variant, so we always return nullptr.
   template <typename Ret, typename Self>
@@ -367,12 +417,32 @@ class Variant {
       memcpy(data, &value, sizeof(value));
       handler_ = nullptr;
     } else {
-      Resize(sizeof(value));
+      Allocate(sizeof(value), ShouldShare(static_cast<const Type&>(value)));
       new (Data()) Type(std::forward<T>(value));
       handler_ = &HandlerImpl<Type>;
     }
   }
 
+  // Returns whether |value| should be stored in a shared block rather than in
+  // the embedded buffer.  This is done for values which don't fit the buffer,
+  // and for values whose copies would need to allocate anyway.
+  template <typename T>
+  static bool ShouldShare(const T& value) {
+    return sizeof(T) > kStoreSize;
+  }
+  static bool ShouldShare(const std::string& value) {
+    return sizeof(value) > kStoreSize || value.size() > kMaxUnsharedStringSize;
+  }
+  static bool ShouldShare(const VariantArray& value) {
+    return sizeof(value) > kStoreSize || !value.empty();
+  }
+  static bool ShouldShare(const VariantMap& value) {
+    return sizeof(value) > kStoreSize || !value.empty();
+  }
+  static bool ShouldShare(const ByteArray& value) {
+    return sizeof(value) > kStoreSize || !value.empty();
+  }
+
   // Overload for SetImpl for when T does not have a TypeId.  In this case, do
   // nothing.
   template <typename T>
@@ -465,39 +535,108 @@ class Variant {
 
   // Get data for small types with embedded storage.
   void* EmbeddedData() {
-    assert(size_ <= kStoreSize && size_ > 0);
+    assert(!shared_ && size_ <= kStoreSize && size_ > 0);
     return &buffer_;
   }
   const void* EmbeddedData() const {
     return const_cast<Variant*>(this)->EmbeddedData();
   }
 
-  // Get data for large types with heap storage.
-  void* HeapData() {
-    assert(size_ > kStoreSize);
-    return *reinterpret_cast<void**>(&buffer_);
+  // Get the block for types with shared storage.
+  SharedBlock* Block() const {
+    assert(shared_);
+    return *reinterpret_cast<SharedBlock* const*>(&buffer_);
+  }
+  void SetBlock(SharedBlock* block) {
+    *reinterpret_cast<SharedBlock**>(&buffer_) = block;
   }
-  const void* HeapData() const {
-    return const_cast<Variant*>(this)->HeapData();
+  static void* BlockData(SharedBlock* block) {
+    return reinterpret_cast<uint8_t*>(block) + kBlockHeaderSize;
   }
 
   // Get data irrespective of storage location.
-  void* Data() {
-    return size_ <= kStoreSize ? &buffer_ : *reinterpret_cast<void**>(&buffer_);
-  }
+  void* Data() { return shared_ ? BlockData(Block()) : &buffer_; }
   const void* Data() const {
     return const_cast<Variant*>(this)->Data();
   }
 
-  // Set data to a heap-allocated pointer.
-  void SetDataAsPointer(void* pointer) {
-    *reinterpret_cast<void**>(&buffer_) = pointer;
+  // Get data that is about to be modified, first copying a value that is
+  // shared with other Variants.
+  void* MutableData() {
+    if (!shared_) {
+      return &buffer_;
+    }
+    SharedBlock* block = Block();
+    if (block->ref_count.load(std::memory_order_acquire) > 1) {
+      Allocate(size_, true);
+      DoOp(kCopy, Data(), BlockData(block), nullptr);
+      ReleaseBlock(block);
+      block = Block();
+    }
+    block->exclusive = true;
+    return BlockData(block);
+  }
+
+  // Set up storage for a value of |size| bytes, allocating a new block if the
+  // value is to be shared.  Any previous storage must have been released.
+  void Allocate(size_t size, bool shared) {
+    size_ = static_cast<uint32_t>(size);
+    shared_ = shared ? 1 : 0;
+    if (!shared) {
+      assert(size <= kStoreSize);
+      return;
+    }
+
+    const size_t block_size = kBlockHeaderSize + size;
+    VariantArena* arena = VariantArena::GetCurrent();
+    void* memory = arena ? arena->Allocate(block_size, kStoreAlign)
+                         : AlignedAlloc(block_size, kStoreAlign);
+    SharedBlock* block = new (memory) SharedBlock();
+    block->ref_count.store(1, std::memory_order_relaxed);
+    block->exclusive = false;
+    block->arena = arena;
+    SetBlock(block);
+  }
+
+  // Copies the value and storage of |rhs|, sharing its block if possible.
+  // This variant must be empty.
+  void CopyFrom(const Variant& rhs) {
+    type_ = rhs.type_;
+    handler_ = rhs.handler_;
+    if (rhs.shared_ && !rhs.Block()->exclusive) {
+      SharedBlock* block = rhs.Block();
+      block->ref_count.fetch_add(1, std::memory_order_relaxed);
+      size_ = rhs.size_;
+      shared_ = 1;
+      SetBlock(block);
+    } else {
+      Allocate(rhs.size_, rhs.shared_ != 0);
+      DoOp(kCopy, Data(), rhs.Data(), nullptr);
+    }
+  }
+
+  // Destroys the value, unless it is still shared with other Variants.
+  void Release() {
+    if (shared_) {
+      ReleaseBlock(Block());
+    } else {
+      DoOp(kDestroy, nullptr, nullptr, &buffer_);
+    }
   }
 
-  // Free heap data if necessary.
-  void FreeHeapData() {
-    if (size_ > kStoreSize) {
-      AlignedFree(HeapData());
+  // Releases a reference to |block|, destroying the value (which must be of
+  // this variant's type) and freeing the block when it is the last one.
+  void ReleaseBlock(SharedBlock* block) {
+    if (block->ref_count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    DoOp(kDestroy, nullptr, nullptr, BlockData(block));
+    VariantArena* arena = block->arena;
+    block->~SharedBlock();
+    if (arena) {
+      arena->Release();
+    } else {
+      AlignedFree(block);
     }
   }
 
@@ -506,34 +645,25 @@ class Variant {
     assert(to->Empty());  // Destination should be cleared by caller.
     to->type_ = from->type_;
     to->size_ = from->size_;
+    to->shared_ = from->shared_;
     to->handler_ = from->handler_;
 
     if (!from->Empty()) {
-      if (from->size_ <= kStoreSize) {
+      if (!from->shared_) {
         to->DoOp(kMove, to->EmbeddedData(), nullptr, from->EmbeddedData());
         from->DoOp(kDestroy, nullptr, nullptr, from->Data());
       } else {
-        // Heap data can be moved by copying the pointer.
-        to->SetDataAsPointer(from->HeapData());
+        // Shared data can be moved by copying the pointer.
+        to->SetBlock(from->Block());
       }
     }
 
     from->type_ = 0;
     from->size_ = 0;
+    from->shared_ = 0;
     from->handler_ = nullptr;
   }
 
-  // Resize storage, freeing and reallocating heap memory as necessary.
-  void Resize(size_t size) {
-    if (size_ != size) {
-      FreeHeapData();
-      if (size > kStoreSize) {
-        SetDataAsPointer(AlignedAlloc(size, kStoreAlign));
-      }
-      size_ = static_cast<uint32_t>(size);
-    }
-  }
-
   // Cast specialization for int and float casts.
   template <typename T>
   Optional<typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
@@ -556,7 +686,8 @@ class Variant {
   bool IsEnum() const { return handler_ == nullptr; }
 
   TypeId type_ = 0;    // TypeId of the stored value, or 0 if no value stored.
-  uint32_t size_;
+  uint32_t size_ : 31;
+  uint32_t shared_ : 1;  // Whether the value is stored in a SharedBlock.
   HandlerFn handler_;  // Used to perform type-specific operations on the value.
   Buffer buffer_;      // Memory buffer to hold variant value.
 };
@@ -0,0 +1,95 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/variant_arena.h"
+
+#include <algorithm>
+
+#include "lullaby/util/aligned_alloc.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+namespace {
+
+// Pages are aligned enough for any of the types stored in a Variant.
+constexpr size_t kPageAlign = 16;
+
+// The arena of the calling thread, as set by VariantArena::Scope.
+thread_local VariantArena* g_current_arena = nullptr;
+
+}  // namespace
+
+VariantArena::Scope::Scope(VariantArena* arena) : previous_(g_current_arena) {
+  g_current_arena = arena;
+}
+
+VariantArena::Scope::~Scope() { g_current_arena = previous_; }
+
+VariantArena::VariantArena(size_t page_size)
+    : page_size_(page_size), num_live_allocations_(0) {}
+
+VariantArena::~VariantArena() {
+  if (num_live_allocations_ != 0) {
+    LOG(DFATAL) << "VariantArena destroyed with " << num_live_allocations_
+                << " live allocations.";
+  }
+  for (const Page& page : pages_) {
+    AlignedFree(page.data);
+  }
+}
+
+VariantArena* VariantArena::GetCurrent() { return g_current_arena; }
+
+void* VariantArena::Allocate(size_t size, size_t align) {
+  DCHECK_LE(align, kPageAlign);
+  while (page_index_ < pages_.size()) {
+    const size_t offset = (offset_ + align - 1) & ~(align - 1);
+    if (offset + size <= pages_[page_index_].size) {
+      offset_ = offset + size;
+      ++num_live_allocations_;
+      return pages_[page_index_].data + offset;
+    }
+    ++page_index_;
+    offset_ = 0;
+  }
+
+  // Allocations larger than a page get a page of their own.
+  Page page;
+  page.size = std::max(page_size_, size);
+  page.data = static_cast<uint8_t*>(AlignedAlloc(page.size, kPageAlign));
+  pages_.push_back(page);
+  page_index_ = pages_.size() - 1;
+  offset_ = size;
+  ++num_live_allocations_;
+  return page.data;
+}
+
+void VariantArena::Release() {
+  DCHECK_GT(num_live_allocations_.load(), 0u);
+  --num_live_allocations_;
+}
+
+void VariantArena::Reset() {
+  if (num_live_allocations_ != 0) {
+    LOG(DFATAL) << "VariantArena reset with " << num_live_allocations_
+                << " live allocations.";
+    return;
+  }
+  page_index_ = 0;
+  offset_ = 0;
+}
+
+}  // namespace lull
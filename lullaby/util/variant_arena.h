@@ -0,0 +1,100 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_VARIANT_ARENA_H_
+#define LULLABY_UTIL_VARIANT_ARENA_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lull {
+
+// A bump allocator for the storage of short-lived Variants, such as the
+// payloads of the events sent during a single frame.
+//
+// While a VariantArena::Scope is alive on a thread, any Variant set on that
+// thread which needs storage outside of its embedded buffer takes it from the
+// arena instead of the heap.  The memory is only reclaimed by Reset(), which
+// must not be called until all the Variants using the arena are destroyed.
+//
+//   VariantArena arena;
+//   while (running) {
+//     {
+//       VariantArena::Scope scope(&arena);
+//       SendFrameEvents();
+//     }
+//     arena.Reset();
+//   }
+class VariantArena {
+ public:
+  // Makes |arena| the arena of the calling thread until the Scope is
+  // destroyed.  Scopes may be nested.
+  class Scope {
+   public:
+    explicit Scope(VariantArena* arena);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    VariantArena* previous_;
+  };
+
+  static const size_t kDefaultPageSize = 16 * 1024;
+
+  explicit VariantArena(size_t page_size = kDefaultPageSize);
+  ~VariantArena();
+
+  VariantArena(const VariantArena&) = delete;
+  VariantArena& operator=(const VariantArena&) = delete;
+
+  // Returns the arena of the calling thread, or nullptr if there is none.
+  static VariantArena* GetCurrent();
+
+  // Returns |size| bytes of memory aligned to |align|.  Must only be called
+  // from the thread that owns the arena.
+  void* Allocate(size_t size, size_t align);
+
+  // Records that one of the allocations is no longer in use.  This may be
+  // called from any thread.
+  void Release();
+
+  // Makes all the memory in the arena available again, keeping its pages for
+  // reuse.  All allocations must have been released.
+  void Reset();
+
+  // Returns the number of allocations that have not been released.
+  size_t GetNumLiveAllocations() const { return num_live_allocations_; }
+
+ private:
+  struct Page {
+    uint8_t* data;
+    size_t size;
+  };
+
+  std::vector<Page> pages_;
+  size_t page_index_ = 0;
+  size_t offset_ = 0;
+  size_t page_size_;
+  std::atomic<size_t> num_live_allocations_;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_UTIL_VARIANT_ARENA_H_
@@ -21,6 +21,7 @@ limitations under the License.
 #include "fplbase/utilities.h"
 #include "lullaby/modules/animation_channels/render_channels.h"
 #include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/modules/ecs/system_profiler.h"
 #include "lullaby/modules/file/asset_loader.h"
 #include "lullaby/modules/input/input_manager.h"
 #include "lullaby/modules/script/function_binder.h"
@@ -34,6 +35,7 @@ limitations under the License.
 #include "lullaby/systems/model_asset/model_asset_system.h"
 #include "lullaby/systems/name/name_system.h"
 #include "lullaby/systems/physics/physics_system.h"
+#include "lullaby/systems/render/detail/profiler.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/rig/rig_system.h"
 #include "lullaby/systems/script/script_system.h"
@@ -42,6 +44,7 @@ limitations under the License.
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/filename.h"
 #include "lullaby/util/make_unique.h"
+#include "lullaby/util/trace.h"
 #include "lullaby/viewer/entity_generated.h"
 #include "lullaby/viewer/src/builders/build_blueprint.h"
 #include "lullaby/viewer/src/file_manager.h"
@@ -51,7 +54,9 @@ limitations under the License.
 #include "lullaby/viewer/src/widgets/console.h"
 #include "lullaby/viewer/src/widgets/entity_editor.h"
 #include "lullaby/viewer/src/widgets/file_dialog.h"
+#include "lullaby/viewer/src/widgets/performance_window.h"
 #include "lullaby/viewer/src/widgets/preview_window.h"
+#include "lullaby/viewer/src/widgets/system_profiler_window.h"
 
 namespace lull {
 namespace tool {
@@ -109,6 +114,10 @@ void Viewer::OnInitialize() {
   registry_->Create<BuildShaderPopup>(registry_.get());
   registry_->Create<Console>(registry_.get());
   registry_->Create<EntityEditor>(registry_.get());
+  registry_->Create<SystemProfiler>(registry_.get());
+  registry_->Create<detail::Profiler>();
+  registry_->Create<PerformanceWindow>(registry_.get());
+  registry_->Create<SystemProfilerWindow>(registry_.get());
 
   auto* binder = registry_->Get<FunctionBinder>();
   binder->RegisterFunction("pause", [this]() {
@@ -123,8 +132,13 @@ void Viewer::OnInitialize() {
 }
 
 void Viewer::AdvanceFrame(double dt, int width, int height) {
+  LULLABY_CPU_TRACE_CALL();
   AdvanceLullabySystems(dt);
   UpdateViewerGui(width, height);
+
+  const auto delta_time =
+      std::chrono::duration_cast<Clock::duration>(Secondsf(dt));
+  registry_->Get<PerformanceWindow>()->AdvanceFrame(delta_time);
 }
 
 void Viewer::AdvanceLullabySystems(double dt) {
@@ -146,6 +160,7 @@ void Viewer::AdvanceLullabySystems(double dt) {
   registry_->Get<lull::ScriptSystem>()->AdvanceFrame(delta_time);
   registry_->Get<lull::StategraphSystem>()->AdvanceFrame(delta_time);
   registry_->Get<lull::AnimationSystem>()->AdvanceFrame(delta_time);
+  registry_->Get<lull::RigSystem>()->UpdateBoneAttachments();
   registry_->Get<lull::PhysicsSystem>()->AdvanceFrame(delta_time);
   registry_->Get<lull::LightSystem>()->AdvanceFrame();
   registry_->Get<lull::RenderSystem>()->ProcessTasks();
@@ -190,6 +205,12 @@ void Viewer::UpdateViewerGui(int width, int height) {
       }
       if (ImGui::MenuItem("Preview Window")) {
       }
+      if (ImGui::MenuItem("Performance")) {
+        registry_->Get<PerformanceWindow>()->Open();
+      }
+      if (ImGui::MenuItem("System Profiler")) {
+        registry_->Get<SystemProfilerWindow>()->Open();
+      }
       ImGui::Separator();
       if (ImGui::MenuItem("Reset")) {
       }
@@ -241,6 +262,7 @@ void Viewer::UpdateViewerGui(int width, int height) {
   registry_->Get<BuildBlueprintPopup>()->AdvanceFrame();
   registry_->Get<BuildModelPopup>()->AdvanceFrame();
   registry_->Get<BuildShaderPopup>()->AdvanceFrame();
+  registry_->Get<SystemProfilerWindow>()->AdvanceFrame();
 }
 
 void Viewer::OnShutdown() { registry_.reset(); }
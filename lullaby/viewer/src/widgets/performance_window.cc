@@ -0,0 +1,267 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/viewer/src/widgets/performance_window.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+#include "dear_imgui/imgui.h"
+#include "lullaby/modules/ecs/system_profiler.h"
+#include "lullaby/systems/render/detail/profiler.h"
+#include "lullaby/systems/render/texture_factory.h"
+#include "lullaby/tools/common/file_utils.h"
+#include "lullaby/util/time.h"
+#include "lullaby/util/trace.h"
+#include "lullaby/viewer/src/file_manager.h"
+
+namespace lull {
+namespace tool {
+
+static const float kGraphHeight = 60.f;
+
+PerformanceWindow::PerformanceWindow(Registry* registry)
+    : registry_(registry),
+      frame_ms_(kHistorySize),
+      gpu_ms_(kHistorySize),
+      systems_ms_(kHistorySize) {}
+
+void PerformanceWindow::Open() { open_ = true; }
+
+void PerformanceWindow::Close() { open_ = false; }
+
+void PerformanceWindow::AdvanceFrame(Clock::duration delta_time) {
+  RecordFrame(delta_time);
+  UpdateCapture();
+  if (!open_) {
+    return;
+  }
+
+  if (ImGui::Begin("Performance", &open_)) {
+    DrawFrameTimes();
+    DrawSystems();
+    DrawRenderStats();
+    DrawTextureResidency();
+    DrawCapture();
+  }
+  ImGui::End();
+}
+
+void PerformanceWindow::RecordFrame(Clock::duration delta_time) {
+  frame_ms_.Add(MillisecondsFromDuration(delta_time));
+
+  const auto* profiler = registry_->Get<detail::Profiler>();
+  gpu_ms_.Add(profiler ? profiler->GetGpuFrameMs() : 0.f);
+
+  // Only the Systems stepped since the last frame contribute to its total.
+  float systems_ms = 0.f;
+  if (auto* system_profiler = registry_->Get<SystemProfiler>()) {
+    for (const SystemProfiler::Stats& stats : system_profiler->GetAllStats()) {
+      systems_ms += MillisecondsFromDuration(stats.last_time);
+    }
+  }
+  systems_ms_.Add(systems_ms);
+}
+
+void PerformanceWindow::DrawFrameTimes() {
+  if (!ImGui::CollapsingHeader("Frame Times",
+                               ImGuiTreeNodeFlags_DefaultOpen)) {
+    return;
+  }
+
+  // All graphs share a scale so that they can be compared at a glance.
+  const float max_ms = std::max(
+      {frame_ms_.GetMax(), gpu_ms_.GetMax(), systems_ms_.GetMax(), 1.f});
+  const ImVec2 size(0.f, kGraphHeight);
+  char overlay[64];
+
+  snprintf(overlay, sizeof(overlay), "Frame %.2f ms", frame_ms_.GetLatest());
+  ImGui::PlotLines("##Frame", frame_ms_.GetValues().data(),
+                   frame_ms_.GetSize(), frame_ms_.GetOffset(), overlay, 0.f,
+                   max_ms, size);
+
+  snprintf(overlay, sizeof(overlay), "GPU %.2f ms", gpu_ms_.GetLatest());
+  ImGui::PlotLines("##GPU", gpu_ms_.GetValues().data(), gpu_ms_.GetSize(),
+                   gpu_ms_.GetOffset(), overlay, 0.f, max_ms, size);
+
+  snprintf(overlay, sizeof(overlay), "Systems %.2f ms",
+           systems_ms_.GetLatest());
+  ImGui::PlotLines("##Systems", systems_ms_.GetValues().data(),
+                   systems_ms_.GetSize(), systems_ms_.GetOffset(), overlay,
+                   0.f, max_ms, size);
+}
+
+void PerformanceWindow::DrawSystems() {
+  if (!ImGui::CollapsingHeader("Systems")) {
+    return;
+  }
+  auto* profiler = registry_->Get<SystemProfiler>();
+  if (!profiler) {
+    ImGui::Text("No SystemProfiler.");
+    return;
+  }
+
+  const auto stats = profiler->GetAllStats();
+  float total_ms = 0.f;
+  for (const SystemProfiler::Stats& system : stats) {
+    total_ms += MillisecondsFromDuration(system.last_time);
+  }
+
+  ImGui::Columns(3, "PerformanceSystems");
+  for (const SystemProfiler::Stats& system : stats) {
+    if (system.num_samples == 0) {
+      continue;
+    }
+    const float last_ms = MillisecondsFromDuration(system.last_time);
+    ImGui::Text("%s", system.name.c_str());
+    ImGui::NextColumn();
+    ImGui::Text("%.3f ms", last_ms);
+    ImGui::NextColumn();
+    ImGui::ProgressBar(total_ms > 0.f ? last_ms / total_ms : 0.f);
+    ImGui::NextColumn();
+  }
+  ImGui::Columns(1);
+}
+
+void PerformanceWindow::DrawRenderStats() {
+  if (!ImGui::CollapsingHeader("Rendering")) {
+    return;
+  }
+  const auto* profiler = registry_->Get<detail::Profiler>();
+  if (!profiler) {
+    ImGui::Text("No render Profiler.");
+    return;
+  }
+
+  ImGui::Text("FPS: %.1f", profiler->GetFilteredFps());
+  ImGui::Text("CPU: %.2f ms  GPU: %.2f ms", profiler->GetCpuFrameMs(),
+              profiler->GetGpuFrameMs());
+  ImGui::Text("Draws: %d  Verts: %d  Tris: %d", profiler->GetNumDraws(),
+              profiler->GetNumVerts(), profiler->GetNumTris());
+  ImGui::Text("Shader swaps: %d  Material swaps: %d  Mesh swaps: %d",
+              profiler->GetNumShaderSwaps(), profiler->GetNumMaterialSwaps(),
+              profiler->GetNumMeshSwaps());
+  ImGui::Text("Render state changes: %d",
+              profiler->GetNumRenderStateChanges());
+  ImGui::Text("Dropped frames: %d", profiler->GetNumDroppedFrames());
+
+  ImGui::Columns(3, "PerformancePasses");
+  ImGui::Text("Pass");
+  ImGui::NextColumn();
+  ImGui::Text("GPU (ms)");
+  ImGui::NextColumn();
+  ImGui::Text("Draws");
+  ImGui::NextColumn();
+  for (const detail::Profiler::PassStats& pass : profiler->GetPassStats()) {
+    ImGui::Text("0x%08x", pass.pass);
+    ImGui::NextColumn();
+    ImGui::Text("%.3f", pass.gpu_ms);
+    ImGui::NextColumn();
+    ImGui::Text("%d", pass.num_draws);
+    ImGui::NextColumn();
+  }
+  ImGui::Columns(1);
+}
+
+void PerformanceWindow::DrawTextureResidency() {
+  if (!ImGui::CollapsingHeader("Texture Residency")) {
+    return;
+  }
+  const auto* texture_factory = registry_->Get<TextureFactory>();
+  if (!texture_factory) {
+    return;
+  }
+
+  size_t total_bytes = 0;
+  ImGui::Columns(4, "PerformanceTextures");
+  ImGui::Text("Texture");
+  ImGui::NextColumn();
+  ImGui::Text("Size");
+  ImGui::NextColumn();
+  ImGui::Text("Mip");
+  ImGui::NextColumn();
+  ImGui::Text("Resident (KB)");
+  ImGui::NextColumn();
+  texture_factory->ForEachTextureResidency(
+      [&](const TextureFactory::TextureResidencyInfo& info) {
+        total_bytes += info.resident_bytes;
+        ImGui::Text("%s", info.name.c_str());
+        ImGui::NextColumn();
+        ImGui::Text("%dx%d", info.size.x, info.size.y);
+        ImGui::NextColumn();
+        ImGui::Text("%d/%d%s", info.resident_level, info.num_levels,
+                    info.streaming ? " (streaming)" : "");
+        ImGui::NextColumn();
+        ImGui::Text("%.1f", static_cast<float>(info.resident_bytes) / 1024.f);
+        ImGui::NextColumn();
+      });
+  ImGui::Columns(1);
+  ImGui::Text("Total: %.2f MB",
+              static_cast<float>(total_bytes) / (1024.f * 1024.f));
+}
+
+void PerformanceWindow::DrawCapture() {
+  if (!ImGui::CollapsingHeader("Trace Capture",
+                               ImGuiTreeNodeFlags_DefaultOpen)) {
+    return;
+  }
+#if !LULLABY_ENABLE_TRACING
+  ImGui::Text("Build with LULLABY_ENABLE_TRACING=1 to record trace events.");
+#endif
+
+  if (capture_frames_remaining_ > 0) {
+    ImGui::Text("Capturing... %d frames remaining", capture_frames_remaining_);
+  } else {
+    ImGui::InputInt("Frames", &capture_num_frames_);
+    capture_num_frames_ = std::max(capture_num_frames_, 1);
+    if (ImGui::Button("Capture Trace")) {
+      StartCapture();
+    }
+  }
+  if (!capture_status_.empty()) {
+    ImGui::TextWrapped("%s", capture_status_.c_str());
+  }
+}
+
+void PerformanceWindow::StartCapture() {
+  StartTracing();
+  capture_frames_remaining_ = capture_num_frames_;
+  capture_status_.clear();
+}
+
+void PerformanceWindow::UpdateCapture() {
+  if (capture_frames_remaining_ > 0) {
+    --capture_frames_remaining_;
+    if (capture_frames_remaining_ == 0) {
+      FinishCapture();
+    }
+  }
+}
+
+void PerformanceWindow::FinishCapture() {
+  StopTracing();
+  const std::string json = GetChromeTraceJson();
+  const std::string filename =
+      FileManager::MakeTempFolder("trace") + "viewer_trace.json";
+  if (SaveFile(json.data(), json.size(), filename.c_str(), false)) {
+    capture_status_ = "Saved " + filename;
+  } else {
+    capture_status_ = "Failed to save " + filename;
+  }
+}
+
+}  // namespace tool
+}  // namespace lull
@@ -0,0 +1,78 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_VIEWER_SRC_WIDGETS_PERFORMANCE_WINDOW_H_
+#define LULLABY_VIEWER_SRC_WIDGETS_PERFORMANCE_WINDOW_H_
+
+#include <string>
+
+#include "lullaby/util/clock.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/util/sample_history.h"
+
+namespace lull {
+namespace tool {
+
+// Displays live performance data: rolling graphs of the frame, GPU and
+// per-System times, the draw and state change counts of the last frame, and
+// the residency of budgeted textures.  It can also capture a Chrome trace of
+// a number of frames.
+class PerformanceWindow {
+ public:
+  explicit PerformanceWindow(Registry* registry);
+
+  void Open();
+  void Close();
+
+  // Records the frame's timings and draws the window.  Must be called every
+  // frame, even when the window is closed, so that the graphs and captures
+  // cover consecutive frames.
+  void AdvanceFrame(Clock::duration delta_time);
+
+ private:
+  // The number of frames shown in the graphs.
+  static const int kHistorySize = 240;
+
+  void RecordFrame(Clock::duration delta_time);
+  void UpdateCapture();
+  void StartCapture();
+  void FinishCapture();
+
+  void DrawFrameTimes();
+  void DrawSystems();
+  void DrawRenderStats();
+  void DrawTextureResidency();
+  void DrawCapture();
+
+  Registry* registry_ = nullptr;
+  bool open_ = false;
+
+  // The last kHistorySize values of each timing, in milliseconds.
+  SampleHistory frame_ms_;
+  SampleHistory gpu_ms_;
+  SampleHistory systems_ms_;
+
+  int capture_num_frames_ = 120;
+  int capture_frames_remaining_ = 0;
+  std::string capture_status_;
+};
+
+}  // namespace tool
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::tool::PerformanceWindow);
+
+#endif  // LULLABY_VIEWER_SRC_WIDGETS_PERFORMANCE_WINDOW_H_
@@ -0,0 +1,94 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/viewer/src/widgets/system_profiler_window.h"
+
+#include "dear_imgui/imgui.h"
+#include "lullaby/modules/ecs/system_profiler.h"
+#include "lullaby/util/time.h"
+
+namespace lull {
+namespace tool {
+
+SystemProfilerWindow::SystemProfilerWindow(Registry* registry)
+    : registry_(registry) {}
+
+void SystemProfilerWindow::Open() { open_ = true; }
+
+void SystemProfilerWindow::Close() { open_ = false; }
+
+void SystemProfilerWindow::AdvanceFrame() {
+  auto* profiler = registry_->Get<SystemProfiler>();
+  if (!open_ || !profiler) {
+    return;
+  }
+
+  if (ImGui::Begin("Systems", &open_)) {
+    if (ImGui::Button("Reset")) {
+      profiler->Reset();
+    }
+
+    profiler->UpdateComponentStats();
+    const auto stats = profiler->GetAllStats();
+
+    ImGui::Columns(7, "SystemStats");
+    ImGui::Separator();
+    ImGui::Text("System");
+    ImGui::NextColumn();
+    ImGui::Text("Last (ms)");
+    ImGui::NextColumn();
+    ImGui::Text("Mean (ms)");
+    ImGui::NextColumn();
+    ImGui::Text("Max (ms)");
+    ImGui::NextColumn();
+    ImGui::Text("Allocs");
+    ImGui::NextColumn();
+    ImGui::Text("Components");
+    ImGui::NextColumn();
+    ImGui::Text("Memory (KB)");
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    for (const SystemProfiler::Stats& system : stats) {
+      const float mean_ms =
+          system.num_samples > 0
+              ? MillisecondsFromDuration(system.total_time) /
+                    static_cast<float>(system.num_samples)
+              : 0.f;
+      ImGui::Text("%s", system.name.c_str());
+      ImGui::NextColumn();
+      ImGui::Text("%.3f", MillisecondsFromDuration(system.last_time));
+      ImGui::NextColumn();
+      ImGui::Text("%.3f", mean_ms);
+      ImGui::NextColumn();
+      ImGui::Text("%.3f", MillisecondsFromDuration(system.max_time));
+      ImGui::NextColumn();
+      ImGui::Text("%zu", system.last_allocations);
+      ImGui::NextColumn();
+      ImGui::Text("%zu", system.num_components);
+      ImGui::NextColumn();
+      ImGui::Text("%.1f",
+                  static_cast<float>(system.component_memory_usage) / 1024.f);
+      ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+    ImGui::Separator();
+  }
+  ImGui::End();
+}
+
+}  // namespace tool
+}  // namespace lull
@@ -0,0 +1,45 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_VIEWER_SRC_WIDGETS_SYSTEM_PROFILER_WINDOW_H_
+#define LULLABY_VIEWER_SRC_WIDGETS_SYSTEM_PROFILER_WINDOW_H_
+
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace tool {
+
+// Displays the per-System frame time, allocations and Component memory
+// recorded by the SystemProfiler.
+class SystemProfilerWindow {
+ public:
+  explicit SystemProfilerWindow(Registry* registry);
+
+  void Open();
+  void Close();
+  void AdvanceFrame();
+
+ private:
+  Registry* registry_ = nullptr;
+  bool open_ = false;
+};
+
+}  // namespace tool
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::tool::SystemProfilerWindow);
+
+#endif  // LULLABY_VIEWER_SRC_WIDGETS_SYSTEM_PROFILER_WINDOW_H_
@@ -20,7 +20,42 @@ limitations under the License.
 
 namespace redux {
 
-static AnimationChannel ReadChannelAssetDef(const AnimChannelAssetDef* def) {
+// Returns the number of nodes in the spline of the channel `def`, or -1 if the
+// channel is not a spline.
+static int GetNumSplineNodes(const AnimChannelAssetDef* def) {
+  if (def->data_type() == AnimChannelDataAssetDef::AnimChannelSplineAssetDef) {
+    const auto* nodes = def->data_as_AnimChannelSplineAssetDef()->nodes();
+    return nodes ? static_cast<int>(nodes->size()) : 0;
+  } else if (def->data_type() ==
+             AnimChannelDataAssetDef::AnimChannelPackedSplineAssetDef) {
+    return def->data_as_AnimChannelPackedSplineAssetDef()->num_nodes();
+  }
+  return -1;
+}
+
+using SplineNodesAssetDef =
+    flatbuffers::Vector<const AnimSplineNodeAssetDef*>;
+
+// Creates a spline in `buffer` from the `num_nodes` nodes of `nodes` starting
+// at `first_node`. The spline is owned by the clip's spline buffer, so the
+// returned pointer does not delete it.
+static CompactSplinePtr CreateSpline(const SplineNodesAssetDef* nodes,
+                                     uint32_t first_node, int num_nodes,
+                                     const Interval& y_range,
+                                     float x_granularity, uint8_t* buffer) {
+  CompactSpline* spline = CompactSpline::CreateInPlace(
+      static_cast<CompactSplineIndex>(num_nodes), buffer);
+  spline->Init(y_range, x_granularity);
+  for (int i = 0; i < num_nodes; ++i) {
+    const AnimSplineNodeAssetDef* node = nodes->Get(first_node + i);
+    spline->AddNodeVerbatim(node->x(), node->y(), node->angle());
+  }
+  return CompactSplinePtr(spline, [](CompactSpline*) {});
+}
+
+static AnimationChannel ReadChannelAssetDef(const AnimAssetDef* anim_def,
+                                            const AnimChannelAssetDef* def,
+                                            uint8_t* buffer) {
   const AnimChannelType type = def->type();
 
   if (def->data_type() ==
@@ -32,16 +67,29 @@ static AnimationChannel ReadChannelAssetDef(const AnimChannelAssetDef* def) {
     const AnimChannelSplineAssetDef* spline_def =
         def->data_as_AnimChannelSplineAssetDef();
     CHECK(spline_def);
+    CHECK(spline_def->nodes());
 
-    const int num_nodes = spline_def->nodes()->size();
-    CompactSplinePtr spline = CompactSpline::Create(num_nodes);
     const Interval y_range(spline_def->y_range_start(),
                            spline_def->y_range_end());
-    spline->Init(y_range, spline_def->x_granularity());
-    for (int i = 0; i < num_nodes; ++i) {
-      const AnimSplineNodeAssetDef* node = spline_def->nodes()->Get(i);
-      spline->AddNodeVerbatim(node->x(), node->y(), node->angle());
-    }
+    CompactSplinePtr spline =
+        CreateSpline(spline_def->nodes(), 0, GetNumSplineNodes(def), y_range,
+                     spline_def->x_granularity(), buffer);
+    return AnimationChannel(type, std::move(spline));
+  } else if (def->data_type() ==
+             AnimChannelDataAssetDef::AnimChannelPackedSplineAssetDef) {
+    const AnimChannelPackedSplineAssetDef* spline_def =
+        def->data_as_AnimChannelPackedSplineAssetDef();
+    CHECK(spline_def);
+    CHECK(anim_def->spline_nodes());
+    CHECK(spline_def->first_node() + spline_def->num_nodes() <=
+          anim_def->spline_nodes()->size());
+
+    const Interval y_range(spline_def->y_range_start(),
+                           spline_def->y_range_end());
+    CompactSplinePtr spline =
+        CreateSpline(anim_def->spline_nodes(), spline_def->first_node(),
+                     spline_def->num_nodes(), y_range,
+                     anim_def->x_granularity(), buffer);
     return AnimationChannel(type, std::move(spline));
   } else {
     return AnimationChannel(type);
@@ -60,18 +108,46 @@ void AnimationClip::Initialize(DataContainer data) {
 
   def_ = flatbuffers::GetRoot<AnimAssetDef>(data_.GetBytes());
   if (def_->bone_anims()) {
+    // All the splines in the clip are created in a single buffer, rather than
+    // allocating each of them separately.
+    size_t num_spline_bytes = 0;
+    for (const BoneAnimAssetDef* bone_anim_def : *def_->bone_anims()) {
+      if (bone_anim_def->ops()) {
+        for (const AnimChannelAssetDef* def : *bone_anim_def->ops()) {
+          const int num_nodes = GetNumSplineNodes(def);
+          if (num_nodes >= 0) {
+            num_spline_bytes += CompactSpline::Size(
+                static_cast<CompactSplineIndex>(num_nodes));
+          }
+        }
+      }
+    }
+    spline_buffer_ = std::make_unique<uint8_t[]>(num_spline_bytes);
+
+    uint8_t* buffer = spline_buffer_.get();
     anims_.resize(def_->bone_anims()->size());
     for (std::size_t i = 0; i < def_->bone_anims()->size(); ++i) {
       const BoneAnimAssetDef* bone_anim_def = def_->bone_anims()->Get(i);
       if (bone_anim_def->ops()) {
+        anims_[i].reserve(bone_anim_def->ops()->size());
         for (std::size_t j = 0; j < bone_anim_def->ops()->size(); ++j) {
           const AnimChannelAssetDef* def = bone_anim_def->ops()->Get(j);
-          AnimationChannel channel = ReadChannelAssetDef(def);
+          AnimationChannel channel = ReadChannelAssetDef(def_, def, buffer);
+          if (channel.spline) {
+            buffer += CompactSpline::Size(channel.spline->max_nodes());
+          }
           anims_[i].push_back(std::move(channel));
         }
       }
     }
   }
+  if (def_->bone_names() && def_->bone_names()->size() == anims_.size()) {
+    bone_hashes_.reserve(def_->bone_names()->size());
+    for (const auto* name : *def_->bone_names()) {
+      const std::string_view bone_name(name->c_str(), name->size());
+      bone_hashes_.push_back(Hash(bone_name));
+    }
+  }
   repeat_ = def_->repeat();
   duration_ = absl::Seconds(def_->length_in_seconds());
 }
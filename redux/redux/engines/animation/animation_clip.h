@@ -25,6 +25,7 @@ limitations under the License.
 #include "redux/engines/animation/common.h"
 #include "redux/engines/animation/spline/compact_spline.h"
 #include "redux/modules/base/data_container.h"
+#include "redux/modules/base/hash.h"
 
 namespace redux {
 
@@ -85,6 +86,11 @@ class AnimationClip {
   // mesh or the animation is out of date.
   const char* BoneName(BoneIndex idx) const;
 
+  // Returns the hashes of the names of all the bones, or an empty span if the
+  // animation has no bone names. The hashes are computed when the animation is
+  // loaded so that they can be matched against a skeleton cheaply.
+  absl::Span<const HashValue> BoneNameHashes() const { return bone_hashes_; }
+
   // Returns an array of length NumBones() representing the bone heirarchy.
   // `bone_parents()[i]` is the bone index of the ith bone's parent.
   // `bone_parents()[i]` < `bone_parents()[j]` for all i < j.
@@ -94,7 +100,10 @@ class AnimationClip {
   void OnReady(const std::function<void()>& callback);
 
  private:
+  // Backing memory for the splines in `anims_`.
+  std::unique_ptr<uint8_t[]> spline_buffer_;
   std::vector<BoneAnimation> anims_;
+  std::vector<HashValue> bone_hashes_;
   std::vector<std::function<void()>> on_ready_callbacks_;
   DataContainer data_;
   const AnimAssetDef* def_ = nullptr;
@@ -73,7 +73,11 @@ void AnimationEngine::AdvanceFrame(absl::Duration delta_time) {
 AnimationClipPtr AnimationEngine::LoadAnimationClip(std::string_view uri) {
   const HashValue key = Hash(uri);
   AnimationClipPtr clip = animation_clips_.Find(key);
-  if (clip == nullptr) {
+  if (clip != nullptr) {
+    // The clip may have been unloaded while still in use, so take a reference
+    // to it again.
+    animation_clips_.Acquire(key);
+  } else {
     clip = std::make_shared<AnimationClip>();
     auto on_load = [=](AssetLoader::StatusOrData& asset) mutable {
       if (asset.ok()) {
@@ -95,6 +99,10 @@ AnimationClipPtr AnimationEngine::GetAnimationClip(HashValue key) {
   return animation_clips_.Find(key);
 }
 
+void AnimationEngine::UnloadAllAnimationClips() {
+  animation_clips_.ReleaseAll();
+}
+
 static StaticRegistry Static_Register(AnimationEngine::Create);
 
 }  // namespace redux
@@ -94,6 +94,11 @@ class AnimationEngine {
   // unloaded which happens when all references to this clip are released.
   AnimationClipPtr GetAnimationClip(HashValue key);
 
+  // Releases the engine's references to all loaded clips. Clips that are
+  // still in use stay alive and are shared with later loads of the same uri,
+  // the others are freed.
+  void UnloadAllAnimationClips();
+
  private:
   explicit AnimationEngine(Registry* registry) : registry_(registry) {}
 
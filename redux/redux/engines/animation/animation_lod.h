@@ -0,0 +1,41 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_ANIMATION_ANIMATION_LOD_H_
+#define REDUX_ENGINES_ANIMATION_ANIMATION_LOD_H_
+
+namespace redux {
+
+// Level-of-detail settings that reduce the cost of calculating a rig's pose,
+// for example when it is small on screen or not visible at all. The underlying
+// animations keep playing regardless, so the pose is correct as soon as the
+// level-of-detail is raised again.
+struct AnimationLod {
+  // The pose is recalculated once every `update_interval` frames.
+  int update_interval = 1;
+
+  // Bones deeper than this in the hierarchy (where root bones have a depth of
+  // 0) keep the local transform they had when they were last calculated, and
+  // simply follow their parent. A negative value calculates all bones.
+  int max_bone_depth = -1;
+
+  // If true, the pose is not recalculated at all.
+  bool frozen = false;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_ENGINES_ANIMATION_ANIMATION_LOD_H_
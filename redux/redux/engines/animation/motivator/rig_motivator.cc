@@ -33,6 +33,10 @@ void RigMotivator::SetRepeating(bool repeat) {
   Processor().SetRepeating(index_, repeat);
 }
 
+void RigMotivator::SetLod(const AnimationLod& lod) {
+  Processor().SetLod(index_, lod);
+}
+
 absl::Span<const mat4> RigMotivator::GlobalTransforms() const {
   return Processor().GlobalTransforms(index_);
 }
@@ -18,6 +18,7 @@ limitations under the License.
 #define REDUX_ENGINES_ANIMATION_MOTIVATOR_RIG_MOTIVATOR_H_
 
 #include "redux/engines/animation/animation_clip.h"
+#include "redux/engines/animation/animation_lod.h"
 #include "redux/engines/animation/animation_playback.h"
 #include "redux/engines/animation/motivator/motivator.h"
 #include "redux/modules/base/typeid.h"
@@ -49,6 +50,9 @@ class RigMotivator : public Motivator {
   // animation is done playing, then this call has no effect.
   void SetRepeating(bool repeat);
 
+  // Sets the level-of-detail used to calculate the GlobalTransforms().
+  void SetLod(const AnimationLod& lod);
+
   // Returns an array of matricies: one for each bone in the rig. The matrices
   // are all in the space of the root bone. That is, the bone hierarchy has been
   // flattened.
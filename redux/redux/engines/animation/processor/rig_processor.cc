@@ -20,9 +20,43 @@ limitations under the License.
 #include "redux/engines/animation/animation_clip.h"
 #include "redux/engines/animation/animation_engine.h"
 #include "redux/modules/base/logging.h"
+#include "vectorial/simd4f.h"
 
 namespace redux {
 
+// Sets `out` to `a * b`. Each column of the product is a sum of the columns of
+// `a` scaled by one element of `b`, so the whole multiply stays in four-wide
+// registers, unlike the row/column dot products of mat4's operator*.
+static inline void MultiplyMatrices(const mat4& a, const mat4& b, mat4* out) {
+  const simd4f a0 = simd4f_uload4(a.cols[0]);
+  const simd4f a1 = simd4f_uload4(a.cols[1]);
+  const simd4f a2 = simd4f_uload4(a.cols[2]);
+  const simd4f a3 = simd4f_uload4(a.cols[3]);
+  for (int cc = 0; cc < 4; ++cc) {
+    const float* b_col = b.cols[cc];
+    simd4f col = simd4f_mul(a0, simd4f_splat(b_col[0]));
+    col = simd4f_add(col, simd4f_mul(a1, simd4f_splat(b_col[1])));
+    col = simd4f_add(col, simd4f_mul(a2, simd4f_splat(b_col[2])));
+    col = simd4f_add(col, simd4f_mul(a3, simd4f_splat(b_col[3])));
+    simd4f_ustore4(col, out->cols[cc]);
+  }
+}
+
+// Composes `locals` into `globals` down the hierarchy described by `parents`,
+// where parents always come before their children.
+static void ComposeBoneTransforms(const BoneIndex* parents, const mat4* locals,
+                                  int num_bones, mat4* globals) {
+  for (int i = 0; i < num_bones; ++i) {
+    const BoneIndex parent_idx = parents[i];
+    if (parent_idx == kInvalidBoneIdx) {
+      globals[i] = locals[i];
+    } else {
+      CHECK_GT(i, parent_idx);
+      MultiplyMatrices(globals[parent_idx], locals[i], &globals[i]);
+    }
+  }
+}
+
 RigMotivator RigProcessor::AllocateMotivator(int dimensions) {
   RigMotivator motivator;
   const Motivator::Index index =
@@ -45,31 +79,50 @@ void RigProcessor::RigData::Reset() {
   animation = nullptr;
   end_time = absl::ZeroDuration();
   motivators.clear();
+  local_matrices.clear();
   global_transforms.clear();
+  lod = AnimationLod();
+  frames_until_update = 0;
+  needs_full_update = true;
+  bone_depths.clear();
 }
 
-// Traverse hierarchy, converting local transforms from `motivators_` into
-// global transforms. The `parents` are layed out such that the parent
-// always come before the child.
-// TODO OPT: optimize `parents` layout so that we can parallelize this call.
+// Gathers the local transforms from `motivators` into `local_matrices`, then
+// composes them into global transforms in a second pass over the contiguous
+// arrays.
 void RigProcessor::RigData::UpdateGlobalTransforms() {
+  if (animation == nullptr) {
+    return;
+  }
+  if (!needs_full_update) {
+    if (lod.frozen) {
+      return;
+    } else if (frames_until_update > 0) {
+      --frames_until_update;
+      return;
+    }
+    frames_until_update = lod.update_interval - 1;
+  }
+
   const absl::Span<const BoneIndex> parents = animation->BoneParents();
   const int num_bones = animation->NumBones();
+  const bool limit_depth = lod.max_bone_depth >= 0 && !needs_full_update;
   for (int i = 0; i < num_bones; ++i) {
-    const int parent_idx = parents[i];
+    // Bones beyond the maximum depth reuse their last local transform.
+    if (limit_depth && bone_depths[i] > lod.max_bone_depth) {
+      continue;
+    }
     const TransformMotivator& motivator = motivators[i];
     const Transform local_transform =
         motivator.Valid() ? motivator.Value() : Transform();
-
-    const mat4 local_matrix = TransformMatrix(local_transform);
-    if (parent_idx == kInvalidBoneIdx) {
-      global_transforms[i] = local_matrix;
-    } else {
-      CHECK_GT(i, parent_idx);
-      global_transforms[i] = global_transforms[parent_idx] * local_matrix;
-    }
+    local_matrices[i] = TransformMatrix(local_transform);
   }
 
+  ComposeBoneTransforms(parents.data(), local_matrices.data(), num_bones,
+                        global_transforms.data());
+
+  needs_full_update = false;
+
   // TODO: We should let go of the animation once we've reached the end and no
   // longer need to hold on to the splines.
 }
@@ -86,8 +139,22 @@ void RigProcessor::BlendToAnim(Motivator::Index index,
   const int num_bones = anim->NumBones();
 
   data.motivators.resize(num_bones);
+  data.local_matrices.resize(num_bones);
   data.global_transforms.resize(num_bones);
 
+  // Parents always come before their children, so a single pass calculates
+  // the depths.
+  const absl::Span<const BoneIndex> parents = anim->BoneParents();
+  data.bone_depths.resize(num_bones);
+  for (int i = 0; i < num_bones; ++i) {
+    const BoneIndex parent = parents[i];
+    data.bone_depths[i] = parent == kInvalidBoneIdx
+                              ? 0
+                              : static_cast<BoneIndex>(
+                                    data.bone_depths[parent] + 1);
+  }
+  data.needs_full_update = true;
+
   // Update the motivators to blend to our new values.
   for (BoneIndex i = 0; i < num_bones; ++i) {
     TransformMotivator& motivator = data.motivators[i];
@@ -113,6 +180,16 @@ void RigProcessor::SetRepeating(Motivator::Index index, bool repeat) {
   }
 }
 
+void RigProcessor::SetLod(Motivator::Index index, const AnimationLod& lod) {
+  CHECK_GE(lod.update_interval, 1);
+  RigData& data = Data(index);
+  data.lod = lod;
+  // Stagger the updates of rigs that share an interval so that they aren't all
+  // recalculated on the same frame.
+  data.frames_until_update = index % lod.update_interval;
+  data.needs_full_update = true;
+}
+
 const AnimationClipPtr& RigProcessor::CurrentAnimationClip(
     Motivator::Index index) const {
   return Data(index).animation;
@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "redux/engines/animation/animation_clip.h"
+#include "redux/engines/animation/animation_lod.h"
 #include "redux/engines/animation/common.h"
 #include "redux/engines/animation/motivator/rig_motivator.h"
 #include "redux/engines/animation/motivator/transform_motivator.h"
@@ -64,6 +65,9 @@ class RigProcessor : public AnimProcessor {
   // animations are running, has no effect.
   void SetRepeating(Motivator::Index index, bool repeat);
 
+  // Sets the level-of-detail used to calculate the GlobalTransforms().
+  void SetLod(Motivator::Index index, const AnimationLod& lod);
+
  private:
   struct RigData {
     RigData() = default;
@@ -78,8 +82,19 @@ class RigProcessor : public AnimProcessor {
     // Time that the animation is expected to complete.
     absl::Duration end_time = absl::ZeroDuration();
 
+    // Per-bone data is stored as separate arrays in the order of the bones of
+    // `animation`, in which parents always come before their children.
     std::vector<TransformMotivator> motivators;
+    std::vector<mat4> local_matrices;
     std::vector<mat4> global_transforms;
+
+    AnimationLod lod;
+    // Number of frames to skip before the pose is next recalculated.
+    int frames_until_update = 0;
+    // If true, the next update calculates every bone, regardless of `lod`.
+    bool needs_full_update = true;
+    // Depth of each bone in the hierarchy. Only used by `lod.max_bone_depth`.
+    std::vector<BoneIndex> bone_depths;
   };
 
   void SetNumIndices(Motivator::Index num_indices) override;
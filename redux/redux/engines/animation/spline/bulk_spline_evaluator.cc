@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "redux/engines/animation/spline/bulk_spline_evaluator.h"
 
+#include "redux/engines/animation/spline/bulk_spline_evaluator_x86.h"
+
 namespace redux {
 
 // These functions are implemented in assembly language.
@@ -45,6 +47,7 @@ void BulkSplineEvaluator::SetNumIndices(const Index num_indices) {
   cubics_.resize(num_indices);
   ys_.resize(num_indices, 0.0f);
   scratch_.resize(num_indices, 0);
+  masks_.resize(num_indices, 0);
 }
 
 void BulkSplineEvaluator::MoveIndices(const Index old_index,
@@ -219,6 +222,50 @@ void BulkSplineEvaluator::SetXs(const Index index, const Index count,
   }
 }
 
+bool BulkSplineEvaluator::SupportsOptimization(Optimization optimization) {
+  switch (optimization) {
+    case kNoOptimizations:
+      return true;
+    case kNeonOptimizations:
+#if defined(REDUX_ANIM_NEON)
+      return true;
+#else
+      return false;
+#endif
+    case kSse4Optimizations:
+#if REDUX_ANIM_X86
+      return CpuSupportsSse4();
+#else
+      return false;
+#endif
+    case kAvx2Optimizations:
+#if REDUX_ANIM_X86
+      return CpuSupportsAvx2();
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+BulkSplineEvaluator::Optimization BulkSplineEvaluator::BestOptimization() {
+  static const Optimization best = []() {
+    for (Optimization optimization :
+         {kAvx2Optimizations, kSse4Optimizations, kNeonOptimizations}) {
+      if (SupportsOptimization(optimization)) {
+        return optimization;
+      }
+    }
+    return kNoOptimizations;
+  }();
+  return best;
+}
+
+void BulkSplineEvaluator::SetOptimization(Optimization optimization) {
+  optimization_ =
+      SupportsOptimization(optimization) ? optimization : kNoOptimizations;
+}
+
 void BulkSplineEvaluator::SetPlaybackRates(const Index index, const Index count,
                                            float playback_rate) {
   for (Index i = index; i < index + count; ++i) {
@@ -265,11 +312,10 @@ static size_t ConvertMaskToIndices(const uint8_t* mask, size_t length,
 // since they have trouble converting masks into indices.
 size_t BulkSplineEvaluator::UpdateCubicXs_TwoSteps(const float delta_x,
                                                    Index* indices_to_init) {
-  // Use last half of 'indices_to_init' as a scratch buffer for 'mask'.
-  // Must be the last half since we read 'mask' to write 'indices_to_init'
-  // in ConvertMaskToIndices().
+  // The mask has its own buffer, since sharing 'indices_to_init' would let
+  // ConvertMaskToIndices() overwrite masks it has yet to read.
   const Index num_indices = NumIndices();
-  uint8_t* mask = reinterpret_cast<uint8_t*>(&indices_to_init[num_indices / 2]);
+  uint8_t* mask = masks_.data();
 
   // Add delta_x to each of the cubic_xs_.
   // Set mask[i] to 0xFF if the cubic has gone past the end of its array.
@@ -394,11 +440,29 @@ inline void BulkSplineEvaluator::UpdateCubicXsAndGetMask(const float delta_x,
   if (optimization_ == kNeonOptimizations) {
     UpdateCubicXsAndGetMask_Neon(delta_x, &cubic_x_ends_.front(), NumIndices(),
                                  &cubic_xs_.front(), masks);
-  } else
+    return;
+  }
 #endif
-  {
-    UpdateCubicXsAndGetMask_C(delta_x, masks);
+#if REDUX_ANIM_X86
+  if (optimization_ == kAvx2Optimizations ||
+      optimization_ == kSse4Optimizations) {
+    static_assert(sizeof(Source) % sizeof(float) == 0,
+                  "Rates must be addressable with a float stride.");
+    const float* rates = sources_.empty() ? nullptr : &sources_.front().rate;
+    const size_t rate_stride = sizeof(Source) / sizeof(float);
+    if (optimization_ == kAvx2Optimizations) {
+      UpdateCubicXsAndGetMask_Avx2(delta_x, rates, rate_stride,
+                                   cubic_x_ends_.data(), NumIndices(),
+                                   cubic_xs_.data(), masks);
+    } else {
+      UpdateCubicXsAndGetMask_Sse4(delta_x, rates, rate_stride,
+                                   cubic_x_ends_.data(), NumIndices(),
+                                   cubic_xs_.data(), masks);
+    }
+    return;
   }
+#endif
+  UpdateCubicXsAndGetMask_C(delta_x, masks);
 
 #endif  // not defined(REDUX_ANIM_ASSEMBLY_TEST)
 }
@@ -426,11 +490,12 @@ inline size_t BulkSplineEvaluator::UpdateCubicXs(const float delta_x,
 
 #else  // not defined(REDUX_ANIM_ASSEMBLY_TEST)
 
-#if defined(REDUX_ANIM_NEON)
-  return UpdateCubicXs_TwoSteps(delta_x, indices_to_init);
-#else
+  // The SIMD kernels can't easily emit indices as they go, so they produce a
+  // mask that is converted in a second pass.
+  if (optimization_ != kNoOptimizations) {
+    return UpdateCubicXs_TwoSteps(delta_x, indices_to_init);
+  }
   return UpdateCubicXs_OneStep(delta_x, indices_to_init);
-#endif
 
 #endif  // not defined(REDUX_ANIM_ASSEMBLY_TEST)
 }
@@ -454,11 +519,25 @@ inline void BulkSplineEvaluator::EvaluateCubics() {
 #else  // not defined(REDUX_ANIM_ASSEMBLY_TEST)
 
 #if defined(REDUX_ANIM_NEON)
-  EvaluateCubics_Neon(&cubics_.front(), &cubic_xs_.front(), &y_ranges_.front(),
-                      NumIndices(), &ys_.front());
-#else
-  EvaluateCubics_C();
+  if (optimization_ == kNeonOptimizations) {
+    EvaluateCubics_Neon(&cubics_.front(), &cubic_xs_.front(),
+                        &y_ranges_.front(), NumIndices(), &ys_.front());
+    return;
+  }
 #endif
+#if REDUX_ANIM_X86
+  if (optimization_ == kAvx2Optimizations) {
+    EvaluateCubics_Avx2(cubics_.data(), cubic_xs_.data(), NumIndices(),
+                        ys_.data());
+    return;
+  }
+  if (optimization_ == kSse4Optimizations) {
+    EvaluateCubics_Sse4(cubics_.data(), cubic_xs_.data(), NumIndices(),
+                        ys_.data());
+    return;
+  }
+#endif
+  EvaluateCubics_C();
 
 #endif  // not defined(REDUX_ANIM_ASSEMBLY_TEST)
 }
@@ -51,8 +51,29 @@ class BulkSplineEvaluator {
  public:
   using Index = int;
 
+  // Instruction sets that AdvanceFrame() can use to process many splines at
+  // once. By default, the fastest one supported by the CPU is used.
+  enum Optimization {
+    kNoOptimizations,
+    kNeonOptimizations,
+    kSse4Optimizations,
+    kAvx2Optimizations,
+  };
+
   BulkSplineEvaluator() = default;
 
+  // Returns true if this build and the CPU we're running on support
+  // `optimization`. kNoOptimizations is always supported.
+  static bool SupportsOptimization(Optimization optimization);
+
+  // Returns the fastest optimization that is supported.
+  static Optimization BestOptimization();
+
+  // Selects the kernels used by AdvanceFrame(). Falls back to the C kernels if
+  // `optimization` is not supported. Mostly useful for testing and profiling.
+  void SetOptimization(Optimization optimization);
+  Optimization GetOptimization() const { return optimization_; }
+
   // Return the number of indices currently allocated. Each index is one
   // spline that's being evaluated.
   Index NumIndices() const { return static_cast<Index>(sources_.size()); }
@@ -398,6 +419,11 @@ class BulkSplineEvaluator {
 
   // Stratch buffer used for internal calculations.
   std::vector<Index> scratch_;
+
+  // Stratch buffer for the masks calculated by UpdateCubicXs_TwoSteps().
+  std::vector<uint8_t> masks_;
+
+  Optimization optimization_ = BestOptimization();
 };
 
 }  // namespace redux
@@ -223,5 +223,85 @@ TEST(BulkSplineEvaluatorTests, YScaleAndOffset) {
   }
 }
 
+// Ensure the SIMD kernels agree with the C kernels. Uses a number of indices
+// that isn't a multiple of the SIMD width so the remainder loops are covered.
+TEST(BulkSplineEvaluatorTests, OptimizationsMatchC) {
+  static const int kNumIndices = 21;
+  static const int kNumFrames = 100;
+  static const float kRates[] = {1.0f, 0.5f, 2.0f, 0.0f, 1.3f};
+
+  CompactSpline splines[kNumSimpleSplines];
+  for (int i = 0; i < kNumSimpleSplines; ++i) {
+    const CubicInit& init = kSimpleSplines[i];
+    splines[i].Init(CubicInitYInterval(init, 0.1f),
+                    init.width_x * kXGranularityScale);
+    splines[i].AddNode(0.0f, init.start_y, init.start_derivative);
+    splines[i].AddNode(init.width_x * 0.5f, init.end_y, 0.0f);
+    splines[i].AddNode(init.width_x, init.start_y, init.end_derivative);
+  }
+
+  auto init_evaluator = [&](BulkSplineEvaluator* evaluator) {
+    evaluator->SetNumIndices(kNumIndices);
+    for (int i = 0; i < kNumIndices; ++i) {
+      SplinePlayback playback;
+      playback.playback_rate = kRates[i % ABSL_ARRAYSIZE(kRates)];
+      playback.y_scale = 1.0f + 0.1f * i;
+      playback.repeat = true;
+      evaluator->SetSplines(i, 1, &splines[i % kNumSimpleSplines], playback);
+    }
+  };
+
+  BulkSplineEvaluator::Optimization optimizations[] = {
+      BulkSplineEvaluator::kNeonOptimizations,
+      BulkSplineEvaluator::kSse4Optimizations,
+      BulkSplineEvaluator::kAvx2Optimizations,
+  };
+  for (BulkSplineEvaluator::Optimization optimization : optimizations) {
+    if (!BulkSplineEvaluator::SupportsOptimization(optimization)) {
+      continue;
+    }
+
+    BulkSplineEvaluator expected;
+    expected.SetOptimization(BulkSplineEvaluator::kNoOptimizations);
+    init_evaluator(&expected);
+
+    BulkSplineEvaluator actual;
+    actual.SetOptimization(optimization);
+    EXPECT_THAT(actual.GetOptimization(), Eq(optimization));
+    init_evaluator(&actual);
+
+    const float delta_x = kSimpleSplines[0].width_x / 17.0f;
+    for (int frame = 0; frame < kNumFrames; ++frame) {
+      expected.AdvanceFrame(delta_x);
+      actual.AdvanceFrame(delta_x);
+      for (int i = 0; i < kNumIndices; ++i) {
+        EXPECT_FLOAT_EQ(expected.X(i), actual.X(i));
+        EXPECT_FLOAT_EQ(expected.Y(i), actual.Y(i));
+      }
+    }
+  }
+}
+
+TEST(BulkSplineEvaluatorTests, UnsupportedOptimizationFallsBackToC) {
+  BulkSplineEvaluator evaluator;
+  EXPECT_TRUE(
+      BulkSplineEvaluator::SupportsOptimization(evaluator.GetOptimization()));
+  EXPECT_THAT(evaluator.GetOptimization(),
+              Eq(BulkSplineEvaluator::BestOptimization()));
+
+  for (BulkSplineEvaluator::Optimization optimization :
+       {BulkSplineEvaluator::kNeonOptimizations,
+        BulkSplineEvaluator::kSse4Optimizations,
+        BulkSplineEvaluator::kAvx2Optimizations}) {
+    evaluator.SetOptimization(optimization);
+    if (BulkSplineEvaluator::SupportsOptimization(optimization)) {
+      EXPECT_THAT(evaluator.GetOptimization(), Eq(optimization));
+    } else {
+      EXPECT_THAT(evaluator.GetOptimization(),
+                  Eq(BulkSplineEvaluator::kNoOptimizations));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace redux
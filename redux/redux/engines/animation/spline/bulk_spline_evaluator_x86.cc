@@ -0,0 +1,171 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// SSE4.1 and AVX2 versions of the BulkSplineEvaluator kernels. Each function
+// is compiled for its instruction set with a target attribute, so this file
+// does not need special compiler flags. BulkSplineEvaluator only calls them
+// after checking that the CPU supports the instruction set at runtime.
+//
+// The kernels perform the same operations, in the same order, as the C
+// versions, so they produce the same results.
+
+#include "redux/engines/animation/spline/bulk_spline_evaluator_x86.h"
+
+#if REDUX_ANIM_X86
+
+#include <immintrin.h>
+
+#include <cstring>
+
+namespace redux {
+
+static_assert(sizeof(CubicCurve) == CubicCurve::kNumCoeff * sizeof(float),
+              "Kernels assume CubicCurve is a packed array of coefficients.");
+
+__attribute__((target("sse4.1"))) void UpdateCubicXsAndGetMask_Sse4(
+    float delta_x, const float* rates, size_t rate_stride,
+    const float* x_ends, int num_xs, float* xs, uint8_t* masks) {
+  const __m128 delta = _mm_set1_ps(delta_x);
+  int i = 0;
+  for (; i + 4 <= num_xs; i += 4) {
+    const float* r = &rates[i * rate_stride];
+    const __m128 rate = _mm_setr_ps(r[0], r[rate_stride], r[2 * rate_stride],
+                                    r[3 * rate_stride]);
+    const __m128 x = _mm_add_ps(_mm_loadu_ps(&xs[i]), _mm_mul_ps(delta, rate));
+    _mm_storeu_ps(&xs[i], x);
+
+    // Narrow the 32-bit comparison results to one byte per x.
+    const __m128i mask32 =
+        _mm_castps_si128(_mm_cmpgt_ps(x, _mm_loadu_ps(&x_ends[i])));
+    const __m128i mask16 = _mm_packs_epi32(mask32, mask32);
+    const int mask8 = _mm_cvtsi128_si32(_mm_packs_epi16(mask16, mask16));
+    memcpy(&masks[i], &mask8, 4);
+  }
+  for (; i < num_xs; ++i) {
+    xs[i] += delta_x * rates[i * rate_stride];
+    masks[i] = xs[i] > x_ends[i] ? 0xFF : 0x00;
+  }
+}
+
+__attribute__((target("sse4.1"))) void EvaluateCubics_Sse4(
+    const CubicCurve* curves, const float* xs, int num_curves, float* ys) {
+  const float* c = reinterpret_cast<const float*>(curves);
+  int i = 0;
+  for (; i + 4 <= num_curves; i += 4) {
+    // Transpose four curves into one register per coefficient.
+    __m128 c0 = _mm_loadu_ps(&c[4 * i]);
+    __m128 c1 = _mm_loadu_ps(&c[4 * i + 4]);
+    __m128 c2 = _mm_loadu_ps(&c[4 * i + 8]);
+    __m128 c3 = _mm_loadu_ps(&c[4 * i + 12]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    const __m128 x = _mm_loadu_ps(&xs[i]);
+    __m128 y = _mm_add_ps(_mm_mul_ps(c3, x), c2);
+    y = _mm_add_ps(_mm_mul_ps(y, x), c1);
+    y = _mm_add_ps(_mm_mul_ps(y, x), c0);
+    _mm_storeu_ps(&ys[i], y);
+  }
+  for (; i < num_curves; ++i) {
+    ys[i] = curves[i].Evaluate(xs[i]);
+  }
+}
+
+__attribute__((target("avx2"))) static inline __m256 LoadCurvePair(
+    const float* lo, const float* hi) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)),
+                              _mm_loadu_ps(hi), 1);
+}
+
+__attribute__((target("avx2"))) void UpdateCubicXsAndGetMask_Avx2(
+    float delta_x, const float* rates, size_t rate_stride,
+    const float* x_ends, int num_xs, float* xs, uint8_t* masks) {
+  const __m256 delta = _mm256_set1_ps(delta_x);
+  const int stride = static_cast<int>(rate_stride);
+  const __m256i rate_offsets =
+      _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                         _mm256_set1_epi32(stride));
+  int i = 0;
+  for (; i + 8 <= num_xs; i += 8) {
+    const __m256 rate =
+        _mm256_i32gather_ps(&rates[i * rate_stride], rate_offsets, 4);
+    const __m256 x =
+        _mm256_add_ps(_mm256_loadu_ps(&xs[i]), _mm256_mul_ps(delta, rate));
+    _mm256_storeu_ps(&xs[i], x);
+
+    // Narrow the 32-bit comparison results to one byte per x.
+    const __m256i mask32 = _mm256_castps_si256(
+        _mm256_cmp_ps(x, _mm256_loadu_ps(&x_ends[i]), _CMP_GT_OQ));
+    const __m128i mask16 =
+        _mm_packs_epi32(_mm256_castsi256_si128(mask32),
+                        _mm256_extracti128_si256(mask32, 1));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&masks[i]),
+                     _mm_packs_epi16(mask16, mask16));
+  }
+  if (i < num_xs) {
+    UpdateCubicXsAndGetMask_Sse4(delta_x, &rates[i * rate_stride],
+                                 rate_stride, &x_ends[i], num_xs - i, &xs[i],
+                                 &masks[i]);
+  }
+}
+
+__attribute__((target("avx2"))) void EvaluateCubics_Avx2(
+    const CubicCurve* curves, const float* xs, int num_curves, float* ys) {
+  const float* c = reinterpret_cast<const float*>(curves);
+  int i = 0;
+  for (; i + 8 <= num_curves; i += 8) {
+    // Row k holds curve i+k in its low half and curve i+k+4 in its high half,
+    // so the in-lane transpose below gives one register per coefficient with
+    // the curves in order.
+    const float* lo = &c[4 * i];
+    const float* hi = &c[4 * i + 16];
+    const __m256 r0 = LoadCurvePair(&lo[0], &hi[0]);
+    const __m256 r1 = LoadCurvePair(&lo[4], &hi[4]);
+    const __m256 r2 = LoadCurvePair(&lo[8], &hi[8]);
+    const __m256 r3 = LoadCurvePair(&lo[12], &hi[12]);
+
+    const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    const __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+    const __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+    const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    const __m256 c0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 c1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 c2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 c3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+    const __m256 x = _mm256_loadu_ps(&xs[i]);
+    __m256 y = _mm256_add_ps(_mm256_mul_ps(c3, x), c2);
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), c1);
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), c0);
+    _mm256_storeu_ps(&ys[i], y);
+  }
+  if (i < num_curves) {
+    EvaluateCubics_Sse4(&curves[i], &xs[i], num_curves - i, &ys[i]);
+  }
+}
+
+bool CpuSupportsSse4() {
+  static const bool supported = __builtin_cpu_supports("sse4.1");
+  return supported;
+}
+
+bool CpuSupportsAvx2() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+}  // namespace redux
+
+#endif  // REDUX_ANIM_X86
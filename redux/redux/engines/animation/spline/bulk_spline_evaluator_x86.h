@@ -0,0 +1,61 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_ANIMATION_SPLINE_BULK_SPLINE_EVALUATOR_X86_H_
+#define REDUX_ENGINES_ANIMATION_SPLINE_BULK_SPLINE_EVALUATOR_X86_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "redux/engines/animation/spline/cubic_curve.h"
+
+// The x86 kernels rely on GCC/Clang target attributes and CPU detection.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define REDUX_ANIM_X86 1
+#else
+#define REDUX_ANIM_X86 0
+#endif
+
+#if REDUX_ANIM_X86
+
+namespace redux {
+
+// Returns true if the CPU we're running on supports the instruction set.
+bool CpuSupportsSse4();
+bool CpuSupportsAvx2();
+
+// For each i in [0, num_xs):
+//   xs[i] += delta_x * rates[i * rate_stride];
+//   masks[i] = xs[i] > x_ends[i] ? 0xFF : 0x00;
+void UpdateCubicXsAndGetMask_Sse4(float delta_x, const float* rates,
+                                  size_t rate_stride, const float* x_ends,
+                                  int num_xs, float* xs, uint8_t* masks);
+void UpdateCubicXsAndGetMask_Avx2(float delta_x, const float* rates,
+                                  size_t rate_stride, const float* x_ends,
+                                  int num_xs, float* xs, uint8_t* masks);
+
+// For each i in [0, num_curves):
+//   ys[i] = curves[i].Evaluate(xs[i]);
+void EvaluateCubics_Sse4(const CubicCurve* curves, const float* xs,
+                         int num_curves, float* ys);
+void EvaluateCubics_Avx2(const CubicCurve* curves, const float* xs,
+                         int num_curves, float* ys);
+
+}  // namespace redux
+
+#endif  // REDUX_ANIM_X86
+
+#endif  // REDUX_ENGINES_ANIMATION_SPLINE_BULK_SPLINE_EVALUATOR_X86_H_
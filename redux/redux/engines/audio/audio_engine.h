@@ -17,6 +17,8 @@ limitations under the License.
 #ifndef REDUX_ENGINES_AUDIO_AUDIO_ENGINE_H_
 #define REDUX_ENGINES_AUDIO_AUDIO_ENGINE_H_
 
+#include <cstddef>
+
 #include "redux/engines/audio/audio_asset.h"
 #include "redux/engines/audio/sound.h"
 #include "redux/engines/audio/sound_room.h"
@@ -75,6 +77,9 @@ class AudioEngine {
     SoundType type = SoundType::Stereo;
     float volume = 1.0f;
     bool looping = false;
+    // Sounds with a higher priority are given real voices first when more
+    // sounds are playing than SetMaxRealVoices allows.
+    int priority = 0;
   };
 
   // Starts playing a sound using the given `asset` and play `params`.
@@ -86,6 +91,17 @@ class AudioEngine {
   // Updates all the active sounds.
   void Update();
 
+  // Sets the maximum number of sounds that are decoded and spatialized at once.
+  // Additional playing sounds, chosen by lowest priority and then lowest
+  // audibility, are "virtualized": their playback position keeps advancing but
+  // they are silent and cost almost nothing. A virtual sound becomes real again
+  // as soon as it ranks within the budget.
+  void SetMaxRealVoices(std::size_t count);
+
+  // Sets the audibility (volume multiplied by distance attenuation) below which
+  // a playing sound is virtualized regardless of the voice budget.
+  void SetVirtualizationThreshold(float audibility);
+
   // Updates Audio rendering to simulate the listener being in an enclosed
   // space (i.e. a room).
   void EnableRoom(const SoundRoom& room, const vec3& position,
@@ -30,9 +30,18 @@ limitations under the License.
 
 namespace redux {
 
+// Default limit for the amount of decoded audio data kept in the cache.
+static constexpr size_t kDefaultPcmCacheLimit = 16 * 1024 * 1024;
+
+// Default decoded size at or below which streamed assets are loaded into memory
+// instead, roughly 1.4s of mono audio at 48kHz.
+static constexpr size_t kDefaultPromoteToMemoryLimit = 256 * 1024;
+
 AudioAssetManager::AudioAssetManager(Registry* registry, SpeakerProfile profile)
-    : registry_(registry), speaker_profile_(profile) {
-}
+    : registry_(registry),
+      speaker_profile_(profile),
+      pcm_cache_(kDefaultPcmCacheLimit),
+      promote_to_memory_limit_(kDefaultPromoteToMemoryLimit) {}
 
 AudioAssetPtr AudioAssetManager::CreateAudioAsset(
     std::string_view uri, AudioEngine::StreamingPolicy policy) {
@@ -56,12 +65,23 @@ AudioAsset::Id AudioAssetManager::LoadAudioAsset(
   asset_map_.insert(std::make_pair(id, asset));
   asset_uris_.insert(std::make_pair(id, std::string(uri)));
 
+  // The cached data has already been resampled to the device's sample rate, so
+  // it can be used without opening the asset at all.
+  const HashValue key = Hash(uri);
+  if (AudioPcmCache::DataPtr data = pcm_cache_.Find(key)) {
+    asset->SetAudioPlanarData(std::move(data));
+    return id;
+  }
+
   auto on_open = [=](AssetLoader::StatusOrReader& reader) {
     if (reader.ok()) {
-      std::unique_ptr<AudioReader> audio_reader = CreateReader(reader.value());
-      if (policy == AudioEngine::kPreloadIntoMemory) {
-        auto data =
+      std::unique_ptr<AudioReader> audio_reader =
+          CreateReader(key, reader.value());
+      if (policy == AudioEngine::kPreloadIntoMemory ||
+          (audio_reader && ShouldPromoteToMemory(*audio_reader))) {
+        AudioPcmCache::DataPtr data =
             AudioPlanarData::FromReader(*audio_reader, speaker_profile_);
+        pcm_cache_.Insert(key, data);
         asset->SetAudioPlanarData(std::move(data));
       } else {
         asset->SetAudioReader(std::move(audio_reader));
@@ -143,20 +163,68 @@ AudioAssetManager::CreateTemporaryAudioAsset(std::string_view uri) {
 
   const AudioAsset::Id new_asset_id = asset_id_counter_++;
   auto asset = std::make_shared<ResonanceAudioAsset>(new_asset_id);
-  asset->SetAudioReader(CreateReader(reader.value()));
+  asset->SetAudioReader(CreateReader(Hash(uri), reader.value()));
   CHECK(asset->IsValid()) << "Failed to acquire reader for AudioAssetStream.";
   return asset;
 }
 
+void AudioAssetManager::SetPcmCacheLimit(size_t num_bytes) {
+  pcm_cache_.SetMaxBytes(num_bytes);
+}
+
+void AudioAssetManager::SetPromoteToMemoryLimit(size_t num_bytes) {
+  promote_to_memory_limit_ = num_bytes;
+}
+
+bool AudioAssetManager::ShouldPromoteToMemory(const AudioReader& reader) const {
+  const uint64_t num_frames = reader.GetTotalFrameCount();
+  const int sample_rate_hz = reader.GetSampleRateHz();
+  if (num_frames == 0 || sample_rate_hz <= 0) {
+    // The size can't be determined up front.
+    return false;
+  }
+
+  // Account for resampling to the device's sample rate.
+  const double num_resampled_frames =
+      static_cast<double>(num_frames) *
+      static_cast<double>(speaker_profile_.sample_rate_hz) /
+      static_cast<double>(sample_rate_hz);
+  const double num_bytes = num_resampled_frames *
+                           static_cast<double>(reader.GetNumChannels()) *
+                           sizeof(float);
+  return num_bytes <= static_cast<double>(promote_to_memory_limit_.load());
+}
+
+std::shared_ptr<const OggSeekTable> AudioAssetManager::FindSeekTable(
+    HashValue key) const {
+  std::lock_guard<std::mutex> lock(seek_tables_mutex_);
+  const auto iter = seek_tables_.find(key);
+  return iter != seek_tables_.end() ? iter->second : nullptr;
+}
+
+void AudioAssetManager::CacheSeekTable(
+    HashValue key, std::shared_ptr<const OggSeekTable> seek_table) {
+  if (seek_table) {
+    std::lock_guard<std::mutex> lock(seek_tables_mutex_);
+    seek_tables_[key] = std::move(seek_table);
+  }
+}
+
 std::unique_ptr<AudioReader> AudioAssetManager::CreateReader(
-    DataReader& src) {
+    HashValue key, DataReader& src) {
   std::unique_ptr<AudioReader> reader;
   if (WavReader::CheckHeader(src)) {
     reader = std::make_unique<WavReader>(std::move(src));
   } else if (OpusReader::CheckHeader(src)) {
-    reader = std::make_unique<OpusReader>(std::move(src));
+    auto opus_reader =
+        std::make_unique<OpusReader>(std::move(src), FindSeekTable(key));
+    CacheSeekTable(key, opus_reader->GetSeekTable());
+    reader = std::move(opus_reader);
   } else if (VorbisReader::CheckHeader(src)) {
-    reader = std::make_unique<VorbisReader>(std::move(src));
+    auto vorbis_reader =
+        std::make_unique<VorbisReader>(std::move(src), FindSeekTable(key));
+    CacheSeekTable(key, vorbis_reader->GetSeekTable());
+    reader = std::move(vorbis_reader);
   }
   if (reader == nullptr) {
     LOG(ERROR) << "Unable to determine audio format.";
@@ -17,14 +17,18 @@ limitations under the License.
 #ifndef REDUX_ENGINES_AUDIO_RESONANCE_AUDIO_ASSET_MANAGER_H_
 #define REDUX_ENGINES_AUDIO_RESONANCE_AUDIO_ASSET_MANAGER_H_
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 #include "absl/container/flat_hash_map.h"
 #include "redux/engines/audio/audio_asset.h"
 #include "redux/engines/audio/audio_engine.h"
+#include "redux/engines/audio/resonance/audio_pcm_cache.h"
 #include "redux/engines/audio/resonance/resonance_audio_asset.h"
 #include "redux/engines/platform/device_profiles.h"
 #include "redux/modules/audio/audio_reader.h"
+#include "redux/modules/audio/ogg_seek_table.h"
 #include "redux/modules/base/data_reader.h"
 #include "redux/modules/base/registry.h"
 
@@ -32,6 +36,11 @@ namespace redux {
 
 // Provides methods for preloading and managing samples/sounds in memory and
 // creating asset handles.
+//
+// Decoded audio data is kept in an AudioPcmCache so that reloading a sound
+// (eg. a UI click played many times) doesn't decode it again. Assets that would
+// be streamed but are small enough are decoded into memory (and the cache)
+// instead, since streaming them costs more than it saves.
 class AudioAssetManager {
  public:
   AudioAssetManager(Registry* registry, SpeakerProfile profile);
@@ -58,6 +67,13 @@ class AudioAssetManager {
   std::shared_ptr<ResonanceAudioAsset> GetAssetForPlayback(
       AudioAsset::Id asset_id);
 
+  // Sets the maximum number of bytes of decoded audio data held by the cache.
+  void SetPcmCacheLimit(size_t num_bytes);
+
+  // Sets the decoded size, in bytes, at or below which assets are loaded into
+  // memory regardless of their StreamingPolicy. Zero disables promotion.
+  void SetPromoteToMemoryLimit(size_t num_bytes);
+
  private:
   AudioAsset::Id LoadAudioAsset(std::string_view uri,
                                   AudioEngine::StreamingPolicy policy);
@@ -67,7 +83,19 @@ class AudioAssetManager {
   std::shared_ptr<ResonanceAudioAsset> CreateTemporaryAudioAsset(
       std::string_view uri);
 
-  std::unique_ptr<AudioReader> CreateReader(DataReader& src);
+  // Creates a reader for the asset whose URI hashes to `key`.
+  std::unique_ptr<AudioReader> CreateReader(HashValue key, DataReader& src);
+
+  // Returns the cached seek table for the asset whose URI hashes to `key`.
+  std::shared_ptr<const OggSeekTable> FindSeekTable(HashValue key) const;
+
+  // Caches the `seek_table` of the asset whose URI hashes to `key`.
+  void CacheSeekTable(HashValue key,
+                      std::shared_ptr<const OggSeekTable> seek_table);
+
+  // Returns true if the audio from `reader` should be decoded into memory even
+  // though it was requested for streaming.
+  bool ShouldPromoteToMemory(const AudioReader& reader) const;
 
   Registry* registry_ = nullptr;
 
@@ -80,6 +108,18 @@ class AudioAssetManager {
   absl::flat_hash_map<AudioAsset::Id, std::string> asset_uris_;
   absl::flat_hash_map<AudioAsset::Id, std::shared_ptr<ResonanceAudioAsset>>
       asset_map_;
+
+  // Decoded audio data keyed by the hash of the URI. Accessed from both the
+  // main thread and the AssetLoader's threads.
+  AudioPcmCache pcm_cache_;
+  std::atomic<size_t> promote_to_memory_limit_;
+
+  // Seek tables of Ogg assets keyed by the hash of the URI, so that reopening
+  // an asset (eg. for another playback) doesn't scan the stream again. Accessed
+  // from both the main thread and the AssetLoader's threads.
+  mutable std::mutex seek_tables_mutex_;
+  absl::flat_hash_map<HashValue, std::shared_ptr<const OggSeekTable>>
+      seek_tables_;
 };
 
 }  // namespace redux
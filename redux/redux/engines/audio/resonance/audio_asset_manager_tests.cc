@@ -99,6 +99,9 @@ TEST_F(AudioAssetManagerTest, GetAssetForPlayback) {
 }
 
 TEST_F(AudioAssetManagerTest, GetAssetForPlaybackLocked) {
+  // Ensure the asset is actually streamed rather than loaded into memory.
+  audio_asset_manager_->SetPromoteToMemoryLimit(0);
+
   const std::string uri = ResolveTestFilePath(kDataPath, "speech.wav");
   const auto asset = audio_asset_manager_->CreateAudioAsset(
       uri, AudioEngine::kStreamIntoMemory);
@@ -108,5 +111,34 @@ TEST_F(AudioAssetManagerTest, GetAssetForPlaybackLocked) {
   EXPECT_THAT(asset1->GetId(), Ne(asset2->GetId()));
 }
 
+TEST_F(AudioAssetManagerTest, PromoteSmallAssetToMemory) {
+  // speech.wav is ~570KB once resampled to 48kHz.
+  audio_asset_manager_->SetPromoteToMemoryLimit(1024 * 1024);
+
+  const std::string uri = ResolveTestFilePath(kDataPath, "speech.wav");
+  const auto asset =
+      audio_asset_manager_->CreateAudioAsset(uri, AudioEngine::kStreamAndClose);
+  const auto playback_asset =
+      audio_asset_manager_->GetAssetForPlayback(asset->GetId());
+  EXPECT_THAT(playback_asset->GetPlanarData(), Ne(nullptr));
+}
+
+TEST_F(AudioAssetManagerTest, ReloadFromPcmCache) {
+  const std::string uri = ResolveTestFilePath(kDataPath, "speech.wav");
+  auto asset = audio_asset_manager_->CreateAudioAsset(
+      uri, AudioEngine::kPreloadIntoMemory);
+  const AudioPlanarData* data =
+      audio_asset_manager_->GetAssetForPlayback(asset->GetId())
+          ->GetPlanarData();
+  EXPECT_THAT(data, Ne(nullptr));
+
+  audio_asset_manager_->UnloadAudioAsset(Hash(uri));
+  asset = audio_asset_manager_->CreateAudioAsset(
+      uri, AudioEngine::kPreloadIntoMemory);
+  EXPECT_THAT(audio_asset_manager_->GetAssetForPlayback(asset->GetId())
+                  ->GetPlanarData(),
+              Eq(data));
+}
+
 }  // namespace
 }  // namespace redux
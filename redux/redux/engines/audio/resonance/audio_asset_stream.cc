@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "redux/engines/audio/resonance/audio_asset_stream.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "absl/functional/bind_front.h"
@@ -23,13 +24,25 @@ limitations under the License.
 
 namespace redux {
 
-// 64 buffers correspond to 0.5 and 1.3 seconds of audio for 512 and 1024
-// frames per buffer and a sample rate of 48000 Hz respectively.
-static const size_t kNumberFifoBuffers = 64;
+// Amount of decoded audio to keep stocked ahead of the playhead for streamed
+// assets. This must cover the worst-case scheduling latency of the streaming
+// thread, otherwise the stream will underrun.
+static constexpr float kPrestockLatencySeconds = 0.5f;
 
-// Number of available buffers in which indicates a "low water mark" signal for
-// the buffer stock to be refilled.
-static const size_t kRefillOnBufferCount = kNumberFifoBuffers;
+// Minimum number of stocked buffers, regardless of the buffer duration.
+static constexpr size_t kMinStockBuffers = 8;
+
+static size_t CalculateNumStockBuffers(size_t frames_per_buffer,
+                                       int sample_rate_hz) {
+  if (frames_per_buffer == 0) {
+    return kMinStockBuffers;
+  }
+  const float latency_frames =
+      kPrestockLatencySeconds * static_cast<float>(sample_rate_hz);
+  const size_t num_buffers = static_cast<size_t>(
+      std::ceil(latency_frames / static_cast<float>(frames_per_buffer)));
+  return std::max(num_buffers, kMinStockBuffers);
+}
 
 AudioAssetStream::AudioAssetStream(
     const std::shared_ptr<ResonanceAudioAsset>& asset,
@@ -39,13 +52,15 @@ AudioAssetStream::AudioAssetStream(
       end_of_stream_(false),
       playhead_position_(0),
       stream_started_(false),
+      skipping_(false),
       pending_seek_(false),
       pending_seek_position_(0),
       crossfade_size_frames_(0),
       channel_count_(0),
       frames_per_buffer_(speaker_profile.frames_per_buffer),
       system_sample_rate_hz_(speaker_profile.sample_rate_hz),
-      num_stock_fifo_buffers_to_fill_(kNumberFifoBuffers),
+      num_stock_fifo_buffers_to_fill_(CalculateNumStockBuffers(
+          speaker_profile.frames_per_buffer, speaker_profile.sample_rate_hz)),
       active_stock_buffer_(nullptr) {
   // Take over the asset's reader and the decoding process.
   reader_ = asset_->AcquireReader();
@@ -90,9 +105,18 @@ bool AudioAssetStream::Initialize() {
       return false;
     }
     total_frames_ = static_cast<size_t>(reader_->GetTotalFrameCount());
-    stock_fifo_ =
-        std::make_unique<AudioBufferFifo>(kNumberFifoBuffers, *output_buffer_);
     ConfigureResampler();
+
+    // A partitioner may emit several buffers per decoded buffer, so leave
+    // enough headroom above the fill target that it never overflows the ring.
+    size_t headroom = 0;
+    if (partitioner_ != nullptr) {
+      headroom = static_cast<size_t>(
+          std::ceil(static_cast<float>(resampler_output_->num_frames()) /
+                    static_cast<float>(frames_per_buffer_)));
+    }
+    stock_fifo_ = std::make_unique<AudioBufferFifo>(
+        num_stock_fifo_buffers_to_fill_ + headroom, *output_buffer_);
   }
 
   return true;
@@ -115,12 +139,6 @@ void AudioAssetStream::ConfigureResampler() {
   partitioner_ = std::make_unique<vraudio::BufferPartitioner>(
       channel_count_, frames_per_buffer_,
       absl::bind_front(&AudioAssetStream::PartitionedBufferCallback, this));
-
-  // Adjust the |stock_fifo_| fill to point so that buffer repartitioning
-  // will not cause |stock_fifo_| overflow.
-  num_stock_fifo_buffers_to_fill_ -= static_cast<size_t>(
-      std::ceil(static_cast<float>(max_resampled_frames_per_buffer) /
-                static_cast<float>(frames_per_buffer_)));
 }
 
 uint64_t AudioAssetStream::GetNumChannels() const { return channel_count_; }
@@ -211,6 +229,23 @@ bool AudioAssetStream::GetNextAudioBufferFromMemory(
 
 bool AudioAssetStream::GetNextAudioBufferFromPrestockQueue(
     const vraudio::AudioBuffer** output_buffer) {
+  if (skipping_.exchange(false)) {
+    // Resume decoding from the position we skipped to. Anything stocked in the
+    // meantime is stale, so report an (expected) underrun while the stock is
+    // rebuilt.
+    DiscardStock();
+    const double reader_frames_per_frame =
+        static_cast<double>(reader_->GetSampleRateHz()) /
+        static_cast<double>(system_sample_rate_hz_);
+    pending_seek_position_ = static_cast<size_t>(
+        static_cast<double>(playhead_position_.load()) *
+        reader_frames_per_frame);
+    pending_seek_ = true;
+    end_of_stream_ = false;
+    *output_buffer = nullptr;
+    return true;
+  }
+
   // Push the last buffer back into the fifo queue.
   if (active_stock_buffer_ != nullptr) {
     stock_fifo_->ReleaseOutputObject(active_stock_buffer_);
@@ -260,6 +295,67 @@ bool AudioAssetStream::GetNextAudioBufferFromPrestockQueue(
   return true;
 }
 
+bool AudioAssetStream::SkipNextAudioBuffer() {
+  if (asset_->GetStatus() == ResonanceAudioAsset::Status::kLoadedInMemory) {
+    return SkipNextAudioBufferInMemory();
+  }
+  if (planar_data_ != nullptr) {
+    // Streaming into memory requires every buffer to be decoded in order, so
+    // consume the buffer as usual and simply don't output it.
+    const vraudio::AudioBuffer* unused = nullptr;
+    return GetNextAudioBufferFromPrestockQueue(&unused);
+  }
+
+  skipping_ = true;
+  DiscardStock();
+
+  // Advance the playhead as if the buffer had been played, keeping it in the
+  // audio device's frame rate like GetNextAudioBufferFromPrestockQueue does.
+  const size_t total_frames = static_cast<size_t>(
+      static_cast<double>(total_frames_) *
+      static_cast<double>(system_sample_rate_hz_) /
+      static_cast<double>(reader_->GetSampleRateHz()));
+  size_t position = playhead_position_.load() + frames_per_buffer_;
+  if (position >= total_frames) {
+    if (!looping_enabled_.load() || total_frames == 0) {
+      end_of_stream_ = true;
+      return false;
+    }
+    position %= total_frames;
+  }
+  playhead_position_ = position;
+  return true;
+}
+
+bool AudioAssetStream::SkipNextAudioBufferInMemory() {
+  if (end_of_stream_.load()) {
+    return false;
+  }
+
+  const size_t total_frames = asset_->GetPlanarData()->GetFrameCount();
+  size_t position = playhead_position_.load() + frames_per_buffer_;
+  if (position >= total_frames) {
+    if (!looping_enabled_.load() || total_frames == 0) {
+      end_of_stream_ = true;
+      return false;
+    }
+    position %= total_frames;
+  }
+  playhead_position_ = position;
+  return true;
+}
+
+void AudioAssetStream::DiscardStock() {
+  if (active_stock_buffer_ != nullptr) {
+    stock_fifo_->ReleaseOutputObject(active_stock_buffer_);
+    active_stock_buffer_ = nullptr;
+  }
+  while (const vraudio::AudioBuffer* buffer =
+             stock_fifo_->AcquireOutputObject()) {
+    stock_fifo_->ReleaseOutputObject(buffer);
+  }
+}
+
 bool AudioAssetStream::IsPrestockServiceNeeded() const {
   if (asset_->GetStatus() == ResonanceAudioAsset::Status::kLoadedInMemory) {
     // Do not prestock buffers if asset is in memory.
@@ -268,8 +364,13 @@ bool AudioAssetStream::IsPrestockServiceNeeded() const {
   if (end_of_stream_.load()) {
     return false;
   }
+  if (skipping_.load()) {
+    // Decoding resumes once the stream is played again.
+    return false;
+  }
 
-  return pending_seek_.load() || stock_fifo_->Size() < kRefillOnBufferCount;
+  return pending_seek_.load() ||
+         stock_fifo_->Size() < num_stock_fifo_buffers_to_fill_;
 }
 
 void AudioAssetStream::ServicePrestock() {
@@ -22,13 +22,13 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "redux/engines/audio/resonance/audio_ring_buffer.h"
 #include "redux/engines/audio/resonance/audio_source_stream.h"
 #include "redux/engines/audio/resonance/resonance_audio_asset.h"
 #include "redux/modules/audio/audio_reader.h"
 #include "resonance_audio/base/audio_buffer.h"
 #include "resonance_audio/dsp/resampler.h"
 #include "resonance_audio/utils/buffer_partitioner.h"
-#include "resonance_audio/utils/threadsafe_fifo.h"
 
 namespace redux {
 
@@ -43,12 +43,13 @@ namespace redux {
 //
 // The more complicated case is when the AudioAsset is only able to stream data
 // using an AudioReader. In this case, we try to asynchronously read and decode
-// the audio stream and store a "stock" of audio buffers into a thread-safe
-// FIFO queue. Then, when we get a request for data, we can return the next
-// buffer from the queue.
+// the audio stream and store a "stock" of audio buffers into a lock-free ring
+// buffer. Then, when we get a request for data, we can return the next buffer
+// from the ring without blocking or decoding on the audio thread.
 //
 // Managing this stock of buffers requires coordination with the streaming
-// thread managed by the AudioStreamManager.
+// thread managed by the AudioStreamManager, which is the ring's only producer;
+// the audio thread is its only consumer.
 class AudioAssetStream : public AudioSourceStream {
  public:
   // Creates the AudioSourceStream around the AudioAsset. The audio will be
@@ -75,6 +76,14 @@ class AudioAssetStream : public AudioSourceStream {
   bool GetNextAudioBuffer(
       const vraudio::AudioBuffer** output_buffer) override;
 
+  // Advances the audio stream by one buffer without producing any audio. For
+  // streamed assets, this discards any stocked buffers and suspends decoding
+  // until GetNextAudioBuffer is called again, at which point the stream seeks
+  // to the skipped-to position.
+  //
+  // Should be called only from the audio thread.
+  bool SkipNextAudioBuffer() override;
+
   // Queries whether the asynchronously decoded stock of audio buffers needs to
   // be refilled. Should be called only from the audio thread.
   bool IsPrestockServiceNeeded() const override;
@@ -119,6 +128,14 @@ class AudioAssetStream : public AudioSourceStream {
   bool GetNextAudioBufferFromPrestockQueue(
       const vraudio::AudioBuffer** output_buffer);
 
+  // Helper for `SkipNextAudioBuffer` that advances the playhead of an asset
+  // whose data is in memory.
+  bool SkipNextAudioBufferInMemory();
+
+  // Releases all stocked buffers, including the active one. Should be called
+  // only from the audio thread.
+  void DiscardStock();
+
   // Reads an audio buffer from the asset reader and pushes it into the prestock
   // queue.
   bool StockNextBufferFromReader();
@@ -139,9 +156,10 @@ class AudioAssetStream : public AudioSourceStream {
   // This is only used if the asset was configured for streaming into memory.
   std::unique_ptr<AudioPlanarData> planar_data_;
 
-  // A threadsafe FIFO queue that stores audio buffers that can be consumed by
-  // calls to GetNextAudioBuffer.
-  using AudioBufferFifo = vraudio::ThreadsafeFifo<vraudio::AudioBuffer>;
+  // A single-producer, single-consumer ring that stores audio buffers that can
+  // be consumed by calls to GetNextAudioBuffer. It is sized to hold enough
+  // audio to cover kPrestockLatencySeconds (see the .cc file).
+  using AudioBufferFifo = AudioRingBuffer<vraudio::AudioBuffer>;
   std::unique_ptr<AudioBufferFifo> stock_fifo_;
 
   // Flag indicating looped playback.
@@ -160,6 +178,10 @@ class AudioAssetStream : public AudioSourceStream {
   // produced by this |AudioAssetStream|.
   std::atomic<bool> stream_started_;
 
+  // Indicates that the stream is being skipped rather than played, in which
+  // case decoding is suspended.
+  std::atomic<bool> skipping_;
+
   // Indicates that an asynchronous seek to frame position is pending.
   std::atomic<bool> pending_seek_;
 
@@ -183,7 +205,7 @@ class AudioAssetStream : public AudioSourceStream {
   size_t total_frames_;
 
   // The number of |stock_fifo_| buffers that the |ServicePrestock| routine
-  // should try to fill. This number will be smaller than |kNumberFifoBuffers|
+  // should try to fill. The |stock_fifo_| has additional capacity beyond this
   // where a |partitioner_| is used.
   size_t num_stock_fifo_buffers_to_fill_;
 
@@ -230,6 +230,74 @@ TEST(AudioAssetStreamTest, SeekMemory) {
   EXPECT_THAT(frames_read + skipped_frames, Eq(expected_frames));
 }
 
+TEST(AudioAssetStreamTest, SkipMemory) {
+  auto reader = CreateWavReader("speech.wav");
+  auto profile = InitSpeakerProfile(reader.get());
+
+  const uint64_t total_frames = reader->GetTotalFrameCount();
+  const uint64_t expected_frames = RoundToFullFrames(total_frames, profile);
+
+  auto asset = std::make_shared<ResonanceAudioAsset>(1);
+  auto stream = CreateAudioAssetStreamFromMemory(std::move(reader), asset);
+
+  const uint64_t num_skips = 10;
+  for (uint64_t i = 0; i < num_skips; ++i) {
+    EXPECT_TRUE(stream->SkipNextAudioBuffer());
+  }
+
+  vraudio::AudioBuffer buffer(profile.num_channels, profile.frames_per_buffer);
+  uint64_t frames_read = 0;
+  while (true) {
+    const vraudio::AudioBuffer* ptr = &buffer;
+    if (stream->GetNextAudioBuffer(&ptr)) {
+      frames_read += ptr->num_frames();
+    } else {
+      break;
+    }
+  }
+
+  EXPECT_THAT(frames_read + num_skips * profile.frames_per_buffer,
+              Eq(expected_frames));
+}
+
+TEST(AudioAssetStreamTest, SkipStreaming) {
+  auto reader = CreateWavReader("speech.wav");
+  auto profile = InitSpeakerProfile(reader.get());
+
+  const uint64_t total_frames = reader->GetTotalFrameCount();
+  const uint64_t expected_frames = RoundToFullFrames(total_frames, profile);
+
+  auto asset = std::make_shared<ResonanceAudioAsset>(1);
+  auto stream = CreateAudioAssetStreamForStreaming(std::move(reader), asset);
+
+  const uint64_t num_skips = 10;
+  for (uint64_t i = 0; i < num_skips; ++i) {
+    EXPECT_TRUE(stream->SkipNextAudioBuffer());
+  }
+  // Nothing is decoded while skipping.
+  EXPECT_FALSE(stream->IsPrestockServiceNeeded());
+
+  vraudio::AudioBuffer buffer(profile.num_channels, profile.frames_per_buffer);
+  uint64_t frames_read = 0;
+  while (true) {
+    while (stream->IsPrestockServiceNeeded()) {
+      stream->ServicePrestock();
+    }
+
+    const vraudio::AudioBuffer* ptr = &buffer;
+    if (stream->GetNextAudioBuffer(&ptr)) {
+      if (ptr != nullptr) {
+        frames_read += ptr->num_frames();
+      }
+    } else {
+      break;
+    }
+  }
+
+  EXPECT_THAT(frames_read + num_skips * profile.frames_per_buffer,
+              Eq(expected_frames));
+}
+
 TEST(AudioAssetStreamTest, SeekFailsForStreamIntoMemory) {
   auto reader = CreateWavReader("speech.wav");
   auto asset = std::make_shared<ResonanceAudioAsset>(1, true);
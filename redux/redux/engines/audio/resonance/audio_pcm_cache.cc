@@ -0,0 +1,94 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/audio/resonance/audio_pcm_cache.h"
+
+#include <utility>
+
+namespace redux {
+
+AudioPcmCache::AudioPcmCache(std::size_t max_bytes) : max_bytes_(max_bytes) {}
+
+AudioPcmCache::DataPtr AudioPcmCache::Find(HashValue key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = lookup_.find(key);
+  if (iter == lookup_.end()) {
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, iter->second);
+  return iter->second->data;
+}
+
+void AudioPcmCache::Insert(HashValue key, DataPtr data) {
+  if (data == nullptr) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = lookup_.find(key);
+  if (iter != lookup_.end()) {
+    num_bytes_ -= iter->second->num_bytes;
+    entries_.erase(iter->second);
+    lookup_.erase(iter);
+  }
+
+  const std::size_t num_bytes = GetNumBytes(*data);
+  if (num_bytes > max_bytes_) {
+    return;
+  }
+
+  entries_.push_front(Entry{key, std::move(data), num_bytes});
+  lookup_[key] = entries_.begin();
+  num_bytes_ += num_bytes;
+  EvictLocked();
+}
+
+void AudioPcmCache::Erase(HashValue key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = lookup_.find(key);
+  if (iter != lookup_.end()) {
+    num_bytes_ -= iter->second->num_bytes;
+    entries_.erase(iter->second);
+    lookup_.erase(iter);
+  }
+}
+
+void AudioPcmCache::SetMaxBytes(std::size_t max_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_bytes_ = max_bytes;
+  EvictLocked();
+}
+
+std::size_t AudioPcmCache::GetNumBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_bytes_;
+}
+
+std::size_t AudioPcmCache::GetNumBytes(const AudioPlanarData& data) {
+  return static_cast<std::size_t>(data.GetFrameCount() *
+                                  data.GetNumChannels() * sizeof(float));
+}
+
+void AudioPcmCache::EvictLocked() {
+  while (num_bytes_ > max_bytes_ && !entries_.empty()) {
+    const Entry& entry = entries_.back();
+    num_bytes_ -= entry.num_bytes;
+    lookup_.erase(entry.key);
+    entries_.pop_back();
+  }
+}
+
+}  // namespace redux
@@ -0,0 +1,92 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_AUDIO_RESONANCE_AUDIO_PCM_CACHE_H_
+#define REDUX_ENGINES_AUDIO_RESONANCE_AUDIO_PCM_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include "absl/container/flat_hash_map.h"
+#include "redux/engines/audio/resonance/audio_planar_data.h"
+#include "redux/modules/base/hash.h"
+
+namespace redux {
+
+// Cache of decoded (and resampled to the audio device's sample rate) audio data
+// so that frequently played sounds don't need to be decoded or resampled each
+// time they are loaded.
+//
+// The cache holds at most a fixed number of bytes of audio data. When full,
+// the least recently used data is evicted. Evicting data only releases the
+// cache's reference to it; assets that are still using the data keep it alive.
+//
+// All functions are thread-safe.
+class AudioPcmCache {
+ public:
+  using DataPtr = std::shared_ptr<const AudioPlanarData>;
+
+  explicit AudioPcmCache(std::size_t max_bytes);
+
+  AudioPcmCache(const AudioPcmCache&) = delete;
+  AudioPcmCache& operator=(const AudioPcmCache&) = delete;
+
+  // Returns the data associated with `key`, marking it as the most recently
+  // used, or nullptr if there is no such data.
+  DataPtr Find(HashValue key);
+
+  // Associates `data` with `key`, replacing any existing data, and evicts the
+  // least recently used data until the cache is within its size limit. Data
+  // that is by itself larger than the limit is not cached.
+  void Insert(HashValue key, DataPtr data);
+
+  // Removes the data associated with `key`.
+  void Erase(HashValue key);
+
+  // Sets the maximum number of bytes of audio data to hold, evicting data as
+  // needed.
+  void SetMaxBytes(std::size_t max_bytes);
+
+  // Returns the number of bytes of audio data currently held.
+  std::size_t GetNumBytes() const;
+
+  // Returns the number of bytes used by the samples of `data`.
+  static std::size_t GetNumBytes(const AudioPlanarData& data);
+
+ private:
+  struct Entry {
+    HashValue key;
+    DataPtr data;
+    std::size_t num_bytes = 0;
+  };
+  using EntryList = std::list<Entry>;
+
+  void EvictLocked();
+
+  mutable std::mutex mutex_;
+  std::size_t max_bytes_ = 0;
+  std::size_t num_bytes_ = 0;
+
+  // Entries ordered from most to least recently used.
+  EntryList entries_;
+  absl::flat_hash_map<HashValue, EntryList::iterator> lookup_;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_ENGINES_AUDIO_RESONANCE_AUDIO_PCM_CACHE_H_
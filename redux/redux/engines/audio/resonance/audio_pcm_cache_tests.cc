@@ -0,0 +1,101 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/engines/audio/resonance/audio_pcm_cache.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::NotNull;
+
+// Creates mono audio data that takes up `num_frames * sizeof(float)` bytes.
+static AudioPcmCache::DataPtr CreateData(size_t num_frames) {
+  vraudio::AudioBuffer source(1, num_frames);
+  source.Clear();
+  auto data = std::make_shared<AudioPlanarData>(1);
+  data->AppendData(source);
+  return data;
+}
+
+TEST(AudioPcmCacheTest, InsertAndFind) {
+  AudioPcmCache cache(1024);
+  auto data = CreateData(16);
+  cache.Insert(ConstHash("a"), data);
+  EXPECT_THAT(cache.Find(ConstHash("a")), Eq(data));
+  EXPECT_THAT(cache.Find(ConstHash("b")), IsNull());
+  EXPECT_THAT(cache.GetNumBytes(), Eq(16 * sizeof(float)));
+
+  cache.Erase(ConstHash("a"));
+  EXPECT_THAT(cache.Find(ConstHash("a")), IsNull());
+  EXPECT_THAT(cache.GetNumBytes(), Eq(0));
+}
+
+TEST(AudioPcmCacheTest, EvictLeastRecentlyUsed) {
+  AudioPcmCache cache(3 * 16 * sizeof(float));
+  cache.Insert(ConstHash("a"), CreateData(16));
+  cache.Insert(ConstHash("b"), CreateData(16));
+  cache.Insert(ConstHash("c"), CreateData(16));
+
+  // Touch "a" so that "b" becomes the least recently used.
+  EXPECT_THAT(cache.Find(ConstHash("a")), NotNull());
+  cache.Insert(ConstHash("d"), CreateData(16));
+
+  EXPECT_THAT(cache.Find(ConstHash("a")), NotNull());
+  EXPECT_THAT(cache.Find(ConstHash("b")), IsNull());
+  EXPECT_THAT(cache.Find(ConstHash("c")), NotNull());
+  EXPECT_THAT(cache.Find(ConstHash("d")), NotNull());
+  EXPECT_THAT(cache.GetNumBytes(), Eq(3 * 16 * sizeof(float)));
+}
+
+TEST(AudioPcmCacheTest, EvictionKeepsDataAlive) {
+  AudioPcmCache cache(16 * sizeof(float));
+  auto data = CreateData(16);
+  cache.Insert(ConstHash("a"), data);
+  cache.Insert(ConstHash("b"), CreateData(16));
+
+  EXPECT_THAT(cache.Find(ConstHash("a")), IsNull());
+  EXPECT_THAT(data->GetFrameCount(), Eq(16));
+}
+
+TEST(AudioPcmCacheTest, TooLarge) {
+  AudioPcmCache cache(16 * sizeof(float));
+  cache.Insert(ConstHash("a"), CreateData(8));
+  cache.Insert(ConstHash("b"), CreateData(32));
+
+  EXPECT_THAT(cache.Find(ConstHash("a")), NotNull());
+  EXPECT_THAT(cache.Find(ConstHash("b")), IsNull());
+}
+
+TEST(AudioPcmCacheTest, SetMaxBytes) {
+  AudioPcmCache cache(1024);
+  cache.Insert(ConstHash("a"), CreateData(16));
+  cache.Insert(ConstHash("b"), CreateData(16));
+
+  cache.SetMaxBytes(16 * sizeof(float));
+  EXPECT_THAT(cache.Find(ConstHash("a")), IsNull());
+  EXPECT_THAT(cache.Find(ConstHash("b")), NotNull());
+
+  cache.SetMaxBytes(0);
+  EXPECT_THAT(cache.Find(ConstHash("b")), IsNull());
+  EXPECT_THAT(cache.GetNumBytes(), Eq(0));
+}
+
+}  // namespace
+}  // namespace redux
@@ -16,9 +16,10 @@ limitations under the License.
 
 #include "redux/engines/audio/resonance/audio_planar_data.h"
 
+#include "absl/container/inlined_vector.h"
 #include "redux/modules/audio/audio_reader.h"
+#include "redux/modules/audio/sample_conversion.h"
 #include "resonance_audio/dsp/resampler.h"
-#include "resonance_audio/utils/planar_interleaved_conversion.h"
 
 namespace redux {
 
@@ -124,15 +125,22 @@ size_t AudioPlanarData::ReadNextAudioBufferFromReader(
   const absl::Span<const std::byte> bytes =
       reader->ReadFrames(buffer->num_frames());
   const size_t num_frames = bytes.size() / reader->GetNumBytesPerFrame();
-  const int num_channels = reader->GetNumChannels();
+  const size_t num_channels = reader->GetNumChannels();
+  CHECK_EQ(num_channels, buffer->num_channels());
+  CHECK_LE(num_frames, buffer->num_frames());
+
+  absl::InlinedVector<float*, 16> channels(num_channels);
+  for (size_t i = 0; i < num_channels; ++i) {
+    channels[i] = (*buffer)[i].begin();
+  }
 
   const auto format = reader->GetEncodingFormat();
   if (format == AudioReader::kFloat) {
     const float* data = reinterpret_cast<const float*>(bytes.data());
-    vraudio::FillAudioBuffer(data, num_frames, num_channels, buffer);
+    DeinterleaveToFloat(data, num_frames, channels);
   } else if (format == AudioReader::kInt16) {
     const int16_t* data = reinterpret_cast<const int16_t*>(bytes.data());
-    vraudio::FillAudioBuffer(data, num_frames, num_channels, buffer);
+    DeinterleaveToFloat(data, num_frames, channels);
   }
   return num_frames;
 }
@@ -0,0 +1,117 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_AUDIO_RESONANCE_AUDIO_RING_BUFFER_H_
+#define REDUX_ENGINES_AUDIO_RESONANCE_AUDIO_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "redux/modules/base/logging.h"
+
+namespace redux {
+
+// Fixed-capacity, lock-free ring of preallocated objects shared between exactly
+// one producer thread and one consumer thread.
+//
+// Objects are accessed in-place rather than being copied in and out: the
+// producer acquires the next free slot, fills it, and releases it to make it
+// visible to the consumer; the consumer acquires the oldest filled slot, reads
+// it, and releases it to return it to the producer. None of these operations
+// allocate, lock, or block, making the consumer side safe to use from an audio
+// render callback.
+//
+// The interface mirrors vraudio::ThreadsafeFifo so that either can be used by
+// the same code.
+template <typename T>
+class AudioRingBuffer {
+ public:
+  // Creates a ring with `capacity` slots, each initialized to a copy of
+  // `init`.
+  AudioRingBuffer(std::size_t capacity, const T& init)
+      : slots_(capacity, init) {
+    CHECK_GT(capacity, 0);
+  }
+
+  AudioRingBuffer(const AudioRingBuffer&) = delete;
+  AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+  // Returns the next free slot, or nullptr if the ring is full. Producer only.
+  T* AcquireInputObject() {
+    const std::size_t write = write_.load(std::memory_order_relaxed);
+    const std::size_t read = read_.load(std::memory_order_acquire);
+    if (write - read >= slots_.size()) {
+      return nullptr;
+    }
+    return &slots_[write % slots_.size()];
+  }
+
+  // Makes the slot returned by AcquireInputObject available to the consumer.
+  // Producer only.
+  void ReleaseInputObject(const T* object) {
+    const std::size_t write = write_.load(std::memory_order_relaxed);
+    DCHECK_EQ(object, &slots_[write % slots_.size()]);
+    write_.store(write + 1, std::memory_order_release);
+  }
+
+  // Returns the oldest filled slot, or nullptr if the ring is empty. Consumer
+  // only.
+  T* AcquireOutputObject() {
+    const std::size_t read = read_.load(std::memory_order_relaxed);
+    const std::size_t write = write_.load(std::memory_order_acquire);
+    if (read == write) {
+      return nullptr;
+    }
+    return &slots_[read % slots_.size()];
+  }
+
+  // Returns the slot returned by AcquireOutputObject to the producer. Consumer
+  // only.
+  void ReleaseOutputObject(const T* object) {
+    const std::size_t read = read_.load(std::memory_order_relaxed);
+    DCHECK_EQ(object, &slots_[read % slots_.size()]);
+    read_.store(read + 1, std::memory_order_release);
+  }
+
+  // Returns the number of filled slots, including one that has been acquired
+  // but not yet released by the consumer. Safe to call from either thread,
+  // though the result may be stale by the time it is used.
+  std::size_t Size() const {
+    const std::size_t read = read_.load(std::memory_order_acquire);
+    const std::size_t write = write_.load(std::memory_order_acquire);
+    return write - read;
+  }
+
+  // Returns the total number of slots.
+  std::size_t Capacity() const { return slots_.size(); }
+
+  bool Empty() const { return Size() == 0; }
+
+  bool Full() const { return Size() >= slots_.size(); }
+
+ private:
+  std::vector<T> slots_;
+
+  // Monotonic counts of released input and output slots. They are kept on
+  // separate cache lines so that the producer and consumer do not contend.
+  alignas(64) std::atomic<std::size_t> write_{0};
+  alignas(64) std::atomic<std::size_t> read_{0};
+};
+
+}  // namespace redux
+
+#endif  // REDUX_ENGINES_AUDIO_RESONANCE_AUDIO_RING_BUFFER_H_
@@ -0,0 +1,101 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/audio/resonance/audio_ring_buffer.h"
+
+#include <thread>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+
+TEST(AudioRingBufferTest, FillAndDrain) {
+  AudioRingBuffer<int> ring(4, 0);
+  EXPECT_TRUE(ring.Empty());
+  EXPECT_THAT(ring.Capacity(), Eq(4));
+  EXPECT_THAT(ring.AcquireOutputObject(), Eq(nullptr));
+
+  for (int i = 0; i < 4; ++i) {
+    int* slot = ring.AcquireInputObject();
+    ASSERT_NE(slot, nullptr);
+    *slot = i;
+    ring.ReleaseInputObject(slot);
+  }
+  EXPECT_TRUE(ring.Full());
+  EXPECT_THAT(ring.AcquireInputObject(), Eq(nullptr));
+
+  for (int i = 0; i < 4; ++i) {
+    const int* slot = ring.AcquireOutputObject();
+    ASSERT_NE(slot, nullptr);
+    EXPECT_THAT(*slot, Eq(i));
+    ring.ReleaseOutputObject(slot);
+  }
+  EXPECT_TRUE(ring.Empty());
+}
+
+TEST(AudioRingBufferTest, AcquiredOutputIsNotReused) {
+  AudioRingBuffer<int> ring(2, 0);
+  for (int i = 0; i < 2; ++i) {
+    int* slot = ring.AcquireInputObject();
+    *slot = i;
+    ring.ReleaseInputObject(slot);
+  }
+
+  // A slot that the consumer is still reading must not be handed back to the
+  // producer until it is released.
+  const int* output = ring.AcquireOutputObject();
+  EXPECT_THAT(ring.AcquireInputObject(), Eq(nullptr));
+  ring.ReleaseOutputObject(output);
+  EXPECT_NE(ring.AcquireInputObject(), nullptr);
+}
+
+TEST(AudioRingBufferTest, ProducerConsumer) {
+  constexpr int kCount = 100000;
+  AudioRingBuffer<int> ring(16, 0);
+
+  std::thread producer([&]() {
+    for (int i = 0; i < kCount;) {
+      int* slot = ring.AcquireInputObject();
+      if (slot == nullptr) {
+        std::this_thread::yield();
+        continue;
+      }
+      *slot = i++;
+      ring.ReleaseInputObject(slot);
+    }
+  });
+
+  int expected = 0;
+  while (expected < kCount) {
+    const int* slot = ring.AcquireOutputObject();
+    if (slot == nullptr) {
+      std::this_thread::yield();
+      continue;
+    }
+    EXPECT_THAT(*slot, Eq(expected));
+    ++expected;
+    ring.ReleaseOutputObject(slot);
+  }
+  producer.join();
+  EXPECT_TRUE(ring.Empty());
+}
+
+}  // namespace
+}  // namespace redux
@@ -47,6 +47,14 @@ class AudioSourceStream {
   virtual bool GetNextAudioBuffer(
       const vraudio::AudioBuffer** output_buffer) = 0;
 
+  // Advances the audio stream by one buffer without producing any audio,
+  // decoding as little as possible. Used to keep the timeline of a virtualized
+  // voice moving so that it can resume from the right position once it is
+  // audible again. Returns false if there is no more data to be consumed.
+  //
+  // Should be called only from the audio thread.
+  virtual bool SkipNextAudioBuffer() = 0;
+
   // Queries whether the asynchronously decoded stock of audio buffers needs to
   // be refilled. Should be called only from the audio thread.
   virtual bool IsPrestockServiceNeeded() const = 0;
@@ -16,23 +16,23 @@ limitations under the License.
 
 #include "redux/engines/audio/resonance/audio_stream_manager.h"
 
-#include "resonance_audio/utils/task_thread_pool.h"
-#include "resonance_audio/utils/threadsafe_fifo.h"
+#include <chrono>
 
 namespace redux {
 
-// Number of streaming worker threads available for asynchronous decoding.
-static const unsigned int kNumStreamingWorkerThreads = 64;
-
 // Maximum number of streaming requests in stream renderer pointer queue.
 static const size_t kMaxStreamFifoElements = 64;
 
+// Upper bound on how long the streaming thread sleeps between checks for new
+// requests. Wake-ups are signalled without holding a lock, so one can
+// occasionally be missed; this bounds the resulting delay.
+static constexpr std::chrono::milliseconds kMaxStreamingThreadSleep(2);
+
 AudioStreamManager::AudioStreamManager()
     : streaming_thread_running_(false),
       stream_renderer_ptr_fifo_(kMaxStreamFifoElements, nullptr) {}
 
 void AudioStreamManager::Start() {
-  stream_renderer_ptr_fifo_.EnableBlockingSleepUntilMethods(true);
   if (!streaming_thread_running_.load()) {
     streaming_thread_running_ = true;
     streaming_thread_ = std::thread([this]() { StreamingThread(); });
@@ -40,13 +40,13 @@ void AudioStreamManager::Start() {
 }
 
 void AudioStreamManager::Stop() {
-  stream_renderer_ptr_fifo_.EnableBlockingSleepUntilMethods(false);
   if (streaming_thread_running_.load()) {
     streaming_thread_running_ = false;
+    wake_condition_.notify_one();
     streaming_thread_.join();
   }
 
-  while (stream_renderer_ptr_fifo_.Size() > 0) {
+  while (!stream_renderer_ptr_fifo_.Empty()) {
     auto renderer = PopFromStreamRendererFifo();
     if (renderer) {
       renderer->SetPrestockServicePending(false);
@@ -82,10 +82,9 @@ void AudioStreamManager::Render(std::vector<SourceId>* disabled_renderer_ids) {
     // asynchronous task to do so.
     if (streaming_thread_running_.load() &&
         renderer->IsPrestockServiceNeeded()) {
-      if (!stream_renderer_ptr_fifo_.Full()) {
-        renderer->SetPrestockServicePending(true);
-        const bool pushed = PushToStreamRendererFifo(renderer);
-        DCHECK(pushed);
+      renderer->SetPrestockServicePending(true);
+      if (PushToStreamRendererFifo(renderer)) {
+        wake_condition_.notify_one();
       } else {
         renderer->SetPrestockServicePending(false);
         LOG(WARNING) << "Overflow of asynchronous restock requests. Is the "
@@ -106,30 +105,21 @@ void AudioStreamManager::Render(std::vector<SourceId>* disabled_renderer_ids) {
 }
 
 void AudioStreamManager::StreamingThread() {
-  vraudio::TaskThreadPool worker_thread_pool;
-  if (!worker_thread_pool.StartThreadPool(kNumStreamingWorkerThreads)) {
-    LOG(ERROR) << "Could not start worker threads";
-    return;
-  }
-
   while (streaming_thread_running_.load()) {
-    while (streaming_thread_running_.load() &&
-           !worker_thread_pool.WaitUntilWorkerBecomesAvailable()) {
-    }
-    while (streaming_thread_running_.load() &&
-           !stream_renderer_ptr_fifo_.SleepUntilOutputObjectIsAvailable()) {
-    }
-
     RendererPtr renderer = PopFromStreamRendererFifo();
-    if (renderer != nullptr) {
-      if (streaming_thread_running_.load()) {
-        const auto task = [renderer]() { renderer->ServicePrestock(); };
-        const bool worker_assigned = worker_thread_pool.RunOnWorkerThread(task);
-        DCHECK(worker_assigned);
-      } else {
-        renderer->SetPrestockServicePending(false);
-      }
+    if (renderer == nullptr) {
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      wake_condition_.wait_for(lock, kMaxStreamingThreadSleep, [this]() {
+        return !streaming_thread_running_.load() ||
+               !stream_renderer_ptr_fifo_.Empty();
+      });
+      continue;
     }
+
+    // Decode directly on this thread. Only the audio thread produces
+    // requests and only this thread consumes them, so each stream's prestock
+    // ring also has exactly one producer and one consumer.
+    renderer->ServicePrestock();
   }
 }
 
@@ -17,18 +17,26 @@ limitations under the License.
 #ifndef REDUX_ENGINES_AUDIO_RESONANCE_AUDIO_STREAM_MANAGER_H_
 #define REDUX_ENGINES_AUDIO_RESONANCE_AUDIO_STREAM_MANAGER_H_
 
+#include <atomic>
+#include <condition_variable>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <thread>
 
 #include "absl/container/flat_hash_map.h"
+#include "redux/engines/audio/resonance/audio_ring_buffer.h"
 #include "redux/engines/audio/resonance/audio_stream_renderer.h"
-#include "resonance_audio/utils/threadsafe_fifo.h"
 
 namespace redux {
 
 // Manages the "streaming" thread in which an AudioStreamRenderer can stream and
 // decode audio data.
+//
+// All decoding happens on this single, dedicated thread. The audio thread
+// (which calls Render) only posts requests to it through a lock-free ring and
+// never waits on it, so slow decodes result in underruns rather than stalls in
+// the audio callback.
 class AudioStreamManager {
  public:
   using SourceId = vraudio::SourceId;
@@ -67,7 +75,15 @@ class AudioStreamManager {
 
   std::thread streaming_thread_;
   std::atomic<bool> streaming_thread_running_;
-  vraudio::ThreadsafeFifo<RendererPtr> stream_renderer_ptr_fifo_;
+
+  // Prestock requests from the audio thread (producer) to the streaming thread
+  // (consumer).
+  AudioRingBuffer<RendererPtr> stream_renderer_ptr_fifo_;
+
+  // Used to wake the streaming thread when requests are posted. The audio
+  // thread only ever notifies, it never takes the mutex.
+  std::mutex wake_mutex_;
+  std::condition_variable wake_condition_;
   absl::flat_hash_map<SourceId, RendererPtr> renderers_;
 };
 
@@ -34,6 +34,8 @@ AudioStreamRenderer::AudioStreamRenderer(
       shutdown_triggered_(false),
       stream_volume_(1.0f),
       fade_out_count_down_(0),
+      is_virtual_(false),
+      virtual_fade_out_count_down_(0),
       prestock_service_pending_(false) {
   CHECK(stream_ != nullptr);
   CHECK(resonance_ != nullptr);
@@ -66,7 +68,9 @@ AudioStreamRenderer::~AudioStreamRenderer() {
 
 void AudioStreamRenderer::Resume() {
   is_paused_ = false;
-  resonance_->SetSourceVolume(source_id_, stream_volume_);
+  if (!is_virtual_) {
+    resonance_->SetSourceVolume(source_id_, stream_volume_);
+  }
   fade_out_count_down_ = 0;
 }
 
@@ -82,16 +86,40 @@ void AudioStreamRenderer::Shutdown() {
 
 void AudioStreamRenderer::SetVolume(float volume) {
   stream_volume_ = volume;
-  if (!is_paused_) {
+  if (!is_paused_ && !is_virtual_) {
     resonance_->SetSourceVolume(source_id_, stream_volume_);
   }
 }
 
+void AudioStreamRenderer::SetVirtual(bool is_virtual) {
+  if (is_virtual_ == is_virtual) {
+    return;
+  }
+  is_virtual_ = is_virtual;
+  if (is_virtual_) {
+    resonance_->SetSourceVolume(source_id_, 0.0f);
+    virtual_fade_out_count_down_ = kNumBuffersToProcessDuringFadeOut;
+  } else {
+    virtual_fade_out_count_down_ = 0;
+    if (!is_paused_ && fade_out_count_down_ == 0) {
+      resonance_->SetSourceVolume(source_id_, stream_volume_);
+    }
+  }
+}
+
 bool AudioStreamRenderer::Render() {
   if (is_paused_) {
     return !shutdown_triggered_;
   }
 
+  if (is_virtual_ && virtual_fade_out_count_down_ == 0) {
+    // Without a new buffer, Resonance skips processing for the source.
+    if (!stream_->SkipNextAudioBuffer()) {
+      return !stream_->EndOfStreamReached();
+    }
+    return true;
+  }
+
   const vraudio::AudioBuffer* next_buffer = nullptr;
   if (!stream_->GetNextAudioBuffer(&next_buffer) || next_buffer == nullptr) {
     return !stream_->EndOfStreamReached();
@@ -108,6 +136,9 @@ bool AudioStreamRenderer::Render() {
     --fade_out_count_down_;
     is_paused_ = true;
   }
+  if (virtual_fade_out_count_down_ > 0) {
+    --virtual_fade_out_count_down_;
+  }
   return true;
 }
 
@@ -51,6 +51,11 @@ class AudioStreamRenderer {
   // Sets volume of source stream.
   void SetVolume(float volume);
 
+  // Virtualizes (or devirtualizes) the source stream. A virtual stream keeps
+  // advancing its timeline but is neither decoded nor passed to Resonance for
+  // spatialization; it fades out first so it doesn't cut off abruptly.
+  void SetVirtual(bool is_virtual);
+
   // Returns the handle to the underlying vraudio source.
   vraudio::SourceId GetSourceId() const { return source_id_; }
 
@@ -96,6 +101,12 @@ class AudioStreamRenderer {
   // Number of silence buffers to be triggered before pausing the stream.
   size_t fade_out_count_down_;
 
+  // Indicates if the AudioSourceStream is virtualized.
+  bool is_virtual_;
+
+  // Number of buffers to render before a virtualized stream stops rendering.
+  size_t virtual_fade_out_count_down_;
+
   // Indicates whether this renderer has already been staged for prestock.
   // This flag is used only by the AudioStreamManager to co-ordinate the running
   // of th prestock service.
@@ -55,7 +55,7 @@ void ResonanceAudioAsset::SetAudioReader(std::unique_ptr<AudioReader> reader) {
 }
 
 void ResonanceAudioAsset::SetAudioPlanarData(
-    std::unique_ptr<AudioPlanarData> planar_data) {
+    std::shared_ptr<const AudioPlanarData> planar_data) {
   if (planar_data == nullptr) {
     SetStatus(Status::kInvalid);
     return;
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <atomic>            
 #include <condition_variable>
+#include <memory>
 #include <mutex>             
 
 #include "redux/engines/audio/audio_asset.h"
@@ -61,8 +62,9 @@ class ResonanceAudioAsset : public AudioAsset {
   // asynchronously, but is needed to initialize the asset.
   void SetAudioReader(std::unique_ptr<AudioReader> reader);
 
-  // Sets the audio data for the asset.
-  void SetAudioPlanarData(std::unique_ptr<AudioPlanarData> planar_data);
+  // Sets the audio data for the asset. The data may be shared with other
+  // assets (eg. via the AudioPcmCache).
+  void SetAudioPlanarData(std::shared_ptr<const AudioPlanarData> planar_data);
 
   // Releases the internal AudioReader to the caller. We cannot have concurrent
   // users attempting to stream data from the same AudioReader, so this
@@ -95,7 +97,7 @@ class ResonanceAudioAsset : public AudioAsset {
   std::unique_ptr<AudioReader> reader_;
 
   // Buffer containing uncompressed, planar audio data.
-  std::unique_ptr<AudioPlanarData> planar_data_;
+  std::shared_ptr<const AudioPlanarData> planar_data_;
 
   // Mutex and conditional variable to signal status changes.
   std::atomic<Status> status_;
@@ -16,6 +16,9 @@ limitations under the License.
 
 #include "redux/engines/audio/resonance/resonance_audio_engine.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "redux/engines/audio/resonance/audio_stream_renderer.h"
 #include "redux/engines/audio/resonance/audio_asset_stream.h"
 #include "redux/engines/audio/resonance/resonance_sound.h"
@@ -50,9 +53,37 @@ static const size_t kAudioThreadFifoMaxWaitTimeMs = 100;
 // Maximum number of sources that can be simultaneously created.
 static const size_t kMaxNumberOfSoundSources = 512;
 
+// Default number of sounds that are decoded and spatialized at once.
+static const size_t kDefaultMaxRealVoices = 32;
+
+// Default audibility below which sounds are virtualized (-60dB).
+static const float kDefaultVirtualizationThreshold = 0.001f;
+
+// Estimates the distance attenuation Resonance will apply to a sound. This only
+// needs to be accurate enough to rank sounds against each other.
+static float EstimateDistanceAttenuation(SoundType type,
+                                         Sound::DistanceRolloffModel rolloff,
+                                         float min_distance, float max_distance,
+                                         float distance) {
+  if (type != SoundType::Point || rolloff == Sound::NoRollof) {
+    return 1.0f;
+  } else if (distance <= min_distance) {
+    return 1.0f;
+  } else if (distance >= max_distance) {
+    return 0.0f;
+  } else if (rolloff == Sound::LinearRolloff) {
+    return 1.0f - (distance - min_distance) / (max_distance - min_distance);
+  } else {
+    return 1.0f - std::log(distance / min_distance) /
+                      std::log(max_distance / min_distance);
+  }
+}
+
 ResonanceAudioEngine::ResonanceAudioEngine(Registry* registry)
     : AudioEngine(registry),
       resonance_(nullptr),
+      max_real_voices_(kDefaultMaxRealVoices),
+      virtualization_threshold_(kDefaultVirtualizationThreshold),
       audio_running_(false),
       audio_thread_task_queue_(kMaxNumberOfSoundSources) {
   auto* choreographer = registry->Get<Choreographer>();
@@ -170,6 +201,58 @@ void ResonanceAudioEngine::Update() {
     auto sound = sounds_.find(source)->second;
     sound->Stop();
   }
+
+  if (audio_running_) {
+    UpdateVoices();
+  }
+}
+
+void ResonanceAudioEngine::SetMaxRealVoices(size_t count) {
+  max_real_voices_ = count;
+}
+
+void ResonanceAudioEngine::SetVirtualizationThreshold(float audibility) {
+  virtualization_threshold_ = audibility;
+}
+
+void ResonanceAudioEngine::UpdateVoices() {
+  ranked_voices_.clear();
+  for (auto& iter : voices_) {
+    Voice& voice = iter.second;
+    if (!voice.playing) {
+      continue;
+    }
+    const float distance = Length(voice.position - listener_position_);
+    voice.audibility =
+        voice.volume * EstimateDistanceAttenuation(
+                           voice.type, voice.rolloff, voice.min_distance,
+                           voice.max_distance, distance);
+    ranked_voices_.push_back(&voice);
+  }
+
+  std::sort(ranked_voices_.begin(), ranked_voices_.end(),
+            [](const Voice* lhs, const Voice* rhs) {
+              if (lhs->priority != rhs->priority) {
+                return lhs->priority > rhs->priority;
+              }
+              return lhs->audibility > rhs->audibility;
+            });
+
+  size_t num_real_voices = 0;
+  for (Voice* voice : ranked_voices_) {
+    const bool is_real = num_real_voices < max_real_voices_ &&
+                         voice->audibility >= virtualization_threshold_;
+    if (is_real) {
+      ++num_real_voices;
+    }
+    if (voice->is_virtual == is_real) {
+      voice->is_virtual = !is_real;
+      const bool is_virtual = voice->is_virtual;
+      RunRendererTask(voice->source_id, [=](AudioStreamRenderer& renderer) {
+        renderer.SetVirtual(is_virtual);
+      });
+    }
+  }
 }
 
 SoundPtr ResonanceAudioEngine::CreateSound(AudioAssetPtr asset,
@@ -208,6 +291,12 @@ SoundPtr ResonanceAudioEngine::CreateSound(AudioAssetPtr asset,
   };
   audio_thread_task_queue_.Post(task);
 
+  Voice& voice = voices_[source_id];
+  voice.source_id = source_id;
+  voice.type = params.type;
+  voice.priority = params.priority;
+  voice.volume = params.volume;
+
   auto sound = std::make_shared<ResonanceSound>(params.type, source_id, this);
   sounds_[source_id] = sound;
   return std::static_pointer_cast<Sound>(sound);
@@ -217,6 +306,7 @@ void ResonanceAudioEngine::PauseSound(SourceId source_id) {
   if (sounds_.contains(source_id)) {
     RunRendererTask(source_id,
                     [](AudioStreamRenderer& renderer) { renderer.Pause(); });
+    voices_[source_id].playing = false;
   }
 }
 
@@ -224,6 +314,7 @@ void ResonanceAudioEngine::ResumeSound(SourceId source_id) {
   if (sounds_.contains(source_id)) {
     RunRendererTask(source_id,
                     [](AudioStreamRenderer& renderer) { renderer.Resume(); });
+    voices_[source_id].playing = true;
   }
 }
 
@@ -231,6 +322,7 @@ void ResonanceAudioEngine::StopSound(SourceId source_id) {
   if (sounds_.contains(source_id)) {
     RunRendererTask(source_id,
                     [](AudioStreamRenderer& renderer) { renderer.Shutdown(); });
+    voices_.erase(source_id);
     {
       std::lock_guard<std::mutex> lock(pending_delete_mutex_);
       pending_delete_.push_back(source_id);
@@ -241,6 +333,10 @@ void ResonanceAudioEngine::StopSound(SourceId source_id) {
 void ResonanceAudioEngine::SetSoundObjectPosition(SourceId source_id,
                                                   const vec3& position) {
   resonance_->SetSourcePosition(source_id, position.x, position.y, position.z);
+  auto iter = voices_.find(source_id);
+  if (iter != voices_.end()) {
+    iter->second.position = position;
+  }
 }
 
 void ResonanceAudioEngine::SetSoundObjectDistanceRolloffModel(
@@ -252,6 +348,14 @@ void ResonanceAudioEngine::SetSoundObjectDistanceRolloffModel(
     // No distance attenuation should be applied.
     resonance_->SetSourceDistanceAttenuation(source_id, 1.0f);
   }
+
+  auto iter = voices_.find(source_id);
+  if (iter != voices_.end() &&
+      (rolloff == Sound::NoRollof || max_distance > min_distance)) {
+    iter->second.rolloff = rolloff;
+    iter->second.min_distance = min_distance;
+    iter->second.max_distance = max_distance;
+  }
 }
 
 void ResonanceAudioEngine::SetSoundfieldRotation(SourceId source_id,
@@ -276,6 +380,7 @@ void ResonanceAudioEngine::SetSoundVolume(SourceId source_id, float volume) {
     RunRendererTask(source_id, [=](AudioStreamRenderer& renderer) {
       renderer.SetVolume(volume);
     });
+    voices_[source_id].volume = volume;
   }
 }
 
@@ -286,6 +391,7 @@ void ResonanceAudioEngine::SetGlobalVolume(float volume) {
 void ResonanceAudioEngine::SetListenerTransform(const vec3& position,
                                                 const quat& rotation) {
   resonance_->SetHeadPosition(position.x, position.y, position.z);
+  listener_position_ = position;
   resonance_->SetHeadRotation(rotation.x, rotation.y, rotation.z, rotation.w);
 }
 
@@ -452,6 +558,12 @@ void AudioEngine::SetListenerTransform(const vec3& position,
   Upcast(this)->SetListenerTransform(position, rotation);
 }
 void AudioEngine::Update() { Upcast(this)->Update(); }
+void AudioEngine::SetMaxRealVoices(std::size_t count) {
+  Upcast(this)->SetMaxRealVoices(count);
+}
+void AudioEngine::SetVirtualizationThreshold(float audibility) {
+  Upcast(this)->SetVirtualizationThreshold(audibility);
+}
 AudioAssetPtr AudioEngine::GetAudioAsset(HashValue key) {
   return Upcast(this)->GetAudioAssetManager()->FindAudioAsset(key);
 }
@@ -21,6 +21,7 @@ limitations under the License.
 #include <memory>
 #include <mutex> 
 #include <thread>
+#include <vector>
 
 #include "redux/engines/audio/audio_engine.h"
 #include "redux/engines/audio/resonance/audio_asset_manager.h"
@@ -128,6 +129,14 @@ class ResonanceAudioEngine : public AudioEngine {
                   const quat& rotation);
   void DisableRoom();
 
+  // Sets the maximum number of sounds that are decoded and spatialized at once.
+  // See AudioEngine::SetMaxRealVoices.
+  void SetMaxRealVoices(size_t count);
+
+  // Sets the audibility below which playing sounds are virtualized. See
+  // AudioEngine::SetVirtualizationThreshold.
+  void SetVirtualizationThreshold(float audibility);
+
   // Returrns the AudioAssetManager used for managing audio assets.
   AudioAssetManager* GetAudioAssetManager() {
     return audio_asset_manager_.get();
@@ -139,6 +148,25 @@ class ResonanceAudioEngine : public AudioEngine {
   }
 
  private:
+  // Main thread bookkeeping used to decide which sounds get real voices.
+  struct Voice {
+    SourceId source_id = vraudio::kInvalidSourceId;
+    SoundType type = SoundType::Stereo;
+    int priority = 0;
+    float volume = 1.0f;
+    vec3 position = vec3::Zero();
+    Sound::DistanceRolloffModel rolloff = Sound::LogarithmicRolloff;
+    float min_distance = 1.0f;
+    float max_distance = 500.0f;
+    float audibility = 0.0f;
+    bool playing = false;
+    bool is_virtual = false;
+  };
+
+  // Ranks all playing sounds by priority and audibility and virtualizes those
+  // that are inaudible or don't fit in the voice budget.
+  void UpdateVoices();
+
   // Starts the audio playback.
   void Start();
 
@@ -175,6 +203,13 @@ class ResonanceAudioEngine : public AudioEngine {
 
   absl::flat_hash_map<SourceId, std::shared_ptr<ResonanceSound>> sounds_;
 
+  // Voice virtualization state, updated on the main thread.
+  absl::flat_hash_map<SourceId, Voice> voices_;
+  std::vector<Voice*> ranked_voices_;
+  vec3 listener_position_ = vec3::Zero();
+  size_t max_real_voices_;
+  float virtualization_threshold_;
+
   // Audio processing thread.
   std::thread audio_thread_;
   std::atomic<bool> audio_running_;
@@ -0,0 +1,129 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/physics/bullet/bullet_bvh.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "LinearMath/btAlignedAllocator.h"
+#include "LinearMath/btScalar.h"
+#include "redux/modules/base/logging.h"
+
+namespace redux {
+
+static constexpr size_t kVerticesPerTriangle = 3;
+static constexpr size_t kFloatsPerVertex = 3;
+static constexpr size_t kTriangleStride = kVerticesPerTriangle * sizeof(int);
+static constexpr size_t kVertexStride = kFloatsPerVertex * sizeof(float);
+static constexpr size_t kBvhAlignment = 16;
+static constexpr uint32_t kBakedBvhMagic = 0x48564252;  // "RBVH"
+
+// Prefixed to the serialized BVH to identify the runtime that baked it. Its
+// size keeps the BVH that follows it 16-byte aligned.
+struct BakedBvhHeader {
+  uint32_t magic = kBakedBvhMagic;
+  uint32_t bullet_version = BT_BULLET_VERSION;
+  uint32_t scalar_size = sizeof(btScalar);
+  uint32_t num_triangles = 0;
+};
+static_assert(sizeof(BakedBvhHeader) % kBvhAlignment == 0);
+
+static size_t GetNumTriangles(const CollisionMesh& mesh) {
+  return mesh.indices.GetNumBytes() / kTriangleStride;
+}
+
+void BulletAlignedDeleter::operator()(void* ptr) const { btAlignedFree(ptr); }
+
+std::unique_ptr<btTriangleIndexVertexArray> CreateBtTriangleMesh(
+    const CollisionMesh& mesh) {
+  const int* triangles = reinterpret_cast<const int*>(mesh.indices.GetBytes());
+  const float* vertices =
+      reinterpret_cast<const float*>(mesh.vertices.GetBytes());
+  const size_t num_vertices = mesh.vertices.GetNumBytes() / kVertexStride;
+
+  return std::make_unique<btTriangleIndexVertexArray>(
+      GetNumTriangles(mesh), const_cast<int*>(triangles), kTriangleStride,
+      num_vertices, const_cast<float*>(vertices), kVertexStride);
+}
+
+DataContainer BakeBvh(const CollisionMesh& mesh) {
+  // Match how btBvhTriangleMeshShape builds its BVH so that the quantization
+  // is identical to what would have been built at runtime.
+  auto bt_mesh = CreateBtTriangleMesh(mesh);
+  btVector3 aabb_min;
+  btVector3 aabb_max;
+  bt_mesh->calculateAabbBruteForce(aabb_min, aabb_max);
+
+  btOptimizedBvh bvh;
+  bvh.build(bt_mesh.get(), /* useQuantizedAabbCompression= */ true, aabb_min,
+            aabb_max);
+
+  BakedBvhHeader header;
+  header.num_triangles = static_cast<uint32_t>(GetNumTriangles(mesh));
+
+  const unsigned int bvh_size = bvh.calculateSerializeBufferSize();
+  const size_t num_bytes = sizeof(header) + bvh_size;
+  auto* bytes =
+      static_cast<std::byte*>(btAlignedAlloc(num_bytes, kBvhAlignment));
+  std::memcpy(bytes, &header, sizeof(header));
+  if (!bvh.serialize(bytes + sizeof(header), bvh_size, false)) {
+    btAlignedFree(bytes);
+    LOG(ERROR) << "Unable to serialize BVH.";
+    return DataContainer();
+  }
+  auto deleter = [](const std::byte* mem) {
+    btAlignedFree(const_cast<std::byte*>(mem));
+  };
+  return DataContainer(bytes, num_bytes, std::move(deleter));
+}
+
+btOptimizedBvh* LoadBakedBvh(const CollisionMesh& mesh,
+                             BulletAlignedBuffer* buffer) {
+  const DataContainer& baked = mesh.bvh;
+  if (baked.GetNumBytes() <= sizeof(BakedBvhHeader)) {
+    return nullptr;
+  }
+
+  BakedBvhHeader header;
+  std::memcpy(&header, baked.GetBytes(), sizeof(header));
+  if (header.magic != kBakedBvhMagic ||
+      header.bullet_version != BT_BULLET_VERSION ||
+      header.scalar_size != sizeof(btScalar) ||
+      header.num_triangles != GetNumTriangles(mesh)) {
+    LOG(ERROR) << "Ignoring baked BVH which does not match the runtime.";
+    return nullptr;
+  }
+
+  // Deserializing fixes up pointers within the data, so work on a mutable and
+  // suitably aligned copy of it.
+  const size_t bvh_size = baked.GetNumBytes() - sizeof(header);
+  buffer->reset(btAlignedAlloc(bvh_size, kBvhAlignment));
+  std::memcpy(buffer->get(), baked.GetBytes() + sizeof(header), bvh_size);
+
+  btQuantizedBvh* bvh = btQuantizedBvh::deSerializeInPlace(
+      buffer->get(), static_cast<unsigned int>(bvh_size), false);
+  if (bvh == nullptr || !bvh->isQuantized()) {
+    LOG(ERROR) << "Unable to deserialize baked BVH.";
+    buffer->reset();
+    return nullptr;
+  }
+  // btOptimizedBvh adds no state to btQuantizedBvh; Bullet's own importers
+  // cast deserialized BVHs the same way.
+  return static_cast<btOptimizedBvh*>(bvh);
+}
+
+}  // namespace redux
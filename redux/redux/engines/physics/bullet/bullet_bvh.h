@@ -0,0 +1,59 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_PHYSICS_BULLET_BULLET_BVH_H_
+#define REDUX_ENGINES_PHYSICS_BULLET_BULLET_BVH_H_
+
+#include <memory>
+
+#include "BulletCollision/CollisionShapes/btOptimizedBvh.h"
+#include "BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h"
+#include "redux/engines/physics/collision_data.h"
+#include "redux/modules/base/data_container.h"
+
+namespace redux {
+
+// Functions for baking the bounding volume hierarchy (BVH) of a triangle mesh
+// offline, so that a btBvhTriangleMeshShape can be created at runtime without
+// building its BVH.
+//
+// The baked data is Bullet's own serialized quantized BVH, prefixed by a small
+// header. The format depends on the Bullet version, the precision of btScalar
+// and the endianness of the machine that baked it. Baked data that does not
+// match the runtime is rejected, in which case the BVH must be built instead.
+
+// Frees memory allocated with btAlignedAlloc.
+struct BulletAlignedDeleter {
+  void operator()(void* ptr) const;
+};
+using BulletAlignedBuffer = std::unique_ptr<void, BulletAlignedDeleter>;
+
+// Creates a Bullet triangle mesh which references the data in `mesh`.
+std::unique_ptr<btTriangleIndexVertexArray> CreateBtTriangleMesh(
+    const CollisionMesh& mesh);
+
+// Builds the quantized BVH for `mesh` and returns it in its baked form.
+DataContainer BakeBvh(const CollisionMesh& mesh);
+
+// Loads the BVH baked in `mesh.bvh` into `buffer`. Bullet deserializes the BVH
+// in place, so the returned BVH lives in `buffer` and must not outlive it.
+// Returns nullptr if the mesh has no baked BVH or it cannot be used.
+btOptimizedBvh* LoadBakedBvh(const CollisionMesh& mesh,
+                             BulletAlignedBuffer* buffer);
+
+}  // namespace redux
+
+#endif  // REDUX_ENGINES_PHYSICS_BULLET_BULLET_BVH_H_
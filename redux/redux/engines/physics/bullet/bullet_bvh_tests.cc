@@ -0,0 +1,108 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/physics/bullet/bullet_bvh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace redux {
+namespace {
+
+// A 2x2 grid of quads, two triangles each.
+const std::vector<float> kVertices = {
+    0, 0, 0, 1, 0, 0, 2, 0, 0,  //
+    0, 0, 1, 1, 0, 1, 2, 0, 1,  //
+    0, 0, 2, 1, 0, 2, 2, 0, 2,  //
+};
+const std::vector<int> kIndices = {
+    0, 3, 1, 1, 3, 4, 1, 4, 2, 2, 4, 5,
+    3, 6, 4, 4, 6, 7, 4, 7, 5, 5, 7, 8,
+};
+
+template <typename T>
+DataContainer CopyData(const std::vector<T>& data) {
+  return DataContainer::WrapData(data.data(), data.size()).Clone();
+}
+
+CollisionMesh CreateMesh(const std::vector<int>& indices) {
+  CollisionMesh mesh;
+  mesh.vertices = CopyData(kVertices);
+  mesh.indices = CopyData(indices);
+  return mesh;
+}
+
+TEST(BulletBvhTest, LoadBakedBvh) {
+  CollisionMesh mesh = CreateMesh(kIndices);
+  mesh.bvh = BakeBvh(mesh);
+  ASSERT_GT(mesh.bvh.GetNumBytes(), 0u);
+
+  BulletAlignedBuffer buffer;
+  btOptimizedBvh* bvh = LoadBakedBvh(mesh, &buffer);
+  ASSERT_NE(bvh, nullptr);
+  EXPECT_NE(buffer.get(), nullptr);
+  EXPECT_TRUE(bvh->isQuantized());
+
+  // The baked BVH matches the one that would be built at runtime.
+  auto bt_mesh = CreateBtTriangleMesh(mesh);
+  btVector3 aabb_min;
+  btVector3 aabb_max;
+  bt_mesh->calculateAabbBruteForce(aabb_min, aabb_max);
+  btOptimizedBvh built;
+  built.build(bt_mesh.get(), true, aabb_min, aabb_max);
+  EXPECT_EQ(bvh->getQuantizedNodeArray().size(),
+            built.getQuantizedNodeArray().size());
+}
+
+TEST(BulletBvhTest, NoBakedBvh) {
+  const CollisionMesh mesh = CreateMesh(kIndices);
+
+  BulletAlignedBuffer buffer;
+  EXPECT_EQ(LoadBakedBvh(mesh, &buffer), nullptr);
+  EXPECT_EQ(buffer.get(), nullptr);
+}
+
+TEST(BulletBvhTest, RejectsBvhOfDifferentMesh) {
+  const std::vector<int> indices(kIndices.begin(), kIndices.begin() + 6);
+  CollisionMesh mesh = CreateMesh(indices);
+  mesh.bvh = BakeBvh(CreateMesh(kIndices));
+
+  BulletAlignedBuffer buffer;
+  EXPECT_EQ(LoadBakedBvh(mesh, &buffer), nullptr);
+}
+
+TEST(BulletBvhTest, RejectsCorruptBvh) {
+  CollisionMesh mesh = CreateMesh(kIndices);
+  DataContainer baked = BakeBvh(mesh);
+  ASSERT_GT(baked.GetNumBytes(), 0u);
+
+  // Overwrite the header's magic number.
+  std::vector<std::byte> bytes(baked.GetBytes(),
+                               baked.GetBytes() + baked.GetNumBytes());
+  std::memset(bytes.data(), 0, sizeof(uint32_t));
+  mesh.bvh = CopyData(bytes);
+
+  BulletAlignedBuffer buffer;
+  EXPECT_EQ(LoadBakedBvh(mesh, &buffer), nullptr);
+}
+
+}  // namespace
+}  // namespace redux
@@ -20,10 +20,9 @@ limitations under the License.
 
 #include "BulletCollision/CollisionShapes/btBoxShape.h"
 #include "BulletCollision/CollisionShapes/btCompoundShape.h"
+#include "BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h"
 #include "BulletCollision/CollisionShapes/btSphereShape.h"
 #include "BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h"
-#include "BulletCollision/CollisionShapes/btUniformScalingShape.h"
-#include "BulletCollision/Gimpact/btGImpactShape.h"
 #include "redux/engines/physics/bullet/bullet_utils.h"
 
 namespace redux {
@@ -35,6 +34,31 @@ BulletCollisionShape::BulletCollisionShape(std::shared_ptr<CollisionData> data)
   const int num_shapes = data_->GetNumParts();
   CHECK_GT(num_shapes, 0);
 
+  vertices_.resize(num_shapes);
+  bvhs_.resize(num_shapes);
+  meshes_.resize(num_shapes);
+  scaled_shapes_.emplace_back(CreateScaledShape(vec3::One()));
+}
+
+btCollisionShape* BulletCollisionShape::GetUnderlyingBtCollisionShape(
+    const vec3& scale) {
+  // Entities using a shape rarely come in more than a handful of scales, so a
+  // linear search is sufficient.
+  for (const auto& scaled_shape : scaled_shapes_) {
+    if (scaled_shape->scale == scale) {
+      return scaled_shape->bt_shape;
+    }
+  }
+  scaled_shapes_.emplace_back(CreateScaledShape(scale));
+  return scaled_shapes_.back()->bt_shape;
+}
+
+std::unique_ptr<BulletCollisionShape::ScaledShape>
+BulletCollisionShape::CreateScaledShape(const vec3& scale) {
+  auto out = std::make_unique<ScaledShape>();
+  out->scale = scale;
+
+  const int num_shapes = data_->GetNumParts();
   bool single_shape_at_origin = true;
   if (num_shapes > 1) {
     single_shape_at_origin = false;
@@ -47,22 +71,23 @@ BulletCollisionShape::BulletCollisionShape(std::shared_ptr<CollisionData> data)
   btCompoundShape* compound = nullptr;
   if (!single_shape_at_origin) {
     compound = new btCompoundShape(true, num_shapes);
-    shapes_.emplace_back(compound);
-    bt_shape_ = compound;
+    out->shapes.emplace_back(compound);
+    out->bt_shape = compound;
   }
 
+  const btVector3 bt_scale = ToBullet(scale);
   for (int i = 0; i < num_shapes; ++i) {
     btCollisionShape* shape = nullptr;
     const auto type = data_->GetPartType(i);
     switch (type) {
       case CollisionData::kBox:
-        shape = AddBoxShape(data_->GetBoxHalfExtents(i));
+        shape = AddBoxShape(out.get(), data_->GetBoxHalfExtents(i));
         break;
       case CollisionData::kSphere:
-        shape = AddSphereShape(data_->GetSphereRadius(i));
+        shape = AddSphereShape(out.get(), data_->GetSphereRadius(i));
         break;
       case CollisionData::kMesh:
-        shape = AddMeshShape(data_->GetCollisionMesh(i));
+        shape = AddMeshShape(out.get(), i);
         break;
       case CollisionData::kNone:
         LOG(FATAL) << "No shape.";
@@ -70,9 +95,11 @@ BulletCollisionShape::BulletCollisionShape(std::shared_ptr<CollisionData> data)
     }
 
     if (single_shape_at_origin) {
-      bt_shape_ = shape;
+      out->bt_shape = shape;
     } else {
-      const btVector3 bt_position = ToBullet(data_->GetPosition(i));
+      // Scale the offset of the part the same way btCompoundShape does; the
+      // part itself has already been scaled.
+      const btVector3 bt_position = ToBullet(data_->GetPosition(i)) * bt_scale;
       const btQuaternion bt_rotation = ToBullet(data_->GetRotation(i));
       const btTransform bt_transform(bt_rotation, bt_position);
       compound->addChildShape(bt_transform, shape);
@@ -81,43 +108,54 @@ BulletCollisionShape::BulletCollisionShape(std::shared_ptr<CollisionData> data)
   if (compound) {
     compound->recalculateLocalAabb();
   }
+  return out;
 }
 
-btCollisionShape* BulletCollisionShape::AddBoxShape(const vec3& half_extents) {
+btCollisionShape* BulletCollisionShape::AddBoxShape(ScaledShape* out,
+                                                    const vec3& half_extents) {
   btVector3 bt_extents(half_extents.x, half_extents.y, half_extents.z);
   auto ptr = new btBoxShape(bt_extents);
-  shapes_.emplace_back(ptr);
+  ptr->setLocalScaling(ToBullet(out->scale));
+  out->shapes.emplace_back(ptr);
   return ptr;
 }
 
-btCollisionShape* BulletCollisionShape::AddSphereShape(float radius) {
+btCollisionShape* BulletCollisionShape::AddSphereShape(ScaledShape* out,
+                                                       float radius) {
   auto ptr = new btSphereShape(radius);
-  shapes_.emplace_back(ptr);
+  ptr->setLocalScaling(ToBullet(out->scale));
+  out->shapes.emplace_back(ptr);
   return ptr;
 }
 
-btCollisionShape* BulletCollisionShape::AddMeshShape(
-    const CollisionMesh& mesh) {
-  static constexpr size_t kVerticesPerTriangle = 3;
-  static constexpr size_t kFloatsPerVertex = 3;
-  static constexpr size_t kTriangleStride = kVerticesPerTriangle * sizeof(int);
-  static constexpr size_t kVertexStride = kFloatsPerVertex * sizeof(float);
-
-  const int* triangles = reinterpret_cast<const int*>(mesh.indices.GetBytes());
-  const size_t num_triangles = mesh.indices.GetNumBytes() / kTriangleStride;
-  const float* vertices =
-      reinterpret_cast<const float*>(mesh.vertices.GetBytes());
-  const size_t num_vertices = mesh.indices.GetNumBytes() / kVertexStride;
-
-  btTriangleIndexVertexArray* vertex_array = new btTriangleIndexVertexArray(
-      num_triangles, const_cast<int*>(triangles), kTriangleStride, num_vertices,
-      const_cast<float*>(vertices), kVertexStride);
-  vertices_.emplace_back(vertex_array);
-
-  auto ptr = new btGImpactMeshShape(vertex_array);
-  ptr->postUpdate();
-  ptr->updateBound();
-  shapes_.emplace_back(ptr);
+btCollisionShape* BulletCollisionShape::AddMeshShape(ScaledShape* out,
+                                                     size_t index) {
+  btBvhTriangleMeshShape* mesh = GetMeshShape(index);
+  if (out->scale == vec3::One()) {
+    return mesh;
+  }
+  auto ptr = new btScaledBvhTriangleMeshShape(mesh, ToBullet(out->scale));
+  out->shapes.emplace_back(ptr);
   return ptr;
 }
+
+btBvhTriangleMeshShape* BulletCollisionShape::GetMeshShape(size_t index) {
+  if (meshes_[index]) {
+    return meshes_[index].get();
+  }
+
+  const CollisionMesh& mesh = data_->GetCollisionMesh(index);
+  vertices_[index] = CreateBtTriangleMesh(mesh);
+
+  // Use the baked BVH if there is one, otherwise build it now.
+  btOptimizedBvh* bvh = LoadBakedBvh(mesh, &bvhs_[index]);
+  meshes_[index] = std::make_unique<btBvhTriangleMeshShape>(
+      vertices_[index].get(), /* useQuantizedAabbCompression= */ true,
+      /* buildBvh= */ bvh == nullptr);
+  if (bvh) {
+    meshes_[index]->setOptimizedBvh(bvh);
+  }
+  return meshes_[index].get();
+}
+
 }  // namespace redux
@@ -18,30 +18,62 @@ limitations under the License.
 #define REDUX_ENGINES_PHYSICS_BULLET_BULLET_COLLISION_SHAPE_H_
 
 #include <functional>
+#include <memory>
 #include <vector>
 
+#include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h"
 #include "BulletCollision/CollisionShapes/btCollisionShape.h"
 #include "BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h"
+#include "redux/engines/physics/bullet/bullet_bvh.h"
 #include "redux/engines/physics/collision_data.h"
 #include "redux/engines/physics/collision_shape.h"
 
 namespace redux {
 
+// The Bullet representation of a CollisionData.
+//
+// Bullet shapes carry their own scale, so this class keeps a separate Bullet
+// shape for each scale at which it is used. This lets a single
+// BulletCollisionShape be shared by every Entity with the same collision data.
+// Triangle mesh parts are built into a BVH only once and shared across scales
+// via btScaledBvhTriangleMeshShape.
 class BulletCollisionShape : public CollisionShape {
  public:
   explicit BulletCollisionShape(std::shared_ptr<CollisionData> data);
 
-  btCollisionShape* GetUnderlyingBtCollisionShape() { return bt_shape_; }
+  // Returns the unscaled Bullet shape.
+  btCollisionShape* GetUnderlyingBtCollisionShape() {
+    return GetUnderlyingBtCollisionShape(vec3::One());
+  }
+
+  // Returns the Bullet shape scaled by `scale`, creating it if needed.
+  btCollisionShape* GetUnderlyingBtCollisionShape(const vec3& scale);
+
+  // Returns the data from which this shape was created.
+  const CollisionData& GetCollisionData() const { return *data_; }
 
  private:
-  btCollisionShape* AddBoxShape(const vec3& half_extents);
-  btCollisionShape* AddSphereShape(float radius);
-  btCollisionShape* AddMeshShape(const CollisionMesh& mesh);
+  // The Bullet shapes that make up this shape at a single scale.
+  struct ScaledShape {
+    vec3 scale = vec3::One();
+    btCollisionShape* bt_shape = nullptr;
+    std::vector<std::unique_ptr<btCollisionShape>> shapes;
+  };
+
+  std::unique_ptr<ScaledShape> CreateScaledShape(const vec3& scale);
+  btCollisionShape* AddBoxShape(ScaledShape* out, const vec3& half_extents);
+  btCollisionShape* AddSphereShape(ScaledShape* out, float radius);
+  btCollisionShape* AddMeshShape(ScaledShape* out, size_t index);
+  btBvhTriangleMeshShape* GetMeshShape(size_t index);
 
-  btCollisionShape* bt_shape_ = nullptr;
   std::shared_ptr<CollisionData> data_;
-  std::vector<std::unique_ptr<btCollisionShape>> shapes_;
+  // The unscaled mesh shapes (and their vertex arrays and baked BVHs),
+  // indexed by part.
   std::vector<std::unique_ptr<btTriangleIndexVertexArray>> vertices_;
+  std::vector<BulletAlignedBuffer> bvhs_;
+  std::vector<std::unique_ptr<btBvhTriangleMeshShape>> meshes_;
+  // Declared last so that it is destroyed before the shapes it references.
+  std::vector<std::unique_ptr<ScaledShape>> scaled_shapes_;
 };
 
 inline BulletCollisionShape* Upcast(CollisionShape* ptr) {
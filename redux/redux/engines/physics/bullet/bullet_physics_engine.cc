@@ -19,6 +19,8 @@ limitations under the License.
 #include <algorithm>
 
 #include "btBulletDynamicsCommon.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
 #include "redux/engines/physics/bullet/bullet_collision_shape.h"
 #include "redux/engines/physics/bullet/bullet_rigid_body.h"
 #include "redux/engines/physics/bullet/bullet_trigger_volume.h"
@@ -31,115 +33,314 @@ limitations under the License.
 namespace redux {
 
 static void CreatePhysicsEngine(Registry* registry) {
+#ifdef REDUX_BULLET_NUM_THREADS
+  auto ptr = new BulletPhysicsEngine(registry, REDUX_BULLET_NUM_THREADS);
+#else
   auto ptr = new BulletPhysicsEngine(registry);
+#endif
   registry->Register(std::unique_ptr<PhysicsEngine>(ptr));
 }
 
 static StaticRegistry Static_Register(CreatePhysicsEngine);
 
+// Records the rigid bodies whose bounding boxes overlap a trigger volume.
+class TriggerAabbCallback : public btBroadphaseAabbCallback {
+ public:
+  TriggerAabbCallback(Entity entity, Bits32 group, Bits32 filter,
+                      std::vector<BulletPhysicsCollisionData>* collisions)
+      : entity_(entity),
+        group_(static_cast<int>(group.Value())),
+        filter_(static_cast<int>(filter.Value())),
+        collisions_(collisions) {}
+
+  bool process(const btBroadphaseProxy* proxy) override {
+    // The same test as btOverlapFilterCallback's default.
+    if ((proxy->m_collisionFilterGroup & filter_) == 0 ||
+        (group_ & proxy->m_collisionFilterMask) == 0) {
+      return true;
+    }
+    const auto* object =
+        static_cast<const btCollisionObject*>(proxy->m_clientObject);
+    const Entity other = EntityFromBulletUserIndex(object->getUserIndex());
+    if (other != entity_) {
+      collisions_->emplace_back(BulletPhysicsCollisionKey(entity_, other), -1);
+    }
+    return true;
+  }
+
+ private:
+  Entity entity_;
+  int group_ = 0;
+  int filter_ = 0;
+  std::vector<BulletPhysicsCollisionData>* collisions_ = nullptr;
+};
+
 static void InternalTickCallback(btDynamicsWorld* world, btScalar time_step) {
   BulletPhysicsEngine* engine =
       static_cast<BulletPhysicsEngine*>(world->getWorldUserInfo());
   engine->OnSimTick();
 }
 
-BulletPhysicsEngine::BulletPhysicsEngine(Registry* registry)
+BulletPhysicsEngine::BulletPhysicsEngine(Registry* registry, int num_threads)
     : registry_(registry) {
+#if BT_THREADSAFE
+  if (num_threads != 1) {
+    task_scheduler_ = std::make_unique<BulletTaskScheduler>(num_threads);
+    btSetTaskScheduler(task_scheduler_.get());
+  }
+#endif
+
   bt_config_ = std::make_unique<btDefaultCollisionConfiguration>();
-  bt_dispatcher_ = std::make_unique<btCollisionDispatcher>(bt_config_.get());
   bt_broadphase_ = std::make_unique<btDbvtBroadphase>();
-  bt_solver_ = std::make_unique<btSequentialImpulseConstraintSolver>();
-  bt_world_ = std::make_unique<btDiscreteDynamicsWorld>(
-      bt_dispatcher_.get(), bt_broadphase_.get(), bt_solver_.get(),
-      bt_config_.get());
+  if (task_scheduler_) {
+    // The solver pool solves simulation islands in parallel, with one solver
+    // per thread.
+    auto solver_pool = std::make_unique<btConstraintSolverPoolMt>(
+        task_scheduler_->getMaxNumThreads());
+    bt_dispatcher_ =
+        std::make_unique<btCollisionDispatcherMt>(bt_config_.get());
+    bt_world_ = std::make_unique<btDiscreteDynamicsWorldMt>(
+        bt_dispatcher_.get(), bt_broadphase_.get(), solver_pool.get(), nullptr,
+        bt_config_.get());
+    bt_solver_ = std::move(solver_pool);
+  } else {
+    bt_dispatcher_ = std::make_unique<btCollisionDispatcher>(bt_config_.get());
+    bt_solver_ = std::make_unique<btSequentialImpulseConstraintSolver>();
+    bt_world_ = std::make_unique<btDiscreteDynamicsWorld>(
+        bt_dispatcher_.get(), bt_broadphase_.get(), bt_solver_.get(),
+        bt_config_.get());
+  }
   bt_world_->setGravity(ToBullet(gravity_));
   bt_world_->setInternalTickCallback(InternalTickCallback,
                                      static_cast<void*>(this));
+}
 
-  on_exit_collision_ = [](Entity, Entity) {};
-  on_enter_collision_ = [](Entity, Entity) {};
+BulletPhysicsEngine::~BulletPhysicsEngine() {
+  bt_world_.reset();
+  if (task_scheduler_ && btGetTaskScheduler() == task_scheduler_.get()) {
+    btSetTaskScheduler(btGetSequentialTaskScheduler());
+  }
 }
 
 void BulletPhysicsEngine::OnSimTick() {
-  contacts_.clear();
+  using std::swap;
+  swap(current_collisions_, previous_collisions_);
   current_collisions_.clear();
+  contacts_.clear();
 
-  for (int i = 0; i < bt_dispatcher_->getNumManifolds(); ++i) {
-    const btPersistentManifold* manifold =
-        bt_dispatcher_->getManifoldByIndexInternal(i);
-    ProcessContactManifold(manifold);
-  }
+  GatherCollisions();
+  DiffCollisions();
 
-  for (auto iter : current_collisions_) {
-    const bool new_collision = !previous_collisions_.contains(iter.first);
-    if (new_collision) {
-      on_enter_collision_(Entity(iter.first.entities[0]),
-                          Entity(iter.first.entities[1]));
+  if (on_collision_batch_ &&
+      (!entered_collisions_.empty() || !exited_collisions_.empty())) {
+    on_collision_batch_(entered_collisions_, exited_collisions_);
+  }
+  if (on_enter_collision_) {
+    for (const CollisionPair& pair : entered_collisions_) {
+      on_enter_collision_(pair.entity_a, pair.entity_b);
     }
   }
-
-  for (auto iter : previous_collisions_) {
-    const bool expired_collision = !current_collisions_.contains(iter.first);
-    if (expired_collision) {
-      on_exit_collision_(Entity(iter.first.entities[0]),
-                         Entity(iter.first.entities[1]));
+  if (on_exit_collision_) {
+    for (const CollisionPair& pair : exited_collisions_) {
+      on_exit_collision_(pair.entity_a, pair.entity_b);
     }
   }
+}
 
-  using std::swap;
-  swap(current_collisions_, previous_collisions_);
+void BulletPhysicsEngine::GatherCollisions() {
+  const int num_manifolds = bt_dispatcher_->getNumManifolds();
+  for (int i = 0; i < num_manifolds; ++i) {
+    const btPersistentManifold* manifold =
+        bt_dispatcher_->getManifoldByIndexInternal(i);
+    if (manifold->getNumContacts() == 0) {
+      continue;
+    }
+
+    auto body_a = manifold->getBody0();
+    auto body_b = manifold->getBody1();
+    Entity entity_a = EntityFromBulletUserIndex(body_a->getUserIndex());
+    Entity entity_b = EntityFromBulletUserIndex(body_b->getUserIndex());
+    CHECK(entity_a.get() && entity_b.get());
+
+    const BulletPhysicsCollisionKey key(entity_a, entity_b);
+    CHECK(key.entities[0] < key.entities[1]);
+    current_collisions_.emplace_back(key, i);
+  }
+  GatherTriggerOverlaps();
+
+  // A pair of Entities may touch through more than one manifold (eg. when an
+  // Entity has multiple bodies) or trigger volume overlap. Ordering by manifold
+  // index within a pair keeps the contact points in a stable order.
+  std::sort(current_collisions_.begin(), current_collisions_.end(),
+            [](const BulletPhysicsCollisionData& lhs,
+               const BulletPhysicsCollisionData& rhs) {
+              if (lhs.key == rhs.key) {
+                return lhs.manifold_index < rhs.manifold_index;
+              }
+              return lhs.key < rhs.key;
+            });
+
+  // Collapse the manifolds of each pair into a single entry, gathering the
+  // contact points of the pair only if someone has asked for them.
+  auto out = current_collisions_.begin();
+  auto iter = current_collisions_.begin();
+  while (iter != current_collisions_.end()) {
+    auto next = iter + 1;
+    while (next != current_collisions_.end() && next->key == iter->key) {
+      ++next;
+    }
+    if (AreContactPointsEnabled(iter->key)) {
+      GatherContacts(iter, next);
+    }
+    *out = *iter;
+    ++out;
+    iter = next;
+  }
+  current_collisions_.erase(out, current_collisions_.end());
 }
 
-void BulletPhysicsEngine::ProcessContactManifold(
-    const btPersistentManifold* manifold) {
-  const size_t num_contacts = manifold->getNumContacts();
-  if (num_contacts == 0) {
+void BulletPhysicsEngine::GatherTriggerOverlaps() {
+  if (trigger_broadphase_.GetNumProxies() == 0) {
     return;
   }
 
-  auto body_a = manifold->getBody0();
-  auto body_b = manifold->getBody1();
-  Entity entity_a = EntityFromBulletUserIndex(body_a->getUserIndex());
-  Entity entity_b = EntityFromBulletUserIndex(body_b->getUserIndex());
-  CHECK(entity_a.get() && entity_b.get());
+  // Trigger volumes are not in the Bullet world, so they have no manifolds.
+  // Their overlaps with each other come from the trigger broadphase, and their
+  // overlaps with rigid bodies from querying Bullet's broadphase.
+  for (const CollisionPair& pair : trigger_broadphase_.FindOverlaps()) {
+    current_collisions_.emplace_back(
+        BulletPhysicsCollisionKey(pair.entity_a, pair.entity_b), -1);
+  }
+  trigger_broadphase_.ForEachProxy(
+      [this](Entity entity, const Box& box, Bits32 group, Bits32 filter) {
+        TriggerAabbCallback callback(entity, group, filter,
+                                     &current_collisions_);
+        bt_broadphase_->aabbTest(ToBullet(box.min), ToBullet(box.max),
+                                 callback);
+      });
+}
 
-  const BulletPhysicsCollisionKey key(entity_a, entity_b);
-  CHECK(key.entities[0] < key.entities[1]);
-  const bool flip_normal = entity_a.get() > entity_b.get();
+void BulletPhysicsEngine::GatherContacts(CollisionList::iterator collision,
+                                         CollisionList::iterator end) {
+  collision->contact_index = contacts_.size();
+  for (auto iter = collision; iter != end; ++iter) {
+    if (iter->manifold_index < 0) {
+      continue;  // A trigger volume overlap, which has no contact points.
+    }
+    const btPersistentManifold* manifold =
+        bt_dispatcher_->getManifoldByIndexInternal(iter->manifold_index);
+    const Entity entity_a =
+        EntityFromBulletUserIndex(manifold->getBody0()->getUserIndex());
+    const bool flip_normal = entity_a.get() != collision->key.entities[0];
+
+    const int num_contacts = manifold->getNumContacts();
+    for (int i = 0; i < num_contacts; ++i) {
+      const btManifoldPoint& bt_contact = manifold->getContactPoint(i);
+
+      ContactPoint point;
+      point.world_position = FromBullet(bt_contact.getPositionWorldOnB());
+      point.contact_normal = flip_normal
+                                 ? FromBullet(bt_contact.m_normalWorldOnB)
+                                 : -FromBullet(bt_contact.m_normalWorldOnB);
+      contacts_.emplace_back(point);
+    }
+  }
+  collision->num_contacts = contacts_.size() - collision->contact_index;
+}
 
-  const size_t start = contacts_.size();
-  current_collisions_[key] = {manifold, start, num_contacts};
-  for (size_t i = 0; i < num_contacts; ++i) {
-    const btManifoldPoint& bt_contact = manifold->getContactPoint(i);
+void BulletPhysicsEngine::DiffCollisions() {
+  entered_collisions_.clear();
+  exited_collisions_.clear();
+
+  auto ToPair = [](const BulletPhysicsCollisionKey& key) {
+    return CollisionPair{Entity(key.entities[0]), Entity(key.entities[1])};
+  };
+
+  // Both lists are sorted by key, so a single merge pass finds the pairs that
+  // are only in the current list (entered) or only in the previous (exited).
+  auto curr = current_collisions_.cbegin();
+  auto prev = previous_collisions_.cbegin();
+  while (curr != current_collisions_.cend() ||
+         prev != previous_collisions_.cend()) {
+    if (prev == previous_collisions_.cend() ||
+        (curr != current_collisions_.cend() && curr->key < prev->key)) {
+      entered_collisions_.push_back(ToPair(curr->key));
+      ++curr;
+    } else if (curr == current_collisions_.cend() || prev->key < curr->key) {
+      exited_collisions_.push_back(ToPair(prev->key));
+      ++prev;
+    } else {
+      ++curr;
+      ++prev;
+    }
+  }
+}
+
+bool BulletPhysicsEngine::AreContactPointsEnabled(
+    const BulletPhysicsCollisionKey& key) const {
+  if (contact_point_entities_.empty()) {
+    return false;
+  }
+  return contact_point_entities_.contains(Entity(key.entities[0])) ||
+         contact_point_entities_.contains(Entity(key.entities[1]));
+}
 
-    ContactPoint point;
-    point.world_position = FromBullet(bt_contact.getPositionWorldOnB());
-    point.contact_normal = flip_normal
-                               ? FromBullet(bt_contact.m_normalWorldOnB)
-                               : -FromBullet(bt_contact.m_normalWorldOnB);
-    contacts_.emplace_back(point);
+void BulletPhysicsEngine::SetContactPointsEnabled(Entity entity,
+                                                  bool enabled) {
+  if (enabled) {
+    contact_point_entities_.insert(entity);
+  } else {
+    contact_point_entities_.erase(entity);
   }
 }
 
 absl::Span<const BulletPhysicsEngine::ContactPoint>
 BulletPhysicsEngine::GetActiveContacts(Entity entity_a, Entity entity_b) const {
   const BulletPhysicsCollisionKey key(entity_a, entity_b);
-  auto iter = current_collisions_.find(key);
-  if (iter != current_collisions_.end()) {
+  auto iter = std::lower_bound(
+      current_collisions_.begin(), current_collisions_.end(), key,
+      [](const BulletPhysicsCollisionData& lhs,
+         const BulletPhysicsCollisionKey& rhs) { return lhs.key < rhs; });
+  if (iter != current_collisions_.end() && iter->key == key &&
+      iter->num_contacts > 0) {
     return absl::Span<const BulletPhysicsEngine::ContactPoint>(
-        &contacts_[iter->second.contact_index], iter->second.num_contacts);
+        &contacts_[iter->contact_index], iter->num_contacts);
   }
   return {};
 }
 
+void BulletPhysicsEngine::SetGravity(const vec3& gravity) {
+  gravity_ = gravity;
+  bt_world_->setGravity(ToBullet(gravity_));
+}
+
+void BulletPhysicsEngine::SetTimestep(absl::Duration timestep,
+                                      int max_substeps) {
+  CHECK(timestep > absl::ZeroDuration());
+  CHECK_GT(max_substeps, 0);
+  timestep_ = static_cast<float>(absl::ToDoubleSeconds(timestep));
+  max_substeps_ = max_substeps;
+}
+
 void BulletPhysicsEngine::AdvanceFrame(absl::Duration timestep) {
-  // During one AdvanceFrame() call, do at most a set number of 1/60 second
-  // updates. Bullet will update the MotionStates of every Dynamic Entity that
-  // has a transform update. These Entities will be marked for synchronization.
+  // During one AdvanceFrame() call, do at most a set number of fixed timestep
+  // updates. Any remaining time is accumulated by Bullet, which interpolates
+  // the MotionStates of every awake Dynamic Entity by that remainder. Only the
+  // ones whose interpolated transform changed are recorded in updated_poses_.
+  updated_poses_.Clear();
   const float dt = static_cast<float>(absl::ToDoubleSeconds(timestep));
   bt_world_->stepSimulation(dt, max_substeps_, timestep_);
 }
 
+PhysicsEngine::RigidBodyPoses BulletPhysicsEngine::GetUpdatedRigidBodyPoses()
+    const {
+  RigidBodyPoses poses;
+  poses.entities = updated_poses_.entities;
+  poses.positions = updated_poses_.positions;
+  poses.rotations = updated_poses_.rotations;
+  return poses;
+}
+
 void BulletPhysicsEngine::OnRegistryInitialize() {
   auto* choreographer = registry_->Get<Choreographer>();
   if (choreographer) {
@@ -156,33 +357,68 @@ void BulletPhysicsEngine::SetOnExitCollisionCallback(CollisionCallback cb) {
   on_exit_collision_ = std::move(cb);
 }
 
+void BulletPhysicsEngine::SetCollisionBatchCallback(
+    CollisionBatchCallback cb) {
+  on_collision_batch_ = std::move(cb);
+}
+
 RigidBodyPtr BulletPhysicsEngine::CreateRigidBody(
     const RigidBodyParams& params) {
-  auto ptr = std::make_shared<BulletRigidBody>(params, bt_world_.get());
+  auto ptr = std::make_shared<BulletRigidBody>(params, bt_world_.get(),
+                                                &updated_poses_);
   return std::static_pointer_cast<RigidBody>(ptr);
 }
 
 TriggerVolumePtr BulletPhysicsEngine::CreateTriggerVolume(
     const TriggerVolumeParams& params) {
-  auto ptr = std::make_shared<BulletTriggerVolume>(params, bt_world_.get());
+  auto ptr =
+      std::make_shared<BulletTriggerVolume>(params, &trigger_broadphase_);
   return std::static_pointer_cast<TriggerVolume>(ptr);
 }
 
 CollisionShapePtr BulletPhysicsEngine::CreateShape(
     CollisionDataPtr shape_data) {
+  CHECK(shape_data);
+  const HashValue hash = shape_data->GetContentHash();
+  std::weak_ptr<BulletCollisionShape>& interned = interned_shapes_[hash];
+  if (auto existing = interned.lock()) {
+    // Guard against hash collisions; on a mismatch the newer shape replaces
+    // the existing one in the table.
+    if (existing->GetCollisionData().HasSameContents(*shape_data)) {
+      return std::static_pointer_cast<CollisionShape>(existing);
+    }
+  }
+
   auto ptr = std::make_shared<BulletCollisionShape>(std::move(shape_data));
+  interned = ptr;
+  if (interned_shapes_.size() >= interned_shapes_prune_size_) {
+    PruneInternedShapes();
+  }
   return std::static_pointer_cast<CollisionShape>(ptr);
 }
 
 CollisionShapePtr BulletPhysicsEngine::CreateShape(HashValue name) {
   auto ptr = shape_data_.Find(name);
   if (ptr) {
-    auto impl = std::make_shared<BulletCollisionShape>(ptr);
-    return std::static_pointer_cast<CollisionShape>(impl);
+    return CreateShape(std::move(ptr));
   }
   return nullptr;
 }
 
+void BulletPhysicsEngine::PruneInternedShapes() {
+  for (auto iter = interned_shapes_.begin(); iter != interned_shapes_.end();) {
+    if (iter->second.expired()) {
+      interned_shapes_.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+  // Only prune again once the table has doubled, so that pruning is amortized
+  // over the shapes that are created.
+  interned_shapes_prune_size_ =
+      std::max<size_t>(64, 2 * interned_shapes_.size());
+}
+
 void BulletPhysicsEngine::CacheShapeData(HashValue name,
                                          CollisionDataPtr data) {
   shape_data_.Register(name, std::move(data));
@@ -18,13 +18,18 @@ limitations under the License.
 #define REDUX_ENGINES_PHYSICS_BULLET_BULLET_PHYSICS_ENGINE_H_
 
 #include <algorithm>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "btBulletDynamicsCommon.h"
 #include "redux/engines/physics/bullet/bullet_collision_shape.h"
 #include "redux/engines/physics/bullet/bullet_rigid_body.h"
+#include "redux/engines/physics/bullet/bullet_task_scheduler.h"
 #include "redux/engines/physics/bullet/bullet_trigger_volume.h"
 #include "redux/engines/physics/bullet/bullet_utils.h"
 #include "redux/engines/physics/physics_engine.h"
+#include "redux/engines/physics/trigger_broadphase.h"
 #include "redux/modules/base/choreographer.h"
 #include "redux/modules/base/static_registry.h"
 #include "redux/modules/ecs/entity.h"
@@ -47,6 +52,10 @@ struct BulletPhysicsCollisionKey {
     return key == rhs.key;
   }
 
+  bool operator<(const BulletPhysicsCollisionKey& rhs) const {
+    return key < rhs.key;
+  }
+
   union {
     uint64_t key;
     Entity::Rep entities[2];
@@ -54,14 +63,30 @@ struct BulletPhysicsCollisionKey {
 };
 
 struct BulletPhysicsCollisionData {
-  const btPersistentManifold* manifold = nullptr;
+  explicit BulletPhysicsCollisionData(BulletPhysicsCollisionKey key,
+                                      int manifold_index)
+      : key(key), manifold_index(manifold_index) {}
+
+  BulletPhysicsCollisionKey key;
+  int manifold_index = 0;
   size_t contact_index = 0;
   size_t num_contacts = 0;
 };
 
+// Define this macro to simulate physics on the given number of threads (or 0
+// for one thread per hardware thread). This requires Bullet to be built with
+// BT_THREADSAFE=1, eg. by building with:
+//   --copt=-DBT_THREADSAFE=1 --copt=-DREDUX_BULLET_NUM_THREADS=0
+// #define REDUX_BULLET_NUM_THREADS 0
+
 class BulletPhysicsEngine : public PhysicsEngine {
  public:
-  explicit BulletPhysicsEngine(Registry* registry);
+  // If `num_threads` is not 1, the world is simulated by Bullet's
+  // multi-threaded dynamics world, running on a BulletTaskScheduler with
+  // `num_threads` threads (0 for one per hardware thread). Otherwise, or if
+  // Bullet is not built with BT_THREADSAFE=1, the world is single-threaded.
+  explicit BulletPhysicsEngine(Registry* registry, int num_threads = 1);
+  ~BulletPhysicsEngine() override;
 
   void OnRegistryInitialize();
 
@@ -79,13 +104,20 @@ class BulletPhysicsEngine : public PhysicsEngine {
   // Advances the physics simulation by the given timestep.
   void AdvanceFrame(absl::Duration timestep);
 
+  // Returns the poses of the dynamic rigid bodies that moved during the last
+  // AdvanceFrame. When the frame time is not a multiple of the timestep, these
+  // are interpolated by Bullet past the last fixed step.
+  RigidBodyPoses GetUpdatedRigidBodyPoses() const;
+
   // Creates an active rigid body using the provided data.
   RigidBodyPtr CreateRigidBody(const RigidBodyParams& params);
 
   // Creates an active trigger volume using the provided data.
   TriggerVolumePtr CreateTriggerVolume(const TriggerVolumeParams& params);
 
-  // Creates a CollisionShape using the provided data.
+  // Creates a CollisionShape using the provided data. Shapes are interned by
+  // content, so this returns the existing CollisionShape if one with the same
+  // data is still alive.
   CollisionShapePtr CreateShape(CollisionDataPtr shape_data);
 
   // Creates a CollisionShape using the data associated with |name|.
@@ -111,8 +143,17 @@ class BulletPhysicsEngine : public PhysicsEngine {
   // volumes.
   void SetOnExitCollisionCallback(CollisionCallback cb);
 
+  // Sets the callback to invoke once per simulation step with all the
+  // collisions that started and ended during that step.
+  void SetCollisionBatchCallback(CollisionBatchCallback cb);
+
+  // Enables (or disables) gathering the contact points of all collisions
+  // involving `entity`.
+  void SetContactPointsEnabled(Entity entity, bool enabled);
+
   // Returns information about all the contacts between two Entities. Should be
-  // used in conjunction with the above collision callbacks.
+  // used in conjunction with the above collision callbacks. Returns an empty
+  // span unless contact points are enabled for either Entity.
   absl::Span<const ContactPoint> GetActiveContacts(Entity entity_a,
                                                    Entity entity_b) const;
 
@@ -120,23 +161,44 @@ class BulletPhysicsEngine : public PhysicsEngine {
   void OnSimTick();
 
  private:
-  using CollisionMap = absl::flat_hash_map<BulletPhysicsCollisionKey,
-                                           BulletPhysicsCollisionData>;
-
-  void ProcessContactManifold(const btPersistentManifold* manifold);
+  // Collisions are stored in flat arrays sorted by key so that consecutive
+  // steps can be diffed in a single linear pass. The arrays (and the contacts_
+  // and entered/exited arrays) are cleared rather than freed between steps so
+  // that, once warmed up, a step does not allocate.
+  using CollisionList = std::vector<BulletPhysicsCollisionData>;
+
+  void GatherCollisions();
+  void GatherTriggerOverlaps();
+  void GatherContacts(CollisionList::iterator collision,
+                      CollisionList::iterator end);
+  void DiffCollisions();
+  bool AreContactPointsEnabled(const BulletPhysicsCollisionKey& key) const;
+  void PruneInternedShapes();
 
   Registry* registry_ = nullptr;
   ResourceManager<CollisionData> shape_data_;
+  // All live shapes keyed by the content hash of their CollisionData.
+  absl::flat_hash_map<HashValue, std::weak_ptr<BulletCollisionShape>>
+      interned_shapes_;
+  size_t interned_shapes_prune_size_ = 64;
+  // Declared before the Bullet objects so that it outlives the world.
+  std::unique_ptr<BulletTaskScheduler> task_scheduler_;
   CollisionCallback on_enter_collision_;
   CollisionCallback on_exit_collision_;
+  CollisionBatchCallback on_collision_batch_;
   std::unique_ptr<btCollisionConfiguration> bt_config_;
   std::unique_ptr<btCollisionDispatcher> bt_dispatcher_;
   std::unique_ptr<btBroadphaseInterface> bt_broadphase_;
   std::unique_ptr<btConstraintSolver> bt_solver_;
   std::unique_ptr<btDiscreteDynamicsWorld> bt_world_;
-  CollisionMap current_collisions_;
-  CollisionMap previous_collisions_;
+  TriggerBroadphase trigger_broadphase_;
+  CollisionList current_collisions_;
+  CollisionList previous_collisions_;
+  std::vector<CollisionPair> entered_collisions_;
+  std::vector<CollisionPair> exited_collisions_;
   std::vector<ContactPoint> contacts_;
+  BulletRigidBodyPoses updated_poses_;
+  absl::flat_hash_set<Entity> contact_point_entities_;
   vec3 gravity_ = {0, -9.81, 0};
   float timestep_ = 1 / 60.f;
   int max_substeps_ = 4;
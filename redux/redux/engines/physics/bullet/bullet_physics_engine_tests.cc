@@ -0,0 +1,203 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/physics/bullet/bullet_physics_engine.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "redux/engines/physics/collision_data.h"
+#include "redux/modules/base/registry.h"
+
+namespace redux {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Not;
+using ::testing::SizeIs;
+
+using EntityPair = std::pair<Entity, Entity>;
+
+const Entity kEntityA(1);
+const Entity kEntityB(2);
+const Entity kEntityC(3);
+
+std::vector<EntityPair> ToPairs(
+    absl::Span<const PhysicsEngine::CollisionPair> collisions) {
+  std::vector<EntityPair> pairs;
+  for (const auto& collision : collisions) {
+    pairs.emplace_back(collision.entity_a, collision.entity_b);
+  }
+  return pairs;
+}
+
+class BulletPhysicsEngineTest : public ::testing::Test {
+ protected:
+  BulletPhysicsEngineTest() : engine_(&registry_) {
+    engine_.SetGravity(vec3::Zero());
+    // Each AdvanceFrame below runs exactly one simulation step.
+    engine_.SetTimestep(kTimestep, 1);
+  }
+
+  CollisionShapePtr CreateSphereShape(float radius) {
+    auto data = std::make_shared<CollisionData>();
+    data->AddSphere(vec3::Zero(), radius);
+    return engine_.CreateShape(std::move(data));
+  }
+
+  RigidBodyPtr CreateSphere(Entity entity, RigidBodyMotionType type,
+                            const vec3& position) {
+    RigidBodyParams params;
+    params.type = type;
+    params.mass = type == RigidBodyMotionType::Dynamic ? 1.f : 0.f;
+    params.shape = CreateSphereShape(1.f);
+    params.entity = entity;
+    RigidBodyPtr body = engine_.CreateRigidBody(params);
+    MoveTo(body.get(), position);
+    return body;
+  }
+
+  void MoveTo(RigidBody* body, const vec3& position) {
+    Transform transform;
+    transform.translation = position;
+    body->SetTransform(transform);
+    body->SetLinearVelocity(vec3::Zero());
+  }
+
+  void Step() { engine_.AdvanceFrame(kTimestep * 2); }
+
+  static constexpr absl::Duration kTimestep = absl::Milliseconds(10);
+
+  Registry registry_;
+  BulletPhysicsEngine engine_;
+};
+
+TEST_F(BulletPhysicsEngineTest, CollisionBatchReportsEnterAndExit) {
+  std::vector<std::vector<EntityPair>> entered;
+  std::vector<std::vector<EntityPair>> exited;
+  engine_.SetCollisionBatchCallback(
+      [&](absl::Span<const PhysicsEngine::CollisionPair> enter,
+          absl::Span<const PhysicsEngine::CollisionPair> exit) {
+        entered.push_back(ToPairs(enter));
+        exited.push_back(ToPairs(exit));
+      });
+
+  // Created in the opposite order so that the pair has to be sorted.
+  auto b = CreateSphere(kEntityB, RigidBodyMotionType::Static, vec3(0, 0, 0));
+  auto a = CreateSphere(kEntityA, RigidBodyMotionType::Dynamic, vec3(1, 0, 0));
+
+  Step();
+  ASSERT_THAT(entered, SizeIs(1));
+  EXPECT_THAT(entered[0], ElementsAre(EntityPair(kEntityA, kEntityB)));
+  EXPECT_THAT(exited[0], IsEmpty());
+
+  // Staying in contact does not report the pair again, and the callback is
+  // skipped when nothing changed.
+  MoveTo(a.get(), vec3(1, 0, 0));
+  Step();
+  EXPECT_THAT(entered, SizeIs(1));
+
+  MoveTo(a.get(), vec3(10, 0, 0));
+  Step();
+  ASSERT_THAT(entered, SizeIs(2));
+  EXPECT_THAT(entered[1], IsEmpty());
+  EXPECT_THAT(exited[1], ElementsAre(EntityPair(kEntityA, kEntityB)));
+}
+
+TEST_F(BulletPhysicsEngineTest, PerPairCallbacksMatchBatch) {
+  std::vector<EntityPair> entered;
+  std::vector<EntityPair> exited;
+  engine_.SetOnEnterCollisionCallback(
+      [&](Entity a, Entity b) { entered.emplace_back(a, b); });
+  engine_.SetOnExitCollisionCallback(
+      [&](Entity a, Entity b) { exited.emplace_back(a, b); });
+
+  auto a = CreateSphere(kEntityA, RigidBodyMotionType::Dynamic, vec3(1, 0, 0));
+  auto b = CreateSphere(kEntityB, RigidBodyMotionType::Static, vec3(0, 0, 0));
+
+  Step();
+  EXPECT_THAT(entered, ElementsAre(EntityPair(kEntityA, kEntityB)));
+  EXPECT_THAT(exited, IsEmpty());
+
+  MoveTo(a.get(), vec3(10, 0, 0));
+  Step();
+  EXPECT_THAT(entered, ElementsAre(EntityPair(kEntityA, kEntityB)));
+  EXPECT_THAT(exited, ElementsAre(EntityPair(kEntityA, kEntityB)));
+}
+
+TEST_F(BulletPhysicsEngineTest, ContactPointsOnlyForEnabledEntities) {
+  auto a = CreateSphere(kEntityA, RigidBodyMotionType::Dynamic, vec3(1, 0, 0));
+  auto b = CreateSphere(kEntityB, RigidBodyMotionType::Static, vec3(0, 0, 0));
+
+  Step();
+  EXPECT_THAT(engine_.GetActiveContacts(kEntityA, kEntityB), IsEmpty());
+
+  engine_.SetContactPointsEnabled(kEntityB, true);
+  MoveTo(a.get(), vec3(1, 0, 0));
+  Step();
+  EXPECT_THAT(engine_.GetActiveContacts(kEntityA, kEntityB), Not(IsEmpty()));
+  EXPECT_THAT(engine_.GetActiveContacts(kEntityB, kEntityA), Not(IsEmpty()));
+
+  engine_.SetContactPointsEnabled(kEntityB, false);
+  MoveTo(a.get(), vec3(1, 0, 0));
+  Step();
+  EXPECT_THAT(engine_.GetActiveContacts(kEntityA, kEntityB), IsEmpty());
+}
+
+TEST_F(BulletPhysicsEngineTest, UpdatedPosesOnlyIncludeMovedBodies) {
+  auto moving = CreateSphere(kEntityA, RigidBodyMotionType::Dynamic,
+                             vec3(0, 0, 0));
+  auto resting = CreateSphere(kEntityB, RigidBodyMotionType::Dynamic,
+                              vec3(10, 0, 0));
+  auto fixed = CreateSphere(kEntityC, RigidBodyMotionType::Static,
+                            vec3(20, 0, 0));
+  moving->SetLinearVelocity(vec3(1, 0, 0));
+
+  Step();
+  auto poses = engine_.GetUpdatedRigidBodyPoses();
+  EXPECT_THAT(poses.entities, ElementsAre(kEntityA));
+  ASSERT_THAT(poses.positions, SizeIs(1));
+  ASSERT_THAT(poses.rotations, SizeIs(1));
+  EXPECT_GT(poses.positions[0].x, 0.f);
+  EXPECT_EQ(poses.positions[0].x, moving->GetPosition().x);
+
+  // Once stopped, the body's pose is no longer written back.
+  MoveTo(moving.get(), vec3(0, 0, 0));
+  Step();
+  poses = engine_.GetUpdatedRigidBodyPoses();
+  EXPECT_THAT(poses.entities, IsEmpty());
+  EXPECT_THAT(poses.positions, IsEmpty());
+  EXPECT_THAT(poses.rotations, IsEmpty());
+}
+
+TEST_F(BulletPhysicsEngineTest, CreateShapeInternsEqualData) {
+  CollisionShapePtr shape = CreateSphereShape(1.f);
+  EXPECT_EQ(shape, CreateSphereShape(1.f));
+  EXPECT_NE(shape, CreateSphereShape(2.f));
+
+  auto data = std::make_shared<CollisionData>();
+  data->AddSphere(vec3::Zero(), 1.f);
+  engine_.CacheShapeData(ConstHash("sphere"), std::move(data));
+  EXPECT_EQ(shape, engine_.CreateShape(ConstHash("sphere")));
+}
+
+}  // namespace
+}  // namespace redux
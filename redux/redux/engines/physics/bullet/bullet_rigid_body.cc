@@ -16,19 +16,31 @@ limitations under the License.
 
 #include "redux/engines/physics/bullet/bullet_rigid_body.h"
 
-#include "LinearMath/btDefaultMotionState.h"
 #include "redux/engines/physics/bullet/bullet_collision_shape.h"
 #include "redux/engines/physics/bullet/bullet_utils.h"
 #include "redux/modules/base/bits.h"
 
 namespace redux {
 
+void BulletMotionState::setWorldTransform(const btTransform& transform) {
+  if (transform == transform_) {
+    return;
+  }
+  transform_ = transform;
+  if (poses_) {
+    poses_->entities.push_back(entity_);
+    poses_->positions.push_back(FromBullet(transform.getOrigin()));
+    poses_->rotations.push_back(FromBullet(transform.getRotation()));
+  }
+}
+
 BulletRigidBody::BulletRigidBody(const RigidBodyParams& params,
-                                 btDynamicsWorld* world)
+                                 btDynamicsWorld* world,
+                                 BulletRigidBodyPoses* poses)
     : params_(params), world_(world) {
   btCollisionShape* bt_shape = GetUnderlyingBtCollisionShape();
 
-  bt_motion_state_ = std::make_unique<btDefaultMotionState>();
+  bt_motion_state_ = std::make_unique<BulletMotionState>(params.entity, poses);
 
   btVector3 inertia(0.f, 0.f, 0.f);
   bt_shape->calculateLocalInertia(params.mass, inertia);
@@ -85,9 +97,25 @@ bool BulletRigidBody::IsActive() const { return bt_rigid_body_->isInWorld(); }
 void BulletRigidBody::SetTransform(const Transform& transform) {
   const auto bt_translation = ToBullet(transform.translation);
   const auto bt_rotation = ToBullet(transform.rotation);
-  const auto bt_scale = ToBullet(transform.scale);
-  bt_rigid_body_->setWorldTransform(btTransform(bt_rotation, bt_translation));
-  GetUnderlyingBtCollisionShape()->setLocalScaling(bt_scale);
+  const btTransform bt_transform(bt_rotation, bt_translation);
+  bt_rigid_body_->setWorldTransform(bt_transform);
+  bt_rigid_body_->setInterpolationWorldTransform(bt_transform);
+  bt_motion_state_->ResetWorldTransform(bt_transform);
+  SetScale(transform.scale);
+}
+
+void BulletRigidBody::SetScale(const vec3& scale) {
+  btCollisionShape* bt_shape =
+      Upcast(params_.shape.get())->GetUnderlyingBtCollisionShape(scale);
+  if (bt_shape == bt_rigid_body_->getCollisionShape()) {
+    return;
+  }
+  bt_rigid_body_->setCollisionShape(bt_shape);
+  if (bt_rigid_body_->isInWorld()) {
+    // Drop the collision algorithms that were created for the old shape.
+    world_->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(
+        bt_rigid_body_->getBroadphaseHandle(), world_->getDispatcher());
+  }
 }
 
 vec3 BulletRigidBody::GetPosition() const {
@@ -104,7 +132,8 @@ quat BulletRigidBody::GetRotation() const {
 
 void BulletRigidBody::SetMass(float mass_in_kg) {
   btVector3 inertia(0.f, 0.f, 0.f);
-  GetUnderlyingBtCollisionShape()->calculateLocalInertia(mass_in_kg, inertia);
+  bt_rigid_body_->getCollisionShape()->calculateLocalInertia(mass_in_kg,
+                                                             inertia);
   bt_rigid_body_->setMassProps(mass_in_kg, inertia);
   // setMassProps() can change collision flags, so reset them to be sure.
   UpdateFlags();
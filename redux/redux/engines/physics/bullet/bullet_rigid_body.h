@@ -17,17 +17,60 @@ limitations under the License.
 #ifndef REDUX_ENGINES_PHYSICS_BULLET_BULLET_RIGID_BODY_H_
 #define REDUX_ENGINES_PHYSICS_BULLET_BULLET_RIGID_BODY_H_
 
+#include <vector>
+
 #include "BulletDynamics/Dynamics/btDynamicsWorld.h"
 #include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btMotionState.h"
 #include "redux/engines/physics/rigid_body.h"
 
 namespace redux {
 
 class PhysicsWorld;
 
+// The poses of the rigid bodies that moved during a frame, stored as parallel
+// arrays so they can be written back in a single pass.
+struct BulletRigidBodyPoses {
+  void Clear() {
+    entities.clear();
+    positions.clear();
+    rotations.clear();
+  }
+
+  std::vector<Entity> entities;
+  std::vector<vec3> positions;
+  std::vector<quat> rotations;
+};
+
+// Bullet calls setWorldTransform once per stepSimulation for every awake
+// dynamic body with the transform interpolated between the last two fixed
+// steps. Only transforms that differ from the previous one are recorded.
+class BulletMotionState : public btMotionState {
+ public:
+  BulletMotionState(Entity entity, BulletRigidBodyPoses* poses)
+      : entity_(entity), poses_(poses) {}
+
+  void getWorldTransform(btTransform& transform) const override {
+    transform = transform_;
+  }
+
+  void setWorldTransform(const btTransform& transform) override;
+
+  // Sets the transform without recording it as a pose change.
+  void ResetWorldTransform(const btTransform& transform) {
+    transform_ = transform;
+  }
+
+ private:
+  Entity entity_;
+  BulletRigidBodyPoses* poses_ = nullptr;
+  btTransform transform_ = btTransform::getIdentity();
+};
+
 class BulletRigidBody : public RigidBody {
  public:
-  BulletRigidBody(const RigidBodyParams& params, btDynamicsWorld* world);
+  BulletRigidBody(const RigidBodyParams& params, btDynamicsWorld* world,
+                  BulletRigidBodyPoses* poses);
   ~BulletRigidBody() override;
 
   // Enables the rigid body to be included in any dynamics calculations and
@@ -125,11 +168,13 @@ class BulletRigidBody : public RigidBody {
 
  private:
   void UpdateFlags();
+  // Switches to the variant of the (shared) collision shape with `scale`.
+  void SetScale(const vec3& scale);
   btCollisionShape* GetUnderlyingBtCollisionShape();
 
   RigidBodyParams params_;
   btDynamicsWorld* world_ = nullptr;
-  std::unique_ptr<btMotionState> bt_motion_state_;
+  std::unique_ptr<BulletMotionState> bt_motion_state_;
   std::unique_ptr<btRigidBody> bt_rigid_body_;
 };
 
@@ -0,0 +1,136 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/physics/bullet/bullet_task_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+
+namespace redux {
+
+static int GetMaxNumThreads(int num_threads) {
+#ifdef REDUX_DISABLE_THREADS
+  return 1;
+#else
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  return std::clamp(num_threads, 1, BT_MAX_THREAD_COUNT);
+#endif
+}
+
+struct BulletTaskScheduler::Loop {
+  ChunkFn fn;
+  int begin = 0;
+  int end = 0;
+  int grain_size = 1;
+  int num_chunks = 0;
+  std::atomic<int> next_chunk = 0;
+  std::atomic<int> remaining_chunks = 0;
+  absl::Notification done;
+};
+
+// The calling thread is one of the threads processing each loop, so only
+// max_num_threads - 1 worker threads are needed.
+BulletTaskScheduler::BulletTaskScheduler(int num_threads)
+    : btITaskScheduler("redux"),
+      processor_(GetMaxNumThreads(num_threads) - 1),
+      max_num_threads_(GetMaxNumThreads(num_threads)),
+      num_threads_(max_num_threads_) {}
+
+void BulletTaskScheduler::setNumThreads(int num_threads) {
+  num_threads_ = std::clamp(num_threads, 1, max_num_threads_);
+}
+
+void BulletTaskScheduler::parallelFor(int begin, int end, int grain_size,
+                                      const btIParallelForBody& body) {
+  Run(begin, end, grain_size, [&body](int, int chunk_begin, int chunk_end) {
+    body.forLoop(chunk_begin, chunk_end);
+  });
+}
+
+btScalar BulletTaskScheduler::parallelSum(int begin, int end, int grain_size,
+                                          const btIParallelSumBody& body) {
+  // Each chunk writes its own partial sum, and the partial sums are added in
+  // order, so the result doesn't depend on how the chunks were scheduled.
+  const int num_chunks = (end - begin + std::max(grain_size, 1) - 1) /
+                         std::max(grain_size, 1);
+  std::vector<btScalar> sums(std::max(num_chunks, 1), btScalar(0));
+  Run(begin, end, grain_size,
+      [&body, &sums](int chunk, int chunk_begin, int chunk_end) {
+        sums[chunk] = body.sumLoop(chunk_begin, chunk_end);
+      });
+
+  btScalar sum = 0;
+  for (btScalar partial_sum : sums) {
+    sum += partial_sum;
+  }
+  return sum;
+}
+
+void BulletTaskScheduler::Run(int begin, int end, int grain_size, ChunkFn fn) {
+  if (begin >= end) {
+    return;
+  }
+
+  grain_size = std::max(grain_size, 1);
+  const int num_chunks = (end - begin + grain_size - 1) / grain_size;
+  const int num_workers = std::min(num_threads_, num_chunks) - 1;
+  if (num_workers <= 0) {
+    fn(0, begin, end);
+    return;
+  }
+
+  // Workers that start after all the chunks have been claimed still hold a
+  // reference to the loop, but never call its function.
+  auto loop = std::make_shared<Loop>();
+  loop->fn = std::move(fn);
+  loop->begin = begin;
+  loop->end = end;
+  loop->grain_size = grain_size;
+  loop->num_chunks = num_chunks;
+  loop->remaining_chunks = num_chunks;
+  for (int i = 0; i < num_workers; ++i) {
+    processor_.Execute(Task{loop}, &BulletTaskScheduler::ProcessTask);
+  }
+  RunChunks(loop.get());
+  loop->done.WaitForNotification();
+}
+
+void BulletTaskScheduler::ProcessTask(Task* task) {
+  RunChunks(task->loop.get());
+}
+
+void BulletTaskScheduler::RunChunks(Loop* loop) {
+  while (true) {
+    const int chunk = loop->next_chunk.fetch_add(1);
+    if (chunk >= loop->num_chunks) {
+      return;
+    }
+    const int begin = loop->begin + chunk * loop->grain_size;
+    const int end = std::min(begin + loop->grain_size, loop->end);
+    loop->fn(chunk, begin, end);
+    if (loop->remaining_chunks.fetch_sub(1) == 1) {
+      loop->done.Notify();
+    }
+  }
+}
+
+}  // namespace redux
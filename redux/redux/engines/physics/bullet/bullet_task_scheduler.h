@@ -0,0 +1,73 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_PHYSICS_BULLET_BULLET_TASK_SCHEDULER_H_
+#define REDUX_ENGINES_PHYSICS_BULLET_BULLET_TASK_SCHEDULER_H_
+
+#include <functional>
+#include <memory>
+
+#include "LinearMath/btThreads.h"
+#include "redux/modules/base/async_processor.h"
+
+namespace redux {
+
+// Runs the parallel loops of Bullet's multi-threaded dynamics world on a pool
+// of worker threads. The thread that starts a loop also processes it, so a loop
+// runs on at most getNumThreads() threads in total.
+class BulletTaskScheduler : public btITaskScheduler {
+ public:
+  // Creates the worker threads. If `num_threads` is 0, one thread per hardware
+  // thread is used.
+  explicit BulletTaskScheduler(int num_threads = 0);
+
+  BulletTaskScheduler(const BulletTaskScheduler&) = delete;
+  BulletTaskScheduler& operator=(const BulletTaskScheduler&) = delete;
+
+  int getMaxNumThreads() const override { return max_num_threads_; }
+  int getNumThreads() const override { return num_threads_; }
+  void setNumThreads(int num_threads) override;
+
+  void parallelFor(int begin, int end, int grain_size,
+                   const btIParallelForBody& body) override;
+
+  btScalar parallelSum(int begin, int end, int grain_size,
+                       const btIParallelSumBody& body) override;
+
+ private:
+  struct Loop;
+
+  struct Task {
+    std::shared_ptr<Loop> loop;
+  };
+
+  using ChunkFn = std::function<void(int chunk, int begin, int end)>;
+
+  // Splits [begin, end) into chunks of `grain_size` and calls `fn` for each of
+  // them, returning once all the chunks are done.
+  void Run(int begin, int end, int grain_size, ChunkFn fn);
+
+  static void RunChunks(Loop* loop);
+  static void ProcessTask(Task* task);
+
+  AsyncProcessor<Task> processor_;
+  int max_num_threads_ = 1;
+  int num_threads_ = 1;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_ENGINES_PHYSICS_BULLET_BULLET_TASK_SCHEDULER_H_
@@ -0,0 +1,133 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/physics/bullet/bullet_task_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Each;
+using ::testing::Eq;
+using ::testing::Gt;
+
+// Squares each index, counting the visits to each index and the threads that
+// ran the loop.
+class SquareBody : public btIParallelForBody {
+ public:
+  explicit SquareBody(int size) : squares_(size), visits_(size) {}
+
+  void forLoop(int begin, int end) const override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      thread_ids_.insert(std::this_thread::get_id());
+    }
+    for (int i = begin; i < end; ++i) {
+      squares_[i] = i * i;
+      ++visits_[i];
+    }
+    // Keep each chunk busy long enough for the workers to claim some.
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+
+  std::vector<int> GetSquares() const { return squares_; }
+
+  std::vector<int> GetVisits() const {
+    return std::vector<int>(visits_.begin(), visits_.end());
+  }
+
+  size_t GetNumThreads() const { return thread_ids_.size(); }
+
+ private:
+  mutable std::vector<int> squares_;
+  mutable std::vector<std::atomic<int>> visits_;
+  mutable std::mutex mutex_;
+  mutable std::set<std::thread::id> thread_ids_;
+};
+
+class SumBody : public btIParallelSumBody {
+ public:
+  btScalar sumLoop(int begin, int end) const override {
+    btScalar sum = 0;
+    for (int i = begin; i < end; ++i) {
+      sum += static_cast<btScalar>(i);
+    }
+    return sum;
+  }
+};
+
+TEST(BulletTaskSchedulerTest, ParallelForMatchesSerial) {
+  constexpr int kSize = 500;
+  BulletTaskScheduler scheduler(4);
+  EXPECT_THAT(scheduler.getNumThreads(), Eq(4));
+
+  SquareBody body(kSize);
+  scheduler.parallelFor(0, kSize, 3, body);
+
+  std::vector<int> expected(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    expected[i] = i * i;
+  }
+  EXPECT_THAT(body.GetSquares(), Eq(expected));
+  EXPECT_THAT(body.GetVisits(), Each(Eq(1)));
+  EXPECT_THAT(body.GetNumThreads(), Gt(1));
+}
+
+TEST(BulletTaskSchedulerTest, ParallelForSubrange) {
+  BulletTaskScheduler scheduler(3);
+  SquareBody body(100);
+  scheduler.parallelFor(10, 95, 4, body);
+
+  const std::vector<int> visits = body.GetVisits();
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(visits[i], Eq(i >= 10 && i < 95 ? 1 : 0)) << i;
+  }
+}
+
+TEST(BulletTaskSchedulerTest, ParallelSumMatchesSerial) {
+  BulletTaskScheduler scheduler(4);
+  const SumBody body;
+  // The values are small integers, so the sums are exact in any order.
+  const btScalar serial = body.sumLoop(3, 1003);
+  for (int grain_size : {1, 2, 7, 64, 5000}) {
+    EXPECT_THAT(scheduler.parallelSum(3, 1003, grain_size, body), Eq(serial))
+        << "grain size " << grain_size;
+  }
+  EXPECT_THAT(scheduler.parallelSum(5, 5, 1, body), Eq(btScalar(0)));
+}
+
+TEST(BulletTaskSchedulerTest, SingleThreadRunsOnCaller) {
+  BulletTaskScheduler scheduler(4);
+  scheduler.setNumThreads(1);
+  EXPECT_THAT(scheduler.getNumThreads(), Eq(1));
+
+  SquareBody body(50);
+  scheduler.parallelFor(0, 50, 1, body);
+  EXPECT_THAT(body.GetVisits(), Each(Eq(1)));
+  EXPECT_THAT(body.GetNumThreads(), Eq(1));
+}
+
+}  // namespace
+}  // namespace redux
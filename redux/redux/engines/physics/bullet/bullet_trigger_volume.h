@@ -17,18 +17,21 @@ limitations under the License.
 #ifndef REDUX_ENGINES_PHYSICS_BULLET_BULLET_TRIGGER_VOLUME_H_
 #define REDUX_ENGINES_PHYSICS_BULLET_BULLET_TRIGGER_VOLUME_H_
 
-#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
-#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btTransform.h"
+#include "redux/engines/physics/trigger_broadphase.h"
 #include "redux/engines/physics/trigger_volume.h"
+#include "redux/modules/math/bounds.h"
 
 namespace redux {
 
-class PhysicsWorld;
-
+// Trigger volumes are not added to the Bullet world. Instead, the bounding box
+// of each active trigger volume is kept in a TriggerBroadphase owned by the
+// BulletPhysicsEngine, which tests it for overlaps without creating any
+// collision algorithms or persistent manifolds.
 class BulletTriggerVolume : public TriggerVolume {
  public:
   BulletTriggerVolume(const TriggerVolumeParams& params,
-                      btDynamicsWorld* world);
+                      TriggerBroadphase* broadphase);
   ~BulletTriggerVolume() override;
 
   // Enables the trigger volume to be included when performing any potential
@@ -52,12 +55,14 @@ class BulletTriggerVolume : public TriggerVolume {
   quat GetRotation() const;
 
  private:
-  void UpdateFlags();
+  // Returns the world-space bounding box of the (scaled) shape.
+  Box ComputeBounds() const;
 
   TriggerVolumeParams params_;
-  btDynamicsWorld* world_ = nullptr;
-  std::unique_ptr<btMotionState> bt_motion_state_;
-  std::unique_ptr<btRigidBody> bt_rigid_body_;
+  TriggerBroadphase* broadphase_ = nullptr;
+  TriggerBroadphase::ProxyId proxy_ = TriggerBroadphase::kInvalidProxy;
+  btTransform transform_ = btTransform::getIdentity();
+  vec3 scale_ = vec3::One();
 };
 
 }  // namespace redux
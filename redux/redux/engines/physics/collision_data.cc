@@ -16,10 +16,40 @@ limitations under the License.
 
 #include "redux/engines/physics/collision_data.h"
 
+#include <cstring>
 #include <utility>
 
 namespace redux {
 
+// Hash() stops at the first zero byte, so binary data is hashed here with the
+// same FNV-1a steps.
+static HashValue HashBytes(HashValue basis, const void* bytes, size_t size) {
+  const auto* ptr = static_cast<const unsigned char*>(bytes);
+  HashValue::Rep value = basis.get();
+  for (size_t i = 0; i < size; ++i) {
+    value = (value ^ ptr[i]) * HashValue::kPrimeMultiplier;
+  }
+  return HashValue(value);
+}
+
+template <typename T>
+static HashValue HashComponents(HashValue basis, const T& value, int count) {
+  for (int i = 0; i < count; ++i) {
+    basis = HashBytes(basis, &value[i], sizeof(value[i]));
+  }
+  return basis;
+}
+
+static bool SameBytes(const DataContainer& lhs, const DataContainer& rhs) {
+  if (lhs.GetNumBytes() != rhs.GetNumBytes()) {
+    return false;
+  }
+  if (lhs.GetBytes() == rhs.GetBytes() || lhs.GetNumBytes() == 0) {
+    return true;
+  }
+  return std::memcmp(lhs.GetBytes(), rhs.GetBytes(), lhs.GetNumBytes()) == 0;
+}
+
 void CollisionData::AddBox(const vec3& position, const quat& rotation,
                            const vec3& half_extents) {
   auto& shape = shape_parts_.emplace_back();
@@ -78,4 +108,43 @@ const CollisionMesh& CollisionData::GetCollisionMesh(size_t index) const {
   return shape_parts_[index].mesh;
 }
 
+HashValue CollisionData::GetContentHash() const {
+  // Vectors are hashed per component since they may contain padding.
+  HashValue hash = ConstHash("CollisionData");
+  for (const ShapePart& part : shape_parts_) {
+    hash = HashBytes(hash, &part.type, sizeof(part.type));
+    hash = HashComponents(hash, part.position, 3);
+    hash = HashComponents(hash, part.rotation, 4);
+    hash = HashComponents(hash, part.extents, 3);
+    if (part.type == kMesh) {
+      const DataContainer& vertices = part.mesh.vertices;
+      const DataContainer& indices = part.mesh.indices;
+      hash = HashBytes(hash, vertices.GetBytes(), vertices.GetNumBytes());
+      hash = HashBytes(hash, indices.GetBytes(), indices.GetNumBytes());
+    }
+  }
+  return hash;
+}
+
+bool CollisionData::HasSameContents(const CollisionData& other) const {
+  if (shape_parts_.size() != other.shape_parts_.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < shape_parts_.size(); ++i) {
+    const ShapePart& lhs = shape_parts_[i];
+    const ShapePart& rhs = other.shape_parts_[i];
+    if (lhs.type != rhs.type || lhs.position != rhs.position ||
+        lhs.rotation != rhs.rotation || lhs.extents != rhs.extents) {
+      return false;
+    }
+    if (lhs.type == kMesh) {
+      if (!SameBytes(lhs.mesh.vertices, rhs.mesh.vertices) ||
+          !SameBytes(lhs.mesh.indices, rhs.mesh.indices)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 }  // namespace redux
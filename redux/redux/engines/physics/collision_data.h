@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "redux/modules/base/data_container.h"
+#include "redux/modules/base/hash.h"
 #include "redux/modules/math/quaternion.h"
 #include "redux/modules/math/vector.h"
 
@@ -30,6 +31,9 @@ namespace redux {
 struct CollisionMesh {
   DataContainer vertices;  // `vec3` point array.
   DataContainer indices;   // `int` indices array, 3 indices for each triangle.
+  // Optional bounding volume hierarchy of the triangles, baked offline in the
+  // physics backend's format. It is not considered part of the mesh contents.
+  DataContainer bvh;
 };
 
 // Collision data from which a CollisionShape can be created.
@@ -83,6 +87,13 @@ class CollisionData {
   // the part is not a mesh.
   const CollisionMesh& GetCollisionMesh(size_t index) const;
 
+  // Returns a hash of the contents (ie. the type, transform, size and mesh
+  // data of every part) of the collision data.
+  HashValue GetContentHash() const;
+
+  // Returns true if `other` has exactly the same parts as this collision data.
+  bool HasSameContents(const CollisionData& other) const;
+
  private:
   struct ShapePart {
     PartType type = kNone;
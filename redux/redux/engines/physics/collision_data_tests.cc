@@ -0,0 +1,109 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/physics/collision_data.h"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace redux {
+namespace {
+
+const std::vector<vec3> kVertices = {
+    vec3(0, 0, 0), vec3(1, 0, 0), vec3(0, 1, 0), vec3(0, 0, 1)};
+const std::vector<int> kIndices = {0, 1, 2, 0, 2, 3};
+
+// Copies the data so that equal meshes do not share their buffers.
+template <typename T>
+DataContainer CopyData(const std::vector<T>& data) {
+  return DataContainer::WrapData(data.data(), data.size()).Clone();
+}
+
+CollisionMesh CreateMesh(const std::vector<vec3>& vertices) {
+  CollisionMesh mesh;
+  mesh.vertices = CopyData(vertices);
+  mesh.indices = CopyData(kIndices);
+  return mesh;
+}
+
+CollisionData CreateData() {
+  CollisionData data;
+  data.AddSphere(vec3(1, 2, 3), 4.f);
+  data.AddBox(vec3(0, 1, 0), quat::Identity(), vec3(1, 2, 3));
+  data.AddMesh(vec3::Zero(), quat::Identity(), CreateMesh(kVertices));
+  return data;
+}
+
+TEST(CollisionDataTest, EqualContents) {
+  const CollisionData lhs = CreateData();
+  const CollisionData rhs = CreateData();
+  EXPECT_TRUE(lhs.HasSameContents(rhs));
+  EXPECT_TRUE(rhs.HasSameContents(lhs));
+  EXPECT_EQ(lhs.GetContentHash(), rhs.GetContentHash());
+}
+
+TEST(CollisionDataTest, DifferentPrimitives) {
+  const CollisionData base = CreateData();
+
+  CollisionData radius;
+  radius.AddSphere(vec3(1, 2, 3), 5.f);
+  CollisionData position;
+  position.AddSphere(vec3(1, 2, 4), 4.f);
+  CollisionData sphere;
+  sphere.AddSphere(vec3(1, 2, 3), 4.f);
+
+  EXPECT_FALSE(radius.HasSameContents(sphere));
+  EXPECT_NE(radius.GetContentHash(), sphere.GetContentHash());
+  EXPECT_FALSE(position.HasSameContents(sphere));
+  EXPECT_NE(position.GetContentHash(), sphere.GetContentHash());
+
+  // A prefix of the parts is not the same shape.
+  EXPECT_FALSE(sphere.HasSameContents(base));
+  EXPECT_NE(sphere.GetContentHash(), base.GetContentHash());
+}
+
+TEST(CollisionDataTest, DifferentMeshes) {
+  std::vector<vec3> vertices = kVertices;
+  vertices[3] = vec3(0, 0, 2);
+
+  CollisionData lhs;
+  lhs.AddMesh(vec3::Zero(), quat::Identity(), CreateMesh(kVertices));
+  CollisionData rhs;
+  rhs.AddMesh(vec3::Zero(), quat::Identity(), CreateMesh(vertices));
+
+  EXPECT_FALSE(lhs.HasSameContents(rhs));
+  EXPECT_NE(lhs.GetContentHash(), rhs.GetContentHash());
+}
+
+TEST(CollisionDataTest, BvhIsNotPartOfContents) {
+  const std::vector<std::byte> bvh(16, std::byte{1});
+
+  CollisionData lhs;
+  lhs.AddMesh(vec3::Zero(), quat::Identity(), CreateMesh(kVertices));
+  CollisionMesh mesh = CreateMesh(kVertices);
+  mesh.bvh = CopyData(bvh);
+  CollisionData rhs;
+  rhs.AddMesh(vec3::Zero(), quat::Identity(), std::move(mesh));
+
+  EXPECT_TRUE(lhs.HasSameContents(rhs));
+  EXPECT_EQ(lhs.GetContentHash(), rhs.GetContentHash());
+}
+
+}  // namespace
+}  // namespace redux
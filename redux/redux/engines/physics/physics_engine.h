@@ -20,6 +20,7 @@ limitations under the License.
 #include <functional>
 
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "redux/engines/physics/collision_data.h"
 #include "redux/engines/physics/collision_shape.h"
 #include "redux/engines/physics/rigid_body.h"
@@ -103,13 +104,52 @@ class PhysicsEngine {
   // volumes.
   void SetOnExitCollisionCallback(CollisionCallback cb);
 
+  // A pair of Entities whose collision volumes are touching. `entity_a` is
+  // always the Entity with the lower value.
+  struct CollisionPair {
+    Entity entity_a;
+    Entity entity_b;
+  };
+
+  // Callback for all the collisions that started (`entered`) and ended
+  // (`exited`) during a single simulation step. The spans are only valid for
+  // the duration of the call.
+  using CollisionBatchCallback =
+      std::function<void(absl::Span<const CollisionPair> entered,
+                         absl::Span<const CollisionPair> exited)>;
+
+  // Sets the callback to invoke once per simulation step with all the
+  // collisions that changed during that step. This is invoked before the
+  // per-pair enter/exit callbacks above.
+  void SetCollisionBatchCallback(CollisionBatchCallback cb);
+
   struct ContactPoint {
     vec3 world_position = vec3::Zero();
     vec3 contact_normal = vec3::Zero();
   };
 
+  // Enables (or disables) gathering the contact points of all collisions
+  // involving `entity`. Contact points are only gathered for collisions in
+  // which at least one of the Entities is enabled.
+  void SetContactPointsEnabled(Entity entity, bool enabled);
+
+  // The interpolated poses of the dynamic rigid bodies that moved during the
+  // last AdvanceFrame, as parallel arrays (ie. positions[i] and rotations[i]
+  // belong to entities[i]).
+  struct RigidBodyPoses {
+    absl::Span<const Entity> entities;
+    absl::Span<const vec3> positions;
+    absl::Span<const quat> rotations;
+  };
+
+  // Returns the poses of the dynamic rigid bodies that moved during the last
+  // AdvanceFrame. Rigid bodies that are asleep or did not move are omitted.
+  // The spans are valid until the next AdvanceFrame.
+  RigidBodyPoses GetUpdatedRigidBodyPoses() const;
+
   // Returns information about all the contacts between two Entities. Should be
-  // used in conjunction with the above collision callbacks.
+  // used in conjunction with the above collision callbacks. Returns an empty
+  // span unless contact points are enabled for either Entity.
   absl::Span<const ContactPoint> GetActiveContacts(Entity entity_a,
                                                    Entity entity_b) const;
 
@@ -33,10 +33,25 @@ void PhysicsEngine::SetOnEnterCollisionCallback(CollisionCallback cb) {
 void PhysicsEngine::SetOnExitCollisionCallback(CollisionCallback cb) {
   Upcast(this)->SetOnExitCollisionCallback(std::move(cb));
 }
+void PhysicsEngine::SetCollisionBatchCallback(CollisionBatchCallback cb) {
+  Upcast(this)->SetCollisionBatchCallback(std::move(cb));
+}
+void PhysicsEngine::SetContactPointsEnabled(Entity entity, bool enabled) {
+  Upcast(this)->SetContactPointsEnabled(entity, enabled);
+}
 absl::Span<const PhysicsEngine::ContactPoint> PhysicsEngine::GetActiveContacts(
     Entity entity_a, Entity entity_b) const {
   return Upcast(this)->GetActiveContacts(entity_a, entity_b);
 }
+void PhysicsEngine::SetGravity(const vec3& gravity) {
+  Upcast(this)->SetGravity(gravity);
+}
+void PhysicsEngine::SetTimestep(absl::Duration timestep, int max_substeps) {
+  Upcast(this)->SetTimestep(timestep, max_substeps);
+}
+PhysicsEngine::RigidBodyPoses PhysicsEngine::GetUpdatedRigidBodyPoses() const {
+  return Upcast(this)->GetUpdatedRigidBodyPoses();
+}
 void PhysicsEngine::AdvanceFrame(absl::Duration timestep) {
   Upcast(this)->AdvanceFrame(timestep);
 }
@@ -0,0 +1,234 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/physics/trigger_broadphase.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "redux/modules/base/logging.h"
+
+namespace redux {
+
+// Cell coordinates are packed into 21 bits each to form the key of a cell.
+static constexpr int kCellBits = 21;
+static constexpr int kCellOffset = 1 << (kCellBits - 1);
+static constexpr uint64_t kCellMask = (uint64_t(1) << kCellBits) - 1;
+
+TriggerBroadphase::TriggerBroadphase(float cell_size) {
+  CHECK_GT(cell_size, 0.f);
+  inv_cell_size_ = 1.f / cell_size;
+}
+
+vec3i TriggerBroadphase::ToCell(const vec3& point) const {
+  vec3i cell;
+  for (int i = 0; i < 3; ++i) {
+    const float coord = std::floor(point[i] * inv_cell_size_);
+    cell[i] = static_cast<int>(std::clamp<float>(
+        coord, -kCellOffset, kCellOffset - 1));
+  }
+  return cell;
+}
+
+uint64_t TriggerBroadphase::CellKey(const vec3i& cell) {
+  const uint64_t x = static_cast<uint64_t>(cell.x + kCellOffset) & kCellMask;
+  const uint64_t y = static_cast<uint64_t>(cell.y + kCellOffset) & kCellMask;
+  const uint64_t z = static_cast<uint64_t>(cell.z + kCellOffset) & kCellMask;
+  return x | (y << kCellBits) | (z << (2 * kCellBits));
+}
+
+TriggerBroadphase::ProxyId TriggerBroadphase::Add(Entity entity,
+                                                  const Box& box, Bits32 group,
+                                                  Bits32 filter) {
+  CHECK(entity != kNullEntity);
+
+  ProxyId id = kInvalidProxy;
+  if (free_proxies_.empty()) {
+    id = static_cast<ProxyId>(proxies_.size());
+    proxies_.emplace_back();
+  } else {
+    id = free_proxies_.back();
+    free_proxies_.pop_back();
+  }
+
+  Proxy& proxy = proxies_[id];
+  proxy.entity = entity;
+  proxy.box = box;
+  proxy.group = group;
+  proxy.filter = filter;
+  Insert(id);
+  ++num_proxies_;
+  return id;
+}
+
+void TriggerBroadphase::Update(ProxyId id, const Box& box) {
+  CHECK_LT(id, proxies_.size());
+  Proxy& proxy = proxies_[id];
+  CHECK(proxy.entity != kNullEntity);
+
+  // Small movements within the same cells only need the box to be updated.
+  dirty_ = true;
+  if (ToCell(box.min) == proxy.min_cell && ToCell(box.max) == proxy.max_cell) {
+    proxy.box = box;
+    return;
+  }
+  Erase(id);
+  proxy.box = box;
+  Insert(id);
+}
+
+void TriggerBroadphase::Remove(ProxyId id) {
+  CHECK_LT(id, proxies_.size());
+  CHECK(proxies_[id].entity != kNullEntity);
+  Erase(id);
+  proxies_[id] = Proxy();
+  free_proxies_.push_back(id);
+  --num_proxies_;
+}
+
+void TriggerBroadphase::Insert(ProxyId id) {
+  Proxy& proxy = proxies_[id];
+  proxy.min_cell = ToCell(proxy.box.min);
+  proxy.max_cell = ToCell(proxy.box.max);
+  dirty_ = true;
+
+  const vec3i extent = proxy.max_cell - proxy.min_cell + vec3i::One();
+  const int64_t num_cells =
+      int64_t(extent.x) * int64_t(extent.y) * int64_t(extent.z);
+  proxy.oversized = num_cells > kMaxCellsPerProxy;
+  if (proxy.oversized) {
+    oversized_proxies_.push_back(id);
+    return;
+  }
+
+  vec3i cell;
+  for (cell.z = proxy.min_cell.z; cell.z <= proxy.max_cell.z; ++cell.z) {
+    for (cell.y = proxy.min_cell.y; cell.y <= proxy.max_cell.y; ++cell.y) {
+      for (cell.x = proxy.min_cell.x; cell.x <= proxy.max_cell.x; ++cell.x) {
+        Cell& entry = cells_[CellKey(cell)];
+        entry.coord = cell;
+        entry.proxies.push_back(id);
+      }
+    }
+  }
+}
+
+void TriggerBroadphase::Erase(ProxyId id) {
+  const Proxy& proxy = proxies_[id];
+  dirty_ = true;
+
+  if (proxy.oversized) {
+    auto iter =
+        std::find(oversized_proxies_.begin(), oversized_proxies_.end(), id);
+    CHECK(iter != oversized_proxies_.end());
+    *iter = oversized_proxies_.back();
+    oversized_proxies_.pop_back();
+    return;
+  }
+
+  vec3i cell;
+  for (cell.z = proxy.min_cell.z; cell.z <= proxy.max_cell.z; ++cell.z) {
+    for (cell.y = proxy.min_cell.y; cell.y <= proxy.max_cell.y; ++cell.y) {
+      for (cell.x = proxy.min_cell.x; cell.x <= proxy.max_cell.x; ++cell.x) {
+        auto entry = cells_.find(CellKey(cell));
+        CHECK(entry != cells_.end());
+        std::vector<ProxyId>& ids = entry->second.proxies;
+        auto iter = std::find(ids.begin(), ids.end(), id);
+        CHECK(iter != ids.end());
+        *iter = ids.back();
+        ids.pop_back();
+        if (ids.empty()) {
+          cells_.erase(entry);
+        }
+      }
+    }
+  }
+}
+
+void TriggerBroadphase::TestPair(const Proxy& a, const Proxy& b) {
+  if (a.entity == b.entity) {
+    return;
+  }
+  if (!a.group.Any(b.filter) || !b.group.Any(a.filter)) {
+    return;
+  }
+  if (!(a.box.min <= b.box.max) || !(b.box.min <= a.box.max)) {
+    return;
+  }
+  if (a.entity < b.entity) {
+    overlaps_.push_back({a.entity, b.entity});
+  } else {
+    overlaps_.push_back({b.entity, a.entity});
+  }
+}
+
+absl::Span<const PhysicsEngine::CollisionPair>
+TriggerBroadphase::FindOverlaps() {
+  if (!dirty_) {
+    return overlaps_;
+  }
+  dirty_ = false;
+  overlaps_.clear();
+
+  for (const auto& iter : cells_) {
+    const Cell& cell = iter.second;
+    const std::vector<ProxyId>& ids = cell.proxies;
+    for (size_t i = 0; i < ids.size(); ++i) {
+      const Proxy& a = proxies_[ids[i]];
+      for (size_t j = i + 1; j < ids.size(); ++j) {
+        const Proxy& b = proxies_[ids[j]];
+        // Two proxies may share several cells; only test them in the first.
+        if (Max(a.min_cell, b.min_cell) == cell.coord) {
+          TestPair(a, b);
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < oversized_proxies_.size(); ++i) {
+    const ProxyId id = oversized_proxies_[i];
+    for (ProxyId other = 0; other < proxies_.size(); ++other) {
+      const Proxy& proxy = proxies_[other];
+      if (proxy.entity == kNullEntity || other == id) {
+        continue;
+      }
+      // Test each pair of oversized proxies only once.
+      if (proxy.oversized && other < id) {
+        continue;
+      }
+      TestPair(proxies_[id], proxy);
+    }
+  }
+
+  // Entities with several trigger volumes may overlap more than once.
+  auto less = [](const PhysicsEngine::CollisionPair& lhs,
+                 const PhysicsEngine::CollisionPair& rhs) {
+    if (lhs.entity_a == rhs.entity_a) {
+      return lhs.entity_b < rhs.entity_b;
+    }
+    return lhs.entity_a < rhs.entity_a;
+  };
+  auto equal = [](const PhysicsEngine::CollisionPair& lhs,
+                  const PhysicsEngine::CollisionPair& rhs) {
+    return lhs.entity_a == rhs.entity_a && lhs.entity_b == rhs.entity_b;
+  };
+  std::sort(overlaps_.begin(), overlaps_.end(), less);
+  overlaps_.erase(std::unique(overlaps_.begin(), overlaps_.end(), equal),
+                  overlaps_.end());
+  return overlaps_;
+}
+
+}  // namespace redux
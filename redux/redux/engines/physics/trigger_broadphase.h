@@ -0,0 +1,117 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_PHYSICS_TRIGGER_BROADPHASE_H_
+#define REDUX_ENGINES_PHYSICS_TRIGGER_BROADPHASE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "redux/engines/physics/physics_engine.h"
+#include "redux/modules/base/bits.h"
+#include "redux/modules/ecs/entity.h"
+#include "redux/modules/math/bounds.h"
+#include "redux/modules/math/vector.h"
+
+namespace redux {
+
+// Finds the overlaps between trigger volumes, which only need to know when they
+// start and stop overlapping rather than how they collide.
+//
+// Each proxy is an axis-aligned box stored in the cells of a uniform grid that
+// it touches. A proxy is only re-hashed when it moves into a different set of
+// cells, and the overlaps are only recomputed when a proxy has changed since
+// the last call to FindOverlaps().
+class TriggerBroadphase {
+ public:
+  using ProxyId = uint32_t;
+  static constexpr ProxyId kInvalidProxy = ~ProxyId(0);
+
+  // `cell_size` should be a little larger than the typical trigger volume.
+  explicit TriggerBroadphase(float cell_size = 1.f);
+
+  TriggerBroadphase(const TriggerBroadphase&) = delete;
+  TriggerBroadphase& operator=(const TriggerBroadphase&) = delete;
+
+  // Adds a proxy for `entity`. Like Bullet, two proxies can only overlap if
+  // each one's `group` intersects the other's `filter`.
+  ProxyId Add(Entity entity, const Box& box, Bits32 group, Bits32 filter);
+
+  // Moves the proxy to `box`.
+  void Update(ProxyId proxy, const Box& box);
+
+  // Removes the proxy. The id may then be reused by a later call to Add().
+  void Remove(ProxyId proxy);
+
+  // Returns the number of proxies in the broadphase.
+  size_t GetNumProxies() const { return num_proxies_; }
+
+  // Calls `fn(Entity entity, const Box& box, Bits32 group, Bits32 filter)` for
+  // each proxy.
+  template <typename Fn>
+  void ForEachProxy(const Fn& fn) const {
+    for (const Proxy& proxy : proxies_) {
+      if (proxy.entity != kNullEntity) {
+        fn(proxy.entity, proxy.box, proxy.group, proxy.filter);
+      }
+    }
+  }
+
+  // Returns each pair of distinct Entities that have overlapping proxies, with
+  // the lower Entity first. The pairs are sorted and unique.
+  absl::Span<const PhysicsEngine::CollisionPair> FindOverlaps();
+
+ private:
+  struct Cell {
+    vec3i coord = vec3i::Zero();
+    std::vector<ProxyId> proxies;
+  };
+
+  struct Proxy {
+    Entity entity = kNullEntity;
+    Box box;
+    vec3i min_cell = vec3i::Zero();
+    vec3i max_cell = vec3i::Zero();
+    Bits32 group;
+    Bits32 filter;
+    bool oversized = false;
+  };
+
+  // Proxies that span more than this many cells are tested against all other
+  // proxies instead of being stored in the grid.
+  static constexpr int kMaxCellsPerProxy = 64;
+
+  vec3i ToCell(const vec3& point) const;
+  static uint64_t CellKey(const vec3i& cell);
+  void Insert(ProxyId id);
+  void Erase(ProxyId id);
+  void TestPair(const Proxy& a, const Proxy& b);
+
+  float inv_cell_size_ = 1.f;
+  std::vector<Proxy> proxies_;
+  std::vector<ProxyId> free_proxies_;
+  std::vector<ProxyId> oversized_proxies_;
+  absl::flat_hash_map<uint64_t, Cell> cells_;
+  std::vector<PhysicsEngine::CollisionPair> overlaps_;
+  size_t num_proxies_ = 0;
+  bool dirty_ = false;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_ENGINES_PHYSICS_TRIGGER_BROADPHASE_H_
@@ -0,0 +1,184 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/physics/trigger_broadphase.h"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace redux {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+
+using EntityPair = std::pair<Entity, Entity>;
+
+std::vector<EntityPair> ToPairs(
+    absl::Span<const PhysicsEngine::CollisionPair> overlaps) {
+  std::vector<EntityPair> pairs;
+  for (const auto& overlap : overlaps) {
+    pairs.emplace_back(overlap.entity_a, overlap.entity_b);
+  }
+  return pairs;
+}
+
+Box MakeBox(float x, float y, float z, float size) {
+  return Box(vec3(x, y, z), vec3(x + size, y + size, z + size));
+}
+
+TEST(TriggerBroadphaseTest, FindsOverlaps) {
+  TriggerBroadphase broadphase;
+  const Entity a(1);
+  const Entity b(2);
+  const Entity c(3);
+  broadphase.Add(a, MakeBox(0, 0, 0, 1), Bits32::All(), Bits32::All());
+  broadphase.Add(b, MakeBox(0.5f, 0.5f, 0.5f, 1), Bits32::All(),
+                 Bits32::All());
+  const auto proxy_c =
+      broadphase.Add(c, MakeBox(5, 5, 5, 1), Bits32::All(), Bits32::All());
+  EXPECT_THAT(ToPairs(broadphase.FindOverlaps()),
+              ElementsAre(EntityPair(a, b)));
+
+  broadphase.Update(proxy_c, MakeBox(1.5f, 1.5f, 1.5f, 1));
+  EXPECT_THAT(ToPairs(broadphase.FindOverlaps()),
+              ElementsAre(EntityPair(a, b), EntityPair(b, c)));
+
+  broadphase.Remove(proxy_c);
+  EXPECT_THAT(ToPairs(broadphase.FindOverlaps()),
+              ElementsAre(EntityPair(a, b)));
+  EXPECT_THAT(broadphase.GetNumProxies(), Eq(2));
+}
+
+TEST(TriggerBroadphaseTest, FiltersByGroup) {
+  TriggerBroadphase broadphase;
+  const Bits32 group_a = Bits32::Nth<0>();
+  const Bits32 group_b = Bits32::Nth<1>();
+  broadphase.Add(Entity(1), MakeBox(0, 0, 0, 1), group_a, group_b);
+  broadphase.Add(Entity(2), MakeBox(0, 0, 0, 1), group_a, group_b);
+  EXPECT_THAT(ToPairs(broadphase.FindOverlaps()), IsEmpty());
+
+  broadphase.Add(Entity(3), MakeBox(0, 0, 0, 1), group_b, group_a);
+  EXPECT_THAT(ToPairs(broadphase.FindOverlaps()),
+              ElementsAre(EntityPair(Entity(1), Entity(3)),
+                          EntityPair(Entity(2), Entity(3))));
+}
+
+TEST(TriggerBroadphaseTest, MergesProxiesOfSameEntity) {
+  TriggerBroadphase broadphase;
+  broadphase.Add(Entity(1), MakeBox(0, 0, 0, 1), Bits32::All(),
+                 Bits32::All());
+  broadphase.Add(Entity(1), MakeBox(0.5f, 0, 0, 1), Bits32::All(),
+                 Bits32::All());
+  broadphase.Add(Entity(2), MakeBox(0.2f, 0, 0, 1), Bits32::All(),
+                 Bits32::All());
+  EXPECT_THAT(ToPairs(broadphase.FindOverlaps()),
+              ElementsAre(EntityPair(Entity(1), Entity(2))));
+}
+
+// Compares the broadphase against testing every pair of proxies over random
+// rounds of adding, moving and removing proxies, including boxes too large to
+// be stored in the grid.
+TEST(TriggerBroadphaseTest, MatchesBruteForce) {
+  struct Reference {
+    TriggerBroadphase::ProxyId id;
+    Entity entity;
+    Box box;
+    Bits32 group;
+    Bits32 filter;
+  };
+
+  std::mt19937 rng(1234);
+  auto uniform = [&](float lo, float hi) {
+    return std::uniform_real_distribution<float>(lo, hi)(rng);
+  };
+  auto random_box = [&]() {
+    const float size = uniform(0.f, 1.f) < 0.1f ? uniform(4.f, 12.f)
+                                                : uniform(0.1f, 1.5f);
+    return MakeBox(uniform(-8.f, 8.f), uniform(-8.f, 8.f), uniform(-8.f, 8.f),
+                   size);
+  };
+  auto random_bits = [&]() {
+    return Bits32(std::uniform_int_distribution<uint32_t>(1, 7)(rng));
+  };
+
+  TriggerBroadphase broadphase(2.f);
+  std::vector<Reference> proxies;
+  for (int round = 0; round < 200; ++round) {
+    const int num_adds = std::uniform_int_distribution<int>(0, 6)(rng);
+    for (int i = 0; i < num_adds; ++i) {
+      Reference ref;
+      ref.entity = Entity(std::uniform_int_distribution<int>(1, 60)(rng));
+      ref.box = random_box();
+      ref.group = random_bits();
+      ref.filter = random_bits();
+      ref.id = broadphase.Add(ref.entity, ref.box, ref.group, ref.filter);
+      proxies.push_back(ref);
+    }
+    for (Reference& ref : proxies) {
+      const float action = uniform(0.f, 1.f);
+      if (action < 0.3f) {
+        // Small moves usually stay within the same cells.
+        const vec3 offset(uniform(-0.3f, 0.3f), uniform(-0.3f, 0.3f),
+                          uniform(-0.3f, 0.3f));
+        ref.box = Box(ref.box.min + offset, ref.box.max + offset);
+        broadphase.Update(ref.id, ref.box);
+      } else if (action < 0.4f) {
+        ref.box = random_box();
+        broadphase.Update(ref.id, ref.box);
+      }
+    }
+    const int num_removes = std::uniform_int_distribution<int>(0, 4)(rng);
+    for (int i = 0; i < num_removes && !proxies.empty(); ++i) {
+      const size_t index = std::uniform_int_distribution<size_t>(
+          0, proxies.size() - 1)(rng);
+      broadphase.Remove(proxies[index].id);
+      proxies.erase(proxies.begin() + index);
+    }
+
+    std::vector<EntityPair> expected;
+    for (size_t i = 0; i < proxies.size(); ++i) {
+      for (size_t j = i + 1; j < proxies.size(); ++j) {
+        const Reference& a = proxies[i];
+        const Reference& b = proxies[j];
+        if (a.entity == b.entity || !a.group.Any(b.filter) ||
+            !b.group.Any(a.filter)) {
+          continue;
+        }
+        if (a.box.min <= b.box.max && b.box.min <= a.box.max) {
+          expected.emplace_back(std::min(a.entity, b.entity),
+                                std::max(a.entity, b.entity));
+        }
+      }
+    }
+    std::sort(expected.begin(), expected.end());
+    expected.erase(std::unique(expected.begin(), expected.end()),
+                   expected.end());
+
+    ASSERT_THAT(broadphase.GetNumProxies(), Eq(proxies.size()));
+    ASSERT_THAT(ToPairs(broadphase.FindOverlaps()), Eq(expected))
+        << "Round " << round;
+  }
+}
+
+}  // namespace
+}  // namespace redux
@@ -0,0 +1,75 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/platform/frame_pacer.h"
+
+#include <algorithm>
+
+#include "redux/modules/base/logging.h"
+
+namespace redux {
+
+void FramePacer::SetMode(Mode mode) {
+  mode_ = mode;
+  if (mode_ == Mode::kContinuous) {
+    idle_ = false;
+  }
+}
+
+void FramePacer::SetIdleFrameRate(double hz) {
+  CHECK_GT(hz, 0.0);
+  idle_frame_period_ = absl::Seconds(1.0 / hz);
+}
+
+void FramePacer::SetIdleTimeout(absl::Duration timeout) {
+  idle_timeout_ = timeout;
+}
+
+bool FramePacer::BeginFrame(absl::Time now) {
+  if (idle_ && last_frame_time_ != absl::InfinitePast()) {
+    stats_.idle_time += now - last_frame_time_;
+  }
+  last_frame_time_ = now;
+  ++stats_.num_frames;
+
+  if (requested_.exchange(false, std::memory_order_acq_rel)) {
+    last_request_time_ = now;
+  }
+
+  bool render = true;
+  if (mode_ == Mode::kAdaptive) {
+    idle_ = now - last_request_time_ >= idle_timeout_;
+    render = !idle_ || now - last_render_time_ >= idle_frame_period_;
+  }
+
+  if (render) {
+    last_render_time_ = now;
+    ++stats_.num_rendered_frames;
+  } else {
+    ++stats_.num_skipped_frames;
+  }
+  return render;
+}
+
+absl::Duration FramePacer::GetTimeUntilNextFrame(absl::Time now) const {
+  if (!idle_ || requested_.load(std::memory_order_acquire)) {
+    return absl::ZeroDuration();
+  }
+  return std::max(last_render_time_ + idle_frame_period_ - now,
+                  absl::ZeroDuration());
+}
+
+}  // namespace redux
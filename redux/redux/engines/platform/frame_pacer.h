@@ -0,0 +1,105 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_PLATFORM_FRAME_PACER_H_
+#define REDUX_ENGINES_PLATFORM_FRAME_PACER_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "absl/time/time.h"
+#include "redux/modules/base/typeid.h"
+
+namespace redux {
+
+// Decides which frames of the Mainloop need to be rendered.
+//
+// In kContinuous mode (the default) every frame is rendered. In kAdaptive
+// mode, frames are only rendered at full rate while something on screen is
+// changing, as reported by calls to RequestFrame (eg. from input events or
+// running animations). Once no frame has been requested for the idle timeout,
+// the pacer drops to the idle frame rate, and the Mainloop skips rendering (and
+// sleeps) in between idle frames. Any call to RequestFrame returns to full rate
+// on the next frame.
+class FramePacer {
+ public:
+  enum class Mode {
+    kContinuous,
+    kAdaptive,
+  };
+
+  struct Stats {
+    // Number of calls to BeginFrame.
+    std::uint64_t num_frames = 0;
+    // Number of frames that were rendered.
+    std::uint64_t num_rendered_frames = 0;
+    // Number of frames in which rendering was skipped.
+    std::uint64_t num_skipped_frames = 0;
+    // Total time spent in the idle state.
+    absl::Duration idle_time = absl::ZeroDuration();
+  };
+
+  FramePacer() = default;
+
+  FramePacer(const FramePacer&) = delete;
+  FramePacer& operator=(const FramePacer&) = delete;
+
+  // Sets the pacing mode.
+  void SetMode(Mode mode);
+  Mode GetMode() const { return mode_; }
+
+  // Sets the rate (in frames per second) at which frames are rendered while
+  // idle. Must be greater than zero.
+  void SetIdleFrameRate(double hz);
+
+  // Sets how long after the last requested frame the pacer becomes idle.
+  void SetIdleTimeout(absl::Duration timeout);
+
+  // Indicates that something has changed and the next frame must be rendered.
+  // May be called from any thread.
+  void RequestFrame() { requested_.store(true, std::memory_order_release); }
+
+  // Called by the Mainloop at the start of every frame. Returns true if the
+  // frame should be rendered.
+  bool BeginFrame(absl::Time now);
+
+  // Returns how long the Mainloop may sleep before the next frame needs to be
+  // rendered. Returns zero while not idle.
+  absl::Duration GetTimeUntilNextFrame(absl::Time now) const;
+
+  // Returns true if no frame has been requested within the idle timeout.
+  bool IsIdle() const { return idle_; }
+
+  // Returns the statistics gathered since construction.
+  const Stats& GetStats() const { return stats_; }
+
+ private:
+  Mode mode_ = Mode::kContinuous;
+  absl::Duration idle_frame_period_ = absl::Seconds(1) / 10;
+  absl::Duration idle_timeout_ = absl::Milliseconds(500);
+  std::atomic<bool> requested_ = true;
+  bool idle_ = false;
+  absl::Time last_request_time_ = absl::InfinitePast();
+  absl::Time last_render_time_ = absl::InfinitePast();
+  absl::Time last_frame_time_ = absl::InfinitePast();
+  Stats stats_;
+};
+
+}  // namespace redux
+
+REDUX_SETUP_TYPEID(redux::FramePacer);
+
+#endif  // REDUX_ENGINES_PLATFORM_FRAME_PACER_H_
@@ -0,0 +1,109 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/platform/frame_pacer.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+
+TEST(FramePacerTest, ContinuousRendersEveryFrame) {
+  FramePacer pacer;
+  absl::Time now = absl::UnixEpoch();
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(pacer.BeginFrame(now));
+    EXPECT_FALSE(pacer.IsIdle());
+    EXPECT_THAT(pacer.GetTimeUntilNextFrame(now), Eq(absl::ZeroDuration()));
+    now += absl::Milliseconds(16);
+  }
+  EXPECT_THAT(pacer.GetStats().num_frames, Eq(100));
+  EXPECT_THAT(pacer.GetStats().num_rendered_frames, Eq(100));
+  EXPECT_THAT(pacer.GetStats().num_skipped_frames, Eq(0));
+}
+
+TEST(FramePacerTest, AdaptiveDropsToIdleRate) {
+  FramePacer pacer;
+  pacer.SetMode(FramePacer::Mode::kAdaptive);
+  pacer.SetIdleTimeout(absl::Milliseconds(100));
+  pacer.SetIdleFrameRate(10.0);
+
+  // The first frame is always rendered, as are frames within the timeout.
+  absl::Time now = absl::UnixEpoch();
+  EXPECT_TRUE(pacer.BeginFrame(now));
+  now += absl::Milliseconds(50);
+  EXPECT_TRUE(pacer.BeginFrame(now));
+  EXPECT_FALSE(pacer.IsIdle());
+
+  // Past the timeout, only one frame per idle period is rendered.
+  now += absl::Milliseconds(60);
+  EXPECT_FALSE(pacer.BeginFrame(now));
+  EXPECT_TRUE(pacer.IsIdle());
+  EXPECT_THAT(pacer.GetTimeUntilNextFrame(now), Eq(absl::Milliseconds(40)));
+
+  now += absl::Milliseconds(40);
+  EXPECT_TRUE(pacer.BeginFrame(now));
+  EXPECT_THAT(pacer.GetTimeUntilNextFrame(now), Eq(absl::Milliseconds(100)));
+  now += absl::Milliseconds(10);
+  EXPECT_FALSE(pacer.BeginFrame(now));
+
+  EXPECT_THAT(pacer.GetStats().num_frames, Eq(5));
+  EXPECT_THAT(pacer.GetStats().num_rendered_frames, Eq(3));
+  EXPECT_THAT(pacer.GetStats().num_skipped_frames, Eq(2));
+  EXPECT_THAT(pacer.GetStats().idle_time, Eq(absl::Milliseconds(50)));
+}
+
+TEST(FramePacerTest, RequestFrameLeavesIdle) {
+  FramePacer pacer;
+  pacer.SetMode(FramePacer::Mode::kAdaptive);
+  pacer.SetIdleTimeout(absl::Milliseconds(100));
+  pacer.SetIdleFrameRate(1.0);
+
+  absl::Time now = absl::UnixEpoch();
+  EXPECT_TRUE(pacer.BeginFrame(now));
+  now += absl::Milliseconds(200);
+  EXPECT_FALSE(pacer.BeginFrame(now));
+  EXPECT_TRUE(pacer.IsIdle());
+
+  pacer.RequestFrame();
+  EXPECT_THAT(pacer.GetTimeUntilNextFrame(now), Eq(absl::ZeroDuration()));
+  now += absl::Milliseconds(10);
+  EXPECT_TRUE(pacer.BeginFrame(now));
+  EXPECT_FALSE(pacer.IsIdle());
+  now += absl::Milliseconds(10);
+  EXPECT_TRUE(pacer.BeginFrame(now));
+}
+
+TEST(FramePacerTest, ContinuousLeavesIdle) {
+  FramePacer pacer;
+  pacer.SetMode(FramePacer::Mode::kAdaptive);
+  pacer.SetIdleTimeout(absl::ZeroDuration());
+
+  absl::Time now = absl::UnixEpoch();
+  EXPECT_TRUE(pacer.BeginFrame(now));
+  EXPECT_TRUE(pacer.IsIdle());
+
+  pacer.SetMode(FramePacer::Mode::kContinuous);
+  EXPECT_FALSE(pacer.IsIdle());
+  now += absl::Milliseconds(1);
+  EXPECT_TRUE(pacer.BeginFrame(now));
+}
+
+}  // namespace
+}  // namespace redux
@@ -20,6 +20,7 @@ limitations under the License.
 #include "redux/editor/editor.h"
 #endif
 #include "redux/engines/platform/device_manager.h"
+#include "redux/engines/platform/frame_pacer.h"
 #include "redux/modules/base/asset_loader.h"
 #include "redux/modules/base/choreographer.h"
 #include "redux/modules/base/static_registry.h"
@@ -30,12 +31,19 @@ Mainloop::Mainloop() {
   registry_.Create<AssetLoader>(GetRegistry());
   registry_.Create<Choreographer>(GetRegistry());
   registry_.Create<DeviceManager>(GetRegistry());
+  registry_.Create<FramePacer>();
   StaticRegistry::Create(GetRegistry());
 }
 
 void Mainloop::Initialize() { registry_.Initialize(); }
 
+void Mainloop::WaitForEvents(absl::Duration timeout) {
+  absl::SleepFor(timeout);
+}
+
 absl::StatusCode Mainloop::Run(const PerFrameCallback& cb) {
+  auto* choreographer = registry_.Get<Choreographer>();
+  auto* frame_pacer = registry_.Get<FramePacer>();
   absl::Time last_time = absl::Now();
   absl::StatusCode status = absl::StatusCode::kOk;
   while (status == absl::StatusCode::kOk) {
@@ -47,14 +55,20 @@ absl::StatusCode Mainloop::Run(const PerFrameCallback& cb) {
     if (status == absl::StatusCode::kOk) {
       const absl::Time now = absl::Now();
       const absl::Duration delta = now - last_time;
+      const bool render = frame_pacer->BeginFrame(now);
+      choreographer->SetStageEnabled(Choreographer::Stage::kRender, render);
 #ifdef REDUX_EDITOR
       // Editor will step the choreographer, but can do things like slow
       // down or single step the framerate.
       status = registry_.Get<Editor>()->Update(delta);
 #else
-      registry_.Get<Choreographer>()->Step(delta);
+      choreographer->Step(delta);
 #endif
       last_time = now;
+
+      if (frame_pacer->IsIdle()) {
+        WaitForEvents(frame_pacer->GetTimeUntilNextFrame(absl::Now()));
+      }
     }
   }
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include <string_view>
 
 #include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "redux/modules/base/registry.h"
 #include "redux/modules/math/vector.h"
 
@@ -52,7 +53,7 @@ class Mainloop {
 
   // Runs the mainloop. A user-supplied callback can be provided which will be
   // run "inside" the loop. If the callback returns a non-Ok status, the loop
-  // will be exited.
+  // will be exited. Rendering is paced by the FramePacer in the registry.
   using PerFrameCallback = std::function<absl::StatusCode()>;
   absl::StatusCode Run(const PerFrameCallback& cb);
 
@@ -64,6 +65,10 @@ class Mainloop {
 
   virtual absl::StatusCode PollEvents() = 0;
 
+  // Blocks for up to `timeout` while the FramePacer is idle. Implementations
+  // should return early if a system event arrives.
+  virtual void WaitForEvents(absl::Duration timeout);
+
   Registry registry_;
 };
 
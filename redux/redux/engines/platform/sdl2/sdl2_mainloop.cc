@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <memory>
 
+#include "redux/engines/platform/frame_pacer.h"
 #include "redux/engines/platform/sdl2/sdl2_display.h"
 #include "redux/engines/platform/sdl2/sdl2_keyboard.h"
 #include "redux/engines/platform/sdl2/sdl2_mouse.h"
@@ -59,7 +60,9 @@ void Sdl2Mainloop::CreateSpeaker() {
 
 absl::StatusCode Sdl2Mainloop::PollEvents() {
   SDL_Event event;
+  bool has_events = false;
   while (SDL_PollEvent(&event)) {
+    has_events = true;
     if (event.type == SDL_QUIT) {
       return absl::StatusCode::kCancelled;
     } else if (event.type == SDL_APP_WILLENTERBACKGROUND) {
@@ -73,7 +76,18 @@ absl::StatusCode Sdl2Mainloop::PollEvents() {
   for (auto& iter : handlers_) {
     iter->Commit();
   }
+  if (has_events) {
+    registry_.Get<FramePacer>()->RequestFrame();
+  }
   return absl::StatusCode::kOk;
 }
 
+void Sdl2Mainloop::WaitForEvents(absl::Duration timeout) {
+  // Leaves any event in the queue to be handled by the next PollEvents.
+  const int ms = static_cast<int>(absl::ToInt64Milliseconds(timeout));
+  if (ms > 0) {
+    SDL_WaitEventTimeout(nullptr, ms);
+  }
+}
+
 }  // namespace redux
@@ -39,6 +39,7 @@ class Sdl2Mainloop : public Mainloop {
 
  private:
   absl::StatusCode PollEvents() override;
+  void WaitForEvents(absl::Duration timeout) override;
 
   std::vector<std::unique_ptr<Sdl2EventHandler>> handlers_;
 };
@@ -17,6 +17,7 @@ limitations under the License.
 #include "redux/engines/render/filament/filament_render_engine.h"
 
 #include "filament/Fence.h"
+#include "filament/TransformManager.h"
 #include "redux/engines/platform/device_manager.h"
 #include "redux/engines/render/filament/filament_indirect_light.h"
 #include "redux/engines/render/filament/filament_light.h"
@@ -110,6 +111,12 @@ void FilamentRenderEngine::OnRegistryInitialize() {
   clear_options.discard = true;
   frenderer_->setClearOptions(clear_options);
 
+  // Gives layers using dynamic resolution some headroom below the frame budget
+  // so that the scale is lowered before frames are dropped.
+  filament::Renderer::FrameRateOptions frame_rate_options;
+  frame_rate_options.headRoomRatio = 0.1f;
+  frenderer_->setFrameRateOptions(frame_rate_options);
+
   auto target = std::make_shared<FilamentRenderTarget>(registry_);
   default_render_target_ = std::static_pointer_cast<RenderTarget>(target);
 
@@ -171,7 +178,19 @@ IndirectLightPtr FilamentRenderEngine::CreateIndirectLight(
   return std::static_pointer_cast<IndirectLight>(light);
 }
 
+void FilamentRenderEngine::BeginTransformBatch() {
+  fengine_->getTransformManager().openLocalTransformTransaction();
+}
+
+void FilamentRenderEngine::CommitTransformBatch() {
+  fengine_->getTransformManager().commitLocalTransformTransaction();
+}
+
 bool FilamentRenderEngine::Render() {
+  // Recycle transient resources released in earlier frames.
+  texture_factory_->AdvanceFrame();
+  render_target_factory_->AdvanceFrame();
+
   std::vector<FilamentRenderLayer*> layers;
   layers.reserve(layers_.size());
   for (auto& iter : layers_) {
@@ -68,6 +68,14 @@ class FilamentRenderEngine : public RenderEngine {
   IndirectLightPtr CreateIndirectLight(const TexturePtr& reflection,
                                        const TexturePtr& irradiance = nullptr);
 
+  // Starts a batch of Renderable::SetTransform calls. Transforms set during the
+  // batch are applied together by CommitTransformBatch, which is much cheaper
+  // than applying them one at a time when many renderables are moving.
+  void BeginTransformBatch();
+
+  // Applies all transforms set since BeginTransformBatch.
+  void CommitTransformBatch();
+
   // Renders all active RenderLayers in priority order.
   bool Render();
 
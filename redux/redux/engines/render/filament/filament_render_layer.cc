@@ -68,6 +68,24 @@ void FilamentRenderLayer::DisablePostProcessing() {
   fview_->setPostProcessingEnabled(false);
 }
 
+void FilamentRenderLayer::EnableDynamicResolution(float min_scale,
+                                                  float max_scale) {
+  CHECK(min_scale > 0.f && min_scale <= max_scale && max_scale <= 1.f)
+      << "Invalid dynamic resolution range: " << min_scale << " to "
+      << max_scale;
+  filament::View::DynamicResolutionOptions options;
+  options.enabled = true;
+  options.minScale = {min_scale, min_scale};
+  options.maxScale = {max_scale, max_scale};
+  fview_->setDynamicResolutionOptions(options);
+}
+
+void FilamentRenderLayer::DisableDynamicResolution() {
+  filament::View::DynamicResolutionOptions options;
+  options.enabled = false;
+  fview_->setDynamicResolutionOptions(options);
+}
+
 void FilamentRenderLayer::SetClipPlaneDistances(float near, float far) {
   near_plane_ = near;
   far_plane_ = far;
@@ -29,6 +29,9 @@ namespace redux {
 
 static constexpr HashValue kRootPart = HashValue(0);
 
+// The maximum number of instances filament supports in a single renderable.
+static constexpr std::size_t kMaxInstances = 32767;
+
 static filament::RenderableManager::PrimitiveType ToFilament(
     MeshPrimitiveType type) {
   switch (type) {
@@ -61,16 +64,64 @@ FilamentRenderable::FilamentRenderable(Registry* registry) {
 
 FilamentRenderable::~FilamentRenderable() { DestroyParts(); }
 
-void FilamentRenderable::PrepareToRender(const mat4& transform) {
+void FilamentRenderable::SetTransform(const mat4& transform) {
+  transform_ = transform;
+
   auto& tm = fengine_->getTransformManager();
+  const auto mx = ToFilament(transform_);
+  for (auto& iter : parts_) {
+    tm.setTransform(tm.getInstance(iter.second.fentity), mx);
+  }
+}
+
+void FilamentRenderable::SetMaxInstances(std::size_t max_instances) {
+  CHECK_LE(max_instances, kMaxInstances);
+  if (max_instances == instances_.GetCapacity()) {
+    return;
+  }
+
+  instances_.SetCapacity(max_instances);
+  finstance_transforms_.resize(max_instances);
+  if (mesh_) {
+    CreateParts();
+    RebuildConditions();
+  }
+}
+
+void FilamentRenderable::SetInstanceTransforms(
+    absl::Span<const mat4> transforms) {
+  CHECK(instances_.GetCapacity() > 0) << "Instancing is not enabled.";
+  instances_.Set(transforms);
+  for (auto& iter : parts_) {
+    UpdateInstances(iter.second);
+  }
+}
+
+void FilamentRenderable::UpdateInstances(PartInstance& part) {
+  if (!part.finstance_buffer) {
+    return;
+  }
+
+  const std::vector<mat4>& transforms = instances_.GetTransforms();
+  for (std::size_t i = 0; i < transforms.size(); ++i) {
+    finstance_transforms_[i] = ToFilament(transforms[i]);
+  }
+  part.finstance_buffer->setLocalTransforms(finstance_transforms_.data(),
+                                            finstance_transforms_.size());
+
+  // Filament culls the renderable as a whole, so its bounding box must enclose
+  // all of the instances.
+  auto& rm = fengine_->getRenderableManager();
+  rm.setAxisAlignedBoundingBox(rm.getInstance(part.fentity),
+                               ToFilament(instances_.GetBounds(part.box)));
+}
+
+void FilamentRenderable::PrepareToRender() {
   auto& rm = fengine_->getRenderableManager();
 
   const uint8_t global_visbility = IsHidden(kRootPart) ? 0x00 : 0xff;
-  const auto mx = ToFilament(transform);
   for (auto& iter : parts_) {
-    auto ti = tm.getInstance(iter.second.fentity);
     auto ri = rm.getInstance(iter.second.fentity);
-    tm.setTransform(ti, mx);
 
     const uint8_t local_visibility = IsHidden(iter.first) ? 0x00 : 0xff;
     const uint8_t visibility = global_visbility & local_visibility;
@@ -219,8 +270,20 @@ void FilamentRenderable::CreateParts() {
       builder.skinning(255);
     }
 
+    part.box = submesh.box;
+    if (instances_.GetCapacity() > 0) {
+      const std::size_t count = instances_.GetCapacity();
+      auto* fbuffer = filament::InstanceBuffer::Builder(count).build(*fengine_);
+      part.finstance_buffer = MakeFilamentResource(fbuffer, fengine_);
+      builder.instances(count, fbuffer);
+    }
+
     part.fentity = utils::EntityManager::get().create();
     builder.build(*fengine_, part.fentity);
+    UpdateInstances(part);
+
+    auto& tm = fengine_->getTransformManager();
+    tm.setTransform(tm.getInstance(part.fentity), ToFilament(transform_));
 
     // Add the part to all the scenes to which this belongs.
     for (filament::Scene* scene : scenes_) {
@@ -17,11 +17,16 @@ limitations under the License.
 #ifndef REDUX_ENGINES_RENDER_FILAMENT_FILAMENT_RENDERABLE_H_
 #define REDUX_ENGINES_RENDER_FILAMENT_FILAMENT_RENDERABLE_H_
 
+#include <cstddef>
+#include <vector>
+
 #include "filament/Engine.h"
+#include "filament/InstanceBuffer.h"
 #include "utils/Entity.h"
 #include "redux/engines/render/filament/filament_render_scene.h"
 #include "redux/engines/render/filament/filament_shader.h"
 #include "redux/engines/render/filament/filament_utils.h"
+#include "redux/engines/render/instance_transforms.h"
 #include "redux/engines/render/renderable.h"
 #include "redux/modules/base/data_buffer.h"
 #include "redux/modules/base/registry.h"
@@ -43,9 +48,23 @@ class FilamentRenderable : public Renderable {
   explicit FilamentRenderable(Registry* registry);
   ~FilamentRenderable() override;
 
-  // Prepares the renderable for rendering. The transform is used to place the
-  // renderable in all scenes to which it belongs.
-  void PrepareToRender(const mat4& transform);
+  // Sets the transform used to place the renderable in all scenes to which it
+  // belongs. Calls made between RenderEngine::BeginTransformBatch and
+  // RenderEngine::CommitTransformBatch are applied together.
+  void SetTransform(const mat4& transform);
+
+  // Prepares the renderable for rendering.
+  void PrepareToRender();
+
+  // Enables GPU instancing. The renderable's mesh and materials are shared by
+  // up to `max_instances` copies, all drawn by a single draw call. Setting zero
+  // (the default) disables instancing.
+  void SetMaxInstances(std::size_t max_instances);
+
+  // Sets the transforms of the instances, relative to the transform of the
+  // renderable itself. Only the first `max_instances` transforms are used; any
+  // remaining instances are not drawn.
+  void SetInstanceTransforms(absl::Span<const mat4> transforms);
 
   // Enables the renderable (or a part of the renderable) to be rendered.
   void Show(std::optional<HashValue> part = std::nullopt);
@@ -105,6 +124,8 @@ class FilamentRenderable : public Renderable {
     utils::Entity fentity;
     FilamentShader::VariantId variant_id = FilamentShader::kInvalidVariant;
     FilamentResourcePtr<filament::MaterialInstance> finstance;
+    FilamentResourcePtr<filament::InstanceBuffer> finstance_buffer;
+    Box box;
     absl::flat_hash_map<HashValue, int> property_generations;
     ShaderPtr shader;
   };
@@ -125,6 +146,7 @@ class FilamentRenderable : public Renderable {
 
   void CreateParts();
   void DestroyParts();
+  void UpdateInstances(PartInstance& part);
   void RebuildConditions();
   void ReacquireInstance(HashValue part);
   bool ApplyProperties(HashValue name, PartInstance& part);
@@ -139,6 +161,9 @@ class FilamentRenderable : public Renderable {
   absl::flat_hash_map<HashValue, Material> materials_;
   absl::flat_hash_map<HashValue, PartInstance> parts_;
   mutable absl::flat_hash_set<filament::Scene*> scenes_;
+  mat4 transform_ = mat4::Identity();
+  InstanceTransforms instances_;
+  std::vector<filament::math::mat4f> finstance_transforms_;
   bool is_skinned_ = false;
 };
 
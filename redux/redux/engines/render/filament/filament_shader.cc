@@ -44,35 +44,36 @@ absl::Span<const std::byte> AsBytes(const FlatVector<T>& vec) {
   return {bytes, size};
 }
 
-static FilamentResourcePtr<filament::Material> ReadFilamentMaterial(
-    filament::Engine* engine, const FlatVector<uint8_t>* matc) {
-  CHECK(matc);
-  filament::Material::Builder builder;
-  builder.package(matc->data(), matc->size());
-  return MakeFilamentResource(builder.build(*engine), engine);
-}
-
 FilamentShader::FilamentShader(Registry* registry, const ShaderAssetDef* def) {
   fengine_ = GetFilamentEngine(registry);
   if (def && def->variants()) {
-    for (const auto& variant : *def->variants()) {
+    // Without a prewarm manifest, every variant is created up front.
+    absl::btree_set<uint32_t> prewarm;
+    if (def->prewarm_variants()) {
+      prewarm.insert(def->prewarm_variants()->begin(),
+                     def->prewarm_variants()->end());
+    }
+
+    for (uint32_t i = 0; i < def->variants()->size(); ++i) {
+      const auto* variant = def->variants()->Get(i);
       CHECK(variant);
-      BuildVariant(variant);
+      BuildVariant(variant, prewarm.empty() || prewarm.contains(i));
     }
   }
 }
 
-void FilamentShader::BuildVariant(const ShaderVariantAssetDef* def) {
+void FilamentShader::BuildVariant(const ShaderVariantAssetDef* def,
+                                  bool create_material) {
+  CHECK(def->filament_material());
   auto variant = std::make_unique<Variant>();
-  variant->fmaterial = ReadFilamentMaterial(fengine_, def->filament_material());
+  variant->package.assign(def->filament_material()->begin(),
+                          def->filament_material()->end());
   variant->conditions = ReadFlags(def->conditions());
   variant->features = ReadFlags(def->features());
 
-  filament::MaterialInstance* default_instance =
-      variant->fmaterial->getDefaultInstance();
-
   if (def->properties()) {
     variant->params.reserve(def->properties()->size());
+    variant->defaults.reserve(def->properties()->size());
     for (const ShaderPropertyAssetDef* property : *def->properties()) {
       CHECK(property->name() && property->name()->name());
       ParameterInfo param;
@@ -87,19 +88,42 @@ void FilamentShader::BuildVariant(const ShaderVariantAssetDef* def) {
       }
       variant->params.emplace_back(param);
 
+      absl::Span<const std::byte> data;
       if (property->default_floats()) {
-        absl::Span<const std::byte> data = AsBytes(*property->default_floats());
-        SetParameter(default_instance, param.name.c_str(), param.type, data);
+        data = AsBytes(*property->default_floats());
       } else if (property->default_ints()) {
-        absl::Span<const std::byte> data = AsBytes(*property->default_ints());
-        SetParameter(default_instance, param.name.c_str(), param.type, data);
+        data = AsBytes(*property->default_ints());
       }
+      variant->defaults.emplace_back(data.begin(), data.end());
     }
   }
 
+  if (create_material) {
+    CreateMaterial(variant.get());
+  }
   variants_.emplace_back(std::move(variant));
 }
 
+void FilamentShader::CreateMaterial(Variant* variant) const {
+  filament::Material::Builder builder;
+  builder.package(variant->package.data(), variant->package.size());
+  variant->fmaterial = MakeFilamentResource(builder.build(*fengine_), fengine_);
+
+  filament::MaterialInstance* default_instance =
+      variant->fmaterial->getDefaultInstance();
+  for (size_t i = 0; i < variant->params.size(); ++i) {
+    const ParameterInfo& param = variant->params[i];
+    if (!variant->defaults[i].empty()) {
+      SetParameter(default_instance, param.name.c_str(), param.type,
+                   variant->defaults[i]);
+    }
+  }
+
+  // The package and defaults are no longer needed once the material exists.
+  variant->package = std::vector<uint8_t>();
+  variant->defaults = std::vector<std::vector<std::byte>>();
+}
+
 FilamentShader::VariantId FilamentShader::DetermineVariantId(
     const FlagSet& conditions, const FlagSet& features) const {
   for (int i = 0; i < variants_.size(); ++i) {
@@ -118,6 +142,9 @@ const filament::Material* FilamentShader::GetFilamentMaterial(
     VariantId id) const {
   CHECK(id >= 0 && id < variants_.size());
   auto& variant = variants_[id];
+  if (variant->fmaterial == nullptr) {
+    CreateMaterial(variant.get());
+  }
   return variant->fmaterial.get();
 }
 
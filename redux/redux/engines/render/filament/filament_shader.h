@@ -43,6 +43,9 @@ namespace redux {
 // filament::Material. Each variant supports a set of features (e.g. skinning)
 // and depends on a set of conditions (i.e. bone weights/indices vertex
 // attributes).
+//
+// If the shader asset has a prewarm manifest, only the listed variants are
+// created when the shader is loaded; the others are created on first use.
 class FilamentShader : public Shader {
  public:
   FilamentShader(Registry* registry, const ShaderAssetDef* def);
@@ -57,7 +60,8 @@ class FilamentShader : public Shader {
   VariantId DetermineVariantId(const FlagSet& conditions,
                                const FlagSet& features) const;
 
-  // Returns the filament::Material for the given variant.
+  // Returns the filament::Material for the given variant, creating it if it was
+  // deferred.
   const filament::Material* GetFilamentMaterial(VariantId id) const;
 
   // Information about a single parameter in a material.
@@ -90,9 +94,15 @@ class FilamentShader : public Shader {
     std::vector<ParameterInfo> params;
     FlagSet conditions;
     FlagSet features;
+
+    // The filament material package and default parameter values (indexed
+    // like `params`) of a variant whose material has not been created yet.
+    std::vector<uint8_t> package;
+    std::vector<std::vector<std::byte>> defaults;
   };
 
-  void BuildVariant(const ShaderVariantAssetDef* def);
+  void BuildVariant(const ShaderVariantAssetDef* def, bool create_material);
+  void CreateMaterial(Variant* variant) const;
 
   filament::Engine* fengine_ = nullptr;
   std::vector<std::unique_ptr<Variant>> variants_;
@@ -174,6 +174,29 @@ bool FilamentTexture::Update(ImageData image) {
   return true;
 }
 
+bool FilamentTexture::UpdateRegion(const vec2i& offset, ImageData image) {
+  if (ftexture_ == nullptr || target_ != TextureTarget::Normal2D) {
+    return false;
+  }
+  const vec2i size = image.GetSize();
+  if (offset.x < 0 || offset.y < 0 || offset.x + size.x > dimensions_.x ||
+      offset.y + size.y > dimensions_.y) {
+    return false;
+  }
+  if (image.GetNumBytes() == 0) {
+    return false;
+  }
+
+  auto image_data = std::make_shared<ImageData>(std::move(image));
+  filament::Texture::PixelBufferDescriptor buffer =
+      CreatePixelBuffer(image_data);
+  buffer.stride = image_data->GetStrideInPixels();
+  buffer.alignment = 1;
+  ftexture_->setImage(*fengine_, 0, offset.x, offset.y, size.x, size.y,
+                      std::move(buffer));
+  return true;
+}
+
 void FilamentTexture::Build(ImageData image_data, const TextureParams& params) {
   Build(std::make_shared<ImageData>(std::move(image_data)), params);
 }
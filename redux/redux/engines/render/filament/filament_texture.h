@@ -59,6 +59,11 @@ class FilamentTexture : public Texture, public Readiable {
   // internal and 2D.
   bool Update(ImageData image);
 
+  // Updates the region of the texture starting at `offset` (in pixels) with
+  // the contents of `image`. Returns false if the region doesn't fit within the
+  // texture or if the texture isn't internal and 2D.
+  bool UpdateRegion(const vec2i& offset, ImageData image);
+
   void Build(const std::shared_ptr<ImageData>& image_data,
              const TextureParams& params);
   void Update(const std::shared_ptr<ImageData>& image_data);
@@ -20,6 +20,69 @@ limitations under the License.
 
 namespace redux {
 
+static std::size_t GetBytesPerPixel(RenderTargetFormat format) {
+  switch (format) {
+    case RenderTargetFormat::None:
+      return 0;
+    case RenderTargetFormat::Red8:
+      return 1;
+    case RenderTargetFormat::Rgb8:
+    case RenderTargetFormat::Rgba8:
+      return 4;
+  }
+  return 0;
+}
+
+static std::size_t GetBytesPerPixel(RenderTargetDepthStencilFormat format) {
+  switch (format) {
+    case RenderTargetDepthStencilFormat::None:
+      return 0;
+    case RenderTargetDepthStencilFormat::Stencil8:
+      return 1;
+    case RenderTargetDepthStencilFormat::Depth16:
+      return 2;
+    case RenderTargetDepthStencilFormat::Depth24:
+    case RenderTargetDepthStencilFormat::Depth32f:
+    case RenderTargetDepthStencilFormat::Depth24Stencil8:
+      return 4;
+    case RenderTargetDepthStencilFormat::Depth32fStencil8:
+      return 8;
+  }
+  return 0;
+}
+
+static HashValue GetPoolKey(const RenderTargetParams& params) {
+  const int fields[] = {
+      params.dimensions.x,
+      params.dimensions.y,
+      static_cast<int>(params.texture_format),
+      static_cast<int>(params.depth_stencil_format),
+      static_cast<int>(params.num_mip_levels),
+      static_cast<int>(params.min_filter),
+      static_cast<int>(params.mag_filter),
+      static_cast<int>(params.wrap_s),
+      static_cast<int>(params.wrap_t),
+  };
+  // Hash() stops at the first zero byte, so combine the fields instead.
+  HashValue key(0);
+  for (int field : fields) {
+    key = Combine(key, HashValue(static_cast<HashValue::Rep>(field)));
+  }
+  return key;
+}
+
+static std::size_t GetNumBytes(const RenderTargetParams& params) {
+  const std::size_t num_pixels = static_cast<std::size_t>(params.dimensions.x) *
+                                 static_cast<std::size_t>(params.dimensions.y);
+  std::size_t color_bytes =
+      num_pixels * GetBytesPerPixel(params.texture_format);
+  if (params.num_mip_levels != 1) {
+    color_bytes += color_bytes / 3;
+  }
+  return color_bytes +
+         num_pixels * GetBytesPerPixel(params.depth_stencil_format);
+}
+
 RenderTargetFactory::RenderTargetFactory(Registry* registry)
     : registry_(registry) {}
 
@@ -39,4 +102,18 @@ RenderTargetPtr RenderTargetFactory::CreateRenderTarget(
   return target;
 }
 
+RenderTargetPtr RenderTargetFactory::AcquirePooledRenderTarget(
+    const RenderTargetParams& params) {
+  return pool_.Acquire(GetPoolKey(params), GetNumBytes(params), [&]() {
+    return std::static_pointer_cast<RenderTarget>(
+        std::make_shared<FilamentRenderTarget>(registry_, params));
+  });
+}
+
+void RenderTargetFactory::AdvanceFrame() { pool_.AdvanceFrame(); }
+
+RenderTargetFactory::PoolStats RenderTargetFactory::GetPoolStats() const {
+  return pool_.GetStats();
+}
+
 }  // namespace redux
@@ -23,9 +23,33 @@ limitations under the License.
 #include "redux/modules/base/asset_loader.h"
 #include "redux/modules/codecs/decode_image.h"
 #include "redux/modules/graphics/enums.h"
+#include "redux/modules/graphics/image_utils.h"
 
 namespace redux {
 
+static HashValue GetPoolKey(const vec2i& size, ImageFormat format,
+                            const TextureParams& params) {
+  const int fields[] = {
+      size.x,
+      size.y,
+      static_cast<int>(format),
+      static_cast<int>(params.min_filter),
+      static_cast<int>(params.mag_filter),
+      static_cast<int>(params.wrap_s),
+      static_cast<int>(params.wrap_t),
+      static_cast<int>(params.wrap_r),
+      static_cast<int>(params.target),
+      static_cast<int>(params.premultiply_alpha),
+      static_cast<int>(params.generate_mipmaps),
+  };
+  // Hash() stops at the first zero byte, so combine the fields instead.
+  HashValue key(0);
+  for (int field : fields) {
+    key = Combine(key, HashValue(static_cast<HashValue::Rep>(field)));
+  }
+  return key;
+}
+
 TextureFactory::TextureFactory(Registry* registry) : registry_(registry) {}
 
 TexturePtr TextureFactory::GetTexture(HashValue name) const {
@@ -59,6 +83,28 @@ TexturePtr TextureFactory::CreateTexture(const vec2i& size, ImageFormat format,
   return CreateTexture(std::move(empty), params);
 }
 
+TexturePtr TextureFactory::AcquirePooledTexture(const vec2i& size,
+                                                ImageFormat format,
+                                                const TextureParams& params) {
+  std::size_t num_bytes = static_cast<std::size_t>(size.x) *
+                          static_cast<std::size_t>(size.y) *
+                          GetBytesPerPixel(format);
+  if (params.target == TextureTarget::CubeMap) {
+    num_bytes *= 6;
+  }
+  if (params.generate_mipmaps) {
+    num_bytes += num_bytes / 3;
+  }
+  return pool_.Acquire(GetPoolKey(size, format, params), num_bytes,
+                       [&]() { return CreateTexture(size, format, params); });
+}
+
+void TextureFactory::AdvanceFrame() { pool_.AdvanceFrame(); }
+
+TextureFactory::PoolStats TextureFactory::GetPoolStats() const {
+  return pool_.GetStats();
+}
+
 TexturePtr TextureFactory::LoadTexture(std::string_view uri,
                                        const TextureParams& params) {
   const HashValue key = Hash(uri);
@@ -0,0 +1,58 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/render/instance_transforms.h"
+
+#include <algorithm>
+
+#include "redux/modules/math/transform.h"
+
+namespace redux {
+
+const mat4 InstanceTransforms::kHidden =
+    TransformMatrix(vec3::Zero(), quat::Identity(), vec3::Zero());
+
+void InstanceTransforms::SetCapacity(std::size_t capacity) {
+  transforms_.resize(capacity, kHidden);
+  num_active_ = std::min(num_active_, capacity);
+}
+
+void InstanceTransforms::Set(absl::Span<const mat4> transforms) {
+  const std::size_t count = std::min(transforms.size(), transforms_.size());
+  std::copy_n(transforms.begin(), count, transforms_.begin());
+  std::fill(transforms_.begin() + count, transforms_.end(), kHidden);
+  num_active_ = count;
+}
+
+Box InstanceTransforms::GetBounds(const Box& box) const {
+  if (num_active_ == 0) {
+    return box;
+  }
+
+  Box bounds = Box::Empty();
+  const vec3 corners[] = {box.min, box.max};
+  for (std::size_t i = 0; i < num_active_; ++i) {
+    const mat4& mx = transforms_[i];
+    for (int c = 0; c < 8; ++c) {
+      const vec3 corner(corners[c & 1].x, corners[(c >> 1) & 1].y,
+                        corners[(c >> 2) & 1].z);
+      bounds = bounds.Included(mx * corner);
+    }
+  }
+  return bounds;
+}
+
+}  // namespace redux
@@ -0,0 +1,64 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_RENDER_INSTANCE_TRANSFORMS_H_
+#define REDUX_ENGINES_RENDER_INSTANCE_TRANSFORMS_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "redux/modules/math/bounds.h"
+#include "redux/modules/math/matrix.h"
+
+namespace redux {
+
+// The per-instance transforms of an instanced renderable.
+//
+// A fixed number of instances (the capacity) is always uploaded to the GPU.
+// Only the first `GetNumActive()` of them are drawn; the rest are scaled down
+// to a point.
+class InstanceTransforms {
+ public:
+  // Changes the number of instances. Existing transforms are kept, new ones
+  // are hidden, and the active count is clamped to the new capacity.
+  void SetCapacity(std::size_t capacity);
+
+  // Sets the transforms of the active instances. Only the first `GetCapacity()`
+  // transforms are used; any remaining instances are hidden.
+  void Set(absl::Span<const mat4> transforms);
+
+  // Returns the bounds enclosing `box` under the transform of every active
+  // instance, or `box` itself if there are no active instances.
+  Box GetBounds(const Box& box) const;
+
+  // Returns the transforms of all instances, active or not.
+  const std::vector<mat4>& GetTransforms() const { return transforms_; }
+
+  std::size_t GetCapacity() const { return transforms_.size(); }
+  std::size_t GetNumActive() const { return num_active_; }
+
+  // The transform applied to instances that are not drawn.
+  static const mat4 kHidden;
+
+ private:
+  std::vector<mat4> transforms_;
+  std::size_t num_active_ = 0;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_ENGINES_RENDER_INSTANCE_TRANSFORMS_H_
@@ -0,0 +1,130 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/render/instance_transforms.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/math/constants.h"
+#include "redux/modules/math/testing.h"
+#include "redux/modules/math/transform.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+
+constexpr float kEpsilon = 1e-5f;
+
+mat4 Translation(float x, float y, float z) {
+  return TransformMatrix(vec3(x, y, z), quat::Identity(), vec3::One());
+}
+
+TEST(InstanceTransformsTest, NewInstancesAreHidden) {
+  InstanceTransforms instances;
+  EXPECT_THAT(instances.GetCapacity(), Eq(0u));
+
+  instances.SetCapacity(3);
+  EXPECT_THAT(instances.GetCapacity(), Eq(3u));
+  EXPECT_THAT(instances.GetNumActive(), Eq(0u));
+  for (const mat4& mx : instances.GetTransforms()) {
+    EXPECT_THAT(mx, MathNear(InstanceTransforms::kHidden, kEpsilon));
+    EXPECT_THAT(mx * vec3(1, 2, 3), MathNear(vec3::Zero(), kEpsilon));
+  }
+}
+
+TEST(InstanceTransformsTest, HidesUnsetInstances) {
+  InstanceTransforms instances;
+  instances.SetCapacity(3);
+
+  const mat4 transforms[] = {Translation(1, 0, 0), Translation(2, 0, 0),
+                             Translation(3, 0, 0)};
+  instances.Set(transforms);
+  EXPECT_THAT(instances.GetNumActive(), Eq(3u));
+
+  instances.Set(absl::MakeConstSpan(transforms, 1));
+  EXPECT_THAT(instances.GetNumActive(), Eq(1u));
+  const std::vector<mat4>& result = instances.GetTransforms();
+  EXPECT_THAT(result[0], MathNear(transforms[0], kEpsilon));
+  EXPECT_THAT(result[1], MathNear(InstanceTransforms::kHidden, kEpsilon));
+  EXPECT_THAT(result[2], MathNear(InstanceTransforms::kHidden, kEpsilon));
+}
+
+TEST(InstanceTransformsTest, ClampsToCapacity) {
+  InstanceTransforms instances;
+  instances.SetCapacity(2);
+
+  const mat4 transforms[] = {Translation(1, 0, 0), Translation(2, 0, 0),
+                             Translation(3, 0, 0)};
+  instances.Set(transforms);
+  EXPECT_THAT(instances.GetNumActive(), Eq(2u));
+  EXPECT_THAT(instances.GetTransforms()[1], MathNear(transforms[1], kEpsilon));
+
+  // Shrinking keeps the remaining transforms and clamps the active count.
+  instances.SetCapacity(1);
+  EXPECT_THAT(instances.GetNumActive(), Eq(1u));
+  EXPECT_THAT(instances.GetTransforms()[0], MathNear(transforms[0], kEpsilon));
+
+  // Growing adds hidden instances.
+  instances.SetCapacity(2);
+  EXPECT_THAT(instances.GetNumActive(), Eq(1u));
+  EXPECT_THAT(instances.GetTransforms()[1],
+              MathNear(InstanceTransforms::kHidden, kEpsilon));
+}
+
+TEST(InstanceTransformsTest, BoundsWithoutActiveInstances) {
+  InstanceTransforms instances;
+  instances.SetCapacity(2);
+
+  const Box box(vec3(-1, -1, -1), vec3(1, 1, 1));
+  const Box bounds = instances.GetBounds(box);
+  EXPECT_THAT(bounds.min, MathNear(box.min, kEpsilon));
+  EXPECT_THAT(bounds.max, MathNear(box.max, kEpsilon));
+}
+
+TEST(InstanceTransformsTest, BoundsEncloseActiveInstances) {
+  InstanceTransforms instances;
+  instances.SetCapacity(3);
+
+  // The third instance is inactive, so it must not widen the bounds.
+  const mat4 transforms[] = {
+      Translation(-5, 0, 0),
+      TransformMatrix(vec3(0, 3, 0), quat::Identity(), vec3(2, 2, 2))};
+  instances.Set(transforms);
+
+  const Box box(vec3(-1, -1, -1), vec3(1, 1, 1));
+  const Box bounds = instances.GetBounds(box);
+  EXPECT_THAT(bounds.min, MathNear(vec3(-6, -1, -2), kEpsilon));
+  EXPECT_THAT(bounds.max, MathNear(vec3(2, 5, 2), kEpsilon));
+}
+
+TEST(InstanceTransformsTest, BoundsFollowRotation) {
+  InstanceTransforms instances;
+  instances.SetCapacity(1);
+
+  const quat rotation = QuaternionFromAxisAngle(vec3(0, 0, 1), kPi / 2.0f);
+  const mat4 transforms[] = {
+      TransformMatrix(vec3::Zero(), rotation, vec3::One())};
+  instances.Set(transforms);
+
+  const Box box(vec3(0, 0, 0), vec3(2, 1, 1));
+  const Box bounds = instances.GetBounds(box);
+  EXPECT_THAT(bounds.min, MathNear(vec3(-1, 0, 0), kEpsilon));
+  EXPECT_THAT(bounds.max, MathNear(vec3(0, 2, 1), kEpsilon));
+}
+
+}  // namespace
+}  // namespace redux
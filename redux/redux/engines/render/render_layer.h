@@ -94,6 +94,14 @@ class RenderLayer {
   // Disables post-processing (like tone mapping) when rendering the layer.
   void DisablePostProcessing();
 
+  // Allows the layer to be rendered at a lower resolution (and upscaled when
+  // presented) whenever the GPU frame time exceeds the frame budget. The scale
+  // applied to each axis is kept within [min_scale, max_scale].
+  void EnableDynamicResolution(float min_scale, float max_scale);
+
+  // Always renders the layer at its full resolution.
+  void DisableDynamicResolution();
+
  protected:
   explicit RenderLayer() = default;
 };
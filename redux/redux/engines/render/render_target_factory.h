@@ -20,6 +20,7 @@ limitations under the License.
 #include "redux/engines/render/render_target.h"
 #include "redux/modules/base/registry.h"
 #include "redux/modules/base/resource_manager.h"
+#include "redux/modules/base/resource_pool.h"
 
 namespace redux {
 
@@ -93,9 +94,24 @@ class RenderTargetFactory {
   RenderTargetPtr CreateRenderTarget(HashValue name,
                                      const RenderTargetParams& params);
 
+  // Returns an unnamed RenderTarget for transient use (eg. post effects),
+  // reusing a previously released target with the same params if possible.
+  // The target returns to the pool once all references to it are dropped.
+  RenderTargetPtr AcquirePooledRenderTarget(const RenderTargetParams& params);
+
+  // Makes render targets released a few frames ago available for reuse, and
+  // destroys those that have not been reused for a while. Called by the
+  // RenderEngine once per frame.
+  void AdvanceFrame();
+
+  // Returns the hit rate and GPU memory held by the pool of render targets.
+  using PoolStats = ResourcePool<RenderTarget>::Stats;
+  PoolStats GetPoolStats() const;
+
  private:
   Registry* registry_ = nullptr;
   ResourceManager<RenderTarget> render_targets_;
+  ResourcePool<RenderTarget> pool_;
 };
 
 }  // namespace redux
@@ -17,9 +17,11 @@ limitations under the License.
 #ifndef REDUX_ENGINES_RENDER_RENDERABLE_H_
 #define REDUX_ENGINES_RENDER_RENDERABLE_H_
 
+#include <cstddef>
 #include <memory>
 #include <optional>
 
+#include "absl/types/span.h"
 #include "redux/engines/render/mesh.h"
 #include "redux/engines/render/shader.h"
 #include "redux/engines/render/texture.h"
@@ -49,9 +51,23 @@ class Renderable {
   Renderable(const Renderable&) = delete;
   Renderable& operator=(const Renderable&) = delete;
 
-  // Prepares the renderable for rendering. The transform is used to place the
-  // renderable in all scenes to which it belongs.
-  void PrepareToRender(const mat4& transform);
+  // Sets the transform used to place the renderable in all scenes to which it
+  // belongs. Calls made between RenderEngine::BeginTransformBatch and
+  // RenderEngine::CommitTransformBatch are applied together.
+  void SetTransform(const mat4& transform);
+
+  // Prepares the renderable for rendering.
+  void PrepareToRender();
+
+  // Enables GPU instancing. The renderable's mesh and materials are shared by
+  // up to `max_instances` copies, all drawn by a single draw call. Setting zero
+  // (the default) disables instancing.
+  void SetMaxInstances(std::size_t max_instances);
+
+  // Sets the transforms of the instances, relative to the transform of the
+  // renderable itself. Only the first `max_instances` transforms are used; any
+  // remaining instances are not drawn.
+  void SetInstanceTransforms(absl::Span<const mat4> transforms);
 
   // Enables the renderable (or a part of the renderable) to be rendered.
   void Show(std::optional<HashValue> part = std::nullopt);
@@ -55,6 +55,11 @@ class Texture {
   // internal and 2D.
   bool Update(ImageData image);
 
+  // Updates the region of the texture starting at `offset` (in pixels) with
+  // the contents of `image`. Returns false if the region doesn't fit within the
+  // texture or if the texture isn't internal and 2D.
+  bool UpdateRegion(const vec2i& offset, ImageData image);
+
  protected:
   Texture() = default;
 };
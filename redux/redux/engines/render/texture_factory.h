@@ -20,6 +20,7 @@ limitations under the License.
 #include "redux/engines/render/texture.h"
 #include "redux/modules/base/registry.h"
 #include "redux/modules/base/resource_manager.h"
+#include "redux/modules/base/resource_pool.h"
 #include "redux/modules/graphics/image_data.h"
 
 namespace redux {
@@ -66,6 +67,22 @@ class TextureFactory {
   TexturePtr CreateTexture(const vec2i& size, ImageFormat format,
                            const TextureParams& params);
 
+  // Returns an "empty" texture for transient use, as above, reusing a
+  // previously released texture with the same size, format and params if
+  // possible. The texture returns to the pool once all references to it are
+  // dropped.
+  TexturePtr AcquirePooledTexture(const vec2i& size, ImageFormat format,
+                                  const TextureParams& params);
+
+  // Makes textures released a few frames ago available for reuse, and
+  // destroys those that have not been reused for a while. Called by the
+  // RenderEngine once per frame.
+  void AdvanceFrame();
+
+  // Returns the hit rate and GPU memory held by the pool of textures.
+  using PoolStats = ResourcePool<Texture>::Stats;
+  PoolStats GetPoolStats() const;
+
   // Loads a texture off disk with the given |filename| and uses the creation
   // |params| to configure it for the GPU. The filename is also used as the
   // "name" of the texture. Subsequent calls to this function with the same
@@ -82,6 +99,7 @@ class TextureFactory {
  private:
   Registry* registry_ = nullptr;
   ResourceManager<Texture> textures_;
+  ResourcePool<Texture> pool_;
   TexturePtr missing_black_;
   TexturePtr missing_white_;
   TexturePtr missing_normal_;
@@ -54,6 +54,12 @@ IndirectLightPtr RenderEngine::CreateIndirectLight(
     const TexturePtr& reflection, const TexturePtr& irradiance) {
   return Upcast(this)->CreateIndirectLight(reflection, irradiance);
 }
+void RenderEngine::BeginTransformBatch() {
+  Upcast(this)->BeginTransformBatch();
+}
+void RenderEngine::CommitTransformBatch() {
+  Upcast(this)->CommitTransformBatch();
+}
 bool RenderEngine::Render() { return Upcast(this)->Render(); }
 bool RenderEngine::RenderLayer(HashValue name) {
   return Upcast(this)->RenderLayer(name);
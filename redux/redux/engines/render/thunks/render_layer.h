@@ -34,6 +34,12 @@ void RenderLayer::DisableAntiAliasing() { Upcast(this)->DisableAntiAliasing(); }
 void RenderLayer::DisablePostProcessing() {
   Upcast(this)->DisablePostProcessing();
 }
+void RenderLayer::EnableDynamicResolution(float min_scale, float max_scale) {
+  Upcast(this)->EnableDynamicResolution(min_scale, max_scale);
+}
+void RenderLayer::DisableDynamicResolution() {
+  Upcast(this)->DisableDynamicResolution();
+}
 void RenderLayer::SetScene(const RenderScenePtr& scene) {
   Upcast(this)->SetScene(scene);
 }
@@ -22,8 +22,15 @@ limitations under the License.
 namespace redux {
 
 // Thunk functions to call the actual implementation.
-void Renderable::PrepareToRender(const mat4& transform) {
-  Upcast(this)->PrepareToRender(transform);
+void Renderable::SetTransform(const mat4& transform) {
+  Upcast(this)->SetTransform(transform);
+}
+void Renderable::PrepareToRender() { Upcast(this)->PrepareToRender(); }
+void Renderable::SetMaxInstances(std::size_t max_instances) {
+  Upcast(this)->SetMaxInstances(max_instances);
+}
+void Renderable::SetInstanceTransforms(absl::Span<const mat4> transforms) {
+  Upcast(this)->SetInstanceTransforms(transforms);
 }
 void Renderable::SetMesh(MeshPtr mesh) {
   Upcast(this)->SetMesh(std::move(mesh));
@@ -28,6 +28,9 @@ vec2i Texture::GetDimensions() const { return Upcast(this)->GetDimensions(); }
 bool Texture::Update(ImageData image) {
   return Upcast(this)->Update(std::move(image));
 }
+bool Texture::UpdateRegion(const vec2i& offset, ImageData image) {
+  return Upcast(this)->UpdateRegion(offset, std::move(image));
+}
 
 }  // namespace redux
 
@@ -0,0 +1,178 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/script/redux/script_arena.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "redux/modules/base/logging.h"
+
+namespace redux {
+namespace {
+
+// Blocks are aligned to their size so that the block owning any allocation can
+// be found by masking the allocation's address.
+constexpr std::size_t kBlockSize = 64 * 1024;
+constexpr std::size_t kAlignment = alignof(std::max_align_t) > 16
+                                       ? alignof(std::max_align_t)
+                                       : 16;
+
+// The number of unused blocks a thread keeps around once its outermost Scope
+// ends.  Any additional unused blocks are returned to the heap.
+constexpr std::size_t kMaxIdleBlocks = 4;
+
+constexpr std::size_t AlignSize(std::size_t size) {
+  return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+struct Block {
+  // The number of live allocations in the block, plus one for the owning
+  // thread.  Whoever drops the count to zero frees the block, which allows
+  // values to be released on a different thread than the one that created
+  // them, or after the owning thread has exited.
+  std::atomic<int> refs{1};
+  // The offset of the next allocation in the block.  Only used by the owning
+  // thread.
+  std::size_t offset = AlignSize(sizeof(Block));
+};
+
+constexpr std::size_t kHeaderSize = AlignSize(sizeof(Block));
+
+Block* NewBlock() {
+  void* memory = std::aligned_alloc(kBlockSize, kBlockSize);
+  CHECK(memory != nullptr);
+  return new (memory) Block();
+}
+
+void ReleaseBlock(Block* block) {
+  if (block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    block->~Block();
+    std::free(block);
+  }
+}
+
+Block* GetBlock(const void* ptr) {
+  const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+  return reinterpret_cast<Block*>(address & ~(kBlockSize - 1));
+}
+
+// Returns true if all the allocations in the block have been released.
+bool IsIdle(const Block* block) {
+  return block->refs.load(std::memory_order_acquire) == 1;
+}
+
+struct ThreadState {
+  ~ThreadState() {
+    for (Block* block : blocks) {
+      ReleaseBlock(block);
+    }
+  }
+
+  // Returns a block with room for an allocation, reusing an idle block if
+  // possible.
+  Block* NextBlock() {
+    for (Block* block : blocks) {
+      if (IsIdle(block)) {
+        block->offset = kHeaderSize;
+        return block;
+      }
+    }
+    blocks.push_back(NewBlock());
+    return blocks.back();
+  }
+
+  // Rewinds all idle blocks and returns the excess ones to the heap.
+  void Recycle() {
+    std::size_t num_idle = 0;
+    auto iter = blocks.begin();
+    while (iter != blocks.end()) {
+      Block* block = *iter;
+      if (!IsIdle(block)) {
+        ++iter;
+      } else if (num_idle < kMaxIdleBlocks) {
+        block->offset = kHeaderSize;
+        ++num_idle;
+        ++iter;
+      } else {
+        if (block == current) {
+          current = nullptr;
+        }
+        ReleaseBlock(block);
+        iter = blocks.erase(iter);
+      }
+    }
+  }
+
+  std::vector<Block*> blocks;
+  Block* current = nullptr;
+  int depth = 0;
+};
+
+thread_local ThreadState g_state;
+
+}  // namespace
+
+ScriptArena::Scope::Scope() { outermost_ = (g_state.depth++ == 0); }
+
+ScriptArena::Scope::~Scope() {
+  --g_state.depth;
+  if (outermost_) {
+    g_state.Recycle();
+  }
+}
+
+bool ScriptArena::IsActive() { return g_state.depth > 0; }
+
+bool ScriptArena::Contains(const void* ptr) {
+  const Block* block = GetBlock(ptr);
+  for (const Block* owned : g_state.blocks) {
+    if (owned == block) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::shared_ptr<Var> ScriptArena::MakeVar() {
+  CHECK(IsActive()) << "No ScriptArena::Scope is active.";
+  return std::allocate_shared<Var>(Allocator<Var>());
+}
+
+std::size_t ScriptArena::GetNumBlocks() { return g_state.blocks.size(); }
+
+void* ScriptArena::Allocate(std::size_t size) {
+  size = AlignSize(size);
+  CHECK(size <= kBlockSize - kHeaderSize) << "Allocation too large: " << size;
+
+  Block* block = g_state.current;
+  if (block == nullptr || block->offset + size > kBlockSize) {
+    block = g_state.NextBlock();
+    g_state.current = block;
+  }
+
+  void* ptr = reinterpret_cast<std::byte*>(block) + block->offset;
+  block->offset += size;
+  block->refs.fetch_add(1, std::memory_order_relaxed);
+  return ptr;
+}
+
+void ScriptArena::Deallocate(void* ptr) { ReleaseBlock(GetBlock(ptr)); }
+
+}  // namespace redux
@@ -0,0 +1,108 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_SCRIPT_REDUX_SCRIPT_ARENA_H_
+#define REDUX_ENGINES_SCRIPT_REDUX_SCRIPT_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+
+#include "redux/modules/var/var.h"
+
+namespace redux {
+
+// Per-thread bump allocator for the short-lived Vars created while a script is
+// being evaluated.
+//
+// Memory is carved out of fixed-size blocks owned by the calling thread, so
+// allocating a temporary value never touches the general heap (or contends
+// with other threads for it). Each block counts its live allocations; a block
+// whose allocations have all been released is reused from its start. Values
+// that outlive the evaluation remain valid (they simply keep their block
+// alive), but values that are expected to live for a long time should be
+// moved to the heap by calling ScriptValue::PromoteToHeap.
+class ScriptArena {
+ public:
+  // Activates the arena on the calling thread for the lifetime of the Scope.
+  // Scopes may be nested; idle blocks are recycled when the outermost Scope
+  // ends.
+  class Scope {
+   public:
+    Scope();
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    // Returns true if this is the outermost Scope on the calling thread.
+    bool IsOutermost() const { return outermost_; }
+
+   private:
+    bool outermost_ = false;
+  };
+
+  // Returns true if a Scope is active on the calling thread.
+  static bool IsActive();
+
+  // Returns true if |ptr| was allocated from the calling thread's arena.
+  static bool Contains(const void* ptr);
+
+  // Creates an empty Var in the calling thread's arena. A Scope must be
+  // active.
+  static std::shared_ptr<Var> MakeVar();
+
+  // Returns the number of blocks currently owned by the calling thread.
+  static std::size_t GetNumBlocks();
+
+ private:
+  template <typename T>
+  struct Allocator;
+
+  static void* Allocate(std::size_t size);
+  static void Deallocate(void* ptr);
+};
+
+// Standard allocator interface over the ScriptArena, for use with
+// std::allocate_shared.
+template <typename T>
+struct ScriptArena::Allocator {
+  using value_type = T;
+
+  Allocator() = default;
+
+  template <typename U>
+  Allocator(const Allocator<U>&) {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(ScriptArena::Allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, std::size_t) { ScriptArena::Deallocate(ptr); }
+
+  template <typename U>
+  bool operator==(const Allocator<U>&) const {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const Allocator<U>&) const {
+    return false;
+  }
+};
+
+}  // namespace redux
+
+#endif  // REDUX_ENGINES_SCRIPT_REDUX_SCRIPT_ARENA_H_
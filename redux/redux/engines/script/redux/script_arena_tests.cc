@@ -0,0 +1,133 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/script/redux/script_arena.h"
+
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/engines/script/redux/script_stack.h"
+#include "redux/engines/script/redux/script_value.h"
+#include "redux/engines/script/redux/testing.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Le;
+
+TEST(ScriptArenaTest, Scope) {
+  EXPECT_FALSE(ScriptArena::IsActive());
+  {
+    ScriptArena::Scope outer;
+    EXPECT_TRUE(ScriptArena::IsActive());
+    EXPECT_TRUE(outer.IsOutermost());
+    {
+      ScriptArena::Scope inner;
+      EXPECT_TRUE(ScriptArena::IsActive());
+      EXPECT_FALSE(inner.IsOutermost());
+    }
+    EXPECT_TRUE(ScriptArena::IsActive());
+  }
+  EXPECT_FALSE(ScriptArena::IsActive());
+}
+
+TEST(ScriptArenaTest, AllocatesInScope) {
+  ScriptValue heap = 123;
+  EXPECT_FALSE(heap.IsInArena());
+
+  ScriptValue arena;
+  {
+    ScriptArena::Scope scope;
+    arena = 456;
+    EXPECT_TRUE(arena.IsInArena());
+  }
+
+  // Values that outlive the scope remain valid.
+  REDUX_CHECK_SCRIPT_VALUE(heap, 123);
+  REDUX_CHECK_SCRIPT_VALUE(arena, 456);
+}
+
+TEST(ScriptArenaTest, PromoteToHeap) {
+  ScriptValue value;
+  {
+    ScriptArena::Scope scope;
+    value = 123;
+    ScriptValue alias = value;
+    value.PromoteToHeap();
+    EXPECT_FALSE(value.IsInArena());
+    EXPECT_TRUE(alias.IsInArena());
+    REDUX_CHECK_SCRIPT_VALUE(alias, 123);
+  }
+  REDUX_CHECK_SCRIPT_VALUE(value, 123);
+}
+
+TEST(ScriptArenaTest, ReusesBlocks) {
+  ScriptArena::Scope scope;
+  for (int i = 0; i < 100000; ++i) {
+    ScriptValue value = i;
+    REDUX_CHECK_SCRIPT_VALUE(value, i);
+  }
+  EXPECT_THAT(ScriptArena::GetNumBlocks(), Le(2u));
+}
+
+TEST(ScriptArenaTest, ReleaseOnOtherThread) {
+  std::vector<ScriptValue> values;
+  std::thread thread([&values]() {
+    ScriptArena::Scope scope;
+    for (int i = 0; i < 1000; ++i) {
+      values.emplace_back(i);
+    }
+  });
+  thread.join();
+
+  // The values outlive both the scope and the thread that created them.
+  for (int i = 0; i < 1000; ++i) {
+    REDUX_CHECK_SCRIPT_VALUE(values[i], i);
+  }
+  values.clear();
+}
+
+TEST(ScriptArenaTest, PromoteStackValues) {
+  const HashValue a = ConstHash("a");
+  const HashValue b = ConstHash("b");
+  const HashValue c = ConstHash("c");
+
+  ScriptStack stack;
+  {
+    ScriptArena::Scope scope;
+    ScriptValue shared = 123;
+    stack.SetValue(a, shared);
+    stack.SetValue(b, shared);
+    stack.SetValue(c, 456);
+    EXPECT_TRUE(stack.GetValue(a).IsInArena());
+    EXPECT_TRUE(stack.GetValue(c).IsInArena());
+
+    stack.PromoteArenaValues();
+  }
+
+  EXPECT_FALSE(stack.GetValue(a).IsInArena());
+  EXPECT_FALSE(stack.GetValue(b).IsInArena());
+  EXPECT_FALSE(stack.GetValue(c).IsInArena());
+  EXPECT_THAT(stack.GetValue(a).Get<Var>(), Eq(stack.GetValue(b).Get<Var>()));
+  REDUX_CHECK_SCRIPT_VALUE(stack.GetValue(a), 123);
+  REDUX_CHECK_SCRIPT_VALUE(stack.GetValue(c), 456);
+}
+
+}  // namespace
+}  // namespace redux
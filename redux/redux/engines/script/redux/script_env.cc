@@ -26,6 +26,7 @@ limitations under the License.
 #include "redux/engines/script/redux/functions/message.h"
 #include "redux/engines/script/redux/functions/operators.h"
 #include "redux/engines/script/redux/functions/typeof.h"
+#include "redux/engines/script/redux/script_arena.h"
 #include "redux/engines/script/redux/script_ast_builder.h"
 #include "redux/engines/script/redux/script_frame.h"
 #include "redux/engines/script/redux/script_parser.h"
@@ -264,6 +265,10 @@ ScriptValue ScriptEnv::GetValue(HashValue id) {
 }
 
 ScriptValue ScriptEnv::Eval(const ScriptValue& script) {
+  // Temporaries created while evaluating the script are allocated from the
+  // thread's ScriptArena. Values that are still bound to variables once the
+  // outermost evaluation completes are moved to the heap.
+  ScriptArena::Scope arena_scope;
   ScriptValue result;
   if (const AstNode* node = script.Get<AstNode>()) {
     const AstNode* child = node->first.Get<AstNode>();
@@ -277,6 +282,9 @@ ScriptValue ScriptEnv::Eval(const ScriptValue& script) {
   } else {
     result = script;
   }
+  if (arena_scope.IsOutermost()) {
+    stack_.PromoteArenaValues();
+  }
   return result;
 }
 
@@ -448,6 +456,7 @@ ScriptValue ScriptEnv::SetImpl(const ScriptValue& args, ValueType type) {
 }
 
 ScriptValue ScriptEnv::CallVarSpan(HashValue id, absl::Span<Var> args) {
+  ScriptArena::Scope arena_scope;
   ScriptValue script_args;
   for (size_t i = 0; i < args.size(); ++i) {
     ScriptValue first = ScriptValue(args[args.size() - i - 1]);
@@ -455,7 +464,11 @@ ScriptValue ScriptEnv::CallVarSpan(HashValue id, absl::Span<Var> args) {
     script_args = node;
   }
   ScriptValue callable = Symbol(id);
-  return CallInternal(callable, script_args);
+  ScriptValue result = CallInternal(callable, script_args);
+  if (arena_scope.IsOutermost()) {
+    stack_.PromoteArenaValues();
+  }
+  return result;
 }
 
 ScriptValue ScriptEnv::CallVarTable(HashValue id, const VarTable& kwargs) {
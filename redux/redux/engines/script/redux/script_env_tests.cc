@@ -54,6 +54,14 @@ TEST(ScriptEnvTest, SetGetValue) {
   REDUX_CHECK_SCRIPT_VALUE(res, 789);
 }
 
+TEST(ScriptEnvTest, PromotesEscapingValues) {
+  ScriptEnv env;
+  env.Exec("(= foo (+ 1 2))");
+  ScriptValue res = env.GetValue(ConstHash("foo"));
+  EXPECT_FALSE(res.IsInArena());
+  REDUX_CHECK_SCRIPT_VALUE(res, 3);
+}
+
 TEST(ScriptEnvTest, Eval) {
   ScriptEnv env;
   ScriptValue res = env.Exec("(eval 123)");
@@ -20,44 +20,51 @@ namespace redux {
 
 ScriptStack::ScriptStack() { PushScope(); }
 
+ScriptStack::Slot ScriptStack::Resolve(HashValue id) {
+  auto pair = lookup_.emplace(id, bindings_.size());
+  if (pair.second) {
+    bindings_.emplace_back();
+  }
+  return pair.first->second;
+}
+
 void ScriptStack::SetValue(HashValue id, ScriptValue value) {
-  auto pair = lookup_.emplace(id, IndexArray());
-  auto iter = pair.first;
+  SetValue(Resolve(id), std::move(value));
+}
 
-  IndexArray& array = iter->second;
-  const bool exists = !pair.second;
-  if (exists) {
+void ScriptStack::SetValue(Slot slot, ScriptValue value) {
+  const IndexArray& array = bindings_[slot];
+  if (array.count > 0) {
     const size_t index = array.index[array.count - 1];
     values_[index].value = std::move(value);
   } else {
-    CHECK(array.count < IndexArray::kMaxInstancesPerValue);
-
-    const size_t index = values_.size();
-    values_.emplace_back(std::move(value), &(*iter));
-
-    array.index[array.count] = index;
-    array.count++;
+    AddValue(slot, std::move(value));
   }
 }
 
 void ScriptStack::LetValue(HashValue id, ScriptValue value) {
-  auto iter = lookup_.emplace(id, IndexArray()).first;
+  LetValue(Resolve(id), std::move(value));
+}
 
-  IndexArray& array = iter->second;
+void ScriptStack::LetValue(Slot slot, ScriptValue value) {
+  const IndexArray& array = bindings_[slot];
   const bool exists_in_current_scope =
       array.count > 0 && array.index[array.count - 1] > scopes_.back();
   if (exists_in_current_scope) {
     const size_t index = array.index[array.count - 1];
     values_[index].value = std::move(value);
   } else {
-    CHECK(array.count < IndexArray::kMaxInstancesPerValue);
+    AddValue(slot, std::move(value));
+  }
+}
 
-    const size_t index = values_.size();
-    values_.emplace_back(std::move(value), &(*iter));
+void ScriptStack::AddValue(Slot slot, ScriptValue value) {
+  IndexArray& array = bindings_[slot];
+  CHECK(array.count < IndexArray::kMaxInstancesPerValue);
 
-    array.index[array.count] = index;
-    array.count++;
-  }
+  array.index[array.count] = values_.size();
+  array.count++;
+  values_.emplace_back(std::move(value), slot);
 }
 
 ScriptValue ScriptStack::GetValue(HashValue id) {
@@ -65,13 +72,15 @@ ScriptValue ScriptStack::GetValue(HashValue id) {
   if (iter == lookup_.end()) {
     return {};
   }
+  return GetValue(iter->second);
+}
 
-  const auto& entry = iter->second;
-  CHECK(entry.count != 0)
-      << "This entry should have been removed from the lookup table.";
-
-  const size_t index = entry.index[entry.count - 1];
-  return values_[index].value;
+ScriptValue ScriptStack::GetValue(Slot slot) {
+  const IndexArray& array = bindings_[slot];
+  if (array.count == 0) {
+    return {};
+  }
+  return values_[array.index[array.count - 1]].value;
 }
 
 void ScriptStack::PushScope() { scopes_.emplace_back(values_.size()); }
@@ -79,16 +88,27 @@ void ScriptStack::PushScope() { scopes_.emplace_back(values_.size()); }
 void ScriptStack::PopScope() {
   const size_t size = scopes_.back();
   while (values_.size() > size) {
-    auto* lookup = values_.back().lookup_entry;
-
-    IndexArray& array = lookup->second;
-    --array.count;
-    if (array.count == 0) {
-      lookup_.erase(lookup->first);
-    }
+    --bindings_[values_.back().slot].count;
     values_.pop_back();
   }
   scopes_.pop_back();
 }
 
+void ScriptStack::PromoteArenaValues() {
+  absl::flat_hash_map<const Var*, ScriptValue> promoted;
+  for (ValueEntry& entry : values_) {
+    if (!entry.value.IsInArena()) {
+      continue;
+    }
+    auto iter = promoted.find(entry.value.Get<Var>());
+    if (iter == promoted.end()) {
+      const Var* var = entry.value.Get<Var>();
+      entry.value.PromoteToHeap();
+      promoted.emplace(var, entry.value);
+    } else {
+      entry.value = iter->second;
+    }
+  }
+}
+
 }  // namespace redux
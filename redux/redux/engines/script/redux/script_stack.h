@@ -35,6 +35,11 @@ namespace redux {
 // scopes to both declare a variable with the same name.
 class ScriptStack {
  public:
+  // A handle to all the bindings of a symbol. Resolving a symbol to a Slot once
+  // allows its value to be accessed without hashing it again. Slots remain
+  // valid for the lifetime of the stack.
+  using Slot = size_t;
+
   ScriptStack();
 
   ScriptStack(const ScriptStack& rhs) = delete;
@@ -43,13 +48,19 @@ class ScriptStack {
   // Sets a value associated with the symbol. If there is no binding for the
   // symbol, a new binding will be introduce in the current scope.
   void SetValue(HashValue id, ScriptValue value);
+  void SetValue(Slot slot, ScriptValue value);
 
   // Like SetValue, but introduces a new binding if the symbol doesn't exist
   // in the current scope (even if it exists in a parent scope).
   void LetValue(HashValue id, ScriptValue value);
+  void LetValue(Slot slot, ScriptValue value);
 
   // Gets a value associated with the symbol,
   ScriptValue GetValue(HashValue id);
+  ScriptValue GetValue(Slot slot);
+
+  // Returns the Slot for the symbol, creating it if necessary.
+  Slot Resolve(HashValue id);
 
   // Indicates the start of a new scope. Any values set at this scope will not
   // replace values in a prior scope, even if they have the same key.
@@ -59,11 +70,19 @@ class ScriptStack {
   // removed.
   void PopScope();
 
+  // Moves all bound values that live in the calling thread's ScriptArena to the
+  // heap. Values that were shared between bindings remain shared.
+  void PromoteArenaValues();
+
  private:
-  // There are two main data structures that are used to store data. The actual
-  // Vars are stored in a std::vector which allows for an efficient mechanism
-  // for popping the scope. A flat_hash_map is used to as a lookup table for
-  // efficiently locating all the Vars (in all scopes) associated with a symbol.
+  // There are three main data structures that are used to store data. The
+  // actual Vars are stored in a std::vector which allows for an efficient
+  // mechanism for popping the scope. Each symbol that has ever been bound is
+  // given a Slot in a second std::vector which tracks all the Vars (in all
+  // scopes) associated with the symbol. A flat_hash_map is used to as a lookup
+  // table for efficiently locating the Slot of a symbol. Slots are never
+  // removed, so pushing and popping scopes (eg. for function calls) does not
+  // insert into or erase from the lookup table.
 
   // Stores the indices of all Vars associated with the same symbol.
   struct IndexArray {
@@ -75,23 +94,27 @@ class ScriptStack {
     size_t count = 0;
   };
 
-  using LookupTable = absl::flat_hash_map<HashValue, IndexArray>;
+  using LookupTable = absl::flat_hash_map<HashValue, Slot>;
 
   // Stores the actual Var associated with a symbol at a specific scope,
-  // as well the symbol's corresponding IndexArray in the lookup table.
+  // as well the symbol's corresponding Slot.
   struct ValueEntry {
-    ValueEntry(ScriptValue value, LookupTable::value_type* lookup)
-        : value(std::move(value)), lookup_entry(lookup) {}
+    ValueEntry(ScriptValue value, Slot slot)
+        : value(std::move(value)), slot(slot) {}
 
     // The actual Var associated with a symbol.
     ScriptValue value;
-    // A pointer to the data in the LookupTable associated with the symbol.
-    LookupTable::value_type* lookup_entry;
+    // The Slot of the symbol, ie. an index into the bindings_ vector.
+    Slot slot;
   };
 
+  void AddValue(Slot slot, ScriptValue value);
+
   // Storage for all the Vars stored in the table for all scopes.
   std::vector<ValueEntry> values_;
-  // Lookup table for finding the Vars associated with a given symbol.
+  // The indices into values_ of the bindings of each Slot.
+  std::vector<IndexArray> bindings_;
+  // Lookup table for finding the Slot associated with a given symbol.
   LookupTable lookup_;
   // An index into the values_ table that represents the starting index of a
   // given scope.
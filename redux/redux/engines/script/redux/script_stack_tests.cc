@@ -102,5 +102,35 @@ TEST(ScriptStackTest, PushPop) {
   EXPECT_THAT(*value.Get<int>(), Eq(456));
 }
 
+TEST(ScriptStackTest, Slots) {
+  ScriptStack table;
+  const HashValue key1 = ConstHash("123");
+  const HashValue key2 = ConstHash("456");
+
+  const ScriptStack::Slot slot1 = table.Resolve(key1);
+  const ScriptStack::Slot slot2 = table.Resolve(key2);
+  EXPECT_THAT(table.Resolve(key1), Eq(slot1));
+  EXPECT_TRUE(slot1 != slot2);
+  EXPECT_TRUE(!table.GetValue(slot1));
+
+  table.SetValue(slot1, 123);
+  EXPECT_THAT(*table.GetValue(key1).Get<int>(), Eq(123));
+
+  table.PushScope();
+  table.LetValue(slot1, 456);
+  table.SetValue(key2, 789);
+  EXPECT_THAT(*table.GetValue(slot1).Get<int>(), Eq(456));
+  EXPECT_THAT(*table.GetValue(slot2).Get<int>(), Eq(789));
+  table.PopScope();
+
+  // Slots remain valid after all of their bindings have been popped.
+  EXPECT_THAT(*table.GetValue(slot1).Get<int>(), Eq(123));
+  EXPECT_TRUE(!table.GetValue(slot2));
+  EXPECT_TRUE(!table.GetValue(key2));
+
+  table.SetValue(slot2, 1.f);
+  EXPECT_THAT(*table.GetValue(key2).Get<float>(), Eq(1.f));
+}
+
 }  // namespace
 }  // namespace redux
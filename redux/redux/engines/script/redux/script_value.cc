@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "redux/engines/script/redux/script_value.h"
 
+#include "redux/engines/script/redux/script_arena.h"
+
 namespace redux {
 
 TypeId ScriptValue::GetTypeId() const {
@@ -28,4 +30,21 @@ bool ScriptValue::IsNil() const {
 
 ScriptValue::operator bool() const { return !IsNil(); }
 
+bool ScriptValue::IsInArena() const {
+  return var_ptr_ ? ScriptArena::Contains(var_ptr_.get()) : false;
+}
+
+void ScriptValue::PromoteToHeap() {
+  if (IsInArena()) {
+    var_ptr_ = std::make_shared<Var>(*var_ptr_);
+  }
+}
+
+std::shared_ptr<Var> ScriptValue::AllocateVar() {
+  if (ScriptArena::IsActive()) {
+    return ScriptArena::MakeVar();
+  }
+  return std::make_shared<Var>();
+}
+
 }  // namespace redux
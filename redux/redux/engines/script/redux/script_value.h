@@ -53,7 +53,19 @@ class ScriptValue {
 
   explicit operator bool() const;
 
+  // Returns true if the value is stored in the calling thread's ScriptArena.
+  bool IsInArena() const;
+
+  // Moves the value out of the ScriptArena and into its own heap allocation so
+  // that it can outlive the evaluation that created it without pinning arena
+  // memory. Other ScriptValues sharing the old storage are unaffected.
+  void PromoteToHeap();
+
  private:
+  // Allocates storage for a new value, using the calling thread's ScriptArena
+  // if one is active.
+  static std::shared_ptr<Var> AllocateVar();
+
   std::shared_ptr<Var> var_ptr_;
 };
 
@@ -67,7 +79,7 @@ void ScriptValue::Set(T&& value) {
   if constexpr (std::is_same_v<typename std::decay<T>::type, ScriptValue>) {
     var_ptr_ = value.var_ptr_;
   } else {
-    var_ptr_ = std::make_shared<Var>();
+    var_ptr_ = AllocateVar();
     const bool ok = ToVar(value, var_ptr_.get());
     CHECK(ok);
   }
@@ -16,19 +16,31 @@ limitations under the License.
 
 #include "redux/engines/text/font.h"
 
+#include <algorithm>
+#include <chrono>
 #include <utility>
+#include <vector>
+
+#include "redux/modules/base/logging.h"
 
 namespace redux {
 
-Font::Font(HashValue name, DataContainer data)
-    : name_(name), data_(std::move(data)) {
+Font::Font(HashValue name, DataContainer data, const vec2i& page_size,
+           size_t max_pages)
+    : name_(name),
+      data_(std::move(data)),
+      page_size_(page_size),
+      max_pages_(max_pages) {
+  CHECK_GT(max_pages_, 0);
   rasterizer_ = CreateGlyphRasterizer(data_);
   CHECK(rasterizer_);
   sequencer_ = CreateGlyphSequencer(data_, rasterizer_->GetUnitsPerEm());
   CHECK(sequencer_);
 
-  const vec2i initial_size(512, 512);
-  atlas_ = std::make_unique<ImageAtlaser>(ImageFormat::Alpha8, initial_size);
+  // Always have at least one page so that GetGlyphAtlas() is valid.
+  pages_.emplace_back();
+  pages_.back().atlas =
+      std::make_unique<ImageAtlaser>(ImageFormat::Alpha8, page_size_);
 }
 
 HashValue Font::GetName() const { return name_; }
@@ -37,7 +49,55 @@ float Font::GetAscender() const { return sequencer_->GetAscender(); }
 
 float Font::GetDescender() const { return sequencer_->GetDescender(); }
 
-const ImageAtlaser& Font::GetGlyphAtlas() const { return *atlas_; }
+size_t Font::GetNumGlyphPages() const { return pages_.size(); }
+
+const ImageAtlaser& Font::GetGlyphAtlas(size_t page) const {
+  CHECK_LT(page, pages_.size());
+  return *pages_[page].atlas;
+}
+
+uint32_t Font::GetGlyphPageGeneration(size_t page) const {
+  CHECK_LT(page, pages_.size());
+  return pages_[page].generation;
+}
+
+void Font::ClearGlyphPageDirtyRegion(size_t page) {
+  CHECK_LT(page, pages_.size());
+  pages_[page].atlas->ClearDirtyRegion();
+}
+
+void Font::SetSdfComputer(std::shared_ptr<SdfBatchComputer> sdf_computer,
+                          bool async) {
+  sdf_computer_ = std::move(sdf_computer);
+  async_sdf_ = async;
+}
+
+bool Font::HasPendingGlyphs() const { return !pending_.empty(); }
+
+size_t Font::ProcessPendingGlyphs() {
+  size_t count = 0;
+  for (auto iter = pending_.begin(); iter != pending_.end();) {
+    using std::chrono::seconds;
+    if (iter->images.wait_for(seconds(0)) != std::future_status::ready) {
+      ++iter;
+      continue;
+    }
+
+    const std::vector<ImageData> images = iter->images.get();
+    GlyphPage& page = pages_[iter->page];
+    // The page may have been evicted while the glyphs were being computed, in
+    // which case the space the glyphs were reserved in no longer exists.
+    if (page.generation == iter->generation) {
+      CHECK_EQ(images.size(), iter->ids.size());
+      for (size_t i = 0; i < images.size(); ++i) {
+        page.atlas->Update(HashValue(iter->ids[i]), images[i]);
+      }
+      count += images.size();
+    }
+    iter = pending_.erase(iter);
+  }
+  return count;
+}
 
 Bounds2f Font::GetGlyphBounds(TextGlyphId id) const {
   auto iter = glyphs_.find(id);
@@ -64,13 +124,15 @@ float Font::GetGlyphAdvance(TextGlyphId id) const {
   return iter != glyphs_.end() ? iter->second.advance : 0.f;
 }
 
-Bounds2f Font::GetGlyphUvBounds(TextGlyphId id) const {
-  const Bounds2f bounds = atlas_->GetUvBounds(HashValue(id));
-  const vec2 offset =
-      static_cast<float>(sdf_padding_) / vec2(atlas_->GetSize());
-  const vec2 pos = bounds.min + offset;
-  const vec2 size = bounds.Size() - (2.f * offset);
-  return Bounds2f(pos, pos + size);
+Bounds2f Font::GetGlyphUvBounds(size_t page, TextGlyphId id) const {
+  return GetGlyphMetrics(page, id).uv_bounds;
+}
+
+const GlyphMetrics& Font::GetGlyphMetrics(size_t page, TextGlyphId id) const {
+  static const GlyphMetrics kEmptyMetrics;
+  CHECK_LT(page, pages_.size());
+  const GlyphMetrics* metrics = pages_[page].metrics.Find(id);
+  return metrics ? *metrics : kEmptyMetrics;
 }
 
 GlyphSequence Font::GenerateGlyphSequence(std::string_view text,
@@ -78,29 +140,226 @@ GlyphSequence Font::GenerateGlyphSequence(std::string_view text,
                                           float font_size,
                                           TextDirection direction) {
   GlyphSequence sequence =
-      sequencer_->GetGlyphSequence(text, language_iso_639, direction);
+      ShapeGlyphSequence(text, language_iso_639, direction);
+  PrepareGlyphSequence(&sequence, font_size);
+  return sequence;
+}
+
+GlyphSequence Font::ShapeGlyphSequence(std::string_view text,
+                                       std::string_view language_iso_639,
+                                       TextDirection direction) const {
+  return sequencer_->GetGlyphSequence(text, language_iso_639, direction);
+}
+
+void Font::PrepareGlyphSequence(GlyphSequence* sequence, float font_size) {
+  CHECK(sequence);
+  std::vector<TextGlyphId> ids;
+  ids.reserve(sequence->elements.size());
+  for (const GlyphSequence::Element& element : sequence->elements) {
+    if (element.id != 0) {
+      ids.push_back(element.id);
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+  sequence->page = PrepareGlyphs(ids, font_size);
+}
+
+size_t Font::PrepareGlyphs(absl::Span<const TextGlyphId> ids,
+                           float font_size) {
+  ++use_counter_;
 
-  // Rasterize all the glyphs and store them in the glyph map/texture atlas.
-  for (size_t i = 0; i < sequence.elements.size(); ++i) {
-    const TextGlyphId id = sequence.elements[i].id;
-    if (id == 0 || glyphs_.contains(id)) {
-      // The glyph has already been rasterized into the atlas.
+  // Prefer the page that already has the most glyphs, breaking ties in favour
+  // of the most recently used page.
+  size_t best_page = 0;
+  size_t best_count = 0;
+  for (size_t i = 0; i < pages_.size(); ++i) {
+    const ImageAtlaser& atlas = *pages_[i].atlas;
+    size_t count = 0;
+    for (TextGlyphId id : ids) {
+      if (atlas.Contains(HashValue(id))) {
+        ++count;
+      }
+    }
+    if (count > best_count ||
+        (count == best_count &&
+         pages_[i].last_used > pages_[best_page].last_used)) {
+      best_page = i;
+      best_count = count;
+    }
+  }
+
+  if (AddGlyphsToPage(best_page, ids, font_size)) {
+    pages_[best_page].last_used = use_counter_;
+    return best_page;
+  }
+
+  // The glyphs don't fit on any existing page, so start a new page if allowed
+  // or evict the least-recently used one.
+  size_t page = pages_.size();
+  if (pages_.size() < max_pages_) {
+    pages_.emplace_back();
+    pages_.back().atlas =
+        std::make_unique<ImageAtlaser>(ImageFormat::Alpha8, page_size_);
+  } else {
+    page = 0;
+    for (size_t i = 1; i < pages_.size(); ++i) {
+      if (pages_[i].last_used < pages_[page].last_used) {
+        page = i;
+      }
+    }
+    pages_[page].atlas->Clear();
+    pages_[page].metrics.Clear();
+    ++pages_[page].generation;
+  }
+
+  pages_[page].last_used = use_counter_;
+  if (!AddGlyphsToPage(page, ids, font_size)) {
+    LOG(ERROR) << "Unable to fit " << ids.size()
+               << " glyphs into a single glyph page.";
+  }
+  return page;
+}
+
+void Font::UpdateGlyphMetrics(size_t page, TextGlyphId id) {
+  const ImageAtlaser& atlas = *pages_[page].atlas;
+  const GlyphData& gd = glyphs_[id];
+  const Bounds2f uv_bounds = atlas.GetUvBounds(HashValue(id));
+  const vec2 uv_offset =
+      static_cast<float>(sdf_padding_) / vec2(atlas.GetSize());
+
+  GlyphMetrics& gm = pages_[page].metrics.Insert(id);
+  gm.bounds = Bounds2f(vec2(gd.bounds.min), vec2(gd.bounds.max));
+  gm.sub_bounds =
+      Bounds2f(vec2(gd.bitmap_bounds.min), vec2(gd.bitmap_bounds.max));
+  gm.uv_bounds = Bounds2f(uv_bounds.min + uv_offset, uv_bounds.max - uv_offset);
+  gm.advance = gd.advance;
+}
+
+std::vector<Font::BakedGlyph> Font::GetBakedGlyphs(size_t page) const {
+  const ImageAtlaser& atlas = GetGlyphAtlas(page);
+  std::vector<BakedGlyph> glyphs;
+  for (const auto& iter : glyphs_) {
+    if (!atlas.Contains(HashValue(iter.first))) {
+      continue;
+    }
+    BakedGlyph& glyph = glyphs.emplace_back();
+    glyph.id = iter.first;
+    glyph.size = iter.second.bounds.max;
+    glyph.bitmap_bounds = iter.second.bitmap_bounds;
+    glyph.atlas_bounds = atlas.GetBounds(HashValue(iter.first));
+    glyph.advance = iter.second.advance;
+  }
+  std::sort(glyphs.begin(), glyphs.end(),
+            [](const BakedGlyph& lhs, const BakedGlyph& rhs) {
+              return lhs.id < rhs.id;
+            });
+  return glyphs;
+}
+
+bool Font::LoadBakedGlyphs(const ImageData& atlas,
+                           absl::Span<const BakedGlyph> glyphs) {
+  if (atlas.GetFormat() != ImageFormat::Alpha8 ||
+      atlas.GetSize() != page_size_) {
+    LOG(ERROR) << "Baked glyph atlas does not match the font's glyph pages.";
+    return false;
+  }
+
+  std::vector<ImageAtlaser::SubimageBounds> subimages;
+  subimages.reserve(glyphs.size());
+  for (const BakedGlyph& glyph : glyphs) {
+    GlyphData& gd = glyphs_[glyph.id];
+    gd.bounds = Bounds2i(vec2i::Zero(), glyph.size);
+    gd.bitmap_bounds = glyph.bitmap_bounds;
+    gd.advance = glyph.advance;
+    subimages.emplace_back(HashValue(glyph.id), glyph.atlas_bounds);
+  }
+
+  // Any text that was generated against the previous contents of the page is
+  // no longer valid.
+  GlyphPage& page = pages_[0];
+  if (page.atlas->GetNumSubimages() > 0) {
+    ++page.generation;
+  }
+  page.atlas->Load(atlas, subimages);
+  page.metrics.Clear();
+  for (const BakedGlyph& glyph : glyphs) {
+    UpdateGlyphMetrics(0, glyph.id);
+  }
+  return true;
+}
+
+bool Font::AddGlyphsToPage(size_t page, absl::Span<const TextGlyphId> ids,
+                           float font_size) {
+  ImageAtlaser* atlas = pages_[page].atlas.get();
+
+  // Rasterize the coverage of all the missing glyphs.
+  std::vector<std::pair<TextGlyphId, ImageData>> bitmaps;
+  for (TextGlyphId id : ids) {
+    if (atlas->Contains(HashValue(id))) {
       continue;
     }
 
     // TODO: Generating the glyph directly into the atlas would be faster.
-    const GlyphImage image =
-        rasterizer_->Rasterize(id, static_cast<int>(font_size), sdf_padding_);
-    const auto res = atlas_->Add(HashValue(id), image.bitmap);
-    CHECK(res != ImageAtlaser::kNoMoreSpace);
+    GlyphImage image = rasterizer_->Rasterize(id, static_cast<int>(font_size));
+    const vec2i sdf_size = image.bitmap.GetSize() + vec2i(2 * sdf_padding_);
 
     auto& gd = glyphs_[id];
     gd.bounds.min = vec2i::Zero();
     gd.bounds.max = image.size;
     gd.advance = image.advance;
     gd.bitmap_bounds.min = image.offset;
-    gd.bitmap_bounds.max = image.offset + image.bitmap.GetSize();
+    gd.bitmap_bounds.max = image.offset + sdf_size;
+    bitmaps.emplace_back(id, std::move(image.bitmap));
   }
-  return sequence;
+  if (bitmaps.empty()) {
+    return true;
+  }
+
+  // Reserve space for the glyphs from tallest to shortest, which allows the
+  // atlas to pack them more tightly.
+  std::stable_sort(bitmaps.begin(), bitmaps.end(),
+                   [](const auto& lhs, const auto& rhs) {
+                     return lhs.second.GetSize().y > rhs.second.GetSize().y;
+                   });
+
+  bool fits = true;
+  PendingGlyphs pending;
+  std::vector<ImageData> sources;
+  for (auto& iter : bitmaps) {
+    const vec2i sdf_size = iter.second.GetSize() + vec2i(2 * sdf_padding_);
+    if (atlas->Reserve(HashValue(iter.first), sdf_size) ==
+        ImageAtlaser::kNoMoreSpace) {
+      fits = false;
+      break;
+    }
+    UpdateGlyphMetrics(page, iter.first);
+    pending.ids.push_back(iter.first);
+    sources.push_back(std::move(iter.second));
+  }
+  if (sources.empty()) {
+    return fits;
+  }
+
+  // Compute the distance fields of all the reserved glyphs in one batch, even
+  // if not all of the glyphs fit, so that no reserved glyph is left blank.
+  if (sdf_computer_ == nullptr) {
+    sdf_computer_ = std::make_shared<SdfBatchComputer>();
+  }
+  if (async_sdf_) {
+    pending.page = page;
+    pending.generation = pages_[page].generation;
+    pending.images =
+        sdf_computer_->ComputeAsync(std::move(sources), sdf_padding_);
+    pending_.emplace_back(std::move(pending));
+  } else {
+    const std::vector<ImageData> images =
+        sdf_computer_->Compute(std::move(sources), sdf_padding_);
+    for (size_t i = 0; i < images.size(); ++i) {
+      atlas->Update(HashValue(pending.ids[i]), images[i]);
+    }
+  }
+  return fits;
 }
 }  // namespace redux
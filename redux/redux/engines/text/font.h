@@ -17,9 +17,16 @@ limitations under the License.
 #ifndef REDUX_ENGINES_TEXT_FONT_H_
 #define REDUX_ENGINES_TEXT_FONT_H_
 
+#include <cstdint>
+#include <future>
 #include <memory>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "redux/engines/text/internal/glyph.h"
+#include "redux/engines/text/internal/glyph_metrics_table.h"
+#include "redux/engines/text/internal/sdf_computer.h"
 #include "redux/engines/text/text_enums.h"
 #include "redux/modules/base/data_container.h"
 #include "redux/modules/graphics/image_atlaser.h"
@@ -28,37 +35,112 @@ namespace redux {
 
 // Rasterizes and stores the glyphs for a given Font object (e.g. a true-type
 // font binary loaded from disk).
+//
+// Glyphs are rasterized lazily (i.e. when they are first needed by a
+// GlyphSequence) into fixed-size atlas pages. All the glyphs of a single
+// GlyphSequence are placed on the same page so that the text can be rendered
+// with a single texture. Once the maximum number of pages is in use, the
+// least-recently used page is cleared and reused.
 class Font {
  public:
+  static constexpr int kDefaultGlyphPageSize = 512;
+  static constexpr size_t kDefaultMaxGlyphPages = 4;
+
   // Constructs the font of a given name using binary data (e.g. a ttf file).
-  Font(HashValue name, DataContainer data);
+  // Glyphs are stored in up to `max_pages` atlases of `page_size` pixels.
+  Font(HashValue name, DataContainer data,
+       const vec2i& page_size = vec2i(kDefaultGlyphPageSize),
+       size_t max_pages = kDefaultMaxGlyphPages);
 
   // Returns the name of the font.
   HashValue GetName() const;
 
-  // Returns the image atlas containing all the glyphs.
-  const ImageAtlaser& GetGlyphAtlas() const;
+  // Returns the number of glyph atlas pages currently in use.
+  size_t GetNumGlyphPages() const;
+
+  // Returns the image atlas containing the glyphs of the given page.
+  const ImageAtlaser& GetGlyphAtlas(size_t page = 0) const;
+
+  // Returns the number of times the given page has been evicted. Any text that
+  // was generated against a previous generation of the page must be generated
+  // again.
+  uint32_t GetGlyphPageGeneration(size_t page) const;
+
+  // Resets the dirty region of the given page once it has been uploaded.
+  void ClearGlyphPageDirtyRegion(size_t page);
+
+  // Sets the computer used to generate the signed distance fields of newly
+  // rasterized glyphs. If `async` is true, GenerateGlyphSequence returns before
+  // the distance fields are ready; the glyphs are reserved (blank) in the atlas
+  // and filled in by a later call to ProcessPendingGlyphs.
+  void SetSdfComputer(std::shared_ptr<SdfBatchComputer> sdf_computer,
+                      bool async);
+
+  // Writes the signed distance fields that have finished computing into the
+  // atlas. Returns the number of glyphs that were written.
+  size_t ProcessPendingGlyphs();
+
+  // Returns true if any signed distance fields are still being computed.
+  bool HasPendingGlyphs() const;
 
   // Returns information about a specific glyph. If the specified glyph hasn't
   // been rasterized, will return zero-sized values.
   Bounds2f GetGlyphBounds(TextGlyphId id) const;
   Bounds2f GetGlyphSubBounds(TextGlyphId id) const;
-  Bounds2f GetGlyphUvBounds(TextGlyphId id) const;
+  Bounds2f GetGlyphUvBounds(size_t page, TextGlyphId id) const;
   float GetGlyphAdvance(TextGlyphId id) const;
 
+  // Returns all the information about a glyph on the given page with a single
+  // lookup. If the glyph isn't on the page, all the returned values are zero.
+  const GlyphMetrics& GetGlyphMetrics(size_t page, TextGlyphId id) const;
+
   // Returns information about the font.
   float GetAscender() const;
   float GetDescender() const;
 
   // Generates the sequence of Glyphs that represents the given `text`. This
   // function will also update the font's internal glyph map/texture atlas that
-  // stores the rasterized images for each glyph.
+  // stores the rasterized images for each glyph. The returned sequence
+  // identifies the atlas page on which all of its glyphs can be found.
   //
   // This function can be slow when generating new glyphs, so use with caution.
   GlyphSequence GenerateGlyphSequence(std::string_view text,
                                       std::string_view language_iso_639,
                                       float font_size, TextDirection direction);
 
+  // Performs only the shaping step of GenerateGlyphSequence. The returned
+  // sequence does not reference any atlas page until it is passed to
+  // PrepareGlyphSequence. Shaping does not depend on the font size, so the
+  // result can be cached and reused across layouts.
+  GlyphSequence ShapeGlyphSequence(std::string_view text,
+                                   std::string_view language_iso_639,
+                                   TextDirection direction) const;
+
+  // Ensures all the glyphs of a (shaped) `sequence` are rasterized onto a
+  // single atlas page and updates the sequence's page accordingly.
+  void PrepareGlyphSequence(GlyphSequence* sequence, float font_size);
+
+  // A glyph that has been rasterized ahead of time (eg. by the font_pipeline
+  // tool) into a glyph atlas.
+  struct BakedGlyph {
+    TextGlyphId id = 0;
+    vec2i size = vec2i::Zero();
+    Bounds2i bitmap_bounds = {vec2i::Zero(), vec2i::Zero()};
+    // The area of the atlas containing the glyph's distance field.
+    Bounds2i atlas_bounds = {vec2i::Zero(), vec2i::Zero()};
+    float advance = 0.f;
+  };
+
+  // Returns all the glyphs on the given page, ordered by id.
+  std::vector<BakedGlyph> GetBakedGlyphs(size_t page = 0) const;
+
+  // Replaces the contents of the first glyph page with a pre-rasterized
+  // `atlas` containing the `glyphs`. Glyphs that are not in the atlas are still
+  // rasterized when they are first needed. Returns false if the atlas does not
+  // have the same format and size as the font's glyph pages.
+  bool LoadBakedGlyphs(const ImageData& atlas,
+                       absl::Span<const BakedGlyph> glyphs);
+
  private:
   struct GlyphData {
     Bounds2i bounds = {vec2i::Zero(), vec2i::Zero()};
@@ -66,12 +148,47 @@ class Font {
     float advance = 0.f;
   };
 
+  struct GlyphPage {
+    std::unique_ptr<ImageAtlaser> atlas;
+    GlyphMetricsTable metrics;
+    uint64_t last_used = 0;
+    uint32_t generation = 0;
+  };
+
+  // Ensures all the `ids` are on a single page and returns the index of that
+  // page.
+  size_t PrepareGlyphs(absl::Span<const TextGlyphId> ids, float font_size);
+
+  // Rasterizes the `ids` that are not yet in the `page`. Returns false if the
+  // page ran out of space.
+  bool AddGlyphsToPage(size_t page, absl::Span<const TextGlyphId> ids,
+                       float font_size);
+
+  // Updates the metrics table of the page with the glyph's data and its
+  // location in the page's atlas.
+  void UpdateGlyphMetrics(size_t page, TextGlyphId id);
+
+  // Glyphs that have been reserved in a page whose distance fields are still
+  // being computed.
+  struct PendingGlyphs {
+    size_t page = 0;
+    uint32_t generation = 0;
+    std::vector<TextGlyphId> ids;
+    std::future<std::vector<ImageData>> images;
+  };
+
   HashValue name_;
   DataContainer data_;
   std::unique_ptr<GlyphRasterizer> rasterizer_;
   std::unique_ptr<GlyphSequencer> sequencer_;
-  std::unique_ptr<ImageAtlaser> atlas_;
+  std::vector<GlyphPage> pages_;
+  std::vector<PendingGlyphs> pending_;
+  std::shared_ptr<SdfBatchComputer> sdf_computer_;
+  bool async_sdf_ = false;
   absl::flat_hash_map<TextGlyphId, GlyphData> glyphs_;
+  vec2i page_size_ = vec2i::Zero();
+  size_t max_pages_ = 0;
+  uint64_t use_counter_ = 0;
   int sdf_padding_ = 4;
 };
 
@@ -0,0 +1,242 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/text/font.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/base/data_builder.h"
+
+namespace redux {
+
+// The size of a glyph in the atlas, including its signed distance field
+// padding.
+static constexpr int kGlyphSize = 10;
+static constexpr int kSdfPadding = 4;
+static int num_rasterized_glyphs = 0;
+
+// Rasterizes every glyph into an image of the same size.
+struct FakeGlyphRasterizer : GlyphRasterizer {
+  int GetUnitsPerEm() const override { return 1; }
+
+  GlyphImage Rasterize(TextGlyphId id, unsigned int size_in_pixels) override {
+    ++num_rasterized_glyphs;
+    const int size = kGlyphSize - (2 * kSdfPadding);
+    DataBuilder data(size * size);
+    data.Advance(size * size);
+
+    GlyphImage image;
+    image.size = vec2i(kGlyphSize, kGlyphSize);
+    image.bitmap =
+        ImageData(ImageFormat::Alpha8, vec2i(size, size), data.Release());
+    image.advance = static_cast<float>(kGlyphSize);
+    return image;
+  }
+};
+
+// Uses each character in the string as its glyph id.
+struct FakeGlyphSequencer : GlyphSequencer {
+  float GetAscender() const override { return 0.f; }
+  float GetDescender() const override { return 0.f; }
+
+  GlyphSequence GetGlyphSequence(std::string_view text,
+                                 std::string_view language_iso_639,
+                                 TextDirection direction) override {
+    GlyphSequence sequence;
+    for (size_t i = 0; i < text.size(); ++i) {
+      GlyphSequence::Element element;
+      element.id = static_cast<TextGlyphId>(text[i]);
+      element.character_index = static_cast<int>(i);
+      sequence.elements.push_back(element);
+    }
+    return sequence;
+  }
+};
+
+std::unique_ptr<GlyphRasterizer> CreateGlyphRasterizer(
+    const DataContainer& data) {
+  return std::make_unique<FakeGlyphRasterizer>();
+}
+
+std::unique_ptr<GlyphSequencer> CreateGlyphSequencer(const DataContainer& data,
+                                                     int units_per_em) {
+  return std::make_unique<FakeGlyphSequencer>();
+}
+
+namespace {
+
+using ::testing::Eq;
+
+// Each page can hold 3x3 glyphs.
+const vec2i kPageSize(3 * kGlyphSize, 3 * kGlyphSize);
+
+GlyphSequence Generate(Font* font, std::string_view text) {
+  return font->GenerateGlyphSequence(text, "", 48.f,
+                                     TextDirection::kLanguageDefault);
+}
+
+class FontTest : public ::testing::Test {
+ protected:
+  void SetUp() override { num_rasterized_glyphs = 0; }
+};
+
+TEST_F(FontTest, RasterizesGlyphsLazily) {
+  Font font(HashValue(1), DataContainer(), kPageSize, 2);
+  EXPECT_THAT(font.GetGlyphAtlas().GetNumSubimages(), Eq(0));
+
+  const GlyphSequence sequence = Generate(&font, "abca");
+  EXPECT_THAT(sequence.page, Eq(0));
+  EXPECT_THAT(num_rasterized_glyphs, Eq(3));
+  EXPECT_THAT(font.GetGlyphAtlas().GetNumSubimages(), Eq(3));
+  EXPECT_THAT(font.GetGlyphAdvance('a'), Eq(kGlyphSize));
+
+  Generate(&font, "cab");
+  EXPECT_THAT(num_rasterized_glyphs, Eq(3));
+}
+
+TEST_F(FontTest, StoresGlyphMetricsPerPage) {
+  Font font(HashValue(1), DataContainer(), kPageSize, 2);
+  EXPECT_THAT(Generate(&font, "abcdefgh").page, Eq(0));
+  EXPECT_THAT(Generate(&font, "ija").page, Eq(1));
+
+  const GlyphMetrics& metrics = font.GetGlyphMetrics(1, 'a');
+  EXPECT_THAT(metrics.advance, Eq(kGlyphSize));
+  EXPECT_THAT(metrics.bounds, Eq(font.GetGlyphBounds('a')));
+  EXPECT_THAT(metrics.sub_bounds, Eq(font.GetGlyphSubBounds('a')));
+  EXPECT_THAT(metrics.uv_bounds, Eq(font.GetGlyphUvBounds(1, 'a')));
+
+  // Glyphs that aren't on a page have empty metrics.
+  EXPECT_THAT(font.GetGlyphMetrics(0, 'j').advance, Eq(0.f));
+  EXPECT_THAT(font.GetGlyphMetrics(1, 'b').uv_bounds,
+              Eq(Bounds2f(vec2::Zero(), vec2::Zero())));
+}
+
+TEST_F(FontTest, LoadsBakedGlyphs) {
+  Font baker(HashValue(1), DataContainer(), kPageSize, 2);
+  Generate(&baker, "abc");
+  const std::vector<Font::BakedGlyph> glyphs = baker.GetBakedGlyphs();
+  EXPECT_THAT(glyphs.size(), Eq(3));
+  EXPECT_THAT(glyphs[0].id, Eq('a'));
+
+  num_rasterized_glyphs = 0;
+  Font font(HashValue(1), DataContainer(), kPageSize, 2);
+  EXPECT_TRUE(font.LoadBakedGlyphs(baker.GetGlyphAtlas().GetImageData(),
+                                   glyphs));
+  EXPECT_THAT(font.GetGlyphAtlas().GetNumSubimages(), Eq(3));
+  EXPECT_THAT(font.GetGlyphUvBounds(0, 'b'),
+              Eq(baker.GetGlyphUvBounds(0, 'b')));
+  EXPECT_THAT(font.GetGlyphAdvance('c'), Eq(kGlyphSize));
+
+  // Only the glyphs that weren't baked are rasterized.
+  EXPECT_THAT(Generate(&font, "abcd").page, Eq(0));
+  EXPECT_THAT(num_rasterized_glyphs, Eq(1));
+  EXPECT_THAT(font.GetGlyphAtlas().GetNumSubimages(), Eq(4));
+}
+
+TEST_F(FontTest, RejectsMismatchedBakedGlyphs) {
+  Font font(HashValue(1), DataContainer(), kPageSize, 2);
+  ImageAtlaser atlas(ImageFormat::Alpha8, kPageSize * 2);
+  EXPECT_FALSE(font.LoadBakedGlyphs(atlas.GetImageData(), {}));
+}
+
+TEST_F(FontTest, AddsPagesWhenFull) {
+  Font font(HashValue(1), DataContainer(), kPageSize, 2);
+
+  EXPECT_THAT(Generate(&font, "abcdefgh").page, Eq(0));
+  EXPECT_THAT(Generate(&font, "ijk").page, Eq(1));
+  EXPECT_THAT(font.GetNumGlyphPages(), Eq(2));
+
+  // All the glyphs of a sequence end up on the same page.
+  EXPECT_THAT(Generate(&font, "ija").page, Eq(1));
+  EXPECT_TRUE(font.GetGlyphAtlas(1).Contains(HashValue('a')));
+  EXPECT_THAT(Generate(&font, "abc").page, Eq(0));
+}
+
+TEST_F(FontTest, EvictsLeastRecentlyUsedPage) {
+  Font font(HashValue(1), DataContainer(), kPageSize, 2);
+
+  EXPECT_THAT(Generate(&font, "abcdefghi").page, Eq(0));
+  EXPECT_THAT(Generate(&font, "jklmnopqr").page, Eq(1));
+  EXPECT_THAT(Generate(&font, "abc").page, Eq(0));
+
+  EXPECT_THAT(Generate(&font, "stu").page, Eq(1));
+  EXPECT_THAT(font.GetGlyphPageGeneration(0), Eq(0));
+  EXPECT_THAT(font.GetGlyphPageGeneration(1), Eq(1));
+  EXPECT_THAT(font.GetGlyphAtlas(1).GetNumSubimages(), Eq(3));
+  EXPECT_FALSE(font.GetGlyphAtlas(1).Contains(HashValue('j')));
+  EXPECT_THAT(font.GetGlyphUvBounds(1, 'j'),
+              Eq(Bounds2f(vec2::Zero(), vec2::Zero())));
+
+  // Evicted glyphs are rasterized again on demand.
+  num_rasterized_glyphs = 0;
+  EXPECT_THAT(Generate(&font, "j").page, Eq(1));
+  EXPECT_THAT(num_rasterized_glyphs, Eq(1));
+}
+
+TEST_F(FontTest, TracksDirtyRegion) {
+  Font font(HashValue(1), DataContainer(), kPageSize, 2);
+  font.ClearGlyphPageDirtyRegion(0);
+  EXPECT_FALSE(font.GetGlyphAtlas(0).IsDirty());
+
+  Generate(&font, "a");
+  EXPECT_THAT(font.GetGlyphAtlas(0).GetDirtyRegion(),
+              Eq(Bounds2i(vec2i::Zero(), vec2i(kGlyphSize, kGlyphSize))));
+
+  font.ClearGlyphPageDirtyRegion(0);
+  Generate(&font, "a");
+  EXPECT_FALSE(font.GetGlyphAtlas(0).IsDirty());
+}
+
+TEST_F(FontTest, ComputesDistanceFieldsAsynchronously) {
+  Font font(HashValue(1), DataContainer(), kPageSize, 2);
+  font.SetSdfComputer(std::make_shared<SdfBatchComputer>(1), true);
+  font.ClearGlyphPageDirtyRegion(0);
+
+  Generate(&font, "ab");
+  EXPECT_TRUE(font.GetGlyphAtlas(0).Contains(HashValue('a')));
+  EXPECT_THAT(font.GetGlyphBounds('a'),
+              Eq(Bounds2f(vec2::Zero(), vec2(kGlyphSize, kGlyphSize))));
+  EXPECT_TRUE(font.HasPendingGlyphs());
+  EXPECT_FALSE(font.GetGlyphAtlas(0).IsDirty());
+
+  size_t count = 0;
+  while (font.HasPendingGlyphs()) {
+    count += font.ProcessPendingGlyphs();
+  }
+  EXPECT_THAT(count, Eq(2));
+  EXPECT_THAT(font.GetGlyphAtlas(0).GetDirtyRegion(),
+              Eq(Bounds2i(vec2i::Zero(), vec2i(2 * kGlyphSize, kGlyphSize))));
+}
+
+TEST_F(FontTest, DropsDistanceFieldsOfEvictedPages) {
+  Font font(HashValue(1), DataContainer(), kPageSize, 1);
+  font.SetSdfComputer(std::make_shared<SdfBatchComputer>(1), true);
+
+  Generate(&font, "abcdefghi");
+  Generate(&font, "j");
+  EXPECT_THAT(font.GetGlyphPageGeneration(0), Eq(1));
+  font.ClearGlyphPageDirtyRegion(0);
+
+  size_t count = 0;
+  while (font.HasPendingGlyphs()) {
+    count += font.ProcessPendingGlyphs();
+  }
+  EXPECT_THAT(count, Eq(1));
+  EXPECT_THAT(font.GetGlyphAtlas(0).GetNumSubimages(), Eq(1));
+}
+
+}  // namespace
+}  // namespace redux
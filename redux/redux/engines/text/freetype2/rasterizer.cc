@@ -17,8 +17,8 @@ limitations under the License.
 #include "freetype/freetype.h"
 #include "ft2build.h"
 #include "redux/engines/text/internal/glyph.h"
-#include "redux/engines/text/internal/sdf_computer.h"
 #include "redux/engines/text/text_engine.h"
+#include "redux/modules/base/data_builder.h"
 #include "redux/modules/graphics/enums.h"
 #include "redux/modules/graphics/image_data.h"
 
@@ -34,13 +34,11 @@ class FreeTypeGlyphRasterizer : public GlyphRasterizer {
     return 2048;  // TODO(b/72713908): Query this value from freetype.
   }
 
-  GlyphImage Rasterize(TextGlyphId id, uint32_t size_in_pixels,
-                       int sdf_padding) override;
+  GlyphImage Rasterize(TextGlyphId id, uint32_t size_in_pixels) override;
 
  private:
   FT_Library ft_lib_;
   FT_Face ft_face_;
-  SdfComputer sdf_computer_;
 };
 
 static float ToPixels(FT_Pos v26_6) {
@@ -60,8 +58,7 @@ FreeTypeGlyphRasterizer::~FreeTypeGlyphRasterizer() {
 }
 
 GlyphImage FreeTypeGlyphRasterizer::Rasterize(TextGlyphId id,
-                                              uint32_t size_in_pixels,
-                                              int sdf_padding) {
+                                              uint32_t size_in_pixels) {
   if (FT_IS_SCALABLE(ft_face_)) {
     FT_Set_Pixel_Sizes(ft_face_, size_in_pixels, size_in_pixels);
   } else {
@@ -91,11 +88,20 @@ GlyphImage FreeTypeGlyphRasterizer::Rasterize(TextGlyphId id,
   const int width = ft_glyph->bitmap.width;
   const int height = ft_glyph->bitmap.rows;
   const vec2i bitmap_size(width, height);
-  const std::byte* bitmap_pixels =
-      reinterpret_cast<const std::byte*>(ft_glyph->bitmap.buffer);
+
+  // The glyph slot is reused by freetype, so copy the bitmap out of it. The
+  // rows in the slot may also be padded (or even stored bottom-up).
+  const int pitch = ft_glyph->bitmap.pitch;
+  DataBuilder pixels(width * height);
+  for (int y = 0; y < height; ++y) {
+    const int row = pitch >= 0 ? y : (height - 1 - y);
+    const std::byte* src = reinterpret_cast<const std::byte*>(
+        ft_glyph->bitmap.buffer + (row * std::abs(pitch)));
+    pixels.Append(src, width);
+  }
 
   GlyphImage image;
-  image.bitmap = sdf_computer_.Compute(bitmap_pixels, bitmap_size, sdf_padding);
+  image.bitmap = ImageData(ImageFormat::Alpha8, bitmap_size, pixels.Release());
   image.size.x = ToPixels(ft_glyph->metrics.width);
   image.size.y = ToPixels(ft_glyph->metrics.height);
   image.advance = ToPixels(ft_glyph->advance.x);
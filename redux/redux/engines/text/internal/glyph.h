@@ -49,14 +49,21 @@ struct GlyphSequence {
 
   std::vector<Element> elements;
   std::vector<TextCharacterBreakType> breaks;
+
+  // The index of the font's glyph atlas page that contains all the glyphs.
+  size_t page = 0;
 };
 
 // Responsible for rasterizing a glyph into an image.
 struct GlyphRasterizer {
   virtual ~GlyphRasterizer() = default;
   virtual int GetUnitsPerEm() const = 0;
-  virtual GlyphImage Rasterize(TextGlyphId id, unsigned int size_in_pixels,
-                               int sdf_padding) = 0;
+
+  // Rasterizes the coverage of the glyph into an Alpha8 bitmap. The signed
+  // distance field is computed from this bitmap by the Font, which allows the
+  // (comparatively expensive) distance computations to be batched and moved
+  // off the calling thread.
+  virtual GlyphImage Rasterize(TextGlyphId id, unsigned int size_in_pixels) = 0;
 };
 
 // Responsible for arranging glyphs in the correct order for a given string.
@@ -0,0 +1,43 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/text/internal/glyph_metrics_table.h"
+
+namespace redux {
+
+GlyphMetricsTable::GlyphMetricsTable() : dense_(kNumDenseGlyphs) {}
+
+GlyphMetrics& GlyphMetricsTable::Insert(TextGlyphId id) {
+  if (id < kNumDenseGlyphs) {
+    if (!dense_present_.test(id)) {
+      dense_present_.set(id);
+      dense_[id] = GlyphMetrics();
+    }
+    return dense_[id];
+  }
+  return sparse_[id];
+}
+
+void GlyphMetricsTable::Clear() {
+  dense_present_.reset();
+  sparse_.clear();
+}
+
+size_t GlyphMetricsTable::Size() const {
+  return dense_present_.count() + sparse_.size();
+}
+
+}  // namespace redux
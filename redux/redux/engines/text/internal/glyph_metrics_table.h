@@ -0,0 +1,77 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_TEXT_INTERNAL_GLYPH_METRICS_TABLE_H_
+#define REDUX_ENGINES_TEXT_INTERNAL_GLYPH_METRICS_TABLE_H_
+
+#include <bitset>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "redux/engines/text/internal/glyph.h"
+#include "redux/modules/math/bounds.h"
+
+namespace redux {
+
+// Everything needed to lay out and render a single glyph on a glyph atlas page,
+// packed into a single cache line so that it can be read with one fetch.
+struct alignas(64) GlyphMetrics {
+  // The size of the glyph, starting at the origin.
+  Bounds2f bounds = {vec2::Zero(), vec2::Zero()};
+  // The area covered by the glyph's (padded) bitmap relative to its origin.
+  Bounds2f sub_bounds = {vec2::Zero(), vec2::Zero()};
+  // The uv-space area of the glyph within the atlas page, excluding padding.
+  Bounds2f uv_bounds = {vec2::Zero(), vec2::Zero()};
+  float advance = 0.f;
+};
+
+// Stores the GlyphMetrics of a set of glyphs. The lowest glyph ids (which, in
+// most fonts, cover the ASCII and Latin-1 characters) are stored in a directly
+// indexed array; all other glyphs are stored in a hash map.
+class GlyphMetricsTable {
+ public:
+  static constexpr TextGlyphId kNumDenseGlyphs = 256;
+
+  GlyphMetricsTable();
+
+  // Returns the metrics of the glyph, or nullptr if it has not been inserted.
+  const GlyphMetrics* Find(TextGlyphId id) const {
+    if (id < kNumDenseGlyphs) {
+      return dense_present_.test(id) ? &dense_[id] : nullptr;
+    }
+    auto iter = sparse_.find(id);
+    return iter != sparse_.end() ? &iter->second : nullptr;
+  }
+
+  // Returns the metrics of the glyph, inserting (zeroed) metrics if it has not
+  // been inserted. The returned reference is valid until the next Insert.
+  GlyphMetrics& Insert(TextGlyphId id);
+
+  // Removes all glyphs from the table.
+  void Clear();
+
+  // Returns the number of glyphs in the table.
+  size_t Size() const;
+
+ private:
+  std::vector<GlyphMetrics> dense_;
+  std::bitset<kNumDenseGlyphs> dense_present_;
+  absl::flat_hash_map<TextGlyphId, GlyphMetrics> sparse_;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_ENGINES_TEXT_INTERNAL_GLYPH_METRICS_TABLE_H_
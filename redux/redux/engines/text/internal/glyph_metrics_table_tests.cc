@@ -0,0 +1,67 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/text/internal/glyph_metrics_table.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::NotNull;
+
+TEST(GlyphMetricsTableTest, FitsInCacheLine) {
+  EXPECT_THAT(sizeof(GlyphMetrics), Eq(64));
+  EXPECT_THAT(alignof(GlyphMetrics), Eq(64));
+}
+
+TEST(GlyphMetricsTableTest, InsertAndFind) {
+  GlyphMetricsTable table;
+  const TextGlyphId dense_id = 65;
+  const TextGlyphId sparse_id = GlyphMetricsTable::kNumDenseGlyphs + 100;
+  EXPECT_THAT(table.Find(dense_id), IsNull());
+  EXPECT_THAT(table.Find(sparse_id), IsNull());
+
+  table.Insert(dense_id).advance = 1.f;
+  table.Insert(sparse_id).advance = 2.f;
+  EXPECT_THAT(table.Size(), Eq(2));
+
+  ASSERT_THAT(table.Find(dense_id), NotNull());
+  EXPECT_THAT(table.Find(dense_id)->advance, Eq(1.f));
+  ASSERT_THAT(table.Find(sparse_id), NotNull());
+  EXPECT_THAT(table.Find(sparse_id)->advance, Eq(2.f));
+  EXPECT_THAT(table.Find(dense_id + 1), IsNull());
+  EXPECT_THAT(table.Find(sparse_id + 1), IsNull());
+}
+
+TEST(GlyphMetricsTableTest, Clear) {
+  GlyphMetricsTable table;
+  table.Insert(1).advance = 1.f;
+  table.Insert(1000).advance = 2.f;
+  table.Clear();
+  EXPECT_THAT(table.Size(), Eq(0));
+  EXPECT_THAT(table.Find(1), IsNull());
+  EXPECT_THAT(table.Find(1000), IsNull());
+
+  // Re-inserting a glyph doesn't retain its old metrics.
+  EXPECT_THAT(table.Insert(1).advance, Eq(0.f));
+}
+
+}  // namespace
+}  // namespace redux
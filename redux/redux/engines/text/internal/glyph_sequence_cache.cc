@@ -0,0 +1,62 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/text/internal/glyph_sequence_cache.h"
+
+#include "redux/modules/base/logging.h"
+
+namespace redux {
+
+GlyphSequenceCache::GlyphSequenceCache(size_t capacity) : capacity_(capacity) {
+  CHECK_GT(capacity_, 0);
+}
+
+GlyphSequence* GlyphSequenceCache::Find(const Key& key) {
+  auto iter = map_.find(&key);
+  if (iter == map_.end()) {
+    return nullptr;
+  }
+  // Move the entry to the front of the list; the iterator remains valid.
+  entries_.splice(entries_.begin(), entries_, iter->second);
+  return &iter->second->second;
+}
+
+GlyphSequence* GlyphSequenceCache::Insert(Key key, GlyphSequence sequence) {
+  auto iter = map_.find(&key);
+  if (iter != map_.end()) {
+    entries_.splice(entries_.begin(), entries_, iter->second);
+    iter->second->second = std::move(sequence);
+    return &iter->second->second;
+  }
+
+  if (entries_.size() >= capacity_) {
+    map_.erase(&entries_.back().first);
+    entries_.pop_back();
+  }
+
+  entries_.emplace_front(std::move(key), std::move(sequence));
+  map_.emplace(&entries_.front().first, entries_.begin());
+  return &entries_.front().second;
+}
+
+void GlyphSequenceCache::Clear() {
+  map_.clear();
+  entries_.clear();
+}
+
+size_t GlyphSequenceCache::Size() const { return entries_.size(); }
+
+}  // namespace redux
@@ -0,0 +1,102 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_TEXT_INTERNAL_GLYPH_SEQUENCE_CACHE_H_
+#define REDUX_ENGINES_TEXT_INTERNAL_GLYPH_SEQUENCE_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "redux/engines/text/internal/glyph.h"
+#include "redux/engines/text/text_enums.h"
+#include "redux/modules/base/hash.h"
+
+namespace redux {
+
+// A bounded cache of shaped GlyphSequences (and their line breaks) so that
+// text which is laid out repeatedly (e.g. scrolling lists, or text whose
+// bounds/color change) doesn't need to be shaped again. The least recently
+// used sequence is evicted once the cache is full.
+class GlyphSequenceCache {
+ public:
+  // Everything that affects the shaping of a piece of text.
+  struct Key {
+    std::string text;
+    HashValue font;
+    float font_size = 0.f;
+    std::string language_iso_639;
+    TextDirection direction = TextDirection::kLanguageDefault;
+
+    bool operator==(const Key& rhs) const {
+      return font == rhs.font && font_size == rhs.font_size &&
+             direction == rhs.direction && text == rhs.text &&
+             language_iso_639 == rhs.language_iso_639;
+    }
+
+    template <typename H>
+    friend H AbslHashValue(H h, const Key& key) {
+      return H::combine(std::move(h), key.text, key.font, key.font_size,
+                        key.language_iso_639, key.direction);
+    }
+  };
+
+  explicit GlyphSequenceCache(size_t capacity);
+
+  GlyphSequenceCache(const GlyphSequenceCache&) = delete;
+  GlyphSequenceCache& operator=(const GlyphSequenceCache&) = delete;
+
+  // Returns the cached sequence for the `key` (marking it as the most recently
+  // used), or nullptr if there is none. The returned pointer is valid until the
+  // next call to Insert or Clear.
+  GlyphSequence* Find(const Key& key);
+
+  // Adds the sequence to the cache, evicting the least recently used sequence
+  // if the cache is full, and returns the cached sequence.
+  GlyphSequence* Insert(Key key, GlyphSequence sequence);
+
+  // Removes all sequences from the cache.
+  void Clear();
+
+  // Returns the number of sequences in the cache.
+  size_t Size() const;
+
+ private:
+  using Entry = std::pair<Key, GlyphSequence>;
+  using List = std::list<Entry>;
+
+  // Adapters to allow the map to refer to keys stored in the list.
+  struct KeyRefHash {
+    size_t operator()(const Key* key) const { return absl::Hash<Key>()(*key); }
+  };
+  struct KeyRefEq {
+    bool operator()(const Key* lhs, const Key* rhs) const {
+      return *lhs == *rhs;
+    }
+  };
+
+  size_t capacity_ = 0;
+  List entries_;  // Ordered from most to least recently used.
+  absl::flat_hash_map<const Key*, List::iterator, KeyRefHash, KeyRefEq> map_;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_ENGINES_TEXT_INTERNAL_GLYPH_SEQUENCE_CACHE_H_
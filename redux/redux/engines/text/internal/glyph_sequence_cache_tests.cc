@@ -0,0 +1,92 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/text/internal/glyph_sequence_cache.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::NotNull;
+
+GlyphSequenceCache::Key MakeKey(std::string text, float font_size = 48.f) {
+  GlyphSequenceCache::Key key;
+  key.text = std::move(text);
+  key.font = HashValue(1);
+  key.font_size = font_size;
+  return key;
+}
+
+GlyphSequence MakeSequence(TextGlyphId id) {
+  GlyphSequence sequence;
+  sequence.elements.resize(1);
+  sequence.elements[0].id = id;
+  return sequence;
+}
+
+TEST(GlyphSequenceCacheTest, FindInserted) {
+  GlyphSequenceCache cache(4);
+  EXPECT_THAT(cache.Find(MakeKey("hello")), IsNull());
+
+  cache.Insert(MakeKey("hello"), MakeSequence(1));
+  GlyphSequence* sequence = cache.Find(MakeKey("hello"));
+  ASSERT_THAT(sequence, NotNull());
+  EXPECT_THAT(sequence->elements[0].id, Eq(1));
+
+  // All parts of the key are significant.
+  EXPECT_THAT(cache.Find(MakeKey("hello", 24.f)), IsNull());
+  GlyphSequenceCache::Key key = MakeKey("hello");
+  key.language_iso_639 = "fr";
+  EXPECT_THAT(cache.Find(key), IsNull());
+  key = MakeKey("hello");
+  key.direction = TextDirection::kRightToLeft;
+  EXPECT_THAT(cache.Find(key), IsNull());
+  key = MakeKey("hello");
+  key.font = HashValue(2);
+  EXPECT_THAT(cache.Find(key), IsNull());
+}
+
+TEST(GlyphSequenceCacheTest, Replace) {
+  GlyphSequenceCache cache(4);
+  cache.Insert(MakeKey("hello"), MakeSequence(1));
+  cache.Insert(MakeKey("hello"), MakeSequence(2));
+  EXPECT_THAT(cache.Size(), Eq(1));
+  EXPECT_THAT(cache.Find(MakeKey("hello"))->elements[0].id, Eq(2));
+}
+
+TEST(GlyphSequenceCacheTest, EvictsLeastRecentlyUsed) {
+  GlyphSequenceCache cache(2);
+  cache.Insert(MakeKey("a"), MakeSequence(1));
+  cache.Insert(MakeKey("b"), MakeSequence(2));
+  EXPECT_THAT(cache.Find(MakeKey("a")), NotNull());
+
+  cache.Insert(MakeKey("c"), MakeSequence(3));
+  EXPECT_THAT(cache.Size(), Eq(2));
+  EXPECT_THAT(cache.Find(MakeKey("a")), NotNull());
+  EXPECT_THAT(cache.Find(MakeKey("b")), IsNull());
+  EXPECT_THAT(cache.Find(MakeKey("c")), NotNull());
+
+  cache.Clear();
+  EXPECT_THAT(cache.Size(), Eq(0));
+  EXPECT_THAT(cache.Find(MakeKey("a")), IsNull());
+}
+
+}  // namespace
+}  // namespace redux
@@ -16,13 +16,13 @@ limitations under the License.
 
 #include "redux/engines/text/internal/sdf_computer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "redux/modules/base/data_builder.h"
 #include "redux/modules/math/vector.h"
 
-// We can choose between two different implementations where the trade-off is
-// between speed and quality.
-#define REDUX_FAST_SDF_DISTANCE_CALCULATIONS 0
-
 namespace redux {
 
 // We do not want to do sdf calculations using simd.
@@ -104,10 +104,53 @@ static float ApproximateDistanceToEdge(float value, const SdfVec2f& gradient) {
   }
 }
 
+// Computes the squared distance transform of the 1D function `f` of length `n`
+// using the lower envelope of parabolas (Felzenszwalb & Huttenlocher). For each
+// index `q`, stores min((q - p)^2 + f(p)) in `d` and the minimizing `p` in
+// `nearest`. `v` and `z` are scratch buffers of size `n` and `n + 1`.
+static void DistanceTransform1D(const float* f, int n, float* d, int* nearest,
+                                int* v, float* z) {
+  constexpr float kInf = std::numeric_limits<float>::infinity();
+  int k = 0;
+  v[0] = 0;
+  z[0] = -kInf;
+  z[1] = kInf;
+  auto intersect = [f](int q, int p) {
+    const float fq = f[q] + static_cast<float>(q * q);
+    const float fp = f[p] + static_cast<float>(p * p);
+    return (fq - fp) / static_cast<float>(2 * (q - p));
+  };
+
+  for (int q = 1; q < n; ++q) {
+    float s = intersect(q, v[k]);
+    while (s <= z[k]) {
+      --k;
+      s = intersect(q, v[k]);
+    }
+    ++k;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = kInf;
+  }
+
+  k = 0;
+  for (int q = 0; q < n; ++q) {
+    while (z[k + 1] < static_cast<float>(q)) {
+      ++k;
+    }
+    const int p = v[k];
+    d[q] = static_cast<float>((q - p) * (q - p)) + f[p];
+    nearest[q] = p;
+  }
+}
+
 class SdfComputer::Impl {
  public:
-  ImageData Compute(const std::byte* bytes, const SdfVec2i& size, int padding) {
-    SetSource(bytes, size, padding);
+  explicit Impl(Method method) : method_(method) {}
+
+  ImageData Compute(const std::byte* bytes, const SdfVec2i& size, int padding,
+                    int stride) {
+    SetSource(bytes, size, padding, stride);
     InitializeGrids();
     ComputeGradients();
     ComputeDistances<true>(&inner_distances_);
@@ -118,10 +161,12 @@ class SdfComputer::Impl {
 
  private:
   void SetSource(const std::byte* bytes = nullptr,
-                 const SdfVec2i& size = SdfVec2i::Zero(), int padding = 0) {
+                 const SdfVec2i& size = SdfVec2i::Zero(), int padding = 0,
+                 int stride = 0) {
     src_image_ = bytes;
     src_size_ = size;
     src_padding_ = padding;
+    src_stride_ = stride;
   }
 
   void InitializeGrids() {
@@ -139,7 +184,7 @@ class SdfComputer::Impl {
     const int unpadded_y = pos.y - src_padding_;
     if (unpadded_x >= 0 && unpadded_y >= 0 && unpadded_x < src_size_.x &&
         unpadded_y < src_size_.y) {
-      const int index = unpadded_x + unpadded_y * src_size_.x;
+      const int index = unpadded_x + unpadded_y * src_stride_;
       value = static_cast<uint8_t>(src_image_[index]);
     }
 
@@ -255,60 +300,14 @@ class SdfComputer::Impl {
       }
     }
 
+    if (method_ == Method::kSeparable) {
+      ComputeSeparableDistances<Invert>(distances);
+      return;
+    }
+
     // Keep processing while distances are being modified.
     edge_distances_.Reset(distances->GetSize(), SdfVec2i::Zero());
     bool updated = false;
-
-#if REDUX_FAST_SDF_DISTANCE_CALCULATIONS
-
-    do {
-      updated = false;
-      // Propagate from top down, starting with the second row.
-      for (int y = 1; y < h; ++y) {
-        // Propagate distances to the right.
-        for (int x = 1; x < w; ++x) {
-          const SdfVec2i pos(x, y);
-          const float dist = distances->Get(pos);
-          if (dist > 0.0f) {
-            updated |= UpdateDistance<Invert>(distances, {x, y}, {0, -1}, dist);
-          }
-        }
-        // Propagate distances to the left (skip the rightmost pixel).
-        for (int x = w - 2; x >= 0; --x) {
-          const SdfVec2i pos(x, y);
-          const float dist = distances->Get(pos);
-          if (dist > 0.0f) {
-            updated |= UpdateDistance<Invert>(distances, {x, y}, {1, 0}, dist);
-          }
-        }
-      }
-    } while (updated);
-
-    do {
-      updated = false;
-      // Propagate from bottom up, starting with the second row from the bottom.
-      for (int y = h - 2; y >= 0; --y) {
-        // Propagate distances to the left.
-        for (int x = w - 1; x >= 0; --x) {
-          const SdfVec2i pos(x, y);
-          const float dist = distances->Get(pos);
-          if (dist > 0.0f) {
-            updated |= UpdateDistance<Invert>(distances, {x, y}, {0, 1}, dist);
-          }
-        }
-        // Propagate distances to the right (skip the leftmost pixel).
-        for (int x = 1; x < w; ++x) {
-          const SdfVec2i pos(x, y);
-          const float dist = distances->Get(pos);
-          if (dist > 0.0f) {
-            updated |= UpdateDistance<Invert>(distances, {x, y}, {-1, 0}, dist);
-          }
-        }
-      }
-    } while (updated);
-
-#else
-
     do {
       updated = false;
 
@@ -368,8 +367,94 @@ class SdfComputer::Impl {
         }
       }
     } while (updated);
+  }
 
-#endif
+  // Computes distances by finding the nearest "seed" pixel (ie. one with a
+  // non-zero source value) for every pixel and then approximating the distance
+  // to the edge within that seed pixel. The nearest seeds are found with two
+  // separable passes (columns then rows) over contiguous rows of memory that
+  // compilers are able to vectorize, rather than iterating until convergence.
+  template <bool Invert>
+  void ComputeSeparableDistances(Grid<float>* distances) {
+    const int w = distances->GetSize().x;
+    const int h = distances->GetSize().y;
+    const int num_pixels = w * h;
+
+    // Column pass: the vertical distance to the nearest seed in the same
+    // column. Processing whole rows at a time keeps the inner loops over
+    // contiguous memory.
+    constexpr int kNoSeed = std::numeric_limits<int>::max() / 4;
+    column_distances_.assign(num_pixels, kNoSeed);
+    for (int y = 0; y < h; ++y) {
+      int* row = column_distances_.data() + (y * w);
+      const int* prev = y > 0 ? row - w : nullptr;
+      for (int x = 0; x < w; ++x) {
+        if (GetSourceValue<Invert>({x, y}) > 0) {
+          row[x] = 0;
+        } else if (prev) {
+          row[x] = std::min(prev[x] + 1, kNoSeed);
+        }
+      }
+    }
+    for (int y = h - 2; y >= 0; --y) {
+      int* row = column_distances_.data() + (y * w);
+      const int* next = row + w;
+      for (int x = 0; x < w; ++x) {
+        row[x] = std::min(row[x], next[x] + 1);
+      }
+    }
+
+    // Row pass: the 2D squared distance to the nearest seed, using the column
+    // distances as the 1D function.
+    row_f_.resize(w);
+    row_d_.resize(w);
+    row_nearest_.resize(w);
+    row_v_.resize(w);
+    row_z_.resize(w + 1);
+    for (int y = 0; y < h; ++y) {
+      const int* column = column_distances_.data() + (y * w);
+      bool has_seed = false;
+      for (int x = 0; x < w; ++x) {
+        const float dy = static_cast<float>(column[x]);
+        row_f_[x] = column[x] >= kNoSeed ? kLargeDistance * kLargeDistance
+                                         : dy * dy;
+        has_seed |= column[x] < kNoSeed;
+      }
+      if (!has_seed) {
+        continue;
+      }
+
+      DistanceTransform1D(row_f_.data(), w, row_d_.data(), row_nearest_.data(),
+                          row_v_.data(), row_z_.data());
+
+      for (int x = 0; x < w; ++x) {
+        const int seed_x = row_nearest_[x];
+        const SdfVec2i pos(x, y);
+        if (seed_x == x && column[x] == 0) {
+          // This pixel is a seed, so keep its initial approximation.
+          continue;
+        }
+
+        // Find the seed within the nearest column. It is either above or below
+        // this row at the column distance.
+        const int dy = column_distances_[seed_x + y * w];
+        SdfVec2i seed(seed_x, y - dy);
+        if (seed.y < 0 || GetSourceValue<Invert>(seed) == 0) {
+          seed.y = y + dy;
+        }
+
+        const SdfVec2i offset = pos - seed;
+        const float length = std::sqrt(
+            static_cast<float>(offset.x * offset.x + offset.y * offset.y));
+        const float normalized_value =
+            static_cast<float>(GetSourceValue<Invert>(seed)) /
+            std::numeric_limits<uint8_t>::max();
+        const float dist =
+            length + ApproximateDistanceToEdge(normalized_value,
+                                               SdfVec2f(offset));
+        distances->Set(pos, std::min(distances->Get(pos), dist));
+      }
+    }
   }
 
   // Computes the distance from |pos| to an edge pixel based on the information
@@ -422,22 +507,112 @@ class SdfComputer::Impl {
     return true;
   }
 
+  Method method_ = Method::kPropagate;
   const std::byte* src_image_ = nullptr;
   SdfVec2i src_size_ = SdfVec2i::Zero();
   int src_padding_ = 0;
+  int src_stride_ = 0;
 
   Grid<SdfVec2f> gradients_;       // Local gradients in X and Y.
   Grid<SdfVec2i> edge_distances_;  // Pixel distances in X and Y to edges.
   Grid<float> inner_distances_;    // Final inner distance values.
   Grid<float> outer_distances_;    // Final outer distance values.
+
+  // Scratch buffers for the separable distance transform.
+  std::vector<int> column_distances_;
+  std::vector<float> row_f_;
+  std::vector<float> row_d_;
+  std::vector<int> row_nearest_;
+  std::vector<int> row_v_;
+  std::vector<float> row_z_;
 };
 
-SdfComputer::SdfComputer() : impl_(std::make_unique<Impl>()) {}
+SdfComputer::SdfComputer(Method method)
+    : impl_(std::make_unique<Impl>(method)) {}
 
 SdfComputer::~SdfComputer() = default;
 
 ImageData SdfComputer::Compute(const std::byte* bytes, const SdfVec2i& size,
                                int padding) {
-  return impl_->Compute(bytes, size, padding);
+  return impl_->Compute(bytes, size, padding, size.x);
+}
+
+ImageData SdfComputer::Compute(const ImageData& bitmap, int padding) {
+  CHECK(bitmap.GetFormat() == ImageFormat::Alpha8);
+  return impl_->Compute(bitmap.GetData(), bitmap.GetSize(), padding,
+                        static_cast<int>(bitmap.GetStride()));
+}
+
+struct SdfBatchComputer::Batch {
+  std::vector<ImageData> bitmaps;
+  std::vector<ImageData> images;
+  std::atomic<size_t> remaining_tasks = 0;
+  std::promise<std::vector<ImageData>> promise;
+  Method method = Method::kSeparable;
+  int padding = 0;
+};
+
+static size_t GetNumThreads(size_t num_threads) {
+  if (num_threads == 0) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+  return std::max<size_t>(num_threads, 1);
+}
+
+SdfBatchComputer::SdfBatchComputer(size_t num_threads, Method method)
+    : processor_(GetNumThreads(num_threads)),
+      num_threads_(GetNumThreads(num_threads)),
+      method_(method) {}
+
+std::vector<ImageData> SdfBatchComputer::Compute(
+    std::vector<ImageData> bitmaps, int padding) {
+  return ComputeAsync(std::move(bitmaps), padding).get();
+}
+
+std::future<std::vector<ImageData>> SdfBatchComputer::ComputeAsync(
+    std::vector<ImageData> bitmaps, int padding) {
+  auto batch = std::make_shared<Batch>();
+  batch->images.resize(bitmaps.size());
+  batch->bitmaps = std::move(bitmaps);
+  batch->method = method_;
+  batch->padding = padding;
+  auto future = batch->promise.get_future();
+
+  const size_t count = batch->bitmaps.size();
+  if (count == 0) {
+    batch->promise.set_value({});
+    return future;
+  }
+
+  // Split the batch into (at most) one contiguous range per worker thread.
+  const size_t num_tasks = std::min(num_threads_, count);
+  const size_t per_task = (count + num_tasks - 1) / num_tasks;
+  batch->remaining_tasks = (count + per_task - 1) / per_task;
+  for (size_t begin = 0; begin < count; begin += per_task) {
+    Task task;
+    task.batch = batch;
+    task.begin = begin;
+    task.end = std::min(begin + per_task, count);
+#ifdef REDUX_DISABLE_THREADS
+    ProcessTask(&task);
+#else
+    processor_.Execute(std::move(task), &SdfBatchComputer::ProcessTask);
+#endif
+  }
+  return future;
+}
+
+void SdfBatchComputer::ProcessTask(Task* task) {
+  Batch* batch = task->batch.get();
+  SdfComputer computer(batch->method);
+  for (size_t i = task->begin; i < task->end; ++i) {
+    batch->images[i] = computer.Compute(batch->bitmaps[i], batch->padding);
+    batch->bitmaps[i] = ImageData();
+  }
+
+  // The last task to finish delivers the results.
+  if (--batch->remaining_tasks == 0) {
+    batch->promise.set_value(std::move(batch->images));
+  }
 }
 }  // namespace redux
@@ -17,8 +17,11 @@ limitations under the License.
 #ifndef REDUX_ENGINES_TEXT_INTERNAL_SDF_COMPUTER_H_
 #define REDUX_ENGINES_TEXT_INTERNAL_SDF_COMPUTER_H_
 
+#include <future>
 #include <memory>
+#include <vector>
 
+#include "redux/modules/base/async_processor.h"
 #include "redux/modules/graphics/image_data.h"
 #include "redux/modules/math/vector.h"
 
@@ -27,7 +30,18 @@ namespace redux {
 // Computes an image containing signed distances for font rendering.
 class SdfComputer {
  public:
-  SdfComputer();
+  // The algorithms that can be used to compute the distances, where the
+  // trade-off is between speed and quality.
+  enum class Method {
+    // Iteratively propagates the distances to edge pixels until no distances
+    // change. Slowest, but the most accurate.
+    kPropagate,
+    // Finds the nearest edge pixel for every pixel using two separable passes
+    // of a distance transform. Much faster for large images.
+    kSeparable,
+  };
+
+  explicit SdfComputer(Method method = Method::kPropagate);
   ~SdfComputer();
 
   // Computes the signed distance field image for the given input grayscale
@@ -37,10 +51,54 @@ class SdfComputer {
   // positive.
   ImageData Compute(const std::byte* bytes, const vec2i& size, int padding);
 
+  // Similar to above, but takes the grayscale (ie. Alpha8) bitmap as an image,
+  // respecting its stride.
+  ImageData Compute(const ImageData& bitmap, int padding);
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
 };
+
+// Computes the signed distance fields of batches of bitmaps using a pool of
+// worker threads, eg. all the new glyphs needed by a paragraph of text.
+class SdfBatchComputer {
+ public:
+  using Method = SdfComputer::Method;
+
+  // Creates the worker threads. If `num_threads` is 0, one thread per hardware
+  // thread is created.
+  explicit SdfBatchComputer(size_t num_threads = 0,
+                            Method method = Method::kSeparable);
+
+  SdfBatchComputer(const SdfBatchComputer&) = delete;
+  SdfBatchComputer& operator=(const SdfBatchComputer&) = delete;
+
+  // Computes the signed distance fields of all the Alpha8 `bitmaps` (see
+  // SdfComputer::Compute), blocking until they are all done. The returned
+  // images are in the same order as the `bitmaps`.
+  std::vector<ImageData> Compute(std::vector<ImageData> bitmaps, int padding);
+
+  // Like Compute, but returns immediately. The images are delivered through
+  // the returned future once they are all done.
+  std::future<std::vector<ImageData>> ComputeAsync(
+      std::vector<ImageData> bitmaps, int padding);
+
+ private:
+  struct Batch;
+
+  struct Task {
+    std::shared_ptr<Batch> batch;
+    size_t begin = 0;
+    size_t end = 0;
+  };
+
+  static void ProcessTask(Task* task);
+
+  AsyncProcessor<Task> processor_;
+  size_t num_threads_ = 0;
+  Method method_ = Method::kSeparable;
+};
 }  // namespace redux
 
 #endif  // REDUX_ENGINES_TEXT_INTERNAL_SDF_COMPUTER_H_
@@ -0,0 +1,133 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/engines/text/internal/sdf_computer.h"
+
+#include <cmath>
+#include <cstdlib>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/base/data_builder.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Le;
+
+// Creates an anti-aliased disk of the given `radius` in an image of `size`
+// pixels where each row is `stride` bytes.
+ImageData MakeDisk(const vec2i& size, float radius, int stride = 0) {
+  if (stride == 0) {
+    stride = size.x;
+  }
+  DataBuilder data(stride * size.y);
+  std::byte* bytes = data.GetAppendPtr(stride * size.y);
+  const vec2 center = vec2(size) * 0.5f;
+  for (int y = 0; y < size.y; ++y) {
+    for (int x = 0; x < size.x; ++x) {
+      const vec2 d = vec2(x + 0.5f, y + 0.5f) - center;
+      const float dist = std::sqrt(d.x * d.x + d.y * d.y);
+      const float coverage = std::clamp(radius - dist + 0.5f, 0.f, 1.f);
+      bytes[x + y * stride] = static_cast<std::byte>(coverage * 255.f);
+    }
+  }
+  return ImageData(ImageFormat::Alpha8, size, data.Release(), stride);
+}
+
+// Returns the largest and the mean difference between the pixels of two images.
+int MaxDifference(const ImageData& lhs, const ImageData& rhs,
+                  float* mean_diff = nullptr) {
+  CHECK(lhs.GetSize() == rhs.GetSize());
+  int max_diff = 0;
+  int total_diff = 0;
+  for (size_t i = 0; i < lhs.GetNumBytes(); ++i) {
+    const int a = static_cast<int>(lhs.GetData()[i]);
+    const int b = static_cast<int>(rhs.GetData()[i]);
+    max_diff = std::max(max_diff, std::abs(a - b));
+    total_diff += std::abs(a - b);
+  }
+  if (mean_diff) {
+    *mean_diff = static_cast<float>(total_diff) / lhs.GetNumBytes();
+  }
+  return max_diff;
+}
+
+TEST(SdfComputerTest, SeparableMatchesPropagate) {
+  const ImageData disk = MakeDisk(vec2i(32, 32), 10.f);
+
+  SdfComputer propagate(SdfComputer::Method::kPropagate);
+  SdfComputer separable(SdfComputer::Method::kSeparable);
+  const ImageData expected = propagate.Compute(disk, 4);
+  const ImageData actual = separable.Compute(disk, 4);
+
+  // The distances may differ slightly near the edges, but stay within a pixel
+  // (ie. 16 levels).
+  float mean_diff = 0.f;
+  EXPECT_THAT(actual.GetSize(), Eq(vec2i(40, 40)));
+  EXPECT_THAT(MaxDifference(expected, actual, &mean_diff), Le(12));
+  EXPECT_THAT(mean_diff, Le(1.f));
+}
+
+TEST(SdfComputerTest, RespectsStride) {
+  const ImageData packed = MakeDisk(vec2i(20, 20), 6.f);
+  const ImageData strided = MakeDisk(vec2i(20, 20), 6.f, 32);
+
+  SdfComputer computer;
+  const ImageData expected =
+      computer.Compute(packed.GetData(), vec2i(20, 20), 2);
+  const ImageData actual = computer.Compute(strided, 2);
+  EXPECT_THAT(MaxDifference(expected, actual), Eq(0));
+}
+
+TEST(SdfBatchComputerTest, Compute) {
+  std::vector<ImageData> bitmaps;
+  for (int i = 0; i < 9; ++i) {
+    bitmaps.push_back(MakeDisk(vec2i(10 + i, 12), 4.f));
+  }
+
+  SdfComputer computer(SdfComputer::Method::kSeparable);
+  std::vector<ImageData> expected;
+  for (const ImageData& bitmap : bitmaps) {
+    expected.push_back(computer.Compute(bitmap, 3));
+  }
+
+  SdfBatchComputer batch(4, SdfComputer::Method::kSeparable);
+  const std::vector<ImageData> actual = batch.Compute(std::move(bitmaps), 3);
+  ASSERT_THAT(actual.size(), Eq(expected.size()));
+  for (size_t i = 0; i < actual.size(); ++i) {
+    EXPECT_THAT(MaxDifference(expected[i], actual[i]), Eq(0));
+  }
+}
+
+TEST(SdfBatchComputerTest, ComputeAsync) {
+  std::vector<ImageData> bitmaps;
+  bitmaps.push_back(MakeDisk(vec2i(8, 8), 3.f));
+  bitmaps.push_back(MakeDisk(vec2i(16, 16), 6.f));
+
+  SdfBatchComputer batch(2);
+  auto future = batch.ComputeAsync(std::move(bitmaps), 2);
+  const std::vector<ImageData> images = future.get();
+  ASSERT_THAT(images.size(), Eq(2));
+  EXPECT_THAT(images[0].GetSize(), Eq(vec2i(12, 12)));
+  EXPECT_THAT(images[1].GetSize(), Eq(vec2i(20, 20)));
+
+  EXPECT_TRUE(batch.Compute({}, 2).empty());
+}
+
+}  // namespace
+}  // namespace redux
@@ -33,9 +33,12 @@ TextLayout::TextLayout(const TextParams& params, float rasterization_size)
 MeshData TextLayout::GenerateMesh(std::string_view text,
                                   const GlyphSequence& sequence) {
   bounds_.reserve(sequence.elements.size());
+  metrics_.reserve(sequence.elements.size());
   for (size_t i = 0; i < sequence.elements.size(); ++i) {
-    const Bounds2f r = params_.font->GetGlyphBounds(sequence.elements[i].id);
-    bounds_.push_back(r);
+    const GlyphMetrics& metrics =
+        params_.font->GetGlyphMetrics(sequence.page, sequence.elements[i].id);
+    metrics_.push_back(&metrics);
+    bounds_.push_back(metrics.bounds);
   }
 
   StartNewLine();
@@ -152,7 +155,7 @@ void TextLayout::PlaceGlyphsOnCurrentLine(size_t start, size_t end,
 
   for (size_t i = start; i < end; ++i) {
     CHECK(i < bounds_.size());
-    const float x = params_.font->GetGlyphAdvance(sequence.elements[i].id);
+    const float x = metrics_[i]->advance;
 
     if (direction == TextDirection::kRightToLeft) {
       cursor_.x -= x;
@@ -240,8 +243,10 @@ void TextLayout::PlaceWrappedWord(size_t start, size_t end,
   return PlaceGlyphsOnCurrentLine(start, end, sequence);
 }
 
-static void AddVertex(DataBuilder* vertices, const vec2& pos, const vec2& uv) {
-  vertices->Append<float>({pos.x, pos.y, 0.f, 1.f, 1.f, 1.f, 1.f, uv.x, uv.y});
+static void AddVertex(DataBuilder* vertices, const vec2& pos, const vec4& color,
+                      const vec2& uv) {
+  vertices->Append<float>(
+      {pos.x, pos.y, 0.f, color.x, color.y, color.z, color.w, uv.x, uv.y});
 }
 
 MeshData TextLayout::BuildMesh(const GlyphSequence& sequence) const {
@@ -254,23 +259,23 @@ MeshData TextLayout::BuildMesh(const GlyphSequence& sequence) const {
   const size_t num_vertices = bounds_.size() * 6;
   DataBuilder vertices(num_vertices * format.GetVertexSize());
   const float scale = (params_.font_size / rasterization_size_);
+  const vec4& color = params_.color;
 
   Box bounds;
   for (size_t i = 0; i < sequence.elements.size(); ++i) {
-    const TextGlyphId id = sequence.elements[i].id;
-    const Bounds2f uvs = params_.font->GetGlyphUvBounds(id);
-    const vec2 pos =
-        (bounds_[i].min + params_.font->GetGlyphSubBounds(id).min) * scale;
+    const GlyphMetrics& metrics = *metrics_[i];
+    const Bounds2f& uvs = metrics.uv_bounds;
+    const vec2 pos = (bounds_[i].min + metrics.sub_bounds.min) * scale;
     const vec2 d = bounds_[i].Size() * scale;
     const float d_u = uvs.Size().x;
     const float d_v = uvs.Size().y;
 
-    AddVertex(&vertices, pos + vec2(0.f, 0.f), uvs.min + vec2(0.f, d_v));
-    AddVertex(&vertices, pos + vec2(0.f, d.y), uvs.min + vec2(0.f, 0.f));
-    AddVertex(&vertices, pos + vec2(d.x, 0.f), uvs.min + vec2(d_u, d_v));
-    AddVertex(&vertices, pos + vec2(d.x, 0.f), uvs.min + vec2(d_u, d_v));
-    AddVertex(&vertices, pos + vec2(0.f, d.y), uvs.min + vec2(0.f, 0.f));
-    AddVertex(&vertices, pos + vec2(d.x, d.y), uvs.min + vec2(d_u, 0.f));
+    AddVertex(&vertices, pos + vec2(0.f, 0.f), color, uvs.min + vec2(0.f, d_v));
+    AddVertex(&vertices, pos + vec2(0.f, d.y), color, uvs.min + vec2(0.f, 0.f));
+    AddVertex(&vertices, pos + vec2(d.x, 0.f), color, uvs.min + vec2(d_u, d_v));
+    AddVertex(&vertices, pos + vec2(d.x, 0.f), color, uvs.min + vec2(d_u, d_v));
+    AddVertex(&vertices, pos + vec2(0.f, d.y), color, uvs.min + vec2(0.f, 0.f));
+    AddVertex(&vertices, pos + vec2(d.x, d.y), color, uvs.min + vec2(d_u, 0.f));
 
     bounds.min = Min(bounds.min, vec3(pos.x, pos.y, 0.f));
     bounds.max = Min(bounds.max, vec3(pos.x + d.x, pos.y + d.y, 0.f));
@@ -55,6 +55,8 @@ class TextLayout {
   const TextParams& params_;
   std::vector<Line> lines_;
   std::vector<Bounds2f> bounds_;
+  // The metrics of each glyph in the sequence, fetched once per layout.
+  std::vector<const GlyphMetrics*> metrics_;
   Line* current_line_ = nullptr;
   vec2 cursor_ = {0, 0};
   size_t placed_glyphs_ = 0;
@@ -18,13 +18,22 @@ limitations under the License.
 
 #include <utility>
 
+#include "redux/data/asset_defs/font_asset_def_generated.h"
 #include "redux/engines/text/internal/text_layout.h"
 #include "redux/modules/base/asset_loader.h"
+#include "redux/modules/base/filepath.h"
 #include "redux/modules/base/logging.h"
 #include "redux/modules/base/static_registry.h"
+#include "redux/modules/flatbuffers/math.h"
 
 namespace redux {
 
+// The number of shaped glyph sequences retained across GenerateTextMesh calls.
+static constexpr size_t kShapingCacheSize = 256;
+
+// The size (in pixels) at which all glyphs are rasterized.
+static constexpr float kFontRasterizationSize = 48.f;
+
 std::vector<TextCharacterBreakType> GetBreaks(std::string_view text,
                                               const TextParams& params);
 
@@ -32,7 +41,17 @@ void TextEngine::Create(Registry* registry) {
   registry->Register(std::unique_ptr<TextEngine>(new TextEngine(registry)));
 }
 
-TextEngine::TextEngine(Registry* registry) : registry_(registry) {}
+TextEngine::TextEngine(Registry* registry)
+    : registry_(registry),
+      sdf_computer_(std::make_shared<SdfBatchComputer>()),
+      shaping_cache_(kShapingCacheSize) {}
+
+void TextEngine::SetAsyncGlyphRasterization(bool async) {
+  async_glyph_rasterization_ = async;
+  for (auto& iter : fonts_) {
+    iter.second->SetSdfComputer(sdf_computer_, async_glyph_rasterization_);
+  }
+}
 
 FontPtr TextEngine::LoadFont(std::string_view path) {
   const HashValue key = Hash(path);
@@ -45,22 +64,95 @@ FontPtr TextEngine::LoadFont(std::string_view path) {
   auto asset = asset_loader->LoadNow(path);
   CHECK(asset.ok()) << "Could not load font: " << path;
 
-  FontPtr font = std::make_shared<Font>(key, std::move(*asset));
+  FontPtr font;
+  if (GetExtension(path) == ".rxfont") {
+    font = LoadBakedFont(key, *asset);
+  } else {
+    font = std::make_shared<Font>(key, std::move(*asset));
+  }
+  font->SetSdfComputer(sdf_computer_, async_glyph_rasterization_);
   fonts_[key] = font;
   return font;
 }
 
+FontPtr TextEngine::LoadBakedFont(HashValue key, const DataContainer& asset) {
+  const auto* def = flatbuffers::GetRoot<FontAssetDef>(asset.GetBytes());
+  CHECK(def->font_data()) << "Baked font is missing its font data.";
+
+  // The font data must outlive the asset, so it is copied.
+  const auto* bytes = def->font_data();
+  DataContainer font_data =
+      DataContainer::WrapData(bytes->data(), bytes->size()).Clone();
+
+  if (def->atlas() == nullptr || def->atlas_size() == nullptr ||
+      def->glyphs() == nullptr) {
+    return std::make_shared<Font>(key, std::move(font_data));
+  }
+
+  const vec2i atlas_size = ReadFbs(*def->atlas_size());
+  FontPtr font = std::make_shared<Font>(key, std::move(font_data), atlas_size);
+  if (def->rasterization_size() != kFontRasterizationSize) {
+    LOG(ERROR) << "Baked glyphs were rasterized at size "
+               << def->rasterization_size() << " instead of "
+               << kFontRasterizationSize << ", ignoring them.";
+    return font;
+  }
+  const size_t num_pixels = static_cast<size_t>(atlas_size.x * atlas_size.y);
+  if (def->atlas()->size() != num_pixels) {
+    LOG(ERROR) << "Baked glyph atlas has the wrong size, ignoring it.";
+    return font;
+  }
+
+  std::vector<Font::BakedGlyph> glyphs;
+  glyphs.reserve(def->glyphs()->size());
+  for (const BakedGlyphAssetDef* glyph : *def->glyphs()) {
+    Font::BakedGlyph& baked = glyphs.emplace_back();
+    baked.id = glyph->id();
+    baked.size = ReadFbs(glyph->size());
+    baked.bitmap_bounds = ReadFbs(glyph->bitmap_bounds());
+    baked.atlas_bounds = ReadFbs(glyph->atlas_bounds());
+    baked.advance = glyph->advance();
+  }
+
+  const ImageData atlas(ImageFormat::Alpha8, atlas_size,
+                        DataContainer::WrapData(def->atlas()->data(),
+                                                def->atlas()->size()));
+  font->LoadBakedGlyphs(atlas, glyphs);
+  return font;
+}
+
 MeshData TextEngine::GenerateTextMesh(std::string_view text,
-                                      const TextParams& params) {
+                                      const TextParams& params,
+                                      size_t* out_glyph_page) {
   CHECK(params.font);
 
-  static constexpr float kFontRasterizationSize = 48.f;
-  GlyphSequence sequence = params.font->GenerateGlyphSequence(
-      text, params.language_iso_639, kFontRasterizationSize,
-      params.text_direction);
+  GlyphSequenceCache::Key key;
+  key.text = std::string(text);
+  key.font = params.font->GetName();
+  key.font_size = kFontRasterizationSize;
+  key.language_iso_639 = params.language_iso_639;
+  key.direction = params.text_direction;
+
+  GlyphSequence* shaped = shaping_cache_.Find(key);
+  if (shaped == nullptr) {
+    shaped = shaping_cache_.Insert(
+        std::move(key),
+        params.font->ShapeGlyphSequence(text, params.language_iso_639,
+                                        params.text_direction));
+  }
+
+  // Breaks depend only on the text and language, so they are computed once and
+  // kept with the cached shaping.
+  if (params.wrap != TextWrapMode::kNone && shaped->breaks.empty()) {
+    shaped->breaks = GetBreaks(text, params);
+  }
 
-  if (params.wrap != TextWrapMode::kNone) {
-    sequence.breaks = GetBreaks(text, params);
+  // The glyphs may have been evicted from the atlas since the sequence was
+  // shaped, so always make sure they are rasterized.
+  GlyphSequence sequence = *shaped;
+  params.font->PrepareGlyphSequence(&sequence, kFontRasterizationSize);
+  if (out_glyph_page) {
+    *out_glyph_page = sequence.page;
   }
 
   TextLayout layout(params, kFontRasterizationSize);
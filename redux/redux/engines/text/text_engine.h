@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "redux/engines/text/font.h"
+#include "redux/engines/text/internal/glyph_sequence_cache.h"
 #include "redux/engines/text/text_enums.h"
 #include "redux/modules/base/registry.h"
 #include "redux/modules/graphics/mesh_data.h"
@@ -49,6 +50,9 @@ struct TextParams {
   TextDirection text_direction = TextDirection::kLanguageDefault;
 
   std::string language_iso_639;
+
+  // The color stored in the vertices of the generated mesh.
+  vec4 color = vec4::One();
 };
 
 // Manages Font objects and uses them to generate image and mesh data for text
@@ -60,15 +64,37 @@ class TextEngine {
   TextEngine(const TextEngine&) = delete;
   TextEngine& operator=(const TextEngine&) = delete;
 
+  // Loads the font at the given `path`, which is either a font binary (eg. a
+  // ttf file) or an rxfont file, ie. a font binary along with a pre-rasterized
+  // glyph atlas built by the font_pipeline tool.
   FontPtr LoadFont(std::string_view path);
 
-  MeshData GenerateTextMesh(std::string_view text, const TextParams& params);
+  // Enables computing the signed distance fields of new glyphs on worker
+  // threads for all fonts. The glyphs become visible in the font atlases once
+  // Font::ProcessPendingGlyphs is called after they are done.
+  void SetAsyncGlyphRasterization(bool async);
+
+  // Generates the mesh for the `text`. The mesh samples from a single glyph
+  // atlas page of the font, the index of which is returned in `out_glyph_page`
+  // if provided.
+  //
+  // The shaped glyph sequence (and its line breaks) is cached by text, font,
+  // language and direction, so regenerating the same text with different
+  // bounds, alignment or wrap width only repeats the layout.
+  MeshData GenerateTextMesh(std::string_view text, const TextParams& params,
+                            size_t* out_glyph_page = nullptr);
 
  protected:
   explicit TextEngine(Registry* registry);
 
+  // Creates a Font from an rxfont asset, preloading its baked glyphs.
+  FontPtr LoadBakedFont(HashValue key, const DataContainer& asset);
+
   Registry* registry_ = nullptr;
   absl::flat_hash_map<HashValue, FontPtr> fonts_;
+  std::shared_ptr<SdfBatchComputer> sdf_computer_;
+  GlyphSequenceCache shaping_cache_;
+  bool async_glyph_rasterization_ = false;
 };
 }  // namespace redux
 
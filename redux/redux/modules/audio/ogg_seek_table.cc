@@ -0,0 +1,130 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/audio/ogg_seek_table.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace redux {
+
+// The fixed-size part of an Ogg page header, followed by up to 255 lacing
+// values giving the sizes of the segments of the page body.
+static constexpr size_t kPageHeaderSize = 27;
+
+// Flag in the page header type indicating that the page begins with the
+// continuation of a packet from the previous page.
+static constexpr uint8_t kContinuedPacket = 0x01;
+
+// Granule position of a page on which no packet ends.
+static constexpr int64_t kNoGranule = -1;
+
+static uint64_t ReadLittleEndian(const uint8_t* ptr, int num_bytes) {
+  uint64_t value = 0;
+  for (int i = num_bytes - 1; i >= 0; --i) {
+    value = (value << 8) | ptr[i];
+  }
+  return value;
+}
+
+std::shared_ptr<const OggSeekTable> OggSeekTable::Build(DataReader& reader,
+                                                         uint64_t pre_skip) {
+  const size_t start = reader.GetCurrentPosition();
+  const size_t length = reader.GetTotalLength();
+  auto table = std::make_shared<OggSeekTable>();
+
+  bool ok = true;
+  bool first_page = true;
+  uint32_t serial = 0;
+  bool has_granule = false;
+  int64_t prev_granule = 0;
+  size_t offset = 0;
+  while (offset < length) {
+    uint8_t header[kPageHeaderSize + 255];
+    reader.SetCurrentPosition(offset);
+    const size_t num_read = reader.Read(header, kPageHeaderSize);
+    if (num_read == 0) {
+      // The length of the stream was not known up front.
+      break;
+    }
+    if (num_read != kPageHeaderSize ||
+        std::memcmp(header, "OggS", 4) != 0 || header[4] != 0) {
+      ok = false;
+      break;
+    }
+    const uint8_t type = header[5];
+    const int64_t granule =
+        static_cast<int64_t>(ReadLittleEndian(header + 6, 8));
+    const uint32_t page_serial =
+        static_cast<uint32_t>(ReadLittleEndian(header + 14, 4));
+    const size_t num_segments = header[26];
+    if (reader.Read(header + kPageHeaderSize, num_segments) != num_segments) {
+      ok = false;
+      break;
+    }
+
+    if (first_page) {
+      serial = page_serial;
+      first_page = false;
+    } else if (page_serial != serial) {
+      // Chained or multiplexed streams are not supported.
+      ok = false;
+      break;
+    }
+
+    // Header pages have a granule position of zero and cannot be decoded from.
+    // Pages that begin mid-packet would lose that packet.
+    if (has_granule && granule != 0 && (type & kContinuedPacket) == 0) {
+      Entry entry;
+      entry.frame = prev_granule > static_cast<int64_t>(pre_skip)
+                        ? static_cast<uint64_t>(prev_granule) - pre_skip
+                        : 0;
+      entry.offset = offset;
+      if (table->entries_.empty() ||
+          entry.frame > table->entries_.back().frame) {
+        table->entries_.push_back(entry);
+      }
+    }
+    if (granule != kNoGranule) {
+      has_granule = true;
+      prev_granule = granule;
+    }
+
+    size_t body_size = 0;
+    for (size_t i = 0; i < num_segments; ++i) {
+      body_size += header[kPageHeaderSize + i];
+    }
+    offset += kPageHeaderSize + num_segments + body_size;
+  }
+
+  reader.SetCurrentPosition(start);
+  if (!ok || table->entries_.empty()) {
+    return nullptr;
+  }
+  return table;
+}
+
+const OggSeekTable::Entry* OggSeekTable::Find(uint64_t frame) const {
+  auto iter = std::upper_bound(
+      entries_.begin(), entries_.end(), frame,
+      [](uint64_t frame, const Entry& entry) { return frame < entry.frame; });
+  if (iter == entries_.begin()) {
+    return nullptr;
+  }
+  return &*(iter - 1);
+}
+
+}  // namespace redux
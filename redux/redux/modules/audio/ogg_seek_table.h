@@ -0,0 +1,64 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_MODULES_AUDIO_OGG_SEEK_TABLE_H_
+#define REDUX_MODULES_AUDIO_OGG_SEEK_TABLE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "redux/modules/base/data_reader.h"
+
+namespace redux {
+
+// Maps frame positions in an Ogg stream to the byte offsets of the pages from
+// which decoding can resume, so that readers can jump straight to the right
+// page instead of bisecting the stream (with many small reads) on every seek.
+//
+// The table is built by reading only the page headers of the stream, and is
+// immutable once built so that it can be shared by every reader of the same
+// asset.
+class OggSeekTable {
+ public:
+  struct Entry {
+    // The first frame that is decoded when decoding starts at the page.
+    uint64_t frame = 0;
+    // The byte offset of the start of the page.
+    uint64_t offset = 0;
+  };
+
+  // Scans the pages of the Ogg stream in `reader`, restoring its position
+  // afterwards. Granule positions are converted to frames by subtracting
+  // `pre_skip` (eg. the Opus pre-skip). Returns nullptr if the stream is not a
+  // single, well-formed logical stream.
+  static std::shared_ptr<const OggSeekTable> Build(DataReader& reader,
+                                                   uint64_t pre_skip = 0);
+
+  // Returns the last entry whose frame is at or before `frame`, or nullptr if
+  // there is none.
+  const Entry* Find(uint64_t frame) const;
+
+  // Returns all entries, ordered by frame.
+  const std::vector<Entry>& GetEntries() const { return entries_; }
+
+ private:
+  std::vector<Entry> entries_;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_MODULES_AUDIO_OGG_SEEK_TABLE_H_
@@ -0,0 +1,86 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/testing/testing.h"
+#include "redux/modules/audio/ogg_seek_table.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::NotNull;
+using ::testing::SizeIs;
+
+static constexpr auto kDataPath =
+    "redux/modules/audio/test_data";
+
+static DataReader CreateDataReader(std::string_view uri) {
+  const std::string fullpath = ResolveTestFilePath(kDataPath, uri);
+  FILE* file = fopen(fullpath.c_str(), "rb");
+  return DataReader::FromCFile(file);
+}
+
+TEST(OggSeekTableTests, BuildVorbis) {
+  auto reader = CreateDataReader("speech.ogg");
+  auto table = OggSeekTable::Build(reader);
+  ASSERT_THAT(table, NotNull());
+  EXPECT_THAT(reader.GetCurrentPosition(), Eq(0));
+
+  // The header pages are skipped.
+  const auto& entries = table->GetEntries();
+  ASSERT_THAT(entries, SizeIs(4));
+  EXPECT_THAT(entries[0].frame, Eq(0));
+  EXPECT_THAT(entries[0].offset, Eq(2631));
+  EXPECT_THAT(entries[1].frame, Eq(7168));
+  EXPECT_THAT(entries[1].offset, Eq(6818));
+  EXPECT_THAT(entries[3].frame, Eq(22016));
+  EXPECT_THAT(entries[3].offset, Eq(15270));
+}
+
+TEST(OggSeekTableTests, BuildOpusWithPreSkip) {
+  auto reader = CreateDataReader("speech.opus");
+  auto table = OggSeekTable::Build(reader, 312);
+  ASSERT_THAT(table, NotNull());
+
+  const auto& entries = table->GetEntries();
+  ASSERT_THAT(entries, SizeIs(3));
+  EXPECT_THAT(entries[0].frame, Eq(0));
+  EXPECT_THAT(entries[1].frame, Eq(48000 - 312));
+  EXPECT_THAT(entries[2].frame, Eq(96000 - 312));
+}
+
+TEST(OggSeekTableTests, Find) {
+  auto reader = CreateDataReader("speech.ogg");
+  auto table = OggSeekTable::Build(reader);
+  ASSERT_THAT(table, NotNull());
+
+  EXPECT_THAT(table->Find(0)->offset, Eq(2631));
+  EXPECT_THAT(table->Find(7167)->offset, Eq(2631));
+  EXPECT_THAT(table->Find(7168)->offset, Eq(6818));
+  EXPECT_THAT(table->Find(100000)->offset, Eq(15270));
+}
+
+TEST(OggSeekTableTests, RejectsNonOgg) {
+  auto reader = CreateDataReader("speech.wav");
+  EXPECT_THAT(OggSeekTable::Build(reader), IsNull());
+  EXPECT_THAT(reader.GetCurrentPosition(), Eq(0));
+}
+
+}  // namespace
+}  // namespace redux
@@ -25,6 +25,9 @@ namespace redux {
 // Default frame size of buffers used for internal ogg decoding.
 static const size_t kOggInternalBufferSize = 512;
 
+// Opus needs 80ms (at 48kHz) of decoded audio to converge after a seek.
+static const uint64_t kPreRollFrames = 3840;
+
 static int OggOpusRead(void* stream, unsigned char* ptr, int nbytes) {
   auto* reader = reinterpret_cast<DataReader*>(stream);
   return static_cast<int>(reader->Read(ptr, nbytes));
@@ -50,7 +53,9 @@ static opus_int64 OggOpusTell(void* stream) {
 
 static int OggOpusNoopClose(void* stream) { return 0; }
 
-OpusReader::OpusReader(DataReader reader) : reader_(std::move(reader)) {
+OpusReader::OpusReader(DataReader reader,
+                       std::shared_ptr<const OggSeekTable> seek_table)
+    : reader_(std::move(reader)), seek_table_(std::move(seek_table)) {
   OpusFileCallbacks callbacks = {OggOpusRead, OggOpusSeek, OggOpusTell,
                                  OggOpusNoopClose};
 
@@ -71,6 +76,11 @@ OpusReader::OpusReader(DataReader reader) : reader_(std::move(reader)) {
   num_channels_ = static_cast<uint64_t>(head->channel_count);
   total_frames_ = total_samples / num_channels_;
   bytes_per_sample_ = sizeof(float);
+
+  if (seek_table_ == nullptr && op_seekable(opus_file_) &&
+      op_link_count(opus_file_) == 1) {
+    seek_table_ = OggSeekTable::Build(reader_, head->pre_skip);
+  }
 }
 
 OpusReader::~OpusReader() { Close(); }
@@ -100,13 +110,46 @@ uint64_t OpusReader::SeekToFramePosition(uint64_t position) {
     LOG(ERROR) << "Attempt to seek into non-seekable opus stream.";
   } else if (position >= total_frames_) {
     LOG(ERROR) << "Seek out of range in opus stream";
-  } else if (op_pcm_seek(opus_file_, static_cast<ogg_int64_t>(position)) < 0) {
+  } else if (!SeekWithTable(position) &&
+             op_pcm_seek(opus_file_, static_cast<ogg_int64_t>(position)) < 0) {
     LOG(ERROR) << "Error seeking in opus stream";
   }
   current_frame_ = static_cast<uint64_t>(op_pcm_tell(opus_file_));
   return current_frame_;
 }
 
+bool OpusReader::SeekWithTable(uint64_t position) {
+  if (seek_table_ == nullptr) {
+    return false;
+  }
+  const uint64_t start =
+      position > kPreRollFrames ? position - kPreRollFrames : 0;
+  const OggSeekTable::Entry* entry = seek_table_->Find(start);
+  if (entry == nullptr ||
+      op_raw_seek(opus_file_, static_cast<opus_int64>(entry->offset)) < 0) {
+    return false;
+  }
+
+  // Decode and discard the audio up to the requested position.
+  ogg_int64_t current = op_pcm_tell(opus_file_);
+  if (current < 0 || static_cast<uint64_t>(current) > position) {
+    return false;
+  }
+  read_buffer_.resize(kOggInternalBufferSize * num_channels_ *
+                      bytes_per_sample_);
+  float* buffer = reinterpret_cast<float*>(read_buffer_.data());
+  while (static_cast<uint64_t>(current) < position) {
+    const uint64_t num_frames = std::min<uint64_t>(
+        kOggInternalBufferSize, position - static_cast<uint64_t>(current));
+    const int num_samples = static_cast<int>(num_frames * num_channels_);
+    if (op_read_float(opus_file_, buffer, num_samples, nullptr) <= 0) {
+      return false;
+    }
+    current = op_pcm_tell(opus_file_);
+  }
+  return true;
+}
+
 absl::Span<const std::byte> OpusReader::ReadFrames(uint64_t num_frames) {
   CHECK(reader_.IsOpen()) << "Opus data stream is closed.";
   CHECK(opus_file_ != nullptr) << "Opus data stream is closed.";
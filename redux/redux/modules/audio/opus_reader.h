@@ -17,10 +17,12 @@ limitations under the License.
 #ifndef REDUX_MODULES_AUDIO_OPUS_READER_H_
 #define REDUX_MODULES_AUDIO_OPUS_READER_H_
 
+#include <memory>
 #include <vector>
 
 #include "opusfile.h"
 #include "redux/modules/audio/audio_reader.h"
+#include "redux/modules/audio/ogg_seek_table.h"
 #include "redux/modules/base/data_reader.h"
 
 namespace redux {
@@ -28,7 +30,11 @@ namespace redux {
 // Stream-like API for Ogg Opus files.
 class OpusReader : public AudioReader {
  public:
-  explicit OpusReader(DataReader reader);
+  // Seeks jump straight to the right page of the stream using `seek_table`.
+  // If it is null, a seek table is built from the stream when it is opened.
+  explicit OpusReader(
+      DataReader reader,
+      std::shared_ptr<const OggSeekTable> seek_table = nullptr);
   ~OpusReader() override;
 
   // Resets the reader to a just-initialized state. Should be run if an error
@@ -73,12 +79,23 @@ class OpusReader : public AudioReader {
   // Reads up to `num_frames` of audio data.
   absl::Span<const std::byte> ReadFrames(uint64_t num_frames) override;
 
+  // Returns the table used for seeking, which can be shared with other readers
+  // of the same stream to avoid building it again. May be null if the stream
+  // cannot be seeked.
+  const std::shared_ptr<const OggSeekTable>& GetSeekTable() const {
+    return seek_table_;
+  }
+
   // Checks the data reader to see if it contains a opus .ogg header.
   static bool CheckHeader(DataReader& reader);
 
  private:
   void Close();
 
+  // Seeks to `position` by decoding from the nearest preceding page in the seek
+  // table. Returns false if the seek table could not be used.
+  bool SeekWithTable(uint64_t position);
+
   int sample_rate_hz_ = -1;
   uint64_t num_channels_ = 0;
   uint64_t bytes_per_sample_ = 0;
@@ -86,6 +103,7 @@ class OpusReader : public AudioReader {
   uint64_t total_frames_ = 0;
   OggOpusFile* opus_file_ = nullptr;
   DataReader reader_;
+  std::shared_ptr<const OggSeekTable> seek_table_;
   std::vector<std::byte> read_buffer_;
 };
 
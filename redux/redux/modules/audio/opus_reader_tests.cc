@@ -24,6 +24,8 @@ namespace {
 
 using ::testing::Eq;
 using ::testing::Le;
+using ::testing::NotNull;
+using ::testing::SizeIs;
 
 static constexpr auto kDataPath =
     "redux/modules/audio/test_data";
@@ -80,6 +82,37 @@ TEST(OpusReaderTests, DecodeSmallFile) {
   EXPECT_THAT(frame_count, Eq(reader->GetTotalFrameCount()));
 }
 
+TEST(OpusReaderTests, BuildsSeekTable) {
+  auto reader = CreateOpusReader("speech.opus");
+
+  ASSERT_THAT(reader->GetSeekTable(), NotNull());
+  EXPECT_THAT(reader->GetSeekTable()->GetEntries(), SizeIs(3));
+}
+
+TEST(OpusReaderTests, SeekWithSharedSeekTable) {
+  auto other = CreateOpusReader("speech.opus");
+  auto reader = std::make_unique<OpusReader>(CreateDataReader("speech.opus"),
+                                             other->GetSeekTable());
+  EXPECT_THAT(reader->GetSeekTable(), Eq(other->GetSeekTable()));
+
+  const uint64_t position = 100000;
+  EXPECT_THAT(reader->SeekToFramePosition(position), Eq(position));
+  EXPECT_THAT(reader->GetReadFramePosition(), Eq(position));
+
+  uint64_t frame_count = position;
+  while (!reader->IsAtEndOfStream()) {
+    auto buffer = reader->ReadFrames(2048);
+    if (buffer.empty()) {
+      break;
+    }
+    frame_count += buffer.size() / reader->GetNumBytesPerFrame();
+  }
+  EXPECT_THAT(frame_count, Eq(reader->GetTotalFrameCount()));
+
+  reader->Reset();
+  EXPECT_THAT(reader->GetReadFramePosition(), Eq(0));
+}
+
 TEST(OpusReaderTests, CheckHeader) {
   auto reader1 = CreateDataReader("speech.opus");
   EXPECT_TRUE(OpusReader::CheckHeader(reader1));
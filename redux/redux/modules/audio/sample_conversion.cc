@@ -0,0 +1,158 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/audio/sample_conversion.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define REDUX_AUDIO_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define REDUX_AUDIO_NEON 1
+#endif
+
+namespace redux {
+
+// Matches the scale used by resonance audio when converting to/from int16.
+static constexpr float kInt16ToFloat = 1.0f / 32767.0f;
+
+static void DeinterleaveMono(const int16_t* src, std::size_t num_frames,
+                             float* dst) {
+  std::size_t i = 0;
+#if defined(REDUX_AUDIO_SSE2)
+  const __m128 scale = _mm_set1_ps(kInt16ToFloat);
+  for (; i + 8 <= num_frames; i += 8) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    // Sign-extend each half to 32-bits by placing the samples in the upper
+    // 16-bits and shifting them back down.
+    const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+  }
+#elif defined(REDUX_AUDIO_NEON)
+  for (; i + 8 <= num_frames; i += 8) {
+    const int16x8_t v = vld1q_s16(src + i);
+    const int32x4_t lo = vmovl_s16(vget_low_s16(v));
+    const int32x4_t hi = vmovl_s16(vget_high_s16(v));
+    vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(lo), kInt16ToFloat));
+    vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(hi), kInt16ToFloat));
+  }
+#endif
+  for (; i < num_frames; ++i) {
+    dst[i] = static_cast<float>(src[i]) * kInt16ToFloat;
+  }
+}
+
+static void DeinterleaveStereo(const int16_t* src, std::size_t num_frames,
+                               float* left, float* right) {
+  std::size_t i = 0;
+#if defined(REDUX_AUDIO_SSE2)
+  const __m128 scale = _mm_set1_ps(kInt16ToFloat);
+  for (; i + 4 <= num_frames; i += 4) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (2 * i)));
+    // Each 32-bit lane holds one frame; left in the low half, right in the
+    // high half.
+    const __m128i l = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    const __m128i r = _mm_srai_epi32(v, 16);
+    _mm_storeu_ps(left + i, _mm_mul_ps(_mm_cvtepi32_ps(l), scale));
+    _mm_storeu_ps(right + i, _mm_mul_ps(_mm_cvtepi32_ps(r), scale));
+  }
+#elif defined(REDUX_AUDIO_NEON)
+  for (; i + 8 <= num_frames; i += 8) {
+    const int16x8x2_t v = vld2q_s16(src + (2 * i));
+    const int32x4_t l_lo = vmovl_s16(vget_low_s16(v.val[0]));
+    const int32x4_t l_hi = vmovl_s16(vget_high_s16(v.val[0]));
+    const int32x4_t r_lo = vmovl_s16(vget_low_s16(v.val[1]));
+    const int32x4_t r_hi = vmovl_s16(vget_high_s16(v.val[1]));
+    vst1q_f32(left + i, vmulq_n_f32(vcvtq_f32_s32(l_lo), kInt16ToFloat));
+    vst1q_f32(left + i + 4, vmulq_n_f32(vcvtq_f32_s32(l_hi), kInt16ToFloat));
+    vst1q_f32(right + i, vmulq_n_f32(vcvtq_f32_s32(r_lo), kInt16ToFloat));
+    vst1q_f32(right + i + 4, vmulq_n_f32(vcvtq_f32_s32(r_hi), kInt16ToFloat));
+  }
+#endif
+  for (; i < num_frames; ++i) {
+    left[i] = static_cast<float>(src[2 * i]) * kInt16ToFloat;
+    right[i] = static_cast<float>(src[(2 * i) + 1]) * kInt16ToFloat;
+  }
+}
+
+static void DeinterleaveStereo(const float* src, std::size_t num_frames,
+                               float* left, float* right) {
+  std::size_t i = 0;
+#if defined(REDUX_AUDIO_SSE2)
+  for (; i + 4 <= num_frames; i += 4) {
+    const __m128 a = _mm_loadu_ps(src + (2 * i));
+    const __m128 b = _mm_loadu_ps(src + (2 * i) + 4);
+    _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+#elif defined(REDUX_AUDIO_NEON)
+  for (; i + 4 <= num_frames; i += 4) {
+    const float32x4x2_t v = vld2q_f32(src + (2 * i));
+    vst1q_f32(left + i, v.val[0]);
+    vst1q_f32(right + i, v.val[1]);
+  }
+#endif
+  for (; i < num_frames; ++i) {
+    left[i] = src[2 * i];
+    right[i] = src[(2 * i) + 1];
+  }
+}
+
+void DeinterleaveToFloat(const int16_t* interleaved, std::size_t num_frames,
+                         absl::Span<float* const> planar) {
+  const std::size_t num_channels = planar.size();
+  if (num_channels == 1) {
+    DeinterleaveMono(interleaved, num_frames, planar[0]);
+  } else if (num_channels == 2) {
+    DeinterleaveStereo(interleaved, num_frames, planar[0], planar[1]);
+  } else {
+    for (std::size_t channel = 0; channel < num_channels; ++channel) {
+      float* dst = planar[channel];
+      const int16_t* src = interleaved + channel;
+      for (std::size_t i = 0; i < num_frames; ++i) {
+        dst[i] = static_cast<float>(*src) * kInt16ToFloat;
+        src += num_channels;
+      }
+    }
+  }
+}
+
+void DeinterleaveToFloat(const float* interleaved, std::size_t num_frames,
+                         absl::Span<float* const> planar) {
+  const std::size_t num_channels = planar.size();
+  if (num_channels == 1) {
+    std::copy(interleaved, interleaved + num_frames, planar[0]);
+  } else if (num_channels == 2) {
+    DeinterleaveStereo(interleaved, num_frames, planar[0], planar[1]);
+  } else {
+    for (std::size_t channel = 0; channel < num_channels; ++channel) {
+      float* dst = planar[channel];
+      const float* src = interleaved + channel;
+      for (std::size_t i = 0; i < num_frames; ++i) {
+        dst[i] = *src;
+        src += num_channels;
+      }
+    }
+  }
+}
+
+}  // namespace redux
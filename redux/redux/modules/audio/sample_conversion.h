@@ -0,0 +1,43 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_MODULES_AUDIO_SAMPLE_CONVERSION_H_
+#define REDUX_MODULES_AUDIO_SAMPLE_CONVERSION_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/types/span.h"
+
+namespace redux {
+
+// Converts `num_frames` of interleaved 16-bit samples (as returned by
+// AudioReader::ReadFrames for the kInt16 format) into planar float samples in
+// the range [-1, 1]. The number of channels is given by the size of `planar`,
+// and each entry must point to at least `num_frames` floats.
+//
+// Mono and stereo data (the common cases) are converted using SSE2 or NEON
+// when available.
+void DeinterleaveToFloat(const int16_t* interleaved, std::size_t num_frames,
+                         absl::Span<float* const> planar);
+
+// As above, but for interleaved float samples (ie. the kFloat format).
+void DeinterleaveToFloat(const float* interleaved, std::size_t num_frames,
+                         absl::Span<float* const> planar);
+
+}  // namespace redux
+
+#endif  // REDUX_MODULES_AUDIO_SAMPLE_CONVERSION_H_
@@ -0,0 +1,96 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/audio/sample_conversion.h"
+
+namespace redux {
+namespace {
+
+using ::testing::FloatEq;
+using ::testing::Pointwise;
+
+// Number of frames that isn't a multiple of any vector width so that both the
+// vectorized and scalar paths are exercised.
+static constexpr std::size_t kNumFrames = 37;
+
+template <typename T>
+static std::vector<T> CreateInterleaved(std::size_t num_channels) {
+  std::vector<T> data(kNumFrames * num_channels);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    // Cover the full range of values, including both extremes.
+    const int value =
+        -32768 + static_cast<int>((i * 65535) / (data.size() - 1));
+    if constexpr (std::is_same_v<T, int16_t>) {
+      data[i] = static_cast<int16_t>(value);
+    } else {
+      data[i] = static_cast<float>(value) / 32768.0f;
+    }
+  }
+  return data;
+}
+
+template <typename T>
+static void TestDeinterleave(std::size_t num_channels, float scale) {
+  const std::vector<T> interleaved = CreateInterleaved<T>(num_channels);
+
+  std::vector<std::vector<float>> planar(num_channels,
+                                         std::vector<float>(kNumFrames));
+  std::vector<float*> channels;
+  for (auto& channel : planar) {
+    channels.push_back(channel.data());
+  }
+  DeinterleaveToFloat(interleaved.data(), kNumFrames, channels);
+
+  for (std::size_t channel = 0; channel < num_channels; ++channel) {
+    std::vector<float> expected(kNumFrames);
+    for (std::size_t i = 0; i < kNumFrames; ++i) {
+      expected[i] =
+          static_cast<float>(interleaved[(i * num_channels) + channel]) * scale;
+    }
+    EXPECT_THAT(planar[channel], Pointwise(FloatEq(), expected));
+  }
+}
+
+TEST(SampleConversionTest, Int16Mono) {
+  TestDeinterleave<int16_t>(1, 1.0f / 32767.0f);
+}
+
+TEST(SampleConversionTest, Int16Stereo) {
+  TestDeinterleave<int16_t>(2, 1.0f / 32767.0f);
+}
+
+TEST(SampleConversionTest, Int16MultiChannel) {
+  TestDeinterleave<int16_t>(3, 1.0f / 32767.0f);
+  TestDeinterleave<int16_t>(4, 1.0f / 32767.0f);
+}
+
+TEST(SampleConversionTest, FloatMono) { TestDeinterleave<float>(1, 1.0f); }
+
+TEST(SampleConversionTest, FloatStereo) { TestDeinterleave<float>(2, 1.0f); }
+
+TEST(SampleConversionTest, FloatMultiChannel) {
+  TestDeinterleave<float>(3, 1.0f);
+  TestDeinterleave<float>(4, 1.0f);
+}
+
+}  // namespace
+}  // namespace redux
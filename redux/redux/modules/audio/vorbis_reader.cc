@@ -25,6 +25,15 @@ namespace redux {
 // Default frame size of buffers used for internal ogg decoding.
 static const uint64_t kOggInternalBufferSize = 512;
 
+// Decoding from a page may not produce audio for the first half-block (of up to
+// 8192 frames), so seeks start from a page at least this far before the target.
+static const uint64_t kPreRollFrames = 4096;
+
+// Sample format arguments to ov_read.
+static constexpr int kLittleEndian = 0;
+static constexpr int k16BitSamples = 2;
+static constexpr int kSignedSamples = 1;
+
 static size_t OggVorbisRead(void* ptr, size_t nbytes, size_t count,
                             void* stream) {
   auto* reader = reinterpret_cast<DataReader*>(stream);
@@ -51,7 +60,9 @@ static long OggVorbisTell(void* stream) {
 
 static int OggVorbisNoopClose(void* stream) { return 0; }
 
-VorbisReader::VorbisReader(DataReader reader) : reader_(std::move(reader)) {
+VorbisReader::VorbisReader(DataReader reader,
+                           std::shared_ptr<const OggSeekTable> seek_table)
+    : reader_(std::move(reader)), seek_table_(std::move(seek_table)) {
   ov_callbacks callbacks = {OggVorbisRead, OggVorbisSeek, OggVorbisNoopClose,
                             OggVorbisTell};
 
@@ -70,6 +81,11 @@ VorbisReader::VorbisReader(DataReader reader) : reader_(std::move(reader)) {
   num_channels_ = static_cast<size_t>(info->channels);
   total_frames_ = total_samples / num_channels_;
   bytes_per_sample_ = sizeof(uint16_t);
+
+  if (seek_table_ == nullptr && ov_seekable(&vorbis_file_) &&
+      ov_streams(&vorbis_file_) == 1) {
+    seek_table_ = OggSeekTable::Build(reader_);
+  }
 }
 
 VorbisReader::~VorbisReader() { Close(); }
@@ -92,21 +108,52 @@ uint64_t VorbisReader::SeekToFramePosition(uint64_t position) {
     LOG(ERROR) << "Attempt to seek into non-seekable Vorbis stream.";
   } else if (position >= total_frames_) {
     LOG(ERROR) << "Seek out of range in Vorbis stream";
-  } else if (ov_pcm_seek(&vorbis_file_, static_cast<ogg_int64_t>(position)) <
-             0) {
+  } else if (!SeekWithTable(position) &&
+             ov_pcm_seek(&vorbis_file_, static_cast<ogg_int64_t>(position)) <
+                 0) {
     LOG(ERROR) << "Error seeking in Vorbis stream";
   }
   current_frame_ = static_cast<uint64_t>(ov_pcm_tell(&vorbis_file_));
   return current_frame_;
 }
 
+bool VorbisReader::SeekWithTable(uint64_t position) {
+  if (seek_table_ == nullptr) {
+    return false;
+  }
+  const uint64_t start =
+      position > kPreRollFrames ? position - kPreRollFrames : 0;
+  const OggSeekTable::Entry* entry = seek_table_->Find(start);
+  if (entry == nullptr ||
+      ov_raw_seek(&vorbis_file_, static_cast<ogg_int64_t>(entry->offset)) !=
+          0) {
+    return false;
+  }
+
+  // Decode and discard the audio up to the requested position.
+  ogg_int64_t current = ov_pcm_tell(&vorbis_file_);
+  if (current < 0 || static_cast<uint64_t>(current) > position) {
+    return false;
+  }
+  const uint64_t bytes_per_frame = num_channels_ * bytes_per_sample_;
+  read_buffer_.resize(kOggInternalBufferSize * bytes_per_frame);
+  char* buffer = reinterpret_cast<char*>(read_buffer_.data());
+  while (static_cast<uint64_t>(current) < position) {
+    const uint64_t num_frames = std::min<uint64_t>(
+        kOggInternalBufferSize, position - static_cast<uint64_t>(current));
+    const int num_bytes = static_cast<int>(num_frames * bytes_per_frame);
+    if (ov_read(&vorbis_file_, buffer, num_bytes, kLittleEndian, k16BitSamples,
+                kSignedSamples, nullptr) <= 0) {
+      return false;
+    }
+    current = ov_pcm_tell(&vorbis_file_);
+  }
+  return true;
+}
+
 absl::Span<const std::byte> VorbisReader::ReadFrames(uint64_t num_frames) {
   CHECK(reader_.IsOpen());
 
-  constexpr int kLittleEndian = 0;
-  constexpr int k16BitSamples = 2;
-  constexpr int kSignedSamples = 1;
-
   const uint64_t capacity = num_frames * bytes_per_sample_ * num_channels_;
   read_buffer_.resize(capacity);
 
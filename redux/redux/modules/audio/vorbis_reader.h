@@ -17,11 +17,13 @@ limitations under the License.
 #ifndef REDUX_MODULES_AUDIO_VORBIS_READER_H_
 #define REDUX_MODULES_AUDIO_VORBIS_READER_H_
 
+#include <memory>
 #include <vector>
 
 #define OV_EXCLUDE_STATIC_CALLBACKS 1
 #include "vorbis/vorbisfile.h"
 #include "redux/modules/audio/audio_reader.h"
+#include "redux/modules/audio/ogg_seek_table.h"
 #include "redux/modules/base/data_reader.h"
 
 namespace redux {
@@ -29,7 +31,11 @@ namespace redux {
 // Stream decodes an Ogg Vorbis file.
 class VorbisReader : public AudioReader {
  public:
-  explicit VorbisReader(DataReader reader);
+  // Seeks jump straight to the right page of the stream using `seek_table`.
+  // If it is null, a seek table is built from the stream when it is opened.
+  explicit VorbisReader(
+      DataReader reader,
+      std::shared_ptr<const OggSeekTable> seek_table = nullptr);
   ~VorbisReader() override;
 
   // Resets the reader to a just-initialized state. Should be run if an error
@@ -74,12 +80,23 @@ class VorbisReader : public AudioReader {
   // Reads up to `num_frames` of audio data.
   absl::Span<const std::byte> ReadFrames(uint64_t num_frames) override;
 
+  // Returns the table used for seeking, which can be shared with other readers
+  // of the same stream to avoid building it again. May be null if the stream
+  // cannot be seeked.
+  const std::shared_ptr<const OggSeekTable>& GetSeekTable() const {
+    return seek_table_;
+  }
+
   // Checks the data reader to see if it contains a vorbis .ogg header.
   static bool CheckHeader(DataReader& reader);
 
  private:
   void Close();
 
+  // Seeks to `position` by decoding from the nearest preceding page in the seek
+  // table. Returns false if the seek table could not be used.
+  bool SeekWithTable(uint64_t position);
+
   int sample_rate_hz_ = 0;
   uint64_t num_channels_ = 0;
   uint64_t bytes_per_sample_ = 0;
@@ -88,6 +105,7 @@ class VorbisReader : public AudioReader {
   uint64_t total_frames_ = 0;
   OggVorbis_File vorbis_file_ = {};
   DataReader reader_;
+  std::shared_ptr<const OggSeekTable> seek_table_;
   std::vector<std::byte> read_buffer_;
 };
 
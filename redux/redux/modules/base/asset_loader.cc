@@ -117,19 +117,20 @@ static absl::StatusOr<DataContainer> ReadAll(DataReader& reader) {
   return builder.Release();
 }
 
+// Returns a DataContainer that references the shared data and keeps it alive.
+static absl::StatusOr<DataContainer> WrapSharedData(
+    const absl::StatusOr<std::shared_ptr<const DataContainer>>& data) {
+  if (!data.ok()) {
+    return data.status();
+  }
+  const std::shared_ptr<const DataContainer>& container = data.value();
+  return DataContainer::WrapDataInSharedPtr(
+      container->GetBytes(), container->GetNumBytes(), container);
+}
+
 template <typename T>
 void AssetLoader::Request<T>::DoAsyncOp() {
-  StatusOrReader reader = (*open_fn_)(uri_);
-
-  if constexpr (std::is_same_v<T, DataReader>) {
-    result_ = std::move(reader);
-  } else if constexpr (std::is_same_v<T, DataContainer>) {
-    if (reader.ok()) {
-      result_ = ReadAll(reader.value());
-    } else {
-      result_ = reader.status();
-    }
-  }
+  result_ = operation_();
 
   if (async_op_) {
     async_op_(result_);
@@ -160,7 +161,10 @@ auto AssetLoader::Request<T>::PackageFinalizer(RequestPtr ptr,
   return finalize_task_.get_future();
 }
 
-AssetLoader::AssetLoader(Registry* registry) : registry_(registry) {
+AssetLoader::AssetLoader(Registry* registry, size_t num_worker_threads)
+    : registry_(registry),
+      num_worker_threads_(num_worker_threads),
+      processor_(num_worker_threads) {
   SetOpenFunction(nullptr);
 }
 
@@ -190,7 +194,9 @@ AssetLoader::OpenFn AssetLoader::GetDefaultOpenFunction(Registry* registry) {
   };
 }
 
-void AssetLoader::StartAsyncOperations() { processor_.Start(); }
+void AssetLoader::StartAsyncOperations() {
+  processor_.Start(num_worker_threads_);
+}
 
 void AssetLoader::StopAsyncOperations() { processor_.Stop(); }
 
@@ -210,7 +216,10 @@ auto AssetLoader::OpenAsync(std::string_view uri, ReaderCallback on_open,
                             ReaderCallback on_finalize)
     -> std::future<StatusOrReader> {
   using RequestT = Request<DataReader>;
-  auto request = std::make_shared<RequestT>(uri, open_fn_, std::move(on_open));
+  auto open = [open_fn = open_fn_, uri = std::string(uri)]() {
+    return (*open_fn)(uri);
+  };
+  auto request = std::make_shared<RequestT>(open, std::move(on_open));
 
   if (!processor_.IsRunning()) {
     request->DoAsyncOp();
@@ -229,17 +238,58 @@ auto AssetLoader::LoadAsync(std::string_view uri, DataCallback on_load,
                             DataCallback on_finalize)
     -> std::future<StatusOrData> {
   using RequestT = Request<DataContainer>;
-  auto request = std::make_shared<RequestT>(uri, open_fn_, std::move(on_load));
   if (!processor_.IsRunning()) {
+    // Loading now can't share a load that is waiting for the processor
+    // to be started again.
+    auto load = [this, uri = std::string(uri)]() { return LoadNow(uri); };
+    auto request = std::make_shared<RequestT>(load, std::move(on_load));
     request->DoAsyncOp();
-  } else {
-    ScheduleRequest(request);
-  }
-  auto future = request->PackageFinalizer(request, std::move(on_finalize));
-  if (!processor_.IsRunning()) {
+    auto future = request->PackageFinalizer(request, std::move(on_finalize));
     request->DoFinalize();
+    return future;
   }
-  return future;
+
+  auto request = std::make_shared<RequestT>(GetSharedLoadOperation(uri),
+                                            std::move(on_load));
+  ScheduleRequest(request);
+  return request->PackageFinalizer(request, std::move(on_finalize));
+}
+
+auto AssetLoader::GetSharedLoadOperation(std::string_view uri)
+    -> std::function<StatusOrData()> {
+  std::lock_guard<std::mutex> lock(in_flight_mutex_);
+  std::string key(uri);
+  auto iter = in_flight_loads_.find(key);
+  if (iter != in_flight_loads_.end()) {
+    // The requests are processed in order, so the load we join has already
+    // started by the time we wait for it.
+    SharedDataFuture future = iter->second;
+    return [future]() { return WrapSharedData(future.get()); };
+  }
+
+  auto promise = std::make_shared<std::promise<SharedData>>();
+  SharedDataFuture future = promise->get_future().share();
+  in_flight_loads_.emplace(key, future);
+  return [this, key, promise, future, open_fn = open_fn_]() {
+    SharedData data;
+    StatusOrReader reader = (*open_fn)(key);
+    if (reader.ok()) {
+      StatusOrData contents = ReadAll(reader.value());
+      if (contents.ok()) {
+        data = std::make_shared<const DataContainer>(std::move(*contents));
+      } else {
+        data = contents.status();
+      }
+    } else {
+      data = reader.status();
+    }
+    promise->set_value(std::move(data));
+    {
+      std::lock_guard<std::mutex> lock(in_flight_mutex_);
+      in_flight_loads_.erase(key);
+    }
+    return WrapSharedData(future.get());
+  };
 }
 
 void AssetLoader::ScheduleRequest(RequestPtr req) {
@@ -21,8 +21,10 @@ limitations under the License.
 #include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "redux/modules/base/async_processor.h"
 #include "redux/modules/base/data_container.h"
@@ -42,9 +44,14 @@ namespace redux {
 // operations will perform the entire loading process on the calling thread.
 // Asynchronous operations will perform the loading using an AsyncProcessor and
 // callbacks are used to manage the asset during this process.
+//
+// Asynchronous loads of a URI that is already being loaded asynchronously share
+// the data that is read, rather than each reading the URI again.
 class AssetLoader {
  public:
-  explicit AssetLoader(Registry* registry);
+  // The asynchronous operations are performed by `num_worker_threads` threads.
+  // The open function must be thread-safe if there is more than one.
+  explicit AssetLoader(Registry* registry, size_t num_worker_threads = 1);
   ~AssetLoader();
 
   AssetLoader(const AssetLoader& rhs) = delete;
@@ -73,7 +80,9 @@ class AssetLoader {
   // Loads the asset at the given `uri` into a DataContainer. The `on_load`
   // callback will be executed on a worker thread after the data is loaded.
   // The `on_finalize` callback will be called during Finalize(), allowing
-  // the caller to know when the asset is ready to use.
+  // the caller to know when the asset is ready to use. If `uri` is already
+  // being loaded asynchronously, its data is shared with that load instead of
+  // being read again.
   std::future<StatusOrData> LoadAsync(std::string_view uri,
                                       DataCallback on_load,
                                       DataCallback on_finalize);
@@ -117,6 +126,10 @@ class AssetLoader {
  private:
   using OpenFnPtr = std::shared_ptr<OpenFn>;
 
+  // Data read by a load that is shared by all the requests for its URI.
+  using SharedData = absl::StatusOr<std::shared_ptr<const DataContainer>>;
+  using SharedDataFuture = std::shared_future<SharedData>;
+
   class RequestBase {
    public:
     virtual ~RequestBase() = default;
@@ -130,11 +143,10 @@ class AssetLoader {
    public:
     using StatusOrT = absl::StatusOr<T>;
     using CallbackFn = std::function<void(StatusOrT&)>;
+    using OperationFn = std::function<StatusOrT()>;
 
-    Request(std::string_view uri, OpenFnPtr open_fn, CallbackFn async_op)
-        : uri_(uri),
-          open_fn_(std::move(open_fn)),
-          async_op_(std::move(async_op)) {}
+    Request(OperationFn operation, CallbackFn async_op)
+        : operation_(std::move(operation)), async_op_(std::move(async_op)) {}
 
     std::future<StatusOrT> PackageFinalizer(RequestPtr ptr,
                                             CallbackFn on_finalize);
@@ -144,19 +156,27 @@ class AssetLoader {
     void DoFinalize() override;
 
    private:
-    std::string uri_;
     StatusOrT result_;
-    OpenFnPtr open_fn_;
+    OperationFn operation_;
     CallbackFn async_op_;
     std::packaged_task<StatusOrT()> finalize_task_;
   };
 
   void ScheduleRequest(RequestPtr request);
 
+  // Returns the operation that loads `uri` asynchronously, which joins the
+  // load already in flight for `uri` if there is one.
+  std::function<StatusOrData()> GetSharedLoadOperation(std::string_view uri);
+
   Registry* registry_ = nullptr;
+  size_t num_worker_threads_ = 1;
   AsyncProcessor<RequestPtr> processor_;
   OpenFnPtr open_fn_ = nullptr;
   int pending_requests_ = 0;
+
+  // The loads that have been scheduled but not read yet, keyed by URI.
+  absl::flat_hash_map<std::string, SharedDataFuture> in_flight_loads_;
+  std::mutex in_flight_mutex_;
 };
 
 }  // namespace redux
@@ -14,9 +14,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <atomic>
+#include <future>
+#include <string>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/functional/bind_front.h"
+#include "absl/strings/str_cat.h"
 #include "redux/modules/base/asset_loader.h"
 #include "redux/modules/base/data_builder.h"
 
@@ -251,5 +257,91 @@ TEST_F(AssetLoaderTest, LoadAsyncBadOnLoad) {
   EXPECT_FALSE(asset.ok());
 }
 
+TEST_F(AssetLoaderTest, LoadAsyncSharesInFlightLoads) {
+  // Block the worker thread until all the loads have been requested.
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::atomic<int> num_opens = 0;
+  asset_loader_->SetOpenFunction([&](std::string_view uri) {
+    released.wait();
+    ++num_opens;
+    auto data = reinterpret_cast<const std::byte*>(uri.data());
+    return AssetLoader::StatusOrReader(
+        DataReader::FromByteSpan({data, uri.size()}));
+  });
+
+  // Any loaded data may be replaced without affecting the shared data.
+  auto on_load = [](AssetLoader::StatusOrData& asset) {
+    asset = FromString("replaced");
+  };
+  auto future1 = asset_loader_->LoadAsync("filename.txt", nullptr, nullptr);
+  auto future2 = asset_loader_->LoadAsync("filename.txt", on_load, nullptr);
+  auto future3 = asset_loader_->LoadAsync("filename.txt", nullptr, nullptr);
+  auto future4 = asset_loader_->LoadAsync("other.txt", nullptr, nullptr);
+  release.set_value();
+
+  while (asset_loader_->FinalizeAll() != 0) {
+  }
+  EXPECT_THAT(num_opens.load(), Eq(2));
+
+  auto asset1 = future1.get();
+  auto asset2 = future2.get();
+  auto asset3 = future3.get();
+  auto asset4 = future4.get();
+  EXPECT_THAT(AsString(asset1.value()), Eq("filename.txt"));
+  EXPECT_THAT(AsString(asset2.value()), Eq("replaced"));
+  EXPECT_THAT(AsString(asset3.value()), Eq("filename.txt"));
+  EXPECT_THAT(AsString(asset4.value()), Eq("other.txt"));
+  EXPECT_THAT(asset1->GetBytes(), Eq(asset3->GetBytes()));
+
+  // Once the load is done, loading the URI again reads it again.
+  auto future5 = asset_loader_->LoadAsync("filename.txt", nullptr, nullptr);
+  while (asset_loader_->FinalizeAll() != 0) {
+  }
+  EXPECT_THAT(AsString(future5.get().value()), Eq("filename.txt"));
+  EXPECT_THAT(num_opens.load(), Eq(3));
+}
+
+TEST_F(AssetLoaderTest, LoadAsyncSharesFailedLoads) {
+  FailOnOpen("Fail");
+
+  asset_loader_->StopAsyncOperations();
+  auto future1 = asset_loader_->LoadAsync("filename.txt", nullptr, nullptr);
+  asset_loader_->StartAsyncOperations();
+  auto future2 = asset_loader_->LoadAsync("filename.txt", nullptr, nullptr);
+  auto future3 = asset_loader_->LoadAsync("filename.txt", nullptr, nullptr);
+
+  while (asset_loader_->FinalizeAll() != 0) {
+  }
+  EXPECT_FALSE(future1.get().ok());
+  EXPECT_FALSE(future2.get().ok());
+  EXPECT_THAT(future3.get().status().message(), Eq("Fail"));
+}
+
+TEST(AssetLoaderWorkersTest, LoadAsyncWithManyWorkers) {
+  Registry registry;
+  AssetLoader asset_loader(&registry, 4);
+  asset_loader.SetOpenFunction([](std::string_view uri) {
+    auto data = reinterpret_cast<const std::byte*>(uri.data());
+    return AssetLoader::StatusOrReader(
+        DataReader::FromByteSpan({data, uri.size()}));
+  });
+
+  // The URIs must outlive the readers that reference them.
+  std::vector<std::string> uris;
+  for (int i = 0; i < 32; ++i) {
+    uris.push_back(absl::StrCat("file", i % 8, ".txt"));
+  }
+  std::vector<std::future<AssetLoader::StatusOrData>> futures;
+  for (const std::string& uri : uris) {
+    futures.push_back(asset_loader.LoadAsync(uri, nullptr, nullptr));
+  }
+  while (asset_loader.FinalizeAll() != 0) {
+  }
+  for (int i = 0; i < 32; ++i) {
+    EXPECT_THAT(AsString(futures[i].get().value()), Eq(uris[i]));
+  }
+}
+
 }  // namespace
 }  // namespace redux
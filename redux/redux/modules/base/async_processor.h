@@ -20,6 +20,7 @@ limitations under the License.
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -16,10 +16,154 @@ limitations under the License.
 
 #include "redux/modules/base/choreographer.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <thread>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
 
 namespace redux {
 
+// Steps the functions in a Schedule on the calling thread and a set of worker
+// threads. A function is started once all its dependencies have completed and
+// no conflicting function is currently running.
+class Choreographer::Scheduler {
+ public:
+  explicit Scheduler(std::size_t num_threads) {
+    for (std::size_t i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this]() { WorkerThread(); });
+    }
+  }
+
+  ~Scheduler() {
+    {
+      absl::MutexLock lock(&mutex_);
+      shutdown_ = true;
+    }
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Run(const Schedule& schedule, Registry* registry, absl::Duration dt,
+           StageSet disabled_stages, bool profile) {
+    {
+      absl::MutexLock lock(&mutex_);
+      schedule_ = &schedule;
+      registry_ = registry;
+      disabled_stages_ = disabled_stages;
+      profile_ = profile;
+      delta_time_ = dt;
+      num_nodes_ = schedule.handlers.size();
+      num_completed_ = 0;
+      remaining_ = schedule.num_dependencies;
+      running_.assign(num_nodes_, false);
+      ready_.clear();
+      for (std::size_t i = 0; i < num_nodes_; ++i) {
+        if (remaining_[i] == 0) {
+          ready_.push_back(i);
+        }
+      }
+      ++generation_;
+    }
+    Work();
+  }
+
+ private:
+  void WorkerThread() {
+    std::size_t generation = 0;
+    while (true) {
+      {
+        absl::MutexLock lock(&mutex_);
+        auto has_new_work = [&]() {
+          return shutdown_ || generation_ != generation;
+        };
+        mutex_.Await(absl::Condition(&has_new_work));
+        if (shutdown_) {
+          return;
+        }
+        generation = generation_;
+      }
+      Work();
+    }
+  }
+
+  // Steps functions until every node in the current schedule has completed.
+  void Work() {
+    mutex_.Lock();
+    while (true) {
+      mutex_.Await(absl::Condition(this, &Scheduler::CanProceed));
+      if (num_completed_ == num_nodes_) {
+        break;
+      }
+
+      const std::size_t pos = FindRunnable();
+      const std::size_t index = ready_[pos];
+      ready_.erase(ready_.begin() + pos);
+
+      HandlerBase* handler = schedule_->handlers[index];
+      if (handler && !IsDisabled(handler)) {
+        running_[index] = true;
+        mutex_.Unlock();
+        handler->TimedStep(registry_, delta_time_, profile_);
+        mutex_.Lock();
+        running_[index] = false;
+      }
+      Complete(index);
+    }
+    mutex_.Unlock();
+  }
+
+  // Returns the position in ready_ of the first node that does not conflict
+  // with any running node, or ready_.size() if there is none.
+  std::size_t FindRunnable() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    for (std::size_t i = 0; i < ready_.size(); ++i) {
+      const auto& conflicts = schedule_->conflicts[ready_[i]];
+      const bool blocked =
+          std::any_of(conflicts.begin(), conflicts.end(),
+                      [this](std::size_t other) { return running_[other]; });
+      if (!blocked) {
+        return i;
+      }
+    }
+    return ready_.size();
+  }
+
+  bool IsDisabled(const HandlerBase* handler) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return disabled_stages_.test(static_cast<std::size_t>(handler->stage));
+  }
+
+  bool CanProceed() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return num_completed_ == num_nodes_ || FindRunnable() < ready_.size();
+  }
+
+  void Complete(std::size_t index) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    ++num_completed_;
+    for (const std::size_t dependent : schedule_->dependents[index]) {
+      if (--remaining_[dependent] == 0) {
+        ready_.push_back(dependent);
+      }
+    }
+  }
+
+  absl::Mutex mutex_;
+  std::vector<std::thread> threads_;
+  const Schedule* schedule_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  Registry* registry_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  absl::Duration delta_time_ ABSL_GUARDED_BY(mutex_);
+  StageSet disabled_stages_ ABSL_GUARDED_BY(mutex_);
+  bool profile_ ABSL_GUARDED_BY(mutex_) = false;
+  std::size_t num_nodes_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::size_t num_completed_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::vector<std::size_t> remaining_ ABSL_GUARDED_BY(mutex_);
+  std::vector<bool> running_ ABSL_GUARDED_BY(mutex_);
+  std::vector<std::size_t> ready_ ABSL_GUARDED_BY(mutex_);
+  std::size_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
 Choreographer::Choreographer(Registry* registry) : registry_(registry) {
   constexpr std::size_t num_stages =
       static_cast<std::size_t>(Stage::kNumStages);
@@ -35,24 +179,166 @@ Choreographer::Choreographer(Registry* registry) : registry_(registry) {
   }
 }
 
+Choreographer::~Choreographer() = default;
+
 void Choreographer::AddDependency(Tag node, Tag dependency) {
   graph_.AddDependency(node, dependency);
+  schedule_dirty_ = true;
+}
+
+void Choreographer::AddAccess(Tag tag, TypeId type, bool write) {
+  Access& access = access_[tag];
+  std::vector<TypeId>& types = write ? access.writes : access.reads;
+  if (std::find(types.begin(), types.end(), type) == types.end()) {
+    types.push_back(type);
+  }
+  schedule_dirty_ = true;
+}
+
+void Choreographer::SetNumWorkerThreads(std::size_t num_threads) {
+  scheduler_.reset();
+#ifndef REDUX_DISABLE_THREADS
+  if (num_threads > 0) {
+    scheduler_ = std::make_unique<Scheduler>(num_threads);
+  }
+#endif
 }
 
 void Choreographer::Step(absl::Duration delta_time) {
+  if (scheduler_) {
+    if (schedule_dirty_) {
+      BuildSchedule();
+    }
+    scheduler_->Run(schedule_, registry_, delta_time, disabled_stages_,
+                    profiling_enabled_);
+    return;
+  }
+
   graph_.Traverse([=](Tag tag) {
+    auto iter = handlers_.find(tag);
+    if (iter != handlers_.end() && IsStageEnabled(iter->second->stage)) {
+      iter->second->TimedStep(registry_, delta_time, profiling_enabled_);
+    }
+  });
+}
+
+void Choreographer::SetProfilingEnabled(bool enabled) {
+  profiling_enabled_ = enabled;
+}
+
+void Choreographer::ForEachStepStats(
+    const std::function<void(const StepStats&)>& fn) const {
+  graph_.Traverse([&](Tag tag) {
     auto iter = handlers_.find(tag);
     if (iter != handlers_.end()) {
-      iter->second->Step(registry_, delta_time);
+      StepStats stats = iter->second->stats;
+      stats.name = iter->second->GetName();
+      fn(stats);
     }
   });
 }
 
+void Choreographer::ResetStepStats() {
+  for (auto& iter : handlers_) {
+    iter.second->stats = StepStats();
+  }
+}
+
+void Choreographer::SetStageEnabled(Stage stage, bool enabled) {
+  CHECK(stage != Stage::kNumStages);
+  disabled_stages_.set(static_cast<std::size_t>(stage), !enabled);
+}
+
+bool Choreographer::IsStageEnabled(Stage stage) const {
+  CHECK(stage != Stage::kNumStages);
+  return !disabled_stages_.test(static_cast<std::size_t>(stage));
+}
+
 void Choreographer::AddToStage(Tag tag, Stage stage) {
   const std::size_t index = static_cast<std::size_t>(stage);
   const std::pair<Tag, Tag> bookends = stage_tags_[index];
   graph_.AddDependency(tag, bookends.first);
   graph_.AddDependency(bookends.second, tag);
+  schedule_dirty_ = true;
+}
+
+bool Choreographer::Conflicts(Tag lhs, Tag rhs) const {
+  auto lhs_iter = access_.find(lhs);
+  auto rhs_iter = access_.find(rhs);
+  if (lhs_iter == access_.end() || rhs_iter == access_.end()) {
+    return true;
+  }
+
+  // Stepping a function always modifies the object it is called on.
+  const TypeId lhs_self = handlers_.find(lhs)->second->GetObjectType();
+  const TypeId rhs_self = handlers_.find(rhs)->second->GetObjectType();
+
+  auto writes = [](const Access& access, TypeId self, TypeId type) {
+    return type == self || std::find(access.writes.begin(), access.writes.end(),
+                                     type) != access.writes.end();
+  };
+  auto touches = [&](const Access& access, TypeId self, TypeId type) {
+    return writes(access, self, type) ||
+           std::find(access.reads.begin(), access.reads.end(), type) !=
+               access.reads.end();
+  };
+  auto any_write_conflict = [&](const Access& w, TypeId w_self,
+                                const Access& other, TypeId other_self) {
+    if (touches(other, other_self, w_self)) {
+      return true;
+    }
+    for (const TypeId type : w.writes) {
+      if (touches(other, other_self, type)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  return any_write_conflict(lhs_iter->second, lhs_self, rhs_iter->second,
+                            rhs_self) ||
+         any_write_conflict(rhs_iter->second, rhs_self, lhs_iter->second,
+                            lhs_self);
+}
+
+void Choreographer::BuildSchedule() {
+  std::vector<Tag> tags;
+  absl::flat_hash_map<Tag, std::size_t> indices;
+  graph_.Traverse([&](Tag tag) {
+    indices[tag] = tags.size();
+    tags.push_back(tag);
+  });
+
+  const std::size_t num_nodes = tags.size();
+  schedule_.handlers.assign(num_nodes, nullptr);
+  schedule_.dependents.assign(num_nodes, {});
+  schedule_.num_dependencies.assign(num_nodes, 0);
+  schedule_.conflicts.assign(num_nodes, {});
+
+  for (std::size_t i = 0; i < num_nodes; ++i) {
+    if (auto iter = handlers_.find(tags[i]); iter != handlers_.end()) {
+      schedule_.handlers[i] = iter->second.get();
+    }
+  }
+
+  graph_.ForAllEdges([&](Tag dependency, Tag node) {
+    const std::size_t src = indices[dependency];
+    const std::size_t dst = indices[node];
+    schedule_.dependents[src].push_back(dst);
+    ++schedule_.num_dependencies[dst];
+  });
+
+  for (std::size_t i = 0; i < num_nodes; ++i) {
+    if (schedule_.handlers[i] == nullptr) {
+      continue;
+    }
+    for (std::size_t j = i + 1; j < num_nodes; ++j) {
+      if (schedule_.handlers[j] && Conflicts(tags[i], tags[j])) {
+        schedule_.conflicts[i].push_back(j);
+        schedule_.conflicts[j].push_back(i);
+      }
+    }
+  }
+  schedule_dirty_ = false;
 }
 
 void Choreographer::Traverse(const std::function<void(std::string_view)>& fn) {
@@ -64,6 +350,22 @@ void Choreographer::Traverse(const std::function<void(std::string_view)>& fn) {
   });
 }
 
+void Choreographer::HandlerBase::TimedStep(Registry* registry,
+                                           absl::Duration dt, bool profile) {
+  if (!profile) {
+    Step(registry, dt);
+    return;
+  }
+
+  const absl::Time start = absl::Now();
+  Step(registry, dt);
+  const absl::Duration time = absl::Now() - start;
+  ++stats.num_steps;
+  stats.last_time = time;
+  stats.total_time += time;
+  stats.max_time = std::max(stats.max_time, time);
+}
+
 std::string_view Choreographer::HandlerBase::PrettyName(std::string_view name) {
   const auto start = name.find("T = &") + 5;
   const auto end = name.find_last_of("]");
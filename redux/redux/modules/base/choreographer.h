@@ -17,6 +17,8 @@ limitations under the License.
 #ifndef REDUX_MODULES_BASE_CHOREOGRAPHER_H_
 #define REDUX_MODULES_BASE_CHOREOGRAPHER_H_
 
+#include <bitset>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <utility>
@@ -47,9 +49,18 @@ namespace redux {
 //
 // More fine-grained ordering can be specified by explicitly registering a
 // function to be called either before or after another function.
+//
+// By default, all functions are stepped serially on the calling thread. Calling
+// SetNumWorkerThreads enables parallel stepping, where functions that have no
+// ordering dependency between them may be stepped concurrently. Only functions
+// that declare the types of data they access (via DependencyBuilder::Reads and
+// DependencyBuilder::Writes) are run alongside other functions, and never at
+// the same time as a function that writes data they read or write. Stages are
+// still stepped strictly in order.
 class Choreographer {
  public:
   explicit Choreographer(Registry* registry);
+  ~Choreographer();
 
   Choreographer(const Choreographer&) = delete;
   Choreographer& operator=(const Choreographer&) = delete;
@@ -78,6 +89,20 @@ class Choreographer {
   // delta_time if applicable.
   void Step(absl::Duration delta_time);
 
+  // Enables or disables stepping the functions registered in `stage`. Disabled
+  // stages are skipped by Step (eg. to skip rendering when nothing on screen
+  // has changed). All stages are enabled by default. Must not be called during
+  // Step.
+  void SetStageEnabled(Stage stage, bool enabled);
+
+  // Returns true if the functions in `stage` will be stepped.
+  bool IsStageEnabled(Stage stage) const;
+
+  // Sets the number of worker threads used to step functions in parallel, in
+  // addition to the thread calling Step. Setting it to 0 (the default) steps
+  // all functions serially. Must not be called during Step.
+  void SetNumWorkerThreads(std::size_t num_threads);
+
   // A proxy class that can be used to provide more fine-grained control over
   // update ordering. An instance of this class is returned by
   // Choreographer::Add after which the Before/After functions can be used
@@ -97,6 +122,16 @@ class Choreographer {
     template <auto Fn>
     DependencyBuilder& After();
 
+    // Declares that the function registered with Add() reads data of type `T`
+    // (eg. a system or component store) when parallel stepping is enabled.
+    template <typename T>
+    DependencyBuilder& Reads();
+
+    // Declares that the function registered with Add() writes data of type `T`
+    // when parallel stepping is enabled.
+    template <typename T>
+    DependencyBuilder& Writes();
+
    private:
     Choreographer* advancer_ = nullptr;
     Tag tag_ = 0;
@@ -113,14 +148,48 @@ class Choreographer {
   // is useful for debugging purposes.
   void Traverse(const std::function<void(std::string_view)>& fn);
 
+  // The time spent stepping a single registered function while profiling is
+  // enabled.
+  struct StepStats {
+    std::string_view name;
+    std::size_t num_steps = 0;
+    absl::Duration last_time;
+    absl::Duration total_time;
+    absl::Duration max_time;
+  };
+
+  // Enables or disables timing every function as it is stepped. Profiling is
+  // disabled by default. Must not be called during Step.
+  void SetProfilingEnabled(bool enabled);
+
+  // Returns true if functions are timed as they are stepped.
+  bool IsProfilingEnabled() const { return profiling_enabled_; }
+
+  // Calls `fn` with the StepStats of every registered function, in step order.
+  // Must not be called during Step.
+  void ForEachStepStats(const std::function<void(const StepStats&)>& fn) const;
+
+  // Clears the StepStats of every registered function. Must not be called
+  // during Step.
+  void ResetStepStats();
+
  private:
   using StepFn = std::function<void(absl::Duration)>;
 
   struct HandlerBase {
     virtual ~HandlerBase() = default;
     virtual std::string_view GetName() const = 0;
+    virtual TypeId GetObjectType() const = 0;
     virtual void Step(Registry* registry, absl::Duration) = 0;
     static std::string_view PrettyName(std::string_view name);
+
+    // Steps the function, recording the time it took in `stats` if `profile`
+    // is true.
+    void TimedStep(Registry* registry, absl::Duration dt, bool profile);
+
+    Stage stage = Stage::kNumStages;
+    // Only written by the thread stepping the function.
+    StepStats stats;
   };
 
   template <auto T>
@@ -135,6 +204,7 @@ class Choreographer {
     std::string_view GetName() const override {
       return PrettyName(__PRETTY_FUNCTION__);
     }
+    TypeId GetObjectType() const override { return redux::GetTypeId<T>(); }
     void Step(Registry* registry, absl::Duration dt) override {
       T* obj = registry->Get<T>();
       if (obj) {
@@ -152,6 +222,7 @@ class Choreographer {
     std::string_view GetName() const override {
       return PrettyName(__PRETTY_FUNCTION__);
     }
+    TypeId GetObjectType() const override { return redux::GetTypeId<T>(); }
     void Step(Registry* registry, absl::Duration dt) override {
       T* obj = registry->Get<T>();
       if (obj) {
@@ -171,19 +242,55 @@ class Choreographer {
     if (auto& h = handlers_[tag]; h == nullptr) {
       graph_.AddNode(tag);
       h = std::make_unique<Handler<Fn>>();
+      h->stage = stage;
       AddToStage(tag, stage);
     }
     return tag;
   }
 
+  // The data declared as accessed by a function. Functions without any
+  // declarations are assumed to access everything.
+  struct Access {
+    std::vector<TypeId> reads;
+    std::vector<TypeId> writes;
+  };
+
+  // The precomputed graph used for parallel stepping. Nodes include the stage
+  // bookends (which have a null handler).
+  struct Schedule {
+    std::vector<HandlerBase*> handlers;
+    std::vector<std::vector<std::size_t>> dependents;
+    std::vector<std::size_t> num_dependencies;
+    std::vector<std::vector<std::size_t>> conflicts;
+  };
+
+  // Runs a Schedule on a pool of worker threads; defined in the .cc file.
+  class Scheduler;
+
+  using StageSet = std::bitset<static_cast<std::size_t>(Stage::kNumStages)>;
+
   void AddDependency(Tag node, Tag dependency);
 
+  void AddAccess(Tag tag, TypeId type, bool write);
+
   void AddToStage(Tag tag, Stage stage);
 
+  // Returns true if the functions with the given tags may not be stepped at
+  // the same time.
+  bool Conflicts(Tag lhs, Tag rhs) const;
+
+  void BuildSchedule();
+
   Registry* registry_;
   DependencyGraph<Tag> graph_;
   absl::flat_hash_map<Tag, std::unique_ptr<HandlerBase>> handlers_;
+  absl::flat_hash_map<Tag, Access> access_;
   std::vector<std::pair<Tag, Tag>> stage_tags_;
+  Schedule schedule_;
+  bool schedule_dirty_ = true;
+  StageSet disabled_stages_;
+  bool profiling_enabled_ = false;
+  std::unique_ptr<Scheduler> scheduler_;
 };
 
 template <auto Fn>
@@ -202,6 +309,22 @@ Choreographer::DependencyBuilder& Choreographer::DependencyBuilder::After() {
   return *this;
 }
 
+template <typename T>
+Choreographer::DependencyBuilder& Choreographer::DependencyBuilder::Reads() {
+  if (advancer_) {
+    advancer_->AddAccess(tag_, redux::GetTypeId<T>(), false);
+  }
+  return *this;
+}
+
+template <typename T>
+Choreographer::DependencyBuilder& Choreographer::DependencyBuilder::Writes() {
+  if (advancer_) {
+    advancer_->AddAccess(tag_, redux::GetTypeId<T>(), true);
+  }
+  return *this;
+}
+
 }  // namespace redux
 
 REDUX_SETUP_TYPEID(redux::Choreographer);
@@ -14,6 +14,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "redux/modules/base/choreographer.h"
@@ -45,10 +49,62 @@ struct TestObjectNoDt {
   Tracker& tracker;
 };
 
+// Tracks how many steppers are running at once.
+struct Overlap {
+  void Enter() {
+    const int count = ++active;
+    int prev = max_active;
+    while (count > prev && !max_active.compare_exchange_weak(prev, count)) {
+    }
+  }
+
+  void Leave() { --active; }
+
+  // Waits (with a timeout) for `count` steppers to be running at once.
+  bool WaitFor(int count) {
+    if (!wait) {
+      return false;
+    }
+    const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (max_active < count && std::chrono::steady_clock::now() < end) {
+      std::this_thread::yield();
+    }
+    return max_active >= count;
+  }
+
+  std::atomic<int> active = 0;
+  std::atomic<int> max_active = 0;
+  bool wait = true;
+};
+
+struct SharedData {};
+
+template <int N>
+struct ParallelObject {
+  explicit ParallelObject(Overlap& overlap) : overlap(overlap) {}
+
+  void Step() {
+    overlap.Enter();
+    saw_overlap = overlap.WaitFor(2);
+    overlap.Leave();
+    ++num_steps;
+  }
+
+  Overlap& overlap;
+  bool saw_overlap = false;
+  int num_steps = 0;
+};
+
+using ParallelObjectA = ParallelObject<0>;
+using ParallelObjectB = ParallelObject<1>;
+
 }  // namespace
 }  // namespace redux
 REDUX_SETUP_TYPEID(redux::TestObject);
 REDUX_SETUP_TYPEID(redux::TestObjectNoDt);
+REDUX_SETUP_TYPEID(redux::SharedData);
+REDUX_SETUP_TYPEID(redux::ParallelObjectA);
+REDUX_SETUP_TYPEID(redux::ParallelObjectB);
 namespace redux {
 namespace {
 
@@ -101,5 +157,187 @@ TEST(ChoreographerTest, After) {
   EXPECT_THAT(tracker.ordered_calls[1], Eq("TestObject::Step"));
 }
 
+TEST(ChoreographerTest, ParallelOrdering) {
+  Tracker tracker;
+  Registry registry;
+  registry.Create<TestObject>(tracker);
+  registry.Create<TestObjectNoDt>(tracker);
+
+  Choreographer choreo(&registry);
+  choreo.SetNumWorkerThreads(4);
+  choreo.Add<&TestObject::Step>(Choreographer::Stage::kPrologue)
+      .Reads<SharedData>()
+      .Before<&TestObjectNoDt::Step>();
+  choreo.Add<&TestObjectNoDt::Step>(Choreographer::Stage::kPrologue)
+      .Reads<SharedData>();
+
+  for (int i = 0; i < 10; ++i) {
+    choreo.Step(absl::ZeroDuration());
+  }
+  EXPECT_THAT(tracker.ordered_calls.size(), Eq(20));
+  for (int i = 0; i < 20; i += 2) {
+    EXPECT_THAT(tracker.ordered_calls[i], Eq("TestObject::Step"));
+    EXPECT_THAT(tracker.ordered_calls[i + 1], Eq("TestObjectNoDt::Step"));
+  }
+}
+
+TEST(ChoreographerTest, ParallelIndependentFunctions) {
+  Overlap overlap;
+  Registry registry;
+  auto* a = registry.Create<ParallelObjectA>(overlap);
+  auto* b = registry.Create<ParallelObjectB>(overlap);
+
+  Choreographer choreo(&registry);
+  choreo.SetNumWorkerThreads(2);
+  choreo.Add<&ParallelObjectA::Step>(Choreographer::Stage::kLogic)
+      .Reads<SharedData>();
+  choreo.Add<&ParallelObjectB::Step>(Choreographer::Stage::kLogic)
+      .Reads<SharedData>();
+
+  choreo.Step(absl::ZeroDuration());
+  EXPECT_THAT(a->num_steps, Eq(1));
+  EXPECT_THAT(b->num_steps, Eq(1));
+  EXPECT_TRUE(a->saw_overlap);
+  EXPECT_TRUE(b->saw_overlap);
+}
+
+TEST(ChoreographerTest, ParallelConflictingWrites) {
+  Overlap overlap;
+  Registry registry;
+  auto* a = registry.Create<ParallelObjectA>(overlap);
+  auto* b = registry.Create<ParallelObjectB>(overlap);
+
+  Choreographer choreo(&registry);
+  choreo.SetNumWorkerThreads(2);
+  choreo.Add<&ParallelObjectA::Step>(Choreographer::Stage::kLogic)
+      .Writes<SharedData>();
+  choreo.Add<&ParallelObjectB::Step>(Choreographer::Stage::kLogic)
+      .Reads<SharedData>();
+
+  overlap.wait = false;  // Skip the wait for an overlap in each Step.
+  choreo.Step(absl::ZeroDuration());
+  EXPECT_THAT(a->num_steps, Eq(1));
+  EXPECT_THAT(b->num_steps, Eq(1));
+  EXPECT_THAT(overlap.max_active, Eq(1));
+}
+
+TEST(ChoreographerTest, ParallelStages) {
+  Overlap overlap;
+  Registry registry;
+  auto* a = registry.Create<ParallelObjectA>(overlap);
+  auto* b = registry.Create<ParallelObjectB>(overlap);
+
+  Choreographer choreo(&registry);
+  choreo.SetNumWorkerThreads(2);
+  choreo.Add<&ParallelObjectA::Step>(Choreographer::Stage::kLogic)
+      .Reads<SharedData>();
+  choreo.Add<&ParallelObjectB::Step>(Choreographer::Stage::kRender)
+      .Reads<SharedData>();
+
+  overlap.wait = false;
+  choreo.Step(absl::ZeroDuration());
+  EXPECT_THAT(a->num_steps, Eq(1));
+  EXPECT_THAT(b->num_steps, Eq(1));
+  EXPECT_THAT(overlap.max_active, Eq(1));
+}
+
+TEST(ChoreographerTest, DisabledStage) {
+  Tracker tracker;
+  Registry registry;
+  registry.Create<TestObject>(tracker);
+  registry.Create<TestObjectNoDt>(tracker);
+
+  Choreographer choreo(&registry);
+  choreo.Add<&TestObject::Step>(Choreographer::Stage::kLogic);
+  choreo.Add<&TestObjectNoDt::Step>(Choreographer::Stage::kRender);
+  EXPECT_TRUE(choreo.IsStageEnabled(Choreographer::Stage::kRender));
+
+  choreo.SetStageEnabled(Choreographer::Stage::kRender, false);
+  EXPECT_FALSE(choreo.IsStageEnabled(Choreographer::Stage::kRender));
+  choreo.Step(absl::ZeroDuration());
+  EXPECT_THAT(tracker.ordered_calls.size(), Eq(1));
+  EXPECT_THAT(tracker.ordered_calls[0], Eq("TestObject::Step"));
+
+  choreo.SetStageEnabled(Choreographer::Stage::kRender, true);
+  choreo.Step(absl::ZeroDuration());
+  EXPECT_THAT(tracker.ordered_calls.size(), Eq(3));
+  EXPECT_THAT(tracker.ordered_calls[2], Eq("TestObjectNoDt::Step"));
+}
+
+TEST(ChoreographerTest, ParallelDisabledStage) {
+  Overlap overlap;
+  Registry registry;
+  auto* a = registry.Create<ParallelObjectA>(overlap);
+  auto* b = registry.Create<ParallelObjectB>(overlap);
+
+  Choreographer choreo(&registry);
+  choreo.SetNumWorkerThreads(2);
+  choreo.Add<&ParallelObjectA::Step>(Choreographer::Stage::kLogic);
+  choreo.Add<&ParallelObjectB::Step>(Choreographer::Stage::kRender);
+  choreo.SetStageEnabled(Choreographer::Stage::kRender, false);
+
+  overlap.wait = false;
+  choreo.Step(absl::ZeroDuration());
+  EXPECT_THAT(a->num_steps, Eq(1));
+  EXPECT_THAT(b->num_steps, Eq(0));
+}
+
+
+TEST(ChoreographerTest, Profiling) {
+  Tracker tracker;
+  Registry registry;
+  registry.Create<TestObject>(tracker);
+  registry.Create<TestObjectNoDt>(tracker);
+
+  Choreographer choreo(&registry);
+  choreo.Add<&TestObject::Step>(Choreographer::Stage::kLogic);
+  choreo.Add<&TestObjectNoDt::Step>(Choreographer::Stage::kRender);
+  EXPECT_FALSE(choreo.IsProfilingEnabled());
+
+  choreo.Step(absl::ZeroDuration());
+  choreo.SetProfilingEnabled(true);
+  choreo.Step(absl::ZeroDuration());
+  choreo.Step(absl::ZeroDuration());
+
+  std::vector<std::string_view> names;
+  choreo.Traverse([&](std::string_view name) { names.push_back(name); });
+
+  std::vector<Choreographer::StepStats> stats;
+  choreo.ForEachStepStats(
+      [&](const Choreographer::StepStats& s) { stats.push_back(s); });
+  ASSERT_THAT(stats.size(), Eq(2));
+  EXPECT_THAT(stats[0].name, Eq(names[0]));
+  EXPECT_THAT(stats[1].name, Eq(names[1]));
+  for (const auto& s : stats) {
+    EXPECT_THAT(s.num_steps, Eq(2));
+    EXPECT_GE(s.max_time, s.last_time);
+    EXPECT_GE(s.total_time, s.max_time);
+  }
+
+  choreo.ResetStepStats();
+  choreo.ForEachStepStats([](const Choreographer::StepStats& s) {
+    EXPECT_THAT(s.num_steps, Eq(0));
+  });
+}
+
+TEST(ChoreographerTest, ParallelProfiling) {
+  Overlap overlap;
+  Registry registry;
+  registry.Create<ParallelObjectA>(overlap);
+  registry.Create<ParallelObjectB>(overlap);
+
+  Choreographer choreo(&registry);
+  choreo.SetNumWorkerThreads(2);
+  choreo.SetProfilingEnabled(true);
+  choreo.Add<&ParallelObjectA::Step>(Choreographer::Stage::kLogic);
+  choreo.Add<&ParallelObjectB::Step>(Choreographer::Stage::kRender);
+
+  overlap.wait = false;
+  choreo.Step(absl::ZeroDuration());
+  choreo.ForEachStepStats([](const Choreographer::StepStats& s) {
+    EXPECT_THAT(s.num_steps, Eq(1));
+  });
+}
+
 }  // namespace
 }  // namespace redux
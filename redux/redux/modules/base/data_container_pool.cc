@@ -0,0 +1,153 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/base/data_container_pool.h"
+
+#include <new>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+
+namespace redux {
+namespace {
+
+// One size class for each power of two from kMinPooledSize to kMaxPooledSize.
+constexpr int kNumSizeClasses = 17;
+static_assert((DataContainerPool::kMinPooledSize << (kNumSizeClasses - 1)) ==
+              DataContainerPool::kMaxPooledSize);
+
+constexpr std::align_val_t kAlignment{DataContainerPool::kMaxAlignment};
+
+struct PoolState {
+  absl::Mutex mutex;
+  std::vector<std::byte*> free_buffers[kNumSizeClasses];
+  DataContainerPool::Stats stats;
+};
+
+// The state is never destroyed so that DataContainers released during static
+// destruction can still return their buffers.
+PoolState* GetState() {
+  static PoolState* state = new PoolState();
+  return state;
+}
+
+int GetSizeClass(std::size_t num_bytes) {
+  int size_class = 0;
+  std::size_t class_size = DataContainerPool::kMinPooledSize;
+  while (class_size < num_bytes) {
+    class_size <<= 1;
+    ++size_class;
+  }
+  return size_class;
+}
+
+std::size_t GetClassSize(int size_class) {
+  return DataContainerPool::kMinPooledSize << size_class;
+}
+
+std::byte* AllocateBuffer(std::size_t num_bytes) {
+  return static_cast<std::byte*>(::operator new(num_bytes, kAlignment));
+}
+
+void FreeBuffer(const std::byte* buffer) {
+  ::operator delete(const_cast<std::byte*>(buffer), kAlignment);
+}
+
+void ReleaseBuffer(const std::byte* buffer, int size_class) {
+  const std::size_t class_size = GetClassSize(size_class);
+
+  PoolState* state = GetState();
+  {
+    absl::MutexLock lock(&state->mutex);
+    --state->stats.num_in_use;
+    if (state->stats.free_bytes + class_size <=
+        DataContainerPool::kMaxFreeBytes) {
+      state->free_buffers[size_class].push_back(
+          const_cast<std::byte*>(buffer));
+      ++state->stats.num_free;
+      state->stats.free_bytes += class_size;
+      return;
+    }
+  }
+  FreeBuffer(buffer);
+}
+
+}  // namespace
+
+DataContainer DataContainerPool::Allocate(std::size_t num_bytes,
+                                          std::size_t alignment) {
+  CHECK(alignment <= kMaxAlignment && (alignment & (alignment - 1)) == 0)
+      << "Unsupported alignment: " << alignment;
+
+  PoolState* state = GetState();
+  if (num_bytes > kMaxPooledSize) {
+    {
+      absl::MutexLock lock(&state->mutex);
+      ++state->stats.num_allocations;
+      ++state->stats.num_unpooled;
+    }
+    return DataContainer(AllocateBuffer(num_bytes), num_bytes, FreeBuffer);
+  }
+
+  const int size_class = GetSizeClass(num_bytes);
+  std::byte* buffer = nullptr;
+  {
+    absl::MutexLock lock(&state->mutex);
+    ++state->stats.num_allocations;
+    ++state->stats.num_in_use;
+    auto& free_buffers = state->free_buffers[size_class];
+    if (!free_buffers.empty()) {
+      buffer = free_buffers.back();
+      free_buffers.pop_back();
+      ++state->stats.num_reused;
+      --state->stats.num_free;
+      state->stats.free_bytes -= GetClassSize(size_class);
+    }
+  }
+  if (buffer == nullptr) {
+    buffer = AllocateBuffer(GetClassSize(size_class));
+  }
+
+  auto deleter = [size_class](const std::byte* mem) {
+    ReleaseBuffer(mem, size_class);
+  };
+  return DataContainer(buffer, num_bytes, std::move(deleter));
+}
+
+DataContainerPool::Stats DataContainerPool::GetStats() {
+  PoolState* state = GetState();
+  absl::MutexLock lock(&state->mutex);
+  return state->stats;
+}
+
+void DataContainerPool::Trim() {
+  std::vector<std::byte*> buffers;
+  PoolState* state = GetState();
+  {
+    absl::MutexLock lock(&state->mutex);
+    for (auto& free_buffers : state->free_buffers) {
+      buffers.insert(buffers.end(), free_buffers.begin(), free_buffers.end());
+      free_buffers.clear();
+    }
+    state->stats.num_free = 0;
+    state->stats.free_bytes = 0;
+  }
+  for (std::byte* buffer : buffers) {
+    FreeBuffer(buffer);
+  }
+}
+
+}  // namespace redux
@@ -0,0 +1,76 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_MODULES_BASE_DATA_CONTAINER_POOL_H_
+#define REDUX_MODULES_BASE_DATA_CONTAINER_POOL_H_
+
+#include <cstddef>
+
+#include "redux/modules/base/data_container.h"
+
+namespace redux {
+
+// A process-wide pool of buffers for DataContainers holding transient data
+// (eg. decoded images and rebuilt meshes) that is allocated and released
+// repeatedly.
+//
+// Buffers are grouped into power-of-two size classes. When a pooled
+// DataContainer is destroyed, its buffer is returned to the pool and reused by
+// the next allocation of the same size class. Allocations larger than
+// `kMaxPooledSize` are not pooled. All functions are thread-safe.
+class DataContainerPool {
+ public:
+  // The smallest and largest buffer sizes that are pooled.
+  static constexpr std::size_t kMinPooledSize = 64;
+  static constexpr std::size_t kMaxPooledSize = 4 * 1024 * 1024;
+
+  // The maximum number of bytes kept in free buffers. Buffers returned while
+  // the pool is full are freed instead.
+  static constexpr std::size_t kMaxFreeBytes = 16 * 1024 * 1024;
+
+  // All buffers are aligned to this many bytes.
+  static constexpr std::size_t kMaxAlignment = 64;
+
+  struct Stats {
+    // The number of calls to `Allocate`.
+    std::size_t num_allocations = 0;
+    // The number of allocations that reused a free pooled buffer.
+    std::size_t num_reused = 0;
+    // The number of allocations that were too large to be pooled.
+    std::size_t num_unpooled = 0;
+    // The number of pooled buffers currently owned by DataContainers.
+    std::size_t num_in_use = 0;
+    // The number and total size of the free buffers held by the pool.
+    std::size_t num_free = 0;
+    std::size_t free_bytes = 0;
+  };
+
+  // Like `DataContainer::Allocate`, but the memory comes from the pool and is
+  // aligned to `alignment` bytes, which must be a power of two no larger than
+  // `kMaxAlignment` (eg. 16 for SIMD data).
+  static DataContainer Allocate(std::size_t num_bytes,
+                                std::size_t alignment = 0);
+
+  // Returns the statistics of the pool.
+  static Stats GetStats();
+
+  // Frees all the free buffers held by the pool.
+  static void Trim();
+};
+
+}  // namespace redux
+
+#endif  // REDUX_MODULES_BASE_DATA_CONTAINER_POOL_H_
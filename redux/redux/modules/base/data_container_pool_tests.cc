@@ -0,0 +1,85 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/base/data_container_pool.h"
+
+#include <cstdint>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Gt;
+
+TEST(DataContainerPoolTest, Allocate) {
+  DataContainerPool::Trim();
+
+  DataContainer data = DataContainerPool::Allocate(100, 16);
+  EXPECT_THAT(data.GetNumBytes(), Eq(100));
+  EXPECT_THAT(reinterpret_cast<std::uintptr_t>(data.GetBytes()) % 16, Eq(0));
+}
+
+TEST(DataContainerPoolTest, ReusesBuffers) {
+  DataContainerPool::Trim();
+  const DataContainerPool::Stats start = DataContainerPool::GetStats();
+
+  const std::byte* bytes = nullptr;
+  {
+    DataContainer data = DataContainerPool::Allocate(1000);
+    bytes = data.GetBytes();
+    EXPECT_THAT(DataContainerPool::GetStats().num_in_use,
+                Eq(start.num_in_use + 1));
+  }
+  DataContainerPool::Stats stats = DataContainerPool::GetStats();
+  EXPECT_THAT(stats.num_in_use, Eq(start.num_in_use));
+  EXPECT_THAT(stats.num_free, Eq(1));
+  EXPECT_THAT(stats.free_bytes, Eq(1024));
+
+  // An allocation of the same size class reuses the returned buffer.
+  DataContainer data = DataContainerPool::Allocate(600, 64);
+  EXPECT_THAT(data.GetBytes(), Eq(bytes));
+  stats = DataContainerPool::GetStats();
+  EXPECT_THAT(stats.num_allocations, Eq(start.num_allocations + 2));
+  EXPECT_THAT(stats.num_reused, Eq(start.num_reused + 1));
+  EXPECT_THAT(stats.num_free, Eq(0));
+}
+
+TEST(DataContainerPoolTest, LargeAllocationsAreNotPooled) {
+  DataContainerPool::Trim();
+  const DataContainerPool::Stats start = DataContainerPool::GetStats();
+  {
+    DataContainer data =
+        DataContainerPool::Allocate(DataContainerPool::kMaxPooledSize + 1);
+    EXPECT_THAT(data.GetNumBytes(), Eq(DataContainerPool::kMaxPooledSize + 1));
+  }
+  const DataContainerPool::Stats stats = DataContainerPool::GetStats();
+  EXPECT_THAT(stats.num_unpooled, Eq(start.num_unpooled + 1));
+  EXPECT_THAT(stats.num_free, Eq(0));
+}
+
+TEST(DataContainerPoolTest, Trim) {
+  { DataContainer data = DataContainerPool::Allocate(10); }
+  EXPECT_THAT(DataContainerPool::GetStats().num_free, Gt(0));
+  DataContainerPool::Trim();
+  EXPECT_THAT(DataContainerPool::GetStats().num_free, Eq(0));
+  EXPECT_THAT(DataContainerPool::GetStats().free_bytes, Eq(0));
+}
+
+}  // namespace
+}  // namespace redux
@@ -17,12 +17,19 @@ limitations under the License.
 #ifndef REDUX_MODULES_BASE_DATA_TABLE_H_
 #define REDUX_MODULES_BASE_DATA_TABLE_H_
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "redux/modules/base/logging.h"
 #include "redux/modules/base/ref_tuple.h"
 
@@ -36,14 +43,72 @@ namespace redux {
 //
 //     struct Scale : DataColumn<vec3, &vec3::One> {};
 //
+// An (optional) alignment can also be provided, in which case the start of
+// each chunk of the column will be aligned to that value. This is useful for
+// running vectorized kernels over the column data. For example:
+//
+//     struct Weight : DataColumn<float, nullptr, 64> {};
+//
 // See DataTable class below for more information.
-template <typename T, T (*Fn)() = nullptr>
+template <typename T, T (*Fn)() = nullptr, std::size_t Alignment = alignof(T)>
 struct DataColumn {
   using Type = T;
 
+  static constexpr std::size_t kAlignment = Alignment;
+  static_assert(kAlignment >= alignof(T), "Alignment too small.");
+  static_assert((kAlignment & (kAlignment - 1)) == 0,
+                "Alignment must be a power-of-two.");
+
   static constexpr Type DefaultValue() { return Fn != nullptr ? Fn() : T{}; }
 };
 
+namespace detail {
+
+// Allocator used to store DataColumn chunks at the column's alignment.
+template <typename T, std::size_t Alignment>
+struct DataColumnAllocator {
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = DataColumnAllocator<U, Alignment>;
+  };
+
+  DataColumnAllocator() = default;
+
+  template <typename U>
+  DataColumnAllocator(const DataColumnAllocator<U, Alignment>&) {}
+
+  T* allocate(std::size_t n) {
+    if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      return static_cast<T*>(
+          ::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+    } else {
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+  }
+
+  void deallocate(T* ptr, std::size_t) {
+    if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(ptr, std::align_val_t{Alignment});
+    } else {
+      ::operator delete(ptr);
+    }
+  }
+
+  template <typename U>
+  bool operator==(const DataColumnAllocator<U, Alignment>&) const {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const DataColumnAllocator<U, Alignment>&) const {
+    return false;
+  }
+};
+
+}  // namespace detail
+
 // An unordered associative container that maps keys to multiple values.
 //
 // The primary reason to use a DataTable over other associative containers (e.g.
@@ -74,6 +139,12 @@ struct DataColumn {
 // Whereas new elements are added to the end of the table, erasing elements is
 // done using the swap-and-pop idiom. This approach is more efficient, but it
 // does mean that no order guarantees are provided (similar to unordered_map).
+//
+// Internally, each column is stored as a sequence of fixed-size chunks, with
+// the n-th chunk of every column holding the data for the same rows. Chunks
+// can be accessed directly as absl::Spans (see GetChunk and ForEachChunk) so
+// that systems can run tight (or vectorized) loops over the column data, or
+// split the work across threads (see ParallelForEachChunk).
 template <typename Key, typename... Fields>
 class DataTable {
  public:
@@ -86,15 +157,28 @@ class DataTable {
   using Row = RefTuple<DefaultBindings, const Key, Fields...>;
   using ConstRow = RefTuple<DefaultBindings, const Key, const Fields...>;
 
+  // The default number of rows stored in each chunk.
+  static constexpr std::size_t kDefaultChunkSize = 32;
+
   // Initializes the internal storage for each column.
   DataTable() { InitImpl(DefaultBindings()); }
 
+  // As above, but with the number of rows stored in each chunk.
+  explicit DataTable(std::size_t chunk_size) : page_capacity_(chunk_size) {
+    CHECK_GT(chunk_size, 0) << "Chunk size must be non-zero.";
+    InitImpl(DefaultBindings());
+  }
+
   // Removes all data from the table.
   void Clear() { ClearImpl(DefaultBindings()); }
 
   // Returns the number of rows in the table.
   std::size_t Size() const { return lookup_.size(); }
 
+  // Reserves storage so that the table can hold `size` rows without growing
+  // its internal lookup or chunk lists.
+  void Reserve(std::size_t size) { ReserveImpl(size, DefaultBindings()); }
+
   // Returns a Row for the given key, creating the row if necessary.
   Row TryEmplace(const KeyType& key) {
     if (auto iter = lookup_.find(key); iter != lookup_.end()) {
@@ -195,13 +279,116 @@ class DataTable {
   // The data is passed individually as parameters, not as as Row/RefTuple.
   template <typename... T, typename Fn>
   void ForEach(const Fn& fn) {
-    const std::size_t last_page = (lookup_.size() / page_capacity_);
-    const std::size_t last_page_count = lookup_.size() % page_capacity_;
-    for (std::size_t page = 0; page <= last_page; ++page) {
-      const std::size_t num =
-          (page == last_page) ? last_page_count : page_capacity_;
-      ForEachInner(fn, num, GetColumnPageData<T>(page)...);
+    const std::size_t num_pages = GetNumChunks();
+    for (std::size_t page = 0; page < num_pages; ++page) {
+      ForEachInner(fn, GetChunkSize(page), GetColumnPageData<T>(page)...);
+    }
+  }
+
+  // Writes the contents of the table to `writer` (eg. a SnapshotWriter) one
+  // chunk at a time as raw bytes. All columns must be trivially copyable.
+  template <typename Writer>
+  void WriteSnapshot(Writer& writer) const {
+    static_assert((std::is_trivially_copyable_v<typename Key::Type> && ... &&
+                   std::is_trivially_copyable_v<typename Fields::Type>),
+                  "DataTable snapshots require trivially copyable columns.");
+    const std::uint64_t size = lookup_.size();
+    writer.Write(&size, sizeof(size));
+    WriteSnapshotImpl(writer, DefaultBindings());
+  }
+
+  // Replaces the contents of the table with data from `reader` (eg. a
+  // SnapshotReader) that was written by WriteSnapshot. Returns false if the
+  // reader did not contain enough data, in which case the table is cleared.
+  template <typename Reader>
+  bool ReadSnapshot(Reader& reader) {
+    Clear();
+    std::uint64_t size = 0;
+    if (!reader.Read(&size, sizeof(size)) || size > reader.GetRemaining() ||
+        !ReadSnapshotImpl(reader, size, DefaultBindings())) {
+      Clear();
+      return false;
+    }
+
+    const auto& keys = GetColumn<0>();
+    lookup_.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      const Index index = GetIndex(i);
+      lookup_.emplace(keys[index], index);
     }
+    return true;
+  }
+
+  // Returns the number of rows stored in each (non-final) chunk.
+  std::size_t GetChunkCapacity() const { return page_capacity_; }
+
+  // Returns the number of chunks used to store the rows in the table.
+  std::size_t GetNumChunks() const {
+    return (lookup_.size() + page_capacity_ - 1) / page_capacity_;
+  }
+
+  // Returns the data for column `T` in the n-th chunk. Rows in the n-th chunk
+  // start at row `n * GetChunkCapacity()` in the table.
+  template <typename T>
+  auto GetChunk(std::size_t n) {
+    CHECK_LT(n, GetNumChunks()) << "Index out of bounds.";
+    return absl::MakeSpan(GetMutableColumnPageData<T>(n), GetChunkSize(n));
+  }
+
+  // Returns the data for column `T` in the n-th chunk.
+  template <typename T>
+  auto GetChunk(std::size_t n) const {
+    CHECK_LT(n, GetNumChunks()) << "Index out of bounds.";
+    return absl::MakeConstSpan(GetColumnPageData<T>(n), GetChunkSize(n));
+  }
+
+  // Iterates over each chunk in the table, invoking the function `fn`. The
+  // arguments passed into the function are absl::Spans over the data of the
+  // columns specified by T... for the chunk. The key column is always const.
+  template <typename... T, typename Fn>
+  void ForEachChunk(const Fn& fn) {
+    ForEachChunkInRange<T...>(fn, 0, GetNumChunks());
+  }
+
+  // As ForEachChunk, but splits the chunks between `num_threads` threads (one
+  // of which is the calling thread). `fn` may be invoked concurrently, but
+  // each invocation receives a disjoint set of rows. Returns once all chunks
+  // have been processed.
+  template <typename... T, typename Fn>
+  void ParallelForEachChunk(std::size_t num_threads, const Fn& fn) {
+    const std::size_t num_chunks = GetNumChunks();
+#ifdef REDUX_DISABLE_THREADS
+    num_threads = 1;
+#endif
+    num_threads = std::min(num_threads, num_chunks);
+    if (num_threads <= 1) {
+      ForEachChunkInRange<T...>(fn, 0, num_chunks);
+      return;
+    }
+
+#ifndef REDUX_DISABLE_THREADS
+    // Give each thread a contiguous range of chunks, with the first
+    // `remainder` threads taking one extra chunk.
+    const std::size_t per_thread = num_chunks / num_threads;
+    const std::size_t remainder = num_chunks % num_threads;
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    std::size_t begin = 0;
+    for (std::size_t i = 0; i < num_threads; ++i) {
+      const std::size_t end = begin + per_thread + (i < remainder ? 1 : 0);
+      if (i + 1 == num_threads) {
+        ForEachChunkInRange<T...>(fn, begin, end);
+      } else {
+        threads.emplace_back([this, &fn, begin, end]() {
+          ForEachChunkInRange<T...>(fn, begin, end);
+        });
+      }
+      begin = end;
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+#endif
   }
 
  private:
@@ -299,11 +486,18 @@ class DataTable {
   class Column {
    public:
     using Type = typename T::Type;
+    static constexpr std::size_t kAlignment = T::kAlignment;
 
     Column() = default;
 
     void Clear() { pages_.clear(); }
 
+    // Reserves enough pages to hold `size` elements. Pages themselves are
+    // allocated (at full capacity) as they are needed.
+    void Reserve(std::size_t size, std::size_t page_capacity) {
+      pages_.reserve((size + page_capacity - 1) / page_capacity);
+    }
+
     template <typename Arg>
     void Add(std::size_t page_capacity, Arg&& arg) {
       if (pages_.empty() || pages_.back().size() == page_capacity) {
@@ -337,6 +531,17 @@ class DataTable {
       }
     }
 
+    // Resizes the column to hold `size` elements in pages of `page_capacity`.
+    // Newly added elements are value-initialized.
+    void Resize(std::size_t size, std::size_t page_capacity) {
+      const std::size_t num_pages = (size + page_capacity - 1) / page_capacity;
+      pages_.resize(num_pages);
+      for (std::size_t i = 0; i < num_pages; ++i) {
+        pages_[i].reserve(page_capacity);
+        pages_[i].resize(std::min(page_capacity, size - i * page_capacity));
+      }
+    }
+
     void Swap(const Index& index0, const Index& index1) {
       auto& a = pages_[index0.page][index0.element];
       auto& b = pages_[index1.page][index1.element];
@@ -375,8 +580,10 @@ class DataTable {
     static_assert(sizeof(bool) == sizeof(std::byte));
     static constexpr bool kIsBool = std::is_same_v<Type, bool>;
     using StorageType = std::conditional_t<kIsBool, std::byte, Type>;
+    using Page = std::vector<
+        StorageType, detail::DataColumnAllocator<StorageType, kAlignment>>;
 
-    std::vector<std::vector<StorageType>> pages_;
+    std::vector<Page> pages_;
   };
 
   Index GetIndex(std::size_t n) const {
@@ -417,6 +624,31 @@ class DataTable {
     return GetColumn<N>().GetPageData(n);
   }
 
+  template <typename Field>
+  auto GetMutableColumnPageData(std::size_t n) {
+    constexpr std::size_t N =
+        IndexOfElementWithin<Field, Key, Fields...>::value;
+    if constexpr (N == 0) {
+      // Always ensure that access to the key column is const.
+      return std::as_const(GetColumn<N>()).GetPageData(n);
+    } else {
+      return GetColumn<N>().GetPageData(n);
+    }
+  }
+
+  // Returns the number of rows in the n-th page.
+  std::size_t GetChunkSize(std::size_t n) const {
+    return std::min(page_capacity_, lookup_.size() - n * page_capacity_);
+  }
+
+  template <typename... T, typename Fn>
+  void ForEachChunkInRange(const Fn& fn, std::size_t begin, std::size_t end) {
+    for (std::size_t page = begin; page < end; ++page) {
+      fn(absl::MakeSpan(GetMutableColumnPageData<T>(page),
+                        GetChunkSize(page))...);
+    }
+  }
+
   template <std::size_t... N>
   void InitImpl(std::index_sequence<N...>) {
     // Initializes each column variant to be of the correct type. For example,
@@ -430,6 +662,12 @@ class DataTable {
     lookup_.clear();
   }
 
+  template <std::size_t... N>
+  void ReserveImpl(std::size_t size, std::index_sequence<N...>) {
+    (GetColumn<N>().Reserve(size, page_capacity_), ...);
+    lookup_.reserve(size);
+  }
+
   template <typename... Args, std::size_t... N>
   Row EmplaceImpl(std::index_sequence<N...>, Args&&... args) {
     (GetColumn<N>().Add(page_capacity_, std::forward<Args>(args)), ...);
@@ -480,6 +718,41 @@ class DataTable {
     (GetColumn<N>().Swap(index0, index1), ...);
   }
 
+  template <typename Writer, std::size_t... N>
+  void WriteSnapshotImpl(Writer& writer, std::index_sequence<N...>) const {
+    (WriteColumnSnapshot<N>(writer), ...);
+  }
+
+  template <std::size_t N, typename Writer>
+  void WriteColumnSnapshot(Writer& writer) const {
+    const auto& column = GetColumn<N>();
+    using Type = typename std::decay_t<decltype(column)>::Type;
+    for (std::size_t page = 0; page < GetNumChunks(); ++page) {
+      writer.Write(column.GetPageData(page), GetChunkSize(page) * sizeof(Type));
+    }
+  }
+
+  template <typename Reader, std::size_t... N>
+  bool ReadSnapshotImpl(Reader& reader, std::size_t size,
+                        std::index_sequence<N...>) {
+    return (ReadColumnSnapshot<N>(reader, size) && ...);
+  }
+
+  template <std::size_t N, typename Reader>
+  bool ReadColumnSnapshot(Reader& reader, std::size_t size) {
+    auto& column = GetColumn<N>();
+    using Type = typename std::decay_t<decltype(column)>::Type;
+    column.Resize(size, page_capacity_);
+    for (std::size_t page = 0; page * page_capacity_ < size; ++page) {
+      const std::size_t count =
+          std::min(page_capacity_, size - page * page_capacity_);
+      if (!reader.Read(column.GetPageData(page), count * sizeof(Type))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   template <typename Fn, typename... T>
   void ForEachInner(const Fn& fn, std::size_t n, T&&... ptrs) {
     for (std::size_t i = 0; i < n; ++i) {
@@ -495,7 +768,7 @@ class DataTable {
 
   ColumnVariant cols_[kNumColumns];
   absl::flat_hash_map<KeyType, Index> lookup_;
-  std::size_t page_capacity_ = 32;
+  std::size_t page_capacity_ = kDefaultChunkSize;
 };
 
 }  // namespace redux
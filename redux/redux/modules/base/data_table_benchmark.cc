@@ -0,0 +1,135 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+#include "redux/modules/base/data_table.h"
+
+// Benchmarks for the common DataTable operations. The number of rows is given
+// by state.range(0). Keys are generated with a fixed LCG so that the access
+// patterns (and therefore the results) are the same between runs.
+
+namespace redux {
+namespace {
+
+struct Key : DataColumn<std::uint32_t> {};
+struct Position : DataColumn<float> {};
+struct Velocity : DataColumn<float> {};
+struct Flags : DataColumn<std::uint32_t> {};
+
+using Table = DataTable<Key, Position, Velocity, Flags>;
+
+// Returns the i-th key of a fixed pseudo-random sequence.
+std::uint32_t MakeKey(std::uint32_t i) { return i * 2654435761u + 1u; }
+
+void Fill(Table* table, int count) {
+  for (int i = 0; i < count; ++i) {
+    table->TryEmplace(MakeKey(i), static_cast<float>(i), 1.f, 0u);
+  }
+}
+
+void BM_DataTableTryEmplace(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    Table table;
+    Fill(&table, count);
+    benchmark::DoNotOptimize(table.Size());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DataTableTryEmplace)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
+void BM_DataTableTryEmplaceReserved(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    Table table;
+    table.Reserve(count);
+    Fill(&table, count);
+    benchmark::DoNotOptimize(table.Size());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DataTableTryEmplaceReserved)
+    ->Arg(1 << 10)
+    ->Arg(1 << 14)
+    ->Arg(1 << 17);
+
+void BM_DataTableFindRow(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  Table table;
+  Fill(&table, count);
+
+  std::uint32_t i = 0;
+  for (auto _ : state) {
+    auto row = table.FindRow(MakeKey(i));
+    benchmark::DoNotOptimize(row.Get<Position>());
+    i = (i + 7919) % count;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DataTableFindRow)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
+void BM_DataTableErase(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    Table table;
+    Fill(&table, count);
+    state.ResumeTiming();
+
+    // Erase every other row, which exercises the swap-and-pop path.
+    for (int i = 0; i < count; i += 2) {
+      table.Erase(MakeKey(i));
+    }
+    benchmark::DoNotOptimize(table.Size());
+  }
+  state.SetItemsProcessed(state.iterations() * (count / 2));
+}
+BENCHMARK(BM_DataTableErase)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
+void BM_DataTableForEach(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  Table table;
+  Fill(&table, count);
+
+  for (auto _ : state) {
+    table.ForEach<Position, Velocity>(
+        [](float& position, float velocity) { position += velocity; });
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DataTableForEach)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
+void BM_DataTableForEachChunk(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  Table table;
+  Fill(&table, count);
+
+  for (auto _ : state) {
+    table.ForEachChunk<Position, Velocity>(
+        [](absl::Span<float> positions, absl::Span<float> velocities) {
+          for (std::size_t i = 0; i < positions.size(); ++i) {
+            positions[i] += velocities[i];
+          }
+        });
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DataTableForEachChunk)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
+}  // namespace
+}  // namespace redux
@@ -14,6 +14,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <cstdint>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "redux/modules/base/data_table.h"
@@ -27,6 +29,7 @@ struct Integer : DataColumn<int> {};
 struct Float : DataColumn<float> {};
 struct Boolean : DataColumn<bool> {};
 struct String : DataColumn<std::string> {};
+struct AlignedFloat : DataColumn<float, nullptr, 64> {};
 
 TEST(DataTable, TryEmplaceDefault) {
   DataTable<Integer, Float, Boolean, String> map;
@@ -172,6 +175,21 @@ TEST(DataTable, Clear) {
   EXPECT_THAT(map.Size(), Eq(0));
 }
 
+TEST(DataTable, Reserve) {
+  DataTable<Integer, Float, Boolean, String> map(4);
+  map.TryEmplace(1);
+  map.Reserve(100);
+  EXPECT_THAT(map.Size(), Eq(1));
+
+  for (int i = 2; i <= 100; ++i) {
+    map.TryEmplace(i);
+  }
+  EXPECT_THAT(map.Size(), Eq(100));
+  EXPECT_THAT(map.GetNumChunks(), Eq(25));
+  EXPECT_TRUE(map.Contains(1));
+  EXPECT_TRUE(map.Contains(100));
+}
+
 TEST(DataTable, Erase) {
   DataTable<Integer, Float, Boolean, String> map;
   map.TryEmplace(1);
@@ -292,6 +310,88 @@ TEST(DataTable, MultiplePages) {
   EXPECT_THAT(map.Size(), Eq(count));
 }
 
+TEST(DataTable, ForEachFullChunks) {
+  DataTable<Integer, Float> map(8);
+  for (int i = 0; i < 16; ++i) {
+    map.TryEmplace(i);
+  }
+
+  int count = 0;
+  map.ForEach<Integer>([&](int value) { ++count; });
+  EXPECT_THAT(count, Eq(16));
+}
+
+TEST(DataTable, GetChunk) {
+  DataTable<Integer, Float> map(8);
+  EXPECT_THAT(map.GetChunkCapacity(), Eq(8));
+  EXPECT_THAT(map.GetNumChunks(), Eq(0));
+
+  for (int i = 0; i < 20; ++i) {
+    map.TryEmplace(i, static_cast<float>(i));
+  }
+  EXPECT_THAT(map.GetNumChunks(), Eq(3));
+
+  auto keys = map.GetChunk<Integer>(2);
+  auto values = map.GetChunk<Float>(2);
+  EXPECT_THAT(keys.size(), Eq(4));
+  EXPECT_THAT(values.size(), Eq(4));
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_THAT(keys[i], Eq(16 + static_cast<int>(i)));
+    values[i] *= 2.f;
+  }
+  EXPECT_THAT(map.FindRow(18).Get<Float>(), Eq(36.f));
+}
+
+TEST(DataTable, ForEachChunk) {
+  DataTable<Integer, Float> map(8);
+  for (int i = 0; i < 20; ++i) {
+    map.TryEmplace(i, static_cast<float>(i));
+  }
+
+  std::size_t count = 0;
+  map.ForEachChunk<Integer, Float>(
+      [&](absl::Span<const int> keys, absl::Span<float> values) {
+        EXPECT_THAT(keys.size(), Eq(values.size()));
+        for (std::size_t i = 0; i < values.size(); ++i) {
+          values[i] += static_cast<float>(keys[i]);
+        }
+        count += keys.size();
+      });
+  EXPECT_THAT(count, Eq(20));
+
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_THAT(map.FindRow(i).Get<Float>(), Eq(2.f * i));
+  }
+}
+
+TEST(DataTable, AlignedChunks) {
+  DataTable<Integer, AlignedFloat> map(16);
+  for (int i = 0; i < 100; ++i) {
+    map.TryEmplace(i);
+  }
+  for (std::size_t n = 0; n < map.GetNumChunks(); ++n) {
+    const auto chunk = map.GetChunk<AlignedFloat>(n);
+    EXPECT_THAT(reinterpret_cast<std::uintptr_t>(chunk.data()) % 64, Eq(0));
+  }
+}
+
+TEST(DataTable, ParallelForEachChunk) {
+  DataTable<Integer, Float> map(8);
+  for (int i = 0; i < 1000; ++i) {
+    map.TryEmplace(i, 1.f);
+  }
+
+  map.ParallelForEachChunk<Float>(4, [](absl::Span<float> values) {
+    for (float& value : values) {
+      value *= 3.f;
+    }
+  });
+
+  float sum = 0.f;
+  map.ForEach<Float>([&](float value) { sum += value; });
+  EXPECT_THAT(sum, Eq(3000.f));
+}
+
 TEST(RefTuple, StructuredBindingsOutOfOrder) {
   DataTable<Integer, Float, Boolean, String> map;
   map.TryEmplace(1, 2.f, true, "hello");
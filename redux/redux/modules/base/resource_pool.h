@@ -0,0 +1,218 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_MODULES_BASE_RESOURCE_POOL_H_
+#define REDUX_MODULES_BASE_RESOURCE_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "redux/modules/base/hash.h"
+#include "redux/modules/base/logging.h"
+
+namespace redux {
+
+// Recycles interchangeable objects (eg. transient GPU textures) that are
+// expensive to create and destroy.
+//
+// Objects are grouped by a HashValue key that identifies everything that makes
+// two objects interchangeable (eg. size and format). Acquire returns a pooled
+// object with a matching key if there is one, otherwise it creates a new one.
+// When the last reference to an acquired object is dropped, the object goes
+// back to the pool. It only becomes available for reuse `release_delay_frames`
+// calls to AdvanceFrame later, so that work still in flight (eg. on the GPU)
+// can finish with it first. Pooled objects that have not been reused for
+// `max_idle_frames` frames are destroyed.
+//
+// Objects may be released from any thread.
+template <typename T>
+class ResourcePool {
+ public:
+  using ObjectPtr = std::shared_ptr<T>;
+  using CreateFn = std::function<ObjectPtr()>;
+
+  struct Stats {
+    // Number of calls to Acquire that reused a pooled object.
+    std::size_t num_hits = 0;
+    // Number of calls to Acquire that created a new object.
+    std::size_t num_misses = 0;
+    // Number (and size) of acquired objects that are still referenced.
+    std::size_t num_in_use = 0;
+    std::size_t bytes_in_use = 0;
+    // Number (and size) of objects held by the pool for reuse.
+    std::size_t num_pooled = 0;
+    std::size_t bytes_pooled = 0;
+
+    // Returns the fraction of calls to Acquire that reused an object.
+    double HitRate() const {
+      const std::size_t total = num_hits + num_misses;
+      return total ? static_cast<double>(num_hits) / total : 0.0;
+    }
+  };
+
+  explicit ResourcePool(int release_delay_frames = 3, int max_idle_frames = 120)
+      : state_(std::make_shared<State>()) {
+    CHECK_GE(release_delay_frames, 0);
+    CHECK_GE(max_idle_frames, 0);
+    state_->release_delay_frames = release_delay_frames;
+    state_->max_idle_frames = max_idle_frames;
+  }
+
+  ResourcePool(const ResourcePool&) = delete;
+  ResourcePool& operator=(const ResourcePool&) = delete;
+
+  // Returns an object associated with `key`, reusing a pooled object if one is
+  // available, or else calling `create`. `num_bytes` is the (approximate)
+  // memory held by the object and is only used for reporting.
+  ObjectPtr Acquire(HashValue key, std::size_t num_bytes,
+                    const CreateFn& create) {
+    ObjectPtr obj;
+    {
+      absl::MutexLock lock(&state_->mutex);
+      auto iter = state_->available.find(key);
+      if (iter != state_->available.end() && !iter->second.empty()) {
+        Entry& entry = iter->second.back();
+        obj = std::move(entry.obj);
+        num_bytes = entry.num_bytes;
+        iter->second.pop_back();
+        ++state_->stats.num_hits;
+        --state_->stats.num_pooled;
+        state_->stats.bytes_pooled -= num_bytes;
+      } else {
+        ++state_->stats.num_misses;
+      }
+      ++state_->stats.num_in_use;
+      state_->stats.bytes_in_use += num_bytes;
+    }
+
+    if (obj == nullptr) {
+      obj = create();
+      CHECK(obj);
+    }
+
+    // Hand out an alias of the object whose "deleter" returns the object to the
+    // pool (or simply destroys it if the pool is gone).
+    std::weak_ptr<State> weak_state = state_;
+    T* ptr = obj.get();
+    return ObjectPtr(ptr, [weak_state, key, num_bytes,
+                           obj = std::move(obj)](T*) mutable {
+      if (auto state = weak_state.lock()) {
+        absl::MutexLock lock(&state->mutex);
+        --state->stats.num_in_use;
+        state->stats.bytes_in_use -= num_bytes;
+        ++state->stats.num_pooled;
+        state->stats.bytes_pooled += num_bytes;
+        state->pending.push_back({key, Entry{std::move(obj), num_bytes,
+                                             state->frame}});
+      }
+    });
+  }
+
+  // Makes objects released at least `release_delay_frames` ago available for
+  // reuse and destroys objects that have been idle for too long.
+  void AdvanceFrame() {
+    std::vector<ObjectPtr> expired;
+    {
+      absl::MutexLock lock(&state_->mutex);
+      const std::uint64_t frame = ++state_->frame;
+
+      // Evict idle objects before adding newly available ones.
+      for (auto& iter : state_->available) {
+        std::vector<Entry>& entries = iter.second;
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+          if (frame - entries[i].frame > state_->max_idle_frames) {
+            --state_->stats.num_pooled;
+            state_->stats.bytes_pooled -= entries[i].num_bytes;
+            expired.push_back(std::move(entries[i].obj));
+          } else if (kept++ != i) {
+            entries[kept - 1] = std::move(entries[i]);
+          }
+        }
+        entries.erase(entries.begin() + kept, entries.end());
+      }
+
+      auto& pending = state_->pending;
+      std::size_t kept = 0;
+      for (std::size_t i = 0; i < pending.size(); ++i) {
+        auto& [key, entry] = pending[i];
+        if (frame - entry.frame >= state_->release_delay_frames) {
+          entry.frame = frame;
+          state_->available[key].push_back(std::move(entry));
+        } else if (kept++ != i) {
+          pending[kept - 1] = std::move(pending[i]);
+        }
+      }
+      pending.erase(pending.begin() + kept, pending.end());
+    }
+    // `expired` objects are destroyed here, outside the lock.
+  }
+
+  // Destroys all objects available for reuse. Objects still in use, or waiting
+  // out their release delay, are unaffected.
+  void Clear() {
+    absl::flat_hash_map<HashValue, std::vector<Entry>> available;
+    {
+      absl::MutexLock lock(&state_->mutex);
+      for (const auto& iter : state_->available) {
+        for (const Entry& entry : iter.second) {
+          --state_->stats.num_pooled;
+          state_->stats.bytes_pooled -= entry.num_bytes;
+        }
+      }
+      available.swap(state_->available);
+    }
+  }
+
+  // Returns statistics about the usage of the pool.
+  Stats GetStats() const {
+    absl::MutexLock lock(&state_->mutex);
+    return state_->stats;
+  }
+
+ private:
+  struct Entry {
+    ObjectPtr obj;
+    std::size_t num_bytes = 0;
+    // The frame in which the object was released or became available.
+    std::uint64_t frame = 0;
+  };
+
+  // Kept in a shared_ptr so that objects released after the pool is destroyed
+  // do not access a dangling pool.
+  struct State {
+    absl::Mutex mutex;
+    std::uint64_t frame ABSL_GUARDED_BY(mutex) = 0;
+    std::uint64_t release_delay_frames = 0;
+    std::uint64_t max_idle_frames = 0;
+    std::vector<std::pair<HashValue, Entry>> pending ABSL_GUARDED_BY(mutex);
+    absl::flat_hash_map<HashValue, std::vector<Entry>> available
+        ABSL_GUARDED_BY(mutex);
+    Stats stats ABSL_GUARDED_BY(mutex);
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_MODULES_BASE_RESOURCE_POOL_H_
@@ -0,0 +1,124 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/base/resource_pool.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace redux {
+namespace {
+
+using ::testing::DoubleEq;
+using ::testing::Eq;
+using ::testing::Ne;
+
+struct TestResource {
+  explicit TestResource(int value) : value(value) {}
+  int value;
+};
+
+using TestPool = ResourcePool<TestResource>;
+
+TestPool::CreateFn MakeResource(int value, int* num_created = nullptr) {
+  return [=]() {
+    if (num_created) {
+      ++*num_created;
+    }
+    return std::make_shared<TestResource>(value);
+  };
+}
+
+TEST(ResourcePoolTest, CreatesWhenEmpty) {
+  TestPool pool;
+  auto res = pool.Acquire(HashValue(1), 100, MakeResource(123));
+  EXPECT_THAT(res->value, Eq(123));
+
+  const TestPool::Stats stats = pool.GetStats();
+  EXPECT_THAT(stats.num_misses, Eq(1));
+  EXPECT_THAT(stats.num_hits, Eq(0));
+  EXPECT_THAT(stats.num_in_use, Eq(1));
+  EXPECT_THAT(stats.bytes_in_use, Eq(100));
+}
+
+TEST(ResourcePoolTest, ReusesAfterDelay) {
+  TestPool pool(2);
+  int num_created = 0;
+  const TestResource* first =
+      pool.Acquire(HashValue(1), 100, MakeResource(1, &num_created)).get();
+  EXPECT_THAT(pool.GetStats().num_pooled, Eq(1));
+  EXPECT_THAT(pool.GetStats().bytes_pooled, Eq(100));
+
+  // Not yet reusable; a new object is created instead.
+  pool.AdvanceFrame();
+  auto second = pool.Acquire(HashValue(1), 100, MakeResource(2, &num_created));
+  EXPECT_THAT(second.get(), Ne(first));
+  EXPECT_THAT(num_created, Eq(2));
+
+  pool.AdvanceFrame();
+  auto third = pool.Acquire(HashValue(1), 100, MakeResource(3, &num_created));
+  EXPECT_THAT(third.get(), Eq(first));
+  EXPECT_THAT(third->value, Eq(1));
+  EXPECT_THAT(num_created, Eq(2));
+  EXPECT_THAT(pool.GetStats().HitRate(), DoubleEq(1.0 / 3.0));
+}
+
+TEST(ResourcePoolTest, KeysAreNotInterchangeable) {
+  TestPool pool(0);
+  pool.Acquire(HashValue(1), 100, MakeResource(1));
+  pool.AdvanceFrame();
+
+  auto res = pool.Acquire(HashValue(2), 100, MakeResource(2));
+  EXPECT_THAT(res->value, Eq(2));
+  res = pool.Acquire(HashValue(1), 100, MakeResource(3));
+  EXPECT_THAT(res->value, Eq(1));
+}
+
+TEST(ResourcePoolTest, EvictsIdleObjects) {
+  TestPool pool(0, 2);
+  pool.Acquire(HashValue(1), 100, MakeResource(1));
+  pool.AdvanceFrame();
+  pool.AdvanceFrame();
+  pool.AdvanceFrame();
+  EXPECT_THAT(pool.GetStats().num_pooled, Eq(1));
+  pool.AdvanceFrame();
+  EXPECT_THAT(pool.GetStats().num_pooled, Eq(0));
+  EXPECT_THAT(pool.GetStats().bytes_pooled, Eq(0));
+}
+
+TEST(ResourcePoolTest, Clear) {
+  TestPool pool(0);
+  pool.Acquire(HashValue(1), 100, MakeResource(1));
+  pool.AdvanceFrame();
+  pool.Clear();
+  EXPECT_THAT(pool.GetStats().num_pooled, Eq(0));
+
+  auto res = pool.Acquire(HashValue(1), 100, MakeResource(2));
+  EXPECT_THAT(res->value, Eq(2));
+}
+
+TEST(ResourcePoolTest, OutlivesPool) {
+  TestPool::ObjectPtr res;
+  {
+    TestPool pool;
+    res = pool.Acquire(HashValue(1), 100, MakeResource(1));
+  }
+  EXPECT_THAT(res->value, Eq(1));
+  res.reset();
+}
+
+}  // namespace
+}  // namespace redux
@@ -0,0 +1,225 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_MODULES_BASE_SNAPSHOT_H_
+#define REDUX_MODULES_BASE_SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "redux/modules/base/data_container.h"
+#include "redux/modules/base/hash.h"
+#include "redux/modules/base/logging.h"
+#include "redux/modules/base/serialize.h"
+#include "redux/modules/base/serialize_traits.h"
+
+namespace redux {
+
+// Serializer that writes values into a single contiguous binary image.
+//
+// Values are written in the order in which they are visited with no keys or
+// type information, so the image can only be read back by a SnapshotReader
+// visiting the same values in the same order (ie. the same build of the same
+// code). Trivially copyable values (and vectors of them) are copied as raw
+// bytes, which makes saving and restoring large blocks of component data
+// little more than a memcpy.
+//
+// Example:
+//   SnapshotWriter writer;
+//   Serialize(writer, obj);
+//   DataContainer image = writer.Release();
+class SnapshotWriter {
+ public:
+  SnapshotWriter() = default;
+
+  SnapshotWriter(const SnapshotWriter&) = delete;
+  SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+  // Appends `num_bytes` from `data` to the image.
+  void Write(const void* data, std::size_t num_bytes) {
+    const auto* bytes = static_cast<const std::byte*>(data);
+    data_.insert(data_.end(), bytes, bytes + num_bytes);
+  }
+
+  // Reserves space for a uint64_t to be filled in later by Patch.  Returns the
+  // offset of the reserved space.
+  std::size_t Reserve() {
+    const std::size_t offset = data_.size();
+    data_.resize(offset + sizeof(std::uint64_t));
+    return offset;
+  }
+
+  // Writes `value` into the space previously reserved at `offset`.
+  void Patch(std::size_t offset, std::uint64_t value) {
+    CHECK_LE(offset + sizeof(value), data_.size());
+    std::memcpy(data_.data() + offset, &value, sizeof(value));
+  }
+
+  template <typename T>
+  void operator()(T& value, HashValue key) {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, std::string>) {
+      const std::uint64_t size = value.size();
+      Write(&size, sizeof(size));
+      Write(value.data(), value.size());
+    } else if constexpr (IsVectorV<U>) {
+      using Element = typename U::value_type;
+      const std::uint64_t size = value.size();
+      Write(&size, sizeof(size));
+      if constexpr (std::is_same_v<Element, bool>) {
+        for (const bool element : value) {
+          const std::uint8_t byte = element ? 1 : 0;
+          Write(&byte, sizeof(byte));
+        }
+      } else if constexpr (std::is_trivially_copyable_v<Element>) {
+        Write(value.data(), value.size() * sizeof(Element));
+      } else {
+        for (auto& element : value) {
+          Serialize(*this, element, key);
+        }
+      }
+    } else {
+      static_assert(std::is_trivially_copyable_v<U> && !IsPointerV<U>,
+                    "Type cannot be written to a snapshot.");
+      Write(&value, sizeof(value));
+    }
+  }
+
+  // Indicates that calls to operator() will not modify the `value` argument.
+  constexpr bool IsDestructive() const { return false; }
+
+  // Returns the number of bytes written so far.
+  std::size_t GetSize() const { return data_.size(); }
+
+  // Returns a DataContainer holding the image, resetting this writer.
+  DataContainer Release() {
+    if (data_.empty()) {
+      return DataContainer();
+    }
+    auto* bytes = new std::vector<std::byte>(std::move(data_));
+    data_.clear();
+    return DataContainer(bytes->data(), bytes->size(),
+                         [bytes](const std::byte*) { delete bytes; });
+  }
+
+ private:
+  std::vector<std::byte> data_;
+};
+
+// Serializer that reads values from a binary image created by SnapshotWriter.
+//
+// Reading past the end of the image puts the reader into an error state (see
+// IsOk) in which all further reads are ignored.
+class SnapshotReader {
+ public:
+  explicit SnapshotReader(absl::Span<const std::byte> data) : data_(data) {}
+
+  SnapshotReader(const SnapshotReader&) = delete;
+  SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+  // Copies the next `num_bytes` of the image into `data`.  Returns false if
+  // there are not enough bytes remaining.
+  bool Read(void* data, std::size_t num_bytes) {
+    if (!ok_ || num_bytes > data_.size() - offset_) {
+      ok_ = false;
+      return false;
+    }
+    std::memcpy(data, data_.data() + offset_, num_bytes);
+    offset_ += num_bytes;
+    return true;
+  }
+
+  // Returns a view of the next `num_bytes` of the image and skips over them, or
+  // an empty span if there are not enough bytes remaining.
+  absl::Span<const std::byte> ReadSpan(std::size_t num_bytes) {
+    if (!ok_ || num_bytes > data_.size() - offset_) {
+      ok_ = false;
+      return {};
+    }
+    absl::Span<const std::byte> span = data_.subspan(offset_, num_bytes);
+    offset_ += num_bytes;
+    return span;
+  }
+
+  template <typename T>
+  void operator()(T& value, HashValue key) {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, std::string>) {
+      const absl::Span<const std::byte> bytes = ReadSpan(ReadSize());
+      value.assign(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    } else if constexpr (IsVectorV<U>) {
+      using Element = typename U::value_type;
+      const std::uint64_t size = ReadSize();
+      if constexpr (std::is_same_v<Element, bool>) {
+        const absl::Span<const std::byte> bytes = ReadSpan(size);
+        value.resize(bytes.size());
+        for (std::size_t i = 0; i < bytes.size(); ++i) {
+          value[i] = bytes[i] != std::byte{0};
+        }
+      } else if constexpr (std::is_trivially_copyable_v<Element>) {
+        const absl::Span<const std::byte> bytes =
+            ReadSpan(size * sizeof(Element));
+        value.resize(bytes.size() / sizeof(Element));
+        std::memcpy(value.data(), bytes.data(), bytes.size());
+      } else {
+        value.clear();
+        for (std::uint64_t i = 0; i < size && ok_; ++i) {
+          Element element{};
+          Serialize(*this, element, key);
+          value.emplace_back(std::move(element));
+        }
+      }
+    } else {
+      static_assert(std::is_trivially_copyable_v<U> && !IsPointerV<U>,
+                    "Type cannot be read from a snapshot.");
+      Read(&value, sizeof(value));
+    }
+  }
+
+  // Indicates that calls to operator() will overwrite the `value` argument.
+  constexpr bool IsDestructive() const { return true; }
+
+  // Returns false if an attempt was made to read past the end of the image.
+  bool IsOk() const { return ok_; }
+
+  // Returns the number of bytes that have not yet been read.
+  std::size_t GetRemaining() const { return data_.size() - offset_; }
+
+ private:
+  std::uint64_t ReadSize() {
+    std::uint64_t size = 0;
+    Read(&size, sizeof(size));
+    // Guard against corrupt sizes before they are used to allocate memory.
+    if (size > GetRemaining()) {
+      ok_ = false;
+      return 0;
+    }
+    return size;
+  }
+
+  absl::Span<const std::byte> data_;
+  std::size_t offset_ = 0;
+  bool ok_ = true;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_MODULES_BASE_SNAPSHOT_H_
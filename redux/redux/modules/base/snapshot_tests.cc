@@ -0,0 +1,163 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/base/snapshot.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/base/data_table.h"
+#include "redux/modules/base/hash.h"
+#include "redux/modules/base/serialize.h"
+
+namespace redux {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+struct Inner {
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(name, ConstHash("name"));
+    archive(values, ConstHash("values"));
+  }
+
+  std::string name;
+  std::vector<int> values;
+};
+
+struct Outer {
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(int_value, ConstHash("int_value"));
+    archive(float_value, ConstHash("float_value"));
+    archive(flags, ConstHash("flags"));
+    archive(inners, ConstHash("inners"));
+  }
+
+  int int_value = 0;
+  float float_value = 0.f;
+  std::vector<bool> flags;
+  std::vector<Inner> inners;
+};
+
+TEST(Snapshot, RoundTrip) {
+  Outer in;
+  in.int_value = 123;
+  in.float_value = 4.5f;
+  in.flags = {true, false, true};
+  in.inners.push_back({"hello", {1, 2, 3}});
+  in.inners.push_back({"world", {}});
+
+  SnapshotWriter writer;
+  Serialize(writer, in);
+  const DataContainer data = writer.Release();
+
+  Outer out;
+  SnapshotReader reader(data.GetByteSpan());
+  Serialize(reader, out);
+  EXPECT_TRUE(reader.IsOk());
+  EXPECT_THAT(reader.GetRemaining(), Eq(0));
+  EXPECT_THAT(out.int_value, Eq(123));
+  EXPECT_THAT(out.float_value, Eq(4.5f));
+  EXPECT_THAT(out.flags, ElementsAre(true, false, true));
+  ASSERT_THAT(out.inners.size(), Eq(2));
+  EXPECT_THAT(out.inners[0].name, Eq("hello"));
+  EXPECT_THAT(out.inners[0].values, ElementsAre(1, 2, 3));
+  EXPECT_THAT(out.inners[1].name, Eq("world"));
+  EXPECT_TRUE(out.inners[1].values.empty());
+}
+
+TEST(Snapshot, Truncated) {
+  Outer in;
+  in.inners.push_back({"hello", {1, 2, 3}});
+
+  SnapshotWriter writer;
+  Serialize(writer, in);
+  const DataContainer data = writer.Release();
+
+  Outer out;
+  SnapshotReader reader(data.GetByteSpan().subspan(0, data.GetNumBytes() - 1));
+  Serialize(reader, out);
+  EXPECT_FALSE(reader.IsOk());
+}
+
+TEST(Snapshot, Patch) {
+  SnapshotWriter writer;
+  const std::size_t offset = writer.Reserve();
+  int value = 42;
+  writer(value, ConstHash("value"));
+  writer.Patch(offset, sizeof(value));
+  const DataContainer data = writer.Release();
+
+  SnapshotReader reader(data.GetByteSpan());
+  std::uint64_t size = 0;
+  reader(size, ConstHash("size"));
+  EXPECT_THAT(size, Eq(sizeof(int)));
+  reader(value, ConstHash("value"));
+  EXPECT_THAT(value, Eq(42));
+}
+
+struct Integer : DataColumn<int> {};
+struct Float : DataColumn<float> {};
+struct Boolean : DataColumn<bool> {};
+
+TEST(Snapshot, DataTable) {
+  using Table = DataTable<Integer, Float, Boolean>;
+  Table in(4);
+  for (int i = 0; i < 10; ++i) {
+    in.TryEmplace(i, i * 0.5f, i % 2 == 0);
+  }
+
+  SnapshotWriter writer;
+  in.WriteSnapshot(writer);
+  const DataContainer data = writer.Release();
+
+  Table out(4);
+  out.TryEmplace(100);
+  SnapshotReader reader(data.GetByteSpan());
+  EXPECT_TRUE(out.ReadSnapshot(reader));
+  EXPECT_THAT(out.Size(), Eq(10));
+  EXPECT_FALSE(out.Contains(100));
+  for (int i = 0; i < 10; ++i) {
+    auto row = out.FindRow(i);
+    ASSERT_TRUE(row);
+    EXPECT_THAT(row.Get<Float>(), Eq(i * 0.5f));
+    EXPECT_THAT(row.Get<Boolean>(), Eq(i % 2 == 0));
+  }
+}
+
+TEST(Snapshot, DataTableTruncated) {
+  using Table = DataTable<Integer, Float>;
+  Table in;
+  in.TryEmplace(1, 2.f);
+
+  SnapshotWriter writer;
+  in.WriteSnapshot(writer);
+  const DataContainer data = writer.Release();
+
+  Table out;
+  SnapshotReader reader(data.GetByteSpan().subspan(0, data.GetNumBytes() - 1));
+  EXPECT_FALSE(out.ReadSnapshot(reader));
+  EXPECT_THAT(out.Size(), Eq(0));
+}
+
+}  // namespace
+}  // namespace redux
@@ -18,23 +18,11 @@ limitations under the License.
 
 #include <cstdlib>
 
+#include "redux/modules/graphics/image_utils.h"
 #include "stb_image.h"
 
 namespace redux {
 
-static void MultiplyRgbByAlpha(uint8_t* data, const vec2i& size) {
-  const int num_pixels = size.x * size.y;
-  for (int i = 0; i < num_pixels; ++i, data += 4) {
-    const auto alpha = static_cast<uint16_t>(data[3]);
-    data[0] =
-        static_cast<uint8_t>((static_cast<uint16_t>(data[0]) * alpha) / 255);
-    data[1] =
-        static_cast<uint8_t>((static_cast<uint16_t>(data[1]) * alpha) / 255);
-    data[2] =
-        static_cast<uint8_t>((static_cast<uint16_t>(data[2]) * alpha) / 255);
-  }
-}
-
 ImageData DecodeStb(const DataContainer& data, const DecodeStbOptions& opts) {
   int width = 0;
   int height = 0;
@@ -16,12 +16,34 @@ limitations under the License.
 
 #include "redux/modules/codecs/encode_png.h"
 
-#include "redux/modules/base/data_builder.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "redux/modules/base/logging.h"
 #include "redux/modules/graphics/image_utils.h"
-#include "png.h"
+#include "zlib.h"
 
 namespace redux {
 
+static constexpr uint8_t kPngSignature[] = {0x89, 'P',  'N',  'G',
+                                            '\r', '\n', 0x1a, '\n'};
+
+// A zlib stream header for a deflate stream with a 32K window.
+static constexpr uint8_t kZlibHeader[] = {0x78, 0x9c};
+
+// Strips with fewer rows than this are not worth a thread of their own.
+static constexpr int kMinRowsPerStrip = 16;
+
+// The amount by which the compressed output of a strip is grown.
+static constexpr size_t kOutputChunkSize = 64 * 1024;
+
 static int ImageDataFormatToComponentCount(ImageFormat format) {
   switch (format) {
     case ImageFormat::Luminance8:
@@ -40,64 +62,300 @@ static int ImageDataFormatToComponentCount(ImageFormat format) {
 static int ImageDataFormatToPngColorType(ImageFormat format) {
   switch (format) {
     case ImageFormat::Luminance8:
-      return PNG_COLOR_TYPE_GRAY;
+      return 0;
     case ImageFormat::LuminanceAlpha88:
-      return PNG_COLOR_TYPE_GRAY_ALPHA;
+      return 4;
     case ImageFormat::Rgb888:
-      return PNG_COLOR_TYPE_RGB;
+      return 2;
     case ImageFormat::Rgba8888:
-      return PNG_COLOR_TYPE_RGB_ALPHA;
+      return 6;
     default:
       LOG(FATAL) << "Unsupported format";
   }
 }
 
-static void PngWriteFn(png_structp png_ptr, png_bytep data, png_size_t length) {
-  auto byte_array = static_cast<std::vector<uint8_t>*>(png_get_io_ptr(png_ptr));
-  const size_t offset = byte_array->size();
-  byte_array->resize(offset + length);
-  memcpy(byte_array->data() + offset, data, length);
+static void WriteBigEndian32(uint32_t value, uint8_t* dst) {
+  dst[0] = static_cast<uint8_t>(value >> 24);
+  dst[1] = static_cast<uint8_t>(value >> 16);
+  dst[2] = static_cast<uint8_t>(value >> 8);
+  dst[3] = static_cast<uint8_t>(value);
 }
 
-static void PngFlushFn(png_structp png_ptr) {}
+static void Emit(const EncodeSinkFn& sink, absl::Span<const uint8_t> bytes) {
+  if (!bytes.empty()) {
+    sink(absl::MakeConstSpan(reinterpret_cast<const std::byte*>(bytes.data()),
+                             bytes.size()));
+  }
+}
 
-DataContainer EncodePng(const ImageData& src) {
-  std::vector<uint8_t> encoded_png;
+// Writes a PNG chunk of the given `type` whose data is the concatenation of
+// `parts`.
+static void WriteChunk(const EncodeSinkFn& sink, const char* type,
+                       std::initializer_list<absl::Span<const uint8_t>> parts) {
+  size_t size = 0;
+  for (const auto& part : parts) {
+    size += part.size();
+  }
 
-  // Create basic png struct.
-  png_structp png =
-      png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-  png_infop png_info = nullptr;
-  png_set_write_fn(png, &encoded_png, &PngWriteFn, &PngFlushFn);
+  uint8_t header[8];
+  WriteBigEndian32(static_cast<uint32_t>(size), header);
+  std::memcpy(header + 4, type, 4);
+  uLong crc = crc32(0L, header + 4, 4);
+  for (const auto& part : parts) {
+    // Note that crc32() resets the checksum when passed a null buffer.
+    if (!part.empty()) {
+      crc = crc32(crc, part.data(), static_cast<uInt>(part.size()));
+    }
+  }
+  uint8_t trailer[4];
+  WriteBigEndian32(static_cast<uint32_t>(crc), trailer);
 
-  // Set and write png header.
-  if (png != nullptr) {
-    png_info = png_create_info_struct(png);
+  Emit(sink, header);
+  for (const auto& part : parts) {
+    Emit(sink, part);
   }
+  Emit(sink, trailer);
+}
+
+static int PaethPredictor(int a, int b, int c) {
+  const int p = a + b - c;
+  const int pa = std::abs(p - a);
+  const int pb = std::abs(p - b);
+  const int pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc) {
+    return a;
+  }
+  return pb <= pc ? b : c;
+}
+
+// Filters a row of `n` bytes with the `predict(left, up, up_left)` function
+// into `out` and returns the sum of the absolute values of the filtered bytes.
+template <typename Fn>
+static uint64_t FilterRow(const uint8_t* row, const uint8_t* prev, size_t n,
+                          size_t bpp, uint8_t* out, Fn predict) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const int left = i >= bpp ? row[i - bpp] : 0;
+    const int up_left = i >= bpp ? prev[i - bpp] : 0;
+    const uint8_t value =
+        static_cast<uint8_t>(row[i] - predict(left, prev[i], up_left));
+    out[i] = value;
+    sum += value < 128 ? value : 256 - value;
+  }
+  return sum;
+}
+
+// Applies each of the five PNG filter types to a row and picks the one with
+// the smallest sum of absolute differences, which is the libpng heuristic.
+class RowFilter {
+ public:
+  RowFilter(size_t row_bytes, size_t bpp) : bpp_(bpp), zeros_(row_bytes, 0) {
+    for (auto& candidate : candidates_) {
+      candidate.resize(row_bytes + 1);
+    }
+  }
+
+  // Returns the filtered `row`, prefixed with its filter type.  `prev` is the
+  // previous unfiltered row, or nullptr for the first row of the image.
+  absl::Span<const uint8_t> Apply(const uint8_t* row, const uint8_t* prev) {
+    if (prev == nullptr) {
+      prev = zeros_.data();
+    }
+    const size_t n = zeros_.size();
+    uint64_t sums[kNumFilters];
+    sums[0] = FilterRow(row, prev, n, bpp_, Out(0),
+                        [](int, int, int) { return 0; });
+    sums[1] = FilterRow(row, prev, n, bpp_, Out(1),
+                        [](int a, int, int) { return a; });
+    sums[2] = FilterRow(row, prev, n, bpp_, Out(2),
+                        [](int, int b, int) { return b; });
+    sums[3] = FilterRow(row, prev, n, bpp_, Out(3),
+                        [](int a, int b, int) { return (a + b) / 2; });
+    sums[4] = FilterRow(row, prev, n, bpp_, Out(4), PaethPredictor);
+
+    int best = 0;
+    for (int type = 1; type < kNumFilters; ++type) {
+      if (sums[type] < sums[best]) {
+        best = type;
+      }
+    }
+    candidates_[best][0] = static_cast<uint8_t>(best);
+    return candidates_[best];
+  }
+
+ private:
+  static constexpr int kNumFilters = 5;
+
+  uint8_t* Out(int type) { return candidates_[type].data() + 1; }
+
+  size_t bpp_;
+  std::vector<uint8_t> zeros_;
+  std::vector<uint8_t> candidates_[kNumFilters];
+};
+
+// A horizontal band of the image that is filtered and compressed into an
+// independent piece of the deflate stream.
+struct Strip {
+  int begin_row = 0;
+  int end_row = 0;
+  std::vector<uint8_t> compressed;
+  // The checksum and size of the filtered (uncompressed) data.
+  uLong adler = 1;
+  size_t num_filtered_bytes = 0;
+  bool ok = false;
+};
+
+static bool Deflate(z_stream* stream, absl::Span<const uint8_t> input,
+                    int flush, std::vector<uint8_t>* out, size_t* out_size) {
+  stream->next_in = const_cast<Bytef*>(input.data());
+  stream->avail_in = static_cast<uInt>(input.size());
+  do {
+    if (out->size() == *out_size) {
+      out->resize(out->size() + kOutputChunkSize);
+    }
+    stream->next_out = out->data() + *out_size;
+    stream->avail_out = static_cast<uInt>(out->size() - *out_size);
+    if (deflate(stream, flush) == Z_STREAM_ERROR) {
+      return false;
+    }
+    *out_size = out->size() - stream->avail_out;
+  } while (stream->avail_out == 0);
+  return true;
+}
+
+// Compresses the rows of `strip` into a raw deflate stream. All but the last
+// strip end in a sync flush so that the strips can be concatenated.
+static bool CompressStrip(const ImageData& src, size_t row_bytes, size_t bpp,
+                          int level, bool last, Strip* strip) {
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(src.GetData());
+  const size_t stride = src.GetStride();
+  RowFilter filter(row_bytes, bpp);
+  size_t compressed_size = 0;
+  bool ok = true;
+  for (int row = strip->begin_row; ok && row < strip->end_row; ++row) {
+    const uint8_t* curr = data + row * stride;
+    const uint8_t* prev = row > 0 ? curr - stride : nullptr;
+    const absl::Span<const uint8_t> filtered = filter.Apply(curr, prev);
+    strip->adler = adler32(strip->adler, filtered.data(),
+                           static_cast<uInt>(filtered.size()));
+    strip->num_filtered_bytes += filtered.size();
+
+    int flush = Z_NO_FLUSH;
+    if (row + 1 == strip->end_row) {
+      flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    }
+    ok = Deflate(&stream, filtered, flush, &strip->compressed,
+                 &compressed_size);
+  }
+  deflateEnd(&stream);
+  strip->compressed.resize(compressed_size);
+  return ok;
+}
+
+bool EncodePng(const ImageData& src, const EncodeSinkFn& sink,
+               const PngEncodeOptions& options) {
+  const int width = src.GetSize().x;
+  const int height = src.GetSize().y;
+  if (width <= 0 || height <= 0 || src.GetData() == nullptr) {
+    return false;
+  }
+
   const int color_type = ImageDataFormatToPngColorType(src.GetFormat());
   const int component_count = ImageDataFormatToComponentCount(src.GetFormat());
   const int bits_per_pixel = GetBitsPerPixel(src.GetFormat());
   const int bit_depth = bits_per_pixel / component_count;
-  png_set_IHDR(png, png_info, src.GetSize().x, src.GetSize().y, bit_depth,
-               color_type, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
-               PNG_FILTER_TYPE_DEFAULT);
-  png_write_info(png, png_info);
+  const size_t bpp = std::max(1, bits_per_pixel / 8);
+  const size_t row_bytes = static_cast<size_t>(bits_per_pixel) * width / 8;
 
-  // Encode pixel data.
-  const uint8_t* data = reinterpret_cast<const uint8_t*>(src.GetData());
-  const int pitch = bits_per_pixel * src.GetSize().x / 8;
-  for (int row = 0; row < src.GetSize().y; ++row) {
-    png_write_row(png, data + row * pitch);
+  int num_strips = 1;
+#ifndef REDUX_DISABLE_THREADS
+  num_strips = std::clamp(options.num_threads, 1,
+                          std::max(1, height / kMinRowsPerStrip));
+#endif
+
+  std::vector<Strip> strips(num_strips);
+  for (int i = 0; i < num_strips; ++i) {
+    strips[i].begin_row = static_cast<int>(int64_t{height} * i / num_strips);
+    strips[i].end_row =
+        static_cast<int>(int64_t{height} * (i + 1) / num_strips);
+  }
+  auto compress = [&](int i) {
+    const bool last = i + 1 == num_strips;
+    strips[i].ok = CompressStrip(src, row_bytes, bpp,
+                                 options.compression_level, last, &strips[i]);
+  };
+
+  // The first strip is compressed on the calling thread.
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_strips; ++i) {
+    threads.emplace_back(compress, i);
   }
+  compress(0);
 
-  // Write the png trailer and destroy allocated libpng objects.
-  png_write_end(png, nullptr);
-  png_destroy_write_struct(&png, &png_info);
+  uint8_t ihdr[13];
+  WriteBigEndian32(static_cast<uint32_t>(width), ihdr);
+  WriteBigEndian32(static_cast<uint32_t>(height), ihdr + 4);
+  ihdr[8] = static_cast<uint8_t>(bit_depth);
+  ihdr[9] = static_cast<uint8_t>(color_type);
+  ihdr[10] = 0;  // Deflate compression.
+  ihdr[11] = 0;  // Adaptive filtering.
+  ihdr[12] = 0;  // No interlacing.
 
-  // Copy the vector data into a DataContainer.
-  DataBuilder builder(encoded_png.size());
-  auto* dst = builder.GetAppendPtr(encoded_png.size());
-  memcpy(dst, encoded_png.data(), encoded_png.size());
-  return builder.Release();
+  // Each strip is written out as its own IDAT chunk as soon as it (and all the
+  // strips before it) are ready, so a strip that fails after earlier ones have
+  // been written leaves the sink with a truncated file.
+  bool ok = strips[0].ok;
+  uLong adler = strips[0].adler;
+  for (int i = 0; i < num_strips; ++i) {
+    if (i > 0) {
+      threads[i - 1].join();
+      ok = ok && strips[i].ok;
+      const auto num_bytes = static_cast<z_off_t>(strips[i].num_filtered_bytes);
+      adler = adler32_combine(adler, strips[i].adler, num_bytes);
+    }
+    if (!ok) {
+      continue;
+    }
+
+    if (i == 0) {
+      Emit(sink, kPngSignature);
+      WriteChunk(sink, "IHDR", {ihdr});
+    }
+    absl::Span<const uint8_t> header;
+    if (i == 0) {
+      header = kZlibHeader;
+    }
+    uint8_t checksum[4];
+    absl::Span<const uint8_t> trailer;
+    if (i + 1 == num_strips) {
+      WriteBigEndian32(static_cast<uint32_t>(adler), checksum);
+      trailer = checksum;
+    }
+    WriteChunk(sink, "IDAT", {header, strips[i].compressed, trailer});
+    // Release each strip as soon as it has been written.
+    strips[i].compressed = std::vector<uint8_t>();
+  }
+  if (!ok) {
+    return false;
+  }
+
+  WriteChunk(sink, "IEND", {});
+  return true;
+}
+
+DataContainer EncodePng(const ImageData& src) {
+  EncodeBuffer buffer;
+  if (!EncodePng(src, buffer.GetSink())) {
+    return DataContainer();
+  }
+  return buffer.Release();
 }
+
 }  // namespace redux
@@ -18,13 +18,31 @@ limitations under the License.
 #define REDUX_MODULES_CODECS_ENCODE_PNG_H_
 
 #include "redux/modules/base/data_container.h"
+#include "redux/modules/codecs/encode_sink.h"
 #include "redux/modules/graphics/image_data.h"
 
 namespace redux {
 
-// Encodes the image as a PNG data buffer.
+struct PngEncodeOptions {
+  // The zlib compression level, from 0 (none) to 9 (smallest), or -1 for the
+  // zlib default.
+  int compression_level = -1;
+
+  // The image is split into this many horizontal strips which are filtered
+  // and compressed in parallel, each on its own thread. The strips are joined
+  // into a single valid PNG stream, at a small cost in compression ratio.
+  int num_threads = 1;
+};
+
 DataContainer EncodePng(const ImageData& src);
 
+// Encodes `src` as a PNG, passing the encoded bytes to `sink` as they become
+// available rather than building the whole file in memory. Returns false if
+// the image could not be encoded, in which case the bytes already passed to
+// `sink` (if any) are a truncated file and should be discarded.
+bool EncodePng(const ImageData& src, const EncodeSinkFn& sink,
+               const PngEncodeOptions& options = PngEncodeOptions());
+
 }  // namespace redux
 
 #endif  // REDUX_MODULES_CODECS_ENCODE_PNG_H_
@@ -0,0 +1,140 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/codecs/encode_png.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/codecs/decode_stb.h"
+#include "redux/modules/graphics/image_utils.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Gt;
+
+// Returns an image whose rows are `padding` bytes longer than its pixels. The
+// pixels mix smooth gradients with noise so that every filter type is used.
+ImageData MakeImage(ImageFormat format, int width, int height,
+                    std::size_t padding = 0) {
+  const std::size_t row_bytes = GetBitsPerPixel(format) * width / 8;
+  const std::size_t stride = row_bytes + padding;
+  std::vector<std::byte> bytes(stride * height);
+  std::uint32_t seed = 12345;
+  for (int y = 0; y < height; ++y) {
+    for (std::size_t x = 0; x < stride; ++x) {
+      seed = seed * 1103515245 + 12345;
+      const int noise = (seed >> 16) & 0x0f;
+      const int value = static_cast<int>(x) * 3 + y * 5 + (y % 7 ? 0 : noise);
+      bytes[y * stride + x] = static_cast<std::byte>(value);
+    }
+  }
+  return ImageData(format, vec2i(width, height),
+                   DataContainer::WrapData(absl::MakeConstSpan(bytes)).Clone(),
+                   stride);
+}
+
+DataContainer Encode(const ImageData& image, int num_threads) {
+  PngEncodeOptions options;
+  options.num_threads = num_threads;
+  EncodeBuffer buffer;
+  EXPECT_TRUE(EncodePng(image, buffer.GetSink(), options));
+  return buffer.Release();
+}
+
+void ExpectSamePixels(const ImageData& decoded, const ImageData& src) {
+  ASSERT_THAT(decoded.GetFormat(), Eq(src.GetFormat()));
+  ASSERT_THAT(decoded.GetSize(), Eq(src.GetSize()));
+  const std::size_t row_bytes =
+      GetBitsPerPixel(src.GetFormat()) * src.GetSize().x / 8;
+  for (int y = 0; y < src.GetSize().y; ++y) {
+    const std::byte* expected = src.GetData() + y * src.GetStride();
+    const std::byte* actual = decoded.GetData() + y * decoded.GetStride();
+    const std::vector<std::byte> expected_row(expected, expected + row_bytes);
+    const std::vector<std::byte> actual_row(actual, actual + row_bytes);
+    ASSERT_THAT(actual_row, Eq(expected_row)) << "Row " << y;
+  }
+}
+
+void ExpectRoundTrip(const ImageData& image, int num_threads) {
+  const DataContainer png = Encode(image, num_threads);
+  ASSERT_THAT(png.GetNumBytes(), Gt(0));
+  ExpectSamePixels(DecodeStb(png, DecodeStbOptions()), image);
+}
+
+TEST(EncodePngTest, RoundTripsFormats) {
+  for (ImageFormat format :
+       {ImageFormat::Luminance8, ImageFormat::LuminanceAlpha88,
+        ImageFormat::Rgb888, ImageFormat::Rgba8888}) {
+    ExpectRoundTrip(MakeImage(format, 37, 29), 1);
+    ExpectRoundTrip(MakeImage(format, 37, 29), 4);
+  }
+}
+
+TEST(EncodePngTest, RoundTripsStrips) {
+  // None of the heights are multiples of the minimum rows per strip, and some
+  // are too short to be split into as many strips as threads.
+  for (int height : {1, 15, 17, 33, 50, 101}) {
+    for (int num_threads : {1, 2, 3, 4, 8}) {
+      SCOPED_TRACE(testing::Message()
+                   << "height " << height << ", threads " << num_threads);
+      ExpectRoundTrip(MakeImage(ImageFormat::Rgba8888, 19, height),
+                      num_threads);
+    }
+  }
+}
+
+TEST(EncodePngTest, RoundTripsPaddedRows) {
+  ExpectRoundTrip(MakeImage(ImageFormat::Rgb888, 21, 40, 7), 1);
+  ExpectRoundTrip(MakeImage(ImageFormat::Rgb888, 21, 40, 7), 3);
+}
+
+TEST(EncodePngTest, StreamsChunks) {
+  const ImageData image = MakeImage(ImageFormat::Rgba8888, 64, 64);
+  PngEncodeOptions options;
+  options.num_threads = 4;
+
+  int num_calls = 0;
+  std::vector<std::byte> streamed;
+  EXPECT_TRUE(EncodePng(
+      image,
+      [&](absl::Span<const std::byte> bytes) {
+        ++num_calls;
+        streamed.insert(streamed.end(), bytes.begin(), bytes.end());
+      },
+      options));
+  EXPECT_THAT(num_calls, Gt(1));
+
+  const DataContainer png = Encode(image, options.num_threads);
+  const std::vector<std::byte> buffered(png.GetBytes(),
+                                        png.GetBytes() + png.GetNumBytes());
+  EXPECT_THAT(streamed, Eq(buffered));
+}
+
+TEST(EncodePngTest, RejectsEmptyImage) {
+  int num_calls = 0;
+  EXPECT_FALSE(EncodePng(ImageData(),
+                         [&](absl::Span<const std::byte>) { ++num_calls; }));
+  EXPECT_THAT(num_calls, Eq(0));
+}
+
+}  // namespace
+}  // namespace redux
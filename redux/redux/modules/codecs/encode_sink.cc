@@ -0,0 +1,66 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/codecs/encode_sink.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "redux/modules/base/logging.h"
+
+namespace redux {
+
+EncodeBuffer::EncodeBuffer(std::size_t capacity_hint) {
+  bytes_.reserve(capacity_hint);
+}
+
+void EncodeBuffer::Append(absl::Span<const std::byte> bytes) {
+  bytes_.insert(bytes_.end(), bytes.begin(), bytes.end());
+}
+
+EncodeSinkFn EncodeBuffer::GetSink() {
+  return [this](absl::Span<const std::byte> bytes) { Append(bytes); };
+}
+
+DataContainer EncodeBuffer::Release() {
+  if (bytes_.empty()) {
+    return DataContainer();
+  }
+  // Hand the vector's storage to the DataContainer instead of copying it.
+  auto* owner = new std::vector<std::byte>(std::move(bytes_));
+  bytes_.clear();
+  return DataContainer(owner->data(), owner->size(),
+                       [owner](const std::byte*) { delete owner; });
+}
+
+EncodeSinkFn OpenFileSink(std::string_view path) {
+  const std::string filename(path);
+  FILE* file = fopen(filename.c_str(), "wb");
+  if (file == nullptr) {
+    LOG(ERROR) << "Unable to open file for writing: " << filename;
+    return nullptr;
+  }
+  std::shared_ptr<FILE> handle(file, [](FILE* file) { fclose(file); });
+  return [handle](absl::Span<const std::byte> bytes) {
+    if (fwrite(bytes.data(), 1, bytes.size(), handle.get()) != bytes.size()) {
+      LOG(ERROR) << "Failed to write encoded image data.";
+    }
+  };
+}
+
+}  // namespace redux
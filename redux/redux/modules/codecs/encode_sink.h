@@ -0,0 +1,67 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_MODULES_CODECS_ENCODE_SINK_H_
+#define REDUX_MODULES_CODECS_ENCODE_SINK_H_
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "redux/modules/base/data_container.h"
+
+namespace redux {
+
+// Receives the output of an image encoder as a sequence of byte chunks, in
+// order. The chunks are only valid for the duration of the call.
+using EncodeSinkFn = std::function<void(absl::Span<const std::byte>)>;
+
+// Accumulates the chunks sent to a sink and hands them off as a single
+// DataContainer without an extra copy.
+class EncodeBuffer {
+ public:
+  explicit EncodeBuffer(std::size_t capacity_hint = 0);
+
+  EncodeBuffer(const EncodeBuffer&) = delete;
+  EncodeBuffer& operator=(const EncodeBuffer&) = delete;
+
+  // Appends `bytes` to the buffer.
+  void Append(absl::Span<const std::byte> bytes);
+
+  // Returns a sink that appends to this buffer. The buffer must outlive the
+  // sink.
+  EncodeSinkFn GetSink();
+
+  // Returns the number of bytes appended so far.
+  std::size_t GetNumBytes() const { return bytes_.size(); }
+
+  // Moves the appended bytes into a DataContainer, leaving the buffer empty.
+  DataContainer Release();
+
+ private:
+  std::vector<std::byte> bytes_;
+};
+
+// Returns a sink that writes to the file at `path`, which is closed once the
+// sink (and all copies of it) are destroyed. Returns nullptr if the file could
+// not be opened.
+EncodeSinkFn OpenFileSink(std::string_view path);
+
+}  // namespace redux
+
+#endif  // REDUX_MODULES_CODECS_ENCODE_SINK_H_
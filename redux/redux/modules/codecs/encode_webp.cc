@@ -17,34 +17,68 @@ limitations under the License.
 #include "redux/modules/codecs/encode_webp.h"
 
 #include "webp/encode.h"
+#include "redux/modules/base/logging.h"
 #include "redux/modules/graphics/image_utils.h"
 
 namespace redux {
 
-DataContainer EncodeWebp(const ImageData& src) {
+static int WebpWriteFn(const uint8_t* data, size_t data_size,
+                       const WebPPicture* picture) {
+  const auto* sink = static_cast<const EncodeSinkFn*>(picture->custom_ptr);
+  if (data_size > 0) {
+    (*sink)(absl::MakeConstSpan(reinterpret_cast<const std::byte*>(data),
+                                data_size));
+  }
+  return 1;
+}
+
+bool EncodeWebp(const ImageData& src, const EncodeSinkFn& sink,
+                const WebpEncodeOptions& options) {
   const auto image_size = src.GetSize();
   const int channel_count = GetChannelCountForFormat(src.GetFormat());
   const uint8_t* data = reinterpret_cast<const uint8_t*>(src.GetData());
-  const size_t stride = src.GetStride();
+  const int stride = static_cast<int>(src.GetStride());
+
+  WebPConfig config;
+  if (!WebPConfigPreset(&config, WEBP_PRESET_DEFAULT, options.quality)) {
+    return false;
+  }
+  config.lossless = options.lossless ? 1 : 0;
+  config.thread_level = options.multithreaded ? 1 : 0;
+  if (!WebPValidateConfig(&config)) {
+    return false;
+  }
 
-  uint8_t* webp = nullptr;
-  size_t size = 0;
+  WebPPicture picture;
+  if (!WebPPictureInit(&picture)) {
+    return false;
+  }
+  picture.use_argb = config.lossless;
+  picture.width = image_size.x;
+  picture.height = image_size.y;
+  picture.writer = &WebpWriteFn;
+  picture.custom_ptr = const_cast<EncodeSinkFn*>(&sink);
+
+  int imported = 0;
   if (channel_count == 3) {
-    size =
-        WebPEncodeLosslessRGB(data, image_size.x, image_size.y, stride, &webp);
+    imported = WebPPictureImportRGB(&picture, data, stride);
   } else if (channel_count == 4) {
-    size =
-        WebPEncodeLosslessRGBA(data, image_size.x, image_size.y, stride, &webp);
+    imported = WebPPictureImportRGBA(&picture, data, stride);
   } else {
     LOG(FATAL) << "Unsupported number of image channels: " << channel_count;
   }
 
-  if (webp == nullptr) {
-    return DataContainer(reinterpret_cast<std::byte*>(webp), size,
-                         [=](const std::byte*) { delete webp; });
-  } else {
+  const bool ok = imported && WebPEncode(&config, &picture);
+  WebPPictureFree(&picture);
+  return ok;
+}
+
+DataContainer EncodeWebp(const ImageData& src) {
+  EncodeBuffer buffer;
+  if (!EncodeWebp(src, buffer.GetSink())) {
     return DataContainer();
   }
+  return buffer.Release();
 }
 
 }  // namespace redux
@@ -18,13 +18,32 @@ limitations under the License.
 #define REDUX_MODULES_CODECS_ENCODE_WEBP_H_
 
 #include "redux/modules/base/data_container.h"
+#include "redux/modules/codecs/encode_sink.h"
 #include "redux/modules/graphics/image_data.h"
 
 namespace redux {
 
-// Encodes the image as a WEBP data buffer.
+struct WebpEncodeOptions {
+  // Whether to encode losslessly.
+  bool lossless = true;
+
+  // For lossy encoding, the quality from 0 (smallest) to 100 (best). For
+  // lossless encoding, the effort from 0 (fastest) to 100 (smallest).
+  float quality = 75.f;
+
+  // Allows libwebp to use an additional thread while encoding.
+  bool multithreaded = true;
+};
+
 DataContainer EncodeWebp(const ImageData& src);
 
+// Encodes `src` as a WebP, passing the encoded bytes to `sink` as they become
+// available rather than building the whole file in memory. Returns false if
+// the image could not be encoded, in which case the bytes already passed to
+// `sink` (if any) are a truncated file and should be discarded.
+bool EncodeWebp(const ImageData& src, const EncodeSinkFn& sink,
+                const WebpEncodeOptions& options = WebpEncodeOptions());
+
 }  // namespace redux
 
 #endif  // REDUX_MODULES_CODECS_ENCODE_WEBP_H_
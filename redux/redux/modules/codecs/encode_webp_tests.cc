@@ -0,0 +1,123 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/codecs/encode_webp.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/codecs/decode_webp.h"
+#include "redux/modules/graphics/image_utils.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Gt;
+
+// Returns an image whose rows are `padding` bytes longer than its pixels. The
+// alpha channel, if any, is never zero since lossless WebP is free to change
+// the color of fully transparent pixels.
+ImageData MakeImage(ImageFormat format, int width, int height,
+                    std::size_t padding = 0) {
+  const int channels = GetChannelCountForFormat(format);
+  const std::size_t stride = channels * width + padding;
+  std::vector<std::byte> bytes(stride * height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      std::byte* pixel = &bytes[y * stride + x * channels];
+      pixel[0] = static_cast<std::byte>(x * 7 + y);
+      pixel[1] = static_cast<std::byte>(y * 5);
+      pixel[2] = static_cast<std::byte>((x ^ y) * 3);
+      if (channels == 4) {
+        pixel[3] = static_cast<std::byte>(128 + (x + y) % 128);
+      }
+    }
+  }
+  return ImageData(format, vec2i(width, height),
+                   DataContainer::WrapData(absl::MakeConstSpan(bytes)).Clone(),
+                   stride);
+}
+
+DataContainer Encode(const ImageData& image, const WebpEncodeOptions& options) {
+  EncodeBuffer buffer;
+  EXPECT_TRUE(EncodeWebp(image, buffer.GetSink(), options));
+  return buffer.Release();
+}
+
+void ExpectSamePixels(const ImageData& decoded, const ImageData& src) {
+  ASSERT_THAT(decoded.GetFormat(), Eq(src.GetFormat()));
+  ASSERT_THAT(decoded.GetSize(), Eq(src.GetSize()));
+  const std::size_t row_bytes =
+      GetChannelCountForFormat(src.GetFormat()) * src.GetSize().x;
+  for (int y = 0; y < src.GetSize().y; ++y) {
+    const std::byte* expected = src.GetData() + y * src.GetStride();
+    const std::byte* actual = decoded.GetData() + y * decoded.GetStride();
+    const std::vector<std::byte> expected_row(expected, expected + row_bytes);
+    const std::vector<std::byte> actual_row(actual, actual + row_bytes);
+    ASSERT_THAT(actual_row, Eq(expected_row)) << "Row " << y;
+  }
+}
+
+TEST(EncodeWebpTest, RoundTripsLossless) {
+  for (ImageFormat format : {ImageFormat::Rgb888, ImageFormat::Rgba8888}) {
+    for (bool multithreaded : {false, true}) {
+      WebpEncodeOptions options;
+      options.multithreaded = multithreaded;
+      const ImageData image = MakeImage(format, 37, 29);
+      const DataContainer webp = Encode(image, options);
+      ASSERT_THAT(webp.GetNumBytes(), Gt(0));
+      ExpectSamePixels(DecodeWebp(webp, DecodeWebpOptions()), image);
+    }
+  }
+}
+
+TEST(EncodeWebpTest, RoundTripsPaddedRows) {
+  const ImageData image = MakeImage(ImageFormat::Rgba8888, 21, 17, 12);
+  const DataContainer webp = Encode(image, WebpEncodeOptions());
+  ExpectSamePixels(DecodeWebp(webp, DecodeWebpOptions()), image);
+}
+
+TEST(EncodeWebpTest, EncodesLossy) {
+  WebpEncodeOptions options;
+  options.lossless = false;
+  options.quality = 50.f;
+  const ImageData image = MakeImage(ImageFormat::Rgb888, 40, 30);
+  const ImageData decoded =
+      DecodeWebp(Encode(image, options), DecodeWebpOptions());
+  EXPECT_THAT(decoded.GetFormat(), Eq(ImageFormat::Rgb888));
+  EXPECT_THAT(decoded.GetSize(), Eq(image.GetSize()));
+}
+
+TEST(EncodeWebpTest, StreamsSameBytesAsBuffer) {
+  const ImageData image = MakeImage(ImageFormat::Rgba8888, 64, 64);
+
+  std::vector<std::byte> streamed;
+  EXPECT_TRUE(EncodeWebp(image, [&](absl::Span<const std::byte> bytes) {
+    streamed.insert(streamed.end(), bytes.begin(), bytes.end());
+  }));
+
+  const DataContainer webp = EncodeWebp(image);
+  const std::vector<std::byte> buffered(webp.GetBytes(),
+                                        webp.GetBytes() + webp.GetNumBytes());
+  EXPECT_THAT(streamed, Eq(buffered));
+}
+
+}  // namespace
+}  // namespace redux
@@ -0,0 +1,126 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/codecs/image_encoder.h"
+
+#include <utility>
+
+namespace redux {
+
+ImageEncoder::ImageEncoder(size_t num_worker_threads,
+                           size_t max_queued_images)
+    : max_queued_images_(max_queued_images) {
+#ifndef REDUX_DISABLE_THREADS
+  for (size_t i = 0; i < num_worker_threads; ++i) {
+    worker_threads_.emplace_back([this]() { WorkerThread(); });
+  }
+#endif
+}
+
+ImageEncoder::~ImageEncoder() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopping_ = true;
+  }
+  for (auto& thread : worker_threads_) {
+    thread.join();
+  }
+}
+
+bool ImageEncoder::EncodePng(ImageData image, EncodeSinkFn sink,
+                             DoneFn on_done, const PngEncodeOptions& options) {
+  Job job;
+  job.image = std::move(image);
+  job.encode = [sink = std::move(sink), options](const ImageData& image) {
+    return redux::EncodePng(image, sink, options);
+  };
+  job.on_done = std::move(on_done);
+  return Enqueue(std::move(job));
+}
+
+bool ImageEncoder::EncodeWebp(ImageData image, EncodeSinkFn sink,
+                              DoneFn on_done,
+                              const WebpEncodeOptions& options) {
+  Job job;
+  job.image = std::move(image);
+  job.encode = [sink = std::move(sink), options](const ImageData& image) {
+    return redux::EncodeWebp(image, sink, options);
+  };
+  job.on_done = std::move(on_done);
+  return Enqueue(std::move(job));
+}
+
+bool ImageEncoder::Enqueue(Job job) {
+  if (worker_threads_.empty()) {
+    Process(job);
+    return true;
+  }
+
+  absl::MutexLock lock(&mutex_);
+  if (queue_.size() >= max_queued_images_) {
+    return false;
+  }
+  queue_.push_back(std::move(job));
+  return true;
+}
+
+size_t ImageEncoder::GetNumPending() const {
+  absl::MutexLock lock(&mutex_);
+  return queue_.size() + num_active_;
+}
+
+void ImageEncoder::Wait() {
+  absl::MutexLock lock(&mutex_, absl::Condition(this, &ImageEncoder::IsIdle));
+}
+
+bool ImageEncoder::IsIdle() const { return queue_.empty() && num_active_ == 0; }
+
+bool ImageEncoder::HasWork() const { return !queue_.empty() || stopping_; }
+
+void ImageEncoder::WorkerThread() {
+  while (true) {
+    Job job;
+    {
+      absl::MutexLock lock(&mutex_,
+                           absl::Condition(this, &ImageEncoder::HasWork));
+      if (queue_.empty()) {
+        // Only reached once stopping, after the queue has been drained.
+        break;
+      }
+      job = std::move(queue_.front());
+      queue_.pop_front();
+      ++num_active_;
+    }
+
+    Process(job);
+
+    absl::MutexLock lock(&mutex_);
+    --num_active_;
+  }
+}
+
+void ImageEncoder::Process(Job& job) {
+  const bool ok = job.encode(job.image);
+  // Release the image and the sink (eg. closing its file) before notifying the
+  // caller.
+  DoneFn on_done = std::move(job.on_done);
+  job = Job();
+  if (on_done) {
+    on_done(ok);
+  }
+}
+
+}  // namespace redux
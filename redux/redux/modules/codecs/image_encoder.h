@@ -0,0 +1,101 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_MODULES_CODECS_IMAGE_ENCODER_H_
+#define REDUX_MODULES_CODECS_IMAGE_ENCODER_H_
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "redux/modules/codecs/encode_png.h"
+#include "redux/modules/codecs/encode_sink.h"
+#include "redux/modules/codecs/encode_webp.h"
+#include "redux/modules/graphics/image_data.h"
+
+namespace redux {
+
+// Encodes images on worker threads, eg. to save captured frames without
+// stalling the thread that captured them.
+//
+// At most `max_queued_images` images wait to be encoded at any time. Further
+// requests are rejected rather than blocking the caller, so that a burst of
+// captures cannot grow memory use without bound. The encoded bytes are passed
+// to the request's sink on a worker thread as they are produced, followed by a
+// call to its `on_done` callback.
+class ImageEncoder {
+ public:
+  // Called on a worker thread once an image has been encoded, with whether the
+  // encoding succeeded. On failure, the bytes already passed to the sink are a
+  // truncated file and should be discarded.
+  using DoneFn = std::function<void(bool ok)>;
+
+  // With zero worker threads, images are encoded on the calling thread.
+  explicit ImageEncoder(size_t num_worker_threads = 1,
+                        size_t max_queued_images = 2);
+
+  // Finishes encoding all queued images.
+  ~ImageEncoder();
+
+  ImageEncoder(const ImageEncoder&) = delete;
+  ImageEncoder& operator=(const ImageEncoder&) = delete;
+
+  // Queues `image` to be encoded as a PNG into `sink`. Returns false, without
+  // calling `sink` or `on_done`, if the queue is full.
+  bool EncodePng(ImageData image, EncodeSinkFn sink, DoneFn on_done = nullptr,
+                 const PngEncodeOptions& options = PngEncodeOptions());
+
+  // Queues `image` to be encoded as a WebP into `sink`. Returns false, without
+  // calling `sink` or `on_done`, if the queue is full.
+  bool EncodeWebp(ImageData image, EncodeSinkFn sink, DoneFn on_done = nullptr,
+                  const WebpEncodeOptions& options = WebpEncodeOptions());
+
+  // Returns the number of images that are queued or being encoded.
+  size_t GetNumPending() const;
+
+  // Blocks until all queued images have been encoded.
+  void Wait();
+
+ private:
+  using EncodeFn = std::function<bool(const ImageData&)>;
+
+  struct Job {
+    ImageData image;
+    EncodeFn encode;
+    DoneFn on_done;
+  };
+
+  bool Enqueue(Job job);
+  bool IsIdle() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void WorkerThread();
+  static void Process(Job& job);
+
+  const size_t max_queued_images_;
+  std::vector<std::thread> worker_threads_;
+  mutable absl::Mutex mutex_;
+  std::deque<Job> queue_ ABSL_GUARDED_BY(mutex_);
+  size_t num_active_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_MODULES_CODECS_IMAGE_ENCODER_H_
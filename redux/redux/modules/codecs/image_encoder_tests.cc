@@ -0,0 +1,122 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/codecs/image_encoder.h"
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
+#include "redux/modules/codecs/decode_stb.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+
+ImageData MakeImage(int width, int height) {
+  std::vector<std::byte> bytes(4 * width * height);
+  for (std::size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<std::byte>(i * 7);
+  }
+  return ImageData(ImageFormat::Rgba8888, vec2i(width, height),
+                   DataContainer::WrapData(absl::MakeConstSpan(bytes)).Clone());
+}
+
+TEST(ImageEncoderTest, EncodesOnWorkerThreads) {
+  constexpr int kNumImages = 8;
+  std::vector<EncodeBuffer> buffers(kNumImages);
+  std::atomic<int> num_done = 0;
+  {
+    ImageEncoder encoder(2, kNumImages);
+    for (int i = 0; i < kNumImages; ++i) {
+      EXPECT_TRUE(encoder.EncodePng(MakeImage(16 + i, 20),
+                                    buffers[i].GetSink(), [&](bool ok) {
+                                      EXPECT_TRUE(ok);
+                                      ++num_done;
+                                    }));
+    }
+    encoder.Wait();
+    EXPECT_THAT(encoder.GetNumPending(), Eq(0));
+    EXPECT_THAT(num_done.load(), Eq(kNumImages));
+  }
+
+  for (int i = 0; i < kNumImages; ++i) {
+    const ImageData decoded =
+        DecodeStb(buffers[i].Release(), DecodeStbOptions());
+    EXPECT_THAT(decoded.GetSize(), Eq(vec2i(16 + i, 20)));
+  }
+}
+
+TEST(ImageEncoderTest, RejectsWhenQueueIsFull) {
+  ImageEncoder encoder(1, 1);
+
+  // Block the worker inside the sink of the first image.
+  absl::Notification started;
+  absl::Notification release;
+  auto blocking_sink = [&](absl::Span<const std::byte>) {
+    if (!started.HasBeenNotified()) {
+      started.Notify();
+      release.WaitForNotification();
+    }
+  };
+  std::atomic<int> num_done = 0;
+  auto on_done = [&](bool ok) {
+    EXPECT_TRUE(ok);
+    ++num_done;
+  };
+
+  EXPECT_TRUE(encoder.EncodePng(MakeImage(8, 8), blocking_sink, on_done));
+  started.WaitForNotification();
+  EXPECT_THAT(encoder.GetNumPending(), Eq(1));
+
+  // The worker is busy, so one image may wait in the queue.
+  EncodeBuffer queued;
+  EXPECT_TRUE(encoder.EncodePng(MakeImage(8, 8), queued.GetSink(), on_done));
+  EXPECT_THAT(encoder.GetNumPending(), Eq(2));
+
+  int num_rejected_calls = 0;
+  EXPECT_FALSE(encoder.EncodePng(
+      MakeImage(8, 8),
+      [&](absl::Span<const std::byte>) { ++num_rejected_calls; },
+      [&](bool) { ++num_rejected_calls; }));
+  EXPECT_THAT(encoder.GetNumPending(), Eq(2));
+
+  release.Notify();
+  encoder.Wait();
+  EXPECT_THAT(encoder.GetNumPending(), Eq(0));
+  EXPECT_THAT(num_done.load(), Eq(2));
+  EXPECT_THAT(num_rejected_calls, Eq(0));
+  EXPECT_THAT(DecodeStb(queued.Release(), DecodeStbOptions()).GetSize(),
+              Eq(vec2i(8, 8)));
+}
+
+TEST(ImageEncoderTest, EncodesInlineWithoutWorkers) {
+  ImageEncoder encoder(0);
+  EncodeBuffer buffer;
+  bool done = false;
+  EXPECT_TRUE(encoder.EncodePng(MakeImage(4, 4), buffer.GetSink(),
+                                [&](bool ok) { done = ok; }));
+  EXPECT_TRUE(done);
+  EXPECT_THAT(encoder.GetNumPending(), Eq(0));
+  encoder.Wait();
+}
+
+}  // namespace
+}  // namespace redux
@@ -0,0 +1,125 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "redux/modules/datafile/datafile_parser.h"
+#include "redux/modules/datafile/datafile_reader.h"
+
+// Benchmarks for parsing datafiles. The number of entities in the generated
+// scene is given by state.range(0). Throughput is reported in bytes of source
+// text per second so that the results are comparable across scene sizes.
+
+namespace redux {
+namespace {
+
+struct Transform {
+  std::vector<float> position;
+  std::vector<float> scale;
+
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(position, ConstHash("position"));
+    archive(scale, ConstHash("scale"));
+  }
+};
+
+struct Entity {
+  std::string name;
+  std::vector<std::string> tags;
+  Transform transform;
+  bool visible = false;
+
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(name, ConstHash("name"));
+    archive(tags, ConstHash("tags"));
+    archive(transform, ConstHash("transform"));
+    archive(visible, ConstHash("visible"));
+  }
+};
+
+struct Scene {
+  std::vector<Entity> entities;
+
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(entities, ConstHash("entities"));
+  }
+};
+
+// Callbacks that do nothing, used to measure the cost of the parser itself.
+class NullCallbacks : public DatafileParserCallbacks {
+ public:
+  void Key(std::string_view value) override { benchmark::DoNotOptimize(value); }
+  void BeginObject() override {}
+  void EndObject() override {}
+  void BeginArray() override {}
+  void EndArray() override {}
+  void Null() override {}
+  void Boolean(bool value) override {}
+  void Number(double value) override { benchmark::DoNotOptimize(value); }
+  void String(std::string_view value) override {
+    benchmark::DoNotOptimize(value);
+  }
+  void Expression(std::string_view value) override {}
+  void ParseError(std::string_view context,
+                  std::string_view message) override {}
+};
+
+std::string MakeScene(int count) {
+  std::string text = "{\n  entities: [\n";
+  for (int i = 0; i < count; ++i) {
+    const std::string n = std::to_string(i);
+    text += "    {\n";
+    text += "      ; Entity " + n + "\n";
+    text += "      name: 'entity_" + n + "',\n";
+    text += "      tags: ['static', 'layer_" + std::to_string(i % 8) + "'],\n";
+    text += "      transform: {\n";
+    text += "        position: [" + n + ", 0.5, -" + n + "],\n";
+    text += "        scale: [1, 1, 1],\n";
+    text += "      },\n";
+    text += "      visible: true,\n";
+    text += "    },\n";
+  }
+  text += "  ]\n}\n";
+  return text;
+}
+
+void BM_ParseDatafile(benchmark::State& state) {
+  const std::string text = MakeScene(static_cast<int>(state.range(0)));
+  NullCallbacks callbacks;
+  for (auto _ : state) {
+    ParseDatafile(text, &callbacks);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ParseDatafile)->Arg(1 << 6)->Arg(1 << 10)->Arg(1 << 14);
+
+void BM_ReadDatafile(benchmark::State& state) {
+  const std::string text = MakeScene(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    Scene scene = ReadDatafile<Scene>(text, nullptr);
+    benchmark::DoNotOptimize(scene.entities.data());
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ReadDatafile)->Arg(1 << 6)->Arg(1 << 10)->Arg(1 << 14);
+
+}  // namespace
+}  // namespace redux
@@ -95,21 +95,15 @@ static bool IsKeyValid(std::string_view key) {
 // character after the comments.
 static std::string_view SkipComments(std::string_view txt) {
   txt = StripFront(txt);
-  while (IsCommentMarker(txt.front())) {
+  while (!txt.empty() && IsCommentMarker(txt.front())) {
+    // Consume all characters until the end of the line, as well as all
+    // whitespace at the start of the next line. If the comment ends with an
+    // EOF rather than a new line, this consumes the rest of the text.
     std::size_t i = 0;
-    for (; i < txt.length(); ++i) {
-      if (IsNewline(txt[i])) {
-        // Consume all characters until the end of the line, as well as all
-        // non-whitespace at the start of the next line.
-        txt = StripFront(txt.substr(i));
-      }
-    }
-
-    if (i == txt.length()) {
-      // There are no more characters in the text. This may happen if the
-      // comment line ends with an EOF rather than a new line.
-      return txt.substr(i);
+    while (i < txt.length() && !IsNewline(txt[i])) {
+      ++i;
     }
+    txt = StripFront(txt.substr(i));
   }
   return txt;
 }
@@ -160,6 +160,27 @@ TEST(DatafileParserTest, BasicParsing) {
   EXPECT_THAT(callbacks.values[21].ValueOr(std::string()), Eq("Expr"));
 }
 
+TEST(DatafileParserTest, Comments) {
+  const char* txt =
+      "; Leading comment.\n"
+      "{\n"
+      "  ; Comment before a key.\n"
+      "  a: 1,  ; Trailing comment.\n"
+      "  ; Two comments\n"
+      "  ; in a row.\n"
+      "  b: 2,\n"
+      "}\n"
+      "; Comment at the end without a new line.";
+  std::vector<Token> expected = {
+      kBeginObject, kKey, kNumber, kKey, kNumber, kEndObject,
+  };
+
+  TestDatafileParserCallbacks callbacks;
+  ParseDatafile(txt, &callbacks);
+  EXPECT_THAT(callbacks.tokens, Eq(expected));
+  EXPECT_THAT(callbacks.values[4].ValueOr(0.0), Eq(2.0));
+}
+
 TEST(DatafileParserTest, EscapedQuotes) {
   const char* txt = "{Key : 'hello\\'world'}";
   std::vector<Token> expected = {
@@ -25,33 +25,40 @@ namespace redux::detail {
 
 void DatafileReader::Key(std::string_view value) { key_ = Hash(value); }
 
+void DatafileReader::Push() {
+  CHECK_LT(depth_, kMaxDepth);
+  Element* next = stack_[depth_ - 1]->Begin(key_, &storage_[depth_]);
+  CHECK(next != nullptr);
+  stack_[depth_] = next;
+  ++depth_;
+}
+
+void DatafileReader::Pop() {
+  CHECK_GT(depth_, 0);
+  --depth_;
+  stack_[depth_]->~Element();
+}
+
 void DatafileReader::BeginObject() {
-  if (stack_.empty()) {
-    using std::swap;
-    swap(root_, stack_.emplace_back());
+  if (depth_ == 0) {
+    // The root Element was already constructed in the first slot by Read().
+    CHECK(root_ != nullptr);
+    stack_[0] = root_;
+    root_ = nullptr;
+    depth_ = 1;
   } else {
-    auto next = stack_.back()->Begin(key_);
-    CHECK(next != nullptr);
-    stack_.emplace_back(std::move(next));
+    Push();
   }
 }
 
-void DatafileReader::EndObject() {
-  CHECK(!stack_.empty());
-  stack_.pop_back();
-}
+void DatafileReader::EndObject() { Pop(); }
 
 void DatafileReader::BeginArray() {
-  CHECK(!stack_.empty());
-  auto next = stack_.back()->Begin(key_);
-  CHECK(next != nullptr);
-  stack_.emplace_back(std::move(next));
+  CHECK_GT(depth_, 0);
+  Push();
 }
 
-void DatafileReader::EndArray() {
-  CHECK(!stack_.empty());
-  stack_.pop_back();
-}
+void DatafileReader::EndArray() { Pop(); }
 
 void DatafileReader::Null() { SetValue(Var()); }
 
@@ -60,7 +67,8 @@ void DatafileReader::Boolean(bool value) { SetValue(Var(value)); }
 void DatafileReader::Number(double value) { SetValue(Var(value)); }
 
 void DatafileReader::String(std::string_view value) {
-  SetValue(Var(std::string(value)));
+  CHECK_GT(depth_, 0);
+  stack_[depth_ - 1]->SetString(key_, value);
 }
 
 void DatafileReader::Expression(std::string_view value) {
@@ -80,8 +88,8 @@ void DatafileReader::ParseError(std::string_view context,
 }
 
 void DatafileReader::SetValue(const Var& var) {
-  CHECK(!stack_.empty());
-  stack_.back()->SetValue(key_, var);
+  CHECK_GT(depth_, 0);
+  stack_[depth_ - 1]->SetValue(key_, var);
 }
 
 }  // namespace redux::detail
@@ -17,6 +17,9 @@ limitations under the License.
 #ifndef REDUX_MODULES_DATAFILE_DATAFILE_H_
 #define REDUX_MODULES_DATAFILE_DATAFILE_H_
 
+#include <cstddef>
+#include <new>
+#include <string>
 #include <string_view>
 #include <type_traits>
 
@@ -46,11 +49,12 @@ class DatafileReader : public DatafileParserCallbacks {
 
   template <typename T>
   void Read(std::string_view text, T& obj) {
-    // Push 'obj' as the root object for the traversal stack.
-    root_.reset(new ElementT<T>(&obj));
+    // Prepare 'obj' as the root object for the traversal stack; it is pushed
+    // when the parser begins the top-level object.
+    root_ = ElementT<T>::Make(&obj, &storage_[0]);
     ParseDatafile(text, this);
-    CHECK(stack_.empty());
-    root_.reset();
+    CHECK_EQ(depth_, 0);
+    root_ = nullptr;
   }
 
   // DatafileParserCallbacks.
@@ -94,8 +98,17 @@ class DatafileReader : public DatafileParserCallbacks {
   template <typename U>
   static constexpr bool IsValue = !IsObject<U> && !IsArray<U>;
 
-  class Element;
-  using ElementPtr = std::unique_ptr<Element>;
+  // The maximum nesting depth of Objects and Arrays, which matches the limit
+  // imposed by the parser.
+  static constexpr std::size_t kMaxDepth = 128;
+
+  // Storage for a single Element. Every ElementT only holds a pointer to the
+  // object it serializes into, so they all fit into the same fixed-size slot.
+  // This allows the traversal stack to live inside the reader rather than
+  // allocating each Element on the heap.
+  struct alignas(void*) ElementStorage {
+    std::byte bytes[2 * sizeof(void*)];
+  };
 
   // Responsible for Serializing data into an Element. In this case, Elements
   // are limited to either Objects or Arrays.
@@ -104,11 +117,16 @@ class DatafileReader : public DatafileParserCallbacks {
     virtual ~Element() = default;
 
     // Marks the start of a new Object or Array within the current element.
-    // Returns the pointer to the new "Element" object.
-    virtual ElementPtr Begin(HashValue key) = 0;
+    // Constructs the new "Element" object in `storage` and returns a pointer to
+    // it, or returns nullptr if there is no Object or Array for the key.
+    virtual Element* Begin(HashValue key, ElementStorage* storage) = 0;
 
     // Attempts to set the value of the given field within the current element.
     virtual void SetValue(HashValue key, const Var& var) = 0;
+
+    // Like SetValue, but string fields are assigned directly from the source
+    // text without first being copied into a Var.
+    virtual void SetString(HashValue key, std::string_view value) = 0;
   };
 
   template <typename T>
@@ -116,14 +134,21 @@ class DatafileReader : public DatafileParserCallbacks {
    public:
     explicit ElementT(T* obj) : obj_(obj) {}
 
-    ElementPtr Begin(HashValue key) override {
+    // Constructs an ElementT for `obj` in the given `storage`.
+    static Element* Make(T* obj, ElementStorage* storage) {
+      static_assert(sizeof(ElementT) <= sizeof(ElementStorage));
+      static_assert(alignof(ElementT) <= alignof(ElementStorage));
+      return new (storage) ElementT(obj);
+    }
+
+    Element* Begin(HashValue key, ElementStorage* storage) override {
       if constexpr (IsArray<T>) {
         // We can only call Begin in an array if its an array of objects.
         if constexpr (!IsValue<typename T::value_type>) {
-          return BeginArrayElement(key);
+          return BeginArrayElement(key, storage);
         }
       } else if constexpr (IsObject<T>) {
-        return BeginObjectElement(key);
+        return BeginObjectElement(key, storage);
       }
       return nullptr;
     }
@@ -140,15 +165,38 @@ class DatafileReader : public DatafileParserCallbacks {
       }
     }
 
+    // Assigns a string value to the element.
+    void SetString(HashValue key, std::string_view value) override {
+      if constexpr (IsArray<T>) {
+        if constexpr (IsValue<typename T::value_type>) {
+          obj_->emplace_back();
+          AssignString(value, &obj_->back());
+        }
+      } else if constexpr (IsObject<T>) {
+        obj_->Serialize([&](auto& field, HashValue match) {
+          using U = std::decay_t<decltype(field)>;
+          if constexpr (IsValue<U>) {
+            if (key == match) {
+              AssignString(value, &field);
+            }
+          }
+        });
+      }
+    }
+
    private:
     template <typename U>
-    ElementPtr MakeElementPtr(U* obj) {
-      return ElementPtr(new ElementT<U>(obj));
+    static void AssignString(std::string_view value, U* out) {
+      if constexpr (std::is_same_v<U, std::string>) {
+        out->assign(value.data(), value.size());
+      } else {
+        FromVar(Var(std::string(value)), out);
+      }
     }
 
-    ElementPtr BeginArrayElement(HashValue key) {
+    Element* BeginArrayElement(HashValue key, ElementStorage* storage) {
       obj_->emplace_back();
-      return MakeElementPtr(&obj_->back());
+      return ElementT<typename T::value_type>::Make(&obj_->back(), storage);
     }
 
     void SetArrayValue(HashValue key, const Var& var) {
@@ -156,11 +204,12 @@ class DatafileReader : public DatafileParserCallbacks {
       FromVar(var, &obj_->back());
     }
 
-    ElementPtr BeginObjectElement(HashValue key) {
-      ElementPtr result;
+    Element* BeginObjectElement(HashValue key, ElementStorage* storage) {
+      Element* result = nullptr;
       obj_->Serialize([&](auto& value, HashValue match) {
         if (key == match) {
-          result = MakeElementPtr(&value);
+          using U = std::decay_t<decltype(value)>;
+          result = ElementT<U>::Make(&value, storage);
         }
       });
       return result;
@@ -183,9 +232,17 @@ class DatafileReader : public DatafileParserCallbacks {
   // Basically calls SetValue on the back of the stack with the current key.
   void SetValue(const Var& var);
 
+  // Pushes a new Element for the current key onto the stack.
+  void Push();
+
+  // Pops and destroys the Element at the back of the stack.
+  void Pop();
+
   HashValue key_;
-  ElementPtr root_;
-  std::vector<ElementPtr> stack_;
+  Element* root_ = nullptr;
+  Element* stack_[kMaxDepth];
+  ElementStorage storage_[kMaxDepth];
+  std::size_t depth_ = 0;
   ScriptEnv* env_ = nullptr;
 };
 
@@ -91,5 +91,45 @@ TEST(Datafile, ReadDatafile) {
   EXPECT_THAT(test.objs[2].str, Eq("cd"));
 }
 
+struct DatafileTestNestedClass {
+  std::vector<std::string> names;
+  std::vector<DatafileTestClass> children;
+
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(names, ConstHash("names"));
+    archive(children, ConstHash("children"));
+  }
+};
+
+TEST(Datafile, ReadNestedDatafile) {
+  const char* txt =
+      "{"
+      "  names : ['a', 'bc', \"def\"],"
+      "  children : [{"
+      "    str : 'first',"
+      "    objs : [{ str : 'x' }, { str : 'y' }],"
+      "  }, {"
+      "    inner : { str : 'second' },"
+      "    arr : [5],"
+      "  }]"
+      "}";
+
+  DatafileTestNestedClass test =
+      ReadDatafile<DatafileTestNestedClass>(txt, nullptr);
+  EXPECT_THAT(test.names.size(), Eq(3));
+  EXPECT_THAT(test.names[0], Eq("a"));
+  EXPECT_THAT(test.names[1], Eq("bc"));
+  EXPECT_THAT(test.names[2], Eq("def"));
+  EXPECT_THAT(test.children.size(), Eq(2));
+  EXPECT_THAT(test.children[0].str, Eq("first"));
+  EXPECT_THAT(test.children[0].objs.size(), Eq(2));
+  EXPECT_THAT(test.children[0].objs[0].str, Eq("x"));
+  EXPECT_THAT(test.children[0].objs[1].str, Eq("y"));
+  EXPECT_THAT(test.children[1].inner.str, Eq("second"));
+  EXPECT_THAT(test.children[1].arr.size(), Eq(1));
+  EXPECT_THAT(test.children[1].arr[0], Eq(5.f));
+}
+
 }  // namespace
 }  // namespace redux
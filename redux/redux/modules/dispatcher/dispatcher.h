@@ -75,7 +75,9 @@ namespace redux {
 //
 // In addition to sending/receiving concrete Event types, clients can connect
 // and send Message objects directly. This allows clients to process
-// events in a more generic way.
+// events in a more generic way. Events are only converted to/from their
+// VarTable form when a handler actually needs that form, so dispatching a
+// concrete Event to concrete handlers never serializes it.
 class Dispatcher {
  private:
   // Internal class that stores the map of TypeId to Handlers.
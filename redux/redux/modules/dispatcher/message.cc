@@ -18,51 +18,23 @@ limitations under the License.
 
 namespace redux {
 
-Message::Message(const Message& rhs)
-    : obj_(rhs.obj_),
-      table_(rhs.table_),
-      type_(rhs.type_),
-      pointer_(rhs.pointer_),
-      handler_(rhs.handler_) {
-  if (rhs.handler_) {
-    rhs.handler_(kCopy, this, &rhs);
-  } else {
-    CHECK(pointer_.Empty());
-    CHECK(obj_.has_value() == false);
-  }
-}
+Message::Message(const Message& rhs) { *this = rhs; }
 
-Message::Message(Message&& rhs)
-    : obj_(std::move(rhs.obj_)),
-      table_(std::move(rhs.table_)),
-      type_(rhs.type_),
-      pointer_(rhs.pointer_),
-      handler_(rhs.handler_) {
-  if (rhs.handler_) {
-    rhs.handler_(kMove, this, &rhs);
-  } else {
-    CHECK(pointer_.Empty());
-    CHECK(obj_.has_value() == false);
-  }
-
-  rhs.type_ = 0;
-  rhs.pointer_.Reset();
-  rhs.handler_ = nullptr;
-}
+Message::Message(Message&& rhs) { *this = std::move(rhs); }
 
 Message& Message::operator=(const Message& rhs) {
   if (this != &rhs) {
+    Reset(rhs.type_, rhs.handler_);
     if (rhs.handler_) {
       rhs.handler_(kCopy, this, &rhs);
     } else {
       CHECK(rhs.pointer_.Empty());
       CHECK(rhs.obj_.has_value() == false);
-
-      type_ = rhs.type_;
-      pointer_ = TypedPtr();
-      obj_.reset();
+    }
+    // Typed messages only have a VarTable if a dynamic handler asked for one,
+    // so typed-only dispatch never pays for the conversion here.
+    if (!rhs.table_.Empty()) {
       table_ = rhs.table_;
-      handler_ = rhs.handler_;
     }
   }
   return *this;
@@ -70,23 +42,27 @@ Message& Message::operator=(const Message& rhs) {
 
 Message& Message::operator=(Message&& rhs) {
   if (this != &rhs) {
+    Reset(rhs.type_, rhs.handler_);
     if (rhs.handler_) {
       rhs.handler_(kMove, this, &rhs);
     } else {
       CHECK(rhs.pointer_.Empty());
       CHECK(rhs.obj_.has_value() == false);
-
-      type_ = rhs.type_;
-      pointer_ = TypedPtr();
-      obj_.reset();
+    }
+    if (!rhs.table_.Empty()) {
       table_ = std::move(rhs.table_);
-      handler_ = rhs.handler_;
-
-      rhs.type_ = 0;
-      rhs.table_.Clear();
-      rhs.handler_ = nullptr;
     }
+    rhs.Reset(0, nullptr);
   }
   return *this;
 }
+
+void Message::Reset(TypeId type, HandlerFn* handler) {
+  type_ = type;
+  handler_ = handler;
+  pointer_.Reset();
+  obj_.reset();
+  table_.Clear();
+}
+
 }  // namespace redux
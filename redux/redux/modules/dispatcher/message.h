@@ -106,6 +106,9 @@ class Message {
   // performing any necessary conversions.
   void EnsureIsDynamic() const;
 
+  // Releases the payload and sets the message's type and handler.
+  void Reset(TypeId type, HandlerFn* handler);
+
   absl::any obj_;     // Type-erased instance of the payload.
   Var table_;         // The payload stored as a dynamic Var.
   TypeId type_ = 0;   // The typeid of the message.
@@ -184,7 +187,7 @@ void Message::Handler(HandlerOp op, Message* dst, const Message* src) {
         LoadFromVar loader(const_cast<Var*>(&src->table_));
         Serialize(loader, obj);
 
-        dst->obj_ = obj;
+        dst->obj_ = std::move(obj);
         dst->pointer_ = TypedPtr(absl::any_cast<T>(&dst->obj_));
       }
       CHECK(dst->pointer_.Is<T>());
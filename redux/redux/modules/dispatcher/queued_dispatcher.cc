@@ -21,13 +21,33 @@ namespace redux {
 void QueuedDispatcher::Dispatch() {
   while (auto msg = queue_.TryPopFront()) {
     Dispatcher::SendImpl(*msg.value());
+    ReleaseMessage(std::move(msg.value()));
   }
 }
 
 void QueuedDispatcher::SendImpl(const Message& msg) {
   // Copy the event in order to increase the lifetime of the event until it
   // is dispatched.  The original event can now safely go out-of-scope.
-  queue_.PushBack(std::make_unique<Message>(msg));
+  MessagePtr copy = AcquireMessage();
+  *copy = msg;
+  queue_.PushBack(std::move(copy));
+}
+
+QueuedDispatcher::MessagePtr QueuedDispatcher::AcquireMessage() {
+  if (auto msg = pool_.TryPopFront()) {
+    --pool_size_;
+    return std::move(msg.value());
+  }
+  return std::make_unique<Message>();
+}
+
+void QueuedDispatcher::ReleaseMessage(MessagePtr msg) {
+  // Drop the payload now rather than holding onto it while pooled.
+  *msg = Message();
+  if (pool_size_ < kMaxPooledMessages) {
+    ++pool_size_;
+    pool_.PushBack(std::move(msg));
+  }
 }
 
 }  // namespace redux
@@ -17,6 +17,8 @@ limitations under the License.
 #ifndef REDUX_MODULES_DISPATCHER_QUEUED_DISPATCHER_H_
 #define REDUX_MODULES_DISPATCHER_QUEUED_DISPATCHER_H_
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
 
 #include "redux/modules/base/thread_safe_deque.h"
@@ -33,6 +35,9 @@ namespace redux {
 // and allows the owner of the QueuedDispatcher to control when those Events are
 // actually handled by the owning thread.
 //
+// Dispatched Messages are recycled for later events so that a steady stream of
+// events does not allocate a new Message for each one.
+//
 // On destruction, any events that have been queued but not yet dispatched will
 // be lost.
 class QueuedDispatcher : public Dispatcher {
@@ -47,11 +52,22 @@ class QueuedDispatcher : public Dispatcher {
  private:
   using MessagePtr = std::unique_ptr<Message>;
 
+  // The maximum number of dispatched Messages kept around for reuse.
+  static constexpr std::size_t kMaxPooledMessages = 64;
+
   // Overrides the Dispatcher base-class SendImpl function to store Messages in
   // the queue rather than sending them to the registered handlers.
   void SendImpl(const Message& msg) override;
 
+  // Returns a Message from the pool, or a newly allocated one if it is empty.
+  MessagePtr AcquireMessage();
+
+  // Clears the `msg` and returns it to the pool (if there is space).
+  void ReleaseMessage(MessagePtr msg);
+
   ThreadSafeDeque<MessagePtr> queue_;
+  ThreadSafeDeque<MessagePtr> pool_;
+  std::atomic<std::size_t> pool_size_ = 0;
 };
 
 }  // namespace redux
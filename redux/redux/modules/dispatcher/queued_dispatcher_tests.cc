@@ -60,6 +60,23 @@ struct QueuedEventHandlerClass {
 int QueuedEventHandlerClass::static_value = 0;
 int QueuedEventHandlerClass::static_accumulator = 0;
 
+// Counts how many times it is converted to/from a VarTable.
+struct SerializedEvent {
+  SerializedEvent() {}
+  explicit SerializedEvent(int value) : value(value) {}
+
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    ++serialize_count;
+    archive(value, ConstHash("value"));
+  }
+
+  int value = 0;
+  static int serialize_count;
+};
+
+int SerializedEvent::serialize_count = 0;
+
 TEST(QueuedDispatcher, BaseTestNoRegisteredHandlers) {
   QueuedDispatcher d;
   QueuedEventHandlerClass h;
@@ -201,6 +218,54 @@ TEST(QueuedDispatcher, Message) {
   EXPECT_EQ(2, count);
 }
 
+TEST(QueuedDispatcher, ConcreteEventsAreNotSerialized) {
+  SerializedEvent::serialize_count = 0;
+
+  int value = 0;
+  QueuedDispatcher d;
+  auto c = d.Connect([&](const SerializedEvent& e) { value = e.value; });
+
+  d.Send(SerializedEvent(123));
+  d.Dispatch();
+  EXPECT_EQ(123, value);
+  EXPECT_EQ(0, SerializedEvent::serialize_count);
+
+  // A generic handler can still read the event as a VarTable.
+  int generic_value = 0;
+  auto c2 = d.ConnectToAll([&](const Message& msg) {
+    generic_value = msg.ValueOr(ConstHash("value"), 0);
+  });
+  d.Send(SerializedEvent(456));
+  d.Dispatch();
+  EXPECT_EQ(456, value);
+  EXPECT_EQ(456, generic_value);
+  EXPECT_EQ(1, SerializedEvent::serialize_count);
+}
+
+TEST(QueuedDispatcher, ReusesMessagesAcrossTypes) {
+  QueuedEventHandlerClass h;
+  int value = 0;
+  int count = 0;
+  static const TypeId kTestTypeId = 123;
+
+  QueuedDispatcher d;
+  auto c1 = d.Connect([&](const QueuedEvent& e) { h.HandleEvent(e); });
+  auto c2 = d.Connect([&](const SerializedEvent& e) { value = e.value; });
+  auto c3 = d.Connect(kTestTypeId, [&](const Message& msg) { ++count; });
+
+  for (int i = 1; i <= 10; ++i) {
+    d.Send(QueuedEvent(i, "text"));
+    d.Send(SerializedEvent(i));
+    d.Send(Message(kTestTypeId));
+    d.Dispatch();
+    EXPECT_EQ(i, h.value);
+    EXPECT_EQ("text", h.text);
+    EXPECT_EQ(i, value);
+    EXPECT_EQ(i, count);
+  }
+  EXPECT_EQ(55, h.accumulator);
+}
+
 TEST(ThreadSafeQueue, Multithreaded) {
   QueuedDispatcher d;
   QueuedEventHandlerClass h;
@@ -273,3 +338,4 @@ TEST(ThreadSafeQueue, MultithreadedSendWhileDispatching) {
 }  // namespace redux
 
 REDUX_SETUP_TYPEID(QueuedEvent);
+REDUX_SETUP_TYPEID(SerializedEvent);
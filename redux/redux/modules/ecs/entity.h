@@ -27,16 +27,39 @@ namespace redux {
 //
 // An Entity itself does not have any data or functionality; it is just a way to
 // uniquely identify objects and is simply a number.
+//
+// The lower `kIndexBits` of the number are a dense slot index that is recycled
+// once an Entity is destroyed, and the upper bits are a generation counter
+// that is bumped each time a slot is recycled. This allows Systems to store
+// Components in arrays addressed by `index()` (see EntityMap) while still
+// being able to detect stale handles by comparing the whole value.
 class Entity {
  public:
   // Underlying representation for Entity.
   using Rep = std::uint32_t;
 
+  // Number of bits used for the slot index; the rest hold the generation.
+  static constexpr int kIndexBits = 24;
+  static constexpr Rep kIndexMask = (Rep(1) << kIndexBits) - 1;
+  static constexpr Rep kMaxGeneration = ~Rep(0) >> kIndexBits;
+
   constexpr Entity() : value_(0) {}
   constexpr explicit Entity(Rep value) : value_(value) {}
 
+  // Creates an Entity from its slot `index` and `generation`.
+  static constexpr Entity FromIndex(Rep index, Rep generation) {
+    return Entity((generation << kIndexBits) | (index & kIndexMask));
+  }
+
   constexpr Rep get() const { return value_; }
 
+  // Returns the dense slot index of the Entity.
+  constexpr Rep index() const { return value_ & kIndexMask; }
+
+  // Returns the number of times the Entity's slot had been recycled when the
+  // Entity was created.
+  constexpr Rep generation() const { return value_ >> kIndexBits; }
+
   explicit operator bool() const { return value_ != 0; }
 
  private:
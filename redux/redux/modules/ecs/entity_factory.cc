@@ -16,6 +16,9 @@ limitations under the License.
 
 #include "redux/modules/ecs/entity_factory.h"
 
+#include <vector>
+
+#include "redux/modules/base/snapshot.h"
 #include "redux/modules/ecs/entity.h"
 #include "redux/modules/ecs/system.h"
 
@@ -25,35 +28,82 @@ static constexpr int32_t kDisabledExplicitly = 0x1 << 0;
 static constexpr int32_t kDisabledIndirectly = 0x1 << 1;
 static constexpr int32_t kDisabled = kDisabledExplicitly | kDisabledIndirectly;
 
+// Identifies a snapshot image; bump the version whenever the layout changes.
+static constexpr uint32_t kSnapshotMagic = 0x50414e53;  // "SNAP"
+static constexpr uint32_t kSnapshotVersion = 2;
+
 EntityFactory::EntityFactory(Registry* registry)
-    : registry_(registry), blueprint_factory_(registry) {}
+    : registry_(registry), blueprint_factory_(registry), generations_(1, 0) {}
 
 EntityFactory::~EntityFactory() {}
 
 Entity EntityFactory::Create() {
-  const Entity entity(++entity_generator_);
-  CHECK_NE(entity_generator_, 0);
+  Entity::Rep index = 0;
+  if (free_indices_.size() > kMinFreeIndices) {
+    index = free_indices_.front();
+    free_indices_.pop_front();
+  } else {
+    index = static_cast<Entity::Rep>(generations_.size());
+    CHECK_LE(index, Entity::kIndexMask) << "Too many entities.";
+    generations_.push_back(0);
+  }
+
+  const Entity entity = Entity::FromIndex(index, generations_[index]);
   metadata_[entity] = Bits32::None();
   return entity;
 }
 
+void EntityFactory::ReleaseIndex(Entity entity) {
+  const Entity::Rep index = entity.index();
+  generations_[index] = (generations_[index] + 1) & Entity::kMaxGeneration;
+  free_indices_.push_back(index);
+}
+
 Entity EntityFactory::Create(const BlueprintPtr& blueprint) {
   CHECK(blueprint);
   if (blueprint == nullptr) {
     return kNullEntity;
   }
 
-  Entity entity = Create();
+  const Entity entity = Create();
+  AddComponents(blueprint, {&entity, 1});
+  return entity;
+}
+
+std::vector<Entity> EntityFactory::Create(const BlueprintPtr& blueprint,
+                                          std::size_t count) {
+  CHECK(blueprint);
+  if (blueprint == nullptr || count == 0) {
+    return {};
+  }
+
+  metadata_.reserve(metadata_.size() + count);
+  std::vector<Entity> entities;
+  entities.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    entities.push_back(Create());
+  }
+
+  for (size_t i = 0; i < blueprint->GetNumComponents(); ++i) {
+    auto iter = defs_.find(blueprint->GetComponentType(i));
+    CHECK(iter != defs_.end());
+    iter->second.system->OnReserve(count);
+  }
+
+  AddComponents(blueprint, entities);
+  return entities;
+}
+
+void EntityFactory::AddComponents(const BlueprintPtr& blueprint,
+                                  absl::Span<const Entity> entities) {
   for (size_t i = 0; i < blueprint->GetNumComponents(); ++i) {
     const TypeId type = blueprint->GetComponentType(i);
-    auto iter = add_fns_.find(type);
-    CHECK(iter != add_fns_.end());
-    absl::Status status = iter->second(entity, blueprint->GetComponent(i));
+    auto iter = defs_.find(type);
+    CHECK(iter != defs_.end());
+    absl::Status status = iter->second.fn(entities, blueprint->GetComponent(i));
     CHECK(status.ok()) << "Unable to read component " << i << " of blueprint "
                        << blueprint->GetName() << ": " << status;
   }
-
-  return entity;
 }
 
 Entity EntityFactory::Load(std::string_view uri) {
@@ -67,7 +117,11 @@ void EntityFactory::DestroyNow(Entity entity) {
     for (auto& system_entry : systems_) {
       system_entry.second->OnDestroy(entity);
     }
-    metadata_.erase(iter);
+    // Systems may have created or destroyed Entities (including this one), so
+    // look the Entity up again rather than reusing the iterator.
+    if (metadata_.erase(entity) > 0) {
+      ReleaseIndex(entity);
+    }
   }
 }
 
@@ -133,6 +187,147 @@ void EntityFactory::UpdateEnableBits(Entity entity, int32_t set_bits,
   }
 }
 
+DataContainer EntityFactory::SaveSnapshot() const {
+  SnapshotWriter writer;
+  uint32_t magic = kSnapshotMagic;
+  uint32_t version = kSnapshotVersion;
+  writer(magic, ConstHash("magic"));
+  writer(version, ConstHash("version"));
+
+  uint64_t num_slots = generations_.size();
+  writer(num_slots, ConstHash("num_slots"));
+  for (Entity::Rep generation : generations_) {
+    writer(generation, ConstHash("generation"));
+  }
+  uint64_t num_free = free_indices_.size();
+  writer(num_free, ConstHash("num_free"));
+  for (Entity::Rep index : free_indices_) {
+    writer(index, ConstHash("index"));
+  }
+
+  uint64_t num_entities = metadata_.size();
+  writer(num_entities, ConstHash("num_entities"));
+  for (const auto& iter : metadata_) {
+    Entity::Rep entity = iter.first.get();
+    uint32_t bits = iter.second.Value();
+    writer(entity, ConstHash("entity"));
+    writer(bits, ConstHash("metadata"));
+  }
+
+  // Each System's data is prefixed by its size so that unknown Systems can be
+  // skipped when loading.
+  uint64_t num_systems = systems_.size();
+  writer(num_systems, ConstHash("num_systems"));
+  for (const auto& iter : systems_) {
+    TypeId type = iter.first;
+    writer(type, ConstHash("type"));
+    const std::size_t offset = writer.Reserve();
+    const std::size_t start = writer.GetSize();
+    iter.second->SaveSnapshot(writer);
+    writer.Patch(offset, writer.GetSize() - start);
+  }
+  return writer.Release();
+}
+
+bool EntityFactory::LoadSnapshot(absl::Span<const std::byte> snapshot) {
+  SnapshotReader reader(snapshot);
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  reader(magic, ConstHash("magic"));
+  reader(version, ConstHash("version"));
+  if (!reader.IsOk() || magic != kSnapshotMagic ||
+      version != kSnapshotVersion) {
+    LOG(ERROR) << "Invalid snapshot.";
+    return false;
+  }
+
+  std::vector<Entity> entities;
+  entities.reserve(metadata_.size());
+  for (const auto& iter : metadata_) {
+    entities.push_back(iter.first);
+  }
+  for (Entity entity : entities) {
+    DestroyNow(entity);
+  }
+  pending_destruction_ = {};
+
+  uint64_t num_slots = 0;
+  reader(num_slots, ConstHash("num_slots"));
+  if (!reader.IsOk() || num_slots == 0 || num_slots > Entity::kIndexMask + 1) {
+    LOG(ERROR) << "Invalid snapshot.";
+    return false;
+  }
+  generations_.assign(num_slots, 0);
+  for (Entity::Rep& generation : generations_) {
+    reader(generation, ConstHash("generation"));
+  }
+  // No slot may be listed twice, be both free and live, or be the reserved
+  // slot 0. Otherwise Create() could hand out a live or out-of-range index.
+  std::vector<bool> claimed(num_slots, false);
+  claimed[0] = true;
+  uint64_t num_free = 0;
+  reader(num_free, ConstHash("num_free"));
+  if (!reader.IsOk() || num_free >= num_slots) {
+    LOG(ERROR) << "Invalid snapshot.";
+    return false;
+  }
+  free_indices_.clear();
+  for (uint64_t i = 0; i < num_free && reader.IsOk(); ++i) {
+    Entity::Rep index = 0;
+    reader(index, ConstHash("index"));
+    if (index == 0 || index >= generations_.size() || claimed[index]) {
+      LOG(ERROR) << "Invalid snapshot.";
+      return false;
+    }
+    claimed[index] = true;
+    free_indices_.push_back(index);
+  }
+
+  uint64_t num_entities = 0;
+  reader(num_entities, ConstHash("num_entities"));
+  for (uint64_t i = 0; i < num_entities && reader.IsOk(); ++i) {
+    Entity::Rep rep = 0;
+    uint32_t bits = 0;
+    reader(rep, ConstHash("entity"));
+    reader(bits, ConstHash("metadata"));
+    const Entity entity(rep);
+    const Entity::Rep index = entity.index();
+    if (index == 0 || index >= generations_.size() || claimed[index] ||
+        entity.generation() != generations_[index]) {
+      LOG(ERROR) << "Invalid snapshot.";
+      return false;
+    }
+    claimed[index] = true;
+    metadata_[entity] = Bits32(bits);
+  }
+
+  uint64_t num_systems = 0;
+  reader(num_systems, ConstHash("num_systems"));
+  for (uint64_t i = 0; i < num_systems && reader.IsOk(); ++i) {
+    TypeId type = 0;
+    uint64_t size = 0;
+    reader(type, ConstHash("type"));
+    reader(size, ConstHash("size"));
+    const absl::Span<const std::byte> data = reader.ReadSpan(size);
+
+    auto iter = systems_.find(type);
+    if (iter == systems_.end()) {
+      continue;
+    }
+    SnapshotReader system_reader(data);
+    if (!iter->second->LoadSnapshot(system_reader) || !system_reader.IsOk()) {
+      LOG(ERROR) << "Unable to load snapshot for system " << type;
+      return false;
+    }
+  }
+
+  if (!reader.IsOk()) {
+    LOG(ERROR) << "Snapshot is truncated.";
+    return false;
+  }
+  return true;
+}
+
 bool EntityFactory::IsAlive(Entity entity) const {
   return metadata_.contains(entity);
 }
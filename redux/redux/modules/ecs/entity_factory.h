@@ -18,17 +18,22 @@ limitations under the License.
 #define REDUX_MODULES_ECS_ENTITY_FACTORY_H_
 
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <queue>
+#include <vector>
 
 #include "redux/engines/script/redux/script_env.h"
+#include "absl/types/span.h"
 #include "redux/modules/base/bits.h"
+#include "redux/modules/base/data_container.h"
 #include "redux/modules/base/registry.h"
 #include "redux/modules/base/typeid.h"
 #include "redux/modules/ecs/blueprint.h"
 #include "redux/modules/ecs/blueprint_factory.h"
 #include "redux/modules/ecs/component_serializer.h"
 #include "redux/modules/ecs/entity.h"
+#include "redux/modules/ecs/entity_map.h"
 
 namespace redux {
 
@@ -56,12 +61,19 @@ class EntityFactory {
   template <typename T, typename... Args>
   T* CreateSystem(Args&&... args);
 
-  // Creates an "empty" Entity; one that has no Components.
+  // Creates an "empty" Entity; one that has no Components. The Entity's slot
+  // index is recycled from a previously destroyed Entity when possible, with
+  // its generation bumped so that the old Entity remains distinguishable.
   Entity Create();
 
   // Creates an Entity with attached Components as defined by the Blueprint.
   Entity Create(const BlueprintPtr& blueprint);
 
+  // Creates `count` Entities from the same Blueprint. Each ComponentDef in the
+  // Blueprint is only read once and then added to every Entity, and Systems
+  // are given a chance to reserve storage for all the Entities up front.
+  std::vector<Entity> Create(const BlueprintPtr& blueprint, std::size_t count);
+
   // Convenience function that uses the BlueprintFactory to load a Blueprint
   // from the given 'uri' and create an Entity from it all in one go.
   Entity Load(std::string_view uri);
@@ -95,6 +107,19 @@ class EntityFactory {
   // Returns true if an Entity is enabled.
   bool IsEnabled(Entity entity) const;
 
+  // Saves the state of all Entities and the Component data of all Systems into
+  // a single binary image that can be restored with LoadSnapshot. Entities
+  // queued for destruction are not recorded as such.
+  //
+  // The image is a raw copy of the runtime data and can only be loaded by the
+  // same build with the same set of Systems.
+  DataContainer SaveSnapshot() const;
+
+  // Destroys all existing Entities and restores the state previously saved by
+  // SaveSnapshot. Returns false if the snapshot is invalid, in which case the
+  // runtime may be left partially restored.
+  bool LoadSnapshot(absl::Span<const std::byte> snapshot);
+
   // Associates a ComponentDefT with a SystemT. When a Blueprint contains data
   // for a ComponentDefT, the EntityFactory will pass that data to the given
   // member function of the System, allowing the System to create Components
@@ -105,17 +130,38 @@ class EntityFactory {
  private:
   void UpdateEnableBits(Entity entity, int32_t set_bits, int32_t clear_bits);
 
-  using AddFn = std::function<absl::Status(Entity, const Var&)>;
-  using Metadata = absl::flat_hash_map<Entity, Bits32>;
+  void AddComponents(const BlueprintPtr& blueprint,
+                     absl::Span<const Entity> entities);
+
+  // Reads a ComponentDef from a Var and adds it to all the given Entities.
+  using AddFn =
+      std::function<absl::Status(absl::Span<const Entity>, const Var&)>;
+
+  struct DefInfo {
+    System* system = nullptr;
+    AddFn fn;
+  };
+
+  using Metadata = EntityMap<Bits32>;
+
+  // Slot indices are only recycled once this many are free so that each slot
+  // goes through its generations slowly, making stale Entities that alias a
+  // live one (after the generation wraps around) very unlikely.
+  static constexpr std::size_t kMinFreeIndices = 1024;
+
+  void ReleaseIndex(Entity entity);
 
   Registry* registry_ = nullptr;
-  Entity::Rep entity_generator_ = 0;
   BlueprintFactory blueprint_factory_;
   ScriptEnv env_;
   std::queue<Entity> pending_destruction_;
-  absl::flat_hash_map<Entity, Bits32> metadata_;
+  Metadata metadata_;
+  // The current generation of each slot index. Index 0 is reserved so that
+  // kNullEntity is never created.
+  std::vector<Entity::Rep> generations_;
+  std::deque<Entity::Rep> free_indices_;
   absl::flat_hash_map<TypeId, System*> systems_;
-  absl::flat_hash_map<TypeId, AddFn> add_fns_;
+  absl::flat_hash_map<TypeId, DefInfo> defs_;
 };
 
 template <typename T, typename... Args>
@@ -130,12 +176,17 @@ template <typename DefT, typename SystemT>
 void EntityFactory::RegisterDef(SystemT* system,
                                 void (SystemT::*fn)(Entity, const DefT&)) {
   const TypeId type = GetTypeId<DefT>();
-  add_fns_[type] = [this, system, fn](Entity entity, const Var& component) {
+  DefInfo& info = defs_[type];
+  info.system = system;
+  info.fn = [this, system, fn](absl::Span<const Entity> entities,
+                               const Var& component) {
     ComponentSerializer loader(component, &env_);
     DefT def;
     Serialize(loader, def);
     if (loader.Status().ok()) {
-      (system->*fn)(entity, def);
+      for (Entity entity : entities) {
+        (system->*fn)(entity, def);
+      }
     }
     return loader.Status();
   };
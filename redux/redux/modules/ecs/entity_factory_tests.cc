@@ -14,6 +14,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "redux/modules/ecs/blueprint_factory.h"
@@ -44,9 +49,35 @@ class TestSystem : public System {
     data_[entity] = component.value;
   }
 
+  void OnReserve(std::size_t count) override { reserved_ += count; }
+
   absl::flat_hash_map<Entity, int> data_;
+  std::size_t reserved_ = 0;
 };
 
+TEST(EntityFactoryTest, RecyclesIndices) {
+  Registry registry;
+  auto entity_factory = registry.Create<EntityFactory>(&registry);
+
+  std::vector<Entity> entities;
+  for (int i = 0; i < 2000; ++i) {
+    entities.push_back(entity_factory->Create());
+  }
+  EXPECT_THAT(entities[0].index(), Eq(1));
+  EXPECT_THAT(entities[0].generation(), Eq(0));
+  for (Entity entity : entities) {
+    entity_factory->DestroyNow(entity);
+  }
+
+  // The oldest free slot is reused with a new generation, so the destroyed
+  // Entity stays dead.
+  const Entity entity = entity_factory->Create();
+  EXPECT_THAT(entity.index(), Eq(entities[0].index()));
+  EXPECT_THAT(entity.generation(), Eq(1));
+  EXPECT_TRUE(entity_factory->IsAlive(entity));
+  EXPECT_FALSE(entity_factory->IsAlive(entities[0]));
+}
+
 }  // namespace
 }  // namespace redux
 
@@ -56,6 +87,59 @@ REDUX_SETUP_TYPEID(redux::TestSystem);
 namespace redux {
 namespace {
 
+// Writes `value` over the bytes of `snapshot` at `offset`.
+template <typename T>
+std::vector<std::byte> PatchSnapshot(const DataContainer& snapshot,
+                                     std::size_t offset, T value) {
+  const absl::Span<const std::byte> bytes = snapshot.GetByteSpan();
+  std::vector<std::byte> patched(bytes.begin(), bytes.end());
+  std::memcpy(patched.data() + offset, &value, sizeof(value));
+  return patched;
+}
+
+TEST(EntityFactoryTest, LoadSnapshot) {
+  Registry registry;
+  auto entity_factory = registry.Create<EntityFactory>(&registry);
+  const Entity destroyed = entity_factory->Create();
+  const Entity alive = entity_factory->Create();
+  entity_factory->DestroyNow(destroyed);
+  const DataContainer snapshot = entity_factory->SaveSnapshot();
+
+  Registry other_registry;
+  auto other_factory = other_registry.Create<EntityFactory>(&other_registry);
+  EXPECT_TRUE(other_factory->LoadSnapshot(snapshot.GetByteSpan()));
+  EXPECT_TRUE(other_factory->IsAlive(alive));
+  EXPECT_FALSE(other_factory->IsAlive(destroyed));
+}
+
+TEST(EntityFactoryTest, LoadSnapshotRejectsInvalidFreeIndices) {
+  Registry registry;
+  auto entity_factory = registry.Create<EntityFactory>(&registry);
+  const Entity destroyed = entity_factory->Create();
+  const Entity alive = entity_factory->Create();
+  entity_factory->DestroyNow(destroyed);
+  const DataContainer snapshot = entity_factory->SaveSnapshot();
+
+  // The image starts with the magic, version, number of slots (3) and their
+  // generations, followed by the free list.
+  const std::size_t num_free_offset = 4 + 4 + 8 + 3 * 4;
+  const std::size_t free_index_offset = num_free_offset + 8;
+  const std::vector<std::vector<std::byte>> invalid_snapshots = {
+      PatchSnapshot(snapshot, num_free_offset, uint64_t{1000}),
+      PatchSnapshot(snapshot, free_index_offset, Entity::Rep{0}),
+      PatchSnapshot(snapshot, free_index_offset, Entity::Rep{3}),
+      PatchSnapshot(snapshot, free_index_offset, alive.index()),
+  };
+  for (const auto& invalid : invalid_snapshots) {
+    EXPECT_FALSE(entity_factory->LoadSnapshot(invalid));
+  }
+
+  // The unpatched image is still accepted.
+  EXPECT_TRUE(entity_factory->LoadSnapshot(
+      PatchSnapshot(snapshot, free_index_offset, destroyed.index())));
+  EXPECT_TRUE(entity_factory->IsAlive(alive));
+}
+
 TEST(EntityFactoryTest, Basic) {
   Registry registry;
   auto blueprint_factory = registry.Create<BlueprintFactory>(&registry);
@@ -76,5 +160,29 @@ TEST(EntityFactoryTest, Basic) {
   EXPECT_THAT(test_system->data_[entity], Eq(46));
 }
 
+TEST(EntityFactoryTest, CreateMany) {
+  Registry registry;
+  auto blueprint_factory = registry.Create<BlueprintFactory>(&registry);
+  auto entity_factory = registry.Create<EntityFactory>(&registry);
+  auto test_system = entity_factory->CreateSystem<TestSystem>();
+
+  const char* txt =
+      "{"
+      "  'redux::TestDef': {"
+      "    'value': (+ 12 34),"
+      "  },"
+      "}";
+
+  BlueprintPtr blueprint = blueprint_factory->ReadBlueprint(txt);
+  const std::vector<Entity> entities = entity_factory->Create(blueprint, 10);
+
+  EXPECT_THAT(entities.size(), Eq(10));
+  EXPECT_THAT(test_system->reserved_, Eq(10));
+  for (Entity entity : entities) {
+    EXPECT_TRUE(entity_factory->IsAlive(entity));
+    EXPECT_THAT(test_system->data_[entity], Eq(46));
+  }
+}
+
 }  // namespace
 }  // namespace redux
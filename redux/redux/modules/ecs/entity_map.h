@@ -0,0 +1,169 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_MODULES_ECS_ENTITY_MAP_H_
+#define REDUX_MODULES_ECS_ENTITY_MAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "redux/modules/ecs/entity.h"
+
+namespace redux {
+
+// A map of Entity to T implemented as a sparse set.
+//
+// Values are stored densely (along with their Entity) in a vector, and a
+// second "sparse" vector maps each `Entity::index()` to a position in the
+// dense vector. A lookup is therefore a single array access followed by a
+// comparison of the stored Entity, which also rejects stale Entities whose
+// slot has since been recycled with a newer generation.
+//
+// The interface mirrors the subset of absl::flat_hash_map used by Systems so
+// that it can be used as a drop-in replacement; iteration visits
+// `std::pair<Entity, T>` elements in dense order. Erasing an element moves the
+// last element into its place, so iteration order is not stable and erasure
+// invalidates iterators and references to the last element.
+template <typename T>
+class EntityMap {
+ public:
+  using key_type = Entity;
+  using mapped_type = T;
+  using value_type = std::pair<Entity, T>;
+  using iterator = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  EntityMap() = default;
+
+  iterator begin() { return dense_.begin(); }
+  iterator end() { return dense_.end(); }
+  const_iterator begin() const { return dense_.begin(); }
+  const_iterator end() const { return dense_.end(); }
+
+  std::size_t size() const { return dense_.size(); }
+  bool empty() const { return dense_.empty(); }
+
+  // Returns an iterator to the element for `entity`, or end() if none.
+  iterator find(Entity entity) {
+    const std::size_t pos = Lookup(entity);
+    return pos != kInvalid ? dense_.begin() + pos : dense_.end();
+  }
+
+  // Returns an iterator to the element for `entity`, or end() if none.
+  const_iterator find(Entity entity) const {
+    const std::size_t pos = Lookup(entity);
+    return pos != kInvalid ? dense_.begin() + pos : dense_.end();
+  }
+
+  // Returns true if there is an element for `entity`.
+  bool contains(Entity entity) const { return Lookup(entity) != kInvalid; }
+
+  // Returns the number of elements for `entity` (ie. 0 or 1).
+  std::size_t count(Entity entity) const { return contains(entity) ? 1 : 0; }
+
+  // Returns a pointer to the value for `entity`, or nullptr if none.
+  T* Get(Entity entity) {
+    const std::size_t pos = Lookup(entity);
+    return pos != kInvalid ? &dense_[pos].second : nullptr;
+  }
+
+  // Returns a pointer to the value for `entity`, or nullptr if none.
+  const T* Get(Entity entity) const {
+    const std::size_t pos = Lookup(entity);
+    return pos != kInvalid ? &dense_[pos].second : nullptr;
+  }
+
+  // Constructs the value for `entity` from `args` if it does not already
+  // exist. Returns the iterator to the element and whether it was inserted.
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Entity entity, Args&&... args) {
+    const std::size_t pos = Lookup(entity);
+    if (pos != kInvalid) {
+      return {dense_.begin() + pos, false};
+    }
+    const Entity::Rep index = entity.index();
+    if (index >= sparse_.size()) {
+      sparse_.resize(index + 1, 0);
+    } else if (sparse_[index] != 0) {
+      // The slot is held by an older generation of the Entity that was never
+      // removed; evict it so that it cannot alias the new Entity.
+      EraseAt(sparse_[index] - 1);
+    }
+    dense_.emplace_back(std::piecewise_construct, std::forward_as_tuple(entity),
+                        std::forward_as_tuple(std::forward<Args>(args)...));
+    sparse_[index] = static_cast<std::uint32_t>(dense_.size());
+    return {dense_.end() - 1, true};
+  }
+
+  // Returns the value for `entity`, default constructing it if needed.
+  T& operator[](Entity entity) { return try_emplace(entity).first->second; }
+
+  // Removes the element for `entity`. Returns the number of elements removed.
+  std::size_t erase(Entity entity) {
+    const std::size_t pos = Lookup(entity);
+    if (pos == kInvalid) {
+      return 0;
+    }
+    EraseAt(pos);
+    return 1;
+  }
+
+  // Removes the element at `iter`.
+  void erase(const_iterator iter) {
+    EraseAt(static_cast<std::size_t>(iter - dense_.cbegin()));
+  }
+
+  // Removes all elements.
+  void clear() {
+    dense_.clear();
+    sparse_.clear();
+  }
+
+  // Reserves space in the dense storage for `count` elements.
+  void reserve(std::size_t count) { dense_.reserve(count); }
+
+ private:
+  static constexpr std::size_t kInvalid = ~std::size_t(0);
+
+  std::size_t Lookup(Entity entity) const {
+    const Entity::Rep index = entity.index();
+    if (index >= sparse_.size() || sparse_[index] == 0) {
+      return kInvalid;
+    }
+    const std::size_t pos = sparse_[index] - 1;
+    return dense_[pos].first == entity ? pos : kInvalid;
+  }
+
+  void EraseAt(std::size_t pos) {
+    sparse_[dense_[pos].first.index()] = 0;
+    if (pos + 1 != dense_.size()) {
+      dense_[pos] = std::move(dense_.back());
+      sparse_[dense_[pos].first.index()] = static_cast<std::uint32_t>(pos + 1);
+    }
+    dense_.pop_back();
+  }
+
+  // Dense position + 1 for each Entity index; 0 means no element.
+  std::vector<std::uint32_t> sparse_;
+  std::vector<value_type> dense_;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_MODULES_ECS_ENTITY_MAP_H_
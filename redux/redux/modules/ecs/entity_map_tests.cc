@@ -0,0 +1,107 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/ecs/entity_map.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::NotNull;
+
+TEST(EntityTest, IndexAndGeneration) {
+  const Entity entity = Entity::FromIndex(123, 4);
+  EXPECT_THAT(entity.index(), Eq(123));
+  EXPECT_THAT(entity.generation(), Eq(4));
+  EXPECT_THAT(Entity(7).index(), Eq(7));
+  EXPECT_THAT(Entity(7).generation(), Eq(0));
+  EXPECT_TRUE(Entity::FromIndex(123, 4) != Entity::FromIndex(123, 5));
+}
+
+TEST(EntityMapTest, InsertFindErase) {
+  EntityMap<std::string> map;
+  EXPECT_TRUE(map.empty());
+
+  map[Entity(1)] = "one";
+  map.try_emplace(Entity(5), "five");
+  EXPECT_THAT(map.size(), Eq(2));
+  EXPECT_TRUE(map.contains(Entity(1)));
+  EXPECT_FALSE(map.contains(Entity(2)));
+  EXPECT_THAT(map.find(Entity(5))->second, Eq("five"));
+  EXPECT_TRUE(map.find(Entity(100)) == map.end());
+
+  EXPECT_FALSE(map.try_emplace(Entity(5), "other").second);
+  EXPECT_THAT(*map.Get(Entity(5)), Eq("five"));
+
+  EXPECT_THAT(map.erase(Entity(1)), Eq(1));
+  EXPECT_THAT(map.erase(Entity(1)), Eq(0));
+  EXPECT_THAT(map.Get(Entity(1)), IsNull());
+  EXPECT_THAT(*map.Get(Entity(5)), Eq("five"));
+  EXPECT_THAT(map.size(), Eq(1));
+}
+
+TEST(EntityMapTest, RejectsStaleGenerations) {
+  EntityMap<int> map;
+  const Entity old_entity = Entity::FromIndex(3, 0);
+  const Entity new_entity = Entity::FromIndex(3, 1);
+
+  map[old_entity] = 1;
+  EXPECT_THAT(map.Get(new_entity), IsNull());
+
+  // Inserting a newer generation evicts the stale element.
+  map[new_entity] = 2;
+  EXPECT_THAT(map.Get(old_entity), IsNull());
+  ASSERT_THAT(map.Get(new_entity), NotNull());
+  EXPECT_THAT(*map.Get(new_entity), Eq(2));
+  EXPECT_THAT(map.size(), Eq(1));
+}
+
+TEST(EntityMapTest, Iteration) {
+  EntityMap<int> map;
+  for (Entity::Rep i = 1; i <= 100; ++i) {
+    map[Entity(i)] = static_cast<int>(i);
+  }
+  for (Entity::Rep i = 1; i <= 100; i += 2) {
+    map.erase(Entity(i));
+  }
+
+  int count = 0;
+  for (const auto& iter : map) {
+    EXPECT_THAT(iter.first.get() % 2, Eq(0));
+    EXPECT_THAT(iter.second, Eq(static_cast<int>(iter.first.get())));
+    ++count;
+  }
+  EXPECT_THAT(count, Eq(50));
+  for (Entity::Rep i = 2; i <= 100; i += 2) {
+    ASSERT_THAT(map.Get(Entity(i)), NotNull());
+    EXPECT_THAT(*map.Get(Entity(i)), Eq(static_cast<int>(i)));
+  }
+
+  map.erase(map.find(Entity(2)));
+  EXPECT_FALSE(map.contains(Entity(2)));
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.contains(Entity(4)));
+}
+
+}  // namespace
+}  // namespace redux
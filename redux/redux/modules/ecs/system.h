@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "redux/modules/base/function_traits.h"
 #include "redux/modules/base/registry.h"
+#include "redux/modules/base/snapshot.h"
 #include "redux/modules/base/static_registry.h"
 #include "redux/modules/ecs/entity.h"
 #include "redux/modules/ecs/entity_factory.h"
@@ -61,6 +62,20 @@ class System {
   // Disables all Components associated with the `entity`.
   virtual void OnDisable(Entity entity) {}
 
+  // Called before `count` Entities are created from a Blueprint that contains
+  // a ComponentDef registered by this System, allowing the System to reserve
+  // storage for the new Components.
+  virtual void OnReserve(std::size_t count) {}
+
+  // Writes all Component data owned by the System into `writer`. Called by
+  // EntityFactory::SaveSnapshot.
+  virtual void SaveSnapshot(SnapshotWriter& writer) const {}
+
+  // Replaces all Component data owned by the System with the data previously
+  // written by SaveSnapshot. Returns false if the data could not be read.
+  // Called by EntityFactory::LoadSnapshot.
+  virtual bool LoadSnapshot(SnapshotReader& reader) { return true; }
+
   // Wrapper around EntityFactory::IsEnabled.
   bool IsEntityEnabled(Entity entity) const {
     const EntityFactory* entity_factory = GetEntityFactory();
@@ -16,10 +16,24 @@ limitations under the License.
 
 #include "redux/modules/graphics/image_atlaser.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "redux/modules/base/data_builder.h"
 #include "redux/modules/graphics/image_utils.h"
 
 namespace redux {
 
+// Once there are this many separate dirty rects, they are collapsed into a
+// single rect (ie. the whole dirty region).
+static constexpr std::size_t kMaxDirtyRects = 16;
+
+// Returns true if the two rects overlap or share an edge.
+static bool Touches(const Bounds2i& a, const Bounds2i& b) {
+  return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y &&
+         b.min.y <= a.max.y;
+}
+
 ImageAtlaser::ImageAtlaser(ImageFormat format, const vec2i& size, int padding)
     : size_(size), format_(format), padding_(padding) {
   // To begin, there is a single skyline that spans the bottom of the bin.
@@ -28,17 +42,111 @@ ImageAtlaser::ImageAtlaser(ImageFormat format, const vec2i& size, int padding)
   const int bytes_per_pixel = GetBitsPerPixel(format) / 8;
   const int num_bytes = size.x * size.y * bytes_per_pixel;
   pixels_ = std::make_unique<std::byte[]>(num_bytes);
+
+  // The initial (empty) contents of the atlas have never been consumed.
+  MarkAllDirty();
+}
+
+void ImageAtlaser::Clear() {
+  subimages_.clear();
+  skyline_.clear();
+  skyline_.emplace_back(0, 0, size_.x);
+
+  const int bytes_per_pixel = GetBitsPerPixel(format_) / 8;
+  const int num_bytes = size_.x * size_.y * bytes_per_pixel;
+  std::memset(pixels_.get(), 0, num_bytes);
+  MarkAllDirty();
+}
+
+void ImageAtlaser::Load(const ImageData& image,
+                        absl::Span<const SubimageBounds> subimages) {
+  CHECK(image.GetFormat() == format_)
+      << "Invalid image format: " << ToString(image.GetFormat());
+  CHECK(image.GetSize() == size_);
+
+  subimages_.clear();
+  int top = 0;
+  for (const SubimageBounds& subimage : subimages) {
+    const Bounds2i& rect = subimage.second;
+    CHECK(rect.min.x >= 0 && rect.min.y >= 0);
+    CHECK(rect.max.x <= size_.x && rect.max.y <= size_.y);
+    Subimage& entry = subimages_[subimage.first];
+    entry.uv = Bounds2f(ToUv(rect.min), ToUv(rect.max));
+    entry.rect = rect;
+    top = std::max(top, std::min(rect.max.y + padding_, size_.y));
+  }
+
+  // The gaps between the loaded subimages are not tracked, so the skyline
+  // spans the top of the tallest one.
+  skyline_.clear();
+  skyline_.emplace_back(0, top, size_.x);
+
+  CopySubimage(image, vec2i::Zero());
+  MarkAllDirty();
+}
+
+const Bounds2i& ImageAtlaser::GetDirtyRegion() const { return dirty_region_; }
+
+absl::Span<const Bounds2i> ImageAtlaser::GetDirtyRects() const {
+  return dirty_rects_;
+}
+
+bool ImageAtlaser::IsDirty() const {
+  return dirty_region_.min.x < dirty_region_.max.x &&
+         dirty_region_.min.y < dirty_region_.max.y;
+}
+
+void ImageAtlaser::ClearDirtyRegion() {
+  dirty_region_ = Bounds2i::Empty();
+  dirty_rects_.clear();
+}
+
+void ImageAtlaser::MarkAllDirty() {
+  dirty_region_ = Bounds2i(vec2i::Zero(), size_);
+  dirty_rects_.assign(1, dirty_region_);
+}
+
+void ImageAtlaser::MarkDirty(const Bounds2i& rect) {
+  dirty_region_ = dirty_region_.Included(rect.min).Included(rect.max);
+
+  // Absorb every rect that the new one touches, restarting whenever the merged
+  // rect grows since it may then touch rects that were already checked.
+  Bounds2i merged = rect;
+  for (std::size_t i = 0; i < dirty_rects_.size();) {
+    if (Touches(merged, dirty_rects_[i])) {
+      merged = merged.Included(dirty_rects_[i].min)
+                   .Included(dirty_rects_[i].max);
+      dirty_rects_[i] = dirty_rects_.back();
+      dirty_rects_.pop_back();
+      i = 0;
+    } else {
+      ++i;
+    }
+  }
+
+  if (dirty_rects_.size() + 1 >= kMaxDirtyRects) {
+    dirty_rects_.assign(1, dirty_region_);
+  } else {
+    dirty_rects_.push_back(merged);
+  }
 }
 
 vec2i ImageAtlaser::GetSize() const { return size_; }
 
-std::size_t ImageAtlaser::GetNumSubimages() const { return uvs_.size(); }
+std::size_t ImageAtlaser::GetNumSubimages() const { return subimages_.size(); }
 
-bool ImageAtlaser::Contains(HashValue id) const { return uvs_.contains(id); }
+bool ImageAtlaser::Contains(HashValue id) const {
+  return subimages_.contains(id);
+}
 
 Bounds2f ImageAtlaser::GetUvBounds(HashValue id) const {
-  auto iter = uvs_.find(id);
-  return iter != uvs_.end() ? iter->second : Bounds2f();
+  auto iter = subimages_.find(id);
+  return iter != subimages_.end() ? iter->second.uv : Bounds2f();
+}
+
+Bounds2i ImageAtlaser::GetBounds(HashValue id) const {
+  auto iter = subimages_.find(id);
+  return iter != subimages_.end() ? iter->second.rect : Bounds2i();
 }
 
 ImageData ImageAtlaser::GetImageData() const {
@@ -48,6 +156,26 @@ ImageData ImageAtlaser::GetImageData() const {
   return ImageData(format_, size_, std::move(data));
 }
 
+ImageData ImageAtlaser::GetImageData(const Bounds2i& region) const {
+  CHECK(region.min.x >= 0 && region.min.y >= 0);
+  CHECK(region.max.x <= size_.x && region.max.y <= size_.y);
+  const vec2i size = region.Size();
+  CHECK(size.x > 0 && size.y > 0);
+
+  const int bytes_per_pixel = GetBitsPerPixel(format_) / 8;
+  const int bytes_per_row = size.x * bytes_per_pixel;
+  const int src_stride = size_.x * bytes_per_pixel;
+
+  DataBuilder data(bytes_per_row * size.y);
+  const std::byte* src_row = pixels_.get() + (region.min.y * src_stride) +
+                             (region.min.x * bytes_per_pixel);
+  for (int y = 0; y < size.y; ++y) {
+    data.Append(src_row, bytes_per_row);
+    src_row += src_stride;
+  }
+  return ImageData(format_, size, data.Release(), bytes_per_row);
+}
+
 vec2 ImageAtlaser::ToUv(const vec2i pos) const {
   const float u = static_cast<float>(pos.x) / static_cast<float>(size_.x);
   const float v = static_cast<float>(pos.y) / static_cast<float>(size_.y);
@@ -58,13 +186,22 @@ ImageAtlaser::AddResult ImageAtlaser::Add(HashValue id,
                                           const ImageData& subimage) {
   CHECK(subimage.GetFormat() == format_)
       << "Invalid image format: " << ToString(subimage.GetFormat());
-  if (uvs_.contains(id)) {
+  const AddResult result = Reserve(id, subimage.GetSize());
+  if (result == kAddSuccessful) {
+    Update(id, subimage);
+  }
+  return result;
+}
+
+ImageAtlaser::AddResult ImageAtlaser::Reserve(HashValue id,
+                                              const vec2i& subimage_size) {
+  if (subimages_.contains(id)) {
     return kAlreadyExists;
   }
 
   vec2i pos = {0, 0};
   std::size_t index = 0;
-  vec2i size = subimage.GetSize() + vec2i(2 * padding_);
+  vec2i size = subimage_size + vec2i(2 * padding_);
   while (!FindSegment(size, &index, &pos)) {
     return kNoMoreSpace;
   }
@@ -72,12 +209,28 @@ ImageAtlaser::AddResult ImageAtlaser::Add(HashValue id,
   AddSkyline(index, pos, size);
 
   const vec2i uv_min = pos + vec2i(padding_, padding_);
-  const vec2i uv_max = uv_min + subimage.GetSize();
-  CopySubimage(subimage, uv_min);
-  uvs_.emplace(id, Bounds2f(ToUv(uv_min), ToUv(uv_max)));
+  const vec2i uv_max = uv_min + subimage_size;
+  Subimage& entry = subimages_[id];
+  entry.uv = Bounds2f(ToUv(uv_min), ToUv(uv_max));
+  entry.rect = Bounds2i(uv_min, uv_max);
   return kAddSuccessful;
 }
 
+bool ImageAtlaser::Update(HashValue id, const ImageData& subimage) {
+  CHECK(subimage.GetFormat() == format_)
+      << "Invalid image format: " << ToString(subimage.GetFormat());
+  auto iter = subimages_.find(id);
+  if (iter == subimages_.end()) {
+    return false;
+  }
+
+  const Bounds2i& rect = iter->second.rect;
+  CHECK(subimage.GetSize() == rect.Size());
+  CopySubimage(subimage, rect.min);
+  MarkDirty(rect);
+  return true;
+}
+
 void ImageAtlaser::CopySubimage(const ImageData& subimage, const vec2i& pos) {
   const vec2i size = subimage.GetSize();
   CHECK(pos.x + size.x <= size_.x);
@@ -19,9 +19,11 @@ limitations under the License.
 
 #include <cstddef>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "redux/modules/base/data_container.h"
 #include "redux/modules/base/hash.h"
 #include "redux/modules/graphics/enums.h"
@@ -50,6 +52,28 @@ class ImageAtlaser {
   // Adds an image to the atlas with the given key id.
   AddResult Add(HashValue id, const ImageData& subimage);
 
+  // Reserves space in the atlas for an image of the given `size` without
+  // providing its contents. The reserved space is blank until Update is called.
+  AddResult Reserve(HashValue id, const vec2i& size);
+
+  // Replaces the contents of an image in the atlas, eg. one that was previously
+  // reserved. The `subimage` must have the same size as the image in the atlas.
+  // Returns false if there is no image with the given key id.
+  bool Update(HashValue id, const ImageData& subimage);
+
+  // Removes all images from the atlas, making its entire area available for
+  // new images. The whole atlas is marked as dirty.
+  void Clear();
+
+  // The key id of an image and its bounds (in pixels) within the atlas.
+  using SubimageBounds = std::pair<HashValue, Bounds2i>;
+
+  // Replaces the contents of the atlas with a previously packed `image` (eg.
+  // one that was generated offline) that contains the given `subimages`. The
+  // `image` must have the same format and size as the atlas. Images added
+  // afterwards are placed above all of the given subimages.
+  void Load(const ImageData& image, absl::Span<const SubimageBounds> subimages);
+
   // Returns the number of images contained within the atlas.
   size_t GetNumSubimages() const;
 
@@ -61,12 +85,36 @@ class ImageAtlaser {
   // corner of the atlas.)
   Bounds2f GetUvBounds(HashValue id) const;
 
+  // Returns the Bounds (in pixels) of the image within the atlas.
+  Bounds2i GetBounds(HashValue id) const;
+
   // Returns the dimensions of the image atlas.
   vec2i GetSize() const;
 
   // Returns the image data for the atlas itself.
   ImageData GetImageData() const;
 
+  // Returns a copy of the pixels of the atlas within the given `region`.
+  ImageData GetImageData(const Bounds2i& region) const;
+
+  // Returns the region (in pixels) of the atlas that has been modified since
+  // the atlas was created or since the last call to ClearDirtyRegion. The
+  // region is Bounds2i::Empty() if nothing has been modified.
+  const Bounds2i& GetDirtyRegion() const;
+
+  // Returns the modified parts of the atlas as a list of non-overlapping
+  // rectangles, all of which are within GetDirtyRegion. Uploading just these
+  // rectangles avoids re-uploading the unmodified pixels between them. Images
+  // placed next to each other are merged into a single rectangle.
+  absl::Span<const Bounds2i> GetDirtyRects() const;
+
+  // Returns true if any part of the atlas has been modified since the atlas
+  // was created or since the last call to ClearDirtyRegion.
+  bool IsDirty() const;
+
+  // Resets the dirty region, eg. once the modified pixels have been uploaded.
+  void ClearDirtyRegion();
+
  private:
   static constexpr std::size_t kInvalidIndex = -1;
 
@@ -111,14 +159,26 @@ class ImageAtlaser {
   void TryMergingNeighbors(std::size_t left, std::size_t right);
 
   void CopySubimage(const ImageData& subimage, const vec2i& pos);
-  void CopyPixel(const ImageData& subimage, const vec2i& pos, int x, int y);
+
+  // Adds `rect` to the dirty region and list of dirty rects.
+  void MarkDirty(const Bounds2i& rect);
+
+  // Marks the entire atlas as dirty.
+  void MarkAllDirty();
 
   // Converts a position in the image array into a uv co-ordinate.
   vec2 ToUv(const vec2i pos) const;
 
-  absl::flat_hash_map<HashValue, Bounds2f> uvs_;
+  struct Subimage {
+    Bounds2f uv;
+    Bounds2i rect;
+  };
+
+  absl::flat_hash_map<HashValue, Subimage> subimages_;
   std::unique_ptr<std::byte[]> pixels_;
   std::vector<SkylineSegment> skyline_;
+  Bounds2i dirty_region_ = Bounds2i::Empty();
+  std::vector<Bounds2i> dirty_rects_;
   vec2i size_;
   ImageFormat format_;
   int padding_ = 0;
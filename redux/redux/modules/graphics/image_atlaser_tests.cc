@@ -94,5 +94,146 @@ TEST(ImageAtlaserTest, RejectTooLarge) {
   ImageData image = MakeImage(vec2i(20, 20));
   EXPECT_THAT(atlas.Add(key, image), Eq(ImageAtlaser::kNoMoreSpace));
 }
+
+TEST(ImageAtlaserTest, Clear) {
+  ImageAtlaser atlas(ImageFormat::Alpha8, vec2i(10, 10));
+
+  HashValue key1(1);
+  HashValue key2(2);
+  ImageData image = MakeImage(vec2i(10, 10));
+  EXPECT_THAT(atlas.Add(key1, image), Eq(ImageAtlaser::kAddSuccessful));
+  EXPECT_THAT(atlas.Add(key2, image), Eq(ImageAtlaser::kNoMoreSpace));
+
+  atlas.Clear();
+  EXPECT_THAT(atlas.GetNumSubimages(), Eq(0));
+  EXPECT_FALSE(atlas.Contains(key1));
+  EXPECT_THAT(atlas.Add(key2, image), Eq(ImageAtlaser::kAddSuccessful));
+}
+
+TEST(ImageAtlaserTest, DirtyRegion) {
+  ImageAtlaser atlas(ImageFormat::Alpha8, vec2i(10, 10));
+  EXPECT_TRUE(atlas.IsDirty());
+  EXPECT_THAT(atlas.GetDirtyRegion(),
+              Eq(Bounds2i(vec2i::Zero(), vec2i(10, 10))));
+
+  atlas.ClearDirtyRegion();
+  EXPECT_FALSE(atlas.IsDirty());
+
+  atlas.Add(HashValue(1), MakeImage(vec2i(4, 3)));
+  EXPECT_TRUE(atlas.IsDirty());
+  EXPECT_THAT(atlas.GetDirtyRegion(), Eq(Bounds2i(vec2i(0, 0), vec2i(4, 3))));
+
+  atlas.Add(HashValue(2), MakeImage(vec2i(2, 2)));
+  EXPECT_THAT(atlas.GetDirtyRegion(), Eq(Bounds2i(vec2i(0, 0), vec2i(6, 3))));
+
+  atlas.ClearDirtyRegion();
+  atlas.Clear();
+  EXPECT_THAT(atlas.GetDirtyRegion(),
+              Eq(Bounds2i(vec2i::Zero(), vec2i(10, 10))));
+}
+
+TEST(ImageAtlaserTest, DirtyRects) {
+  ImageAtlaser atlas(ImageFormat::Alpha8, vec2i(16, 16), 2);
+  ASSERT_THAT(atlas.GetDirtyRects().size(), Eq(1));
+  EXPECT_THAT(atlas.GetDirtyRects()[0],
+              Eq(Bounds2i(vec2i::Zero(), vec2i(16, 16))));
+
+  atlas.ClearDirtyRegion();
+  EXPECT_TRUE(atlas.GetDirtyRects().empty());
+
+  // The padding keeps the two images apart, so the pixels between them do not
+  // need to be uploaded.
+  atlas.Add(HashValue(1), MakeImage(vec2i(4, 3)));
+  atlas.Add(HashValue(2), MakeImage(vec2i(2, 2)));
+  ASSERT_THAT(atlas.GetDirtyRects().size(), Eq(2));
+  EXPECT_THAT(atlas.GetDirtyRects()[0],
+              Eq(Bounds2i(vec2i(2, 2), vec2i(6, 5))));
+  EXPECT_THAT(atlas.GetDirtyRects()[1],
+              Eq(Bounds2i(vec2i(10, 2), vec2i(12, 4))));
+  EXPECT_THAT(atlas.GetDirtyRegion(), Eq(Bounds2i(vec2i(2, 2), vec2i(12, 5))));
+
+  // Updating an image that is already dirty does not add another rect.
+  atlas.Update(HashValue(1), MakeImage(vec2i(4, 3)));
+  EXPECT_THAT(atlas.GetDirtyRects().size(), Eq(2));
+
+  atlas.ClearDirtyRegion();
+  EXPECT_TRUE(atlas.GetDirtyRects().empty());
+}
+
+TEST(ImageAtlaserTest, GetRegionImageData) {
+  ImageAtlaser atlas(ImageFormat::Alpha8, vec2i(10, 10));
+
+  DataBuilder data(4);
+  data.Append<uint8_t>({1, 2, 3, 4});
+  const ImageData image(ImageFormat::Alpha8, vec2i(2, 2), data.Release());
+  atlas.Add(HashValue(1), image);
+
+  const ImageData region =
+      atlas.GetImageData(Bounds2i(vec2i(1, 0), vec2i(3, 2)));
+  EXPECT_THAT(region.GetSize(), Eq(vec2i(2, 2)));
+  ASSERT_THAT(region.GetNumBytes(), Eq(4));
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(region.GetData());
+  EXPECT_THAT(bytes[0], Eq(2));
+  EXPECT_THAT(bytes[1], Eq(0));
+  EXPECT_THAT(bytes[2], Eq(4));
+  EXPECT_THAT(bytes[3], Eq(0));
+}
+
+TEST(ImageAtlaserTest, ReserveAndUpdate) {
+  ImageAtlaser atlas(ImageFormat::Alpha8, vec2i(10, 10));
+  atlas.ClearDirtyRegion();
+
+  HashValue key(1);
+  EXPECT_THAT(atlas.Reserve(key, vec2i(2, 2)),
+              Eq(ImageAtlaser::kAddSuccessful));
+  EXPECT_TRUE(atlas.Contains(key));
+  EXPECT_FALSE(atlas.IsDirty());
+  EXPECT_THAT(atlas.Reserve(key, vec2i(2, 2)),
+              Eq(ImageAtlaser::kAlreadyExists));
+
+  DataBuilder data(4);
+  data.Append<uint8_t>({1, 2, 3, 4});
+  const ImageData image(ImageFormat::Alpha8, vec2i(2, 2), data.Release());
+  EXPECT_TRUE(atlas.Update(key, image));
+  EXPECT_FALSE(atlas.Update(HashValue(2), image));
+  EXPECT_THAT(atlas.GetDirtyRegion(), Eq(Bounds2i(vec2i(0, 0), vec2i(2, 2))));
+
+  const ImageData region =
+      atlas.GetImageData(Bounds2i(vec2i(0, 0), vec2i(2, 2)));
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(region.GetData());
+  EXPECT_THAT(bytes[0], Eq(1));
+  EXPECT_THAT(bytes[3], Eq(4));
+}
+
+TEST(ImageAtlaserTest, Load) {
+  ImageAtlaser src(ImageFormat::Alpha8, vec2i(10, 10));
+  DataBuilder data(4);
+  data.Append<uint8_t>({1, 2, 3, 4});
+  const ImageData image(ImageFormat::Alpha8, vec2i(2, 2), data.Release());
+  EXPECT_THAT(src.Add(HashValue(1), image), Eq(ImageAtlaser::kAddSuccessful));
+  EXPECT_THAT(src.Add(HashValue(2), MakeImage(vec2i(3, 4))),
+              Eq(ImageAtlaser::kAddSuccessful));
+
+  const std::vector<ImageAtlaser::SubimageBounds> subimages = {
+      {HashValue(1), src.GetBounds(HashValue(1))},
+      {HashValue(2), src.GetBounds(HashValue(2))},
+  };
+  ImageAtlaser atlas(ImageFormat::Alpha8, vec2i(10, 10));
+  atlas.Load(src.GetImageData(), subimages);
+  EXPECT_THAT(atlas.GetNumSubimages(), Eq(2));
+  EXPECT_THAT(atlas.GetUvBounds(HashValue(1)),
+              Eq(src.GetUvBounds(HashValue(1))));
+  EXPECT_THAT(atlas.GetBounds(HashValue(2)), Eq(src.GetBounds(HashValue(2))));
+
+  const ImageData region = atlas.GetImageData(atlas.GetBounds(HashValue(1)));
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(region.GetData());
+  EXPECT_THAT(bytes[0], Eq(1));
+  EXPECT_THAT(bytes[3], Eq(4));
+
+  // New images are placed above the loaded ones.
+  EXPECT_THAT(atlas.Add(HashValue(3), MakeImage(vec2i(2, 2))),
+              Eq(ImageAtlaser::kAddSuccessful));
+  EXPECT_THAT(atlas.GetBounds(HashValue(3)).min.y, Eq(4));
+}
 }  // namespace
 }  // namespace redux
@@ -17,8 +17,19 @@ limitations under the License.
 #include "redux/modules/graphics/image_utils.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 
+#include "redux/modules/base/logging.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define REDUX_IMAGE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define REDUX_IMAGE_NEON 1
+#endif
+
 namespace redux {
 
 static constexpr std::size_t kBitsPerByte = 8;
@@ -144,4 +155,140 @@ bool IsContainerFormat(ImageFormat format) {
   return format == ImageFormat::Ktx;
 }
 
+static constexpr std::uint8_t kOpaque = 255;
+
+// Returns `x` * `alpha` / 255, rounded down.
+static std::uint8_t MultiplyByAlpha(std::uint8_t x, std::uint8_t alpha) {
+  const auto product =
+      static_cast<std::uint16_t>(x) * static_cast<std::uint16_t>(alpha);
+  return static_cast<std::uint8_t>(product / 255);
+}
+
+#if defined(REDUX_IMAGE_SSE2)
+// Divides each 16-bit lane (which must be at most 255 * 255) by 255, rounding
+// down. For such values, x / 255 == (x * 0x8081) >> 23.
+static __m128i DivideBy255(__m128i x) {
+  const __m128i kMagic = _mm_set1_epi16(static_cast<short>(0x8081));
+  return _mm_srli_epi16(_mm_mulhi_epu16(x, kMagic), 7);
+}
+
+// Multiplies the RGB lanes of the two RGBA pixels in `x` (one channel per
+// 16-bit lane) by their alpha lane. Alpha lanes are multiplied by 255 so that
+// they are unchanged by DivideBy255.
+static __m128i MultiplyByAlpha(__m128i x) {
+  const __m128i kRgbMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+  const __m128i kAlphaOne = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+  __m128i alpha = _mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3));
+  alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+  alpha = _mm_or_si128(_mm_and_si128(alpha, kRgbMask), kAlphaOne);
+  return DivideBy255(_mm_mullo_epi16(x, alpha));
+}
+#elif defined(REDUX_IMAGE_NEON)
+// Divides each 16-bit lane (which must be at most 255 * 255) by 255, rounding
+// down, and narrows the result to 8 bits. For such values,
+// x / 255 == ((x + 1) + ((x + 1) >> 8)) >> 8.
+static uint8x8_t DivideBy255(uint16x8_t x) {
+  const uint16x8_t t = vaddq_u16(x, vdupq_n_u16(1));
+  return vshrn_n_u16(vsraq_n_u16(t, t, 8), 8);
+}
+
+static uint8x16_t MultiplyByAlpha(uint8x16_t x, uint8x16_t alpha) {
+  const uint16x8_t lo = vmull_u8(vget_low_u8(x), vget_low_u8(alpha));
+  const uint16x8_t hi = vmull_u8(vget_high_u8(x), vget_high_u8(alpha));
+  return vcombine_u8(DivideBy255(lo), DivideBy255(hi));
+}
+#endif
+
+void MultiplyRgbByAlpha(std::uint8_t* data, const vec2i& size) {
+  const int num_pixels = size.x * size.y;
+  int i = 0;
+#if defined(REDUX_IMAGE_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 4 <= num_pixels; i += 4) {
+    __m128i* ptr = reinterpret_cast<__m128i*>(data + 4 * i);
+    const __m128i pixels = _mm_loadu_si128(ptr);
+    const __m128i lo = MultiplyByAlpha(_mm_unpacklo_epi8(pixels, zero));
+    const __m128i hi = MultiplyByAlpha(_mm_unpackhi_epi8(pixels, zero));
+    _mm_storeu_si128(ptr, _mm_packus_epi16(lo, hi));
+  }
+#elif defined(REDUX_IMAGE_NEON)
+  for (; i + 16 <= num_pixels; i += 16) {
+    uint8x16x4_t pixels = vld4q_u8(data + 4 * i);
+    pixels.val[0] = MultiplyByAlpha(pixels.val[0], pixels.val[3]);
+    pixels.val[1] = MultiplyByAlpha(pixels.val[1], pixels.val[3]);
+    pixels.val[2] = MultiplyByAlpha(pixels.val[2], pixels.val[3]);
+    vst4q_u8(data + 4 * i, pixels);
+  }
+#endif
+  for (data += 4 * i; i < num_pixels; ++i, data += 4) {
+    data[0] = MultiplyByAlpha(data[0], data[3]);
+    data[1] = MultiplyByAlpha(data[1], data[3]);
+    data[2] = MultiplyByAlpha(data[2], data[3]);
+  }
+}
+
+void ConvertRgb888ToRgba8888(const std::uint8_t* src, const vec2i& size,
+                             std::uint8_t* dst) {
+  CHECK(src != nullptr && dst != nullptr) << "Invalid RGB to RGBA conversion.";
+
+  const int num_pixels = size.x * size.y;
+  int i = 0;
+#if defined(REDUX_IMAGE_NEON)
+  for (; i + 16 <= num_pixels; i += 16) {
+    const uint8x16x3_t rgb = vld3q_u8(src + 3 * i);
+    const uint8x16x4_t rgba = {
+        {rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(kOpaque)}};
+    vst4q_u8(dst + 4 * i, rgba);
+  }
+#else
+  // Copy each pixel as a single 32-bit word, which also picks up the first
+  // byte of the next pixel, and then overwrite that byte with the alpha. The
+  // last pixel is left to the loop below to avoid reading past the source.
+  const std::uint8_t alpha_bytes[4] = {0, 0, 0, kOpaque};
+  std::uint32_t alpha_mask;
+  std::memcpy(&alpha_mask, alpha_bytes, sizeof(alpha_mask));
+  const std::uint32_t rgb_mask = ~alpha_mask;
+  for (; i + 1 < num_pixels; ++i) {
+    std::uint32_t pixel;
+    std::memcpy(&pixel, src + 3 * i, sizeof(pixel));
+    pixel = (pixel & rgb_mask) | alpha_mask;
+    std::memcpy(dst + 4 * i, &pixel, sizeof(pixel));
+  }
+#endif
+  for (; i < num_pixels; ++i) {
+    dst[4 * i + 0] = src[3 * i + 0];
+    dst[4 * i + 1] = src[3 * i + 1];
+    dst[4 * i + 2] = src[3 * i + 2];
+    dst[4 * i + 3] = kOpaque;
+  }
+}
+
+void ConvertRgb888ToRgba8888InPlace(std::uint8_t* data, const vec2i& size) {
+  CHECK(data != nullptr) << "Failed to convert RGB to RGBA.";
+
+  // Pixels are expanded back to front: the destination of a pixel never
+  // overlaps the source of any pixel before it, so no source pixel is
+  // overwritten before it has been read.
+  int i = size.x * size.y;
+#if defined(REDUX_IMAGE_NEON)
+  while (i >= 16) {
+    i -= 16;
+    const uint8x16x3_t rgb = vld3q_u8(data + 3 * i);
+    const uint8x16x4_t rgba = {
+        {rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(kOpaque)}};
+    vst4q_u8(data + 4 * i, rgba);
+  }
+#endif
+  while (i > 0) {
+    --i;
+    const std::uint8_t r = data[3 * i + 0];
+    const std::uint8_t g = data[3 * i + 1];
+    const std::uint8_t b = data[3 * i + 2];
+    data[4 * i + 0] = r;
+    data[4 * i + 1] = g;
+    data[4 * i + 2] = b;
+    data[4 * i + 3] = kOpaque;
+  }
+}
+
 }  // namespace redux
@@ -18,6 +18,8 @@ limitations under the License.
 #define REDUX_MODULES_GRAPHICS_IMAGE_UTILS_H_
 
 #include <cstddef>
+#include <cstdint>
+
 #include "absl/types/span.h"
 #include "redux/modules/graphics/enums.h"
 #include "redux/modules/math/vector.h"
@@ -54,6 +56,21 @@ bool IsCompressedFormat(ImageFormat format);
 // Returns true if the format is for a container (eg. ktx) image type.
 bool IsContainerFormat(ImageFormat format);
 
+// Multiplies the RGB components of the `size.x` x `size.y` RGBA pixels at
+// `data` by their alpha component. Pixels are processed independently, so a
+// large image can be split into bands of rows that are processed in parallel.
+void MultiplyRgbByAlpha(std::uint8_t* data, const vec2i& size);
+
+// Converts the `size.x` x `size.y` RGB pixels at `src` into RGBA pixels at
+// `dst`, with an alpha of 255.
+void ConvertRgb888ToRgba8888(const std::uint8_t* src, const vec2i& size,
+                             std::uint8_t* dst);
+
+// As above, but converts the RGB pixels at the start of `data` in place, which
+// avoids allocating a second image. `data` must be large enough to hold the
+// resulting RGBA pixels.
+void ConvertRgb888ToRgba8888InPlace(std::uint8_t* data, const vec2i& size);
+
 }  // namespace redux
 
 #endif  // REDUX_MODULES_GRAPHICS_IMAGE_UTILS_H_
@@ -0,0 +1,86 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/graphics/image_utils.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+
+TEST(ImageUtilsTest, MultiplyRgbByAlpha) {
+  // Every combination of channel and alpha value.
+  constexpr int kWidth = 256;
+  constexpr int kHeight = 256;
+  std::vector<std::uint8_t> data(4 * kWidth * kHeight);
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      std::uint8_t* pixel = &data[4 * (y * kWidth + x)];
+      pixel[0] = static_cast<std::uint8_t>(x);
+      pixel[1] = static_cast<std::uint8_t>(255 - x);
+      pixel[2] = static_cast<std::uint8_t>(x / 2);
+      pixel[3] = static_cast<std::uint8_t>(y);
+    }
+  }
+  const std::vector<std::uint8_t> original = data;
+
+  MultiplyRgbByAlpha(data.data(), vec2i(kWidth, kHeight));
+
+  for (std::size_t i = 0; i < data.size(); i += 4) {
+    const int alpha = original[i + 3];
+    EXPECT_THAT(data[i + 0], Eq(original[i + 0] * alpha / 255));
+    EXPECT_THAT(data[i + 1], Eq(original[i + 1] * alpha / 255));
+    EXPECT_THAT(data[i + 2], Eq(original[i + 2] * alpha / 255));
+    EXPECT_THAT(data[i + 3], Eq(alpha));
+  }
+}
+
+TEST(ImageUtilsTest, ConvertRgb888ToRgba8888) {
+  // An odd number of pixels exercises both the vectorized and scalar paths.
+  constexpr int kWidth = 7;
+  constexpr int kHeight = 5;
+  constexpr int kNumPixels = kWidth * kHeight;
+
+  std::uint8_t rgb[3 * kNumPixels];
+  for (int i = 0; i < 3 * kNumPixels; ++i) {
+    rgb[i] = static_cast<std::uint8_t>(i);
+  }
+
+  std::uint8_t rgba[4 * kNumPixels];
+  ConvertRgb888ToRgba8888(rgb, vec2i(kWidth, kHeight), rgba);
+
+  std::uint8_t in_place[4 * kNumPixels];
+  std::memcpy(in_place, rgb, sizeof(rgb));
+  ConvertRgb888ToRgba8888InPlace(in_place, vec2i(kWidth, kHeight));
+
+  for (int i = 0; i < kNumPixels; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_THAT(rgba[4 * i + c], Eq(rgb[3 * i + c]));
+      EXPECT_THAT(in_place[4 * i + c], Eq(rgb[3 * i + c]));
+    }
+    EXPECT_THAT(rgba[4 * i + 3], Eq(255));
+    EXPECT_THAT(in_place[4 * i + 3], Eq(255));
+  }
+}
+
+}  // namespace
+}  // namespace redux
@@ -18,6 +18,9 @@ limitations under the License.
 
 #include <algorithm>
 #include <limits>
+#include <utility>
+
+#include "redux/modules/graphics/vertex_utils.h"
 
 namespace redux {
 
@@ -77,4 +80,24 @@ MeshData MeshData::Clone() const {
   return clone;
 }
 
+MeshData MeshData::CloneWithVertexFormat(
+    const VertexFormat& vertex_format) const {
+  if (vertex_format == vertex_format_) {
+    return Clone();
+  }
+
+  const std::size_t num_vertices = GetNumVertices();
+  DataContainer vertex_data =
+      DataContainer::Allocate(vertex_format.GetVertexSize() * num_vertices);
+  ConvertVertices(vertex_data_.GetByteSpan(), vertex_format_,
+                  const_cast<std::byte*>(vertex_data.GetBytes()),
+                  vertex_format, num_vertices);
+
+  MeshData clone;
+  clone.SetVertexData(vertex_format, std::move(vertex_data), bounds_);
+  clone.SetIndexData(index_type_, index_data_.Clone());
+  clone.SetParts(parts_.Clone());
+  return clone;
+}
+
 }  // namespace redux
@@ -108,6 +108,11 @@ class MeshData {
   // in order to pass to a worker thread or the GPU.
   MeshData Clone() const;
 
+  // Like Clone, but converts the vertices into the given format. Attributes
+  // are matched by usage (see ConvertVertices), so this can be used to repack
+  // a mesh into the layout expected by a shader or render backend.
+  MeshData CloneWithVertexFormat(const VertexFormat& vertex_format) const;
+
   static constexpr std::uint32_t kInvalidIndexU32 =
       static_cast<std::uint32_t>(~0);
   static constexpr std::uint16_t kMaxValidIndexU16 =
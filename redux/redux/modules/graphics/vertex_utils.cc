@@ -0,0 +1,110 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/graphics/vertex_utils.h"
+
+#include <array>
+#include <iterator>
+#include <utility>
+
+#include "redux/modules/base/logging.h"
+
+namespace redux {
+namespace {
+
+// The valid VertexTypes, in the order used to index the converter table.
+constexpr VertexType kVertexTypes[] = {
+    VertexType::Scalar1f, VertexType::Vec2f,  VertexType::Vec3f,
+    VertexType::Vec4f,    VertexType::Vec2us, VertexType::Vec4us,
+    VertexType::Vec4ub,
+};
+constexpr std::size_t kNumVertexTypes = std::size(kVertexTypes);
+
+int GetVertexTypeIndex(VertexType type) {
+  for (std::size_t i = 0; i < kNumVertexTypes; ++i) {
+    if (kVertexTypes[i] == type) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+template <std::size_t Src, std::size_t... Dst>
+constexpr auto MakeConverterRow(std::index_sequence<Dst...>) {
+  return std::array<VertexAttributeConverter, kNumVertexTypes>{
+      &ConvertVertexAttribute<kVertexTypes[Src], kVertexTypes[Dst]>...};
+}
+
+template <std::size_t... Src>
+constexpr auto MakeConverterTable(std::index_sequence<Src...>) {
+  return std::array<std::array<VertexAttributeConverter, kNumVertexTypes>,
+                    kNumVertexTypes>{
+      MakeConverterRow<Src>(std::make_index_sequence<kNumVertexTypes>())...};
+}
+
+constexpr auto kConverters =
+    MakeConverterTable(std::make_index_sequence<kNumVertexTypes>());
+
+}  // namespace
+
+VertexAttributeConverter GetVertexAttributeConverter(VertexType src,
+                                                     VertexType dst) {
+  const int src_index = GetVertexTypeIndex(src);
+  const int dst_index = GetVertexTypeIndex(dst);
+  if (src_index < 0 || dst_index < 0) {
+    return nullptr;
+  }
+  return kConverters[src_index][dst_index];
+}
+
+void ConvertVertices(absl::Span<const std::byte> src,
+                     const VertexFormat& src_format, std::byte* dst,
+                     const VertexFormat& dst_format, std::size_t num_vertices) {
+  const std::size_t src_stride = src_format.GetVertexSize();
+  const std::size_t dst_stride = dst_format.GetVertexSize();
+  CHECK_GE(src.size(), src_stride * num_vertices);
+
+  if (src_format == dst_format) {
+    std::memcpy(dst, src.data(), src_stride * num_vertices);
+    return;
+  }
+
+  for (std::size_t i = 0; i < dst_format.GetNumAttributes(); ++i) {
+    const VertexAttribute* dst_attrib = dst_format.GetAttributeAt(i);
+    std::byte* dst_ptr = dst + dst_format.GetAttributeOffsetAt(i);
+
+    const VertexAttribute* src_attrib =
+        src_format.GetAttributeWithUsage(dst_attrib->usage);
+    VertexAttributeConverter converter = nullptr;
+    if (src_attrib != nullptr) {
+      converter = GetVertexAttributeConverter(src_attrib->type,
+                                              dst_attrib->type);
+    }
+
+    if (converter != nullptr) {
+      const std::byte* src_ptr =
+          src.data() + src_format.GetAttributeOffset(src_attrib);
+      converter(src_ptr, src_stride, dst_ptr, dst_stride, num_vertices);
+    } else {
+      const std::size_t size = VertexFormat::GetAttributeSize(*dst_attrib);
+      for (std::size_t v = 0; v < num_vertices; ++v) {
+        std::memset(dst_ptr + v * dst_stride, 0, size);
+      }
+    }
+  }
+}
+
+}  // namespace redux
@@ -17,6 +17,15 @@ limitations under the License.
 #ifndef REDUX_MODULES_GRAPHICS_VERTEX_UTILS_H_
 #define REDUX_MODULES_GRAPHICS_VERTEX_UTILS_H_
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "absl/types/span.h"
+#include "redux/modules/graphics/enums.h"
+#include "redux/modules/graphics/vertex_format.h"
 #include "redux/modules/math/matrix.h"
 #include "redux/modules/math/quaternion.h"
 #include "redux/modules/math/vector.h"
@@ -54,6 +63,131 @@ inline vec4 CalculateOrientation(const vec3& normal) {
   return CalculateOrientation(normal, tangent);
 }
 
+namespace detail {
+
+// Describes the components of a VertexType. Vec4ub is used for colors, so its
+// components are treated as normalized [0, 255] values.
+template <VertexType Type>
+struct VertexTypeTraits;
+
+template <typename T, std::size_t N, bool Normalized = false>
+struct VertexTypeTraitsImpl {
+  using Component = T;
+  static constexpr std::size_t kNumComponents = N;
+  static constexpr bool kNormalized = Normalized;
+};
+
+template <>
+struct VertexTypeTraits<VertexType::Scalar1f> : VertexTypeTraitsImpl<float, 1> {
+};
+template <>
+struct VertexTypeTraits<VertexType::Vec2f> : VertexTypeTraitsImpl<float, 2> {};
+template <>
+struct VertexTypeTraits<VertexType::Vec3f> : VertexTypeTraitsImpl<float, 3> {};
+template <>
+struct VertexTypeTraits<VertexType::Vec4f> : VertexTypeTraitsImpl<float, 4> {};
+template <>
+struct VertexTypeTraits<VertexType::Vec2us>
+    : VertexTypeTraitsImpl<std::uint16_t, 2> {};
+template <>
+struct VertexTypeTraits<VertexType::Vec4us>
+    : VertexTypeTraitsImpl<std::uint16_t, 4> {};
+template <>
+struct VertexTypeTraits<VertexType::Vec4ub>
+    : VertexTypeTraitsImpl<std::uint8_t, 4, true> {};
+
+template <typename Src, typename Dst>
+typename Dst::Component ConvertVertexComponent(typename Src::Component value) {
+  using In = typename Src::Component;
+  using Out = typename Dst::Component;
+  if constexpr (Src::kNormalized && std::is_floating_point_v<Out>) {
+    return static_cast<Out>(value) / Out(255);
+  } else if constexpr (Dst::kNormalized && std::is_floating_point_v<In>) {
+    return static_cast<Out>(std::clamp(value, In(0), In(1)) * In(255) +
+                            In(0.5));
+  } else {
+    return static_cast<Out>(value);
+  }
+}
+
+}  // namespace detail
+
+// Converts `count` attributes of type `Src` into attributes of type `Dst`.
+// Consecutive attributes are `src_stride` and `dst_stride` bytes apart, so the
+// source and destination may be interleaved with other attributes. Components
+// missing in `Src` are set to 0, except for a missing fourth component which
+// is set to 1 (eg. when converting positions to homogeneous coordinates).
+//
+// The conversion is resolved at compile-time so that the inner loop is free of
+// any per-vertex branching on the attribute types. Identical types are copied
+// directly.
+template <VertexType Src, VertexType Dst>
+void ConvertVertexAttribute(const std::byte* src, std::size_t src_stride,
+                            std::byte* dst, std::size_t dst_stride,
+                            std::size_t count) {
+  using SrcTraits = detail::VertexTypeTraits<Src>;
+  using DstTraits = detail::VertexTypeTraits<Dst>;
+  using SrcComponent = typename SrcTraits::Component;
+  using DstComponent = typename DstTraits::Component;
+  constexpr std::size_t kSrcSize =
+      sizeof(SrcComponent) * SrcTraits::kNumComponents;
+  constexpr std::size_t kDstSize =
+      sizeof(DstComponent) * DstTraits::kNumComponents;
+
+  if constexpr (Src == Dst) {
+    if (src_stride == kSrcSize && dst_stride == kDstSize) {
+      std::memcpy(dst, src, kSrcSize * count);
+      return;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      std::memcpy(dst, src, kSrcSize);
+      src += src_stride;
+      dst += dst_stride;
+    }
+  } else {
+    constexpr std::size_t kNumConverted =
+        std::min(SrcTraits::kNumComponents, DstTraits::kNumComponents);
+    constexpr DstComponent kOne = DstTraits::kNormalized ? 255 : 1;
+
+    for (std::size_t i = 0; i < count; ++i) {
+      // Copy through local arrays since vertex data need not be aligned.
+      SrcComponent in[SrcTraits::kNumComponents];
+      DstComponent out[DstTraits::kNumComponents];
+      std::memcpy(in, src, kSrcSize);
+      for (std::size_t c = 0; c < kNumConverted; ++c) {
+        out[c] = detail::ConvertVertexComponent<SrcTraits, DstTraits>(in[c]);
+      }
+      for (std::size_t c = kNumConverted; c < DstTraits::kNumComponents; ++c) {
+        out[c] = c == 3 ? kOne : DstComponent(0);
+      }
+      std::memcpy(dst, out, kDstSize);
+      src += src_stride;
+      dst += dst_stride;
+    }
+  }
+}
+
+// A type-erased instantiation of ConvertVertexAttribute.
+using VertexAttributeConverter = void (*)(const std::byte* src,
+                                          std::size_t src_stride,
+                                          std::byte* dst,
+                                          std::size_t dst_stride,
+                                          std::size_t count);
+
+// Returns the ConvertVertexAttribute instantiation for the given types, or
+// nullptr if either type is invalid.
+VertexAttributeConverter GetVertexAttributeConverter(VertexType src,
+                                                     VertexType dst);
+
+// Converts `num_vertices` vertices in `src_format` into `dst`, which must be
+// large enough for that many vertices in `dst_format`. Attributes are matched
+// by usage; attributes in `dst_format` without a match in `src_format` are
+// zero-filled. The converter for each attribute is looked up once for the
+// whole buffer rather than per vertex.
+void ConvertVertices(absl::Span<const std::byte> src,
+                     const VertexFormat& src_format, std::byte* dst,
+                     const VertexFormat& dst_format, std::size_t num_vertices);
+
 }  // namespace redux
 
 #endif  // REDUX_MODULES_GRAPHICS_VERTEX_UTILS_H_
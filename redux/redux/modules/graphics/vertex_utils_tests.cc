@@ -0,0 +1,151 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/graphics/vertex_utils.h"
+
+#include <cstdint>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/graphics/vertex_format.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::FloatEq;
+
+template <typename T>
+const std::byte* ToBytes(const T* ptr) {
+  return reinterpret_cast<const std::byte*>(ptr);
+}
+
+template <typename T>
+std::byte* ToBytes(T* ptr) {
+  return reinterpret_cast<std::byte*>(ptr);
+}
+
+TEST(VertexUtils, ConvertSameType) {
+  const float src[] = {1, 2, 3, 4, 5, 6};
+  float dst[6] = {0};
+  ConvertVertexAttribute<VertexType::Vec3f, VertexType::Vec3f>(
+      ToBytes(src), sizeof(float) * 3, ToBytes(dst), sizeof(float) * 3, 2);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_THAT(dst[i], Eq(src[i]));
+  }
+}
+
+TEST(VertexUtils, ConvertStrided) {
+  // Copies the second component of each 3-float source into a tightly packed
+  // destination.
+  const float src[] = {1, 2, 3, 4, 5, 6};
+  float dst[2] = {0};
+  ConvertVertexAttribute<VertexType::Scalar1f, VertexType::Scalar1f>(
+      ToBytes(src + 1), sizeof(float) * 3, ToBytes(dst), sizeof(float), 2);
+  EXPECT_THAT(dst[0], Eq(2.f));
+  EXPECT_THAT(dst[1], Eq(5.f));
+}
+
+TEST(VertexUtils, ConvertWidensWithDefaults) {
+  const float src[] = {1, 2, 3};
+  float dst[4] = {0};
+  ConvertVertexAttribute<VertexType::Vec3f, VertexType::Vec4f>(
+      ToBytes(src), sizeof(src), ToBytes(dst), sizeof(dst), 1);
+  EXPECT_THAT(dst[0], Eq(1.f));
+  EXPECT_THAT(dst[1], Eq(2.f));
+  EXPECT_THAT(dst[2], Eq(3.f));
+  EXPECT_THAT(dst[3], Eq(1.f));
+
+  float uv[4] = {0};
+  ConvertVertexAttribute<VertexType::Vec2f, VertexType::Vec4f>(
+      ToBytes(src), sizeof(float) * 2, ToBytes(uv), sizeof(uv), 1);
+  EXPECT_THAT(uv[2], Eq(0.f));
+  EXPECT_THAT(uv[3], Eq(1.f));
+}
+
+TEST(VertexUtils, ConvertNormalizedColors) {
+  const float src[] = {0.f, 0.5f, 1.f, 2.f};
+  uint8_t dst[4] = {0};
+  ConvertVertexAttribute<VertexType::Vec4f, VertexType::Vec4ub>(
+      ToBytes(src), sizeof(src), ToBytes(dst), sizeof(dst), 1);
+  EXPECT_THAT(dst[0], Eq(0));
+  EXPECT_THAT(dst[1], Eq(128));
+  EXPECT_THAT(dst[2], Eq(255));
+  EXPECT_THAT(dst[3], Eq(255));
+
+  float back[4] = {0};
+  ConvertVertexAttribute<VertexType::Vec4ub, VertexType::Vec4f>(
+      ToBytes(dst), sizeof(dst), ToBytes(back), sizeof(back), 1);
+  EXPECT_THAT(back[0], FloatEq(0.f));
+  EXPECT_THAT(back[2], FloatEq(1.f));
+}
+
+TEST(VertexUtils, GetVertexAttributeConverter) {
+  EXPECT_THAT(GetVertexAttributeConverter(VertexType::Vec3f,
+                                          VertexType::Vec4ub),
+              Eq(&ConvertVertexAttribute<VertexType::Vec3f,
+                                         VertexType::Vec4ub>));
+  EXPECT_THAT(GetVertexAttributeConverter(VertexType::Invalid,
+                                          VertexType::Vec3f),
+              Eq(nullptr));
+}
+
+TEST(VertexUtils, ConvertVertices) {
+  struct SrcVertex {
+    float position[3];
+    float color[4];
+  };
+  struct DstVertex {
+    uint8_t color[4];
+    float position[4];
+    float uv[2];
+  };
+  const VertexFormat src_format = {
+      {VertexUsage::Position, VertexType::Vec3f},
+      {VertexUsage::Color0, VertexType::Vec4f},
+  };
+  const VertexFormat dst_format = {
+      {VertexUsage::Color0, VertexType::Vec4ub},
+      {VertexUsage::Position, VertexType::Vec4f},
+      {VertexUsage::TexCoord0, VertexType::Vec2f},
+  };
+  ASSERT_THAT(src_format.GetVertexSize(), Eq(sizeof(SrcVertex)));
+  ASSERT_THAT(dst_format.GetVertexSize(), Eq(sizeof(DstVertex)));
+
+  const SrcVertex src[] = {
+      {{1, 2, 3}, {1, 0, 0, 1}},
+      {{4, 5, 6}, {0, 1, 0, 1}},
+  };
+  DstVertex dst[2];
+  dst[1].uv[0] = 7.f;
+  dst[1].uv[1] = 8.f;
+  ConvertVertices({ToBytes(src), sizeof(src)}, src_format, ToBytes(dst),
+                  dst_format, 2);
+
+  EXPECT_THAT(dst[0].position[0], Eq(1.f));
+  EXPECT_THAT(dst[0].position[3], Eq(1.f));
+  EXPECT_THAT(dst[1].position[2], Eq(6.f));
+  EXPECT_THAT(dst[0].color[0], Eq(255));
+  EXPECT_THAT(dst[0].color[1], Eq(0));
+  EXPECT_THAT(dst[1].color[1], Eq(255));
+  EXPECT_THAT(dst[1].color[3], Eq(255));
+  // Attributes not in the source format are zero-filled.
+  EXPECT_THAT(dst[1].uv[0], Eq(0.f));
+  EXPECT_THAT(dst[1].uv[1], Eq(0.f));
+}
+
+}  // namespace
+}  // namespace redux
@@ -0,0 +1,151 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/math/batch.h"
+
+#include "redux/modules/base/logging.h"
+#include "vectorial/simd4f.h"
+
+namespace redux {
+namespace {
+
+// The math types only use a simd layout if requested, so values are always
+// moved in and out of simd registers with unaligned loads and stores.
+
+simd4f LoadColumn(const mat4& m, int col) { return simd4f_uload4(m.cols[col]); }
+
+void StoreColumn(simd4f value, mat4* m, int col) {
+  simd4f_ustore4(value, m->cols[col]);
+}
+
+simd4f LoadVec3(const vec3& v) { return simd4f_create(v.x, v.y, v.z, 0.f); }
+
+void StoreVec3(simd4f value, vec3* v) {
+  float tmp[4];
+  simd4f_ustore4(value, tmp);
+  *v = vec3(tmp[0], tmp[1], tmp[2]);
+}
+
+// Multiplies the matrix with columns `c0` to `c3` with the column `v`.
+simd4f Multiply(simd4f c0, simd4f c1, simd4f c2, simd4f c3, const float* v) {
+  const simd4f a = simd4f_add(simd4f_mul(c0, simd4f_splat(v[0])),
+                              simd4f_mul(c1, simd4f_splat(v[1])));
+  const simd4f b = simd4f_add(simd4f_mul(c2, simd4f_splat(v[2])),
+                              simd4f_mul(c3, simd4f_splat(v[3])));
+  return simd4f_add(a, b);
+}
+
+// Multiplies `lhs` (given as its columns) with `rhs`, writing into `out`. All
+// the columns are computed before any are stored, so `out` may alias `rhs`.
+void MultiplyMatrix(const simd4f* lhs, const mat4& rhs, mat4* out) {
+  const simd4f r0 = Multiply(lhs[0], lhs[1], lhs[2], lhs[3], rhs.cols[0]);
+  const simd4f r1 = Multiply(lhs[0], lhs[1], lhs[2], lhs[3], rhs.cols[1]);
+  const simd4f r2 = Multiply(lhs[0], lhs[1], lhs[2], lhs[3], rhs.cols[2]);
+  const simd4f r3 = Multiply(lhs[0], lhs[1], lhs[2], lhs[3], rhs.cols[3]);
+  StoreColumn(r0, out, 0);
+  StoreColumn(r1, out, 1);
+  StoreColumn(r2, out, 2);
+  StoreColumn(r3, out, 3);
+}
+
+}  // namespace
+
+void TransformPoints(const mat4& m, absl::Span<const vec3> points,
+                     absl::Span<vec3> out) {
+  CHECK_EQ(points.size(), out.size());
+  const simd4f c0 = LoadColumn(m, 0);
+  const simd4f c1 = LoadColumn(m, 1);
+  const simd4f c2 = LoadColumn(m, 2);
+  const simd4f c3 = LoadColumn(m, 3);
+
+  // The w-component is always 1 for affine matrices, which are the common
+  // case, so the perspective divide can be skipped.
+  const bool affine =
+      m(3, 0) == 0.f && m(3, 1) == 0.f && m(3, 2) == 0.f && m(3, 3) == 1.f;
+
+  for (size_t i = 0; i < points.size(); ++i) {
+    const float p[4] = {points[i].x, points[i].y, points[i].z, 1.f};
+    simd4f result = Multiply(c0, c1, c2, c3, p);
+    if (!affine) {
+      result = simd4f_div(result, simd4f_splat(simd4f_get_w(result)));
+    }
+    StoreVec3(result, &out[i]);
+  }
+}
+
+void TransformDirections(const mat4& m, absl::Span<const vec3> directions,
+                         absl::Span<vec3> out) {
+  CHECK_EQ(directions.size(), out.size());
+  const simd4f c0 = LoadColumn(m, 0);
+  const simd4f c1 = LoadColumn(m, 1);
+  const simd4f c2 = LoadColumn(m, 2);
+
+  for (size_t i = 0; i < directions.size(); ++i) {
+    const vec3& d = directions[i];
+    const simd4f xy = simd4f_add(simd4f_mul(c0, simd4f_splat(d.x)),
+                                 simd4f_mul(c1, simd4f_splat(d.y)));
+    StoreVec3(simd4f_add(xy, simd4f_mul(c2, simd4f_splat(d.z))), &out[i]);
+  }
+}
+
+void MultiplyMatrices(absl::Span<const mat4> lhs, absl::Span<const mat4> rhs,
+                      absl::Span<mat4> out) {
+  CHECK_EQ(lhs.size(), rhs.size());
+  CHECK_EQ(lhs.size(), out.size());
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    const simd4f cols[4] = {LoadColumn(lhs[i], 0), LoadColumn(lhs[i], 1),
+                            LoadColumn(lhs[i], 2), LoadColumn(lhs[i], 3)};
+    MultiplyMatrix(cols, rhs[i], &out[i]);
+  }
+}
+
+void MultiplyMatrices(const mat4& lhs, absl::Span<const mat4> rhs,
+                      absl::Span<mat4> out) {
+  CHECK_EQ(rhs.size(), out.size());
+  const simd4f cols[4] = {LoadColumn(lhs, 0), LoadColumn(lhs, 1),
+                          LoadColumn(lhs, 2), LoadColumn(lhs, 3)};
+  for (size_t i = 0; i < rhs.size(); ++i) {
+    MultiplyMatrix(cols, rhs[i], &out[i]);
+  }
+}
+
+void NormalizeQuaternions(absl::Span<quat> quats) {
+  for (quat& q : quats) {
+    const simd4f normalized = simd4f_normalize4(simd4f_uload4(q.data));
+    simd4f_ustore4(normalized, q.data);
+  }
+}
+
+Box ComputeBounds(absl::Span<const vec3> points) {
+  if (points.empty()) {
+    return Box::Empty();
+  }
+
+  simd4f min = LoadVec3(points[0]);
+  simd4f max = min;
+  for (size_t i = 1; i < points.size(); ++i) {
+    const simd4f p = LoadVec3(points[i]);
+    min = simd4f_min(min, p);
+    max = simd4f_max(max, p);
+  }
+
+  Box box;
+  StoreVec3(min, &box.min);
+  StoreVec3(max, &box.max);
+  return box;
+}
+
+}  // namespace redux
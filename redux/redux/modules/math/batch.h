@@ -0,0 +1,68 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_MODULES_MATH_BATCH_H_
+#define REDUX_MODULES_MATH_BATCH_H_
+
+#include "absl/types/span.h"
+#include "redux/modules/math/bounds.h"
+#include "redux/modules/math/matrix.h"
+#include "redux/modules/math/quaternion.h"
+#include "redux/modules/math/vector.h"
+
+namespace redux {
+
+// Batched versions of common math operations, for code that applies the same
+// operation to many values at once (eg. transforming all the vertices of a
+// mesh, or updating the world matrices of many entities).
+//
+// These functions operate on the 4-wide simd registers provided by vectorial
+// (ie. SSE or NEON, depending on the target) regardless of whether the math
+// types themselves use a simd layout. Results match those of calling the
+// single-value operation in a loop, up to floating-point rounding.
+//
+// Unless otherwise stated, the `out` span must be the same size as the input
+// spans, and may alias one of them for in-place updates.
+
+// Multiplies each of the `points` by `m` (ie. `m * points[i]`), including the
+// perspective divide for non-affine matrices.
+void TransformPoints(const mat4& m, absl::Span<const vec3> points,
+                     absl::Span<vec3> out);
+
+// Multiplies each of the `directions` by `m`, ignoring its translation (ie.
+// `(m * vec4(directions[i], 0)).xyz()`).
+void TransformDirections(const mat4& m, absl::Span<const vec3> directions,
+                         absl::Span<vec3> out);
+
+// Multiplies each pair of matrices (ie. `lhs[i] * rhs[i]`).
+void MultiplyMatrices(absl::Span<const mat4> lhs, absl::Span<const mat4> rhs,
+                      absl::Span<mat4> out);
+
+// Multiplies `lhs` with each of the `rhs` matrices (ie. `lhs * rhs[i]`), eg.
+// to compute the world matrices of all the children of a parent.
+void MultiplyMatrices(const mat4& lhs, absl::Span<const mat4> rhs,
+                      absl::Span<mat4> out);
+
+// Normalizes each of the `quats` in place.
+void NormalizeQuaternions(absl::Span<quat> quats);
+
+// Returns the smallest Box that contains all the `points`, or `Box::Empty()` if
+// there are no points.
+Box ComputeBounds(absl::Span<const vec3> points);
+
+}  // namespace redux
+
+#endif  // REDUX_MODULES_MATH_BATCH_H_
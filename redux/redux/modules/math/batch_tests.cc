@@ -0,0 +1,135 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/modules/math/batch.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/math/testing.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+
+constexpr float kEpsilon = 1e-5f;
+
+// Returns an affine matrix with a rotation, non-uniform scale and translation.
+mat4 MakeAffineMatrix(float seed) {
+  const quat rotation =
+      QuaternionFromEulerAngles(vec3(0.3f * seed, 1.1f, -0.7f * seed));
+  const mat3 r = RotationMatrixFromQuaternion(rotation);
+  return mat4(r(0, 0) * 2.f, r(0, 1), r(0, 2) * 0.5f, seed,
+              r(1, 0) * 2.f, r(1, 1), r(1, 2) * 0.5f, -2.f * seed,
+              r(2, 0) * 2.f, r(2, 1), r(2, 2) * 0.5f, 3.f,
+              0.f, 0.f, 0.f, 1.f);
+}
+
+std::vector<vec3> MakePoints(int count) {
+  std::vector<vec3> points;
+  for (int i = 0; i < count; ++i) {
+    const float f = static_cast<float>(i);
+    points.emplace_back(f * 0.5f - 3.f, 10.f - f, f * f * 0.1f);
+  }
+  return points;
+}
+
+TEST(BatchTest, TransformPoints) {
+  const mat4 m = MakeAffineMatrix(1.5f);
+  const std::vector<vec3> points = MakePoints(7);
+  std::vector<vec3> out(points.size());
+  TransformPoints(m, points, absl::MakeSpan(out));
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_THAT(out[i], MathNear(m * points[i], kEpsilon));
+  }
+}
+
+TEST(BatchTest, TransformPointsPerspective) {
+  mat4 m = MakeAffineMatrix(0.5f);
+  m(3, 2) = -1.f;
+  m(3, 3) = 0.f;
+  std::vector<vec3> points = MakePoints(5);
+  const std::vector<vec3> expected = points;
+
+  // Transform in place.
+  TransformPoints(m, points, absl::MakeSpan(points));
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_THAT(points[i], MathNear(m * expected[i], kEpsilon));
+  }
+}
+
+TEST(BatchTest, TransformDirections) {
+  const mat4 m = MakeAffineMatrix(2.f);
+  const std::vector<vec3> directions = MakePoints(6);
+  std::vector<vec3> out(directions.size());
+  TransformDirections(m, directions, absl::MakeSpan(out));
+  for (size_t i = 0; i < directions.size(); ++i) {
+    const vec3 expected = (m * vec4(directions[i], 0.f)).xyz();
+    EXPECT_THAT(out[i], MathNear(expected, kEpsilon));
+  }
+}
+
+TEST(BatchTest, MultiplyMatrices) {
+  std::vector<mat4> lhs;
+  std::vector<mat4> rhs;
+  for (int i = 0; i < 5; ++i) {
+    lhs.push_back(MakeAffineMatrix(static_cast<float>(i)));
+    rhs.push_back(MakeAffineMatrix(static_cast<float>(i) * -0.5f));
+  }
+  rhs[2](3, 0) = 0.25f;  // Not all matrices are affine.
+
+  std::vector<mat4> out(lhs.size());
+  MultiplyMatrices(lhs, rhs, absl::MakeSpan(out));
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    EXPECT_THAT(out[i], MathNear(lhs[i] * rhs[i], kEpsilon));
+  }
+
+  // Multiply a single parent with each child, in place.
+  const mat4 parent = MakeAffineMatrix(3.f);
+  const std::vector<mat4> children = rhs;
+  MultiplyMatrices(parent, rhs, absl::MakeSpan(rhs));
+  for (size_t i = 0; i < rhs.size(); ++i) {
+    EXPECT_THAT(rhs[i], MathNear(parent * children[i], kEpsilon));
+  }
+}
+
+TEST(BatchTest, NormalizeQuaternions) {
+  std::vector<quat> quats = {
+      quat(1.f, 2.f, 3.f, 4.f),
+      quat(0.f, 0.f, 0.f, 2.f),
+      quat(-0.5f, 0.1f, 0.f, 0.3f),
+  };
+  const std::vector<quat> expected = quats;
+  NormalizeQuaternions(absl::MakeSpan(quats));
+  for (size_t i = 0; i < quats.size(); ++i) {
+    EXPECT_THAT(quats[i], MathNear(expected[i].Normalized(), kEpsilon));
+  }
+}
+
+TEST(BatchTest, ComputeBounds) {
+  const std::vector<vec3> points = MakePoints(9);
+  const Box box = ComputeBounds(points);
+  const Box expected{absl::Span<const vec3>(points)};
+  EXPECT_THAT(box.min, MathNear(expected.min, 0.f));
+  EXPECT_THAT(box.max, MathNear(expected.max, 0.f));
+
+  EXPECT_THAT(ComputeBounds({}), Eq(Box::Empty()));
+}
+
+}  // namespace
+}  // namespace redux
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "redux/modules/var/var.h"
 
+#include <new>
+
 #include "redux/modules/var/var_array.h"
 #include "redux/modules/var/var_table.h"
 
@@ -47,6 +49,9 @@ Var& Var::operator=(Var&& rhs) {
 }
 
 void Var::SetVar(const Var& rhs) {
+  if (&rhs == this) {
+    return;
+  }
   Destroy();
   if (!rhs.Empty()) {
     Alloc(rhs.capacity_);
@@ -57,6 +62,9 @@ void Var::SetVar(const Var& rhs) {
 }
 
 void Var::SetVar(Var&& rhs) {
+  if (&rhs == this) {
+    return;
+  }
   Destroy();
   if (!rhs.Empty()) {
     if (IsSmallData() || rhs.IsSmallData()) {
@@ -90,7 +98,8 @@ void Var::Alloc(std::size_t size) {
   }
   Free();
   if (size > kStoreSize) {
-    heap_data_ = new std::byte[size];
+    heap_data_ = static_cast<std::byte*>(
+        ::operator new(size, std::align_val_t{kStoreAlign}));
     capacity_ = size;
   }
 }
@@ -99,7 +108,7 @@ void Var::Free() {
   CHECK(handler_ == nullptr) << "Must Destroy() before Free()ing.";
   Destroy();
   if (!IsSmallData()) {
-    delete[] heap_data_;
+    ::operator delete(heap_data_, std::align_val_t{kStoreAlign});
   }
   capacity_ = kStoreSize;
 }
@@ -26,6 +26,12 @@ limitations under the License.
 #include "redux/modules/base/logging.h"
 #include "redux/modules/base/typeid.h"
 
+// The number of bytes a Var can store inline before falling back to the heap.
+// Must be large enough to hold a std::string, VarArray, and VarTable.
+#ifndef REDUX_VAR_STORE_SIZE
+#define REDUX_VAR_STORE_SIZE 64
+#endif
+
 namespace redux {
 
 // Variant type similar to std::any, but constrained to types that have a
@@ -170,36 +176,30 @@ class Var {
   void SetValue(const T& value) {
     CHECK(alignof(T) <= kStoreAlign);
 
-    const T* value_ptr = &value;
-    Var tmp;
     if (handler_) {
-      // We need to protect ourselves from self-assignment. We do this by
-      // copying the value into a temporary buffer.
-      value_ptr = tmp.CopyIntoHelper(value_ptr);
+      // |value| may be owned by the value we are about to destroy (eg. it is
+      // an element of a stored VarArray), so copy it out first and then move
+      // the copy into place. Moving a heap-stored Var just swaps buffers.
+      Var tmp;
+      tmp.CopyIntoHelper(&value);
+      SetVar(std::move(tmp));
+    } else {
+      CopyIntoHelper(&value);
     }
-
-    // We could be more optimal about swapping buffers rather than performing
-    // all these copies, but we'll leave that for an optimization pass.
-    Destroy();
-    CopyIntoHelper(value_ptr);
   }
 
   template <typename T>
   void SetValue(T&& value) {
     CHECK(alignof(T) <= kStoreAlign);
 
-    T* value_ptr = &value;
-    Var tmp;
     if (handler_) {
-      // We need to protect ourselves from self-assignment. We do this by
-      // copying the value into a temporary buffer.
-      value_ptr = tmp.MoveIntoHelper(value_ptr);
+      // See above; |value| may be owned by the current value.
+      Var tmp;
+      tmp.MoveIntoHelper(&value);
+      SetVar(std::move(tmp));
+    } else {
+      MoveIntoHelper(&value);
     }
-
-    // We could be more optimal about swapping buffers rather than performing
-    // all these copies, but we'll leave that for an optimization pass.
-    Destroy();
-    MoveIntoHelper(value_ptr);
   }
 
   template <typename T>
@@ -260,7 +260,7 @@ class Var {
     }
   }
 
-  static constexpr std::size_t kStoreSize = 64;
+  static constexpr std::size_t kStoreSize = REDUX_VAR_STORE_SIZE;
   static constexpr std::size_t kStoreAlign = 16;  // Aligned for simd types.
   using HandlerFn = void(Operation, void*, const void*, void*);
 
@@ -18,32 +18,92 @@ limitations under the License.
 
 namespace redux {
 
-void VarTable::Clear() { data_.clear(); }
+void VarTable::Clear() {
+  entries_.clear();
+  index_.clear();
+}
+
+void VarTable::Swap(VarTable& rhs) {
+  entries_.swap(rhs.entries_);
+  index_.swap(rhs.index_);
+}
+
+size_t VarTable::Count() const { return entries_.size(); }
+
+std::size_t VarTable::FindIndex(HashValue key) const {
+  if (!index_.empty()) {
+    auto iter = index_.find(key);
+    return iter != index_.end() ? iter->second : npos;
+  }
+  for (std::size_t i = 0; i < entries_.size(); ++i) {
+    if (entries_[i].first == key) {
+      return i;
+    }
+  }
+  return npos;
+}
 
-void VarTable::Swap(VarTable& rhs) { data_.swap(rhs.data_); }
+Var& VarTable::FindOrAdd(HashValue key) {
+  const std::size_t index = FindIndex(key);
+  if (index != npos) {
+    return entries_[index].second;
+  }
 
-size_t VarTable::Count() const { return data_.size(); }
+  if (entries_.empty()) {
+    entries_.reserve(kMaxLinearSearchSize);
+  }
+  entries_.emplace_back(key, Var());
 
-void VarTable::Erase(HashValue key) { data_.erase(key); }
+  if (!index_.empty()) {
+    index_.emplace(key, entries_.size() - 1);
+  } else if (entries_.size() > kMaxLinearSearchSize) {
+    index_.reserve(entries_.size());
+    for (std::size_t i = 0; i < entries_.size(); ++i) {
+      index_.emplace(entries_[i].first, i);
+    }
+  }
+  return entries_.back().second;
+}
+
+void VarTable::Erase(HashValue key) {
+  const std::size_t index = FindIndex(key);
+  if (index == npos) {
+    return;
+  }
+
+  // Fill the hole with the last entry so the entries stay contiguous.
+  const std::size_t last = entries_.size() - 1;
+  if (index != last) {
+    entries_[index] = std::move(entries_[last]);
+  }
+  entries_.pop_back();
+
+  if (!index_.empty()) {
+    index_.erase(key);
+    if (index != last) {
+      index_[entries_[index].first] = index;
+    }
+  }
+}
 
-bool VarTable::Contains(HashValue key) const { return data_.contains(key); }
+bool VarTable::Contains(HashValue key) const { return FindIndex(key) != npos; }
 
 Var* VarTable::TryFind(HashValue key) {
-  auto iter = data_.find(key);
-  return iter != data_.end() ? &iter->second : nullptr;
+  const std::size_t index = FindIndex(key);
+  return index != npos ? &entries_[index].second : nullptr;
 }
 
 const Var* VarTable::TryFind(HashValue key) const {
-  auto iter = data_.find(key);
-  return iter != data_.end() ? &iter->second : nullptr;
+  const std::size_t index = FindIndex(key);
+  return index != npos ? &entries_[index].second : nullptr;
 }
 
-Var& VarTable::operator[](HashValue key) { return data_[key]; }
+Var& VarTable::operator[](HashValue key) { return FindOrAdd(key); }
 
 const Var& VarTable::operator[](HashValue key) const {
   static const Var kEmpty;
-  auto iter = data_.find(key);
-  return iter != data_.end() ? iter->second : kEmpty;
+  const Var* var = TryFind(key);
+  return var ? *var : kEmpty;
 }
 
 }  // namespace redux
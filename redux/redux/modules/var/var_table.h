@@ -17,12 +17,21 @@ limitations under the License.
 #ifndef REDUX_MODULES_VAR_VAR_TABLE_H_
 #define REDUX_MODULES_VAR_VAR_TABLE_H_
 
+#include <utility>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "redux/modules/var/var.h"
 
 namespace redux {
 
-// An unordered dictionary (flat_hash_map) of HashValue to Var objects.
+// An unordered dictionary of HashValue to Var objects.
+//
+// Entries are stored contiguously and, since most tables (eg. Message payloads)
+// only have a handful of keys, small tables are searched linearly. Once a table
+// grows beyond kMaxLinearSearchSize entries, a hash index into the entries is
+// built and maintained. Erasing an entry may reorder the remaining entries, and
+// inserting an entry may invalidate pointers to existing Vars.
 class VarTable {
  public:
   VarTable() = default;
@@ -77,25 +86,44 @@ class VarTable {
   template <typename T>
   T ValueOr(HashValue key, T&& default_value) const;
 
-  // Iterator API to support range based for loops.
-  auto begin() { return data_.begin(); }
-  auto end() { return data_.end(); }
-  auto begin() const { return data_.begin(); }
-  auto end() const { return data_.end(); }
+  // Iterator API to support range based for loops. Each element is a
+  // std::pair of the key and its associated Var.
+  auto begin() { return entries_.begin(); }
+  auto end() { return entries_.end(); }
+  auto begin() const { return entries_.begin(); }
+  auto end() const { return entries_.end(); }
 
  private:
-  absl::flat_hash_map<HashValue, Var> data_;
+  using Entry = std::pair<HashValue, Var>;
+
+  // Tables with up to this many entries are searched linearly without a hash
+  // index. This is also the initial capacity reserved for the entries.
+  static constexpr std::size_t kMaxLinearSearchSize = 8;
+
+  // Returns the index of the entry with the `key`, or npos if there is none.
+  std::size_t FindIndex(HashValue key) const;
+
+  // Returns the Var associated with the `key`, adding an empty one if needed.
+  Var& FindOrAdd(HashValue key);
+
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  std::vector<Entry> entries_;
+  absl::flat_hash_map<HashValue, std::size_t> index_;
 };
 
 template <typename T>
 void VarTable::Insert(HashValue key, T&& value) {
-  data_.emplace(key, std::forward<T>(value));
+  // Adding an entry may reallocate the storage that `value` lives in, so wrap
+  // it in a Var first.
+  Var var(std::forward<T>(value));
+  FindOrAdd(key) = std::move(var);
 }
 
 template <typename T>
 T VarTable::ValueOr(HashValue key, T&& default_value) const {
-  if (auto iter = data_.find(key); iter != data_.end()) {
-    return iter->second.ValueOr(std::forward<T>(default_value));
+  if (const Var* var = TryFind(key)) {
+    return var->ValueOr(std::forward<T>(default_value));
   } else {
     return std::forward<T>(default_value);
   }
@@ -78,6 +78,43 @@ TEST(VarTable, Erase) {
   EXPECT_TRUE(tbl.Contains(key3));
 }
 
+TEST(VarTable, InsertOverwrites) {
+  VarTable tbl;
+  tbl.Insert(key1, 1);
+  tbl.Insert(key1, 2.0f);
+  EXPECT_THAT(tbl.Count(), Eq(1));
+  EXPECT_THAT(tbl.ValueOr(key1, 0.0f), Eq(2.0f));
+}
+
+TEST(VarTable, ManyKeys) {
+  constexpr int kNumKeys = 64;
+  VarTable tbl;
+  for (int i = 0; i < kNumKeys; ++i) {
+    tbl.Insert(HashValue(i + 1), i);
+  }
+  EXPECT_THAT(tbl.Count(), Eq(kNumKeys));
+  for (int i = 0; i < kNumKeys; ++i) {
+    EXPECT_THAT(tbl.ValueOr(HashValue(i + 1), -1), Eq(i));
+  }
+
+  for (int i = 0; i < kNumKeys; i += 2) {
+    tbl.Erase(HashValue(i + 1));
+  }
+  EXPECT_THAT(tbl.Count(), Eq(kNumKeys / 2));
+  for (int i = 0; i < kNumKeys; ++i) {
+    const int expected = (i % 2) ? i : -1;
+    EXPECT_THAT(tbl.ValueOr(HashValue(i + 1), -1), Eq(expected));
+  }
+
+  int sum = 0;
+  for (const auto& iter : tbl) {
+    const int key = static_cast<int>(iter.first.get());
+    EXPECT_THAT(iter.second.ValueOr(-1), Eq(key - 1));
+    sum += iter.second.ValueOr(0);
+  }
+  EXPECT_THAT(sum, Eq(kNumKeys * kNumKeys / 4));
+}
+
 TEST(VarTable, TryFind) {
   VarTable tbl;
   tbl.Insert(key1, 1);
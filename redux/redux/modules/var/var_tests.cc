@@ -59,10 +59,16 @@ struct ObjectWithDynamicAllocation {
   int* ptr;
 };
 
+// Too large to fit in a Var's inline storage.
+struct LargeObject {
+  int values[32] = {0};
+};
+
 }  // namespace
 }  // namespace redux
 
 REDUX_SETUP_TYPEID(redux::ObjectWithDynamicAllocation);
+REDUX_SETUP_TYPEID(redux::LargeObject);
 
 namespace redux {
 namespace {
@@ -121,6 +127,30 @@ TEST(Var, SelfAssign) {
   EXPECT_THAT(*v.Get<ObjectWithDynamicAllocation>()->ptr, Eq(123));
 }
 
+TEST(Var, SelfAssignVar) {
+  Var v = ObjectWithDynamicAllocation(123);
+  Var& ref = v;
+  v = ref;
+  EXPECT_THAT(*v.Get<ObjectWithDynamicAllocation>()->ptr, Eq(123));
+  v = std::move(ref);
+  EXPECT_THAT(*v.Get<ObjectWithDynamicAllocation>()->ptr, Eq(123));
+}
+
+TEST(Var, AssignOwnedElement) {
+  LargeObject obj;
+  obj.values[31] = 7;
+
+  VarArray arr;
+  arr.PushBack(obj);
+  Var v = arr;
+  v = *v[0].Get<LargeObject>();
+  ASSERT_TRUE(v.Is<LargeObject>());
+  EXPECT_THAT(v.Get<LargeObject>()->values[31], Eq(7));
+
+  v = LargeObject();
+  EXPECT_THAT(v.Get<LargeObject>()->values[31], Eq(0));
+}
+
 TEST(Var, ValueOr) {
   Var v = 1;
   EXPECT_THAT(v.ValueOr(0), Eq(1));
@@ -20,6 +20,7 @@ limitations under the License.
 #include <utility>
 
 #include "redux/engines/animation/motivator/spline_motivator.h"
+#include "redux/engines/platform/frame_pacer.h"
 #include "redux/modules/base/choreographer.h"
 #include "redux/modules/math/interpolation.h"
 #include "redux/systems/rig/rig_system.h"
@@ -32,6 +33,7 @@ AnimationSystem::AnimationSystem(Registry* registry) : System(registry) {
 
 void AnimationSystem::OnRegistryInitialize() {
   engine_ = registry_->Get<AnimationEngine>();
+  rig_system_ = registry_->Get<RigSystem>();
   auto choreo = registry_->Get<Choreographer>();
   if (choreo) {
     choreo
@@ -65,8 +67,10 @@ void AnimationSystem::PlayAnimation(Entity entity,
     auto& c = iter->second;
     if (!c.motivator.Valid()) {
       c.motivator = engine_->AcquireMotivator<RigMotivator>();
+      c.motivator.SetLod(c.lod);
     }
     c.motivator.BlendToAnim(animation, playback);
+    UpdateRetargetTable(entity, &c);
   });
 
   auto& c = anims_[entity];
@@ -108,6 +112,15 @@ void AnimationSystem::OnDestroy(Entity entity) {
   }
 }
 
+void AnimationSystem::SetAnimationLod(Entity entity, const AnimationLod& lod) {
+  if (auto it = anims_.find(entity); it != anims_.end()) {
+    it->second.lod = lod;
+    if (it->second.motivator.Valid()) {
+      it->second.motivator.SetLod(lod);
+    }
+  }
+}
+
 absl::Duration AnimationSystem::GetTimeRemaining(Entity entity) const {
   auto it = anims_.find(entity);
   return it != anims_.end() ? it->second.motivator.TimeRemaining()
@@ -115,14 +128,25 @@ absl::Duration AnimationSystem::GetTimeRemaining(Entity entity) const {
 }
 
 void AnimationSystem::PostAnimation(absl::Duration delta_time) {
-  auto* rig_system = registry_->Get<RigSystem>();
+  if (!anims_.empty()) {
+    if (auto* frame_pacer = registry_->Get<FramePacer>()) {
+      frame_pacer->RequestFrame();
+    }
+  }
+
   for (auto iter = anims_.begin(); iter != anims_.end();) {
     AnimationComponent& c = iter->second;
 
     bool remove = false;
 
     if (c.motivator.Valid()) {
-      rig_system->UpdatePose(iter->first, c.motivator.GlobalTransforms());
+      UpdateRetargetTable(iter->first, &c);
+      if (c.retarget.empty()) {
+        rig_system_->UpdatePose(iter->first, c.motivator.GlobalTransforms());
+      } else {
+        rig_system_->UpdatePose(iter->first, c.motivator.GlobalTransforms(),
+                                c.retarget);
+      }
 
       if (c.motivator.TimeRemaining() == absl::ZeroDuration()) {
         if (c.on_complete) {
@@ -140,4 +164,26 @@ void AnimationSystem::PostAnimation(absl::Duration delta_time) {
   }
 }
 
+void AnimationSystem::UpdateRetargetTable(Entity entity,
+                                          AnimationComponent* c) const {
+  const AnimationClip* clip = c->animation.get();
+  const std::uint32_t skeleton_version = rig_system_->GetSkeletonVersion();
+  if (clip == c->retarget_clip &&
+      skeleton_version == c->retarget_skeleton_version) {
+    return;
+  }
+
+  c->retarget_clip = clip;
+  c->retarget_skeleton_version = skeleton_version;
+
+  // Clips without bone names are assumed to match the skeleton exactly.
+  const absl::Span<const HashValue> bones =
+      clip && clip->IsReady() ? clip->BoneNameHashes()
+                              : absl::Span<const HashValue>();
+  if (bones.empty() ||
+      !rig_system_->BuildRetargetTable(entity, bones, &c->retarget)) {
+    c->retarget.clear();
+  }
+}
+
 }  // namespace redux
@@ -17,14 +17,18 @@ limitations under the License.
 #ifndef REDUX_SYSTEMS_ANIMATION_ANIMATION_SYSTEM_H_
 #define REDUX_SYSTEMS_ANIMATION_ANIMATION_SYSTEM_H_
 
+#include <cstdint>
 #include <functional>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "redux/engines/animation/animation_engine.h"
+#include "redux/engines/animation/animation_lod.h"
 #include "redux/engines/animation/motivator/rig_motivator.h"
 #include "redux/engines/animation/motivator/spline_motivator.h"
 #include "redux/engines/animation/spline/compact_spline.h"
 #include "redux/modules/ecs/system.h"
+#include "redux/systems/rig/rig_system.h"
 
 namespace redux {
 
@@ -73,6 +77,11 @@ class AnimationSystem : public System {
   // Resumes the animation playing on the Entity.
   void ResumeAnimation(Entity entity);
 
+  // Sets the level-of-detail used to calculate the poses of the animation
+  // playing on the Entity, eg. based on whether it is visible and how large it
+  // is on screen. Has no effect if no animation is playing.
+  void SetAnimationLod(Entity entity, const AnimationLod& lod);
+
   // Returns the remaining time for the current animation. Returns 0 if there is
   // no animation playing or if the animation is complete. Returns infinity if
   // the animation is looping.
@@ -92,11 +101,23 @@ class AnimationSystem : public System {
     RigMotivator motivator;
     AnimationClipPtr animation;
     std::function<void(CompletionReason)> on_complete;
+    AnimationLod lod;
     float playback_speed = 0.f;
     bool paused = false;
+
+    // Maps the bones of `animation` to the bones of the Entity's skeleton.
+    // Empty if the bones already match the skeleton one-to-one.
+    std::vector<RigSystem::BoneIndex> retarget;
+    const AnimationClip* retarget_clip = nullptr;
+    std::uint32_t retarget_skeleton_version = 0;
   };
 
+  // Rebuilds the component's retarget table if its animation or the Entity's
+  // skeleton has changed since it was last built.
+  void UpdateRetargetTable(Entity entity, AnimationComponent* c) const;
+
   AnimationEngine* engine_ = nullptr;
+  RigSystem* rig_system_ = nullptr;
   absl::flat_hash_map<Entity, AnimationComponent> anims_;
 };
 
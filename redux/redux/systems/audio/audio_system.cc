@@ -215,6 +215,7 @@ void AudioSystem::AddSoundFromSoundDef(Entity entity, const SoundDef& def) {
   SoundPlaybackParams params;
   params.looping = def.looping;
   params.volume = def.volume;
+  params.priority = def.priority;
   Play(entity, def.uri, params);
 }
 
@@ -98,6 +98,13 @@ CameraOps CameraSystem::GetCameraOps(Entity entity) const {
                    Bounds2i::Empty());
 }
 
+void CameraSystem::ForEachCamera(
+    const std::function<void(Entity, const CameraOps&)>& fn) const {
+  for (const auto& iter : cameras_) {
+    fn(iter.first, GetCameraOps(iter.first));
+  }
+}
+
 RenderLayerPtr CameraSystem::GetRenderLayer(HashValue key) const {
   RenderLayerPtr layer;
   if (key != HashValue()) {
@@ -17,10 +17,12 @@ limitations under the License.
 #ifndef REDUX_SYSTEMS_CAMERA_CAMERA_SYSTEM_H_
 #define REDUX_SYSTEMS_CAMERA_CAMERA_SYSTEM_H_
 
+#include <functional>
 #include <optional>
 
 #include "redux/engines/render/render_engine.h"
 #include "redux/engines/render/render_layer.h"
+#include "redux/modules/ecs/entity_map.h"
 #include "redux/modules/ecs/system.h"
 #include "redux/modules/graphics/camera_ops.h"
 #include "redux/modules/math/bounds.h"
@@ -60,6 +62,10 @@ class CameraSystem : public System {
   // Returns the CameraOps associated with the Entity.
   CameraOps GetCameraOps(Entity entity) const;
 
+  // Invokes |fn| with the CameraOps of every Entity with camera properties.
+  void ForEachCamera(const std::function<void(Entity, const CameraOps&)>& fn)
+      const;
+
   // Sets the camera properties for the Entity from the CameraDef.
   void SetFromCameraDef(Entity entity, const CameraDef& def);
 
@@ -84,7 +90,7 @@ class CameraSystem : public System {
   static mat4 CalculateProjectionMatrix(const Camera& camera,
                                         const RenderLayerPtr& layer);
 
-  absl::flat_hash_map<Entity, Camera> cameras_;
+  EntityMap<Camera> cameras_;
   TransformSystem* transform_system_ = nullptr;
   RenderEngine* render_engine_ = nullptr;
 };
@@ -16,12 +16,22 @@ limitations under the License.
 
 #include "redux/systems/constraint/constraint_system.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "redux/modules/base/choreographer.h"
 #include "redux/modules/math/transform.h"
 #include "redux/systems/constraint/events.h"
 
 namespace redux {
 
+// Hierarchies are only updated on separate threads if there are at least this
+// many constraints for each thread to apply.
+static constexpr std::size_t kMinConstraintsPerThread = 256;
+
 ConstraintSystem::ConstraintSystem(Registry* registry)
     : System(registry), fns_(registry) {
   RegisterDependency<RigSystem>(this);
@@ -97,6 +107,7 @@ std::pair<Entity, bool> ConstraintSystem::TryCreateLink(
   }
 
   Constraints::Row parent_row = constraints_.TryEmplace(parent);
+  hierarchy_dirty_ = true;
   child_row.Get<kParent>() = parent;
   child_row.Get<kPrevSibling>() = kNullEntity;
   child_row.Get<kNextSibling>() = parent_row.Get<kFirstChild>();
@@ -106,6 +117,7 @@ std::pair<Entity, bool> ConstraintSystem::TryCreateLink(
   child_row.Get<kBone>() = params.child_bone;
   child_row.Get<kParentBone>() = params.parent_bone;
   child_row.Get<kIgnoreParentScale>() = params.ignore_parent_scale;
+  ResolveBones(child_row);
 
   if (!entity_factory_->IsEnabled(parent)) {
     entity_factory_->DisableIndirectly(child);
@@ -159,6 +171,7 @@ std::pair<Entity, bool> ConstraintSystem::TryRemoveLink(Entity child,
   child_row.Get<kParent>() = kNullEntity;
   child_row.Get<kPrevSibling>() = kNullEntity;
   child_row.Get<kNextSibling>() = kNullEntity;
+  hierarchy_dirty_ = true;
 
   if (!entity_factory_->IsEnabled(child)) {
     entity_factory_->Disable(child);
@@ -216,6 +229,33 @@ void ConstraintSystem::OnDestroy(Entity entity) {
   CHECK(!constraints_.Contains(entity));
 }
 
+void ConstraintSystem::SaveSnapshot(SnapshotWriter& writer) const {
+  constraints_.WriteSnapshot(writer);
+}
+
+bool ConstraintSystem::LoadSnapshot(SnapshotReader& reader) {
+  if (!constraints_.ReadSnapshot(reader)) {
+    return false;
+  }
+  hierarchy_dirty_ = true;
+
+  // Bone indices are only valid for the skeletons they were resolved against.
+  for (std::size_t i = 0; i < constraints_.Size(); ++i) {
+    Constraints::Row row = constraints_.At(i);
+    ResolveBones(row);
+  }
+  skeleton_version_ = rig_system_->GetSkeletonVersion();
+
+  // Re-acquire the transform locks on all children since the TransformSystem
+  // does not restore owners from the snapshot.
+  constraints_.ForEach<kEntity, kParent>([this](Entity entity, Entity parent) {
+    if (parent != kNullEntity) {
+      transform_system_->LockTransform(entity, this);
+    }
+  });
+  return true;
+}
+
 void ConstraintSystem::OnEnable(Entity entity) { SetEnabled(entity, true); }
 
 void ConstraintSystem::OnDisable(Entity entity) { SetEnabled(entity, false); }
@@ -262,28 +302,41 @@ void ConstraintSystem::Notify(Entity child, Entity old_parent,
   }
 }
 
-Transform ConstraintSystem::GetBoneTransform(Entity entity,
-                                             HashValue bone) const {
-  if (entity != kNullEntity && bone != HashValue()) {
-    return Transform(rig_system_->GetBonePose(entity, bone));
+mat4 ConstraintSystem::GetBoneTransform(Entity entity,
+                                        RigSystem::BoneIndex bone) const {
+  if (entity != kNullEntity && bone != RigSystem::kInvalidBoneIndex) {
+    return rig_system_->GetBonePose(entity, bone);
   }
-  return Transform();
+  return mat4::Identity();
+}
+
+void ConstraintSystem::ResolveBones(Constraints::Row& row) const {
+  const HashValue child_bone = row.Get<kBone>();
+  const HashValue parent_bone = row.Get<kParentBone>();
+  row.Get<kBoneIndex>() =
+      child_bone != HashValue()
+          ? rig_system_->GetBoneIndex(row.Get<kEntity>(), child_bone)
+          : RigSystem::kInvalidBoneIndex;
+  row.Get<kParentBoneIndex>() =
+      parent_bone != HashValue()
+          ? rig_system_->GetBoneIndex(row.Get<kParent>(), parent_bone)
+          : RigSystem::kInvalidBoneIndex;
 }
 
 void ConstraintSystem::ApplyConstraint(const Constraints::Row& row) {
   const Entity entity = row.Get<kEntity>();
   const Entity parent = row.Get<kParent>();
-  const HashValue child_bone = row.Get<kBone>();
-  const HashValue parent_bone = row.Get<kParentBone>();
+  const RigSystem::BoneIndex child_bone = row.Get<kBoneIndex>();
+  const RigSystem::BoneIndex parent_bone = row.Get<kParentBoneIndex>();
 
   mat4 parent_transform = transform_system_->GetWorldTransformMatrix(parent);
-  if (parent_bone != HashValue()) {
-    parent_transform *= rig_system_->GetBonePose(parent, parent_bone);
+  if (parent_bone != RigSystem::kInvalidBoneIndex) {
+    parent_transform *= GetBoneTransform(parent, parent_bone);
   }
 
   mat4 child_offset = TransformMatrix(row.Get<kOffset>());
-  if (child_bone != HashValue()) {
-    child_offset *= rig_system_->GetBonePose(entity, child_bone);
+  if (child_bone != RigSystem::kInvalidBoneIndex) {
+    child_offset *= GetBoneTransform(entity, child_bone);
   }
 
   if (row.Get<kIgnoreParentScale>()) {
@@ -296,34 +349,119 @@ void ConstraintSystem::ApplyConstraint(const Constraints::Row& row) {
       entity, Transform(parent_transform * child_offset), this);
 }
 
-template <typename Fn>
-void ConstraintSystem::ForEachRowInHierarchy(Entity root, const Fn& fn) {
-  if (root == kNullEntity) {
-    return;
+void ConstraintSystem::ApplyConstraints(std::size_t begin, std::size_t end) {
+  for (std::size_t i = begin; i < end; ++i) {
+    ApplyConstraint(constraints_.At(i));
   }
-  const Constraints::Row row = constraints_.FindRow(root);
-  if (!row) {
+}
+
+void ConstraintSystem::SortHierarchy() {
+  if (!hierarchy_dirty_) {
     return;
   }
 
-  fn(row);
-  ForEachRowInHierarchy(row.Get<kFirstChild>(), fn);
-  ForEachRowInHierarchy(row.Get<kNextSibling>(), fn);
+  // Build the desired order by starting with all the roots and then doing a
+  // breadth-first walk through the children of each root in turn.
+  std::vector<Entity> order;
+  order.reserve(constraints_.Size());
+  absl::flat_hash_map<Entity, std::size_t> rows;
+  rows.reserve(constraints_.Size());
+  for (std::size_t i = 0; i < constraints_.Size(); ++i) {
+    const auto row = constraints_.At(i);
+    const Entity entity = row.Get<kEntity>();
+    rows[entity] = i;
+    if (row.Get<kParent>() == kNullEntity) {
+      order.push_back(entity);
+    }
+  }
+  first_child_row_ = order.size();
+
+  auto add_children = [&](Entity parent) {
+    auto child = constraints_.Find<kEntity, kNextSibling>(
+        *constraints_.Find<kFirstChild>(parent));
+    while (child) {
+      order.push_back(child.Get<kEntity>());
+      child = constraints_.Find<kEntity, kNextSibling>(
+          child.Get<kNextSibling>());
+    }
+  };
+
+  hierarchies_.clear();
+  for (std::size_t root = 0; root < first_child_row_; ++root) {
+    const std::size_t begin = order.size();
+    add_children(order[root]);
+    for (std::size_t i = begin; i < order.size(); ++i) {
+      add_children(order[i]);
+    }
+    if (order.size() > begin) {
+      hierarchies_.push_back({begin, order.size()});
+    }
+  }
+  CHECK_EQ(order.size(), constraints_.Size());
+
+  // Swap each Entity into its sorted position, tracking where the displaced
+  // Entity ends up.
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    const std::size_t row = rows[order[i]];
+    if (row != i) {
+      const Entity displaced = constraints_.At(i).Get<kEntity>();
+      constraints_.Swap(i, row);
+      rows[displaced] = row;
+    }
+  }
+  hierarchy_dirty_ = false;
 }
 
 void ConstraintSystem::UpdateTransforms() {
-  // Awful, awful performance, completely negating the benefits of using a
-  // structure-of-arrays data container. But, it works.
-  for (auto row : constraints_) {
-    if (row.Get<kParent>() == kNullEntity) {
-      const Entity root = row.Get<kEntity>();
-      ForEachRowInHierarchy(root, [&](const Constraints::Row& row) {
-        if (row.Get<kParent>() != kNullEntity) {
-          ApplyConstraint(row);
-        }
+  SortHierarchy();
+
+  const std::uint32_t skeleton_version = rig_system_->GetSkeletonVersion();
+  if (skeleton_version != skeleton_version_) {
+    for (std::size_t i = first_child_row_; i < constraints_.Size(); ++i) {
+      Constraints::Row row = constraints_.At(i);
+      ResolveBones(row);
+    }
+    skeleton_version_ = skeleton_version;
+  }
+
+  // Parents always precede their children, so a parent's world transform is
+  // up-to-date by the time any of its children are visited.
+  const std::size_t end = constraints_.Size();
+  std::size_t num_threads = 1;
+#ifndef REDUX_DISABLE_THREADS
+  const std::size_t num_rows = end - first_child_row_;
+  num_threads = std::min({static_cast<std::size_t>(
+                              std::thread::hardware_concurrency()),
+                          hierarchies_.size(),
+                          num_rows / kMinConstraintsPerThread});
+#endif
+  if (num_threads <= 1) {
+    ApplyConstraints(first_child_row_, end);
+    return;
+  }
+
+#ifndef REDUX_DISABLE_THREADS
+  // Each hierarchy only reads and writes the transforms of its own Entities,
+  // so separate hierarchies can be updated concurrently. Give each thread a
+  // contiguous run of whole hierarchies with roughly the same number of rows.
+  const std::size_t rows_per_thread =
+      (num_rows + num_threads - 1) / num_threads;
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  std::size_t begin = first_child_row_;
+  for (const RowRange& hierarchy : hierarchies_) {
+    if (hierarchy.end - begin >= rows_per_thread && hierarchy.end < end) {
+      threads.emplace_back([this, begin, stop = hierarchy.end]() {
+        ApplyConstraints(begin, stop);
       });
+      begin = hierarchy.end;
     }
   }
+  ApplyConstraints(begin, end);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+#endif
 }
 
 }  // namespace redux
@@ -17,8 +17,10 @@ limitations under the License.
 #ifndef REDUX_SYSTEMS_CONSTRAINT_CONSTRAINT_SYSTEM_H_
 #define REDUX_SYSTEMS_CONSTRAINT_CONSTRAINT_SYSTEM_H_
 
+#include <cstdint>
 #include <functional>
 #include <utility>
+#include <vector>
 
 #include "absl/types/span.h"
 #include "redux/engines/script/function_binder.h"
@@ -72,6 +74,10 @@ class ConstraintSystem : public System {
 
   // Iterates over all "child" Entities, updating their transforms based on
   // their parents and attachment properties.
+  //
+  // Rows are kept sorted such that every parent precedes its children and the
+  // descendants of each root are contiguous, so this is a linear pass over the
+  // child rows. Independent hierarchies may be updated on separate threads.
   void UpdateTransforms();
 
  private:
@@ -84,16 +90,27 @@ class ConstraintSystem : public System {
   struct kBone : DataColumn<HashValue> {};
   struct kParentBone : DataColumn<HashValue> {};
   struct kIgnoreParentScale : DataColumn<uint8_t> {};
+  struct kBoneIndex : DataColumn<RigSystem::BoneIndex> {};
+  struct kParentBoneIndex : DataColumn<RigSystem::BoneIndex> {};
 
   using Constraints =
       DataTable<kEntity, kParent, kFirstChild, kNextSibling, kPrevSibling,
-                kOffset, kBone, kParentBone, kIgnoreParentScale>;
+                kOffset, kBone, kParentBone, kIgnoreParentScale, kBoneIndex,
+                kParentBoneIndex>;
+
+  // A range of rows in constraints_ holding all the descendants of one root.
+  struct RowRange {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+  };
 
   enum EnableState {};
 
   void OnEnable(Entity entity) override;
   void OnDisable(Entity entity) override;
   void OnDestroy(Entity entity) override;
+  void SaveSnapshot(SnapshotWriter& writer) const override;
+  bool LoadSnapshot(SnapshotReader& reader) override;
 
   std::pair<Entity, bool> TryCreateLink(Entity parent, Entity child,
                                         const AttachParams& params);
@@ -104,16 +121,37 @@ class ConstraintSystem : public System {
   void Notify(Entity child, Entity old_parent, Entity new_parent,
               bool on_destroy);
 
-  Transform GetBoneTransform(Entity entity, HashValue bone) const;
+  mat4 GetBoneTransform(Entity entity, RigSystem::BoneIndex bone) const;
 
   void ApplyConstraint(const Constraints::Row& row);
 
-  template <typename Fn>
-  void ForEachRowInHierarchy(Entity root, const Fn& fn);
+  // Applies the constraints of all the rows in the range [begin, end).
+  void ApplyConstraints(std::size_t begin, std::size_t end);
+
+  // Looks up the bone indices for the bones used by the row's constraint.
+  void ResolveBones(Constraints::Row& row) const;
+
+  // Reorders the rows of constraints_ such that all root Entities come first
+  // followed by the descendants of each root in turn, with every Entity
+  // coming after its parent.
+  void SortHierarchy();
 
   FunctionBinder fns_;
   Constraints constraints_;
 
+  // Whether constraints_ needs to be re-sorted by SortHierarchy.
+  bool hierarchy_dirty_ = false;
+
+  // The index of the first non-root row in constraints_ once sorted.
+  std::size_t first_child_row_ = 0;
+
+  // The rows of each independent hierarchy (ie. root with children) once
+  // sorted. These ranges are contiguous and cover all the non-root rows.
+  std::vector<RowRange> hierarchies_;
+
+  // The RigSystem skeleton version for which the bone indices were resolved.
+  std::uint32_t skeleton_version_ = 0;
+
   RigSystem* rig_system_ = nullptr;
   TransformSystem* transform_system_ = nullptr;
   DispatcherSystem* dispatcher_system_ = nullptr;
@@ -14,6 +14,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <string_view>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "redux/modules/math/testing.h"
@@ -98,6 +101,99 @@ TEST_F(ConstraintSystemTest, AttachChildChain) {
   EXPECT_TRUE(constraint_system_->IsAncestorOf(parent_2, child));
 }
 
+TEST_F(ConstraintSystemTest, AttachChildChainOutOfOrder) {
+  const Entity child(1);
+  const Entity parent_1(2);
+  const Entity parent_2(3);
+
+  Transform transform;
+  transform.translation = vec3(1.0f, 2.0f, 3.0f);
+  transform.rotation = QuaternionFromEulerAngles(vec3(kHalfPi, 0.0f, 0.0f));
+
+  // Attach the bottom of the chain first so that the child's row is created
+  // before the rows of its ancestors.
+  transform_system_->SetTransform(parent_1, transform);
+  constraint_system_->AttachChild(parent_2, child, {.local_offset = transform});
+  constraint_system_->AttachChild(parent_1, parent_2,
+                                  {.local_offset = transform});
+
+  constraint_system_->UpdateTransforms();
+
+  transform = transform_system_->GetTransform(child);
+  EXPECT_THAT(transform.translation,
+              MathNear(vec3(3.0f, -3.0f, 2.0f), kEpsilon));
+  EXPECT_THAT(ToEulerAngles(transform.rotation),
+              MathNear(vec3(-kHalfPi, 0.0f, 0.0f), kEpsilon));
+
+  // Moving the root should update the whole chain in a single update.
+  transform.translation = vec3(2.0f, 2.0f, 3.0f);
+  transform.rotation = QuaternionFromEulerAngles(vec3(kHalfPi, 0.0f, 0.0f));
+  transform_system_->SetTransform(parent_1, transform);
+
+  constraint_system_->UpdateTransforms();
+
+  transform = transform_system_->GetTransform(child);
+  EXPECT_THAT(transform.translation,
+              MathNear(vec3(4.0f, -3.0f, 2.0f), kEpsilon));
+}
+
+TEST_F(ConstraintSystemTest, AttachChildToBone) {
+  const Entity child(1);
+  const Entity parent(2);
+
+  constraint_system_->AttachChild(parent, child,
+                                  {.parent_bone = ConstHash("hand")});
+
+  // The skeleton is set after attaching, so the bone must be resolved later.
+  const std::string_view bones[] = {"root", "hand"};
+  const RigSystem::BoneIndex hierarchy[] = {RigSystem::kInvalidBoneIndex, 0};
+  rig_system_->SetSkeleton(parent, bones, hierarchy);
+
+  const mat4 pose[] = {mat4::Identity(),
+                       TransformMatrix(vec3(1.0f, 2.0f, 3.0f), quat::Identity(),
+                                       vec3::One())};
+  rig_system_->UpdatePose(parent, pose);
+  constraint_system_->UpdateTransforms();
+
+  const Transform transform = transform_system_->GetTransform(child);
+  EXPECT_THAT(transform.translation,
+              MathNear(vec3(1.0f, 2.0f, 3.0f), kEpsilon));
+}
+
+TEST_F(ConstraintSystemTest, ManyHierarchies) {
+  constexpr int kNumRoots = 8;
+  constexpr int kDepth = 100;
+
+  Transform offset;
+  offset.translation = vec3(1.0f, 0.0f, 0.0f);
+
+  std::vector<Entity> leaves;
+  for (int i = 0; i < kNumRoots; ++i) {
+    const Entity root = entity_factory_->Create();
+    Transform transform;
+    transform.translation = vec3(0.0f, static_cast<float>(i), 0.0f);
+    transform_system_->SetTransform(root, transform);
+
+    Entity parent = root;
+    for (int j = 0; j < kDepth; ++j) {
+      const Entity child = entity_factory_->Create();
+      constraint_system_->AttachChild(parent, child, {.local_offset = offset});
+      parent = child;
+    }
+    leaves.push_back(parent);
+  }
+
+  constraint_system_->UpdateTransforms();
+
+  for (int i = 0; i < kNumRoots; ++i) {
+    const Transform transform = transform_system_->GetTransform(leaves[i]);
+    EXPECT_THAT(transform.translation,
+                MathNear(vec3(static_cast<float>(kDepth),
+                              static_cast<float>(i), 0.0f),
+                         kEpsilon));
+  }
+}
+
 TEST_F(ConstraintSystemTest, RemoveParent) {
   const Entity child(1);
   const Entity parent(2);
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "redux/engines/render/render_engine.h"
 #include "redux/modules/base/hash.h"
+#include "redux/modules/ecs/entity_map.h"
 #include "redux/modules/ecs/system.h"
 #include "redux/modules/math/math.h"
 #include "redux/systems/light/light_def_generated.h"
@@ -115,7 +116,7 @@ class LightSystem : public System {
   void OnDestroy(Entity entity) override;
 
   RenderEngine* engine_ = nullptr;
-  absl::flat_hash_map<Entity, LightComponent> lights_;
+  EntityMap<LightComponent> lights_;
 };
 
 }  // namespace redux
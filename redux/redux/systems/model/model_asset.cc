@@ -202,6 +202,52 @@ static ModelAsset::TextureData ReadTextureData(
   return info;
 }
 
+static CollisionDataPtr ReadCollisionData(
+    const ModelCollisionShapeAssetDef* shape_def,
+    const std::shared_ptr<DataContainer>& data) {
+  if (shape_def == nullptr || shape_def->vertices() == nullptr ||
+      shape_def->indices() == nullptr) {
+    return nullptr;
+  }
+
+  VertexFormat expected_format;
+  expected_format.AppendAttribute({VertexUsage::Position, VertexType::Vec3f});
+  if (ReadVertexFormat(shape_def->vertices()) != expected_format) {
+    LOG(ERROR) << "Collision shapes must only contain vec3f positions.";
+    return nullptr;
+  }
+
+  // The collision mesh, like the rest of the model, points directly into the
+  // asset where possible.
+  CollisionMesh mesh;
+  mesh.vertices = DataContainer::WrapDataInSharedPtr(
+      ReadVertexData(shape_def->vertices()), data);
+  if (const auto* indices32 = shape_def->indices()->data32()) {
+    mesh.indices = DataContainer::WrapDataInSharedPtr(AsByteSpan(indices32),
+                                                      data);
+  } else if (const auto* indices16 = shape_def->indices()->data16()) {
+    // CollisionMeshes require 32-bit indices.
+    const size_t num_bytes = indices16->size() * sizeof(int);
+    std::byte* bytes = new std::byte[num_bytes];
+    int* indices = reinterpret_cast<int*>(bytes);
+    for (uint16_t index : *indices16) {
+      *indices++ = index;
+    }
+    auto deleter = [](const std::byte* mem) { delete[] mem; };
+    mesh.indices = DataContainer(bytes, num_bytes, std::move(deleter));
+  } else {
+    return nullptr;
+  }
+  if (shape_def->bullet_bvh()) {
+    mesh.bvh = DataContainer::WrapDataInSharedPtr(
+        AsByteSpan(shape_def->bullet_bvh()), data);
+  }
+
+  auto collision_data = std::make_shared<CollisionData>();
+  collision_data->AddMesh(vec3::Zero(), quat::Identity(), std::move(mesh));
+  return collision_data;
+}
+
 void ModelAsset::OnLoad(std::shared_ptr<DataContainer> data,
                         ImageDecoder decoder) {
   data_ = std::move(data);
@@ -217,26 +263,32 @@ void ModelAsset::OnLoad(std::shared_ptr<DataContainer> data,
 
   const ModelAssetDef* model_def = flatbuffers::GetRoot<ModelAssetDef>(ptr);
 
-  const int lod = 0;
-  if (model_def->lods() == nullptr || model_def->lods()->size() != 1) {
-    LOG(FATAL) << "Only support single LODs for now.";
+  if (model_def->lods() == nullptr || model_def->lods()->size() == 0) {
+    LOG(FATAL) << "Model must have at least one LOD.";
     return;
   }
 
-  const ModelInstanceAssetDef* instance = model_def->lods()->Get(lod);
-  CHECK(instance);
-
-  const ModelVertexBufferAssetDef* vertex_buffer = instance->vertices();
-  const ModelIndexBufferAssetDef* index_buffer = instance->indices();
+  lods_.resize(model_def->lods()->size());
+  for (size_t i = 0; i < lods_.size(); ++i) {
+    const ModelInstanceAssetDef* lod_def = model_def->lods()->Get(i);
+    CHECK(lod_def);
+
+    const ModelVertexBufferAssetDef* vertex_buffer = lod_def->vertices();
+    const ModelIndexBufferAssetDef* index_buffer = lod_def->indices();
+
+    LodData& lod = lods_[i];
+    ReadVector(&lod.parts, lod_def->parts(), ReadMeshPart);
+    lod.vertex_format = ReadVertexFormat(vertex_buffer);
+    lod.vertex_data = ReadVertexData(vertex_buffer);
+    lod.index_format = ReadIndexType(index_buffer);
+    lod.index_data = ReadIndexData(index_buffer);
+    lod.error = lod_def->lod_error();
+  }
 
-  ReadVector(&parts_, instance->parts(), ReadMeshPart);
+  // Materials, blend shapes, collisions and skinning come from the first LOD.
+  const ModelInstanceAssetDef* instance = model_def->lods()->Get(0);
   ReadVector(&materials_, instance->parts(), ReadMaterial);
 
-  vertex_format_ = ReadVertexFormat(vertex_buffer);
-  vertex_data_ = ReadVertexData(vertex_buffer);
-  index_format_ = ReadIndexType(index_buffer);
-  index_data_ = ReadIndexData(index_buffer);
-
   if (instance->blend_shapes() && instance->blend_shapes()->size() > 0) {
     // We assume the first blend shape has the format.
     blend_format_ =
@@ -249,6 +301,8 @@ void ModelAsset::OnLoad(std::shared_ptr<DataContainer> data,
     }
   }
 
+  collision_data_ = ReadCollisionData(instance->collision_shape(), data_);
+
   const ModelSkeletonAssetDef* skeleton = model_def->skeleton();
   if (skeleton && skeleton->bone_names() &&
       skeleton->bone_names()->size() > 0) {
@@ -295,17 +349,20 @@ const ModelAsset::TextureData* ModelAsset::GetTextureData(
   }
 }
 
-MeshData ModelAsset::GetMeshData() const {
+MeshData ModelAsset::GetMeshData(size_t lod) const {
+  CHECK_LT(lod, lods_.size());
+  const LodData& data = lods_[lod];
   DataContainer vertices =
-      DataContainer::WrapDataInSharedPtr(vertex_data_, data_);
+      DataContainer::WrapDataInSharedPtr(data.vertex_data, data_);
   DataContainer indices =
-      DataContainer::WrapDataInSharedPtr(index_data_, data_);
-  DataContainer parts = DataContainer::WrapData(parts_.data(), parts_.size());
+      DataContainer::WrapDataInSharedPtr(data.index_data, data_);
+  DataContainer parts =
+      DataContainer::WrapData(data.parts.data(), data.parts.size());
 
   MeshData mesh_data;
-  mesh_data.SetVertexData(vertex_format_, std::move(vertices), bounds_);
-  if (!index_data_.empty()) {
-    mesh_data.SetIndexData(index_format_, std::move(indices));
+  mesh_data.SetVertexData(data.vertex_format, std::move(vertices), bounds_);
+  if (!data.index_data.empty()) {
+    mesh_data.SetIndexData(data.index_format, std::move(indices));
   }
   mesh_data.SetParts(parts.Clone());
   return mesh_data;
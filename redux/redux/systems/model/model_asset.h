@@ -45,8 +45,15 @@ class ModelAsset {
 
   bool IsReady() const { return is_ready_; }
 
-  // Returns the MeshData contained in the model asset.
-  MeshData GetMeshData() const;
+  // Returns the MeshData for the given LOD level contained in the model asset.
+  MeshData GetMeshData(size_t lod = 0) const;
+
+  // Returns the number of LOD levels in the model asset.
+  size_t GetNumLods() const { return lods_.size(); }
+
+  // Returns the estimated distance (in model units) between the surface of the
+  // given LOD level and the surface of the first LOD level.
+  float GetLodError(size_t lod) const { return lods_[lod].error; }
 
   // Returns the Materials defined in the model asset, one material for each
   // part of the mesh.
@@ -103,19 +110,25 @@ class ModelAsset {
   std::shared_ptr<ImageData> ReadImage(ImageData image,
                                        const ImageDecoder& decoder);
 
+  // The mesh data of a single LOD level.
+  struct LodData {
+    VertexFormat vertex_format;
+    MeshIndexType index_format;
+    ByteSpan vertex_data;
+    ByteSpan index_data;
+    std::vector<MeshData::PartData> parts;
+    float error = 0.f;
+  };
+
   std::shared_ptr<DataContainer> data_;
 
   // Information extracted from the raw ModelDef asset. We try as much as
   // possible to simply point to the buffer directly in the asset, but do need
   // to perform some additional processing in order to make the data compatible
   // with our runtime.
-  VertexFormat vertex_format_;
+  std::vector<LodData> lods_;
   VertexFormat blend_format_;
-  MeshIndexType index_format_;
   CollisionDataPtr collision_data_;
-  ByteSpan vertex_data_;
-  ByteSpan index_data_;
-  std::vector<MeshData::PartData> parts_;
   std::vector<MaterialData> materials_;
   std::vector<std::string_view> bone_names_;
   std::vector<mat4> inverse_bind_pose_;
@@ -19,10 +19,14 @@ limitations under the License.
 #include "redux/engines/render/mesh_factory.h"
 #include "redux/engines/render/texture_factory.h"
 #include "redux/modules/base/asset_loader.h"
+#include "redux/modules/base/choreographer.h"
 #include "redux/modules/codecs/decode_image.h"
+#include "redux/modules/math/constants.h"
+#include "redux/systems/camera/camera_system.h"
 #include "redux/systems/physics/physics_system.h"
 #include "redux/systems/render/render_system.h"
 #include "redux/systems/rig/rig_system.h"
+#include "redux/systems/transform/transform_system.h"
 
 namespace redux {
 
@@ -37,8 +41,16 @@ void ModelSystem::OnRegistryInitialize() {
   if (mesh_factory) {
     empty_mesh_ = mesh_factory->EmptyMesh();
   }
+
+  auto choreo = registry_->Get<Choreographer>();
+  if (choreo) {
+    choreo->Add<&ModelSystem::UpdateLods>(Choreographer::Stage::kRender)
+        .Before<&RenderSystem::PrepareToRender>();
+  }
 }
 
+void ModelSystem::OnDestroy(Entity entity) { lods_.erase(entity); }
+
 void ModelSystem::AddFromDef(Entity entity, const ModelDef& def) {
   if (entity == kNullEntity) {
     return;
@@ -57,6 +69,8 @@ void ModelSystem::AddFromDef(Entity entity, const ModelDef& def) {
   setup.entity = entity;
   setup.model_id = key;
   setup.render_scene = ConstHash("default");
+  setup.lod_pixel_error = def.lod_pixel_error;
+  setup.lod_hysteresis = def.lod_hysteresis;
 
   if (model->IsReady()) {
     FinalizeEntity(setup);
@@ -103,7 +117,7 @@ void ModelSystem::ReleaseModel(HashValue key) {
   if (iter != instances_.end()) {
     auto* texture_factory = registry_->Get<TextureFactory>();
     if (texture_factory) {
-      for (auto& texture_iter : iter->second.textures) {
+      for (auto& texture_iter : iter->second->textures) {
         texture_factory->ReleaseTexture(texture_iter.first);
       }
     }
@@ -121,16 +135,20 @@ void ModelSystem::FinalizeModel(HashValue key) {
   }
 }
 
-ModelSystem::ModelInstance ModelSystem::GenerateModelInstance(
+ModelSystem::ModelInstancePtr ModelSystem::GenerateModelInstance(
     const ModelAsset& asset) {
-  ModelInstance instance;
+  auto instance = std::make_shared<ModelInstance>();
 
   auto* mesh_factory = registry_->Get<RenderEngine>()->GetMeshFactory();
   auto* physics_engine = registry_->Get<PhysicsEngine>();
   auto* texture_factory = registry_->Get<RenderEngine>()->GetTextureFactory();
 
   if (mesh_factory) {
-    instance.mesh = mesh_factory->CreateMesh(asset.GetMeshData());
+    for (size_t lod = 0; lod < asset.GetNumLods(); ++lod) {
+      MeshPtr mesh = mesh_factory->CreateMesh(asset.GetMeshData(lod));
+      instance->meshes.push_back(std::move(mesh));
+      instance->lod_errors.push_back(asset.GetLodError(lod));
+    }
   }
 
   if (texture_factory) {
@@ -150,14 +168,14 @@ ModelSystem::ModelInstance ModelSystem::GenerateModelInstance(
           } else {
             LOG(FATAL) << "Texture must have either a filename or image data.";
           }
-          instance.textures[key] = texture;
+          instance->textures[key] = texture;
         }
       }
     }
   }
 
   if (physics_engine && asset.GetCollisionData()) {
-    instance.collision_shape =
+    instance->collision_shape =
         physics_engine->CreateShape(asset.GetCollisionData());
   }
 
@@ -168,17 +186,17 @@ void ModelSystem::FinalizeEntity(const EntitySetupInfo& setup) {
   auto model = models_.Find(setup.model_id);
   CHECK(model && model->IsReady()) << "Model is not ready.";
 
-  ModelInstance instance;
+  // Entities share the instance generated for the model rather than copying
+  // it, so adding another Entity with the same model only costs a reference.
+  ModelInstancePtr instance;
   if (setup.distinct) {
     instance = GenerateModelInstance(*model);
   } else {
-    auto iter = instances_.find(setup.model_id);
-    if (iter == instances_.end()) {
-      instance = GenerateModelInstance(*model);
-      instances_[setup.model_id] = instance;
-    } else {
-      instance = iter->second;
+    ModelInstancePtr& shared = instances_[setup.model_id];
+    if (shared == nullptr) {
+      shared = GenerateModelInstance(*model);
     }
+    instance = shared;
   }
 
   auto* rig_system = registry_->Get<RigSystem>();
@@ -190,10 +208,19 @@ void ModelSystem::FinalizeEntity(const EntitySetupInfo& setup) {
                             model->GetParentBoneIndices());
   }
 
-  render_system->SetMesh(setup.entity, instance.mesh);
+  const MeshPtr& mesh =
+      instance->meshes.empty() ? empty_mesh_ : instance->meshes[0];
+  render_system->SetMesh(setup.entity, mesh);
+  if (instance->meshes.size() > 1) {
+    LodComponent& lod = lods_[setup.entity];
+    lod.instance = instance;
+    lod.pixel_error = setup.lod_pixel_error;
+    lod.hysteresis = setup.lod_hysteresis;
+    lod.lod = 0;
+  }
 
   if (physics_system) {
-    physics_system->SetShape(setup.entity, instance.collision_shape);
+    physics_system->SetShape(setup.entity, instance->collision_shape);
   }
 
   // Set the material at the very end after all the other properties are done.
@@ -250,8 +277,11 @@ void ModelSystem::FinalizeEntity(const EntitySetupInfo& setup) {
         }
       }
       for (const auto& sampler : material.textures) {
-        auto texture = instance.textures[Hash(sampler.texture)];
-        render_system->SetTexture(setup.entity, sampler.usage, texture);
+        const auto texture = instance->textures.find(Hash(sampler.texture));
+        render_system->SetTexture(setup.entity, sampler.usage,
+                                  texture != instance->textures.end()
+                                      ? texture->second
+                                      : nullptr);
       }
       render_system->SetInverseBindPose(setup.entity,
                                         model->GetInverseBindPose());
@@ -262,4 +292,72 @@ void ModelSystem::FinalizeEntity(const EntitySetupInfo& setup) {
   }
 }
 
+void ModelSystem::UpdateLods() {
+  if (lods_.empty()) {
+    return;
+  }
+
+  auto* camera_system = registry_->Get<CameraSystem>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+  auto* render_system = registry_->Get<RenderSystem>();
+  if (camera_system == nullptr || transform_system == nullptr) {
+    return;
+  }
+
+  // For each camera, the number of pixels covered by one world unit at unit
+  // distance along the vertical axis of the viewport.
+  std::vector<std::pair<vec3, float>> cameras;
+  camera_system->ForEachCamera([&](Entity, const CameraOps& camera) {
+    const float height = static_cast<float>(camera.Viewport().Size().y);
+    if (height <= 0.f) {
+      return;
+    }
+    const float focal = camera.ClipFromCamera()(1, 1);
+    cameras.emplace_back(camera.WorldPosition(), focal * height * 0.5f);
+  });
+  if (cameras.empty()) {
+    return;
+  }
+
+  for (auto& iter : lods_) {
+    LodComponent& c = iter.second;
+    const mat4 world = transform_system->GetWorldTransformMatrix(iter.first);
+    const vec3 position(world(0, 3), world(1, 3), world(2, 3));
+    float scale = 0.f;
+    for (int col = 0; col < 3; ++col) {
+      const vec3 axis(world(0, col), world(1, col), world(2, col));
+      scale = std::max(scale, axis.Length());
+    }
+
+    // Use the camera that sees the largest error, i.e. the closest one.
+    float pixels_per_unit = 0.f;
+    for (const auto& camera : cameras) {
+      const float distance =
+          std::max((position - camera.first).Length(), kDefaultEpsilon);
+      pixels_per_unit =
+          std::max(pixels_per_unit, camera.second * scale / distance);
+    }
+
+    // Only coarsen once the next LOD is comfortably below the allowed error,
+    // but refine as soon as the current LOD exceeds it.
+    const ModelInstance& instance = *c.instance;
+    const size_t num_lods = instance.meshes.size();
+    const float coarsen_error = c.pixel_error * (1.f - c.hysteresis);
+    size_t lod = c.lod;
+    while (lod + 1 < num_lods &&
+           instance.lod_errors[lod + 1] * pixels_per_unit <= coarsen_error) {
+      ++lod;
+    }
+    while (lod > 0 &&
+           instance.lod_errors[lod] * pixels_per_unit > c.pixel_error) {
+      --lod;
+    }
+
+    if (lod != c.lod) {
+      c.lod = lod;
+      render_system->SetMesh(iter.first, instance.meshes[lod]);
+    }
+  }
+}
+
 }  // namespace redux
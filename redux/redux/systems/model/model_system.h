@@ -17,6 +17,9 @@ limitations under the License.
 #ifndef REDUX_SYSTEMS_MODEL_MODEL_SYSTEM_H_
 #define REDUX_SYSTEMS_MODEL_MODEL_SYSTEM_H_
 
+#include <memory>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "redux/engines/physics/collision_shape.h"
 #include "redux/engines/render/mesh.h"
@@ -42,9 +45,20 @@ class ModelSystem : public System {
   // Releases the loaded model file from the internal cache.
   void ReleaseModel(HashValue key);
 
+  // Selects the LOD of each model with multiple LODs such that its on-screen
+  // error, as seen from the closest camera, is within the allowed error. Note:
+  // this function is automatically bound to run before rendering if the
+  // choreographer is available.
+  void UpdateLods();
+
  private:
+  // The render and physics resources created from a ModelAsset. Instances are
+  // immutable once generated so that they can be shared by all the Entities
+  // using the same model.
   struct ModelInstance {
-    MeshPtr mesh;
+    // One mesh per LOD level, along with each LOD level's error in model units.
+    std::vector<MeshPtr> meshes;
+    std::vector<float> lod_errors;
     CollisionShapePtr collision_shape;
     absl::flat_hash_map<HashValue, TexturePtr> textures;
   };
@@ -54,11 +68,25 @@ class ModelSystem : public System {
     HashValue model_id = HashValue(0);
     HashValue render_scene = HashValue(0);
     bool distinct = false;
+    float lod_pixel_error = 1.0f;
+    float lod_hysteresis = 0.25f;
+  };
+
+  using ModelInstancePtr = std::shared_ptr<const ModelInstance>;
+
+  struct LodComponent {
+    // The instance holding the meshes and errors of each LOD level.
+    ModelInstancePtr instance;
+    float pixel_error = 1.0f;
+    float hysteresis = 0.25f;
+    size_t lod = 0;
   };
 
+  void OnDestroy(Entity entity) override;
+
   void AddFromDef(Entity entity, const ModelDef& def);
 
-  ModelInstance GenerateModelInstance(const ModelAsset& asset);
+  ModelInstancePtr GenerateModelInstance(const ModelAsset& asset);
 
   void FinalizeModel(HashValue key);
   void FinalizeEntity(const EntitySetupInfo& setup);
@@ -69,9 +97,10 @@ class ModelSystem : public System {
 
   // The "raw" models as loaded directly off disk.
   ResourceManager<ModelAsset> models_;
-  absl::flat_hash_map<HashValue, ModelInstance> instances_;
+  absl::flat_hash_map<HashValue, ModelInstancePtr> instances_;
   absl::flat_hash_map<HashValue, std::vector<EntitySetupInfo>>
       pending_entities_;
+  absl::flat_hash_map<Entity, LodComponent> lods_;
   MeshPtr empty_mesh_;
 };
 
@@ -37,12 +37,11 @@ void PhysicsSystem::OnRegistryInitialize() {
   dispatcher_system_ = registry_->Get<DispatcherSystem>();
 
   if (dispatcher_system_) {
-    engine_->SetOnEnterCollisionCallback([=](Entity entity_a, Entity entity_b) {
-      OnCollisionEnter(entity_a, entity_b);
-    });
-    engine_->SetOnExitCollisionCallback([=](Entity entity_a, Entity entity_b) {
-      OnCollisionExit(entity_a, entity_b);
-    });
+    engine_->SetCollisionBatchCallback(
+        [=](absl::Span<const PhysicsEngine::CollisionPair> entered,
+            absl::Span<const PhysicsEngine::CollisionPair> exited) {
+          OnCollisions(entered, exited);
+        });
   }
 
   auto choreo = registry_->Get<Choreographer>();
@@ -102,6 +101,7 @@ void PhysicsSystem::OnDestroy(Entity entity) {
   trigger_volumes_.erase(entity);
   rigid_bodies_.erase(entity);
   shapes_.erase(entity);
+  engine_->SetContactPointsEnabled(entity, false);
 }
 
 void PhysicsSystem::PrePhysics(absl::Duration timestep) {
@@ -138,21 +138,27 @@ void PhysicsSystem::PrePhysics(absl::Duration timestep) {
 void PhysicsSystem::PostPhysics(absl::Duration timestep) {
   auto* transform_system = registry_->Get<TransformSystem>();
 
-  for (auto& iter : rigid_bodies_) {
-    if (iter.second.params.type != RigidBodyMotionType::Dynamic) {
-      continue;
-    }
-    if (iter.second.rigid_body == nullptr) {
-      continue;
-    }
-    if (!iter.second.rigid_body->IsActive()) {
-      continue;
-    }
+  // The engine only reports the dynamic rigid bodies whose (interpolated) pose
+  // changed, so bodies that are asleep or at rest are never written back.
+  const PhysicsEngine::RigidBodyPoses poses =
+      engine_->GetUpdatedRigidBodyPoses();
+  for (size_t i = 0; i < poses.entities.size(); ++i) {
+    const Entity entity = poses.entities[i];
+    Transform transform = transform_system->GetTransform(entity);
+    transform.translation = poses.positions[i];
+    transform.rotation = poses.rotations[i];
+    transform_system->SetTransform(entity, transform);
+  }
+}
 
-    Transform transform = transform_system->GetTransform(iter.first);
-    transform.translation = iter.second.rigid_body->GetPosition();
-    transform.rotation = iter.second.rigid_body->GetRotation();
-    transform_system->SetTransform(iter.first, transform);
+void PhysicsSystem::OnCollisions(
+    absl::Span<const PhysicsEngine::CollisionPair> entered,
+    absl::Span<const PhysicsEngine::CollisionPair> exited) {
+  for (const PhysicsEngine::CollisionPair& pair : entered) {
+    OnCollisionEnter(pair.entity_a, pair.entity_b);
+  }
+  for (const PhysicsEngine::CollisionPair& pair : exited) {
+    OnCollisionExit(pair.entity_a, pair.entity_b);
   }
 }
 
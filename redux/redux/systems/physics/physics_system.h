@@ -90,6 +90,8 @@ class PhysicsSystem : public System {
   void TryCreateTriggerVolume(Entity entity);
 
   void OnDestroy(Entity entity) override;
+  void OnCollisions(absl::Span<const PhysicsEngine::CollisionPair> entered,
+                    absl::Span<const PhysicsEngine::CollisionPair> exited);
   void OnCollisionEnter(Entity entity_a, Entity entity_b);
   void OnCollisionExit(Entity entity_a, Entity entity_b);
 
@@ -37,6 +37,8 @@ void RenderSystem::OnRegistryInitialize() {
   engine_ = registry_->Get<RenderEngine>();
   CHECK(engine_);
 
+  transform_flag_ = registry_->Get<TransformSystem>()->RequestChangeFlag();
+
   auto choreo = registry_->Get<Choreographer>();
   choreo->Add<&RenderSystem::PrepareToRender>(Choreographer::Stage::kRender)
       .Before<&RenderEngine::Render>();
@@ -81,8 +83,19 @@ void RenderSystem::PrepareToRender() {
   auto rig_system = registry_->Get<RigSystem>();
   auto transform_system = registry_->Get<TransformSystem>();
 
-  static int counter = 0;
-  ++counter;
+  // Only push the transforms that changed since the last frame, and push them
+  // all in a single batch.
+  engine_->BeginTransformBatch();
+  for (auto& iter : renderables_) {
+    if (iter.second.needs_transform ||
+        transform_system->HasFlag(iter.first, transform_flag_)) {
+      const mat4 matrix = transform_system->GetWorldTransformMatrix(iter.first);
+      iter.second.renderable->SetTransform(matrix);
+      transform_system->ClearFlag(iter.first, transform_flag_);
+      iter.second.needs_transform = false;
+    }
+  }
+  engine_->CommitTransformBatch();
 
   for (const auto& iter : renderables_) {
     const auto& shader_indices = iter.second.shader_indices;
@@ -98,9 +111,7 @@ void RenderSystem::PrepareToRender() {
                                           {bytes, num_bytes});
     }
 
-    const Transform transform = transform_system->GetTransform(iter.first);
-    const mat4 matrix = TransformMatrix(transform);
-    iter.second.renderable->PrepareToRender(matrix);
+    iter.second.renderable->PrepareToRender();
   }
 }
 
@@ -108,6 +119,9 @@ void RenderSystem::SetFromRenderDef(Entity entity, const RenderDef& def) {
   if (!def.shading_model.empty()) {
     SetShadingModel(entity, def.shading_model);
   }
+  if (def.max_instances > 0) {
+    SetMaxInstances(entity, static_cast<std::size_t>(def.max_instances));
+  }
 }
 
 void RenderSystem::OnDestroy(Entity entity) { renderables_.erase(entity); }
@@ -228,6 +242,18 @@ void RenderSystem::SetInverseBindPose(Entity entity,
                                                 pose.data() + pose.size());
 }
 
+void RenderSystem::SetMaxInstances(Entity entity, std::size_t max_instances) {
+  GetRenderable(entity).SetMaxInstances(max_instances);
+}
+
+void RenderSystem::SetInstanceTransforms(Entity entity,
+                                         absl::Span<const mat4> transforms) {
+  Renderable* r = TryGetRenderable(entity);
+  if (r) {
+    r->SetInstanceTransforms(transforms);
+  }
+}
+
 void RenderSystem::SetBoneShaderIndices(Entity entity,
                                         absl::Span<const uint16_t> indices) {
   renderables_[entity].shader_indices.assign(indices.data(),
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "redux/engines/render/render_engine.h"
 #include "redux/engines/render/render_target_factory.h"
+#include "redux/modules/base/bits.h"
 #include "redux/modules/base/hash.h"
 #include "redux/modules/ecs/system.h"
 #include "redux/modules/math/math.h"
@@ -135,6 +136,15 @@ class RenderSystem : public System {
   // the matrices to be passed to the shader to be smaller.
   void SetBoneShaderIndices(Entity entity, absl::Span<const uint16_t> indices);
 
+  // Draws the Entity's mesh up to `max_instances` times in a single draw call
+  // using GPU instancing, sharing the mesh and materials between all instances.
+  // Zero disables instancing.
+  void SetMaxInstances(Entity entity, std::size_t max_instances);
+
+  // Sets the transforms of the Entity's instances from a packed array, relative
+  // to the Entity's own transform. Requires SetMaxInstances.
+  void SetInstanceTransforms(Entity entity, absl::Span<const mat4> transforms);
+
   // Sets arbitrary data on the material of the entity. The name and type of
   // data for the materials is defined by the ShadingModel assigned to the
   // entity.
@@ -188,6 +198,9 @@ class RenderSystem : public System {
     std::vector<uint16_t> shader_indices;
 
     RenderablePtr renderable;
+
+    // True if the renderable has not yet been given its transform.
+    bool needs_transform = true;
   };
 
   void OnDestroy(Entity entity) override;
@@ -201,6 +214,7 @@ class RenderSystem : public System {
 
   RenderEngine* engine_ = nullptr;
   absl::flat_hash_map<Entity, RenderableComponent> renderables_;
+  Bits32 transform_flag_ = Bits32(0);
 };
 
 template <typename T>
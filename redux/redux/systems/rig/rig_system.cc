@@ -31,6 +31,7 @@ void RigSystem::SetSkeleton(Entity entity,
   CHECK_GT(num_bones, 0);
   CHECK_EQ(bones.size(), hierarchy.size());
 
+  ++skeleton_version_;
   Rig& rig = rigs_[entity];
   // Clear out all the data in case we're reassigning a new skeleton.
   rig.bones.clear();
@@ -57,7 +58,11 @@ void RigSystem::SetSkeleton(Entity entity,
   }
 }
 
-void RigSystem::OnDestroy(Entity entity) { rigs_.erase(entity); }
+void RigSystem::OnDestroy(Entity entity) {
+  if (rigs_.erase(entity) > 0) {
+    ++skeleton_version_;
+  }
+}
 
 void RigSystem::UpdatePose(Entity entity, absl::Span<const mat4> pose) {
   if (auto iter = rigs_.find(entity); iter != rigs_.end()) {
@@ -67,6 +72,42 @@ void RigSystem::UpdatePose(Entity entity, absl::Span<const mat4> pose) {
   }
 }
 
+void RigSystem::UpdatePose(Entity entity, absl::Span<const mat4> pose,
+                           absl::Span<const BoneIndex> retarget) {
+  CHECK_EQ(pose.size(), retarget.size()) << "Pose/retarget size mismatch";
+  if (auto iter = rigs_.find(entity); iter != rigs_.end()) {
+    std::vector<mat4>& rig_pose = iter->second.pose;
+    for (std::size_t i = 0; i < pose.size(); ++i) {
+      const BoneIndex index = retarget[i];
+      if (index < rig_pose.size()) {
+        rig_pose[index] = pose[i];
+      }
+    }
+  }
+}
+
+bool RigSystem::BuildRetargetTable(Entity entity,
+                                   absl::Span<const HashValue> bones,
+                                   std::vector<BoneIndex>* retarget) const {
+  retarget->assign(bones.size(), kInvalidBoneIndex);
+
+  auto iter = rigs_.find(entity);
+  if (iter == rigs_.end()) {
+    return true;
+  }
+
+  const Rig& rig = iter->second;
+  bool identity = bones.size() == rig.bones.size();
+  for (std::size_t i = 0; i < bones.size(); ++i) {
+    if (auto bone_iter = rig.bone_map.find(bones[i]);
+        bone_iter != rig.bone_map.end()) {
+      (*retarget)[i] = bone_iter->second;
+    }
+    identity = identity && (*retarget)[i] == i;
+  }
+  return !identity;
+}
+
 absl::Span<const mat4> RigSystem::GetPose(Entity entity) const {
   if (auto iter = rigs_.find(entity); iter != rigs_.end()) {
     return iter->second.pose;
@@ -86,4 +127,27 @@ mat4 RigSystem::GetBonePose(Entity entity, HashValue bone) const {
   return mat4::Identity();
 }
 
+mat4 RigSystem::GetBonePose(Entity entity, BoneIndex bone) const {
+  if (bone != kInvalidBoneIndex) {
+    if (auto iter = rigs_.find(entity); iter != rigs_.end()) {
+      const std::vector<mat4>& pose = iter->second.pose;
+      if (bone < pose.size()) {
+        return pose[bone];
+      }
+    }
+  }
+  return mat4::Identity();
+}
+
+RigSystem::BoneIndex RigSystem::GetBoneIndex(Entity entity,
+                                             HashValue bone) const {
+  if (auto iter = rigs_.find(entity); iter != rigs_.end()) {
+    auto& bone_map = iter->second.bone_map;
+    if (auto bone_iter = bone_map.find(bone); bone_iter != bone_map.end()) {
+      return bone_iter->second;
+    }
+  }
+  return kInvalidBoneIndex;
+}
+
 }  // namespace redux
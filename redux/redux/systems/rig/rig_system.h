@@ -51,12 +51,40 @@ class RigSystem : public System {
   // Sets the current pose for the Entity.
   void UpdatePose(Entity entity, absl::Span<const mat4> pose);
 
+  // Sets the current pose for the Entity from a pose whose bones are in a
+  // different order than the Entity's skeleton (eg. an animation clip).
+  // `retarget[i]` is the index in the skeleton of the i-th bone of `pose`, or
+  // kInvalidBoneIndex to ignore it. Skeleton bones with no matching bone in
+  // `pose` keep their previous transform. See BuildRetargetTable.
+  void UpdatePose(Entity entity, absl::Span<const mat4> pose,
+                  absl::Span<const BoneIndex> retarget);
+
+  // Fills `retarget` with the index in the Entity's skeleton of each of the
+  // given bones, for use with UpdatePose. Returns false if the table is an
+  // identity mapping (ie. the bones match the skeleton exactly), in which case
+  // the pose can be passed to UpdatePose without a retarget table.
+  bool BuildRetargetTable(Entity entity, absl::Span<const HashValue> bones,
+                          std::vector<BoneIndex>* retarget) const;
+
   // Returns the current pose of the Entity, or an empty span if no pose.
   absl::Span<const mat4> GetPose(Entity entity) const;
 
   // Returns the transform of the given bone of the Entity.
   mat4 GetBonePose(Entity entity, HashValue bone) const;
 
+  // As above, but with the index of the bone in the Entity's skeleton (see
+  // GetBoneIndex). Returns the identity if the index is invalid.
+  mat4 GetBonePose(Entity entity, BoneIndex bone) const;
+
+  // Returns the index of the given bone in the Entity's skeleton, or
+  // kInvalidBoneIndex if the Entity has no such bone. The index remains valid
+  // until GetSkeletonVersion changes.
+  BoneIndex GetBoneIndex(Entity entity, HashValue bone) const;
+
+  // Returns a counter that changes whenever any skeleton is set or removed,
+  // which invalidates all previously returned BoneIndex values.
+  std::uint32_t GetSkeletonVersion() const { return skeleton_version_; }
+
  private:
   void OnDestroy(Entity entity) override;
 
@@ -68,6 +96,7 @@ class RigSystem : public System {
   };
 
   absl::flat_hash_map<Entity, Rig> rigs_;
+  std::uint32_t skeleton_version_ = 0;
 };
 
 }  // namespace redux
@@ -0,0 +1,108 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/systems/rig/rig_system.h"
+
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/math/transform.h"
+
+namespace redux {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+using BoneIndex = RigSystem::BoneIndex;
+constexpr BoneIndex kInvalid = RigSystem::kInvalidBoneIndex;
+
+const std::string_view kBones[] = {"root", "spine", "head"};
+const BoneIndex kHierarchy[] = {kInvalid, 0, 1};
+
+mat4 Translation(const vec3& position) {
+  return TransformMatrix(position, quat::Identity(), vec3::One());
+}
+
+class RigSystemTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    rig_system_ = registry_.Create<RigSystem>(&registry_);
+    registry_.Initialize();
+    rig_system_->SetSkeleton(entity_, kBones, kHierarchy);
+  }
+
+  Registry registry_;
+  RigSystem* rig_system_;
+  const Entity entity_ = Entity(123);
+};
+
+TEST_F(RigSystemTest, GetBoneIndex) {
+  EXPECT_THAT(rig_system_->GetBoneIndex(entity_, Hash("spine")), Eq(1));
+  EXPECT_THAT(rig_system_->GetBoneIndex(entity_, Hash("tail")), Eq(kInvalid));
+  EXPECT_THAT(rig_system_->GetBoneIndex(Entity(456), Hash("spine")),
+              Eq(kInvalid));
+}
+
+TEST_F(RigSystemTest, SkeletonVersion) {
+  const auto version = rig_system_->GetSkeletonVersion();
+  rig_system_->SetSkeleton(Entity(456), kBones, kHierarchy);
+  EXPECT_THAT(rig_system_->GetSkeletonVersion(), Eq(version + 1));
+}
+
+TEST_F(RigSystemTest, IdentityRetargetTable) {
+  const HashValue bones[] = {Hash("root"), Hash("spine"), Hash("head")};
+  std::vector<BoneIndex> retarget;
+  EXPECT_FALSE(rig_system_->BuildRetargetTable(entity_, bones, &retarget));
+  EXPECT_THAT(retarget, ElementsAre(0, 1, 2));
+}
+
+TEST_F(RigSystemTest, RetargetTable) {
+  const HashValue bones[] = {Hash("head"), Hash("tail"), Hash("root")};
+  std::vector<BoneIndex> retarget;
+  EXPECT_TRUE(rig_system_->BuildRetargetTable(entity_, bones, &retarget));
+  EXPECT_THAT(retarget, ElementsAre(2, kInvalid, 0));
+
+  // A prefix of the skeleton still needs a table, since the clip does not
+  // cover every bone.
+  const HashValue prefix[] = {Hash("root"), Hash("spine")};
+  EXPECT_TRUE(rig_system_->BuildRetargetTable(entity_, prefix, &retarget));
+  EXPECT_THAT(retarget, ElementsAre(0, 1));
+}
+
+TEST_F(RigSystemTest, RetargetTableWithoutSkeleton) {
+  const HashValue bones[] = {Hash("root"), Hash("spine")};
+  std::vector<BoneIndex> retarget;
+  EXPECT_TRUE(rig_system_->BuildRetargetTable(Entity(456), bones, &retarget));
+  EXPECT_THAT(retarget, ElementsAre(kInvalid, kInvalid));
+}
+
+TEST_F(RigSystemTest, UpdatePoseWithRetargetTable) {
+  const mat4 head = Translation(vec3(0, 2, 0));
+  const mat4 tail = Translation(vec3(0, 0, -1));
+  const mat4 root = Translation(vec3(1, 0, 0));
+  const mat4 pose[] = {head, tail, root};
+  const BoneIndex retarget[] = {2, kInvalid, 0};
+  rig_system_->UpdatePose(entity_, pose, retarget);
+
+  EXPECT_THAT(rig_system_->GetPose(entity_),
+              ElementsAre(root, mat4::Identity(), head));
+}
+
+}  // namespace
+}  // namespace redux
@@ -0,0 +1,114 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/systems/text/text_batcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "redux/modules/base/data_builder.h"
+#include "redux/modules/base/logging.h"
+
+namespace redux {
+
+void TextBatcher::Add(const Key& key, Entity entity, const MeshData& mesh,
+                      const mat4& transform, int sort_order) {
+  if (mesh.GetNumVertices() == 0) {
+    return;
+  }
+
+  const VertexAttribute* position =
+      mesh.GetVertexFormat().GetAttributeWithUsage(VertexUsage::Position);
+  CHECK(position && position->type == VertexType::Vec3f)
+      << "Batched text requires Vec3f positions.";
+  CHECK_EQ(mesh.GetNumIndices(), 0) << "Batched text must not be indexed.";
+
+  Entry entry;
+  entry.entity = entity;
+  entry.mesh = &mesh;
+  entry.transform = transform;
+  entry.sort_order = sort_order;
+  batches_[key].push_back(entry);
+}
+
+void TextBatcher::Build(const BuildFn& fn) const {
+  for (const auto& iter : batches_) {
+    std::vector<const Entry*> entries;
+    entries.reserve(iter.second.size());
+    for (const Entry& entry : iter.second) {
+      entries.push_back(&entry);
+    }
+    fn(iter.first, Merge(std::move(entries)));
+  }
+}
+
+void TextBatcher::Clear() { batches_.clear(); }
+
+MeshData TextBatcher::Merge(std::vector<const Entry*> entries) {
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry* lhs, const Entry* rhs) {
+              if (lhs->sort_order != rhs->sort_order) {
+                return lhs->sort_order < rhs->sort_order;
+              }
+              return lhs->entity < rhs->entity;
+            });
+
+  const VertexFormat& format = entries.front()->mesh->GetVertexFormat();
+  const size_t vertex_size = format.GetVertexSize();
+  const size_t position_offset = format.GetAttributeOffset(
+      format.GetAttributeWithUsage(VertexUsage::Position));
+
+  size_t num_vertices = 0;
+  for (const Entry* entry : entries) {
+    CHECK(entry->mesh->GetVertexFormat() == format)
+        << "All text in a batch must have the same vertex format.";
+    num_vertices += entry->mesh->GetNumVertices();
+  }
+
+  DataBuilder vertices(num_vertices * vertex_size);
+  Box bounds = Box::Empty();
+  for (const Entry* entry : entries) {
+    const absl::Span<const std::byte> src = entry->mesh->GetVertexData();
+    std::byte* dst = vertices.GetAppendPtr(src.size());
+    std::memcpy(dst, src.data(), src.size());
+
+    // Replace the local position of each vertex with its world position.
+    for (size_t offset = position_offset; offset < src.size();
+         offset += vertex_size) {
+      vec3 position;
+      std::memcpy(&position.x, dst + offset, sizeof(float) * 3);
+      position = entry->transform * position;
+      std::memcpy(dst + offset, &position.x, sizeof(float) * 3);
+      bounds = bounds.Included(position);
+    }
+  }
+
+  MeshData::PartData part;
+  part.primitive_type = MeshPrimitiveType::Triangles;
+  part.start = 0;
+  part.end = static_cast<uint32_t>(num_vertices);
+  part.box = bounds;
+  DataBuilder parts(sizeof(MeshData::PartData));
+  parts.Append(part);
+
+  MeshData mesh;
+  mesh.SetVertexData(format, vertices.Release(), bounds);
+  mesh.SetParts(parts.Release());
+  return mesh;
+}
+
+}  // namespace redux
@@ -0,0 +1,90 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_SYSTEMS_TEXT_TEXT_BATCHER_H_
+#define REDUX_SYSTEMS_TEXT_TEXT_BATCHER_H_
+
+#include <functional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "redux/modules/base/hash.h"
+#include "redux/modules/ecs/entity.h"
+#include "redux/modules/graphics/mesh_data.h"
+#include "redux/modules/math/matrix.h"
+
+namespace redux {
+
+// Merges the meshes of text Entities that can be drawn with the same glyph
+// texture and material into a single mesh per batch.
+//
+// The world transform of each Entity is baked into the positions of its
+// vertices (the color of the text is already stored in the vertices). Within a
+// batch, meshes are emitted in ascending sort order, with ties broken by
+// Entity, so that overlapping text is drawn in a stable order.
+class TextBatcher {
+ public:
+  // Text can only be merged if it samples the same atlas page of the same font
+  // with the same SDF parameters (which are derived from the font size).
+  struct Key {
+    HashValue font;
+    size_t page = 0;
+    float font_size = 0.f;
+
+    friend bool operator==(const Key& lhs, const Key& rhs) {
+      return lhs.font == rhs.font && lhs.page == rhs.page &&
+             lhs.font_size == rhs.font_size;
+    }
+    friend bool operator!=(const Key& lhs, const Key& rhs) {
+      return !(lhs == rhs);
+    }
+
+    template <typename H>
+    friend H AbslHashValue(H h, const Key& key) {
+      return H::combine(std::move(h), key.font, key.page, key.font_size);
+    }
+  };
+
+  using BuildFn = std::function<void(const Key& key, MeshData mesh)>;
+
+  // Adds the `mesh` of the `entity` to the batch for `key`. The mesh must be
+  // made of (non-indexed) triangles with a Vec3f position attribute, and must
+  // remain valid until Build is called.
+  void Add(const Key& key, Entity entity, const MeshData& mesh,
+           const mat4& transform, int sort_order = 0);
+
+  // Merges the meshes of each batch and passes the result to `fn`.
+  void Build(const BuildFn& fn) const;
+
+  // Removes all the meshes that have been added.
+  void Clear();
+
+ private:
+  struct Entry {
+    Entity entity;
+    const MeshData* mesh = nullptr;
+    mat4 transform;
+    int sort_order = 0;
+  };
+
+  static MeshData Merge(std::vector<const Entry*> entries);
+
+  absl::flat_hash_map<Key, std::vector<Entry>> batches_;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_SYSTEMS_TEXT_TEXT_BATCHER_H_
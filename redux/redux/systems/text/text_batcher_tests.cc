@@ -0,0 +1,138 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/systems/text/text_batcher.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/base/data_builder.h"
+#include "redux/modules/math/transform.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::FloatEq;
+
+const VertexFormat kFormat({
+    {VertexUsage::Position, VertexType::Vec3f},
+    {VertexUsage::Color0, VertexType::Vec4f},
+    {VertexUsage::TexCoord0, VertexType::Vec2f},
+});
+
+struct Vertex {
+  float x, y, z;
+  float r, g, b, a;
+  float u, v;
+};
+
+// Creates a mesh with a single triangle whose first vertex is at `pos` and
+// whose texture coordinates are all `uv`.
+MeshData MakeTriangle(const vec3& pos, float uv) {
+  DataBuilder vertices(3 * sizeof(Vertex));
+  vertices.Append(Vertex{pos.x, pos.y, pos.z, 1, 1, 1, 1, uv, uv});
+  vertices.Append(Vertex{pos.x + 1, pos.y, pos.z, 1, 1, 1, 1, uv, uv});
+  vertices.Append(Vertex{pos.x, pos.y + 1, pos.z, 1, 1, 1, 1, uv, uv});
+
+  MeshData mesh;
+  mesh.SetVertexData(kFormat, vertices.Release(), Box::Empty());
+  return mesh;
+}
+
+const Vertex* GetVertices(const MeshData& mesh) {
+  return reinterpret_cast<const Vertex*>(mesh.GetVertexData().data());
+}
+
+TEST(TextBatcherTest, MergesMeshesWithSameKey) {
+  const TextBatcher::Key key1{HashValue(1), 0, 12.f};
+  const TextBatcher::Key key2{HashValue(1), 1, 12.f};
+  const MeshData a = MakeTriangle(vec3::Zero(), 0.1f);
+  const MeshData b = MakeTriangle(vec3::Zero(), 0.2f);
+  const MeshData c = MakeTriangle(vec3::Zero(), 0.3f);
+
+  TextBatcher batcher;
+  batcher.Add(key1, Entity(1), a, mat4::Identity());
+  batcher.Add(key1, Entity(2), b, mat4::Identity());
+  batcher.Add(key2, Entity(3), c, mat4::Identity());
+
+  int num_batches = 0;
+  batcher.Build([&](const TextBatcher::Key& key, MeshData mesh) {
+    ++num_batches;
+    if (key == key1) {
+      EXPECT_THAT(mesh.GetNumVertices(), Eq(6));
+    } else {
+      EXPECT_THAT(key, Eq(key2));
+      EXPECT_THAT(mesh.GetNumVertices(), Eq(3));
+    }
+    ASSERT_THAT(mesh.GetPartData().size(), Eq(1));
+    EXPECT_THAT(mesh.GetPartData()[0].end, Eq(mesh.GetNumVertices()));
+  });
+  EXPECT_THAT(num_batches, Eq(2));
+
+  batcher.Clear();
+  num_batches = 0;
+  batcher.Build([&](const TextBatcher::Key&, MeshData) { ++num_batches; });
+  EXPECT_THAT(num_batches, Eq(0));
+}
+
+TEST(TextBatcherTest, AppliesTransforms) {
+  const TextBatcher::Key key{HashValue(1), 0, 12.f};
+  const MeshData mesh = MakeTriangle(vec3(1.f, 2.f, 0.f), 0.5f);
+
+  Transform transform;
+  transform.translation = vec3(10.f, 20.f, 30.f);
+  transform.scale = vec3(2.f, 2.f, 2.f);
+
+  TextBatcher batcher;
+  batcher.Add(key, Entity(1), mesh, TransformMatrix(transform));
+  batcher.Build([&](const TextBatcher::Key&, MeshData merged) {
+    const Vertex* vertices = GetVertices(merged);
+    EXPECT_THAT(vertices[0].x, FloatEq(12.f));
+    EXPECT_THAT(vertices[0].y, FloatEq(24.f));
+    EXPECT_THAT(vertices[0].z, FloatEq(30.f));
+    EXPECT_THAT(vertices[1].x, FloatEq(14.f));
+    EXPECT_THAT(vertices[2].y, FloatEq(26.f));
+    // Other attributes are copied as-is.
+    EXPECT_THAT(vertices[0].u, FloatEq(0.5f));
+    EXPECT_THAT(vertices[0].a, FloatEq(1.f));
+
+    const Box bounds = merged.GetBoundingBox();
+    EXPECT_THAT(bounds.min.x, FloatEq(12.f));
+    EXPECT_THAT(bounds.max.x, FloatEq(14.f));
+    EXPECT_THAT(bounds.max.y, FloatEq(26.f));
+  });
+}
+
+TEST(TextBatcherTest, OrdersBySortOrderThenEntity) {
+  const TextBatcher::Key key{HashValue(1), 0, 12.f};
+  const MeshData a = MakeTriangle(vec3::Zero(), 0.1f);
+  const MeshData b = MakeTriangle(vec3::Zero(), 0.2f);
+  const MeshData c = MakeTriangle(vec3::Zero(), 0.3f);
+
+  TextBatcher batcher;
+  batcher.Add(key, Entity(3), a, mat4::Identity(), 1);
+  batcher.Add(key, Entity(2), b, mat4::Identity(), 0);
+  batcher.Add(key, Entity(1), c, mat4::Identity(), 1);
+  batcher.Build([&](const TextBatcher::Key&, MeshData merged) {
+    const Vertex* vertices = GetVertices(merged);
+    EXPECT_THAT(vertices[0].u, FloatEq(0.2f));
+    EXPECT_THAT(vertices[3].u, FloatEq(0.3f));
+    EXPECT_THAT(vertices[6].u, FloatEq(0.1f));
+  });
+}
+
+}  // namespace
+}  // namespace redux
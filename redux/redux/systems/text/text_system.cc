@@ -19,7 +19,9 @@ limitations under the License.
 #include "redux/engines/render/mesh_factory.h"
 #include "redux/engines/render/texture_factory.h"
 #include "redux/modules/base/choreographer.h"
+#include "redux/modules/ecs/entity_factory.h"
 #include "redux/systems/render/render_system.h"
+#include "redux/systems/transform/transform_system.h"
 
 namespace redux {
 
@@ -35,6 +37,9 @@ TextSystem::TextSystem(Registry* registry) : System(registry) {
 void TextSystem::OnRegistryInitialize() {
   engine_ = registry_->Get<TextEngine>();
   CHECK(engine_);
+  // Glyphs are uploaded to the GPU as they become ready, so there's no need to
+  // wait for them when generating the text meshes.
+  engine_->SetAsyncGlyphRasterization(true);
 }
 
 void TextSystem::SetFromTextDef(Entity entity, const TextDef& def) {
@@ -49,19 +54,116 @@ void TextSystem::SetFromTextDef(Entity entity, const TextDef& def) {
   c.params.wrap = def.wrap;
   c.params.text_direction = def.text_direction;
   c.params.language_iso_639 = def.language_iso_639;
+  c.params.color = def.color;
+  c.batched = def.batched;
+  c.sort_order = def.sort_order;
   dirty_set_.emplace(entity);
 }
 
 void TextSystem::OnDestroy(Entity entity) {
+  auto iter = components_.find(entity);
+  if (iter != components_.end() && iter->second.batch_key) {
+    dirty_batches_.emplace(*iter->second.batch_key);
+  }
   dirty_set_.erase(entity);
   components_.erase(entity);
 }
 
 void TextSystem::PrepareToRender() {
+  // Text whose glyphs were evicted from the font's atlas needs to be generated
+  // again.
+  for (const auto& iter : components_) {
+    const TextComponent& c = iter.second;
+    const FontPtr& font = c.params.font;
+    if (font == nullptr || c.glyph_page >= font->GetNumGlyphPages()) {
+      continue;
+    }
+    if (font->GetGlyphPageGeneration(c.glyph_page) != c.glyph_page_generation) {
+      dirty_set_.emplace(iter.first);
+    }
+  }
+
   for (Entity entity : dirty_set_) {
     GenerateText(entity);
   }
   dirty_set_.clear();
+
+  UploadGlyphPages();
+  UpdateBatches();
+}
+
+void TextSystem::UpdateBatches() {
+  auto* transform_system = registry_->Get<TransformSystem>();
+
+  // Find the batches whose contents have changed since they were last merged.
+  for (auto& iter : components_) {
+    TextComponent& c = iter.second;
+    if (!c.batched) {
+      continue;
+    }
+
+    std::optional<TextBatcher::Key> key;
+    if (!c.hidden && c.mesh.GetNumVertices() > 0) {
+      key = TextBatcher::Key{c.params.font->GetName(), c.glyph_page,
+                             c.params.font_size};
+    }
+    const mat4 transform =
+        transform_system ? transform_system->GetWorldTransformMatrix(iter.first)
+                         : mat4::Identity();
+
+    if (key != c.batch_key) {
+      if (c.batch_key) {
+        dirty_batches_.emplace(*c.batch_key);
+      }
+      c.batch_key = key;
+      c.mesh_changed = true;
+    }
+    if (key && (c.mesh_changed || transform != c.batch_transform)) {
+      dirty_batches_.emplace(*key);
+    }
+    c.batch_transform = transform;
+    c.mesh_changed = false;
+  }
+
+  if (dirty_batches_.empty()) {
+    return;
+  }
+
+  TextBatcher batcher;
+  for (const auto& iter : components_) {
+    const TextComponent& c = iter.second;
+    if (c.batch_key && dirty_batches_.contains(*c.batch_key)) {
+      batcher.Add(*c.batch_key, iter.first, c.mesh, c.batch_transform,
+                  c.sort_order);
+    }
+  }
+
+  auto* render_system = registry_->Get<RenderSystem>();
+  batcher.Build([&](const TextBatcher::Key& key, MeshData mesh) {
+    dirty_batches_.erase(key);
+
+    Entity& entity = batch_entities_[key];
+    const bool created = (entity == kNullEntity);
+    if (created) {
+      entity = registry_->Get<EntityFactory>()->Create();
+    }
+    render_system->SetMesh(entity, std::move(mesh));
+    if (created) {
+      const FontTexture& font_texture = font_textures_[key.font];
+      SetTextMaterial(entity, GetTexture(font_texture.font, key.page),
+                      key.font_size);
+    }
+    render_system->Show(entity);
+  });
+
+  // Any remaining batches no longer have any visible text.
+  for (const TextBatcher::Key& key : dirty_batches_) {
+    auto iter = batch_entities_.find(key);
+    if (iter != batch_entities_.end()) {
+      render_system->Hide(iter->second);
+    }
+  }
+  dirty_batches_.clear();
 }
 
 void TextSystem::SetFont(Entity entity, FontPtr font) {
@@ -85,25 +187,46 @@ void TextSystem::SetText(Entity entity, const std::string& text) {
   }
 }
 
-TexturePtr TextSystem::GetTexture(const FontPtr& font) {
-  FontTexture& iter = font_textures_[font->GetName()];
-  TexturePtr& texture = iter.texture;
+TexturePtr TextSystem::GetTexture(const FontPtr& font, size_t page) {
+  FontTexture& font_texture = font_textures_[font->GetName()];
+  font_texture.font = font;
+  if (font_texture.pages.size() <= page) {
+    font_texture.pages.resize(page + 1);
+  }
+  TexturePtr& texture = font_texture.pages[page];
 
-  const ImageAtlaser& atlas = font->GetGlyphAtlas();
+  const ImageAtlaser& atlas = font->GetGlyphAtlas(page);
   if (texture == nullptr || texture->GetDimensions() != atlas.GetSize()) {
     if (atlas.GetSize().x > 0 && atlas.GetSize().y > 0) {
       auto texture_factory = registry_->Get<TextureFactory>();
       texture = texture_factory->CreateTexture(
           atlas.GetSize(), ImageFormat::Alpha8, TextureParams());
+      // The entire contents of the new texture need to be uploaded.
+      texture->Update(atlas.GetImageData());
+      font->ClearGlyphPageDirtyRegion(page);
     }
   }
+  return texture;
+}
 
-  if (iter.texture_generation_id != atlas.GetNumSubimages()) {
-    texture->Update(atlas.GetImageData());
-    iter.texture_generation_id = atlas.GetNumSubimages();
+void TextSystem::UploadGlyphPages() {
+  // Only the regions of the atlases into which glyphs have been rasterized
+  // since the last upload are sent to the GPU, once per frame.
+  for (auto& iter : font_textures_) {
+    FontTexture& font_texture = iter.second;
+    font_texture.font->ProcessPendingGlyphs();
+    for (size_t page = 0; page < font_texture.pages.size(); ++page) {
+      const TexturePtr& texture = font_texture.pages[page];
+      const ImageAtlaser& atlas = font_texture.font->GetGlyphAtlas(page);
+      if (texture == nullptr || !atlas.IsDirty()) {
+        continue;
+      }
+      for (const Bounds2i& rect : atlas.GetDirtyRects()) {
+        texture->UpdateRegion(rect.min, atlas.GetImageData(rect));
+      }
+      font_texture.font->ClearGlyphPageDirtyRegion(page);
+    }
   }
-
-  return texture;
 }
 
 static inline vec4 CalculateSdfParams(float font_size,
@@ -130,24 +253,104 @@ void TextSystem::GenerateText(Entity entity) {
   const TextParams& params = iter->second.params;
   CHECK(params.font);
 
-  MeshData mesh_data = engine_->GenerateTextMesh(iter->second.text, params);
+  size_t glyph_page = 0;
+  MeshData mesh_data =
+      engine_->GenerateTextMesh(iter->second.text, params, &glyph_page);
+  iter->second.glyph_page = glyph_page;
+  iter->second.glyph_page_generation =
+      params.font->GetGlyphPageGeneration(glyph_page);
+
+  TexturePtr texture = GetTexture(params.font, glyph_page);
+
+  // Batched text is merged with the rest of its batch in UpdateBatches.
+  if (iter->second.batched) {
+    iter->second.mesh = std::move(mesh_data);
+    iter->second.mesh_changed = true;
+    return;
+  }
+
   auto* mesh_factory = registry_->Get<MeshFactory>();
   MeshPtr mesh = mesh_factory->CreateMesh(std::move(mesh_data));
-  TexturePtr texture = GetTexture(params.font);
 
   auto* render_system = registry_->Get<RenderSystem>();
   render_system->SetMesh(entity, mesh);
+  SetTextMaterial(entity, texture, params.font_size);
+  if (iter->second.hidden) {
+    render_system->Hide(entity);
+  }
+}
+
+void TextSystem::SetTextMaterial(Entity entity, const TexturePtr& texture,
+                                 float font_size) {
+  auto* render_system = registry_->Get<RenderSystem>();
   render_system->SetTexture(entity, {MaterialTextureType::Glyph}, texture);
   render_system->SetShadingModel(entity, "text");
   if (texture) {
     render_system->EnableShadingFeature(entity, ConstHash("SDF_TEXT"));
 
-    const vec4 sdf_params = CalculateSdfParams(params.font_size);
+    const vec4 sdf_params = CalculateSdfParams(font_size);
     render_system->SetMaterialProperty(entity, ConstHash("SdfParams"),
                                        sdf_params);
   }
 }
 
+void TextSystem::SetColor(Entity entity, const vec4& color) {
+  auto iter = components_.find(entity);
+  if (iter != components_.end()) {
+    iter->second.params.color = color;
+    dirty_set_.emplace(entity);
+  }
+}
+
+void TextSystem::SetBatched(Entity entity, bool batched) {
+  auto iter = components_.find(entity);
+  if (iter == components_.end() || iter->second.batched == batched) {
+    return;
+  }
+
+  TextComponent& c = iter->second;
+  c.batched = batched;
+  auto* render_system = registry_->Get<RenderSystem>();
+  if (batched) {
+    // The Entity's own mesh is replaced by its batch.
+    render_system->Hide(entity);
+  } else {
+    c.mesh = MeshData();
+    if (!c.hidden) {
+      render_system->Show(entity);
+    }
+  }
+  dirty_set_.emplace(entity);
+}
+
+void TextSystem::SetSortOrder(Entity entity, int sort_order) {
+  auto iter = components_.find(entity);
+  if (iter != components_.end() && iter->second.sort_order != sort_order) {
+    iter->second.sort_order = sort_order;
+    iter->second.mesh_changed = true;
+  }
+}
+
+void TextSystem::Hide(Entity entity) {
+  auto iter = components_.find(entity);
+  if (iter != components_.end()) {
+    iter->second.hidden = true;
+    if (!iter->second.batched) {
+      registry_->Get<RenderSystem>()->Hide(entity);
+    }
+  }
+}
+
+void TextSystem::Show(Entity entity) {
+  auto iter = components_.find(entity);
+  if (iter != components_.end()) {
+    iter->second.hidden = false;
+    if (!iter->second.batched) {
+      registry_->Get<RenderSystem>()->Show(entity);
+    }
+  }
+}
+
 void TextSystem::SetFontSize(Entity entity, float size) {
   auto iter = components_.find(entity);
   if (iter != components_.end()) {
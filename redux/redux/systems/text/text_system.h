@@ -17,10 +17,14 @@ limitations under the License.
 #ifndef REDUX_SYSTEMS_TEXT_TEXT_SYSTEM_H_
 #define REDUX_SYSTEMS_TEXT_TEXT_SYSTEM_H_
 
+#include <optional>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "redux/engines/render/texture.h"
 #include "redux/engines/text/text_engine.h"
 #include "redux/modules/ecs/system.h"
+#include "redux/systems/text/text_batcher.h"
 #include "redux/systems/text/text_def_generated.h"
 
 namespace redux {
@@ -64,36 +68,73 @@ class TextSystem : public System {
   // Sets the direction in which the text will be displayed.
   void SetTextDirection(Entity entity, TextDirection direction);
 
+  // Sets the color of the text.
+  void SetColor(Entity entity, const vec4& color);
+
+  // Sets whether the text is drawn as part of a shared mesh. All batched text
+  // that uses the same font atlas page and font size is merged into a single
+  // mesh (and draw call) with the world transform of each Entity baked into its
+  // vertices. Batched text is drawn in the default scene.
+  void SetBatched(Entity entity, bool batched);
+
+  // Sets the order in which batched text is drawn within its batch. Text with
+  // a lower sort order is drawn first.
+  void SetSortOrder(Entity entity, int sort_order);
+
+  // Hides or shows the text, whether or not it is batched.
+  void Hide(Entity entity);
+  void Show(Entity entity);
+
   // Updates the RenderSystem with the text Entities' Meshes and Textures.
   // Note: this function is automatically bound to the Choreographer if it is
   // available.
   void PrepareToRender();
 
-  // Returns the underlying glyph texture associated with the font.
-  TexturePtr GetTexture(const FontPtr& font);
+  // Returns the underlying glyph texture associated with a page of the font.
+  // The contents of the texture are kept up-to-date by PrepareToRender.
+  TexturePtr GetTexture(const FontPtr& font, size_t page = 0);
 
  private:
   void SetFromTextDef(Entity entity, const TextDef& def);
   void OnDestroy(Entity entity) override;
   void GenerateText(Entity entity);
 
+  void UploadGlyphPages();
+  void UpdateBatches();
+  void SetTextMaterial(Entity entity, const TexturePtr& texture,
+                       float font_size);
+
   struct FontTexture {
-    TexturePtr texture;
-    // Tracks the number of glyphs in a texture. When new glyphs are added,
-    // we need to upload the texture to the GPU, effectively using a more
-    // "current" texture.
-    size_t texture_generation_id = 0;
+    FontPtr font;
+    // One texture per glyph atlas page of the font.
+    std::vector<TexturePtr> pages;
   };
 
   struct TextComponent {
     std::string text;
     TextParams params;
+    // The glyph atlas page (and its generation) used by the generated mesh.
+    size_t glyph_page = 0;
+    uint32_t glyph_page_generation = 0;
+    bool batched = false;
+    bool hidden = false;
+    int sort_order = 0;
+    // The (local space) mesh of batched text, and the batch and world transform
+    // with which it was last merged.
+    MeshData mesh;
+    bool mesh_changed = false;
+    std::optional<TextBatcher::Key> batch_key;
+    mat4 batch_transform = mat4::Identity();
   };
 
   TextEngine* engine_ = nullptr;
   absl::flat_hash_map<Entity, TextComponent> components_;
   absl::flat_hash_map<HashValue, FontTexture> font_textures_;
   absl::flat_hash_set<Entity> dirty_set_;
+  // The Entity that renders the merged mesh of each batch, and the batches that
+  // need to be merged again.
+  absl::flat_hash_map<TextBatcher::Key, Entity> batch_entities_;
+  absl::flat_hash_set<TextBatcher::Key> dirty_batches_;
 };
 
 }  // namespace redux
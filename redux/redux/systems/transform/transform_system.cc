@@ -16,6 +16,9 @@ limitations under the License.
 
 #include "redux/systems/transform/transform_system.h"
 
+#include <utility>
+#include <vector>
+
 namespace redux {
 
 static Box CalculateTransformedBox(const mat4& mat, const Box& box) {
@@ -48,6 +51,7 @@ TransformSystem::TransformSystem(Registry* registry)
 
 void TransformSystem::OnRegistryInitialize() {
   dirty_flag_ = RequestFlag();
+  change_flags_.Set(dirty_flag_);
   fns_.RegisterMemFn("rx.Transform.SetTranslation", this,
                      &TransformSystem::SetTranslation);
   fns_.RegisterMemFn("rx.Transform.SetRotation", this,
@@ -70,7 +74,7 @@ void TransformSystem::SetTranslation(Entity entity, const vec3& translation) {
   if (data) {
     CHECK(data.Get<kOwner>() == nullptr);
     data.Get<kTranslation>() = translation;
-    data.Get<kFlags>().Set(dirty_flag_);
+    data.Get<kFlags>().Set(change_flags_);
   }
 }
 
@@ -84,7 +88,7 @@ void TransformSystem::SetRotation(Entity entity, const quat& rotation) {
   if (data) {
     CHECK(data.Get<kOwner>() == nullptr);
     data.Get<kRotation>() = rotation;
-    data.Get<kFlags>().Set(dirty_flag_);
+    data.Get<kFlags>().Set(change_flags_);
   }
 }
 
@@ -98,7 +102,7 @@ void TransformSystem::SetScale(Entity entity, const vec3& scale) {
   if (data) {
     CHECK(data.Get<kOwner>() == nullptr);
     data.Get<kScale>() = scale;
-    data.Get<kFlags>().Set(dirty_flag_);
+    data.Get<kFlags>().Set(change_flags_);
   }
 }
 
@@ -135,7 +139,7 @@ void TransformSystem::SetTransform(Entity entity, const Transform& transform,
     data.Get<kTranslation>() = transform.translation;
     data.Get<kRotation>() = transform.rotation;
     data.Get<kScale>() = transform.scale;
-    data.Get<kFlags>().Set(dirty_flag_);
+    data.Get<kFlags>().Set(change_flags_);
   }
 }
 
@@ -159,7 +163,7 @@ void TransformSystem::SetBox(Entity entity, Box box) {
   auto data = transforms_.TryEmplace(entity);
   if (data) {
     data.Get<kLocalBoundingBox>() = box;
-    data.Get<kFlags>().Set(dirty_flag_);
+    data.Get<kFlags>().Set(change_flags_);
   }
 }
 
@@ -197,6 +201,41 @@ void TransformSystem::RemoveTransform(Entity entity) {
 
 void TransformSystem::OnDestroy(Entity entity) { RemoveTransform(entity); }
 
+void TransformSystem::OnReserve(std::size_t count) {
+  transforms_.Reserve(transforms_.Size() + count);
+}
+
+void TransformSystem::SaveSnapshot(SnapshotWriter& writer) const {
+  transforms_.WriteSnapshot(writer);
+}
+
+bool TransformSystem::LoadSnapshot(SnapshotReader& reader) {
+  // Owners are pointers to other Systems and are not valid across snapshots.
+  // Keep any locks taken by Systems that were restored before this one and
+  // leave the rest for their owners to re-acquire.
+  std::vector<std::pair<Entity, void*>> owners;
+  transforms_.ForEach<kEntity, kOwner>([&](Entity entity, void* owner) {
+    if (owner != nullptr) {
+      owners.emplace_back(entity, owner);
+    }
+  });
+
+  if (!transforms_.ReadSnapshot(reader)) {
+    return false;
+  }
+  transforms_.ForEach<kOwner>([](void*& owner) { owner = nullptr; });
+  // Every restored transform counts as a change.
+  transforms_.ForEach<kFlags>(
+      [this](Bits32& flags) { flags.Set(change_flags_); });
+  for (const auto& [entity, owner] : owners) {
+    auto data = transforms_.Find<kOwner>(entity);
+    if (data) {
+      data.Get<kOwner>() = owner;
+    }
+  }
+  return true;
+}
+
 TransformSystem::TransformFlags TransformSystem::RequestFlag() {
   constexpr int kNumBits = 8 * sizeof(TransformFlags);
   for (uint32_t i = 0; i < kNumBits; ++i) {
@@ -210,9 +249,16 @@ TransformSystem::TransformFlags TransformSystem::RequestFlag() {
   return TransformFlags::None();
 }
 
+TransformSystem::TransformFlags TransformSystem::RequestChangeFlag() {
+  const TransformFlags flag = RequestFlag();
+  change_flags_.Set(flag);
+  return flag;
+}
+
 void TransformSystem::ReleaseFlag(TransformFlags flag) {
   CHECK(flag != TransformFlags::None()) << "Cannot release invalid flag.";
   reserved_flags_ = ClearBits(reserved_flags_, flag.Value());
+  change_flags_.Clear(flag);
 }
 
 void TransformSystem::SetFlag(Entity entity, TransformFlags flag) {
@@ -100,6 +100,12 @@ class TransformSystem : public System {
   // spatial queries.
   TransformFlags RequestFlag();
 
+  // Reserves a flag that is set on an Entity's transform whenever it changes.
+  // The flag is never cleared by the TransformSystem itself, so the caller can
+  // find the transforms that changed since it last cleared the flag (using
+  // HasFlag and ClearFlag). Release it with ReleaseFlag.
+  TransformFlags RequestChangeFlag();
+
   // Releases a flag that had been previously requested.
   void ReleaseFlag(TransformFlags flag);
 
@@ -133,11 +139,15 @@ class TransformSystem : public System {
                 kLocalBoundingBox, kWorldBoundingBox, kOwner>;
 
   void OnDestroy(Entity entity) override;
+  void OnReserve(std::size_t count) override;
+  void SaveSnapshot(SnapshotWriter& writer) const override;
+  bool LoadSnapshot(SnapshotReader& reader) override;
   void UpdateRow(Transforms::Row& data) const;
 
   FunctionBinder fns_;
   mutable Transforms transforms_;
   Bits32 dirty_flag_ = Bits32(0);
+  Bits32 change_flags_ = Bits32(0);
   uint32_t reserved_flags_ = 0;
 };
 
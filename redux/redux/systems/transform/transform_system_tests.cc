@@ -137,6 +137,28 @@ TEST_F(TransformSystemTest, Flags) {
   EXPECT_THAT(transform_system_->HasFlag(entity, flag2), Eq(false));
 }
 
+TEST_F(TransformSystemTest, ChangeFlag) {
+  const Entity entity(123);
+  transform_system_->SetTransform(entity, Transform());
+
+  const auto flag = transform_system_->RequestChangeFlag();
+  EXPECT_THAT(transform_system_->HasFlag(entity, flag), Eq(false));
+
+  transform_system_->SetTranslation(entity, vec3(1.f, 2.f, 3.f));
+  EXPECT_THAT(transform_system_->HasFlag(entity, flag), Eq(true));
+
+  // Reading the transform does not clear the change flag.
+  transform_system_->GetWorldTransformMatrix(entity);
+  EXPECT_THAT(transform_system_->HasFlag(entity, flag), Eq(true));
+
+  transform_system_->ClearFlag(entity, flag);
+  EXPECT_THAT(transform_system_->HasFlag(entity, flag), Eq(false));
+
+  transform_system_->ReleaseFlag(flag);
+  transform_system_->SetScale(entity, vec3(2.f, 2.f, 2.f));
+  EXPECT_THAT(transform_system_->HasFlag(entity, flag), Eq(false));
+}
+
 TEST_F(TransformSystemTest, TooManyFlags) {
   for (int i = 0; i < 31; ++i) {
     transform_system_->RequestFlag();
@@ -16,10 +16,11 @@ limitations under the License.
 
 #include "redux/systems/tween/tween_system.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "redux/engines/animation/animation_engine.h"
-#include "redux/engines/animation/motivator/spline_motivator.h"
+#include "redux/engines/platform/frame_pacer.h"
 #include "redux/modules/base/choreographer.h"
 #include "redux/modules/math/interpolation.h"
 
@@ -103,18 +104,22 @@ static CompactSplinePtr BuildSpline(const vec3 (&nodes)[N]) {
 }
 
 TweenSystem::TweenSystem(Registry* registry) : System(registry) {
+  // Tweens are evaluated by the TweenSystem itself, but are updated after the
+  // AnimationEngine so that they can be combined with other animations.
   RegisterDependency<AnimationEngine>(this);
 }
 
 void TweenSystem::OnRegistryInitialize() {
-  engine_ = registry_->Get<AnimationEngine>();
-  splines_[kQuadraticEaseIn] = BuildSpline(kQuadraticEaseInData);
-  splines_[kQuadraticEaseOut] = BuildSpline(kQuadraticEaseOutData);
-  splines_[kQuadraticEaseInOut] = BuildSpline(kQuadraticEaseInOutData);
-  splines_[kCubicEaseIn] = BuildSpline(kCubicEaseInData);
-  splines_[kCubicEaseOut] = BuildSpline(kCubicEaseOutData);
-  splines_[kCubicEaseInOut] = BuildSpline(kCubicEaseInOutData);
-  splines_[kFastOutSlowIn] = BuildSpline(kFastOutSlowInData);
+  easings_[kQuadraticEaseIn] =
+      CreateEasing(*BuildSpline(kQuadraticEaseInData));
+  easings_[kQuadraticEaseOut] =
+      CreateEasing(*BuildSpline(kQuadraticEaseOutData));
+  easings_[kQuadraticEaseInOut] =
+      CreateEasing(*BuildSpline(kQuadraticEaseInOutData));
+  easings_[kCubicEaseIn] = CreateEasing(*BuildSpline(kCubicEaseInData));
+  easings_[kCubicEaseOut] = CreateEasing(*BuildSpline(kCubicEaseOutData));
+  easings_[kCubicEaseInOut] = CreateEasing(*BuildSpline(kCubicEaseInOutData));
+  easings_[kFastOutSlowIn] = CreateEasing(*BuildSpline(kFastOutSlowInData));
 
   auto choreo = registry_->Get<Choreographer>();
   if (choreo) {
@@ -123,25 +128,91 @@ void TweenSystem::OnRegistryInitialize() {
   }
 }
 
+TweenSystem::Easing TweenSystem::CreateEasing(const CompactSpline& spline) {
+  Easing easing;
+  for (CompactSplineIndex i = 0; i < spline.LastNodeIndex(); ++i) {
+    easing.start_xs.push_back(spline.NodeX(i));
+    easing.curves.emplace_back(spline.CreateCubicInit(i));
+  }
+  easing.end_x = spline.EndX();
+  easing.end_y = spline.EndY();
+  return easing;
+}
+
+float TweenSystem::Evaluate(const Easing& easing, float x) {
+  if (x >= easing.end_x) {
+    return easing.end_y;
+  }
+  // Our splines only have a handful of segments, so counting the segments
+  // that start before x is cheaper than a search, and doesn't branch.
+  std::size_t segment = 0;
+  for (std::size_t i = 1; i < easing.start_xs.size(); ++i) {
+    segment += x >= easing.start_xs[i] ? 1 : 0;
+  }
+  return easing.curves[segment].Evaluate(x - easing.start_xs[segment]);
+}
+
+bool TweenSystem::IsFinished(const Easing& easing, float x) {
+  // Measure the remaining time the same way as the SplineMotivator so that
+  // tweens finish on the same frame they used to.
+  const float remaining = std::max(easing.end_x - x, 0.f);
+  return absl::Milliseconds(remaining) == absl::ZeroDuration();
+}
+
+void TweenSystem::AdvanceBatch(const Easing& easing, float delta_x,
+                               TweenBatch* batch) {
+  const std::size_t count = batch->ids.size();
+  float* xs = batch->xs.data();
+  const float* rates = batch->rates.data();
+  float* ys = batch->ys.data();
+  for (std::size_t i = 0; i < count; ++i) {
+    xs[i] += delta_x * rates[i];
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    ys[i] = Evaluate(easing, xs[i]);
+  }
+}
+
+void TweenSystem::AddToBatch(TweenId tween_id, Tween* tween) {
+  TweenBatch& batch = batches_[tween->type];
+  tween->batch_index = batch.ids.size();
+  batch.ids.push_back(tween_id);
+  batch.xs.push_back(tween->x);
+  batch.rates.push_back(tween->rate);
+  batch.ys.push_back(Evaluate(easings_[tween->type], tween->x));
+}
+
+void TweenSystem::RemoveFromBatch(Tween* tween) {
+  TweenBatch& batch = batches_[tween->type];
+  const std::size_t index = tween->batch_index;
+  tween->x = batch.xs[index];
+  tween->batch_index = kNotInBatch;
+
+  // Move the last tween into the vacated slot.
+  const std::size_t last = batch.ids.size() - 1;
+  if (index != last) {
+    batch.ids[index] = batch.ids[last];
+    batch.xs[index] = batch.xs[last];
+    batch.rates[index] = batch.rates[last];
+    batch.ys[index] = batch.ys[last];
+    GetTween(batch.ids[index])->batch_index = index;
+  }
+  batch.ids.pop_back();
+  batch.xs.pop_back();
+  batch.rates.pop_back();
+  batch.ys.pop_back();
+}
+
 template <typename T>
 TweenSystem::TweenId TweenSystem::Start(GenericTweenParams<T> params) {
   CHECK(params.type != TweenType::kMaxNumTweenTypes);
-  const CompactSpline* spline = splines_[params.type].get();
 
   CHECK(params.duration > absl::ZeroDuration())
       << "Must specify a positive duration.";
-  // Our predefined splines are all 1ms in duration, so we need to slow-down or
-  // speed-up the playback to match the desired duration.
-  const float playback_rate = 1.f / absl::ToDoubleMilliseconds(params.duration);
 
   auto target_value = AsVec(params.target_value);
   using VecType = decltype(target_value);
 
-  VecType init_value(0.f);
-  if (params.init_value.has_value()) {
-    init_value = AsVec(params.init_value.value());
-  }
-
   const TweenId tween_id = ++next_tween_id_;
   Tween& tween = tweens_[tween_id];
   tween.type = params.type;
@@ -150,6 +221,11 @@ TweenSystem::TweenId TweenSystem::Start(GenericTweenParams<T> params) {
   tween.on_update_callback = std::move(params.on_update_callback);
   tween.on_completed_callback = std::move(params.on_completed_callback);
 
+  // Our predefined splines are all 1ms in duration, so we need to slow-down or
+  // speed-up the playback to match the desired duration.
+  tween.rate = 1.f / absl::ToDoubleMilliseconds(params.duration);
+  tween.x = 0.f;
+
   for (std::size_t i = 0; i < tween.dimensions; ++i) {
     float init_value = 0.f;
     if (params.init_value.has_value()) {
@@ -157,15 +233,11 @@ TweenSystem::TweenId TweenSystem::Start(GenericTweenParams<T> params) {
     }
     float target_value = AsVec(params.target_value)[i];
 
-    AnimationPlayback& playback = tween.playback_params[i];
-    playback.playback_rate = playback_rate;
-    playback.value_offset = init_value;
-    playback.value_scale = target_value - init_value;
-
+    tween.offset.data[i] = init_value;
+    tween.scale.data[i] = target_value - init_value;
     tween.value.data[i] = init_value;
-    tween.motivators[i] = engine_->AcquireMotivator<SplineMotivator>();
-    tween.motivators[i].SetSpline(*spline, playback);
   }
+  AddToBatch(tween_id, &tween);
   return tween_id;
 }
 
@@ -205,19 +277,13 @@ void TweenSystem::Pause(TweenId tween_id) {
   Tween* tween = GetTween(tween_id);
   if (tween == nullptr) {
     return;  // Invalid tween.
-  } else if (!tween->motivators[0].Valid()) {
+  } else if (tween->batch_index == kNotInBatch) {
     return;  // Already paused.
   }
 
-  // Our predefined splines all have a length of 1ms. We use that length in
-  // order to determine how far along we are in the current spline playback and
-  // use that value for when we want to resume the spline.
-  const absl::Duration spline_elapsed_time =
-      absl::Milliseconds(1) - tween->motivators[0].TimeRemaining();
-  for (std::size_t i = 0; i < tween->dimensions; ++i) {
-    tween->playback_params[i].start_time = spline_elapsed_time;
-    tween->motivators[i].Invalidate();
-  }
+  // The tween keeps its position along the spline so that it can resume from
+  // there.
+  RemoveFromBatch(tween);
 }
 
 void TweenSystem::Pause(Entity entity) {
@@ -234,15 +300,11 @@ void TweenSystem::Unpause(TweenId tween_id) {
     return;  // Invalild tween.
   } else if (tween->type == kMaxNumTweenTypes) {
     return;  // Already ended.
-  } else if (tween->motivators[0].Valid()) {
+  } else if (tween->batch_index != kNotInBatch) {
     return;  // Already paused.
   }
 
-  const CompactSpline* spline = splines_[tween->type].get();
-  for (std::size_t i = 0; i < tween->dimensions; ++i) {
-    tween->motivators[i] = engine_->AcquireMotivator<SplineMotivator>();
-    tween->motivators[i].SetSpline(*spline, tween->playback_params[i]);
-  }
+  AddToBatch(tween_id, tween);
 }
 
 void TweenSystem::Unpause(Entity entity) {
@@ -272,11 +334,11 @@ void TweenSystem::EndTween(TweenId tween_id, CompletionReason reason) {
   if (tween->on_completed_callback) {
     tween->on_completed_callback(reason);
   }
-  for (std::size_t i = 0; i < tween->dimensions; ++i) {
-    tween->motivators[i].Invalidate();
+  if (tween->batch_index != kNotInBatch) {
+    RemoveFromBatch(tween);
   }
 
-  // Just invalidating the motivator is not enough (as that is also what
+  // Just removing the tween from its batch is not enough (as that is also what
   // happens when a tween is paused), so also invalidate the tween type to
   // indicate that the tween has ended.
   tween->type = kMaxNumTweenTypes;
@@ -318,7 +380,7 @@ const TweenSystem::Tween* TweenSystem::GetTween(TweenId tween_id) const {
 
 bool TweenSystem::IsTweenPlaying(TweenId tween_id) const {
   const Tween* tween = GetTween(tween_id);
-  return tween ? tween->motivators[0].Valid() : false;
+  return tween ? tween->batch_index != kNotInBatch : false;
 }
 
 absl::Span<const float> TweenSystem::GetCurrentValue(TweenId tween_id) const {
@@ -329,21 +391,48 @@ absl::Span<const float> TweenSystem::GetCurrentValue(TweenId tween_id) const {
 void TweenSystem::PostAnimation(absl::Duration delta_time) {
   EraseCompletedTweens();
 
-  for (auto& [tween_id, tween] : tweens_) {
-    if (!tween.motivators[0].Valid()) {
-      continue;  // Tween paused.
+  // Advance all the tweens before invoking any callbacks, since callbacks may
+  // start, pause or stop tweens and so rearrange the batches.
+  const float delta_x =
+      static_cast<float>(absl::ToDoubleMilliseconds(delta_time));
+  updated_tweens_.clear();
+  for (int type = 0; type < kMaxNumTweenTypes; ++type) {
+    TweenBatch& batch = batches_[type];
+    AdvanceBatch(easings_[type], delta_x, &batch);
+    updated_tweens_.insert(updated_tweens_.end(), batch.ids.begin(),
+                           batch.ids.end());
+  }
+
+  if (!updated_tweens_.empty()) {
+    if (auto* frame_pacer = registry_->Get<FramePacer>()) {
+      frame_pacer->RequestFrame();
+    }
+  }
+
+  for (const TweenId tween_id : updated_tweens_) {
+    Tween* tween = GetTween(tween_id);
+    if (tween == nullptr || tween->batch_index == kNotInBatch) {
+      continue;  // Tween paused or stopped by an earlier callback.
     }
 
-    for (std::size_t i = 0; i < tween.dimensions; ++i) {
-      tween.value.data[i] = tween.motivators[i].Value();
+    const TweenBatch& batch = batches_[tween->type];
+    const float y = batch.ys[tween->batch_index];
+    const bool finished =
+        IsFinished(easings_[tween->type], batch.xs[tween->batch_index]);
+    for (std::size_t i = 0; i < tween->dimensions; ++i) {
+      tween->value.data[i] = tween->offset.data[i] + tween->scale.data[i] * y;
     }
 
-    if (tween.on_update_callback) {
-      tween.on_update_callback(tween.value.data);
+    if (tween->on_update_callback) {
+      tween->on_update_callback(tween->value.data);
     }
 
-    if (tween.motivators[0].TimeRemaining() == absl::ZeroDuration()) {
-      EndTween(tween_id, kCompleted);
+    if (finished) {
+      // The tween may have been stopped by its own callback.
+      tween = GetTween(tween_id);
+      if (tween != nullptr && tween->type != kMaxNumTweenTypes) {
+        EndTween(tween_id, kCompleted);
+      }
     }
   }
 }
@@ -18,12 +18,13 @@ limitations under the License.
 #define REDUX_SYSTEMS_TWEEN_TWEEN_SYSTEM_H_
 
 #include <functional>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
 #include "redux/engines/animation/animation_engine.h"
-#include "redux/engines/animation/motivator/spline_motivator.h"
 #include "redux/engines/animation/spline/compact_spline.h"
+#include "redux/engines/animation/spline/cubic_curve.h"
 #include "redux/engines/script/function_binder.h"
 #include "redux/modules/ecs/system.h"
 
@@ -31,7 +32,11 @@ namespace redux {
 
 // Interpolates values between two points over time using common algorithms.
 //
-// The TweenSystem using the animation engine to drive the values.
+// Every tweening algorithm is a normalized spline, so all the dimensions of a
+// tween share a single evaluation of it. Playing tweens are grouped by
+// algorithm into parallel arrays which are advanced and evaluated together
+// once per frame. The arrays are reused, so starting and finishing tweens does
+// not allocate once they have grown to fit.
 class TweenSystem : public System {
  public:
   using TweenId = uint32_t;
@@ -152,17 +157,44 @@ class TweenSystem : public System {
   // Internally, we do everything with a span of floats.
   using TweenParamsSpan = GenericTweenParams<absl::Span<const float>>;
 
+  static constexpr std::size_t kNotInBatch = ~std::size_t(0);
+
   struct Tween {
     vec4 value = vec4::Zero();
+    // The value is offset + scale * y, where y is the eased progress from 0
+    // to 1.
+    vec4 offset = vec4::Zero();
+    vec4 scale = vec4::Zero();
     Entity entity = kNullEntity;
     HashValue channel = HashValue(0);
     TweenType type = kQuadraticEaseInOut;
     std::size_t dimensions = 0;
     absl::Duration total_duration = absl::ZeroDuration();
+    // The rate at which the tween moves along its spline, and the position on
+    // the spline while the tween is paused.
+    float rate = 0.f;
+    float x = 0.f;
+    // The index of the tween in the TweenBatch for its type, or kNotInBatch if
+    // it is paused or has ended.
+    std::size_t batch_index = kNotInBatch;
     std::function<void(absl::Span<const float>)> on_update_callback;
     std::function<void(CompletionReason)> on_completed_callback;
-    AnimationPlayback playback_params[4];
-    SplineMotivator motivators[4];
+  };
+
+  // The segments of the spline for a tweening algorithm.
+  struct Easing {
+    std::vector<float> start_xs;
+    std::vector<CubicCurve> curves;
+    float end_x = 0.f;
+    float end_y = 0.f;
+  };
+
+  // The playing tweens of one TweenType, stored as parallel arrays.
+  struct TweenBatch {
+    std::vector<TweenId> ids;
+    std::vector<float> xs;
+    std::vector<float> rates;
+    std::vector<float> ys;
   };
 
   struct TweenComponent {
@@ -180,6 +212,15 @@ class TweenSystem : public System {
   void OnDisable(Entity entity) override;
   void OnDestroy(Entity entity) override;
 
+  static Easing CreateEasing(const CompactSpline& spline);
+  static float Evaluate(const Easing& easing, float x);
+  static bool IsFinished(const Easing& easing, float x);
+  static void AdvanceBatch(const Easing& easing, float delta_x,
+                           TweenBatch* batch);
+
+  void AddToBatch(TweenId tween_id, Tween* tween);
+  void RemoveFromBatch(Tween* tween);
+
   TweenId Start(TweenParamsSpan params);
   TweenId Start(Entity entity, HashValue channel, TweenParamsSpan params);
   void RemoveChannel(Entity entity, HashValue channel);
@@ -187,10 +228,11 @@ class TweenSystem : public System {
   void EndTween(TweenId tween_id, CompletionReason reason);
   void EraseCompletedTweens();
 
-  AnimationEngine* engine_ = nullptr;
   absl::flat_hash_map<TweenId, Tween> tweens_;
   absl::flat_hash_map<Entity, TweenComponent> tween_components_;
-  CompactSplinePtr splines_[kMaxNumTweenTypes];
+  Easing easings_[kMaxNumTweenTypes];
+  TweenBatch batches_[kMaxNumTweenTypes];
+  std::vector<TweenId> updated_tweens_;
   std::vector<TweenId> completed_tweens_;
   TweenId next_tween_id_ = 1;
 };
@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -483,5 +484,81 @@ TEST_F(TweenSystemTest, OnInterrupted) {
   EXPECT_THAT(result[0], Eq(0.0f));
 }
 
+TEST_F(TweenSystemTest, ManyTweensWithPause) {
+  static constexpr int kNumSteps = 10;
+  static constexpr int kNumTweens = 30;
+
+  std::vector<TweenSystem::TweenId> tween_ids;
+  for (int i = 0; i < kNumTweens; ++i) {
+    TweenSystem::TweenParams1f params;
+    params.init_value = 0.0f;
+    params.target_value = static_cast<float>(i + 1);
+    params.duration = absl::Seconds(1);
+    params.type = static_cast<TweenSystem::TweenType>(
+        i % TweenSystem::kMaxNumTweenTypes);
+    tween_ids.push_back(tween_system_->Start(params));
+  }
+
+  // Pausing tweens in the middle of a batch must not disturb the others.
+  const auto delta_time = absl::Seconds(1) / static_cast<float>(kNumSteps);
+  AdvanceFrame(delta_time);
+  tween_system_->Pause(tween_ids[0]);
+  tween_system_->Pause(tween_ids[kNumTweens / 2]);
+  const float paused_value0 = tween_system_->GetCurrentValue(tween_ids[0])[0];
+  const float paused_value1 =
+      tween_system_->GetCurrentValue(tween_ids[kNumTweens / 2])[0];
+  for (int i = 1; i < kNumSteps; ++i) {
+    AdvanceFrame(delta_time);
+  }
+
+  for (int i = 0; i < kNumTweens; ++i) {
+    const bool paused = i == 0 || i == kNumTweens / 2;
+    // Paused tweens are removed from their batch, so are not playing.
+    EXPECT_THAT(tween_system_->IsTweenPlaying(tween_ids[i]), Eq(false));
+    auto result = tween_system_->GetCurrentValue(tween_ids[i]);
+    if (paused) {
+      EXPECT_THAT(result[0], Eq(i == 0 ? paused_value0 : paused_value1));
+      EXPECT_THAT(result[0], Lt(static_cast<float>(i + 1)));
+    } else {
+      EXPECT_THAT(result[0], FloatEq(static_cast<float>(i + 1)));
+    }
+  }
+
+  tween_system_->Unpause(tween_ids[0]);
+  tween_system_->Unpause(tween_ids[kNumTweens / 2]);
+  for (int i = 1; i < kNumSteps; ++i) {
+    AdvanceFrame(delta_time);
+  }
+  EXPECT_THAT(tween_system_->GetCurrentValue(tween_ids[0])[0], FloatEq(1.0f));
+  EXPECT_THAT(tween_system_->GetCurrentValue(tween_ids[kNumTweens / 2])[0],
+              FloatEq(static_cast<float>(kNumTweens / 2 + 1)));
+}
+
+TEST_F(TweenSystemTest, StopFromCallback) {
+  static constexpr int kNumSteps = 10;
+
+  TweenSystem::TweenParams1f params;
+  params.init_value = 0.0f;
+  params.target_value = 1.0f;
+  params.duration = absl::Seconds(1);
+
+  int num_updates = 0;
+  TweenSystem::TweenId other_id = TweenSystem::kInvalidTweenId;
+  params.on_update_callback = [&](absl::Span<const float> data) {
+    tween_system_->Stop(other_id);
+  };
+  tween_system_->Start(params);
+
+  params.on_update_callback = [&](absl::Span<const float> data) {
+    ++num_updates;
+  };
+  other_id = tween_system_->Start(params);
+
+  const auto delta_time = params.duration / static_cast<float>(kNumSteps);
+  AdvanceFrame(delta_time);
+  EXPECT_FALSE(tween_system_->IsTweenPlaying(other_id));
+  EXPECT_THAT(num_updates, Eq(0));
+}
+
 }  // namespace
 }  // namespace redux
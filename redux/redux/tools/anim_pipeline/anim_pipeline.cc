@@ -53,7 +53,7 @@ DataContainer AnimPipeline::Build(std::string_view uri,
   if (!opts.stagger_end_times) {
     anim->ExtendChannelsToTime(anim->MaxAnimatedTimeMs());
   }
-  return ExportAnimation(anim, log_);
+  return ExportAnimation(anim, opts.pack_splines, log_);
 }
 
 }  // namespace redux::tool
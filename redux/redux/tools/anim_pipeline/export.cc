@@ -17,6 +17,7 @@ limitations under the License.
 #include "redux/tools/anim_pipeline/export.h"
 
 #include <limits>
+#include <vector>
 
 #include "redux/data/asset_defs/anim_asset_def_generated.h"
 #include "redux/engines/animation/spline/compact_spline.h"
@@ -32,14 +33,19 @@ static std::unique_ptr<fbs::HashStringT> MakeName(std::string_view name) {
   return std::make_unique<fbs::HashStringT>(CreateHashStringT(name));
 }
 
-static CompactSplinePtr CreateCompactSpline(AnimCurve::CurveSegment nodes) {
+// Creates a spline from `nodes`. If `x_granularity` is 0, the spline gets its
+// own time base.
+static CompactSplinePtr CreateCompactSpline(AnimCurve::CurveSegment nodes,
+                                            float x_granularity) {
   Interval y_range(Interval::Empty());
   for (const auto& n : nodes) {
     y_range = y_range.Included(n.value);
   }
 
-  const float x_granularity = CompactSpline::RecommendXGranularity(
-      static_cast<float>(nodes.back().time_ms));
+  if (x_granularity == 0.0f) {
+    x_granularity = CompactSpline::RecommendXGranularity(
+        static_cast<float>(nodes.back().time_ms));
+  }
 
   CompactSplinePtr spline = CompactSpline::Create(nodes.size());
   spline->Init(y_range, x_granularity);
@@ -59,29 +65,49 @@ static CompactSplinePtr CreateCompactSpline(AnimCurve::CurveSegment nodes) {
 }
 
 
+static void AppendNodes(const CompactSpline& spline,
+                        std::vector<AnimSplineNodeAssetDef>* out) {
+  const int num_nodes = spline.num_nodes();
+  out->reserve(out->size() + num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    const auto& node = spline.nodes()[i];
+    const auto x = node.x();
+    const auto y = node.y();
+    const auto angle = node.angle();
+    static_assert(sizeof(x) == sizeof(uint16_t));
+    static_assert(sizeof(y) == sizeof(uint16_t));
+    static_assert(sizeof(angle) == sizeof(uint16_t));
+    out->emplace_back(x, y, angle);
+  }
+}
+
 static std::unique_ptr<AnimChannelSplineAssetDefT> ExportSpline(
     const AnimCurve& curve) {
   // We generate the same compact spline as the runtime in order to extract
   // good values for export.
-  CompactSplinePtr spline = CreateCompactSpline(curve.Nodes());
+  CompactSplinePtr spline = CreateCompactSpline(curve.Nodes(), 0.0f);
 
   auto res = std::make_unique<AnimChannelSplineAssetDefT>();
   res->y_range_start = spline->y_range().min;
   res->y_range_end = spline->y_range().max;
   res->x_granularity = spline->x_granularity();
+  AppendNodes(*spline, &res->nodes);
+  return res;
+}
 
-  const int num_nodes = spline->num_nodes();
-  res->nodes.reserve(num_nodes);
-  for (int i = 0; i < num_nodes; ++i) {
-    const auto& node = spline->nodes()[i];
-    const auto x = node.x();
-    const auto y = node.y();
-    const auto angle = node.angle();
-    static_assert(sizeof(x) == sizeof(uint16_t));
-    static_assert(sizeof(y) == sizeof(uint16_t));
-    static_assert(sizeof(angle) == sizeof(uint16_t));
-    res->nodes.emplace_back(x, y, angle);
-  }
+// Exports the spline using the time base of `anim_def` and appends its nodes
+// to the node pool of `anim_def`.
+static std::unique_ptr<AnimChannelPackedSplineAssetDefT> ExportPackedSpline(
+    const AnimCurve& curve, AnimAssetDefT* anim_def) {
+  CompactSplinePtr spline =
+      CreateCompactSpline(curve.Nodes(), anim_def->x_granularity);
+
+  auto res = std::make_unique<AnimChannelPackedSplineAssetDefT>();
+  res->y_range_start = spline->y_range().min;
+  res->y_range_end = spline->y_range().max;
+  res->first_node = static_cast<uint32_t>(anim_def->spline_nodes.size());
+  res->num_nodes = static_cast<uint16_t>(spline->num_nodes());
+  AppendNodes(*spline, &anim_def->spline_nodes);
   return res;
 }
 
@@ -92,8 +118,10 @@ static std::unique_ptr<AnimChannelConstValueAssetDefT> ExportConstValue(
   return res;
 }
 
+// Exports the curves of `bone_anim`. If `anim_def` has a time base, splines
+// are packed into its node pool.
 static std::unique_ptr<BoneAnimAssetDefT> ExportBoneAnim(
-    const AnimBone& bone_anim) {
+    const AnimBone& bone_anim, AnimAssetDefT* anim_def) {
   auto bone_anim_def = std::make_unique<BoneAnimAssetDefT>();
   for (const AnimCurve& curve : bone_anim.curves) {
     auto op = std::make_unique<AnimChannelAssetDefT>();
@@ -106,6 +134,10 @@ static std::unique_ptr<BoneAnimAssetDefT> ExportBoneAnim(
       auto val = ExportConstValue(curve);
       op->data.type = AnimChannelDataAssetDef::AnimChannelConstValueAssetDef;
       op->data.value = val.release();
+    } else if (anim_def->x_granularity > 0.0f) {
+      auto spline = ExportPackedSpline(curve, anim_def);
+      op->data.type = AnimChannelDataAssetDef::AnimChannelPackedSplineAssetDef;
+      op->data.value = spline.release();
     } else {
       auto spline = ExportSpline(curve);
       op->data.type = AnimChannelDataAssetDef::AnimChannelSplineAssetDef;
@@ -118,6 +150,9 @@ static std::unique_ptr<BoneAnimAssetDefT> ExportBoneAnim(
 
 void LogResults(const AnimAssetDefT& out, Logger& log) {
   log("version: ", out.version);
+  if (out.x_granularity > 0.0f) {
+    log("packed spline nodes: ", out.spline_nodes.size());
+  }
 
   const size_t num_bones = out.bone_names.size();
   log("bones: ", num_bones);
@@ -136,6 +171,8 @@ void LogResults(const AnimAssetDefT& out, Logger& log) {
       const char* type_name = EnumNameAnimChannelType(channel->type);
       const auto* const_data = channel->data.AsAnimChannelConstValueAssetDef();
       const auto* spline_data = channel->data.AsAnimChannelSplineAssetDef();
+      const auto* packed_data =
+          channel->data.AsAnimChannelPackedSplineAssetDef();
 
       if (const_data) {
         const float value = const_data->value;
@@ -148,17 +185,32 @@ void LogResults(const AnimAssetDefT& out, Logger& log) {
               static_cast<float>(n.x()) * spline_data->x_granularity;
           log("      ", time, " ", n.y(), " ", n.angle());
         }
+      } else if (packed_data) {
+        const size_t num = packed_data->num_nodes;
+        log("    ", type_name, " packed spline ", num);
+        for (size_t j = 0; j < num; ++j) {
+          const auto& n = out.spline_nodes[packed_data->first_node + j];
+          const float time = static_cast<float>(n.x()) * out.x_granularity;
+          log("      ", time, " ", n.y(), " ", n.angle());
+        }
       }
     }
   }
 }
 
-DataContainer ExportAnimation(AnimationPtr anim, Logger& log) {
+DataContainer ExportAnimation(AnimationPtr anim, bool pack_splines,
+                              Logger& log) {
   AnimAssetDefT anim_def;
   anim_def.version = 1;
   anim_def.repeat = anim->Repeat();
   anim_def.length_in_seconds =
       (anim->MaxAnimatedTimeMs() - anim->MinAnimatedTimeMs()) * 1000.0f;
+  if (pack_splines) {
+    // A single time base for the whole rig. Every node time is at most the
+    // max animated time, so all nodes fit in the quantized x range.
+    anim_def.x_granularity =
+        CompactSpline::RecommendXGranularity(anim->MaxAnimatedTimeMs());
+  }
 
   const size_t num_bones = anim->NumBones();
   anim_def.bone_names.reserve(num_bones);
@@ -169,7 +221,7 @@ DataContainer ExportAnimation(AnimationPtr anim, Logger& log) {
     const AnimBone& bone_anim = anim->GetBone(i);
     anim_def.bone_names.emplace_back(MakeName(bone_anim.name));
     anim_def.bone_parents.emplace_back(bone_anim.parent_bone_index);
-    anim_def.bone_anims.emplace_back(ExportBoneAnim(bone_anim));
+    anim_def.bone_anims.emplace_back(ExportBoneAnim(bone_anim, &anim_def));
   }
 
   LogResults(anim_def, log);
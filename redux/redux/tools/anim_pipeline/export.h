@@ -24,8 +24,10 @@ limitations under the License.
 namespace redux::tool {
 
 // Generates a DataContainer storing an AnimAssetDef binary object from the
-// provided animation.
-DataContainer ExportAnimation(AnimationPtr anim, Logger& log);
+// provided animation. If `pack_splines` is true, the splines share a single
+// time base and node pool (see AnimChannelPackedSplineAssetDef).
+DataContainer ExportAnimation(AnimationPtr anim, bool pack_splines,
+                              Logger& log);
 
 }  // namespace redux::tool
 
@@ -0,0 +1,180 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/types/span.h"
+#include "redux/engines/animation/animation_clip.h"
+#include "redux/engines/animation/spline/compact_spline.h"
+#include "redux/tools/anim_pipeline/animation.h"
+#include "redux/tools/anim_pipeline/export.h"
+
+namespace redux::tool {
+namespace {
+
+using ::testing::Eq;
+using ::testing::FloatEq;
+using ::testing::FloatNear;
+using ::testing::NotNull;
+
+// The longest curve; its last node sits on the largest quantized x value.
+static const AnimCurve::Node kLongNodes[] = {
+    {0.0f, -2.0f},
+    {250.0f, 3.5f},
+    {1000.0f, 7.0f},
+};
+
+// A shorter curve whose extremes are in the middle, so that the y range
+// bounds are not tied to the first and last nodes.
+static const AnimCurve::Node kShortNodes[] = {
+    {0.0f, 0.125f},
+    {100.0f, -0.75f},
+    {400.0f, 0.25f},
+    {500.0f, 0.125f},
+};
+
+static void AddCurve(AnimBone& bone, AnimChannelType type,
+                     absl::Span<const AnimCurve::Node> nodes) {
+  AnimCurve curve(type, nodes.size());
+  for (const auto& n : nodes) {
+    curve.AddNode(n.time_ms, n.value);
+  }
+  bone.curves.push_back(std::move(curve));
+}
+
+static AnimationPtr CreateAnimation() {
+  auto anim = std::make_shared<Animation>(Tolerances());
+  const BoneIndex root = anim->RegisterBone("root");
+  const BoneIndex child = anim->RegisterBone("child", root);
+  AddCurve(anim->GetMutableBone(root), AnimChannelType::TranslateX,
+           kLongNodes);
+  AddCurve(anim->GetMutableBone(child), AnimChannelType::ScaleY, kShortNodes);
+  return anim;
+}
+
+static AnimationClip ExportAndLoad(bool pack_splines) {
+  Logger log;
+  return AnimationClip(ExportAnimation(CreateAnimation(), pack_splines, log));
+}
+
+static const CompactSpline* GetSpline(const AnimationClip& clip,
+                                      BoneIndex bone) {
+  const AnimationClip::BoneAnimation& anim = clip.GetBoneAnimation(bone);
+  EXPECT_THAT(anim.size(), Eq(1));
+  return anim.empty() ? nullptr : anim[0].spline.get();
+}
+
+// Checks that `spline` reproduces `nodes` to within a single quantization
+// step in x and y.
+static void ExpectMatchesNodes(const CompactSpline& spline,
+                               absl::Span<const AnimCurve::Node> nodes) {
+  ASSERT_THAT(spline.num_nodes(), Eq(nodes.size()));
+
+  const float x_step = spline.x_granularity();
+  const float y_step =
+      spline.IntervalY().Size() /
+      static_cast<float>(std::numeric_limits<CompactSplineYRung>::max());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const auto index = static_cast<CompactSplineIndex>(i);
+    EXPECT_THAT(spline.NodeX(index), FloatNear(nodes[i].time_ms, x_step));
+    EXPECT_THAT(spline.NodeY(index), FloatNear(nodes[i].value, y_step));
+    EXPECT_THAT(spline.YCalculatedSlowly(nodes[i].time_ms),
+                FloatNear(nodes[i].value, y_step));
+  }
+}
+
+TEST(ExportTests, UnpackedRoundTrip) {
+  const AnimationClip clip = ExportAndLoad(false);
+  ASSERT_THAT(clip.NumBones(), Eq(2));
+
+  const CompactSpline* long_spline = GetSpline(clip, 0);
+  const CompactSpline* short_spline = GetSpline(clip, 1);
+  ASSERT_THAT(long_spline, NotNull());
+  ASSERT_THAT(short_spline, NotNull());
+  ExpectMatchesNodes(*long_spline, kLongNodes);
+  ExpectMatchesNodes(*short_spline, kShortNodes);
+}
+
+TEST(ExportTests, PackedRoundTrip) {
+  const AnimationClip clip = ExportAndLoad(true);
+  ASSERT_THAT(clip.NumBones(), Eq(2));
+
+  const CompactSpline* long_spline = GetSpline(clip, 0);
+  const CompactSpline* short_spline = GetSpline(clip, 1);
+  ASSERT_THAT(long_spline, NotNull());
+  ASSERT_THAT(short_spline, NotNull());
+
+  // Packed splines share the time base of the longest curve.
+  EXPECT_THAT(short_spline->x_granularity(),
+              FloatEq(long_spline->x_granularity()));
+  ExpectMatchesNodes(*long_spline, kLongNodes);
+  ExpectMatchesNodes(*short_spline, kShortNodes);
+}
+
+TEST(ExportTests, PackedQuantizationBounds) {
+  const AnimationClip clip = ExportAndLoad(true);
+  const CompactSpline* long_spline = GetSpline(clip, 0);
+  const CompactSpline* short_spline = GetSpline(clip, 1);
+  ASSERT_THAT(long_spline, NotNull());
+  ASSERT_THAT(short_spline, NotNull());
+
+  // The end of the longest curve lands on the last quantized x value and must
+  // not wrap around.
+  const auto max_x = detail::CompactSplineNode::MaxX();
+  EXPECT_THAT(long_spline->nodes()[2].x(), Eq(max_x));
+  EXPECT_THAT(long_spline->EndX(), FloatEq(1000.0f));
+
+  // The extremes of each curve land on the first and last y rungs, so they
+  // are reproduced exactly.
+  const auto max_y = std::numeric_limits<CompactSplineYRung>::max();
+  EXPECT_THAT(long_spline->nodes()[0].y(), Eq(0));
+  EXPECT_THAT(long_spline->nodes()[2].y(), Eq(max_y));
+  EXPECT_THAT(long_spline->NodeY(0), FloatEq(-2.0f));
+  EXPECT_THAT(long_spline->NodeY(2), FloatEq(7.0f));
+
+  EXPECT_THAT(short_spline->nodes()[1].y(), Eq(0));
+  EXPECT_THAT(short_spline->nodes()[2].y(), Eq(max_y));
+  EXPECT_THAT(short_spline->NodeY(1), FloatEq(-0.75f));
+  EXPECT_THAT(short_spline->NodeY(2), FloatEq(0.25f));
+}
+
+TEST(ExportTests, PackedMatchesUnpacked) {
+  const AnimationClip packed = ExportAndLoad(true);
+  const AnimationClip unpacked = ExportAndLoad(false);
+
+  for (BoneIndex bone = 0; bone < 2; ++bone) {
+    const CompactSpline* a = GetSpline(packed, bone);
+    const CompactSpline* b = GetSpline(unpacked, bone);
+    ASSERT_THAT(a, NotNull());
+    ASSERT_THAT(b, NotNull());
+
+    // The packed time base is coarser for the short curve, so allow a
+    // little drift between the two encodings.
+    const float tolerance = 0.001f * a->IntervalY().Size();
+    const float end_x = b->EndX();
+    for (float x = 0.0f; x <= end_x; x += end_x / 64.0f) {
+      EXPECT_THAT(a->YCalculatedSlowly(x),
+                  FloatNear(b->YCalculatedSlowly(x), tolerance));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace redux::tool
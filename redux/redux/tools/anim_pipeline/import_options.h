@@ -30,6 +30,11 @@ struct ImportOptions {
   // If true, allow each channel to end at a different time.
   bool stagger_end_times = false;
 
+  // If true, export splines with a single time base for the whole rig and
+  // store all their nodes in one array, which makes clips smaller and faster
+  // to load.
+  bool pack_splines = false;
+
   // Amount the output curves are allowed to deviate from the input curves to
   // assist animation compression.
   Tolerances tolerances;
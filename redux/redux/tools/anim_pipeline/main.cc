@@ -53,6 +53,8 @@ ABSL_FLAG(bool, preserve_start_time, false,
           "Allow animations to start at a non-zero time.");
 ABSL_FLAG(bool, stagger_end_times, false,
           "Allow each channel to end at a different time");
+ABSL_FLAG(bool, pack_splines, false,
+          "Export splines with a shared time base and node array.");
 
 namespace redux::tool {
 
@@ -85,6 +87,7 @@ static int RunAnimPipeline() {
     opts.scale_multiplier = absl::GetFlag(FLAGS_scale_multiplier);
     opts.preserve_start_time = absl::GetFlag(FLAGS_preserve_start_time);
     opts.stagger_end_times = absl::GetFlag(FLAGS_stagger_end_times);
+    opts.pack_splines = absl::GetFlag(FLAGS_pack_splines);
     opts.tolerances.translate = absl::GetFlag(FLAGS_translation_tolerance);
     opts.tolerances.quaternion = absl::GetFlag(FLAGS_quaternion_tolerance);
     opts.tolerances.scale = absl::GetFlag(FLAGS_scale_tolerance);
@@ -0,0 +1,49 @@
+"""Generates an rxfont (redux font) file from a font file."""
+
+def build_font(
+        name,
+        src,
+        out,
+        characters = "",
+        characters_file = None,
+        atlas_size = 512,
+        visibility = ["//visibility:public"]):
+    """Bakes the glyphs of a font into an rxfont usable as a data dependency.
+
+    Args:
+      name: string, desired filegroup target name.
+      src: input font file (eg. ttf).
+      out: string, output filename.
+      characters: string, the characters whose glyphs are baked.
+      characters_file: optional file containing additional characters to bake.
+      atlas_size: int, the width and height of the glyph atlas.
+      visibility: the visiblity argument for the filegroup
+    """
+    font_pipeline = "//redux/tools/font_pipeline"
+
+    srcs = [src]
+    argv = [
+        "$(location %s)" % font_pipeline,
+        "--src $(location %s)" % src,
+        "--out $(location %s)" % out,
+        "--characters '%s'" % characters.replace("'", "'\\''"),
+        "--atlas_size %d" % atlas_size,
+    ]
+    if characters_file:
+        srcs.append(characters_file)
+        argv.append("--characters_file $(location %s)" % characters_file)
+
+    native.genrule(
+        name = "%s_genrule" % (name),
+        srcs = srcs,
+        outs = [out],
+        tools = [font_pipeline],
+        cmd = " ".join(argv),
+        message = "Calling font_pipeline for target %s" % name,
+    )
+
+    native.filegroup(
+        name = name,
+        srcs = [out],
+        visibility = visibility,
+    )
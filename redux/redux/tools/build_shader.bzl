@@ -5,6 +5,7 @@ def build_shader(
         src,
         out,
         include_deps = [],
+        feature_sets = None,
         strip_prefix = "",
         visibility = ["//visibility:public"]):
     """Generates a redux shader and returns a Fileset usable as a data dependency.
@@ -15,6 +16,10 @@ def build_shader(
       out: string, output filename.
       include_deps: optional array of possibly included header files. These will
                     be made available on the machine executing the genrule.
+      feature_sets: optional jsonnet file listing the shading feature
+                    combinations used by the application. Variants that none
+                    of them can select are pruned and the rest are created
+                    when the shader is loaded.
       strip_prefix: optional string, will be stripped from all input file paths
                     in output file generation. All subdirectories after
                     strip_prefix will be retained.
@@ -33,12 +38,17 @@ def build_shader(
         "$@",
     ]
 
+    srcs = [src] + include_deps + fbs_schema_includes
+    if feature_sets:
+        argv.append("--feature_sets $(location %s)" % feature_sets)
+        srcs.append(feature_sets)
+
     if strip_prefix:
         out = out.split(strip_prefix + "/")[-1]
 
     native.genrule(
         name = "%s_genrule" % (name),
-        srcs = [src] + include_deps + fbs_schema_includes,
+        srcs = srcs,
         outs = [out],
         tools = [shader_pipeline],
         cmd = " ".join(argv),
@@ -0,0 +1,75 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/tools/font_pipeline/font_pipeline.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "redux/data/asset_defs/font_asset_def_generated.h"
+#include "redux/modules/base/logging.h"
+#include "redux/tools/common/flatbuffer_utils.h"
+
+namespace redux::tool {
+
+static fbs::Recti ToFbs(const Bounds2i& bounds) {
+  const vec2i size = bounds.Size();
+  return fbs::Recti(bounds.min.x, bounds.min.y, size.x, size.y);
+}
+
+DataContainer BuildFontAsset(const DataContainer& font_data,
+                             const FontAssetOptions& options) {
+  // Rasterize all the glyphs onto a single page, synchronously.
+  Font font(Hash("font_pipeline"), font_data.Clone(), options.atlas_size, 1);
+  GlyphSequence sequence = font.ShapeGlyphSequence(
+      options.characters, options.language_iso_639,
+      TextDirection::kLanguageDefault);
+  font.PrepareGlyphSequence(&sequence, options.rasterization_size);
+
+  std::vector<TextGlyphId> ids;
+  for (const GlyphSequence::Element& element : sequence.elements) {
+    if (element.id != 0) {
+      ids.push_back(element.id);
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+  const std::vector<Font::BakedGlyph> glyphs = font.GetBakedGlyphs();
+  CHECK_EQ(glyphs.size(), ids.size())
+      << "Unable to fit all the glyphs into an atlas of size "
+      << options.atlas_size.x << "x" << options.atlas_size.y;
+
+  FontAssetDefT def;
+  const auto* bytes = reinterpret_cast<const uint8_t*>(font_data.GetBytes());
+  def.font_data.assign(bytes, bytes + font_data.GetNumBytes());
+  def.rasterization_size = options.rasterization_size;
+  def.atlas_size =
+      std::make_unique<fbs::Vec2i>(options.atlas_size.x, options.atlas_size.y);
+
+  const ImageData atlas = font.GetGlyphAtlas().GetImageData();
+  const auto* pixels = reinterpret_cast<const uint8_t*>(atlas.GetData());
+  def.atlas.assign(pixels, pixels + atlas.GetNumBytes());
+
+  for (const Font::BakedGlyph& glyph : glyphs) {
+    def.glyphs.emplace_back(glyph.id, fbs::Vec2i(glyph.size.x, glyph.size.y),
+                            ToFbs(glyph.bitmap_bounds),
+                            ToFbs(glyph.atlas_bounds), glyph.advance);
+  }
+  return BuildFlatbuffer(def);
+}
+
+}  // namespace redux::tool
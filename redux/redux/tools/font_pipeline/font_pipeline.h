@@ -0,0 +1,52 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_TOOLS_FONT_PIPELINE_FONT_PIPELINE_H_
+#define REDUX_TOOLS_FONT_PIPELINE_FONT_PIPELINE_H_
+
+#include <string>
+
+#include "redux/engines/text/font.h"
+#include "redux/modules/base/data_container.h"
+#include "redux/modules/math/vector.h"
+
+namespace redux::tool {
+
+struct FontAssetOptions {
+  // The (utf8) characters whose glyphs are baked into the atlas.
+  std::string characters;
+
+  // The language used to shape the characters.
+  std::string language_iso_639;
+
+  // The dimensions of the glyph atlas. This is also the size of every glyph
+  // page the runtime creates for the font.
+  vec2i atlas_size = vec2i(Font::kDefaultGlyphPageSize);
+
+  // The size (in pixels) at which the glyphs are rasterized. Must match the
+  // size used by the TextEngine for the baked glyphs to be used.
+  float rasterization_size = 48.f;
+};
+
+// Rasterizes the glyphs of the `options.characters` from the `font_data` (eg.
+// a ttf file) into a signed distance field atlas, and returns an rxfont binary
+// containing the font data, the atlas and the metrics of the baked glyphs.
+DataContainer BuildFontAsset(const DataContainer& font_data,
+                             const FontAssetOptions& options);
+
+}  // namespace redux::tool
+
+#endif  // REDUX_TOOLS_FONT_PIPELINE_FONT_PIPELINE_H_
@@ -0,0 +1,69 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "redux/modules/base/logging.h"
+#include "redux/tools/common/file_utils.h"
+#include "redux/tools/font_pipeline/font_pipeline.h"
+
+ABSL_FLAG(std::string, src, "", "Input font file (eg. ttf).");
+ABSL_FLAG(std::string, out, "", "Location of file to be saved.");
+ABSL_FLAG(std::string, characters, "",
+          "The characters whose glyphs are baked into the atlas.");
+ABSL_FLAG(std::string, characters_file, "",
+          "A (utf8) file containing additional characters to bake.");
+ABSL_FLAG(std::string, language, "", "Language used to shape the characters.");
+ABSL_FLAG(int, atlas_size, redux::Font::kDefaultGlyphPageSize,
+          "Width and height of the glyph atlas.");
+
+namespace redux::tool {
+namespace {
+
+int RunFontPipeline() {
+  const std::string src = absl::GetFlag(FLAGS_src);
+  CHECK(!src.empty()) << "Must specify input file.";
+
+  const std::string out_file = absl::GetFlag(FLAGS_out);
+  CHECK(!out_file.empty()) << "Must specify output file.";
+
+  absl::StatusOr<DataContainer> font_data = LoadFile(src.c_str());
+  CHECK(font_data.ok()) << "Could not open input file: " << src;
+
+  FontAssetOptions options;
+  options.characters = absl::GetFlag(FLAGS_characters);
+  const std::string characters_file = absl::GetFlag(FLAGS_characters_file);
+  if (!characters_file.empty()) {
+    options.characters += LoadFileAsString(characters_file.c_str());
+  }
+  options.language_iso_639 = absl::GetFlag(FLAGS_language);
+  options.atlas_size = vec2i(absl::GetFlag(FLAGS_atlas_size));
+
+  DataContainer data = BuildFontAsset(*font_data, options);
+  CHECK(SaveFile(data.GetBytes(), data.GetNumBytes(), out_file.c_str(), true))
+      << "Failed to save to file: " << out_file;
+  return 0;
+}
+
+}  // namespace
+}  // namespace redux::tool
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  return redux::tool::RunFontPipeline();
+}
@@ -18,10 +18,13 @@ limitations under the License.
 
 #include "redux/data/asset_defs/model_asset_def_generated.h"
 #include "redux/data/asset_defs/texture_asset_def_generated.h"
+#include "redux/engines/physics/bullet/bullet_bvh.h"
+#include "redux/engines/physics/collision_data.h"
 #include "redux/modules/flatbuffers/common.h"
 #include "redux/modules/graphics/color.h"
 #include "redux/tools/common/flatbuffer_utils.h"
 #include "redux/tools/common/log_utils.h"
+#include "redux/tools/model_pipeline/mesh_optimizer.h"
 #include "redux/tools/model_pipeline/util.h"
 
 namespace redux::tool {
@@ -51,53 +54,82 @@ static fbs::Mat3x4f MatrixToFbsMat4x3f(const mat4& in) {
 template <typename T = Vertex>
 class VertexBufferBuilder {
  public:
-  void ClearBuffer() { buffer_.clear(); }
-
   template <typename Fn>
   void AddOp(const Fn& fn) {
-    ops_.emplace_back([this, fn](const T& v) {
+    ops_.emplace_back([fn](const T& v, std::vector<uint8_t>* buffer) {
       const auto value = fn(v);
       const uint8_t* ptr = reinterpret_cast<const uint8_t*>(&value);
-      buffer_.insert(buffer_.end(), ptr, ptr + sizeof(value));
+      buffer->insert(buffer->end(), ptr, ptr + sizeof(value));
     });
   }
 
   template <typename Fn>
   void AddVec2Op(const Fn& fn) {
-    AddOp([&](const T& v) { return Vector<float, 2, false>(fn(v)); });
+    AddOp([fn](const T& v) { return Vector<float, 2, false>(fn(v)); });
   }
 
   template <typename Fn>
   void AddVec3Op(const Fn& fn) {
-    AddOp([&](const T& v) { return Vector<float, 3, false>(fn(v)); });
+    AddOp([fn](const T& v) { return Vector<float, 3, false>(fn(v)); });
   }
 
   template <typename Fn>
   void AddVec4Op(const Fn& fn) {
-    AddOp([&](const T& v) { return Vector<float, 4, false>(fn(v)); });
+    AddOp([fn](const T& v) { return Vector<float, 4, false>(fn(v)); });
   }
 
   template <typename Fn>
   void AddColorOp(const Fn& fn) {
-    AddOp([&](const T& v) { return Color4ub::FromVec4(fn(v)); });
-  }
+    AddOp([fn](const T& v) { return Color4ub::FromVec4(fn(v)); });
+  }
+
+  // Returns the interleaved buffer for |count| elements, where |get|(i) returns
+  // the i-th element. Blocks of elements are written concurrently into
+  // separate buffers which are then concatenated.
+  template <typename GetFn>
+  std::vector<uint8_t> Build(size_t count, const GetFn& get) const {
+    static constexpr size_t kMinElementsPerThread = 16 * 1024;
+    static constexpr size_t kMaxBlocks = 64;
+    const size_t block_size = std::max(
+        kMinElementsPerThread, (count + kMaxBlocks - 1) / kMaxBlocks);
+    const size_t num_blocks = (count + block_size - 1) / block_size;
+
+    std::vector<std::vector<uint8_t>> blocks(num_blocks);
+    ParallelFor(num_blocks, 1, [&](size_t begin, size_t end) {
+      for (size_t b = begin; b < end; ++b) {
+        const size_t first = b * block_size;
+        const size_t last = std::min(first + block_size, count);
+        for (size_t i = first; i < last; ++i) {
+          ApplyOps(get(i), &blocks[b]);
+        }
+      }
+    });
 
-  void ApplyOps(const T& vertex) {
-    for (Op& op : ops_) {
-      op(vertex);
+    if (blocks.size() == 1) {
+      return std::move(blocks[0]);
+    }
+    size_t total_size = 0;
+    for (const auto& block : blocks) {
+      total_size += block.size();
     }
-  }
-
-  std::vector<uint8_t> Release() {
     std::vector<uint8_t> out;
-    buffer_.swap(out);
+    out.reserve(total_size);
+    for (const auto& block : blocks) {
+      out.insert(out.end(), block.begin(), block.end());
+    }
     return out;
   }
 
  private:
-  using Op = std::function<void(const T&)>;
+  using Op = std::function<void(const T&, std::vector<uint8_t>*)>;
+
+  void ApplyOps(const T& value, std::vector<uint8_t>* buffer) const {
+    for (const Op& op : ops_) {
+      op(value, buffer);
+    }
+  }
+
   std::vector<Op> ops_;
-  std::vector<uint8_t> buffer_;
 };
 
 template <typename T>
@@ -108,6 +140,41 @@ static void AppendIndices(T* indices, const std::vector<size_t>& src) {
   }
 }
 
+static void ExportCollisionShape(const Model& model,
+                                 ModelCollisionShapeAssetDefT* out) {
+  const std::vector<Vertex>& vertices = model.GetVertices();
+  CHECK_GT(vertices.size(), 0);
+
+  // Collision shapes only need tightly-packed positions and 32-bit indices.
+  out->vertices = std::make_unique<ModelVertexBufferAssetDefT>();
+  out->vertices->vertex_format.emplace_back(VertexUsage::Position,
+                                            VertexType::Vec3f);
+  out->vertices->interleaved = true;
+  out->vertices->num_vertices = static_cast<uint32_t>(vertices.size());
+  out->vertices->data.resize(vertices.size() * 3 * sizeof(float));
+  float* positions = reinterpret_cast<float*>(out->vertices->data.data());
+  for (const Vertex& vertex : vertices) {
+    *positions++ = vertex.position.x;
+    *positions++ = vertex.position.y;
+    *positions++ = vertex.position.z;
+  }
+
+  out->indices = std::make_unique<ModelIndexBufferAssetDefT>();
+  for (const Drawable& drawable : model.GetDrawables()) {
+    AppendIndices(&out->indices->data32, drawable.indices);
+  }
+
+  // Bake the BVH so that it need not be built when the asset is loaded.
+  CollisionMesh mesh;
+  mesh.vertices = DataContainer::WrapData(out->vertices->data.data(),
+                                          out->vertices->data.size());
+  mesh.indices = DataContainer::WrapData(out->indices->data32.data(),
+                                         out->indices->data32.size());
+  const DataContainer bvh = BakeBvh(mesh);
+  const auto* bvh_bytes = reinterpret_cast<const uint8_t*>(bvh.GetBytes());
+  out->bullet_bvh.assign(bvh_bytes, bvh_bytes + bvh.GetNumBytes());
+}
+
 static void ExportSkeleton(const Model& model, ModelSkeletonAssetDefT* out) {
   const auto& bones = model.GetBones();
   out->bone_names.reserve(bones.size());
@@ -319,12 +386,9 @@ void ExportModelInstance(const Model& model, ModelInstanceAssetDefT* out) {
   // Build the vertex buffer data.
   out->vertices = std::make_unique<ModelVertexBufferAssetDefT>();
 
-  builder.ClearBuffer();
-  for (const Vertex& v : model.GetVertices()) {
-    builder.ApplyOps(v);
-  }
-
-  out->vertices->data = builder.Release();
+  const std::vector<Vertex>& vertices = model.GetVertices();
+  out->vertices->data = builder.Build(
+      num_vertices, [&](size_t i) -> const Vertex& { return vertices[i]; });
   out->vertices->vertex_format = std::move(format);
   out->vertices->interleaved = true;
   out->vertices->num_vertices = static_cast<uint32_t>(num_vertices);
@@ -361,17 +425,18 @@ void ExportModelInstance(const Model& model, ModelInstanceAssetDefT* out) {
 
   // Build the shader bone mapping for the base model.
   out->shader_to_mesh_bones = std::move(shader_to_mesh_bones);
+  out->lod_error = model.GetLodError();
 
   const Vertex& v = model.GetVertices()[0];
   for (size_t i = 0; i < v.blends.size(); ++i) {
     auto blend = std::make_unique<ModelBlendShapeAssetDefT>();
     blend->name = MakeName(v.blends[i].name);
 
-    blender.ClearBuffer();
-    for (const Vertex& v : model.GetVertices()) {
-      blender.ApplyOps(v.blends[i]);
-    }
-    blend->vertices->data = blender.Release();
+    blend->vertices = std::make_unique<ModelVertexBufferAssetDefT>();
+    blend->vertices->data = blender.Build(
+        num_vertices, [&](size_t n) -> const Vertex::Blend& {
+          return vertices[n].blends[i];
+        });
     blend->vertices->vertex_format = out->vertices->vertex_format;
     blend->vertices->interleaved = out->vertices->interleaved;
     blend->vertices->num_vertices = out->vertices->num_vertices;
@@ -443,8 +508,17 @@ void LogResults(const ModelAssetDefT& out, Logger& log) {
       log("      bytes: ", lod->indices->data32.size() * sizeof(uint32_t));
     }
 
+    log("    lod_error: ", lod->lod_error);
     log("    shader_bones: ", lod->shader_to_mesh_bones.size());
 
+    if (lod->collision_shape) {
+      const auto& shape = lod->collision_shape;
+      log("    collision shape:");
+      log("      vertices: ", shape->vertices->num_vertices);
+      log("      indices: ", shape->indices->data32.size());
+      log("      bvh bytes: ", shape->bullet_bvh.size());
+    }
+
     log("    drawables: ", lod->parts.size());
     for (const auto& part : lod->parts) {
       log("      ", part->name);
@@ -504,6 +578,13 @@ DataContainer ExportModel(absl::Span<const ModelPtr> lods, ModelPtr skeleton,
     model_def.lods.emplace_back(std::move(lod));
   }
 
+  // Export the collision shape. Only the first LOD is used at runtime.
+  if (collidable && !model_def.lods.empty()) {
+    auto& shape = model_def.lods[0]->collision_shape;
+    shape = std::make_unique<ModelCollisionShapeAssetDefT>();
+    ExportCollisionShape(*collidable, shape.get());
+  }
+
   // Gather texture for export.
   absl::flat_hash_map<std::string, const TextureInfo*> textures;
   for (const ModelPtr& model : lods) {
@@ -0,0 +1,476 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/tools/model_pipeline/mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <queue>
+#include <thread>
+
+#include "absl/container/flat_hash_map.h"
+
+namespace redux::tool {
+
+// Size of the simulated LRU cache used to score vertices. This is deliberately
+// larger than most hardware caches; the resulting order degrades gracefully
+// for smaller caches.
+static constexpr int kCacheSize = 32;
+static constexpr int kNoCachePosition = -1;
+static constexpr size_t kNoTriangle = std::numeric_limits<size_t>::max();
+
+namespace {
+
+struct CacheVertex {
+  // Offset into the adjacency list of the triangles using this vertex.
+  size_t first_triangle = 0;
+  // Number of triangles using this vertex that have not been emitted yet.
+  size_t num_active_triangles = 0;
+  int cache_position = kNoCachePosition;
+  float score = 0.0f;
+};
+
+}  // namespace
+
+static float ScoreVertex(const CacheVertex& vertex) {
+  if (vertex.num_active_triangles == 0) {
+    // No triangles need this vertex anymore.
+    return -1.0f;
+  }
+
+  float score = 0.0f;
+  if (vertex.cache_position >= 0) {
+    if (vertex.cache_position < 3) {
+      // The vertices of the last emitted triangle get a fixed score so that the
+      // next triangle doesn't simply share an edge with the previous one, which
+      // produces poor strips.
+      score = 0.75f;
+    } else {
+      const float scale = 1.0f / (kCacheSize - 3);
+      score = 1.0f - (vertex.cache_position - 3) * scale;
+      score = std::pow(score, 1.5f);
+    }
+  }
+
+  // Boost vertices with few remaining triangles so that they are finished off
+  // rather than left behind as isolated triangles.
+  const float valence_boost =
+      1.0f / std::sqrt(static_cast<float>(vertex.num_active_triangles));
+  return score + 2.0f * valence_boost;
+}
+
+void OptimizeVertexCache(absl::Span<size_t> indices) {
+  if (indices.size() % 3 != 0 || indices.size() <= 3) {
+    return;
+  }
+  const size_t num_triangles = indices.size() / 3;
+
+  // Remap the (model-wide) vertex indices into a compact local range so that
+  // the per-vertex state is proportional to the size of this index list.
+  absl::flat_hash_map<size_t, size_t> local_map;
+  std::vector<size_t> local_indices(indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    auto iter = local_map.try_emplace(indices[i], local_map.size()).first;
+    local_indices[i] = iter->second;
+  }
+  std::vector<CacheVertex> vertices(local_map.size());
+
+  // Build the vertex to triangle adjacency lists.
+  for (size_t index : local_indices) {
+    ++vertices[index].num_active_triangles;
+  }
+  size_t offset = 0;
+  for (CacheVertex& vertex : vertices) {
+    vertex.first_triangle = offset;
+    offset += vertex.num_active_triangles;
+    vertex.num_active_triangles = 0;
+  }
+  std::vector<size_t> adjacency(offset);
+  for (size_t i = 0; i < local_indices.size(); ++i) {
+    CacheVertex& vertex = vertices[local_indices[i]];
+    adjacency[vertex.first_triangle + vertex.num_active_triangles] = i / 3;
+    ++vertex.num_active_triangles;
+  }
+
+  for (CacheVertex& vertex : vertices) {
+    vertex.score = ScoreVertex(vertex);
+  }
+  std::vector<float> triangle_scores(num_triangles, 0.0f);
+  for (size_t i = 0; i < local_indices.size(); ++i) {
+    triangle_scores[i / 3] += vertices[local_indices[i]].score;
+  }
+  std::vector<bool> emitted(num_triangles, false);
+
+  // The cache holds an extra triangle's worth of entries so that vertices
+  // pushed out by the newest triangle can still have their scores updated.
+  std::vector<size_t> cache;
+  cache.reserve(kCacheSize + 3);
+  std::vector<size_t> next_cache;
+  next_cache.reserve(kCacheSize + 3);
+
+  std::vector<size_t> output;
+  output.reserve(indices.size());
+
+  size_t best_triangle = kNoTriangle;
+  size_t next_unemitted = 0;
+  for (size_t n = 0; n < num_triangles; ++n) {
+    if (best_triangle == kNoTriangle) {
+      // Nothing in the cache is useful, so start again from the first
+      // triangle that has not yet been emitted.
+      while (emitted[next_unemitted]) {
+        ++next_unemitted;
+      }
+      best_triangle = next_unemitted;
+    }
+
+    emitted[best_triangle] = true;
+    const size_t* tri = &local_indices[best_triangle * 3];
+    next_cache.assign(tri, tri + 3);
+    for (int i = 0; i < 3; ++i) {
+      const size_t index = indices[best_triangle * 3 + i];
+      output.push_back(index);
+
+      // Remove the triangle from the vertex's list of active triangles.
+      CacheVertex& vertex = vertices[tri[i]];
+      size_t* begin = &adjacency[vertex.first_triangle];
+      size_t* end = begin + vertex.num_active_triangles;
+      std::iter_swap(std::find(begin, end, best_triangle), end - 1);
+      --vertex.num_active_triangles;
+    }
+
+    for (size_t index : cache) {
+      if (index != tri[0] && index != tri[1] && index != tri[2]) {
+        next_cache.push_back(index);
+      }
+    }
+    cache.swap(next_cache);
+
+    // Update the scores for all vertices in (or just evicted from) the cache
+    // and the triangles that use them.
+    for (size_t i = 0; i < cache.size(); ++i) {
+      CacheVertex& vertex = vertices[cache[i]];
+      vertex.cache_position =
+          i < kCacheSize ? static_cast<int>(i) : kNoCachePosition;
+      const float score = ScoreVertex(vertex);
+      const float delta = score - vertex.score;
+      vertex.score = score;
+      for (size_t t = 0; t < vertex.num_active_triangles; ++t) {
+        triangle_scores[adjacency[vertex.first_triangle + t]] += delta;
+      }
+    }
+    if (cache.size() > kCacheSize) {
+      cache.resize(kCacheSize);
+    }
+
+    // Pick the best triangle adjacent to a cached vertex for the next step.
+    best_triangle = kNoTriangle;
+    float best_score = -1.0f;
+    for (size_t index : cache) {
+      const CacheVertex& vertex = vertices[index];
+      for (size_t t = 0; t < vertex.num_active_triangles; ++t) {
+        const size_t triangle = adjacency[vertex.first_triangle + t];
+        if (triangle_scores[triangle] > best_score) {
+          best_score = triangle_scores[triangle];
+          best_triangle = triangle;
+        }
+      }
+    }
+  }
+
+  std::copy(output.begin(), output.end(), indices.begin());
+}
+
+float CalculateAverageCacheMissRatio(absl::Span<const size_t> indices,
+                                     size_t cache_size) {
+  if (indices.size() < 3) {
+    return 0.0f;
+  }
+
+  std::deque<size_t> cache;
+  size_t misses = 0;
+  for (size_t index : indices) {
+    if (std::find(cache.begin(), cache.end(), index) != cache.end()) {
+      continue;
+    }
+    ++misses;
+    cache.push_back(index);
+    if (cache.size() > cache_size) {
+      cache.pop_front();
+    }
+  }
+  return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+namespace {
+
+// A symmetric 4x4 matrix which gives the sum of squared distances between a
+// point and a set of planes.
+struct Quadric {
+  void AddPlane(const vec3& normal, float distance) {
+    const double a = normal.x;
+    const double b = normal.y;
+    const double c = normal.z;
+    const double d = distance;
+    m[0] += a * a;
+    m[1] += a * b;
+    m[2] += a * c;
+    m[3] += a * d;
+    m[4] += b * b;
+    m[5] += b * c;
+    m[6] += b * d;
+    m[7] += c * c;
+    m[8] += c * d;
+    m[9] += d * d;
+  }
+
+  void Add(const Quadric& other) {
+    for (int i = 0; i < 10; ++i) {
+      m[i] += other.m[i];
+    }
+  }
+
+  double Evaluate(const vec3& p) const {
+    const double x = p.x;
+    const double y = p.y;
+    const double z = p.z;
+    const double error = x * x * m[0] + 2.0 * x * y * m[1] +
+                         2.0 * x * z * m[2] + 2.0 * x * m[3] + y * y * m[4] +
+                         2.0 * y * z * m[5] + 2.0 * y * m[6] + z * z * m[7] +
+                         2.0 * z * m[8] + m[9];
+    // Rounding can produce tiny negative values.
+    return std::max(error, 0.0);
+  }
+
+  double m[10] = {0.0};
+};
+
+// A candidate collapse of vertex |from| into vertex |to|.
+struct Collapse {
+  double cost;
+  size_t from;
+  size_t to;
+
+  bool operator>(const Collapse& rhs) const { return cost > rhs.cost; }
+};
+
+}  // namespace
+
+static vec3 TriangleNormal(const vec3& p0, const vec3& p1, const vec3& p2) {
+  return (p1 - p0).Cross(p2 - p0);
+}
+
+std::vector<size_t> SimplifyMesh(absl::Span<const vec3> positions,
+                                 absl::Span<const size_t> indices,
+                                 size_t target_index_count, float* out_error) {
+  if (out_error) {
+    *out_error = 0.0f;
+  }
+  std::vector<size_t> triangles(indices.begin(), indices.end());
+  if (triangles.size() % 3 != 0 || triangles.size() <= target_index_count) {
+    return triangles;
+  }
+
+  const size_t num_vertices = positions.size();
+  const size_t num_triangles = triangles.size() / 3;
+
+  // Accumulate the plane of each triangle into the quadrics of its vertices and
+  // build the vertex to triangle adjacency.
+  std::vector<Quadric> quadrics(num_vertices);
+  std::vector<std::vector<size_t>> vertex_triangles(num_vertices);
+  for (size_t t = 0; t < num_triangles; ++t) {
+    const size_t* tri = &triangles[t * 3];
+    vec3 normal =
+        TriangleNormal(positions[tri[0]], positions[tri[1]], positions[tri[2]]);
+    const float length = normal.Length();
+    if (length > 0.0f) {
+      normal /= length;
+    }
+    const float distance = -normal.Dot(positions[tri[0]]);
+    for (int i = 0; i < 3; ++i) {
+      quadrics[tri[i]].AddPlane(normal, distance);
+      vertex_triangles[tri[i]].push_back(t);
+    }
+  }
+
+  // Count the triangles using each (undirected) edge. Vertices on edges used by
+  // a single triangle are on a border or seam and are locked in place.
+  absl::flat_hash_map<std::pair<size_t, size_t>, int> edges;
+  for (size_t t = 0; t < num_triangles; ++t) {
+    const size_t* tri = &triangles[t * 3];
+    for (int i = 0; i < 3; ++i) {
+      const size_t a = tri[i];
+      const size_t b = tri[(i + 1) % 3];
+      ++edges[{std::min(a, b), std::max(a, b)}];
+    }
+  }
+  std::vector<bool> locked(num_vertices, false);
+  for (const auto& iter : edges) {
+    if (iter.second == 1) {
+      locked[iter.first.first] = true;
+      locked[iter.first.second] = true;
+    }
+  }
+
+  // Vertices that have been collapsed point to the vertex they were merged
+  // into.
+  std::vector<size_t> parent(num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    parent[i] = i;
+  }
+  auto find = [&parent](size_t v) {
+    while (parent[v] != v) {
+      parent[v] = parent[parent[v]];
+      v = parent[v];
+    }
+    return v;
+  };
+  auto cost = [&](size_t from, size_t to) {
+    Quadric q = quadrics[from];
+    q.Add(quadrics[to]);
+    return q.Evaluate(positions[to]);
+  };
+
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>>
+      queue;
+  for (const auto& iter : edges) {
+    const size_t a = iter.first.first;
+    const size_t b = iter.first.second;
+    if (!locked[a]) {
+      queue.push({cost(a, b), a, b});
+    }
+    if (!locked[b]) {
+      queue.push({cost(b, a), b, a});
+    }
+  }
+
+  std::vector<bool> removed(num_triangles, false);
+
+  // Returns true if moving |from| onto |to| would flip or degenerate any of the
+  // triangles that remain after the collapse.
+  auto flips = [&](size_t from, size_t to) {
+    for (size_t t : vertex_triangles[from]) {
+      if (removed[t]) {
+        continue;
+      }
+      const size_t* tri = &triangles[t * 3];
+      if (tri[0] == to || tri[1] == to || tri[2] == to) {
+        continue;  // This triangle collapses away.
+      }
+      vec3 moved[3];
+      for (int i = 0; i < 3; ++i) {
+        moved[i] = positions[tri[i] == from ? to : tri[i]];
+      }
+      const vec3 before = TriangleNormal(positions[tri[0]], positions[tri[1]],
+                                         positions[tri[2]]);
+      const vec3 after = TriangleNormal(moved[0], moved[1], moved[2]);
+      if (before.Dot(after) <= 0.0f) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  double max_cost = 0.0;
+  size_t num_live_triangles = num_triangles;
+  while (num_live_triangles * 3 > target_index_count && !queue.empty()) {
+    Collapse collapse = queue.top();
+    queue.pop();
+
+    const size_t from = find(collapse.from);
+    const size_t to = find(collapse.to);
+    if (from == to || from != collapse.from || locked[from]) {
+      continue;
+    }
+
+    // The quadrics grow as vertices are merged, so stale entries are
+    // re-queued with their current cost.
+    const double current_cost = cost(from, to);
+    if (current_cost > collapse.cost || to != collapse.to) {
+      queue.push({current_cost, from, to});
+      continue;
+    }
+    if (flips(from, to)) {
+      continue;
+    }
+
+    parent[from] = to;
+    quadrics[to].Add(quadrics[from]);
+    max_cost = std::max(max_cost, current_cost);
+    for (size_t t : vertex_triangles[from]) {
+      if (removed[t]) {
+        continue;
+      }
+      size_t* tri = &triangles[t * 3];
+      for (int i = 0; i < 3; ++i) {
+        if (tri[i] == from) {
+          tri[i] = to;
+        }
+      }
+      if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+        removed[t] = true;
+        --num_live_triangles;
+      } else {
+        vertex_triangles[to].push_back(t);
+      }
+    }
+    vertex_triangles[from].clear();
+  }
+
+  std::vector<size_t> result;
+  result.reserve(num_live_triangles * 3);
+  for (size_t t = 0; t < num_triangles; ++t) {
+    if (!removed[t]) {
+      result.insert(result.end(), &triangles[t * 3], &triangles[t * 3 + 3]);
+    }
+  }
+  if (out_error) {
+    *out_error = static_cast<float>(std::sqrt(max_cost));
+  }
+  return result;
+}
+
+void ParallelFor(size_t count, size_t min_block_size,
+                 const std::function<void(size_t begin, size_t end)>& fn) {
+  if (count == 0) {
+    return;
+  }
+
+  const size_t max_threads =
+      std::max(1u, std::thread::hardware_concurrency());
+  const size_t max_blocks = std::max<size_t>(1, count / min_block_size);
+  const size_t num_blocks = std::min(max_threads, max_blocks);
+  if (num_blocks == 1) {
+    fn(0, count);
+    return;
+  }
+
+  const size_t block_size = (count + num_blocks - 1) / num_blocks;
+  std::vector<std::thread> threads;
+  threads.reserve(num_blocks - 1);
+  for (size_t begin = block_size; begin < count; begin += block_size) {
+    const size_t end = std::min(begin + block_size, count);
+    threads.emplace_back([&fn, begin, end]() { fn(begin, end); });
+  }
+  // The first block is processed on the calling thread.
+  fn(0, std::min(block_size, count));
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace redux::tool
@@ -0,0 +1,63 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_TOOLS_MODEL_PIPELINE_MESH_OPTIMIZER_H_
+#define REDUX_TOOLS_MODEL_PIPELINE_MESH_OPTIMIZER_H_
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "redux/modules/math/vector.h"
+
+namespace redux::tool {
+
+// Reorders the triangles in the triangle-list |indices| so that vertices are
+// reused while they are still in the GPU's post-transform cache (using Tom
+// Forsyth's "Linear-Speed Vertex Cache Optimisation"). The set of triangles
+// and their winding is unchanged. Index lists whose size is not a multiple of
+// three are left untouched.
+void OptimizeVertexCache(absl::Span<size_t> indices);
+
+// Returns the average number of vertices transformed per triangle (ACMR) for
+// the triangle-list |indices| with a FIFO cache of |cache_size| entries. Lower
+// is better; 0.5 is the ideal for large regular meshes and 3 is the worst.
+float CalculateAverageCacheMissRatio(absl::Span<const size_t> indices,
+                                     size_t cache_size = 16);
+
+// Simplifies the triangle-list |indices| (which index into |positions|) by
+// repeatedly collapsing the edge with the smallest quadric error until at most
+// |target_index_count| indices remain or no collapse is possible. Vertices are
+// only ever merged into other existing vertices, so the result indexes the same
+// vertex buffer. Vertices on open borders (including attribute seams, where
+// the same position is split into several vertices) are never moved.
+// If |out_error| is not null, it is set to an estimate of the largest distance
+// between the simplified and the original surface.
+std::vector<size_t> SimplifyMesh(absl::Span<const vec3> positions,
+                                 absl::Span<const size_t> indices,
+                                 size_t target_index_count,
+                                 float* out_error = nullptr);
+
+// Splits the range [0, count) into contiguous blocks of at least
+// |min_block_size| elements and calls |fn|(begin, end) for each block, using
+// up to one thread per hardware thread. Returns once all blocks are done.
+void ParallelFor(size_t count, size_t min_block_size,
+                 const std::function<void(size_t begin, size_t end)>& fn);
+
+}  // namespace redux::tool
+
+#endif  // REDUX_TOOLS_MODEL_PIPELINE_MESH_OPTIMIZER_H_
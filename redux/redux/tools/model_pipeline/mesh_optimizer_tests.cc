@@ -0,0 +1,156 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/tools/model_pipeline/mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <random>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace redux::tool {
+namespace {
+
+using ::testing::Eq;
+using ::testing::FloatNear;
+using ::testing::Lt;
+using ::testing::Ne;
+
+// Creates the triangle-list for a regular grid of |size| x |size| quads.
+std::vector<size_t> CreateGrid(size_t size, size_t base_index = 0) {
+  std::vector<size_t> indices;
+  const size_t stride = size + 1;
+  for (size_t y = 0; y < size; ++y) {
+    for (size_t x = 0; x < size; ++x) {
+      const size_t i0 = base_index + y * stride + x;
+      const size_t i1 = i0 + 1;
+      const size_t i2 = i0 + stride;
+      const size_t i3 = i2 + 1;
+      indices.insert(indices.end(), {i0, i1, i2, i2, i1, i3});
+    }
+  }
+  return indices;
+}
+
+// Returns the vertex positions of a flat grid created by CreateGrid(size).
+std::vector<vec3> CreateGridPositions(size_t size) {
+  std::vector<vec3> positions;
+  for (size_t y = 0; y <= size; ++y) {
+    for (size_t x = 0; x <= size; ++x) {
+      positions.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.f);
+    }
+  }
+  return positions;
+}
+
+// Returns the triangles as a sorted list of index triples, each one rotated so
+// that its smallest index comes first (which preserves winding).
+std::vector<std::array<size_t, 3>> GetTriangles(
+    const std::vector<size_t>& indices) {
+  std::vector<std::array<size_t, 3>> triangles;
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    std::array<size_t, 3> tri = {indices[i], indices[i + 1], indices[i + 2]};
+    std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()),
+                tri.end());
+    triangles.push_back(tri);
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+TEST(MeshOptimizerTest, PreservesTriangles) {
+  std::vector<size_t> indices = CreateGrid(20, 100);
+  const auto expected = GetTriangles(indices);
+
+  OptimizeVertexCache(absl::MakeSpan(indices));
+  EXPECT_THAT(GetTriangles(indices), Eq(expected));
+}
+
+TEST(MeshOptimizerTest, ImprovesCacheMissRatio) {
+  std::vector<size_t> indices = CreateGrid(64);
+
+  // Shuffle the triangles to simulate a poorly ordered import.
+  std::vector<std::array<size_t, 3>> triangles;
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+  }
+  std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1234));
+  indices.clear();
+  for (const auto& tri : triangles) {
+    indices.insert(indices.end(), tri.begin(), tri.end());
+  }
+
+  const float before = CalculateAverageCacheMissRatio(indices);
+  OptimizeVertexCache(absl::MakeSpan(indices));
+  const float after = CalculateAverageCacheMissRatio(indices);
+
+  EXPECT_THAT(after, Lt(before));
+  EXPECT_THAT(after, Lt(1.0f));
+}
+
+TEST(MeshOptimizerTest, IgnoresNonTriangleLists) {
+  std::vector<size_t> indices = {0, 1, 2, 3};
+  OptimizeVertexCache(absl::MakeSpan(indices));
+  EXPECT_THAT(indices, Eq(std::vector<size_t>({0, 1, 2, 3})));
+}
+
+TEST(MeshOptimizerTest, SimplifiesFlatMesh) {
+  const std::vector<size_t> indices = CreateGrid(16);
+  const std::vector<vec3> positions = CreateGridPositions(16);
+
+  float error = -1.0f;
+  const std::vector<size_t> simplified =
+      SimplifyMesh(positions, indices, indices.size() / 4, &error);
+
+  EXPECT_THAT(simplified.size() % 3, Eq(0));
+  EXPECT_THAT(simplified.size(), Lt(indices.size() / 2));
+  EXPECT_THAT(error, FloatNear(0.0f, 1e-4f));
+  for (size_t i = 0; i < simplified.size(); i += 3) {
+    EXPECT_THAT(simplified[i], Ne(simplified[i + 1]));
+    EXPECT_THAT(simplified[i + 1], Ne(simplified[i + 2]));
+    EXPECT_THAT(simplified[i + 2], Ne(simplified[i]));
+  }
+}
+
+TEST(MeshOptimizerTest, SimplifyKeepsMeshWithinTarget) {
+  const std::vector<size_t> indices = CreateGrid(4);
+  const std::vector<vec3> positions = CreateGridPositions(4);
+
+  float error = -1.0f;
+  const std::vector<size_t> simplified =
+      SimplifyMesh(positions, indices, indices.size(), &error);
+  EXPECT_THAT(simplified, Eq(indices));
+  EXPECT_THAT(error, Eq(0.0f));
+}
+
+TEST(MeshOptimizerTest, ParallelForVisitsEachIndexOnce) {
+  std::vector<std::atomic<int>> counts(10000);
+  ParallelFor(counts.size(), 10, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      ++counts[i];
+    }
+  });
+  for (const auto& count : counts) {
+    EXPECT_THAT(count.load(), Eq(1));
+  }
+}
+
+}  // namespace
+}  // namespace redux::tool
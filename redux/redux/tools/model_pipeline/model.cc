@@ -16,9 +16,15 @@ limitations under the License.
 
 #include "redux/tools/model_pipeline/model.h"
 
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
+#include "absl/hash/hash.h"
 #include "redux/modules/flatbuffers/var.h"
 #include "redux/modules/graphics/image_utils.h"
 #include "redux/tools/common/file_utils.h"
+#include "redux/tools/model_pipeline/mesh_optimizer.h"
 #include "redux/tools/model_pipeline/util.h"
 
 namespace redux::tool {
@@ -66,19 +72,18 @@ static size_t MaterialHash(const Material& material) {
 // Hashes only the position, orientation, and uv0 of the Vertex. This hash
 // should only be used as a first-level filter for deduplication. For actual
 // deduplication, the vertices should be compared directly.
+//
+// The components are combined (rather than xor'ed together) so that vertices
+// whose components are merely permuted, which is common on axis-aligned CAD
+// geometry, do not all land in the same bucket.
 static size_t VertexHash(const Vertex& vertex) {
-  uint64_t hash = 0;
-  hash ^= std::hash<uint32_t>()(vertex.attribs.Value());
-  hash ^= std::hash<float>()(vertex.position.x);
-  hash ^= std::hash<float>()(vertex.position.y);
-  hash ^= std::hash<float>()(vertex.position.z);
-  hash ^= std::hash<float>()(vertex.orientation.x);
-  hash ^= std::hash<float>()(vertex.orientation.y);
-  hash ^= std::hash<float>()(vertex.orientation.z);
-  hash ^= std::hash<float>()(vertex.orientation.w);
-  hash ^= std::hash<float>()(vertex.uv0.x);
-  hash ^= std::hash<float>()(vertex.uv0.y);
-  return static_cast<size_t>(hash);
+  return absl::Hash<std::tuple<uint32_t, float, float, float, float, float,
+                               float, float, float, float>>()(
+      std::make_tuple(vertex.attribs.Value(), vertex.position.x,
+                      vertex.position.y, vertex.position.z,
+                      vertex.orientation.x, vertex.orientation.y,
+                      vertex.orientation.z, vertex.orientation.w,
+                      vertex.uv0.x, vertex.uv0.y));
 }
 
 Model::Model() : Model("") {}
@@ -194,34 +199,110 @@ void Model::ComputeOrientationsFromTangentSpaces(bool ensure_w_not_zero) {
     return;
   }
 
-  if (ensure_w_not_zero) {
-    if (vertex_attributes_.Any(Vertex::kAttribBit_Tangent)) {
-      for (Vertex& vertex : vertices_) {
-        vertex.orientation =
-            CalculateOrientationNonZeroW(vertex.normal, vertex.tangent);
-      }
-    } else {
-      for (Vertex& vertex : vertices_) {
-        vec4 tangent = GenerateTangent(vertex.normal);
-        vertex.orientation =
-            CalculateOrientationNonZeroW(vertex.normal, tangent);
-      }
+  const bool has_tangents = vertex_attributes_.Any(Vertex::kAttribBit_Tangent);
+
+  // Each vertex is independent, so the vertex array is simply split into
+  // blocks that are processed concurrently.
+  static constexpr size_t kMinVerticesPerThread = 4096;
+  ParallelFor(vertices_.size(), kMinVerticesPerThread,
+              [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                  Vertex& vertex = vertices_[i];
+                  const vec4 tangent = has_tangents
+                                           ? vertex.tangent
+                                           : GenerateTangent(vertex.normal);
+                  vertex.orientation =
+                      ensure_w_not_zero
+                          ? CalculateOrientationNonZeroW(vertex.normal, tangent)
+                          : CalculateOrientation(vertex.normal, tangent);
+                }
+              });
+
+  vertex_attributes_.Set(Vertex::kAttribBit_Orientation);
+}
+
+void Model::OptimizeVertexOrder() {
+  // Reorder each drawable's triangles for the post-transform vertex cache. The
+  // drawables do not share any state so they are optimized concurrently.
+  ParallelFor(drawables_.size(), 1, [this](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      OptimizeVertexCache(absl::MakeSpan(drawables_[i].indices));
     }
-  } else {
-    if (vertex_attributes_.Any(Vertex::kAttribBit_Tangent)) {
-      for (Vertex& vertex : vertices_) {
-        vertex.orientation =
-            CalculateOrientation(vertex.normal, vertex.tangent);
+  });
+
+  // Then reorder the vertices themselves into the order in which they are
+  // first referenced so that vertex fetches are (mostly) sequential.
+  static constexpr size_t kUnassigned = std::numeric_limits<size_t>::max();
+  std::vector<size_t> remap(vertices_.size(), kUnassigned);
+  std::vector<Vertex> vertices;
+  vertices.reserve(vertices_.size());
+  for (Drawable& drawable : drawables_) {
+    for (size_t& index : drawable.indices) {
+      if (remap[index] == kUnassigned) {
+        remap[index] = vertices.size();
+        vertices.push_back(std::move(vertices_[index]));
       }
-    } else {
-      for (Vertex& vertex : vertices_) {
-        vec4 tangent = GenerateTangent(vertex.normal);
-        vertex.orientation = CalculateOrientation(vertex.normal, tangent);
+      index = remap[index];
+    }
+  }
+  vertices_ = std::move(vertices);
+
+  vertex_map_.clear();
+  for (size_t i = 0; i < vertices_.size(); ++i) {
+    vertex_map_[VertexHash(vertices_[i])].push_back(i);
+  }
+}
+
+std::shared_ptr<Model> Model::CreateSimplifiedModel(
+    float triangle_ratio) const {
+  auto model = std::make_shared<Model>(*this);
+
+  std::vector<vec3> positions;
+  positions.reserve(vertices_.size());
+  for (const Vertex& vertex : vertices_) {
+    positions.push_back(vertex.position);
+  }
+
+  // Each drawable is simplified independently so that the boundaries between
+  // materials are preserved.
+  std::vector<float> errors(drawables_.size(), 0.0f);
+  ParallelFor(drawables_.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const std::vector<size_t>& indices = drawables_[i].indices;
+      const size_t target = static_cast<size_t>(
+          static_cast<float>(indices.size() / 3) * triangle_ratio) * 3;
+      model->drawables_[i].indices =
+          SimplifyMesh(positions, indices, target, &errors[i]);
+    }
+  });
+
+  // Errors are measured against this model, so accumulate them with the error
+  // of this model relative to the original.
+  float max_error = 0.0f;
+  for (float error : errors) {
+    max_error = std::max(max_error, error);
+  }
+  model->lod_error_ = lod_error_ + max_error;
+
+  // Drop the vertices that are no longer referenced.
+  static constexpr size_t kUnassigned = std::numeric_limits<size_t>::max();
+  std::vector<size_t> remap(vertices_.size(), kUnassigned);
+  model->vertices_.clear();
+  for (Drawable& drawable : model->drawables_) {
+    for (size_t& index : drawable.indices) {
+      if (remap[index] == kUnassigned) {
+        remap[index] = model->vertices_.size();
+        model->vertices_.push_back(vertices_[index]);
       }
+      index = remap[index];
     }
   }
 
-  vertex_attributes_.Set(Vertex::kAttribBit_Orientation);
+  model->vertex_map_.clear();
+  for (size_t i = 0; i < model->vertices_.size(); ++i) {
+    model->vertex_map_[VertexHash(model->vertices_[i])].push_back(i);
+  }
+  return model;
 }
 
 Material* Model::FindMaterialByName(std::string_view name) {
@@ -337,6 +418,10 @@ void Model::Finish(const ModelConfig* config, const TextureResolver& resolver) {
     vertex_attributes_.Intersect(requested);
   }
 
+  if (config->optimize_vertex_order()) {
+    OptimizeVertexOrder();
+  }
+
   if (config->materials()) {
     for (const MaterialConfig* material_opts : *config->materials()) {
       if (material_opts->name()) {
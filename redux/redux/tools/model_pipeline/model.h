@@ -62,6 +62,11 @@ class Model {
   using TextureResolver = std::function<std::string(std::string_view)>;
   void Finish(const ModelConfig* config, const TextureResolver& resolver);
 
+  // Returns a copy of this model whose drawables have been simplified to
+  // roughly |triangle_ratio| of their current triangle counts. The copy only
+  // contains the vertices still referenced by the simplified drawables.
+  std::shared_ptr<Model> CreateSimplifiedModel(float triangle_ratio) const;
+
   // Accessors used during the export process.
   const std::string& GetName() const { return name_; }
   const vec3& GetMinPosition() const { return min_position_; }
@@ -71,6 +76,10 @@ class Model {
   const std::vector<Drawable>& GetDrawables() const { return drawables_; }
   const Vertex::Attrib GetAttribs() const { return vertex_attributes_; }
 
+  // The estimated distance (in model units) between the surface of this model
+  // and the surface of the model from which it was simplified.
+  float GetLodError() const { return lod_error_; }
+
  protected:
   size_t AddOrGetVertex(const Vertex& vertex);
 
@@ -80,6 +89,11 @@ class Model {
   // determine bitangent direction using the glsl method sign().
   void ComputeOrientationsFromTangentSpaces(bool ensure_w_not_zero);
 
+  // Reorders the indices of each drawable for better vertex cache utilization
+  // and then reorders the vertices to match the order in which the indices
+  // first reference them.
+  void OptimizeVertexOrder();
+
   Material* FindMaterialByName(std::string_view name);
 
   std::string name_;
@@ -96,6 +110,7 @@ class Model {
   vec3 max_position_;
   size_t current_drawable_ = 0;
   Vertex::Attrib vertex_attributes_;
+  float lod_error_ = 0.0f;
 };
 
 using ModelPtr = std::shared_ptr<Model>;
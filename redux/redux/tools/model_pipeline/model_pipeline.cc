@@ -80,6 +80,13 @@ DataContainer ModelPipeline::Build(const Config& config) {
     CHECK(name) << "Renderable must specify a name.";
     renderables.emplace_back(GetImportedModel(name->c_str()));
   }
+  CHECK(!renderables.empty()) << "Must specify at least one renderable.";
+
+  for (int i = 0; i < config.generated_lods(); ++i) {
+    const ModelPtr& prev = renderables.back();
+    renderables.emplace_back(
+        prev->CreateSimplifiedModel(config.lod_triangle_ratio()));
+  }
 
   ModelPtr skeleton;
   if (config.skeleton()) {
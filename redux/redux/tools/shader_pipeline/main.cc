@@ -28,6 +28,8 @@ limitations under the License.
 
 ABSL_FLAG(std::string, src, "", "Input shader file.");
 ABSL_FLAG(std::string, out, "", "Location of file to be saved.");
+ABSL_FLAG(std::string, feature_sets, "",
+          "Optional file listing the shading feature combinations in use.");
 
 namespace redux::tool {
 namespace {
@@ -41,13 +43,34 @@ struct ShaderList {
   }
 };
 
+struct ShaderFeatureSetList {
+  std::vector<ShaderFeatureSet> feature_sets;
+
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(feature_sets, ConstHash("feature_sets"));
+  }
+};
+
+ShaderFeatureSetList LoadFeatureSets(const std::string& path) {
+  if (path.empty()) {
+    return {};
+  }
+  const std::string jsonnet = LoadFileAsString(path.c_str());
+  const std::string json = JsonnetToJson(jsonnet.c_str(), path.c_str());
+  return ReadJson<ShaderFeatureSetList>(json.c_str());
+}
+
 int RunShaderPipeline() {
   const std::string src = absl::GetFlag(FLAGS_src);
   const std::string jsonnet = LoadFileAsString(src.c_str());
   const std::string json = JsonnetToJson(jsonnet.c_str(), src.c_str());
   const std::string name = std::string(RemoveDirectoryAndExtension(src));
   ShaderList shaders = ReadJson<ShaderList>(json.c_str());
-  DataContainer data = BuildShader(name, shaders.shaders);
+  const ShaderFeatureSetList feature_sets =
+      LoadFeatureSets(absl::GetFlag(FLAGS_feature_sets));
+  DataContainer data =
+      BuildShader(name, shaders.shaders, feature_sets.feature_sets);
 
   const std::string& out_file = absl::GetFlag(FLAGS_out);
   CHECK(SaveFile(data.GetBytes(), data.GetNumBytes(), out_file.c_str(), true))
@@ -262,13 +262,28 @@ std::unique_ptr<ShaderVariantAssetDefT> BuildVariant(const ShaderAsset& asset) {
 }
 
 DataContainer BuildShader(std::string_view name,
-                          absl::Span<const ShaderAsset> assets) {
+                          absl::Span<const ShaderAsset> assets,
+                          absl::Span<const ShaderFeatureSet> feature_sets) {
   ShaderAssetDefT shader_def;
   shader_def.shading_model = std::string(name);
 
-  filamat::MaterialBuilder::init();
+  std::vector<std::vector<std::string>> variant_features;
+  variant_features.reserve(assets.size());
   for (const ShaderAsset& asset : assets) {
-    shader_def.variants.emplace_back(BuildVariant(asset));
+    variant_features.emplace_back(asset.features);
+  }
+  VariantSelection selection = SelectVariants(variant_features, feature_sets);
+  shader_def.prewarm_variants = std::move(selection.prewarm);
+
+  filamat::MaterialBuilder::init();
+  std::size_t next = 0;
+  for (std::size_t i = 0; i < assets.size(); ++i) {
+    if (next < selection.variants.size() && selection.variants[next] == i) {
+      shader_def.variants.emplace_back(BuildVariant(assets[i]));
+      ++next;
+    } else {
+      LOG(INFO) << "Pruning unused shader variant: " << assets[i].name;
+    }
   }
   filamat::MaterialBuilder::shutdown();
   return BuildFlatbuffer(shader_def);
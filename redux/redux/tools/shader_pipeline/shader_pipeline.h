@@ -25,6 +25,7 @@ limitations under the License.
 #include "redux/modules/base/data_container.h"
 #include "redux/modules/base/hash.h"
 #include "redux/modules/graphics/enums.h"
+#include "redux/tools/shader_pipeline/variant_selection.h"
 
 namespace redux::tool {
 
@@ -117,8 +118,13 @@ struct ShaderAsset {
   }
 };
 
+// Builds the shader from the given variants. If `feature_sets` is not empty,
+// variants that cannot be selected by any of the feature sets are pruned
+// (except for the final, fallback variant) and the remaining ones are listed
+// in the shader's prewarm manifest so that they are created at load time.
 DataContainer BuildShader(std::string_view name,
-                          absl::Span<const ShaderAsset> assets);
+                          absl::Span<const ShaderAsset> assets,
+                          absl::Span<const ShaderFeatureSet> feature_sets = {});
 
 }  // namespace redux::tool
 
@@ -0,0 +1,64 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/tools/shader_pipeline/variant_selection.h"
+
+#include <algorithm>
+
+namespace redux::tool {
+
+// Returns true if the runtime could select a variant with the given features
+// when the given set of features is enabled, ie. the variant provides all the
+// features.
+static bool SupportsFeatures(const std::vector<std::string>& features,
+                             const ShaderFeatureSet& feature_set) {
+  for (const std::string& feature : feature_set.features) {
+    if (std::find(features.begin(), features.end(), feature) ==
+        features.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+VariantSelection SelectVariants(
+    absl::Span<const std::vector<std::string>> variant_features,
+    absl::Span<const ShaderFeatureSet> feature_sets) {
+  VariantSelection selection;
+  for (std::size_t i = 0; i < variant_features.size(); ++i) {
+    bool used = feature_sets.empty();
+    for (const ShaderFeatureSet& feature_set : feature_sets) {
+      if (SupportsFeatures(variant_features[i], feature_set)) {
+        used = true;
+        break;
+      }
+    }
+
+    // The last variant is the runtime's fallback, so it is always kept.
+    const bool fallback = i + 1 == variant_features.size();
+    if (!used && !fallback) {
+      continue;
+    }
+    if (used && !feature_sets.empty()) {
+      selection.prewarm.emplace_back(
+          static_cast<uint32_t>(selection.variants.size()));
+    }
+    selection.variants.emplace_back(i);
+  }
+  return selection;
+}
+
+}  // namespace redux::tool
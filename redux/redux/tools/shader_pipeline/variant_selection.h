@@ -0,0 +1,61 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_TOOLS_SHADER_PIPELINE_VARIANT_SELECTION_H_
+#define REDUX_TOOLS_SHADER_PIPELINE_VARIANT_SELECTION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "redux/modules/base/hash.h"
+
+namespace redux::tool {
+
+// A combination of shading features that is enabled together at runtime.
+struct ShaderFeatureSet {
+  std::vector<std::string> features;
+
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(features, ConstHash("features"));
+  }
+};
+
+// The variants of a shader that are kept after pruning.
+struct VariantSelection {
+  // Indices of the kept variants in the input list, in their original order.
+  std::vector<std::size_t> variants;
+
+  // Indices into `variants` of the variants to create when the shader is
+  // loaded. Empty if every variant should be created up front.
+  std::vector<uint32_t> prewarm;
+};
+
+// Decides which variants to build, given the features each variant provides.
+// If `feature_sets` is empty, every variant is kept. Otherwise, variants that
+// cannot be selected by any of the feature sets are pruned, except for the
+// final variant which the runtime uses as its fallback, and the others are
+// listed for prewarming.
+VariantSelection SelectVariants(
+    absl::Span<const std::vector<std::string>> variant_features,
+    absl::Span<const ShaderFeatureSet> feature_sets);
+
+}  // namespace redux::tool
+
+#endif  // REDUX_TOOLS_SHADER_PIPELINE_VARIANT_SELECTION_H_
@@ -0,0 +1,81 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/tools/shader_pipeline/variant_selection.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace redux::tool {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+ShaderFeatureSet FeatureSet(std::vector<std::string> features) {
+  ShaderFeatureSet feature_set;
+  feature_set.features = std::move(features);
+  return feature_set;
+}
+
+const std::vector<std::vector<std::string>> kVariants = {
+    {"Skinning", "Texture"},
+    {"Skinning"},
+    {"Texture"},
+    {},
+};
+
+TEST(VariantSelectionTest, KeepsEverythingWithoutFeatureSets) {
+  const VariantSelection selection = SelectVariants(kVariants, {});
+  EXPECT_THAT(selection.variants, ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(selection.prewarm, IsEmpty());
+}
+
+TEST(VariantSelectionTest, PrunesUnselectableVariants) {
+  const std::vector<ShaderFeatureSet> feature_sets = {FeatureSet({"Texture"})};
+  const VariantSelection selection = SelectVariants(kVariants, feature_sets);
+
+  // Both variants with a texture can be selected, and the fallback is kept.
+  EXPECT_THAT(selection.variants, ElementsAre(0, 2, 3));
+  EXPECT_THAT(selection.prewarm, ElementsAre(0, 1));
+}
+
+TEST(VariantSelectionTest, KeepsVariantsForAnyFeatureSet) {
+  const std::vector<ShaderFeatureSet> feature_sets = {
+      FeatureSet({"Skinning", "Texture"}), FeatureSet({"Skinning"})};
+  const VariantSelection selection = SelectVariants(kVariants, feature_sets);
+  EXPECT_THAT(selection.variants, ElementsAre(0, 1, 3));
+  EXPECT_THAT(selection.prewarm, ElementsAre(0, 1));
+}
+
+TEST(VariantSelectionTest, EmptyFeatureSetSelectsEverything) {
+  const std::vector<ShaderFeatureSet> feature_sets = {FeatureSet({})};
+  const VariantSelection selection = SelectVariants(kVariants, feature_sets);
+  EXPECT_THAT(selection.variants, ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(selection.prewarm, ElementsAre(0, 1, 2, 3));
+}
+
+TEST(VariantSelectionTest, PrewarmsFallbackOnlyIfSelectable) {
+  const std::vector<std::vector<std::string>> variants = {{"Skinning"},
+                                                          {"Texture"}};
+  const std::vector<ShaderFeatureSet> feature_sets = {FeatureSet({"Skinning"})};
+  const VariantSelection selection = SelectVariants(variants, feature_sets);
+  EXPECT_THAT(selection.variants, ElementsAre(0, 1));
+  EXPECT_THAT(selection.prewarm, ElementsAre(0));
+}
+
+}  // namespace
+}  // namespace redux::tool
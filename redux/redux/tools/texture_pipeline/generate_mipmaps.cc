@@ -16,18 +16,162 @@ limitations under the License.
 
 #include "redux/tools/texture_pipeline/generate_mipmaps.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <thread>
 #include <vector>
+
 #include "redux/modules/base/logging.h"
 #include "redux/modules/graphics/image_utils.h"
 
 namespace redux::tool {
 
-static int UvAndChannelToIndex(const ImageData& image, int u, int v, int c) {
-  const int channel_count = GetChannelCountForFormat(image.GetFormat());
-  return (v * image.GetSize().x + u) * channel_count + c;
+// Levels with fewer pixels than this are not worth splitting across threads.
+static constexpr int kMinPixelsPerThread = 64 * 1024;
+
+// The number of entries in the linear-to-sRGB table. More entries than the 256
+// sRGB values are needed to preserve precision in the dark end of the range.
+static constexpr int kLinearToSrgbTableSize = 4096;
+
+namespace {
+
+// Lookup tables for converting between 8-bit sRGB values and linear values.
+struct SrgbTables {
+  SrgbTables() {
+    for (int i = 0; i < 256; ++i) {
+      const float c = static_cast<float>(i) / 255.0f;
+      to_linear[i] = c <= 0.04045f ? c / 12.92f
+                                   : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+    for (int i = 0; i < kLinearToSrgbTableSize; ++i) {
+      const float c = static_cast<float>(i) /
+                      static_cast<float>(kLinearToSrgbTableSize - 1);
+      const float s = c <= 0.0031308f
+                          ? c * 12.92f
+                          : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+      to_srgb[i] = static_cast<std::byte>(std::lround(s * 255.0f));
+    }
+  }
+
+  std::byte ToSrgb(float linear) const {
+    const float scaled =
+        linear * static_cast<float>(kLinearToSrgbTableSize - 1);
+    const int index = static_cast<int>(scaled + 0.5f);
+    return to_srgb[std::clamp(index, 0, kLinearToSrgbTableSize - 1)];
+  }
+
+  std::array<float, 256> to_linear;
+  std::array<std::byte, kLinearToSrgbTableSize> to_srgb;
+};
+
+const SrgbTables& GetSrgbTables() {
+  static const SrgbTables tables;
+  return tables;
+}
+
+// Describes a single 2x2 box-filter reduction from one level to the next.
+struct Downsample {
+  const std::byte* src = nullptr;
+  std::byte* dst = nullptr;
+  std::size_t src_stride = 0;
+  std::size_t dst_stride = 0;
+  int dst_width = 0;
+  int chan_count = 0;
+  // Bitmask of the channels that are sRGB encoded.
+  unsigned int srgb_channels = 0;
+};
+
+// Box filters a single row of |width| pixels with N channels each. The
+// channel count is a compile-time constant so that the compiler can unroll
+// and vectorize the loop.
+template <int N>
+void BoxFilterRow(const uint8_t* row0, const uint8_t* row1, std::byte* out,
+                  int width) {
+  for (int xx = 0; xx < width; ++xx) {
+    for (int cc = 0; cc < N; ++cc) {
+      const int x = xx * 2 * N + cc;
+      const int total = row0[x] + row0[x + N] + row1[x] + row1[x + N];
+      out[xx * N + cc] = static_cast<std::byte>(total / 4);
+    }
+  }
 }
 
-std::vector<ImageData> GenerateMipmaps(ImageData image) {
+// Like BoxFilterRow, but averages the |srgb_channels| in linear space.
+void BoxFilterRowSrgb(const uint8_t* row0, const uint8_t* row1,
+                      std::byte* out, int width, int chan_count,
+                      unsigned int srgb_channels) {
+  const SrgbTables& tables = GetSrgbTables();
+  const int n = chan_count;
+  for (int xx = 0; xx < width; ++xx) {
+    for (int cc = 0; cc < n; ++cc) {
+      const int x = xx * 2 * n + cc;
+      if (srgb_channels & (1u << cc)) {
+        const float total =
+            tables.to_linear[row0[x]] + tables.to_linear[row0[x + n]] +
+            tables.to_linear[row1[x]] + tables.to_linear[row1[x + n]];
+        out[xx * n + cc] = tables.ToSrgb(total * 0.25f);
+      } else {
+        const int total = row0[x] + row0[x + n] + row1[x] + row1[x + n];
+        out[xx * n + cc] = static_cast<std::byte>(total / 4);
+      }
+    }
+  }
+}
+
+// Filters rows [begin, end) of the destination level.
+void DownsampleRows(const Downsample& op, int begin, int end) {
+  for (int yy = begin; yy < end; ++yy) {
+    const auto* row0 = reinterpret_cast<const uint8_t*>(
+        op.src + (2 * yy + 0) * op.src_stride);
+    const auto* row1 = reinterpret_cast<const uint8_t*>(
+        op.src + (2 * yy + 1) * op.src_stride);
+    std::byte* out = op.dst + yy * op.dst_stride;
+
+    if (op.srgb_channels) {
+      BoxFilterRowSrgb(row0, row1, out, op.dst_width, op.chan_count,
+                       op.srgb_channels);
+      continue;
+    }
+    switch (op.chan_count) {
+      case 1:
+        BoxFilterRow<1>(row0, row1, out, op.dst_width);
+        break;
+      case 2:
+        BoxFilterRow<2>(row0, row1, out, op.dst_width);
+        break;
+      case 3:
+        BoxFilterRow<3>(row0, row1, out, op.dst_width);
+        break;
+      case 4:
+        BoxFilterRow<4>(row0, row1, out, op.dst_width);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported channel count: " << op.chan_count;
+    }
+  }
+}
+
+// Returns the bitmask of channels that store sRGB encoded color in |format|.
+unsigned int GetSrgbChannels(ImageFormat format) {
+  switch (format) {
+    case ImageFormat::Luminance8:
+    case ImageFormat::LuminanceAlpha88:
+      return 0x1;
+    case ImageFormat::Rg88:
+      return 0x3;
+    case ImageFormat::Rgb888:
+    case ImageFormat::Rgba8888:
+      return 0x7;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+std::vector<ImageData> GenerateMipmaps(ImageData image,
+                                       const GenerateMipmapsOptions& options) {
   const ImageFormat format = image.GetFormat();
   const int chan_count = GetChannelCountForFormat(format);
   CHECK_NE(chan_count, 0) << "Unsupported format";
@@ -35,39 +179,60 @@ std::vector<ImageData> GenerateMipmaps(ImageData image) {
   int bits_per_channel = GetBitsPerPixel(format) / chan_count;
   CHECK_EQ(bits_per_channel, 8)  << "Only 8 bit images are supported";
 
+  int max_threads = options.num_threads;
+  if (max_threads <= 0) {
+    max_threads =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+
   std::vector<ImageData> images;
   images.push_back(std::move(image));
   ImageData const* src = &images.front();
 
   while (src->GetSize().x > 1 && src->GetSize().y > 1) {
     const vec2i src_size = src->GetSize();
-    const vec2i dst_size = src_size / 2;
+    // Note: vec2i's operator/ multiplies by the (integer) reciprocal, so the
+    // halving is done per-component instead.
+    const vec2i dst_size(src_size.x / 2, src_size.y / 2);
     const size_t dst_data_size = CalculateDataSize(format, dst_size);
 
     DataContainer dst_data = DataContainer::Allocate(dst_data_size);
     ImageData dst = ImageData(format, dst_size, std::move(dst_data));
-    const std::byte* src_bytes = src->GetData();
-    std::byte* dst_bytes = const_cast<std::byte*>(dst.GetData());
-
-    for (int yy = 0; yy < dst_size.y; ++yy) {
-      for (int xx = 0; xx < dst_size.x; ++xx) {
-        for (int cc = 0; cc < chan_count; ++cc) {
-          // Simple box filter, and this does not correctly account for non-
-          // power-of-two textures, but instead behaves as nearest-neighbor.  A
-          // better implementation of box would use bilinear interpolation to
-          // help with pixel siting in non-POT cases.
-          const int xx2 = xx * 2, yy2 = yy * 2;
-          const int p00 = UvAndChannelToIndex(*src, xx2 + 0, yy2 + 0, cc);
-          const int p01 = UvAndChannelToIndex(*src, xx2 + 1, yy2 + 0, cc);
-          const int p10 = UvAndChannelToIndex(*src, xx2 + 0, yy2 + 1, cc);
-          const int p11 = UvAndChannelToIndex(*src, xx2 + 1, yy2 + 1, cc);
-          const int total = static_cast<int>(src_bytes[p00]) +
-                            static_cast<int>(src_bytes[p10]) +
-                            static_cast<int>(src_bytes[p01]) +
-                            static_cast<int>(src_bytes[p11]);
-          dst_bytes[UvAndChannelToIndex(dst, xx, yy, cc)] =
-              static_cast<std::byte>(total / 4);
-        }
+
+    // Simple box filter, and this does not correctly account for non-power-of-
+    // two textures, but instead behaves as nearest-neighbor.  A better
+    // implementation of box would use bilinear interpolation to help with
+    // pixel siting in non-POT cases.
+    Downsample op;
+    op.src = src->GetData();
+    op.dst = const_cast<std::byte*>(dst.GetData());
+    op.src_stride = src->GetStride();
+    op.dst_stride = dst.GetStride();
+    op.dst_width = dst_size.x;
+    op.chan_count = chan_count;
+    op.srgb_channels = options.srgb ? GetSrgbChannels(format) : 0;
+
+    // Split the level into horizontal bands, one per thread, with each band
+    // large enough to be worth the cost of the thread.
+    const int num_pixels = dst_size.x * dst_size.y;
+    const int num_threads = std::clamp(num_pixels / kMinPixelsPerThread, 1,
+                                       std::min(max_threads, dst_size.y));
+    if (num_threads == 1) {
+      DownsampleRows(op, 0, dst_size.y);
+    } else {
+      std::vector<std::thread> threads;
+      threads.reserve(num_threads - 1);
+      const int rows_per_thread = (dst_size.y + num_threads - 1) / num_threads;
+      for (int begin = rows_per_thread; begin < dst_size.y;
+           begin += rows_per_thread) {
+        const int end = std::min(begin + rows_per_thread, dst_size.y);
+        threads.emplace_back([&op, begin, end]() {
+          DownsampleRows(op, begin, end);
+        });
+      }
+      DownsampleRows(op, 0, std::min(rows_per_thread, dst_size.y));
+      for (std::thread& thread : threads) {
+        thread.join();
       }
     }
 
@@ -23,9 +23,23 @@ limitations under the License.
 
 namespace redux::tool {
 
+// Options for controlling how mipmaps are generated.
+struct GenerateMipmapsOptions {
+  // The number of threads across which each mip level is split. A value of 0
+  // uses the number of hardware threads. Small levels are always generated on
+  // the calling thread.
+  int num_threads = 0;
+
+  // If true, the color channels of the image are treated as sRGB encoded and
+  // are filtered in linear space. The alpha channel (if any) is always
+  // filtered as-is.
+  bool srgb = false;
+};
+
 // Generates a vector of mipmap levels for the given image.  The top level
 // image will also be included in the vector.
-std::vector<ImageData> GenerateMipmaps(ImageData image);
+std::vector<ImageData> GenerateMipmaps(
+    ImageData image, const GenerateMipmapsOptions& options = {});
 
 }  // namespace redux::tool
 
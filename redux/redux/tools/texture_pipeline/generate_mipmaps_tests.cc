@@ -0,0 +1,114 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/tools/texture_pipeline/generate_mipmaps.h"
+
+#include <cstring>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/modules/graphics/image_utils.h"
+
+namespace redux::tool {
+namespace {
+
+using ::testing::Eq;
+
+ImageData CreateImage(ImageFormat format, const vec2i& size) {
+  const std::size_t num_bytes = CalculateDataSize(format, size);
+  DataContainer data = DataContainer::Allocate(num_bytes);
+  auto* bytes = const_cast<std::byte*>(data.GetBytes());
+  for (std::size_t i = 0; i < num_bytes; ++i) {
+    bytes[i] = static_cast<std::byte>((i * 7 + i / 13) % 256);
+  }
+  return ImageData(format, size, std::move(data));
+}
+
+TEST(GenerateMipmaps, Levels) {
+  const std::vector<ImageData> mips =
+      GenerateMipmaps(CreateImage(ImageFormat::Rgba8888, {16, 8}));
+  ASSERT_THAT(mips.size(), Eq(4));
+  EXPECT_THAT(mips[0].GetSize(), Eq(vec2i(16, 8)));
+  EXPECT_THAT(mips[1].GetSize(), Eq(vec2i(8, 4)));
+  EXPECT_THAT(mips[2].GetSize(), Eq(vec2i(4, 2)));
+  EXPECT_THAT(mips[3].GetSize(), Eq(vec2i(2, 1)));
+}
+
+TEST(GenerateMipmaps, BoxFilter) {
+  DataContainer data = DataContainer::Allocate(4);
+  auto* bytes = const_cast<std::byte*>(data.GetBytes());
+  bytes[0] = std::byte{10};
+  bytes[1] = std::byte{20};
+  bytes[2] = std::byte{30};
+  bytes[3] = std::byte{41};
+  ImageData image(ImageFormat::Luminance8, {2, 2}, std::move(data));
+
+  const std::vector<ImageData> mips = GenerateMipmaps(std::move(image));
+  ASSERT_THAT(mips.size(), Eq(2));
+  EXPECT_THAT(mips[1].GetData()[0], Eq(std::byte{25}));
+}
+
+TEST(GenerateMipmaps, ThreadsMatchSingleThread) {
+  const ImageData image = CreateImage(ImageFormat::Rgb888, {1024, 1024});
+
+  GenerateMipmapsOptions serial;
+  serial.num_threads = 1;
+  GenerateMipmapsOptions parallel;
+  parallel.num_threads = 8;
+
+  const std::vector<ImageData> expected =
+      GenerateMipmaps(image.Clone(), serial);
+  const std::vector<ImageData> actual =
+      GenerateMipmaps(image.Clone(), parallel);
+  ASSERT_THAT(actual.size(), Eq(expected.size()));
+  for (std::size_t i = 0; i < actual.size(); ++i) {
+    ASSERT_THAT(actual[i].GetNumBytes(), Eq(expected[i].GetNumBytes()));
+    EXPECT_THAT(std::memcmp(actual[i].GetData(), expected[i].GetData(),
+                            actual[i].GetNumBytes()),
+                Eq(0));
+  }
+}
+
+TEST(GenerateMipmaps, Srgb) {
+  // Two black and two white pixels average to 50% linear intensity, which is
+  // much brighter than 50% in sRGB space. Alpha is always filtered linearly.
+  DataContainer data = DataContainer::Allocate(16);
+  auto* bytes = const_cast<std::byte*>(data.GetBytes());
+  for (int i = 0; i < 4; ++i) {
+    const std::byte value = i % 2 ? std::byte{255} : std::byte{0};
+    bytes[i * 4 + 0] = value;
+    bytes[i * 4 + 1] = value;
+    bytes[i * 4 + 2] = value;
+    bytes[i * 4 + 3] = value;
+  }
+  ImageData image(ImageFormat::Rgba8888, {2, 2}, std::move(data));
+
+  GenerateMipmapsOptions options;
+  options.srgb = true;
+  const std::vector<ImageData> mips = GenerateMipmaps(image.Clone(), options);
+  ASSERT_THAT(mips.size(), Eq(2));
+  EXPECT_THAT(mips[1].GetData()[0], Eq(std::byte{188}));
+  EXPECT_THAT(mips[1].GetData()[1], Eq(std::byte{188}));
+  EXPECT_THAT(mips[1].GetData()[2], Eq(std::byte{188}));
+  EXPECT_THAT(mips[1].GetData()[3], Eq(std::byte{127}));
+
+  const std::vector<ImageData> linear = GenerateMipmaps(image.Clone());
+  EXPECT_THAT(linear[1].GetData()[0], Eq(std::byte{127}));
+}
+
+}  // namespace
+}  // namespace redux::tool
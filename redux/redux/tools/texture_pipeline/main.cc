@@ -30,6 +30,11 @@ ABSL_FLAG(std::vector<std::string>, input, std::vector<std::string>{},
           "Input image(s).");
 ABSL_FLAG(std::string, output, "", "Output image.");
 ABSL_FLAG(bool, generate_mipmaps, false, "Generates MipMap levels for image.");
+ABSL_FLAG(int, mipmap_threads, 0,
+          "Number of threads used to generate each MipMap level (0 for the "
+          "number of hardware threads).");
+ABSL_FLAG(bool, srgb, false,
+          "Treats the image color channels as sRGB when generating MipMaps.");
 
 namespace redux::tool {
 
@@ -55,7 +60,10 @@ static int RunTexturePipeline() {
   if (absl::GetFlag(FLAGS_generate_mipmaps)) {
     CHECK_EQ(decoded_images.size(), 1)
         << "Can only generate mipmaps for a single image";
-    decoded_images = GenerateMipmaps(std::move(decoded_images[0]));
+    GenerateMipmapsOptions options;
+    options.num_threads = absl::GetFlag(FLAGS_mipmap_threads);
+    options.srgb = absl::GetFlag(FLAGS_srgb);
+    decoded_images = GenerateMipmaps(std::move(decoded_images[0]), options);
   }
 
   DataContainer out;